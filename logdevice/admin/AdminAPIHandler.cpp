@@ -482,12 +482,17 @@ void AdminAPIHandler::getLogGroupThroughput(
     throw err;
   }
 
+  std::string req_log_group = request->log_group_name_ref().value_or("");
+  std::vector<std::string> log_groups;
+  if (!req_log_group.empty()) {
+    log_groups.push_back(req_log_group);
+  }
+
   AggregateMap agg = doAggregate(stats_holder_,
                                  time_series,
                                  query_intervals,
-                                 processor_->config_->getLogsConfig());
-
-  std::string req_log_group = request->log_group_name_ref().value_or("");
+                                 processor_->config_->getLogsConfig(),
+                                 log_groups);
 
   for (const auto& entry : agg) {
     std::string log_group_name = entry.first;
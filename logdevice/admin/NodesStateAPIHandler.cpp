@@ -20,11 +20,12 @@ using facebook::logdevice::thrift::NodesStateRequest;
 using facebook::logdevice::thrift::NodesStateResponse;
 
 namespace facebook { namespace logdevice {
-void NodesStateAPIHandler::toNodeState(thrift::NodeState& out,
-                                       thrift::NodeIndex index,
-                                       bool force) {
-  std::shared_ptr<EventLogRebuildingSet> rebuilding_set =
-      processor_->rebuilding_set_.get();
+void NodesStateAPIHandler::toNodeState(
+    thrift::NodeState& out,
+    thrift::NodeIndex index,
+    const configuration::nodes::NodesConfiguration& nodes_configuration,
+    const EventLogRebuildingSet* rebuilding_set,
+    bool force) {
   // Rebuilding Set can be nullptr if rebuilding is disabled, or if event_log is
   // not ready yet.
   if (!force && rebuilding_set == nullptr) {
@@ -33,11 +34,9 @@ void NodesStateAPIHandler::toNodeState(thrift::NodeState& out,
                     "different node (or use force=true)");
     throw err;
   }
-  auto nodes_configuration = processor_->getNodesConfiguration();
   const ClusterState* cluster_state = processor_->cluster_state_.get();
   // We have the node, let's fill the data that we have into NodeState
-  fillNodeState(
-      out, index, *nodes_configuration, rebuilding_set.get(), cluster_state);
+  fillNodeState(out, index, nodes_configuration, rebuilding_set, cluster_state);
 }
 
 folly::SemiFuture<std::unique_ptr<NodesStateResponse>>
@@ -71,10 +70,19 @@ NodesStateAPIHandler::semifuture_getNodesState(
     if (req) {
       force = req->force_ref().value_or(false);
     }
+    // Take the rebuilding set snapshot once rather than for every node, so
+    // that all entries of the response describe the same state.
+    std::shared_ptr<EventLogRebuildingSet> rebuilding_set =
+        processor_->rebuilding_set_.get();
     std::vector<thrift::NodeState> result_states;
+    result_states.reserve(nodes_configuration->clusterSize());
     forFilteredNodes(*nodes_configuration, &filter, [&](node_index_t index) {
       thrift::NodeState node_state;
-      toNodeState(node_state, index, force);
+      toNodeState(node_state,
+                  index,
+                  *nodes_configuration,
+                  rebuilding_set.get(),
+                  force);
       result_states.push_back(std::move(node_state));
     });
     out->set_states(std::move(result_states));
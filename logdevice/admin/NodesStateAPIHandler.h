@@ -17,7 +17,11 @@
 namespace facebook { namespace logdevice {
 namespace configuration {
 class Node;
+namespace nodes {
+class NodesConfiguration;
 }
+} // namespace configuration
+class EventLogRebuildingSet;
 
 class NodesStateAPIHandler : public virtual AdminAPIHandlerBase {
  public:
@@ -27,6 +31,11 @@ class NodesStateAPIHandler : public virtual AdminAPIHandlerBase {
       std::unique_ptr<thrift::NodesStateRequest> request) override;
 
  private:
-  void toNodeState(thrift::NodeState& out, thrift::NodeIndex index, bool force);
+  void toNodeState(
+      thrift::NodeState& out,
+      thrift::NodeIndex index,
+      const configuration::nodes::NodesConfiguration& nodes_configuration,
+      const EventLogRebuildingSet* rebuilding_set,
+      bool force);
 };
 }} // namespace facebook::logdevice
@@ -380,6 +380,7 @@ MaintenanceManager::getNodesState(thrift::NodesFilter filter) {
 
         const ClusterState* cluster_state =
             deps_->getProcessor()->cluster_state_.get();
+        states.reserve(node_ids.size());
         for (const auto& node_id : node_ids) {
           auto expected_state = getNodeStateInternal(node_id, cluster_state);
           if (expected_state.hasError()) {
@@ -1019,27 +1020,23 @@ void MaintenanceManager::evaluate() {
   status_ = MMStatus::RUNNING_WORKFLOWS;
   ld_info("Updated MaintenanceManager status to RUNNING_WORKFLOWS");
   auto shards_futures = runShardWorkflows();
-  collectAll(shards_futures.second.begin(), shards_futures.second.end())
+  // Sequencer workflows don't depend on the outcome of shard workflows, so
+  // they run while shard workflows wait for their event log writes.
+  auto nodes_futures = runSequencerWorkflows();
+  collectAll(
+      collectAll(shards_futures.second.begin(), shards_futures.second.end()),
+      collectAll(nodes_futures.second.begin(), nodes_futures.second.end()))
       .via(this)
-      // Cont. When all shard workflows finish processing. At this point we have
-      // a list of MaintenanceStatus states for the shards that tell us how we
-      // should proceed with each workflow.
-      .thenValue([this, shards = std::move(shards_futures.first)](
-                     std::vector<folly::Try<MaintenanceStatus>>&& result) {
-        ld_debug("runShardWorkflows complete. processing results");
-        processShardWorkflowResult(shards, result);
-        auto nodes_futures = runSequencerWorkflows();
-        // Process all sequencer workflow results now.
-        return collectAll(
-                   nodes_futures.second.begin(), nodes_futures.second.end())
-            .via(this)
-            .thenValue([this, n = std::move(nodes_futures.first)](
-                           std::vector<folly::Try<MaintenanceStatus>>&&
-                               sequencerResult) {
-              ld_debug("runSequencerWorkflows complete. processing results");
-              processSequencerWorkflowResult(n, sequencerResult);
-              return folly::unit;
-            });
+      // Cont. When all workflows finish processing. At this point we have
+      // a list of MaintenanceStatus states for the shards and sequencers that
+      // tell us how we should proceed with each workflow.
+      .thenValue([this,
+                  shards = std::move(shards_futures.first),
+                  nodes = std::move(nodes_futures.first)](auto&& results) {
+        ld_debug("Shard and sequencer workflows complete. processing results");
+        processShardWorkflowResult(shards, std::get<0>(results).value());
+        processSequencerWorkflowResult(nodes, std::get<1>(results).value());
+        return folly::unit;
       })
       // Let's perform a NodesConfiguration update if needed. These updates
       // should include any change that doesn't require safety check run.
@@ -7,6 +7,8 @@
  */
 #include "logdevice/admin/safety/SafetyCheckerUtils.h"
 
+#include <folly/Conv.h>
+
 #include "logdevice/common/EpochMetaData.h"
 #include "logdevice/common/FailureDomainNodeSet.h"
 
@@ -14,6 +16,19 @@ using namespace facebook::logdevice::configuration;
 
 namespace facebook { namespace logdevice { namespace safety {
 
+namespace {
+std::string storageSetCacheKey(const StorageSet& storage_set,
+                               const ReplicationProperty& replication,
+                               bool require_fully_started) {
+  std::string key = replication.toString();
+  key += require_fully_started ? "|s|" : "|a|";
+  for (const ShardID& shard : storage_set) {
+    key += folly::to<std::string>(shard.node(), ':', shard.shard(), ',');
+  }
+  return key;
+}
+} // namespace
+
 folly::Expected<Impact, Status> checkImpactOnLogs(
     const std::vector<logid_t>& log_ids,
     const std::shared_ptr<LogMetaDataFetcher::Results>& metadata,
@@ -32,6 +47,7 @@ folly::Expected<Impact, Status> checkImpactOnLogs(
   std::vector<Impact::ImpactOnEpoch> affected_logs_sample;
   size_t logs_done = 0;
   bool internal_logs_affected = false;
+  StorageSetCheckCache storage_set_cache;
 
   // Check other logs
   for (logid_t log_id : log_ids) {
@@ -45,7 +61,8 @@ folly::Expected<Impact, Status> checkImpactOnLogs(
                                    target_storage_state,
                                    safety_margin,
                                    nodes_config,
-                                   cluster_state);
+                                   cluster_state,
+                                   &storage_set_cache);
     logs_done++;
     if (result.hasError()) {
       // The operation failed. Possibly because we don't have metadata for
@@ -88,7 +105,8 @@ folly::Expected<Impact::ImpactOnEpoch, Status> checkImpactOnLog(
     const SafetyMargin& safety_margin,
     const std::shared_ptr<const configuration::nodes::NodesConfiguration>&
         nodes_config,
-    ClusterState* cluster_state) {
+    ClusterState* cluster_state,
+    StorageSetCheckCache* storage_set_cache) {
   ld_assert(metadata_cache);
   if (metadata_cache->find(log_id) == metadata_cache->end()) {
     // We cannot find the epoch metadata for this log. This can have multiple
@@ -136,16 +154,29 @@ folly::Expected<Impact::ImpactOnEpoch, Status> checkImpactOnLog(
     bool safe_writes;
     bool safe_reads;
 
-    std::tie(safe_reads, safe_writes) =
-        checkReadWriteAvailablity(shard_status,
-                                  op_shards,
-                                  epoch_metadata.shards,
-                                  target_storage_state,
-                                  epoch_metadata.replication,
-                                  safety_margin,
-                                  nodes_config,
-                                  cluster_state,
-                                  require_fully_started);
+    auto check = [&] {
+      return checkReadWriteAvailablity(shard_status,
+                                       op_shards,
+                                       epoch_metadata.shards,
+                                       target_storage_state,
+                                       epoch_metadata.replication,
+                                       safety_margin,
+                                       nodes_config,
+                                       cluster_state,
+                                       require_fully_started);
+    };
+    if (storage_set_cache != nullptr) {
+      std::string key = storageSetCacheKey(epoch_metadata.shards,
+                                           epoch_metadata.replication,
+                                           require_fully_started);
+      auto it = storage_set_cache->find(key);
+      if (it == storage_set_cache->end()) {
+        it = storage_set_cache->emplace(std::move(key), check()).first;
+      }
+      std::tie(safe_reads, safe_writes) = it->second;
+    } else {
+      std::tie(safe_reads, safe_writes) = check();
+    }
 
     if (safe_writes && safe_reads) {
       continue;
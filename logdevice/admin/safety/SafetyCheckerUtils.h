@@ -7,6 +7,9 @@
  */
 #pragma once
 
+#include <string>
+
+#include <folly/container/F14Map.h>
 #include <folly/container/F14Set.h>
 
 #include "logdevice/admin/safety/LogMetaDataFetcher.h"
@@ -36,8 +39,21 @@ folly::Expected<Impact, Status> checkImpactOnLogs(
     const std::shared_ptr<const configuration::nodes::NodesConfiguration>&
         nodes_config,
     ClusterState* cluster_state);
+
+/**
+ * Results of checkReadWriteAvailablity() keyed by storage set, replication
+ * and whether nodes need to be fully started. All other inputs are the same
+ * for every log of one checkImpactOnLogs() run, so epochs with identical
+ * storage sets only need to be evaluated once per run.
+ */
+using StorageSetCheckCache =
+    folly::F14FastMap<std::string, std::pair<bool, bool>>;
+
 /**
  * Perform safety check on a single log.
+ *
+ * @param storage_set_cache  if not null, used to look up and store results
+ *                           of storage set checks.
  */
 folly::Expected<Impact::ImpactOnEpoch, Status> checkImpactOnLog(
     logid_t log_id,
@@ -49,7 +65,8 @@ folly::Expected<Impact::ImpactOnEpoch, Status> checkImpactOnLog(
     const SafetyMargin& safety_margin,
     const std::shared_ptr<const configuration::nodes::NodesConfiguration>&
         nodes_config,
-    ClusterState* cluster_state);
+    ClusterState* cluster_state,
+    StorageSetCheckCache* storage_set_cache = nullptr);
 
 /**
  * Checks whether a node is alive in the FailureDetector (gossip) or not.
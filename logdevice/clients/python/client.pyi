@@ -31,9 +31,19 @@ class Directory:
     attrs: Attrs
     # TODO flesh out
 
+class RecordBatch:
+    def __len__(self) -> int: ...
+    def __arrow_c_array__(
+        self, requested_schema: Any = None
+    ) -> Tuple[Any, Any]: ...
+    def to_pyarrow(self) -> Any: ...
+
 class Reader:
     def __iter__(self) -> Iterator: ...
     def __next__(self) -> Tuple[Any, Any]: ...
+    def read_batch(
+        self, max_records: int = 1024
+    ) -> Tuple[Optional[RecordBatch], Any]: ...
     def stop_iteration(self) -> bool: ...
     def start_reading(self, logid: int, from_: lsn_t, until_: lsn_t) -> bool: ...
     def stop_reading(self, logid: int) -> bool: ...
@@ -1151,6 +1151,7 @@ For example, all these are acceptable
   // register object wrappers from other components
   register_logdevice_reader();
   register_logdevice_record();
+  register_logdevice_record_batch();
 
   enum_<dbg::Level>("LoggingLevel")
       .value("NONE", dbg::Level::NONE)
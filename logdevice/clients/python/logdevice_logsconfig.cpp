@@ -59,6 +59,7 @@ constexpr auto logs_config_recognized_attributes = {
     SEQUENCER_BATCHING_PASSTHRU_THRESHOLD,
     SHADOW,
     TAIL_OPTIMIZED,
+    STORAGE_COMPRESSION,
     EXTRAS};
 
 static NodeLocationScope parse_location_scope_or_throw(std::string key) {
@@ -311,6 +312,12 @@ dict LogAttributes_to_dict(const LogAttributes& attrs) {
       SEQUENCER_BATCHING_PASSTHRU_THRESHOLD,
       output);
 
+  add_log_attribute<Compression, std::string>(
+      attrs.storageCompression(),
+      [](auto attr) { return compressionToString(attr.value()); },
+      STORAGE_COMPRESSION,
+      output);
+
   add_log_attribute<logdevice::NodeLocationScope, std::string>(
       attrs.syncReplicationScope(),
       [](auto attr) { return NodeLocation::scopeNames()[attr.value()]; },
@@ -571,6 +578,11 @@ LogAttributes dict_to_LogAttributes(const dict& attrs) {
       bool v = convert_or_throw<bool>(value, TAIL_OPTIMIZED);
       log_attributes = log_attributes.with_tailOptimized(v);
     }
+    if (key_string == STORAGE_COMPRESSION) {
+      std::string v = extract_string(value, STORAGE_COMPRESSION);
+      Compression c = parse_compression_or_throw(v);
+      log_attributes = log_attributes.with_storageCompression(c);
+    }
     if (key == EXTRAS) {
       dict v = convert_or_throw<dict>(value, EXTRAS);
       log_attributes = log_attributes.with_extras(dict_to_ExtrasMap(v));
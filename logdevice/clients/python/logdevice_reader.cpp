@@ -13,6 +13,7 @@
 #include <boost/make_shared.hpp>
 
 #include "logdevice/clients/python/logdevice_client.h"
+#include "logdevice/clients/python/logdevice_record_batch.h"
 #include "logdevice/clients/python/util/util.h"
 #include "logdevice/include/Client.h"
 
@@ -98,6 +99,59 @@ class ReaderWrapper : boost::noncopyable {
     throw std::runtime_error("unpossible, the line above always throws!");
   }
 
+  /**
+   * Read up to `max_records` data records into a RecordBatch, waiting like
+   * next() until at least one record or a gap is available.  Returns a
+   * (RecordBatch, GapRecord) pair in which at most one of the two is not
+   * None; both are None once there is nothing left to read.
+   *
+   * The GIL is released while reading and while copying records into the
+   * batch, so no Python object is created per record.
+   */
+  boost::python::tuple read_batch(size_t max_records = 1024) {
+    if (max_records == 0) {
+      throw_python_exception(PyExc_ValueError, "max_records must be positive");
+    }
+    std::vector<std::unique_ptr<DataRecord>> records;
+    records.reserve(max_records);
+    GapRecord gap;
+
+    while (keep_reading_ && reader_->isReadingAny()) {
+      if (PyErr_CheckSignals() != 0)
+        throw_python_exception();
+
+      boost::shared_ptr<RecordBatch> batch;
+      ssize_t n = 0;
+      {
+        gil_release_and_guard guard;
+        n = reader_->read(max_records, &records, &gap);
+        if (n > 0) {
+          batch = boost::make_shared<RecordBatch>();
+          for (const auto& record : records) {
+            batch->append(*record);
+          }
+          records.clear();
+        }
+      }
+
+      if (n < 0) {
+        if (err == E::GAP) {
+          return boost::python::make_tuple(object(), // RecordBatch is None
+                                           boost::make_shared<GapRecord>(gap));
+        }
+
+        throw_logdevice_exception();
+        throw std::runtime_error("unpossible, the line above always throws!");
+      }
+
+      if (n > 0) {
+        return boost::python::make_tuple(batch, object());
+      }
+    }
+
+    return boost::python::make_tuple(object(), object());
+  }
+
   bool stop_iteration() {
     keep_reading_ = false;
     return true; // yes, we did stop as you requested
@@ -165,6 +219,10 @@ BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(start_reading_overloads,
                                        ReaderWrapper::start_reading,
                                        2,
                                        3)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(read_batch_overloads,
+                                       ReaderWrapper::read_batch,
+                                       0,
+                                       1)
 
 void register_logdevice_reader() {
   class_<ReaderWrapper, boost::shared_ptr<ReaderWrapper>, boost::noncopyable>(
@@ -196,6 +254,19 @@ This will read until the 'stop_iteration()' method is called
 from Python, or a record (data or gap) can be returned.
 )DOC")
 
+      .def("read_batch",
+           &ReaderWrapper::read_batch,
+           read_batch_overloads(args("max_records"),
+                                R"DOC(
+Read up to MAX_RECORDS (default 1024) data records at once, without creating
+a Python object per record.
+
+Returns a (RecordBatch, GapRecord) pair in which at most one of the two is
+not None.  Like iteration, this waits until at least one record or a gap is
+available; both are None if 'stop_iteration()' was called or there is
+nothing left to read.  See RecordBatch for how to get at the data.
+)DOC"))
+
       .def("stop_iteration",
            &ReaderWrapper::stop_iteration,
            "Stop iteration immediately, breaking out of any wait.\n"
@@ -0,0 +1,221 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/clients/python/logdevice_record_batch.h"
+
+#include <array>
+
+#include <boost/make_shared.hpp>
+
+#include "logdevice/clients/python/logdevice_client.h"
+#include "logdevice/clients/python/util/util.h"
+
+using namespace boost::python;
+using namespace facebook::logdevice;
+
+namespace {
+
+struct ColumnType {
+  const char* name;
+  const char* format;
+};
+
+// In the order of the children of the exported struct array.
+const std::array<ColumnType, 4> kColumns{{
+    {"logid", "L"},         // uint64
+    {"lsn", "L"},           // uint64
+    {"timestamp", "tsm:"},  // timestamp[ms], no time zone
+    {"payload", "Z"},       // large_binary
+}};
+constexpr size_t kNumColumns = kColumns.size();
+
+struct ExportedSchema {
+  ArrowSchema children[kNumColumns];
+  ArrowSchema* child_ptrs[kNumColumns];
+};
+
+void release_child_schema(ArrowSchema* schema) {
+  // Owned by the parent's ExportedSchema.
+  schema->release = nullptr;
+}
+
+void release_schema(ArrowSchema* schema) {
+  auto holder = static_cast<ExportedSchema*>(schema->private_data);
+  for (ArrowSchema& child : holder->children) {
+    if (child.release) {
+      child.release(&child);
+    }
+  }
+  delete holder;
+  schema->release = nullptr;
+}
+
+template <typename Columns>
+struct ExportedArray {
+  // Keeps the buffers alive for as long as the consumer needs them.
+  std::shared_ptr<const Columns> columns;
+  ArrowArray children[kNumColumns];
+  ArrowArray* child_ptrs[kNumColumns];
+  // Validity bitmaps are all null, there are no null values.
+  const void* child_buffers[kNumColumns][3];
+  const void* struct_buffers[1] = {nullptr};
+};
+
+void release_child_array(ArrowArray* array) {
+  array->release = nullptr;
+}
+
+template <typename Holder>
+void release_array(ArrowArray* array) {
+  auto holder = static_cast<Holder*>(array->private_data);
+  for (ArrowArray& child : holder->children) {
+    if (child.release) {
+      child.release(&child);
+    }
+  }
+  delete holder;
+  array->release = nullptr;
+}
+
+void schema_capsule_destructor(PyObject* capsule) {
+  auto schema =
+      static_cast<ArrowSchema*>(PyCapsule_GetPointer(capsule, "arrow_schema"));
+  // The consumer sets `release' to null if it took ownership.
+  if (schema->release) {
+    schema->release(schema);
+  }
+  delete schema;
+}
+
+void array_capsule_destructor(PyObject* capsule) {
+  auto array =
+      static_cast<ArrowArray*>(PyCapsule_GetPointer(capsule, "arrow_array"));
+  if (array->release) {
+    array->release(array);
+  }
+  delete array;
+}
+
+ArrowSchema* export_schema() {
+  auto holder = new ExportedSchema();
+  for (size_t i = 0; i < kNumColumns; ++i) {
+    ArrowSchema& child = holder->children[i];
+    child = ArrowSchema{};
+    child.format = kColumns[i].format;
+    child.name = kColumns[i].name;
+    child.release = &release_child_schema;
+    holder->child_ptrs[i] = &child;
+  }
+
+  auto schema = new ArrowSchema{};
+  schema->format = "+s";
+  schema->name = "";
+  schema->n_children = kNumColumns;
+  schema->children = holder->child_ptrs;
+  schema->release = &release_schema;
+  schema->private_data = holder;
+  return schema;
+}
+
+} // namespace
+
+RecordBatch::RecordBatch() : columns_(std::make_shared<Columns>()) {
+  columns_->payload_offsets.push_back(0);
+}
+
+void RecordBatch::append(const DataRecord& record) {
+  Columns& c = *columns_;
+  c.logids.push_back(record.logid.val());
+  c.lsns.push_back(record.attrs.lsn);
+  c.timestamps.push_back(record.attrs.timestamp.count());
+  if (record.payload.size() > 0) {
+    c.payload_data.append(
+        static_cast<const char*>(record.payload.data()), record.payload.size());
+  }
+  c.payload_offsets.push_back(c.payload_data.size());
+}
+
+tuple RecordBatch::arrowCArray(object /* requested_schema */) const {
+  using Holder = ExportedArray<Columns>;
+  auto holder = new Holder();
+  holder->columns = columns_;
+  const Columns& c = *columns_;
+  const void* data[kNumColumns] = {
+      c.logids.data(), c.lsns.data(), c.timestamps.data(), nullptr};
+
+  for (size_t i = 0; i < kNumColumns; ++i) {
+    ArrowArray& child = holder->children[i];
+    const void** buffers = holder->child_buffers[i];
+    child = ArrowArray{};
+    child.length = size();
+    buffers[0] = nullptr;
+    if (i + 1 < kNumColumns) {
+      child.n_buffers = 2;
+      buffers[1] = data[i];
+    } else {
+      // Variable-size binary: offsets, then the bytes.
+      child.n_buffers = 3;
+      buffers[1] = c.payload_offsets.data();
+      buffers[2] = c.payload_data.data();
+    }
+    child.buffers = buffers;
+    child.release = &release_child_array;
+    holder->child_ptrs[i] = &child;
+  }
+
+  auto array = new ArrowArray{};
+  array->length = size();
+  array->n_buffers = 1;
+  array->buffers = holder->struct_buffers;
+  array->n_children = kNumColumns;
+  array->children = holder->child_ptrs;
+  array->release = &release_array<Holder>;
+  array->private_data = holder;
+
+  // The capsules own the structs from here on.
+  object schema_capsule(handle<>(PyCapsule_New(
+      export_schema(), "arrow_schema", &schema_capsule_destructor)));
+  object array_capsule(handle<>(
+      PyCapsule_New(array, "arrow_array", &array_capsule_destructor)));
+  return boost::python::make_tuple(schema_capsule, array_capsule);
+}
+
+namespace {
+
+object to_pyarrow(object self) {
+  return import("pyarrow").attr("record_batch")(self);
+}
+
+} // namespace
+
+void register_logdevice_record_batch() {
+  class_<RecordBatch, boost::shared_ptr<RecordBatch>, boost::noncopyable>(
+      "RecordBatch",
+      R"DOC(
+Data records returned by Reader.read_batch(), stored column by column in
+contiguous buffers:
+
+  logid      uint64
+  lsn        uint64
+  timestamp  timestamp[ms]
+  payload    large_binary
+
+The batch implements the Arrow PyCapsule interface (__arrow_c_array__), so
+Arrow-aware libraries can use its buffers without copying, e.g.
+pyarrow.record_batch(batch) or polars.from_arrow(batch).
+)DOC",
+      no_init)
+      .def("__len__", &RecordBatch::size)
+      .def("__arrow_c_array__",
+           &RecordBatch::arrowCArray,
+           (arg("requested_schema") = object()),
+           "Export the batch through the Arrow C data interface.")
+      .def("to_pyarrow",
+           &to_pyarrow,
+           "Return the batch as a pyarrow.RecordBatch, without copying. "
+           "Requires pyarrow >= 14.");
+}
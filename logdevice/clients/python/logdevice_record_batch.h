@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/python.hpp>
+
+#include "logdevice/include/Record.h"
+
+/**
+ * @file Columnar batches of data records, exported to Python through the
+ *       Arrow C data interface (and its PyCapsule protocol), so that
+ *       pyarrow, polars and friends can use them without copying and
+ *       without this module linking against Arrow.
+ */
+
+// Structs of the Arrow C data interface, straight from the specification:
+// https://arrow.apache.org/docs/format/CDataInterface.html
+// They are ABI-stable, so defining them here is what the spec recommends.
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+  // Array type description
+  const char* format;
+  const char* name;
+  const char* metadata;
+  int64_t flags;
+  int64_t n_children;
+  struct ArrowSchema** children;
+  struct ArrowSchema* dictionary;
+
+  // Release callback
+  void (*release)(struct ArrowSchema*);
+  // Opaque producer-specific data
+  void* private_data;
+};
+
+struct ArrowArray {
+  // Array data description
+  int64_t length;
+  int64_t null_count;
+  int64_t offset;
+  int64_t n_buffers;
+  int64_t n_children;
+  const void** buffers;
+  struct ArrowArray** children;
+  struct ArrowArray* dictionary;
+
+  // Release callback
+  void (*release)(struct ArrowArray*);
+  // Opaque producer-specific data
+  void* private_data;
+};
+
+#endif // ARROW_C_DATA_INTERFACE
+
+/**
+ * Data records stored column by column: logid and lsn (uint64), timestamp
+ * (timestamp[ms]) and payload (large_binary).  Payloads are copied into one
+ * contiguous buffer.
+ *
+ * append() doesn't touch Python objects and may be called without holding
+ * the GIL.  A batch must not be appended to once it was handed to Python,
+ * since exported arrays point into its buffers.
+ */
+class RecordBatch {
+ public:
+  RecordBatch();
+
+  void append(const facebook::logdevice::DataRecord& record);
+
+  size_t size() const {
+    return columns_->lsns.size();
+  }
+
+  /**
+   * Implements __arrow_c_array__() of the Arrow PyCapsule interface, which
+   * returns a pair of capsules with the schema and the data of a struct
+   * array with one child per column.  The exported array keeps the buffers
+   * alive, even after this batch is garbage collected.
+   *
+   * Casting to `requested_schema' isn't supported, it's ignored as the
+   * protocol allows.
+   */
+  boost::python::tuple
+  arrowCArray(boost::python::object requested_schema) const;
+
+ private:
+  struct Columns {
+    std::vector<uint64_t> logids;
+    std::vector<uint64_t> lsns;
+    std::vector<int64_t> timestamps;
+    // payload i is payload_data[payload_offsets[i], payload_offsets[i+1])
+    std::vector<int64_t> payload_offsets;
+    std::string payload_data;
+  };
+
+  std::shared_ptr<Columns> columns_;
+};
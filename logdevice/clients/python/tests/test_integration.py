@@ -138,6 +138,36 @@ class LogDeviceIntegrationTest(TestCase):
                 nread += 1
         self.assertEqual(NWRITES, nread)
 
+    def test_read_batch(self):
+        NWRITES = 100
+        client = self.client()
+        logid = 1
+        payloads = [("record %d" % i).encode() for i in range(NWRITES)]
+        lsns = [client.append(logid, p) for p in payloads]
+
+        reader = client.create_reader(1)
+        reader.start_reading(logid, logdevice.client.LSN_OLDEST, lsns[-1])
+
+        batches = []
+        while True:
+            batch, gap = reader.read_batch(max_records=30)
+            if batch is None and gap is None:
+                break
+            if batch is not None:
+                self.assertIsNone(gap)
+                self.assertLessEqual(len(batch), 30)
+                batches.append(batch)
+        self.assertEqual(NWRITES, sum(len(b) for b in batches))
+
+        try:
+            import pyarrow
+        except ImportError:
+            return
+        table = pyarrow.Table.from_batches([b.to_pyarrow() for b in batches])
+        self.assertEqual(lsns, table.column("lsn").to_pylist())
+        self.assertEqual([logid] * NWRITES, table.column("logid").to_pylist())
+        self.assertEqual(payloads, table.column("payload").to_pylist())
+
     def test_is_log_empty(self):
         client = self.client()
         client.append(1, "test")
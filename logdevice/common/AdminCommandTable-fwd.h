@@ -74,7 +74,16 @@ typedef AdminCommandTable<shard_index_t,              /* Shard */
                           int64_t,  /* Read shaping - current meter level */
                           std::string,                /* Client Session ID */
                           read_stream_id_t::raw_type, /* Read stream ID*/
-                          size_t                      /* send buf occupancy */
+                          size_t,                     /* send buf occupancy */
+                          size_t,                     /* Readahead size */
+                          double,   /* Read amplification */
+                          uint64_t, /* Result cache hits */
+                          uint64_t, /* Result cache misses */
+                          double,      /* Filter selectivity */
+                          size_t,      /* Batch size */
+                          std::string, /* Principal */
+                          uint64_t,    /* Records sent */
+                          uint64_t     /* Record bytes sent */
                           >
     InfoReadersTable;
 
@@ -92,7 +101,11 @@ typedef AdminCommandTable<std::string, /* State */
                           int,         /* Proto */
                           size_t,      /* Send buf-sz */
                           bool,        /* Is ssl */
-                          int          /* FD of the underlying socket */
+                          int,         /* FD of the underlying socket */
+                          float,       /* Messages per write */
+                          float,       /* Bytes per write */
+                          std::string, /* kTLS */
+                          std::string  /* Principal */
                           >
     InfoSocketsTable;
 
@@ -144,7 +157,13 @@ typedef AdminCommandTable<uint32_t,                  /* Shard id */
                           uint64_t,    /* Read buffer bytes */
                           uint64_t,    /* Records in flight */
                           std::string, /* Read pointer */
-                          double       /* Progress */
+                          double,      /* Progress */
+                          std::string, /* Read pass */
+                          uint64_t,    /* Bytes read */
+                          std::string, /* Restart wasted bytes */
+                          uint64_t,    /* Bytes left to read */
+                          uint64_t,    /* Bytes left to rebuild */
+                          std::chrono::seconds /* ETA */
                           >
     InfoRebuildingShardsTable;
 
@@ -170,6 +189,15 @@ typedef AdminCommandTable<int,                       /* Shard */
                           std::string,               /* Append Dirtied By */
                           std::string,               /* Rebuild Dirtied By */
                           bool,                      /* Under Replicated */
+                          std::string,               /* Tier */
+                          uint64_t,                  /* Offloaded Bytes */
+                          uint64_t,                  /* IO Reads */
+                          uint64_t,                  /* IO Read Bytes */
+                          int64_t,                   /* IO Read p50 us */
+                          int64_t,                   /* IO Read p99 us */
+                          uint64_t,                  /* IO Writes */
+                          uint64_t,                  /* IO Write Bytes */
+                          int64_t,                   /* IO Write p99 us */
                           uint64_t /* Approx. Obsolete Bytes */
                           >
     InfoPartitionsTable;
@@ -307,7 +335,11 @@ typedef AdminCommandTable<std::string, /* Column family */
                           std::string, /* More context on the iterator */
                           admin_command_table::LSN,  /* Last seek LSN */
                           std::chrono::milliseconds, /* Last seek timestamp */
-                          uint64_t /* RocksDB version after last seek */
+                          uint64_t, /* RocksDB version after last seek */
+                          uint64_t, /* RocksDB iterators created */
+                          uint64_t, /* RocksDB iterators reused */
+                          double,   /* RocksDB iterators created per minute */
+                          size_t    /* Pinned bytes */
                           >
     InfoIteratorsTable;
 
@@ -316,7 +348,9 @@ typedef AdminCommandTable<uint64_t,    /* Shard ID */
                           Status,      /* Accepting writes */
                           std::string, /* Rebuilding state */
                           uint64_t,    /* Default CF version */
-                          std::string  /* Dirty state */
+                          std::string, /* Dirty state */
+                          int64_t,     /* NUMA node */
+                          bool         /* Storage threads pinned */
                           >
     InfoShardsTable;
 
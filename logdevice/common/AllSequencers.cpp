@@ -88,10 +88,9 @@ std::shared_ptr<Sequencer> AllSequencers::findSequencer(logid_t logid) {
     return getMetaDataLogSequencer(logid);
   }
 
-  folly::SharedMutex::ReadHolder map_lock(sequencer_map_mutex_);
   // data log id
   auto it = sequencer_map_.find(logid.val_);
-  if (it == sequencer_map_.end()) {
+  if (it == sequencer_map_.cend()) {
     err = E::NOSEQUENCER;
     return nullptr;
   }
@@ -127,26 +126,26 @@ int AllSequencers::activateSequencer(
     return -1;
   }
 
-  folly::SharedMutex::UpgradeHolder map_lock(sequencer_map_mutex_);
+  // Already have a Sequencer for this log, check state. In order to
+  // avoid shutdown crashes all threads that may run activateSequencer()
+  // must stop before this AllSequencers object (a subobject of Processor)
+  // is destroyed on shutdown.
   auto it = sequencer_map_.find(logid.val_);
-  if (it != sequencer_map_.end()) {
-    // Already have a Sequencer for this log, check state. In order to
-    // avoid shutdown crashes all threads that may run activateSequencer()
-    // must stop before this AllSequencers object (a subobject of Processor)
-    // is destroyed on shutdown.
+  if (it != sequencer_map_.cend()) {
     seq = it->second;
-    map_lock.unlock();
   } else {
     // no Sequencer for logid in the map, create one and insert it in the map.
-    // We shouldn't race with another thread that is also running
-    // activateSequencer() since we there can only be one thread in upgrade mode
-    // of the shared lock
-    seq = createSequencer(logid, settings_);
-    folly::SharedMutex::WriteHolder map_write_lock(std::move(map_lock));
-    auto insertion_result =
-        sequencer_map_.insert(std::make_pair(logid.val(), seq));
-
-    ld_check(insertion_result.second);
+    // Another thread running activateSequencer() may have got here first,
+    // look again while holding the creation mutex.
+    std::lock_guard<std::mutex> creation_lock(sequencer_creation_mutex_);
+    it = sequencer_map_.find(logid.val_);
+    if (it != sequencer_map_.cend()) {
+      seq = it->second;
+    } else {
+      seq = createSequencer(logid, settings_);
+      auto insertion_result = sequencer_map_.insert(logid.val(), seq);
+      ld_check(insertion_result.second);
+    }
   }
 
   ld_check(seq);
@@ -970,13 +969,9 @@ void AllSequencers::noteConfigurationChanged() {
   }
   std::vector<logid_t> log_ids;
   {
-    folly::stop_watch<std::chrono::milliseconds> watch;
-    folly::SharedMutex::ReadHolder map_lock(sequencer_map_mutex_);
-    uint64_t lock_ms = watch.lap().count();
     for (auto const& [log_id, _] : sequencer_map_) {
       log_ids.push_back(logid_t(log_id));
     }
-    ld_info("Acquiring lock for sequencer map took %lums", lock_ms);
   }
   if (!log_ids.empty()) {
     SequencerBackgroundActivator::requestSchedule(
@@ -985,28 +980,25 @@ void AllSequencers::noteConfigurationChanged() {
 }
 
 void AllSequencers::shutdown() {
-  folly::SharedMutex::ReadHolder map_lock(sequencer_map_mutex_);
   for (auto const& [_, sequencer] : sequencer_map_) {
     sequencer->shutdown();
   }
 }
 
-AllSequencers::Accessor::Accessor(AllSequencers* owner)
-    : owner_(owner), map_lock_(owner_->sequencer_map_mutex_) {}
+AllSequencers::Accessor::Accessor(AllSequencers* owner) : owner_(owner) {}
 
 AllSequencers::Accessor AllSequencers::accessAll() {
   return Accessor(this);
 }
 AllSequencers::Accessor::Iterator AllSequencers::Accessor::begin() {
-  return Iterator(owner_->sequencer_map_.begin());
+  return Iterator(owner_->sequencer_map_.cbegin());
 }
 AllSequencers::Accessor::Iterator AllSequencers::Accessor::end() {
-  return Iterator(owner_->sequencer_map_.end());
+  return Iterator(owner_->sequencer_map_.cend());
 }
 
 std::vector<std::shared_ptr<Sequencer>> AllSequencers::getAll() {
   std::vector<std::shared_ptr<Sequencer>> out;
-  folly::SharedMutex::ReadHolder map_lock(sequencer_map_mutex_);
   for (auto& p : sequencer_map_) {
     out.push_back(p.second);
   }
@@ -1042,14 +1034,12 @@ AllSequencers::getMetaDataLogSequencer(logid_t datalog_id) {
 }
 
 void AllSequencers::disableAllSequencersDueToIsolation() {
-  folly::SharedMutex::ReadHolder map_lock(sequencer_map_mutex_);
   for (const auto& [_, sequencer] : sequencer_map_) {
     sequencer->onNodeIsolated();
   }
 }
 
 void AllSequencers::onSettingsUpdated() {
-  folly::SharedMutex::ReadHolder map_lock(sequencer_map_mutex_);
   for (const auto& [_, sequencer] : sequencer_map_) {
     sequencer->onSettingsUpdated();
   }
@@ -10,10 +10,10 @@
 #include <chrono>
 #include <functional>
 #include <memory>
+#include <mutex>
 
 #include <boost/iterator/iterator_facade.hpp>
-#include <folly/SharedMutex.h>
-#include <folly/container/F14Map.h>
+#include <folly/concurrency/ConcurrentHashMap.h>
 
 #include "logdevice/common/EpochStore.h"
 #include "logdevice/common/MetaDataLog.h"
@@ -42,11 +42,13 @@ class Processor;
 
 class AllSequencers {
  public:
-  using SequencerMap = folly::F14FastMap<logid_t::raw_type,
-                                         std::shared_ptr<Sequencer>,
-                                         Hash64<logid_t::raw_type>>;
+  using SequencerMap = folly::ConcurrentHashMap<logid_t::raw_type,
+                                                std::shared_ptr<Sequencer>,
+                                                Hash64<logid_t::raw_type>>;
 
-  // An object used to access the contents of the map of sequencers.
+  // An object used to access the contents of the map of sequencers.  It
+  // doesn't block activation of new sequencers; those may or may not be
+  // visited by an iteration that is in progress.
   class Accessor {
    public:
     // Iterator, along with begin() and end() methods, required to
@@ -56,7 +58,8 @@ class AllSequencers {
                                         Sequencer,
                                         boost::forward_traversal_tag> {
      public:
-      explicit Iterator(SequencerMap::iterator iter) : iter_(iter) {}
+      explicit Iterator(SequencerMap::ConstIterator iter)
+          : iter_(std::move(iter)) {}
       bool equal(const Iterator& rhs) const {
         return iter_ == rhs.iter_;
       }
@@ -68,7 +71,8 @@ class AllSequencers {
       }
 
      private:
-      SequencerMap::iterator iter_;
+      // Holds a hazard pointer, and so is move-only.
+      SequencerMap::ConstIterator iter_;
     };
 
     explicit Accessor(AllSequencers* owner);
@@ -78,7 +82,6 @@ class AllSequencers {
 
    private:
     AllSequencers* owner_;
-    folly::SharedMutex::ReadHolder map_lock_;
   };
 
   /**
@@ -411,21 +414,18 @@ class AllSequencers {
   virtual StatsHolder* getStats() const;
 
  private:
-  // Protects sequencer_map_ and the std::shared_ptr objects within
-  // sequencer_map_.
-  //
-  // A single instance of std::shared_ptr isn't read/write safe
-  // from multiple threads. Since we already use a mutex to serialize
-  // concurrent read/write access to sequencer_map_, it is natural to just
-  // continue to hold that mutex after lookup while updating, or instantiating a
-  // thread local copy of, the contained std::shared_ptrs.
-  //
-  // NOTE: If we see contention on this mutex, sharding the map should
-  //       be an easy remedy (assuming the contention is not on specific
-  //       logs).
-  folly::SharedMutex sequencer_map_mutex_;
+  // Sequencers are only ever added to the map, never replaced or removed, so
+  // the std::shared_ptr objects within it are never written after insertion
+  // and lookups on the append path can copy them without a lock.
+  // ConcurrentHashMap's reads are wait-free and protected by hazard pointers,
+  // so findSequencer() doesn't bounce a shared lock word between the cores
+  // of all Workers running appends.
   SequencerMap sequencer_map_;
 
+  // Serializes creation of Sequencer objects in activateSequencer(), so that
+  // only one is created per log.  Not taken by lookups.
+  std::mutex sequencer_creation_mutex_;
+
   // cluster config used by the Processor that owns this object
   std::shared_ptr<UpdateableConfig> updateable_config_;
 
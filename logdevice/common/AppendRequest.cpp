@@ -14,6 +14,8 @@
 #include <folly/synchronization/Baton.h>
 
 #include "logdevice/common/AppendProbeController.h"
+#include "logdevice/common/AppendWindows.h"
+#include "logdevice/common/Checksum.h"
 #include "logdevice/common/MetaDataLog.h"
 #include "logdevice/common/Processor.h"
 #include "logdevice/common/Sender.h"
@@ -122,6 +124,15 @@ AppendRequest::~AppendRequest() {
     status_ = E::SHUTDOWN;
   }
 
+  if (window_state_ == WindowState::ADMITTED) {
+    w->appendWindows().onAppendDone(
+        record_.logid,
+        status_,
+        std::max<size_t>(getSettings().client_append_window, 1));
+  } else if (window_state_ == WindowState::QUEUED) {
+    w->appendWindows().cancel(record_.logid, id_);
+  }
+
   Status client_status = translateInternalError(status_);
 
   StatsHolder* stats = w->stats();
@@ -181,6 +192,24 @@ Request::Execution AppendRequest::execute() {
   // milliseconds pass
   setupTimer();
 
+  const size_t max_window = getSettings().client_append_window;
+  if (max_window > 0 && usesAppendWindow()) {
+    if (!Worker::onThisThread()->appendWindows().admit(
+            record_.logid, id_, max_window)) {
+      // The timeout keeps running while we wait for a slot.
+      window_state_ = WindowState::QUEUED;
+      return Execution::CONTINUE;
+    }
+    window_state_ = WindowState::ADMITTED;
+  }
+
+  start();
+
+  // ownership was already transferred to runningAppends
+  return Execution::CONTINUE;
+}
+
+void AppendRequest::start() {
   // kick off the state machine
   if (bypass_write_token_check_) {
     // No need to fetch log config in this case
@@ -188,9 +217,19 @@ Request::Execution AppendRequest::execute() {
   } else {
     fetchLogConfig();
   }
+}
 
-  // ownership was already transferred to runningAppends
-  return Execution::CONTINUE;
+void AppendRequest::resumeAfterWindowWait(request_id_t rqid) {
+  auto& runningAppends = Worker::onThisThread()->runningAppends().map;
+  auto it = runningAppends.find(rqid);
+  // Appends leave the queue when they're destroyed.
+  ld_check(it != runningAppends.end());
+  if (it != runningAppends.end()) {
+    auto rq = checked_downcast<AppendRequest*>(it->second.get());
+    ld_check(rq->window_state_ == WindowState::QUEUED);
+    rq->window_state_ = WindowState::ADMITTED;
+    rq->start();
+  }
 }
 
 void AppendRequest::setupTimer() {
@@ -334,8 +373,20 @@ std::unique_ptr<APPEND_Message> AppendRequest::createAppendMessage() {
       uint32_t(std::min<decltype(timeout_)::rep>(timeout_.count(), UINT_MAX)),
       append_flags};
 
-  return std::make_unique<APPEND_Message>(
+  auto msg = std::make_unique<APPEND_Message>(
       header, previous_lsn_, attrs_, payload_);
+  if (payload_checksum_bits_ != 0) {
+    msg->setPayloadChecksum(payload_checksum_bits_, payload_checksum_);
+  }
+  return msg;
+}
+
+void AppendRequest::precomputeChecksum(int checksum_bits) {
+  ld_check(checksum_bits == 32 || checksum_bits == 64);
+  Slice payload(payload_.getPayload());
+  payload_checksum_ = checksum_bits == 64 ? checksum_64bit(payload)
+                                          : checksum_32bit(payload);
+  payload_checksum_bits_ = checksum_bits;
 }
 
 void AppendRequest::sendAppendMessage() {
@@ -723,6 +774,9 @@ APPEND_flags_t AppendRequest::getAppendFlags() {
   if (payload_group_flag_) {
     append_flags |= APPEND_Header::PAYLOAD_GROUP;
   }
+  if (e2e_traced_flag_) {
+    append_flags |= APPEND_Header::E2E_TRACED;
+  }
   if (sequencer_router_flags_ & SequencerRouter::REDIRECT_CYCLE) {
     // `sequencer_node_' is part of a redirection cycle. Include the NO_REDIRECT
     // flags to break it.
@@ -103,6 +103,12 @@ class AppendRequest : public AppendRequestBase,
     return target_worker_.val_;
   }
 
+  /**
+   * Called by AppendWindows when append `rqid', queued because the window of
+   * its log was full, got a slot.  Starts the append if it's still running.
+   */
+  static void resumeAfterWindowWait(request_id_t rqid);
+
   /**
    * Called when Configuration::getLogByIDAsync() returns with the log config.
    */
@@ -164,10 +170,25 @@ class AppendRequest : public AppendRequestBase,
     payload_group_flag_ = true;
   }
 
+  /**
+   * Computes the checksum of the payload on the calling thread. Meant to be
+   * called on the client thread before the request is posted, so that the
+   * Worker doesn't compute it when serializing the APPEND message (and again
+   * on every resend). Settings::checksum_bits is still what decides whether
+   * a checksum is sent; this one is only used if its size matches.
+   */
+  void precomputeChecksum(int checksum_bits);
+
   bool getPayloadGroupFlag() const {
     return payload_group_flag_;
   }
 
+  // Marks the record as sampled for end-to-end latency tracing, see
+  // Settings::e2e_latency_sampling_rate.
+  void setE2ETracedFlag() {
+    e2e_traced_flag_ = true;
+  }
+
   void setFailedToPost() {
     failed_to_post_ = true;
   }
@@ -289,6 +310,12 @@ class AppendRequest : public AppendRequestBase,
   // Returns the set of flags that included in APPEND messages.
   virtual APPEND_flags_t getAppendFlags();
 
+  // Whether this append counts against the window of its log
+  // (see AppendWindows).
+  virtual bool usesAppendWindow() const {
+    return true;
+  }
+
   /*
    * Including protected accessors to expose read/write access to private fields
    * from child class (mainly StreamAppendRequest). In cases where copy
@@ -385,6 +412,14 @@ class AppendRequest : public AppendRequestBase,
   // have PAYLOAD_GROUP flag set in APPEND_Header.
   bool payload_group_flag_ = false;
 
+  // Appends sampled for end-to-end latency tracing should have the E2E_TRACED
+  // flag set in APPEND_Header.
+  bool e2e_traced_flag_ = false;
+
+  // See precomputeChecksum(). 0 if not precomputed.
+  int payload_checksum_bits_ = 0;
+  uint64_t payload_checksum_ = 0;
+
   bool bypass_write_token_check_ = false;
 
   // keeps track of whether the append response had the REDIRECT_NOT_ALIVE flag
@@ -393,6 +428,10 @@ class AppendRequest : public AppendRequestBase,
   // Control whether e2e tracing is on
   bool is_traced_ = false;
 
+  // Where this append is in the window of its log, see AppendWindows.
+  enum class WindowState { NONE, QUEUED, ADMITTED };
+  WindowState window_state_ = WindowState::NONE;
+
   // This thread-local is set on *client* threads. Processor::postRequest()
   // executing on a client thread will pass this request object to Worker
   // whose index is a function of clientThreadId and the log id. This
@@ -406,6 +445,9 @@ class AppendRequest : public AppendRequestBase,
 
   void onWriteTokenCheckDone();
 
+  // Fetches the log config, or skips right to onWriteTokenCheckDone().
+  void start();
+
   // We found the sequencer, consulted AppendProbeController and it instructed
   // us to send a probe.  This method sends an APPEND_PROBE message to the
   // sequencer; the state machine waits for onProbeReply() to be invoked.
@@ -0,0 +1,161 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/AppendWindows.h"
+
+#include <algorithm>
+
+#include "logdevice/common/debug.h"
+#include "logdevice/common/stats/Stats.h"
+
+namespace facebook { namespace logdevice {
+
+bool AppendWindows::isBackpressure(Status status) {
+  switch (status) {
+    case E::SEQNOBUFS:
+    case E::OVERLOADED:
+    case E::SEQSYSLIMIT:
+    case E::TIMEDOUT:
+      return true;
+    default:
+      return false;
+  }
+}
+
+size_t AppendWindows::limit(const LogWindow& w, size_t max_window) {
+  // The maximum may have been lowered since the window was last adjusted.
+  return std::min(std::max(size_t(w.window), size_t(1)), max_window);
+}
+
+bool AppendWindows::admit(logid_t log,
+                          request_id_t rqid,
+                          size_t max_window) {
+  ld_check(max_window > 0);
+  auto it = logs_.find(log);
+  if (it == logs_.end()) {
+    it = logs_.emplace(log, LogWindow{double(max_window)}).first;
+  }
+  LogWindow& w = it->second;
+  // Appends that are already waiting go first.
+  if (w.queued.empty() && w.in_flight < limit(w, max_window)) {
+    ++w.in_flight;
+    ++w.admitted;
+    return true;
+  }
+  w.queued.push_back(rqid);
+  STAT_INCR(stats_, client.append_window_queued);
+  return false;
+}
+
+void AppendWindows::onAppendDone(logid_t log,
+                                 Status status,
+                                 size_t max_window) {
+  auto it = logs_.find(log);
+  if (it == logs_.end()) {
+    // The window was disabled and re-enabled while the append was running.
+    return;
+  }
+  LogWindow& w = it->second;
+  ld_check(w.in_flight > 0);
+  max_window_ = max_window;
+  --w.in_flight;
+  ++w.completed;
+
+  if (status == E::OK) {
+    w.window = std::min(w.window + 1.0 / w.window, double(max_window));
+  } else if (isBackpressure(status) && w.completed > w.recover_until) {
+    // Appends that were already in flight likely all see the same overload,
+    // only react to the first of them.
+    w.window = std::max(w.window / 2, 1.0);
+    w.recover_until = w.admitted;
+    STAT_INCR(stats_, client.append_window_decreased);
+  }
+
+  if (!w.queued.empty()) {
+    logs_to_resume_.insert(log);
+    scheduleResume();
+  } else {
+    maybeErase(log, max_window);
+  }
+}
+
+void AppendWindows::cancel(logid_t log, request_id_t rqid) {
+  auto it = logs_.find(log);
+  if (it == logs_.end()) {
+    return;
+  }
+  auto& queued = it->second.queued;
+  auto pos = std::find(queued.begin(), queued.end(), rqid);
+  if (pos != queued.end()) {
+    queued.erase(pos);
+  }
+}
+
+request_id_t AppendWindows::admitNext(logid_t log, size_t max_window) {
+  auto it = logs_.find(log);
+  if (it == logs_.end()) {
+    return REQUEST_ID_INVALID;
+  }
+  LogWindow& w = it->second;
+  if (w.queued.empty() || w.in_flight >= limit(w, max_window)) {
+    return REQUEST_ID_INVALID;
+  }
+  request_id_t rqid = w.queued.front();
+  w.queued.pop_front();
+  ++w.in_flight;
+  ++w.admitted;
+  return rqid;
+}
+
+void AppendWindows::scheduleResume() {
+  if (!resume_timer_.isAssigned()) {
+    resume_timer_.assign([this] { resumeQueued(); });
+  }
+  if (!resume_timer_.isActive()) {
+    resume_timer_.activate(std::chrono::microseconds(0));
+  }
+}
+
+void AppendWindows::resumeQueued() {
+  auto logs = std::move(logs_to_resume_);
+  logs_to_resume_.clear();
+  for (logid_t log : logs) {
+    request_id_t rqid;
+    while ((rqid = admitNext(log, max_window_)) != REQUEST_ID_INVALID) {
+      // May complete the append, and modify logs_, synchronously.
+      resume_(rqid);
+    }
+  }
+}
+
+void AppendWindows::maybeErase(logid_t log, size_t max_window) {
+  auto it = logs_.find(log);
+  if (it == logs_.end()) {
+    return;
+  }
+  const LogWindow& w = it->second;
+  if (w.in_flight == 0 && w.queued.empty() && w.window >= max_window) {
+    logs_.erase(it);
+  }
+}
+
+double AppendWindows::getWindow(logid_t log) const {
+  auto it = logs_.find(log);
+  return it == logs_.end() ? 0 : it->second.window;
+}
+
+size_t AppendWindows::getInFlight(logid_t log) const {
+  auto it = logs_.find(log);
+  return it == logs_.end() ? 0 : it->second.in_flight;
+}
+
+size_t AppendWindows::getQueued(logid_t log) const {
+  auto it = logs_.find(log);
+  return it == logs_.end() ? 0 : it->second.queued.size();
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,124 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "logdevice/common/Timer.h"
+#include "logdevice/common/types_internal.h"
+#include "logdevice/include/types.h"
+
+namespace facebook { namespace logdevice {
+
+class StatsHolder;
+
+/**
+ * @file Per-log windows of APPENDs that a client Worker has in flight.  All
+ *       appends to a log from one client thread run on the same Worker, so
+ *       the window bounds how many of them a sequencer sees at a time.
+ *
+ *       The window starts at the configured maximum (--client-append-window)
+ *       and adapts AIMD-style: it's halved when the sequencer pushes back,
+ *       once for all the appends that were in flight at the time, and grows
+ *       by one per window of successful appends.  Appends that don't fit wait
+ *       in FIFO order and are resumed, never from the completion of another
+ *       append directly, but from a zero-delay timer.
+ *
+ *       Not thread-safe, owned by Worker.
+ */
+
+class AppendWindows {
+ public:
+  // Called to start an append that was queued by admit().
+  using ResumeCallback = std::function<void(request_id_t)>;
+
+  explicit AppendWindows(ResumeCallback resume = nullptr,
+                         StatsHolder* stats = nullptr)
+      : resume_(std::move(resume)), stats_(stats) {}
+
+  virtual ~AppendWindows() {}
+
+  /**
+   * Takes a slot in the window of `log' for append `rqid'.
+   *
+   * @param max_window  configured maximum size of the window, must be > 0
+   * @return  true if the append can be sent right away, false if it was
+   *          queued until a slot frees up
+   */
+  bool admit(logid_t log, request_id_t rqid, size_t max_window);
+
+  /**
+   * Releases the slot of an append that was admitted, adjusting the window
+   * according to the status the append completed with, and schedules
+   * resumption of queued appends that now fit.
+   */
+  void onAppendDone(logid_t log, Status status, size_t max_window);
+
+  /**
+   * Removes an append that is still queued, e.g. because it timed out.
+   */
+  void cancel(logid_t log, request_id_t rqid);
+
+  /**
+   * Admits the first queued append of `log' if it fits in the window.
+   *
+   * @return  the ID of the admitted append, or REQUEST_ID_INVALID
+   */
+  request_id_t admitNext(logid_t log, size_t max_window);
+
+  // Current size of the window of `log', 0 if no window is tracked for it.
+  double getWindow(logid_t log) const;
+
+  size_t getInFlight(logid_t log) const;
+
+  size_t getQueued(logid_t log) const;
+
+  // Statuses that indicate the sequencer is overloaded.
+  static bool isBackpressure(Status status);
+
+ protected:
+  // Arranges for resumeQueued() to be called soon.  Tests can override.
+  virtual void scheduleResume();
+
+  // Resumes all queued appends that fit.
+  void resumeQueued();
+
+ private:
+  struct LogWindow {
+    double window;
+    size_t in_flight{0};
+    // Appends admitted and completed so far.
+    uint64_t admitted{0};
+    uint64_t completed{0};
+    // Value of `admitted' when the window was last decreased.  Backpressure
+    // on appends admitted before that was already reacted to.
+    uint64_t recover_until{0};
+    std::deque<request_id_t> queued;
+  };
+
+  static size_t limit(const LogWindow& w, size_t max_window);
+
+  // Drops the state of `log' if nothing remains to remember about it.
+  void maybeErase(logid_t log, size_t max_window);
+
+  ResumeCallback resume_;
+  StatsHolder* stats_;
+
+  std::unordered_map<logid_t, LogWindow, logid_t::Hash> logs_;
+
+  // Logs with queued appends that may now fit in their window.
+  std::unordered_set<logid_t, logid_t::Hash> logs_to_resume_;
+  // Maximum window size passed to the last onAppendDone() call.
+  size_t max_window_{0};
+  Timer resume_timer_;
+};
+
+}} // namespace facebook::logdevice
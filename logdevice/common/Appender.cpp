@@ -29,12 +29,14 @@
 #include "logdevice/common/Sender.h"
 #include "logdevice/common/Sequencer.h"
 #include "logdevice/common/TailRecord.h"
+#include "logdevice/common/ThreadLocalFreeList.h"
 #include "logdevice/common/TraceLogger.h"
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/WorkerTimeoutStats.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/common/protocol/APPENDED_Message.h"
 #include "logdevice/common/protocol/DELETE_Message.h"
+#include "logdevice/common/protocol/PayloadCompression.h"
 #include "logdevice/common/protocol/RELEASE_Message.h"
 #include "logdevice/common/protocol/STORED_Message.h"
 #include "logdevice/common/protocol/STORE_Message.h"
@@ -57,6 +59,13 @@ static const std::chrono::milliseconds LOG_IF_APPEND_TOOK_LONGER_THAN =
     std::chrono::seconds(20);
 static const int LOG_IF_WAVE_ABOVE = 7;
 
+// Whether STORE round trip times should be recorded in WorkerTimeoutStats.
+static bool trackStoreLatency(Worker* worker) {
+  return worker &&
+      (worker->updateable_settings_->enable_store_histogram_calculations ||
+       worker->updateable_settings_->latency_aware_copyset_selection);
+}
+
 Appender::Appender(Worker* worker,
                    std::shared_ptr<TraceLogger> trace_logger,
                    std::chrono::milliseconds client_timeout,
@@ -116,6 +125,32 @@ Appender::Appender(Worker* worker,
                full_appender_size,
                LSN_INVALID) {}
 
+void* Appender::operator new(size_t size) {
+  if (size == sizeof(Appender)) {
+    void* ptr = ThreadLocalFreeList<Appender>::get();
+    if (ptr != nullptr) {
+      WORKER_STAT_INCR(appender_pool_hits);
+      WORKER_STAT_DECR(appender_pool_cached);
+      return ptr;
+    }
+    WORKER_STAT_INCR(appender_pool_misses);
+  }
+  return ::operator new(size);
+}
+
+void Appender::operator delete(void* ptr, size_t size) {
+  // Only cache on workers: other threads (e.g. in tests) may never allocate
+  // another Appender. The last Appenders may be destroyed while the Worker is
+  // shutting down, in which case the cached blocks are freed on thread exit.
+  if (size == sizeof(Appender) && Worker::onThisThread(false) != nullptr &&
+      ThreadLocalFreeList<Appender>::put(
+          ptr, Worker::settings().appender_pool_size)) {
+    WORKER_STAT_INCR(appender_pool_cached);
+    return;
+  }
+  ::operator delete(ptr);
+}
+
 Appender::~Appender() {
   if (started()) {
     ld_spew(
@@ -174,6 +209,16 @@ int Appender::sendSTORE(const StoreChainLink copyset[],
   if (block_starting_lsn.has_value()) {
     store_msg->setBlockStartingLSN(block_starting_lsn.value());
   }
+  const Settings& settings = getSettings();
+  if (settings.network_payload_compression != Compression::NONE &&
+      !payload_.empty() &&
+      payload_.size() >= settings.network_payload_compression_min_size) {
+    if (!compressed_payload_cache_) {
+      compressed_payload_cache_ =
+          std::make_shared<payload_compression::CompressedPayloadCache>();
+    }
+    store_msg->setCompressedPayloadCache(compressed_payload_cache_);
+  }
 
   ld_debug("%s-sending a STORE message for record %s (wave %u) to %s. "
            "Copyset is %s.",
@@ -564,6 +609,9 @@ int Appender::sendWave() {
 
   cancelStoreTimer();
 
+  wave_send_time_ = std::chrono::steady_clock::now();
+  stage_times_.copies.clear();
+
   int rv = trySendingWavesOfStores(cfg_synced, cfg_extras, append_ctx);
 
   if (replies_expected_ < recipients_.getReplication()) {
@@ -682,6 +730,17 @@ int Appender::start(std::shared_ptr<EpochSequencer> epoch_sequencer,
 
   STAT_INCR(getStats(), appender_start);
 
+  start_time_ = std::chrono::steady_clock::now();
+  stage_times_.sequencer_queue_us = usec_since(creation_time_);
+  HISTOGRAM_ADD(getStats(),
+                append_stage_sequencer_queue,
+                stage_times_.sequencer_queue_us);
+  if (getSettings().append_stage_times) {
+    // Set after prepareTailRecord() so that the flag doesn't get into the
+    // tail record.
+    store_hdr_.flags |= STORE_Header::STAGE_TIMES;
+  }
+
   // Test only setting to disallow appender from retiring. We skip sending the
   // copies to the storage nodes and hence stay in the started stage until
   // someone will abort this appender.
@@ -1073,7 +1132,8 @@ void Appender::sendError(Status reason) {
       backlog_duration_,
       started() ? store_hdr_.wave : 0,
       std::string(error_name(client_code)),
-      std::string(error_name(reason)));
+      std::string(error_name(reason)),
+      stage_times_);
 
   sendReply(LSN_INVALID, client_code);
 }
@@ -1131,8 +1191,7 @@ void Appender::onTimeout() {
   }
 
   auto worker = Worker::onThisThread(false);
-  if (worker &&
-      worker->updateable_settings_->enable_store_histogram_calculations) {
+  if (trackStoreLatency(worker)) {
     if (store_hdr_.flags & STORE_Header::CHAIN) {
       worker->getWorkerTimeoutStats().onReply(
           recipients_.getFirstOutstandingRecipient(), store_hdr_);
@@ -1219,8 +1278,7 @@ void Appender::onChainForwardingFailure(unsigned int index) {
 
 void Appender::onCopySent(Status st, ShardID to, const STORE_Header& mhdr) {
   auto worker = Worker::onThisThread(false);
-  if (worker &&
-      worker->updateable_settings_->enable_store_histogram_calculations) {
+  if (trackStoreLatency(worker)) {
     worker->getWorkerTimeoutStats().onCopySent(st, to, mhdr);
   }
 
@@ -1329,10 +1387,10 @@ void Appender::setNotAvailableShard(ShardID shard,
 
 int Appender::onReply(const STORED_Header& header,
                       ShardID from,
-                      ShardID rebuildingRecipient) {
+                      ShardID rebuildingRecipient,
+                      const StoreStageTimes* stage_times) {
   auto worker = Worker::onThisThread(false);
-  if (worker &&
-      worker->updateable_settings_->enable_store_histogram_calculations) {
+  if (trackStoreLatency(worker)) {
     worker->getWorkerTimeoutStats().onReply(from, store_hdr_);
   }
 
@@ -1358,6 +1416,11 @@ int Appender::onReply(const STORED_Header& header,
     STAT_INCR(getStats(), node_overloaded_received);
   }
 
+  if ((header.flags & STORED_Header::OVERLOADED) ||
+      header.status == E::DROPPED || header.status == E::NOSPC) {
+    noteWindowBackpressure();
+  }
+
   // If store succeeded, add to `nodes_stored_amendable_' set.
   // Doing this before the wave staleness check because this information
   // is useful even if we are getting a late reply to a previous wave.
@@ -1466,6 +1529,10 @@ int Appender::onReply(const STORED_Header& header,
       }
     }
 
+    if (stage_times) {
+      noteStoreStageTimes(from, *stage_times);
+    }
+
     onRecipientSucceeded(recipient);
     // `this` may no longer exist here.
     return 0;
@@ -1763,7 +1830,17 @@ void Appender::onRecipientSucceeded(Recipient* recipient) {
   ld_check(!reply_sent_);
   // record the latency of this append
   HISTOGRAM_ADD(getStats(), append_latency, usec_since(creation_time_));
+  fully_replicated_time_ = std::chrono::steady_clock::now();
+  stage_times_.store_us = usec_since(start_time_);
+  HISTOGRAM_ADD(getStats(), append_stage_store, stage_times_.store_us);
   int64_t latency_usec = usec_since(creation_time_);
+  const auto latency_target = getSettings().sequencer_window_latency_target;
+  if (latency_target.count() > 0 &&
+      std::chrono::microseconds(latency_usec) > latency_target) {
+    noteWindowBackpressure();
+  } else if (!window_backpressure_reported_) {
+    noteWindowFeedback(false);
+  }
   const Sockaddr& client_sock_addr =
       Sender::sockaddrOrInvalid(Address(reply_to_));
   tracer_.traceAppend(
@@ -1779,7 +1856,8 @@ void Appender::onRecipientSucceeded(Recipient* recipient) {
       backlog_duration_,
       started() ? store_hdr_.wave : 0,
       std::string(error_name(E::OK)),
-      std::string(error_name(E::OK)));
+      std::string(error_name(E::OK)),
+      stage_times_);
   if (std::chrono::microseconds(latency_usec) >
       LOG_IF_APPEND_TOOK_LONGER_THAN) {
     RATELIMIT_WARNING(
@@ -2061,6 +2139,12 @@ void Appender::onReaped() {
     schedulePeriodicReleases();
   }
 
+  if (fully_replicated_time_ != std::chrono::steady_clock::time_point()) {
+    HISTOGRAM_ADD(getStats(),
+                  append_stage_release,
+                  usec_since(fully_replicated_time_));
+  }
+
   bool need_to_reply = isWriteStreamAppend() && !isDone(REPLIED);
   bool deleted = deleteIfDone(REAPED);
 
@@ -2195,6 +2279,35 @@ bool Appender::epochMetaDataAvailable(epoch_t epoch) const {
   return epoch_sequencer_->epochMetaDataAvailable(epoch);
 }
 
+bool Appender::noteWindowFeedback(bool backpressure) {
+  if (!epoch_sequencer_ || !getSettings().sequencer_window_adaptive) {
+    return false;
+  }
+  return epoch_sequencer_->noteWindowFeedback(
+      store_hdr_.rid.lsn(), backpressure);
+}
+
+void Appender::noteWindowBackpressure() {
+  if (window_backpressure_reported_) {
+    return;
+  }
+  window_backpressure_reported_ = true;
+  if (noteWindowFeedback(true)) {
+    STAT_INCR(getStats(), sequencer_window_decreased);
+  }
+}
+
+void Appender::noteStoreStageTimes(ShardID from,
+                                   const StoreStageTimes& stage_times) {
+  // Round trip as seen from here, minus what the storage node accounted for.
+  // For chain-sent copies this includes forwarding through the chain.
+  const int64_t network_us =
+      std::max<int64_t>(0, usec_since(wave_send_time_) - stage_times.total_us);
+  HISTOGRAM_ADD(getStats(), append_stage_store_network, network_us);
+  stage_times_.copies.push_back(AppendStageTimes::Copy{
+      from, network_us, stage_times.queue_us, stage_times.write_us});
+}
+
 void Appender::setNotAvailableUntil(
     ShardID shard,
     std::chrono::steady_clock::time_point until_time,
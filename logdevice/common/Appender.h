@@ -74,6 +74,10 @@ namespace facebook { namespace logdevice {
  *      wave.
  */
 
+namespace payload_compression {
+class CompressedPayloadCache;
+}
+
 class EpochSequencer;
 class PayloadHolder;
 class SenderBase;
@@ -130,6 +134,16 @@ class Appender : public IntrusiveUnorderedMapHook {
 
   virtual ~Appender();
 
+  /**
+   * Appenders are allocated from a per-thread cache of freed Appenders (see
+   * ThreadLocalFreeList and Settings::appender_pool_size), so that a
+   * sequencer under a steady append load mostly doesn't go to the allocator
+   * for them. Subclasses have a different size and fall through to the
+   * global operators.
+   */
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size);
+
   /**
    * Reason for the retirement of the Appender. Used to determine actions when
    * the appender retires.
@@ -398,7 +412,8 @@ class Appender : public IntrusiveUnorderedMapHook {
    */
   int onReply(const STORED_Header& header,
               ShardID from,
-              ShardID rebuildingRecipient = ShardID());
+              ShardID rebuildingRecipient = ShardID(),
+              const StoreStageTimes* stage_times = nullptr);
 
   const PayloadHolder* getPayload() const {
     return &payload_;
@@ -772,6 +787,9 @@ class Appender : public IntrusiveUnorderedMapHook {
   bool preempted_{false};
   // the number of outstanding STORE responses
   int outstanding_{0};
+  // true once push back from storage nodes was reported to the adaptive
+  // window of the epoch, so only one decrease is attributed to this append
+  bool window_backpressure_reported_{false};
 
   // the number of replies in the most recent wave that we need to have
   // SYNCED set in .flags, indicating that the copy was synced to disk
@@ -806,6 +824,12 @@ class Appender : public IntrusiveUnorderedMapHook {
   // payload of record we are appending.
   PayloadHolder payload_;
 
+  // The payload compressed for the wire, shared by the STOREs of all
+  // recipients and waves so it's compressed once.  Only created if network
+  // payload compression is on and the payload is large enough.
+  std::shared_ptr<payload_compression::CompressedPayloadCache>
+      compressed_payload_cache_;
+
   // tail record for this append, will pass to sequencer when this appender
   // is reaped
   std::shared_ptr<TailRecord> tail_record_;
@@ -813,6 +837,15 @@ class Appender : public IntrusiveUnorderedMapHook {
   // time when the appender was created, used to calculate the latency
   std::chrono::steady_clock::time_point creation_time_;
 
+  // when the appender got an LSN, when it sent its latest wave and when the
+  // record got fully replicated; for the append_stage_* histograms
+  std::chrono::steady_clock::time_point start_time_;
+  std::chrono::steady_clock::time_point wave_send_time_;
+  std::chrono::steady_clock::time_point fully_replicated_time_;
+
+  // breakdown of the append latency for tracer_
+  AppendStageTimes stage_times_;
+
   // deadline after which the client is presumed to have timed out. If the
   // epoch to which this Appender belongs (store_hdr_.epoch) is shut down
   // after this deadline, the appender may abort the request without sending
@@ -1069,6 +1102,15 @@ class Appender : public IntrusiveUnorderedMapHook {
                                   epoch_t* last_released_epoch_out,
                                   bool* lng_changed_out);
   virtual bool epochMetaDataAvailable(epoch_t epoch) const;
+  // Reports storage feedback on this append to the epoch's adaptive window,
+  // see EpochSequencer::noteWindowFeedback().  No-op unless
+  // --sequencer-window-adaptive is set.
+  virtual bool noteWindowFeedback(bool backpressure);
+  // Does the above once per Appender for storage node push back.
+  void noteWindowBackpressure();
+  // Adds the stages a storage node reported for its copy of the record to
+  // stage_times_ and the append_stage_store_network histogram.
+  void noteStoreStageTimes(ShardID from, const StoreStageTimes& stage_times);
 
   virtual void
   setNotAvailableUntil(ShardID shard,
@@ -75,6 +75,12 @@ void AppenderPrep::execute(std::unique_ptr<Appender> appender) {
   // bit of the logid to find the data log sequencer
   const logid_t datalog_id = MetaDataLog::dataLogID(header_.logid);
 
+  if (from_.valid()) {
+    // Charged to the client whether or not the append succeeds.
+    CLIENT_RESOURCE_ADD(
+        stats(), append_bytes, getPrincipal(), appender->getPayload()->size());
+  }
+
   std::shared_ptr<Sequencer> sequencer = findSequencer(datalog_id);
   ld_check(sequencer || err == E::NOSEQUENCER);
 
@@ -200,6 +206,20 @@ void AppenderPrep::onSequencerNodeFound(Status st,
     return;
   }
 
+  if (sequencer && seq_node.index() == getMyNodeID().index() &&
+      !(header_.flags & (APPEND_Header::NO_REDIRECT |
+                         APPEND_Header::REACTIVATE_IF_PREEMPTED))) {
+    // Sequencer rebalancing moved the log off this node. Send the append to
+    // the node it picked, as long as that node can take it.
+    const NodeID rebalanced_to = sequencer->getRebalancedTo();
+    if (rebalanced_to.isNodeID() && isAlive(rebalanced_to) &&
+        !isBoycotted(rebalanced_to)) {
+      STAT_INCR(stats(), append_redirected_rebalanced);
+      sendRedirect(appender.get(), rebalanced_to, E::REDIRECTED);
+      return;
+    }
+  }
+
   Decision redirect_decision = shouldRedirect(seq_node, sequencer.get());
   if (redirect_decision == Decision::REDIRECT) {
     // `seq_node' should handle writes for this log instead
@@ -404,12 +424,13 @@ std::unique_ptr<Appender> AppenderPrep::constructAppender() {
           APPEND_Header::CHECKSUM_PARITY == STORE_Header::CHECKSUM_PARITY &&
           APPEND_Header::BUFFERED_WRITER_BLOB ==
               STORE_Header::BUFFERED_WRITER_BLOB &&
-          APPEND_Header::PAYLOAD_GROUP == STORE_Header::PAYLOAD_GROUP,
+          APPEND_Header::PAYLOAD_GROUP == STORE_Header::PAYLOAD_GROUP &&
+          APPEND_Header::E2E_TRACED == STORE_Header::E2E_TRACED,
       "");
   STORE_flags_t passthru_flags = header_.flags &
       (APPEND_Header::CHECKSUM | APPEND_Header::CHECKSUM_64BIT |
        APPEND_Header::CHECKSUM_PARITY | APPEND_Header::BUFFERED_WRITER_BLOB |
-       APPEND_Header::PAYLOAD_GROUP);
+       APPEND_Header::PAYLOAD_GROUP | APPEND_Header::E2E_TRACED);
 
   // TODO: This does not account for Appender's PayloadHolder's shared segment.
   //       There is no longer a reason to calculate this externally and pass
@@ -36,7 +36,8 @@ void AppenderTracer::traceAppend(
     folly::Optional<std::chrono::seconds> backlog_duration,
     uint32_t waves,
     std::string client_status,
-    std::string internal_status) {
+    std::string internal_status,
+    const AppendStageTimes& stages) {
   auto sample_builder = [&]() -> std::unique_ptr<TraceSample> {
     auto sample = std::make_unique<TraceSample>();
     const auto& recipients = recipient_set.getRecipients();
@@ -81,6 +82,22 @@ void AppenderTracer::traceAppend(
     sample->addIntValue("waves", waves);
     sample->addNormalValue("client_status", client_status);
     sample->addNormalValue("internal_status", internal_status);
+    sample->addIntValue("stage_sequencer_queue_us", stages.sequencer_queue_us);
+    sample->addIntValue("stage_store_us", stages.store_us);
+    std::vector<std::string> copy_ids, network_us, storage_queue_us,
+        storage_write_us;
+    for (const auto& copy : stages.copies) {
+      copy_ids.push_back(copy.shard.toString());
+      network_us.push_back(std::to_string(copy.network_us));
+      storage_queue_us.push_back(std::to_string(copy.storage_queue_us));
+      storage_write_us.push_back(std::to_string(copy.storage_write_us));
+    }
+    sample->addNormVectorValue("stage_copy_ids", std::move(copy_ids));
+    sample->addNormVectorValue("stage_network_us", std::move(network_us));
+    sample->addNormVectorValue(
+        "stage_storage_queue_us", std::move(storage_queue_us));
+    sample->addNormVectorValue(
+        "stage_storage_write_us", std::move(storage_write_us));
     sample->addNormalValue("thread_name", ThreadID::getName());
     return sample;
   };
@@ -8,8 +8,10 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "logdevice/common/SampledTracer.h"
+#include "logdevice/common/ShardID.h"
 #include "logdevice/include/Err.h"
 
 namespace facebook { namespace logdevice {
@@ -20,6 +22,26 @@ struct ClientID;
 
 constexpr auto APPENDER_TRACER = "appender";
 
+/**
+ * Where an append spent its time, see the append_stage_* histograms in
+ * ServerHistograms. Durations are -1 for stages the append didn't complete.
+ */
+struct AppendStageTimes {
+  int64_t sequencer_queue_us = -1;
+  int64_t store_us = -1;
+
+  // Stages of one copy of the record, as reported by its storage node
+  struct Copy {
+    ShardID shard;
+    int64_t network_us;
+    int64_t storage_queue_us;
+    int64_t storage_write_us;
+  };
+  // Copies of the last wave whose storage nodes reported stage times (see
+  // --append-stage-times), in the order the replies arrived.
+  std::vector<Copy> copies;
+};
+
 class AppenderTracer : SampledTracer {
  public:
   explicit AppenderTracer(std::shared_ptr<TraceLogger> logger);
@@ -37,7 +59,8 @@ class AppenderTracer : SampledTracer {
                    folly::Optional<std::chrono::seconds> backlog_duration,
                    uint32_t waves,
                    std::string client_status,
-                   std::string internal_status);
+                   std::string internal_status,
+                   const AppendStageTimes& stages);
 };
 
 }} // namespace facebook::logdevice
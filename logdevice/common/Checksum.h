@@ -9,6 +9,10 @@
 
 #include "logdevice/common/types_internal.h"
 
+namespace folly {
+class IOBuf;
+}
+
 namespace facebook { namespace logdevice {
 
 /**
@@ -39,6 +43,26 @@ namespace facebook { namespace logdevice {
 uint32_t checksum_32bit(Slice slice);
 uint64_t checksum_64bit(Slice slice);
 
+/**
+ * Same as checksum_64bit() of the data in the whole IOBuf chain, without
+ * coalescing the chain first.
+ */
+uint64_t checksum_64bit(const folly::IOBuf& chain);
+
+/**
+ * Computes checksum_32bit() or checksum_64bit() of each of `n` slices and
+ * writes the results to `out`, which must have room for `n` values.
+ *
+ * For small blobs a single CRC32C is bound by the latency of the hardware
+ * instruction rather than its throughput, so the 32-bit variant interleaves
+ * several blobs through the CRC unit at once when the CPU supports it
+ * (SSE4.2 on x86_64, the CRC extension on AArch64). Results are identical to
+ * calling checksum_32bit() on each slice. The 64-bit checksum has no
+ * hardware kernel; the batched call exists so callers don't need to care.
+ */
+void checksum_32bit_batch(const Slice* slices, size_t n, uint32_t* out);
+void checksum_64bit_batch(const Slice* slices, size_t n, uint64_t* out);
+
 /**
  * Writes a binary checksum of the given blob to the given output buffer.  The
  * output buffer must be at least 8 bytes large to fit a 64-bit checksum.
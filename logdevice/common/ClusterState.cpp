@@ -143,13 +143,13 @@ void ClusterState::postUpdateToWorkers(node_index_t node_id, NodeState state) {
   });
 }
 
-void ClusterState::setNodeState(node_index_t idx,
+bool ClusterState::setNodeState(node_index_t idx,
                                 ClusterState::NodeState state) {
   ld_check(idx >= 0);
   folly::SharedMutex::ReadHolder read_lock(mutex_);
   auto node_state = node_state_map_.find(idx);
   if (node_state == node_state_map_.end()) {
-    return;
+    return false;
   }
   ClusterState::NodeState prev = node_state->second->exchange(state);
   if ((prev != state) && processor_) {
@@ -166,6 +166,7 @@ void ClusterState::setNodeState(node_index_t idx,
 
     postUpdateToWorkers(idx, state);
   }
+  return prev != state;
 }
 void ClusterState::setNodeStatus(node_index_t idx, NodeHealthStatus status) {
   ld_check(idx >= 0);
@@ -260,10 +261,12 @@ void ClusterState::onGetClusterStateDone(
     ld_error("Unable to refresh cluster state: %s", error_description(status));
   } else {
     std::vector<std::string> dead;
+    bool state_changed = false;
     for (auto& node : nodes_state) {
       auto [node_idx, new_state] =
           static_cast<std::pair<node_index_t, uint16_t>>(node);
-      setNodeState(node_idx, static_cast<ClusterState::NodeState>(new_state));
+      state_changed |= setNodeState(
+          node_idx, static_cast<ClusterState::NodeState>(new_state));
       if (nodes_configuration->isNodeInServiceDiscoveryConfig(node_idx) &&
           new_state == ClusterState::NodeState::DEAD) {
         dead.emplace_back("N" + std::to_string(node_idx));
@@ -297,6 +300,14 @@ void ClusterState::onGetClusterStateDone(
             unhealthy_tostring.size(),
             folly::join(',', unhealthy_tostring).c_str());
 
+    // Refreshes are frequent and usually report nothing new. Only wake up
+    // every worker if a node changed state or there are dead nodes whose
+    // sockets may need closing, so that the cost of a refresh scales with
+    // the amount of change rather than with the polling rate.
+    if (!state_changed && dead.empty()) {
+      return;
+    }
+
     // notify workers of the update so they can take any action
     auto cb = [&](Worker& w) {
       std::unique_ptr<Request> req =
@@ -188,7 +188,10 @@ class ClusterState {
   folly::Optional<node_index_t>
   getFirstNodeWithPred(folly::Function<bool(node_index_t)> pred) const;
 
-  void setNodeState(node_index_t idx, NodeState state);
+  /**
+   * @return true if the state of the node changed as a result of this call.
+   */
+  bool setNodeState(node_index_t idx, NodeState state);
 
   void setNodeStatus(node_index_t idx, NodeHealthStatus status);
 
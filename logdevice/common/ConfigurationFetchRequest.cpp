@@ -62,7 +62,8 @@ void ConfigurationFetchRequest::sendConfigFetch() {
       isWaitingForResponse() ? id_ : REQUEST_ID_INVALID,
       config_type_,
       (conditional_poll_version_.has_value() ? conditional_poll_version_.value()
-                                             : 0)};
+                                             : 0),
+      flags_};
 
   std::unique_ptr<Message> msg = std::make_unique<CONFIG_FETCH_Message>(hdr);
   int rv = sendMessageTo(std::move(msg), node_id_);
@@ -58,11 +58,13 @@ class ConfigurationFetchRequest : public Request {
       config_cb_t cb,
       worker_id_t cb_worker_id,
       std::chrono::milliseconds timeout,
-      folly::Optional<uint64_t> conditional_poll_version = folly::none)
+      folly::Optional<uint64_t> conditional_poll_version = folly::none,
+      CONFIG_FETCH_Header::flags_t flags = 0)
       : Request(RequestType::CONFIGURATION_FETCH),
         node_id_(node_id),
         config_type_(config_type),
         conditional_poll_version_(conditional_poll_version),
+        flags_(flags),
         cb_(std::move(cb)),
         cb_worker_id_(cb_worker_id),
         timeout_(timeout) {}
@@ -102,6 +104,7 @@ class ConfigurationFetchRequest : public Request {
   NodeID node_id_;
   CONFIG_FETCH_Header::ConfigType config_type_;
   const folly::Optional<uint64_t> conditional_poll_version_;
+  const CONFIG_FETCH_Header::flags_t flags_{0};
 
   // A callback to be called when the config is ready.
   config_cb_t cb_{};
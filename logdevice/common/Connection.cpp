@@ -340,6 +340,7 @@ int Connection::preConnectAttempt() {
   ld_check(!connected_);
   ld_check(pendingq_.empty());
   ld_check(serializeq_.empty());
+  ld_check(deferredq_.empty());
   ld_check(sendq_.empty());
   ld_check(getBytesPending() == 0);
   ld_check(connect_throttle_);
@@ -565,6 +566,25 @@ void Connection::flushSerializeQueue() {
   }
 }
 
+bool Connection::shouldDeferSend(const Envelope& envelope) const {
+  const size_t chunk_size = deps_->getSettings().socket_write_chunk_size;
+  return chunk_size > 0 && envelope.priority() != Priority::MAX &&
+      !isHandshakeMessage(envelope.message().type_) &&
+      getBufferedBytesSize() >= chunk_size;
+}
+
+void Connection::flushDeferredQueue() {
+  // send() defers a message only while the socket is at or above
+  // socket_write_chunk_size, and that's also where this loop stops, so
+  // messages from deferredq_ don't get deferred again and messages of the
+  // same priority go out in the order they were sent.
+  while (!deferredq_.empty() && !shouldDeferSend(deferredq_.front())) {
+    std::unique_ptr<Envelope> next_envelope(&deferredq_.front());
+    deferredq_.pop();
+    send(std::move(next_envelope));
+  }
+}
+
 void Connection::transitionToConnected() {
   addHandshakeTimeoutEvent();
   connected_ = true;
@@ -714,6 +734,7 @@ void Connection::close(Status reason) {
   sock_write_cb_.clear();
   sendChain_.reset();
   sched_write_chain_.cancelTimeout();
+  sched_write_chain_expedited_ = false;
   // Invoke closeNow to close the socket.
   proto_handler_->sock()->closeNow();
 
@@ -738,6 +759,7 @@ void Connection::clearConnQueues(Status close_reason) {
   // Move everything here so that this Socket object has a clean state
   // before we call any callback.
   PendingQueue moved_pendingq = std::move(pendingq_);
+  PendingQueue moved_deferredq = std::move(deferredq_);
   std::vector<EnvelopeQueue> moved_queues;
   moved_queues.emplace_back(std::move(serializeq_));
   moved_queues.emplace_back(std::move(sendq_));
@@ -748,6 +770,7 @@ void Connection::clearConnQueues(Status close_reason) {
 
   ld_check(pendingq_.empty());
   ld_check(serializeq_.empty());
+  ld_check(deferredq_.empty());
   ld_check(sendq_.empty());
   ld_check(impl_->on_close_.empty());
   ld_check(impl_->pending_bw_cbs_.empty());
@@ -759,6 +782,12 @@ void Connection::clearConnQueues(Status close_reason) {
       onSent(std::move(e), close_reason);
     }
   }
+  // Deferred messages were released after the ones in sendq_.
+  while (!moved_deferredq.empty()) {
+    std::unique_ptr<Envelope> e(&moved_deferredq.front());
+    moved_deferredq.pop();
+    onSent(std::move(e), close_reason);
+  }
 
   // Clients expect all outstanding messages to be completed prior to
   // delivering "on close" callbacks.
@@ -803,6 +832,7 @@ bool Connection::isClosed() const {
   ld_check(!connected_);
   ld_check(sendq_.empty());
   ld_check(serializeq_.empty());
+  ld_check(deferredq_.empty());
   // When the socket is getting closed the getBufferedBytesSize will be
   // incorrect as we have not cleared all the members , hence skip the
   // getBytesPending check.
@@ -839,6 +869,14 @@ std::unique_ptr<folly::IOBuf> Connection::serializeMessage(const Message& msg) {
   io_buf->advance(protohdr_bytes);
 
   ProtocolWriter writer(msg.type_, io_buf.get(), proto_);
+  const auto& settings = getSettings();
+  if (settings.network_payload_compression != Compression::NONE &&
+      settings.network_payload_compression_traffic_classes.count(msg.tc_)) {
+    writer.setPayloadCompression(
+        {settings.network_payload_compression,
+         settings.network_payload_compression_zstd_level,
+         settings.network_payload_compression_min_size});
+  }
 
   msg.serialize(writer);
   ssize_t bodylen = writer.result();
@@ -866,17 +904,42 @@ std::unique_ptr<folly::IOBuf> Connection::serializeMessage(const Message& msg) {
 }
 
 Connection::SendStatus
-Connection::sendBuffer(std::unique_ptr<folly::IOBuf>&& io_buf) {
+Connection::sendBuffer(std::unique_ptr<folly::IOBuf>&& io_buf,
+                       Priority priority) {
   if (proto_handler_->good()) {
+    const auto time_trigger = getSettings().socket_batching_time_trigger;
     if (sendChain_) {
       ld_check(sched_write_chain_.isScheduled());
-      sendChain_->prependChain(std::move(io_buf));
+      // sendChain_ is circular, prev() is the last buffer in the chain.
+      folly::IOBuf* tail = sendChain_->prev();
+      const size_t len = io_buf->length();
+      if (!io_buf->isChained() &&
+          len <= getSettings().socket_batching_coalesce_threshold &&
+          !tail->isSharedOne() && tail->tailroom() >= len) {
+        // Small message, append it to the previous one so that the batch is
+        // written with fewer iovecs and the buffer is freed right away.
+        memcpy(tail->writableTail(), io_buf->data(), len);
+        tail->append(len);
+        io_buf.reset();
+        STAT_INCR(deps_->getStats(), sock_messages_coalesced);
+      } else {
+        sendChain_->prependChain(std::move(io_buf));
+      }
+      if (priority == Priority::MAX && !sched_write_chain_expedited_ &&
+          time_trigger.count() > 0) {
+        // Don't hold the highest priority messages for the batching window.
+        sched_write_chain_.scheduleTimeout(std::chrono::milliseconds(0));
+        sched_write_chain_expedited_ = true;
+        STAT_INCR(deps_->getStats(), sock_write_expedited);
+      }
     } else {
       sendChain_ = std::move(io_buf);
       ld_check(!sched_write_chain_.isScheduled());
       sched_write_chain_.attachCallback([this]() { scheduleWriteChain(); });
-      sched_write_chain_.scheduleTimeout(
-          getSettings().socket_batching_time_trigger);
+      sched_write_chain_expedited_ = priority == Priority::MAX;
+      sched_write_chain_.scheduleTimeout(sched_write_chain_expedited_
+                                             ? std::chrono::milliseconds(0)
+                                             : time_trigger);
       sched_start_time_ = SteadyTimestamp::now();
     }
   }
@@ -900,6 +963,9 @@ void Connection::scheduleWriteChain() {
       SocketWriteCallback::WriteUnit{bytes_in_sendq, now});
   // These bytes are now buffered in socket and will be removed from sendq.
   sock_write_cb_.bytes_buffered += bytes_in_sendq;
+  sched_write_chain_expedited_ = false;
+  ++num_write_chains_;
+  STAT_INCR(deps_->getStats(), sock_write_chains);
   proto_handler_->sock()->writeChain(&sock_write_cb_, std::move(sendChain_));
   // All the bytes will be now removed from sendq now that we have written into
   // the asyncsocket.
@@ -919,7 +985,8 @@ int Connection::serializeMessage(std::unique_ptr<Envelope>&& envelope) {
   }
 
   const auto msglen = serialized_buf->computeChainDataLength();
-  Connection::SendStatus status = sendBuffer(std::move(serialized_buf));
+  Connection::SendStatus status =
+      sendBuffer(std::move(serialized_buf), msg.priority());
   if (status == Connection::SendStatus::ERROR) {
     RATELIMIT_CRITICAL(std::chrono::seconds(1),
                        2,
@@ -1055,6 +1122,15 @@ void Connection::send(std::unique_ptr<Envelope> envelope) {
   // serialized once we are handshaken. An exception is handshake messages,
   // they can be serialized as soon as we are connected.
   if (handshaken_ || (connected_ && isHandshakeMessage(msg.type_))) {
+    if (shouldDeferSend(*envelope)) {
+      // The socket has a chunk's worth of data buffered already. Hold the
+      // message back so that it's serialized ahead of any lower priority
+      // ones that arrive in the meantime. See flushDeferredQueue().
+      deferredq_.push(*envelope.release());
+      STAT_INCR(deps_->getStats(), sock_write_deferred);
+      return;
+    }
+
     // compute the message length only when 1) handshaken is completed and
     // negotiaged proto_ is known; or 2) message is a handshaken message
     // therefore its size does not depend on the protocol
@@ -1288,12 +1364,13 @@ void Connection::drainSendQueue() {
   ld_check(cb.bytes_buffered >= total_bytes_drained);
   cb.bytes_buffered -= total_bytes_drained;
   onBytesPassedToTCP(total_bytes_drained);
+  flushDeferredQueue();
 
   // flushOutputAndClose sets close_reason_ and waits for all buffers to drain.
   // Check if all buffers were drained here if that is the case close the
   // connection.
   if (close_reason_ != E::UNKNOWN && cb.write_chains.size() == 0 &&
-      !sendChain_) {
+      !sendChain_ && deferredq_.empty()) {
     close(close_reason_);
   }
 }
@@ -1559,6 +1636,14 @@ int Connection::dispatchMessageBody(ProtocolHeader header,
     handshaken_ = true;
     first_attempt_ = false;
     handshake_timeout_event_->cancelTimeout();
+    if (ph.type == MessageType::HELLO && isSSL()) {
+      // Incoming connection, the TLS handshake is done by now.
+      if (proto_handler_->sock()->getSSLSessionReused()) {
+        STAT_INCR(deps_->getStats(), ssl_accept_resumed);
+      } else {
+        STAT_INCR(deps_->getStats(), ssl_accept_full_handshake);
+      }
+    }
   }
 
   MESSAGE_TYPE_STAT_INCR(deps_->getStats(), ph.type, message_received);
@@ -1736,7 +1821,8 @@ void Connection::addHandshakeTimeoutEvent() {
 }
 
 size_t Connection::getBytesPending() const {
-  size_t queued_bytes = pendingq_.cost() + serializeq_.cost() + sendq_.cost();
+  size_t queued_bytes = pendingq_.cost() + serializeq_.cost() +
+      deferredq_.cost() + sendq_.cost();
 
   size_t buffered_bytes = getBufferedBytesSize();
 
@@ -1834,7 +1920,37 @@ void Connection::getDebugInfo(InfoSocketsTable& table) const {
       .set<11>(proto_)
       .set<12>(this->getTcpSendBufSize())
       .set<13>(isSSL())
-      .set<14>(fd_);
+      .set<14>(fd_)
+      .set<15>(num_write_chains_ == 0
+                   ? 0
+                   : 1.0 * num_messages_sent_ / num_write_chains_)
+      .set<16>(num_write_chains_ == 0 ? 0
+                                      : 1.0 * drain_pos_ / num_write_chains_)
+      .set<17>(getKernelTLSState())
+      .set<18>(principal_->accountingName());
+}
+
+std::string Connection::getKernelTLSState() const {
+  std::string res;
+#if defined(SSL_OP_ENABLE_KTLS) && !defined(OPENSSL_NO_KTLS)
+  if (!isSSL() || !proto_handler_->sock()) {
+    return res;
+  }
+  SSL* ssl = const_cast<SSL*>(proto_handler_->sock()->getSSL());
+  if (ssl == nullptr) {
+    return res;
+  }
+  // OpenSSL enables kTLS separately for each direction once the handshake
+  // installs the keys, and leaves a direction in userspace if the kernel
+  // refuses it.
+  if (BIO_get_ktls_send(SSL_get_wbio(ssl))) {
+    res = "tx";
+  }
+  if (BIO_get_ktls_recv(SSL_get_rbio(ssl))) {
+    res += res.empty() ? "rx" : "+rx";
+  }
+#endif
+  return res;
 }
 
 bool Connection::peerIsClient() const {
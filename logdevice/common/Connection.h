@@ -474,6 +474,13 @@ class Connection : public TrafficShappingSocket {
    */
   size_t getTcpSendBufSize() const;
 
+  /**
+   * @return the directions in which encryption of this connection is done by
+   *         the kernel: "tx", "rx", "tx+rx", or empty if none, e.g. if this
+   *         is a plaintext connection or ssl-ktls-offload is not set.
+   */
+  std::string getKernelTLSState() const;
+
   /**
    * Exposes the tcp recvbuf size that the socket was configured with (or the
    * OS-provided default if the setting wasn't specified).
@@ -672,10 +679,17 @@ class Connection : public TrafficShappingSocket {
     ERROR, // Hit errors when writing the bytes.
   };
   /**
-   * Writes a serialized buffer into the socket.
+   * Writes a serialized buffer into the socket. Small buffers are coalesced
+   * into the tail of the pending write chain, see
+   * Settings::socket_batching_coalesce_threshold.
+   *
+   * @param priority  Priority of the message in the buffer. Priority::MAX
+   *                  messages are written on the next event loop iteration
+   *                  regardless of socket-batching-time-trigger.
    * @returns SendStatus based on the status of the write.
    */
-  SendStatus sendBuffer(std::unique_ptr<folly::IOBuf>&& buffer_chain);
+  SendStatus sendBuffer(std::unique_ptr<folly::IOBuf>&& buffer_chain,
+                        Priority priority = Priority::MAX);
   /**
    * For asyncsocket based connections, to batch data better we schedule a zero
    * timeout event in sendBuffer. It allows to batch all the data going to same
@@ -803,6 +817,20 @@ class Connection : public TrafficShappingSocket {
    */
   void flushSerializeQueue();
 
+  /**
+   * @return true if the message in `envelope` should wait in deferredq_
+   *         rather than be serialized right away, because the socket already
+   *         has Settings::socket_write_chunk_size bytes buffered.
+   */
+  bool shouldDeferSend(const Envelope& envelope) const;
+
+  /**
+   * Serializes messages from deferredq_, highest priority first, until it's
+   * empty or the socket is back at socket_write_chunk_size bytes buffered.
+   * Called by drainSendQueue() as bytes are passed to TCP.
+   */
+  void flushDeferredQueue();
+
   /**
    * Queues up a HELLO message for delivery. The Socket must not be connected.
    * The message will be sent as soon as the connection is established.
@@ -881,6 +909,13 @@ class Connection : public TrafficShappingSocket {
   // the socket finishes handshake and is never used again.
   EnvelopeQueue serializeq_;
 
+  // Envelopes released while the socket had socket_write_chunk_size or more
+  // bytes buffered. They are serialized in priority order as the socket
+  // drains, so that a large backlog of low priority messages (e.g. RECORDs
+  // for a rebuilding reader) doesn't sit in front of a new append-path
+  // message. Priority::MAX and handshake messages are never deferred.
+  PendingQueue deferredq_;
+
   // A queue of Envelopes whose messages have been copied into bev_ but
   // bev_ have not yet fully written their contents into the underlying TCP
   // socket.
@@ -986,6 +1021,11 @@ class Connection : public TrafficShappingSocket {
   // Total number of bytes received since this socket was created.
   size_t num_bytes_received_;
 
+  // Number of write chains handed to the async socket since this socket was
+  // created. Each one is a single vectored write, so together with
+  // num_messages_sent_ and drain_pos_ this tells how well writes are batched.
+  size_t num_write_chains_{0};
+
   // Set of stats that are are used to detect low socket performance.
   struct HealthStats {
     void clear() {
@@ -1102,6 +1142,10 @@ class Connection : public TrafficShappingSocket {
   // Used to note down delays in writing into the asyncsocket.
   SteadyTimestamp sched_start_time_;
 
+  // True if sched_write_chain_ was rescheduled to fire on the next event loop
+  // iteration because a Priority::MAX message was added to sendChain_.
+  bool sched_write_chain_expedited_{false};
+
   // Momemnt of last activity happened on this connection such as
   // - connection created
   // - message sent
@@ -12,6 +12,7 @@
 
 #include <folly/Random.h>
 
+#include "logdevice/common/CopySetTable.h"
 #include "logdevice/common/NodeSetState.h"
 #include "logdevice/common/protocol/STORE_Message.h"
 
@@ -47,20 +48,44 @@ void CopySetManager::disableCopySetShuffling() {
   shuffle_copysets_ = false;
 }
 
+void CopySetManager::enableCopySetTable(size_t size) {
+  copyset_table_ = std::make_unique<CopySetTable>(size);
+}
+
+CopySetSelector::Result
+CopySetManager::selectCopySet(copyset_size_t extras,
+                              StoreChainLink copyset_out[],
+                              copyset_size_t* copyset_size_out,
+                              bool* chain_out,
+                              CopySetSelector::State* css_state) {
+  if (copyset_table_ &&
+      copyset_table_->select(*underlying_selector_,
+                             *nodeset_state_,
+                             extras,
+                             copyset_out,
+                             copyset_size_out,
+                             chain_out)) {
+    return CopySetSelector::Result::SUCCESS;
+  }
+  return underlying_selector_->select(
+      extras, copyset_out, copyset_size_out, chain_out, css_state);
+}
+
 bool CopySetManager::matchesConfig(
     const configuration::nodes::NodesConfiguration& nodes_configuration) {
-  ld_check(!full_nodeset_.empty());
-  return effective_nodeset_ ==
+  ld_check(full_nodeset_ && !full_nodeset_->empty());
+  return *effective_nodeset_ ==
       getEffectiveNodeSet(
-             full_nodeset_, *nodes_configuration.getStorageMembership());
+             *full_nodeset_, *nodes_configuration.getStorageMembership());
 }
 
 void CopySetManager::prepareConfigMatchCheck(
     StorageSet nodeset,
     const configuration::nodes::NodesConfiguration& nodes_configuration) {
-  full_nodeset_ = std::move(nodeset);
-  effective_nodeset_ = getEffectiveNodeSet(
-      full_nodeset_, *nodes_configuration.getStorageMembership());
+  auto& registry = StorageSetRegistry::instance();
+  full_nodeset_ = registry.intern(nodeset);
+  effective_nodeset_ = registry.intern(getEffectiveNodeSet(
+      *full_nodeset_, *nodes_configuration.getStorageMembership()));
 }
 
 }} // namespace facebook::logdevice
@@ -14,6 +14,7 @@
 
 #include "logdevice/common/CopySetSelector.h"
 #include "logdevice/common/NodeSetState.h"
+#include "logdevice/common/StorageSetRegistry.h"
 #include "logdevice/common/types_internal.h"
 
 namespace facebook { namespace logdevice {
@@ -26,6 +27,7 @@ namespace facebook { namespace logdevice {
  * copyset selector. The primary use of this is the StickyCopySetManager
  */
 
+class CopySetTable;
 struct StoreChainLink;
 
 class CopySetManager {
@@ -116,6 +118,10 @@ class CopySetManager {
   // Used in tests
   void disableCopySetShuffling();
 
+  // Makes getCopySet() take copysets from a table of `size` copysets drawn
+  // in advance, once the log picked that many. See CopySetTable.
+  void enableCopySetTable(size_t size);
+
   // Returns false if this CopySetManager needs to be replaced with a new one
   // to reflect config changes. More precisely, if the set of writeable storage
   // shards in nodeset has changed after prepareConfigMatchCheck() was called.
@@ -137,17 +143,28 @@ class CopySetManager {
   // the copyset helps distribute read load more evenly across the cluster
   void shuffleCopySet(StoreChainLink* copyset, int size, bool chain);
 
+  // Picks a copyset from copyset_table_ if there is one and it has a usable
+  // entry, otherwise from the underlying selector.
+  CopySetSelector::Result selectCopySet(copyset_size_t extras,
+                                        StoreChainLink copyset_out[],
+                                        copyset_size_t* copyset_size_out,
+                                        bool* chain_out,
+                                        CopySetSelector::State* css_state);
+
   std::unique_ptr<CopySetSelector> underlying_selector_;
   std::shared_ptr<NodeSetState> nodeset_state_;
 
   bool shuffle_copysets_{true}; // when false, copysets will not be shuffled
 
+  std::unique_ptr<CopySetTable> copyset_table_;
+
   // Used for handling config updates: if the nodes config has changed in such
   // a way that effective_nodeset_ is not correct anymore, we need to create
-  // a new CopySetManager.
-  StorageSet full_nodeset_;
+  // a new CopySetManager. Both are interned in StorageSetRegistry, since most
+  // logs share their nodesets with many others.
+  StorageSetRegistry::Ptr full_nodeset_;
   // Positive-weight nodes in the nodeset.
-  StorageSet effective_nodeset_;
+  StorageSetRegistry::Ptr effective_nodeset_;
 };
 
 }} // namespace facebook::logdevice
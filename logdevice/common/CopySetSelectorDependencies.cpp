@@ -7,6 +7,8 @@
  */
 #include "logdevice/common/CopySetSelectorDependencies.h"
 
+#include "logdevice/common/Worker.h"
+
 namespace facebook { namespace logdevice {
 
 const NodeAvailabilityChecker*
@@ -14,6 +16,15 @@ CopySetSelectorDependencies::getNodeAvailability() const {
   return NodeAvailabilityChecker::instance();
 }
 
+folly::Optional<double>
+CopySetSelectorDependencies::getStoreLatency(ShardID shard) const {
+  Worker* w = Worker::onThisThread(false);
+  if (!w) {
+    return folly::none;
+  }
+  return w->getWorkerTimeoutStats().getStoreLatencyEWMA(shard);
+}
+
 const CopySetSelectorDependencies* CopySetSelectorDependencies::instance() {
   static CopySetSelectorDependencies d;
   return &d;
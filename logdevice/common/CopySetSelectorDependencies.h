@@ -7,7 +7,10 @@
  */
 #pragma once
 
+#include <folly/Optional.h>
+
 #include "logdevice/common/NodeAvailabilityChecker.h"
+#include "logdevice/common/ShardID.h"
 
 namespace facebook { namespace logdevice {
 
@@ -23,6 +26,12 @@ class CopySetSelectorDependencies {
    */
   virtual const NodeAvailabilityChecker* getNodeAvailability() const;
 
+  /**
+   * Recent average STORE latency of `shard' in milliseconds, as seen by the
+   * current worker. folly::none if unknown.
+   */
+  virtual folly::Optional<double> getStoreLatency(ShardID shard) const;
+
   // Returns a singleton instance.
   static const CopySetSelectorDependencies* instance();
 };
@@ -8,6 +8,7 @@
 #include "logdevice/common/CopySetSelectorFactory.h"
 
 #include "logdevice/common/CrossDomainCopySetSelector.h"
+#include "logdevice/common/LatencyAwareCopySetSelector.h"
 #include "logdevice/common/LinearCopySetSelector.h"
 #include "logdevice/common/MetaDataLog.h"
 #include "logdevice/common/PassThroughCopySetManager.h"
@@ -112,6 +113,13 @@ std::unique_ptr<CopySetManager> CopySetSelectorFactory::createManager(
              my_node_id,
              log_attrs,
              settings);
+  if (settings.latency_aware_copyset_selection) {
+    copyset_selector = std::make_unique<LatencyAwareCopySetSelector>(
+        std::move(copyset_selector),
+        settings.latency_aware_copyset_selection_threshold,
+        settings.latency_aware_copyset_selection_min_latency,
+        Worker::stats());
+  }
   std::unique_ptr<CopySetManager> res;
   if (sticky_copysets) {
     res = std::unique_ptr<CopySetManager>(
@@ -123,6 +131,11 @@ std::unique_ptr<CopySetManager> CopySetSelectorFactory::createManager(
     res = std::unique_ptr<CopySetManager>(new PassThroughCopySetManager(
         std::move(copyset_selector), nodeset_state));
   }
+  if (settings.copyset_table_size > 0 &&
+      !settings.latency_aware_copyset_selection) {
+    // Latency-aware selection needs to look at every copyset.
+    res->enableCopySetTable(settings.copyset_table_size);
+  }
   res->prepareConfigMatchCheck(epoch_metadata.shards, *nodes_configuration);
   return res;
 }
@@ -0,0 +1,146 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/CopySetTable.h"
+
+#include <mutex>
+#include <shared_mutex>
+
+#include "logdevice/common/CopySet.h"
+#include "logdevice/common/NodeSetState.h"
+#include "logdevice/common/Worker.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/stats/Stats.h"
+
+namespace facebook { namespace logdevice {
+
+using NodeStatus = NodeAvailabilityChecker::NodeStatus;
+
+// Tables aren't rebuilt more often than this because of availability changes.
+static constexpr std::chrono::seconds kMinRebuildInterval{1};
+
+CopySetTable::CopySetTable(size_t size,
+                           const CopySetSelectorDependencies* deps)
+    : size_(size), deps_(deps) {
+  ld_check(size_ > 0);
+}
+
+size_t CopySetTable::numCopySets() const {
+  std::shared_lock<folly::SharedMutex> lock(mutex_);
+  return table_ ? table_->numCopySets() : 0;
+}
+
+bool CopySetTable::needsRebuild(const Table* table,
+                                copyset_size_t extras,
+                                uint64_t nodeset_generation) const {
+  if (table == nullptr) {
+    return selections_.load() >= size_;
+  }
+  if (table->extras != extras) {
+    return true;
+  }
+  return table->nodeset_generation != nodeset_generation &&
+      now() - table->built_at >= kMinRebuildInterval;
+}
+
+std::shared_ptr<const CopySetTable::Table>
+CopySetTable::build(const CopySetSelector& selector,
+                    copyset_size_t extras,
+                    uint64_t nodeset_generation) const {
+  auto table = std::make_shared<Table>();
+  table->extras = extras;
+  table->copyset_size = selector.getReplicationFactor() + extras;
+  table->nodeset_generation = nodeset_generation;
+  table->built_at = now();
+  table->shards.reserve(size_ * table->copyset_size);
+
+  StoreChainLink copyset[COPYSET_SIZE_MAX];
+  for (size_t i = 0; i < size_; ++i) {
+    copyset_size_t size;
+    // Chaining is decided when an entry is used.
+    auto res = selector.select(extras, copyset, &size);
+    if (res != CopySetSelector::Result::SUCCESS) {
+      // Copysets without all the extras are left to the selector.
+      continue;
+    }
+    ld_check(size == table->copyset_size);
+    for (copyset_size_t j = 0; j < size; ++j) {
+      table->shards.push_back(copyset[j].destination);
+    }
+  }
+
+  if (table->numCopySets() < size_ / 2) {
+    // Too many shards are unavailable for a table to be useful.
+    return nullptr;
+  }
+  return table;
+}
+
+bool CopySetTable::select(const CopySetSelector& selector,
+                          NodeSetState& nodeset_state,
+                          copyset_size_t extras,
+                          StoreChainLink copyset_out[],
+                          copyset_size_t* copyset_size_out,
+                          bool* chain_out) {
+  std::shared_ptr<const Table> table;
+  {
+    std::shared_lock<folly::SharedMutex> lock(mutex_);
+    table = table_;
+  }
+
+  // Read the generation before building, so that changes during the build
+  // trigger another one.
+  const uint64_t generation = nodeset_state.getGeneration();
+  if (needsRebuild(table.get(), extras, generation)) {
+    bool expected = false;
+    if (building_.compare_exchange_strong(expected, true)) {
+      auto new_table = build(selector, extras, generation);
+      {
+        std::unique_lock<folly::SharedMutex> lock(mutex_);
+        table_ = new_table;
+      }
+      building_.store(false);
+      table = std::move(new_table);
+      // Without a table, wait for another `size_' selections before retrying.
+      selections_.store(0);
+      WORKER_STAT_INCR(copyset_table_builds);
+    }
+  }
+
+  if (!table || table->extras != extras) {
+    selections_++;
+    return false;
+  }
+
+  const size_t i = next_.fetch_add(1) % table->numCopySets();
+  const ShardID* shards = &table->shards[i * table->copyset_size];
+  bool chain = chain_out ? *chain_out : false;
+  for (copyset_size_t j = 0; j < table->copyset_size; ++j) {
+    StoreChainLink destination;
+    switch (deps_->getNodeAvailability()->checkNode(
+        &nodeset_state, shards[j], &destination)) {
+      case NodeStatus::AVAILABLE_NOCHAIN:
+        chain = false;
+        break;
+      case NodeStatus::AVAILABLE:
+        break;
+      case NodeStatus::NOT_AVAILABLE:
+        WORKER_STAT_INCR(copyset_table_misses);
+        return false;
+    }
+    copyset_out[j] = destination;
+  }
+
+  *copyset_size_out = table->copyset_size;
+  if (chain_out) {
+    *chain_out = chain;
+  }
+  WORKER_STAT_INCR(copyset_table_hits);
+  return true;
+}
+
+}} // namespace facebook::logdevice
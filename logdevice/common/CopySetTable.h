@@ -0,0 +1,115 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <folly/SharedMutex.h>
+
+#include "logdevice/common/CopySetSelector.h"
+#include "logdevice/common/CopySetSelectorDependencies.h"
+#include "logdevice/common/ShardID.h"
+#include "logdevice/common/types_internal.h"
+
+namespace facebook { namespace logdevice {
+
+class NodeSetState;
+
+/**
+ * @file A table of copysets drawn in advance from a copyset selector, used by
+ *       CopySetManager for logs that pick many copysets. For big nodesets and
+ *       deep location hierarchies, running the selector for every record is
+ *       a noticeable part of the cost of an append, while taking the next
+ *       entry of the table only costs checking the availability of its shards.
+ *
+ *       The table is built once the log has picked as many copysets as the
+ *       table holds, so logs that don't write much never pay for it. It's
+ *       rebuilt when the number of extras changes, or when the availability
+ *       of a shard in the nodeset changed (NodeSetState::getGeneration()),
+ *       at most once per second. In between, entries with unavailable shards
+ *       are skipped, and the caller falls back to the selector.
+ *
+ *       Entries are used in rotation, so the load is distributed like the
+ *       selector's draws, but only so many distinct copysets are used until
+ *       the next rebuild.
+ *
+ *       Thread-safe.
+ */
+
+class CopySetTable {
+ public:
+  explicit CopySetTable(size_t size,
+                        const CopySetSelectorDependencies* deps =
+                            CopySetSelectorDependencies::instance());
+
+  /**
+   * Takes the next copyset from the table, building or rebuilding the table
+   * with `selector' first if needed.  See CopySetSelector::select() for
+   * the parameters.
+   *
+   * @return  true if a copyset was written to `copyset_out', false if the
+   *          caller should use the selector: the table isn't built yet, or
+   *          the entry has unavailable shards.
+   */
+  bool select(const CopySetSelector& selector,
+              NodeSetState& nodeset_state,
+              copyset_size_t extras,
+              StoreChainLink copyset_out[],
+              copyset_size_t* copyset_size_out,
+              bool* chain_out);
+
+  // Number of copysets currently in the table.
+  size_t numCopySets() const;
+
+ protected:
+  virtual std::chrono::steady_clock::time_point now() const {
+    return std::chrono::steady_clock::now();
+  }
+
+ private:
+  struct Table {
+    copyset_size_t extras;
+    copyset_size_t copyset_size;
+    uint64_t nodeset_generation;
+    std::chrono::steady_clock::time_point built_at;
+    // Copysets one after another, copyset_size shards each.
+    std::vector<ShardID> shards;
+
+    size_t numCopySets() const {
+      return shards.size() / copyset_size;
+    }
+  };
+
+  bool needsRebuild(const Table* table,
+                    copyset_size_t extras,
+                    uint64_t nodeset_generation) const;
+
+  // @return  nullptr if the selector failed to pick most of the copysets
+  std::shared_ptr<const Table> build(const CopySetSelector& selector,
+                                     copyset_size_t extras,
+                                     uint64_t nodeset_generation) const;
+
+  const size_t size_;
+  const CopySetSelectorDependencies* deps_;
+
+  // Copysets picked so far by the caller while there was no table.
+  std::atomic<size_t> selections_{0};
+  // Index of the next entry to use, modulo the size of the table.
+  std::atomic<size_t> next_{0};
+  // Set while some thread is building the table.
+  std::atomic<bool> building_{false};
+
+  // Protects table_.
+  mutable folly::SharedMutex mutex_;
+  std::shared_ptr<const Table> table_;
+};
+
+}} // namespace facebook::logdevice
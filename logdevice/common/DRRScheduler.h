@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <chrono>
@@ -57,7 +58,10 @@
  * version a request may not actually use all the bytes it was charged. So
  * the credit() interface allows us to credit back the unused bytes. But the
  * cost of disk IO requests are not completely byte based -- there is fixed seek
- * cost. See comments on top of the 'credit' interface.
+ * cost. See comments on top of the 'credit' interface. Where the real cost of
+ * a request can be measured after the fact, e.g. as the time spent on IO, the
+ * chargeCost() interface settles it, putting the principal into debt if it
+ * used more than it was charged.
  *
  * The actual number of requests in flight is determined by the number of
  * threads processing the queues. In general, there is better control on
@@ -142,12 +146,15 @@ class DRRScheduler {
   class DRRQueue {
    public:
     DRRQueue(DRRPrincipal p, uint64_t quanta)
-        : stats_(p), deficit_(p.share * quanta), numReqs_(0) {}
+        : stats_(p), deficit_(p.share * quanta), debt_(0), numReqs_(0) {}
 
     ~DRRQueue() {}
 
     DRRStats stats_;
     uint64_t deficit_;
+    // Cost incurred beyond what requests were charged at dequeue time, see
+    // chargeCost(). Paid off from the quanta of the next turns.
+    uint64_t debt_;
     uint64_t numReqs_;
 
     // Actual queue of requests.
@@ -249,6 +256,27 @@ class DRRScheduler {
     }
   }
 
+  /*
+   * Settles the cost of a request once it's known, for cost models where
+   * requests are dequeued at an estimate (their reqSize()) and the real cost,
+   * e.g. the time the device spent on them, is only measured afterwards.
+   * If the request cost less than it was charged, the difference is credited
+   * like in returnCredit(). If it cost more, the principal goes into debt and
+   * pays it off from its next quanta, so that it can't get more than its
+   * share of the device by queueing requests that turn out to be expensive.
+   * Unlike the deficit, the debt is kept when the principal's queue runs
+   * empty.
+   */
+  void chargeCost(uint64_t charged, uint64_t actual, uint64_t principal) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    DRRQueue* queue = queues_[principal].get();
+    if (actual > charged) {
+      queue->debt_ += actual - charged;
+    } else if (queue->numReqs_) {
+      queue->deficit_ += charged - actual;
+    }
+  }
+
   /*
    * Non-blocking interface for enqueing the request.
    */
@@ -307,7 +335,10 @@ class DRRScheduler {
           queue->stats_.bytesProcessed += size;
           return req;
         } else {
-          queue->deficit_ += (queue->stats_.principal.share * quanta_);
+          uint64_t quantum = queue->stats_.principal.share * quanta_;
+          uint64_t paid = std::min(queue->debt_, quantum);
+          queue->debt_ -= paid;
+          queue->deficit_ += quantum - paid;
         }
       } else {
         queue->deficit_ = 0;
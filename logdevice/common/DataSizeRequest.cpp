@@ -285,6 +285,11 @@ void DataSizeRequest::finalize(Status status, bool delete_this) {
       size_t avg_size = result_size / double(num_responses);
       size_t final_estimate =
           round(avg_size * double(failure_domain_->numShards()));
+      // Scale the error bound like the size.
+      result_error_bound_ = round(data_size_error_ /
+                                  double(replication_factor_) /
+                                  double(num_responses) *
+                                  double(failure_domain_->numShards()));
       callback_(*this, status, final_estimate);
     }
   } else {
@@ -340,12 +345,17 @@ bool DataSizeRequest::haveDeadEnd() {
   return res;
 }
 
-void DataSizeRequest::onReply(ShardID from, Status status, size_t size) {
-  ld_debug("Received DATA_SIZE_REPLY[%lu] from %s, status=%s, result=%lu",
+void DataSizeRequest::onReply(ShardID from,
+                              Status status,
+                              size_t size,
+                              size_t error_bound) {
+  ld_debug("Received DATA_SIZE_REPLY[%lu] from %s, status=%s, result=%lu, "
+           "error_bound=%lu",
            log_id_.val(),
            from.toString().c_str(),
            error_name(status),
-           size);
+           size,
+           error_bound);
 
   if (!failure_domain_->containsShard(from)) {
     RATELIMIT_ERROR(std::chrono::seconds(10),
@@ -384,6 +394,7 @@ void DataSizeRequest::onReply(ShardID from, Status status, size_t size) {
       // twice.
       if (~shard_st & SHARD_HAS_RESULT) {
         data_size_ += size;
+        data_size_error_ += error_bound;
       }
 
       shard_st |= SHARD_HAS_RESULT;
@@ -122,8 +122,13 @@ class DataSizeRequest : public DistributedRequest,
 
   /**
    * Called when we receive a DATA_SIZE_REPLY message from a storage node.
+   * `error_bound' is how far the node's `size' may be off, 0 for nodes that
+   * don't report it.
    */
-  void onReply(ShardID from, Status status, size_t size);
+  void onReply(ShardID from,
+               Status status,
+               size_t size,
+               size_t error_bound = 0);
 
   /**
    * Initializes state and broadcasts initial messages to all servers.
@@ -141,6 +146,16 @@ class DataSizeRequest : public DistributedRequest,
     return log_id_;
   }
 
+  /**
+   * Once the callback was called with OK or PARTIAL: how far the reported
+   * size may be off because storage nodes interpolated partitions partially
+   * covered by the time range, extrapolated the same way as the size. Doesn't
+   * account for nodes that didn't respond or that run an older version.
+   */
+  size_t getErrorBound() const {
+    return result_error_bound_;
+  }
+
   ~DataSizeRequest() override;
 
  protected: // overridden in tests
@@ -202,6 +217,9 @@ class DataSizeRequest : public DistributedRequest,
   const std::chrono::milliseconds client_timeout_;
   const data_size_callback_ex_t callback_;
   size_t data_size_ = 0;
+  // Sum of the error bounds reported along with data_size_.
+  size_t data_size_error_ = 0;
+  size_t result_error_bound_ = 0;
 
   int replication_factor_ = 0;
   worker_id_t worker_ = worker_id_t(-1);
@@ -56,30 +56,33 @@ void DomainIsolationChecker::rebuildState() {
     return;
   }
 
-  const NodeLocation& this_location = my_location_optional.value();
   for (const auto& kv : *sd_config) {
-    const node_index_t index = kv.first;
-    const configuration::nodes::NodeServiceDiscovery& sd = kv.second;
     // we use a conservative approach so that nodes which do NOT have
     // location info are treated as nodes _outside_ of the domain
-    if (!sd.location.has_value()) {
+    if (!kv.second.location.has_value()) {
       ld_warning("Node %hd does not have location information in config. "
                  "Domain isolation detection may not be accurate!",
-                 index);
-      continue;
-    }
-    const NodeLocation& location = sd.location.value();
-    for (NodeLocationScope scope = NodeLocationScope::NODE;
-         scope < NodeLocationScope::ROOT;
-         scope = NodeLocation::nextGreaterScope(scope)) {
-      if (this_node.index() == index ||
-          this_location.sharesScopeWith(location, scope)) {
-        // the node belongs to the same domain as this node in scope
-        scope_info_[static_cast<size_t>(scope)].domain_nodes.insert(index);
-      }
+                 kv.first);
     }
   }
 
+  // NODE is an implicit scope and not considered shared
+  scope_info_[static_cast<size_t>(NodeLocationScope::NODE)]
+      .domain_nodes.insert(this_node.index());
+
+  const auto& index = *nodes_configuration->getFailureDomainIndex();
+  for (NodeLocationScope scope =
+           NodeLocation::nextGreaterScope(NodeLocationScope::NODE);
+       scope < NodeLocationScope::ROOT;
+       scope = NodeLocation::nextGreaterScope(scope)) {
+    // the nodes which belong to the same domain as this node in scope
+    const auto domain = index.getDomain(scope, this_node.index());
+    ld_check(domain != configuration::nodes::FailureDomainIndex::NO_DOMAIN);
+    const auto& domain_nodes = index.getNodes(scope, domain);
+    scope_info_[static_cast<size_t>(scope)].domain_nodes.insert(
+        domain_nodes.begin(), domain_nodes.end());
+  }
+
   ld_check(scope_info_[static_cast<size_t>(NodeLocationScope::NODE)]
                .domain_nodes.size() == 1);
   ld_check(scope_info_[static_cast<size_t>(NodeLocationScope::NODE)]
@@ -9,65 +9,111 @@
 
 namespace facebook { namespace logdevice {
 
-EpochMetaDataCache::EpochMetaDataCache(size_t max_entries)
-    : cache_(max_entries) {
+EpochMetaDataCache::EpochMetaDataCache(size_t max_entries,
+                                       std::chrono::milliseconds soft_ttl)
+    : soft_ttl_(soft_ttl), cache_(max_entries) {
   ld_check(max_entries > 0);
+  cache_.setPruneHook(
+      [this](Key key, Value&& value) { onEvicted(key, value); });
 }
 
-bool EpochMetaDataCache::getMetaData(logid_t logid,
-                                     epoch_t epoch,
-                                     epoch_t* until_out,
-                                     EpochMetaData* metadata_out,
-                                     RecordSource* source_out,
-                                     bool require_consistent) {
+EpochMetaDataCache::LRUCache::iterator
+EpochMetaDataCache::findLocked(logid_t logid,
+                               epoch_t epoch,
+                               bool require_consistent,
+                               bool promote) const {
+  auto find = [&](const Key& key) {
+    return promote ? cache_.find(key) : cache_.findWithoutPromotion(key);
+  };
+
+  auto it = find(std::make_pair(logid, epoch));
+  if (it != cache_.end()) {
+    // record in the cache must have a cached source
+    ld_check(MetaDataLogReader::isCachedSource(it->second.source));
+    if (it->second.source == RecordSource::CACHED_CONSISTENT) {
+      return it;
+    }
+    // require consistent data but only has soft one in cache, consider it as
+    // a miss, as well as a soft entry that is too old
+    if (!require_consistent &&
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - it->second.set_time) <
+            soft_ttl_) {
+      return it;
+    }
+  }
+
+  // look for a consistent entry of an earlier epoch that is still effective
+  // in `epoch'
+  auto ranges = consistent_ranges_.find(logid);
+  if (ranges == consistent_ranges_.end()) {
+    return cache_.end();
+  }
+  auto range = ranges->second.upper_bound(epoch);
+  if (range == ranges->second.begin()) {
+    return cache_.end();
+  }
+  --range;
+  if (range->second < epoch) {
+    return cache_.end();
+  }
+  it = find(std::make_pair(logid, range->first));
+  ld_check(it != cache_.end());
+  ld_check(it->second.source == RecordSource::CACHED_CONSISTENT);
+  return it;
+}
+
+bool EpochMetaDataCache::lookup(logid_t logid,
+                                epoch_t epoch,
+                                epoch_t* until_out,
+                                EpochMetaData* metadata_out,
+                                RecordSource* source_out,
+                                bool require_consistent,
+                                bool promote) const {
   ld_check(until_out != nullptr);
   ld_check(metadata_out != nullptr);
   ld_check(source_out != nullptr);
-  folly::SharedMutex::WriteHolder write_guard(cache_mutex_);
-  auto it = cache_.find(std::make_pair(logid, epoch));
+  auto it = findLocked(logid, epoch, require_consistent, promote);
   if (it == cache_.end()) {
     return false;
   }
-
-  // record in the cache must have a cached source
-  ld_check(MetaDataLogReader::isCachedSource(it->second.source));
-  if (require_consistent && it->second.source == RecordSource::CACHED_SOFT) {
-    // require consistent data but only has soft one in cache, consider it as
-    // a miss
-    return false;
-  }
-
   *until_out = it->second.until;
   *source_out = it->second.source;
   *metadata_out = it->second.metadata;
   return true;
 }
 
+bool EpochMetaDataCache::getMetaData(logid_t logid,
+                                     epoch_t epoch,
+                                     epoch_t* until_out,
+                                     EpochMetaData* metadata_out,
+                                     RecordSource* source_out,
+                                     bool require_consistent) {
+  folly::SharedMutex::WriteHolder write_guard(cache_mutex_);
+  return lookup(logid,
+                epoch,
+                until_out,
+                metadata_out,
+                source_out,
+                require_consistent,
+                /*promote=*/true);
+}
+
 bool EpochMetaDataCache::getMetaDataNoPromotion(logid_t logid,
                                                 epoch_t epoch,
                                                 epoch_t* until_out,
                                                 EpochMetaData* metadata_out,
                                                 RecordSource* source_out,
                                                 bool require_consistent) const {
-  ld_check(until_out != nullptr);
-  ld_check(metadata_out != nullptr);
-  ld_check(source_out != nullptr);
-
   // using read locks here since the cache is immutable
   folly::SharedMutex::ReadHolder read_guard(cache_mutex_);
-  auto it = cache_.findWithoutPromotion(std::make_pair(logid, epoch));
-  if (it == cache_.end()) {
-    return false;
-  }
-
-  ld_check(MetaDataLogReader::isCachedSource(it->second.source));
-  if (require_consistent && it->second.source == RecordSource::CACHED_SOFT) {
-    return false;
-  }
-  *until_out = it->second.until;
-  *source_out = it->second.source;
-  *metadata_out = it->second.metadata;
-  return true;
+  return lookup(logid,
+                epoch,
+                until_out,
+                metadata_out,
+                source_out,
+                require_consistent,
+                /*promote=*/false);
 }
 
 void EpochMetaDataCache::setMetaData(logid_t logid,
@@ -94,7 +140,25 @@ void EpochMetaDataCache::setMetaData(logid_t logid,
     return;
   }
 
-  cache_.set(std::make_pair(logid, epoch), {until, source, metadata});
+  cache_.set(std::make_pair(logid, epoch),
+             {until, source, metadata, std::chrono::steady_clock::now()});
+  if (source == RecordSource::CACHED_CONSISTENT) {
+    consistent_ranges_[logid][epoch] = until;
+  }
+}
+
+void EpochMetaDataCache::onEvicted(const Key& key, const Value& value) {
+  if (value.source != RecordSource::CACHED_CONSISTENT) {
+    return;
+  }
+  auto ranges = consistent_ranges_.find(key.first);
+  ld_check(ranges != consistent_ranges_.end());
+  if (ranges != consistent_ranges_.end()) {
+    ranges->second.erase(key.second);
+    if (ranges->second.empty()) {
+      consistent_ranges_.erase(ranges);
+    }
+  }
 }
 
 }} // namespace facebook::logdevice
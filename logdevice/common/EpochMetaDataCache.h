@@ -7,11 +7,14 @@
  */
 #pragma once
 
+#include <chrono>
+#include <map>
 #include <utility>
 
 #include <boost/noncopyable.hpp>
 #include <folly/SharedMutex.h>
 #include <folly/container/EvictingCacheMap.h>
+#include <folly/container/F14Map.h>
 #include <folly/hash/Hash.h>
 
 #include "logdevice/common/EpochMetaData.h"
@@ -38,10 +41,16 @@ namespace facebook { namespace logdevice {
  *  The cache is meant to be shared among all worker threads and is proteceted
  *  by locks.
  *
+ *  A consistent entry for <log, epoch> with `until' epoch also answers
+ *  lookups for any epoch in (epoch, until], since the metadata is authentic
+ *  for the whole range. This lets readers of a log that start in different
+ *  epochs of the same metadata range share a single metadata log read. Soft
+ *  entries only answer lookups for their exact epoch, and expire after
+ *  `soft_ttl' so that starting readers eventually pick up a newer storage set.
+ *
  * TODO: write our own LRU cache implementation that supports:
- *       1) epoch interval ranged looked up
- *       2) finer grained locking
- *       3) reduce write frequency by rate limiting promotions
+ *       1) finer grained locking
+ *       2) reduce write frequency by rate limiting promotions
  */
 
 class EpochMetaData;
@@ -50,8 +59,11 @@ class EpochMetaDataCache : boost::noncopyable {
  public:
   using RecordSource = MetaDataLogReader::RecordSource;
 
-  // create the cache with maximum entry size of @param max_entries
-  explicit EpochMetaDataCache(size_t max_entries);
+  // create the cache with maximum entry size of @param max_entries, soft
+  // entries are considered a miss @param soft_ttl after being set
+  explicit EpochMetaDataCache(size_t max_entries,
+                              std::chrono::milliseconds soft_ttl =
+                                  std::chrono::milliseconds::max());
 
   // Given logid and epoch, search the epoch metadata in the cache.
   // @return       true if there is a cache hit, and results (metadata and
@@ -93,14 +105,44 @@ class EpochMetaDataCache : boost::noncopyable {
     epoch_t until;
     RecordSource source;
     EpochMetaData metadata;
+    std::chrono::steady_clock::time_point set_time;
   };
 
   // the internal LRU cache
   using LRUCache = folly::EvictingCacheMap<Key, Value, KeyHasher>;
-  LRUCache cache_;
+
+  // Finds the entry that can answer a lookup for `epoch', either set for
+  // that exact epoch or a consistent entry whose range contains it.
+  // @param promote  whether to promote the entry in the LRU list
+  LRUCache::iterator findLocked(logid_t logid,
+                                epoch_t epoch,
+                                bool require_consistent,
+                                bool promote) const;
+
+  bool lookup(logid_t logid,
+              epoch_t epoch,
+              epoch_t* until_out,
+              EpochMetaData* metadata_out,
+              RecordSource* source_out,
+              bool require_consistent,
+              bool promote) const;
+
+  // called when `key' is evicted from cache_
+  void onEvicted(const Key& key, const Value& value);
+
+  const std::chrono::milliseconds soft_ttl_;
+
+  // `mutable' since lookups promote entries. Protected by cache_mutex_, held
+  // exclusively if entries are promoted.
+  mutable LRUCache cache_;
+
+  // For each log, maps the epoch of each consistent entry in cache_ to its
+  // `until' epoch. Used to find the entry whose range contains an epoch.
+  folly::F14FastMap<logid_t, std::map<epoch_t, epoch_t>, logid_t::Hash>
+      consistent_ranges_;
 
   // protect the access to lru_cache_
-  folly::SharedMutex cache_mutex_;
+  mutable folly::SharedMutex cache_mutex_;
 };
 
 }} // namespace facebook::logdevice
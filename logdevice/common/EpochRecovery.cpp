@@ -255,6 +255,9 @@ void EpochRecovery::onDigestRecord(ShardID from,
     return;
   }
 
+  STAT_ADD(deps_->getStats(),
+           epoch_recovery_digest_payload_bytes,
+           record->payload.size());
   digest_.onRecord(from, std::move(record));
   // ownership of record was transferred to digest_
 
@@ -877,6 +880,9 @@ bool EpochRecovery::mutateEpoch(const std::set<ShardID>& mutation_set,
         mutation_flags |=
             dentry.isWriteStreamRecord() ? STORE_Header::WRITE_STREAM : 0;
         payload = dentry.getPayload();
+        STAT_ADD(deps_->getStats(),
+                 epoch_recovery_mutation_payload_bytes,
+                 payload.size());
 
         // note that with failure domain requirements, existing copyset size may
         // be equal or larger than replication factor but the digest entry still
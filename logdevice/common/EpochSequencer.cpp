@@ -184,6 +184,32 @@ RunAppenderStatus EpochSequencer::runAppender(Appender* appender) {
   return RunAppenderStatus::SUCCESS_KEEP;
 }
 
+bool EpochSequencer::noteWindowFeedback(lsn_t lsn, bool backpressure) {
+  const size_t limit = window_.limit();
+  if (backpressure) {
+    const esn_t::raw_type esn = lsn_to_esn(lsn).val_;
+    const esn_t::raw_type next_esn = lsn_to_esn(window_.next()).val_;
+    esn_t::raw_type recover_until = window_recover_until_.load();
+    do {
+      if (esn < recover_until) {
+        // Admitted before the last decrease, which already accounted for it.
+        return false;
+      }
+    } while (!window_recover_until_.compare_exchange_weak(
+        recover_until, std::max(next_esn, esn + 1)));
+    window_successes_.store(0);
+    window_.setLimit(limit / 2);
+    return window_.limit() < limit;
+  }
+
+  if (limit < window_.capacity() &&
+      window_successes_.fetch_add(1) + 1 >= limit) {
+    window_successes_.store(0);
+    window_.setLimit(limit + 1);
+  }
+  return false;
+}
+
 void EpochSequencer::processNextBytes(Appender* appender) {
   ld_check(appender != nullptr);
   uint64_t in_payload_checksum_bytes = appender->getChecksumBytes();
@@ -309,6 +309,29 @@ class EpochSequencer : public std::enable_shared_from_this<EpochSequencer> {
     return window_.capacity();
   }
 
+  /**
+   * @return current limit on the number of appends in flight, at most
+   *         getMaxWindowSize().  Lower than that only if the window was
+   *         shrunk by noteWindowFeedback().
+   */
+  size_t getWindowLimit() const {
+    return window_.limit();
+  }
+
+  /**
+   * Adapts the window limit to feedback from the Appender of `lsn', when
+   * --sequencer-window-adaptive is on.  The limit is halved on backpressure
+   * (a storage node was overloaded or out of space, or the append was slower
+   * than --sequencer-window-latency-target), once for all the appends that
+   * were in flight at the time, and grows by one per window of appends
+   * replicated without backpressure, up to max-in-flight.
+   *
+   * Thread-safe, called by Appenders on any Worker.
+   *
+   * @return  true if the limit was decreased
+   */
+  bool noteWindowFeedback(lsn_t lsn, bool backpressure);
+
   State getState() const {
     return state_;
   }
@@ -470,6 +493,13 @@ class EpochSequencer : public std::enable_shared_from_this<EpochSequencer> {
   // the next sequence number to use.
   SlidingWindowSingleEpoch<Appender, Appender::Reaper> window_;
 
+  // Adaptive window state, see noteWindowFeedback().  ESN at the leading
+  // edge of the window when its limit was last decreased; backpressure on
+  // appends below it was already reacted to.
+  std::atomic<esn_t::raw_type> window_recover_until_{0};
+  // Appends replicated without backpressure since the limit last changed.
+  std::atomic<size_t> window_successes_{0};
+
   // for serializing state changes
   mutable std::mutex state_mutex_;
 
@@ -149,12 +149,52 @@ Status EventLoop::init(
 void EventLoop::run() {
   EventLoop::thisThreadLoop_ = this; // save in a thread-local
   // this runs until we get destroyed or shutdown is called on
-  // EventLoopTaskQueue
-  auto status = base_->loop();
-  if (status != EvBase::Status::OK) {
-    ld_error("EvBase::loop() exited abnormally");
+  // EventLoopTaskQueue; setBusyPoll() may stop either loop to switch to the
+  // other one.
+  while (!task_queue_->hasTerminatedEventLoop()) {
+    auto status = busy_poll_.count() > 0 ? busyPollLoop() : base_->loop();
+    if (status != EvBase::Status::OK) {
+      ld_error("EvBase::loop() exited abnormally");
+      break;
+    }
   }
   // the thread on which this EventLoop ran terminates here
 }
 
+void EventLoop::setBusyPoll(std::chrono::microseconds duration) {
+  const bool was_busy_polling = busy_poll_.count() > 0;
+  busy_poll_ = duration;
+  if (!was_busy_polling && duration.count() > 0) {
+    // Leave EvBase::loop() so that run() switches to busyPollLoop(). The
+    // other way around busyPollLoop() notices by itself.
+    base_->terminateLoop();
+  }
+}
+
+EvBase::Status EventLoop::busyPollLoop() {
+  using std::chrono::steady_clock;
+  base_->setAsRunningBase();
+
+  uint64_t num_batches = task_queue_->getNumBatches();
+  auto last_active = steady_clock::now();
+  while (busy_poll_.count() > 0 && !task_queue_->hasTerminatedEventLoop()) {
+    EvBase::Status status;
+    if (steady_clock::now() - last_active < busy_poll_) {
+      status = base_->loopOnceNonBlocking();
+    } else {
+      // Idle for long enough, sleep until something happens.
+      status = base_->loopOnce();
+      last_active = steady_clock::now();
+    }
+    if (status != EvBase::Status::OK) {
+      return status;
+    }
+    if (task_queue_->getNumBatches() != num_batches) {
+      num_batches = task_queue_->getNumBatches();
+      last_active = steady_clock::now();
+    }
+  }
+  return EvBase::Status::OK;
+}
+
 }} // namespace facebook::logdevice
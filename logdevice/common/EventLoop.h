@@ -8,6 +8,7 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <functional>
 #include <memory>
@@ -109,6 +110,21 @@ class EventLoop : public folly::Executor {
     return *task_queue_;
   }
 
+  /**
+   * If positive, once woken up the loop keeps polling for events without
+   * blocking until it has found no tasks to run for this long, and only then
+   * goes back to sleep in epoll. Trades cpu for latency: tasks and packets
+   * arriving meanwhile are handled without waking up a sleeping thread. Zero
+   * (the default) makes every iteration block until there is something to do.
+   *
+   * Must be called on the EventLoop thread.
+   */
+  void setBusyPoll(std::chrono::microseconds duration);
+
+  std::chrono::microseconds getBusyPoll() const {
+    return busy_poll_;
+  }
+
   /**
    * @return   a pointer to the EventLoop object running on this thread, or
    *           nullptr if this thread is not running a EventLoop.
@@ -171,6 +187,10 @@ class EventLoop : public folly::Executor {
            requests_per_iteration);
   // called by EventLoop.thread_ after init if it succeds
   void run();
+  // run() while busy_poll_ is positive
+  EvBase::Status busyPollLoop();
+
+  std::chrono::microseconds busy_poll_{0};
 
   // this is how a thread finds if it's running an EventLoop, and which one
   static thread_local EventLoop* thisThreadLoop_;
@@ -7,6 +7,8 @@
  */
 #include "logdevice/common/EventLoopTaskQueue.h"
 
+#include <algorithm>
+
 #include <folly/Function.h>
 
 #include "logdevice/common/ConstructorFailed.h"
@@ -17,6 +19,7 @@
 namespace facebook { namespace logdevice {
 
 constexpr size_t EventLoopTaskQueue::kNumberOfPriorities;
+constexpr uint32_t EventLoopTaskQueue::kMaxBudgetMultiplier;
 
 constexpr std::array<int8_t, EventLoopTaskQueue::kNumberOfPriorities>
     EventLoopTaskQueue::kLookupTable;
@@ -95,13 +98,35 @@ int EventLoopTaskQueue::addWithPriority(Func func, int8_t priority) {
 
 void EventLoopTaskQueue::haveTasksEventHandler() {
   ld_check(sem_waiter_);
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+  using std::chrono::steady_clock;
+
+  const auto start = steady_clock::now();
+  // Only meaningful if tasks were pending all along; otherwise the loop may
+  // just have been idle.
+  const steady_clock::duration loop_delay =
+      backlogged_ ? start - last_batch_end_ : steady_clock::duration::zero();
+  if (backlogged_) {
+    loop_delay_.add(duration_cast<microseconds>(loop_delay).count());
+  }
   try {
     auto cb = [this](uint32_t n) { executeTasks(n); };
     // processBatch() decrements the semaphore by some amount and calls our
     // callback with the amount.  We're guaranteed to have at least that many
     // items in the UMPSCQueue, because the producer pushes into the queue
     // first then increments the semaphore.
-    sem_waiter_->processBatch(cb, total_dequeues_per_iteration_);
+    sem_waiter_->processBatch(cb, dequeue_budget_);
+
+    ++num_batches_;
+    last_batch_end_ = steady_clock::now();
+    const auto batch_time = last_batch_end_ - start;
+    batch_time_.add(duration_cast<microseconds>(batch_time).count());
+    const bool backlogged = sem_.valueGuess() > 0;
+    if (target_iteration_latency_.count() > 0) {
+      adjustDequeueBudget(loop_delay, batch_time, backlogged);
+    }
+    backlogged_ = backlogged;
   } catch (const folly::ShutdownSemError&) {
     // First delete the event since the fd is about to go away
     ld_check(tasks_pending_event_);
@@ -112,6 +137,7 @@ void EventLoopTaskQueue::haveTasksEventHandler() {
 
     // If requested, instruct the event loop to stop
     if (close_event_loop_on_shutdown_) {
+      event_loop_terminated_ = true;
       auto status = base_.terminateLoop();
       if (UNLIKELY(status != EvBase::Status::OK)) {
         ld_error("FATAL: EvBase::terminateLoop() failed");
@@ -121,6 +147,25 @@ void EventLoopTaskQueue::haveTasksEventHandler() {
   }
 }
 
+void EventLoopTaskQueue::adjustDequeueBudget(
+    std::chrono::steady_clock::duration loop_delay,
+    std::chrono::steady_clock::duration batch_time,
+    bool backlogged) {
+  const uint32_t min_budget = kNumberOfPriorities;
+  const uint32_t max_budget = std::max(
+      min_budget, total_dequeues_per_iteration_ * kMaxBudgetMultiplier);
+  if (batch_time > target_iteration_latency_) {
+    // The tasks alone take longer than the target: back off quickly so that
+    // the rest of the event loop isn't starved.
+    dequeue_budget_ = std::max(min_budget, dequeue_budget_ * 3 / 4);
+  } else if (backlogged &&
+             loop_delay + batch_time < target_iteration_latency_ / 2) {
+    // Tasks are piling up and there is room: grow gradually.
+    dequeue_budget_ = std::min(
+        max_budget, dequeue_budget_ + std::max(1u, dequeue_budget_ / 4));
+  }
+}
+
 void EventLoopTaskQueue::executeTasks(uint32_t tokens) {
   std::array<uint32_t, kNumberOfPriorities> dequeues_to_execute{0};
   std::array<uint32_t, kNumberOfPriorities> tasks_available{0};
@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include <chrono>
 #include <memory>
 #include <numeric>
 
@@ -17,6 +18,7 @@
 
 #include "logdevice/common/LifoEventSem.h"
 #include "logdevice/common/libevent/LibEventCompatibility.h"
+#include "logdevice/common/stats/Histogram.h"
 
 namespace facebook { namespace logdevice {
 using Func = folly::Function<void()>;
@@ -43,6 +45,12 @@ struct EventLoopTaskQueueImpl;
  * lower priority we will try to search in higher priorities from highest to
  * lowest.
  *
+ * Optionally (see setTargetIterationLatency()), the total number of tasks
+ * dequeued per iteration adapts to the measured time of event loop
+ * iterations: it shrinks when running a batch of tasks alone takes longer
+ * than the target, so that sockets and timers get their turn, and grows while
+ * tasks are left in the queue and iterations are well within the target.
+ *
  * The expected pattern is for producers and the consumer to share a
  * std::shared_ptr<EventLoopTaskQueue> for shutdown safety.
  */
@@ -116,6 +124,7 @@ class EventLoopTaskQueue {
         std::accumulate(dequeues_per_iteration_.begin(),
                         dequeues_per_iteration_.end(),
                         uint32_t(0));
+    dequeue_budget_ = total_dequeues_per_iteration_;
   }
 
   void setDequeuesPerIterationForPriority(uint32_t num_dequeues,
@@ -125,8 +134,63 @@ class EventLoopTaskQueue {
         std::accumulate(dequeues_per_iteration_.begin(),
                         dequeues_per_iteration_.end(),
                         uint32_t(0));
+    dequeue_budget_ = total_dequeues_per_iteration_;
+  }
+
+  /**
+   * Sets the target duration of an event loop iteration while tasks are
+   * pending. Zero disables adaptation: every iteration dequeues the sum of the
+   * counts passed to setDequeuesPerIteration(). Otherwise that sum is only
+   * the starting point, and the budget moves between kNumberOfPriorities and
+   * kMaxBudgetMultiplier times that sum. When the budget is below the sum,
+   * higher priorities get their slots first.
+   *
+   * Must be called on the EventLoop thread, like the accessors below.
+   */
+  void setTargetIterationLatency(std::chrono::microseconds target) {
+    target_iteration_latency_ = target;
+    dequeue_budget_ = total_dequeues_per_iteration_;
+  }
+
+  std::chrono::microseconds getTargetIterationLatency() const {
+    return target_iteration_latency_;
+  }
+
+  // Number of tasks the next iteration will dequeue at most.
+  uint32_t getDequeueBudget() const {
+    return dequeue_budget_;
+  }
+
+  // Approximate number of tasks pending with the given priority.
+  size_t getQueueSize(int8_t priority) const {
+    return queues_[translatePriority(priority)].size();
   }
 
+  // Time between the end of a batch that left tasks in the queue and the
+  // start of the next batch, i.e. spent on the rest of the event loop, in
+  // microseconds.
+  const LatencyHistogram& getLoopDelayHistogram() const {
+    return loop_delay_;
+  }
+
+  // Time spent running a batch of tasks, in microseconds.
+  const LatencyHistogram& getBatchTimeHistogram() const {
+    return batch_time_;
+  }
+
+  // Number of batches of tasks run so far.
+  uint64_t getNumBatches() const {
+    return num_batches_;
+  }
+
+  // True once the queue was shut down and, as requested by
+  // setCloseEventLoopOnShutdown(), terminated the event loop.
+  bool hasTerminatedEventLoop() const {
+    return event_loop_terminated_;
+  }
+
+  constexpr static uint32_t kMaxBudgetMultiplier = 16;
+
  private:
   EvBase& base_;
 
@@ -149,6 +213,19 @@ class EventLoopTaskQueue {
   std::array<uint32_t, kNumberOfPriorities> dequeues_per_iteration_;
   uint32_t total_dequeues_per_iteration_;
 
+  // Number of tasks to dequeue per iteration, total_dequeues_per_iteration_
+  // unless adapted to target_iteration_latency_.
+  uint32_t dequeue_budget_;
+  std::chrono::microseconds target_iteration_latency_{0};
+
+  // Set if the last batch left tasks in the queue.
+  bool backlogged_{false};
+  std::chrono::steady_clock::time_point last_batch_end_;
+  LatencyHistogram loop_delay_;
+  LatencyHistogram batch_time_;
+  uint64_t num_batches_{0};
+  bool event_loop_terminated_{false};
+
   // The data structures of choice for queue is an UnboundedQueue paired with a
   // LifoEventSem. The posting codepath writes into the queue, then posts to
   // the semaphore. LifoEventSem ensures that the FD hooked up to the event
@@ -177,6 +254,11 @@ class EventLoopTaskQueue {
 
   void haveTasksEventHandler();
 
+  // Adapts dequeue_budget_ after a batch. See setTargetIterationLatency().
+  void adjustDequeueBudget(std::chrono::steady_clock::duration loop_delay,
+                           std::chrono::steady_clock::duration batch_time,
+                           bool backlogged);
+
   // Invoked by haveTasksEventHandle to dequeue tasks from the queue.
   void executeTasks(uint32_t num_tasks_to_dequeue);
 };
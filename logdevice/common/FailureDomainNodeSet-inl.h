@@ -63,35 +63,33 @@ template <typename AttrType, typename HashFn>
 void FailureDomainNodeSet<AttrType, HashFn>::addShard(
     ShardID shard,
     const configuration::nodes::NodesConfiguration& nodes_configuration) {
-  const auto* service_disc =
-      nodes_configuration.getNodeServiceDiscovery(shard.node());
+  const auto& index = *nodes_configuration.getFailureDomainIndex();
   // shard came from the membership reader view of the node configuration
-  ld_check(service_disc != nullptr);
+  ld_check(index.getDomain(NodeLocationScope::NODE, shard.node()) !=
+           configuration::nodes::FailureDomainIndex::NO_DOMAIN);
 
   for (auto it = scopes_.begin(); it != scopes_.end(); ++it) {
     const NodeLocationScope scope = it->first;
-    std::string domain_name;
-    if (scope == NodeLocationScope::NODE) {
-      domain_name = std::to_string(shard.node());
-    } else if (!service_disc->location.has_value() ||
-               !service_disc->location.value().scopeSpecified(scope)) {
+    if (scope != NodeLocationScope::NODE &&
+        !index.scopeSpecified(scope, shard.node())) {
       ld_error("Node %d in the storage_set does not have location "
                "information in location scope: %s.",
                shard.node(),
                NodeLocation::scopeNames()[scope].c_str());
       continue;
-    } else {
-      domain_name = service_disc->location.value().getDomain(scope);
     }
 
     ScopeState& state = it->second;
-    FailureDomainState& fd = state.domains[domain_name];
+    FailureDomainState& fd =
+        state.domains[index.getDomain(scope, shard.node())];
     state.shard_map[shard] = &fd;
     ++fd.n_shards;
   }
 
   // Register the shard in the implicit SHARD scope.
-  FailureDomainState& shard_fd = shard_scope_.domains[shard.toString()];
+  FailureDomainState& shard_fd =
+      shard_scope_.domains[static_cast<uint64_t>(shard.node()) << 16 |
+                           static_cast<uint16_t>(shard.shard())];
   shard_scope_.shard_map[shard] = &shard_fd;
   // There can only be one shard in a domain at scope SHARD.
   ld_check(shard_fd.n_shards == 0);
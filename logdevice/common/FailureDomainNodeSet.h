@@ -285,8 +285,9 @@ class FailureDomainNodeSet {
 
   // Aggregated data for all domains at the same scope.
   struct ScopeState {
-    // The domains at that scope.
-    folly::F14NodeMap<std::string, FailureDomainState> domains;
+    // The domains at that scope, keyed by their FailureDomainIndex id, or by
+    // the node and shard index for the SHARD scope.
+    folly::F14NodeMap<uint64_t, FailureDomainState> domains;
     // A mapping between a shard and the domain it belongs to at that scope for
     // fast lookup.
     folly::F14FastMap<ShardID, FailureDomainState*, ShardID::Hash> shard_map;
@@ -154,6 +154,18 @@ int HashBasedSequencerLocator::locateSequencer(
     }
   };
 
+  // With health-based hashing, nodes that gossip reports as overloaded keep
+  // a reduced share of the hash ring rather than being excluded outright, so
+  // that only a fraction of their logs move away from them.
+  auto load_adjusted = [&sequencers, cs, use_health_based_hashing](
+                           uint64_t node, double w) {
+    if (cs && use_health_based_hashing &&
+        cs->isNodeOverloaded(sequencers->nodes[node].index())) {
+      return w * OVERLOADED_WEIGHT_FACTOR;
+    }
+    return w;
+  };
+
   bool found_in_location = false;
   int64_t idx;
   if (sequencerAffinity && !sequencerAffinity->isEmpty()) {
@@ -168,7 +180,7 @@ int HashBasedSequencerLocator::locateSequencer(
           if (location.has_value()) {
             if (sequencerAffinity->sharesScopeWith(
                     location.value(), sequencerAffinity->lastScope())) {
-              return w;
+              return load_adjusted(node, w);
             }
           } else {
             RATELIMIT_WARNING(
@@ -191,7 +203,7 @@ int HashBasedSequencerLocator::locateSequencer(
     auto weight_fn = [&](uint64_t node) {
       double w = sequencers->weights[node];
       if (can_we_route_to(node, w, use_health_based_hashing)) {
-        return w;
+        return load_adjusted(node, w);
       }
       return 0.0;
     };
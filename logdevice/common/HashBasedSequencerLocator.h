@@ -69,6 +69,10 @@ class HashBasedSequencerLocator : public SequencerLocator {
 
   bool isAllowedToCache() const override;
 
+  // When health-based hashing is in use, the weight of sequencer nodes that
+  // report themselves as overloaded is multiplied by this factor.
+  static constexpr double OVERLOADED_WEIGHT_FACTOR = 0.5;
+
  protected:
   virtual ClusterState* getClusterState() const;
   virtual std::shared_ptr<const Configuration> getConfig() const;
@@ -0,0 +1,101 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/LatencyAwareCopySetSelector.h"
+
+#include <algorithm>
+
+#include <folly/small_vector.h>
+
+#include "logdevice/common/CopySet.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/stats/Stats.h"
+
+namespace facebook { namespace logdevice {
+
+LatencyAwareCopySetSelector::LatencyAwareCopySetSelector(
+    std::unique_ptr<CopySetSelector> selector,
+    double threshold,
+    std::chrono::milliseconds min_latency,
+    StatsHolder* stats,
+    const CopySetSelectorDependencies* deps)
+    : selector_(std::move(selector)),
+      threshold_(threshold),
+      min_latency_ms_(min_latency.count()),
+      stats_(stats),
+      deps_(deps) {
+  ld_check(selector_ != nullptr);
+  ld_check(threshold_ >= 1);
+}
+
+std::string LatencyAwareCopySetSelector::getName() const {
+  return "LatencyAware(" + selector_->getName() + ")";
+}
+
+double LatencyAwareCopySetSelector::expectedStoreLatency(
+    const StoreChainLink copyset[],
+    copyset_size_t copyset_size) const {
+  if (copyset_size == 0) {
+    return 0;
+  }
+  folly::small_vector<double, 8> latencies;
+  for (copyset_size_t i = 0; i < copyset_size; ++i) {
+    latencies.push_back(
+        deps_->getStoreLatency(copyset[i].destination).value_or(0));
+  }
+  // The record is acknowledged once `replication` copies are stored, so
+  // extras hide that many slow shards.
+  size_t k = std::min<size_t>(getReplicationFactor(), copyset_size) - 1;
+  std::nth_element(latencies.begin(), latencies.begin() + k, latencies.end());
+  return latencies[k];
+}
+
+CopySetSelector::Result
+LatencyAwareCopySetSelector::select(copyset_size_t extras,
+                                    StoreChainLink copyset_out[],
+                                    copyset_size_t* copyset_size_out,
+                                    bool* chain_out,
+                                    State* selector_state,
+                                    RNG& rng,
+                                    bool retry) const {
+  const bool chain_in = chain_out ? *chain_out : false;
+  Result res = selector_->select(extras,
+                                 copyset_out,
+                                 copyset_size_out,
+                                 chain_out,
+                                 selector_state,
+                                 rng,
+                                 retry);
+  if (res != Result::SUCCESS) {
+    // Don't look for a better copyset when there's hardly any choice.
+    return res;
+  }
+  const double latency = expectedStoreLatency(copyset_out, *copyset_size_out);
+  if (latency <= min_latency_ms_) {
+    return res;
+  }
+
+  StoreChainLink alt[COPYSET_SIZE_MAX];
+  copyset_size_t alt_size;
+  bool alt_chain = chain_in;
+  Result alt_res = selector_->select(
+      extras, alt, &alt_size, &alt_chain, selector_state, rng, retry);
+  if (alt_res != Result::SUCCESS ||
+      expectedStoreLatency(alt, alt_size) * threshold_ > latency) {
+    return res;
+  }
+
+  std::copy(alt, alt + alt_size, copyset_out);
+  *copyset_size_out = alt_size;
+  if (chain_out) {
+    *chain_out = alt_chain;
+  }
+  STAT_INCR(stats_, copyset_latency_aware_replaced);
+  return res;
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,109 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <chrono>
+#include <memory>
+
+#include "logdevice/common/CopySetSelector.h"
+#include "logdevice/common/CopySetSelectorDependencies.h"
+
+namespace facebook { namespace logdevice {
+
+class StatsHolder;
+
+/**
+ * @file LatencyAwareCopySetSelector wraps another copyset selector and biases
+ *       its choices away from shards that are currently slow to store.
+ *       This reacts to a degraded disk much sooner than graylisting, which
+ *       waits for a node to be an outlier over a grace period.
+ *
+ *       For each record it draws two copysets from the wrapped selector
+ *       (power of two choices) and keeps the one that is expected to be
+ *       stored sooner, according to the per-shard STORE latencies the
+ *       current worker observed. Both candidates satisfy the replication
+ *       property, so only the choice between them is biased.
+ *
+ *       A second copyset is only drawn if the first one is expected to take
+ *       longer than `min_latency`, and only used if the first one is expected
+ *       to take at least `threshold` times longer. When shards are fast or
+ *       similarly fast,
+ *       selection follows the wrapped selector's weights; and however fast a
+ *       shard is, at most two draws can go its way, which bounds how much
+ *       extra load it gets.
+ *
+ *       augment(), used by rebuilding and recovery, is passed through.
+ */
+
+class LatencyAwareCopySetSelector : public CopySetSelector {
+ public:
+  LatencyAwareCopySetSelector(std::unique_ptr<CopySetSelector> selector,
+                              double threshold,
+                              std::chrono::milliseconds min_latency,
+                              StatsHolder* stats = nullptr,
+                              const CopySetSelectorDependencies* deps =
+                                  CopySetSelectorDependencies::instance());
+
+  std::string getName() const override;
+
+  Result select(copyset_size_t extras,
+                StoreChainLink copyset_out[],
+                copyset_size_t* copyset_size_out,
+                bool* chain_out = nullptr,
+                State* selector_state = nullptr,
+                RNG& rng = DefaultRNG::get(),
+                bool retry = true) const override;
+
+  Result augment(ShardID inout_copyset[],
+                 copyset_size_t existing_copyset_size,
+                 copyset_size_t* out_full_size,
+                 RNG& rng = DefaultRNG::get(),
+                 bool retry = true) const override {
+    return selector_->augment(
+        inout_copyset, existing_copyset_size, out_full_size, rng, retry);
+  }
+
+  Result augment(StoreChainLink inout_copyset[],
+                 copyset_size_t existing_copyset_size,
+                 copyset_size_t* out_full_size,
+                 bool fill_client_id = false,
+                 bool* chain_out = nullptr,
+                 RNG& rng = DefaultRNG::get(),
+                 bool retry = true) const override {
+    return selector_->augment(inout_copyset,
+                              existing_copyset_size,
+                              out_full_size,
+                              fill_client_id,
+                              chain_out,
+                              rng,
+                              retry);
+  }
+
+  copyset_size_t getReplicationFactor() const override {
+    return selector_->getReplicationFactor();
+  }
+
+  std::unique_ptr<State> createState(RNG& rng) const override {
+    return selector_->createState(rng);
+  }
+
+  // The time, in milliseconds, until the given copyset is expected to have
+  // enough copies stored for the record to be acknowledged. Shards without
+  // latency information are assumed to be fast.
+  double expectedStoreLatency(const StoreChainLink copyset[],
+                              copyset_size_t copyset_size) const;
+
+ private:
+  const std::unique_ptr<CopySetSelector> selector_;
+  const double threshold_;
+  const double min_latency_ms_;
+  StatsHolder* stats_;
+  const CopySetSelectorDependencies* deps_;
+};
+
+}} // namespace facebook::logdevice
@@ -8,9 +8,15 @@
 #define __STDC_FORMAT_MACROS // pull in PRIu64 etc
 #include "logdevice/common/LocalLogStoreRecordFormat.h"
 
+#include <algorithm>
+
 #include <folly/Range.h>
 #include <folly/Varint.h>
 #include <folly/hash/Hash.h>
+#include <folly/small_vector.h>
+#include <lz4.h>
+#include <lz4hc.h>
+#include <zstd.h>
 
 #include "logdevice/common/Checksum.h"
 #include "logdevice/common/CopySet.h"
@@ -29,6 +35,13 @@ constexpr size_t minLogStoreBlobSize() {
       sizeof(copyset_size_t);
 }
 
+// Prefix of payloads stored with FLAG_PAYLOAD_COMPRESSED.
+struct CompressedPayloadHeader {
+  // Compression, as uint8_t.
+  uint8_t compression;
+  uint32_t uncompressed_size;
+} __attribute__((__packed__));
+
 uint32_t getRecordWaveOrRecoveryEpoch(const STORE_Header& header,
                                       const STORE_Extra& extra) {
   return (((header.flags & STORE_Header::RECOVERY ||
@@ -159,8 +172,9 @@ Slice formRecordHeader(const STORE_Header& store_header,
                        std::string* buf,
                        const bool shard_id_in_copyset,
                        const std::map<KeyType, std::string>& optional_keys,
-                       const STORE_Extra& store_extra) {
-  flags_t flags = store_header.flags & FLAG_MASK;
+                       const STORE_Extra& store_extra,
+                       flags_t local_flags) {
+  flags_t flags = (store_header.flags & FLAG_MASK) | local_flags;
   uint32_t wave_or_recovery_epoch_to_store =
       getRecordWaveOrRecoveryEpoch(store_header, store_extra);
   OffsetMap offsets_within_epoch;
@@ -430,27 +444,14 @@ bool parseCopySetIndexSingleEntry(const Slice& cs_dir_slice,
 
 #undef READ_FROM_SLICE
 
-int parse(const Slice& log_store_blob,
-          std::chrono::milliseconds* timestamp_out,
-          esn_t* last_known_good_out,
-          flags_t* flags_out,
-          uint32_t* wave_or_recovery_epoch_out,
-          copyset_size_t* copyset_size_out,
-          ShardID* copyset_arr_out,
-          size_t copyset_arr_out_size,
-          OffsetMap* offsets_within_epoch_out,
-          std::map<KeyType, std::string>* optional_keys,
-          Payload* payload_out,
-          shard_index_t this_shard) {
-  const uint8_t *const start = reinterpret_cast<const uint8_t*>(
-                           log_store_blob.data),
-                       *const end = start + log_store_blob.size, *ptr = start;
-
-  // Throughout this function, remember that we need to fully verify record
-  // format regardless of which options are nullptr.
+int RecordView::init(const Slice& log_store_blob) {
+  begin_ = reinterpret_cast<const uint8_t*>(log_store_blob.data);
+  end_ = begin_ + log_store_blob.size;
+  tail_decoded_ = false;
+  has_offsets_ = false;
+  const uint8_t* ptr = begin_;
 
-  const size_t MINIMUM_SIZE = minLogStoreBlobSize();
-  if (log_store_blob.size < MINIMUM_SIZE) {
+  if (log_store_blob.size < minLogStoreBlobSize()) {
     RATELIMIT_ERROR(std::chrono::seconds(10),
                     10,
                     "Invalid record: too small (%zu bytes); blob: %s",
@@ -460,41 +461,20 @@ int parse(const Slice& log_store_blob,
     return -1;
   }
 
-  //
-  // Timestamp
-  //
-  if (timestamp_out != nullptr) {
-    uint64_t raw;
-    memcpy(&raw, ptr, sizeof(raw));
-    *timestamp_out = std::chrono::milliseconds(raw);
-  }
-  ptr += sizeof(uint64_t);
+  uint64_t raw_timestamp;
+  memcpy(&raw_timestamp, ptr, sizeof(raw_timestamp));
+  timestamp_ = std::chrono::milliseconds(raw_timestamp);
+  ptr += sizeof(raw_timestamp);
 
-  //
-  // Last known good
-  //
-  if (last_known_good_out != nullptr) {
-    memcpy(last_known_good_out, ptr, sizeof(*last_known_good_out));
-  }
-  ptr += sizeof(esn_t);
+  memcpy(&last_known_good_, ptr, sizeof(last_known_good_));
+  ptr += sizeof(last_known_good_);
 
-  //
-  // Flags
-  //
-  flags_t flags;
-  int rv = parseFlagsValue(flags, &ptr, end);
+  int rv = parseFlagsValue(flags_, &ptr, end_);
   if (rv != 0) {
     return rv;
   }
 
-  if (flags_out != nullptr) {
-    *flags_out = flags;
-  }
-
-  //
-  // Wave number
-  //
-  if (ptr + sizeof(*wave_or_recovery_epoch_out) > end) {
+  if (ptr + sizeof(wave_or_recovery_epoch_) > end_) {
     RATELIMIT_ERROR(std::chrono::seconds(10),
                     10,
                     "Invalid record: past end while parsing wave; blob: %s",
@@ -502,17 +482,10 @@ int parse(const Slice& log_store_blob,
     err = E::MALFORMED_RECORD;
     return -1;
   }
-  if (wave_or_recovery_epoch_out != nullptr) {
-    memcpy(
-        wave_or_recovery_epoch_out, ptr, sizeof(*wave_or_recovery_epoch_out));
-  }
-  ptr += sizeof(*wave_or_recovery_epoch_out);
+  memcpy(&wave_or_recovery_epoch_, ptr, sizeof(wave_or_recovery_epoch_));
+  ptr += sizeof(wave_or_recovery_epoch_);
 
-  //
-  // Copyset size
-  //
-  copyset_size_t copyset_size;
-  if (ptr + sizeof(copyset_size) > end) {
+  if (ptr + sizeof(copyset_size_) > end_) {
     RATELIMIT_ERROR(
         std::chrono::seconds(10),
         10,
@@ -521,74 +494,196 @@ int parse(const Slice& log_store_blob,
     err = E::MALFORMED_RECORD;
     return -1;
   }
-  memcpy(&copyset_size, ptr, sizeof(copyset_size));
-  if (copyset_size < 1 || copyset_size > COPYSET_SIZE_MAX) {
+  memcpy(&copyset_size_, ptr, sizeof(copyset_size_));
+  if (copyset_size_ < 1 || copyset_size_ > COPYSET_SIZE_MAX) {
     RATELIMIT_ERROR(
         std::chrono::seconds(10),
         10,
         "Invalid record: copyset size is %" PRIu8 "; blob: %s",
-        copyset_size,
+        copyset_size_,
         // only print the header part of the blob, for security reasons
-        hexdump_buf(log_store_blob, (ptr - start) * 2).c_str());
+        hexdump_buf(log_store_blob, (ptr - begin_) * 2).c_str());
     err = E::MALFORMED_RECORD;
     return -1;
   }
+  ptr += sizeof(copyset_size_);
 
-  if (copyset_size_out != nullptr) {
-    *copyset_size_out = copyset_size;
+  const size_t entry_size =
+      flags_ & FLAG_SHARD_ID ? sizeof(ShardID) : sizeof(node_index_t);
+  if (ptr + copyset_size_ * entry_size > end_) {
+    RATELIMIT_ERROR(std::chrono::seconds(10),
+                    10,
+                    "Invalid record: past end while parsing copyset; blob: %s",
+                    hexdump_buf(log_store_blob, 700).c_str());
+    err = E::MALFORMED_RECORD;
+    return -1;
   }
-  ptr += sizeof(copyset_size_t);
+  copyset_begin_ = ptr;
+  copyset_end_ = ptr + copyset_size_ * entry_size;
+  return 0;
+}
 
-  //
-  // Copyset
-  //
-  Status status = E::OK;
-  if (flags & FLAG_SHARD_ID) {
-    if (ptr + copyset_size * sizeof(ShardID) > end) {
-      RATELIMIT_ERROR(
-          std::chrono::seconds(10),
-          10,
-          "Invalid record: past end while parsing copyset; blob: %s",
-          hexdump_buf(log_store_blob, 700).c_str());
-      err = E::MALFORMED_RECORD;
+void RecordView::copyset(ShardID* copyset_out,
+                         shard_index_t this_shard) const {
+  ld_check(copyset_begin_ != nullptr);
+  if (flags_ & FLAG_SHARD_ID) {
+    memcpy(copyset_out, copyset_begin_, copyset_size_ * sizeof(ShardID));
+  } else {
+    ld_check(this_shard >= 0);
+    folly::small_vector<node_index_t, 6> copyset;
+    copyset.resize(copyset_size_);
+    memcpy(&copyset[0], copyset_begin_, copyset_size_ * sizeof(node_index_t));
+    for (size_t i = 0; i < copyset_size_; ++i) {
+      copyset_out[i] = ShardID(copyset[i], this_shard);
+    }
+  }
+}
+
+int RecordView::decodeTail() {
+  if (tail_decoded_) {
+    return 0;
+  }
+  ld_check(copyset_end_ != nullptr);
+  const uint8_t* ptr = copyset_end_;
+  auto malformed = [&](const char* what) {
+    RATELIMIT_ERROR(std::chrono::seconds(10),
+                    10,
+                    "Invalid record: past end while parsing %s; blob: %s",
+                    what,
+                    hexdump_buf(begin_, end_ - begin_, 700).c_str());
+    err = E::MALFORMED_RECORD;
+    return -1;
+  };
+
+  if (flags_ & FLAG_OFFSET_WITHIN_EPOCH && !(flags_ & FLAG_OFFSET_MAP)) {
+    uint64_t offset;
+    if (parseOffsetWithinEpochValue(&offset, &ptr, end_) != 0) {
       return -1;
     }
+    offsets_within_epoch_.clear();
+    offsets_within_epoch_.setCounter(BYTE_OFFSET, offset);
+    has_offsets_ = true;
+  }
 
-    if (copyset_arr_out != nullptr) {
-      if (copyset_size <= copyset_arr_out_size) {
-        memcpy(copyset_arr_out, ptr, copyset_size * sizeof(ShardID));
-      } else {
-        status = E::NOBUFS;
-      }
+  // Optional keys are skipped as a whole; parse() decodes them.
+  if ((flags_ & FLAG_CUSTOM_KEY) || (flags_ & FLAG_OPTIONAL_KEYS)) {
+    uint16_t blob_size;
+    if (ptr + sizeof(blob_size) > end_) {
+      return malformed("optional blob size");
     }
-    ptr += copyset_size * sizeof(ShardID);
-  } else {
-    if (ptr + copyset_size * sizeof(node_index_t) > end) {
-      RATELIMIT_ERROR(
-          std::chrono::seconds(10),
-          10,
-          "Invalid record: past end while parsing copyset; blob: %s",
-          hexdump_buf(log_store_blob, 700).c_str());
-      err = E::MALFORMED_RECORD;
+    memcpy(&blob_size, ptr, sizeof(blob_size));
+    ptr += sizeof(blob_size);
+    if (ptr + blob_size > end_) {
+      return malformed("optional keys");
+    }
+    ptr += blob_size;
+  }
+
+  if (flags_ & FLAG_OFFSET_WITHIN_EPOCH && flags_ & FLAG_OFFSET_MAP) {
+    OffsetMap offsets;
+    int rv = offsets.deserialize(Slice(ptr, end_ - ptr));
+    if (rv == -1) {
       return -1;
     }
+    offsets_within_epoch_ = std::move(offsets);
+    has_offsets_ = true;
+    ptr += rv;
+  }
 
-    if (copyset_arr_out != nullptr) {
-      ld_check(this_shard >= 0);
-      if (copyset_size <= copyset_arr_out_size) {
-        folly::small_vector<node_index_t, 6> copyset;
-        copyset.resize(copyset_size);
-        memcpy(&copyset[0], ptr, copyset_size * sizeof(node_index_t));
-        for (size_t i = 0; i < copyset_size; ++i) {
-          copyset_arr_out[i] = ShardID(copyset[i], this_shard);
-        }
-      } else {
-        status = E::NOBUFS;
-      }
+  payload_begin_ = ptr;
+  tail_decoded_ = true;
+  return 0;
+}
+
+int RecordView::offsetsWithinEpoch(OffsetMap* offsets_within_epoch_out) {
+  ld_check(offsets_within_epoch_out != nullptr);
+  if (decodeTail() != 0) {
+    return -1;
+  }
+  if (has_offsets_) {
+    *offsets_within_epoch_out = offsets_within_epoch_;
+  }
+  return 0;
+}
+
+int RecordView::payload(Payload* payload_out) {
+  ld_check(payload_out != nullptr);
+  if (decodeTail() != 0) {
+    return -1;
+  }
+  if (end_ != payload_begin_) {
+    *payload_out = Payload(payload_begin_, end_ - payload_begin_);
+  } else {
+    *payload_out = Payload();
+  }
+  return 0;
+}
+
+int parse(const Slice& log_store_blob,
+          std::chrono::milliseconds* timestamp_out,
+          esn_t* last_known_good_out,
+          flags_t* flags_out,
+          uint32_t* wave_or_recovery_epoch_out,
+          copyset_size_t* copyset_size_out,
+          ShardID* copyset_arr_out,
+          size_t copyset_arr_out_size,
+          OffsetMap* offsets_within_epoch_out,
+          std::map<KeyType, std::string>* optional_keys,
+          Payload* payload_out,
+          shard_index_t this_shard,
+          folly::Optional<folly::StringPiece>* filterable_key_out) {
+  // Throughout this function, remember that we need to fully verify record
+  // format regardless of which options are nullptr.
+
+  if (filterable_key_out != nullptr) {
+    filterable_key_out->clear();
+  }
+
+  //
+  // Timestamp, last known good, flags, wave number, copyset size
+  //
+  RecordView view;
+  int rv = view.init(log_store_blob);
+  if (rv != 0) {
+    return rv;
+  }
+  const flags_t flags = view.flags();
+  const copyset_size_t copyset_size = view.copysetSize();
+
+  if (timestamp_out != nullptr) {
+    *timestamp_out = view.timestamp();
+  }
+  if (last_known_good_out != nullptr) {
+    *last_known_good_out = view.lastKnownGood();
+  }
+  if (flags_out != nullptr) {
+    *flags_out = flags;
+  }
+  if (wave_or_recovery_epoch_out != nullptr) {
+    *wave_or_recovery_epoch_out = view.waveOrRecoveryEpoch();
+  }
+  if (copyset_size_out != nullptr) {
+    *copyset_size_out = copyset_size;
+  }
+
+  //
+  // Copyset
+  //
+  Status status = E::OK;
+  if (copyset_arr_out != nullptr) {
+    if (copyset_size <= copyset_arr_out_size) {
+      view.copyset(copyset_arr_out, this_shard);
+    } else {
+      status = E::NOBUFS;
     }
-    ptr += copyset_size * sizeof(node_index_t);
   }
 
+  const Slice rest = view.afterCopyset();
+  const uint8_t *const start = reinterpret_cast<const uint8_t*>(
+                           log_store_blob.data),
+                       *const end = start + log_store_blob.size,
+                       *ptr = reinterpret_cast<const uint8_t*>(rest.data);
+
   //
   // Offset within epoch (if FLAG_OFFSET_WITHIN_EPOCH was set)
   //
@@ -679,6 +774,11 @@ int parse(const Slice& log_store_blob,
           optional_keys->insert(
               std::make_pair(static_cast<KeyType>(key_type), std::move(key)));
         }
+        if (filterable_key_out != nullptr &&
+            static_cast<KeyType>(key_type) == KeyType::FILTERABLE) {
+          *filterable_key_out = folly::StringPiece(
+              reinterpret_cast<const char*>(ptr), key_length);
+        }
         ptr += key_length;
       }
       if (ptr - map_head_pos != blob_size) {
@@ -737,7 +837,23 @@ int parse(const Slice& log_store_blob,
   }
 }
 
-int checkWellFormed(Slice blob, Slice payload) {
+namespace {
+
+// Checksum which checkWellFormed() needs to verify for a record. `size` is 0
+// if the record has no checksum.
+struct ChecksumToVerify {
+  Slice payload;
+  const void* expected = nullptr;
+  size_t size = 0;
+  // If the payload is compressed, holds the uncompressed payload that
+  // `payload` and `expected` point into.
+  folly::IOBuf uncompressed;
+};
+
+// Everything checkWellFormed() does except computing the checksum.
+int checkWellFormedExceptChecksum(Slice blob,
+                                  Slice payload,
+                                  ChecksumToVerify* out) {
   Payload parsed_payload_p;
   flags_t flags;
   uint32_t wave;
@@ -763,6 +879,18 @@ int checkWellFormed(Slice blob, Slice payload) {
     payload = parsed_payload;
     parsed_payload = Slice();
   }
+  if ((flags & FLAG_PAYLOAD_COMPRESSED) && !(flags & FLAG_AMEND)) {
+    // The checksum is compressed together with the payload, so it can't be
+    // split between `blob` and `payload`.
+    if (parsed_payload.size != 0 ||
+        uncompressPayload(Payload(payload.data, payload.size),
+                          &out->uncompressed) != 0) {
+      ld_error("Invalid record: malformed compressed payload.");
+      err = E::MALFORMED_RECORD;
+      return -1;
+    }
+    payload = Slice(out->uncompressed.data(), out->uncompressed.length());
+  }
   if (flags & FLAG_WRITTEN_BY_RECOVERY) {
     // TODO 11866467: uncomment this when we actually set the wave as sequencer
     // epoch
@@ -817,28 +945,211 @@ int checkWellFormed(Slice blob, Slice payload) {
       payload.data = (const char*)payload.data + checksum_size;
       payload.size -= checksum_size;
     }
-    char buf[8];
-    checksum_bytes(
-        Slice((const char*)payload.data, payload.size), checksum_size * 8, buf);
-    if (memcmp(buf, checksum_slice.data, checksum_size) != 0) {
-      uint64_t payload_checksum = 0;
-      uint64_t expected_checksum = 0;
-      memcpy(&payload_checksum, checksum_slice.data, checksum_size);
-      memcpy(&expected_checksum, buf, checksum_size);
+    out->payload = payload;
+    out->expected = checksum_slice.data;
+    out->size = checksum_size;
+  }
+  return 0;
+}
+
+// Compares checksum `actual` (of size ck.size) with the one stored in the
+// record.
+int compareChecksum(const ChecksumToVerify& ck, uint64_t actual) {
+  if (memcmp(&actual, ck.expected, ck.size) != 0) {
+    uint64_t payload_checksum = 0;
+    uint64_t expected_checksum = 0;
+    memcpy(&payload_checksum, ck.expected, ck.size);
+    memcpy(&expected_checksum, &actual, ck.size);
+    RATELIMIT_ERROR(std::chrono::seconds(10),
+                    100,
+                    "checksum mismatch: Invalid record. Payload: %s, "
+                    "expected checksum: %lu, checksum in payload: %lu",
+                    hexdump_buf(ck.payload, 500).c_str(),
+                    expected_checksum,
+                    payload_checksum);
+    err = E::CHECKSUM_MISMATCH;
+    return -1;
+  }
+  return 0;
+}
+
+} // namespace
+
+bool compressPayload(Compression compression,
+                     int zstd_level,
+                     size_t min_size,
+                     const Payload& payload,
+                     std::string* buf) {
+  ld_check(buf);
+  if (compression == Compression::NONE ||
+      payload.size() < std::max<size_t>(min_size, 1)) {
+    return false;
+  }
+  ld_check(compression == Compression::ZSTD ||
+           compression == Compression::LZ4 ||
+           compression == Compression::LZ4_HC);
+
+  const size_t bound = compression == Compression::ZSTD
+      ? ZSTD_compressBound(payload.size())
+      : LZ4_compressBound(payload.size());
+  buf->resize(sizeof(CompressedPayloadHeader) + bound);
+  char* out = &(*buf)[sizeof(CompressedPayloadHeader)];
+
+  size_t compressed_size;
+  if (compression == Compression::ZSTD) {
+    compressed_size = ZSTD_compress(
+        out, bound, payload.data(), payload.size(), std::max(zstd_level, 1));
+    if (ZSTD_isError(compressed_size)) {
       RATELIMIT_ERROR(std::chrono::seconds(10),
-                      100,
-                      "checksum mismatch: Invalid record. Payload: %s, "
-                      "expected checksum: %lu, checksum in payload: %lu",
-                      hexdump_buf(payload, 500).c_str(),
-                      expected_checksum,
-                      payload_checksum);
-      err = E::CHECKSUM_MISMATCH;
-      return -1;
+                      2,
+                      "ZSTD_compress() failed: %s",
+                      ZSTD_getErrorName(compressed_size));
+      buf->clear();
+      return false;
+    }
+  } else {
+    const char* src = static_cast<const char*>(payload.data());
+    int rv = compression == Compression::LZ4
+        ? LZ4_compress_default(src, out, payload.size(), bound)
+        : LZ4_compress_HC(src, out, payload.size(), bound, 0);
+    if (rv <= 0) {
+      RATELIMIT_ERROR(
+          std::chrono::seconds(10), 2, "LZ4_compress() returned %d", rv);
+      buf->clear();
+      return false;
     }
+    compressed_size = rv;
+  }
+
+  if (sizeof(CompressedPayloadHeader) + compressed_size >= payload.size()) {
+    // Not worth it.
+    buf->clear();
+    return false;
   }
+
+  CompressedPayloadHeader header{static_cast<uint8_t>(compression),
+                                 static_cast<uint32_t>(payload.size())};
+  memcpy(&(*buf)[0], &header, sizeof(header));
+  buf->resize(sizeof(CompressedPayloadHeader) + compressed_size);
+  return true;
+}
+
+int uncompressPayload(const Payload& stored, folly::IOBuf* out) {
+  ld_check(out);
+  CompressedPayloadHeader header;
+  if (stored.size() <= sizeof(header)) {
+    err = E::MALFORMED_RECORD;
+    return -1;
+  }
+  memcpy(&header, stored.data(), sizeof(header));
+  const char* src = static_cast<const char*>(stored.data()) + sizeof(header);
+  const size_t compressed_size = stored.size() - sizeof(header);
+  const size_t size = header.uncompressed_size;
+  const auto compression = static_cast<Compression>(header.compression);
+
+  bool ok = size > 0 && size <= MAX_PAYLOAD_SIZE_INTERNAL;
+  folly::IOBuf buf(folly::IOBuf::CREATE, ok ? size : 0);
+  if (!ok) {
+    // Checked below.
+  } else if (compression == Compression::ZSTD) {
+    size_t rv =
+        ZSTD_decompress(buf.writableData(), size, src, compressed_size);
+    ok = !ZSTD_isError(rv) && rv == size;
+  } else if (compression == Compression::LZ4 ||
+             compression == Compression::LZ4_HC) {
+    int rv = LZ4_decompress_safe(src,
+                                 reinterpret_cast<char*>(buf.writableData()),
+                                 compressed_size,
+                                 size);
+    ok = rv >= 0 && static_cast<size_t>(rv) == size;
+  } else {
+    ok = false;
+  }
+
+  if (!ok) {
+    RATELIMIT_ERROR(std::chrono::seconds(10),
+                    2,
+                    "Malformed compressed payload: compression %u, %zu bytes "
+                    "compressed, %zu uncompressed",
+                    header.compression,
+                    compressed_size,
+                    size);
+    err = E::MALFORMED_RECORD;
+    return -1;
+  }
+  buf.append(size);
+  *out = std::move(buf);
   return 0;
 }
 
+int checkWellFormed(Slice blob, Slice payload) {
+  ChecksumToVerify ck;
+  int rv = checkWellFormedExceptChecksum(blob, payload, &ck);
+  if (rv != 0 || ck.size == 0) {
+    return rv;
+  }
+  uint64_t actual = 0;
+  checksum_bytes(ck.payload, ck.size * 8, (char*)&actual);
+  return compareChecksum(ck, actual);
+}
+
+size_t checkWellFormedBatch(const Slice* blobs,
+                            const Slice* payloads,
+                            size_t n) {
+  folly::small_vector<ChecksumToVerify, 16> cks(n);
+  // Index of the first record that failed checks other than the checksum.
+  size_t first_bad = n;
+  Status first_bad_err = E::OK;
+  for (size_t i = 0; i < n; ++i) {
+    int rv = checkWellFormedExceptChecksum(
+        blobs[i], payloads ? payloads[i] : Slice(), &cks[i]);
+    if (rv != 0) {
+      first_bad = i;
+      first_bad_err = err;
+      break;
+    }
+  }
+
+  // Gather the checksums of records before first_bad, by width.
+  folly::small_vector<Slice, 16> slices32, slices64;
+  folly::small_vector<size_t, 16> idx32, idx64;
+  for (size_t i = 0; i < first_bad; ++i) {
+    if (cks[i].size == 4) {
+      slices32.push_back(cks[i].payload);
+      idx32.push_back(i);
+    } else if (cks[i].size == 8) {
+      slices64.push_back(cks[i].payload);
+      idx64.push_back(i);
+    }
+  }
+  folly::small_vector<uint64_t, 16> actual(first_bad, 0);
+  if (!slices32.empty()) {
+    folly::small_vector<uint32_t, 16> out(slices32.size());
+    checksum_32bit_batch(slices32.data(), slices32.size(), out.data());
+    for (size_t k = 0; k < idx32.size(); ++k) {
+      actual[idx32[k]] = out[k];
+    }
+  }
+  if (!slices64.empty()) {
+    folly::small_vector<uint64_t, 16> out(slices64.size());
+    checksum_64bit_batch(slices64.data(), slices64.size(), out.data());
+    for (size_t k = 0; k < idx64.size(); ++k) {
+      actual[idx64[k]] = out[k];
+    }
+  }
+
+  for (size_t i = 0; i < first_bad; ++i) {
+    if (cks[i].size != 0 && compareChecksum(cks[i], actual[i]) != 0) {
+      return i;
+    }
+  }
+  if (first_bad != n) {
+    err = first_bad_err;
+  }
+  return first_bad;
+}
+
+
 int parseTimestamp(const Slice& log_store_blob,
                    std::chrono::milliseconds* timestamp_out) {
   ld_check(timestamp_out != nullptr);
@@ -893,48 +1204,30 @@ int isWrittenByRecovery(const Slice& log_store_blob,
 
 int parseFlags(const Slice& log_store_blob, flags_t* flags_out) {
   ld_check(flags_out != nullptr);
-  return parse(log_store_blob,
-               nullptr,
-               nullptr,
-               flags_out,
-               nullptr,
-               nullptr,
-               nullptr,
-               0,
-               nullptr,
-               nullptr,
-               nullptr,
-               -1 /* unused */);
+  RecordView view;
+  int rv = view.init(log_store_blob);
+  if (rv != 0) {
+    return rv;
+  }
+  *flags_out = view.flags();
+  return 0;
 }
 
 int getCopysetHash(const Slice& log_store_blob, size_t* hash_out) {
-  static thread_local std::array<ShardID, COPYSET_SIZE_MAX> copyset;
   ld_check(hash_out != nullptr);
-  copyset_size_t copyset_size;
+  RecordView view;
+  int rv = view.init(log_store_blob);
+  if (rv != 0) {
+    return rv;
+  }
 
   // If FLAG_SHARD_ID is not set, retrieve ShardIDs that have the shard_index_t
   // component set to zero. We don't need this value to be accurate since this
   // is just used for hashing.
-  shard_index_t this_shard = 0;
-
-  int rv = parse(log_store_blob,
-                 nullptr,
-                 nullptr,
-                 nullptr,
-                 nullptr,
-                 &copyset_size,
-                 &copyset[0],
-                 copyset.size(),
-                 nullptr,
-                 nullptr,
-                 nullptr,
-                 this_shard);
-  if (rv != 0) {
-    ld_check(err != E::NOBUFS);
-    return rv;
-  }
+  std::array<ShardID, COPYSET_SIZE_MAX> copyset;
+  view.copyset(&copyset[0], /* this_shard */ 0);
   *hash_out = folly::hash::SpookyHashV2::Hash64(
-      &copyset[0], copyset_size * sizeof(ShardID), 0);
+      &copyset[0], view.copysetSize() * sizeof(ShardID), 0);
   return 0;
 }
 
@@ -986,6 +1279,8 @@ std::string flagsToString(flags_t flags) {
   FLAG(OFFSET_MAP)
   FLAG(WRITE_STREAM)
   FLAG(PAYLOAD_GROUP)
+  FLAG(PAYLOAD_COMPRESSED)
+  FLAG(E2E_TRACED)
 
 #undef FLAG
 
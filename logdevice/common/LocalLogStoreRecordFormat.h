@@ -10,7 +10,9 @@
 #include <chrono>
 #include <string>
 
+#include <folly/Optional.h>
 #include <folly/Range.h>
+#include <folly/io/IOBuf.h>
 
 #include "logdevice/common/NodeID.h"
 #include "logdevice/common/OffsetMap.h"
@@ -42,7 +44,11 @@
  *                   equal to hash(log_id) % num_shards.
  *   [0 or 8 bytes]  offset within epoch if FLAG_OFFSET_WITHIN_EPOCH is set
  *   [0 to  64kb]    user defined key.
- *   [?? bytes]      the rest of the blob is the user-provided data
+ *   [?? bytes]      the rest of the blob is the user-provided data, or if
+ *                   FLAG_PAYLOAD_COMPRESSED is set:
+ *                     [1 byte]   Compression
+ *                     [4 bytes]  size of the data after uncompressing it
+ *                     [?? bytes] the compressed data
  *
  * The format of single copyset index entries is:
  *   [4 bytes] wave number
@@ -123,6 +129,17 @@ const flags_t FLAG_WRITE_STREAM = 1u << 22; //=4194304
 // Record contains serialized PayloadGroup.
 const flags_t FLAG_PAYLOAD_GROUP = 1u << 23; //=8388608
 
+// The payload (including the checksum, if any) is stored compressed, see
+// compressPayload(). Only exists in the local log store: payloads are always
+// uncompressed before leaving the node, so this flag is never sent in STORE or
+// RECORD messages. (Bit 24 is PAYLOAD_COMPRESSED in STORE and RECORD
+// headers, which is about the wire format and never stored.)
+const flags_t FLAG_PAYLOAD_COMPRESSED = 1u << 25; //=33554432
+
+// The record was sampled for end-to-end latency tracing by the appending
+// client. Readers measure the latency of its delivery.
+const flags_t FLAG_E2E_TRACED = 1u << 26; //=67108864
+
 // Please update flagsToString() when adding new flags.
 
 // Flags that indicate that the record in question is a pseudorecord, and can
@@ -135,7 +152,7 @@ const flags_t PSEUDORECORD_MASK =
 const flags_t FLAG_MASK = FLAG_CHECKSUM | FLAG_CHECKSUM_64BIT |
     FLAG_CHECKSUM_PARITY | FLAG_HOLE | FLAG_BUFFERED_WRITER_BLOB |
     FLAG_WRITTEN_BY_RECOVERY | FLAG_BRIDGE | FLAG_EPOCH_BEGIN | FLAG_DRAINED |
-    FLAG_WRITE_STREAM | FLAG_PAYLOAD_GROUP;
+    FLAG_WRITE_STREAM | FLAG_PAYLOAD_GROUP | FLAG_E2E_TRACED;
 
 static_assert(FLAG_CHECKSUM == RECORD_Header::CHECKSUM &&
                   FLAG_CHECKSUM_64BIT == RECORD_Header::CHECKSUM_64BIT &&
@@ -149,7 +166,8 @@ static_assert(FLAG_CHECKSUM == RECORD_Header::CHECKSUM &&
                   FLAG_EPOCH_BEGIN == RECORD_Header::EPOCH_BEGIN &&
                   FLAG_DRAINED == RECORD_Header::DRAINED &&
                   FLAG_WRITE_STREAM == RECORD_Header::WRITE_STREAM &&
-                  FLAG_PAYLOAD_GROUP == RECORD_Header::PAYLOAD_GROUP,
+                  FLAG_PAYLOAD_GROUP == RECORD_Header::PAYLOAD_GROUP &&
+                  FLAG_E2E_TRACED == RECORD_Header::E2E_TRACED,
               "Flag constants don't match");
 
 static_assert(FLAG_CHECKSUM == STORE_Header::CHECKSUM &&
@@ -162,7 +180,8 @@ static_assert(FLAG_CHECKSUM == STORE_Header::CHECKSUM &&
                   FLAG_EPOCH_BEGIN == STORE_Header::EPOCH_BEGIN &&
                   FLAG_DRAINED == STORE_Header::DRAINED &&
                   FLAG_WRITE_STREAM == STORE_Header::WRITE_STREAM &&
-                  FLAG_PAYLOAD_GROUP == STORE_Header::PAYLOAD_GROUP,
+                  FLAG_PAYLOAD_GROUP == STORE_Header::PAYLOAD_GROUP &&
+                  FLAG_E2E_TRACED == STORE_Header::E2E_TRACED,
               "Flag constants don't match");
 
 using csi_flags_t = uint8_t;
@@ -253,13 +272,16 @@ Slice formRecordHeader(int64_t timestamp,
  *                              monotonically increasing order);
  *                              KeyType::FILTERABLE is used by server-side
  *                              filtering.[Experimental feature]
+ * @param local_flags           flags that don't come from STORE_Header, like
+ *                              FLAG_PAYLOAD_COMPRESSED, to add to the record
  */
 Slice formRecordHeader(const STORE_Header& store_header,
                        const StoreChainLink* copyset,
                        std::string* buf,
                        bool shard_id_in_copyset,
                        const std::map<KeyType, std::string>& optional_keys,
-                       const STORE_Extra& store_extra = STORE_Extra());
+                       const STORE_Extra& store_extra = STORE_Extra(),
+                       flags_t local_flags = 0);
 
 /**
  * Form copyset index entry flags from the content of a STORE_Header.
@@ -366,6 +388,11 @@ bool parseCopySetIndexSingleEntry(const Slice& cs_dir_slice,
  *              --write-shard-id-in-copyset for more than the total retention
  *              period and after all internal logs have been snapshotted.
  *
+ * `filterable_key_out` is set to the KeyType::FILTERABLE optional key, if the
+ *                      record has one, pointing into the blob. Cheaper than
+ *                      building `optional_keys` when that is the only key
+ *                      the caller needs, e.g. for server-side filtering.
+ *
  * @return On success, returns 0.  On failure, returns -1 and sets err to:
  *           MALFORMED_RECORD  parse error
  *           NOBUFS            copyset_arr_out_size was too small
@@ -382,7 +409,94 @@ int parse(const Slice& log_store_blob,
           OffsetMap* offsets_within_epoch,
           std::map<KeyType, std::string>* optional_keys,
           Payload* payload_out,
-          shard_index_t this_shard);
+          shard_index_t this_shard,
+          folly::Optional<folly::StringPiece>* filterable_key_out = nullptr);
+
+/**
+ * View of a record blob that decodes fields only when they are accessed.
+ * init() decodes the fixed-position header (timestamp, last known good, flags,
+ * wave and copyset size) and bounds-checks the copyset, which is all that
+ * many readers need. The copyset is only copied out by copyset(), and the
+ * variable-size part after it (offsets, optional keys, payload) is only walked
+ * the first time offsetsWithinEpoch() or payload() is called.
+ *
+ * Unlike parse(), the view only validates the parts of the blob it decodes;
+ * use parse() or checkWellFormed() when the whole record must be verified.
+ * The blob must outlive the view.
+ */
+class RecordView {
+ public:
+  /**
+   * @return On success, returns 0.  On failure, returns -1 and sets err to:
+   *           MALFORMED_RECORD  parse error
+   */
+  int init(const Slice& log_store_blob);
+
+  std::chrono::milliseconds timestamp() const {
+    return timestamp_;
+  }
+  esn_t lastKnownGood() const {
+    return last_known_good_;
+  }
+  flags_t flags() const {
+    return flags_;
+  }
+  uint32_t waveOrRecoveryEpoch() const {
+    return wave_or_recovery_epoch_;
+  }
+  copyset_size_t copysetSize() const {
+    return copyset_size_;
+  }
+
+  /**
+   * Copies the copyset into `copyset_out`, which must have room for
+   * copysetSize() entries. See parse() for `this_shard`.
+   */
+  void copyset(ShardID* copyset_out, shard_index_t this_shard) const;
+
+  /**
+   * Same as the `offsets_within_epoch` output of parse(): left untouched if
+   * the record has no offsets.
+   *
+   * @return On success, returns 0.  On failure, returns -1 and sets err to:
+   *           MALFORMED_RECORD  parse error
+   */
+  int offsetsWithinEpoch(OffsetMap* offsets_within_epoch_out);
+
+  /**
+   * @return On success, returns 0.  On failure, returns -1 and sets err to:
+   *           MALFORMED_RECORD  parse error
+   */
+  int payload(Payload* payload_out);
+
+  /**
+   * Part of the blob after the copyset. Used by parse().
+   */
+  Slice afterCopyset() const {
+    return Slice(copyset_end_, end_ - copyset_end_);
+  }
+
+ private:
+  // Walks the blob from copyset_end_ to the payload, decoding offsets on the
+  // way. Only done once.
+  int decodeTail();
+
+  const uint8_t* begin_ = nullptr;
+  const uint8_t* end_ = nullptr;
+  const uint8_t* copyset_begin_ = nullptr;
+  const uint8_t* copyset_end_ = nullptr;
+
+  std::chrono::milliseconds timestamp_{0};
+  esn_t last_known_good_{ESN_INVALID};
+  flags_t flags_ = 0;
+  uint32_t wave_or_recovery_epoch_ = 0;
+  copyset_size_t copyset_size_ = 0;
+
+  bool tail_decoded_ = false;
+  bool has_offsets_ = false;
+  OffsetMap offsets_within_epoch_;
+  const uint8_t* payload_begin_ = nullptr;
+};
 
 /**
  * Same as parse() but faster and only parses timestamp.
@@ -408,6 +522,8 @@ int getCopysetHash(const Slice& log_store_blob, size_t* hash_out);
 
 /**
  * Does some basic checks of record format, including payload checksum check.
+ * If the payload is compressed (FLAG_PAYLOAD_COMPRESSED), it's uncompressed
+ * to check the checksum.
  *
  * @param payload  Can be one of:
  *   - empty; the payload is in `blob`,
@@ -416,6 +532,49 @@ int getCopysetHash(const Slice& log_store_blob, size_t* hash_out);
  */
 int checkWellFormed(Slice blob, Slice payload = Slice());
 
+/**
+ * Same as checkWellFormed() for `n` records, where record i is made of
+ * blobs[i] and payloads[i]; `payloads` may be nullptr if all payloads are in
+ * the blobs. Checksums of all records are computed in one batch (see
+ * checksum_32bit_batch()), which is cheaper than checking records one by one
+ * when there are many small ones.
+ *
+ * @return  index of the first malformed record, with err set as by
+ *          checkWellFormed(), or `n` if all records are well formed.
+ */
+size_t checkWellFormedBatch(const Slice* blobs,
+                            const Slice* payloads,
+                            size_t n);
+
+/**
+ * Compresses a record payload so that it can be stored with
+ * FLAG_PAYLOAD_COMPRESSED, in the format described at the top of the file.
+ * The checksum, if any, is compressed along with the rest of the payload.
+ *
+ * @param zstd_level  compression level if `compression` is ZSTD
+ * @param min_size    payloads smaller than this are not compressed
+ *
+ * @return  true if *buf now contains the compressed payload. false if the
+ *          payload should be stored as is: compression is NONE, the payload
+ *          is too small, or compressing it doesn't save space.
+ */
+bool compressPayload(Compression compression,
+                     int zstd_level,
+                     size_t min_size,
+                     const Payload& payload,
+                     std::string* buf);
+
+/**
+ * Uncompresses the payload of a record that has FLAG_PAYLOAD_COMPRESSED, as
+ * returned by parse(). Everything that sends stored payloads out of the node
+ * (RECORD messages, tail records, rebuilding STOREs) goes through this, so
+ * that compression in the local log store is invisible to readers.
+ *
+ * @return  0 on success, with the original payload in *out. -1 and sets err
+ *          to MALFORMED_RECORD if the compressed payload can't be decoded.
+ */
+int uncompressPayload(const Payload& stored, folly::IOBuf* out);
+
 /**
  * Helper method to forms Slice from optional_keys
  * @ param  optional_keys_string  a pointer to string that will hold serialized
@@ -16,8 +16,10 @@
 #include "logdevice/common/AdminCommandTable.h"
 #include "logdevice/common/AllSequencers.h"
 #include "logdevice/common/LogIDUniqueQueue.h"
+#include "logdevice/common/LogRecoveryScheduler.h"
 #include "logdevice/common/MetaDataLogWriter.h"
 #include "logdevice/common/Processor.h"
+#include "logdevice/common/SealBatcher.h"
 #include "logdevice/common/Sequencer.h"
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/settings/Settings.h"
@@ -197,6 +199,9 @@ LogRecoveryRequest::~LogRecoveryRequest() {
   if (meta_reader_) {
     Worker::onThisThread()->disposeOfMetaReader(std::move(meta_reader_));
   }
+  if (scheduler_accounted_) {
+    Worker::onThisThread()->recoveryScheduler().onFinished(log_id_);
+  }
   ld_spew("[sequencer_activity_in_progress--] Destroyed LogRecoveryRequest for "
           "log %lu",
           log_id_.val());
@@ -254,15 +259,24 @@ Request::Execution LogRecoveryRequest::execute() {
       (settings.concurrent_log_recoveries + settings.num_workers - 1) /
       settings.num_workers;
 
+  // Data log recoveries are also limited by how many of them involve the
+  // same storage shard. A recovery always fits if nothing else is running,
+  // so that the queue can't get stuck.
+  const bool data_log = !internal && !MetaDataLog::isMetaDataLog(log_id_);
+  const bool shards_busy = data_log && !map.empty() &&
+      !w->recoveryScheduler().canStart(
+          seq_metadata_->shards, maxRecoveriesPerShard(settings));
+
   // If log_id_ is a data log, stop running this recovery and enqueue the logid
   // when number of active requests reaches recovery_requests_per_worker.
   // However, if log_id_ is a metadata log, the threshold is doubled so that
   // metadata log recovery can be prioritized.
-  if (!internal &&
-      ((!MetaDataLog::isMetaDataLog(log_id_) &&
-        map.size() >= recovery_requests_per_worker) ||
-       (MetaDataLog::isMetaDataLog(log_id_) &&
-        map.size() >= recovery_requests_per_worker * 2))) {
+  if (shards_busy ||
+      (!internal &&
+       ((!MetaDataLog::isMetaDataLog(log_id_) &&
+         map.size() >= recovery_requests_per_worker) ||
+        (MetaDataLog::isMetaDataLog(log_id_) &&
+         map.size() >= recovery_requests_per_worker * 2)))) {
     // Too many recovery requests are currently active. Add this log to Worker's
     // recoveryQueue_ so it'll be picked up when another LogRecoveryRequest
     // completes.
@@ -293,6 +307,10 @@ Request::Execution LogRecoveryRequest::execute() {
   std::unique_ptr<LogRecoveryRequest> rq(this);
   auto insert_it = map.insert(std::make_pair(log_id_, std::move(rq)));
   ld_check(insert_it.second);
+  if (data_log) {
+    w->recoveryScheduler().onStarted(log_id_, seq_metadata_->shards);
+    scheduler_accounted_ = true;
+  }
 
   if (settings.skip_recovery) {
     skipRecovery();
@@ -312,6 +330,14 @@ Request::Execution LogRecoveryRequest::execute() {
   return Execution::CONTINUE;
 }
 
+size_t LogRecoveryRequest::maxRecoveriesPerShard(const Settings& settings) {
+  if (settings.max_log_recoveries_per_shard <= 0) {
+    return 0;
+  }
+  return (settings.max_log_recoveries_per_shard + settings.num_workers - 1) /
+      settings.num_workers;
+}
+
 void LogRecoveryRequest::skipRecovery() {
   RATELIMIT_INFO(std::chrono::seconds(10),
                  10,
@@ -1065,8 +1091,18 @@ int LogRecoveryRequest::sendSeal(ShardID shard) {
   SEAL_Header header = *seal_header_;
   header.shard = shard.shard();
 
+  Worker* w = Worker::onThisThread();
+  // Batching needs a connection to the node to register the close callback
+  // on. The first SEAL to a node goes out on its own and establishes it.
+  if (Worker::settings().seal_batching &&
+      w->sender().registerOnSocketClosed(NodeID(shard.node()), socket_cb) ==
+          0) {
+    w->sealBatcher().queue(shard.node(), header);
+    return 0;
+  }
+
   auto msg = std::make_unique<SEAL_Message>(header);
-  return Worker::onThisThread()->sender().sendMessage(
+  return w->sender().sendMessage(
       std::move(msg), NodeID(shard.node()), &socket_cb);
 }
 
@@ -1476,7 +1512,12 @@ void LogRecoveryRequest::complete(Status status) {
     WORKER_STAT_INCR(recovery_completed);
   }
 
-  // let the next LogRecoveryRequest from the queue run
+  // let the next LogRecoveryRequest from the queue run, with the shards of
+  // this one no longer counted as busy
+  if (scheduler_accounted_) {
+    worker->recoveryScheduler().onFinished(log_id_);
+    scheduler_accounted_ = false;
+  }
   worker->popRecoveryRequest();
 
   auto& rqmap = worker->runningLogRecoveries().map;
@@ -94,6 +94,7 @@ namespace facebook { namespace logdevice {
  *
  */
 
+struct Settings;
 class Worker;
 
 // The set of LSNs recovered during recovery.
@@ -166,6 +167,9 @@ class LogRecoveryRequest : public Request,
 
   Execution execute() override;
 
+  // Per-worker share of --max-log-recoveries-per-shard, 0 if unlimited.
+  static size_t maxRecoveriesPerShard(const Settings& settings);
+
   void onSealMessageSent(ShardID to, epoch_t seal_epoch, Status status);
   void onSealReply(ShardID from, const SEALED_Message& reply);
 
@@ -456,6 +460,10 @@ class LogRecoveryRequest : public Request,
   // epoch metadata used by the sequencer to activate next_epoch_
   std::shared_ptr<const EpochMetaData> seq_metadata_;
 
+  // true if the shards of seq_metadata_ are accounted for in the Worker's
+  // LogRecoveryScheduler
+  bool scheduler_accounted_{false};
+
   std::chrono::milliseconds delay_; // see constructor
 
   // Total number of nodes in the nodeset.
@@ -0,0 +1,85 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/LogRecoveryScheduler.h"
+
+#include <algorithm>
+
+#include "logdevice/common/debug.h"
+
+namespace facebook { namespace logdevice {
+
+LogRecoveryScheduler::Iterator
+LogRecoveryScheduler::pickNext(LogIDUniqueQueue& queue,
+                               size_t scan_limit,
+                               size_t max_per_shard,
+                               const LogInfoFn& info) const {
+  auto& index = queue.q.get<LogIDUniqueQueue::FIFOIndex>();
+  auto best = index.end();
+  size_t best_pending = 0;
+  size_t scanned = 0;
+  for (auto it = index.begin();
+       it != index.end() && scanned < std::max<size_t>(scan_limit, 1);
+       ++it, ++scanned) {
+    folly::Optional<LogInfo> log_info = info(*it);
+    if (!log_info.has_value()) {
+      return it;
+    }
+    if (!canStart(log_info->shards, max_per_shard)) {
+      continue;
+    }
+    // Ties go to the log that was queued first.
+    if (best == index.end() || log_info->pending_appends > best_pending) {
+      best = it;
+      best_pending = log_info->pending_appends;
+    }
+  }
+  return best;
+}
+
+bool LogRecoveryScheduler::canStart(const StorageSet& shards,
+                                    size_t max_per_shard) const {
+  if (max_per_shard == 0) {
+    return true;
+  }
+  for (ShardID shard : shards) {
+    if (getShardLoad(shard) >= max_per_shard) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void LogRecoveryScheduler::onStarted(logid_t log, const StorageSet& shards) {
+  onFinished(log);
+  for (ShardID shard : shards) {
+    ++shard_load_[shard];
+  }
+  running_[log] = shards;
+}
+
+void LogRecoveryScheduler::onFinished(logid_t log) {
+  auto it = running_.find(log);
+  if (it == running_.end()) {
+    return;
+  }
+  for (ShardID shard : it->second) {
+    auto load = shard_load_.find(shard);
+    ld_check(load != shard_load_.end() && load->second > 0);
+    if (--load->second == 0) {
+      shard_load_.erase(load);
+    }
+  }
+  running_.erase(it);
+}
+
+size_t LogRecoveryScheduler::getShardLoad(ShardID shard) const {
+  auto it = shard_load_.find(shard);
+  return it == shard_load_.end() ? 0 : it->second;
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,82 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+
+#include <folly/Optional.h>
+
+#include "logdevice/common/LogIDUniqueQueue.h"
+#include "logdevice/common/ShardID.h"
+#include "logdevice/include/types.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Decides which queued data log a Worker recovers next.  After a node
+ *       running many sequencers fails, thousands of logs are queued for
+ *       recovery at once, and recovering them in FIFO order lets idle logs
+ *       delay the ones appends are waiting on, and lets logs sharing a few
+ *       storage shards pile seals, digests and CLEANs onto them.
+ *
+ *       The scheduler keeps track of the shards in the nodesets of running
+ *       recoveries.  pickNext() skips queued logs that would exceed the
+ *       per-shard limit (--max-log-recoveries-per-shard) and, among the first
+ *       few that don't, picks the one with the most appends in flight.
+ *
+ *       Not thread-safe, owned by Worker.
+ */
+
+class LogRecoveryScheduler {
+ public:
+  struct LogInfo {
+    // Shards the recovery of the log will talk to.
+    StorageSet shards;
+    // Appends waiting for the recovery to release them.
+    size_t pending_appends{0};
+  };
+
+  // Returns folly::none if the log no longer has a sequencer.
+  using LogInfoFn = std::function<folly::Optional<LogInfo>(logid_t)>;
+
+  using Iterator = decltype(LogIDUniqueQueue::q)::index<
+      LogIDUniqueQueue::FIFOIndex>::type::iterator;
+
+  /**
+   * Looks at up to `scan_limit' logs from the front of `queue'.
+   *
+   * @param max_per_shard  limit on the number of running recoveries that
+   *                       involve the same shard, 0 means no limit
+   * @return  the log to recover next, or queue's end() if none of the logs
+   *          looked at can start.  Logs `info' returns none for are returned
+   *          right away, so that the caller can drop them.
+   */
+  Iterator pickNext(LogIDUniqueQueue& queue,
+                    size_t scan_limit,
+                    size_t max_per_shard,
+                    const LogInfoFn& info) const;
+
+  // @return  true if a recovery involving `shards' fits the per-shard limit
+  bool canStart(const StorageSet& shards, size_t max_per_shard) const;
+
+  // Accounts for a recovery of `log' that involves `shards'.
+  void onStarted(logid_t log, const StorageSet& shards);
+
+  // Releases what onStarted() took for `log', if anything.
+  void onFinished(logid_t log);
+
+  // Number of running recoveries that involve `shard'.
+  size_t getShardLoad(ShardID shard) const;
+
+ private:
+  std::unordered_map<ShardID, size_t, ShardID::Hash> shard_load_;
+  std::unordered_map<logid_t, StorageSet, logid_t::Hash> running_;
+};
+
+}} // namespace facebook::logdevice
@@ -343,6 +343,7 @@ std::chrono::steady_clock::time_point NodeSetState::checkNotAvailableUntil(
   // increase the num counter, making the num correct again.
 
   if (old_reason != new_state.getReason()) {
+    generation_++;
     std::atomic<nodeset_ssize_t>& old_reason_unavailable_count =
         availability_counters_[static_cast<uint8_t>(old_reason)];
     old_reason_unavailable_count--;
@@ -418,6 +419,7 @@ void NodeSetState::clearNotAvailableUntil(ShardID shard) {
 
   // must have done a reset from an unavailable state
   ld_check(!consideredAvailable(reason));
+  generation_++;
   std::atomic<nodeset_ssize_t>& num =
       availability_counters_[static_cast<uint8_t>(reason)];
 
@@ -532,6 +534,10 @@ bool NodeSetState::setNotAvailableUntil(
           reasonString(new_reason),
           log_id_.val());
 
+  if (old_reason != new_reason) {
+    generation_++;
+  }
+
   if (old_reason != NotAvailableReason::NONE) {
     std::atomic<nodeset_ssize_t>& old_reason_unavailable_count =
         availability_counters_[static_cast<uint8_t>(old_reason)];
@@ -212,6 +212,12 @@ class NodeSetState : public std::enable_shared_from_this<NodeSetState> {
     return all_shards_cnt_;
   }
 
+  // Bumped whenever the NotAvailableReason of a shard changes. Lets users
+  // tell whether something they derived from the state is stale.
+  uint64_t getGeneration() const {
+    return generation_.load(std::memory_order_relaxed);
+  }
+
   bool containsShard(ShardID shard) const {
     return shard_states_.count(shard);
   }
@@ -360,6 +366,8 @@ class NodeSetState : public std::enable_shared_from_this<NodeSetState> {
   // when settings change, we don't need to update each and every NodeSetState
   // object.
   std::atomic<bool> graylisting_enabled_;
+
+  std::atomic<uint64_t> generation_{0};
 };
 
 }} // namespace facebook::logdevice
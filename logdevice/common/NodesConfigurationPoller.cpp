@@ -12,6 +12,7 @@
 #include "logdevice/common/Processor.h"
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/configuration/nodes/NodesConfigurationCodec.h"
+#include "logdevice/common/configuration/nodes/NodesConfigurationDiff.h"
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/common/util.h"
 
@@ -176,14 +177,25 @@ NodesConfigurationPoller::aggregateConfiguration(const std::string* config,
   return folly::Optional<std::string>(std::move(response.config_str));
 }
 
-void NodesConfigurationPoller::onConfigurationFetchResult(Poller::RoundID round,
-                                                          node_index_t source,
-                                                          Status st,
-                                                          std::string config) {
+void NodesConfigurationPoller::onConfigurationFetchResult(
+    Poller::RoundID round,
+    node_index_t source,
+    Status st,
+    std::string config,
+    std::shared_ptr<const configuration::nodes::NodesConfiguration> diff_base) {
   Poller::RequestResult result = Poller::RequestResult::OK;
-  if (st == Status::OK || st == Status::UPTODATE) {
-    result = Poller::RequestResult::OK;
-  } else {
+  if (diff_base && st == Status::OK) {
+    auto full = applyDiff(*diff_base, config);
+    if (full.has_value()) {
+      config = std::move(full).value();
+    } else {
+      // Not the source's fault, retry it asking for the full config.
+      diffs_disabled_ = true;
+      st = E::FAILED;
+      config.clear();
+      result = Poller::RequestResult::FAILURE_TRANSIENT;
+    }
+  } else if (st != Status::OK && st != Status::UPTODATE) {
     // in all other cases (e.g., E::TIMEOUT), graylist the source
     result = Poller::RequestResult::FAILURE_GRAYLIST;
   }
@@ -197,6 +209,32 @@ void NodesConfigurationPoller::onConfigurationFetchResult(Poller::RoundID round,
   }
 }
 
+folly::Optional<std::string> NodesConfigurationPoller::applyDiff(
+    const configuration::nodes::NodesConfiguration& base,
+    const std::string& diff) {
+  using configuration::nodes::NodesConfigurationDiff;
+  if (!diff_base_.has_value() || diff_base_->first != base.getVersion()) {
+    diff_base_.assign(std::make_pair(
+        base.getVersion(), NodesConfigurationDiff::serializeForDiff(base)));
+  }
+  folly::Optional<std::string> result;
+  if (!diff_base_->second.empty()) {
+    result = NodesConfigurationDiff::apply(diff_base_->second, diff);
+  }
+  if (!result.has_value()) {
+    WORKER_STAT_INCR(nodes_configuration_diffs_failed);
+    RATELIMIT_WARNING(std::chrono::seconds(10),
+                      2,
+                      "Could not apply a NodesConfiguration diff from version "
+                      "%lu: %s. Falling back to fetching the full config.",
+                      base.getVersion().val(),
+                      error_name(err));
+    return folly::none;
+  }
+  WORKER_STAT_INCR(nodes_configuration_diffs_applied);
+  return result;
+}
+
 void NodesConfigurationPoller::onPollerCallback(
     Status st,
     Poller::RoundID round,
@@ -262,23 +300,40 @@ NodesConfigurationPoller::sendRequestToNode(Poller::RoundID round,
 
   auto ticket = callback_helper_.ticket(
       RequestType::NODES_CONFIGURATION_MANAGER, folly::Executor::HI_PRI);
-  auto cb_wrapper = [ticket, round, node](Status status,
-                                          CONFIG_CHANGED_Header /* header */,
-                                          std::string config) {
-    ticket.postCallbackRequest([round, node, status, cfg = std::move(config)](
-                                   NodesConfigurationPoller* poller) mutable {
-      if (poller != nullptr) {
-        poller->onConfigurationFetchResult(round, node, status, std::move(cfg));
-      }
-    });
-  };
-
   folly::Optional<uint64_t> conditional_poll_version_msg;
   auto conditional_poll_version = getConditionalPollVersion();
   if (conditional_poll_version.has_value()) {
     conditional_poll_version_msg.assign(conditional_poll_version.value().val());
   }
 
+  // Ask for a diff if we have the config the server would diff against.
+  CONFIG_FETCH_Header::flags_t flags = 0;
+  std::shared_ptr<const configuration::nodes::NodesConfiguration> diff_base;
+  if (!diffs_disabled_ && Worker::settings().nodes_configuration_fetch_diffs &&
+      conditional_poll_version.has_value() &&
+      nodes_configuration->getVersion() == conditional_poll_version.value()) {
+    flags |= CONFIG_FETCH_Header::ACCEPT_NODES_CONFIGURATION_DIFF;
+    diff_base = nodes_configuration;
+  }
+
+  auto cb_wrapper = [ticket, round, node, diff_base](
+                        Status status,
+                        CONFIG_CHANGED_Header header,
+                        std::string config) {
+    auto base = header.config_type ==
+            CONFIG_CHANGED_Header::ConfigType::NODES_CONFIGURATION_DIFF
+        ? diff_base
+        : nullptr;
+    ticket.postCallbackRequest(
+        [round, node, status, cfg = std::move(config), base = std::move(base)](
+            NodesConfigurationPoller* poller) mutable {
+          if (poller != nullptr) {
+            poller->onConfigurationFetchResult(
+                round, node, status, std::move(cfg), std::move(base));
+          }
+        });
+  };
+
   // it doesn't matter where ConfigurationFetchRequest will be executed
   // as we always route the callback back to the poller context. However,
   // due to the current connection and worker thread model,
@@ -296,7 +351,8 @@ NodesConfigurationPoller::sendRequestToNode(Poller::RoundID round,
       polling_worker_id,
       // use the full round timeout as the RPC request timeout
       options_.round_timeout,
-      conditional_poll_version_msg);
+      conditional_poll_version_msg,
+      flags);
 
   int rv = worker->processor_->postRequest(rq);
   if (rv != 0 && err == E::NOBUFS) {
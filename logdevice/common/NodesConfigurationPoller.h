@@ -108,16 +108,33 @@ class NodesConfigurationPoller {
   // ensure total ordering among nodes to be picked for fetching config
   folly::Optional<u_int32_t> node_order_seed_;
 
+  // Set once a diff received from a server could not be applied. From then
+  // on this poller only asks for full configs.
+  bool diffs_disabled_{false};
+
+  // Serialization of the config diffs are applied to, cached as several
+  // servers usually reply with diffs from the same base in a round.
+  folly::Optional<std::pair<Version, std::string>> diff_base_;
+
   std::unique_ptr<Poller> createPoller();
 
   folly::Optional<std::string>
   aggregateConfiguration(const std::string* config,
                          NodeResponse response) const;
 
-  void onConfigurationFetchResult(Poller::RoundID round,
-                                  node_index_t source,
-                                  Status st,
-                                  std::string config);
+  // @param diff_base  if not nullptr, `config' is a diff from this config
+  void onConfigurationFetchResult(
+      Poller::RoundID round,
+      node_index_t source,
+      Status st,
+      std::string config,
+      std::shared_ptr<const configuration::nodes::NodesConfiguration>
+          diff_base);
+
+  // Turns a diff from `base' into the full serialized config.
+  folly::Optional<std::string>
+  applyDiff(const configuration::nodes::NodesConfiguration& base,
+            const std::string& diff);
 
   void onPollerCallback(Status st,
                         Poller::RoundID round,
@@ -0,0 +1,212 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/NumaPlacement.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <pthread.h>
+#include <sched.h>
+
+#include <boost/filesystem.hpp>
+#include <folly/Conv.h>
+#include <folly/FileUtil.h>
+#include <folly/Format.h>
+#include <folly/String.h>
+#include <sys/socket.h>
+#include <sys/sysmacros.h>
+
+#include "logdevice/common/config.h"
+#include "logdevice/common/debug.h"
+
+#ifdef LOGDEVICE_USING_JEMALLOC
+// See StatsJemalloc.h: the weak declaration lets us detect at runtime whether
+// the binary is actually linked with jemalloc.
+extern "C" int mallctl(const char*, void*, size_t*, void*, size_t)
+    __attribute__((__nothrow__, __weak__));
+#endif
+
+#ifndef SO_INCOMING_CPU
+#define SO_INCOMING_CPU 49 // Linux 3.19+
+#endif
+
+namespace facebook { namespace logdevice { namespace numa {
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+// Reads a small sysfs file and strips the trailing newline.
+bool readSysfsFile(const std::string& path, std::string* out) {
+  if (!folly::readFile(path.c_str(), *out)) {
+    return false;
+  }
+  *out = folly::trimWhitespace(*out).str();
+  return true;
+}
+
+#ifdef LOGDEVICE_USING_JEMALLOC
+// Returns the index of the jemalloc arena dedicated to `node`, creating it on
+// first use.  Returns -1 if arenas can't be created.
+int arenaForNode(int node) {
+  static std::mutex mutex;
+  static std::map<int, unsigned> arenas;
+
+  if (mallctl == nullptr) {
+    return -1;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = arenas.find(node);
+  if (it != arenas.end()) {
+    return it->second;
+  }
+
+  unsigned arena;
+  size_t len = sizeof(arena);
+  // "arenas.create" was called "arenas.extend" before jemalloc 5.
+  if (mallctl("arenas.create", &arena, &len, nullptr, 0) != 0 &&
+      mallctl("arenas.extend", &arena, &len, nullptr, 0) != 0) {
+    return -1;
+  }
+  arenas.emplace(node, arena);
+  return arena;
+}
+#endif
+
+} // namespace
+
+int parseCpuList(folly::StringPiece s, std::vector<int>* out) {
+  std::vector<int> cpus;
+  s = folly::trimWhitespace(s);
+  if (s.empty()) {
+    out->clear();
+    return 0;
+  }
+  std::vector<folly::StringPiece> ranges;
+  folly::split(',', s, ranges);
+  for (folly::StringPiece range : ranges) {
+    folly::StringPiece lo_str, hi_str;
+    if (!folly::split('-', range, lo_str, hi_str)) {
+      lo_str = hi_str = range;
+    }
+    auto lo = folly::tryTo<int>(lo_str);
+    auto hi = folly::tryTo<int>(hi_str);
+    if (!lo.hasValue() || !hi.hasValue() || lo.value() < 0 ||
+        lo.value() > hi.value()) {
+      return -1;
+    }
+    for (int cpu = lo.value(); cpu <= hi.value(); ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  *out = std::move(cpus);
+  return 0;
+}
+
+int nodeOfBlockDevice(dev_t dev) {
+  // /sys/dev/block/<major>:<minor> links to the device's directory in the
+  // sysfs device tree, e.g.
+  // /sys/devices/pci0000:00/0000:00:01.0/0000:01:00.0/nvme/nvme0/nvme0n1.
+  // The closest ancestor that has a numa_node attribute is the bus device
+  // the disk hangs off.
+  std::string link =
+      folly::sformat("/sys/dev/block/{}:{}", major(dev), minor(dev));
+  boost::system::error_code ec;
+  fs::path path = fs::canonical(link, ec);
+  if (ec) {
+    return -1;
+  }
+
+  const fs::path root("/sys/devices");
+  for (; !path.empty() && path != root; path = path.parent_path()) {
+    std::string contents;
+    if (!readSysfsFile((path / "numa_node").string(), &contents)) {
+      continue;
+    }
+    auto node = folly::tryTo<int>(contents);
+    // The kernel reports -1 if the device isn't associated with a node.
+    return node.hasValue() && node.value() >= 0 ? node.value() : -1;
+  }
+  return -1;
+}
+
+std::vector<int> cpusOfNode(int node) {
+  std::vector<int> cpus;
+  if (node < 0) {
+    return cpus;
+  }
+  std::string contents;
+  std::string path =
+      folly::sformat("/sys/devices/system/node/node{}/cpulist", node);
+  if (!readSysfsFile(path, &contents) || parseCpuList(contents, &cpus) != 0) {
+    ld_error("Failed to read the cpu list of NUMA node %d from %s",
+             node,
+             path.c_str());
+    cpus.clear();
+  }
+  return cpus;
+}
+
+int bindThisThreadToCpus(const std::vector<int>& cpus) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    if (cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &set);
+    }
+  }
+  int rv = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  if (rv != 0) {
+    ld_error("pthread_setaffinity_np() failed for cpus %s: %s",
+             folly::join(",", cpus).c_str(),
+             strerror(rv));
+    return -1;
+  }
+  return 0;
+}
+
+int incomingCpuOfSocket(int fd) {
+  int cpu = -1;
+  socklen_t len = sizeof(cpu);
+  if (getsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &len) != 0) {
+    return -1;
+  }
+  return cpu;
+}
+
+int bindThisThreadToNode(int node) {
+  std::vector<int> cpus = cpusOfNode(node);
+  if (cpus.empty() || bindThisThreadToCpus(cpus) != 0) {
+    return -1;
+  }
+
+#ifdef LOGDEVICE_USING_JEMALLOC
+  int arena = arenaForNode(node);
+  if (arena >= 0) {
+    unsigned arena_idx = arena;
+    if (mallctl("thread.arena",
+                nullptr,
+                nullptr,
+                &arena_idx,
+                sizeof(arena_idx)) != 0) {
+      ld_warning("Failed to switch thread to jemalloc arena %u for NUMA "
+                 "node %d",
+                 arena_idx,
+                 node);
+    }
+  }
+#endif
+
+  return 0;
+}
+
+}}} // namespace facebook::logdevice::numa
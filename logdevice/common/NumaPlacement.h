@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <folly/Range.h>
+#include <sys/types.h>
+
+namespace facebook { namespace logdevice { namespace numa {
+
+/**
+ * @file Helpers for placing threads close to the hardware they use.  All
+ *       topology information comes from sysfs; on machines (or containers)
+ *       where it's not available the functions report the node as unknown
+ *       and callers are expected to fall back to the default placement.
+ */
+
+/**
+ * Parses a cpu list in the kernel's format, e.g. "0-3,8,10-11".
+ *
+ * @return 0 on success, -1 if the string is malformed.  On success *out is
+ *         replaced with the sorted list of cpus.
+ */
+int parseCpuList(folly::StringPiece s, std::vector<int>* out);
+
+/**
+ * @return the NUMA node the block device `dev` (as reported in st_dev by
+ *         stat()) is attached to, or -1 if it can't be determined, e.g. for
+ *         virtual devices, tmpfs or single-node machines.
+ */
+int nodeOfBlockDevice(dev_t dev);
+
+/**
+ * @return the list of cpus belonging to the given NUMA node, or an empty
+ *         vector on error.
+ */
+std::vector<int> cpusOfNode(int node);
+
+/**
+ * Pins the calling thread to the cpus of `node` and, when running with
+ * jemalloc, makes it allocate from an arena dedicated to that node.  With
+ * the thread pinned, the kernel's first-touch policy places the arena's pages
+ * on the local node, and the dedicated arena keeps it from reusing memory
+ * freed by threads running on other nodes.
+ *
+ * @return 0 on success, -1 if the thread could not be pinned.  Failing to set
+ *         up the arena is not an error.
+ */
+int bindThisThreadToNode(int node);
+
+/**
+ * Pins the calling thread to the given cpus.
+ *
+ * @return 0 on success, -1 on failure.
+ */
+int bindThisThreadToCpus(const std::vector<int>& cpus);
+
+/**
+ * @return the cpu that last processed an incoming packet of the TCP socket
+ *         `fd` (SO_INCOMING_CPU), i.e. usually the cpu the NIC queue of the
+ *         connection is steered to, or -1 if unknown.
+ */
+int incomingCpuOfSocket(int fd);
+
+}}} // namespace facebook::logdevice::numa
@@ -8,6 +8,8 @@
 
 #include "logdevice/common/OffsetMap.h"
 
+#include <algorithm>
+
 #include "logdevice/common/protocol/ProtocolReader.h"
 #include "logdevice/common/protocol/ProtocolWriter.h"
 
@@ -25,12 +27,41 @@ OffsetMap::OffsetMap(const OffsetMap& om) noexcept {
   counterTypeMap_ = om.getCounterMap();
 }
 
+OffsetMap::CounterMap::iterator
+OffsetMap::findCounter(counter_type_t counter_type) {
+  auto it = std::lower_bound(
+      counterTypeMap_.begin(),
+      counterTypeMap_.end(),
+      counter_type,
+      [](const auto& entry, counter_type_t t) { return entry.first < t; });
+  return it != counterTypeMap_.end() && it->first == counter_type
+      ? it
+      : counterTypeMap_.end();
+}
+
+OffsetMap::CounterMap::const_iterator
+OffsetMap::findCounter(counter_type_t counter_type) const {
+  return const_cast<OffsetMap*>(this)->findCounter(counter_type);
+}
+
+uint64_t& OffsetMap::counterRef(counter_type_t counter_type) {
+  auto it = std::lower_bound(
+      counterTypeMap_.begin(),
+      counterTypeMap_.end(),
+      counter_type,
+      [](const auto& entry, counter_type_t t) { return entry.first < t; });
+  if (it == counterTypeMap_.end() || it->first != counter_type) {
+    it = counterTypeMap_.emplace(it, counter_type, 0);
+  }
+  return it->second;
+}
+
 void OffsetMap::setCounter(const counter_type_t counter_type,
                            uint64_t counter_val) {
   if (counter_val == BYTE_OFFSET_INVALID) {
-    counterTypeMap_.erase(counter_type);
+    unsetCounter(counter_type);
   } else {
-    counterTypeMap_[counter_type] = counter_val;
+    counterRef(counter_type) = counter_val;
   }
 }
 
@@ -39,14 +70,14 @@ bool OffsetMap::isValid() const {
 }
 
 uint64_t OffsetMap::getCounter(const counter_type_t counter_type) const {
-  auto it = counterTypeMap_.find(counter_type);
+  auto it = findCounter(counter_type);
   if (it == counterTypeMap_.end()) {
     return BYTE_OFFSET_INVALID;
   }
   return it->second;
 }
 
-const std::map<counter_type_t, uint64_t>& OffsetMap::getCounterMap() const {
+const OffsetMap::CounterMap& OffsetMap::getCounterMap() const {
   return counterTypeMap_;
 }
 
@@ -55,11 +86,14 @@ void OffsetMap::clear() {
 }
 
 void OffsetMap::unsetCounter(counter_type_t counter_type) {
-  counterTypeMap_.erase(counter_type);
+  auto it = findCounter(counter_type);
+  if (it != counterTypeMap_.end()) {
+    counterTypeMap_.erase(it);
+  }
 }
 
 bool OffsetMap::isValidOffset(const counter_type_t counter_type) const {
-  return counterTypeMap_.find(counter_type) != counterTypeMap_.end();
+  return findCounter(counter_type) != counterTypeMap_.end();
 }
 
 void OffsetMap::serialize(ProtocolWriter& writer) const {
@@ -84,7 +118,31 @@ void OffsetMap::deserialize(ProtocolReader& reader,
       err = E::BADMSG;
       return;
     }
-    counterTypeMap_[counter_type] = counter_val;
+    counterRef(counter_type) = counter_val;
+  }
+}
+
+void OffsetMap::serializeCompact(ProtocolWriter& writer) const {
+  writer.write(static_cast<uint8_t>(counterTypeMap_.size()));
+  for (const auto& counter : counterTypeMap_) {
+    writer.write(counter.first);
+    writer.writeVarint(counter.second);
+  }
+}
+
+void OffsetMap::deserializeCompact(ProtocolReader& reader) {
+  uint8_t counter_map_size = 0;
+  reader.read(&counter_map_size);
+  for (uint8_t counter = 0; counter < counter_map_size; ++counter) {
+    counter_type_t counter_type;
+    reader.read(&counter_type);
+    uint64_t counter_val;
+    reader.readVarint(&counter_val);
+    if (reader.error()) {
+      err = E::BADMSG;
+      return;
+    }
+    counterRef(counter_type) = counter_val;
   }
 }
 
@@ -107,7 +165,7 @@ bool OffsetMap::operator!=(const OffsetMap& om) const {
 OffsetMap OffsetMap::mergeOffsets(OffsetMap lhs, const OffsetMap& rhs) {
   OffsetMap om = std::move(lhs);
   for (auto& it : rhs.counterTypeMap_) {
-    om.counterTypeMap_[it.first] += it.second;
+    om.counterRef(it.first) += it.second;
   }
   return om;
 }
@@ -115,16 +173,17 @@ OffsetMap OffsetMap::mergeOffsets(OffsetMap lhs, const OffsetMap& rhs) {
 OffsetMap OffsetMap::getOffsetsDifference(OffsetMap lhs, const OffsetMap& rhs) {
   OffsetMap om = std::move(lhs);
   for (auto& it : rhs.counterTypeMap_) {
-    ld_check(om.counterTypeMap_[it.first] >= it.second);
-    om.counterTypeMap_[it.first] -= it.second;
+    uint64_t& counter = om.counterRef(it.first);
+    ld_check(counter >= it.second);
+    counter -= it.second;
   }
   return om;
 }
 
 OffsetMap OffsetMap::operator*(uint64_t scalar) const {
-  OffsetMap om;
-  for (auto& it : counterTypeMap_) {
-    om.counterTypeMap_[it.first] = it.second * scalar;
+  OffsetMap om(*this);
+  for (auto& it : om.counterTypeMap_) {
+    it.second *= scalar;
   }
   return om;
 }
@@ -145,7 +204,8 @@ OffsetMap::OffsetMap(OffsetMap&& om) noexcept {
 
 void OffsetMap::max(const OffsetMap& om) {
   for (auto& it : om.getCounterMap()) {
-    counterTypeMap_[it.first] = std::max(it.second, counterTypeMap_[it.first]);
+    uint64_t& counter = counterRef(it.first);
+    counter = std::max(it.second, counter);
   }
 }
 
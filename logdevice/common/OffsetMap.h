@@ -10,8 +10,10 @@
 
 #include <atomic>
 #include <map>
+#include <utility>
 
 #include <folly/SharedMutex.h>
+#include <folly/small_vector.h>
 
 #include "logdevice/common/SerializableData.h"
 #include "logdevice/include/RecordOffset.h"
@@ -29,6 +31,13 @@ class OffsetMap : public SerializableData {
   using SerializableData::deserialize;
   using SerializableData::serialize;
 
+  // (counter type, value) pairs sorted by counter type. Only a couple of
+  // counter types exist, so they are stored inline to keep copies of an
+  // OffsetMap (done for every record on logs tracking byte offsets) free of
+  // heap allocations.
+  using CounterMap =
+      folly::small_vector<std::pair<counter_type_t, uint64_t>, 2>;
+
   OffsetMap() noexcept = default;
   /*
    * Constructs an OffsetMap object from intializer_list. This constructor
@@ -56,7 +65,7 @@ class OffsetMap : public SerializableData {
    * get counterTypeMap_
    * @return  counterTypeMap_
    */
-  const std::map<counter_type_t, uint64_t>& getCounterMap() const;
+  const CounterMap& getCounterMap() const;
 
   /**
    * removes counter_type from counterTypeMap_
@@ -108,6 +117,18 @@ class OffsetMap : public SerializableData {
               bool evbuffer_zero_copy /* unused */,
               folly::Optional<size_t> expected_size = folly::none) override;
 
+  /**
+   * Same as serialize() but counter values are written as varints, so a
+   * typical BYTE_OFFSET takes 2-4 bytes instead of 8. Only used in messages
+   * sent to peers that support Compatibility::COMPACT_OFFSET_MAP.
+   */
+  void serializeCompact(ProtocolWriter& writer) const;
+
+  /**
+   * Reads an OffsetMap written by serializeCompact().
+   */
+  void deserializeCompact(ProtocolReader& reader);
+
   /**
    * Used to convert uint64_t offset to new OffsetMap format
    * returns  OffsetMap with only <BYTE_OFFSET, offset> stored
@@ -158,7 +179,14 @@ class OffsetMap : public SerializableData {
   bool operator!=(const OffsetMap& om) const;
 
  private:
-  std::map<counter_type_t, uint64_t> counterTypeMap_;
+  CounterMap::iterator findCounter(counter_type_t counter_type);
+  CounterMap::const_iterator findCounter(counter_type_t counter_type) const;
+
+  // Returns a reference to the value of counter_type, inserting it with a
+  // value of 0 if it's not there yet.
+  uint64_t& counterRef(counter_type_t counter_type);
+
+  CounterMap counterTypeMap_;
 };
 
 class AtomicOffsetMap {
@@ -0,0 +1,197 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+#include <folly/AtomicIntrusiveLinkedList.h>
+
+#include "logdevice/common/debug.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Per-thread pools of memory blocks of size sizeof(T), where a freed
+ *       block goes back to the pool of the thread that allocated it. Meant
+ *       for class-level operator new/delete of objects that are created on
+ *       one thread and destroyed on another, at a high rate (e.g. Requests
+ *       posted to another worker). ThreadLocalFreeList doesn't help there:
+ *       it caches blocks on the freeing thread, so the allocating thread
+ *       would keep going to the general purpose allocator, and every free
+ *       would be a cross-thread free.
+ *
+ *       A block freed on its owner thread is put on that thread's local list.
+ *       A block freed on any other thread is pushed onto the owner's
+ *       lock-free list of remotely freed blocks; the owner takes all of them
+ *       back in one batch the next time its local list is empty, much like
+ *       BatchedBufferDisposer. At most MAX_CACHED blocks are cached per
+ *       thread, the rest is returned with ::operator delete.
+ *
+ *       A pool outlives its thread until all blocks allocated from it are
+ *       freed.
+ */
+
+template <typename T>
+class OwnerThreadFreeList {
+ public:
+  static_assert(alignof(T) <= alignof(std::max_align_t),
+                "over-aligned types are not supported");
+
+  static constexpr size_t MAX_CACHED = 4096;
+
+  /**
+   * @return a block of sizeof(T) bytes, from this thread's pool if it has
+   *         one cached, otherwise from ::operator new.
+   */
+  static void* allocate() {
+    return Pool::get()->allocate();
+  }
+
+  /**
+   * Returns a block obtained from allocate(), on any thread, to the pool of
+   * the thread that allocated it.
+   */
+  static void deallocate(void* ptr) {
+    Pool::deallocate(ptr);
+  }
+
+  // @return number of blocks cached on this thread's local list, not counting
+  //         the ones freed by other threads and not taken back yet
+  static size_t size() {
+    Pool* pool = Pool::current();
+    return pool != nullptr ? pool->size() : 0;
+  }
+
+ private:
+  class Pool;
+
+  struct Header {
+    Pool* owner;
+    // link in the owner's list of blocks freed by other threads
+    folly::AtomicIntrusiveLinkedListHook<Header> hook;
+    // link in the owner's local list
+    Header* next;
+  };
+
+  // the block handed out starts right after the header, suitably aligned
+  static constexpr size_t HEADER_SIZE =
+      (sizeof(Header) + alignof(std::max_align_t) - 1) /
+      alignof(std::max_align_t) * alignof(std::max_align_t);
+
+  class Pool {
+   public:
+    // @return this thread's pool, created on first use
+    static Pool* get() {
+      Pool*& pool = threadPool().pool;
+      if (pool == nullptr) {
+        pool = new Pool();
+      }
+      return pool;
+    }
+
+    // @return this thread's pool, or nullptr if it doesn't have one
+    static Pool* current() {
+      return threadPool().pool;
+    }
+
+    void* allocate() {
+      if (local_ == nullptr) {
+        remote_.sweepOnce([this](Header* header) { putLocal(header); });
+      }
+      Header* header = local_;
+      if (header != nullptr) {
+        local_ = header->next;
+        --size_;
+      } else {
+        header = static_cast<Header*>(::operator new(HEADER_SIZE + sizeof(T)));
+        header->owner = this;
+      }
+      refs_.fetch_add(1, std::memory_order_relaxed);
+      return reinterpret_cast<char*>(header) + HEADER_SIZE;
+    }
+
+    static void deallocate(void* ptr) {
+      Header* header =
+          reinterpret_cast<Header*>(static_cast<char*>(ptr) - HEADER_SIZE);
+      Pool* owner = header->owner;
+      if (owner == current()) {
+        owner->putLocal(header);
+      } else {
+        owner->remote_.insertHead(header);
+      }
+      owner->release();
+    }
+
+    size_t size() const {
+      return size_;
+    }
+
+   private:
+    // Drops the thread's reference to its pool when the thread exits.
+    struct ThreadPool {
+      Pool* pool = nullptr;
+
+      ~ThreadPool() {
+        if (pool != nullptr) {
+          Pool* p = pool;
+          pool = nullptr;
+          p->release();
+        }
+      }
+    };
+
+    static ThreadPool& threadPool() {
+      static thread_local ThreadPool tp;
+      return tp;
+    }
+
+    ~Pool() {
+      remote_.sweepOnce([](Header* header) { ::operator delete(header); });
+      while (local_ != nullptr) {
+        Header* next = local_->next;
+        ::operator delete(local_);
+        local_ = next;
+      }
+    }
+
+    // only called on the owner thread
+    void putLocal(Header* header) {
+      ld_check(header->owner == this);
+      if (size_ >= MAX_CACHED) {
+        ::operator delete(header);
+        return;
+      }
+      header->next = local_;
+      local_ = header;
+      ++size_;
+    }
+
+    void release() {
+      if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete this;
+      }
+    }
+
+    // only accessed by the owner thread
+    Header* local_ = nullptr;
+    size_t size_ = 0;
+
+    // blocks freed by other threads
+    folly::AtomicIntrusiveLinkedList<Header, &Header::hook> remote_;
+    // one reference held by the owner thread until it exits, plus one per
+    // block allocated and not freed yet
+    std::atomic<size_t> refs_{1};
+  };
+};
+
+template <typename T>
+constexpr size_t OwnerThreadFreeList<T>::MAX_CACHED;
+
+}} // namespace facebook::logdevice
@@ -51,12 +51,11 @@ class PassThroughCopySetManager : public CopySetManager {
              folly::Optional<lsn_t>& block_starting_lsn_out,
              CopySetManager::State& csm_state) override {
     State& state = checked_downcast<State&>(csm_state);
-    CopySetSelector::Result res =
-        underlying_selector_->select(extras,
-                                     copyset_out,
-                                     copyset_size_out,
-                                     chain_out,
-                                     state.css_state.get());
+    CopySetSelector::Result res = selectCopySet(extras,
+                                                copyset_out,
+                                                copyset_size_out,
+                                                chain_out,
+                                                state.css_state.get());
 
     // see docblock for CopySetManager::shuffleCopySet
     shuffleCopySet(
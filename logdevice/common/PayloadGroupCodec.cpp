@@ -468,6 +468,93 @@ size_t PayloadGroupCodec::decode(Slice binary,
   return deserialized_size;
 }
 
+size_t PayloadGroupCodec::decode(Slice binary,
+                                 std::vector<DecodedColumn>& columns_out,
+                                 bool allow_buffer_sharing) {
+  thrift::CompressedPayloadGroups compressed_payload_groups;
+  const size_t deserialized_size = ThriftCodec::deserialize<ThriftSerializer>(
+      binary,
+      compressed_payload_groups,
+      apache::thrift::ExternalBufferSharing::SHARE_EXTERNAL_BUFFER);
+  if (deserialized_size == 0) {
+    err = E::BADMSG;
+    return 0;
+  }
+
+  folly::Optional<size_t> batch_size;
+  std::vector<DecodedColumn> columns;
+  columns.reserve(compressed_payload_groups.payloads_ref()->size());
+  for (auto& [key, compressed_payloads] :
+       *compressed_payload_groups.payloads_ref()) {
+    thrift::CompressedPayloadsMetadata metadata;
+    int rv = decodeMetadata(key, compressed_payloads, metadata);
+    if (rv != 0) {
+      err = E::BADMSG;
+      return 0;
+    }
+    const auto& descriptors = *metadata.descriptors_ref();
+    if (!batch_size) {
+      batch_size = descriptors.size();
+    } else if (descriptors.size() != *batch_size) {
+      RATELIMIT_ERROR(std::chrono::seconds(1),
+                      1,
+                      "Descriptors sizes mismatch for key %d: %zu vs %zu",
+                      key,
+                      *batch_size,
+                      descriptors.size());
+      err = E::BADMSG;
+      return 0;
+    }
+
+    DecodedColumn& column = columns.emplace_back();
+    column.key = key;
+    column.ranges.reserve(descriptors.size());
+    size_t offset = 0;
+    for (const auto& opt_descriptor : descriptors) {
+      if (auto descriptor = opt_descriptor.descriptor_ref()) {
+        const size_t size = *descriptor->uncompressed_size_ref();
+        column.ranges.push_back({offset, size, true});
+        offset += size;
+      } else {
+        column.ranges.push_back({offset, 0, false});
+      }
+    }
+
+    auto uncompressed_payloads =
+        uncompress(static_cast<Compression>(
+                       *compressed_payloads.payloads_compression_ref()),
+                   offset,
+                   *compressed_payloads.compressed_payloads_ref());
+    if (!uncompressed_payloads) {
+      err = E::BADMSG;
+      return 0;
+    }
+    if (uncompressed_payloads->computeChainDataLength() != offset) {
+      RATELIMIT_ERROR(std::chrono::seconds(1),
+                      1,
+                      "Payloads size mismatch for key %d: %zu bytes "
+                      "expected, but got %zu bytes",
+                      key,
+                      offset,
+                      uncompressed_payloads->computeChainDataLength());
+      err = E::BADMSG;
+      return 0;
+    }
+    if (!allow_buffer_sharing) {
+      // Payloads can share buffer with binary, if no compression was used,
+      // so make a copy if needed.
+      uncompressed_payloads->makeManaged();
+    }
+    uncompressed_payloads->coalesce();
+    column.data = std::move(uncompressed_payloads.value());
+  }
+
+  columns_out.insert(columns_out.end(),
+                     std::make_move_iterator(columns.begin()),
+                     std::make_move_iterator(columns.end()));
+  return deserialized_size;
+}
+
 namespace {
 std::vector<folly::Optional<PayloadDescriptor>>
 convert(const std::vector<thrift::OptionalPayloadDescriptor>& thrift) {
@@ -27,6 +27,26 @@ namespace facebook { namespace logdevice {
  */
 class PayloadGroupCodec {
  public:
+  /**
+   * Uncompressed payloads of one key across a batch of PayloadGroups, as
+   * returned by the columnar decode(). Payloads are not split into separate
+   * IOBufs; `ranges' tells where each of them is in `data'.
+   */
+  struct DecodedColumn {
+    struct Range {
+      size_t offset;
+      size_t length;
+      // False if the payload group doesn't contain the key. length is 0 then.
+      bool present;
+    };
+
+    PayloadKey key;
+    // Single contiguous buffer holding the payloads of this key.
+    folly::IOBuf data;
+    // One entry for each payload group of the batch, in order.
+    std::vector<Range> ranges;
+  };
+
   /**
    * Supports encoding of a sequence of payloads.
    */
@@ -141,6 +161,20 @@ class PayloadGroupCodec {
                        std::vector<PayloadGroup>& payload_groups_out,
                        bool allow_buffer_sharing);
 
+  /**
+   * Decodes PayloadGroups from binary representation into one column per key,
+   * without splitting the uncompressed data into individual payloads. All
+   * columns have one range per payload group of the batch. Decoded columns
+   * are appended to columns_out on success.
+   * Returns number of bytes consumed, or 0 in case of error.
+   * Resulting columns can optionally share data with input (for example in
+   * case it's uncompressed).
+   */
+  FOLLY_NODISCARD
+  static size_t decode(Slice binary,
+                       std::vector<DecodedColumn>& columns_out,
+                       bool allow_buffer_sharing);
+
   /**
    * Decodes compressed representation of payload groups batch.
    * Returns number of bytes consumed, or 0 in case of error.
@@ -49,6 +49,22 @@ PayloadHolder::PayloadHolder(copy_buffer_t, const void* buf, size_t size)
   ld_check(size < Message::MAX_LEN);
 }
 
+PayloadHolder PayloadHolder::takeString(std::string s) {
+  if (s.empty()) {
+    return PayloadHolder();
+  }
+  auto str = new std::string(std::move(s));
+  folly::IOBuf iobuf(
+      folly::IOBuf::TAKE_OWNERSHIP,
+      &(*str)[0],
+      str->size(),
+      [](void* /* buf */, void* userData) {
+        delete static_cast<std::string*>(userData);
+      },
+      str);
+  return PayloadHolder(std::move(iobuf));
+}
+
 void PayloadHolder::reset() {
   // Note that we can't use IOBuf::clear() here because it doesn't free/unlink
   // the memory, only adjusts the data pointer and length.
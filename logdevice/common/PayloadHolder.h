@@ -83,6 +83,9 @@ class PayloadHolder {
                                      bool ignore_size_limit = false) {
     return PayloadHolder(TAKE_OWNERSHIP, buf, size, ignore_size_limit);
   }
+  // Takes over the contents of `s' without copying them. Meant for big
+  // payloads that were built in a string, e.g. state machine snapshots.
+  static PayloadHolder takeString(std::string s);
 
   // Same as copy constructor.
   PayloadHolder clone() const {
@@ -65,6 +65,13 @@ std::string PrincipalIdentity::toString() const {
   return oss.str();
 }
 
+std::string PrincipalIdentity::accountingName() const {
+  if (primary_identity.first.empty() && primary_identity.second.empty()) {
+    return type;
+  }
+  return primary_identity.first + ":" + primary_identity.second;
+}
+
 bool PrincipalIdentity::isValidIdentityType(const std::string& idType) {
   return idType == IDENTITY_USER || idType == IDENTITY_SERVICE ||
       idType == IDENTITY_TIER || idType == IDENTITY_MACHINE ||
@@ -60,6 +60,13 @@ struct PrincipalIdentity {
 
   std::string toString() const;
 
+  /**
+   * Short name identifying the principal in per-principal stats: the
+   * primary identity as "<type>:<name>", or the principal type if there is
+   * no identity.
+   */
+  std::string accountingName() const;
+
   bool match(const std::string& idtype, const std::string& identity);
   static bool isValidIdentityType(const std::string& idType);
 };
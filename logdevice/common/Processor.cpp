@@ -36,7 +36,9 @@
 #include "logdevice/common/SecurityInformation.h"
 #include "logdevice/common/SequencerBatching.h"
 #include "logdevice/common/SequencerLocator.h"
+#include "logdevice/common/SequencerRedirectCache.h"
 #include "logdevice/common/TLSCredMonitor.h"
+#include "logdevice/common/TailInfoCache.h"
 #include "logdevice/common/Thread.h"
 #include "logdevice/common/TraceLogger.h"
 #include "logdevice/common/UpdateableSecurityInfo.h"
@@ -44,6 +46,7 @@
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/WorkerLoadBalancing.h"
 #include "logdevice/common/configuration/UpdateableConfig.h"
+#include "logdevice/common/configuration/nodes/NodesConfigurationHistory.h"
 #include "logdevice/common/configuration/nodes/NodesConfigurationManager.h"
 #include "logdevice/common/event_log/EventLogRebuildingSet.h"
 #include "logdevice/common/plugin/CommonBuiltinPlugins.h"
@@ -109,7 +112,7 @@ class ProcessorImpl {
         read_stream_debug_info_sampling_config_(
             processor->getPluginRegistry(),
             settings->all_read_streams_debug_config_path),
-        ssl_session_cache_(processor->stats_) {
+        ssl_session_cache_(processor->stats_, settings->num_workers) {
     dbg::externalLoggerLogLevel = settings->external_loglevel;
   }
 
@@ -124,6 +127,8 @@ class ProcessorImpl {
 
   WheelTimer wheel_timer_;
   AppendProbeController append_probe_controller_;
+  SequencerRedirectCache sequencer_redirect_cache_;
+  TailInfoCache tail_info_cache_;
   WorkerLoadBalancing worker_load_balancing_;
   ClientIdxAllocator client_idx_allocator_;
   ResourceBudget incoming_message_budget_;
@@ -214,6 +219,7 @@ void Processor::init() {
   }
 
   num_general_workers_ = local_settings->num_workers;
+  load_aware_request_placement_ = local_settings->load_aware_request_placement;
 
   auto config = config_->get();
   // It's important to set the initial cluster state before we start the
@@ -322,6 +328,7 @@ Processor::Processor(std::shared_ptr<UpdateableConfig> updateable_config,
       my_node_id_(std::move(my_node_id)) {
   ld_check(settings.get());
   num_general_workers_ = settings_->num_workers;
+  load_aware_request_placement_ = settings_->load_aware_request_placement;
   security_info_ = std::make_unique<UpdateableSecurityInfo>(
       config_->updateableServerConfig(), plugin_registry_, settings_->server);
 }
@@ -363,9 +370,16 @@ int Processor::getTargetThreadForRequest(const std::unique_ptr<Request>& rq) {
   ld_check_ge(target_thread, -1);
 
   // If the Request does not care about which thread it runs on, schedule it
-  // round-robin.
+  // round-robin, or on a lightly loaded worker.
   if (target_thread == -1) {
     target_thread = selectWorkerRandomly(rq->id_.val(), worker_type).val_;
+    if (load_aware_request_placement_ && worker_type == WorkerType::GENERAL) {
+      const int selected = selectWorkerLoadAware().val_;
+      if (selected != target_thread) {
+        STAT_INCR(stats_, requests_placed_by_load);
+        target_thread = selected;
+      }
+    }
   }
   return target_thread;
 }
@@ -683,6 +697,14 @@ AppendProbeController& Processor::appendProbeController() const {
   return impl_->append_probe_controller_;
 }
 
+SequencerRedirectCache& Processor::sequencerRedirectCache() const {
+  return impl_->sequencer_redirect_cache_;
+}
+
+TailInfoCache& Processor::tailInfoCache() const {
+  return impl_->tail_info_cache_;
+}
+
 AllSequencers& Processor::allSequencers() const {
   return *impl_->allSequencers_;
 }
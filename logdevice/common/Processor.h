@@ -35,6 +35,7 @@ namespace facebook { namespace logdevice {
 
 namespace configuration { namespace nodes {
 class NodesConfiguration;
+class NodesConfigurationHistory;
 class NodesConfigurationManager;
 }} // namespace configuration::nodes
 
@@ -58,6 +59,8 @@ class Request;
 class SequencerBatching;
 class ReadStreamDebugInfoSamplingConfig;
 class SequencerLocator;
+class SequencerRedirectCache;
+class TailInfoCache;
 class SSLSessionCache;
 class StatsHolder;
 class TraceLogger;
@@ -159,6 +162,10 @@ class Processor : public folly::enable_shared_from_this<Processor> {
 
   // BufferedWriter for batching by sequencers.  Initialized only on servers.
   std::unique_ptr<SequencerBatching> sequencer_batching_;
+  // Recent NodesConfigurations, used to answer CONFIG_FETCH with diffs.
+  // Initialized only on servers.
+  std::unique_ptr<configuration::nodes::NodesConfigurationHistory>
+      nodes_configuration_history_;
   // Used to detect that we are in a test environment without a
   // fully initialized processor;
   std::atomic<bool> initialized_{false};
@@ -515,6 +522,13 @@ class Processor : public folly::enable_shared_from_this<Processor> {
   // of probes to save bandwidth
   AppendProbeController& appendProbeController() const;
 
+  // Where clients found sequencers by following redirects, shared by all
+  // Workers
+  SequencerRedirectCache& sequencerRedirectCache() const;
+
+  // Tails of logs recently reported by sequencers, shared by all Workers
+  TailInfoCache& tailInfoCache() const;
+
   // a map from log ids to Sequencer objects owned by this Processor that
   // manage append requests on those logs.
   AllSequencers& allSequencers() const;
@@ -619,6 +633,13 @@ class Processor : public folly::enable_shared_from_this<Processor> {
 
   SequencerBatching& sequencerBatching();
 
+  // nullptr on clients and on servers with
+  // --nodes-configuration-diff-history-size=0.
+  configuration::nodes::NodesConfigurationHistory*
+  nodesConfigurationHistory() const {
+    return nodes_configuration_history_.get();
+  }
+
   const std::string& getName() {
     return name_;
   }
@@ -757,6 +778,9 @@ class Processor : public folly::enable_shared_from_this<Processor> {
   // is relatively expensive
   size_t num_general_workers_{0};
 
+  // Copy of Settings::load_aware_request_placement, for the same reason.
+  bool load_aware_request_placement_{false};
+
   // Callback called when settings are update
   void onSettingsUpdated();
 
@@ -494,7 +494,8 @@ ssize_t ReaderImpl::read(size_t nrecords,
 
     if (head.getType() == QueueEntry::Type::DATA) {
       if ((head.getData().flags_ & RECORD_Header::BUFFERED_WRITER_BLOB) &&
-          decode_buffered_writes_ && !without_payload_) {
+          decode_buffered_writes_ && !without_payload_ &&
+          !payload_hash_only_) {
         // The record contains a blob composed by BufferedWriter that we
         // should decode into records originally provided by the client.  This
         // call will do so and populate `pre_queue_' with entries that we'll
@@ -788,7 +789,8 @@ int ReaderBridgeImpl::onDataRecord(
     bool notify_when_consumed) {
   uint32_t nrecords = 1;
   if (record->flags_ & RECORD_Header::BUFFERED_WRITER_BLOB &&
-      owner_->decode_buffered_writes_ && !owner_->without_payload_) {
+      owner_->decode_buffered_writes_ && !owner_->without_payload_ &&
+      !owner_->payload_hash_only_) {
     // This record's payload was composed by BufferedWriter. Extract the number
     // of individual records inside the batch in order to correctly determine
     // whether to wake up the consumer (e.g. if a single batch with 100 records
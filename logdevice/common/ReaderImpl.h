@@ -53,7 +53,7 @@ class ReaderImpl : public Reader {
   void setMonitoringTier(MonitoringTier tier) override;
   void addMonitoringTag(std::string) override;
   void withoutPayload() override;
-  void payloadHashOnly();
+  void payloadHashOnly() override;
   void includeByteOffset() override;
   void doNotSkipPartiallyTrimmedSections() override;
   int isConnectionHealthy(logid_t) const override;
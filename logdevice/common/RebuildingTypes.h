@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -190,6 +191,50 @@ class ShardRebuildingInterface {
   // Fills the current row of @param table with debug information about the
   // state of rebuilding for this shard. Used by admin commands.
   virtual void getDebugInfo(InfoRebuildingShardsTable& table) const = 0;
+
+  // Opaque, implementation-specific description of a point up to which
+  // everything has been re-replicated. Lets shards added to the rebuilding set
+  // join an in-flight read pass instead of restarting it from the beginning.
+  struct Checkpoint {
+    virtual ~Checkpoint() = default;
+    // How many of the bytes read so far were read past the checkpoint, i.e.
+    // will be read again by a rebuilding resumed from this checkpoint.
+    size_t bytesReadPastCheckpoint{0};
+  };
+
+  // Returns nullptr if there's no checkpoint to resume from.
+  virtual std::shared_ptr<const Checkpoint> getCheckpoint() const {
+    return nullptr;
+  }
+
+  // Total bytes read so far, i.e. wasted if the rebuilding is restarted from
+  // scratch.
+  virtual size_t getBytesRead() const {
+    return 0;
+  }
+
+  // Can be called before start(). Makes this rebuilding start reading from
+  // `checkpoint`, obtained from a previous rebuilding of the same shard whose
+  // rebuilding set was a subset of ours, then do a follow-up pass over
+  // everything before the checkpoint, looking only for records that need to
+  // be rebuilt for `added_shards`.
+  virtual void
+  resumeFrom(std::shared_ptr<const Checkpoint> /* checkpoint */,
+             std::shared_ptr<const RebuildingSet> /* added_shards */) {}
+
+  // Can be called before start(), instead of resumeFrom(). Tells us that
+  // planning hasn't finished yet: the plan passed to start() is partial, and
+  // plans for more logs will be passed to addPlans(). Rebuilding doesn't
+  // complete until addPlans() is called with `last` = true.
+  virtual void expectMorePlans() {}
+
+  // Plans for logs that got planned after start(). Logs that join after the
+  // read pass went past some of their records are read again from the
+  // beginning in a follow-up pass.
+  virtual void
+  addPlans(std::unordered_map<logid_t, std::unique_ptr<RebuildingPlan>>
+           /* plans */,
+           bool /* last */) {}
 };
 
 // Encapsulates the difference between new-to-old and old-to-new rebuilding.
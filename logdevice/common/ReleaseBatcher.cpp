@@ -0,0 +1,107 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/ReleaseBatcher.h"
+
+#include <algorithm>
+
+#include "logdevice/common/Sender.h"
+#include "logdevice/common/Worker.h"
+#include "logdevice/common/protocol/Compatibility.h"
+#include "logdevice/common/protocol/MULTI_RELEASE_Message.h"
+#include "logdevice/common/stats/Stats.h"
+
+namespace facebook { namespace logdevice {
+
+void ReleaseBatcher::queue(node_index_t node, const RELEASE_Header& header) {
+  ld_check(header.shard != -1);
+  pending_[node].push_back(header);
+  scheduleFlush();
+}
+
+size_t ReleaseBatcher::getQueued(node_index_t node) const {
+  auto it = pending_.find(node);
+  return it == pending_.end() ? 0 : it->second.size();
+}
+
+void ReleaseBatcher::scheduleFlush() {
+  if (!flush_timer_.isAssigned()) {
+    flush_timer_.assign([this] { flush(); });
+  }
+  if (!flush_timer_.isActive()) {
+    flush_timer_.activate(std::chrono::microseconds(0));
+  }
+}
+
+void ReleaseBatcher::flush() {
+  auto pending = std::move(pending_);
+  pending_.clear();
+
+  for (auto& kv : pending) {
+    const node_index_t node = kv.first;
+    std::vector<RELEASE_Header>& headers = kv.second;
+
+    if (headers.size() == 1 || !supportsMultiRelease(node)) {
+      for (const RELEASE_Header& header : headers) {
+        if (sendRelease(node, header) != 0) {
+          onSendFailed(node, header, err);
+        }
+      }
+      continue;
+    }
+
+    for (size_t begin = 0; begin < headers.size();
+         begin += MULTI_RELEASE_Message::MAX_ENTRIES) {
+      const size_t end = std::min(
+          headers.size(), begin + MULTI_RELEASE_Message::MAX_ENTRIES);
+      std::vector<RELEASE_Header> batch(
+          headers.begin() + begin, headers.begin() + end);
+      if (sendMultiRelease(node, std::move(batch)) != 0) {
+        // Like in MULTI_RELEASE_Message::onSent(), a node that turned out
+        // not to support MULTI_RELEASE is a plain send failure.
+        const Status st = err == E::PROTONOSUPPORT ? E::FAILED : err;
+        for (size_t i = begin; i < end; ++i) {
+          onSendFailed(node, headers[i], st);
+        }
+      }
+    }
+  }
+}
+
+bool ReleaseBatcher::supportsMultiRelease(node_index_t node) const {
+  auto proto = Worker::onThisThread()->sender().getSocketProtocolVersion(node);
+  return proto.has_value() &&
+      proto.value() >= Compatibility::MULTI_RELEASE_SUPPORT;
+}
+
+int ReleaseBatcher::sendRelease(node_index_t node,
+                                const RELEASE_Header& header) {
+  auto msg = std::make_unique<RELEASE_Message>(header);
+  return Worker::onThisThread()->sender().sendMessage(
+      std::move(msg), NodeID(node));
+}
+
+int ReleaseBatcher::sendMultiRelease(node_index_t node,
+                                     std::vector<RELEASE_Header> headers) {
+  const size_t count = headers.size();
+  auto msg = std::make_unique<MULTI_RELEASE_Message>(std::move(headers));
+  int rv = Worker::onThisThread()->sender().sendMessage(
+      std::move(msg), NodeID(node));
+  if (rv == 0) {
+    WORKER_STAT_INCR(multi_release_messages_sent);
+    WORKER_STAT_ADD(multi_release_releases_batched, count);
+  }
+  return rv;
+}
+
+void ReleaseBatcher::onSendFailed(node_index_t node,
+                                  const RELEASE_Header& header,
+                                  Status status) {
+  RELEASE_Message::onReleaseSent(header, status, Address(NodeID(node)));
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "logdevice/common/Timer.h"
+#include "logdevice/common/protocol/RELEASE_Message.h"
+#include "logdevice/include/types.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Batches the RELEASEs that sequencers of a Worker send to storage nodes
+ *       from Sequencer::sendReleases(), i.e. periodic (retry and broadcast)
+ *       releases and releases after log recovery. With many logs per
+ *       sequencer node, each storage node otherwise gets one RELEASE per log
+ *       and shard on each of those occasions. RELEASEs queued for a node
+ *       during one event loop iteration are sent together in MULTI_RELEASE
+ *       messages.
+ *
+ *       Nodes that predate MULTI_RELEASE_SUPPORT, and flushes that found a
+ *       single RELEASE for a node, still get plain RELEASE messages. Failures
+ *       to send are reported to the Sequencers like failures of RELEASE
+ *       messages, so that they retry.
+ *
+ *       Not thread-safe, owned by Worker.
+ */
+
+class ReleaseBatcher {
+ public:
+  virtual ~ReleaseBatcher() {}
+
+  // Queues a RELEASE for shard `header.shard' of `node'.
+  void queue(node_index_t node, const RELEASE_Header& header);
+
+  // Number of RELEASEs queued for `node'.
+  size_t getQueued(node_index_t node) const;
+
+ protected:
+  // Arranges for flush() to be called once the current iteration of the
+  // event loop is done. Tests can override.
+  virtual void scheduleFlush();
+
+  // Sends everything queued.
+  void flush();
+
+  // The following are overridden in tests.
+
+  // @return  true if `node' is known to understand MULTI_RELEASE
+  virtual bool supportsMultiRelease(node_index_t node) const;
+  // @return  0 on success, -1 with err set on failure, like Sender
+  virtual int sendRelease(node_index_t node, const RELEASE_Header& header);
+  virtual int sendMultiRelease(node_index_t node,
+                               std::vector<RELEASE_Header> headers);
+  // Tells the Sequencer that its RELEASE couldn't be sent.
+  virtual void onSendFailed(node_index_t node,
+                            const RELEASE_Header& header,
+                            Status status);
+
+ private:
+  std::unordered_map<node_index_t, std::vector<RELEASE_Header>> pending_;
+  Timer flush_timer_;
+};
+
+}} // namespace facebook::logdevice
@@ -18,9 +18,10 @@ SSLFetcher::create(const std::string& cert_path,
                    const std::string& key_path,
                    const std::string& ca_path,
                    bool load_certs,
-                   StatsHolder* stats) {
-  std::unique_ptr<SSLFetcher> fetcher{
-      new SSLFetcher(cert_path, key_path, ca_path, load_certs, stats)};
+                   StatsHolder* stats,
+                   bool ktls_offload) {
+  std::unique_ptr<SSLFetcher> fetcher{new SSLFetcher(
+      cert_path, key_path, ca_path, load_certs, stats, ktls_offload)};
   fetcher->reloadSSLContext();
   return fetcher;
 }
@@ -29,11 +30,13 @@ SSLFetcher::SSLFetcher(const std::string& cert_path,
                        const std::string& key_path,
                        const std::string& ca_path,
                        bool load_certs,
-                       StatsHolder* stats)
+                       StatsHolder* stats,
+                       bool ktls_offload)
     : cert_path_(cert_path),
       key_path_(key_path),
       ca_path_(ca_path),
       load_certs_(load_certs),
+      ktls_offload_(ktls_offload),
       stats_(stats) {}
 
 std::shared_ptr<folly::SSLContext> SSLFetcher::getSSLContext() const {
@@ -57,6 +60,20 @@ void SSLFetcher::reloadSSLContext() {
     context_->setOptions(SSL_OP_NO_COMPRESSION);
     SSL_CTX_set_mode(context_->getSSLCtx(), SSL_MODE_RELEASE_BUFFERS);
 
+    if (ktls_offload_) {
+#ifdef SSL_OP_ENABLE_KTLS
+      // Once the handshake is done, OpenSSL installs the session keys in the
+      // socket and lets the kernel encrypt and decrypt records. Connections
+      // whose kernel or cipher doesn't support it silently stay in userspace.
+      context_->setOptions(SSL_OP_ENABLE_KTLS);
+#else
+      RATELIMIT_WARNING(std::chrono::seconds(10),
+                        1,
+                        "ssl-ktls-offload is set, but OpenSSL was built "
+                        "without kTLS support. Ignoring.");
+#endif
+    }
+
     context_->setSessionCacheContext(kSSLCacheContext);
 
     // Check peers cert not their hostname
@@ -32,7 +32,8 @@ class SSLFetcher {
                                             const std::string& key_path,
                                             const std::string& ca_path,
                                             bool load_certs,
-                                            StatsHolder* stats = nullptr);
+                                            StatsHolder* stats = nullptr,
+                                            bool ktls_offload = false);
 
   virtual ~SSLFetcher() = default;
 
@@ -56,13 +57,17 @@ class SSLFetcher {
              const std::string& key_path,
              const std::string& ca_path,
              bool load_certs,
-             StatsHolder* stats = nullptr);
+             StatsHolder* stats = nullptr,
+             bool ktls_offload = false);
 
  protected:
   const std::string cert_path_;
   const std::string key_path_;
   const std::string ca_path_;
   const bool load_certs_;
+  // Let OpenSSL hand the record layer of established connections to the
+  // kernel (kTLS). See Settings::ssl_ktls_offload.
+  const bool ktls_offload_;
 
   std::shared_ptr<folly::SSLContext> context_;
   StatsHolder* stats_{nullptr};
@@ -7,6 +7,8 @@
  */
 #include "logdevice/common/SSLSessionCache.h"
 
+#include <atomic>
+
 #include <folly/Range.h>
 
 #include "logdevice/common/debug.h"
@@ -22,8 +24,17 @@ folly::StringPiece id_from_session(const SSL_SESSION* session) {
 }
 }; // namespace
 
-folly::ssl::SSLSessionUniquePtr SSLSessionCache::getCachedSSLSession() const {
-  auto cached_session = cached_server_session_.rlock();
+size_t SSLSessionCache::shardIndex() const {
+  // Threads take shards in the order they first use any cache. Workers are
+  // long-lived, so this spreads them evenly.
+  static std::atomic<size_t> next_thread{0};
+  static thread_local size_t thread_idx = next_thread++;
+  return thread_idx % shards_.size();
+}
+
+folly::ssl::SSLSessionUniquePtr
+SSLSessionCache::getFromShard(const Shard& shard) const {
+  auto cached_session = shard.cached_server_session.rlock();
 
   auto session = cached_session->session.get();
   if (session == nullptr) {
@@ -41,10 +52,21 @@ folly::ssl::SSLSessionUniquePtr SSLSessionCache::getCachedSSLSession() const {
       return nullptr;
     }
   }
-  STAT_INCR(stats_, ssl_session_resumption_attempt);
   return folly::ssl::SSLSessionUniquePtr(SSL_SESSION_dup(session));
 }
 
+folly::ssl::SSLSessionUniquePtr SSLSessionCache::getCachedSSLSession() const {
+  const size_t idx = shardIndex();
+  auto session = getFromShard(shards_[idx]);
+  for (size_t i = 1; session == nullptr && i < shards_.size(); ++i) {
+    session = getFromShard(shards_[(idx + i) % shards_.size()]);
+  }
+  if (session != nullptr) {
+    STAT_INCR(stats_, ssl_session_resumption_attempt);
+  }
+  return session;
+}
+
 void SSLSessionCache::setCachedSSLSession(
     folly::ssl::SSLSessionUniquePtr session) {
   if (session == nullptr) {
@@ -56,13 +78,18 @@ void SSLSessionCache::setCachedSSLSession(
   }
 
   auto session_id = id_from_session(session.get());
+  auto& shard = shards_[shardIndex()];
 
-  auto cached_session_ulock = cached_server_session_.ulock();
-  if (session_id == cached_session_ulock->session_id) {
+  // Most connections resume the cached session and get the same one back.
+  // Check that under a shared lock, so that they don't serialize.
+  if (session_id == shard.cached_server_session.rlock()->session_id) {
     return;
   }
 
-  auto cached_session = cached_session_ulock.moveFromUpgradeToWrite();
+  auto cached_session = shard.cached_server_session.wlock();
+  if (session_id == cached_session->session_id) {
+    return;
+  }
 
   cached_session->session = std::move(session);
   cached_session->session_id = session_id.str();
@@ -74,4 +101,8 @@ void SSLSessionCache::onSessionResumptionSuccess() const {
   STAT_INCR(stats_, ssl_session_resumption_success);
 }
 
+void SSLSessionCache::onSessionResumptionMiss() const {
+  STAT_INCR(stats_, ssl_session_resumption_miss);
+}
+
 }} // namespace facebook::logdevice
@@ -7,9 +7,12 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <chrono>
+#include <vector>
 
 #include <folly/Function.h>
+#include <folly/concurrency/CacheLocality.h>
 #include <folly/Synchronized.h>
 #include <folly/portability/OpenSSL.h>
 #include <folly/ssl/OpenSSLPtrTypes.h>
@@ -25,18 +28,28 @@ class StatsHolder;
  * by all the outgoing connections. The main assumption here is that SSL
  * sessions can be re-used accross multiple LD servers so make sure that servers
  * are configured with "use-tls-ticket-seeds = true".
+ *
+ * Every worker connects through this cache, which makes it a point of
+ * contention when many connections are established at once, e.g. when a
+ * rolling restart brings a server back. So the session is cached in several
+ * shards, each used by a subset of the threads. A thread whose shard is empty
+ * borrows the session of another shard.
  */
 class SSLSessionCache {
  public:
   using TimeProvider =
       folly::Function<std::chrono::steady_clock::time_point() const>;
 
-  explicit SSLSessionCache(StatsHolder* stats = nullptr) : stats_(stats) {}
+  explicit SSLSessionCache(StatsHolder* stats = nullptr, size_t num_shards = 1)
+      : stats_(stats), shards_(std::max<size_t>(num_shards, 1)) {}
 
   // Used by tests to mock system time
   explicit SSLSessionCache(TimeProvider time_provider,
-                           StatsHolder* stats = nullptr)
-      : stats_(stats), time_provider_(std::move(time_provider)) {}
+                           StatsHolder* stats = nullptr,
+                           size_t num_shards = 1)
+      : stats_(stats),
+        time_provider_(std::move(time_provider)),
+        shards_(std::max<size_t>(num_shards, 1)) {}
 
   /**
    * Returns the cached SSL session, if no session is cached or we exceeded the
@@ -57,6 +70,12 @@ class SSLSessionCache {
    */
   void onSessionResumptionSuccess() const;
 
+  /**
+   * Called when the server didn't accept the session we offered and did a
+   * full handshake instead, for bumping stats.
+   */
+  void onSessionResumptionMiss() const;
+
  private:
   struct CachedSession {
     folly::ssl::SSLSessionUniquePtr session;
@@ -69,7 +88,17 @@ class SSLSessionCache {
     return std::chrono::steady_clock::now();
   };
 
-  folly::Synchronized<CachedSession> cached_server_session_;
+  struct alignas(folly::hardware_destructive_interference_size) Shard {
+    folly::Synchronized<CachedSession> cached_server_session;
+  };
+
+  // @return a copy of the session cached in `shard` if it's still valid
+  folly::ssl::SSLSessionUniquePtr getFromShard(const Shard& shard) const;
+
+  // @return index of the shard used by the calling thread
+  size_t shardIndex() const;
+
+  std::vector<Shard> shards_;
 };
 
 }} // namespace facebook::logdevice
@@ -0,0 +1,110 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/SealBatcher.h"
+
+#include <algorithm>
+
+#include "logdevice/common/LogRecoveryRequest.h"
+#include "logdevice/common/Sender.h"
+#include "logdevice/common/Worker.h"
+#include "logdevice/common/protocol/Compatibility.h"
+#include "logdevice/common/protocol/MULTI_SEAL_Message.h"
+#include "logdevice/common/stats/Stats.h"
+
+namespace facebook { namespace logdevice {
+
+void SealBatcher::queue(node_index_t node, const SEAL_Header& header) {
+  ld_check(header.shard != -1);
+  pending_[node].push_back(header);
+  scheduleFlush();
+}
+
+size_t SealBatcher::getQueued(node_index_t node) const {
+  auto it = pending_.find(node);
+  return it == pending_.end() ? 0 : it->second.size();
+}
+
+void SealBatcher::scheduleFlush() {
+  if (!flush_timer_.isAssigned()) {
+    flush_timer_.assign([this] { flush(); });
+  }
+  if (!flush_timer_.isActive()) {
+    flush_timer_.activate(std::chrono::microseconds(0));
+  }
+}
+
+void SealBatcher::flush() {
+  auto pending = std::move(pending_);
+  pending_.clear();
+
+  for (auto& kv : pending) {
+    const node_index_t node = kv.first;
+    std::vector<SEAL_Header>& headers = kv.second;
+
+    if (headers.size() == 1 || !supportsMultiSeal(node)) {
+      for (const SEAL_Header& header : headers) {
+        if (sendSeal(node, header) != 0) {
+          onSendFailed(node, header, err);
+        }
+      }
+      continue;
+    }
+
+    for (size_t begin = 0; begin < headers.size();
+         begin += MULTI_SEAL_Message::MAX_ENTRIES) {
+      const size_t end = std::min(
+          headers.size(), begin + MULTI_SEAL_Message::MAX_ENTRIES);
+      std::vector<SEAL_Header> batch(
+          headers.begin() + begin, headers.begin() + end);
+      if (sendMultiSeal(node, std::move(batch)) != 0) {
+        const Status st = err;
+        for (size_t i = begin; i < end; ++i) {
+          onSendFailed(node, headers[i], st);
+        }
+      }
+    }
+  }
+}
+
+bool SealBatcher::supportsMultiSeal(node_index_t node) const {
+  auto proto = Worker::onThisThread()->sender().getSocketProtocolVersion(node);
+  return proto.has_value() &&
+      proto.value() >= Compatibility::MULTI_SEAL_SUPPORT;
+}
+
+int SealBatcher::sendSeal(node_index_t node, const SEAL_Header& header) {
+  auto msg = std::make_unique<SEAL_Message>(header);
+  return Worker::onThisThread()->sender().sendMessage(
+      std::move(msg), NodeID(node));
+}
+
+int SealBatcher::sendMultiSeal(node_index_t node,
+                               std::vector<SEAL_Header> headers) {
+  const size_t count = headers.size();
+  auto msg = std::make_unique<MULTI_SEAL_Message>(std::move(headers));
+  int rv = Worker::onThisThread()->sender().sendMessage(
+      std::move(msg), NodeID(node));
+  if (rv == 0) {
+    WORKER_STAT_INCR(multi_seal_messages_sent);
+    WORKER_STAT_ADD(multi_seal_seals_batched, count);
+  }
+  return rv;
+}
+
+void SealBatcher::onSendFailed(node_index_t node,
+                               const SEAL_Header& header,
+                               Status status) {
+  auto& rqmap = Worker::onThisThread()->runningLogRecoveries().map;
+  auto it = rqmap.find(header.log_id);
+  if (it != rqmap.end()) {
+    it->second->onSealMessageSent(
+        ShardID(node, header.shard), header.seal_epoch, status);
+  }
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "logdevice/common/Timer.h"
+#include "logdevice/common/protocol/SEAL_Message.h"
+#include "logdevice/include/types.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Batches the SEALs that the log recoveries of a Worker send to storage
+ *       nodes. When a node activates thousands of sequencers at once, each of
+ *       their recoveries seals every shard of its nodeset, so each storage
+ *       node gets one SEAL per log and shard. SEALs queued for a node during
+ *       one event loop iteration are sent together in MULTI_SEAL messages.
+ *
+ *       Nodes that predate MULTI_SEAL_SUPPORT, and flushes that found a
+ *       single SEAL for a node, still get plain SEAL messages. Failures to
+ *       send are reported to the LogRecoveryRequests like failures of SEAL
+ *       messages, so that they retry.
+ *
+ *       Not thread-safe, owned by Worker.
+ */
+
+class SealBatcher {
+ public:
+  virtual ~SealBatcher() {}
+
+  // Queues a SEAL for shard `header.shard' of `node'.
+  void queue(node_index_t node, const SEAL_Header& header);
+
+  // Number of SEALs queued for `node'.
+  size_t getQueued(node_index_t node) const;
+
+ protected:
+  // Arranges for flush() to be called once the current iteration of the
+  // event loop is done. Tests can override.
+  virtual void scheduleFlush();
+
+  // Sends everything queued.
+  void flush();
+
+  // The following are overridden in tests.
+
+  // @return  true if `node' is known to understand MULTI_SEAL
+  virtual bool supportsMultiSeal(node_index_t node) const;
+  // @return  0 on success, -1 with err set on failure, like Sender
+  virtual int sendSeal(node_index_t node, const SEAL_Header& header);
+  virtual int sendMultiSeal(node_index_t node,
+                            std::vector<SEAL_Header> headers);
+  // Tells the LogRecoveryRequest that its SEAL couldn't be sent.
+  virtual void onSendFailed(node_index_t node,
+                            const SEAL_Header& header,
+                            Status status);
+
+ private:
+  std::unordered_map<node_index_t, std::vector<SEAL_Header>> pending_;
+  Timer flush_timer_;
+};
+
+}} // namespace facebook::logdevice
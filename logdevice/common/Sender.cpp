@@ -15,6 +15,7 @@
 #include <folly/Optional.h>
 #include <folly/Random.h>
 #include <folly/container/F14Map.h>
+#include <folly/hash/Hash.h>
 #include <folly/json.h>
 
 #include "logdevice/common/AdminCommandTable.h"
@@ -85,6 +86,23 @@ class SenderImpl {
   // attempts is controlled by a ConnectionThrottle.
   folly::F14NodeMap<node_index_t, std::unique_ptr<Connection>> server_conns_;
 
+  // Additional DATA connections to servers, for stripes 1 and up of
+  // Settings::data_connection_stripes; stripe 0 is the Connection in
+  // server_conns_. Slots are filled on first use, so some may be null.
+  folly::F14NodeMap<node_index_t, std::vector<std::unique_ptr<Connection>>>
+      striped_conns_;
+
+  template <typename Fn>
+  void forEachStripe(Fn&& fn) {
+    for (auto& entry : striped_conns_) {
+      for (auto& conn : entry.second) {
+        if (conn) {
+          fn(*conn);
+        }
+      }
+    }
+  }
+
   // a map of all Connections wrapping connections that were accepted from
   // clients, keyed by 32-bit client ids. This map is empty on clients.
   folly::F14NodeMap<ClientID, std::unique_ptr<Connection>, ClientID::Hash>
@@ -599,6 +617,12 @@ void Sender::flushOutputAndClose(Status reason) {
       ++open_socket_count;
     }
   }
+  impl_->forEachStripe([&](Connection& conn) {
+    if (!conn.isClosed()) {
+      conn.flushOutputAndClose(reason);
+      ++open_socket_count;
+    }
+  });
 
   for (auto& it : impl_->client_conns_) {
     if (it.second && !it.second->isClosed()) {
@@ -646,6 +670,15 @@ int Sender::closeServerSocket(NodeID peer, Status reason) {
     c->close(reason);
   }
 
+  auto stripes = impl_->striped_conns_.find(peer.index());
+  if (stripes != impl_->striped_conns_.end()) {
+    for (auto& conn : stripes->second) {
+      if (conn && !conn->isClosed()) {
+        conn->close(reason);
+      }
+    }
+  }
+
   return 0;
 }
 
@@ -658,6 +691,12 @@ std::pair<uint32_t, uint32_t> Sender::closeAllSockets() {
       entry.second->close(E::SHUTDOWN);
     }
   }
+  impl_->forEachStripe([&](Connection& conn) {
+    if (!conn.isClosed()) {
+      sockets_closed.first++;
+      conn.close(E::SHUTDOWN);
+    }
+  });
 
   for (auto& entry : impl_->client_conns_) {
     if (!entry.second->isClosed()) {
@@ -687,6 +726,7 @@ void Sender::shutdownSockets(folly::Executor* executor) {
   executor->add([&] {
     shutting_down_ = true;
     closeAllSockets();
+    impl_->striped_conns_.clear();
     impl_->server_conns_.clear();
     impl_->client_conns_.clear();
     sem.post();
@@ -717,6 +757,22 @@ bool Sender::isClosed() const {
       }
     }
   }
+  bool open_stripe = false;
+  impl_->forEachStripe([&](Connection& conn) {
+    if (conn.isClosed()) {
+      return;
+    }
+    open_stripe = true;
+    ++num_open_server_sockets;
+    size_t pending_bytes = conn.getBytesPending();
+    if (server_with_max_pending_bytes < pending_bytes) {
+      max_pending_work_server = &conn;
+      server_with_max_pending_bytes = pending_bytes;
+    }
+  });
+  if (open_stripe && !go_over_all_sockets) {
+    return false;
+  }
 
   int num_open_client_sockets = 0;
   ClientID max_pending_work_clientID;
@@ -984,6 +1040,63 @@ Connection* Sender::initServerConnection(NodeID nid, SocketType sock_type) {
   return it->second.get();
 }
 
+Connection* Sender::initStripeConnection(NodeID nid, size_t stripe) {
+  ld_check(stripe > 0);
+  // Config, SSL and generation checks are all done for the first Connection
+  // to the node, and the other stripes copy its parameters.
+  Connection* first = initServerConnection(nid, SocketType::DATA);
+  if (!first) {
+    return nullptr;
+  }
+  const NodeID peer = first->peer_name_.asNodeID();
+
+  auto& stripes = impl_->striped_conns_[peer.index()];
+  if (stripes.size() < stripe) {
+    stripes.resize(stripe);
+  }
+  auto& conn = stripes[stripe - 1];
+  if (conn &&
+      (conn->isClosed() || conn->getConnType() != first->getConnType() ||
+       !conn->peer_name_.asNodeID().equalsRelaxed(peer))) {
+    // Same as in initServerConnection(): replace the Connection, and close
+    // the old one on the next iteration of the event loop.
+    STAT_INCR(Worker::stats(), server_connection_close_backlog);
+    Worker::onThisThread()->add([s = std::move(conn)] {
+      if (s->good()) {
+        s->close(E::SSLREQUIRED);
+      }
+      STAT_DECR(Worker::stats(), server_connection_close_backlog);
+    });
+    ld_check(!conn);
+  }
+
+  if (!conn) {
+    try {
+      conn = connection_factory_->createConnection(
+          peer,
+          SocketType::DATA,
+          first->getConnType(),
+          first->flow_group_,
+          std::make_unique<SocketDependencies>(
+              Worker::onThisThread()->processor_, this));
+    } catch (ConstructorFailed& exp) {
+      ld_critical("Could not create server Connection to node %s "
+                  "stripe %zu. %s",
+                  toString(peer).c_str(),
+                  stripe,
+                  exp.what());
+      if (err == E::NOTINCONFIG || err == E::NOSSLCONFIG) {
+        return nullptr;
+      }
+      ld_check(false);
+      err = E::INTERNAL;
+      return nullptr;
+    }
+  }
+
+  return conn.get();
+}
+
 Sockaddr Sender::getSockaddr(const Address& addr) {
   if (addr.isClientAddress()) {
     auto pos = impl_->client_conns_.find(addr.id_.client_);
@@ -1048,9 +1161,20 @@ Connection* FOLLY_NULLABLE Sender::getConnection(const NodeID& nid,
     sock_type = SocketType::DATA;
   }
 
-  Connection* conn = initServerConnection(nid, sock_type);
+  Connection* conn;
+  const size_t num_stripes = settings_->data_connection_stripes;
+  folly::Optional<logid_t> stripe_key;
+  if (sock_type == SocketType::DATA && num_stripes > 1 &&
+      (stripe_key = msg.getStripeKey()).has_value()) {
+    const size_t stripe =
+        folly::hash::twang_mix64(stripe_key->val_) % num_stripes;
+    conn = stripe == 0 ? initServerConnection(nid, sock_type)
+                       : initStripeConnection(nid, stripe);
+  } else {
+    conn = initServerConnection(nid, sock_type);
+  }
   if (!conn) {
-    // err set by initServerConnection()
+    // err set by initServerConnection() or initStripeConnection()
     return nullptr;
   }
 
@@ -1366,9 +1490,18 @@ void DisconnectedClientCallback::operator()(Status st, const Address& name) {
 
 void Sender::noteConfigurationChanged(
     std::shared_ptr<const NodesConfiguration> nodes_configuration) {
+  // Connections only depend on the addresses and generations of nodes. Most
+  // updates (e.g. membership or sequencer weight changes) share both of those
+  // sections with the previous version, in which case there is nothing to
+  // re-validate.
+  const bool addresses_unchanged = nodes_ && nodes_configuration &&
+      nodes_->getServiceDiscovery() ==
+          nodes_configuration->getServiceDiscovery() &&
+      nodes_->getStorageConfig() == nodes_configuration->getStorageConfig();
   nodes_ = std::move(nodes_configuration);
 
-  auto it = impl_->server_conns_.begin();
+  auto it = addresses_unchanged ? impl_->server_conns_.end()
+                                : impl_->server_conns_.begin();
   std::vector<std::unique_ptr<Connection>> to_close;
   while (it != impl_->server_conns_.end()) {
     auto& s = it->second;
@@ -1415,6 +1548,22 @@ void Sender::noteConfigurationChanged(
     it = impl_->server_conns_.erase(it);
   }
 
+  // Stripes follow the first Connection to their node: if that one was
+  // destroyed above, so are they.
+  auto stripes = impl_->striped_conns_.begin();
+  while (stripes != impl_->striped_conns_.end()) {
+    if (impl_->server_conns_.count(stripes->first)) {
+      ++stripes;
+      continue;
+    }
+    for (auto& conn : stripes->second) {
+      if (conn) {
+        to_close.push_back(std::move(conn));
+      }
+    }
+    stripes = impl_->striped_conns_.erase(stripes);
+  }
+
   for (auto& socket : to_close) {
     socket->close(E::NOTINCONFIG);
   }
@@ -1488,6 +1637,8 @@ std::string Sender::dumpQueuedMessages(Address addr) const {
     for (const auto& entry : impl_->server_conns_) {
       entry.second->dumpQueuedMessages(&counts);
     }
+    impl_->forEachStripe(
+        [&](Connection& conn) { conn.dumpQueuedMessages(&counts); });
 
     for (const auto& entry : impl_->client_conns_) {
       entry.second->dumpQueuedMessages(&counts);
@@ -1505,6 +1656,7 @@ void Sender::forEachConnection(
   for (const auto& entry : impl_->server_conns_) {
     cb(*entry.second);
   }
+  impl_->forEachStripe([&](Connection& conn) { cb(conn); });
   for (const auto& entry : impl_->client_conns_) {
     cb(*entry.second);
   }
@@ -1580,6 +1732,10 @@ void Sender::cleanupConnections() {
           entry.first);
     }
   }
+  impl_->forEachStripe([&](Connection& conn) {
+    ++num_sockets;
+    close_if_slow(conn);
+  });
   for (auto& entry : impl_->client_conns_) {
     Connection* conn = entry.second.get();
     if (conn) {
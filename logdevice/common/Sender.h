@@ -918,6 +918,17 @@ class Sender : public SenderBase {
    */
   Connection* initServerConnection(NodeID nid, SocketType sock_type);
 
+  /**
+   * Like initServerConnection(), but returns the DATA Connection for the
+   * given stripe (1 to Settings::data_connection_stripes - 1) to nid; stripe
+   * 0 is the Connection returned by initServerConnection(). Creates the
+   * first Connection to nid as well if needed, and uses the same connection
+   * type and flow group as that one.
+   *
+   * @return same as initServerConnection()
+   */
+  Connection* initStripeConnection(NodeID nid, size_t stripe);
+
   /**
    * This method gets the Connection associated with a given ClientID. The
    * connection must already exist for this method to succeed.
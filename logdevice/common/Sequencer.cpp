@@ -25,12 +25,14 @@
 #include "logdevice/common/NodeID.h"
 #include "logdevice/common/PeriodicReleases.h"
 #include "logdevice/common/Processor.h"
+#include "logdevice/common/ReleaseBatcher.h"
 #include "logdevice/common/SequencerBackgroundActivator.h"
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/configuration/Configuration.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/common/protocol/APPEND_Message.h"
 #include "logdevice/common/protocol/RELEASE_Message.h"
+#include "logdevice/common/stats/ServerHistograms.h"
 #include "logdevice/common/util.h"
 
 namespace facebook { namespace logdevice {
@@ -998,6 +1000,11 @@ size_t Sequencer::getMaxWindowSize() const {
   return current == nullptr ? 0 : current->getMaxWindowSize();
 }
 
+size_t Sequencer::getWindowLimit() const {
+  auto current = getCurrentEpochSequencer();
+  return current == nullptr ? 0 : current->getWindowLimit();
+}
+
 folly::Optional<EpochSequencerImmutableOptions>
 Sequencer::getEpochSequencerOptions() const {
   auto current = getCurrentEpochSequencer();
@@ -1261,6 +1268,15 @@ void Sequencer::onRecoveryCompleted(
 
       tail_record_previous_epoch_.update(
           std::make_shared<TailRecord>(std::move(previous_epoch_tail)));
+
+      // The sequencer became ACTIVE when it activated the current epoch,
+      // which is also when it scheduled this recovery.
+      HISTOGRAM_ADD(stats_,
+                    log_recovery_full,
+                    std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch() -
+                        last_state_change_timestamp_)
+                        .count());
     }
   }
 
@@ -1460,6 +1476,21 @@ void Sequencer::clearNoRedirectUntil() {
   no_redirect_until_ = std::chrono::steady_clock::duration::min();
 }
 
+void Sequencer::setRebalancedTo(NodeID target,
+                                std::chrono::steady_clock::duration duration) {
+  rebalanced_to_.store(target);
+  rebalanced_until_.store(std::chrono::steady_clock::now().time_since_epoch() +
+                          duration);
+}
+
+NodeID Sequencer::getRebalancedTo() const {
+  if (std::chrono::steady_clock::now().time_since_epoch() >=
+      rebalanced_until_.load()) {
+    return NodeID();
+  }
+  return rebalanced_to_.load();
+}
+
 ///////////////////////////////////////////////
 
 /* static */
@@ -1565,6 +1596,10 @@ int Sequencer::sendReleases(lsn_t lsn,
     if (!pred || pred(lsn, release_type, shard)) {
       auto h = header;
       h.shard = shard.shard();
+      if (Worker::settings().release_batching) {
+        w->releaseBatcher().queue(shard.node(), h);
+        continue;
+      }
       if (sender.sendMessage(
               std::make_unique<RELEASE_Message>(h), shard.asNodeID()) != 0) {
         RATELIMIT_DEBUG(
@@ -361,6 +361,20 @@ class Sequencer {
    */
   void clearNoRedirectUntil();
 
+  /**
+   * Marks the log as moved to `target` by sequencer rebalancing for
+   * `duration`: appends that this node would handle get redirected to
+   * `target` instead.
+   */
+  void setRebalancedTo(NodeID target,
+                       std::chrono::steady_clock::duration duration);
+
+  /**
+   * @return   the node sequencer rebalancing moved the log to, or an invalid
+   *           NodeID if it wasn't moved or the move has expired.
+   */
+  NodeID getRebalancedTo() const;
+
   /////////////////////// LogRecovery ///////////////////////
 
   /**
@@ -479,7 +493,10 @@ class Sequencer {
    *                      send failed or 2) the epoch metadata for the given lsn
    *                      and release_type is not available or 3) historical
    *                      epoch metadata is not available. Will set err to
-   *                      E::AGAIN in case 2) and 3).
+   *                      E::AGAIN in case 2) and 3). With
+   *                      Settings::release_batching, the messages are only
+   *                      queued in the Worker's ReleaseBatcher, and failures
+   *                      to send them schedule periodic releases later.
    *
    * @seealso epochMetaDataAvailable
    */
@@ -594,6 +611,13 @@ class Sequencer {
    */
   size_t getMaxWindowSize() const;
 
+  /**
+   * @return    the current limit on appends in flight in the current epoch,
+   *            see EpochSequencer::getWindowLimit().  0 if there is no active
+   *            valid current epoch of the Sequencer.
+   */
+  size_t getWindowLimit() const;
+
   /**
    * Returns the ImmutableOptions of the current epoch sequencer.
    * If there's no epoch sequencer, returns false.
@@ -920,6 +944,12 @@ class Sequencer {
   std::atomic<std::chrono::steady_clock::duration> no_redirect_until_{
       std::chrono::steady_clock::duration::min()};
 
+  // Node that sequencer rebalancing moved the log to, and until when appends
+  // should be redirected there. See setRebalancedTo().
+  std::atomic<NodeID> rebalanced_to_{NodeID()};
+  std::atomic<std::chrono::steady_clock::duration> rebalanced_until_{
+      std::chrono::steady_clock::duration::min()};
+
   // Maximum effective_since ever read by recovery.
   // @seealso onSequencerMetaDataRead
   std::atomic<epoch_t::raw_type> max_effective_since_read_{EPOCH_INVALID.val_};
@@ -48,6 +48,7 @@ static BufferedWriter::LogOptions get_log_options(logid_t log_id) {
   const auto& settings = Worker::settings();
 
   const auto group = config->getLogGroupByIDShared(log_id);
+  opts.adaptive_time_trigger = settings.sequencer_batching_adaptive;
 
   if (!group) {
     opts.time_trigger = settings.sequencer_batching_time_trigger;
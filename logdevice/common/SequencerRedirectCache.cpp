@@ -0,0 +1,68 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/SequencerRedirectCache.h"
+
+#include "logdevice/common/debug.h"
+
+namespace facebook { namespace logdevice {
+
+NodeID SequencerRedirectCache::lookup(logid_t log, NodeID located) {
+  folly::SharedMutex::ReadHolder guard(mutex_);
+  auto it = entries_.find(log);
+  if (it == entries_.end() || it->second.located != located ||
+      it->second.expires <= now()) {
+    return NodeID();
+  }
+  return it->second.to;
+}
+
+bool SequencerRedirectCache::noteRedirect(logid_t log,
+                                          NodeID located,
+                                          NodeID to,
+                                          std::chrono::milliseconds ttl) {
+  ld_check(located.isNodeID());
+  ld_check(to.isNodeID());
+  const TimePoint t = now();
+  folly::SharedMutex::WriteHolder guard(mutex_);
+  garbageCollect(t);
+  entries_[log] = Entry{located, to, t + ttl};
+
+  auto res = targets_.emplace(to, t + ttl);
+  if (!res.second && res.first->second > t) {
+    return false;
+  }
+  res.first->second = t + ttl;
+  return true;
+}
+
+void SequencerRedirectCache::invalidate(logid_t log, NodeID to) {
+  folly::SharedMutex::WriteHolder guard(mutex_);
+  auto it = entries_.find(log);
+  if (it != entries_.end() && it->second.to == to) {
+    ld_debug("Dropping cached redirect of log %lu to %s",
+             log.val_,
+             to.toString().c_str());
+    entries_.erase(it);
+  }
+}
+
+void SequencerRedirectCache::garbageCollect(TimePoint t) {
+  // Expired entries are harmless, only sweep them once in a while.
+  if (t - last_gc_ < std::chrono::seconds(1)) {
+    return;
+  }
+  last_gc_ = t;
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    it = it->second.expires <= t ? entries_.erase(it) : std::next(it);
+  }
+  for (auto it = targets_.begin(); it != targets_.end();) {
+    it = it->second <= t ? targets_.erase(it) : std::next(it);
+  }
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,89 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <chrono>
+#include <unordered_map>
+
+#include <folly/SharedMutex.h>
+
+#include "logdevice/include/types.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file  Remembers, across all Workers of a client, where sequencers were
+ *        found by following redirects.  When a sequencer fails over or the
+ *        cluster config changes, the node SequencerLocator picks for a log
+ *        may keep redirecting to the node that now runs the sequencer.
+ *        Without this cache every append pays for that redirect; with it,
+ *        only the appends already in flight do, and the rest go straight to
+ *        the new sequencer.
+ *
+ *        An entry maps a log and the node SequencerLocator picked for it to
+ *        the node it redirected to.  It's only used while the locator keeps
+ *        picking the same node, and for a limited time after the redirect
+ *        (--sequencer-redirect-cache-ttl).
+ *
+ *        This class is thread-safe.
+ */
+
+class SequencerRedirectCache {
+ public:
+  using TimePoint = std::chrono::steady_clock::time_point;
+
+  virtual ~SequencerRedirectCache() {}
+
+  /**
+   * @param located  node SequencerLocator picked for the log
+   * @return  node `located' recently redirected appends to `log' to, or an
+   *          invalid NodeID if there's no such entry
+   */
+  NodeID lookup(logid_t log, NodeID located);
+
+  /**
+   * Notes that appends to `log' sent to `located' end up on `to', for the
+   * next `ttl'.
+   *
+   * @return  true if `to' wasn't a redirect target for any log during the
+   *          last `ttl', i.e. it's worth warming up connections to it
+   */
+  bool noteRedirect(logid_t log,
+                    NodeID located,
+                    NodeID to,
+                    std::chrono::milliseconds ttl);
+
+  /**
+   * Drops the entry for `log' if it points to `to', e.g. because `to' is
+   * unreachable or redirected the append elsewhere.
+   */
+  void invalidate(logid_t log, NodeID to);
+
+ protected:
+  virtual TimePoint now() const {
+    return std::chrono::steady_clock::now();
+  }
+
+ private:
+  struct Entry {
+    NodeID located;
+    NodeID to;
+    TimePoint expires;
+  };
+
+  void garbageCollect(TimePoint now);
+
+  std::unordered_map<logid_t, Entry, logid_t::Hash> entries_;
+  // Redirect targets and until when noteRedirect() won't report them as new.
+  std::unordered_map<NodeID, TimePoint, NodeID::Hash> targets_;
+  // When expired entries were last removed.
+  TimePoint last_gc_{};
+  folly::SharedMutex mutex_;
+};
+
+}} // namespace facebook::logdevice
@@ -10,9 +10,11 @@
 #include "logdevice/common/MetaDataLog.h"
 #include "logdevice/common/Processor.h"
 #include "logdevice/common/SequencerLocator.h"
+#include "logdevice/common/SequencerRedirectCache.h"
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/configuration/Configuration.h"
 #include "logdevice/common/debug.h"
+#include "logdevice/common/request_util.h"
 #include "logdevice/common/settings/Settings.h"
 
 namespace facebook { namespace logdevice {
@@ -65,6 +67,18 @@ void SequencerRouter::start() {
       return;
     }
 
+    router->located_ = node_id;
+    auto cache = router->getRedirectCache();
+    NodeID cached =
+        cache ? cache->lookup(router->log_id_, node_id) : NodeID();
+    if (cached.isNodeID() && cached != router->last_unavailable_.first) {
+      // This node recently redirected appends to this log, skip the detour.
+      WORKER_STAT_INCR(client.sequencer_redirect_cache_hits);
+      router->cached_target_ = cached;
+      router->sendTo(cached, flags_t(0));
+      return;
+    }
+
     router->sendTo(node_id, flags_t(0));
   };
 
@@ -161,6 +175,21 @@ void SequencerRouter::onRedirected(NodeID from, NodeID to, Status status) {
              handler_);
   }
 
+  // Whether the redirect tells where the node picked by SequencerLocator
+  // sends appends to.
+  const bool redirect_of_located =
+      located_.isNodeID() && (from == located_ || from == cached_target_);
+  if (located_.isNodeID() && from == located_ && status == E::REDIRECTED) {
+    located_redirect_ = to;
+  }
+  if (from == cached_target_) {
+    auto cache = getRedirectCache();
+    if (cache) {
+      cache->invalidate(log_id_, from);
+    }
+    cached_target_ = NodeID();
+  }
+
   if (!last_reply_.node.isNodeID()) {
     // Add the first visited node to the `redirected_' set. This reduces the
     // number of messages sent in case of a redirect cycle.
@@ -229,9 +258,11 @@ void SequencerRouter::onRedirected(NodeID from, NodeID to, Status status) {
   if (status == E::REDIRECTED) {
     std::string nodes_in_cycle;
     // Check if we were redirected to the same node before (i.e. there's a
-    // redirect cycle). When this happens, we'll pick the node with the highest
-    // id (if multiple clients get stuck in the same cycle, we'd want them all
-    // to eventually append to the same node in order to prevent multiple
+    // redirect cycle). When this happens, we'll pick the node that the node
+    // the log maps to redirected us to if it's in the cycle (e.g. sequencer
+    // rebalancing moved the log there), or else the node with the highest id
+    // (if multiple clients get stuck in the same cycle, we'd want them all to
+    // eventually append to the same node in order to prevent multiple
     // reactivations) in the cycle and call sendTo() with REDIRECT_CYCLE flag
     // set.
     auto it = redirected_.find(to);
@@ -249,6 +280,10 @@ void SequencerRouter::onRedirected(NodeID from, NodeID to, Status status) {
         }
       }
       ld_check(target.isNodeID());
+      auto located_it = redirected_.find(located_redirect_);
+      if (located_it != redirected_.end() && located_it->second >= d) {
+        target = located_redirect_;
+      }
 
       flags_t flags = REDIRECT_CYCLE;
       if (preempted_nodes_.find(target) != preempted_nodes_.end()) {
@@ -306,6 +341,19 @@ void SequencerRouter::onRedirected(NodeID from, NodeID to, Status status) {
     }
   }
 
+  auto cache = getRedirectCache();
+  if (cache && redirect_of_located) {
+    // Let other appends to this log skip the redirect. If `to' wasn't a
+    // sequencer before, it likely just took over sequencers of a failed node;
+    // get the other Workers connected to it ahead of their appends.
+    if (cache->noteRedirect(log_id_,
+                            located_,
+                            to,
+                            getSettings().sequencer_redirect_cache_ttl)) {
+      prewarmConnections(to);
+    }
+  }
+
   sendTo(to, flags_t(0));
 }
 
@@ -366,6 +414,17 @@ void SequencerRouter::onDeadNode(NodeID node, Status status) {
 void SequencerRouter::onNodeUnavailable(NodeID node, Status status) {
   NodeID last_node = last_reply_.node;
 
+  // If other appends to this log are sent to `node' because of an earlier
+  // redirect, stop doing that. If we got here through the cache, start()
+  // below will fall back to the node SequencerLocator picks.
+  auto cache = getRedirectCache();
+  if (cache) {
+    cache->invalidate(log_id_, node);
+  }
+  if (node == cached_target_) {
+    cached_target_ = NodeID();
+  }
+
   onDeadNode(node, status);
 
   if (!last_node.isNodeID()) { // not set
@@ -558,6 +617,36 @@ ClusterState* SequencerRouter::getClusterState() const {
   return Worker::getClusterState();
 }
 
+SequencerRedirectCache* SequencerRouter::getRedirectCache() const {
+  const Settings& settings = getSettings();
+  if (settings.server ||
+      settings.sequencer_redirect_cache_ttl.count() == 0) {
+    return nullptr;
+  }
+  return &Worker::onThisThread()->processor_->sequencerRedirectCache();
+}
+
+void SequencerRouter::prewarmConnections(NodeID node) {
+  Worker* current = Worker::onThisThread();
+  Processor* processor = current->processor_;
+  processor->applyToWorkerPool(
+      [&](Worker& w) {
+        if (&w == current) {
+          // We're about to send to it anyway.
+          return;
+        }
+        auto req = FuncRequest::make(
+            w.idx_,
+            w.worker_type_,
+            RequestType::PREWARM_SEQUENCER_CONNECTION,
+            [node] { Worker::onThisThread()->sender().connect(node); });
+        processor->postRequest(req);
+      },
+      Processor::Order::FORWARD,
+      current->worker_type_);
+  WORKER_STAT_INCR(client.sequencer_connections_prewarmed);
+}
+
 void SequencerRouter::startClusterStateRefreshTimer() {
   if (getSettings().sequencer_router_internal_timeout <
           std::chrono::milliseconds::max() &&
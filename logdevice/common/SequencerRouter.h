@@ -40,6 +40,7 @@ namespace facebook { namespace logdevice {
  */
 
 class SequencerLocator;
+class SequencerRedirectCache;
 struct Settings;
 
 class SequencerRouter {
@@ -139,6 +140,14 @@ class SequencerRouter {
   // Returns a pointer to the ClusterState object to check cluster/nodes health
   virtual ClusterState* getClusterState() const;
 
+  // Returns the cache of redirects shared by all Workers, or nullptr if
+  // redirects shouldn't be cached.
+  virtual SequencerRedirectCache* getRedirectCache() const;
+
+  // Opens connections to `node' from the other Workers, so that their appends
+  // following a redirect to it don't wait for a handshake.
+  virtual void prewarmConnections(NodeID node);
+
   // Called when cluster_state_refresh_timer_ expires, and initiates an
   // asynchronous cluster state refresh
   virtual void onTimeout();
@@ -187,6 +196,16 @@ class SequencerRouter {
   // Flags used in the most recent call to sendTo().
   flags_t flags_{0};
 
+  // Node SequencerLocator picked in the most recent start(), and the node we
+  // sent to instead because getRedirectCache() said `located_' redirects
+  // there.
+  NodeID located_{};
+  NodeID cached_target_{};
+
+  // Node that `located_' redirected us to, if it did. Preferred when breaking
+  // a redirect cycle, see onRedirected().
+  NodeID located_redirect_{};
+
   // If we haven't received a reply from any of the nodes yet (i.e. we're still
   // trying to find the sequencer node), this will record which node was
   // attempted to be reached last. The goal is to prevent sending to the same
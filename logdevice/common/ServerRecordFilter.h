@@ -8,36 +8,78 @@
 
 #pragma once
 #include <chrono>
+#include <map>
 #include <string>
 
 #include <folly/Range.h>
 
+#include "logdevice/include/Record.h"
+#include "logdevice/include/types.h"
+
 namespace facebook { namespace logdevice {
 
 /**
  * @file This class serves as an interface for server-side filter classes.
- *       There are two implementations right now. Experimental feature:
+ *       There are three implementations right now. Experimental feature:
  *       Use with caution.
  */
 
 /**
- * Currently only two types.
+ * Currently three types.
  * 1) EQUALITY means exact match. It describes string equality filter based for
  *    now.
  * 2) RANGE means filter by upper and lower bounds. It describes string
  *    based range filter for now.
+ * 3) EXPRESSION means a boolean expression over record keys and attributes,
+ *    passed as text in filter_key1. See ServerRecordExpressionFilter.h for the
+ *    syntax. Only sent to servers that speak
+ *    Compatibility::SERVER_FILTER_EXPRESSIONS.
  */
 
 enum class ServerRecordFilterType : uint8_t {
   NOFILTER = 0,
   EQUALITY = 1,
   RANGE = 2,
+  EXPRESSION = 3,
   MAX
 };
 
 class ServerRecordFilter {
  public:
+  /**
+   * What the storage node knows about a record when filtering it, without
+   * looking into the payload.
+   */
+  struct RecordAttributes {
+    lsn_t lsn;
+    std::chrono::milliseconds timestamp;
+    // Size of the payload as stored, possibly compressed and including the
+    // checksum.
+    size_t payload_size;
+    const std::map<KeyType, std::string>& optional_keys;
+  };
+
   virtual bool operator()(folly::StringPiece key) = 0;
+
+  /**
+   * @return  whether the record passes the filter. By default only looks at
+   *          the FILTERABLE key; records without one always pass.
+   */
+  virtual bool matches(const RecordAttributes& record) {
+    auto it = record.optional_keys.find(KeyType::FILTERABLE);
+    return it == record.optional_keys.end() || (*this)(it->second);
+  }
+
+  /**
+   * @return  true if matches() only depends on the FILTERABLE key, as the
+   *          default implementation does. Then readers may call operator()
+   *          on that key directly instead of building RecordAttributes with
+   *          all of the record's optional keys.
+   */
+  virtual bool onlyUsesFilterableKey() const {
+    return true;
+  }
+
   virtual std::string toString() const = 0;
   virtual ~ServerRecordFilter() {}
 };
@@ -52,7 +52,7 @@ namespace facebook { namespace logdevice {
  * The array is initialized to {0, T, 0, 0, 0...}  (tail is at entry MIN_ESN)
  *
  * A separate shared atomic counter n is used to limit the total number of
- * outstanding objects to at most N.
+ * outstanding objects to at most N, or to a lower limit set by setLimit().
  *
  * Every object in the window is identified by a 32-bit ESN (epoch-relative
  * part of LSN) assigned to the record that it attempts to store. That ESN e
@@ -92,6 +92,7 @@ class SlidingWindowSingleEpoch {
         // This is a bit tricky.  We need all slots in the window to map to
         // valid ESNs (at most `esn_max_')
         capacity_(std::min<uint64_t>(capacity, esn_max_.val_)),
+        limit_(capacity_),
         right_(compose_lsn(epoch_, ESN_MIN)) {
     if (capacity_ < SlidingWindowSingleEpoch::MIN_CAPACITY ||
         esn_max < ESN_MIN) {
@@ -152,7 +153,7 @@ class SlidingWindowSingleEpoch {
     // impossible to overflow uint64_t in practice
     size_t token = size_.fetch_add(1);
 
-    if (token >= capacity_) {
+    if (token >= limit_.load(std::memory_order_relaxed)) {
       size_.fetch_sub(1);
       err = E::NOBUFS;
       return LSN_INVALID;
@@ -390,6 +391,24 @@ class SlidingWindowSingleEpoch {
     return capacity_;
   }
 
+  /**
+   * @return   current limit on the window size, at most capacity()
+   */
+  size_t limit() const {
+    return limit_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Changes the limit on the window size, clamped to
+   * [MIN_CAPACITY, capacity()].  If the window is bigger than the new limit,
+   * grow() fails until enough elements are retired.
+   */
+  void setLimit(size_t limit) {
+    limit_.store(std::max<size_t>(std::min(limit, capacity_),
+                                  std::min<size_t>(MIN_CAPACITY, capacity_)),
+                 std::memory_order_relaxed);
+  }
+
   /**
    * @return  A sequence number that will be assigned to the next element
    *          passed to a successful call to grow(). This is the leading edge of
@@ -489,6 +508,10 @@ class SlidingWindowSingleEpoch {
   // Maximum window size
   const size_t capacity_;
 
+  // Window size limit enforced by grow(), in [MIN_CAPACITY, capacity_].
+  // Equals capacity_ unless lowered by setLimit().
+  std::atomic<size_t> limit_;
+
   // right edge of the window (max LSN in window plus one), or LSN_DISABLED if
   // the window is disabled. Next successful call to grow() will return this
   // LSN.
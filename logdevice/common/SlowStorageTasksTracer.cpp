@@ -19,7 +19,7 @@ SlowStorageTasksTracer::SlowStorageTasksTracer(
 
 void SlowStorageTasksTracer::traceStorageTask(
     std::function<StorageTaskDebugInfo()> builder,
-    double execution_time_ms) {
+    double duration_ms) {
   auto sample_builder = [&]() {
     auto info = builder();
     auto sample = std::make_unique<TraceSample>();
@@ -30,6 +30,9 @@ void SlowStorageTasksTracer::traceStorageTask(
     sample->addNormalValue("task_type", info.task_type);
     sample->addIntValue("enqueue_time", info.enqueue_time.count());
     sample->addNormalValue("durability", info.durability);
+    if (!info.principal.empty()) {
+      sample->addNormalValue("principal", info.principal);
+    }
 
     if (info.log_id) {
       sample->addNormalValue(
@@ -42,6 +45,9 @@ void SlowStorageTasksTracer::traceStorageTask(
       sample->addNormalValue(
           "client_address", info.client_address.value().toStringNoPort());
     }
+    if (info.dequeue_time) {
+      sample->addIntValue("dequeue_time", info.dequeue_time.value().count());
+    }
     if (info.execution_start_time) {
       sample->addIntValue(
           "execution_start_time", info.execution_start_time.value().count());
@@ -56,6 +62,18 @@ void SlowStorageTasksTracer::traceStorageTask(
     if (info.node_id) {
       sample->addNormalValue("node_id", info.node_id.value().toString());
     }
+    // Breakdown of the task's duration, in microseconds.
+    if (info.queue_time) {
+      sample->addIntValue("queue_time_us", info.queue_time.value().count());
+    }
+    if (info.batching_time) {
+      sample->addIntValue(
+          "batching_time_us", info.batching_time.value().count());
+    }
+    if (info.execution_time) {
+      sample->addIntValue(
+          "execution_time_us", info.execution_time.value().count());
+    }
     if (info.extra_info) {
       sample->addNormalValue("extra_info", info.extra_info.value());
     }
@@ -66,7 +84,7 @@ void SlowStorageTasksTracer::traceStorageTask(
   publish(SLOW_STORAGE_TASKS_TRACER,
           sample_builder,
           /* force */ false,
-          execution_time_ms);
+          duration_ms);
 }
 
 }} // namespace facebook::logdevice
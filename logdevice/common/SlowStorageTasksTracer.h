@@ -24,11 +24,15 @@ class SlowStorageTasksTracer : SampledTracer {
  public:
   explicit SlowStorageTasksTracer(std::shared_ptr<TraceLogger> logger);
 
+  // Tasks are sampled with a probability proportional to `duration_ms`, so
+  // that the slowest ones are the most likely to be sampled. For tasks
+  // executed by storage threads, it's the total time from enqueueing to the
+  // end of execution; the sample breaks it down by stage.
   void traceStorageTask(std::function<StorageTaskDebugInfo()> builder,
-                        double execution_time_ms);
+                        double duration_ms);
 
   folly::Optional<double> getDefaultSamplePercentage() const override {
-    // By default send a sample every 100 seconds of execution time.
+    // By default send a sample every 100 seconds of task duration.
     return .001; // 100% / 100e3
   }
 };
@@ -23,10 +23,12 @@ namespace facebook { namespace logdevice {
 StatsCollectionThread::StatsCollectionThread(
     const StatsHolder* source,
     std::chrono::seconds interval,
-    std::unique_ptr<StatsPublisher> publisher)
+    std::unique_ptr<StatsPublisher> publisher,
+    bool rollup)
     : source_stats_sets_({source}),
       interval_(interval),
       publisher_(std::move(publisher)),
+      rollup_(rollup),
       thread_(std::bind(&StatsCollectionThread::mainLoop, this)) {
   ld_debug("Stats Collection Thread Started...");
 }
@@ -69,7 +71,13 @@ void StatsCollectionThread::mainLoop() {
     }
 
     ld_debug("Publishing Stats...");
-    if (!previous_snapshots.stats.empty()) {
+    if (rollup_ && !publishRollup(current_snapshots.stats, now)) {
+      ld_warning("Stats publisher doesn't support rollups, publishing all "
+                 "stats instead.");
+      rollup_ = false;
+      rollups_.clear();
+    }
+    if (!rollup_ && !previous_snapshots.stats.empty()) {
       ld_check_gt(previous_snapshots.stats.size(), 0);
       ld_check_ge(
           current_snapshots.stats.size(), previous_snapshots.stats.size());
@@ -104,6 +112,20 @@ void StatsCollectionThread::mainLoop() {
   }
 }
 
+bool StatsCollectionThread::publishRollup(
+    const std::vector<Stats>& snapshots,
+    std::chrono::steady_clock::time_point now) {
+  std::vector<std::vector<const StatsRollup::Bucket*>> buckets;
+  for (size_t i = 0; i < snapshots.size(); ++i) {
+    if (i == rollups_.size()) {
+      // A stats set added with addStatsSource().
+      rollups_.push_back(std::make_unique<StatsRollup>());
+    }
+    buckets.push_back(rollups_[i]->add(snapshots[i], now));
+  }
+  return publisher_->publishRollup(buckets);
+}
+
 std::unique_ptr<StatsCollectionThread> StatsCollectionThread::maybeCreate(
     const UpdateableSettings<Settings>& settings,
     std::shared_ptr<ServerConfig> config,
@@ -131,8 +153,10 @@ std::unique_ptr<StatsCollectionThread> StatsCollectionThread::maybeCreate(
   }
 
   stats_publisher->addRollupEntity(config->getClusterName());
-  return std::make_unique<StatsCollectionThread>(
-      source, stats_collection_interval, std::move(stats_publisher));
+  return std::make_unique<StatsCollectionThread>(source,
+                                                 stats_collection_interval,
+                                                 std::move(stats_publisher),
+                                                 settings->stats_rollup);
 }
 
 }} // namespace facebook::logdevice
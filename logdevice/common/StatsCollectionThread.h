@@ -12,6 +12,7 @@
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 #include "logdevice/common/StatsPublisher.h"
 
@@ -32,9 +33,15 @@ class UpdateableSettings;
 
 class StatsCollectionThread {
  public:
+  /**
+   * @param rollup  if true, stats are rolled up (see StatsRollup.h) and
+   *                published with StatsPublisher::publishRollup(), if the
+   *                publisher supports it
+   */
   StatsCollectionThread(const StatsHolder* source,
                         std::chrono::seconds interval,
-                        std::unique_ptr<StatsPublisher> publisher);
+                        std::unique_ptr<StatsPublisher> publisher,
+                        bool rollup = false);
 
   /**
    * Blocks while the thread publishes stats one last time.
@@ -65,9 +72,18 @@ class StatsCollectionThread {
  private:
   void mainLoop();
 
+  // Rolls up the given snapshots and publishes the closed buckets. Returns
+  // false if the publisher doesn't support rollups.
+  bool publishRollup(const std::vector<Stats>& snapshots,
+                     std::chrono::steady_clock::time_point now);
+
   std::vector<const StatsHolder*> source_stats_sets_;
   std::chrono::seconds interval_;
   std::unique_ptr<StatsPublisher> publisher_;
+  // Only accessed by the thread, after construction.
+  bool rollup_;
+  // One per stats set.
+  std::vector<std::unique_ptr<StatsRollup>> rollups_;
   bool stop_ = false;
   std::mutex mutex_;
   std::condition_variable cv_;
@@ -11,6 +11,8 @@
 #include <string>
 #include <vector>
 
+#include "logdevice/common/StatsRollup.h"
+
 namespace facebook { namespace logdevice {
 
 /**
@@ -33,6 +35,20 @@ class StatsPublisher {
                        const std::vector<const Stats*>& previous,
                        std::chrono::milliseconds elapsed) = 0;
 
+  /**
+   * Called by StatsCollectionThread instead of publish() if --stats-rollup is
+   * set. For each stats set (in the same order as in publish()), `buckets`
+   * has the StatsRollup buckets that closed since the previous call. They
+   * only list the counters that changed.
+   *
+   * @return false if the publisher doesn't support rollups, in which case
+   *         StatsCollectionThread goes back to calling publish().
+   */
+  virtual bool publishRollup(
+      const std::vector<std::vector<const StatsRollup::Bucket*>>& /*buckets*/) {
+    return false;
+  }
+
   /**
    * Additionally aggregate stats against the given entity, for ALL stats sets.
    *
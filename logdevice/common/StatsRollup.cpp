@@ -0,0 +1,202 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/StatsRollup.h"
+
+#include <algorithm>
+
+#include <folly/Conv.h>
+
+#include "logdevice/common/PriorityMap.h"
+#include "logdevice/common/RequestType.h"
+#include "logdevice/common/StorageTask-enums.h"
+#include "logdevice/common/configuration/NodeLocation.h"
+#include "logdevice/common/configuration/TrafficClass.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/protocol/MessageTypeNames.h"
+#include "logdevice/common/stats/Stats.h"
+
+namespace facebook { namespace logdevice {
+
+namespace {
+
+// Flattens all counters of a Stats object, named like in the `stats' admin
+// command.
+class FlattenCallbacks : public Stats::EnumerationCallbacks {
+ public:
+  explicit FlattenCallbacks(std::vector<std::pair<std::string, int64_t>>& out)
+      : out_(out) {}
+
+  void stat(const std::string& name, int64_t val) override {
+    out_.emplace_back(name, val);
+  }
+  void stat(const std::string& name, MessageType msg, int64_t val) override {
+    add(name, messageTypeNames()[msg], val);
+  }
+  void stat(const std::string& name,
+            shard_index_t shard,
+            int64_t val) override {
+    out_.emplace_back(folly::to<std::string>(name, ".shard", shard), val);
+  }
+  void stat(const std::string& name, TrafficClass tc, int64_t val) override {
+    add(name, trafficClasses()[tc], val);
+  }
+  void stat(const std::string& name,
+            NodeLocationScope flow_group,
+            int64_t val) override {
+    add(name, NodeLocation::scopeNames()[flow_group], val);
+  }
+  void stat(const std::string& name,
+            NodeLocationScope flow_group,
+            Priority pri,
+            int64_t val) override {
+    out_.emplace_back(
+        folly::to<std::string>(name,
+                               ".",
+                               NodeLocation::scopeNames()[flow_group],
+                               ".",
+                               PriorityMap::toName()[pri]),
+        val);
+  }
+  void statWithTag(const std::string& name,
+                   const std::string& tag,
+                   int64_t val) override {
+    add(name, tag, val);
+  }
+  void stat(const std::string& name, Priority pri, int64_t val) override {
+    add(name, PriorityMap::toName()[pri], val);
+  }
+  void stat(const std::string& name, RequestType rq, int64_t val) override {
+    add(name, requestTypeNames[rq], val);
+  }
+  void stat(const std::string& name,
+            StorageTaskType type,
+            int64_t val) override {
+    add(name, storageTaskTypeNames[type], val);
+  }
+  void stat(const std::string& name,
+            worker_id_t worker_id,
+            uint64_t load) override {
+    out_.emplace_back(folly::to<std::string>(name, "_", worker_id.val()),
+                      static_cast<int64_t>(load));
+  }
+  void stat(const char* name,
+            const std::string& log_group,
+            int64_t val) override {
+    std::string key = folly::to<std::string>(log_group, ".", name);
+    std::replace(key.begin(), key.begin() + log_group.size(), ' ', '_');
+    out_.emplace_back(std::move(key), val);
+  }
+
+  void histogram(const std::string& /*name*/,
+                 const HistogramInterface& /*hist*/) override {}
+  void histogram(const std::string& /*name*/,
+                 shard_index_t /*shard*/,
+                 const HistogramInterface& /*hist*/) override {}
+  void histogramWithTag(const std::string& /*name*/,
+                        const std::string& /*tag*/,
+                        const HistogramInterface& /*hist*/) override {}
+
+ private:
+  void add(const std::string& name, const std::string& suffix, int64_t val) {
+    out_.emplace_back(folly::to<std::string>(name, ".", suffix), val);
+  }
+
+  std::vector<std::pair<std::string, int64_t>>& out_;
+};
+
+} // namespace
+
+StatsRollup::StatsRollup(std::vector<std::chrono::seconds> resolutions,
+                         size_t history)
+    : history_(history) {
+  ld_check_gt(history_, 0);
+  std::sort(resolutions.begin(), resolutions.end());
+  for (std::chrono::seconds resolution : resolutions) {
+    Level level;
+    level.resolution = resolution;
+    levels_.push_back(std::move(level));
+  }
+}
+
+std::vector<const StatsRollup::Bucket*> StatsRollup::add(const Stats& stats,
+                                                         TimePoint now) {
+  std::vector<std::pair<std::string, int64_t>> counters;
+  FlattenCallbacks cb(counters);
+  stats.enumerate(&cb, /* list_all */ true);
+  return add(counters, now);
+}
+
+std::vector<const StatsRollup::Bucket*>
+StatsRollup::add(const std::vector<std::pair<std::string, int64_t>>& counters,
+                 TimePoint now) {
+  const bool baseline = !has_baseline_;
+  has_baseline_ = true;
+
+  for (const auto& counter : counters) {
+    auto res = values_.emplace(counter.first, counter.second);
+    if (res.second) {
+      // A counter we haven't seen before, e.g. of a new log group. Unless
+      // this is the first snapshot, it started from zero.
+      if (baseline || counter.second == 0) {
+        continue;
+      }
+    } else if (res.first->second == counter.second) {
+      continue;
+    }
+    const int64_t delta =
+        counter.second - (res.second ? 0 : res.first->second);
+    res.first->second = counter.second;
+    const std::string* name = &res.first->first;
+    for (Level& level : levels_) {
+      auto it = level.open_changes.emplace(name, Change{name, 0, 0}).first;
+      it->second.delta += delta;
+      it->second.value = counter.second;
+    }
+  }
+
+  std::vector<const Bucket*> closed;
+  for (Level& level : levels_) {
+    if (!level.open) {
+      level.open = true;
+      level.open_since = now;
+      continue;
+    }
+    if (now - level.open_since < level.resolution) {
+      continue;
+    }
+    Bucket bucket;
+    bucket.resolution = level.resolution;
+    bucket.start = level.open_since;
+    bucket.end = now;
+    bucket.changes.reserve(level.open_changes.size());
+    for (const auto& kv : level.open_changes) {
+      bucket.changes.push_back(kv.second);
+    }
+    level.open_changes.clear();
+    level.open_since = now;
+
+    if (level.closed.size() >= history_) {
+      level.closed.pop_front();
+    }
+    level.closed.push_back(std::move(bucket));
+    closed.push_back(&level.closed.back());
+  }
+  return closed;
+}
+
+const std::deque<StatsRollup::Bucket>*
+StatsRollup::getBuckets(std::chrono::seconds resolution) const {
+  for (const Level& level : levels_) {
+    if (level.resolution == resolution) {
+      return &level.closed;
+    }
+  }
+  return nullptr;
+}
+
+}} // namespace facebook::logdevice
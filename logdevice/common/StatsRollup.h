@@ -0,0 +1,116 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Multi-resolution rollup of the counters of a stats set, so that the
+ *       cost of exporting stats scales with how many counters change rather
+ *       than with how many there are.
+ *
+ *       Each add() flattens a snapshot into named counters, named like in the
+ *       `stats' admin command (e.g. "<stat>.shard3" for a per-shard stat or
+ *       "<log group>.append_success" for a per-log one), and compares them
+ *       to the previous snapshot. Counters that changed are added to the
+ *       open bucket of every resolution (1s, 10s and 1min by default). Once a
+ *       bucket has been open for its resolution, it's closed and kept in a
+ *       ring buffer of the last `history` buckets of that resolution. A
+ *       bucket only lists the counters that changed while it was open, so its
+ *       size depends on the activity, not on the number of counters.
+ *
+ *       Buckets can't be shorter than the interval between snapshots: with a
+ *       60s --stats-collection-interval, each 1s and 10s bucket covers one
+ *       snapshot.
+ *
+ *       Histograms aren't rolled up. Not thread-safe.
+ */
+
+struct Stats;
+
+class StatsRollup {
+ public:
+  using TimePoint = std::chrono::steady_clock::time_point;
+
+  struct Change {
+    // Owned by the StatsRollup, lives as long as it.
+    const std::string* name;
+    // Sum of the changes while the bucket was open.
+    int64_t delta;
+    // Value when the bucket was closed.
+    int64_t value;
+  };
+
+  struct Bucket {
+    std::chrono::seconds resolution;
+    TimePoint start;
+    TimePoint end;
+    std::vector<Change> changes;
+  };
+
+  explicit StatsRollup(std::vector<std::chrono::seconds> resolutions =
+                           {std::chrono::seconds(1),
+                            std::chrono::seconds(10),
+                            std::chrono::minutes(1)},
+                       size_t history = 60);
+
+  /**
+   * Rolls up a snapshot of the stats taken at `now`. The first snapshot only
+   * sets the values that later ones are compared to.
+   *
+   * @return the buckets that closed, finest resolution first. The pointers
+   *         stay valid until the next call.
+   */
+  std::vector<const Bucket*> add(const Stats& stats, TimePoint now);
+
+  /**
+   * Rolls up a snapshot already flattened into counter values. Counters
+   * missing from `counters` are assumed unchanged.
+   */
+  std::vector<const Bucket*>
+  add(const std::vector<std::pair<std::string, int64_t>>& counters,
+      TimePoint now);
+
+  /**
+   * Closed buckets of the given resolution, oldest first, or nullptr if that
+   * resolution isn't rolled up.
+   */
+  const std::deque<Bucket>* getBuckets(std::chrono::seconds resolution) const;
+
+  // Number of distinct counters seen so far.
+  size_t numCounters() const {
+    return values_.size();
+  }
+
+ private:
+  struct Level {
+    std::chrono::seconds resolution;
+    bool open = false;
+    TimePoint open_since;
+    // Counters that changed since the open bucket was opened.
+    std::unordered_map<const std::string*, Change> open_changes;
+    std::deque<Bucket> closed;
+  };
+
+  // Last value of each counter. Nodes are stable, so Change::name points at
+  // the keys.
+  std::unordered_map<std::string, int64_t> values_;
+  std::vector<Level> levels_;
+  const size_t history_;
+  bool has_baseline_ = false;
+};
+
+}} // namespace facebook::logdevice
@@ -179,7 +179,7 @@ bool StickyCopySetManager::startNewBlock(State& csm_state,
   StoreChainLink copyset[COPYSET_SIZE_MAX];
   copyset_size_t size = 0;
 
-  auto result = underlying_selector_->select(
+  auto result = selectCopySet(
       extras, copyset, &size, chain_out, csm_state.css_state.get());
   if (result == CopySetSelector::Result::FAILED) {
     return false;
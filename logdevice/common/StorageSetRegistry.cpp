@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/StorageSetRegistry.h"
+
+#include <algorithm>
+
+#include <folly/hash/Hash.h>
+
+namespace facebook { namespace logdevice {
+
+StorageSetRegistry::Ptr
+StorageSetRegistry::intern(const StorageSet& storage_set) {
+  const size_t hash = folly::hash::hash_range(
+      storage_set.begin(), storage_set.end(), 0, ShardID::Hash());
+
+  // Sets with a colliding hash that we had to look at. If we end up holding
+  // the last reference to one of them, it must be released after the lock.
+  std::vector<Ptr> collisions;
+  auto sets = sets_.wlock();
+  Bucket& bucket = (*sets)[hash];
+  for (const auto& weak : bucket) {
+    Ptr existing = weak.lock();
+    if (!existing) {
+      continue;
+    }
+    if (*existing == storage_set) {
+      return existing;
+    }
+    collisions.push_back(std::move(existing));
+  }
+
+  Ptr ptr(new StorageSet(storage_set), [this, hash](const StorageSet* p) {
+    release(hash, p);
+  });
+  bucket.push_back(ptr);
+  return ptr;
+}
+
+void StorageSetRegistry::release(size_t hash, const StorageSet* storage_set) {
+  {
+    auto sets = sets_.wlock();
+    auto it = sets->find(hash);
+    if (it != sets->end()) {
+      Bucket& bucket = it->second;
+      bucket.erase(
+          std::remove_if(bucket.begin(),
+                         bucket.end(),
+                         [](const std::weak_ptr<const StorageSet>& weak) {
+                           return weak.expired();
+                         }),
+          bucket.end());
+      if (bucket.empty()) {
+        sets->erase(it);
+      }
+    }
+  }
+  delete storage_set;
+}
+
+size_t StorageSetRegistry::size() const {
+  auto sets = sets_.rlock();
+  size_t n = 0;
+  for (const auto& kv : *sets) {
+    n += kv.second.size();
+  }
+  return n;
+}
+
+StorageSetRegistry& StorageSetRegistry::instance() {
+  // Leaked so that interned sets may outlive static destruction.
+  static StorageSetRegistry* registry = new StorageSetRegistry();
+  return *registry;
+}
+
+}} // namespace facebook::logdevice
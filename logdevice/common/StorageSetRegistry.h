@@ -0,0 +1,57 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <folly/Synchronized.h>
+
+#include "logdevice/common/ShardID.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Interns immutable StorageSets, so that the per-log objects derived
+ *       from epoch metadata (copyset managers and selectors) share one copy
+ *       of each distinct nodeset instead of keeping one per log. With many
+ *       logs placed on a handful of distinct nodesets this saves a lot of
+ *       memory on sequencer nodes.
+ *
+ *       Sets are keyed by a hash of their content and are freed when the last
+ *       pointer to them goes away. Thread-safe.
+ */
+
+class StorageSetRegistry {
+ public:
+  using Ptr = std::shared_ptr<const StorageSet>;
+
+  /**
+   * @return  a pointer to a StorageSet equal to `storage_set', shared with
+   *          everyone else who interned an equal set and still holds it.
+   */
+  Ptr intern(const StorageSet& storage_set);
+
+  // Number of distinct sets currently interned.
+  size_t size() const;
+
+  // Returns a singleton instance.
+  static StorageSetRegistry& instance();
+
+ private:
+  // Sets whose content hashes to the same value.
+  using Bucket = std::vector<std::weak_ptr<const StorageSet>>;
+
+  // Called when the last pointer to an interned set is destroyed.
+  void release(size_t hash, const StorageSet* storage_set);
+
+  folly::Synchronized<std::unordered_map<size_t, Bucket>> sets_;
+};
+
+}} // namespace facebook::logdevice
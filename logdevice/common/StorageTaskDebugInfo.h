@@ -47,13 +47,20 @@ struct StorageTaskDebugInfo {
   std::string task_type;
   std::chrono::milliseconds enqueue_time;
   std::string durability;
+  std::string principal;
   // Thread-specific information
   folly::Optional<bool> is_write_queue;
   // Task-specific information
   folly::Optional<logid_t> log_id;
   folly::Optional<lsn_t> lsn;
+  folly::Optional<std::chrono::milliseconds> dequeue_time;
   folly::Optional<std::chrono::milliseconds> execution_start_time;
   folly::Optional<std::chrono::milliseconds> execution_end_time;
+  // Precise durations of the stages between the above, if known. See
+  // ExecStorageThread::reportTaskStageTimes().
+  folly::Optional<std::chrono::microseconds> queue_time;
+  folly::Optional<std::chrono::microseconds> batching_time;
+  folly::Optional<std::chrono::microseconds> execution_time;
   folly::Optional<NodeID> node_id;
   folly::Optional<ClientID> client_id;
   folly::Optional<Sockaddr> client_address;
@@ -78,6 +78,11 @@ class StreamAppendRequest : public AppendRequest {
   // overriding to include stream_request_id in APPEND_Message
   std::unique_ptr<APPEND_Message> createAppendMessage() override;
 
+  // Stream appends are already bounded and ordered by the stream.
+  bool usesAppendWindow() const override {
+    return false;
+  }
+
  private:
   // contains stream id and the sequence number of request in the stream.
   write_stream_request_id_t stream_rqid_;
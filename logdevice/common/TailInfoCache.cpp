@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/TailInfoCache.h"
+
+#include <algorithm>
+
+#include "logdevice/common/debug.h"
+
+namespace facebook { namespace logdevice {
+
+folly::Optional<lsn_t>
+TailInfoCache::getNextLSN(logid_t log, std::chrono::milliseconds max_age) {
+  const TimePoint t = now();
+  folly::SharedMutex::ReadHolder guard(mutex_);
+  auto it = entries_.find(log);
+  if (it == entries_.end() || it->second.next_lsn == LSN_INVALID ||
+      t - it->second.next_lsn_time >= max_age) {
+    return folly::none;
+  }
+  return it->second.next_lsn;
+}
+
+std::unique_ptr<LogTailAttributes>
+TailInfoCache::getTailAttributes(logid_t log,
+                                 std::chrono::milliseconds max_age) {
+  const TimePoint t = now();
+  folly::SharedMutex::ReadHolder guard(mutex_);
+  auto it = entries_.find(log);
+  if (it == entries_.end() || !it->second.attributes.has_value() ||
+      t - it->second.attributes_time >= max_age) {
+    return nullptr;
+  }
+  return std::make_unique<LogTailAttributes>(it->second.attributes.value());
+}
+
+folly::Optional<bool>
+TailInfoCache::getIsLogEmpty(logid_t log, std::chrono::milliseconds max_age) {
+  const TimePoint t = now();
+  folly::SharedMutex::ReadHolder guard(mutex_);
+  auto it = entries_.find(log);
+  if (it == entries_.end() || !it->second.is_log_empty.has_value() ||
+      t - it->second.is_log_empty_time >= max_age) {
+    return folly::none;
+  }
+  return it->second.is_log_empty;
+}
+
+void TailInfoCache::update(logid_t log,
+                           lsn_t next_lsn,
+                           const LogTailAttributes* attributes,
+                           folly::Optional<bool> is_log_empty,
+                           std::chrono::milliseconds ttl) {
+  const TimePoint t = now();
+  folly::SharedMutex::WriteHolder guard(mutex_);
+  garbageCollect(t, ttl);
+  Entry& entry = entries_[log];
+  if (next_lsn != LSN_INVALID) {
+    entry.next_lsn = next_lsn;
+    entry.next_lsn_time = t;
+  }
+  if (attributes) {
+    entry.attributes = *attributes;
+    entry.attributes_time = t;
+  }
+  if (is_log_empty.has_value()) {
+    entry.is_log_empty = is_log_empty;
+    entry.is_log_empty_time = t;
+  }
+}
+
+void TailInfoCache::invalidate(logid_t log) {
+  folly::SharedMutex::WriteHolder guard(mutex_);
+  entries_.erase(log);
+}
+
+void TailInfoCache::garbageCollect(TimePoint t, std::chrono::milliseconds ttl) {
+  // Expired entries are harmless, only sweep them once in a while.
+  if (t - last_gc_ < std::max<std::chrono::milliseconds>(
+                         ttl, std::chrono::seconds(1))) {
+    return;
+  }
+  last_gc_ = t;
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    const Entry& e = it->second;
+    TimePoint last_update = std::max(
+        {e.next_lsn_time, e.attributes_time, e.is_log_empty_time});
+    it = t - last_update >= ttl ? entries_.erase(it) : std::next(it);
+  }
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,108 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+
+#include <folly/Optional.h>
+#include <folly/SharedMutex.h>
+
+#include "logdevice/include/LogTailAttributes.h"
+#include "logdevice/include/types.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file  Remembers, across all Workers of a client, what sequencers recently
+ *        said about the tails of logs: the next LSN, the tail attributes and
+ *        whether the log is empty.  Clients that poll getTailLSN(),
+ *        getTailAttributes() or isLogEmpty() for many logs every few seconds
+ *        (e.g. dashboards, lag monitors) would otherwise send a
+ *        GET_SEQ_STATE per log per poll, and the sequencer's answer can only
+ *        have changed by new appends anyway.
+ *
+ *        Answers are served from the cache only if they are younger than the
+ *        maximum age given by the caller (--tail-info-cache-ttl), so callers
+ *        choose a bounded staleness: a cached tail may miss records appended
+ *        during the last `ttl'.
+ *
+ *        This class is thread-safe.
+ */
+
+class TailInfoCache {
+ public:
+  using TimePoint = std::chrono::steady_clock::time_point;
+
+  virtual ~TailInfoCache() {}
+
+  /**
+   * @return  the next LSN the sequencer of `log' reported within the last
+   *          `max_age', or folly::none
+   */
+  folly::Optional<lsn_t> getNextLSN(logid_t log,
+                                    std::chrono::milliseconds max_age);
+
+  /**
+   * @return  tail attributes of `log' reported within the last `max_age', or
+   *          nullptr
+   */
+  std::unique_ptr<LogTailAttributes>
+  getTailAttributes(logid_t log, std::chrono::milliseconds max_age);
+
+  /**
+   * @return  whether `log' was empty according to a reply received within
+   *          the last `max_age', or folly::none
+   */
+  folly::Optional<bool> getIsLogEmpty(logid_t log,
+                                      std::chrono::milliseconds max_age);
+
+  /**
+   * Records a successful reply from the sequencer of `log'. `next_lsn' may
+   * be LSN_INVALID, `attributes' nullptr and `is_log_empty' folly::none if
+   * the reply didn't include them; fields cached earlier are then kept with
+   * their original age. Entries older than `ttl' are dropped once in a
+   * while.
+   */
+  void update(logid_t log,
+              lsn_t next_lsn,
+              const LogTailAttributes* attributes,
+              folly::Optional<bool> is_log_empty,
+              std::chrono::milliseconds ttl);
+
+  /**
+   * Forgets what is known about `log', e.g. after the client appended to it
+   * and wants to read its own write.
+   */
+  void invalidate(logid_t log);
+
+ protected:
+  virtual TimePoint now() const {
+    return std::chrono::steady_clock::now();
+  }
+
+ private:
+  struct Entry {
+    lsn_t next_lsn{LSN_INVALID};
+    TimePoint next_lsn_time{};
+    folly::Optional<LogTailAttributes> attributes;
+    TimePoint attributes_time{};
+    folly::Optional<bool> is_log_empty;
+    TimePoint is_log_empty_time{};
+  };
+
+  void garbageCollect(TimePoint now, std::chrono::milliseconds ttl);
+
+  std::unordered_map<logid_t, Entry, logid_t::Hash> entries_;
+  // When expired entries were last removed.
+  TimePoint last_gc_{};
+  folly::SharedMutex mutex_;
+};
+
+}} // namespace facebook::logdevice
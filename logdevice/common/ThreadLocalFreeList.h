@@ -0,0 +1,112 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file A per-thread cache of freed memory blocks of size sizeof(T). Meant
+ *       for class-level operator new/delete of objects that are created and
+ *       destroyed at a high rate on the same set of threads (e.g. Appenders
+ *       on workers), so that the steady state doesn't go to the general
+ *       purpose allocator at all.
+ *
+ *       A block is cached on the thread that frees it, which doesn't have to
+ *       be the thread that allocated it. Each thread caches at most the number
+ *       of blocks passed to put(); blocks above the limit, and all cached
+ *       blocks when the thread exits, are returned with ::operator delete.
+ *
+ *       No synchronization: every thread only touches its own list.
+ */
+
+template <typename T>
+class ThreadLocalFreeList {
+ public:
+  static_assert(sizeof(T) >= sizeof(void*), "T is too small to be pooled");
+
+  /**
+   * @return a block of sizeof(T) bytes taken from this thread's cache, or
+   *         nullptr if the cache is empty.
+   */
+  static void* get() {
+    List& list = getList();
+    Block* block = list.head;
+    if (block == nullptr) {
+      return nullptr;
+    }
+    list.head = block->next;
+    --list.size;
+    return block;
+  }
+
+  /**
+   * Adds a block of sizeof(T) bytes to this thread's cache.
+   *
+   * @param max_cached  maximum number of blocks this thread may cache
+   * @return true if the block was cached, false if the cache is full; the
+   *         caller is then responsible for freeing the block
+   */
+  static bool put(void* ptr, size_t max_cached) {
+    List& list = getList();
+    if (list.size >= max_cached) {
+      return false;
+    }
+    list.head = new (ptr) Block{list.head};
+    ++list.size;
+    return true;
+  }
+
+  // @return number of blocks currently cached by this thread
+  static size_t size() {
+    return getList().size;
+  }
+
+  /**
+   * Frees all blocks cached by this thread.
+   *
+   * @return the number of blocks freed
+   */
+  static size_t clear() {
+    return getList().clear();
+  }
+
+ private:
+  struct Block {
+    Block* next;
+  };
+
+  struct List {
+    Block* head = nullptr;
+    size_t size = 0;
+
+    size_t clear() {
+      size_t freed = size;
+      while (head != nullptr) {
+        Block* next = head->next;
+        ::operator delete(static_cast<void*>(head));
+        head = next;
+      }
+      size = 0;
+      return freed;
+    }
+
+    ~List() {
+      clear();
+    }
+  };
+
+  static List& getList() {
+    static thread_local List list;
+    return list;
+  }
+};
+
+}} // namespace facebook::logdevice
@@ -54,7 +54,8 @@ WeightedCopySetSelector::WeightedCopySetSelector(
       print_bias_warnings_(print_bias_warnings),
       locality_enabled_(locality_enabled),
       stats_(stats),
-      nodeset_indices_(epoch_metadata.shards) {
+      nodeset_indices_(
+          StorageSetRegistry::instance().intern(epoch_metadata.shards)) {
   {
     ld_check(nodes_configuration != nullptr);
     // Convert replication requirement from the more general ReplictionProperty
@@ -213,7 +214,7 @@ WeightedCopySetSelector::WeightedCopySetSelector(
   ld_debug("Created WeightedCopySetSelector for log %lu. Nodeset: %s, "
            "weights: %s, R: %d, R2: %d, hierarchy: %s",
            logid_.val_,
-           logdevice::toString(nodeset_indices_).c_str(),
+           logdevice::toString(*nodeset_indices_).c_str(),
            logdevice::toString(weights).c_str(),
            (int)replication_,
            (int)secondary_replication_,
@@ -767,7 +768,7 @@ WeightedCopySetSelector::select(copyset_size_t extras,
         (int)secondary_replication_,
         NodeLocation::scopeNames()[secondary_replication_scope_].c_str(),
         logid_.val_,
-        toString(nodeset_indices_).c_str(),
+        toString(*nodeset_indices_).c_str(),
         toString(cache.unavailable_nodes).c_str());
     return Result::FAILED;
   };
@@ -804,7 +805,7 @@ WeightedCopySetSelector::select(copyset_size_t extras,
           logid_.val_,
           (int)replication_,
           MAX_BLACKLISTING_ITERATIONS,
-          toString(nodeset_indices_).c_str());
+          toString(*nodeset_indices_).c_str());
       return ret = Result::FAILED;
     }
     ++attempts;
@@ -979,7 +980,7 @@ void WeightedCopySetSelector::splitExistingCopySet(
           "storage node. Log: %lu, current inout_copyset: [%s], "
           "useful_existing_copies so far: %s, existing_copyset_size: %d",
           node.toString().c_str(),
-          toString(nodeset_indices_).c_str(),
+          toString(*nodeset_indices_).c_str(),
           logid_.val_,
           rangeToString(inout_copyset,
                         inout_copyset +
@@ -1193,7 +1194,7 @@ WeightedCopySetSelector::augment(StoreChainLink inout_copyset[],
           MAX_BLACKLISTING_ITERATIONS,
           rangeToString(inout_copyset, inout_copyset + useful_existing_copies)
               .c_str(),
-          toString(nodeset_indices_).c_str());
+          toString(*nodeset_indices_).c_str());
       return ret = Result::FAILED;
     }
     ++attempts;
@@ -1237,7 +1238,7 @@ WeightedCopySetSelector::augment(StoreChainLink inout_copyset[],
             NodeLocation::scopeNames()[secondary_replication_scope_].c_str(),
             rangeToString(inout_copyset, inout_copyset + out_size).c_str(),
             useful_existing_copies,
-            toString(nodeset_indices_).c_str(),
+            toString(*nodeset_indices_).c_str(),
             toString(cache.unavailable_nodes).c_str(),
             (int)secondary_replication_,
             NodeLocation::scopeNames()[secondary_replication_scope_].c_str(),
@@ -1277,7 +1278,7 @@ WeightedCopySetSelector::augment(StoreChainLink inout_copyset[],
           logid_.val_,
           rangeToString(inout_copyset, inout_copyset + out_size).c_str(),
           useful_existing_copies,
-          toString(nodeset_indices_).c_str());
+          toString(*nodeset_indices_).c_str());
       return ret = retry_on_copyset_failure();
     }
 
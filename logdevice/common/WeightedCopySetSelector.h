@@ -13,6 +13,7 @@
 #include "logdevice/common/Random.h"
 #include "logdevice/common/Sampling.h"
 #include "logdevice/common/SmallMap.h"
+#include "logdevice/common/StorageSetRegistry.h"
 #include "logdevice/common/configuration/ReplicationProperty.h"
 
 namespace facebook { namespace logdevice {
@@ -304,7 +305,8 @@ class WeightedCopySetSelector : public CopySetSelector {
 
   StatsHolder* stats_;
 
-  StorageSet nodeset_indices_;
+  // Interned, shared with the other logs on the same nodeset.
+  StorageSetRegistry::Ptr nodeset_indices_;
 
   Hierarchy hierarchy_;
 
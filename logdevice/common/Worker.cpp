@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <pthread.h>
 #include <string>
+#include <time.h>
 #include <unistd.h>
 
 #include <folly/Memory.h>
@@ -21,6 +22,7 @@
 #include "logdevice/common/AllSequencers.h"
 #include "logdevice/common/AppendRequest.h"
 #include "logdevice/common/AppendRequestBase.h"
+#include "logdevice/common/AppendWindows.h"
 #include "logdevice/common/Appender.h"
 #include "logdevice/common/AppenderBuffer.h"
 #include "logdevice/common/CheckNodeHealthRequest.h"
@@ -44,12 +46,16 @@
 #include "logdevice/common/GraylistingTracker.h"
 #include "logdevice/common/LogIDUniqueQueue.h"
 #include "logdevice/common/LogRecoveryRequest.h"
+#include "logdevice/common/LogRecoveryScheduler.h"
 #include "logdevice/common/LogsConfigApiRequest.h"
 #include "logdevice/common/LogsConfigUpdatedRequest.h"
 #include "logdevice/common/MetaDataLogWriter.h"
+#include "logdevice/common/SealBatcher.h"
 #include "logdevice/common/NodesConfigurationUpdatedRequest.h"
+#include "logdevice/common/NumaPlacement.h"
 #include "logdevice/common/PermissionChecker.h"
 #include "logdevice/common/Processor.h"
+#include "logdevice/common/ReleaseBatcher.h"
 #include "logdevice/common/SSLFetcher.h"
 #include "logdevice/common/SequencerBackgroundActivator.h"
 #include "logdevice/common/ServerConfigUpdatedRequest.h"
@@ -128,6 +134,7 @@ class WorkerImpl {
                     new AsyncSocketConnectionFactory(
                         w->getEvBase().getEventBase())),
                 stats),
+        appendWindows_(&AppendRequest::resumeAfterWindowWait, stats),
         activeAppenders_(w->immutable_settings_->server ? N_APPENDER_MAP_BUCKETS
                                                         : 1),
         // AppenderBuffer queue capacity is the system-wide per-log limit
@@ -165,6 +172,9 @@ class WorkerImpl {
   LogsConfigManagerRequestMap runningLogsConfigManagerReqs_;
   LogsConfigManagerReplyMap runningLogsConfigManagerReplies_;
   SettingOverrideTTLRequestMap activeSettingOverrides_;
+  // Must outlive runningAppends_, AppendRequest destructors release their
+  // slot in the window.
+  AppendWindows appendWindows_;
   AppendRequestMap runningAppends_;
   CheckSealRequestMap runningCheckSeals_;
   ConfigurationFetchRequestMap runningConfigurationFetches_;
@@ -172,7 +182,12 @@ class WorkerImpl {
   AppenderMap activeAppenders_;
   GetLogInfoRequestMaps runningGetLogInfo_;
   ClusterStateSubscriptionList clusterStateSubscriptions_;
+  // Must outlive runningLogRecoveries_, LogRecoveryRequest destructors
+  // release the shards they were accounted for.
+  LogRecoveryScheduler recoveryScheduler_;
   LogRecoveryRequestMap runningLogRecoveries_;
+  SealBatcher sealBatcher_;
+  ReleaseBatcher releaseBatcher_;
   SyncSequencerRequestList runningSyncSequencerRequests_;
   AppenderBuffer appenderBuffer_;
   AppenderBuffer previously_redirected_appends_;
@@ -285,7 +300,14 @@ std::string Worker::getName(WorkerType type, worker_id_t idx) {
 
 std::shared_ptr<Configuration> Worker::getConfiguration() const {
   ld_check((bool)config_);
-  return config_->get();
+  // Read the version before the configs, so that an update racing with
+  // config_->get() is picked up by the next call at the latest.
+  const uint64_t version = config_->getVersion();
+  if (config_snapshot_ == nullptr || version != config_snapshot_version_) {
+    config_snapshot_ = config_->get();
+    config_snapshot_version_ = version;
+  }
+  return config_snapshot_;
 }
 
 std::shared_ptr<ServerConfig> Worker::getServerConfig() const {
@@ -419,6 +441,15 @@ OverloadDetector* Worker::overloadDetector() {
   return w->overload_detector_.get();
 }
 
+std::chrono::microseconds Worker::busyPollDuration() const {
+  const std::vector<int>& workers = settings().busy_poll_workers;
+  if (worker_type_ == WorkerType::GENERAL &&
+      std::binary_search(workers.begin(), workers.end(), idx_.val_)) {
+    return settings().busy_poll_duration;
+  }
+  return std::chrono::microseconds::zero();
+}
+
 void Worker::onSettingsUpdated() {
   // If SettingsUpdatedRequest are posted faster than they're processed,
   // each request will pick up multiple settings updates. This would mean
@@ -435,6 +466,9 @@ void Worker::onSettingsUpdated() {
       {immutable_settings_->hi_requests_per_iteration,
        immutable_settings_->mid_requests_per_iteration,
        immutable_settings_->lo_requests_per_iteration});
+  event_loop->getTaskQueue().setTargetIterationLatency(
+      immutable_settings_->event_loop_target_latency);
+  event_loop->setBusyPoll(busyPollDuration());
   clientReadStreams().noteSettingsUpdated();
   if (logsconfig_manager_) {
     // LogsConfigManager might want to start or stop the underlying RSM if
@@ -442,7 +476,8 @@ void Worker::onSettingsUpdated() {
     logsconfig_manager_->onSettingsUpdated();
   }
 
-  if (!new_settings->enable_store_histogram_calculations) {
+  if (!new_settings->enable_store_histogram_calculations &&
+      !new_settings->latency_aware_copyset_selection) {
     getWorkerTimeoutStats().clear();
   }
 
@@ -546,7 +581,8 @@ void Worker::initSSLFetcher() {
                                     setting.ssl_key_path,
                                     setting.ssl_ca_path,
                                     setting.ssl_load_client_cert,
-                                    stats());
+                                    stats(),
+                                    setting.ssl_ktls_offload);
 }
 
 void Worker::setupWorker() {
@@ -567,6 +603,19 @@ void Worker::setupWorker() {
     stats_->get().worker_id = idx_;
   }
 
+  const std::vector<int>& cpus = settings().worker_cpus;
+  if (worker_type_ == WorkerType::GENERAL && !cpus.empty()) {
+    const int cpu = cpus[idx_.val_ % cpus.size()];
+    if (numa::bindThisThreadToCpus({cpu}) == 0) {
+      ld_info("Pinned worker %s to cpu %d", getName().c_str(), cpu);
+    }
+  }
+
+  auto event_loop = checked_downcast<EventLoop*>(getExecutor());
+  event_loop->getTaskQueue().setTargetIterationLatency(
+      settings().event_loop_target_latency);
+  event_loop->setBusyPoll(busyPollDuration());
+
   // Subscribe to config updates and setting updates
   initializeSubscriptions();
 
@@ -827,42 +876,67 @@ void Worker::popRecoveryRequest() {
       recoveryQueueMetaDataLog().q.get<LogIDUniqueQueue::FIFOIndex>();
   auto& dataqueue_index =
       recoveryQueueDataLog().q.get<LogIDUniqueQueue::FIFOIndex>();
+  auto& seqmap = processor_->allSequencers();
 
-  while (true) {
-    auto& index =
-        metadataqueue_index.size() > 0 ? metadataqueue_index : dataqueue_index;
-
-    if (index.size() == 0) {
+  const bool metadata = metadataqueue_index.size() > 0;
+  auto it = metadataqueue_index.begin();
+  if (!metadata) {
+    if (dataqueue_index.size() == 0) {
       return;
     }
-
-    ld_check(index.size() > 0);
-    auto& seqmap = processor_->allSequencers();
-
-    auto it = index.begin();
-    std::shared_ptr<Sequencer> seq = seqmap.findSequencer(*it);
-
-    if (!seq) {
-      // Sequencer went away.
-      if (ld_catch(MetaDataLog::isMetaDataLog(*it) && err == E::NOSEQUENCER,
-                   "INTERNAL ERROR: couldn't find sequencer for queued "
-                   "recovery for log %lu: %s",
-                   it->val_,
-                   error_name(err))) {
-        ld_info("No sequencer for queued recovery for log %lu", it->val_);
-      }
-      WORKER_STAT_INCR(recovery_completed);
-    } else if (seq->startRecovery() != 0) {
-      ld_error("Failed to start recovery for log %lu: %s",
-               it->val_,
-               error_description(err));
+    // Metadata logs are few and go first in FIFO order. For data logs, let
+    // the scheduler pick the one that's most worth recovering right now.
+    const auto& s = settings();
+    it = recoveryScheduler().pickNext(
+        recoveryQueueDataLog(),
+        s.recovery_queue_scan_limit,
+        LogRecoveryRequest::maxRecoveriesPerShard(s),
+        [&](logid_t log) -> folly::Optional<LogRecoveryScheduler::LogInfo> {
+          std::shared_ptr<Sequencer> seq = seqmap.findSequencer(log);
+          if (!seq) {
+            return folly::none;
+          }
+          LogRecoveryScheduler::LogInfo info;
+          auto metadata = seq->getCurrentMetaData();
+          if (metadata) {
+            info.shards = metadata->shards;
+          }
+          info.pending_appends = seq->getNumAppendsInFlight();
+          return info;
+        });
+    if (it == dataqueue_index.end()) {
+      // All the logs looked at involve shards that are busy recovering other
+      // logs. Try again when one of those recoveries completes.
+      WORKER_STAT_INCR(recovery_deferred_shard_limit);
       return;
     }
+  }
+
+  std::shared_ptr<Sequencer> seq = seqmap.findSequencer(*it);
 
-    WORKER_STAT_DECR(recovery_enqueued);
-    index.erase(it);
+  if (!seq) {
+    // Sequencer went away.
+    if (ld_catch(MetaDataLog::isMetaDataLog(*it) && err == E::NOSEQUENCER,
+                 "INTERNAL ERROR: couldn't find sequencer for queued "
+                 "recovery for log %lu: %s",
+                 it->val_,
+                 error_name(err))) {
+      ld_info("No sequencer for queued recovery for log %lu", it->val_);
+    }
+    WORKER_STAT_INCR(recovery_completed);
+  } else if (seq->startRecovery() != 0) {
+    ld_error("Failed to start recovery for log %lu: %s",
+             it->val_,
+             error_description(err));
     return;
   }
+
+  WORKER_STAT_DECR(recovery_enqueued);
+  if (metadata) {
+    metadataqueue_index.erase(it);
+  } else {
+    dataqueue_index.erase(it);
+  }
 }
 
 ExponentialBackoffTimerNode* Worker::registerTimer(
@@ -972,7 +1046,43 @@ ClusterState* Worker::getClusterState() {
   return Worker::onThisThread()->processor_->cluster_state_.get();
 }
 
+namespace {
+// CPU time consumed by the calling thread so far.
+std::chrono::nanoseconds threadCpuTime() {
+  struct timespec ts;
+  int rv = clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  ld_check(rv == 0);
+  return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+}
+} // namespace
+
+bool Worker::shouldSampleCpuTime() {
+  const uint32_t period = settings().worker_cpu_time_sample_period;
+  if (period == 0) {
+    return false;
+  }
+  if (cpu_time_sample_countdown_ > 0) {
+    --cpu_time_sample_countdown_;
+    return false;
+  }
+  // Random gaps, averaging `period`, so that the samples don't line up with
+  // periodic patterns of work.
+  cpu_time_sample_countdown_ = folly::Random::rand32(2 * period - 1);
+  return true;
+}
+
 void Worker::onStoppedRunning(RunContext prev_context) {
+  // Estimated CPU time of prev_context: the measured one scaled by the
+  // sampling period; negative if it wasn't sampled.
+  int64_t cpu_usec = -1;
+  if (currentlyRunningCpuStart_.count() >= 0) {
+    cpu_usec = std::chrono::duration_cast<std::chrono::microseconds>(
+                   threadCpuTime() - currentlyRunningCpuStart_)
+                   .count() *
+        settings().worker_cpu_time_sample_period;
+    currentlyRunningCpuStart_ = std::chrono::nanoseconds(-1);
+  }
+
   std::chrono::steady_clock::time_point start_time;
   start_time = currentlyRunningStart_;
   generateErrorInjection(
@@ -1008,6 +1118,10 @@ void Worker::onStoppedRunning(RunContext prev_context) {
       ld_check(msg_type < static_cast<int>(MessageType::MAX));
       MESSAGE_TYPE_STAT_ADD(
           Worker::stats(), msg_type, message_worker_usec, usec);
+      if (cpu_usec >= 0) {
+        MESSAGE_TYPE_STAT_ADD(
+            Worker::stats(), msg_type, message_worker_cpu_usec, cpu_usec);
+      }
       HISTOGRAM_ADD(Worker::stats(), message_callback_duration[msg_type], usec);
       break;
     }
@@ -1015,6 +1129,10 @@ void Worker::onStoppedRunning(RunContext prev_context) {
       int rqtype = static_cast<int>(prev_context.subtype_.request);
       ld_check(rqtype < static_cast<int>(RequestType::MAX));
       REQUEST_TYPE_STAT_ADD(Worker::stats(), rqtype, request_worker_usec, usec);
+      if (cpu_usec >= 0) {
+        REQUEST_TYPE_STAT_ADD(
+            Worker::stats(), rqtype, request_worker_cpu_usec, cpu_usec);
+      }
       HISTOGRAM_ADD(Worker::stats(), request_execution_duration[rqtype], usec);
       break;
     }
@@ -1023,6 +1141,12 @@ void Worker::onStoppedRunning(RunContext prev_context) {
       ld_check(task_type < static_cast<int>(StorageTaskType::MAX));
       STORAGE_TASK_TYPE_STAT_ADD(
           Worker::stats(), task_type, storage_task_response_worker_usec, usec);
+      if (cpu_usec >= 0) {
+        STORAGE_TASK_TYPE_STAT_ADD(Worker::stats(),
+                                   task_type,
+                                   storage_task_response_worker_cpu_usec,
+                                   cpu_usec);
+      }
       HISTOGRAM_ADD(
           Worker::stats(), storage_task_response_duration[task_type], usec);
       break;
@@ -1030,6 +1154,12 @@ void Worker::onStoppedRunning(RunContext prev_context) {
     case RunContext::NONE: {
       REQUEST_TYPE_STAT_ADD(
           Worker::stats(), RequestType::INVALID, request_worker_usec, usec);
+      if (cpu_usec >= 0) {
+        REQUEST_TYPE_STAT_ADD(Worker::stats(),
+                              RequestType::INVALID,
+                              request_worker_cpu_usec,
+                              cpu_usec);
+      }
       HISTOGRAM_ADD(
           Worker::stats(),
           request_execution_duration[static_cast<int>(RequestType::INVALID)],
@@ -1041,6 +1171,10 @@ void Worker::onStoppedRunning(RunContext prev_context) {
 
 void Worker::onStartedRunning(RunContext new_context) {
   setCurrentlyRunningContext(new_context, RunContext());
+  ld_check(currentlyRunningCpuStart_.count() < 0);
+  if (shouldSampleCpuTime()) {
+    currentlyRunningCpuStart_ = threadCpuTime();
+  }
 }
 
 void Worker::activateIsolationTimer() {
@@ -1070,7 +1204,9 @@ std::unique_ptr<MessageDispatch> Worker::createMessageDispatch() {
 
 // Stashes current RunContext and pauses its timer. Returns everything needed to
 // restore it. Use it for nesting RunContexts.
-std::tuple<RunContext, std::chrono::steady_clock::duration>
+std::tuple<RunContext,
+           std::chrono::steady_clock::duration,
+           std::chrono::nanoseconds>
 Worker::packRunContext() {
   Worker* w = Worker::onThisThread(false);
   if (!w) {
@@ -1078,19 +1214,26 @@ Worker::packRunContext() {
                     10,
                     "Attempting to pack worker context while not on a worker.");
     ld_check(false);
-    return std::make_tuple(
-        RunContext(), std::chrono::steady_clock::duration(0));
+    return std::make_tuple(RunContext(),
+                           std::chrono::steady_clock::duration(0),
+                           std::chrono::nanoseconds(-1));
   }
+  auto cpu_time = w->currentlyRunningCpuStart_.count() >= 0
+      ? threadCpuTime() - w->currentlyRunningCpuStart_
+      : std::chrono::nanoseconds(-1);
   auto res = std::make_tuple(
       w->currentlyRunning_,
-      std::chrono::steady_clock::now() - w->currentlyRunningStart_);
+      std::chrono::steady_clock::now() - w->currentlyRunningStart_,
+      cpu_time);
   w->currentlyRunning_ = RunContext();
   w->currentlyRunningStart_ = std::chrono::steady_clock::now();
+  w->currentlyRunningCpuStart_ = std::chrono::nanoseconds(-1);
   return res;
 }
 
-void Worker::unpackRunContext(
-    std::tuple<RunContext, std::chrono::steady_clock::duration> s) {
+void Worker::unpackRunContext(std::tuple<RunContext,
+                                         std::chrono::steady_clock::duration,
+                                         std::chrono::nanoseconds> s) {
   Worker* w = Worker::onThisThread(false);
   if (!w) {
     RATELIMIT_ERROR(std::chrono::seconds(10),
@@ -1102,6 +1245,9 @@ void Worker::unpackRunContext(
   ld_check(w->currentlyRunning_.type_ == RunContext::Type::NONE);
   w->currentlyRunning_ = std::get<0>(s);
   w->currentlyRunningStart_ = std::chrono::steady_clock::now() - std::get<1>(s);
+  w->currentlyRunningCpuStart_ = std::get<2>(s).count() >= 0
+      ? threadCpuTime() - std::get<2>(s)
+      : std::chrono::nanoseconds(-1);
 }
 
 //
@@ -1168,6 +1314,10 @@ AppendRequestMap& Worker::runningAppends() const {
   return impl_->runningAppends_;
 }
 
+AppendWindows& Worker::appendWindows() const {
+  return impl_->appendWindows_;
+}
+
 CheckSealRequestMap& Worker::runningCheckSeals() const {
   return impl_->runningCheckSeals_;
 }
@@ -1216,6 +1366,18 @@ LogIDUniqueQueue& Worker::recoveryQueueMetaDataLog() const {
   return impl_->recoveryQueueMetaDataLog_;
 }
 
+LogRecoveryScheduler& Worker::recoveryScheduler() const {
+  return impl_->recoveryScheduler_;
+}
+
+SealBatcher& Worker::sealBatcher() const {
+  return impl_->sealBatcher_;
+}
+
+ReleaseBatcher& Worker::releaseBatcher() const {
+  return impl_->releaseBatcher_;
+}
+
 ShardAuthoritativeStatusManager& Worker::shardStatusManager() const {
   return impl_->shardStatusManager_;
 }
@@ -1383,6 +1545,7 @@ void Worker::addWithPriority(folly::Func func, int8_t priority) {
                 std::chrono::steady_clock::now() - enqueue_time);
 
         HISTOGRAM_ADD(stats_, requests_queue_latency, queue_time.count());
+        queue_latency_.add(queue_time.count());
         switch (priority) {
           case folly::Executor::HI_PRI:
             HISTOGRAM_ADD(stats_, hi_pri_requests_latency, queue_time.count());
@@ -1425,6 +1588,33 @@ int Worker::forcePost(std::unique_ptr<Request>& req) {
   return 0;
 }
 
+int Worker::forcePostBatch(std::vector<std::unique_ptr<Request>>& reqs,
+                           int8_t priority) {
+  if (shutting_down_) {
+    err = E::SHUTDOWN;
+    return -1;
+  }
+
+  const auto now = std::chrono::steady_clock::now();
+  for (const auto& req : reqs) {
+    if (!req) {
+      err = E::INVALID_PARAM;
+      return -1;
+    }
+    req->enqueue_time_ = now;
+  }
+
+  folly::Func func = [rqs = std::move(reqs), this]() mutable {
+    for (auto& rq : rqs) {
+      processRequest(std::move(rq));
+    }
+  };
+  reqs.clear();
+  addWithPriority(std::move(func), priority);
+
+  return 0;
+}
+
 void Worker::generateErrorInjection(double error_chance,
                                     std::chrono::milliseconds sleep_duration) {
   if (UNLIKELY(worker_type_ == WorkerType::GENERAL && error_chance > 0 &&
@@ -110,6 +110,7 @@ namespace facebook { namespace logdevice {
  */
 
 class AllClientReadStreams;
+class AppendWindows;
 class AppenderBuffer;
 class BufferedWriterShard;
 class ClusterState;
@@ -125,8 +126,10 @@ class MetaDataLogReader;
 class Mutator;
 class Processor;
 class RebuildingCoordinatorInterface;
+class ReleaseBatcher;
 class Request;
 class SSLFetcher;
+class SealBatcher;
 class Sender;
 class SequencerBackgroundActivator;
 class ServerConfig;
@@ -163,6 +166,7 @@ struct GetLogInfoRequestMaps;
 struct GetRsmSnapshotRequestMap;
 struct GetTrimPointRequestMap;
 struct LogIDUniqueQueue;
+class LogRecoveryScheduler;
 struct LogRecoveryRequestMap;
 struct LogsConfigApiRequestMap;
 struct LogsConfigManagerReplyMap;
@@ -255,7 +259,10 @@ class Worker : public WorkContext {
 
   /**
    * @return cluster configuration object cached on this Worker and
-   *         auto updated
+   *         auto updated. The object is only rebuilt when one of the
+   *         underlying configs changes, and its reference count is only
+   *         touched by this Worker's thread, so this is cheap to call on
+   *         every message. Must be called on this Worker's thread.
    */
   std::shared_ptr<Configuration> getConfiguration() const;
 
@@ -454,6 +461,9 @@ class Worker : public WorkContext {
   // a map of all currently running AppendRequests
   AppendRequestMap& runningAppends() const;
 
+  // per-log windows of in-flight AppendRequests
+  AppendWindows& appendWindows() const;
+
   // a map of all currently running CheckSealRequest
   CheckSealRequestMap& runningCheckSeals() const;
   ShapingContainer& readShapingContainer() const;
@@ -523,6 +533,18 @@ class Worker : public WorkContext {
   LogIDUniqueQueue& recoveryQueueDataLog() const;
   LogIDUniqueQueue& recoveryQueueMetaDataLog() const;
 
+  // Picks logs from recoveryQueueDataLog() and keeps track of the storage
+  // shards running recoveries involve.
+  LogRecoveryScheduler& recoveryScheduler() const;
+
+  // Batches the SEALs sent by log recoveries, see
+  // Settings::seal_batching.
+  SealBatcher& sealBatcher() const;
+
+  // Batches periodic RELEASEs sent by sequencers, see
+  // Settings::release_batching.
+  ReleaseBatcher& releaseBatcher() const;
+
   static OverloadDetector* overloadDetector();
 
   // EventLogStateMachine only exists on Worker 0 of a server. It provides an
@@ -708,6 +730,11 @@ class Worker : public WorkContext {
   // Time when currentlyRunning_ was set
   std::chrono::steady_clock::time_point currentlyRunningStart_;
 
+  // CPU time of this thread when currentlyRunning_ was set, if the CPU time
+  // of currentlyRunning_ is sampled (see
+  // Settings::worker_cpu_time_sample_period), negative otherwise.
+  std::chrono::nanoseconds currentlyRunningCpuStart_{-1};
+
   // This should be called whenever the ServerConfig  has been updated.
   // Has to be called from the worker thread
   virtual void onServerConfigUpdated();
@@ -729,16 +756,21 @@ class Worker : public WorkContext {
   // prev_context
   void onStoppedRunning(RunContext prev_context);
 
-  // Packs the current RunContext and returns it along with how long it ran for,
-  // sets the current RunContext to NONE
-  static std::tuple<RunContext, std::chrono::steady_clock::duration>
+  // Packs the current RunContext and returns it along with how long it ran for
+  // and, if sampled, how much CPU time it took (negative otherwise), sets the
+  // current RunContext to NONE
+  static std::tuple<RunContext,
+                    std::chrono::steady_clock::duration,
+                    std::chrono::nanoseconds>
   packRunContext();
 
   // Unpacks the given RunContext, sets the current worker's RunContext to the
-  // one supplied and adds the supplied duration to the duration of the current
-  // RunContext.
-  static void unpackRunContext(
-      std::tuple<RunContext, std::chrono::steady_clock::duration> s);
+  // one supplied and adds the supplied durations to the durations of the
+  // current RunContext.
+  static void
+  unpackRunContext(std::tuple<RunContext,
+                              std::chrono::steady_clock::duration,
+                              std::chrono::nanoseconds> s);
 
   // For debugging.
   static std::string describeMyNode();
@@ -763,6 +795,12 @@ class Worker : public WorkContext {
     return *worker_timeout_stats_;
   }
 
+  // Time requests and other work spent in this worker's queue, in
+  // microseconds.
+  const LatencyHistogram& getQueueLatencyHistogram() const {
+    return queue_latency_;
+  }
+
   const std::unordered_set<node_index_t>& getGraylistedNodes() const;
   void resetGraylist();
 
@@ -795,6 +833,18 @@ class Worker : public WorkContext {
    */
   int forcePost(std::unique_ptr<Request>& req);
 
+  /**
+   * Like forcePost() for several requests at once: they are added to the
+   * task queue with the given priority as a single task, so that the worker
+   * is woken up at most once for all of them. Requests are processed in
+   * order. On success `reqs` is left empty.
+   *
+   * @return 0 if the requests were posted. Otherwise it returns -1 and err
+   * contains the actual error_code.
+   */
+  int forcePostBatch(std::vector<std::unique_ptr<Request>>& reqs,
+                     int8_t priority);
+
   virtual void setupWorker();
   // Callback functions that register worker id and duration of slow/delayed
   // action.
@@ -822,9 +872,21 @@ class Worker : public WorkContext {
   // Initializes subscriptions to config and setting updates
   void initializeSubscriptions();
 
+  // Busy-poll duration of this worker's event loop, per the busy-poll-*
+  // settings
+  std::chrono::microseconds busyPollDuration() const;
+
   // Helper used by onStartedRunning() and onStoppedRunning()
   void setCurrentlyRunningContext(RunContext new_context,
                                   RunContext prev_context);
+
+  // Called by onStartedRunning(), decides whether to measure the CPU time of
+  // the context being started.
+  bool shouldSampleCpuTime();
+
+  // Number of contexts to start before the next one whose CPU time is
+  // measured.
+  uint32_t cpu_time_sample_countdown_{0};
   // Helper used to generate error injection if the conditions are correct. Used
   // to test HealthMonitor functionalities.
   void generateErrorInjection(double error_chance,
@@ -840,6 +902,11 @@ class Worker : public WorkContext {
   std::shared_ptr<UpdateableConfig> config_; // cluster config to use for
   // all ops on this thread
 
+  // Last value of config_->get() handed out by getConfiguration(), and the
+  // config_->getVersion() it was built at.
+  mutable std::shared_ptr<Configuration> config_snapshot_;
+  mutable uint64_t config_snapshot_version_{0};
+
   // Handles for our subscriptions to config updates, used in destructor to
   // unsubscribe
   ConfigSubscriptionHandle server_config_update_sub_;
@@ -928,6 +995,9 @@ class Worker : public WorkContext {
   // Used to return NOBUFS when count goes above worker_request_pipe_capacity.
   std::atomic<size_t> num_requests_enqueued_{0};
 
+  // See getQueueLatencyHistogram(). Only updated on this worker's thread.
+  LatencyHistogram queue_latency_;
+
   // Stop on EventLogStateMachine should only be called once.
   // Set to true once stop has been called
   bool event_log_stopped_{false};
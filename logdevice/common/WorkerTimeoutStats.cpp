@@ -24,6 +24,10 @@ constexpr auto kBucketSize = 1;
 constexpr auto kMinBucketsLevel = 0;
 constexpr auto kMaxBucketsLevel = 20;
 constexpr auto kTimeBucketsNum = 10;
+// Weight of a new sample in the per-shard latency average.
+constexpr double kShardLatencyEWMAAlpha = 0.1;
+// Averages not updated for this long are forgotten.
+constexpr auto kShardLatencyMaxAge = 10s;
 constexpr std::initializer_list<std::chrono::steady_clock::duration> kLevels = {
     10s,
 };
@@ -63,9 +67,15 @@ void WorkerTimeoutStats::onReply(const ShardID& from,
   outgoing_messages_.erase(it->second);
   lookup_table_.erase(it);
 
+  updateShardLatency(from, now - message_sent_timestamp, now);
+  if (!histogramsEnabled()) {
+    return;
+  }
+
   const int64_t round_trip_time = to_msec(now - message_sent_timestamp).count();
   ld_check(round_trip_time >= 0);
   const Latency round_trip_time_log = std::log2(std::max(round_trip_time, 1L));
+
   auto histogram_iterator = histograms_.emplace(
       std::piecewise_construct,
       std::forward_as_tuple(std::get<0>(key)),
@@ -79,6 +89,35 @@ void WorkerTimeoutStats::onReply(const ShardID& from,
   overall_.addValue(now, round_trip_time_log);
 }
 
+void WorkerTimeoutStats::updateShardLatency(ShardID shard,
+                                            Clock::duration round_trip_time,
+                                            Clock::time_point now) {
+  const Latency sample =
+      duration_cast<duration<Latency, std::milli>>(round_trip_time).count();
+  auto res = shard_latencies_.emplace(shard, ShardLatency{sample, now});
+  ShardLatency& shard_latency = res.first->second;
+  if (!res.second) {
+    if (now - shard_latency.last_update > kShardLatencyMaxAge) {
+      shard_latency.ewma_ms = sample;
+    } else {
+      shard_latency.ewma_ms +=
+          kShardLatencyEWMAAlpha * (sample - shard_latency.ewma_ms);
+    }
+    shard_latency.last_update = now;
+  }
+}
+
+folly::Optional<WorkerTimeoutStats::Latency>
+WorkerTimeoutStats::getStoreLatencyEWMA(ShardID shard,
+                                        Clock::time_point now) const {
+  auto it = shard_latencies_.find(shard);
+  if (it == shard_latencies_.end() ||
+      now - it->second.last_update > kShardLatencyMaxAge) {
+    return folly::none;
+  }
+  return it->second.ewma_ms;
+}
+
 void WorkerTimeoutStats::cleanup() {
   const size_t size = outgoing_messages_.size();
   if (size <= kMaxNumberOfOutgoingMessages) {
@@ -122,6 +161,7 @@ WorkerTimeoutStats::getEstimations(Levels level,
 void WorkerTimeoutStats::clear() {
   histograms_.clear();
   overall_.clear();
+  shard_latencies_.clear();
   outgoing_messages_.clear();
   lookup_table_.clear();
 }
@@ -130,6 +170,11 @@ uint64_t WorkerTimeoutStats::getMinSamplesPerBucket() const {
   return Worker::settings().store_histogram_min_samples_per_bucket;
 }
 
+bool WorkerTimeoutStats::histogramsEnabled() const {
+  Worker* w = Worker::onThisThread(false);
+  return !w || w->settings().enable_store_histogram_calculations;
+}
+
 constexpr std::array<double, 6> WorkerTimeoutStats::kQuantiles;
 
 }} // namespace facebook::logdevice
@@ -63,15 +63,37 @@ class WorkerTimeoutStats {
                  int node = -1,
                  Clock::time_point now = Clock::now());
 
+  // Exponentially weighted moving average of the STORE round trip time to
+  // `shard', in milliseconds. folly::none if the shard didn't reply recently.
+  // Reacts to a slow shard within a few dozen replies.
+  folly::Optional<Latency>
+  getStoreLatencyEWMA(ShardID shard,
+                      Clock::time_point now = Clock::now()) const;
+
   std::unordered_map<node_index_t, Histogram> histograms_;
   Histogram overall_;
 
  protected:
   virtual uint64_t getMinSamplesPerBucket() const;
 
+  // Replies are also recorded when only the per-shard averages are needed,
+  // for latency-aware copyset selection. Histograms are only updated if this
+  // returns true.
+  virtual bool histogramsEnabled() const;
+
  private:
   void cleanup();
 
+  void updateShardLatency(ShardID shard,
+                          Clock::duration round_trip_time,
+                          Clock::time_point now);
+
+  struct ShardLatency {
+    Latency ewma_ms;
+    Timepoint last_update;
+  };
+  std::unordered_map<ShardID, ShardLatency, ShardID::Hash> shard_latencies_;
+
   std::map<MessageKey, std::list<std::pair<MessageKey, Timepoint>>::iterator>
       lookup_table_;
 
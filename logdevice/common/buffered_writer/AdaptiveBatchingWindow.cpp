@@ -0,0 +1,69 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/buffered_writer/AdaptiveBatchingWindow.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace facebook { namespace logdevice {
+
+constexpr double AdaptiveBatchingWindow::ALPHA;
+constexpr double AdaptiveBatchingWindow::MIN_EXPECTED_APPENDS;
+
+void AdaptiveBatchingWindow::onAppend(Clock::time_point now, size_t bytes) {
+  if (num_appends_ == 0) {
+    avg_bytes_ = bytes;
+  } else {
+    avg_bytes_ += ALPHA * (bytes - avg_bytes_);
+    const auto gap =
+        std::chrono::duration_cast<std::chrono::microseconds>(now -
+                                                              last_append_);
+    const double gap_usec = std::max<double>(0, gap.count());
+    avg_gap_usec_ = avg_gap_usec_ < 0
+        ? gap_usec
+        : avg_gap_usec_ + ALPHA * (gap_usec - avg_gap_usec_);
+  }
+  last_append_ = now;
+  ++num_appends_;
+}
+
+std::chrono::milliseconds
+AdaptiveBatchingWindow::getWindow(std::chrono::milliseconds budget,
+                                  ssize_t size_trigger) const {
+  if (budget.count() <= 0) {
+    return budget;
+  }
+  if (avg_gap_usec_ < 0) {
+    // Don't know the rate yet. Assume a quiet log.
+    return std::chrono::milliseconds::zero();
+  }
+
+  const double budget_usec = budget.count() * 1000.0;
+  // Appends expected within the budget, including the one that opened the
+  // batch.
+  const double expected = 1 + budget_usec / std::max(avg_gap_usec_, 1.0);
+  if (expected < MIN_EXPECTED_APPENDS) {
+    return std::chrono::milliseconds::zero();
+  }
+
+  double window_usec = budget_usec;
+  if (size_trigger >= 0) {
+    // Time until the batch is expected to reach the size trigger.
+    const double appends_to_fill =
+        std::ceil(size_trigger / std::max(avg_bytes_, 1.0));
+    const double fill_usec = std::max(appends_to_fill - 1, 0.0) * avg_gap_usec_;
+    window_usec = std::min(window_usec, fill_usec);
+  }
+  // Round up so that a short window doesn't degrade into no batching.
+  return std::min(
+      budget,
+      std::chrono::milliseconds(
+          static_cast<int64_t>(std::ceil(window_usec / 1000.0))));
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,81 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <sys/types.h>
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Picks how long BufferedWriter should hold a new batch for a log open
+ *       before flushing it, based on the append arrival rate measured on
+ *       that log. Used when BufferedWriter::LogOptions::adaptive_time_trigger
+ *       is set, in which case LogOptions::time_trigger is the latency budget:
+ *       the longest time any append may wait.
+ *
+ *       The idea is Nagle's algorithm with a deadline: only wait when more
+ *       appends are expected to arrive within the budget, and only for as
+ *       long as it takes to fill the batch up to LogOptions::size_trigger.
+ *       A log that gets an append every few seconds flushes right away
+ *       instead of paying the whole budget, while a hot log waits long enough
+ *       to build batches of size_trigger bytes.
+ *
+ *       Arrival rate and append size are tracked as exponentially weighted
+ *       moving averages. Not thread safe; owned by a BufferedWriterSingleLog.
+ */
+
+class AdaptiveBatchingWindow {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // Weight of a new sample in the moving averages.
+  static constexpr double ALPHA = 0.125;
+
+  // Don't wait for more appends unless at least this many are expected to
+  // arrive within the latency budget, counting the one that opened the batch.
+  static constexpr double MIN_EXPECTED_APPENDS = 2.0;
+
+  /**
+   * Records the arrival of an append (or of a chunk of appends that get
+   * batched atomically) with the given number of payload bytes.
+   */
+  void onAppend(Clock::time_point now, size_t bytes);
+
+  /**
+   * @param budget        maximum time an append may be buffered; negative
+   *                      means no time trigger
+   * @param size_trigger  flush threshold in payload bytes; negative for none
+   *
+   * @return how long to buffer a batch that was just opened. Zero means
+   *         flush as soon as the current event loop iteration is done. The
+   *         result is never more than budget. Negative if budget is.
+   */
+  std::chrono::milliseconds getWindow(std::chrono::milliseconds budget,
+                                      ssize_t size_trigger) const;
+
+  // @return average time between appends in microseconds, or a negative
+  //         value if fewer than two appends were observed
+  double averageGapUsec() const {
+    return avg_gap_usec_;
+  }
+
+  // @return average payload bytes per append
+  double averageBytes() const {
+    return avg_bytes_;
+  }
+
+ private:
+  Clock::time_point last_append_{};
+  size_t num_appends_ = 0;
+  double avg_gap_usec_ = -1;
+  double avg_bytes_ = 0;
+};
+
+}} // namespace facebook::logdevice
@@ -17,6 +17,7 @@
 
 #include "logdevice/common/Checksum.h"
 #include "logdevice/common/buffered_writer/BufferedWriteDecoderImpl.h"
+#include "logdevice/common/buffered_writer/ZstdDictionaryRegistry.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/include/types.h"
 
@@ -44,10 +45,12 @@ void BufferedWriteSinglePayloadsCodec::Encoder::append(
   }
 }
 
-void BufferedWriteSinglePayloadsCodec::Encoder::encode(folly::IOBufQueue& out,
-                                                       Compression& compression,
-                                                       int zstd_level) {
-  bool compressed = compress(compression, zstd_level);
+void BufferedWriteSinglePayloadsCodec::Encoder::encode(
+    folly::IOBufQueue& out,
+    Compression& compression,
+    int zstd_level,
+    uint32_t zstd_dictionary_id) {
+  bool compressed = compress(compression, zstd_level, zstd_dictionary_id);
   if (!compressed) {
     compression = Compression::NONE;
   }
@@ -56,7 +59,8 @@ void BufferedWriteSinglePayloadsCodec::Encoder::encode(folly::IOBufQueue& out,
 
 bool BufferedWriteSinglePayloadsCodec::Encoder::compress(
     Compression compression,
-    int zstd_level) {
+    int zstd_level,
+    uint32_t zstd_dictionary_id) {
   if (compression == Compression::NONE) {
     // Nothing to do.
     return true;
@@ -88,11 +92,36 @@ bool BufferedWriteSinglePayloadsCodec::Encoder::compress(
   size_t compressed_size;
   if (compression == Compression::ZSTD) {
     ld_check(zstd_level > 0);
-    compressed_size = ZSTD_compress(out,              // dst
-                                    end - out,        // dstCapacity
-                                    to_compress.data, // src
-                                    to_compress.size, // srcSize
-                                    zstd_level);      // level
+    std::shared_ptr<const ZstdDictionaryRegistry::Dictionary> dict;
+    const ZSTD_CDict* cdict = nullptr;
+    if (zstd_dictionary_id != 0) {
+      dict = ZstdDictionaryRegistry::get(zstd_dictionary_id);
+      cdict = dict ? dict->getCDict(zstd_level) : nullptr;
+      if (!cdict) {
+        RATELIMIT_WARNING(std::chrono::seconds(10),
+                          1,
+                          "zstd dictionary %u is not registered, compressing "
+                          "without it",
+                          zstd_dictionary_id);
+      }
+    }
+    if (cdict) {
+      // The frame header names the dictionary for the decoder.
+      std::unique_ptr<ZSTD_CCtx, size_t (*)(ZSTD_CCtx*)> cctx(
+          ZSTD_createCCtx(), ZSTD_freeCCtx);
+      compressed_size = ZSTD_compress_usingCDict(cctx.get(),
+                                                 out,
+                                                 end - out,
+                                                 to_compress.data,
+                                                 to_compress.size,
+                                                 cdict);
+    } else {
+      compressed_size = ZSTD_compress(out,              // dst
+                                      end - out,        // dstCapacity
+                                      to_compress.data, // src
+                                      to_compress.size, // srcSize
+                                      zstd_level);      // level
+    }
     if (ZSTD_isError(compressed_size)) {
       ld_critical(
           "ZSTD_compress() failed: %s", ZSTD_getErrorName(compressed_size));
@@ -172,10 +201,33 @@ folly::Optional<folly::IOBuf> uncompress(const Slice& slice,
       ld_check(false);
       return folly::none;
     case Compression::ZSTD: {
-      size_t rv = ZSTD_decompress(out.writableTail(), // dst
-                                  uncompressed_size,  // dstCapacity
-                                  ptr,                // src
-                                  end - ptr);         // compressedSize
+      // Batches compressed with a dictionary name it in the frame header.
+      const uint32_t dict_id = ZSTD_getDictID_fromFrame(ptr, end - ptr);
+      size_t rv;
+      if (dict_id == 0) {
+        rv = ZSTD_decompress(out.writableTail(), // dst
+                             uncompressed_size,  // dstCapacity
+                             ptr,                // src
+                             end - ptr);         // compressedSize
+      } else {
+        auto dict = ZstdDictionaryRegistry::get(dict_id);
+        if (!dict) {
+          RATELIMIT_ERROR(std::chrono::seconds(1),
+                          1,
+                          "Batch is compressed with zstd dictionary %u, which "
+                          "is not registered",
+                          dict_id);
+          return folly::none;
+        }
+        std::unique_ptr<ZSTD_DCtx, size_t (*)(ZSTD_DCtx*)> dctx(
+            ZSTD_createDCtx(), ZSTD_freeDCtx);
+        rv = ZSTD_decompress_usingDDict(dctx.get(),
+                                        out.writableTail(),
+                                        uncompressed_size,
+                                        ptr,
+                                        end - ptr,
+                                        dict->getDDict());
+      }
       if (ZSTD_isError(rv)) {
         RATELIMIT_ERROR(std::chrono::seconds(1),
                         1,
@@ -293,6 +345,50 @@ size_t BufferedWriteSinglePayloadsCodec::decode(
   return cursor.getCurrentPosition();
 }
 
+size_t BufferedWriteSinglePayloadsCodec::decode(
+    const Slice& binary,
+    Compression compression,
+    PayloadGroupCodec::DecodedColumn& column_out,
+    bool allow_buffer_sharing) {
+  auto uncompressed = uncompress(binary, compression);
+  if (!uncompressed) {
+    return 0;
+  }
+  if (!allow_buffer_sharing) {
+    uncompressed->makeManaged();
+  }
+
+  // uncompress() always returns a single buffer, so walk it directly instead
+  // of going through a Cursor.
+  std::vector<PayloadGroupCodec::DecodedColumn::Range> ranges;
+  folly::ByteRange range = uncompressed->coalesce();
+  const uint8_t* const begin = range.begin();
+  while (!range.empty()) {
+    auto len = folly::tryDecodeVarint(range);
+    if (!len) {
+      RATELIMIT_ERROR(std::chrono::seconds(1), 1, "Failed to decode varint");
+      return 0;
+    }
+    if (*len > range.size()) {
+      RATELIMIT_ERROR(std::chrono::seconds(1),
+                      1,
+                      "Expected %lu more bytes based on length varint but "
+                      "there are only %zu left",
+                      *len,
+                      range.size());
+      return 0;
+    }
+    ranges.push_back({size_t(range.begin() - begin), size_t(*len), true});
+    range.advance(*len);
+  }
+
+  const size_t consumed = uncompressed->length();
+  column_out.key = 0;
+  column_out.data = std::move(uncompressed.value());
+  column_out.ranges = std::move(ranges);
+  return consumed;
+}
+
 void BufferedWriteSinglePayloadsCodec::Estimator::append(
     const folly::IOBuf& payload) {
   const size_t len = payload.computeChainDataLength();
@@ -364,7 +460,8 @@ template <typename PayloadsEncoder>
 void BufferedWriteCodec::Encoder<PayloadsEncoder>::encode(
     folly::IOBufQueue& out,
     Compression compression,
-    int zstd_level) {
+    int zstd_level,
+    uint32_t zstd_dictionary_id) {
   folly::IOBufQueue queue;
   if constexpr (std::is_same_v<PayloadsEncoder, PayloadGroupCodec::Encoder>) {
     // Make sure there's headroom reserved
@@ -375,7 +472,12 @@ void BufferedWriteCodec::Encoder<PayloadsEncoder>::encode(
     queue.append(std::move(iobuf));
   }
 
-  payloads_encoder_.encode(queue, compression, zstd_level);
+  if constexpr (std::is_same_v<PayloadsEncoder, PayloadGroupCodec::Encoder>) {
+    payloads_encoder_.encode(queue, compression, zstd_level);
+  } else {
+    payloads_encoder_.encode(
+        queue, compression, zstd_level, zstd_dictionary_id);
+  }
 
   auto blob = queue.move();
   if constexpr (std::is_same_v<PayloadsEncoder, PayloadGroupCodec::Encoder>) {
@@ -683,6 +785,48 @@ size_t BufferedWriteCodec::decode(Slice binary,
   return 0;
 }
 
+FOLLY_NODISCARD
+size_t BufferedWriteCodec::decode(
+    Slice binary,
+    std::vector<PayloadGroupCodec::DecodedColumn>& columns_out,
+    bool allow_buffer_sharing) {
+  BufferedWriteDecoderImpl::flags_t flags;
+  Format format;
+  size_t batch_size;
+  const size_t header_size = decodeHeader(binary, &flags, &format, &batch_size);
+  if (header_size == 0) {
+    return 0;
+  }
+  const Compression compression = static_cast<Compression>(
+      flags & BufferedWriteDecoderImpl::Flags::COMPRESSION_MASK);
+  switch (format) {
+    case Format::SINGLE_PAYLOADS: {
+      if (binary.size == 0) {
+        // Nothing else to decode. Just the header.
+        return header_size;
+      }
+      PayloadGroupCodec::DecodedColumn column;
+      const size_t bytes_decoded = BufferedWriteSinglePayloadsCodec::decode(
+          binary, compression, column, allow_buffer_sharing);
+      if (bytes_decoded == 0) {
+        return 0;
+      }
+      columns_out.push_back(std::move(column));
+      return header_size + bytes_decoded;
+    }
+    case Format::PAYLOAD_GROUPS: {
+      const size_t bytes_decoded =
+          PayloadGroupCodec::decode(binary, columns_out, allow_buffer_sharing);
+      if (bytes_decoded == 0) {
+        return 0;
+      }
+      return header_size + bytes_decoded;
+    }
+  }
+  ld_check(false); // decodeHeader should check format
+  return 0;
+}
+
 FOLLY_NODISCARD
 size_t BufferedWriteCodec::decode(
     const folly::IOBuf& blob,
@@ -36,17 +36,22 @@ class BufferedWriteSinglePayloadsCodec {
      * Encodes and compressess payloads. If compressing payloads with requested
      * compresssion doesn't improve required space, then it can be left
      * uncompressed. compression parameter is updated accordingly.
+     * With ZSTD, a nonzero zstd_dictionary_id selects a dictionary from
+     * ZstdDictionaryRegistry. If it isn't registered, no dictionary is used.
      */
     void encode(folly::IOBufQueue& out,
                 Compression& compression,
-                int zstd_level = 0);
+                int zstd_level = 0,
+                uint32_t zstd_dictionary_id = 0);
 
    private:
     /**
      * Replaces blob with compressed blob if compression saves some space and
      * returns true. Otherwise leaves blob as is and returns false.
      */
-    bool compress(Compression compression, int zstd_level);
+    bool compress(Compression compression,
+                  int zstd_level,
+                  uint32_t zstd_dictionary_id);
 
     // Payloads are appended to the blob_ using appender_ */
     folly::IOBuf blob_;
@@ -77,6 +82,17 @@ class BufferedWriteSinglePayloadsCodec {
                        Compression compression,
                        std::vector<folly::IOBuf>& payloads_out,
                        bool allow_buffer_sharing);
+
+  /**
+   * Uncompresses payloads stored in batch into a single column with key 0,
+   * without splitting them into individual IOBufs. Payload lengths stay
+   * interleaved with payloads in column_out.data; ranges skip them.
+   * Returns number of bytes consumed, or 0 if decoding fails.
+   */
+  static size_t decode(const Slice& binary,
+                       Compression compression,
+                       PayloadGroupCodec::DecodedColumn& column_out,
+                       bool allow_buffer_sharing);
 };
 
 /**
@@ -109,10 +125,13 @@ class BufferedWriteCodec {
      * encoded payloads.
      * Encoder must not be re-used after calling this.
      * zstd_level must be specified if ZSTD compression is used.
+     * zstd_dictionary_id is only used for batches of single payloads, see
+     * BufferedWriteSinglePayloadsCodec::Encoder::encode().
      */
     void encode(folly::IOBufQueue& out,
                 Compression compression,
-                int zstd_level = 0);
+                int zstd_level = 0,
+                uint32_t zstd_dictionary_id = 0);
 
    private:
     /** Writes header (checksum, flags, etc) to the blob's headroom */
@@ -196,6 +215,19 @@ class BufferedWriteCodec {
                        std::vector<PayloadGroup>& payload_groups_out,
                        bool allow_buffer_sharing);
 
+  /**
+   * Decodes payloads stored in batch into one column per payload key (see
+   * PayloadGroupCodec::DecodedColumn). Single payloads become a column with
+   * key 0. No IOBufs are created for individual payloads, which makes this
+   * the cheapest way to decode batches of many small payloads.
+   * Returns number of bytes consumed, or 0 if decoding fails.
+   */
+  FOLLY_NODISCARD
+  static size_t
+  decode(Slice binary,
+         std::vector<PayloadGroupCodec::DecodedColumn>& columns_out,
+         bool allow_buffer_sharing);
+
   /**
    * Decodes payload groups without uncompressing them. This requires payloads
    * to be in PAYLOAD_GROUPS format, otherwise decoding fails.
@@ -7,6 +7,11 @@
  */
 #include "logdevice/common/buffered_writer/BufferedWriteDecoderImpl.h"
 
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <unordered_map>
+
 #include <lz4.h>
 #include <zstd.h>
 
@@ -174,6 +179,112 @@ int BufferedWriteDecoderImpl::decodeOne(
   return 0;
 }
 
+int BufferedWriteDecoderImpl::decodeColumns(
+    std::vector<std::unique_ptr<DataRecord>>&& records,
+    PayloadColumns& columns_out) {
+  using DecodedColumn = PayloadGroupCodec::DecodedColumn;
+
+  // First pass: uncompress every record into per-key columns. Uncompressed
+  // records are decoded in place, so keep them alive until their payloads
+  // are copied out below.
+  struct DecodedRecord {
+    std::unique_ptr<DataRecord> record;
+    std::vector<DecodedColumn> columns;
+    size_t rows;
+  };
+  std::vector<DecodedRecord> decoded;
+  decoded.reserve(records.size());
+  // Total size of each output column.
+  std::map<PayloadKey, size_t> column_bytes;
+  size_t rows = 0;
+  int rv = 0;
+  for (auto& record : records) {
+    std::vector<DecodedColumn> columns;
+    size_t bytes_decoded =
+        BufferedWriteCodec::decode(Slice(record->payload),
+                                   columns,
+                                   /* allow_buffer_sharing */ true);
+    if (bytes_decoded == 0) {
+      rv = -1;
+      continue;
+    }
+    const size_t record_rows = columns.empty() ? 0 : columns[0].ranges.size();
+    for (const DecodedColumn& column : columns) {
+      // PayloadGroupCodec checks that all keys have the same number of
+      // descriptors.
+      ld_check_eq(column.ranges.size(), record_rows);
+      size_t& bytes = column_bytes[column.key];
+      for (const auto& range : column.ranges) {
+        bytes += range.length;
+      }
+    }
+    rows += record_rows;
+    decoded.push_back({std::move(record), std::move(columns), record_rows});
+  }
+
+  // Lay out all columns back to back in a single buffer.
+  size_t total_bytes = 0;
+  for (const auto& [key, bytes] : column_bytes) {
+    total_bytes += bytes;
+  }
+  folly::IOBuf arena(folly::IOBuf::CREATE, std::max<size_t>(total_bytes, 1));
+  arena.append(total_bytes);
+  char* const arena_data = reinterpret_cast<char*>(arena.writableData());
+
+  columns_out.rows = rows;
+  columns_out.columns.clear();
+  columns_out.columns.reserve(column_bytes.size());
+  std::unordered_map<PayloadKey, size_t> column_index;
+  // Where the next payload of each column gets copied to.
+  std::vector<char*> write_ptr;
+  write_ptr.reserve(column_bytes.size());
+  char* column_start = arena_data;
+  for (const auto& [key, bytes] : column_bytes) {
+    column_index[key] = columns_out.columns.size();
+    auto& column = columns_out.columns.emplace_back();
+    column.key = key;
+    column.data = column_start;
+    // Rows that have no payload for this key keep a zero length.
+    column.offsets.assign(rows + 1, 0);
+    column.present.assign(rows, 0);
+    write_ptr.push_back(column_start);
+    column_start += bytes;
+  }
+
+  // Second pass: copy payloads out and record their lengths in offsets[row
+  // + 1]; prefix sums below turn lengths into offsets.
+  size_t first_row = 0;
+  for (DecodedRecord& record : decoded) {
+    for (const DecodedColumn& in : record.columns) {
+      const size_t idx = column_index.at(in.key);
+      PayloadColumns::Column& out = columns_out.columns[idx];
+      const char* src = reinterpret_cast<const char*>(in.data.data());
+      for (size_t i = 0; i < in.ranges.size(); ++i) {
+        const auto& range = in.ranges[i];
+        if (!range.present) {
+          continue;
+        }
+        const size_t row = first_row + i;
+        out.present[row] = 1;
+        out.offsets[row + 1] = range.length;
+        if (range.length > 0) {
+          memcpy(write_ptr[idx], src + range.offset, range.length);
+          write_ptr[idx] += range.length;
+        }
+      }
+    }
+    first_row += record.rows;
+  }
+  for (auto& column : columns_out.columns) {
+    for (size_t row = 0; row < rows; ++row) {
+      column.offsets[row + 1] += column.offsets[row];
+    }
+  }
+
+  pinned_buffers_.push_back(std::move(arena));
+  return rv;
+}
+
 namespace {
 /**
  * Gets IOBuf from the record to allow IOBuf sharing. If record is backed by
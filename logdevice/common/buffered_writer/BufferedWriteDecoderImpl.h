@@ -53,6 +53,9 @@ class BufferedWriteDecoderImpl : public BufferedWriteDecoder {
   int decodeOne(const DataRecord& record,
                 std::vector<PayloadGroup>& payload_groups_out);
 
+  int decodeColumns(std::vector<std::unique_ptr<DataRecord>>&& records,
+                    PayloadColumns& columns_out);
+
   // Decodes compresssed payloads and their descriptors without uncompressing.
   int decodeOneCompressed(
       std::unique_ptr<DataRecord>&& record,
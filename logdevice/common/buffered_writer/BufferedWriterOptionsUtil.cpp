@@ -18,7 +18,7 @@ namespace facebook { namespace logdevice {
 void describeBufferedWriterOptions(options_description& po,
                                    BufferedWriter::Options* opts,
                                    std::string prefix) {
-  static_assert(sizeof(BufferedWriter::Options) == 7 * 8,
+  static_assert(sizeof(BufferedWriter::Options) == 8 * 8,
                 "If you added fields to BufferedWriter::Options, you may want "
                 "to add them here as well.");
 
@@ -86,6 +86,12 @@ void describeBufferedWriterOptions(options_description& po,
           }),
       "Algorithm to use for client-side compression in Buffered writer. 'none' "
       "for no compression. Supported values: 'zstd', 'lz4', 'lz4_hc'.");
+  po.add_options()(
+      (prefix + "zstd-dictionary-id").c_str(),
+      value<uint32_t>(&opts->zstd_dictionary_id)
+          ->default_value(opts->zstd_dictionary_id),
+      "ID of a registered zstd dictionary to compress batches with when "
+      "compression is 'zstd'. 0 for none.");
   po.add_options()((prefix + "memory-limit-mb").c_str(),
                    value<int32_t>(&opts->memory_limit_mb)
                        ->default_value(opts->memory_limit_mb),
@@ -30,6 +30,7 @@
 #include "logdevice/common/buffered_writer/BufferedWriterImpl.h"
 #include "logdevice/common/buffered_writer/BufferedWriterShard.h"
 #include "logdevice/common/debug.h"
+#include "logdevice/common/stats/ServerHistograms.h"
 #include "logdevice/common/stats/Stats.h"
 
 namespace facebook { namespace logdevice {
@@ -73,6 +74,12 @@ BufferedWriterSingleLog::~BufferedWriterSingleLog() {
 }
 
 void BufferedWriterSingleLog::append(AppendChunk chunk) {
+  size_t chunk_bytes = 0;
+  for (const BufferedWriter::Append& append : chunk) {
+    chunk_bytes += BufferedWriterPayloadMeter::memorySize(append.payload);
+  }
+  adaptive_window_.onAppend(AdaptiveBatchingWindow::Clock::now(), chunk_bytes);
+
   int rv = appendImpl(chunk, /* defer_client_size_trigger */ false);
   if (rv != 0) {
     // Buffer this chunk; when the inflight batch finishes we will re-call
@@ -140,6 +147,7 @@ int BufferedWriterSingleLog::appendImpl(AppendChunk& chunk,
     options_ = get_log_options_(log_id_);
 
     auto batch = std::make_unique<Batch>(next_batch_num_++);
+    batch->zstd_dictionary_id = options_.zstd_dictionary_id;
 
     // Calculate how many bytes these records will take up in the blob
     for (const BufferedWriter::Append& append : chunk) {
@@ -324,6 +332,14 @@ void BufferedWriterSingleLog::readyToSend(Batch& batch) {
   // idea of the compression ratio
   STAT_ADD(stats, buffered_writer_bytes_in, batch.payload_memory_bytes_total);
   STAT_ADD(stats, buffered_writer_bytes_batched, batch.blob.length());
+  // Batch size, and how long its oldest append waited, including compression
+  HISTOGRAM_ADD(
+      stats, buffered_writer_batch_size, batch.payload_memory_bytes_total);
+  HISTOGRAM_ADD(stats,
+                buffered_writer_batch_delay,
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - batch.created_at)
+                    .count());
 
   setBatchState(batch, Batch::State::READY_TO_SEND);
 
@@ -524,7 +540,11 @@ void BufferedWriterSingleLog::activateTimeTrigger() {
     });
   }
   if (!time_trigger_timer_->isActive()) {
-    time_trigger_timer_->activate(options_.time_trigger);
+    time_trigger_timer_->activate(
+        options_.adaptive_time_trigger
+            ? adaptive_window_.getWindow(
+                  options_.time_trigger, options_.size_trigger)
+            : options_.time_trigger);
   }
 }
 
@@ -678,7 +698,7 @@ void encode_batch(BufferedWriterSingleLog::Batch& batch,
     }
   }
   folly::IOBufQueue encoded;
-  encoder.encode(encoded, compression, zstd_level);
+  encoder.encode(encoded, compression, zstd_level, batch.zstd_dictionary_id);
   batch.blob = encoded.moveAsValue();
 }
 } // namespace
@@ -748,7 +768,9 @@ void BufferedWriterSingleLog::construct_blob(
             batches_->size(),
             parent_->parent_->recentNumBackground());
 
-    processor_proxy->processor()->enqueueToBackgroundBlocking(
+    // If the background queue is full, compress on this thread rather than
+    // block it until a background thread frees up a slot.
+    const bool enqueued = processor_proxy->processor()->enqueueToBackground(
         [&batch,
          checksum_bits,
          destroy_payloads,
@@ -776,6 +798,15 @@ void BufferedWriterSingleLog::construct_blob(
             ld_error("Processor::postWithRetrying() failed: %d", rc);
           }
         });
+    StatsHolder* stats{parent_->parent_->processor()->stats_};
+    if (enqueued) {
+      STAT_INCR(stats, buffered_writer_batches_constructed_in_background);
+    } else {
+      STAT_INCR(stats, buffered_writer_background_queue_full);
+      Impl::construct_blob_long_running(
+          batch, checksum_bits, compression, zstd_level, destroy_payloads);
+      readyToSend(batch);
+    }
   }
 }
 
@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include <chrono>
 #include <deque>
 #include <queue>
 #include <string>
@@ -21,6 +22,7 @@
 #include "logdevice/common/ExponentialBackoffTimer.h"
 #include "logdevice/common/Request.h"
 #include "logdevice/common/SimpleEnumMap.h"
+#include "logdevice/common/buffered_writer/AdaptiveBatchingWindow.h"
 #include "logdevice/common/buffered_writer/BufferedWriteCodec.h"
 #include "logdevice/common/buffered_writer/BufferedWriteDecoderImpl.h"
 #include "logdevice/common/types_internal.h"
@@ -115,11 +117,18 @@ class BufferedWriterSingleLog {
     // Encoding format which must be used to allow encoding of all appends.
     BufferedWriteCodec::Format blob_format =
         BufferedWriteCodec::Format::SINGLE_PAYLOADS;
+    // zstd dictionary to compress the blob with, from the log options when
+    // the batch was created.  0 for none.
+    uint32_t zstd_dictionary_id = 0;
     // Blob to send to LogDevice, with the entire batch serialized.
     // Constructed the first time the batch transitions from BUILDING to
     // INFLIGHT.
     folly::IOBuf blob;
 
+    // When the batch was created, i.e. when its oldest append was buffered.
+    std::chrono::steady_clock::time_point created_at =
+        std::chrono::steady_clock::now();
+
     // How many times we've retried sending this batch
     int retry_count = 0;
     // Retry timer if in state RETRY_PENDING
@@ -241,7 +250,8 @@ class BufferedWriterSingleLog {
   void unblockAppends();
   void dropBlockedAppends(Status status, NodeID redirect);
   // Ensures that time_trigger_timer_ is active if Options::time_trigger was
-  // set by client
+  // set by client. With Options::adaptive_time_trigger, the timeout comes
+  // from adaptive_window_.
   void activateTimeTrigger();
   // Called when a batch fails to send.  Attempts to schedule a retry if
   // configured, returns 0 if the retry was successfully scheduled.
@@ -286,6 +296,8 @@ class BufferedWriterSingleLog {
   GetLogOptionsFunc get_log_options_;
   CompactableContainer<std::deque<std::unique_ptr<Batch>>> batches_;
   std::unique_ptr<Timer> time_trigger_timer_;
+  // Tracks the arrival rate of appends for Options::adaptive_time_trigger.
+  AdaptiveBatchingWindow adaptive_window_;
 
   // get_log_options_() call is not very cheap, so we call it only when
   // starting a new batch and cache the result.
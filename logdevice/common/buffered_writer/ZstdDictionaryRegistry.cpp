@@ -0,0 +1,81 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/buffered_writer/ZstdDictionaryRegistry.h"
+
+#include <unordered_map>
+
+#include <folly/Synchronized.h>
+
+#include "logdevice/common/debug.h"
+#include "logdevice/include/Err.h"
+
+namespace facebook { namespace logdevice {
+
+namespace {
+
+using Dictionary = ZstdDictionaryRegistry::Dictionary;
+using DictionaryMap =
+    std::unordered_map<uint32_t, std::shared_ptr<const Dictionary>>;
+
+folly::Synchronized<DictionaryMap>& dictionaries() {
+  static folly::Synchronized<DictionaryMap> map;
+  return map;
+}
+
+} // namespace
+
+ZstdDictionaryRegistry::Dictionary::Dictionary(std::string bytes)
+    : bytes_(std::move(bytes)),
+      id_(ZSTD_getDictID_fromDict(bytes_.data(), bytes_.size())),
+      ddict_(ZSTD_createDDict(bytes_.data(), bytes_.size())) {}
+
+ZstdDictionaryRegistry::Dictionary::~Dictionary() {
+  for (auto& kv : cdicts_) {
+    ZSTD_freeCDict(kv.second);
+  }
+  ZSTD_freeDDict(ddict_);
+}
+
+const ZSTD_CDict*
+ZstdDictionaryRegistry::Dictionary::getCDict(int level) const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto it = cdicts_.find(level);
+  if (it == cdicts_.end()) {
+    ZSTD_CDict* cdict = ZSTD_createCDict(bytes_.data(), bytes_.size(), level);
+    if (cdict == nullptr) {
+      return nullptr;
+    }
+    it = cdicts_.emplace(level, cdict).first;
+  }
+  return it->second;
+}
+
+int ZstdDictionaryRegistry::registerDictionary(std::string bytes) {
+  auto dict = std::make_shared<const Dictionary>(std::move(bytes));
+  if (dict->id() == 0 || dict->getDDict() == nullptr) {
+    // Raw content dictionaries aren't named in frame headers, so readers
+    // couldn't tell which dictionary a batch was compressed with.
+    ld_error("Not registering zstd dictionary: %s",
+             dict->id() == 0 ? "it has no ID" : "zstd failed to load it");
+    err = E::INVALID_PARAM;
+    return -1;
+  }
+  ld_info("Registering zstd dictionary %u", dict->id());
+  const uint32_t id = dict->id();
+  dictionaries().wlock()->insert_or_assign(id, std::move(dict));
+  return 0;
+}
+
+std::shared_ptr<const ZstdDictionaryRegistry::Dictionary>
+ZstdDictionaryRegistry::get(uint32_t id) {
+  auto map = dictionaries().rlock();
+  auto it = map->find(id);
+  return it == map->end() ? nullptr : it->second;
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,81 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <zstd.h>
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Process-wide set of zstd dictionaries that BufferedWriter batches can
+ *       be compressed with.  Small batches of similar payloads (e.g. JSON
+ *       documents) compress much better with a dictionary trained on
+ *       samples of them (`zstd --train`).
+ *
+ *       zstd writes the ID of the dictionary into the frame header, so
+ *       readers find the dictionary a batch needs without any change to the
+ *       BufferedWriter format.  Both writers and readers must register the
+ *       dictionary; decoding a batch compressed with an unknown dictionary
+ *       fails.  Distributing dictionaries is up to the application.
+ *
+ *       Thread-safe.
+ */
+
+class ZstdDictionaryRegistry {
+ public:
+  class Dictionary {
+   public:
+    explicit Dictionary(std::string bytes);
+    ~Dictionary();
+
+    Dictionary(const Dictionary&) = delete;
+    Dictionary& operator=(const Dictionary&) = delete;
+
+    // ID stored in the dictionary, 0 if it's a raw content dictionary.
+    uint32_t id() const {
+      return id_;
+    }
+
+    // Digested dictionary for compressing at `level', created on first use.
+    const ZSTD_CDict* getCDict(int level) const;
+
+    // Digested dictionary for decompressing, nullptr if zstd failed to
+    // load the dictionary.
+    const ZSTD_DDict* getDDict() const {
+      return ddict_;
+    }
+
+   private:
+    const std::string bytes_;
+    uint32_t id_;
+    ZSTD_DDict* ddict_;
+
+    mutable std::mutex mutex_;
+    mutable std::map<int, ZSTD_CDict*> cdicts_;
+  };
+
+  /**
+   * Registers a dictionary in zstd dictionary format.  Replaces a dictionary
+   * previously registered with the same ID.
+   *
+   * @return  0 on success, -1 if the dictionary doesn't parse or has no ID, in
+   *          which case err is set to E::INVALID_PARAM
+   */
+  static int registerDictionary(std::string bytes);
+
+  /**
+   * @return  the dictionary with the given ID, or nullptr if there isn't one
+   */
+  static std::shared_ptr<const Dictionary> get(uint32_t id);
+};
+
+}} // namespace facebook::logdevice
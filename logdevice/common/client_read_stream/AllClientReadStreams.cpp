@@ -13,8 +13,11 @@
 #include "logdevice/common/RawDataRecord.h"
 #include "logdevice/common/Sender.h"
 #include "logdevice/common/Worker.h"
+#include "logdevice/common/protocol/Compatibility.h"
+#include "logdevice/common/protocol/READ_CONTROL_Message.h"
 #include "logdevice/common/protocol/STOP_Message.h"
 #include "logdevice/common/request_util.h"
+#include "logdevice/common/stats/Stats.h"
 #include "logdevice/include/Err.h"
 
 namespace facebook { namespace logdevice {
@@ -158,6 +161,116 @@ void AllClientReadStreams::sampleAllReadStreamsDebugInfo() const {
   }
 }
 
+void AllClientReadStreams::queueWindowUpdate(ShardID shard,
+                                             const WINDOW_Header& header) {
+  PendingReadControl& pending = pending_read_control_[shard.node()];
+  PendingReadControl::Key key(header.read_stream_id.val_, header.shard);
+  if (pending.stops.count(key)) {
+    // The stream is going away on this shard.
+    return;
+  }
+  pending.windows[key] = header;
+  if (!flush_read_control_timer_.isAssigned()) {
+    flush_read_control_timer_.assign([this] { flushReadControl(); });
+  }
+  flush_read_control_timer_.activate(std::chrono::microseconds(0));
+}
+
+void AllClientReadStreams::queueStop(ShardID shard, const STOP_Header& header) {
+  PendingReadControl& pending = pending_read_control_[shard.node()];
+  PendingReadControl::Key key(header.read_stream_id.val_, header.shard);
+  pending.windows.erase(key);
+  pending.stops[key] = header;
+  if (!flush_read_control_timer_.isAssigned()) {
+    flush_read_control_timer_.assign([this] { flushReadControl(); });
+  }
+  flush_read_control_timer_.activate(std::chrono::microseconds(0));
+}
+
+void AllClientReadStreams::cancelReadControl(ShardID shard,
+                                             read_stream_id_t rsid) {
+  auto it = pending_read_control_.find(shard.node());
+  if (it == pending_read_control_.end()) {
+    return;
+  }
+  PendingReadControl::Key key(rsid.val_, shard.shard());
+  it->second.windows.erase(key);
+  it->second.stops.erase(key);
+}
+
+void AllClientReadStreams::flushReadControl() {
+  Worker* w = Worker::onThisThread();
+  ld_check(w);
+  auto pending_by_node = std::move(pending_read_control_);
+  pending_read_control_.clear();
+
+  auto on_window_failed = [this](node_index_t nid, const WINDOW_Header& h) {
+    ClientReadStream* stream = getStream(h.read_stream_id);
+    if (stream) {
+      stream->onWindowSendFailed(ShardID(nid, h.shard), h.sliding_window.high);
+    }
+  };
+
+  for (auto& kv : pending_by_node) {
+    const node_index_t nid = kv.first;
+    PendingReadControl& pending = kv.second;
+    const size_t num_entries = pending.windows.size() + pending.stops.size();
+    if (num_entries == 0) {
+      continue;
+    }
+
+    auto proto = w->sender().getSocketProtocolVersion(nid);
+    if (num_entries == 1 || !proto.hasValue() ||
+        proto.value() < Compatibility::BATCHED_READ_CONTROL) {
+      // Nothing to batch, or the node doesn't understand READ_CONTROL.
+      for (const auto& window : pending.windows) {
+        auto msg = std::make_unique<WINDOW_Message>(window.second);
+        if (w->sender().sendMessage(std::move(msg), NodeID(nid, 0)) != 0) {
+          on_window_failed(nid, window.second);
+        }
+      }
+      if (w->isAcceptingWork()) {
+        for (const auto& stop : pending.stops) {
+          auto msg = std::make_unique<STOP_Message>(stop.second);
+          w->sender().sendMessage(std::move(msg), NodeID(nid, 0));
+        }
+      }
+      continue;
+    }
+
+    auto window_it = pending.windows.begin();
+    auto stop_it = pending.stops.begin();
+    while (window_it != pending.windows.end() ||
+           stop_it != pending.stops.end()) {
+      std::vector<WINDOW_Header> windows;
+      std::vector<STOP_Header> stops;
+      for (; window_it != pending.windows.end() &&
+           windows.size() < READ_CONTROL_Message::MAX_ENTRIES;
+           ++window_it) {
+        windows.push_back(window_it->second);
+      }
+      for (; stop_it != pending.stops.end() &&
+           stops.size() < READ_CONTROL_Message::MAX_ENTRIES;
+           ++stop_it) {
+        stops.push_back(stop_it->second);
+      }
+      WORKER_STAT_INCR(read_control_messages_sent);
+      WORKER_STAT_ADD(read_control_windows_batched, windows.size());
+      WORKER_STAT_ADD(read_control_stops_batched, stops.size());
+
+      // Keep a copy of the windows to retry them if the send fails.
+      std::vector<WINDOW_Header> sent_windows = windows;
+      auto msg = std::make_unique<READ_CONTROL_Message>(std::move(windows),
+                                                        std::move(stops));
+      if (w->sender().sendMessage(std::move(msg), NodeID(nid, 0)) != 0) {
+        for (const WINDOW_Header& window : sent_windows) {
+          on_window_failed(nid, window);
+        }
+      }
+    }
+  }
+}
+
 std::string
 AllClientReadStreams::getAllReadStreamsDebugInfo(bool pretty,
                                                  bool json,
@@ -7,14 +7,19 @@
  */
 #pragma once
 
+#include <map>
 #include <memory>
 #include <unordered_map>
+#include <utility>
 
 #include "logdevice/common/AdminCommandTable-fwd.h"
 #include "logdevice/common/ShardAuthoritativeStatusMap.h"
+#include "logdevice/common/Timer.h"
 #include "logdevice/common/client_read_stream/ClientReadStream.h"
 #include "logdevice/common/protocol/GAP_Message.h"
 #include "logdevice/common/protocol/STARTED_Message.h"
+#include "logdevice/common/protocol/STOP_Message.h"
+#include "logdevice/common/protocol/WINDOW_Message.h"
 #include "logdevice/common/types_internal.h"
 #include "logdevice/include/types.h"
 
@@ -120,7 +125,43 @@ class AllClientReadStreams : public ShardAuthoritativeStatusSubscriber {
 
   void sampleAllReadStreamsDebugInfo() const;
 
+  /**
+   * Queues a WINDOW update for a read stream on `shard'. Updates queued for
+   * the same node during one iteration of the event loop are sent together
+   * in a READ_CONTROL message, and only the latest window of each read
+   * stream is kept. Used when Settings::read_control_batching is on.
+   */
+  void queueWindowUpdate(ShardID shard, const WINDOW_Header& header);
+
+  /**
+   * Queues a STOP for a read stream on `shard', batched like
+   * queueWindowUpdate(). Drops the stream's pending WINDOW update.
+   */
+  void queueStop(ShardID shard, const STOP_Header& header);
+
+  /**
+   * Drops the WINDOW and STOP updates queued for a read stream on `shard'.
+   * Called before sending a START, which supersedes them.
+   */
+  void cancelReadControl(ShardID shard, read_stream_id_t rsid);
+
  private:
+  // Sends the updates queued by queueWindowUpdate() and queueStop().
+  void flushReadControl();
+
+  // Updates queued for one node, keyed by read stream id and shard index.
+  struct PendingReadControl {
+    using Key = std::pair<read_stream_id_t::raw_type, shard_index_t>;
+    std::map<Key, WINDOW_Header> windows;
+    std::map<Key, STOP_Header> stops;
+  };
+
+  std::unordered_map<node_index_t, PendingReadControl> pending_read_control_;
+
+  // Zero-delay timer that flushes pending_read_control_ once the current
+  // iteration of the event loop is done.
+  Timer flush_read_control_timer_;
+
   // Actual container
   std::unordered_map<read_stream_id_t,
                      std::unique_ptr<ClientReadStream>,
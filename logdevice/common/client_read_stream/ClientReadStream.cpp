@@ -43,6 +43,7 @@
 #include "logdevice/common/client_read_stream/ClientReadStreamConnectionHealth.h"
 #include "logdevice/common/client_read_stream/ClientReadStreamScd.h"
 #include "logdevice/common/client_read_stream/ClientReadStreamTracer.h"
+#include "logdevice/common/chrono_util.h"
 #include "logdevice/common/configuration/Configuration.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/common/event_log/EventLogRebuildingSet.h"
@@ -51,6 +52,7 @@
 #include "logdevice/common/protocol/STARTED_Message.h"
 #include "logdevice/common/protocol/STOP_Message.h"
 #include "logdevice/common/settings/Settings.h"
+#include "logdevice/common/stats/ClientHistograms.h"
 #include "logdevice/common/stats/PerMonitoringTagHistograms.h"
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/include/Record.h"
@@ -132,6 +134,7 @@ ClientReadStream::ClientReadStream(
       gap_end_outside_window_(LSN_INVALID),
       trim_point_(LSN_INVALID),
       monitoring_tags_(monitoring_tags.begin(), monitoring_tags.end()),
+      monitoring_tier_(tier),
       reader_(reader),
       coordinated_proto_(Compatibility::MAX_PROTOCOL_SUPPORTED),
       window_update_pending_(false),
@@ -617,6 +620,11 @@ void ClientReadStream::sendStart(ShardID shard_id, SenderState& state) {
   if (ignore_released_status_) {
     header.flags |= START_Header::IGNORE_RELEASED_STATUS;
   }
+  if (monitoring_tier_ == MonitoringTier::HIGH_PRI) {
+    header.flags |= START_Header::MONITORING_TIER_HIGH;
+  } else if (monitoring_tier_ == MonitoringTier::LOW_PRI) {
+    header.flags |= START_Header::MONITORING_TIER_LOW;
+  }
 
   const auto& filtered_out =
       scd_->isActive() ? scd_->getFilteredOut() : small_shardset_t{};
@@ -3371,6 +3379,9 @@ int ClientReadStream::deliverRecord(
   }
 
   bool bridge_record = (record->flags_ & RECORD_Header::BRIDGE);
+  // The record is moved into the callback, remember what is needed after.
+  const bool e2e_traced = (record->flags_ & RECORD_Header::E2E_TRACED);
+  const std::chrono::milliseconds timestamp = record->attrs.timestamp;
   bool success;
   if (reader_) {
     bool notify =
@@ -3383,6 +3394,16 @@ int ClientReadStream::deliverRecord(
         lsn == until_lsn_;
     int rv = reader_->onDataRecord(getID(), std::move(record), notify);
     success = (rv == 0);
+  } else if (deps_->hasRecordBatchCallback() && lsn < until_lsn_) {
+    RecordBatchEntry entry(std::unique_ptr<DataRecord>(std::move(record)));
+    success = appendToRecordBatch(entry);
+    if (!success) {
+      record = std::unique_ptr<DataRecordOwnsPayload>(
+          static_cast<DataRecordOwnsPayload*>(entry.record.release()));
+    }
+  } else if (!flushRecordBatch()) {
+    // Everything batched so far must be consumed before the last record.
+    success = false;
   } else {
     inside_callback_ = true;
     // This is tricky.  Upcasting from DataRecordOwnsPayload ...
@@ -3426,6 +3447,9 @@ int ClientReadStream::deliverRecord(
       // lsn appropriately in that case.
       last_delivered_lsn_ = lsn;
     }
+    if (e2e_traced) {
+      recordE2ELatency(timestamp);
+    }
     if (MetaDataLog::isMetaDataLog(log_id_)) {
       if (wait_for_all_copies_) {
         WORKER_STAT_INCR(metadata_log_records_delivered_wait_for_all);
@@ -3499,6 +3523,11 @@ int ClientReadStream::deliverGap(GapType type, lsn_t lo, lsn_t hi) {
         lo <= next_lsn_to_slide_window_ && next_lsn_to_slide_window_ <= hi;
     int rv = reader_->onGapRecord(getID(), gap, notify);
     success = (rv == 0);
+  } else if (deps_->hasRecordBatchCallback() && hi < until_lsn_) {
+    RecordBatchEntry entry(gap);
+    success = appendToRecordBatch(entry);
+  } else if (!flushRecordBatch()) {
+    success = false;
   } else {
     inside_callback_ = true;
     success = deps_->gapCallback(gap);
@@ -3545,6 +3574,54 @@ int ClientReadStream::deliverGap(GapType type, lsn_t lo, lsn_t hi) {
   return success ? 0 : -1;
 }
 
+bool ClientReadStream::appendToRecordBatch(RecordBatchEntry& entry) {
+  if (record_batch_rejected_) {
+    return false;
+  }
+  // Bound the batch by the size of the buffer, so that a slow application
+  // doesn't make us hold more records than the window allows.
+  if (record_batch_.size() >= buffer_->capacity() && !flushRecordBatch()) {
+    return false;
+  }
+  record_batch_.push_back(std::move(entry));
+
+  if (!record_batch_timer_) {
+    record_batch_timer_ = deps_->createTimer([this] {
+      if (!flushRecordBatch()) {
+        activateRedeliveryTimer();
+      }
+    });
+  }
+  if (!record_batch_timer_->isActive()) {
+    record_batch_timer_->activate(std::chrono::microseconds(0));
+  }
+  return true;
+}
+
+bool ClientReadStream::flushRecordBatch() {
+  if (!record_batch_.empty()) {
+    inside_callback_ = true;
+    size_t consumed = deps_->recordBatchCallback(record_batch_);
+    inside_callback_ = false;
+    ld_check(consumed <= record_batch_.size());
+    consumed = std::min(consumed, record_batch_.size());
+    record_batch_.erase(
+        record_batch_.begin(), record_batch_.begin() + consumed);
+    if (!MetaDataLog::isMetaDataLog(log_id_)) {
+      if (record_batch_.empty()) {
+        WORKER_STAT_INCR(record_batches_delivered);
+      } else {
+        WORKER_STAT_INCR(record_batches_redelivery_attempted);
+      }
+    }
+  }
+  record_batch_rejected_ = !record_batch_.empty();
+  if (record_batch_timer_ && !record_batch_rejected_) {
+    record_batch_timer_->cancel();
+  }
+  return !record_batch_rejected_;
+}
+
 void ClientReadStream::deliverAccessGapAndDispose() {
   ld_check(permission_denied_);
 
@@ -3618,6 +3695,11 @@ void ClientReadStream::cancelRedeliveryTimer() {
 }
 
 void ClientReadStream::redeliver() {
+  if (!flushRecordBatch()) {
+    activateRedeliveryTimer();
+    return;
+  }
+
   if (log_removed_from_config_) {
     deliverNoConfigGapAndDispose();
   } else if (permission_denied_) {
@@ -3900,6 +3982,22 @@ void ClientReadStream::sendWindowMessage(SenderState& state) {
   }
 }
 
+void ClientReadStream::onWindowSendFailed(ShardID shard, lsn_t window_high) {
+  auto it = storage_set_states_.find(shard);
+  if (it == storage_set_states_.end()) {
+    return;
+  }
+  SenderState& state = it->second;
+  if (state.getConnectionState() != ConnectionState::READING ||
+      state.getWindowHigh() != window_high) {
+    // A newer window or a START already superseded the failed update.
+    return;
+  }
+  // The update was assumed to be sent when it was queued.
+  state.setWindowHigh(LSN_INVALID);
+  state.activateRetryWindowTimer();
+}
+
 bool ClientReadStream::canSkipPartiallyTrimmedSection() const {
   return !do_not_skip_partially_trimmed_sections_ &&
       trim_point_ != LSN_INVALID && trim_point_ >= next_lsn_to_deliver_;
@@ -3938,6 +4036,25 @@ int ClientReadStream::deliverFastForwardGap(GapType type, lsn_t next_lsn) {
   return 0;
 }
 
+void ClientReadStream::recordE2ELatency(std::chrono::milliseconds timestamp) {
+  // The timestamp was assigned by the sequencer when the append arrived. Clock
+  // skew between it and this host can make the difference negative.
+  const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::system_clock::now().time_since_epoch());
+  const int64_t latency_us =
+      std::max<int64_t>(0, to_usec(now - timestamp).count());
+
+  // The reader is considered caught up if everything known to be released
+  // fits in its window, i.e. it isn't held back by its own buffer.
+  if (last_released_ <= window_high_) {
+    LOG_GROUP_E2E_LATENCY_ADD(
+        Worker::stats(), log_group_name_, tailing, latency_us);
+  } else {
+    LOG_GROUP_E2E_LATENCY_ADD(
+        Worker::stats(), log_group_name_, backfill, latency_us);
+  }
+}
+
 void ClientReadStream::updateLastReleased(lsn_t last_released_lsn) {
   if (last_released_lsn > last_released_) {
     last_released_ = last_released_lsn;
@@ -4123,6 +4240,14 @@ void ClientReadStream::handleStartPROTONOSUPPORT(ShardID shard_id) {
 void ClientReadStream::scheduleRewind(RewindReason reason,
                                       std::string reason_str) {
   ld_check(!reason_str.empty());
+  const double speculative_percentile =
+      deps_->getSettings()
+          .reader_slow_shards_detection_settings.speculative_percentile;
+  // The rewind keeps the buffered records only if every rewind merged into it
+  // does.
+  rewind_keeps_records_ =
+      (rewind_keeps_records_ || !rewind_scheduler_->isScheduled()) &&
+      reason == RewindReason::OUTLIERS_CHANGED && speculative_percentile > 0;
   rewind_scheduler_->schedule(std::move(reason_str));
 
   if (!rewind_imminent_) {
@@ -4208,8 +4333,24 @@ void ClientReadStream::rewind(std::string reason) {
   ld_check(scd_->getGapShardsFilteredOut() == 0);
   ld_check(scd_->getUnderReplicatedShardsNotBlacklisted() == 0);
 
-  // clear the entire read stream buffer
-  buffer_->clear();
+  if (rewind_keeps_records_) {
+    dropBufferedGaps();
+    WORKER_STAT_INCR(rewind_kept_records);
+  } else {
+    // clear the entire read stream buffer
+    size_t records_discarded = 0;
+    size_t bytes_discarded = 0;
+    const lsn_t max_lsn = buffer_->maxLSNToAccept();
+    buffer_->forEachUpto(max_lsn, [&](lsn_t, RecordState& rstate) {
+      if (rstate.record) {
+        ++records_discarded;
+        bytes_discarded += rstate.record->payload.size();
+      }
+    });
+    buffer_->clear();
+    WORKER_STAT_ADD(rewind_records_discarded, records_discarded);
+    WORKER_STAT_ADD(rewind_bytes_discarded, bytes_discarded);
+  }
 
   gap_end_outside_window_ = LSN_INVALID;
 
@@ -4309,6 +4450,7 @@ void ClientReadStream::rewind(std::string reason) {
   }
   rewind_scheduler_->cancel();
   rewind_imminent_ = false;
+  rewind_keeps_records_ = false;
 
   if (scd_ && scd_->isActive()) {
     for (const auto& shard_id : scd_->getShardsSlow()) {
@@ -4372,6 +4514,28 @@ void ClientReadStream::rewind(std::string reason) {
   scd_->onWindowSlid(server_window_.high, filter_version_);
 }
 
+void ClientReadStream::dropBufferedGaps() {
+  size_t records_discarded = 0;
+  size_t bytes_discarded = 0;
+  const lsn_t max_lsn = buffer_->maxLSNToAccept();
+  buffer_->forEachUpto(max_lsn, [&](lsn_t, RecordState& rstate) {
+    // Senders were unlinked by resetGapParametersForSender().
+    ld_check(rstate.list.empty());
+    rstate.gap = false;
+    rstate.filtered_out = false;
+    if (rstate.record && rstate.record_corrupted) {
+      // Let the new streams give another shard a chance to send a copy that
+      // is not corrupted.
+      ++records_discarded;
+      bytes_discarded += rstate.record->payload.size();
+      rstate.record.reset();
+      rstate.record_corrupted = false;
+    }
+  });
+  WORKER_STAT_ADD(rewind_records_discarded, records_discarded);
+  WORKER_STAT_ADD(rewind_bytes_discarded, bytes_discarded);
+}
+
 int ClientReadStream::setGapStateFilteredOut(lsn_t start_lsn,
                                              lsn_t end_lsn,
                                              SenderState& state) {
@@ -4492,6 +4656,7 @@ bool ClientReadStreamDependencies::getMetaDataForEpoch(
                                      &source,
                                      require_consistent_from_cache)) {
       // Cache hit
+      WORKER_STAT_INCR(epoch_metadata_cache_hits);
 
       // metadata must from a cached source
       ld_check(MetaDataLogReader::isCachedSource(source));
@@ -4532,6 +4697,7 @@ bool ClientReadStreamDependencies::getMetaDataForEpoch(
     }
 
     // cache miss, continue to read the metadata log
+    WORKER_STAT_INCR(epoch_metadata_cache_misses);
   }
 
   if (nodeset_finder_) {
@@ -4678,6 +4844,10 @@ int ClientReadStreamDependencies::sendStartMessage(
   header.log_id = log_id_;
   header.read_stream_id = read_stream_id_;
 
+  // Updates still waiting to be batched are about the previous incarnation
+  // of the stream on this shard and must not reach it after the START.
+  w->clientReadStreams().cancelReadControl(shard, read_stream_id_);
+
   auto msg = std::make_unique<START_Message>(
       header, filtered_out, attrs, client_session_id_);
   return w->sender().sendMessage(std::move(msg), shard.asNodeID(), onclose);
@@ -4697,6 +4867,11 @@ int ClientReadStreamDependencies::sendStopMessage(ShardID shard) {
     return 0;
   }
 
+  if (getSettings().read_control_batching) {
+    w->clientReadStreams().queueStop(shard, header);
+    return 0;
+  }
+
   auto msg = std::make_unique<STOP_Message>(header);
   return w->sender().sendMessage(std::move(msg), shard.asNodeID());
 }
@@ -4716,6 +4891,11 @@ int ClientReadStreamDependencies::sendWindowMessage(ShardID shard,
 
   ld_check(window_low <= window_high);
 
+  if (getSettings().read_control_batching) {
+    w->clientReadStreams().queueWindowUpdate(shard, header);
+    return 0;
+  }
+
   auto msg = std::make_unique<WINDOW_Message>(header);
   return w->sender().sendMessage(std::move(msg), shard.asNodeID());
 }
@@ -12,6 +12,7 @@
 #include <memory>
 #include <queue>
 #include <set>
+#include <vector>
 
 #include <boost/noncopyable.hpp>
 #include <folly/Optional.h>
@@ -34,6 +35,7 @@
 #include "logdevice/common/protocol/WINDOW_Message.h"
 #include "logdevice/common/settings/Settings.h"
 #include "logdevice/common/types_internal.h"
+#include "logdevice/include/AsyncReader.h"
 #include "logdevice/include/Err.h"
 #include "logdevice/include/types.h"
 
@@ -118,6 +120,8 @@ class ClientReadStreamDependencies {
   using done_cb_t = std::function<void(logid_t)>;
   using record_copy_cb_t = std::function<void(ShardID, const RawDataRecord*)>;
   using health_cb_t = std::function<void(bool)>;
+  using record_batch_cb_t =
+      std::function<size_t(std::vector<RecordBatchEntry>&)>;
 
   ClientReadStreamDependencies(read_stream_id_t rsid,
                                logid_t log_id,
@@ -227,6 +231,30 @@ class ClientReadStreamDependencies {
     return record_callback_ ? record_callback_(record) : true;
   }
 
+  /**
+   * Call the application-supplied callback to deliver a batch of records and
+   * gaps.
+   *
+   * @return the number of entries at the front of `batch` that were consumed
+   */
+  virtual size_t recordBatchCallback(std::vector<RecordBatchEntry>& batch) {
+    return record_batch_callback_ ? record_batch_callback_(batch)
+                                  : batch.size();
+  }
+
+  /**
+   * If true, ClientReadStream accumulates records and gaps and delivers them
+   * through recordBatchCallback() instead of calling recordCallback() and
+   * gapCallback() for each of them.
+   */
+  virtual bool hasRecordBatchCallback() const {
+    return record_batch_callback_ != nullptr;
+  }
+
+  void setRecordBatchCallback(record_batch_cb_t cb) {
+    record_batch_callback_ = std::move(cb);
+  }
+
   /**
    * Call the application-supplied callback to report a gap.
    */
@@ -356,6 +384,7 @@ class ClientReadStreamDependencies {
   std::string reader_name_;
   record_cb_t record_callback_;
   gap_cb_t gap_callback_;
+  record_batch_cb_t record_batch_callback_;
   done_cb_t done_callback_;
   // If our owner requested health updates, this is the callback.
   health_cb_t health_callback_;
@@ -491,6 +520,13 @@ class ClientReadStream : boost::noncopyable {
    */
   void onStartSent(ShardID shard, Status status);
 
+  /**
+   * Called when a WINDOW update that sendWindowMessage() handed to
+   * AllClientReadStreams for batching could not be sent. If the shard's
+   * window is still the one that failed, retry later.
+   */
+  void onWindowSendFailed(ShardID shard, lsn_t window_high);
+
   /**
    * Called by a worker thread when a RECORD message is received from a
    * storage shard.
@@ -937,6 +973,23 @@ class ClientReadStream : boost::noncopyable {
    */
   int deliverGap(GapType type, lsn_t lo, lsn_t hi);
 
+  /**
+   * If the application reads in batches, moves `entry` to the end of
+   * record_batch_ and makes sure the batch is flushed on the next iteration
+   * of the event loop. On failure `entry` is left intact.
+   *
+   * @return  true on success, false if the batch is full or was rejected
+   *          by the application
+   */
+  bool appendToRecordBatch(RecordBatchEntry& entry);
+
+  /**
+   * Delivers record_batch_ to the application.
+   *
+   * @return  true if the batch is empty afterwards
+   */
+  bool flushRecordBatch();
+
   /**
    * Attempts to deliver access Gap record to the client. When successful, this
    * ReadStream is destroyed. If it is not, all out going data records are
@@ -1260,6 +1313,11 @@ class ClientReadStream : boost::noncopyable {
   // updated last_released_ based on what we got from storage shards.
   void updateLastReleased(lsn_t last_released_lsn);
 
+  // Called after delivering a record with the RECORD_Header::E2E_TRACED flag.
+  // Records its latency since `timestamp` in the e2e_latency.* histograms of
+  // the log group, see Settings::e2e_latency_sampling_rate.
+  void recordE2ELatency(std::chrono::milliseconds timestamp);
+
   // Activate metadata fetch retry timer
   void activateMetaDataRetryTimer();
 
@@ -1292,9 +1350,18 @@ class ClientReadStream : boost::noncopyable {
    * The `reason` string may be a concatenation of multiple (human-readable)
    * reasons if we're rewinding for multiple reasons at once, e.g. a few
    * shards were added to down list in quick succession.
+   * If rewind_keeps_records_ is set, the records already buffered are kept
+   * and only gap information is dropped.
    */
   void rewind(std::string reason);
 
+  /**
+   * Called by rewind() instead of clearing buffer_ when the rewind keeps the
+   * records already received. Drops the gaps and filtered out markers, which
+   * are only valid for the current filter version, and the corrupted records.
+   */
+  void dropBufferedGaps();
+
   /**
    * Called to set gap state to be FILTERED_OUT from start_lsn to end_lsn.
    * This method first verifies start_lsn, end_lsn, state. If we should
@@ -1504,6 +1571,22 @@ class ClientReadStream : boost::noncopyable {
   // Timer used to retry delivery when it fails
   std::unique_ptr<BackoffTimer> redelivery_timer_;
 
+  // Records and gaps accumulated for the application's batch callback, see
+  // ClientReadStreamDependencies::hasRecordBatchCallback(). Entries have
+  // already been accounted as delivered: next_lsn_to_deliver_ is past them.
+  // Only ever holds entries below until_lsn_, the last record or gap of the
+  // stream is delivered synchronously so that the stream is done only once
+  // the application has consumed everything.
+  std::vector<RecordBatchEntry> record_batch_;
+
+  // Set if the application did not consume all of record_batch_ the last time
+  // it was flushed. Nothing is added to the batch until it is consumed.
+  bool record_batch_rejected_{false};
+
+  // Zero-delay timer flushing record_batch_ once the event loop is done with
+  // the messages that filled it.
+  std::unique_ptr<Timer> record_batch_timer_;
+
   // If the client starts at an lsn with epoch 0, we issue a bridge gap to
   // epoch 1. If the client rejects that gap, we will reattempt to deliver
   std::unique_ptr<BackoffTimer> reattempt_start_timer_;
@@ -1531,6 +1614,9 @@ class ClientReadStream : boost::noncopyable {
 
   folly::small_vector<std::string> monitoring_tags_;
 
+  // SLO class of the reader, sent to storage shards in START.
+  const MonitoringTier monitoring_tier_;
+
   // Reader object to deliver to when not using callbacks.  Null if using
   // callbacks
   ReaderBridge* reader_;
@@ -1615,6 +1701,14 @@ class ClientReadStream : boost::noncopyable {
   // is used to avoid updating rewind-scheduling stats in this situation.
   bool rewind_imminent_ = false;
 
+  // True if all the rewinds scheduled since the last one was done change the
+  // outlier list while speculative slow shards detection is enabled, see
+  // Settings::reader_slow_shards_detection_settings.speculative_percentile.
+  // Records are valid whatever the
+  // filter version, so such rewinds keep the records already buffered rather
+  // than reading the whole window again.
+  bool rewind_keeps_records_ = false;
+
   // When the clientReadStream receives a STARTED_Message with an E::ACCESS
   // error from any storage shard in the current readset, permission_denied_ is
   // set to true indicating that all outgoing data/gap records (if any) will
@@ -9,6 +9,7 @@
 
 #include <folly/Memory.h>
 
+#include "logdevice/common/client_read_stream/ClientReadStreamChunkedBuffer.h"
 #include "logdevice/common/client_read_stream/ClientReadStreamCircularBuffer.h"
 #include "logdevice/common/client_read_stream/ClientReadStreamOrderedMapBuffer.h"
 
@@ -21,6 +22,8 @@ namespace facebook { namespace logdevice {
 enum class ClientReadStreamBufferType : uint8_t {
   CIRCULAR = 0,
   ORDERED_MAP,
+  // Sparse buffer with a bitmap per chunk of LSNs, for wide windows
+  CHUNKED,
 };
 
 class ClientReadStreamBufferFactory {
@@ -35,6 +38,9 @@ class ClientReadStreamBufferFactory {
       case ClientReadStreamBufferType::ORDERED_MAP:
         return std::make_unique<ClientReadStreamOrderedMapBuffer>(
             capacity, buffer_head);
+      case ClientReadStreamBufferType::CHUNKED:
+        return std::make_unique<ClientReadStreamChunkedBuffer>(
+            capacity, buffer_head);
     }
 
     ld_check(false);
@@ -0,0 +1,251 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/client_read_stream/ClientReadStreamChunkedBuffer.h"
+
+#include <array>
+
+#include <folly/Portability.h>
+
+#include "logdevice/common/DataRecordOwnsPayload.h"
+#include "logdevice/common/Timer.h"
+#include "logdevice/common/client_read_stream/ClientReadStream.h"
+#include "logdevice/common/debug.h"
+
+namespace facebook { namespace logdevice {
+
+using RecordState = ClientReadStreamRecordState;
+
+struct ClientReadStreamChunkedBuffer::Chunk {
+  explicit Chunk(uint64_t chunk_id) : id(chunk_id) {}
+
+  const uint64_t id;
+  // Bit i is set if slots[i] holds a descriptor.
+  uint64_t present{0};
+  std::array<RecordState, CHUNK_SIZE> slots;
+};
+
+namespace {
+
+bool isMarker(const RecordState& state) {
+  return state.record || state.gap || state.filtered_out;
+}
+
+// Bits of slots [lo, hi] of a chunk.
+uint64_t slotMask(size_t lo, size_t hi) {
+  ld_check(lo <= hi);
+  ld_check(hi < ClientReadStreamChunkedBuffer::CHUNK_SIZE);
+  uint64_t upto_hi = hi == 63 ? ~0ul : (1ul << (hi + 1)) - 1;
+  return upto_hi & (~0ul << lo);
+}
+
+} // namespace
+
+ClientReadStreamChunkedBuffer::ClientReadStreamChunkedBuffer(size_t capacity,
+                                                             lsn_t buffer_head)
+    : capacity_(capacity),
+      buffer_head_(buffer_head),
+      chunks_(capacity / CHUNK_SIZE + 2) {}
+
+ClientReadStreamChunkedBuffer::~ClientReadStreamChunkedBuffer() = default;
+
+RecordState* ClientReadStreamChunkedBuffer::createOrGet(lsn_t lsn) {
+  // lsn must be with in the range of
+  // [buffer_head, buffer_head + capacity() - 1]
+  if (!LSNInBuffer(lsn)) {
+    return nullptr;
+  }
+  std::unique_ptr<Chunk>& chunk = chunkFor(lsn);
+  if (!chunk) {
+    chunk = std::make_unique<Chunk>(chunkID(lsn));
+    ++num_chunks_;
+  }
+  // A chunk is released once it's empty, and chunks below the buffer head
+  // are empty, so the slot can't be taken by another chunk.
+  ld_check(chunk->id == chunkID(lsn));
+  chunk->present |= 1ul << slotIndex(lsn);
+  return &chunk->slots[slotIndex(lsn)];
+}
+
+RecordState* ClientReadStreamChunkedBuffer::find(lsn_t lsn) {
+  if (!LSNInBuffer(lsn)) {
+    return nullptr;
+  }
+  Chunk* chunk = chunkFor(lsn).get();
+  if (!chunk || !(chunk->present & (1ul << slotIndex(lsn)))) {
+    return nullptr;
+  }
+  ld_check(chunk->id == chunkID(lsn));
+  return &chunk->slots[slotIndex(lsn)];
+}
+
+bool ClientReadStreamChunkedBuffer::nextPresent(lsn_t from,
+                                                lsn_t to,
+                                                bool reverse,
+                                                lsn_t* out) const {
+  ld_check(out);
+  ld_assert(LSNInBuffer(from));
+  ld_assert(LSNInBuffer(to));
+  const lsn_t lo = reverse ? to : from;
+  const lsn_t hi = reverse ? from : to;
+  ld_check(lo <= hi);
+
+  const uint64_t first = chunkID(lo);
+  const uint64_t last = chunkID(hi);
+  for (uint64_t i = 0; i <= last - first; ++i) {
+    const uint64_t id = reverse ? last - i : first + i;
+    const Chunk* chunk = chunks_[id % chunks_.size()].get();
+    if (!chunk) {
+      continue;
+    }
+    ld_check(chunk->id == id);
+    uint64_t bits = chunk->present &
+        slotMask(id == first ? slotIndex(lo) : 0,
+                 id == last ? slotIndex(hi) : CHUNK_SIZE - 1);
+    if (bits) {
+      // Bit scans find the first descriptor without looking at the others.
+      const size_t slot = reverse ? CHUNK_SIZE - 1 - __builtin_clzl(bits)
+                                  : __builtin_ctzl(bits);
+      *out = id * CHUNK_SIZE + slot;
+      return true;
+    }
+  }
+  return false;
+}
+
+std::pair<ClientReadStreamRecordState*, lsn_t>
+ClientReadStreamChunkedBuffer::findFirstMarker() {
+  lsn_t lsn = buffer_head_;
+  const lsn_t max_lsn = maxLSNToAccept();
+  while (lsn <= max_lsn && nextPresent(lsn, max_lsn, false, &lsn)) {
+    RecordState& state = chunkFor(lsn)->slots[slotIndex(lsn)];
+    if (isMarker(state)) {
+      return std::make_pair(&state, lsn);
+    }
+    // for slot that is not a record/gap marker, its list must be
+    // empty
+    ld_check(state.list.empty());
+    if (lsn == max_lsn) {
+      break;
+    }
+    ++lsn;
+  }
+
+  // no gap/record marker in buffer
+  return std::make_pair(nullptr, LSN_INVALID);
+}
+
+ClientReadStreamRecordState* ClientReadStreamChunkedBuffer::front() {
+  RecordState* state = find(buffer_head_);
+  if (state && isMarker(*state)) {
+    return state;
+  }
+
+  // the descriptor is a placeholder, return nullptr
+  ld_check(!state || state->list.empty());
+  return nullptr;
+}
+
+void ClientReadStreamChunkedBuffer::release(lsn_t lsn) {
+  std::unique_ptr<Chunk>& chunk = chunkFor(lsn);
+  ld_check(chunk);
+  ld_check(chunk->present & (1ul << slotIndex(lsn)));
+  chunk->slots[slotIndex(lsn)].reset();
+  chunk->present &= ~(1ul << slotIndex(lsn));
+  if (chunk->present == 0) {
+    chunk.reset();
+    --num_chunks_;
+  }
+}
+
+void ClientReadStreamChunkedBuffer::popFront() {
+  RecordState* state = find(buffer_head_);
+  if (!state) {
+    return;
+  }
+  // record and list, if exist, must be already consumed
+  ld_check(!state->record && !state->filtered_out);
+  ld_check(state->list.empty());
+  release(buffer_head_);
+}
+
+void ClientReadStreamChunkedBuffer::advanceBufferHead(size_t offset) {
+  if (offset == 0) {
+    return;
+  }
+  // caller needs to ensure that there must not be any marker
+  // in the buffer slots that get advanced. assert this below.
+  const lsn_t max_lsn = maxLSNToAccept();
+  if (folly::kIsDebug && buffer_head_ <= max_lsn) {
+    const lsn_t last = offset - 1 >= max_lsn - buffer_head_
+        ? max_lsn
+        : buffer_head_ + offset - 1;
+    lsn_t lsn;
+    ld_check(!nextPresent(buffer_head_, last, false, &lsn));
+  }
+  buffer_head_ += offset;
+}
+
+void ClientReadStreamChunkedBuffer::clear() {
+  for (auto& chunk : chunks_) {
+    chunk.reset();
+  }
+  num_chunks_ = 0;
+}
+
+void ClientReadStreamChunkedBuffer::forEach(
+    lsn_t from,
+    lsn_t to,
+    std::function<bool(lsn_t, ClientReadStreamRecordState& record)> cb) {
+  const bool reverse = from > to;
+  // Only LSNs in the buffer can have descriptors.
+  const lsn_t max_lsn = maxLSNToAccept();
+  if (reverse) {
+    from = std::min(from, max_lsn);
+    to = std::max(to, buffer_head_);
+    if (from < to) {
+      return;
+    }
+  } else {
+    from = std::max(from, buffer_head_);
+    to = std::min(to, max_lsn);
+    if (from > to) {
+      return;
+    }
+  }
+
+  lsn_t lsn;
+  bool found = nextPresent(from, to, reverse, &lsn);
+  while (found) {
+    RecordState& state = chunkFor(lsn)->slots[slotIndex(lsn)];
+    const bool done = !cb(lsn, state);
+    if (!isMarker(state)) {
+      ld_check(state.list.empty());
+      release(lsn);
+    }
+    if (done || lsn == to) {
+      break;
+    }
+    found = nextPresent(reverse ? lsn - 1 : lsn + 1, to, reverse, &lsn);
+  }
+}
+
+void ClientReadStreamChunkedBuffer::forEachUpto(
+    lsn_t to,
+    std::function<void(lsn_t, RecordState& record)> callback) {
+  if (to < buffer_head_) {
+    return;
+  }
+  forEach(buffer_head_,
+          to,
+          [cb = std::move(callback)](lsn_t lsn, RecordState& rstate) {
+            cb(lsn, rstate);
+            return true;
+          });
+}
+
+}} // namespace facebook::logdevice
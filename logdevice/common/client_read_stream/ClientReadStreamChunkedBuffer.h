@@ -0,0 +1,133 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "logdevice/common/client_read_stream/ClientReadStreamBuffer.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file ClientReadStreamChunkedBuffer is an implementation of
+ *       ClientReadStreamBuffer for wide windows. LSNs are grouped into
+ *       aligned chunks of 64 slots. A chunk is only allocated while some of
+ *       its slots hold a RecordState descriptor, and a 64-bit bitmap per
+ *       chunk tells which ones do. Lookups are O(1) like in
+ *       ClientReadStreamCircularBuffer, while scans (findFirstMarker(),
+ *       forEach()) skip unallocated chunks and use bit scans within a chunk,
+ *       touching only the descriptors that exist, like
+ *       ClientReadStreamOrderedMapBuffer. The index costs one pointer per 64
+ *       LSNs of capacity.
+ *
+ *       Like ClientReadStreamOrderedMapBuffer, only slots that were created
+ *       with createOrGet() are visited by forEach(), and slots left empty by
+ *       the callback are released.
+ */
+
+class ClientReadStreamChunkedBuffer : public ClientReadStreamBuffer {
+ public:
+  static constexpr size_t CHUNK_SIZE = 64;
+
+  ClientReadStreamChunkedBuffer(size_t capacity, lsn_t buffer_head);
+
+  ~ClientReadStreamChunkedBuffer() override;
+
+  // see ClientReadStreamBuffer::createOrGet()
+  // complexity O(1)
+  ClientReadStreamRecordState* createOrGet(lsn_t lsn) override;
+
+  // see ClientReadStreamBuffer::find()
+  // complexity O(1)
+  ClientReadStreamRecordState* find(lsn_t lsn) override;
+
+  // see ClientReadStreamBuffer::findFirstMarker()
+  // complexity O(n / CHUNK_SIZE) in which n is the capacity of the buffer
+  std::pair<ClientReadStreamRecordState*, lsn_t> findFirstMarker() override;
+
+  // see ClientReadStreamBuffer::front()
+  // complexity O(1)
+  ClientReadStreamRecordState* front() override;
+
+  // see ClientReadStreamBuffer::popFront()
+  // complexity O(1)
+  void popFront() override;
+
+  // see ClientReadStreamBuffer::advanceBufferHead()
+  // complexity O(1)
+  void advanceBufferHead(size_t offset = 1) override;
+
+  // see ClientReadStreamBuffer::capacity()
+  size_t capacity() const override {
+    return capacity_;
+  }
+
+  // see ClientReadStreamBuffer::clear()
+  // complexity O(n / CHUNK_SIZE)
+  void clear() override;
+
+  // see ClientReadStreamBuffer::forEachUpto()
+  // complexity O((to - buffer_head_) / CHUNK_SIZE + number of descriptors)
+  void forEachUpto(
+      lsn_t to,
+      std::function<void(lsn_t, ClientReadStreamRecordState& record)> cb)
+      override;
+
+  // see ClientReadStreamBuffer::forEach()
+  // complexity O(abs(to - from) / CHUNK_SIZE + number of descriptors)
+  void forEach(lsn_t from,
+               lsn_t to,
+               std::function<bool(lsn_t, ClientReadStreamRecordState& record)>
+                   cb) override;
+
+  // see ClientReadStreamBuffer::getBufferHead()
+  lsn_t getBufferHead() const override {
+    return buffer_head_;
+  }
+
+  // Number of chunks currently allocated.
+  size_t numChunks() const {
+    return num_chunks_;
+  }
+
+ private:
+  struct Chunk;
+
+  static uint64_t chunkID(lsn_t lsn) {
+    return lsn / CHUNK_SIZE;
+  }
+
+  static size_t slotIndex(lsn_t lsn) {
+    return lsn % CHUNK_SIZE;
+  }
+
+  // Chunks are indexed by their ID modulo the size of chunks_. The buffer
+  // spans fewer chunk IDs than that, so IDs never collide.
+  std::unique_ptr<Chunk>& chunkFor(lsn_t lsn) {
+    return chunks_[chunkID(lsn) % chunks_.size()];
+  }
+
+  // Finds the smallest (or, if reverse, largest) LSN of a descriptor in
+  // [from, to] (or [to, from]). Both ends must be in the buffer.
+  //
+  // @return  true if one was found and written to *out
+  bool nextPresent(lsn_t from, lsn_t to, bool reverse, lsn_t* out) const;
+
+  // Releases the descriptor for `lsn', and its chunk if it was the last one.
+  void release(lsn_t lsn);
+
+  size_t capacity_;
+  // tracks the buffer head
+  lsn_t buffer_head_;
+  std::vector<std::unique_ptr<Chunk>> chunks_;
+  size_t num_chunks_{0};
+};
+
+}} // namespace facebook::logdevice
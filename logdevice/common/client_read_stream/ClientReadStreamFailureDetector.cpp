@@ -21,6 +21,13 @@ namespace facebook { namespace logdevice {
 static constexpr int kNumBuckets = 10;
 static constexpr float kFuzzRatio = 0.1;
 static constexpr int kNumDeviationsFromCenter = 5;
+// Number of window completion latencies kept per shard for the speculative
+// detection, and how many are needed across shards before it is attempted.
+static constexpr size_t kNumRecentLatencies = 32;
+static constexpr size_t kMinSpeculativeSamples = 16;
+// Floor of the speculative threshold, so that windows completed instantly
+// from the servers' caches don't make every other shard an outlier.
+static constexpr std::chrono::milliseconds kMinSpeculativeThreshold{10};
 
 #define SCOPE_EXIT_CHECK_CONSISTENCY() \
   SCOPE_EXIT {                         \
@@ -244,6 +251,16 @@ void ClientReadStreamFailureDetector::onShardCompletedWindow(
   // Compute how long it took and add a latency sample.
   auto delta = TS(now - window.time_slid).toMilliseconds();
   it_m->second.moving_avg->addValue(now, delta.count());
+  if (settings_.speculative_percentile > 0) {
+    ShardState& state = it_m->second;
+    if (state.recent_latencies.size() < kNumRecentLatencies) {
+      state.recent_latencies.push_back(delta.count());
+    } else {
+      state.recent_latencies[state.next_recent_latency] = delta.count();
+    }
+    state.next_recent_latency =
+        (state.next_recent_latency + 1) % kNumRecentLatencies;
+  }
 
   // If this shard is not an outlier, decrease its `outlier_duration`
   // value as this is positive signal that the shard is able to send without
@@ -278,6 +295,16 @@ void ClientReadStreamFailureDetector::checkForShardsBlockingWindow(TS now) {
   // Run the detection.
   OutlierChangedReason reason;
   Samples result;
+  // How long until the detection should be tried again.
+  std::chrono::milliseconds retry_in = std::chrono::milliseconds::max();
+  if (settings_.speculative_percentile > 0 &&
+      findShardsBlockingWindowSpeculatively(now, result, retry_in, reason)) {
+    ld_check(!result.empty());
+    changeOutliers(now, std::move(result), folly::join(". ", reason));
+    required_margin_.negativeFeedback();
+    return;
+  }
+
   std::chrono::milliseconds threshold = std::chrono::milliseconds::max();
   const bool found_outliers = findShardsBlockingWindow(
       now, kNumDeviationsFromCenter, n_pending, result, threshold, reason);
@@ -288,20 +315,99 @@ void ClientReadStreamFailureDetector::checkForShardsBlockingWindow(TS now) {
     changeOutliers(now, std::move(result), folly::join(". ", reason));
     // make sure we are less agressive for the next window.
     required_margin_.negativeFeedback();
+    return;
   } else if (threshold != std::chrono::milliseconds::max()) {
     auto window_duration = TS(now - window.time_slid).toMilliseconds();
     // `delta` measures how long we should wait until we are able to consider
     // all shards that have not yet completed the window as outliers.
     auto delta = threshold - window_duration;
-    if (delta.count() <= 0) {
-      // We can be here if the shards that have not completed the window yet are
-      // already outliers. There is no point in calling this function again
-      // until the window is slid.
-      return;
+    // If delta is not positive, the shards that have not completed the window
+    // yet are already outliers. There is no point in calling this function
+    // again until the window is slid.
+    if (delta.count() > 0) {
+      retry_in = std::min(retry_in, delta);
     }
+  }
+
+  if (retry_in != std::chrono::milliseconds::max()) {
     // schedule a timer to call this function again.
-    activateTimer(delta + std::chrono::milliseconds{10});
+    activateTimer(retry_in + std::chrono::milliseconds{10});
+  }
+}
+
+bool ClientReadStreamFailureDetector::findShardsBlockingWindowSpeculatively(
+    TS now,
+    Samples& samples_out,
+    std::chrono::milliseconds& retry_in,
+    OutlierChangedReason& reason) {
+  WindowState& window = getLastWindow();
+
+  // Pool the recent latencies of the candidates that completed the window.
+  std::vector<size_t> latencies;
+  for (const auto& p : shards_) {
+    if (p.second.is_candidate_ && p.second.next_lsn > window.hi &&
+        !current_outliers_.count(p.first)) {
+      latencies.insert(latencies.end(),
+                       p.second.recent_latencies.begin(),
+                       p.second.recent_latencies.end());
+    }
+  }
+  if (latencies.size() < kMinSpeculativeSamples) {
+    return false;
   }
+
+  const size_t rank = std::min(
+      latencies.size() - 1,
+      static_cast<size_t>(latencies.size() *
+                          settings_.speculative_percentile / 100));
+  std::nth_element(
+      latencies.begin(), latencies.begin() + rank, latencies.end());
+  // Grows above 1 as rewinds make the required margin increase.
+  const double backoff = settings_.required_margin > 0
+      ? required_margin_.getCurrentValue() / settings_.required_margin
+      : 1.0;
+  const std::chrono::milliseconds threshold =
+      std::max(kMinSpeculativeThreshold,
+               std::chrono::milliseconds(static_cast<long>(
+                   std::ceil(latencies[rank] * std::max(backoff, 1.0)))));
+
+  const std::chrono::milliseconds delta =
+      TS(now - window.time_slid).toMilliseconds();
+  if (delta < threshold) {
+    retry_in = threshold - delta;
+    return false;
+  }
+
+  Samples added;
+  for (const auto& p : shards_) {
+    if (p.second.is_candidate_ && p.second.next_lsn <= window.hi &&
+        !current_outliers_.count(p.first)) {
+      added.emplace_back(p.first, delta.count());
+    }
+  }
+  if (added.empty()) {
+    return false;
+  }
+  WORKER_STAT_ADD(scd_shard_slow_added_speculatively, added.size());
+
+  reason.push_back(
+      folly::format("samples {} did not complete the window up to {} after "
+                    "{}ms, which is above the p{} latency {}ms of the other "
+                    "shards",
+                    toString(added),
+                    lsn_to_string(window.hi),
+                    delta.count(),
+                    settings_.speculative_percentile,
+                    threshold.count())
+          .str());
+
+  samples_out = std::move(added);
+  for (ShardID s : current_outliers_) {
+    auto it = shards_.find(s);
+    ld_check(it != shards_.end());
+    samples_out.emplace_back(s, it->second.last_outlier_val);
+  }
+  return true;
 }
 
 ClientReadStreamFailureDetector::Samples
@@ -431,6 +537,8 @@ void ClientReadStreamFailureDetector::removeExpiredOutliers(TS now) {
       // for it must be dropped as they should not be considered "normal" for
       // further runs of the outlier detection algorithm.
       it_shard->second.moving_avg->clear();
+      it_shard->second.recent_latencies.clear();
+      it_shard->second.next_recent_latency = 0;
     } else {
       // This shard remains an outlier.
       new_outliers.push_back(Sample{s, it_shard->second.last_outlier_val});
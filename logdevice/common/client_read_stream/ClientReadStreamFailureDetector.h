@@ -10,6 +10,7 @@
 #include <chrono>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <folly/Optional.h>
 #include <folly/stats/BucketedTimeSeries.h>
@@ -80,6 +81,18 @@
  * The adaptive nature of the required margin helps protect ourselves against
  * degenerate cases where many shards alternate being slow.
  *
+ * == Speculative detection ==
+ *
+ * The outlier detection algorithm needs the pending shards to be several
+ * times slower than the others before it is confident they are outliers, and
+ * the reader is stalled meanwhile. If
+ * `ClientReadStreamFailureDetectorSettings::speculative_percentile` is set,
+ * we also keep the last few window completion latencies of each shard and
+ * declare the pending shards outliers as soon as they have been slower than
+ * that percentile of the latencies of the shards that completed the window.
+ * The threshold grows with the required margin, so that shards alternating
+ * being slow make the speculative detection less aggressive too.
+ *
  * == Reinstating outliers ==
  *
  * When a shard is in the outlier list, we keep sending WINDOW messages to it
@@ -239,6 +252,10 @@ class ClientReadStreamFailureDetector {
     using TimeSeries = folly::BucketedTimeSeries<size_t, TS::clock>;
     // Average latency of completing windows for the shard over a time period.
     std::unique_ptr<TimeSeries> moving_avg;
+    // Last window completion latencies, in ms, used by the speculative
+    // detection. A rotating buffer of up to kNumRecentLatencies samples.
+    std::vector<size_t> recent_latencies;
+    size_t next_recent_latency = 0;
     // Next lsn that this storage shard will send.
     lsn_t next_lsn = LSN_OLDEST;
     // If the shard is an outlier, timestamp of when it should be reinstated.
@@ -321,6 +338,19 @@ class ClientReadStreamFailureDetector {
                                 std::chrono::milliseconds& threshold,
                                 OutlierChangedReason& reason);
 
+  // Speculative version of findShardsBlockingWindow(). Declares outliers the
+  // shards that have not completed the last window if they have been pending
+  // for longer than the `speculative_percentile` percentile of the recent
+  // latencies of the other shards.
+  // Returns true if some outliers were added, and samples gets populated with
+  // the new outlier list. Otherwise, populates `retry_in` with how long until
+  // the pending shards would be outliers, if there is enough data for that.
+  bool findShardsBlockingWindowSpeculatively(
+      TS now,
+      Samples& samples,
+      std::chrono::milliseconds& retry_in,
+      OutlierChangedReason& reason);
+
   // Find the outlier that is due to expire first and schedule the
   // `expiry_timer_` to eventually call `removeExpiredOutliers`.
   void scheduleExpiryTimer(TS now);
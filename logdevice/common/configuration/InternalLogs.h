@@ -109,6 +109,10 @@ class InternalLogs {
     return boost::icl::elements_rend(logs_index_);
   }
 
+  const logsconfig::LogMap& getLogMap() const {
+    return logs_index_;
+  }
+
   /**
    * @return number of internal logs that have been activated.
    */
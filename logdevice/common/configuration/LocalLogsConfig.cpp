@@ -71,38 +71,45 @@ LocalLogsConfig::getLogGroupPath(logid_t id) const {
 
 const LocalLogsConfig::LogGroupInDirectory* FOLLY_NULLABLE
 LocalLogsConfig::getLogGroupInDirectoryByIDRaw(logid_t id) const {
-  const logsconfig::LogGroupInDirectory* res =
-      config_tree_->getLogGroupByID(id);
-
-  if (res) {
-    return res;
-  }
-
-  res = internal_logs_.getLogGroupByID(id);
-  if (res) {
-    return res;
-  }
-
-  return nullptr;
+  // covers both the tree and the internal logs
+  return getFlatLogIndex().find(id.val());
 }
 
 bool LocalLogsConfig::logExists(logid_t id) const {
   // Use the masked logid to find the data log in the config because we don't
   // store the metadata logs in the tree
   const logid_t data_log_id = MetaDataLog::dataLogID(id);
-  return config_tree_->logExists(data_log_id) ||
-      internal_logs_.logExists(data_log_id);
+  return getFlatLogIndex().find(data_log_id.val()) != nullptr;
 }
 
 LogGroupNodePtr LocalLogsConfig::getLogGroupByIDShared(logid_t id) const {
   // LogGroupNode can be both a normal or an internal log
   const logsconfig::LogGroupInDirectory* res =
-      config_tree_->getLogGroupByID(id);
-  if (!res) {
-    res = internal_logs_.getLogGroupByID(id);
+      getFlatLogIndex().find(id.val());
+  return res ? res->log_group : nullptr;
+}
+
+const logsconfig::FlatLogIndex& LocalLogsConfig::getFlatLogIndex() const {
+  const logsconfig::FlatLogIndex* index =
+      flat_index_.load(std::memory_order_acquire);
+  if (index) {
+    return *index;
   }
+  std::lock_guard<std::mutex> lock(flat_index_mutex_);
+  if (!flat_index_owner_) {
+    ld_check(config_tree_ != nullptr);
+    flat_index_owner_ = std::make_unique<logsconfig::FlatLogIndex>(
+        std::vector<const LogMap*>{
+            &config_tree_->getLogMap(), &internal_logs_.getLogMap()});
+    flat_index_.store(flat_index_owner_.get(), std::memory_order_release);
+  }
+  return *flat_index_owner_;
+}
 
-  return res ? res->log_group : nullptr;
+void LocalLogsConfig::invalidateFlatLogIndex() {
+  std::lock_guard<std::mutex> lock(flat_index_mutex_);
+  flat_index_.store(nullptr, std::memory_order_release);
+  flat_index_owner_.reset();
 }
 
 void LocalLogsConfig::getLogGroupByIDAsync(
@@ -176,6 +183,7 @@ LogGroupNodePtr LocalLogsConfig::insert(DirectoryNode* parent,
   ld_check(config_tree_ != nullptr);
 
   was_modified_in_place_.store(true);
+  invalidateFlatLogIndex();
 
   // we need to figure out if the name has the _delimiter_ in it or not, if it
   // has, then we need to create the intermediate namespaces first or attach
@@ -203,6 +211,7 @@ LocalLogsConfig::insertNamespace(DirectoryNode* parent,
                                  const LogAttributes& log_attrs) {
   ld_check(config_tree_ != nullptr);
   was_modified_in_place_.store(true);
+  invalidateFlatLogIndex();
   DirectoryNode* actual_parent = parent;
   // if no parent was passed we fallback to the root of the tree
   if (actual_parent == nullptr) {
@@ -215,6 +224,7 @@ bool LocalLogsConfig::replaceLogGroup(const std::string& path,
                                       const LogGroupNode& new_log_group) {
   ld_check(config_tree_ != nullptr);
   was_modified_in_place_.store(true);
+  invalidateFlatLogIndex();
   std::string failure_reason;
   bool ret = config_tree_->replaceLogGroup(path, new_log_group, failure_reason);
   if (!ret) {
@@ -228,6 +238,7 @@ bool LocalLogsConfig::replaceLogGroup(const std::string& path,
 bool LocalLogsConfig::erase(const std::string& path) {
   ld_check(config_tree_ != nullptr);
   was_modified_in_place_.store(true);
+  invalidateFlatLogIndex();
   std::string failure_reason;
   int rv = config_tree_->deleteLogGroup(path, failure_reason);
   if (rv != 0) {
@@ -245,6 +256,7 @@ logsconfig::LogGroupNodePtr LocalLogsConfig::insert(logid_t::raw_type logid,
                                                     LogAttributes attrs) {
   ld_check(config_tree_ != nullptr);
   was_modified_in_place_.store(true);
+  invalidateFlatLogIndex();
   std::string failure_reason;
   auto ret =
       config_tree_->addLogGroup(name,
@@ -266,6 +278,7 @@ logsconfig::LogGroupNodePtr LocalLogsConfig::insert(
     LogAttributes attrs) {
   ld_check(config_tree_ != nullptr);
   was_modified_in_place_.store(true);
+  invalidateFlatLogIndex();
   std::string failure_reason;
   auto added_group = config_tree_->addLogGroup(
       name,
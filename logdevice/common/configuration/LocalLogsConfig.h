@@ -7,7 +7,9 @@
  */
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <utility>
 
 #include <boost/container/flat_map.hpp>
@@ -16,6 +18,7 @@
 #include "logdevice/common/configuration/LocalLogsConfigIterator.h"
 #include "logdevice/common/configuration/LogsConfig.h"
 #include "logdevice/common/configuration/ServerConfig.h"
+#include "logdevice/common/configuration/logs/FlatLogIndex.h"
 #include "logdevice/common/configuration/logs/LogsConfigTree.h"
 #include "logdevice/common/types_internal.h"
 #include "logdevice/common/util.h"
@@ -108,6 +111,7 @@ class LocalLogsConfig : public LogsConfig {
     internal_logs_ = internal_logs;
     // invalidate the narrowest replication cache
     narrowest_replication_cache_.clear();
+    invalidateFlatLogIndex();
   }
 
   const InternalLogs& getInternalLogs() const {
@@ -180,6 +184,12 @@ class LocalLogsConfig : public LogsConfig {
     config_tree_ = std::move(tree);
     // invalidate the narrowest replication cache
     narrowest_replication_cache_.clear();
+    invalidateFlatLogIndex();
+  }
+  // Builds the index used for lookups by log id ahead of the first lookup,
+  // which would otherwise pay for it. Called before publishing a new config.
+  void prepareLookupIndex() const {
+    getFlatLogIndex();
   }
   const LogsConfigTree& getLogsConfigTree() const {
     return *config_tree_;
@@ -194,6 +204,7 @@ class LocalLogsConfig : public LogsConfig {
     config_tree_ = nullptr;
     // invalidate the narrowest replication cache
     narrowest_replication_cache_.clear();
+    invalidateFlatLogIndex();
   }
 
   const std::string& getDelimiter() const {
@@ -268,6 +279,16 @@ class LocalLogsConfig : public LogsConfig {
   // Note that bumping version on modificaion would be unsafe.
   std::atomic<bool> was_modified_in_place_{false};
 
+  // Lookups by log id go through a flat copy of the log id indexes of
+  // config_tree_ and internal_logs_, built by the first lookup. Modifications
+  // drop it; like every other modification they must not race with readers.
+  mutable std::atomic<const logsconfig::FlatLogIndex*> flat_index_{nullptr};
+  mutable std::unique_ptr<logsconfig::FlatLogIndex> flat_index_owner_;
+  mutable std::mutex flat_index_mutex_;
+
+  const logsconfig::FlatLogIndex& getFlatLogIndex() const;
+  void invalidateFlatLogIndex();
+
   void getAllLogRangesfromDirectory(DirectoryNode* dir,
                                     NamespaceRangeLookupMap& res) const;
 };
@@ -115,6 +115,7 @@ static const std::set<std::string> logs_config_recognized_keys = {
     SEQUENCER_BATCHING_PASSTHRU_THRESHOLD,
     SHADOW,
     TAIL_OPTIMIZED,
+    STORAGE_COMPRESSION,
 };
 
 static const std::set<std::string> logs_config_non_defaultable_keys = {"id",
@@ -553,6 +554,7 @@ parseAttributes(const folly::dynamic& attrs,
         Attribute<ssize_t>(),     /* sequencerBatchingPassthruThreshold */
         Attribute<LogAttributes::Shadow>(),     /* shadow */
         false,                                  /* tail optimized */
+        Attribute<Compression>(),               /* storageCompression */
         Attribute<LogAttributes::ExtrasMap>()); /* extras */
   }
 
@@ -871,6 +873,32 @@ parseAttributes(const folly::dynamic& attrs,
     return folly::none;
   }
 
+  Attribute<Compression> storageCompression;
+  std::string storageCompression_string;
+  if (getStringFromMap(
+          attrs, STORAGE_COMPRESSION, storageCompression_string)) {
+    Compression compression;
+    auto rv =
+        parseCompression(storageCompression_string.c_str(), &compression);
+    if (rv == -1) {
+      ld_error("Invalid value for \"%s\" attribute of log range '%s'. "
+               "Valid compression codec expected, got '%s'",
+               STORAGE_COMPRESSION,
+               interval_string.c_str(),
+               storageCompression_string.c_str());
+      err = E::INVALID_CONFIG;
+      return folly::none;
+    }
+    storageCompression = compression;
+  } else if (err != E::NOTFOUND) {
+    ld_error("Invalid value for \"%s\" attribute of log range '%s'. "
+             "String expected.",
+             STORAGE_COMPRESSION,
+             interval_string.c_str());
+    err = E::INVALID_CONFIG;
+    return folly::none;
+  }
+
   // Adding fields that logdevice doesn't recognize
   Attribute<LogAttributes::ExtrasMap> extras;
   LogAttributes::ExtrasMap extras_map;
@@ -920,6 +948,7 @@ parseAttributes(const folly::dynamic& attrs,
                        sequencerBatchingPassthruThreshold,
                        shadow,
                        tailOptimized,
+                       storageCompression,
                        extras};
   return folly::Optional<LogAttributes>(std::move(output));
 }
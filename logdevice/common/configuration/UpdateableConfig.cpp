@@ -25,20 +25,23 @@ UpdateableConfig::UpdateableConfig(
           std::make_shared<UpdateableNodesConfiguration>()),
       updateable_ncm_nodes_configuration_(
           std::make_shared<UpdateableNodesConfiguration>()) {
+  nodes_configuration_subscription_ =
+      updateable_nodes_configuration_->subscribeToUpdates(
+          std::bind(&UpdateableConfig::onNodesConfigurationUpdated, this));
   if (updateable_logs_config_) {
     logs_config_subscription_ = updateable_logs_config_->subscribeToUpdates(
-        std::bind(&UpdateableConfig::notify, this));
+        std::bind(&UpdateableConfig::onConfigUpdated, this));
   }
   if (updateable_server_config_) {
     // TODO: use the NodesConfiguration in ServerConfig or obtain the initial
     // version elsewhere.
     server_config_subscription_ = updateable_server_config_->subscribeToUpdates(
-        std::bind(&UpdateableConfig::notify, this));
+        std::bind(&UpdateableConfig::onConfigUpdated, this));
   }
   if (updateable_zookeeper_config) {
     zookeeper_config_subscription_ =
         updateable_zookeeper_config_->subscribeToUpdates(
-            std::bind(&UpdateableConfig::notify, this));
+            std::bind(&UpdateableConfig::onConfigUpdated, this));
   }
 }
 
@@ -64,17 +67,31 @@ UpdateableConfig::UpdateableConfig(std::shared_ptr<Configuration> init_config)
       updateable_zookeeper_config_->update(zookeeper_config);
     }
   }
+  nodes_configuration_subscription_ =
+      updateable_nodes_configuration_->subscribeToUpdates(
+          std::bind(&UpdateableConfig::onNodesConfigurationUpdated, this));
   logs_config_subscription_ = updateable_logs_config_->subscribeToUpdates(
-      std::bind(&UpdateableConfig::notify, this));
+      std::bind(&UpdateableConfig::onConfigUpdated, this));
   server_config_subscription_ = updateable_server_config_->subscribeToUpdates(
-      std::bind(&UpdateableConfig::notify, this));
+      std::bind(&UpdateableConfig::onConfigUpdated, this));
   zookeeper_config_subscription_ =
       updateable_zookeeper_config_->subscribeToUpdates(
-          std::bind(&UpdateableConfig::notify, this));
+          std::bind(&UpdateableConfig::onConfigUpdated, this));
 }
 
 UpdateableConfig::~UpdateableConfig() = default;
 
+void UpdateableConfig::onConfigUpdated() {
+  version_.fetch_add(1, std::memory_order_acq_rel);
+  notify();
+}
+
+void UpdateableConfig::onNodesConfigurationUpdated() {
+  // subscribers of this object aren't notified of NodesConfiguration updates,
+  // they subscribe to updateableNodesConfiguration() directly
+  version_.fetch_add(1, std::memory_order_acq_rel);
+}
+
 std::shared_ptr<configuration::LocalLogsConfig>
 UpdateableConfig::getLocalLogsConfig() const {
   return checked_downcast<std::shared_ptr<configuration::LocalLogsConfig>>(
@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <utility>
 
@@ -110,7 +111,19 @@ class UpdateableConfig : public configuration::UpdateableConfigBase {
 
   static std::shared_ptr<UpdateableConfig> createEmpty();
 
+  /**
+   * Incremented whenever one of the underlying configs is updated, once the
+   * update is visible through the getters. Lets callers keep the
+   * Configuration returned by get() and rebuild it only when this changes.
+   */
+  uint64_t getVersion() const {
+    return version_.load(std::memory_order_acquire);
+  }
+
  private:
+  void onConfigUpdated();
+  void onNodesConfigurationUpdated();
+
   std::shared_ptr<UpdateableServerConfig> updateable_server_config_;
   std::shared_ptr<UpdateableLogsConfig> updateable_logs_config_;
   std::shared_ptr<UpdateableZookeeperConfig> updateable_zookeeper_config_;
@@ -133,5 +146,8 @@ class UpdateableConfig : public configuration::UpdateableConfigBase {
   ConfigSubscriptionHandle server_config_subscription_;
   ConfigSubscriptionHandle logs_config_subscription_;
   ConfigSubscriptionHandle zookeeper_config_subscription_;
+  ConfigSubscriptionHandle nodes_configuration_subscription_;
+
+  std::atomic<uint64_t> version_{0};
 };
 }} // namespace facebook::logdevice
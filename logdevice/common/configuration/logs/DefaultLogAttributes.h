@@ -74,6 +74,8 @@ class DefaultLogAttributes : public LogAttributes {
             Attribute<Shadow>(),
             /* tailOptimized */
             false,
+            /* storageCompression */
+            Attribute<Compression>(),
             /* extras */
             Attribute<ExtrasMap>()) {}
 };
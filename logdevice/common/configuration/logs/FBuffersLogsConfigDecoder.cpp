@@ -251,6 +251,7 @@ FBuffersLogsConfigCodec::fbuffers_deserialize<logsconfig::LogAttributes,
                    SEQUENCER_BATCHING_PASSTHRU_THRESHOLD,
                    ssize_t);
   DESERIALIZE_ATTR(tailOptimized, TAIL_OPTIMIZED, bool);
+  DESERIALIZE_ATTR(storageCompression, STORAGE_COMPRESSION, Compression);
 
 #undef DESERIALIZE_ATTR_OPT
 #undef DESERIALIZE_ATTR
@@ -401,6 +402,7 @@ FBuffersLogsConfigCodec::fbuffers_deserialize<logsconfig::LogAttributes,
                        std::move(sequencerBatchingPassthruThreshold),
                        std::move(shadow),
                        std::move(tailOptimized),
+                       std::move(storageCompression),
                        std::move(extras)};
 }
 
@@ -160,6 +160,8 @@ FBuffersLogsConfigCodec::fbuffers_serialize(
                       Long,
                       attributes.sequencerBatchingPassthruThreshold);
   SERIALIZE_ATTRIBUTE(TAIL_OPTIMIZED, Bool, attributes.tailOptimized);
+  SERIALIZE_ATTRIBUTE(
+      STORAGE_COMPRESSION, UInt8, attributes.storageCompression);
 
   // permissions
   std::vector<flatbuffers::Offset<fbuffers::Permission>> perms;
@@ -0,0 +1,82 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/configuration/logs/FlatLogIndex.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace facebook { namespace logdevice { namespace logsconfig {
+
+namespace {
+
+std::atomic<uint64_t> next_generation{1};
+
+struct LastLookup {
+  uint64_t generation = 0;
+  logid_t::raw_type lo = 0;
+  logid_t::raw_type hi = 0;
+  const LogGroupInDirectory* group = nullptr;
+};
+
+thread_local LastLookup last_lookup;
+
+} // namespace
+
+FlatLogIndex::FlatLogIndex(std::vector<const LogMap*> maps)
+    : generation_(next_generation.fetch_add(1)) {
+  size_t total = 0;
+  for (const LogMap* map : maps) {
+    total += map->iterative_size();
+  }
+  entries_.reserve(total);
+  for (const LogMap* map : maps) {
+    for (const auto& segment : *map) {
+      // Intervals are right-open.
+      ld_check(segment.first.upper() > segment.first.lower());
+      entries_.push_back(Entry{segment.first.lower(),
+                               segment.first.upper() - 1,
+                               &segment.second});
+    }
+  }
+  std::sort(
+      entries_.begin(), entries_.end(), [](const Entry& a, const Entry& b) {
+        return a.lo < b.lo;
+      });
+  if (folly::kIsDebug) {
+    for (size_t i = 1; i < entries_.size(); ++i) {
+      ld_check(entries_[i - 1].hi < entries_[i].lo);
+    }
+  }
+}
+
+const LogGroupInDirectory* FlatLogIndex::find(logid_t::raw_type logid) const {
+  LastLookup& last = last_lookup;
+  if (last.generation == generation_ && logid >= last.lo && logid <= last.hi) {
+    return last.group;
+  }
+
+  // First entry starting after `logid'; the one before it is the only one
+  // that can contain it.
+  auto it = std::upper_bound(
+      entries_.begin(),
+      entries_.end(),
+      logid,
+      [](logid_t::raw_type id, const Entry& e) { return id < e.lo; });
+  if (it == entries_.begin() || logid > std::prev(it)->hi) {
+    err = E::NOTFOUND;
+    return nullptr;
+  }
+  --it;
+  last.generation = generation_;
+  last.lo = it->lo;
+  last.hi = it->hi;
+  last.group = it->group;
+  return it->group;
+}
+
+}}} // namespace facebook::logdevice::logsconfig
@@ -0,0 +1,54 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <vector>
+
+#include "logdevice/common/configuration/logs/LogsConfigTree.h"
+
+namespace facebook { namespace logdevice { namespace logsconfig {
+
+/**
+ * @file A read-only copy of one or more LogMaps (log id range -> log group)
+ *       laid out as a sorted array, for lookups by log id on hot paths
+ *       (appends, read streams, copyset selection). A binary search over a
+ *       contiguous array touches far fewer cache lines than a lookup in the
+ *       node-based interval_map. Each thread also remembers the range it
+ *       found last, since consecutive lookups tend to be for the same log.
+ *
+ *       The entries point into the LogMaps the index was built from, which
+ *       must outlive it and must not change while it exists.
+ */
+
+class FlatLogIndex {
+ public:
+  // The ranges of the maps are expected not to overlap.
+  explicit FlatLogIndex(std::vector<const LogMap*> maps);
+
+  // @return  the log group whose range contains `logid', or nullptr with err
+  //          set to E::NOTFOUND
+  const LogGroupInDirectory* find(logid_t::raw_type logid) const;
+
+  size_t size() const {
+    return entries_.size();
+  }
+
+ private:
+  struct Entry {
+    logid_t::raw_type lo;
+    logid_t::raw_type hi; // inclusive
+    const LogGroupInDirectory* group;
+  };
+
+  std::vector<Entry> entries_;
+  // Distinguishes this index from any other in the per-thread cache of the
+  // last lookup, even if another one was allocated at the same address.
+  const uint64_t generation_;
+};
+
+}}} // namespace facebook::logdevice::logsconfig
@@ -322,6 +322,7 @@ void LogsConfigManager::updateLogsConfig(
       std::chrono::duration_cast<std::chrono::microseconds>(
           std::chrono::steady_clock::now() - clone_start_time)
           .count();
+  new_logs_config->prepareLookupIndex();
   updateable_config_->updateableLogsConfig()->update(new_logs_config);
   // updating the internal state
   is_fully_loaded_ = true;
@@ -197,6 +197,11 @@ folly::dynamic LogGroupInDirectory::toFollyDynamic(bool metadata_logs) const {
 
   json_log[TAIL_OPTIMIZED] = attrs.tailOptimized().value();
 
+  if (attrs.storageCompression().hasValue()) {
+    json_log[STORAGE_COMPRESSION] =
+        compressionToString(attrs.storageCompression().value());
+  }
+
   if (attrs.shadow().hasValue() &&
       !attrs.shadow().value().destination().empty()) {
     json_log[SHADOW] = folly::dynamic::object();
@@ -356,7 +361,7 @@ DirectoryNode::DirectoryNode(const DirectoryNode& other, DirectoryNode* parent)
     : LogsConfigTreeNode(other.name_, other.attrs()),
       parent_(parent),
       delimiter_(other.delimiter_) {
-  // a simple copy of the log groups map
+  // share the log groups map, it gets copied on the first modification
   logs_ = other.logs_;
   for (const auto& item : other.children_) {
     children_[item.first] = std::make_unique<DirectoryNode>(*item.second, this);
@@ -368,7 +373,7 @@ ReplicationProperty DirectoryNode::getNarrowestReplication() const {
   for (const auto& item : children_) {
     narrowest = narrowest.narrowest(item.second->getNarrowestReplication());
   }
-  for (const auto& item : logs_) {
+  for (const auto& item : *logs_) {
     narrowest = narrowest.narrowest(item.second->getReplicationProperty());
   }
   return narrowest;
@@ -395,14 +400,31 @@ void DirectoryNode::deduplicateRecursively(CommonValuesRegistry& registry,
     child.second->deduplicateRecursively(registry, callback);
   }
 
-  for (auto& item : logs_) {
-    auto& log = item.second;
+  // Collect the replacements first so that logs_ is only copied if it is
+  // shared and something actually changes.
+  std::vector<LogGroupNodePtr> replaced;
+  for (const auto& item : *logs_) {
+    const auto& log = item.second;
     if (auto new_attrs = registry.deduplicate(log->attrs())) {
-      log = std::make_shared<const LogGroupNode>(
-          log->name(), *new_attrs, log->range());
-      callback(parent_, log);
+      replaced.push_back(std::make_shared<const LogGroupNode>(
+          log->name(), *new_attrs, log->range()));
     }
   }
+  if (replaced.empty()) {
+    return;
+  }
+  LogGroupMap& logs = mutableLogs();
+  for (auto& log : replaced) {
+    logs[log->name()] = log;
+    callback(parent_, log);
+  }
+}
+
+LogGroupMap& DirectoryNode::mutableLogs() {
+  if (logs_.use_count() > 1) {
+    logs_ = std::make_shared<LogGroupMap>(*logs_);
+  }
+  return *logs_;
 }
 
 LogGroupNodePtr DirectoryNode::addLogGroup(LogGroupNodePtr group,
@@ -413,7 +435,7 @@ LogGroupNodePtr DirectoryNode::addLogGroup(LogGroupNodePtr group,
     err = E::EXISTS;
     return nullptr;
   }
-  logs_[group->name()] = group;
+  mutableLogs()[group->name()] = group;
   return group;
 }
 
@@ -454,8 +476,9 @@ bool DirectoryNode::refreshAttributesInheritance(std::string& failure_reason) {
       return false;
     }
   }
-  // for all log groups, replace.
-  for (auto& it : logs_) {
+  // for all log groups, replace. Every entry is overwritten, so take our own
+  // copy of the map before iterating over it.
+  for (auto& it : mutableLogs()) {
     std::string log_path = getFullyQualifiedName() + delimiter_ + it.first;
     // create a replacement log group node that has our attributes applied
     LogGroupNode replacement = it.second->withLogAttributes(
@@ -471,13 +494,14 @@ bool DirectoryNode::refreshAttributesInheritance(std::string& failure_reason) {
 }
 
 LogGroupNodePtr DirectoryNode::deleteLogGroup(const std::string& name) {
-  auto iter = logs_.find(name);
-  if (iter != logs_.end()) {
-    auto old_node = iter->second;
-    logs_.erase(iter);
-    return old_node;
+  if (logs_->count(name) == 0) {
+    return nullptr;
   }
-  return nullptr;
+  LogGroupMap& logs = mutableLogs();
+  auto iter = logs.find(name);
+  auto old_node = iter->second;
+  logs.erase(iter);
+  return old_node;
 }
 
 void DirectoryNode::deleteChild(const std::string& name) {
@@ -1301,6 +1325,51 @@ void LogsConfigTree::rebuildIndex() {
   rebuildIndexForDir(root_.get(), false);
 }
 
+namespace {
+// Maps every directory of `from' to its counterpart in `to', a copy of it.
+void mapCopiedDirectories(
+    const DirectoryNode* from,
+    const DirectoryNode* to,
+    folly::F14FastMap<const DirectoryNode*, const DirectoryNode*>& out) {
+  out[from] = to;
+  for (const auto& item : from->children()) {
+    auto it = to->children().find(item.first);
+    ld_check(it != to->children().end());
+    mapCopiedDirectories(item.second.get(), it->second.get(), out);
+  }
+}
+} // namespace
+
+LogsConfigTree& LogsConfigTree::copy(const LogsConfigTree& other) {
+  delimiter_ = other.delimiter_;
+  root_ = std::make_unique<DirectoryNode>(*other.root_);
+  version_ = other.version_;
+  registry_ = other.registry_;
+
+  // The parent pointers in LogGroupInDirectory point to directories of the
+  // old tree. Rather than rebuilding the index from the new tree, which costs
+  // an interval map insertion per log group, copy it and repoint the parents
+  // at the copied directories.
+  folly::F14FastMap<const DirectoryNode*, const DirectoryNode*> dirs;
+  mapCopiedDirectories(other.root_.get(), root_.get(), dirs);
+  logs_index_ = other.logs_index_;
+  max_backlog_duration_ = std::chrono::seconds(0);
+  for (auto& item : logs_index_) {
+    LogGroupInDirectory& lgid = item.second;
+    auto it = dirs.find(lgid.parent);
+    ld_check(it != dirs.end());
+    if (it != dirs.end()) {
+      lgid.parent = it->second;
+    }
+    auto backlog = lgid.log_group->attrs().backlogDuration();
+    if (backlog.hasValue() && backlog.value().has_value()) {
+      max_backlog_duration_ =
+          std::max(max_backlog_duration_, backlog.value().value());
+    }
+  }
+  return *this;
+}
+
 ReplicationProperty LogsConfigTree::getNarrowestReplication() const {
   return root_->getNarrowestReplication();
 }
@@ -207,7 +207,8 @@ class DirectoryNode : public LogsConfigTreeNode {
       : delimiter_(delimiter) {}
 
   // The copy constructor, this ensures that the directory tree is deeply copied
-  // by pointers for an effective snapshotting of the tree.
+  // by pointers for an effective snapshotting of the tree. The log groups map
+  // is shared with `other' until either of them changes it.
   DirectoryNode(const DirectoryNode& other, DirectoryNode* parent);
 
   // copy constructor (should generally be avoided)
@@ -235,7 +236,7 @@ class DirectoryNode : public LogsConfigTreeNode {
       : LogsConfigTreeNode(name, attrs),
         parent_(parent),
         children_(std::move(dirs)),
-        logs_(logs),
+        logs_(std::make_shared<LogGroupMap>(logs)),
         delimiter_(delimiter) {}
 
   NodeType type() const override {
@@ -256,7 +257,7 @@ class DirectoryNode : public LogsConfigTreeNode {
   // Checks whether that name (whether it's a LogGroup or a Directory) exists
   // under this directory or not.
   bool exists(const std::string& name) const {
-    return (logs_.count(name) > 0 || children_.count(name) > 0);
+    return (logs_->count(name) > 0 || children_.count(name) > 0);
   }
 
   /**
@@ -269,7 +270,7 @@ class DirectoryNode : public LogsConfigTreeNode {
   }
 
   virtual const LogGroupMap& logs() const {
-    return logs_;
+    return *logs_;
   }
 
   /*
@@ -327,7 +328,7 @@ class DirectoryNode : public LogsConfigTreeNode {
 
   // sets the log groups map directly.
   void setLogGroups(const LogGroupMap& logs) {
-    logs_ = logs;
+    logs_ = std::make_shared<LogGroupMap>(logs);
   }
 
   void setName(const std::string& name) {
@@ -360,9 +361,16 @@ class DirectoryNode : public LogsConfigTreeNode {
   void deduplicateRecursively(CommonValuesRegistry&, const GroupChangeCb&);
 
  private:
+  // Returns logs_ for modification, copying it first if it is shared with
+  // copies of this directory in other trees.
+  LogGroupMap& mutableLogs();
+
   DirectoryNode* parent_;
   DirectoryMap children_;
-  LogGroupMap logs_;
+  // Shared between copies of the directory until one of them modifies it, so
+  // that copying a tree doesn't copy the log groups of every directory.
+  // LogGroupNodes are immutable and shared as well.
+  std::shared_ptr<LogGroupMap> logs_ = std::make_shared<LogGroupMap>();
   std::string delimiter_;
 };
 
@@ -818,16 +826,7 @@ class LogsConfigTree {
   }
 
  protected:
-  LogsConfigTree& copy(const LogsConfigTree& other) {
-    delimiter_ = other.delimiter_;
-    root_ = std::make_unique<DirectoryNode>(*other.root_);
-    version_ = other.version_;
-    registry_ = other.registry_;
-    // We cannot copy the index because the Parent pointer in
-    // LogGroupInDirectory will be pointing to the old tree.
-    rebuildIndex();
-    return *this;
-  }
+  LogsConfigTree& copy(const LogsConfigTree& other);
 
   /*
    * Adds a log group to a specific directory
@@ -0,0 +1,66 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/configuration/nodes/FailureDomainIndex.h"
+
+#include <algorithm>
+
+#include <folly/container/F14Map.h>
+
+namespace facebook { namespace logdevice { namespace configuration {
+namespace nodes {
+
+constexpr FailureDomainIndex::domain_id_t FailureDomainIndex::NO_DOMAIN;
+
+FailureDomainIndex::FailureDomainIndex(
+    const ServiceDiscoveryConfig& sd_config) {
+  node_index_t max_node = -1;
+  for (const auto& kv : sd_config) {
+    max_node = std::max(max_node, kv.first);
+  }
+  const size_t num_slots = max_node + 1;
+  num_specified_.assign(num_slots, 0);
+  for (auto& scope : scopes_) {
+    scope.node_domain.assign(num_slots, NO_DOMAIN);
+  }
+
+  std::array<folly::F14FastMap<std::string, domain_id_t>,
+             static_cast<size_t>(NodeLocationScope::ROOT)>
+      ids;
+  // Visit nodes in increasing order of index so that the node lists of the
+  // domains come out sorted.
+  for (node_index_t node = 0; node <= max_node; ++node) {
+    const NodeServiceDiscovery* sd = sd_config.getNodeAttributesPtr(node);
+    if (sd == nullptr) {
+      continue;
+    }
+    const auto& location = sd->location;
+    if (location.has_value()) {
+      num_specified_[node] = location->numScopes();
+    }
+    for (NodeLocationScope scope = NodeLocationScope::NODE;
+         scope < NodeLocationScope::ROOT;
+         scope = NodeLocation::nextGreaterScope(scope)) {
+      if (scope != NodeLocationScope::NODE && !location.has_value()) {
+        continue;
+      }
+      std::string name = location.has_value()
+          ? location->getDomain(scope, node)
+          : std::to_string(node);
+      Scope& s = scopes_[scopeIdx(scope)];
+      auto res = ids[scopeIdx(scope)].emplace(name, s.domains.size());
+      if (res.second) {
+        s.domains.push_back(Domain{std::move(name), {}});
+      }
+      const domain_id_t id = res.first->second;
+      s.domains[id].nodes.push_back(node);
+      s.node_domain[node] = id;
+    }
+  }
+}
+
+}}}} // namespace facebook::logdevice::configuration::nodes
@@ -0,0 +1,108 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <array>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "logdevice/common/NodeID.h"
+#include "logdevice/common/configuration/nodes/ServiceDiscoveryConfig.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/include/NodeLocationScope.h"
+
+namespace facebook { namespace logdevice { namespace configuration {
+namespace nodes {
+
+/**
+ * @file FailureDomainIndex maps each node of a ServiceDiscoveryConfig to a
+ * dense id of the failure domain it belongs to at every location scope from
+ * NODE to REGION. It is immutable, built once for each NodesConfiguration
+ * (see NodesConfiguration::getFailureDomainIndex()), so that users grouping
+ * nodes by location, such as FailureDomainNodeSet, can do an array lookup
+ * per node instead of building and hashing location strings every time.
+ *
+ * At NODE scope every node of the config is its own domain. At larger scopes
+ * two nodes are in the same domain iff their locations share that scope as
+ * defined by NodeLocation::sharesScopeWith(), which includes the case where
+ * neither location specifies the scope but the specified prefixes are equal.
+ * Use scopeSpecified() to tell these apart. Nodes without a location are not
+ * in any domain at scopes larger than NODE.
+ */
+class FailureDomainIndex {
+ public:
+  using domain_id_t = uint32_t;
+  static constexpr domain_id_t NO_DOMAIN =
+      std::numeric_limits<domain_id_t>::max();
+
+  // creates an index with no nodes
+  FailureDomainIndex() = default;
+
+  explicit FailureDomainIndex(const ServiceDiscoveryConfig& sd_config);
+
+  // @return  id of the domain `node` belongs to at `scope`, or NO_DOMAIN if
+  //          the node is not in the config or has no location. Ids at a scope
+  //          are in [0, numDomains(scope)). `scope` must be < ROOT.
+  domain_id_t getDomain(NodeLocationScope scope, node_index_t node) const {
+    const auto& domains = scopes_[scopeIdx(scope)].node_domain;
+    return node >= 0 && static_cast<size_t>(node) < domains.size()
+        ? domains[node]
+        : NO_DOMAIN;
+  }
+
+  // @return  true if `node` has a location with a non-empty label at `scope`,
+  //          see NodeLocation::scopeSpecified().
+  bool scopeSpecified(NodeLocationScope scope, node_index_t node) const {
+    return node >= 0 && static_cast<size_t>(node) < num_specified_.size() &&
+        scope != NodeLocationScope::NODE && scope < NodeLocationScope::ROOT &&
+        static_cast<size_t>(NodeLocationScope::ROOT) -
+                static_cast<size_t>(scope) <=
+            num_specified_[node];
+  }
+
+  size_t numDomains(NodeLocationScope scope) const {
+    return scopes_[scopeIdx(scope)].domains.size();
+  }
+
+  // @return  domain name, as returned by NodeLocation::getDomain(scope, node)
+  const std::string& getDomainName(NodeLocationScope scope,
+                                   domain_id_t domain) const {
+    return scopes_[scopeIdx(scope)].domains.at(domain).name;
+  }
+
+  // @return  nodes in the domain, in increasing order
+  const std::vector<node_index_t>& getNodes(NodeLocationScope scope,
+                                            domain_id_t domain) const {
+    return scopes_[scopeIdx(scope)].domains.at(domain).nodes;
+  }
+
+ private:
+  struct Domain {
+    std::string name;
+    std::vector<node_index_t> nodes;
+  };
+
+  struct Scope {
+    // indexed by domain_id_t
+    std::vector<Domain> domains;
+    // indexed by node_index_t, NO_DOMAIN for holes
+    std::vector<domain_id_t> node_domain;
+  };
+
+  static size_t scopeIdx(NodeLocationScope scope) {
+    ld_check(scope < NodeLocationScope::ROOT);
+    return static_cast<size_t>(scope);
+  }
+
+  std::array<Scope, static_cast<size_t>(NodeLocationScope::ROOT)> scopes_;
+  // NodeLocation::numScopes() of each node, indexed by node_index_t
+  std::vector<uint8_t> num_specified_;
+};
+
+}}}} // namespace facebook::logdevice::configuration::nodes
@@ -67,7 +67,8 @@ NodesConfiguration::NodesConfiguration()
       version_(MembershipVersion::EMPTY_VERSION),
       storage_hash_(0),
       num_shards_(0),
-      max_node_index_(0) {
+      max_node_index_(0),
+      failure_domain_index_(std::make_shared<const FailureDomainIndex>()) {
   ld_check(validate());
 }
 
@@ -395,6 +396,8 @@ void NodesConfiguration::recomputeConfigMetadata() {
   num_shards_ = computeNumShards();
   max_node_index_ = computeMaxNodeIndex();
   sequencer_locator_config_ = computeSequencersConfig();
+  failure_domain_index_ =
+      std::make_shared<const FailureDomainIndex>(*service_discovery_);
   serialized_config_ = serializeConfig();
 }
 
@@ -9,6 +9,7 @@
 
 #include "logdevice/common/Timestamp.h"
 #include "logdevice/common/configuration/SequencersConfig.h"
+#include "logdevice/common/configuration/nodes/FailureDomainIndex.h"
 #include "logdevice/common/configuration/nodes/MetaDataLogsReplication.h"
 #include "logdevice/common/configuration/nodes/SequencerConfig.h"
 #include "logdevice/common/configuration/nodes/ServiceDiscoveryConfig.h"
@@ -199,6 +200,13 @@ class NodesConfiguration {
     return sequencer_locator_config_;
   }
 
+  // @return  failure domains of the nodes in the service discovery config at
+  //          each location scope. Never nullptr.
+  const std::shared_ptr<const FailureDomainIndex>&
+  getFailureDomainIndex() const {
+    return failure_domain_index_;
+  }
+
   // TODO(T33035439): this should only be used in migration or emergency. Config
   // version bump should be automatically handled through Update.
   void setVersion(membership::MembershipVersion::Type version) {
@@ -277,6 +285,10 @@ class NodesConfiguration {
   // sequencer locator / routing / placement logic and get rid of this field
   SequencersConfig sequencer_locator_config_;
 
+  // Derived from service discovery and refreshed when the config is updated.
+  // Shared between copies that only differ in version.
+  std::shared_ptr<const FailureDomainIndex> failure_domain_index_;
+
   // Unix timestamp in milliseconds.
   uint64_t last_change_timestamp_{0};
 
@@ -0,0 +1,244 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/configuration/nodes/NodesConfigurationDiff.h"
+
+#include <cstring>
+#include <unordered_map>
+
+#include <zstd.h>
+
+#include "logdevice/common/Checksum.h"
+#include "logdevice/common/configuration/nodes/NodesConfigurationCodec.h"
+#include "logdevice/common/debug.h"
+
+namespace facebook { namespace logdevice { namespace configuration {
+namespace nodes {
+
+namespace {
+
+constexpr uint8_t FORMAT_VERSION = 1;
+
+enum class Op : uint8_t { COPY = 1, INSERT = 2 };
+
+// Size of the blocks of the base that the target is matched against. Small
+// enough to find the unchanged parts between two nearby node entries, large
+// enough to keep the index of the base small.
+constexpr size_t BLOCK_SIZE = 32;
+
+// Multiplier of the polynomial rolling hash. Arithmetic is modulo 2^64.
+constexpr uint64_t HASH_BASE = 1099511628211ull;
+
+uint64_t hashBlock(const char* data) {
+  uint64_t h = 0;
+  for (size_t i = 0; i < BLOCK_SIZE; ++i) {
+    h = h * HASH_BASE + static_cast<uint8_t>(data[i]);
+  }
+  return h;
+}
+
+// HASH_BASE^(BLOCK_SIZE - 1), used to roll the first byte out of the hash.
+uint64_t hashBaseToBlockSize() {
+  uint64_t p = 1;
+  for (size_t i = 0; i + 1 < BLOCK_SIZE; ++i) {
+    p *= HASH_BASE;
+  }
+  return p;
+}
+
+template <typename T>
+void append(std::string& out, T value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool consume(folly::StringPiece& in, T* value) {
+  if (in.size() < sizeof(T)) {
+    return false;
+  }
+  std::memcpy(value, in.data(), sizeof(T));
+  in.advance(sizeof(T));
+  return true;
+}
+
+uint64_t checksum(folly::StringPiece data) {
+  return checksum_64bit(Slice(data.data(), data.size()));
+}
+
+} // namespace
+
+std::string
+NodesConfigurationDiff::serializeForDiff(const NodesConfiguration& config) {
+  return NodesConfigurationCodec::serialize(
+      config, NodesConfigurationCodec::SerializeOptions{/*compression=*/false});
+}
+
+std::string NodesConfigurationDiff::compute(folly::StringPiece base,
+                                            folly::StringPiece target) {
+  std::string ops;
+  append(ops, FORMAT_VERSION);
+  append<uint64_t>(ops, base.size());
+  append(ops, checksum(base));
+  append<uint64_t>(ops, target.size());
+  append(ops, checksum(target));
+
+  auto emit_insert = [&](size_t from, size_t to) {
+    if (to > from) {
+      append(ops, Op::INSERT);
+      append<uint32_t>(ops, to - from);
+      ops.append(target.data() + from, to - from);
+    }
+  };
+
+  // Index the base by the hash of each aligned block. The first occurrence
+  // of a given hash wins.
+  std::unordered_map<uint64_t, uint32_t> index;
+  for (size_t off = 0; off + BLOCK_SIZE <= base.size(); off += BLOCK_SIZE) {
+    index.emplace(hashBlock(base.data() + off), off);
+  }
+
+  const uint64_t roll_out = hashBaseToBlockSize();
+  size_t literal_start = 0;
+  size_t pos = 0;
+  uint64_t h = 0;
+  if (!index.empty() && target.size() >= BLOCK_SIZE) {
+    h = hashBlock(target.data());
+  }
+  while (!index.empty() && pos + BLOCK_SIZE <= target.size()) {
+    auto it = index.find(h);
+    if (it != index.end() &&
+        std::memcmp(
+            base.data() + it->second, target.data() + pos, BLOCK_SIZE) == 0) {
+      size_t base_off = it->second;
+      size_t target_off = pos;
+      // Extend the match backwards over the pending literal bytes...
+      while (target_off > literal_start && base_off > 0 &&
+             base[base_off - 1] == target[target_off - 1]) {
+        --base_off;
+        --target_off;
+      }
+      // ... and forwards as far as the two agree.
+      size_t end = pos + BLOCK_SIZE;
+      while (end < target.size() &&
+             base_off + (end - target_off) < base.size() &&
+             base[base_off + (end - target_off)] == target[end]) {
+        ++end;
+      }
+      emit_insert(literal_start, target_off);
+      append(ops, Op::COPY);
+      append<uint32_t>(ops, base_off);
+      append<uint32_t>(ops, end - target_off);
+      pos = literal_start = end;
+      if (pos + BLOCK_SIZE <= target.size()) {
+        h = hashBlock(target.data() + pos);
+      }
+      continue;
+    }
+    if (pos + BLOCK_SIZE < target.size()) {
+      h = (h - static_cast<uint8_t>(target[pos]) * roll_out) * HASH_BASE +
+          static_cast<uint8_t>(target[pos + BLOCK_SIZE]);
+    }
+    ++pos;
+  }
+  emit_insert(literal_start, target.size());
+
+  std::string out;
+  out.resize(ZSTD_compressBound(ops.size()));
+  size_t compressed_size = ZSTD_compress(&out[0],
+                                         out.size(),
+                                         ops.data(),
+                                         ops.size(),
+                                         /*compressionLevel=*/5);
+  if (ZSTD_isError(compressed_size)) {
+    ld_error("ZSTD_compress() failed: %s", ZSTD_getErrorName(compressed_size));
+    err = E::INTERNAL;
+    return "";
+  }
+  out.resize(compressed_size);
+  return out;
+}
+
+folly::Optional<std::string>
+NodesConfigurationDiff::apply(folly::StringPiece base,
+                              folly::StringPiece diff) {
+  size_t ops_size = ZSTD_getDecompressedSize(diff.data(), diff.size());
+  if (ops_size == 0) {
+    err = E::BADMSG;
+    return folly::none;
+  }
+  std::string ops_buf;
+  ops_buf.resize(ops_size);
+  ops_size =
+      ZSTD_decompress(&ops_buf[0], ops_buf.size(), diff.data(), diff.size());
+  if (ZSTD_isError(ops_size)) {
+    RATELIMIT_ERROR(std::chrono::seconds(5),
+                    1,
+                    "ZSTD_decompress() failed: %s",
+                    ZSTD_getErrorName(ops_size));
+    err = E::BADMSG;
+    return folly::none;
+  }
+  folly::StringPiece ops(ops_buf.data(), ops_size);
+
+  uint8_t format;
+  uint64_t base_size, base_checksum, target_size, target_checksum;
+  if (!consume(ops, &format) || !consume(ops, &base_size) ||
+      !consume(ops, &base_checksum) || !consume(ops, &target_size) ||
+      !consume(ops, &target_checksum) || format != FORMAT_VERSION) {
+    err = E::BADMSG;
+    return folly::none;
+  }
+  if (base.size() != base_size || checksum(base) != base_checksum) {
+    err = E::CHECKSUM_MISMATCH;
+    return folly::none;
+  }
+
+  std::string target;
+  target.reserve(target_size);
+  while (!ops.empty()) {
+    Op op;
+    uint32_t len;
+    if (!consume(ops, &op)) {
+      err = E::BADMSG;
+      return folly::none;
+    }
+    switch (op) {
+      case Op::COPY: {
+        uint32_t offset;
+        if (!consume(ops, &offset) || !consume(ops, &len) ||
+            uint64_t(offset) + len > base.size()) {
+          err = E::BADMSG;
+          return folly::none;
+        }
+        target.append(base.data() + offset, len);
+      } break;
+      case Op::INSERT:
+        if (!consume(ops, &len) || ops.size() < len) {
+          err = E::BADMSG;
+          return folly::none;
+        }
+        target.append(ops.data(), len);
+        ops.advance(len);
+        break;
+      default:
+        err = E::BADMSG;
+        return folly::none;
+    }
+    if (target.size() > target_size) {
+      err = E::BADMSG;
+      return folly::none;
+    }
+  }
+
+  if (target.size() != target_size || checksum(target) != target_checksum) {
+    err = E::BADMSG;
+    return folly::none;
+  }
+  return target;
+}
+
+}}}} // namespace facebook::logdevice::configuration::nodes
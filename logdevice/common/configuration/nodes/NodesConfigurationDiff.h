@@ -0,0 +1,63 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <string>
+
+#include <folly/Optional.h>
+#include <folly/Range.h>
+
+#include "logdevice/include/Err.h"
+
+namespace facebook { namespace logdevice { namespace configuration {
+namespace nodes {
+
+class NodesConfiguration;
+
+/**
+ * @file Binary diffs between two serialized NodesConfigurations, used to
+ * send clients that are a few versions behind only what changed instead of
+ * the whole config.
+ *
+ * Diffs are computed on the uncompressed output of NodesConfigurationCodec
+ * (see serializeForDiff()), as compressed blobs don't share any structure
+ * between versions. The diff is a stream of copy-from-base and insert
+ * operations found with an rsync-like rolling hash over blocks of the base,
+ * compressed with zstd. Both the base and the target are checksummed, so
+ * applying a diff to the wrong base (e.g. because the two sides serialize the
+ * same config differently) fails cleanly instead of producing garbage.
+ */
+class NodesConfigurationDiff {
+ public:
+  // Serializes `config` the way diffs expect it, i.e. without compression.
+  // The result can be passed to NodesConfigurationCodec::deserialize().
+  // Returns an empty string on error.
+  static std::string serializeForDiff(const NodesConfiguration& config);
+
+  /**
+   * Computes a diff that turns `base` into `target`.
+   *
+   * @return  the diff, or an empty string if it could not be computed (err is
+   *          set to INTERNAL).
+   */
+  static std::string compute(folly::StringPiece base,
+                             folly::StringPiece target);
+
+  /**
+   * Applies a diff produced by compute() to `base`.
+   *
+   * @return  the target, or folly::none with err set to:
+   *            BADMSG             the diff is malformed
+   *            CHECKSUM_MISMATCH  `base` is not the base the diff was computed
+   *                               from
+   */
+  static folly::Optional<std::string> apply(folly::StringPiece base,
+                                            folly::StringPiece diff);
+};
+
+}}}} // namespace facebook::logdevice::configuration::nodes
@@ -0,0 +1,108 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/configuration/nodes/NodesConfigurationHistory.h"
+
+#include "logdevice/common/configuration/nodes/NodesConfiguration.h"
+#include "logdevice/common/configuration/nodes/NodesConfigurationDiff.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/include/Err.h"
+
+namespace facebook { namespace logdevice { namespace configuration {
+namespace nodes {
+
+NodesConfigurationHistory::NodesConfigurationHistory(size_t max_versions)
+    : max_versions_(max_versions) {
+  ld_check(max_versions_ > 0);
+}
+
+void NodesConfigurationHistory::add(
+    std::shared_ptr<const NodesConfiguration> config) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  addLocked(std::move(config));
+}
+
+void NodesConfigurationHistory::addLocked(
+    std::shared_ptr<const NodesConfiguration> config) {
+  ld_check(config);
+  const version_t version = config->getVersion();
+  if (!versions_.emplace(version, Entry{std::move(config), ""}).second) {
+    return;
+  }
+  while (versions_.size() > max_versions_) {
+    const version_t evicted = versions_.begin()->first;
+    versions_.erase(versions_.begin());
+    for (auto it = diffs_.begin(); it != diffs_.end();) {
+      if (it->first.first == evicted || it->first.second == evicted) {
+        it = diffs_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+}
+
+const std::string*
+NodesConfigurationHistory::serializedLocked(Entry& entry) {
+  if (entry.serialized.empty()) {
+    entry.serialized = NodesConfigurationDiff::serializeForDiff(*entry.config);
+    if (entry.serialized.empty()) {
+      return nullptr;
+    }
+  }
+  return &entry.serialized;
+}
+
+folly::Optional<std::string> NodesConfigurationHistory::getDiff(
+    version_t base_version,
+    std::shared_ptr<const NodesConfiguration> config) {
+  ld_check(config);
+  const version_t target_version = config->getVersion();
+
+  // Diffs are computed under the lock on purpose: concurrent requests for the
+  // same diff wait for the first one instead of all computing it.
+  std::lock_guard<std::mutex> lock(mutex_);
+  addLocked(std::move(config));
+
+  auto cached = diffs_.find(std::make_pair(base_version, target_version));
+  if (cached != diffs_.end()) {
+    return cached->second;
+  }
+
+  auto base_it = versions_.find(base_version);
+  auto target_it = versions_.find(target_version);
+  if (base_it == versions_.end() || target_it == versions_.end()) {
+    err = E::NOTFOUND;
+    return folly::none;
+  }
+
+  const std::string* base = serializedLocked(base_it->second);
+  const std::string* target = serializedLocked(target_it->second);
+  if (!base || !target) {
+    err = E::INTERNAL;
+    return folly::none;
+  }
+  std::string diff = NodesConfigurationDiff::compute(*base, *target);
+  if (diff.empty()) {
+    return folly::none;
+  }
+  ld_debug("Computed NodesConfiguration diff %lu -> %lu: %zu bytes, full "
+           "config is %zu bytes uncompressed",
+           base_version.val(),
+           target_version.val(),
+           diff.size(),
+           target->size());
+  diffs_.emplace(std::make_pair(base_version, target_version), diff);
+  return diff;
+}
+
+size_t NodesConfigurationHistory::numVersions() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return versions_.size();
+}
+
+}}}} // namespace facebook::logdevice::configuration::nodes
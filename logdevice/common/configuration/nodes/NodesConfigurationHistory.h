@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <folly/Optional.h>
+
+#include "logdevice/common/membership/types.h"
+
+namespace facebook { namespace logdevice { namespace configuration {
+namespace nodes {
+
+class NodesConfiguration;
+
+/**
+ * @file Keeps the last few NodesConfigurations seen by a server so that
+ * CONFIG_FETCH requests from clients that are only a few versions behind can
+ * be answered with a NodesConfigurationDiff instead of the full config.
+ *
+ * Configs are serialized lazily, the first time they are used as the base or
+ * target of a diff, and diffs are cached: a burst of clients polling from the
+ * same version costs a single diff computation. Thread safe.
+ */
+class NodesConfigurationHistory {
+ public:
+  using version_t = membership::MembershipVersion::Type;
+
+  // @param max_versions  how many versions to keep. The oldest ones, and
+  //                      their diffs, are evicted first.
+  explicit NodesConfigurationHistory(size_t max_versions);
+
+  // Records `config`. No-op if its version is already known.
+  void add(std::shared_ptr<const NodesConfiguration> config);
+
+  /**
+   * Returns a diff from `base_version` to `config`, which is recorded first.
+   *
+   * @return  the diff, or folly::none with err set to:
+   *            NOTFOUND  `base_version` is not (or no longer) in the history
+   *            INTERNAL  serialization or diffing failed
+   */
+  folly::Optional<std::string>
+  getDiff(version_t base_version,
+          std::shared_ptr<const NodesConfiguration> config);
+
+  size_t numVersions() const;
+
+ private:
+  struct Entry {
+    std::shared_ptr<const NodesConfiguration> config;
+    // Output of NodesConfigurationDiff::serializeForDiff(), once needed.
+    std::string serialized;
+  };
+
+  const size_t max_versions_;
+
+  mutable std::mutex mutex_;
+  std::map<version_t, Entry> versions_;
+  // Cached diffs, keyed by (base, target) version.
+  std::map<std::pair<version_t, version_t>, std::string> diffs_;
+
+  void addLocked(std::shared_ptr<const NodesConfiguration> config);
+  const std::string* serializedLocked(Entry& entry);
+};
+
+}}}} // namespace facebook::logdevice::configuration::nodes
@@ -73,6 +73,7 @@ void EventLogStateMachine::start() {
   }
 
   blockStateDelivery(settings_->block_eventlog_rsm);
+  startTime_ = SteadyTimestamp::now();
   Parent::start();
 }
 
@@ -144,6 +145,7 @@ std::unique_ptr<EventLogRebuildingSet> EventLogStateMachine::deserializeState(
 void EventLogStateMachine::gotInitialState(
     const EventLogRebuildingSet& rebuilding_set) const {
   ld_info("Got base rebuilding set: %s", toString(rebuilding_set).c_str());
+  baseSnapshotTime_ = SteadyTimestamp::now();
 }
 
 std::unique_ptr<EventLogRecord>
@@ -228,6 +230,10 @@ void EventLogStateMachine::postWriteDeltaRequest(
 void EventLogStateMachine::onUpdate(const EventLogRebuildingSet& set,
                                     const EventLogRecord* /*delta*/,
                                     lsn_t version) {
+  if (!ready_) {
+    onReady();
+  }
+
   if (update_workers_) {
     gracePeriodTimer_.activate(settings_->event_log_grace_period);
     publishRebuildingSet();
@@ -265,6 +271,32 @@ void EventLogStateMachine::onSnapshotCreated(Status st, size_t snapshotSize) {
   }
 }
 
+void EventLogStateMachine::onReady() {
+  // Below this many deltas, replay time is mostly fixed overhead.
+  static constexpr size_t kMinDeltasForReplayCost = 100;
+
+  ready_ = true;
+  const auto now = SteadyTimestamp::now();
+  const auto time_to_ready =
+      std::chrono::duration_cast<std::chrono::milliseconds>(now - startTime_);
+  const auto replay_time =
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          now - baseSnapshotTime_);
+  const size_t deltas = numDeltaRecordsSinceLastSnapshot();
+  if (deltas >= kMinDeltasForReplayCost) {
+    deltaReplayCost_ = replay_time / deltas;
+  }
+
+  ld_info("Event log is ready after %ldms. Replayed %lu deltas after the "
+          "base snapshot in %ldms.",
+          time_to_ready.count(),
+          deltas,
+          std::chrono::duration_cast<std::chrono::milliseconds>(replay_time)
+              .count());
+  WORKER_STAT_SET(eventlog_time_to_ready_ms, time_to_ready.count());
+  WORKER_STAT_SET(eventlog_deltas_replayed_on_startup, deltas);
+}
+
 bool EventLogStateMachine::shouldTrim() const {
   // Trim if:
   // 1. Event log trimming is enabled in the settings;
@@ -289,11 +321,21 @@ bool EventLogStateMachine::shouldCreateSnapshot() const {
   // 1. we are not already snapshotting;
   // 2. Event log snapshotting is enabled in the settings;
   // 3. This node is the first node alive according to the FD;
-  // 4. We reached the limits in delta log size as configured in settings.
+  // 4. We reached the limits in delta log size, or in the estimated time to
+  //    replay it, as configured in settings.
   return canSnapshot() &&
       (numDeltaRecordsSinceLastSnapshot() >
            settings_->event_log_max_delta_records ||
-       numBytesSinceLastSnapshot() > settings_->event_log_max_delta_bytes);
+       numBytesSinceLastSnapshot() > settings_->event_log_max_delta_bytes ||
+       deltaReplayTooSlow());
+}
+
+bool EventLogStateMachine::deltaReplayTooSlow() const {
+  const auto limit = settings_->event_log_max_delta_replay_time;
+  if (limit.count() == 0 || deltaReplayCost_.count() == 0) {
+    return false;
+  }
+  return deltaReplayCost_ * numDeltaRecordsSinceLastSnapshot() > limit;
 }
 
 Request::Execution StartEventLogStateMachineRequest::execute() {
@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include "logdevice/common/Timestamp.h"
 #include "logdevice/common/event_log/EventLogRebuildingSet.h"
 #include "logdevice/common/event_log/EventLogRebuildingSetCodec.h"
 #include "logdevice/common/event_log/EventLogRebuildingSet_generated.h"
@@ -222,8 +223,15 @@ class EventLogStateMachine
                 const EventLogRecord* delta,
                 lsn_t version);
 
+  // Called on the first update after reaching the tail of the delta log.
+  // Records how long it took to get there.
+  void onReady();
+
   // Returns true if now is the time to create a new snapshot.
   bool shouldCreateSnapshot() const;
+  // Returns true if replaying the deltas since the last snapshot is expected
+  // to take longer than event_log_max_delta_replay_time.
+  bool deltaReplayTooSlow() const;
   // Returns true if we can trim the RSM.
   bool shouldTrim() const;
 
@@ -239,6 +247,16 @@ class EventLogStateMachine
   // Used to publish rebuilding set changes after event_log_grace_period.
   Timer gracePeriodTimer_;
 
+  // When start() was called and when the base snapshot was retrieved. The
+  // latter is mutable because gotInitialState() is const.
+  SteadyTimestamp startTime_;
+  mutable SteadyTimestamp baseSnapshotTime_;
+  bool ready_{false};
+
+  // Average time it took to replay one delta on startup. Zero if we replayed
+  // too few deltas for the estimate to mean anything.
+  std::chrono::microseconds deltaReplayCost_{0};
+
   // Last ShardAuthoritativeStatusMap that was broadcast.
   ShardAuthoritativeStatusMap last_broadcast_map_;
 
@@ -54,6 +54,14 @@ EvBaseWithFolly::Status EvBaseWithFolly::loopOnce() {
   return Status::INTERNAL_ERROR;
 }
 
+EvBaseWithFolly::Status EvBaseWithFolly::loopOnceNonBlocking() {
+  if (base_.loopOnce(EVLOOP_NONBLOCK)) {
+    return Status::OK;
+  }
+
+  return Status::INTERNAL_ERROR;
+}
+
 EvBaseWithFolly::Status EvBaseWithFolly::terminateLoop() {
   base_.terminateLoopSoon();
   return Status::OK;
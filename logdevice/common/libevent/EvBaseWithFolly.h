@@ -36,6 +36,7 @@ class EvBaseWithFolly : public IEvBase {
   void runInEventBaseThread(EventCallback fn) override;
   Status loop() override;
   Status loopOnce() override;
+  Status loopOnceNonBlocking() override;
   Status terminateLoop() override;
 
   /**
@@ -52,6 +52,8 @@ class IEvBase : public folly::TimeoutManager {
   virtual void runInEventBaseThread(EventCallback fn) = 0;
   virtual Status loop() = 0;
   virtual Status loopOnce() = 0;
+  // Like loopOnce() but returns right away if no events are ready.
+  virtual Status loopOnceNonBlocking() = 0;
   virtual Status terminateLoop() = 0;
 
   /**
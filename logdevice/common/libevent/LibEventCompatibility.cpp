@@ -60,6 +60,10 @@ EvBase::Status EvBase::loopOnce() {
   return curr_selection_->loopOnce();
 }
 
+EvBase::Status EvBase::loopOnceNonBlocking() {
+  return curr_selection_->loopOnceNonBlocking();
+}
+
 EvBase::Status EvBase::terminateLoop() {
   return curr_selection_->terminateLoop();
 }
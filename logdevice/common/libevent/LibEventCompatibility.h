@@ -29,6 +29,7 @@ class EvBase : public IEvBase {
   void runInEventBaseThread(EventCallback fn) override;
   Status loop() override;
   Status loopOnce() override;
+  Status loopOnceNonBlocking() override;
   Status terminateLoop() override;
 
   /**
@@ -29,6 +29,7 @@ class EvBaseMock : public EvBase {
 
   MOCK_METHOD0(loop, Status(void));
   MOCK_METHOD0(loopOnce, Status(void));
+  MOCK_METHOD0(loopOnceNonBlocking, Status(void));
 
   MOCK_METHOD0(getRawBaseDEPRECATED, event_base*(void));
   MOCK_METHOD0(getRawBase, event_base*(void));
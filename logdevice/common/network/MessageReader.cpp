@@ -12,6 +12,7 @@
 
 #include "logdevice/common/IProtocolHandler.h"
 #include "logdevice/common/debug.h"
+#include "logdevice/common/network/ReceiveBufferPool.h"
 #include "logdevice/common/settings/Settings.h"
 
 namespace facebook { namespace logdevice {
@@ -49,7 +50,7 @@ void MessageReader::prepareMessageBody() {
   auto payload_size = recv_message_ph_.len -
       ProtocolHeader::bytesNeeded(recv_message_ph_.type, proto_);
   next_buffer_allocation_size_ = payload_size;
-  read_buf_ = folly::IOBuf::create(next_buffer_allocation_size_);
+  read_buf_ = ReceiveBufferPool::allocate(next_buffer_allocation_size_);
   // Add the 8 byte of message read if cksum is absent into the read_buf and
   // move the writableTail().
   if (!ProtocolHeader::needChecksumInHeader(recv_message_ph_.type, proto_)) {
@@ -37,6 +37,9 @@ namespace facebook { namespace logdevice {
  * completely. If we were expecting header and it was read completely allocate a
  * new buffer using the message len in header. If the message was read
  * completely, dispatch the message forward for processing.
+ *
+ * Message body buffers come from ReceiveBufferPool, and the deserialized
+ * message may keep referencing them (e.g. as the payload of a RECORD).
  */
 class MessageReader : public folly::AsyncSocket::ReadCallback {
  public:
@@ -0,0 +1,107 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/network/ReceiveBufferPool.h"
+
+#include <array>
+#include <new>
+#include <utility>
+
+#include "logdevice/common/ThreadLocalFreeList.h"
+#include "logdevice/common/Worker.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/settings/Settings.h"
+#include "logdevice/common/stats/Stats.h"
+
+namespace facebook { namespace logdevice {
+
+namespace {
+
+template <size_t Size>
+struct Block {
+  char data[Size];
+};
+
+template <size_t SizeClass>
+using ClassFreeList = ThreadLocalFreeList<
+    Block<(ReceiveBufferPool::MIN_CLASS_SIZE << SizeClass)>>;
+
+struct FreeList {
+  void* (*get)();
+  bool (*put)(void*, size_t);
+};
+
+template <size_t... SizeClasses>
+constexpr std::array<FreeList, sizeof...(SizeClasses)>
+makeFreeLists(std::index_sequence<SizeClasses...>) {
+  return {{{&ClassFreeList<SizeClasses>::get,
+            &ClassFreeList<SizeClasses>::put}...}};
+}
+
+// One free list per size class, indexed by size class.
+constexpr std::array<FreeList, ReceiveBufferPool::NUM_CLASSES> free_lists =
+    makeFreeLists(std::make_index_sequence<ReceiveBufferPool::NUM_CLASSES>());
+
+bool poolEnabled() {
+  return Worker::onThisThread(false) != nullptr &&
+      Worker::settings().receive_buffer_pool_size > 0;
+}
+
+} // namespace
+
+int ReceiveBufferPool::sizeClass(size_t size) {
+  if (size < MIN_CLASS_SIZE || size > MAX_CLASS_SIZE) {
+    return -1;
+  }
+  int size_class = 0;
+  while (classSize(size_class) < size) {
+    ++size_class;
+  }
+  ld_check(size_class < static_cast<int>(NUM_CLASSES));
+  return size_class;
+}
+
+std::unique_ptr<folly::IOBuf> ReceiveBufferPool::allocate(size_t size) {
+  const int size_class = sizeClass(size);
+  if (size_class < 0 || !poolEnabled()) {
+    return folly::IOBuf::create(size);
+  }
+
+  const size_t capacity = classSize(size_class);
+  void* buf = free_lists[size_class].get();
+  if (buf != nullptr) {
+    WORKER_STAT_INCR(sock_read_buffer_pool_hits);
+    WORKER_STAT_SUB(sock_read_buffer_pool_cached_bytes, capacity);
+  } else {
+    WORKER_STAT_INCR(sock_read_buffer_pool_misses);
+    buf = ::operator new(capacity);
+  }
+  return folly::IOBuf::takeOwnership(
+      buf,
+      capacity,
+      0,
+      &ReceiveBufferPool::freeBuffer,
+      reinterpret_cast<void*>(static_cast<uintptr_t>(size_class)));
+}
+
+void ReceiveBufferPool::freeBuffer(void* buf, void* user_data) {
+  const auto size_class = reinterpret_cast<uintptr_t>(user_data);
+  ld_check(size_class < NUM_CLASSES);
+  const size_t capacity = classSize(size_class);
+  // Buffers freed on other threads, e.g. a STORE payload released by a
+  // storage thread, go back to the allocator. Buffers still cached when a
+  // worker thread exits are freed by ThreadLocalFreeList.
+  if (poolEnabled() &&
+      free_lists[size_class].put(
+          buf, Worker::settings().receive_buffer_pool_size / capacity)) {
+    WORKER_STAT_ADD(sock_read_buffer_pool_cached_bytes, capacity);
+    return;
+  }
+  ::operator delete(buf);
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,68 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include <folly/io/IOBuf.h>
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Buffers that MessageReader reads message bodies into. The body of a
+ *       RECORD, STORE or APPEND message usually outlives the message, since
+ *       the payload is a reference into it (see PayloadHolder::deserialize),
+ *       so every message costs an allocation of about its size.
+ *
+ *       Buffers of medium-sized messages come in power-of-two size classes
+ *       and are cached per worker once the last reference to them is gone,
+ *       so that the steady state of a busy socket doesn't go to the
+ *       allocator for its data. Small messages are cheap to allocate with
+ *       folly::IOBuf::create(), which puts the data next to the IOBuf, and
+ *       large ones are rare enough not to matter.
+ *
+ *       A buffer is cached by the worker that frees it, up to
+ *       Settings::receive_buffer_pool_size bytes per size class; see
+ *       ThreadLocalFreeList. Buffers freed on other threads are returned to
+ *       the allocator.
+ */
+
+class ReceiveBufferPool {
+ public:
+  // Capacities of the size classes: MIN_CLASS_SIZE, 2 * MIN_CLASS_SIZE, ...,
+  // MAX_CLASS_SIZE.
+  static constexpr size_t MIN_CLASS_SIZE = 4 * 1024;
+  static constexpr size_t NUM_CLASSES = 7;
+  static constexpr size_t MAX_CLASS_SIZE = MIN_CLASS_SIZE
+      << (NUM_CLASSES - 1);
+
+  /**
+   * @return an empty IOBuf with room for at least `size` bytes. Taken from
+   *         the pool if `size` falls into one of the size classes and this is
+   *         a worker thread with the pool enabled.
+   */
+  static std::unique_ptr<folly::IOBuf> allocate(size_t size);
+
+  /**
+   * @return index of the smallest size class that fits `size` bytes, or -1
+   *         if `size` is below MIN_CLASS_SIZE or above MAX_CLASS_SIZE
+   */
+  static int sizeClass(size_t size);
+
+  static size_t classSize(size_t size_class) {
+    return MIN_CLASS_SIZE << size_class;
+  }
+
+ private:
+  // folly::IOBuf::FreeFunction of pooled buffers. `user_data` is the size
+  // class.
+  static void freeBuffer(void* buf, void* user_data);
+};
+
+}} // namespace facebook::logdevice
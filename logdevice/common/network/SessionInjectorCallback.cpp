@@ -29,8 +29,12 @@ SessionInjectorCallback::SessionInjectorCallback(
 }
 
 void SessionInjectorCallback::connectSuccess() noexcept {
-  if (socket_->getSSLSessionReused() && found_session_) {
-    ssl_session_cache_->onSessionResumptionSuccess();
+  if (found_session_) {
+    if (socket_->getSSLSessionReused()) {
+      ssl_session_cache_->onSessionResumptionSuccess();
+    } else {
+      ssl_session_cache_->onSessionResumptionMiss();
+    }
   }
   ssl_session_cache_->setCachedSSLSession(socket_->getSSLSession());
   callback_->connectSuccess();
@@ -49,6 +49,9 @@ void APPEND_Message::serialize(ProtocolWriter& writer) const {
     proto_supported_header.flags &= ~(APPEND_Header::WRITE_STREAM_REQUEST |
                                       APPEND_Header::WRITE_STREAM_RESUME);
   }
+  if (writer.proto() < Compatibility::ProtocolVersion::E2E_LATENCY_TRACING) {
+    proto_supported_header.flags &= ~APPEND_Header::E2E_TRACED;
+  }
   writer.write(proto_supported_header);
   if (header_.flags & APPEND_Header::LSN_BEFORE_REDIRECT) {
     writer.write(lsn_before_redirect_);
@@ -95,6 +98,12 @@ void APPEND_Message::serialize(ProtocolWriter& writer) const {
     if (writer.isBlackHole()) {
       // no need to checksum anything, just add the appropriate number of bytes
       writer.write(nullptr, checksum_bits / 8);
+    } else if (payload_checksum_bits_ == checksum_bits) {
+      if (checksum_bits == 64) {
+        writer.write(payload_checksum_);
+      } else {
+        writer.write(static_cast<uint32_t>(payload_checksum_));
+      }
     } else {
       Payload payload = payload_.getPayload();
       char buf[8];
@@ -278,6 +287,7 @@ APPEND_Message::getDebugInfo() const {
     FLAG(NO_ACTIVATION)
     FLAG(CUSTOM_COUNTERS)
     FLAG(PAYLOAD_GROUP)
+    FLAG(E2E_TRACED)
 #undef FLAG
     return folly::join('|', strings);
   };
@@ -80,6 +80,10 @@ struct APPEND_Header {
   // Append contains serialized PyaloadGroup.
   static constexpr APPEND_flags_t PAYLOAD_GROUP = 1u << 23; // 8388608
 
+  // The record was sampled for end-to-end latency tracing by the client, see
+  // Settings::e2e_latency_sampling_rate. Passed through to STORE and RECORD.
+  static constexpr APPEND_flags_t E2E_TRACED = 1u << 26; // 67108864
+
   static constexpr APPEND_flags_t FORCE = NO_REDIRECT | REACTIVATE_IF_PREEMPTED;
 } __attribute__((__packed__));
 
@@ -128,6 +132,17 @@ class APPEND_Message : public Message {
 
   const APPEND_Header header_;
 
+  /**
+   * Provides the checksum of the payload, computed ahead of time (see
+   * AppendRequest::precomputeChecksum()), so that serialize() doesn't have to
+   * compute it on the Worker thread. Ignored if `bits` doesn't match the
+   * checksum flags in header_.
+   */
+  void setPayloadChecksum(int bits, uint64_t checksum) {
+    payload_checksum_bits_ = bits;
+    payload_checksum_ = checksum;
+  }
+
   virtual std::vector<std::pair<std::string, folly::dynamic>>
   getDebugInfo() const override;
 
@@ -149,6 +164,10 @@ class APPEND_Message : public Message {
   write_stream_request_id_t write_stream_request_id_ =
       WRITE_STREAM_REQUEST_ID_INVALID;
 
+  // See setPayloadChecksum(). 0 if not provided.
+  int payload_checksum_bits_ = 0;
+  uint64_t payload_checksum_ = 0;
+
   friend class ChecksumTest;
   friend class MessageSerializationTest;
   friend class E2ETracingSerializationTest;
@@ -65,17 +65,17 @@ static Status calculate_response(const Address& from,
     const size_t appends_inflight = sequencer->getNumAppendsInFlight();
     // with per-epoch sequencers, if the sequencer has not yet gotten a valid
     // epoch or all epochs are evicted, getNumAppendsInFlight() and
-    // getMaxWindowSize() will both return 0. We still want to accept this
+    // getWindowLimit() will both return 0. We still want to accept this
     // append since it may activate the sequencer.
-    if (appends_inflight > 0 &&
-        appends_inflight >= sequencer->getMaxWindowSize()) {
+    const size_t window_limit = sequencer->getWindowLimit();
+    if (appends_inflight > 0 && appends_inflight >= window_limit) {
       RATELIMIT_INFO(std::chrono::seconds(10),
                      2,
                      "Denying APPEND_PROBE from %s for log %lu because "
-                     "maximum append window size %zu has been reached",
+                     "append window size limit %zu has been reached",
                      Sender::describeConnection(from).c_str(),
                      header.logid.val(),
-                     sequencer->getMaxWindowSize());
+                     window_limit);
       return E::SEQNOBUFS;
     }
   } else {
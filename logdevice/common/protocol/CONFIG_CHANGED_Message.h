@@ -23,7 +23,10 @@ struct CONFIG_CHANGED_Header {
     // MAIN_CONFIG is deprecated.
     MAIN_CONFIG = 0,
     LOGS_CONFIG = 1,
-    NODES_CONFIGURATION = 2
+    NODES_CONFIGURATION = 2,
+    // A NodesConfigurationDiff from the version the requester sent in
+    // CONFIG_FETCH to `version`. Only sent to requesters that asked for it.
+    NODES_CONFIGURATION_DIFF = 3
   };
   enum class Action : uint8_t {
     // Used by RemoteLogsConfig to signal that current config should be
@@ -14,7 +14,9 @@
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/configuration/Configuration.h"
 #include "logdevice/common/configuration/nodes/NodesConfigurationCodec.h"
+#include "logdevice/common/configuration/nodes/NodesConfigurationHistory.h"
 #include "logdevice/common/protocol/CONFIG_CHANGED_Message.h"
+#include "logdevice/common/stats/Stats.h"
 
 namespace facebook { namespace logdevice {
 
@@ -25,12 +27,17 @@ void CONFIG_FETCH_Header::serialize(ProtocolWriter& writer) const {
     writer.write(my_version);
   }
   writer.write(config_type);
+  if (writer.proto() >=
+      Compatibility::ProtocolVersion::NODES_CONFIGURATION_DIFFS) {
+    writer.write(flags);
+  }
 }
 
 CONFIG_FETCH_Header CONFIG_FETCH_Header::deserialize(ProtocolReader& reader) {
   request_id_t rid;
   uint64_t my_version = 0;
   CONFIG_FETCH_Header::ConfigType config_type;
+  CONFIG_FETCH_Header::flags_t flags = 0;
 
   if (reader.proto() >=
       Compatibility::ProtocolVersion::RID_IN_CONFIG_MESSAGES) {
@@ -40,10 +47,16 @@ CONFIG_FETCH_Header CONFIG_FETCH_Header::deserialize(ProtocolReader& reader) {
 
   reader.read(&config_type);
 
+  if (reader.proto() >=
+      Compatibility::ProtocolVersion::NODES_CONFIGURATION_DIFFS) {
+    reader.read(&flags);
+  }
+
   return CONFIG_FETCH_Header{
       rid,
       config_type,
       my_version,
+      flags,
   };
 }
 
@@ -132,7 +145,25 @@ CONFIG_FETCH_Message::handleNodesConfigurationRequest(const Address& from) {
     // The requester already have an up to date version.
     hdr.status = Status::UPTODATE;
     msg = std::make_unique<CONFIG_CHANGED_Message>(hdr, "");
-  } else {
+  } else if ((header_.flags &
+              CONFIG_FETCH_Header::ACCEPT_NODES_CONFIGURATION_DIFF) &&
+             header_.my_version > 0) {
+    // The requester is behind. If we still know its version, only send what
+    // changed since.
+    auto history = getNodesConfigurationHistory();
+    folly::Optional<std::string> diff;
+    if (history) {
+      diff = history->getDiff(
+          membership::MembershipVersion::Type(header_.my_version), nodes_cfg);
+    }
+    if (diff.has_value()) {
+      WORKER_STAT_INCR(nodes_configuration_diffs_sent);
+      hdr.config_type =
+          CONFIG_CHANGED_Header::ConfigType::NODES_CONFIGURATION_DIFF;
+      msg = std::make_unique<CONFIG_CHANGED_Message>(hdr, std::move(*diff));
+    }
+  }
+  if (!msg) {
     auto serialized = nodes_cfg->serialize();
     if (!serialized) {
       // Failed to serialize configuration, the details should have been logged
@@ -162,6 +193,11 @@ CONFIG_FETCH_Message::getNodesConfiguration() {
   return Worker::onThisThread()->getNodesConfiguration();
 }
 
+configuration::nodes::NodesConfigurationHistory*
+CONFIG_FETCH_Message::getNodesConfigurationHistory() {
+  return Worker::onThisThread()->processor_->nodesConfigurationHistory();
+}
+
 int CONFIG_FETCH_Message::sendMessage(
     std::unique_ptr<CONFIG_CHANGED_Message> msg,
     const Address& to) {
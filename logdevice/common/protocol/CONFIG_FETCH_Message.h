@@ -13,6 +13,7 @@ namespace facebook { namespace logdevice {
 
 namespace configuration { namespace nodes {
 class NodesConfiguration;
+class NodesConfigurationHistory;
 }} // namespace configuration::nodes
 
 class Configuration;
@@ -30,11 +31,22 @@ struct CONFIG_FETCH_Header {
     NODES_CONFIGURATION = 2
   };
 
+  using flags_t = uint8_t;
+
+  // The requester can apply a NodesConfigurationDiff from `my_version` and
+  // the reply may carry one (CONFIG_CHANGED_Header::ConfigType::
+  // NODES_CONFIGURATION_DIFF) instead of the full config.
+  static constexpr flags_t ACCEPT_NODES_CONFIGURATION_DIFF = 1u << 0;
+
   CONFIG_FETCH_Header() = default;
   CONFIG_FETCH_Header(request_id_t rid,
                       ConfigType config_type,
-                      uint64_t my_version = 0)
-      : rid(rid), my_version(my_version), config_type(config_type) {}
+                      uint64_t my_version = 0,
+                      flags_t flags = 0)
+      : rid(rid),
+        my_version(my_version),
+        config_type(config_type),
+        flags(flags) {}
 
   explicit CONFIG_FETCH_Header(ConfigType config_type, uint64_t my_version = 0)
       : CONFIG_FETCH_Header(REQUEST_ID_INVALID, config_type, my_version) {}
@@ -53,10 +65,13 @@ struct CONFIG_FETCH_Header {
   // sent.
   uint64_t my_version;
   ConfigType config_type;
+
+  // Only sent with protocol >= NODES_CONFIGURATION_DIFFS.
+  flags_t flags{0};
 } __attribute__((__packed__));
 
-static_assert(sizeof(CONFIG_FETCH_Header) == 17,
-              "CONFIG_FETCH_Header is expected to be 17 byte");
+static_assert(sizeof(CONFIG_FETCH_Header) == 18,
+              "CONFIG_FETCH_Header is expected to be 18 byte");
 
 class CONFIG_FETCH_Message : public Message {
  public:
@@ -84,6 +99,9 @@ class CONFIG_FETCH_Message : public Message {
   virtual NodeID getMyNodeID() const;
   virtual std::shared_ptr<const configuration::nodes::NodesConfiguration>
   getNodesConfiguration();
+  // nullptr if this node doesn't keep a history to compute diffs from.
+  virtual configuration::nodes::NodesConfigurationHistory*
+  getNodesConfigurationHistory();
 
   virtual int sendMessage(std::unique_ptr<CONFIG_CHANGED_Message> msg,
                           const Address& to);
@@ -53,6 +53,44 @@ enum ProtocolVersion : uint16_t {
 
   GET_RSM_SNAPSHOT_MESSAGE_SUPPORT, // = 103
 
+  // RECORD and STORE payloads may be compressed on the wire, see
+  // PayloadCompression.h
+  PAYLOAD_COMPRESSION_SUPPORT, // = 104
+
+  // GOSSIP node list is varint-encoded and may only contain the entries that
+  // changed since the sender's previous GOSSIP
+  GOSSIP_DELTA_NODE_LIST, // = 105
+
+  // START_Message may carry a ServerRecordFilterType::EXPRESSION filter
+  SERVER_FILTER_EXPRESSIONS, // = 106
+
+  // READ_CONTROL messages batch WINDOW and STOP updates of many read streams
+  BATCHED_READ_CONTROL, // = 107
+
+  // MULTI_SEAL messages carry the SEALs of many logs
+  MULTI_SEAL_SUPPORT, // = 108
+
+  // MULTI_AMEND messages carry the rebuilding amends of many records
+  MULTI_AMEND_SUPPORT, // = 109
+
+  // CONFIG_FETCH has flags, and clients can ask for NodesConfiguration diffs
+  NODES_CONFIGURATION_DIFFS, // = 110
+
+  // APPEND, STORE and RECORD may have the E2E_TRACED flag
+  E2E_LATENCY_TRACING, // = 111
+
+  // DATA_SIZE_REPLY carries a bound on the error of the size estimate
+  DATA_SIZE_ERROR_BOUND, // = 112
+
+  // OffsetMaps in RECORD and STORE carry varint-encoded counter values
+  COMPACT_OFFSET_MAP, // = 113
+
+  // MULTI_RECORD messages carry many small RECORDs of one read stream
+  MULTI_RECORD_SUPPORT, // = 114
+
+  // MULTI_RELEASE messages carry the RELEASEs of many logs
+  MULTI_RELEASE_SUPPORT, // = 115
+
   // NOTE: insert new protocol versions here
 
   // Maximum version number of the protocol this version of LogDevice
@@ -77,6 +115,18 @@ static_assert(HEALTH_MONITOR_SUPPORT_IN_GOSSIP == 100, "");
 static_assert(NODE_STATUS_AND_HASHMAP_SUPPORT_IN_CLUSTER_STATE == 101, "");
 static_assert(INCLUDE_VERSIONS_IN_GOSSIP == 102, "");
 static_assert(GET_RSM_SNAPSHOT_MESSAGE_SUPPORT == 103, "");
+static_assert(PAYLOAD_COMPRESSION_SUPPORT == 104, "");
+static_assert(GOSSIP_DELTA_NODE_LIST == 105, "");
+static_assert(SERVER_FILTER_EXPRESSIONS == 106, "");
+static_assert(BATCHED_READ_CONTROL == 107, "");
+static_assert(MULTI_SEAL_SUPPORT == 108, "");
+static_assert(MULTI_AMEND_SUPPORT == 109, "");
+static_assert(NODES_CONFIGURATION_DIFFS == 110, "");
+static_assert(E2E_LATENCY_TRACING == 111, "");
+static_assert(DATA_SIZE_ERROR_BOUND == 112, "");
+static_assert(COMPACT_OFFSET_MAP == 113, "");
+static_assert(MULTI_RECORD_SUPPORT == 114, "");
+static_assert(MULTI_RELEASE_SUPPORT == 115, "");
 
 constexpr uint16_t MIN_PROTOCOL_SUPPORTED = PROTOCOL_VERSION_LOWER_BOUND + 1;
 constexpr uint16_t MAX_PROTOCOL_SUPPORTED = PROTOCOL_VERSION_UPPER_BOUND - 1;
@@ -10,21 +10,31 @@
 #include "logdevice/common/DataSizeRequest.h"
 #include "logdevice/common/Sender.h"
 #include "logdevice/common/Worker.h"
+#include "logdevice/common/protocol/Compatibility.h"
 
 namespace facebook { namespace logdevice {
 
+size_t DATA_SIZE_REPLY_Header::getExpectedSize(uint16_t proto) {
+  if (proto < Compatibility::DATA_SIZE_ERROR_BOUND) {
+    return offsetof(DATA_SIZE_REPLY_Header, error_bound);
+  }
+  return sizeof(DATA_SIZE_REPLY_Header);
+}
+
 DATA_SIZE_REPLY_Message::DATA_SIZE_REPLY_Message(
     const DATA_SIZE_REPLY_Header& header)
     : Message(MessageType::DATA_SIZE_REPLY, TrafficClass::READ_BACKLOG),
       header_(header) {}
 
 void DATA_SIZE_REPLY_Message::serialize(ProtocolWriter& writer) const {
-  writer.write(header_);
+  writer.write(
+      &header_, DATA_SIZE_REPLY_Header::getExpectedSize(writer.proto()));
 }
 
 MessageReadResult DATA_SIZE_REPLY_Message::deserialize(ProtocolReader& reader) {
   DATA_SIZE_REPLY_Header hdr;
-  reader.read(&hdr);
+  hdr.error_bound = 0;
+  reader.read(&hdr, DATA_SIZE_REPLY_Header::getExpectedSize(reader.proto()));
   return reader.result([&] { return new DATA_SIZE_REPLY_Message(hdr); });
 }
 
@@ -38,10 +48,12 @@ Message::Disposition DATA_SIZE_REPLY_Message::onReceived(const Address& from) {
     return Disposition::ERROR;
   }
 
-  ld_spew("Received DATA_SIZE_REPLY message: rqid: %lu, status=%s, size=%lu",
+  ld_spew("Received DATA_SIZE_REPLY message: rqid: %lu, status=%s, size=%lu, "
+          "error_bound=%lu",
           header_.client_rqid.val(),
           error_name(header_.status),
-          header_.size);
+          header_.size,
+          header_.error_bound);
 
   Worker* worker = Worker::onThisThread();
   auto& rqmap = worker->runningDataSize().map;
@@ -51,7 +63,8 @@ Message::Disposition DATA_SIZE_REPLY_Message::onReceived(const Address& from) {
     shard_index_t shard_idx = header_.shard;
     it->second->onReply(ShardID(from.id_.node_.index(), shard_idx),
                         header_.status,
-                        header_.size);
+                        header_.size,
+                        header_.error_bound);
   }
 
   return Disposition::NORMAL;
@@ -33,6 +33,10 @@ struct DATA_SIZE_REPLY_Header {
   size_t size;
   shard_index_t shard;
 
+  // How far `size' may be off, see PartitionedRocksDBStore::dataSize().
+  // Only sent with protocol >= DATA_SIZE_ERROR_BOUND, 0 otherwise.
+  size_t error_bound;
+
   // Return the expected size of the header given a protocol version.
   static size_t getExpectedSize(uint16_t proto);
 } __attribute__((__packed__));
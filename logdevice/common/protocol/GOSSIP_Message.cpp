@@ -7,8 +7,11 @@
  */
 #include "logdevice/common/protocol/GOSSIP_Message.h"
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 
+#include <folly/Varint.h>
 #include <folly/small_vector.h>
 
 #include "logdevice/common/Processor.h"
@@ -21,6 +24,39 @@
 
 namespace facebook { namespace logdevice {
 
+namespace {
+
+// Bits of the per-node byte in the compact node list
+constexpr uint8_t COMPACT_NODE_STARTING = 1 << 0;
+constexpr uint8_t COMPACT_NODE_HAS_FAILOVER = 1 << 1;
+// NodeHealthStatus takes the upper 4 bits
+constexpr int COMPACT_NODE_STATUS_SHIFT = 4;
+
+void writeVarint(ProtocolWriter& writer, uint64_t value) {
+  uint8_t buf[folly::kMaxVarintLength64];
+  size_t len = folly::encodeVarint(value, buf);
+  writer.write(buf, len);
+}
+
+uint64_t readVarint(ProtocolReader& reader) {
+  uint64_t value = 0;
+  for (int shift = 0; shift < 64 && reader.ok(); shift += 7) {
+    uint8_t byte = 0;
+    reader.read(&byte);
+    value |= uint64_t(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      return value;
+    }
+  }
+  if (reader.ok()) {
+    // Too many continuation bytes.
+    reader.setError(E::BADMSG);
+  }
+  return 0;
+}
+
+} // namespace
+
 GOSSIP_Message::GOSSIP_Message(NodeID this_node,
                                node_list_t node_list,
                                std::chrono::milliseconds instance_id,
@@ -52,8 +88,14 @@ Message::Disposition GOSSIP_Message::onReceived(const Address& /*from*/) {
 
 void GOSSIP_Message::serialize(ProtocolWriter& writer) const {
   auto flags = flags_;
+  const bool compact =
+      writer.proto() >= Compatibility::ProtocolVersion::GOSSIP_DELTA_NODE_LIST;
+  ld_check(changed_.empty() || changed_.size() == node_list_.size());
+  const bool delta = compact && !changed_.empty();
 
-  writer.write((uint16_t)node_list_.size());
+  writer.write(uint16_t(
+      delta ? std::count(changed_.begin(), changed_.end(), true)
+            : node_list_.size()));
   writer.write(gossip_node_);
   writer.write(flags);
   writer.write(instance_id_);
@@ -71,7 +113,11 @@ void GOSSIP_Message::serialize(ProtocolWriter& writer) const {
                    });
     writer.writeVector(legacy_node_list);
   } else {
-    writer.writeVector(node_list_);
+    if (compact) {
+      writeCompactNodeList(writer, delta);
+    } else {
+      writer.writeVector(node_list_);
+    }
     if (flags & HAS_IN_MEM_VERSIONS || flags & HAS_DURABLE_SNAPSHOT_VERSIONS) {
       writeVersions(writer);
     }
@@ -105,7 +151,12 @@ MessageReadResult GOSSIP_Message::deserialize(ProtocolReader& reader) {
                      return GOSSIP_Node{gossip_node};
                    });
   } else {
-    reader.readVector(&msg->node_list_, num_nodes);
+    if (reader.proto() >=
+        Compatibility::ProtocolVersion::GOSSIP_DELTA_NODE_LIST) {
+      msg->readCompactNodeList(reader, num_nodes);
+    } else {
+      reader.readVector(&msg->node_list_, num_nodes);
+    }
     if (msg->flags_ & HAS_IN_MEM_VERSIONS ||
         msg->flags_ & HAS_DURABLE_SNAPSHOT_VERSIONS) {
       // For future compatibility deserialize messages with durable flag.
@@ -170,6 +221,74 @@ void GOSSIP_Message::readBoycottDurations(ProtocolReader& reader) {
   }
 }
 
+void GOSSIP_Message::writeCompactNodeList(ProtocolWriter& writer,
+                                          bool delta) const {
+  node_list_flags_t list_flags = delta ? NODE_LIST_IS_DELTA : 0;
+  writer.write(list_flags);
+
+  for (size_t i = 0; i < node_list_.size(); ++i) {
+    if (delta && !changed_[i]) {
+      continue;
+    }
+    const GOSSIP_Node& node = node_list_[i];
+    const bool has_failover = node.failover_.count() != 0;
+    uint8_t bits = uint8_t(node.node_status_) << COMPACT_NODE_STATUS_SHIFT;
+    if (node.is_node_starting_) {
+      bits |= COMPACT_NODE_STARTING;
+    }
+    if (has_failover) {
+      bits |= COMPACT_NODE_HAS_FAILOVER;
+    }
+
+    writeVarint(writer, node.node_id_);
+    writer.write(bits);
+    writeVarint(writer, node.gossip_);
+    // Most instance ids are close to the sender's own, and a failover time,
+    // if any, is the instance id of the node that requested it.
+    writeVarint(writer,
+                folly::encodeZigZag((node.gossip_ts_ - instance_id_).count()));
+    if (has_failover) {
+      writeVarint(
+          writer,
+          folly::encodeZigZag((node.failover_ - node.gossip_ts_).count()));
+    }
+  }
+}
+
+void GOSSIP_Message::readCompactNodeList(ProtocolReader& reader,
+                                         uint16_t num_nodes) {
+  node_list_flags_t list_flags = 0;
+  reader.read(&list_flags);
+  is_delta_ = list_flags & NODE_LIST_IS_DELTA;
+
+  node_list_.resize(num_nodes);
+  for (auto& node : node_list_) {
+    node.node_id_ = readVarint(reader);
+    uint8_t bits = 0;
+    reader.read(&bits);
+    const uint64_t gossip = readVarint(reader);
+    node.gossip_ts_ = instance_id_ +
+        std::chrono::milliseconds(folly::decodeZigZag(readVarint(reader)));
+    node.failover_ = std::chrono::milliseconds::zero();
+    if (bits & COMPACT_NODE_HAS_FAILOVER) {
+      node.failover_ = node.gossip_ts_ +
+          std::chrono::milliseconds(folly::decodeZigZag(readVarint(reader)));
+    }
+    node.is_node_starting_ = bits & COMPACT_NODE_STARTING;
+    const uint8_t status = bits >> COMPACT_NODE_STATUS_SHIFT;
+    if (!reader.ok()) {
+      break;
+    }
+    if (gossip > std::numeric_limits<uint32_t>::max() ||
+        status > NodeHealthStatus::UNHEALTHY) {
+      reader.setError(E::BADMSG);
+      break;
+    }
+    node.gossip_ = gossip;
+    node.node_status_ = NodeHealthStatus(status);
+  }
+}
+
 void GOSSIP_Message::writeVersions(ProtocolWriter& writer) const {
   if (writer.proto() <
       Compatibility::ProtocolVersion::INCLUDE_VERSIONS_IN_GOSSIP) {
@@ -183,6 +302,14 @@ void GOSSIP_Message::writeVersions(ProtocolWriter& writer) const {
     writer.write(rsm_type);
   }
 
+  if (writer.proto() >=
+      Compatibility::ProtocolVersion::GOSSIP_DELTA_NODE_LIST) {
+    // The node list may be a delta, so it doesn't tell how many entries
+    // follow.
+    ld_check(versions_.size() <= UINT16_MAX);
+    writer.write(uint16_t(versions_.size()));
+  }
+
   for (const auto& node : versions_) {
     writer.write(node.node_id_);
     ld_check(node.rsm_versions_.size() == num_rsms_);
@@ -214,6 +341,14 @@ void GOSSIP_Message::readVersions(ProtocolReader& reader, uint16_t num_nodes) {
     reader.read(&rsm_types_[i]);
   }
 
+  if (reader.proto() >=
+      Compatibility::ProtocolVersion::GOSSIP_DELTA_NODE_LIST) {
+    reader.read(&num_nodes);
+  }
+  if (!reader.ok()) {
+    return;
+  }
+
   versions_.resize(num_nodes);
   for (size_t i = 0; i < num_nodes; ++i) {
     reader.read(&versions_[i].node_id_);
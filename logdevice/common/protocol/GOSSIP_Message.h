@@ -126,6 +126,16 @@ class GOSSIP_Message : public Message {
   // RSM and NCM versions
   versions_node_list_t versions_;
 
+  // Sender side. If not empty, has one element per entry of node_list_, and
+  // only the entries marked here are sent to peers that support
+  // Compatibility::GOSSIP_DELTA_NODE_LIST. Older peers get the whole list.
+  // Not serialized.
+  std::vector<bool> changed_;
+
+  // Receiver side. True if the sender omitted the entries that didn't change
+  // since its previous GOSSIP, so node_list_ may not cover the whole cluster.
+  bool is_delta_{false};
+
   // When set in flags_, indicates that the message includes the failover list.
   static const GOSSIP_flags_t HAS_FAILOVER_LIST_FLAG = 1 << 0;
 
@@ -185,5 +195,15 @@ class GOSSIP_Message : public Message {
   // Read and Write RSM and NCM versions
   void readVersions(ProtocolReader& reader, uint16_t num_nodes);
   void writeVersions(ProtocolWriter& writer) const;
+
+  // Compact encoding of the node list used with protocol
+  // >= GOSSIP_DELTA_NODE_LIST: integers are varints, instance ids and
+  // failover times are written as differences from a nearby value.
+  void writeCompactNodeList(ProtocolWriter& writer, bool delta) const;
+  void readCompactNodeList(ProtocolReader& reader, uint16_t num_nodes);
+
+  // Flags of the compact node list
+  using node_list_flags_t = uint8_t;
+  static const node_list_flags_t NODE_LIST_IS_DELTA = 1 << 0;
 };
 }} // namespace facebook::logdevice
@@ -26,6 +26,7 @@
 #include "logdevice/common/protocol/Compatibility.h"
 #include "logdevice/common/protocol/ProtocolReader.h"
 #include "logdevice/common/protocol/ProtocolWriter.h"
+#include "logdevice/common/stats/Stats.h"
 #include "logdevice/include/Err.h"
 
 namespace facebook { namespace logdevice {
@@ -456,6 +457,10 @@ Message::Disposition HELLO_Message::onReceived(const Address& from) {
     }
   }
 
+  if (ackhdr.status == E::OK && !(header_.flags & HELLO_Header::SOURCE_NODE)) {
+    CLIENT_RESOURCE_ADD(Worker::stats(), connections, &principal, 1);
+  }
+
   return sendReply(ackhdr,
                    from,
                    !(header_.flags & HELLO_Header::SOURCE_NODE),
@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/protocol/MULTI_AMEND_Message.h"
+
+#include <string>
+
+#include "logdevice/common/protocol/Compatibility.h"
+#include "logdevice/common/protocol/ProtocolReader.h"
+#include "logdevice/common/protocol/ProtocolWriter.h"
+
+namespace facebook { namespace logdevice {
+
+MULTI_AMEND_Message::MULTI_AMEND_Message(
+    std::vector<std::unique_ptr<STORE_Message>> stores)
+    : Message(MessageType::MULTI_AMEND, TrafficClass::REBUILD),
+      stores_(std::move(stores)) {}
+
+void MULTI_AMEND_Message::serialize(ProtocolWriter& writer) const {
+  // A STORE message takes whatever follows its header as payload, so each
+  // entry is serialized separately and length-prefixed.
+  uint32_t count = stores_.size();
+  writer.write(count);
+  std::string buf;
+  for (const auto& store : stores_) {
+    ld_check(store->getHeader().flags & STORE_Header::AMEND);
+    buf.clear();
+    ProtocolWriter store_writer(&buf, "MULTI_AMEND", writer.proto());
+    store->serialize(store_writer);
+    if (store_writer.error()) {
+      writer.setError(store_writer.status());
+      return;
+    }
+    writer.writeLengthPrefixedVector(buf);
+  }
+}
+
+MessageReadResult MULTI_AMEND_Message::deserialize(ProtocolReader& reader) {
+  uint32_t count = 0;
+  reader.read(&count);
+  if (reader.ok() && count > MAX_ENTRIES) {
+    ld_error("Bad MULTI_AMEND message: %u entries, max is %lu",
+             count,
+             MAX_ENTRIES);
+    return reader.errorResult(E::BADMSG);
+  }
+
+  std::vector<std::unique_ptr<STORE_Message>> stores;
+  stores.reserve(count);
+  std::string buf;
+  for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+    buf.clear();
+    reader.readLengthPrefixedVector(&buf);
+    if (!reader.ok()) {
+      break;
+    }
+    ProtocolReader store_reader(Slice(buf.data(), buf.size()),
+                                "MULTI_AMEND",
+                                reader.proto());
+    MessageReadResult res = STORE_Message::deserialize(store_reader);
+    if (!res.msg) {
+      reader.setError(err);
+      break;
+    }
+    auto store = std::unique_ptr<STORE_Message>(
+        static_cast<STORE_Message*>(res.msg.release()));
+    if (!(store->getHeader().flags & STORE_Header::AMEND)) {
+      ld_error("Bad MULTI_AMEND message: entry for %s is not an amend",
+               store->getHeader().rid.toString().c_str());
+      reader.setError(E::BADMSG);
+      break;
+    }
+    stores.push_back(std::move(store));
+  }
+
+  return reader.result(
+      [&] { return new MULTI_AMEND_Message(std::move(stores)); });
+}
+
+uint16_t MULTI_AMEND_Message::getMinProtocolVersion() const {
+  return Compatibility::MULTI_AMEND_SUPPORT;
+}
+
+}} // namespace facebook::logdevice
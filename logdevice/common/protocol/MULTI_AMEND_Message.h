@@ -0,0 +1,72 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "logdevice/common/protocol/Message.h"
+#include "logdevice/common/protocol/STORE_Message.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file MULTI_AMEND is sent by rebuilding donors to a storage node instead of
+ *       many STORE messages with the AMEND flag. It carries the amends that
+ *       record rebuildings of any logs running on one worker issued for that
+ *       node during one event loop iteration. Amends have no payload, so
+ *       per-message overhead dominates their cost. The storage node handles
+ *       each entry as if it had received it in a STORE message, and replies
+ *       to each with a STORED message.
+ */
+
+class MULTI_AMEND_Message : public Message {
+ public:
+  explicit MULTI_AMEND_Message(
+      std::vector<std::unique_ptr<STORE_Message>> stores);
+
+  MULTI_AMEND_Message(MULTI_AMEND_Message&&) noexcept = delete;
+  MULTI_AMEND_Message& operator=(const MULTI_AMEND_Message&) = delete;
+  MULTI_AMEND_Message& operator=(MULTI_AMEND_Message&&) = delete;
+
+  int8_t getExecutorPriority() const override {
+    return folly::Executor::LO_PRI;
+  }
+
+  // see Message.h
+  void serialize(ProtocolWriter&) const override;
+  void onSent(Status, const Address& /* to */) const override {
+    // Handler lives in MULTI_AMEND_onSent() on the server. This should never
+    // get called.
+    std::abort();
+  }
+  Disposition onReceived(const Address&) override {
+    // Receipt handler lives in
+    // server/message_handlers/MULTI_AMEND_onReceived.cpp; this should never
+    // get called.
+    std::abort();
+  }
+  uint16_t getMinProtocolVersion() const override;
+  static Message::deserializer_t deserialize;
+
+  const std::vector<std::unique_ptr<STORE_Message>>& getStores() const {
+    return stores_;
+  }
+  std::vector<std::unique_ptr<STORE_Message>>& getStores() {
+    return stores_;
+  }
+
+  // Maximum number of amends senders put in one message.
+  static constexpr size_t MAX_ENTRIES = 1024;
+
+ private:
+  std::vector<std::unique_ptr<STORE_Message>> stores_;
+};
+
+}} // namespace facebook::logdevice
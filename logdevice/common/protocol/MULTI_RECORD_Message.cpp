@@ -0,0 +1,92 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/protocol/MULTI_RECORD_Message.h"
+
+#include <string>
+
+#include "logdevice/common/protocol/Compatibility.h"
+#include "logdevice/common/protocol/ProtocolReader.h"
+#include "logdevice/common/protocol/ProtocolWriter.h"
+
+namespace facebook { namespace logdevice {
+
+MULTI_RECORD_Message::MULTI_RECORD_Message(
+    std::vector<std::unique_ptr<RECORD_Message>> records,
+    TrafficClass tc)
+    : Message(MessageType::MULTI_RECORD, tc), records_(std::move(records)) {}
+
+void MULTI_RECORD_Message::serialize(ProtocolWriter& writer) const {
+  // A RECORD message takes whatever follows its header as payload, so each
+  // entry is serialized separately and length-prefixed.
+  uint32_t count = records_.size();
+  writer.write(count);
+  std::string buf;
+  for (const auto& record : records_) {
+    buf.clear();
+    ProtocolWriter record_writer(&buf, "MULTI_RECORD", writer.proto());
+    record->serialize(record_writer);
+    if (record_writer.error()) {
+      writer.setError(record_writer.status());
+      return;
+    }
+    writer.writeLengthPrefixedVector(buf);
+  }
+}
+
+MessageReadResult MULTI_RECORD_Message::deserialize(ProtocolReader& reader) {
+  uint32_t count = 0;
+  reader.read(&count);
+  if (reader.ok() && count > MAX_ENTRIES) {
+    ld_error("Bad MULTI_RECORD message: %u entries, max is %lu",
+             count,
+             MAX_ENTRIES);
+    return reader.errorResult(E::BADMSG);
+  }
+
+  std::vector<std::unique_ptr<RECORD_Message>> records;
+  records.reserve(count);
+  std::string buf;
+  for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+    buf.clear();
+    reader.readLengthPrefixedVector(&buf);
+    if (!reader.ok()) {
+      break;
+    }
+    ProtocolReader record_reader(Slice(buf.data(), buf.size()),
+                                 "MULTI_RECORD",
+                                 reader.proto());
+    MessageReadResult res = RECORD_Message::deserialize(record_reader);
+    if (!res.msg) {
+      reader.setError(err);
+      break;
+    }
+    records.emplace_back(static_cast<RECORD_Message*>(res.msg.release()));
+  }
+
+  TrafficClass tc =
+      records.empty() ? TrafficClass::READ_TAIL : records.front()->tc_;
+  return reader.result(
+      [&] { return new MULTI_RECORD_Message(std::move(records), tc); });
+}
+
+Message::Disposition MULTI_RECORD_Message::onReceived(const Address& from) {
+  for (auto& record : records_) {
+    Disposition disposition = record->onReceived(from);
+    if (disposition == Disposition::ERROR) {
+      return disposition;
+    }
+    ld_check(disposition == Disposition::NORMAL);
+  }
+  return Disposition::NORMAL;
+}
+
+uint16_t MULTI_RECORD_Message::getMinProtocolVersion() const {
+  return Compatibility::MULTI_RECORD_SUPPORT;
+}
+
+}} // namespace facebook::logdevice
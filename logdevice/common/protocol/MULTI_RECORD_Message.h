@@ -0,0 +1,62 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "logdevice/common/protocol/Message.h"
+#include "logdevice/common/protocol/RECORD_Message.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file MULTI_RECORD is sent by storage nodes to readers instead of a run of
+ *       RECORD messages for small records of the same read stream that are
+ *       read back to back. For records of a few hundred bytes the protocol
+ *       header and per-message processing cost as much as the payload. The
+ *       reader handles each entry as if it had received it in a RECORD
+ *       message, in order.
+ */
+
+class MULTI_RECORD_Message : public Message {
+ public:
+  MULTI_RECORD_Message(std::vector<std::unique_ptr<RECORD_Message>> records,
+                       TrafficClass tc);
+
+  MULTI_RECORD_Message(MULTI_RECORD_Message&&) noexcept = delete;
+  MULTI_RECORD_Message& operator=(const MULTI_RECORD_Message&) = delete;
+  MULTI_RECORD_Message& operator=(MULTI_RECORD_Message&&) = delete;
+
+  // see Message.h
+  void serialize(ProtocolWriter&) const override;
+  void onSent(Status, const Address& /* to */) const override {
+    // Handler lives in MULTI_RECORD_onSent() on the server. This should never
+    // get called.
+    std::abort();
+  }
+  Disposition onReceived(const Address& from) override;
+  uint16_t getMinProtocolVersion() const override;
+  static Message::deserializer_t deserialize;
+
+  const std::vector<std::unique_ptr<RECORD_Message>>& getRecords() const {
+    return records_;
+  }
+  std::vector<std::unique_ptr<RECORD_Message>>& getRecords() {
+    return records_;
+  }
+
+  // Maximum number of records senders put in one message.
+  static constexpr size_t MAX_ENTRIES = 1024;
+
+ private:
+  std::vector<std::unique_ptr<RECORD_Message>> records_;
+};
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,56 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/protocol/MULTI_RELEASE_Message.h"
+
+#include <cstdlib>
+
+#include "logdevice/common/protocol/ProtocolReader.h"
+#include "logdevice/common/protocol/ProtocolWriter.h"
+
+namespace facebook { namespace logdevice {
+
+MULTI_RELEASE_Message::MULTI_RELEASE_Message(
+    std::vector<RELEASE_Header> releases)
+    : Message(MessageType::MULTI_RELEASE, TrafficClass::READ_TAIL),
+      releases_(std::move(releases)) {}
+
+void MULTI_RELEASE_Message::serialize(ProtocolWriter& writer) const {
+  writer.writeLengthPrefixedVector(releases_);
+}
+
+MessageReadResult MULTI_RELEASE_Message::deserialize(ProtocolReader& reader) {
+  std::vector<RELEASE_Header> releases;
+  reader.readLengthPrefixedVector(&releases);
+  return reader.result(
+      [&] { return new MULTI_RELEASE_Message(std::move(releases)); });
+}
+
+Message::Disposition
+MULTI_RELEASE_Message::onReceived(const Address& /*from*/) {
+  // Receipt handler lives in PurgeCoordinator::onReceived(); this should
+  // never get called.
+  std::abort();
+}
+
+void MULTI_RELEASE_Message::onSent(Status status, const Address& to) const {
+  if (status == E::PROTONOSUPPORT) {
+    // The connection was reestablished with a node that doesn't know
+    // MULTI_RELEASE. Have the sequencers retry; ReleaseBatcher will see the
+    // new protocol version and send plain RELEASEs.
+    status = E::FAILED;
+  }
+  for (const RELEASE_Header& header : releases_) {
+    RELEASE_Message::onReleaseSent(header, status, to);
+  }
+}
+
+uint16_t MULTI_RELEASE_Message::getMinProtocolVersion() const {
+  return Compatibility::MULTI_RELEASE_SUPPORT;
+}
+
+}} // namespace facebook::logdevice
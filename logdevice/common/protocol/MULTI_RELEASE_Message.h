@@ -0,0 +1,53 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <vector>
+
+#include "logdevice/common/protocol/Message.h"
+#include "logdevice/common/protocol/RELEASE_Message.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file MULTI_RELEASE is sent by sequencer nodes to a storage node instead of
+ *       many RELEASE messages. It carries the periodic and post-recovery
+ *       RELEASEs that the sequencers of one worker issued for that node during
+ *       one event loop iteration. With many logs per sequencer node, these
+ *       otherwise make up most of the RELEASE traffic at low append rates. The
+ *       storage node handles each of them as if it had received a RELEASE
+ *       message, and wakes up the read streams of all of them at once.
+ */
+
+class MULTI_RELEASE_Message : public Message {
+ public:
+  explicit MULTI_RELEASE_Message(std::vector<RELEASE_Header> releases);
+
+  MULTI_RELEASE_Message(MULTI_RELEASE_Message&&) noexcept = delete;
+  MULTI_RELEASE_Message& operator=(const MULTI_RELEASE_Message&) = delete;
+  MULTI_RELEASE_Message& operator=(MULTI_RELEASE_Message&&) = delete;
+
+  // see Message.h
+  void serialize(ProtocolWriter&) const override;
+  void onSent(Status st, const Address& to) const override;
+  Disposition onReceived(const Address&) override;
+  uint16_t getMinProtocolVersion() const override;
+  static Message::deserializer_t deserialize;
+
+  const std::vector<RELEASE_Header>& getReleases() const {
+    return releases_;
+  }
+
+  // Maximum number of RELEASEs senders put in one message.
+  static constexpr size_t MAX_ENTRIES = 1024;
+
+ private:
+  std::vector<RELEASE_Header> releases_;
+};
+
+}} // namespace facebook::logdevice
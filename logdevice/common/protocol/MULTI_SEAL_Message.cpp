@@ -0,0 +1,58 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/protocol/MULTI_SEAL_Message.h"
+
+#include <cstdlib>
+
+#include "logdevice/common/LogRecoveryRequest.h"
+#include "logdevice/common/Worker.h"
+#include "logdevice/common/protocol/ProtocolReader.h"
+#include "logdevice/common/protocol/ProtocolWriter.h"
+
+namespace facebook { namespace logdevice {
+
+MULTI_SEAL_Message::MULTI_SEAL_Message(std::vector<SEAL_Header> seals)
+    : Message(MessageType::MULTI_SEAL, TrafficClass::RECOVERY),
+      seals_(std::move(seals)) {}
+
+void MULTI_SEAL_Message::serialize(ProtocolWriter& writer) const {
+  writer.writeLengthPrefixedVector(seals_);
+}
+
+MessageReadResult MULTI_SEAL_Message::deserialize(ProtocolReader& reader) {
+  std::vector<SEAL_Header> seals;
+  reader.readLengthPrefixedVector(&seals);
+  return reader.result(
+      [&] { return new MULTI_SEAL_Message(std::move(seals)); });
+}
+
+Message::Disposition MULTI_SEAL_Message::onReceived(const Address& /*from*/) {
+  // Receipt handler lives in server/message_handlers/MULTI_SEAL_onReceived.cpp;
+  // this should never get called.
+  std::abort();
+}
+
+void MULTI_SEAL_Message::onSent(Status status, const Address& to) const {
+  auto& rqmap = Worker::onThisThread()->runningLogRecoveries().map;
+  for (const SEAL_Header& header : seals_) {
+    auto it = rqmap.find(header.log_id);
+    if (it == rqmap.end()) {
+      continue;
+    }
+    ld_check(header.shard != -1);
+    it->second->onSealMessageSent(ShardID(to.id_.node_.index(), header.shard),
+                                  header.seal_epoch,
+                                  status);
+  }
+}
+
+uint16_t MULTI_SEAL_Message::getMinProtocolVersion() const {
+  return Compatibility::MULTI_SEAL_SUPPORT;
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,52 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <vector>
+
+#include "logdevice/common/protocol/Message.h"
+#include "logdevice/common/protocol/SEAL_Message.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file MULTI_SEAL is sent by sequencer nodes to a storage node instead of
+ *       many SEAL messages. It carries the SEALs that log recoveries running
+ *       on one worker issued for that node during one event loop iteration,
+ *       typically right after the node activated a large number of
+ *       sequencers. The storage node handles each of them as if it had
+ *       received a SEAL message, and replies to each with a SEALED message.
+ */
+
+class MULTI_SEAL_Message : public Message {
+ public:
+  explicit MULTI_SEAL_Message(std::vector<SEAL_Header> seals);
+
+  MULTI_SEAL_Message(MULTI_SEAL_Message&&) noexcept = delete;
+  MULTI_SEAL_Message& operator=(const MULTI_SEAL_Message&) = delete;
+  MULTI_SEAL_Message& operator=(MULTI_SEAL_Message&&) = delete;
+
+  // see Message.h
+  void serialize(ProtocolWriter&) const override;
+  void onSent(Status st, const Address& to) const override;
+  Disposition onReceived(const Address&) override;
+  uint16_t getMinProtocolVersion() const override;
+  static Message::deserializer_t deserialize;
+
+  const std::vector<SEAL_Header>& getSeals() const {
+    return seals_;
+  }
+
+  // Maximum number of SEALs senders put in one message.
+  static constexpr size_t MAX_ENTRIES = 1024;
+
+ private:
+  std::vector<SEAL_Header> seals_;
+};
+
+}} // namespace facebook::logdevice
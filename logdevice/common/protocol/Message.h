@@ -11,6 +11,7 @@
 #include <limits>
 
 #include <folly/Executor.h>
+#include <folly/Optional.h>
 #include <folly/dynamic.h>
 
 #include "logdevice/common/PriorityMap.h"
@@ -70,6 +71,16 @@ struct Message {
     return folly::Executor::MID_PRI;
   }
 
+  /**
+   * Messages that only need to stay ordered relative to other messages for
+   * the same log return that log here. Sender is then free to send them to a
+   * node over any of several connections, picking one by log id. See
+   * Settings::data_connection_stripes.
+   */
+  virtual folly::Optional<logid_t> getStripeKey() const {
+    return folly::none;
+  }
+
   /**
    * Calculates how much space the message will take when transmitted,
    * including the protocol header.
@@ -45,11 +45,16 @@
 #include "logdevice/common/protocol/LOGS_CONFIG_API_Message.h"
 #include "logdevice/common/protocol/LOGS_CONFIG_API_REPLY_Message.h"
 #include "logdevice/common/protocol/MEMTABLE_FLUSHED_Message.h"
+#include "logdevice/common/protocol/MULTI_AMEND_Message.h"
+#include "logdevice/common/protocol/MULTI_RECORD_Message.h"
+#include "logdevice/common/protocol/MULTI_RELEASE_Message.h"
+#include "logdevice/common/protocol/MULTI_SEAL_Message.h"
 #include "logdevice/common/protocol/MUTATED_Message.h"
 #include "logdevice/common/protocol/NODE_STATS_AGGREGATE_Message.h"
 #include "logdevice/common/protocol/NODE_STATS_AGGREGATE_REPLY_Message.h"
 #include "logdevice/common/protocol/NODE_STATS_Message.h"
 #include "logdevice/common/protocol/NODE_STATS_REPLY_Message.h"
+#include "logdevice/common/protocol/READ_CONTROL_Message.h"
 #include "logdevice/common/protocol/RECORD_Message.h"
 #include "logdevice/common/protocol/RELEASE_Message.h"
 #include "logdevice/common/protocol/SEALED_Message.h"
@@ -0,0 +1,155 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/protocol/PayloadCompression.h"
+
+#include <algorithm>
+
+#include <lz4.h>
+#include <lz4hc.h>
+#include <zstd.h>
+
+#include "logdevice/common/debug.h"
+#include "logdevice/common/protocol/Compatibility.h"
+#include "logdevice/common/protocol/Message.h"
+
+namespace facebook { namespace logdevice { namespace payload_compression {
+
+folly::Optional<folly::IOBuf> compress(const ProtocolWriter& writer,
+                                       const PayloadHolder& payload) {
+  const PayloadCompressionOptions& options = writer.payloadCompression();
+  if (options.compression == Compression::NONE ||
+      writer.proto() <
+          Compatibility::ProtocolVersion::PAYLOAD_COMPRESSION_SUPPORT ||
+      payload.size() < std::max<size_t>(options.min_size, 1)) {
+    return folly::none;
+  }
+  ld_check(options.compression == Compression::ZSTD ||
+           options.compression == Compression::LZ4 ||
+           options.compression == Compression::LZ4_HC);
+
+  const Payload p = payload.getPayload();
+  const size_t bound = options.compression == Compression::ZSTD
+      ? ZSTD_compressBound(p.size())
+      : LZ4_compressBound(p.size());
+  folly::IOBuf buf(folly::IOBuf::CREATE, sizeof(Header) + bound);
+  uint8_t* out = buf.writableTail() + sizeof(Header);
+
+  size_t compressed_size;
+  if (options.compression == Compression::ZSTD) {
+    ld_check(options.zstd_level > 0);
+    compressed_size =
+        ZSTD_compress(out, bound, p.data(), p.size(), options.zstd_level);
+    if (ZSTD_isError(compressed_size)) {
+      RATELIMIT_ERROR(std::chrono::seconds(10),
+                      2,
+                      "ZSTD_compress() failed: %s",
+                      ZSTD_getErrorName(compressed_size));
+      return folly::none;
+    }
+  } else {
+    const char* src = static_cast<const char*>(p.data());
+    char* dst = reinterpret_cast<char*>(out);
+    int rv = options.compression == Compression::LZ4
+        ? LZ4_compress_default(src, dst, p.size(), bound)
+        : LZ4_compress_HC(src, dst, p.size(), bound, 0);
+    if (rv <= 0) {
+      RATELIMIT_ERROR(
+          std::chrono::seconds(10), 2, "LZ4_compress() returned %d", rv);
+      return folly::none;
+    }
+    compressed_size = rv;
+  }
+
+  if (sizeof(Header) + compressed_size >= p.size()) {
+    // Not worth it.
+    return folly::none;
+  }
+
+  Header header{static_cast<uint8_t>(options.compression),
+                static_cast<uint32_t>(p.size())};
+  memcpy(buf.writableTail(), &header, sizeof(Header));
+  buf.append(sizeof(Header) + compressed_size);
+  return std::move(buf);
+}
+
+folly::Optional<folly::IOBuf>
+CompressedPayloadCache::compress(const ProtocolWriter& writer,
+                                 const PayloadHolder& payload) {
+  const PayloadCompressionOptions& options = writer.payloadCompression();
+  if (writer.proto() <
+      Compatibility::ProtocolVersion::PAYLOAD_COMPRESSION_SUPPORT) {
+    // Doesn't depend on the payload, not worth caching.
+    return folly::none;
+  }
+  if (!valid_ || options_.compression != options.compression ||
+      options_.zstd_level != options.zstd_level ||
+      options_.min_size != options.min_size) {
+    compressed_ = payload_compression::compress(writer, payload);
+    options_ = options;
+    valid_ = true;
+  }
+  if (!compressed_.hasValue()) {
+    return folly::none;
+  }
+  // Shares the buffer.
+  return compressed_->cloneAsValue();
+}
+
+std::unique_ptr<ProtocolReader> read(ProtocolReader& reader, MessageType type) {
+  Header header;
+  reader.read(&header);
+  const size_t compressed_size = reader.bytesRemaining();
+  if (reader.ok() && compressed_size == 0) {
+    reader.setError(E::BADMSG);
+  }
+  folly::IOBuf compressed;
+  reader.readIOBuf(&compressed, compressed_size);
+  if (reader.error()) {
+    return nullptr;
+  }
+  compressed.coalesce();
+
+  const size_t size = header.uncompressed_size;
+  bool ok = size > 0 && size < Message::MAX_LEN;
+  auto buf = folly::IOBuf::create(ok ? size : 0);
+  const auto compression = static_cast<Compression>(header.compression);
+  if (!ok) {
+    // Checked below.
+  } else if (compression == Compression::ZSTD) {
+    size_t rv = ZSTD_decompress(
+        buf->writableData(), size, compressed.data(), compressed.length());
+    ok = !ZSTD_isError(rv) && rv == size;
+  } else if (compression == Compression::LZ4 ||
+             compression == Compression::LZ4_HC) {
+    int rv = LZ4_decompress_safe(
+        reinterpret_cast<const char*>(compressed.data()),
+        reinterpret_cast<char*>(buf->writableData()),
+        compressed.length(),
+        size);
+    ok = rv >= 0 && static_cast<size_t>(rv) == size;
+  } else {
+    ok = false;
+  }
+
+  if (!ok) {
+    RATELIMIT_ERROR(std::chrono::seconds(10),
+                    2,
+                    "Malformed compressed payload in a %s message: "
+                    "compression %u, %zu bytes compressed, %zu uncompressed",
+                    messageTypeNames()[type].c_str(),
+                    header.compression,
+                    compressed.length(),
+                    size);
+    reader.setError(E::BADMSG);
+    return nullptr;
+  }
+  buf->append(size);
+  return std::make_unique<ProtocolReader>(type, std::move(buf), reader.proto());
+}
+
+}}} // namespace facebook::logdevice::payload_compression
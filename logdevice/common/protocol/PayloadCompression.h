@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <memory>
+
+#include <folly/Optional.h>
+#include <folly/io/IOBuf.h>
+
+#include "logdevice/common/PayloadHolder.h"
+#include "logdevice/common/protocol/ProtocolReader.h"
+#include "logdevice/common/protocol/ProtocolWriter.h"
+
+namespace facebook { namespace logdevice { namespace payload_compression {
+
+/**
+ * @file Wire compression of RECORD and STORE payloads.
+ *
+ *       The payload is the last thing in both messages. A compressed payload
+ *       is written as a Header followed by the compressed bytes up to the end
+ *       of the message, and the message sets its PAYLOAD_COMPRESSED flag.
+ *       This is independent of BufferedWriter compression, which is part of
+ *       the record as stored; here the receiver gets back the exact bytes the
+ *       sender had.
+ *
+ *       The sending Connection picks the compression per message (see
+ *       Settings::network_payload_compression), and it is only used for peers
+ *       that negotiated Compatibility::PAYLOAD_COMPRESSION_SUPPORT or newer
+ *       in HELLO/ACK.
+ */
+
+struct Header {
+  // Compression, as uint8_t.
+  uint8_t compression;
+  // Size of the payload after uncompressing it.
+  uint32_t uncompressed_size;
+} __attribute__((__packed__));
+
+/**
+ * Compresses `payload` according to writer.payloadCompression().
+ *
+ * @return  Header and compressed payload, ready to be written after the
+ *          message header. folly::none if the payload should be sent as is:
+ *          compression is disabled, the peer doesn't support it, the payload
+ *          is too small or compressing it doesn't save space.
+ */
+folly::Optional<folly::IOBuf> compress(const ProtocolWriter& writer,
+                                       const PayloadHolder& payload);
+
+/**
+ * Memoizes compress() for a payload that is sent in several messages, e.g.
+ * the STOREs of one record to each of its recipients.  The payload is only
+ * compressed for the first of them; the others get the same buffer (shared,
+ * not copied) as long as they're serialized with the same options.
+ *
+ * Not thread-safe.  All messages sharing a cache must be serialized on the
+ * same thread, and the payload must not change in the meantime.
+ */
+class CompressedPayloadCache {
+ public:
+  // Same as payload_compression::compress(writer, payload), see above.
+  folly::Optional<folly::IOBuf> compress(const ProtocolWriter& writer,
+                                         const PayloadHolder& payload);
+
+ private:
+  bool valid_ = false;
+  // Options the cached result was computed with.
+  PayloadCompressionOptions options_;
+  folly::Optional<folly::IOBuf> compressed_;
+};
+
+/**
+ * Reads the rest of the message from `reader` as a compressed payload and
+ * uncompresses it.
+ *
+ * @return  a reader over the uncompressed payload, from which the message
+ *          reads its payload the same way it would from `reader` if the
+ *          payload wasn't compressed. On failure puts `reader` into an error
+ *          state (E::BADMSG) and returns nullptr.
+ */
+std::unique_ptr<ProtocolReader> read(ProtocolReader& reader, MessageType type);
+
+}}} // namespace facebook::logdevice::payload_compression
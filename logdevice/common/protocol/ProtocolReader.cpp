@@ -210,6 +210,26 @@ void ProtocolReader::readIOBuf(folly::IOBuf* out, size_t to_read) {
   }
 }
 
+void ProtocolReader::readVarint(uint64_t* out) {
+  ld_check(out);
+  *out = 0;
+  uint64_t value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    uint8_t byte = 0;
+    read(&byte);
+    if (!ok()) {
+      return;
+    }
+    value |= uint64_t(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      *out = value;
+      return;
+    }
+  }
+  // Too many continuation bytes.
+  setError(E::BADMSG);
+}
+
 void ProtocolReader::checkReadableBytes(size_t bytes_to_read) {
   if (bytes_to_read > src_left_) {
     ld_error(
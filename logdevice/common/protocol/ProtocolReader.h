@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include <cstring>
 #include <string>
 #include <type_traits>
 #include <vector>
@@ -127,6 +128,28 @@ class ProtocolReader {
     read(out, sizeof(T));
   }
 
+  /**
+   * Reads what ProtocolWriter::writeFields() wrote: same as calling read() on
+   * each of the arguments in order, but checks the remaining size and calls
+   * into the source once for all of them. On error all outputs are zeroed.
+   */
+  template <typename... Ts>
+  void readFields(Ts*... outs) {
+    static_assert(sizeof...(Ts) > 0, "");
+    static_assert((!is_std_vector<Ts>::value && ...),
+                  "ProtocolReader::readFields() must not be called on vector");
+    static_assert((!std::is_same<Ts, std::string>::value && ...),
+                  "ProtocolReader::readFields() must not be called on string");
+    if (!isProtoVersionAllowed()) {
+      // Leave the caller's defaults alone, like read() does.
+      return;
+    }
+    char buf[(sizeof(Ts) + ...)];
+    read(buf, sizeof(buf));
+    const char* pos = buf;
+    ((memcpy(outs, pos, sizeof(Ts)), pos += sizeof(Ts)), ...);
+  }
+
   /**
    * Reads protocol version from field and sets version.
    */
@@ -179,6 +202,12 @@ class ProtocolReader {
 
   void readIOBuf(folly::IOBuf* out, size_t to_read);
 
+  /**
+   * Reads a varint written by ProtocolWriter::writeVarint(). Sets E::BADMSG
+   * if the encoding is longer than 10 bytes. On error, `out' is zeroed.
+   */
+  void readVarint(uint64_t* out);
+
   uint64_t computeChecksum(size_t msglen) {
     return src_ ? src_->computeChecksum(msglen) : 0;
   }
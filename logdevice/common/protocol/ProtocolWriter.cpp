@@ -7,6 +7,7 @@
  */
 #include "logdevice/common/protocol/ProtocolWriter.h"
 
+#include <folly/Varint.h>
 #include <folly/io/IOBuf.h>
 
 #include "logdevice/common/Checksum.h"
@@ -93,17 +94,10 @@ class IOBufDestination : public ProtocolWriter::Destination {
   }
 
   uint64_t computeChecksum() override {
-    uint64_t checksum = 0;
-    const size_t len = iobuf_->computeChainDataLength();
-    std::string data(len, 0);
-    auto it = data.begin();
-    for (auto& buf : *iobuf_) {
-      std::copy(buf.begin(), buf.end(), it);
-      it += buf.size();
-    }
-    Slice slice(&data[0], len);
-    checksum_bytes(slice, 64, (char*)&checksum);
-    return checksum;
+    // Hash the chain in place. Large payloads are chained without copying
+    // (see writeWithoutCopy()), so linearizing the chain here would copy
+    // every checksummed message on the worker thread.
+    return checksum_64bit(*iobuf_);
   }
   const char* identify() const override {
     return "iobuf destination";
@@ -291,6 +285,12 @@ void ProtocolWriter::writeImpl(const void* data, size_t nbytes) {
   writeImplCb([&] { return dest_->write(data, nbytes, nwritten_); });
 }
 
+void ProtocolWriter::writeVarint(uint64_t value) {
+  uint8_t buf[folly::kMaxVarintLength64];
+  size_t len = folly::encodeVarint(value, buf);
+  write(buf, len);
+}
+
 void ProtocolWriter::writeWithoutCopy(const void* data, size_t nbytes) {
   if (!isProtoVersionAllowed()) {
     return;
@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include <cstring>
 #include <string>
 #include <type_traits>
 #include <vector>
@@ -18,9 +19,23 @@
 #include "logdevice/common/protocol/MessageType.h"
 #include "logdevice/common/types_internal.h"
 #include "logdevice/include/Err.h"
+#include "logdevice/include/types.h"
 
 namespace facebook { namespace logdevice {
 
+/**
+ * How the sender wants large RECORD and STORE payloads compressed on the
+ * wire. Set by the Connection on the ProtocolWriter it serializes a message
+ * with, see PayloadCompression.h.
+ */
+struct PayloadCompressionOptions {
+  Compression compression = Compression::NONE;
+  // Only used with Compression::ZSTD.
+  int zstd_level = 1;
+  // Payloads smaller than this are sent uncompressed.
+  size_t min_size = 0;
+};
+
 /**
  * @file Utility class for serializing object into destination buffer (e.g.,
  * serializing Message subclasses onto the network buffer). Simplifies of a
@@ -103,6 +118,28 @@ class ProtocolWriter {
     write(&val, sizeof(T));
   }
 
+  /**
+   * Same as calling write() on each of the arguments in order, but packs
+   * them into one buffer whose size is known at compile time and makes a
+   * single call into the destination. Meant for runs of small fixed-size
+   * fields on the hot paths of messages.
+   */
+  template <typename... Ts>
+  void writeFields(const Ts&... vals) {
+    static_assert(sizeof...(Ts) > 0, "");
+    static_assert((!is_std_vector<Ts>::value && ...),
+                  "ProtocolWriter::writeFields() must not be called on vector");
+    static_assert((!std::is_same<Ts, std::string>::value && ...),
+                  "ProtocolWriter::writeFields() must not be called on string");
+    static_assert((!std::is_pointer<Ts>::value && ...),
+                  "ProtocolWriter::writeFields() must not be called on "
+                  "pointer");
+    char buf[(sizeof(Ts) + ...)];
+    char* pos = buf;
+    ((memcpy(pos, &vals, sizeof(Ts)), pos += sizeof(Ts)), ...);
+    write(buf, sizeof(buf));
+  }
+
   /**
    * Sets protocol version (or checks if set proto version is correct) and
    * proceeds with write() if everything checks out.
@@ -139,6 +176,12 @@ class ProtocolWriter {
     nwritten_ += nbytes;
   }
 
+  /**
+   * Writes an unsigned integer as a varint: 7 bits per byte, least
+   * significant group first, 1 to 10 bytes. See ProtocolReader::readVarint().
+   */
+  void writeVarint(uint64_t value);
+
   /**
    * Writes data without necessarily copying it.  The Message subclass should
    * ensure the region of memory is valid as long as it exists.
@@ -254,6 +297,13 @@ class ProtocolWriter {
     return dest_->computeChecksum();
   }
 
+  const PayloadCompressionOptions& payloadCompression() const {
+    return payload_compression_;
+  }
+  void setPayloadCompression(PayloadCompressionOptions options) {
+    payload_compression_ = options;
+  }
+
   // Use a custom destination. Both dest and context are owned by the caller and
   // must outlive the ProtocolWriter.
   ProtocolWriter(Destination* dest,
@@ -303,6 +353,7 @@ class ProtocolWriter {
   // Protocol gate; write calls are ignored if `proto_' < `proto_gate_'
   uint16_t proto_gate_ = 0;
   Status status_ = E::OK;
+  PayloadCompressionOptions payload_compression_;
 
   void writeImpl(const void* data, size_t nbytes);
   template <typename Fn>
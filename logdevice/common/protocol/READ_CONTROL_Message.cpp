@@ -0,0 +1,48 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/protocol/READ_CONTROL_Message.h"
+
+#include <cstdlib>
+
+#include "logdevice/common/protocol/ProtocolReader.h"
+#include "logdevice/common/protocol/ProtocolWriter.h"
+
+namespace facebook { namespace logdevice {
+
+READ_CONTROL_Message::READ_CONTROL_Message(std::vector<WINDOW_Header> windows,
+                                           std::vector<STOP_Header> stops)
+    : Message(MessageType::READ_CONTROL, TrafficClass::HANDSHAKE),
+      windows_(std::move(windows)),
+      stops_(std::move(stops)) {}
+
+void READ_CONTROL_Message::serialize(ProtocolWriter& writer) const {
+  writer.writeLengthPrefixedVector(windows_);
+  writer.writeLengthPrefixedVector(stops_);
+}
+
+MessageReadResult READ_CONTROL_Message::deserialize(ProtocolReader& reader) {
+  std::vector<WINDOW_Header> windows;
+  std::vector<STOP_Header> stops;
+  reader.readLengthPrefixedVector(&windows);
+  reader.readLengthPrefixedVector(&stops);
+  return reader.result([&] {
+    return new READ_CONTROL_Message(std::move(windows), std::move(stops));
+  });
+}
+
+Message::Disposition READ_CONTROL_Message::onReceived(const Address&) {
+  // Receipt handler lives in server/message_handlers/
+  // READ_CONTROL_onReceived.cpp, this should never get called.
+  std::abort();
+}
+
+uint16_t READ_CONTROL_Message::getMinProtocolVersion() const {
+  return Compatibility::BATCHED_READ_CONTROL;
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,58 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <vector>
+
+#include "logdevice/common/protocol/Message.h"
+#include "logdevice/common/protocol/STOP_Message.h"
+#include "logdevice/common/protocol/WINDOW_Message.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file READ_CONTROL is sent by clients to a storage node instead of many
+ *       WINDOW and STOP messages. It carries the window updates and stop
+ *       requests that read streams of one client worker issued for that node
+ *       during one event loop iteration. The storage node processes them as
+ *       if it had received the WINDOW messages, then the STOP messages, in
+ *       order.
+ */
+
+class READ_CONTROL_Message : public Message {
+ public:
+  READ_CONTROL_Message(std::vector<WINDOW_Header> windows,
+                       std::vector<STOP_Header> stops);
+
+  READ_CONTROL_Message(READ_CONTROL_Message&&) noexcept = delete;
+  READ_CONTROL_Message& operator=(const READ_CONTROL_Message&) = delete;
+  READ_CONTROL_Message& operator=(READ_CONTROL_Message&&) = delete;
+
+  // see Message.h
+  void serialize(ProtocolWriter&) const override;
+  Disposition onReceived(const Address&) override;
+  uint16_t getMinProtocolVersion() const override;
+  static Message::deserializer_t deserialize;
+
+  const std::vector<WINDOW_Header>& getWindows() const {
+    return windows_;
+  }
+
+  const std::vector<STOP_Header>& getStops() const {
+    return stops_;
+  }
+
+  // Maximum number of WINDOW or STOP updates senders put in one message.
+  static constexpr size_t MAX_ENTRIES = 4096;
+
+ private:
+  std::vector<WINDOW_Header> windows_;
+  std::vector<STOP_Header> stops_;
+};
+
+}} // namespace facebook::logdevice
@@ -20,6 +20,7 @@
 #include "logdevice/common/debug.h"
 #include "logdevice/common/protocol/GAP_Message.h"
 #include "logdevice/common/protocol/MessageType.h"
+#include "logdevice/common/protocol/PayloadCompression.h"
 #include "logdevice/common/protocol/ProtocolReader.h"
 #include "logdevice/common/protocol/ProtocolWriter.h"
 #include "logdevice/common/settings/Settings.h"
@@ -58,6 +59,14 @@ void RECORD_Message::serialize(ProtocolWriter& writer) const {
   if (writer.proto() < Compatibility::ProtocolVersion::STREAM_WRITER_SUPPORT) {
     proto_supported_header.flags &= ~RECORD_Header::WRITE_STREAM;
   }
+  if (writer.proto() < Compatibility::ProtocolVersion::E2E_LATENCY_TRACING) {
+    proto_supported_header.flags &= ~RECORD_Header::E2E_TRACED;
+  }
+  folly::Optional<folly::IOBuf> compressed =
+      payload_compression::compress(writer, payload_);
+  if (compressed.hasValue()) {
+    proto_supported_header.flags |= RECORD_Header::PAYLOAD_COMPRESSED;
+  }
   writer.write(proto_supported_header);
 
   // Note: this method needs to be kept at least approximately in sync with
@@ -69,14 +78,20 @@ void RECORD_Message::serialize(ProtocolWriter& writer) const {
 
   if (offsets_.isValid()) {
     ld_check(header_.flags & RECORD_Header::INCLUDE_BYTE_OFFSET);
-    offsets_.serialize(writer);
+    if (writer.proto() >= Compatibility::ProtocolVersion::COMPACT_OFFSET_MAP) {
+      offsets_.serializeCompact(writer);
+    } else {
+      offsets_.serialize(writer);
+    }
   }
 
   // Must have been checked by upper layers.
   ld_check(payload_.size() < Message::MAX_LEN);
 
   Payload p = payload_.getPayload();
-  if (p.size() <= MAX_COPY_TO_EVBUFFER_PAYLOAD_SIZE) {
+  if (compressed.hasValue()) {
+    writer.writeWithoutCopy(compressed.get_pointer());
+  } else if (p.size() <= MAX_COPY_TO_EVBUFFER_PAYLOAD_SIZE) {
     writer.write(p.data(), p.size());
   } else {
     payload_.serialize(writer);
@@ -96,7 +111,11 @@ MessageReadResult RECORD_Message::deserialize(ProtocolReader& reader) {
 
   OffsetMap offsets;
   if (header.flags & RECORD_Header::INCLUDE_BYTE_OFFSET) {
-    offsets.deserialize(reader, false /* unused */);
+    if (reader.proto() >= Compatibility::ProtocolVersion::COMPACT_OFFSET_MAP) {
+      offsets.deserializeCompact(reader);
+    } else {
+      offsets.deserialize(reader, false /* unused */);
+    }
   }
 
   if (header.flags & RECORD_Header::DIGEST) {
@@ -105,11 +124,20 @@ MessageReadResult RECORD_Message::deserialize(ProtocolReader& reader) {
     tc = TrafficClass::REBUILD;
   }
 
+  // A compressed payload is uncompressed up front. The checksum and the
+  // payload are then read from the uncompressed bytes.
+  std::unique_ptr<ProtocolReader> uncompressed;
+  if (header.flags & RECORD_Header::PAYLOAD_COMPRESSED) {
+    header.flags &= ~RECORD_Header::PAYLOAD_COMPRESSED;
+    uncompressed = payload_compression::read(reader, MessageType::RECORD);
+  }
+  ProtocolReader& payload_reader = uncompressed ? *uncompressed : reader;
+
   // If flags indicate that the payload includes a checksum, strip it now.
   // The payload size reported to the client will be just the actual client
   // payload.
   uint64_t expected_checksum = 0;
-  if (reader.ok() && (header.flags & RECORD_Header::CHECKSUM)) {
+  if (payload_reader.ok() && (header.flags & RECORD_Header::CHECKSUM)) {
     union {
       uint64_t c64;
       uint32_t c32;
@@ -124,14 +152,14 @@ MessageReadResult RECORD_Message::deserialize(ProtocolReader& reader) {
       checksum_size = sizeof u.c32;
     }
 
-    if (reader.bytesRemaining() < checksum_size) {
+    if (payload_reader.bytesRemaining() < checksum_size) {
       RATELIMIT_ERROR(
           std::chrono::seconds(10),
           10,
           "Malformed RECORD message: ran out of bytes while reading "
           "checksum (expected %zu, got %zu); log: %lu lsn: %s rsid: %lu",
           checksum_size,
-          reader.bytesRemaining(),
+          payload_reader.bytesRemaining(),
           header.log_id.val_,
           lsn_to_string(header.lsn).c_str(),
           header.read_stream_id.val_);
@@ -140,17 +168,21 @@ MessageReadResult RECORD_Message::deserialize(ProtocolReader& reader) {
       // comes from sender's local log store, without sender checking it.
       expected_checksum = 0x5000b4df00f00f00ul;
     } else {
-      reader.read(ptr, checksum_size);
+      payload_reader.read(ptr, checksum_size);
       expected_checksum =
           (header.flags & RECORD_Header::CHECKSUM_64BIT) ? u.c64 : u.c32;
     }
   }
 
-  size_t payload_size = reader.ok() ? reader.bytesRemaining() : 0;
+  size_t payload_size =
+      payload_reader.ok() ? payload_reader.bytesRemaining() : 0;
   ld_check(payload_size < Message::MAX_LEN);
 
   PayloadHolder payload_holder =
-      PayloadHolder::deserialize(reader, payload_size);
+      PayloadHolder::deserialize(payload_reader, payload_size);
+  if (payload_reader.error()) {
+    reader.setError(payload_reader.status());
+  }
 
   return reader.result([&] {
     auto m = std::make_unique<RECORD_Message>(
@@ -265,7 +297,11 @@ std::unique_ptr<ExtraMetadata> read_extra_metadata(ProtocolReader& reader,
 
   if (flags & RECORD_Header::INCLUDE_OFFSET_WITHIN_EPOCH) {
     OffsetMap offsets_within_epoch;
-    offsets_within_epoch.deserialize(reader, false /* unused */);
+    if (reader.proto() >= Compatibility::ProtocolVersion::COMPACT_OFFSET_MAP) {
+      offsets_within_epoch.deserializeCompact(reader);
+    } else {
+      offsets_within_epoch.deserialize(reader, false /* unused */);
+    }
     result->offsets_within_epoch = std::move(offsets_within_epoch);
   }
   return result;
@@ -282,7 +318,11 @@ void write_extra_metadata(ProtocolWriter& writer,
   writer.writeVector(metadata.copyset);
   if (metadata.offsets_within_epoch.isValid()) {
     ld_check(header.flags & RECORD_Header::INCLUDE_OFFSET_WITHIN_EPOCH);
-    metadata.offsets_within_epoch.serialize(writer);
+    if (writer.proto() >= Compatibility::ProtocolVersion::COMPACT_OFFSET_MAP) {
+      metadata.offsets_within_epoch.serializeCompact(writer);
+    } else {
+      metadata.offsets_within_epoch.serialize(writer);
+    }
   }
 }
 
@@ -354,6 +394,8 @@ std::string RECORD_Message::flagsToString(RECORD_flags_t flags) {
   FLAG(DRAINED)
   FLAG(WRITE_STREAM)
   FLAG(PAYLOAD_GROUP)
+  FLAG(PAYLOAD_COMPRESSED)
+  FLAG(E2E_TRACED)
 
 #undef FLAG
 
@@ -105,6 +105,16 @@ struct RECORD_Header {
   // and STORE_Header::PAYLOAD_GROUP
   static const RECORD_flags_t PAYLOAD_GROUP = 1u << 23; //=8388608
 
+  // Wire only. The payload (including the checksum, if any) is compressed,
+  // see PayloadCompression.h. Set and cleared by serialize()/deserialize().
+  static const RECORD_flags_t PAYLOAD_COMPRESSED = 1u << 24; //=16777216
+
+  // The record was sampled for end-to-end latency tracing by the appending
+  // client, see ClientReadStream::recordE2ELatency().
+  // Flag value must match that of LocalLogStoreRecordFormat::FLAG_E2E_TRACED
+  // and STORE_Header::E2E_TRACED
+  static const RECORD_flags_t E2E_TRACED = 1u << 26; //=67108864
+
   // Please update RECORD_Message::flagsToString() when adding flags.
 
 } __attribute__((__packed__));
@@ -57,6 +57,11 @@ class RELEASE_Message : public Message {
   void onSent(Status st, const Address& to) const override;
   static Message::deserializer_t deserialize;
 
+  // Does what onSent() does for a RELEASE with the given header. Also used
+  // for each of the RELEASEs in a MULTI_RELEASE message.
+  static void
+  onReleaseSent(const RELEASE_Header& header, Status st, const Address& to);
+
   bool warnAboutOldProtocol() const override;
 
   const RELEASE_Header& getHeader() const {
@@ -77,9 +77,26 @@ START_Message::START_Message(const START_Header& header,
 void START_Message::serialize(ProtocolWriter& writer) const {
   writer.write(header_);
   writer.writeLengthPrefixedVector(filtered_out_);
-  writer.write(static_cast<uint8_t>(attrs_.filter_type));
-  writer.writeLengthPrefixedVector(attrs_.filter_key1);
-  writer.writeLengthPrefixedVector(attrs_.filter_key2);
+  if (attrs_.filter_type == ServerRecordFilterType::EXPRESSION &&
+      writer.proto() < Compatibility::SERVER_FILTER_EXPRESSIONS) {
+    // The server would reject the message. Have it deliver everything
+    // instead, same as a server that couldn't compile the expression.
+    RATELIMIT_WARNING(std::chrono::seconds(10),
+                      1,
+                      "Not sending filter expression to a server on protocol "
+                      "%u, server-side filtering is disabled for read stream "
+                      "%lu of log %lu",
+                      writer.proto(),
+                      header_.read_stream_id.val_,
+                      header_.log_id.val_);
+    writer.write(static_cast<uint8_t>(ServerRecordFilterType::NOFILTER));
+    writer.writeLengthPrefixedVector(std::string());
+    writer.writeLengthPrefixedVector(std::string());
+  } else {
+    writer.write(static_cast<uint8_t>(attrs_.filter_type));
+    writer.writeLengthPrefixedVector(attrs_.filter_key1);
+    writer.writeLengthPrefixedVector(attrs_.filter_key2);
+  }
 
   if (header_.scd_copyset_reordering ==
       SCDCopysetReordering::HASH_SHUFFLE_CLIENT_SEED) {
@@ -120,7 +137,9 @@ MessageReadResult START_Message::deserialize(ProtocolReader& reader) {
     m->attrs_.filter_type = static_cast<ServerRecordFilterType>(temp);
     if (m->attrs_.filter_type != ServerRecordFilterType::EQUALITY &&
         m->attrs_.filter_type != ServerRecordFilterType::RANGE &&
-        m->attrs_.filter_type != ServerRecordFilterType::NOFILTER) {
+        m->attrs_.filter_type != ServerRecordFilterType::NOFILTER &&
+        !(m->attrs_.filter_type == ServerRecordFilterType::EXPRESSION &&
+          proto >= Compatibility::SERVER_FILTER_EXPRESSIONS)) {
       ld_error("Bad START message, unknown ServerRecordFilterType: %d",
                static_cast<int>(m->attrs_.filter_type));
       return reader.errorResult(E::BADMSG);
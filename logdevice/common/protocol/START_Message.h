@@ -104,6 +104,12 @@ struct START_Header {
   // if it is the primary recipient (left-most in copyset) of the record in the
   // client's region.
   static const START_flags_t LOCAL_SCD_ENABLED = 1u << 11; //=2048
+
+  // SLO class of the reader, see Reader::setMonitoringTier(). The storage node
+  // prioritizes streams of higher classes when it can't keep up with all
+  // readers of a client. Neither flag means MonitoringTier::MEDIUM_PRI.
+  static const START_flags_t MONITORING_TIER_HIGH = 1u << 12; //=4096
+  static const START_flags_t MONITORING_TIER_LOW = 1u << 13;  //=8192
 } __attribute__((__packed__));
 
 class START_Message : public Message {
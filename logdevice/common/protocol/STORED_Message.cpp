@@ -31,7 +31,8 @@ STORED_Message::STORED_Message(const STORED_Header& header,
                                chunk_rebuilding_id_t rebuilding_id,
                                FlushToken flushToken,
                                ServerInstanceId serverInstanceId,
-                               ShardID rebuildingRecipient)
+                               ShardID rebuildingRecipient,
+                               StoreStageTimes stage_times)
     : Message(MessageType::STORED, calcTrafficClass(header)),
       header_(header),
       rebuilding_version_(rebuilding_version),
@@ -39,7 +40,8 @@ STORED_Message::STORED_Message(const STORED_Header& header,
       rebuilding_id_(rebuilding_id),
       flushToken_(flushToken),
       serverInstanceId_(serverInstanceId),
-      rebuildingRecipient_(rebuildingRecipient) {}
+      rebuildingRecipient_(rebuildingRecipient),
+      stage_times_(stage_times) {}
 
 MessageReadResult STORED_Message::deserialize(ProtocolReader& reader) {
   STORED_Header hdr;
@@ -52,11 +54,11 @@ MessageReadResult STORED_Message::deserialize(ProtocolReader& reader) {
   ServerInstanceId serverInstanceId = ServerInstanceId_INVALID;
   chunk_rebuilding_id_t rebuilding_id = CHUNK_REBUILDING_ID_INVALID;
   if (hdr.flags & STORED_Header::REBUILDING) {
-    reader.read(&rebuilding_version);
-    reader.read(&rebuilding_wave);
-    reader.read(&flushToken);
-    reader.read(&serverInstanceId);
-    reader.read(&rebuilding_id);
+    reader.readFields(&rebuilding_version,
+                      &rebuilding_wave,
+                      &flushToken,
+                      &serverInstanceId,
+                      &rebuilding_id);
   }
 
   ShardID rebuildingRecipient;
@@ -74,6 +76,11 @@ MessageReadResult STORED_Message::deserialize(ProtocolReader& reader) {
     }
   }
 
+  StoreStageTimes stage_times;
+  if (hdr.flags & STORED_Header::STAGE_TIMES) {
+    reader.read(&stage_times);
+  }
+
   return reader.result([&] {
     return new STORED_Message(hdr,
                               rebuilding_version,
@@ -81,28 +88,33 @@ MessageReadResult STORED_Message::deserialize(ProtocolReader& reader) {
                               rebuilding_id,
                               flushToken,
                               serverInstanceId,
-                              rebuildingRecipient);
+                              rebuildingRecipient,
+                              stage_times);
   });
 }
 
 void STORED_Message::serialize(ProtocolWriter& writer) const {
   writer.write(&header_, STORED_Header::headerSize(writer.proto()));
   if (header_.flags & STORED_Header::REBUILDING) {
-    writer.write(rebuilding_version_);
-    writer.write(rebuilding_wave_);
-    writer.write(flushToken_);
-    writer.write(serverInstanceId_);
-    writer.write(rebuilding_id_);
+    writer.writeFields(rebuilding_version_,
+                       rebuilding_wave_,
+                       flushToken_,
+                       serverInstanceId_,
+                       rebuilding_id_);
   }
   if (header_.status == E::REBUILDING) {
     writer.write(rebuildingRecipient_);
   }
+  if (header_.flags & STORED_Header::STAGE_TIMES) {
+    writer.write(stage_times_);
+  }
 }
 
 Message::Disposition
 STORED_Message::handleOneMessage(const STORED_Header& header,
                                  ShardID from,
-                                 ShardID rebuildingRecipient) {
+                                 ShardID rebuildingRecipient,
+                                 const StoreStageTimes* stage_times) {
   Appender* appender{
       // Appender that sent the corresponding STORE
       Worker::onThisThread()->activeAppenders().map.find(header.rid)};
@@ -116,7 +128,7 @@ STORED_Message::handleOneMessage(const STORED_Header& header,
 
   ld_assert(header.rid == Appender::KeyExtractor()(*appender));
 
-  return appender->onReply(header, from, rebuildingRecipient)
+  return appender->onReply(header, from, rebuildingRecipient, stage_times)
       ? Disposition::ERROR
       : Disposition::NORMAL;
 }
@@ -164,8 +176,8 @@ Message::Disposition STORED_Message::onReceivedCommon(const Address& from) {
       auto replies = appender->takeHeldReplies();
 
       for (auto& reply : replies) {
-        auto rv =
-            handleOneMessage(reply.hdr, reply.from, reply.rebuildingRecipient);
+        auto rv = handleOneMessage(
+            reply.hdr, reply.from, reply.rebuildingRecipient, nullptr);
         if (rv == Disposition::ERROR) {
           ld_info("Got an error on proccessing a held STORED message, but "
                   "not closing connection.");
@@ -175,7 +187,12 @@ Message::Disposition STORED_Message::onReceivedCommon(const Address& from) {
     }
   }
 
-  return handleOneMessage(header_, shard, rebuildingRecipient_);
+  return handleOneMessage(header_,
+                          shard,
+                          rebuildingRecipient_,
+                          header_.flags & STORED_Header::STAGE_TIMES
+                              ? &stage_times_
+                              : nullptr);
 }
 
 /**
@@ -273,7 +290,8 @@ void STORED_Message::createAndSend(const STORED_Header& header,
                                    uint32_t rebuilding_wave,
                                    chunk_rebuilding_id_t rebuilding_id,
                                    FlushToken flushToken,
-                                   ShardID rebuildingRecipient) {
+                                   ShardID rebuildingRecipient,
+                                   StoreStageTimes stage_times) {
   ld_check(send_to.valid()); // must have been set by onReceived()
   Worker* worker = Worker::onThisThread();
 
@@ -357,7 +375,8 @@ void STORED_Message::createAndSend(const STORED_Header& header,
                                                 rebuilding_id,
                                                 flushToken,
                                                 serverInstanceId,
-                                                rebuildingRecipient);
+                                                rebuildingRecipient,
+                                                stage_times);
 
     if (target_worker.second == worker->idx_) {
       // the connection to origin is handled by this Worker thread
@@ -398,6 +417,7 @@ STORED_Message::getDebugInfo() const {
     FLAG(REBUILDING)
     FLAG(PREMPTED_BY_SOFT_SEAL_ONLY)
     FLAG(LOW_WATERMARK_NOSPC)
+    FLAG(STAGE_TIMES)
 #undef FLAG
     return folly::join('|', strings);
   };
@@ -421,6 +441,11 @@ STORED_Message::getDebugInfo() const {
     add("server_instance_id", serverInstanceId_);
     add("rebuilding_recipient", rebuildingRecipient_.toString());
   }
+  if (header_.flags & STORED_Header::STAGE_TIMES) {
+    add("queue_us", stage_times_.queue_us);
+    add("write_us", stage_times_.write_us);
+    add("total_us", stage_times_.total_us);
+  }
 
   return res;
 }
@@ -97,6 +97,23 @@ struct STORED_Header {
   static const STORED_flags_t PREMPTED_BY_SOFT_SEAL_ONLY = 1ul << 4; //=16
   // the local log store's partition crossed low-watermark
   static const STORED_flags_t LOW_WATERMARK_NOSPC = 1ul << 5; //=32
+  // the header is followed by StoreStageTimes; only set if the STORE had
+  // the STORE_Header::STAGE_TIMES flag
+  static const STORED_flags_t STAGE_TIMES = 1ul << 6; //=64
+} __attribute__((__packed__));
+
+/**
+ * How long a storage node spent on the stages of a STORE, in microseconds.
+ * Sent back in STORED if the STORE asked for it, so that the sequencer can
+ * tell network time from storage time in its append latency breakdown.
+ */
+struct StoreStageTimes {
+  // from receiving the STORE until a storage thread picked up the write
+  uint32_t queue_us = 0;
+  // writing the batch the record was in to the local log store
+  uint32_t write_us = 0;
+  // from receiving the STORE until sending the STORED
+  uint32_t total_us = 0;
 } __attribute__((__packed__));
 
 class STORED_Message : public Message {
@@ -112,7 +129,8 @@ class STORED_Message : public Message {
                           chunk_rebuilding_id_t rebuilding_id,
                           FlushToken flushToken,
                           ServerInstanceId serverInstanceId,
-                          ShardID rebuildingRecipient = ShardID());
+                          ShardID rebuildingRecipient = ShardID(),
+                          StoreStageTimes stage_times = StoreStageTimes());
 
   void serialize(ProtocolWriter&) const override;
 
@@ -150,7 +168,8 @@ class STORED_Message : public Message {
                             uint32_t rebuilding_wave,
                             chunk_rebuilding_id_t rebuilding_id,
                             FlushToken flushToken = FlushToken_INVALID,
-                            ShardID rebuildingRecipient = ShardID());
+                            ShardID rebuildingRecipient = ShardID(),
+                            StoreStageTimes stage_times = StoreStageTimes());
 
   STORED_Header header_;
 
@@ -178,6 +197,9 @@ class STORED_Message : public Message {
   // recipient in the copyset that is in the rebuilding set.
   ShardID rebuildingRecipient_;
 
+  // Only sent if header_.flags has STAGE_TIMES.
+  StoreStageTimes stage_times_;
+
   virtual std::vector<std::pair<std::string, folly::dynamic>>
   getDebugInfo() const override;
 
@@ -185,9 +207,11 @@ class STORED_Message : public Message {
   /**
    * Calls Appender::onReply() once (at most).  Helper function.
    */
-  static Message::Disposition handleOneMessage(const STORED_Header& header,
-                                               ShardID from,
-                                               ShardID rebuildingRecipient);
+  static Message::Disposition
+  handleOneMessage(const STORED_Header& header,
+                   ShardID from,
+                   ShardID rebuildingRecipient,
+                   const StoreStageTimes* stage_times);
 
   friend Disposition STORED_onReceived(STORED_Message* msg,
                                        const Address& from);
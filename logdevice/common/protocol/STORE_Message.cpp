@@ -22,6 +22,7 @@
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/common/protocol/MUTATED_Message.h"
+#include "logdevice/common/protocol/PayloadCompression.h"
 #include "logdevice/common/protocol/ProtocolReader.h"
 #include "logdevice/common/protocol/ProtocolWriter.h"
 #include "logdevice/common/protocol/STORED_Message.h"
@@ -123,22 +124,40 @@ void STORE_Message::serialize(ProtocolWriter& writer) const {
   if (writer.proto() < Compatibility::ProtocolVersion::STREAM_WRITER_SUPPORT) {
     proto_supported_header.flags &= ~STORE_Header::WRITE_STREAM;
   }
+  if (writer.proto() < Compatibility::ProtocolVersion::E2E_LATENCY_TRACING) {
+    proto_supported_header.flags &= ~STORE_Header::E2E_TRACED;
+  }
+  const bool write_payload =
+      !payload_.empty() && !(header_.flags & STORE_Header::AMEND);
+  folly::Optional<folly::IOBuf> compressed;
+  if (write_payload) {
+    compressed = compressed_payload_cache_
+        ? compressed_payload_cache_->compress(writer, payload_)
+        : payload_compression::compress(writer, payload_);
+  }
+  if (compressed.hasValue()) {
+    proto_supported_header.flags |= STORE_Header::PAYLOAD_COMPRESSED;
+  }
   writer.write(proto_supported_header);
 
   if (header_.flags & STORE_Header::RECOVERY) {
-    writer.write(extra_.recovery_id);
-    writer.write(extra_.recovery_epoch);
+    writer.writeFields(extra_.recovery_id, extra_.recovery_epoch);
   }
 
   if (header_.flags & STORE_Header::REBUILDING) {
-    writer.write(extra_.rebuilding_version);
-    writer.write(extra_.rebuilding_wave);
-    writer.write(extra_.rebuilding_id);
+    writer.writeFields(extra_.rebuilding_version,
+                       extra_.rebuilding_wave,
+                       extra_.rebuilding_id);
   }
 
   if (header_.flags & STORE_Header::OFFSET_WITHIN_EPOCH) {
     if (header_.flags & STORE_Header::OFFSET_MAP) {
-      extra_.offsets_within_epoch.serialize(writer);
+      if (writer.proto() >=
+          Compatibility::ProtocolVersion::COMPACT_OFFSET_MAP) {
+        extra_.offsets_within_epoch.serializeCompact(writer);
+      } else {
+        extra_.offsets_within_epoch.serialize(writer);
+      }
     } else {
       writer.write(extra_.offsets_within_epoch.getCounter(BYTE_OFFSET));
     }
@@ -170,7 +189,9 @@ void STORE_Message::serialize(ProtocolWriter& writer) const {
     }
   }
 
-  if (!payload_.empty() && !(header_.flags & STORE_Header::AMEND)) {
+  if (compressed.hasValue()) {
+    writer.writeWithoutCopy(compressed.get_pointer());
+  } else if (write_payload) {
     payload_.serialize(writer);
   }
 }
@@ -182,19 +203,23 @@ MessageReadResult STORE_Message::deserialize(ProtocolReader& reader) {
   reader.read(&hdr);
 
   if (hdr.flags & STORE_Header::RECOVERY) {
-    reader.read(&extra.recovery_id);
-    reader.read(&extra.recovery_epoch);
+    reader.readFields(&extra.recovery_id, &extra.recovery_epoch);
   }
 
   if (hdr.flags & STORE_Header::REBUILDING) {
-    reader.read(&extra.rebuilding_version);
-    reader.read(&extra.rebuilding_wave);
-    reader.read(&extra.rebuilding_id);
+    reader.readFields(&extra.rebuilding_version,
+                      &extra.rebuilding_wave,
+                      &extra.rebuilding_id);
   }
 
   if (hdr.flags & STORE_Header::OFFSET_WITHIN_EPOCH) {
     if (hdr.flags & STORE_Header::OFFSET_MAP) {
-      extra.offsets_within_epoch.deserialize(reader, false /*not used */);
+      if (reader.proto() >=
+          Compatibility::ProtocolVersion::COMPACT_OFFSET_MAP) {
+        extra.offsets_within_epoch.deserializeCompact(reader);
+      } else {
+        extra.offsets_within_epoch.deserialize(reader, false /*not used */);
+      }
     } else {
       uint64_t offset_within_epoch;
       reader.read(&offset_within_epoch);
@@ -243,9 +268,21 @@ MessageReadResult STORE_Message::deserialize(ProtocolReader& reader) {
     }
   }
 
-  const size_t payload_size = reader.bytesRemaining();
-  PayloadHolder payload_holder =
-      PayloadHolder::deserialize(reader, payload_size);
+  PayloadHolder payload_holder;
+  if (hdr.flags & STORE_Header::PAYLOAD_COMPRESSED) {
+    hdr.flags &= ~STORE_Header::PAYLOAD_COMPRESSED;
+    auto uncompressed = payload_compression::read(reader, MessageType::STORE);
+    if (uncompressed) {
+      payload_holder = PayloadHolder::deserialize(
+          *uncompressed, uncompressed->bytesRemaining());
+      if (uncompressed->error()) {
+        reader.setError(uncompressed->status());
+      }
+    }
+  } else {
+    const size_t payload_size = reader.bytesRemaining();
+    payload_holder = PayloadHolder::deserialize(reader, payload_size);
+  }
 
   return reader.result([&] {
     // No, you can't replace this with make_unique. The constructor is private.
@@ -373,6 +410,18 @@ void STORE_Message::onForwardingFailure(Status st) const {
   }
 }
 
+std::unique_ptr<STORE_Message> STORE_Message::copyForForwarding() const {
+  ld_check(my_pos_in_copyset_ >= 0);
+  std::unique_ptr<STORE_Message> copy(new STORE_Message(header_, payload_));
+  copy->extra_ = extra_;
+  copy->copyset_ = copyset_;
+  copy->block_starting_lsn_ = block_starting_lsn_;
+  copy->optional_keys_ = optional_keys_;
+  copy->my_pos_in_copyset_ = my_pos_in_copyset_;
+  copy->reply_to_ = reply_to_;
+  return copy;
+}
+
 std::string STORE_Message::printableCopyset() {
   std::string res;
 
@@ -473,6 +522,9 @@ std::string STORE_Message::flagsToString(STORE_flags_t flags) {
   FLAG(DRAINED)
   FLAG(WRITE_STREAM)
   FLAG(PAYLOAD_GROUP)
+  FLAG(PAYLOAD_COMPRESSED)
+  FLAG(STAGE_TIMES)
+  FLAG(E2E_TRACED)
 
 #undef FLAG
 
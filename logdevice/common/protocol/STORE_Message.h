@@ -33,6 +33,10 @@
 
 namespace facebook { namespace logdevice {
 
+namespace payload_compression {
+class CompressedPayloadCache;
+}
+
 struct STORE_Header {
   RecordID rid; // unique ID of record being stored, includes log id and LSN
   uint64_t timestamp; // Record timestamp in milliseconds since 1970.
@@ -169,6 +173,19 @@ struct STORE_Header {
   // Record contains serialized PayloadGroup
   static const STORE_flags_t PAYLOAD_GROUP = 1u << 23; //=8388608
 
+  // Wire only. The payload is compressed, see PayloadCompression.h. Set and
+  // cleared by serialize()/deserialize().
+  static const STORE_flags_t PAYLOAD_COMPRESSED = 1u << 24; //=16777216
+
+  // Asks the storage node to report how long it spent on each stage of the
+  // store, see StoreStageTimes.
+  static const STORE_flags_t STAGE_TIMES = 1u << 25; //=33554432
+
+  // The record was sampled for end-to-end latency tracing by the appending
+  // client. Flag value must match that of
+  // LocalLogStoreRecordFormat::FLAG_E2E_TRACED and RECORD_Header::E2E_TRACED
+  static const STORE_flags_t E2E_TRACED = 1u << 26; //=67108864
+
   // Please update STORE_Message::flagsToString() when adding flags.
 } __attribute__((__packed__));
 
@@ -271,6 +288,10 @@ class STORE_Message : public Message {
         : folly::Executor::HI_PRI;
   }
 
+  folly::Optional<logid_t> getStripeKey() const override {
+    return header_.rid.logid;
+  }
+
   static TrafficClass calcTrafficClass(const STORE_Header& header) {
     TrafficClass tc;
 
@@ -377,6 +398,15 @@ class STORE_Message : public Message {
    */
   void setBlockStartingLSN(lsn_t lsn);
 
+  /**
+   * Makes serialize() compress the payload through `cache', which the
+   * caller shares between all STOREs of the same payload.
+   */
+  void setCompressedPayloadCache(
+      std::shared_ptr<payload_compression::CompressedPayloadCache> cache) {
+    compressed_payload_cache_ = std::move(cache);
+  }
+
   /**
    * Pretty-prints flags.
    */
@@ -406,6 +436,13 @@ class STORE_Message : public Message {
    */
   void onForwardingFailure(Status st) const;
 
+  /**
+   * A copy of this received message, including the state set by
+   * StoreStateMachine::onReceived(), to be forwarded down the chain while
+   * this one is still being processed locally.
+   */
+  std::unique_ptr<STORE_Message> copyForForwarding() const;
+
   STORE_Header header_;
 
   STORE_Extra extra_;
@@ -424,6 +461,11 @@ class STORE_Message : public Message {
   // This is essentially unused until block CSI is implemented.
   lsn_t block_starting_lsn_ = LSN_INVALID;
 
+  // If set, compressed payloads are shared with other STOREs of the record,
+  // see setCompressedPayloadCache().
+  std::shared_ptr<payload_compression::CompressedPayloadCache>
+      compressed_payload_cache_;
+
   // The (optional) keys provided by the client in the append() operation.
   // See @Record.h for details
   std::map<KeyType, std::string> optional_keys_;
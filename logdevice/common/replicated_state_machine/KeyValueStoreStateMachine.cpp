@@ -72,7 +72,10 @@ int KeyValueStoreStateMachine::applyDelta(const KeyValueStoreDelta& delta,
       return 0;
     }
     case KeyValueStoreDelta::Type::remove_value: {
-      // TODO: Not implemented
+      // removing a key that doesn't exist is not an error, the delta may have
+      // been written by a client racing with another one removing the key
+      state.store.erase(delta.get_remove_value().key);
+      state.set_version(version);
       return 0;
     }
     default:
@@ -85,12 +88,30 @@ int KeyValueStoreStateMachine::applyDelta(const KeyValueStoreDelta& delta,
 int KeyValueStoreStateMachine::serializeState(const KeyValueStoreState& state,
                                               void* buf,
                                               size_t buf_size) {
-  auto serialized_state =
-      ThriftCodec::serialize<apache::thrift::BinarySerializer>(state);
-  if (buf != nullptr) {
-    ld_check(buf_size >= serialized_state.size());
-    memcpy(buf, serialized_state.data(), serialized_state.size());
+  // ReplicatedStateMachine calls this twice in a row when taking a snapshot:
+  // first with a null buffer to get the size, then to fill the buffer. Keep
+  // the result of the first call so that the state, which may hold a lot of
+  // keys, is only serialized once.
+  std::string serialized_state;
+  if (buf != nullptr && last_serialized_state_ == &state &&
+      last_serialized_version_ == state.version &&
+      last_serialized_.size() <= buf_size) {
+    serialized_state = std::move(last_serialized_);
+  } else {
+    serialized_state =
+        ThriftCodec::serialize<apache::thrift::BinarySerializer>(state);
+  }
+  last_serialized_.clear();
+  last_serialized_state_ = nullptr;
+
+  if (buf == nullptr) {
+    last_serialized_state_ = &state;
+    last_serialized_version_ = state.version;
+    last_serialized_ = std::move(serialized_state);
+    return last_serialized_.size();
   }
+  ld_check(buf_size >= serialized_state.size());
+  memcpy(buf, serialized_state.data(), serialized_state.size());
   return serialized_state.size();
 }
 
@@ -52,5 +52,13 @@ class KeyValueStoreStateMachine
   bool shouldCreateSnapshot() const override;
   bool canSnapshot() const override;
   void onSnapshotCreated(Status st, size_t snapshotSize) override;
+
+ private:
+  // Result of the last serializeState() call made with a null buffer, reused
+  // by the next call if it is for the same state at the same version.
+  const replicated_state_machine::thrift::KeyValueStoreState*
+      last_serialized_state_{nullptr};
+  uint64_t last_serialized_version_{0};
+  std::string last_serialized_;
 };
 }} // namespace facebook::logdevice
@@ -47,7 +47,7 @@ void LogBasedRSMSnapshotStore::postAppendRequest(lsn_t snapshot_ver,
       nullptr,
       snapshot_log_id_,
       AppendAttributes(),
-      PayloadHolder::copyBuffer(payload.data(), payload.size()),
+      PayloadHolder::takeString(std::move(payload)),
       snapshot_append_timeout_,
       append_cb);
   req->bypassWriteTokenCheck();
@@ -364,7 +364,7 @@ void LogBasedRSMSnapshotStore::setCachedItems(
     std::string snapshot_blob,
     SnapshotAttributes snapshot_attrs) {
   last_released_real_lsn_ = last_released_real_lsn;
-  latest_snapshot_blob_ = snapshot_blob;
+  latest_snapshot_blob_ = std::move(snapshot_blob);
   last_snapshot_attrs_ = snapshot_attrs;
 }
 
@@ -82,10 +82,12 @@ void ReplicatedStateMachine<T, D>::getSnapshot() {
              lsn_to_string(snapshot_attrs.base_version).c_str(),
              snapshot_attrs.timestamp.count());
 
-    ticket.postCallbackRequest([st,
-                                snapshot_blob_out,
-                                snapshot_attrs,
-                                rsm_type](ReplicatedStateMachine<T, D>* s) {
+    // The callback gets copied on its way to the state machine's worker.
+    // Share the blob, which can be tens of MB, rather than copy it.
+    auto blob = std::make_shared<const std::string>(
+        std::move(snapshot_blob_out));
+    ticket.postCallbackRequest([st, blob, snapshot_attrs, rsm_type](
+                                   ReplicatedStateMachine<T, D>* s) {
       if (!s) {
         rsm_info(rsm_type, "State machine doesn't exist");
         return;
@@ -95,7 +97,7 @@ void ReplicatedStateMachine<T, D>::getSnapshot() {
       switch (st) {
         case E::OK:
           s->snapshot_sync_ = snapshot_attrs.base_version;
-          payload = Payload(snapshot_blob_out.data(), snapshot_blob_out.size());
+          payload = Payload(blob->data(), blob->size());
           if (!s->processSnapshot(payload, snapshot_attrs)) {
             s->activateSnapshotFetchTimer();
           }
@@ -146,6 +148,7 @@ void ReplicatedStateMachine<T, D>::stop() {
 
   stop_read_stream(snapshot_log_rsid_);
   stop_read_stream(delta_log_rsid_);
+  cached_snapshot_.reset();
 
   stopped_ = true;
   cancelGracePeriodForSnapshotting();
@@ -1230,7 +1233,7 @@ void ReplicatedStateMachine<T, D>::postAppendRequest(
       nullptr,
       logid,
       AppendAttributes(),
-      PayloadHolder::copyBuffer(payload.data(), payload.size()),
+      PayloadHolder::takeString(std::move(payload)),
       timeout,
       cb_wrapper);
 
@@ -1549,7 +1552,20 @@ Status ReplicatedStateMachine<T, D>::getSnapshotFromMemory(
 
   bool include_read_ptr =
       Worker::settings().rsm_include_read_pointer_in_snapshot;
-  snapshot_blob_out = createSnapshotPayload(*data_, version_, include_read_ptr);
+  if (cached_snapshot_ && cached_snapshot_->version == version_ &&
+      cached_snapshot_->delta_read_ptr == delta_read_ptr_ &&
+      cached_snapshot_->include_read_ptr == include_read_ptr) {
+    WORKER_STAT_INCR(rsm_snapshot_from_memory_cache_hits);
+  } else {
+    WORKER_STAT_INCR(rsm_snapshot_from_memory_cache_misses);
+    auto cached = std::make_unique<CachedSnapshot>();
+    cached->version = version_;
+    cached->delta_read_ptr = delta_read_ptr_;
+    cached->include_read_ptr = include_read_ptr;
+    cached->blob = createSnapshotPayload(*data_, version_, include_read_ptr);
+    cached_snapshot_ = std::move(cached);
+  }
+  snapshot_blob_out = cached_snapshot_->blob;
   version_out = version_;
   return E::OK;
 }
@@ -1682,7 +1698,9 @@ void ReplicatedStateMachine<T, D>::snapshot(std::function<void(Status st)> cb) {
   std::string payload =
       createSnapshotPayload(*data_, version_, include_read_ptr);
 
-  // We'll capture these in the lambda below.
+  // We'll capture these in the lambda below. The payload itself is moved
+  // into the append, only its size is captured.
+  const size_t payload_size = payload.size();
   const size_t byte_offset_at_time_of_snapshot = delta_log_byte_offset_;
   const size_t offset_at_time_of_snapshot = delta_log_offset_;
 
@@ -1713,7 +1731,7 @@ void ReplicatedStateMachine<T, D>::snapshot(std::function<void(Status st)> cb) {
                  lsn_to_string(lsn).c_str(),
                  lsn_to_string(delta_read_ptr_copy).c_str());
         advertiseVersions(RsmVersionType::DURABLE, last_written_version_);
-        onSnapshotCreated(st, payload.size());
+        onSnapshotCreated(st, payload_size);
       } else if (st == E::UPTODATE) {
         advertiseVersions(RsmVersionType::DURABLE, lsn);
       } else {
@@ -1737,7 +1755,7 @@ void ReplicatedStateMachine<T, D>::snapshot(std::function<void(Status st)> cb) {
            writing_snapshot ? "" : "Not ",
            lsn_to_string(version_).c_str(),
            lsn_to_string(delta_read_ptr_copy).c_str(),
-           payload.size(),
+           payload_size,
            lsn_to_string(last_written_version_).c_str(),
            lsn_to_string(last_snapshot_last_read_ptr_).c_str(),
            include_read_ptr);
@@ -1749,8 +1767,10 @@ void ReplicatedStateMachine<T, D>::snapshot(std::function<void(Status st)> cb) {
     snapshot_in_flight_ = true;
     snapshot_store_->writeSnapshot(version_, std::move(payload), snapshot_cb);
   } else {
-    postAppendRequest(
-        snapshot_log_id_, payload, snapshot_append_timeout_, snapshot_cb);
+    postAppendRequest(snapshot_log_id_,
+                      std::move(payload),
+                      snapshot_append_timeout_,
+                      snapshot_cb);
     snapshot_in_flight_ = true;
   }
 }
@@ -459,6 +459,9 @@ class ReplicatedStateMachine {
   // multiple times.
   void onGotSnapshotLogTailLSN(Status st, lsn_t start, lsn_t lsn);
 
+  // Serves the in-memory state to clients (see GET_RSM_SNAPSHOT). The
+  // serialized snapshot is cached and reused until the state moves, so that
+  // many clients fetching the same version cost a single serialization.
   virtual Status getSnapshotFromMemory(lsn_t min_ver,
                                        lsn_t& version_out,
                                        std::string& snapshot_blob_out);
@@ -819,6 +822,17 @@ class ReplicatedStateMachine {
   // Version of the latest published state to subscribers.
   folly::Optional<lsn_t> latest_published_version_{folly::none};
 
+  // Last snapshot serialized by getSnapshotFromMemory(), along with what it
+  // was computed from. Reused as long as version_ and delta_read_ptr_ have not
+  // moved. Dropped if the state machine is stopped.
+  struct CachedSnapshot {
+    lsn_t version{LSN_INVALID};
+    lsn_t delta_read_ptr{LSN_INVALID};
+    bool include_read_ptr{false};
+    std::string blob;
+  };
+  std::unique_ptr<CachedSnapshot> cached_snapshot_;
+
   // Ids of the read streams for reading the snapshot and delta logs.
   read_stream_id_t snapshot_log_rsid_{0};
   read_stream_id_t delta_log_rsid_{0};
@@ -18,6 +18,7 @@
 #include "logdevice/common/Processor.h"
 #include "logdevice/common/Request.h"
 #include "logdevice/common/Semaphore.h"
+#include "logdevice/common/Worker.h"
 #include "logdevice/common/WorkerType.h"
 #include "logdevice/common/debug.h"
 
@@ -356,4 +357,26 @@ fulfill_on_all_workers(Processor* processor,
   return futures;
 }
 
+/**
+ * Continues a multi-step operation on the Worker this is called on: once
+ * `future` completes, `cb` is called on this Worker with the folly::Try<T> of
+ * its result. The continuation is added to the Worker's task queue like with
+ * Worker::addWithPriority(), so a step costs no Request to allocate, route
+ * and track. The Worker is kept alive until `cb` has run.
+ *
+ * Must be called on a Worker thread.
+ *
+ * @return  a future completing with the result of `cb`, which can itself be
+ *          continued with then_on_this_worker() from `cb` or from the Worker.
+ */
+template <typename T, typename F>
+auto then_on_this_worker(folly::SemiFuture<T> future,
+                         F&& cb,
+                         int8_t priority = folly::Executor::LO_PRI) {
+  Worker* w = Worker::onThisThread();
+  return std::move(future)
+      .via(folly::getKeepAliveToken(w), priority)
+      .thenTry(std::forward<F>(cb));
+}
+
 }} // namespace facebook::logdevice
@@ -33,5 +33,11 @@ struct ClientReadStreamFailureDetectorSettings {
   // outlier in the read set. This rate gets applied when a shard is not
   // detected an outlier.
   float outlier_duration_decrease_rate;
+  // If positive, a shard that has not completed the window is speculatively
+  // declared an outlier as soon as it is slower than this percentile of the
+  // recent window completion latencies of the other shards, without waiting
+  // for the outlier detection algorithm to have enough confidence. Rewinds
+  // done to filter out such shards keep the records already buffered.
+  double speculative_percentile = 0;
 };
 }} // namespace facebook::logdevice
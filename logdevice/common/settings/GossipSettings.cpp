@@ -169,6 +169,17 @@ void GossipSettings::defineSettings(SettingEasyInit& init) {
        "1/10th of the GOSSIP_Messages.",
        SERVER,
        SettingsCategory::FailureDetector);
+  init("gossip-full-sync-frequency",
+       &gossip_full_sync_frequency,
+       "10",
+       parse_positive<int32_t>(),
+       "How frequently a GOSSIP message includes every node in the cluster. "
+       "The other GOSSIP messages only include the nodes whose state changed "
+       "since the previous message, if the recipient supports it. If the "
+       "value is 10, 1/10th of the GOSSIP_Messages are full. 1 means all of "
+       "them are.",
+       SERVER,
+       SettingsCategory::FailureDetector);
 };
 
 }} // namespace facebook::logdevice
@@ -129,6 +129,23 @@ void RebuildingSettings::defineSettings(SettingEasyInit& init) {
        "Max amount of time rebuilding read storage task is allowed to "
        "take before yielding to other storage tasks. \"max\" for unlimited.",
        SERVER);
+  init("rebuilding-max-batch-time-with-queued-reads",
+       &max_batch_time_with_queued_reads,
+       "50ms",
+       [](std::chrono::milliseconds val) -> void {
+         if (val.count() <= 0) {
+           out_of_range("rebuilding-max-batch-time-with-queued-reads",
+                        "positive",
+                        val.count());
+         }
+       },
+       "Same as rebuilding-max-batch-time, but used instead of it when other "
+       "read storage tasks, e.g. from client read streams, are waiting in "
+       "the shard's slow storage task queue when the rebuilding read starts. "
+       "Lets latency-sensitive reads get a storage thread sooner while a "
+       "donor is rebuilding.",
+       SERVER,
+       SettingsCategory::Rebuilding);
   init("rebuilding-max-records-in-flight",
        &max_records_in_flight,
        "200",
@@ -233,6 +250,16 @@ void RebuildingSettings::defineSettings(SettingEasyInit& init) {
        "unsuccessful reply, or connection closed after we sent the store.",
        SERVER,
        SettingsCategory::Rebuilding);
+  init("rebuilding-amend-batching",
+       &amend_batching,
+       "true",
+       nullptr,
+       "Send the amends that record rebuildings of all logs on a worker issue "
+       "for a storage node within one event loop iteration in one MULTI_AMEND "
+       "message, instead of one STORE message per amend. Nodes that don't "
+       "support MULTI_AMEND still get STORE messages.",
+       SERVER,
+       SettingsCategory::Rebuilding);
   init("rebuild-dirty-shards",
        &rebuild_dirty_shards,
        "true",
@@ -371,6 +398,108 @@ void RebuildingSettings::defineSettings(SettingEasyInit& init) {
        "that would cause a restart.",
        SERVER,
        SettingsCategory::Rebuilding);
+  init("rebuilding-incremental-set-updates",
+       &incremental_set_updates,
+       "true",
+       nullptr,
+       "When shards are added to the rebuilding set of a rebuilding that is "
+       "in progress, resume reading from the point up to which everything "
+       "has been re-replicated instead of starting over, then do a follow-up "
+       "pass over the part that was skipped, looking only for records of the "
+       "added shards. If false, such rebuildings restart from the beginning.",
+       SERVER,
+       SettingsCategory::Rebuilding);
+  init("rebuilding-auto-tune-append-p99-target",
+       &auto_tune_append_p99_target,
+       "0ms",
+       [](std::chrono::milliseconds val) -> void {
+         if (val.count() < 0) {
+           out_of_range("rebuilding-auto-tune-append-p99-target",
+                        "non-negative",
+                        val.count());
+         }
+       },
+       "If positive, rebuilding donors throttle themselves to keep p99 "
+       "latency of appends sequenced on this node below this value: every "
+       "--rebuilding-auto-tune-interval the fraction of "
+       "--rebuilding-rate-limit, --rebuilding-max-records-in-flight and "
+       "--rebuilding-max-record-bytes-in-flight that rebuilding may use is "
+       "halved if the target was exceeded and raised by 10% of the "
+       "configured limits otherwise. 0 disables this target.",
+       SERVER,
+       SettingsCategory::Rebuilding);
+  init("rebuilding-auto-tune-read-p99-target",
+       &auto_tune_read_p99_target,
+       "0ms",
+       [](std::chrono::milliseconds val) -> void {
+         if (val.count() < 0) {
+           out_of_range("rebuilding-auto-tune-read-p99-target",
+                        "non-negative",
+                        val.count());
+         }
+       },
+       "Same as --rebuilding-auto-tune-append-p99-target but for the p99 "
+       "latency of client read storage tasks (queueing plus execution) on "
+       "the shard being rebuilt from. 0 disables this target.",
+       SERVER,
+       SettingsCategory::Rebuilding);
+  init("rebuilding-auto-tune-interval",
+       &auto_tune_interval,
+       "10s",
+       [](std::chrono::milliseconds val) -> void {
+         if (val.count() <= 0) {
+           out_of_range(
+               "rebuilding-auto-tune-interval", "positive", val.count());
+         }
+       },
+       "How often rebuilding re-evaluates client latencies against "
+       "--rebuilding-auto-tune-append-p99-target and "
+       "--rebuilding-auto-tune-read-p99-target.",
+       SERVER,
+       SettingsCategory::Rebuilding);
+  init("rebuilding-auto-tune-min-factor",
+       &auto_tune_min_factor,
+       "0.05",
+       [](double val) -> void {
+         if (val <= 0 || val > 1) {
+           throw boost::program_options::error(
+               "rebuilding-auto-tune-min-factor must be in (0, 1]");
+         }
+       },
+       "Lowest fraction of the configured rebuilding limits that auto-tuning "
+       "may throttle rebuilding down to, to make sure rebuilding always "
+       "makes progress.",
+       SERVER,
+       SettingsCategory::Rebuilding);
+  init("rebuilding-mini-fast-path-max-duration",
+       &mini_rebuilding_fast_path_max_duration,
+       "1h",
+       [](std::chrono::milliseconds val) -> void {
+         if (val.count() < 0) {
+           out_of_range("rebuilding-mini-fast-path-max-duration",
+                        "non-negative",
+                        val.count());
+         }
+       },
+       "If all shards in the rebuilding set are only dirty for some time "
+       "ranges (e.g. after an unclean shutdown), and the dirty ranges add up "
+       "to at most this long, donors only plan the data logs that have "
+       "records in their local partitions overlapping the dirty ranges, "
+       "instead of every log in the config. Logs without such records have "
+       "nothing to rebuild on the donor. 0 disables the fast path.",
+       SERVER,
+       SettingsCategory::Rebuilding);
+  init("rebuilding-start-after-planned-logs",
+       &start_after_planned_logs,
+       "0",
+       nullptr,
+       "If positive, a shard starts reading and rebuilding as soon as this "
+       "many logs have been planned, instead of waiting for the plans of all "
+       "logs. Logs planned later join the read pass as their plans arrive, "
+       "and records they skipped are read in a follow-up pass. Not used when "
+       "resuming rebuilding from a checkpoint. 0 to wait for all plans.",
+       SERVER,
+       SettingsCategory::Rebuilding);
   init("rebuilding-wait-purges-backoff-time",
        &wait_purges_backoff_time,
        "1s..10s",
@@ -457,6 +586,18 @@ void RebuildingSettings::defineSettings(SettingEasyInit& init) {
        "of new-to-old setting; if they don't, rebuilding stalls until they do.",
        SERVER | REQUIRES_RESTART,
        SettingsCategory::Rebuilding);
+  init("rebuilding-chunks-on-background-workers",
+       &chunks_on_background_workers,
+       "false",
+       nullptr,
+       "Re-replicate rebuilt records on the background workers (see "
+       "--num-background-workers) instead of the general ones, so that "
+       "bursts of rebuilding work don't delay the reads and writes that "
+       "general workers serve. Has no effect if there are no background "
+       "workers. Takes effect for shards whose rebuilding starts after the "
+       "change.",
+       SERVER,
+       SettingsCategory::Rebuilding);
 }
 
 }} // namespace facebook::logdevice
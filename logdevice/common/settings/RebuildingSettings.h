@@ -42,6 +42,7 @@ struct RebuildingSettings : public SettingsBundle {
   std::chrono::milliseconds planner_scheduling_delay;
   size_t max_batch_bytes;
   std::chrono::milliseconds max_batch_time;
+  std::chrono::milliseconds max_batch_time_with_queued_reads;
   size_t max_records_in_flight;
   size_t max_record_bytes_in_flight;
   bool use_rocksdb_cache;
@@ -49,6 +50,7 @@ struct RebuildingSettings : public SettingsBundle {
   size_t max_get_seq_state_in_flight;
   chrono_interval_t<std::chrono::milliseconds> retry_timeout;
   chrono_interval_t<std::chrono::milliseconds> store_timeout;
+  bool amend_batching;
   chrono_interval_t<std::chrono::milliseconds>
       rebuilding_planner_sync_seq_retry_interval;
   bool rebuild_dirty_shards;
@@ -62,12 +64,20 @@ struct RebuildingSettings : public SettingsBundle {
   bool allow_conditional_rebuilding_restarts;
   bool test_stall_rebuilding;
   std::chrono::milliseconds rebuilding_restarts_grace_period;
+  bool incremental_set_updates;
+  std::chrono::milliseconds auto_tune_append_p99_target;
+  std::chrono::milliseconds auto_tune_read_p99_target;
+  std::chrono::milliseconds auto_tune_interval;
+  double auto_tune_min_factor;
+  std::chrono::milliseconds mini_rebuilding_fast_path_max_duration;
+  size_t start_after_planned_logs;
   std::chrono::milliseconds auto_mark_unrecoverable_timeout;
   chrono_expbackoff_t<std::chrono::milliseconds> wait_purges_backoff_time;
   uint64_t max_malformed_records_to_tolerate;
   rate_limit_t rate_limit;
   bool filter_relocate_shards;
   bool new_to_old;
+  bool chunks_on_background_workers;
 
  private:
   // Only UpdateableSettings can create this bundle.
@@ -90,6 +90,17 @@ void SequencerBoycottingSettings::defineSettings(SettingEasyInit& init) {
        "time, allow it to be boycotted",
        SERVER,
        SettingsCategory::SequencerBoycotting);
+  init("node-stats-boycott-severe-failure-ratio",
+       &node_stats_boycott_severe_failure_ratio,
+       "1",
+       validate_range<double>(0.0, 1.0),
+       "If an outlier's append failure ratio over the last aggregation period "
+       "is above this value, it may be boycotted right away instead of after "
+       "node-stats-boycott-grace-period. Lets clearly broken sequencers be "
+       "boycotted within one aggregation period, while marginal outliers still "
+       "wait out the grace period. 1 disables this",
+       SERVER,
+       SettingsCategory::SequencerBoycotting);
   init("node-stats-boycott-sensitivity",
        &node_stats_boycott_sensitivity,
        "0",
@@ -59,6 +59,11 @@ struct SequencerBoycottingSettings {
   // For how long should a node be an outlier before it gets boycotted
   std::chrono::milliseconds node_stats_boycott_grace_period;
 
+  // An outlier whose append failure ratio over the last aggregation period
+  // is above this value does not have to wait for the grace period before it
+  // can be boycotted. 1 disables this.
+  double node_stats_boycott_severe_failure_ratio;
+
   // see its entry in Settings.cpp
   double node_stats_boycott_sensitivity;
 
@@ -17,6 +17,7 @@
 #include <boost/thread/thread.hpp>
 #include <folly/String.h>
 
+#include "logdevice/common/NumaPlacement.h"
 #include "logdevice/common/SnapshotStoreTypes.h"
 #include "logdevice/common/Sockaddr.h"
 #include "logdevice/common/commandline_util_chrono.h"
@@ -186,6 +187,22 @@ parse_message_types(const std::string& val) {
   return res;
 }
 
+static std::unordered_set<TrafficClass>
+parse_traffic_classes(const std::string& val) {
+  std::unordered_set<TrafficClass> res;
+  std::vector<std::string> tokens;
+  folly::split(",", val, tokens, true);
+  for (const auto& str : tokens) {
+    TrafficClass tc = trafficClasses().reverseLookup(str);
+    if (tc == TrafficClass::INVALID) {
+      throw boost::program_options::error(
+          std::string("Invalid traffic class in the list (\"" + str + "\")."));
+    }
+    res.insert(tc);
+  }
+  return res;
+}
+
 static SockaddrSet parse_sockaddrs(const std::string& val) {
   std::unordered_set<Sockaddr, Sockaddr::Hash> elements;
   bool anonymous_unix_socket_present = false;
@@ -637,6 +654,35 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "check. Set to 0 to disable closing of idle connections completely.",
        CLIENT,
        SettingsCategory::Network);
+  init("share-client-runtime",
+       &share_client_runtime,
+       "false",
+       nullptr, // no validation
+       "If true, clients created by ClientFactory in the same process for "
+       "the same config, cluster name and credentials share one set of "
+       "workers, connections to the cluster and config subscriptions, instead "
+       "of each having its own. Only clients that have this setting share. "
+       "Each client keeps its own settings for its own API calls (timeouts, "
+       "payload limits etc.), but the settings of the workers and "
+       "connections, e.g. num-workers, are those of the first client, and all "
+       "clients use its client session id. Destroying a client doesn't cancel "
+       "its outstanding requests, whose callbacks may still be called "
+       "afterwards; the workers shut down when the last client sharing them "
+       "is destroyed.",
+       CLIENT | REQUIRES_RESTART /* used in ClientFactory::create() */,
+       SettingsCategory::Network);
+  init("data-connection-stripes",
+       &data_connection_stripes,
+       "1",
+       parse_validate_range<ssize_t>(1, 16),
+       "Number of connections each worker opens to every other node for "
+       "messages that only need to be ordered per log, such as STOREs sent "
+       "by sequencers. Each log uses one of them, picked by log id. More "
+       "than 1 spreads a busy sequencer's traffic to a storage node over "
+       "several TCP streams, which the storage node accepts on different "
+       "workers. Other messages always use the first connection.",
+       SERVER | REQUIRES_RESTART,
+       SettingsCategory::Network);
   init("max-cached-digest-record-queued-kb",
        &max_cached_digest_record_queued_kb,
        "256",
@@ -668,6 +714,100 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "Maximum execution time for reading records. 'max' means no limit.",
        SERVER | EXPERIMENTAL,
        SettingsCategory::ResourceManagement);
+  init("zero-copy-record-delivery",
+       &zero_copy_record_delivery,
+       "false",
+       nullptr,
+       "If true, records that storage threads read for catching up readers "
+       "are placed in refcounted buffers, and RECORD messages reference "
+       "their payloads directly instead of making another copy before "
+       "handing them to the socket. The same applies to records served from "
+       "the real time buffer, whose payload is shared by all readers "
+       "tailing the log. The buffers are released once the messages are "
+       "written out.",
+       SERVER | EXPERIMENTAL,
+       SettingsCategory::ReadPath);
+  init("read-result-cache-max-bytes",
+       &read_result_cache_max_bytes,
+       "0",
+       parse_nonnegative<ssize_t>(),
+       "Max total size (in bytes) of batches of records read from the local "
+       "log store by storage threads that are kept in memory, so that other "
+       "readers reading the same range of the same log shortly after, e.g. "
+       "several consumers of a backfill job, don't have to read it again. "
+       "Batches are only shared by readers with the same single copy "
+       "delivery parameters. Split evenly among workers. 0 disables the "
+       "cache.",
+       SERVER | REQUIRES_RESTART | EXPERIMENTAL,
+       SettingsCategory::ReadPath);
+  init("read-result-cache-ttl",
+       &read_result_cache_ttl,
+       "5min",
+       validate_positive<ssize_t>(),
+       "Batches of records in the read result cache (see "
+       "read-result-cache-max-bytes) older than this are not used, as "
+       "records may have been amended or rebuilt in the meantime.",
+       SERVER | REQUIRES_RESTART | EXPERIMENTAL,
+       SettingsCategory::ReadPath);
+  init("multi-log-read-batch-size",
+       &multi_log_read_batch_size,
+       "1",
+       parse_positive<size_t>(),
+       "When a client catches up on several logs of the same shard, issue up "
+       "to this many of their reads in a single storage task instead of one "
+       "task at a time. The reads are executed back to back, sorted by log "
+       "id, which amortizes storage task queueing and lets the storage "
+       "thread walk the shard's keyspace in one forward pass. 1 disables "
+       "batching.",
+       SERVER | EXPERIMENTAL,
+       SettingsCategory::ReadPath);
+  init("read-record-batch-size",
+       &read_record_batch_size,
+       "1",
+       parse_positive<size_t>(),
+       "Maximum number of small records (up to 512 bytes of payload) that a "
+       "read stream sends to the client in a single MULTI_RECORD message "
+       "when they are read back to back. Amortizes per-message overhead for "
+       "logs with tiny records. Only used with clients that support "
+       "MULTI_RECORD. 1 disables batching.",
+       SERVER | EXPERIMENTAL,
+       SettingsCategory::ReadPath);
+  init("catchup-readahead-max-size",
+       &catchup_readahead_max_size,
+       "0",
+       parse_nonnegative<ssize_t>(),
+       "Maximum read-ahead size, in bytes, for local log store iterators of "
+       "read streams that scan through a backlog. A stream whose storage "
+       "task batches keep ending on the byte or time limit gets read-ahead "
+       "starting at 256KB and doubling with each batch up to this value, so "
+       "that large scans use few large disk reads. Streams that catch up "
+       "with the tail go back to the storage engine's default. 0 disables "
+       "adaptive read-ahead.",
+       SERVER | EXPERIMENTAL,
+       SettingsCategory::ReadPath);
+  init("catchup-readahead-min-batches",
+       &catchup_readahead_min_batches,
+       "2",
+       parse_positive<ssize_t>(),
+       "Number of consecutive storage task batches of a read stream that "
+       "must end on the byte or time limit before it is considered to be "
+       "scanning sequentially and gets read-ahead. See "
+       "--catchup-readahead-max-size.",
+       SERVER | EXPERIMENTAL,
+       SettingsCategory::ReadPath);
+  init("catchup-adaptive-batch-size",
+       &catchup_adaptive_batch_size,
+       "false",
+       nullptr, // no validation
+       "If true, the number of bytes a storage task of a catching up read "
+       "stream may read is picked per stream, to about what the client "
+       "consumes during two storage task round trips, as measured from the "
+       "stream's WINDOW updates and storage task latency. Batches stay "
+       "between 64KB and --max-record-bytes-read-at-once. Fast readers of "
+       "slow disks get few large batches, slow readers don't make storage "
+       "threads read far ahead of them.",
+       SERVER | EXPERIMENTAL,
+       SettingsCategory::ReadPath);
   init("read-requests",
        &requests_from_pipe,
        "128",
@@ -695,6 +835,55 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "number of LO_PRI requests to process per worker event loop iteration",
        SERVER | CLIENT,
        SettingsCategory::Execution);
+  init("event-loop-target-latency",
+       &event_loop_target_latency,
+       "0",
+       validate_nonnegative<ssize_t>(),
+       "If nonzero, adapt the number of requests a worker processes per event "
+       "loop iteration so that iterations take about this long: fewer when "
+       "running requests starves socket IO, more when requests are queueing "
+       "up. The *_requests_per_iteration settings are the starting point. "
+       "0 disables adaptation.",
+       SERVER | CLIENT,
+       SettingsCategory::Execution);
+  init("worker-cpu-time-sample-period",
+       &worker_cpu_time_sample_period,
+       "64",
+       nullptr, // no validation
+       "Workers measure the thread CPU time taken by about one in this many "
+       "requests, message callbacks and storage task responses, picked at "
+       "random, and extrapolate it into the per type *_worker_cpu_usec stats "
+       "(see \"stats cpu_time\"). Each measurement costs two "
+       "clock_gettime(CLOCK_THREAD_CPUTIME_ID) calls. 0 disables.",
+       SERVER | CLIENT,
+       SettingsCategory::Monitoring);
+  init("busy-poll-workers",
+       &busy_poll_workers,
+       "",
+       [](const std::string& val) -> std::vector<int> {
+         std::vector<int> workers;
+         if (numa::parseCpuList(val, &workers) != 0) {
+           throw boost::program_options::error(
+               "value of --busy-poll-workers must be a list of worker "
+               "indices like \"0-3,8\"; " +
+               val + " given.");
+         }
+         return workers;
+       },
+       "Indices of the general workers that busy-poll: after waking up they "
+       "keep polling their sockets and request queue without sleeping until "
+       "they have been idle for --busy-poll-duration, trading a core each "
+       "for lower tail latency of what they handle. Empty to disable.",
+       SERVER | CLIENT | EXPERIMENTAL,
+       SettingsCategory::Execution);
+  init("busy-poll-duration",
+       &busy_poll_duration,
+       "100us",
+       validate_nonnegative<ssize_t>(),
+       "How long workers listed in --busy-poll-workers keep polling without "
+       "sleeping after they last had requests to run.",
+       SERVER | CLIENT | EXPERIMENTAL,
+       SettingsCategory::Execution);
   init("worker-request-pipe-capacity",
        &worker_request_pipe_capacity,
        "524288",
@@ -814,6 +1003,44 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "size of the record cache.",
        SERVER,
        SettingsCategory::Recovery);
+  init("record-cache-checkpoint-interval",
+       &record_cache_checkpoint_interval,
+       "0s",
+       validate_nonnegative<ssize_t>(),
+       "How often the record cache monitor thread writes the record caches "
+       "that changed since the last write to the local log store, so that "
+       "persisting record caches on shutdown only has to write what changed "
+       "since the last checkpoint. After a crash, checkpoints are discarded "
+       "unless --record-cache-recover-checkpoints is set. 0 disables "
+       "checkpoints.",
+       SERVER,
+       SettingsCategory::Recovery);
+  init("record-cache-recover-checkpoints",
+       &record_cache_recover_checkpoints,
+       "true",
+       nullptr,
+       "If true, a record cache checkpoint that wrote every cache that "
+       "changed waits for in-flight stores to reach the caches, then marks "
+       "itself with the local log store sequence number it is consistent "
+       "with. After a crash, such a checkpoint repopulates the record caches, "
+       "except for the logs that the write-ahead log shows were written "
+       "after it, so that recovery can digest from the caches. If the writes "
+       "since the checkpoint can't all be found, e.g. because they skipped "
+       "the write-ahead log, the checkpoint is discarded.",
+       SERVER,
+       SettingsCategory::Recovery);
+  init("record-cache-slab-segment-size",
+       &record_cache_slab_segment_size,
+       "65536",
+       parse_nonnegative<ssize_t>(),
+       "Largest segment, in bytes, that the record cache copies payloads of "
+       "cached records into. Payloads of one epoch are packed into segments "
+       "that start at 1KB and double up to this size, and each segment is "
+       "freed when the last record in it is evicted. Payloads larger than a "
+       "quarter of this size are not copied. 0 disables packing: cached "
+       "records then hold on to the buffers they were received in.",
+       SERVER,
+       SettingsCategory::Recovery);
 
   init("abort-on-failed-check",
        &abort_on_failed_check,
@@ -854,6 +1081,15 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "Should we print backtrace of stalled workers.",
        SERVER | CLIENT,
        SettingsCategory::Monitoring);
+  init("watchdog-capture-stacks-on-stall",
+       &watchdog_capture_stacks_on_stall,
+       "true",
+       nullptr, // no validation
+       "Should the watchdog capture the stacks of stalled workers and what "
+       "they are running, by interrupting them with a signal. The stacks are "
+       "logged and aggregated in the 'info stalls' admin command.",
+       SERVER,
+       SettingsCategory::Monitoring);
   init("watchdog-bt-ratelimit",
        &watchdog_bt_ratelimit,
        "10/120s",
@@ -966,6 +1202,16 @@ void Settings::defineSettings(SettingEasyInit& init) {
        SERVER | REQUIRES_RESTART /* used in ServerProcessor init */,
        SettingsCategory::Monitoring);
 
+  init("health-monitor-shed-load",
+       &health_monitor_shed_load,
+       "false",
+       nullptr,
+       "If true, a storage node that HealthMonitor finds overloaded or "
+       "unhealthy replies OVERLOADED to CHECK_NODE_HEALTH requests, so that "
+       "sequencers steer new writes away from it until it recovers.",
+       SERVER,
+       SettingsCategory::Monitoring);
+
   init("worker-stall-error-injection-chance",
        &worker_stall_error_injection_chance,
        "0",
@@ -1096,6 +1342,51 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "never send a wave of STORE messages through a chain",
        SERVER,
        SettingsCategory::WritePath);
+  init("chain-sending-cut-through",
+       &chain_sending_cut_through,
+       "false",
+       nullptr, // no validation
+       "When a storage node gets a chain-sent STORE of an append, forward it "
+       "to the next node in the chain as soon as the message is validated, "
+       "and check the seal and write the record locally in parallel. Without "
+       "this, the STORE is only forwarded after the seal is known, which may "
+       "need a read or a soft seal write on this node. With it, nodes "
+       "further down the chain store the record even if this node rejects "
+       "it, e.g. because the shard is being rebuilt.",
+       SERVER,
+       SettingsCategory::WritePath);
+  init("sequencer-window-adaptive",
+       &sequencer_window_adaptive,
+       "false",
+       nullptr, // no validation
+       "Adapt the number of appends a sequencer lets in flight in an epoch to "
+       "how storage nodes keep up. The limit is halved when a storage node "
+       "reports being overloaded, out of space, or drops a STORE, and grows "
+       "by one for every window's worth of successful appends, up to the "
+       "maxWritesInFlight of the log. Appends over the limit fail with "
+       "SEQNOBUFS like they do when the window is full.",
+       SERVER,
+       SettingsCategory::WritePath);
+  init("sequencer-window-latency-target",
+       &sequencer_window_latency_target,
+       "0ms",
+       validate_nonnegative<ssize_t>(),
+       "With --sequencer-window-adaptive, also shrink the window of appends "
+       "in flight when an append takes longer than this to get fully "
+       "replicated. 0 disables this.",
+       SERVER,
+       SettingsCategory::WritePath);
+  init("append-stage-times",
+       &append_stage_times,
+       "false",
+       nullptr, // no validation
+       "Ask storage nodes to report how long each STORE of an append spent "
+       "queued and being written, so that sequencers can tell network time "
+       "from storage time. Adds 12 bytes to STORED replies. The breakdown "
+       "goes to the append_stage_store_network histogram and to sampled "
+       "appender traces.",
+       SERVER,
+       SettingsCategory::WritePath);
   init("sbr-low-watermark-check-interval",
        &sbr_low_watermark_check_interval,
        "60s",
@@ -1216,6 +1507,17 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "only when worker context is run with previous eventloop architecture.",
        SERVER | CLIENT | REQUIRES_RESTART,
        SettingsCategory::Network);
+  init("load-aware-request-placement",
+       &load_aware_request_placement,
+       "false",
+       nullptr, // no validation
+       "Post requests that can run on any general worker to a lightly loaded "
+       "worker, picked from two random workers by the CPU usage they last "
+       "reported, instead of a random one. Spreads the load when some "
+       "workers are kept busy by hot logs or sockets. Requests with a worker "
+       "affinity still go to their worker.",
+       SERVER | CLIENT | REQUIRES_RESTART,
+       SettingsCategory::Execution);
 
   init("per-worker-storage-task-queue-size",
        &per_worker_storage_task_queue_size,
@@ -1307,6 +1609,19 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "unless write-batch-size is reached first",
        SERVER,
        SettingsCategory::Storage);
+  init("coalesce-write-batch-tasks",
+       &coalesce_write_batch_tasks,
+       "true",
+       nullptr, // no validation
+       "If true, a worker posts a single write batch task to a shard's "
+       "storage thread pool for all the writes (e.g. a burst of STOREs read "
+       "from the network) it hands to that shard within one event loop "
+       "iteration, instead of one task per write. The first write of an "
+       "iteration still posts its task right away. Reduces contention on "
+       "the storage task queue and lets a storage thread pick up the whole "
+       "burst as one batch.",
+       SERVER,
+       SettingsCategory::Storage);
   init("storage-tasks-use-drr",
        &storage_tasks_use_drr,
        "false",
@@ -1322,6 +1637,19 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "Use something like 1MB for byte based scheduling.",
        SERVER,
        SettingsCategory::Storage);
+  init("storage-tasks-drr-charge-io-time",
+       &storage_tasks_drr_charge_io_time,
+       "false",
+       nullptr,
+       "If true, the DRR scheduler charges each task of the slow storage "
+       "thread pool to its principal by the time the task spent in file reads "
+       "and writes, in microseconds, instead of 1 per task. Block cache "
+       "misses and read-ahead are paid for by the principals causing them, "
+       "which makes the shares apportion device time rather than task counts. "
+       "--storage-tasks-drr-quanta is then in microseconds; use something "
+       "like 10000. Only has effect with --storage-tasks-use-drr.",
+       SERVER,
+       SettingsCategory::Storage);
 
 #define STORAGE_TASK_PRINCIPAL(name, key, shareVal)                      \
   init("storage-task-" #key "-share",                                    \
@@ -1365,6 +1693,37 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "limit on the number of logs that can be in recovery at the same time",
        SERVER,
        SettingsCategory::Recovery);
+  init("max-log-recoveries-per-shard",
+       &max_log_recoveries_per_shard,
+       "0",
+       parse_nonnegative<ssize_t>(),
+       "limit on the number of data log recoveries running on this node whose "
+       "nodesets include the same storage shard, so that recovering many logs "
+       "at once doesn't swamp a few shards with seals, digests and cleaning. "
+       "Divided evenly among workers. 0 means no limit",
+       SERVER,
+       SettingsCategory::Recovery);
+  init("recovery-queue-scan-limit",
+       &recovery_queue_scan_limit,
+       "32",
+       parse_positive<size_t>(),
+       "when a data log recovery completes and others are queued because of "
+       "--concurrent-log-recoveries, look at this many logs from the front of "
+       "the queue and start recovering the one with the most appends in "
+       "flight. 1 recovers queued logs in FIFO order",
+       SERVER,
+       SettingsCategory::Recovery);
+  init("seal-batching",
+       &seal_batching,
+       "true",
+       nullptr,
+       "send the SEALs that log recoveries running on a worker issue to a "
+       "storage node within one event loop iteration in one MULTI_SEAL "
+       "message, and have the storage node seal those logs in one storage "
+       "task per shard. Speeds up failover of nodes running many sequencers. "
+       "Only used with storage nodes that support it",
+       SERVER,
+       SettingsCategory::Recovery);
   init("appender-buffer-queue-cap",
        &appender_buffer_queue_cap,
        "10000",
@@ -1382,6 +1741,15 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "batch size for processing per-log queue of pending writes",
        SERVER,
        SettingsCategory::WritePath);
+  init("appender-pool-size",
+       &appender_pool_size,
+       "4096",
+       parse_nonnegative<ssize_t>(),
+       "maximum number of freed Appender objects each worker caches for reuse "
+       "by subsequent appends, to avoid allocator overhead on the write path. "
+       "0 disables the cache.",
+       SERVER,
+       SettingsCategory::WritePath);
 
   init("test-appender-skip-stores",
        &test_appender_skip_stores,
@@ -1422,6 +1790,16 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "window update messages (less means more often)",
        CLIENT | SERVER /* for event log reads */,
        SettingsCategory::ReadPath);
+  init("read-control-batching",
+       &read_control_batching,
+       "true",
+       nullptr,
+       "batch the window updates and stop requests that the read streams of "
+       "a worker send to a storage node within one event loop iteration into "
+       "one message. Reduces the control message rate of readers reading "
+       "many logs. Only used with storage nodes that support it.",
+       CLIENT | SERVER /* for event log reads */,
+       SettingsCategory::ReadPath);
   init("client-epoch-metadata-cache-size",
        &client_epoch_metadata_cache_size,
        "50000",
@@ -1430,6 +1808,15 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "Set it to 0 to disable the epoch metadata cache.",
        CLIENT | REQUIRES_RESTART,
        SettingsCategory::ReadPath);
+  init("client-epoch-metadata-cache-soft-ttl",
+       &client_epoch_metadata_cache_soft_ttl,
+       "10min",
+       validate_positive<ssize_t>(),
+       "how long the client-side epoch metadata cache serves metadata that is "
+       "not known to be consistent yet (e.g., of the last epochs of a log). "
+       "Metadata known to be consistent never expires.",
+       CLIENT | REQUIRES_RESTART,
+       SettingsCategory::ReadPath);
   init("client-readers-flow-tracer-period",
        &client_readers_flow_tracer_period,
        "0s",
@@ -1537,6 +1924,19 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "logs, currently the event logs and logsconfig logs",
        SERVER,
        SettingsCategory::WritePath);
+  init("release-batching",
+       &release_batching,
+       "true",
+       nullptr,
+       "send the periodic and post-recovery RELEASEs that sequencers running "
+       "on a worker issue to a storage node within one event loop iteration "
+       "in one MULTI_RELEASE message, and have the storage node wake up the "
+       "read streams of those logs with one request per worker. Reduces "
+       "RELEASE overhead on nodes running many sequencers. RELEASEs of "
+       "individual appends are not batched. Only used with storage nodes "
+       "that support it",
+       SERVER,
+       SettingsCategory::WritePath);
   init("recovery-grace-period",
        &recovery_grace_period,
        "100ms",
@@ -1704,6 +2104,31 @@ void Settings::defineSettings(SettingEasyInit& init) {
       "how big a checksum to include with newly appended records (0, 32 or 64)",
       SERVER | CLIENT,
       SettingsCategory::WritePath);
+  init("precompute-checksum-min-size",
+       &precompute_checksum_min_size,
+       "4096",
+       parse_nonnegative<ssize_t>(),
+       "Checksums (see checksum-bits) of appended payloads of at least this "
+       "many bytes are computed on the thread calling append() instead of on "
+       "the worker thread sending the record, so that large appends don't "
+       "stall the worker's event loop. 0 disables.",
+       CLIENT,
+       SettingsCategory::WritePath);
+  init("e2e-latency-sampling-rate",
+       &e2e_latency_sampling_rate,
+       "0",
+       validate_range<double>(0, 1),
+       "Fraction of appends (between 0 and 1) whose records are tagged for "
+       "end-to-end latency tracing. Clients reading a tagged record report "
+       "the time between its timestamp, assigned by the sequencer when the "
+       "append arrives, and its delivery to the application, per log group "
+       "and separately for tailing and backfilling readers, in the "
+       "e2e_latency.tailing and e2e_latency.backfill histograms. The latency "
+       "is only as accurate as the clock synchronization between the "
+       "sequencer and the reader. Requires servers that support tracing; "
+       "0 disables.",
+       CLIENT,
+       SettingsCategory::Monitoring);
   init(
       "mutation-timeout",
       &mutation_timeout,
@@ -1753,8 +2178,12 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "true",
        nullptr, // no validation
        "If set, storage nodes will write the copyset index for all records. "
-       "This must be set before --rocksdb-use-copyset-index is enabled. "
-       "Doesn't affect copyset stickiness",
+       "Disabling it saves a key write per record, which matters for logs "
+       "with high rates of small records; LogsDB partitions that get records "
+       "without the copyset index are then read without it. With the legacy "
+       "unpartitioned store, this must be set before "
+       "--rocksdb-use-copyset-index is enabled. Doesn't affect copyset "
+       "stickiness",
        SERVER,
        SettingsCategory::WritePath);
   init("iterator-cache-ttl",
@@ -1874,6 +2303,22 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "from timestamps to LSNs in LogsDB data partitions.",
        SERVER,
        SettingsCategory::Performance);
+  init("storage-payload-compression-zstd-level",
+       &storage_payload_compression_zstd_level,
+       "3",
+       parse_validate_range<int>(1, ZSTD_maxCLevel()),
+       "Zstd compression level for record payloads of logs whose "
+       "storage_compression attribute is 'zstd'.",
+       SERVER,
+       SettingsCategory::Storage);
+  init("storage-payload-compression-min-size",
+       &storage_payload_compression_min_size,
+       "128",
+       parse_nonnegative<ssize_t>(),
+       "Record payloads smaller than this many bytes are stored uncompressed "
+       "even for logs with the storage_compression attribute.",
+       SERVER,
+       SettingsCategory::Storage);
   init("on-demand-logs-config",
        &on_demand_logs_config,
        "false",
@@ -1902,6 +2347,17 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "be.",
        CLIENT | REQUIRES_RESTART /* used in ClientImpl::create() */,
        SettingsCategory::Configuration);
+  init("remote-logs-config-disk-cache-path",
+       &remote_logs_config_disk_cache_path,
+       "",
+       nullptr, // no validation
+       "If not empty, path of a file where the remote logs config stores the "
+       "log groups it fetches from the cluster. At the next start, the client "
+       "uses them right away instead of waiting for a server to answer, and "
+       "refreshes them in the background. The file must not be shared by "
+       "clients running at the same time.",
+       CLIENT | REQUIRES_RESTART /* used in ClientImpl::create() */,
+       SettingsCategory::Configuration);
   init("alternative-layout-property",
        &alternative_layout_property,
        "",
@@ -1961,6 +2417,31 @@ void Settings::defineSettings(SettingEasyInit& init) {
       "externally before logdevice can do any ZooKeeper epoch store operations",
       SERVER | EXPERIMENTAL,
       SettingsCategory::Core);
+  init("zk-epoch-store-metadata-cache",
+       &zk_epoch_store_metadata_cache,
+       "false",
+       nullptr, // no validation
+       "Keep a write-through cache of the epoch metadata znodes in the "
+       "ZooKeeper epoch store, so that updates of the epoch metadata of a log, "
+       "such as sequencer activations, write the znode right away instead of "
+       "reading it first. Writes are conditional on the znode version, so if "
+       "another node changed the znode in the meantime the update is redone "
+       "from a fresh read. Requests that don't end up writing always read "
+       "the znode.",
+       SERVER,
+       SettingsCategory::Core);
+  init("zk-epoch-store-write-batch-size",
+       &zk_epoch_store_write_batch_size,
+       "1",
+       validate_positive<ssize_t>(),
+       "Maximum number of znode writes the ZooKeeper epoch store sends in one "
+       "multi-op. While a write is in flight, writes of other logs are "
+       "queued and then sent together, so activating many sequencers at once "
+       "takes fewer ZooKeeper round trips. If a multi-op fails because of "
+       "one of its writes, its writes are retried one by one. 1 disables "
+       "batching.",
+       SERVER,
+       SettingsCategory::Core);
   init("ssl-load-client-cert",
        &ssl_load_client_cert,
        "false",
@@ -1968,6 +2449,18 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "Set to include client certificate for mutual ssl authentication",
        CLIENT | REQUIRES_RESTART,
        SettingsCategory::Security);
+  init("ssl-ktls-offload",
+       &ssl_ktls_offload,
+       "false",
+       nullptr, // no validation
+       "Hand the record layer of established SSL connections to the kernel "
+       "(kTLS), so that encryption and decryption happen in the kernel "
+       "instead of in OpenSSL. Requires OpenSSL 3.0 built with kTLS support "
+       "and the Linux tls module. Connections whose cipher the kernel "
+       "doesn't support keep using userspace encryption. See the kTLS column "
+       "of 'info sockets'.",
+       SERVER | CLIENT | REQUIRES_RESTART /* used in Worker ctor */,
+       SettingsCategory::Security);
   init("ssl-cert-path",
        &ssl_cert_path,
        "",
@@ -2060,6 +2553,40 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "\"any\" or \"\" to keep the default.",
        SERVER | REQUIRES_RESTART /* used once when ExecStorageThread starts */,
        SettingsCategory::ResourceManagement);
+  init("numa-aware-storage-threads",
+       &numa_aware_storage_threads,
+       "false",
+       nullptr, // no validation
+       "Pin the storage threads of each shard to the cpus of the NUMA node "
+       "the shard's disk is attached to, and make them allocate memory from a "
+       "jemalloc arena dedicated to that node. Shards whose NUMA node can't "
+       "be determined (e.g. not on a local block device) are left unpinned. "
+       "See 'info shards' for the placement of each shard.",
+       SERVER | REQUIRES_RESTART /* used when storage threads start */ |
+           EXPERIMENTAL,
+       SettingsCategory::ResourceManagement);
+  init("worker-cpus",
+       &worker_cpus,
+       "",
+       [](const std::string& val) -> std::vector<int> {
+         std::vector<int> cpus;
+         if (numa::parseCpuList(val, &cpus) != 0) {
+           throw boost::program_options::error(
+               "value of --worker-cpus must be a list of cpus like "
+               "\"0-3,8\"; " +
+               val + " given.");
+         }
+         return cpus;
+       },
+       "Thread-per-core placement of general workers: worker i is pinned to "
+       "the i-th cpu of this list (wrapping around), and a new incoming "
+       "connection is handed to the worker pinned to the cpu that received "
+       "its first packets (SO_INCOMING_CPU), so that with NIC queues steered "
+       "to those cpus the whole network path of a connection stays on one "
+       "core. Connections arriving on other cpus go to a random worker. "
+       "Empty to leave workers unpinned.",
+       SERVER | REQUIRES_RESTART /* used when workers start */ | EXPERIMENTAL,
+       SettingsCategory::ResourceManagement);
 
   init("checksumming-enabled",
        &checksumming_enabled,
@@ -2157,6 +2684,25 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "Store polling in addition to the required response for each wave",
        CLIENT | SERVER,
        SettingsCategory::Configuration);
+  init("nodes-configuration-fetch-diffs",
+       &nodes_configuration_fetch_diffs,
+       "true",
+       nullptr, // no validation
+       "If true, server based Nodes Configuration Store polling asks servers "
+       "for a diff from the local NodesConfiguration version instead of the "
+       "full config. Servers that don't have the local version in their "
+       "history reply with the full config.",
+       CLIENT | SERVER,
+       SettingsCategory::Configuration);
+  init("nodes-configuration-diff-history-size",
+       &nodes_configuration_diff_history_size,
+       "16",
+       parse_nonnegative<ssize_t>(),
+       "How many recent NodesConfiguration versions this server keeps to "
+       "answer polls with a diff instead of the full config. 0 disables "
+       "diffs.",
+       SERVER | REQUIRES_RESTART,
+       SettingsCategory::Configuration);
   init("nodes-configuration-seed-servers",
        &nodes_configuration_seed_servers,
        "",
@@ -2266,6 +2812,21 @@ void Settings::defineSettings(SettingEasyInit& init) {
                                              StatsCollectionThread */
        ,
        SettingsCategory::Monitoring);
+  init("stats-rollup",
+       &stats_rollup,
+       "false",
+       nullptr, // no validation
+       "If true, collected stats are rolled up in-process into 1s, 10s and "
+       "1min buckets that only hold the counters that changed, and those are "
+       "published instead of full snapshots of all counters, so that the "
+       "cost of publishing scales with activity rather than with the number "
+       "of counters. Buckets can't be finer than --stats-collection-interval. "
+       "Falls back to publishing full snapshots if the stats publisher "
+       "doesn't support rollups.",
+       SERVER | CLIENT | REQUIRES_RESTART /* passed to ctor of
+                                             StatsCollectionThread */
+       ,
+       SettingsCategory::Monitoring);
   init(
       "esn-bits",
       &esn_bits,
@@ -2332,6 +2893,78 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "messages.",
        SERVER | CLIENT,
        SettingsCategory::Batching);
+  init("socket-batching-coalesce-threshold",
+       &socket_batching_coalesce_threshold,
+       "512",
+       parse_nonnegative<ssize_t>(),
+       "Messages whose serialized size is at most this many bytes are copied "
+       "into the buffer of the previous message batched for the same socket "
+       "rather than chained as a separate buffer. This reduces the number of "
+       "iovecs and allocations per write when sending many small messages. "
+       "Messages of priority MAX are never delayed by "
+       "socket-batching-time-trigger. 0 disables coalescing.",
+       SERVER | CLIENT,
+       SettingsCategory::Batching);
+  init("socket-write-chunk-size",
+       &socket_write_chunk_size,
+       "1M",
+       parse_nonnegative<ssize_t>(),
+       "Bounds how much data a busy connection has buffered ahead of a new "
+       "message. Once this many bytes are serialized for a socket but not "
+       "yet passed to TCP, messages of priority lower than MAX are queued "
+       "by priority instead of behind that data, and are serialized as the "
+       "socket drains. A large batch of records for a backlog or rebuilding "
+       "reader then delays an append-path message by at most about this "
+       "much data. 0 disables queueing by priority.",
+       SERVER | CLIENT,
+       SettingsCategory::Batching);
+  init("network-payload-compression",
+       &network_payload_compression,
+       "none",
+       parse_compression,
+       "Compression of RECORD and STORE payloads on the wire: 'none', 'zstd', "
+       "'lz4' or 'lz4_hc'. Only used for peers that support it, and for "
+       "payloads of messages in network-payload-compression-traffic-classes. "
+       "The payload is sent uncompressed if compression doesn't make it "
+       "smaller. Trades CPU for network bandwidth, e.g. for cross-region "
+       "reads and rebuilding.",
+       SERVER | CLIENT,
+       SettingsCategory::Network);
+  init("network-payload-compression-zstd-level",
+       &network_payload_compression_zstd_level,
+       "1",
+       parse_validate_range<int>(1, ZSTD_maxCLevel()),
+       "Zstd compression level to use for network-payload-compression.",
+       SERVER | CLIENT,
+       SettingsCategory::Network);
+  init("network-payload-compression-min-size",
+       &network_payload_compression_min_size,
+       "1024",
+       parse_nonnegative<ssize_t>(),
+       "Payloads smaller than this many bytes are sent uncompressed even if "
+       "network-payload-compression is enabled.",
+       SERVER | CLIENT,
+       SettingsCategory::Network);
+  init("network-payload-compression-traffic-classes",
+       &network_payload_compression_traffic_classes,
+       "READ_BACKLOG,REBUILD",
+       parse_traffic_classes,
+       "Comma-separated list of traffic classes whose RECORD and STORE "
+       "payloads are compressed if network-payload-compression is enabled. "
+       "See traffic_classes.inc for the list of traffic classes.",
+       SERVER | CLIENT,
+       SettingsCategory::Network);
+  init("receive-buffer-pool-size",
+       &receive_buffer_pool_size,
+       "1M",
+       parse_nonnegative<ssize_t>(),
+       "Amount of memory, per size class, that each worker keeps in freed "
+       "message receive buffers for reuse by subsequent messages, to avoid "
+       "allocator overhead when reading from sockets. Messages of 4KB to "
+       "256KB are read into pooled buffers with power-of-two size classes. "
+       "0 disables the pool.",
+       SERVER | CLIENT,
+       SettingsCategory::Network);
   init("sequencer-batching-time-trigger",
        &sequencer_batching_time_trigger,
        "1s",
@@ -2342,6 +2975,18 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "group doesn't override it",
        SERVER,
        SettingsCategory::Batching);
+  init("sequencer-batching-adaptive",
+       &sequencer_batching_adaptive,
+       "false",
+       nullptr, // no validation
+       "Sequencer batching (if used) treats the time trigger as a latency "
+       "budget rather than a fixed delay: based on the measured rate of "
+       "appends to a log, a new batch is flushed right away if no other "
+       "append is expected to arrive within the time trigger, and otherwise "
+       "when the batch is expected to reach the size trigger, but no later "
+       "than the time trigger.",
+       SERVER | EXPERIMENTAL,
+       SettingsCategory::Batching);
   init("sequencer-batching-size-trigger",
        &sequencer_batching_size_trigger,
        "-1",
@@ -2715,6 +3360,18 @@ void Settings::defineSettings(SettingEasyInit& init) {
        SERVER,
        SettingsCategory::Rebuilding);
 
+  init("event-log-max-delta-replay-time",
+       &event_log_max_delta_replay_time,
+       "30s",
+       validate_nonnegative<ssize_t>(),
+       "Snapshot the event log when replaying the deltas written since the "
+       "last snapshot is estimated to take longer than this. The estimate is "
+       "based on how fast this node replayed deltas on startup. Keeps the "
+       "time it takes for rebuilding to become ready after a restart bounded "
+       "when deltas are expensive to replay. 0 disables.",
+       SERVER,
+       SettingsCategory::Rebuilding);
+
   init("event-log-retention",
        &event_log_retention,
        "14d",
@@ -2887,6 +3544,56 @@ void Settings::defineSettings(SettingEasyInit& init) {
        SERVER,
        SettingsCategory::WritePath);
 
+  init("latency-aware-copyset-selection",
+       &latency_aware_copyset_selection,
+       "false",
+       nullptr, // no validation
+       "If true, sequencers draw two copysets for each record and use the one "
+       "expected to be stored sooner, according to an exponentially weighted "
+       "moving average of STORE latency of each shard, kept by each worker. "
+       "Helps append latency when a disk is slow but not failed, well before "
+       "graylisting kicks in. Store latencies are collected for this even if "
+       "--enable-store-histograms-calculations is off. Applies to epochs "
+       "activated after the change.",
+       SERVER,
+       SettingsCategory::WritePath);
+
+  init("latency-aware-copyset-selection-threshold",
+       &latency_aware_copyset_selection_threshold,
+       "2",
+       validate_range<double>(1, 1000),
+       "With --latency-aware-copyset-selection, the second copyset is only "
+       "used if the first one is expected to take at least this many times "
+       "longer to store. Keeps load distribution close to the weights when "
+       "shards have similar latencies.",
+       SERVER,
+       SettingsCategory::WritePath);
+
+  init("latency-aware-copyset-selection-min-latency",
+       &latency_aware_copyset_selection_min_latency,
+       "10ms",
+       validate_nonnegative<ssize_t>(),
+       "With --latency-aware-copyset-selection, copysets expected to be "
+       "stored within this time are used without looking for a faster one.",
+       SERVER,
+       SettingsCategory::WritePath);
+
+  init("copyset-table-size",
+       &copyset_table_size,
+       "0",
+       nullptr, // no validation
+       "If positive, once a sequencer picked this many copysets for an epoch, "
+       "it draws this many copysets in advance and uses them in rotation, "
+       "falling back to the copyset selector for entries with unavailable "
+       "shards. The table is redrawn when availability of shards in the "
+       "nodeset changes, at most once a second. Saves CPU for logs with high "
+       "append rates and big nodesets, at the cost of using fewer distinct "
+       "copysets. 0 disables. Not used with "
+       "--latency-aware-copyset-selection. Applies to epochs activated after "
+       "the change.",
+       SERVER,
+       SettingsCategory::WritePath);
+
   init("test-do-not-pick-in-copysets",
        &test_do_not_pick_in_copysets,
        "",
@@ -2929,6 +3636,18 @@ void Settings::defineSettings(SettingEasyInit& init) {
        CLIENT,
        SettingsCategory::Monitoring);
 
+  init("shadow-append-queue-size",
+       &shadow_append_queue_size,
+       "10000",
+       validate_positive<ssize_t>(),
+       "Maximum number of appends waiting to be sent to a shadow cluster. "
+       "Shadow appends are handed off to a dedicated thread per shadow "
+       "destination; when its queue is full, new shadow appends are dropped "
+       "rather than slowing down the original appends. Applies to shadow "
+       "clients created after the change. See traffic-shadow-enabled.",
+       CLIENT,
+       SettingsCategory::WritePath);
+
   init("enable-nodes-configuration-manager",
        &enable_nodes_configuration_manager,
        "false", // defaults to false
@@ -3106,6 +3825,28 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "When the real time buffer reaches this size, we evict entries.",
        SERVER | REQUIRES_RESTART | EXPERIMENTAL,
        SettingsCategory::ReadPath);
+  init("real-time-max-bytes-per-log",
+       &real_time_max_bytes_per_log,
+       "0",
+       nullptr, // no validation
+       "If nonzero, max size (in bytes) of released records of a single log "
+       "that we'll keep around for real time reads. A log that goes over "
+       "this has its records evicted, so that one high-throughput log can't "
+       "push the records of all other logs out of the real time buffer. "
+       "Like real-time-max-bytes, this is split evenly among workers.",
+       SERVER | REQUIRES_RESTART | EXPERIMENTAL,
+       SettingsCategory::ReadPath);
+  init("real-time-admission-control",
+       &real_time_admission_control,
+       "false",
+       nullptr, // no validation
+       "If true, once the real time buffer reaches "
+       "real-time-eviction-threshold-bytes, newly released records of a log "
+       "are only kept if readers tailing that log recently asked for records "
+       "at least as often as readers of the log that would be evicted to "
+       "make room.",
+       SERVER | REQUIRES_RESTART | EXPERIMENTAL,
+       SettingsCategory::ReadPath);
 
   init("test-timestamp-linear-transform",
        &test_timestamp_linear_transform,
@@ -3309,6 +4050,21 @@ void Settings::defineSettings(SettingEasyInit& init) {
        CLIENT,
        SettingsCategory::ReaderFailover);
 
+  init("reader-slow-shards-detection-speculative-percentile",
+       &reader_slow_shards_detection_settings.speculative_percentile,
+       "0",
+       validate_range<double>(0, 100),
+       "When slow shards detection is enabled and this is positive, a shard "
+       "that has not completed the current window is filtered out as soon as "
+       "it has been slower than this percentile of the recent window "
+       "completion latencies of the other shards, instead of waiting for the "
+       "outlier detection algorithm to be confident it is an outlier. The "
+       "rewinds done to filter out such shards keep the records already "
+       "received instead of reading the whole window again. 0 disables "
+       "speculative detection.",
+       CLIENT | EXPERIMENTAL,
+       SettingsCategory::ReaderFailover);
+
   init("rsm-include-read-pointer-in-snapshot",
        &rsm_include_read_pointer_in_snapshot,
        "true",
@@ -3417,6 +4173,40 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "Timeout for appends. If omitted the client timeout will be used.",
        CLIENT,
        SettingsCategory::Core);
+  init("sequencer-redirect-cache-ttl",
+       &sequencer_redirect_cache_ttl,
+       "5s",
+       validate_nonnegative<ssize_t>(),
+       "When a sequencer redirects an append to another node, further appends "
+       "to the log from this client go straight to that node for this long, "
+       "as long as the same node would be picked for the log. The first "
+       "redirect to a node also opens connections to it from all workers. 0 "
+       "disables this.",
+       CLIENT,
+       SettingsCategory::Sequencer);
+  init("tail-info-cache-ttl",
+       &tail_info_cache_ttl,
+       "0",
+       validate_nonnegative<ssize_t>(),
+       "If positive, getTailLSN(), getTailAttributes() and isLogEmpty() may "
+       "return what the log's sequencer answered to this client up to this "
+       "long ago instead of asking it again. Useful for clients polling the "
+       "tails of many logs, which can tolerate missing the most recent "
+       "appends. 0 disables this.",
+       CLIENT,
+       SettingsCategory::Core);
+  init("client-append-window",
+       &client_append_window,
+       "0",
+       nullptr,
+       "Maximum number of appends to a log that a client worker thread keeps "
+       "in flight, 0 for no limit. Further appends to the log wait in FIFO "
+       "order, their timeout running, until an earlier one completes. The "
+       "limit halves when the sequencer pushes back (SEQNOBUFS, OVERLOADED, "
+       "SEQSYSLIMIT or a timeout) and grows back by one per window of "
+       "successful appends. Does not apply to stream appends.",
+       CLIENT,
+       SettingsCategory::Core);
   init("logsconfig-timeout",
        &logsconfig_timeout,
        "",
@@ -3452,6 +4242,16 @@ void Settings::defineSettings(SettingEasyInit& init) {
        "and use HHWheelTimer backend.",
        SERVER | CLIENT | REQUIRES_RESTART,
        SettingsCategory::Core);
+  init("enable-event-loop-wheel-timers",
+       &enable_event_loop_wheel_timers,
+       "false",
+       nullptr, // no validation
+       "Run the timers of each worker on a hierarchical timer wheel driven by "
+       "the worker's own event loop: O(1) activation and cancellation, and "
+       "batched expiry per tick (10ms), without a hop through another thread. "
+       "Takes precedence over --enable-hh-wheel-backed-timers.",
+       SERVER | CLIENT | REQUIRES_RESTART,
+       SettingsCategory::Core);
   init("enable-store-histograms-calculations",
        &enable_store_histogram_calculations,
        "false",
@@ -3561,6 +4361,51 @@ void Settings::defineSettings(SettingEasyInit& init) {
        SERVER,
        SettingsCategory::Sequencer);
 
+  init("sequencer-rebalancing-interval",
+       &sequencer_rebalancing_interval,
+       "0s",
+       validate_nonnegative<ssize_t>(),
+       "If not zero, sequencer nodes check the append throughput of their "
+       "sequencers this often, and when it exceeds "
+       "--sequencer-rebalancing-throughput-threshold, move their hottest logs "
+       "to the nodes the logs would map to if this node didn't run "
+       "sequencers. Appends to a moved log are redirected to its new node "
+       "for --sequencer-rebalancing-hold-time. Only used with lazy sequencer "
+       "placement.",
+       SERVER | REQUIRES_RESTART,
+       SettingsCategory::Sequencer);
+
+  init("sequencer-rebalancing-throughput-threshold",
+       &sequencer_rebalancing_throughput_threshold,
+       "100M",
+       parse_positive<size_t>(),
+       "Append throughput in bytes per second, measured over the last minute, "
+       "above which sequencer rebalancing (--sequencer-rebalancing-interval) "
+       "moves logs off a node. Logs that are this hot on their own are not "
+       "moved, since they would overload any node they move to.",
+       SERVER,
+       SettingsCategory::Sequencer);
+
+  init("sequencer-rebalancing-max-migrations-per-minute",
+       &sequencer_rebalancing_max_migrations_per_minute,
+       "10",
+       nullptr,
+       "Maximum number of logs a node moves to other nodes per minute with "
+       "sequencer rebalancing (--sequencer-rebalancing-interval). Each move "
+       "costs a sequencer activation and recovery on the target node.",
+       SERVER,
+       SettingsCategory::Sequencer);
+
+  init("sequencer-rebalancing-hold-time",
+       &sequencer_rebalancing_hold_time,
+       "10min",
+       validate_positive<ssize_t>(),
+       "How long a node keeps redirecting appends to a log that sequencer "
+       "rebalancing (--sequencer-rebalancing-interval) moved off it. After "
+       "that, appends are routed to the node the log maps to again.",
+       SERVER,
+       SettingsCategory::Sequencer);
+
   sequencer_boycotting.defineSettings(init);
 
   init("require-permission-message-types",
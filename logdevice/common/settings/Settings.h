@@ -9,6 +9,7 @@
 
 #include <chrono>
 #include <string>
+#include <unordered_set>
 
 #include <folly/Optional.h>
 
@@ -18,6 +19,7 @@
 #include "logdevice/common/Sockaddr.h"
 #include "logdevice/common/StorageTask-enums.h"
 #include "logdevice/common/configuration/NodeLocation.h"
+#include "logdevice/common/configuration/TrafficClass.h"
 #include "logdevice/common/protocol/MessageType.h"
 #include "logdevice/common/settings/ClientReadStreamFailureDetectorSettings.h"
 #include "logdevice/common/settings/Durability.h"
@@ -123,6 +125,11 @@ struct Settings : public SettingsBundle {
   // transitions into an UNHEALTHY state in the HM.
   double health_monitor_max_stalled_worker_percentage;
 
+  // If true, storage nodes that HealthMonitor finds overloaded or unhealthy
+  // answer CHECK_NODE_HEALTH with OVERLOADED so that sequencers pick other
+  // nodes for new writes.
+  bool health_monitor_shed_load;
+
   // Used to simulate delayed request execution in a worker thread by adding a
   // fixed value onto the real execution time. Expressed as a percentage: 100 =
   // 100%.
@@ -224,6 +231,18 @@ struct Settings : public SettingsBundle {
   // Limits the number of idle connections closed during single check
   size_t rate_limit_idle_connection_closed;
 
+  // (client-only setting) If true, clients created by ClientFactory for the
+  // same config, cluster name and credentials share workers, connections and
+  // config subscriptions, see ClientRuntime.
+  bool share_client_runtime;
+
+  // Number of DATA connections a worker keeps to each other node for
+  // messages that only need per-log ordering (STOREs, see
+  // Message::getStripeKey()). The connection is picked by log id, so that a
+  // busy sequencer's traffic to a storage node is spread over several TCP
+  // streams, and over several workers on the receiving side.
+  size_t data_connection_stripes;
+
   // How many kilobytes of RECORD messages the delivery code tries to push
   // to the client at once.  If -1, use the TCP sendbuf size.
   int output_max_records_kb;
@@ -235,6 +254,40 @@ struct Settings : public SettingsBundle {
   // Maximum execution time for reading records
   std::chrono::milliseconds max_record_read_execution_time;
 
+  // If true, records read by storage threads are kept in refcounted buffers
+  // whose payloads RECORD messages reference without copying. Payloads in the
+  // real time record buffer are also shared rather than copied per reader.
+  bool zero_copy_record_delivery;
+
+  // Max total size of record batches read by storage threads that each worker
+  // keeps for other read streams reading the same range of the same log.
+  // 0 disables the read result cache.
+  size_t read_result_cache_max_bytes;
+
+  // Batches in the read result cache older than this are not used.
+  std::chrono::milliseconds read_result_cache_ttl;
+
+  // Maximum number of catch-up reads of different logs of the same client and
+  // shard to bundle into a single storage task. 1 disables batching.
+  size_t multi_log_read_batch_size;
+
+  // Maximum number of small records read back to back by a read stream that
+  // storage nodes send in a single MULTI_RECORD message. 1 disables batching.
+  size_t read_record_batch_size;
+
+  // Upper bound on the read-ahead size picked for iterators of read streams
+  // that scan a backlog (see AdaptiveReadahead). 0 disables read-ahead.
+  size_t catchup_readahead_max_size;
+
+  // Number of consecutive storage task batches that have to end on a read
+  // limit before a read stream is considered to be scanning sequentially.
+  size_t catchup_readahead_min_batches;
+
+  // If true, the bytes a storage task of a catching up read stream may read
+  // adapt to the client's consumption rate and the stream's storage task
+  // latency (see AdaptiveBatchSize), bounded by max_record_bytes_read_at_once.
+  bool catchup_adaptive_batch_size;
+
   // @deprecated
   unsigned requests_from_pipe;
 
@@ -246,6 +299,21 @@ struct Settings : public SettingsBundle {
   uint32_t mid_requests_per_iteration;
   uint32_t lo_requests_per_iteration;
 
+  // If nonzero, the number of requests processed per worker event loop
+  // iteration adapts so that iterations take about this long, starting from
+  // the sum of the *_requests_per_iteration settings.
+  std::chrono::microseconds event_loop_target_latency;
+
+  // Workers measure the thread CPU time of about one in this many requests,
+  // message callbacks and storage task responses, to estimate the
+  // *_worker_cpu_usec stats. 0 disables.
+  uint32_t worker_cpu_time_sample_period;
+
+  // General workers listed in busy_poll_workers poll for events without
+  // sleeping until they have been idle for busy_poll_duration.
+  std::vector<int> busy_poll_workers;
+  std::chrono::microseconds busy_poll_duration;
+
   // Size worker request pipe to hold this many requests.
   //
   // NOTE: This currently translates to a fcntl(F_SETPIPE_SZ) call which is
@@ -337,6 +405,19 @@ struct Settings : public SettingsBundle {
   // size of the record cache
   std::chrono::seconds record_cache_monitor_interval;
 
+  // how often the record caches that changed are written to the local log
+  // store in the background, 0 to only write them on shutdown
+  std::chrono::seconds record_cache_checkpoint_interval;
+
+  // mark checkpoints that wrote every changed cache with the local log store
+  // sequence number they're consistent with, and repopulate them after a
+  // crash, except for the caches of logs written after that
+  bool record_cache_recover_checkpoints;
+
+  // largest segment that the record cache packs payloads of cached records
+  // into, 0 to keep each record's payload in the buffer it arrived in
+  size_t record_cache_slab_segment_size;
+
   // When an ld_check() fails, call abort().  If not, just continue
   // executing.  We'll log either way.
   bool abort_on_failed_check;
@@ -353,6 +434,11 @@ struct Settings : public SettingsBundle {
   // stalled thread(s) will be logged into the log file.
   bool watchdog_print_bt_on_stall;
 
+  // If true, and watchdog detects a stall, it captures the stack of the
+  // stalled thread(s) and the Request or message they are running, logs it
+  // and aggregates it for the "info stalls" admin command.
+  bool watchdog_capture_stacks_on_stall;
+
   // If true, the NodeSetFinder within PurgeUncleanEpochs will use
   // only the metadata log as source for fetching historical metadata.
   // TODO: T28014582
@@ -415,6 +501,22 @@ struct Settings : public SettingsBundle {
   // chain.
   bool disable_chain_sending;
 
+  // If set, storage nodes forward chain-sent STOREs of appends as soon as
+  // they're validated, instead of after the seal check.
+  bool chain_sending_cut_through;
+
+  // If set, sequencers shrink the window of appends in flight of an epoch
+  // when storage nodes push back, and grow it back as appends succeed.
+  bool sequencer_window_adaptive;
+
+  // With sequencer_window_adaptive, appends taking longer than this to get
+  // fully replicated also shrink the window. 0 disables this.
+  std::chrono::milliseconds sequencer_window_latency_target;
+
+  // If set, Appenders ask storage nodes to report how long each STORE spent
+  // queued and writing, to break down append latency by stage.
+  bool append_stage_times;
+
   // Time interval that a node health check probe is sent if there is
   // an outstanding probe from the same node in nodeset
   std::chrono::seconds node_health_check_retry_interval;
@@ -481,6 +583,10 @@ struct Settings : public SettingsBundle {
   // as soon as they are deserialized.
   bool inline_message_execution;
 
+  // If true, requests that can run on any general worker are posted to a
+  // lightly loaded one instead of a random one.
+  bool load_aware_request_placement;
+
   // Maximum number of writes for a storage thread to perform in one batch.
   size_t write_batch_size;
 
@@ -488,12 +594,21 @@ struct Settings : public SettingsBundle {
   //   unless write_batch_size is reached first.
   size_t write_batch_bytes;
 
+  // If true, writes a worker hands to a shard's storage threads in the same
+  // event loop iteration share one WriteBatchStorageTask on the main queue,
+  // instead of posting one each.
+  bool coalesce_write_batch_tasks;
+
   // SLOW threadpool storage tasks go through the DRR scheduler.
   bool storage_tasks_use_drr;
 
   // Quanta for the DRR scheduler.
   uint64_t storage_tasks_drr_quanta = 1;
 
+  // If true, principals are charged for the IO time of their SLOW storage
+  // tasks in microseconds rather than 1 per task.
+  bool storage_tasks_drr_charge_io_time;
+
   // Shares for StorageTask principals.
   std::array<StorageTaskShare, (uint64_t)StorageTaskPrincipal::NUM_PRINCIPALS>
       storage_task_shares;
@@ -530,6 +645,9 @@ struct Settings : public SettingsBundle {
   chrono_expbackoff_t<std::chrono::milliseconds>
       release_broadcast_interval_internal_logs;
 
+  // See .cpp
+  bool release_batching;
+
   bool skip_recovery;
 
   // Maximum number of LogRecoveryRequests for data logs that can be running
@@ -537,6 +655,11 @@ struct Settings : public SettingsBundle {
   // metadata recoveries running.
   int concurrent_log_recoveries;
 
+  // See .cpp
+  int max_log_recoveries_per_shard;
+  bool seal_batching;
+  size_t recovery_queue_scan_limit;
+
   // If true, purging will get the EpochRecoveryMetadata even if the epoch
   // is empty locally on the node
   bool get_erm_for_empty_epoch;
@@ -582,6 +705,10 @@ struct Settings : public SettingsBundle {
   // processed before returning to the libevent loop
   size_t appender_buffer_process_batch;
 
+  // Maximum number of freed Appenders each worker keeps around for reuse by
+  // later appends. 0 disables caching.
+  size_t appender_pool_size;
+
   // Skip sending data to storage node from appender . So that it remains
   // in worker map to test abort or recreate appender leak scenario etc.
   bool test_appender_skip_stores;
@@ -666,10 +793,20 @@ struct Settings : public SettingsBundle {
   // but also wire chatter.
   double client_read_flow_control_threshold;
 
+  // (client-only setting) If true, the WINDOW and STOP messages that the read
+  // streams of a worker send to a storage node within one event loop
+  // iteration are batched into a single READ_CONTROL message, for nodes that
+  // support it.
+  bool read_control_batching;
+
   // (client-only setting) maximum number of epoch metadata entries cached in
   // the client. Set it to 0 to disable epoch metadata caching
   size_t client_epoch_metadata_cache_size;
 
+  // (client-only setting) how long a soft (not yet confirmed consistent)
+  // entry of the epoch metadata cache can be used
+  std::chrono::milliseconds client_epoch_metadata_cache_soft_ttl;
+
   // (client-only setting) Period for logging in logdevice_readers_flow scuba
   // table. Set it to 0 to disable feature.
   std::chrono::milliseconds client_readers_flow_tracer_period;
@@ -717,6 +854,16 @@ struct Settings : public SettingsBundle {
   // reasonable space overhead (4 bytes) and is fast with SSE4.2.
   int checksum_bits;
 
+  // (client-only setting) Checksums of payloads of at least this many bytes
+  // are computed on the thread calling append() rather than on the Worker.
+  // 0 disables.
+  size_t precompute_checksum_min_size;
+
+  // (client-only setting) Fraction of appends whose records are tagged for
+  // end-to-end latency tracing. Readers report the time from append to
+  // delivery of tagged records in the e2e_latency.* histograms.
+  double e2e_latency_sampling_rate;
+
   // Initial timeout used during the mutation phase of recovery. If replicating
   // a record takes longer, Mutator will try to pick a few extra nodes to send
   // mutations to.
@@ -806,6 +953,14 @@ struct Settings : public SettingsBundle {
   // When true, the findTime index is written.
   bool write_find_time_index;
 
+  // Zstd compression level for payloads of logs with the storage_compression
+  // attribute set to zstd.
+  int storage_payload_compression_zstd_level;
+
+  // Payloads smaller than this are stored uncompressed even for logs with
+  // the storage_compression attribute.
+  size_t storage_payload_compression_min_size;
+
   // (client-only setting) When set to true on the client, this will get the
   // log configuration from the server on-demand, if it's not present in the
   // main config file.
@@ -826,6 +981,10 @@ struct Settings : public SettingsBundle {
   // the client will be.
   std::chrono::seconds remote_logs_config_cache_ttl;
 
+  // (client-only setting) If not empty, the remote logs config persists the
+  // log groups it fetches in this file and uses them on the next start.
+  std::string remote_logs_config_disk_cache_path;
+
   // (server-only setting) Override the client FindKeyAccuracy setting with
   // FindKeyAccuracy::APPROXIMATE.
   bool findtime_force_approximate;
@@ -837,6 +996,15 @@ struct Settings : public SettingsBundle {
   // the root znodes should be created by external tooling.
   bool zk_create_root_znodes;
 
+  // If `true`, the Zookeeper epoch store remembers the epoch metadata znodes
+  // it read or wrote, and bases read-modify-writes of them (e.g. sequencer
+  // activations) on the remembered value instead of reading it again.
+  bool zk_epoch_store_metadata_cache;
+
+  // Maximum number of znode writes of the Zookeeper epoch store that are sent
+  // together in one multi-op, 1 to send every write on its own.
+  size_t zk_epoch_store_write_batch_size;
+
   // Maximum amount of memory that can be allocated by read storage tasks.
   size_t read_storage_tasks_max_mem_bytes;
 
@@ -854,6 +1022,10 @@ struct Settings : public SettingsBundle {
 
   bool ssl_load_client_cert;
 
+  // Ask OpenSSL to offload encryption of established TLS connections to the
+  // kernel (kTLS), if both the kernel and the negotiated cipher support it.
+  bool ssl_ktls_offload;
+
   // TTL for the cert loaded from file
   std::chrono::seconds ssl_cert_refresh_interval;
 
@@ -879,6 +1051,15 @@ struct Settings : public SettingsBundle {
   // See man ioprio_set for possible values.
   folly::Optional<std::pair<int, int>> slow_ioprio;
 
+  // If true, storage threads of each shard are pinned to the cpus of the NUMA
+  // node the shard's disk is attached to.
+  bool numa_aware_storage_threads;
+
+  // If not empty, general worker i is pinned to worker_cpus[i % size], and
+  // incoming connections are handed to the worker pinned to the cpu their
+  // packets arrive on.
+  std::vector<int> worker_cpus;
+
   // (client-only setting) Timeout after which ClientReadStream considers a
   // storage node down if it does not send any data for some time but the socket
   // to it remains open. This can happen if:
@@ -923,6 +1104,14 @@ struct Settings : public SettingsBundle {
   // polling in addition to the required response for each wave
   size_t server_based_nodes_configuration_store_polling_extra_requests;
 
+  // If true, server based Nodes Configuration Store polling asks servers for
+  // a diff from the local version instead of the full config.
+  bool nodes_configuration_fetch_diffs;
+
+  // How many recent NodesConfiguration versions a server keeps to answer
+  // polls with diffs. 0 disables diffs on this server.
+  size_t nodes_configuration_diff_history_size;
+
   // The seed string that will be used to fetch the initial nodes configuration
   // It can be in the form string:<server1>,<server2>,etc. Or you can provide an
   // smc tier via "smc:<smc_tier>". If it's empty, NCM client bootstrapping is
@@ -981,6 +1170,10 @@ struct Settings : public SettingsBundle {
   // Set to <=0 to disable collection of stats.
   std::chrono::seconds stats_collection_interval;
 
+  // If true, stats are rolled up at several resolutions and only the
+  // counters that changed are published. See StatsRollup.h.
+  bool stats_rollup;
+
   // How long should we wait before disabling isolated sequencers.
   std::chrono::seconds isolated_sequencer_ttl;
 
@@ -1012,8 +1205,43 @@ struct Settings : public SettingsBundle {
   // buffered append is this old.  See BufferedWriter::Options.
   std::chrono::milliseconds sequencer_batching_time_trigger;
 
+  // If true, sequencer_batching_time_trigger (or the log attribute) is the
+  // upper bound on how long appends are buffered, and the actual flush time
+  // is picked per log based on the append rate.  See
+  // BufferedWriter::LogOptions::adaptive_time_trigger.
+  bool sequencer_batching_adaptive;
+
   std::chrono::milliseconds socket_batching_time_trigger;
 
+  // Serialized messages of at most this many bytes are copied into the tail
+  // of the previous buffer in the pending write chain instead of being
+  // chained as a buffer of their own, so that a batch of small messages is
+  // written with few iovecs. 0 disables coalescing.
+  size_t socket_batching_coalesce_threshold;
+
+  // Once a connection has this many bytes serialized but not yet passed to
+  // TCP, further messages below Priority::MAX wait in a per-connection
+  // priority queue and are serialized in priority order as the socket
+  // drains. 0 disables.
+  size_t socket_write_chunk_size;
+
+  // Compression of RECORD and STORE payloads on the wire, for peers that
+  // support it. NONE disables. See PayloadCompression.h.
+  Compression network_payload_compression;
+
+  // Zstd compression level for network_payload_compression.
+  int network_payload_compression_zstd_level;
+
+  // Payloads smaller than this are sent uncompressed.
+  size_t network_payload_compression_min_size;
+
+  // Only messages of these traffic classes get their payloads compressed.
+  std::unordered_set<TrafficClass> network_payload_compression_traffic_classes;
+
+  // Bytes of freed message receive buffers each worker keeps for reuse, per
+  // size class (see ReceiveBufferPool). 0 disables the pool.
+  size_t receive_buffer_pool_size;
+
   // DEPRECATED! Corresponding log attribute should be used instead.
   // Sequencer batching flushes buffered appends for a log when the total
   // amount of buffered uncompressed data reaches this many bytes (if
@@ -1089,6 +1317,10 @@ struct Settings : public SettingsBundle {
   // and use HHWheelTimer backend.
   bool enable_hh_wheel_backed_timers;
 
+  // If true, timers of workers use the HHWheelTimer of the worker's own
+  // EventBase. Takes precedence over enable_hh_wheel_backed_timers.
+  bool enable_event_loop_wheel_timers;
+
   // If true, use the new version of timers which run on a different thread
   // and use HHWheelTimer backend.
   bool enable_store_histogram_calculations;
@@ -1168,6 +1400,10 @@ struct Settings : public SettingsBundle {
   // it.
   size_t event_log_max_delta_bytes;
 
+  // Snapshot the event log when replaying the deltas since the last snapshot
+  // is estimated to take longer than this on startup.
+  std::chrono::milliseconds event_log_max_delta_replay_time;
+
   // If the event log is snapshotted, how long to keep a history of snapshots
   // and delta.
   std::chrono::milliseconds event_log_retention;
@@ -1279,6 +1515,14 @@ struct Settings : public SettingsBundle {
 
   NodeLocationScope copyset_locality_min_scope;
 
+  // See .cpp
+  bool latency_aware_copyset_selection;
+  double latency_aware_copyset_selection_threshold;
+  std::chrono::milliseconds latency_aware_copyset_selection_min_latency;
+
+  // See .cpp
+  size_t copyset_table_size;
+
   // Defaults to false, allows clients to opt-in to traffic shadowing
   bool traffic_shadow_enabled;
 
@@ -1289,6 +1533,9 @@ struct Settings : public SettingsBundle {
   // See .cpp
   std::chrono::milliseconds shadow_client_timeout;
 
+  // See .cpp
+  size_t shadow_append_queue_size;
+
   // Defaults to false, should only be set by traffic shadowing framework
   bool shadow_client;
 
@@ -1352,6 +1599,17 @@ struct Settings : public SettingsBundle {
   // entries.
   size_t real_time_eviction_threshold_bytes;
 
+  // (server-only setting) If nonzero, max size in bytes of released records of
+  // a single log in the real time buffer.  A log going over this is evicted,
+  // instead of records of other logs.
+  size_t real_time_max_bytes_per_log;
+
+  // (server-only setting) If true, once the real time buffer is over the
+  // eviction threshold, released records of a log are only admitted if
+  // readers recently wanted that log at least as often as the least recently
+  // used log in the buffer.
+  bool real_time_admission_control;
+
   // Test Options:
 
   // This option should only be used in tests. This is used to linerarly
@@ -1400,6 +1658,19 @@ struct Settings : public SettingsBundle {
 
   folly::Optional<std::chrono::milliseconds> append_timeout;
 
+  // How long clients send appends straight to the node a log's sequencer
+  // redirected them to. 0 disables the cache.
+  std::chrono::milliseconds sequencer_redirect_cache_ttl;
+
+  // How old a cached answer of a sequencer to getTailLSN(),
+  // getTailAttributes() or isLogEmpty() may be for the client to reuse it
+  // instead of asking again. 0 disables the cache.
+  std::chrono::milliseconds tail_info_cache_ttl;
+
+  // Maximum number of appends to a log a client worker has in flight at a
+  // time, 0 for no limit. The actual limit adapts to sequencer backpressure.
+  size_t client_append_window;
+
   folly::Optional<std::chrono::milliseconds> logsconfig_timeout;
 
   folly::Optional<std::chrono::milliseconds> meta_api_timeout;
@@ -1419,6 +1690,15 @@ struct Settings : public SettingsBundle {
   std::chrono::milliseconds nodeset_adjustment_min_window;
   size_t nodeset_max_randomizations;
 
+  // Sequencer rebalancing: how often a sequencer node checks the append
+  // throughput of its sequencers (0 to never), the throughput above which it
+  // moves its hottest logs to other nodes, how many logs it may move per
+  // minute, and how long appends to a moved log keep being redirected.
+  std::chrono::milliseconds sequencer_rebalancing_interval;
+  size_t sequencer_rebalancing_throughput_threshold;
+  size_t sequencer_rebalancing_max_migrations_per_minute;
+  std::chrono::milliseconds sequencer_rebalancing_hold_time;
+
   // Use metadata logs in NodeSetFinder if true, otherwise use sequencers
   // (metadata logs v2) and fallback to metadata logs if needed.
   // TODO: set default to false (or remove option) when 2.35 is deployed
@@ -47,4 +47,22 @@ struct ClientHistograms : public HistogramBundle {
   LatencyHistogram nodes_configuration_manager_propagation_latency;
 };
 
+/**
+ * Latency from append to delivery of the records of one log group that were
+ * sampled for end-to-end tracing, see Settings::e2e_latency_sampling_rate
+ * and ClientReadStream::recordE2ELatency().
+ */
+struct E2ELatencyHistograms : public HistogramBundle {
+  HistogramBundle::MapType getMap() override {
+    return {
+        {"e2e_latency.tailing", &tailing},
+        {"e2e_latency.backfill", &backfill},
+    };
+  }
+  // Records delivered to readers that were caught up with the log.
+  CompactLatencyHistogram tailing;
+  // Records delivered to readers that were behind, reading older data.
+  CompactLatencyHistogram backfill;
+};
+
 }} // namespace facebook::logdevice
@@ -0,0 +1,302 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/stats/HeavyHitters.h"
+
+#include <algorithm>
+#include <limits>
+#include <unordered_set>
+
+#include <folly/hash/Hash.h>
+#include <folly/hash/SpookyHashV2.h>
+
+#include "logdevice/common/debug.h"
+
+namespace facebook { namespace logdevice {
+
+constexpr size_t HeavyHitters::DEFAULT_WIDTH;
+constexpr size_t HeavyHitters::DEFAULT_DEPTH;
+constexpr size_t WindowedHeavyHitters::NUM_WINDOWS;
+
+HeavyHitters::HeavyHitters(size_t top_k, size_t width, size_t depth)
+    : top_k_(top_k),
+      width_(width),
+      depth_(depth),
+      counters_(width * depth, 0) {
+  ld_check(width_ > 0);
+  ld_check(depth_ > 0);
+}
+
+folly::small_vector<size_t, HeavyHitters::DEFAULT_DEPTH>
+HeavyHitters::counterIndices(folly::StringPiece key) const {
+  uint64_t h1 = 0x9ae16a3b2f90404fULL;
+  uint64_t h2 = 0xc3a5c85c97cb3127ULL;
+  folly::hash::SpookyHashV2::Hash128(key.data(), key.size(), &h1, &h2);
+  // One hash per row derived from two (Kirsch & Mitzenmacher, "Less Hashing,
+  // Same Performance"). Mixed before taking the remainder, otherwise two keys
+  // colliding in two rows would collide in all of them.
+  folly::small_vector<size_t, DEFAULT_DEPTH> res;
+  for (size_t row = 0; row < depth_; ++row) {
+    res.push_back(row * width_ +
+                  folly::hash::twang_mix64(h1 + row * h2) % width_);
+  }
+  return res;
+}
+
+uint64_t HeavyHitters::addToSketch(folly::StringPiece key, uint64_t n) {
+  // Conservative update: only raise the counters that are below the new
+  // estimate. Estimates stay upper bounds but are much tighter.
+  auto indices = counterIndices(key);
+  uint64_t est = std::numeric_limits<uint64_t>::max();
+  for (size_t idx : indices) {
+    est = std::min(est, counters_[idx]);
+  }
+  est += n;
+  for (size_t idx : indices) {
+    counters_[idx] = std::max(counters_[idx], est);
+  }
+  return est;
+}
+
+uint64_t HeavyHitters::estimate(folly::StringPiece key) const {
+  uint64_t est = std::numeric_limits<uint64_t>::max();
+  for (size_t idx : counterIndices(key)) {
+    est = std::min(est, counters_[idx]);
+  }
+  return est;
+}
+
+void HeavyHitters::add(folly::StringPiece key, uint64_t n) {
+  if (n == 0) {
+    return;
+  }
+  total_ += n;
+  uint64_t est = addToSketch(key, n);
+  if (top_k_ == 0) {
+    return;
+  }
+
+  auto it = top_.find(key);
+  if (it != top_.end()) {
+    // Exact from the moment the key got into the top.
+    it->second += n;
+  } else if (top_.size() < top_k_) {
+    top_.emplace(key.str(), est);
+    if (top_.size() == top_k_) {
+      updateTopMin();
+    }
+  } else if (est > top_min_) {
+    offer(key, est);
+  }
+}
+
+void HeavyHitters::offer(folly::StringPiece key, uint64_t count) {
+  ld_check_eq(top_.size(), top_k_);
+  auto min_it = std::min_element(
+      top_.begin(), top_.end(), [](const auto& a, const auto& b) {
+        return a.second < b.second;
+      });
+  if (count <= min_it->second) {
+    // top_min_ was stale, top keys have grown since.
+    top_min_ = min_it->second;
+    return;
+  }
+  top_.erase(min_it);
+  top_.emplace(key.str(), count);
+  updateTopMin();
+}
+
+void HeavyHitters::updateTopMin() {
+  top_min_ = std::numeric_limits<uint64_t>::max();
+  for (const auto& kv : top_) {
+    top_min_ = std::min(top_min_, kv.second);
+  }
+}
+
+uint64_t HeavyHitters::count(folly::StringPiece key) const {
+  auto it = top_.find(key);
+  return it != top_.end() ? it->second : estimate(key);
+}
+
+void HeavyHitters::merge(const HeavyHitters& other) {
+  ld_check_eq(width_, other.width_);
+  ld_check_eq(depth_, other.depth_);
+
+  // Totals of the candidates for the top, taken before the sketches are
+  // added up so that exact counts on either side are used.
+  folly::F14FastMap<std::string, uint64_t> candidates;
+  for (const auto& kv : top_) {
+    candidates.emplace(kv.first, 0);
+  }
+  for (const auto& kv : other.top_) {
+    candidates.emplace(kv.first, 0);
+  }
+  for (auto& kv : candidates) {
+    kv.second = count(kv.first) + other.count(kv.first);
+  }
+
+  for (size_t i = 0; i < counters_.size(); ++i) {
+    counters_[i] += other.counters_[i];
+  }
+  total_ += other.total_;
+
+  std::vector<std::pair<std::string, uint64_t>> top(
+      candidates.begin(), candidates.end());
+  if (top.size() > top_k_) {
+    std::nth_element(top.begin(),
+                     top.begin() + top_k_,
+                     top.end(),
+                     [](const auto& a, const auto& b) {
+                       return a.second > b.second;
+                     });
+    top.resize(top_k_);
+  }
+  top_.clear();
+  for (auto& kv : top) {
+    top_.emplace(std::move(kv.first), kv.second);
+  }
+  top_min_ = 0;
+  if (top_k_ > 0 && top_.size() == top_k_) {
+    updateTopMin();
+  }
+}
+
+void HeavyHitters::clear() {
+  std::fill(counters_.begin(), counters_.end(), 0);
+  total_ = 0;
+  top_.clear();
+  top_min_ = 0;
+}
+
+std::vector<std::pair<std::string, uint64_t>> HeavyHitters::top() const {
+  std::vector<std::pair<std::string, uint64_t>> res(top_.begin(), top_.end());
+  std::sort(res.begin(), res.end(), [](const auto& a, const auto& b) {
+    return a.second > b.second;
+  });
+  return res;
+}
+
+WindowedHeavyHitters::WindowedHeavyHitters(std::chrono::milliseconds span,
+                                           size_t top_k)
+    : span_(span),
+      window_len_(std::max(std::chrono::milliseconds(1),
+                           span / (NUM_WINDOWS - 1))),
+      top_k_(top_k) {}
+
+void WindowedHeavyHitters::add(folly::StringPiece key,
+                               uint64_t n,
+                               std::chrono::milliseconds now) {
+  const int64_t id = now.count() / window_len_.count();
+  Window& w = windows_[id % NUM_WINDOWS];
+  if (w.id != id) {
+    if (w.id > id) {
+      // `now` went back in time, drop the value.
+      return;
+    }
+    if (w.hh) {
+      w.hh->clear();
+    } else {
+      w.hh = std::make_unique<HeavyHitters>(top_k_);
+    }
+    w.id = id;
+  }
+  w.hh->add(key, n);
+}
+
+void WindowedHeavyHitters::merge(const WindowedHeavyHitters& other) {
+  ld_check(window_len_ == other.window_len_);
+  for (const Window& theirs : other.windows_) {
+    if (theirs.id < 0) {
+      continue;
+    }
+    ld_check(theirs.hh);
+    Window& ours = windows_[theirs.id % NUM_WINDOWS];
+    if (ours.id > theirs.id) {
+      // Theirs expired.
+      continue;
+    }
+    if (ours.id < theirs.id) {
+      ours.id = theirs.id;
+      ours.hh = std::make_unique<HeavyHitters>(*theirs.hh);
+    } else {
+      ours.hh->merge(*theirs.hh);
+    }
+  }
+}
+
+void WindowedHeavyHitters::clear() {
+  for (Window& w : windows_) {
+    if (w.hh) {
+      w.hh->clear();
+    }
+    w.id = -1;
+  }
+}
+
+std::unordered_map<std::string, std::vector<double>>
+WindowedHeavyHitters::rates(
+    const std::vector<std::chrono::milliseconds>& intervals,
+    std::chrono::milliseconds now,
+    const std::vector<std::string>& keys) const {
+  const int64_t now_ms = now.count();
+  const int64_t len = window_len_.count();
+  std::vector<int64_t> interval_ms;
+  int64_t longest = 0;
+  for (auto interval : intervals) {
+    interval_ms.push_back(std::min(interval, span_).count());
+    longest = std::max(longest, interval_ms.back());
+  }
+
+  // Windows overlapping the longest interval, with the part of each that
+  // has elapsed: [start, end).
+  struct Overlapping {
+    const HeavyHitters* hh;
+    int64_t start;
+    int64_t end;
+  };
+  std::vector<Overlapping> overlapping;
+  std::unordered_set<std::string> all_keys(keys.begin(), keys.end());
+  for (const Window& w : windows_) {
+    if (w.id < 0) {
+      continue;
+    }
+    int64_t start = w.id * len;
+    int64_t end = std::min(start + len, now_ms);
+    if (end <= start || end <= now_ms - longest) {
+      continue;
+    }
+    overlapping.push_back(Overlapping{w.hh.get(), start, end});
+    for (auto& kv : w.hh->top()) {
+      all_keys.insert(std::move(kv.first));
+    }
+  }
+
+  std::unordered_map<std::string, std::vector<double>> res;
+  for (const std::string& key : all_keys) {
+    std::vector<double>& key_rates = res[key];
+    key_rates.resize(intervals.size(), 0.);
+    for (const Overlapping& w : overlapping) {
+      uint64_t count = w.hh->count(key);
+      if (count == 0) {
+        continue;
+      }
+      for (size_t i = 0; i < interval_ms.size(); ++i) {
+        int64_t overlap = w.end - std::max(w.start, now_ms - interval_ms[i]);
+        if (overlap > 0) {
+          key_rates[i] += 1. * count * overlap / (w.end - w.start);
+        }
+      }
+    }
+    for (size_t i = 0; i < interval_ms.size(); ++i) {
+      key_rates[i] = interval_ms[i] > 0 ? key_rates[i] * 1000 / interval_ms[i]
+                                        : 0.;
+    }
+  }
+  return res;
+}
+
+}} // namespace facebook::logdevice
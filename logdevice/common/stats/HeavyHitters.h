@@ -0,0 +1,156 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <folly/Range.h>
+#include <folly/container/F14Map.h>
+#include <folly/small_vector.h>
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Approximate per-key totals in bounded memory, no matter how many
+ *       distinct keys there are. Used for per-log-group throughput when there
+ *       are too many log groups for a time series each.
+ *
+ *       All keys are counted in a count-min sketch: `depth` rows of `width`
+ *       counters, a key adds to one counter per row (conservatively, see
+ *       addToSketch()) and its estimate is the minimum of those. The estimate
+ *       never undercounts, and overcounts by at most e/width of the total
+ *       with probability 1-e^-depth.
+ *       In addition, the `top_k` keys with the highest totals are tracked
+ *       exactly from the moment they enter the top, so the heavy hitters are
+ *       accurate and the rest is approximate.
+ *
+ *       Sketches with the same width and depth are merged by adding up
+ *       counters, so per-thread instances can be combined on demand.
+ *
+ *       Not thread-safe.
+ */
+class HeavyHitters {
+ public:
+  static constexpr size_t DEFAULT_WIDTH = 512;
+  static constexpr size_t DEFAULT_DEPTH = 4;
+
+  explicit HeavyHitters(size_t top_k,
+                        size_t width = DEFAULT_WIDTH,
+                        size_t depth = DEFAULT_DEPTH);
+
+  void add(folly::StringPiece key, uint64_t n);
+
+  /**
+   * @return the exact total of `key` if it's among the top keys, otherwise
+   *         the count-min estimate, which may be too high but not too low.
+   */
+  uint64_t count(folly::StringPiece key) const;
+
+  /**
+   * Adds all counts of `other`, which must have the same width and depth.
+   * The top keys of the result are picked among the top keys of both.
+   */
+  void merge(const HeavyHitters& other);
+
+  void clear();
+
+  // @return the top keys with their counts, highest first
+  std::vector<std::pair<std::string, uint64_t>> top() const;
+
+  // @return sum of all counts
+  uint64_t total() const {
+    return total_;
+  }
+
+ private:
+  size_t top_k_;
+  size_t width_;
+  size_t depth_;
+  // depth_ rows of width_ counters
+  std::vector<uint64_t> counters_;
+  uint64_t total_ = 0;
+
+  folly::F14FastMap<std::string, uint64_t> top_;
+  // A lower bound on the smallest count in top_, once it's full. Keys whose
+  // estimate is not above this can't get into the top, which saves a scan
+  // of top_ for the vast majority of adds.
+  uint64_t top_min_ = 0;
+
+  // Adds n to the estimate of the key and returns the new estimate.
+  uint64_t addToSketch(folly::StringPiece key, uint64_t n);
+  uint64_t estimate(folly::StringPiece key) const;
+
+  // Index in counters_ of the counter of `key` in each row.
+  folly::small_vector<size_t, DEFAULT_DEPTH>
+  counterIndices(folly::StringPiece key) const;
+
+  // Offers `key` with total `count` for a spot in the full top_.
+  void offer(folly::StringPiece key, uint64_t count);
+  void updateTopMin();
+};
+
+/**
+ * HeavyHitters over a sliding time span, kept as NUM_WINDOWS windows of
+ * span / (NUM_WINDOWS - 1) each, aligned to multiples of the window length
+ * so that instances of different threads can be merged window by window.
+ * Rates over intervals not aligned to windows prorate the windows at the
+ * edges.
+ *
+ * Windows are allocated when first used. Not thread-safe.
+ */
+class WindowedHeavyHitters {
+ public:
+  static constexpr size_t NUM_WINDOWS = 6;
+
+  WindowedHeavyHitters(std::chrono::milliseconds span, size_t top_k);
+
+  // `now` is any monotonic time, e.g. since the epoch of steady_clock.
+  void add(folly::StringPiece key, uint64_t n, std::chrono::milliseconds now);
+
+  // `other` must have the same span and top_k.
+  void merge(const WindowedHeavyHitters& other);
+
+  void clear();
+
+  /**
+   * For the top keys of every window overlapping the longest of `intervals`
+   * and for `keys`, calculates the rate per second of each key over each of
+   * the `intervals` ending at `now`. Intervals longer than the span are cut
+   * to the span.
+   */
+  std::unordered_map<std::string, std::vector<double>>
+  rates(const std::vector<std::chrono::milliseconds>& intervals,
+        std::chrono::milliseconds now,
+        const std::vector<std::string>& keys = {}) const;
+
+  std::chrono::milliseconds getSpan() const {
+    return span_;
+  }
+
+ private:
+  struct Window {
+    // index of the window since the epoch of the clock, -1 if unused
+    int64_t id = -1;
+    std::unique_ptr<HeavyHitters> hh;
+  };
+
+  std::chrono::milliseconds span_;
+  std::chrono::milliseconds window_len_;
+  size_t top_k_;
+  std::array<Window, NUM_WINDOWS> windows_;
+};
+
+}} // namespace facebook::logdevice
@@ -659,6 +659,52 @@ void MultiScaleHistogram::mergeStagedValues() {
   });
 }
 
+namespace {
+const std::vector<HistogramUnit>* latencyUnits() {
+  static std::vector<HistogramUnit> units{{1l, "us"},
+                                          {1000l, "ms"},
+                                          {1000000l, "s"},
+                                          {60000000l, "min"},
+                                          {3600000000l, "hr"}};
+  return &units;
+}
+
+const std::vector<HistogramUnit>* sizeUnits() {
+  static std::vector<HistogramUnit> units{{1l, "B"},
+                                          {1l << 10, "KiB"},
+                                          {1l << 20, "MiB"},
+                                          {1l << 30, "GiB"},
+                                          {1l << 40, "TiB"},
+                                          {1l << 50, "PiB"}};
+  return &units;
+}
+
+const std::vector<HistogramUnit>* noUnitUnits() {
+  static std::vector<HistogramUnit> units{{1l, ""},
+                                          {1000l, "K"},
+                                          {1000000l, "M"},
+                                          {1000000000l, "B"},
+                                          {1000000000000l, "T"}};
+  return &units;
+}
+
+// Finds the biggest unit smaller than value.
+const HistogramUnit&
+pickHistogramUnit(const std::vector<HistogramUnit>* units, int64_t value) {
+  if (units == nullptr) {
+    static HistogramUnit u = {0l, ""};
+    return u;
+  }
+  ld_check(!units->empty());
+
+  size_t idx = units->size() - 1;
+  while (idx > 0 && (*units)[idx].unit > value) {
+    --idx;
+  }
+  return (*units)[idx];
+}
+} // namespace
+
 void CompactHistogram::add(int64_t value) {
   unsigned int bucket = value <= 0
       ? 0
@@ -871,18 +917,7 @@ std::string CompactHistogram::getUnitName() const {
 }
 
 const CompactHistogram::Unit& CompactHistogram::pickUnit(int64_t value) const {
-  if (units_ == nullptr) {
-    static Unit u = {0l, ""};
-    return u;
-  }
-  ld_check(!units_->empty());
-
-  // Find the biggest unit smaller than value.
-  size_t idx = units_->size() - 1;
-  while (idx > 0 && (*units_)[idx].unit > value) {
-    --idx;
-  }
-  return (*units_)[idx];
+  return pickHistogramUnit(units_, value);
 }
 
 std::string CompactHistogram::valueToString(int64_t value) const {
@@ -956,35 +991,388 @@ CompactHistogram& CompactHistogram::operator=(const CompactHistogram& rhs) {
 
 CompactLatencyHistogram::CompactLatencyHistogram(
     folly::Optional<PublishRange> publish_range)
-    : CompactHistogram(
-          [] {
-            static std::vector<Unit> units{{1l, "us"},
-                                           {1000l, "ms"},
-                                           {1000000l, "s"},
-                                           {60000000l, "min"},
-                                           {3600000000l, "hr"}};
-            return &units;
-          }(),
-          std::move(publish_range)) {}
+    : CompactHistogram(latencyUnits(), std::move(publish_range)) {}
 
 CompactSizeHistogram::CompactSizeHistogram()
-    : CompactHistogram([] {
-        static std::vector<Unit> units{{1l, "B"},
-                                       {1l << 10, "KiB"},
-                                       {1l << 20, "MiB"},
-                                       {1l << 30, "GiB"},
-                                       {1l << 40, "TiB"},
-                                       {1l << 50, "PiB"}};
-        return &units;
-      }()) {}
+    : CompactHistogram(sizeUnits()) {}
 
 CompactNoUnitHistogram::CompactNoUnitHistogram()
-    : CompactHistogram([] {
-        static std::vector<Unit> units{{1l, ""},
-                                       {1000l, "K"},
-                                       {1000000l, "M"},
-                                       {1000000000l, "B"},
-                                       {1000000000000l, "T"}};
+    : CompactHistogram(noUnitUnits()) {}
+
+// Bucket `i` >= 64 holds values (i % 32 + 32) << (i / 32 - 1) and up, see
+// valueToIndex().
+constexpr size_t SketchHistogram::NUM_BUCKETS;
+constexpr size_t SketchHistogram::CHUNK_SIZE;
+constexpr size_t SketchHistogram::NUM_CHUNKS;
+
+size_t SketchHistogram::valueToIndex(int64_t value) {
+  if (value < 64) {
+    return value <= 0 ? 0 : value;
+  }
+  // value is in [m << shift, (m + 1) << shift) with m in [32, 64).
+  unsigned shift = folly::findLastSet(value) - 6;
+  return shift * 32 + (value >> shift);
+}
+
+int64_t SketchHistogram::indexToMin(size_t index) {
+  ld_check_lt(index, NUM_BUCKETS);
+  if (index < 64) {
+    return index;
+  }
+  return static_cast<int64_t>(index % 32 + 32) << (index / 32 - 1);
+}
+
+int64_t SketchHistogram::indexToMax(size_t index) {
+  ld_check_lt(index, NUM_BUCKETS);
+  if (index < 64) {
+    return index;
+  }
+  // Computed as unsigned: the last bucket ends at 2^63-1.
+  return static_cast<int64_t>((static_cast<uint64_t>(index % 32 + 33)
+                               << (index / 32 - 1)) -
+                              1);
+}
+
+SketchHistogram::SketchHistogram(const std::vector<HistogramUnit>* units)
+    : units_(units) {}
+
+SketchHistogram::SketchHistogram(const SketchHistogram& rhs)
+    : units_(rhs.units_) {
+  assign(rhs);
+}
+
+SketchHistogram& SketchHistogram::operator=(const SketchHistogram& rhs) {
+  assign(rhs);
+  return *this;
+}
+
+SketchHistogram::~SketchHistogram() {
+  for (auto& c : chunks_) {
+    delete c.load(std::memory_order_relaxed);
+  }
+}
+
+SketchHistogram::Chunk& SketchHistogram::getOrCreateChunk(size_t chunk_idx) {
+  Chunk* chunk = chunks_[chunk_idx].load(std::memory_order_acquire);
+  if (UNLIKELY(chunk == nullptr)) {
+    auto created = std::make_unique<Chunk>();
+    for (auto& b : *created) {
+      b.store(0, std::memory_order_relaxed);
+    }
+    if (chunks_[chunk_idx].compare_exchange_strong(
+            chunk, created.get(), std::memory_order_acq_rel)) {
+      chunk = created.release();
+    }
+    // Otherwise another thread won the race and `chunk` is its chunk.
+  }
+  return *chunk;
+}
+
+void SketchHistogram::add(int64_t value) {
+  size_t idx = valueToIndex(value);
+  getOrCreateChunk(idx / CHUNK_SIZE)[idx % CHUNK_SIZE].fetch_add(
+      1, std::memory_order_relaxed);
+  sum_.fetch_add(std::max(value, 0l), std::memory_order_relaxed);
+}
+
+void SketchHistogram::clear() {
+  for (auto& c : chunks_) {
+    Chunk* chunk = c.load(std::memory_order_acquire);
+    if (chunk != nullptr) {
+      for (auto& b : *chunk) {
+        b.store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+  sum_.store(0, std::memory_order_relaxed);
+}
+
+void SketchHistogram::assign(const HistogramInterface& other_if) {
+  auto& other = checked_cref_cast<SketchHistogram>(other_if);
+  ld_check(units_ == other.units_);
+
+  for (size_t c = 0; c < NUM_CHUNKS; ++c) {
+    const Chunk* src = other.chunks_[c].load(std::memory_order_acquire);
+    Chunk* dst = chunks_[c].load(std::memory_order_acquire);
+    if (src == nullptr && dst == nullptr) {
+      continue;
+    }
+    if (dst == nullptr) {
+      dst = &getOrCreateChunk(c);
+    }
+    for (size_t i = 0; i < CHUNK_SIZE; ++i) {
+      (*dst)[i].store(
+          src ? (*src)[i].load(std::memory_order_relaxed) : 0,
+          std::memory_order_relaxed);
+    }
+  }
+  sum_.store(other.sum_.load(std::memory_order_relaxed),
+             std::memory_order_relaxed);
+}
+
+void SketchHistogram::merge(const HistogramInterface& other_if) {
+  auto& other = checked_cref_cast<SketchHistogram>(other_if);
+  ld_check(units_ == other.units_);
+
+  for (size_t c = 0; c < NUM_CHUNKS; ++c) {
+    const Chunk* src = other.chunks_[c].load(std::memory_order_acquire);
+    if (src == nullptr) {
+      continue;
+    }
+    Chunk* dst = nullptr;
+    for (size_t i = 0; i < CHUNK_SIZE; ++i) {
+      uint64_t x = (*src)[i].load(std::memory_order_relaxed);
+      if (x == 0) {
+        continue;
+      }
+      if (dst == nullptr) {
+        dst = &getOrCreateChunk(c);
+      }
+      (*dst)[i].fetch_add(x, std::memory_order_relaxed);
+    }
+  }
+  sum_.fetch_add(other.sum_.load(std::memory_order_relaxed),
+                 std::memory_order_relaxed);
+}
+
+void SketchHistogram::subtract(const HistogramInterface& other_if) {
+  auto& other = checked_cref_cast<SketchHistogram>(other_if);
+  ld_check(units_ == other.units_);
+
+  for (size_t c = 0; c < NUM_CHUNKS; ++c) {
+    const Chunk* src = other.chunks_[c].load(std::memory_order_acquire);
+    if (src == nullptr) {
+      continue;
+    }
+    Chunk* dst = nullptr;
+    for (size_t i = 0; i < CHUNK_SIZE; ++i) {
+      uint64_t x = (*src)[i].load(std::memory_order_relaxed);
+      if (x == 0) {
+        continue;
+      }
+      if (dst == nullptr) {
+        dst = &getOrCreateChunk(c);
+      }
+      uint64_t prev = (*dst)[i].fetch_sub(x, std::memory_order_relaxed);
+      if (!dd_assert(x <= prev,
+                     "Histogram subtraction overflowed. Bucket %lu, this: "
+                     "[%s] (half-updated), right operand: [%s]",
+                     c * CHUNK_SIZE + i,
+                     toShortString().c_str(),
+                     other.toShortString().c_str())) {
+        (*dst)[i].store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+  sum_.fetch_sub(other.sum_.load(std::memory_order_relaxed),
+                 std::memory_order_relaxed);
+}
+
+uint64_t SketchHistogram::snapshotBuckets(
+    std::vector<std::pair<size_t, uint64_t>>& out) const {
+  out.clear();
+  uint64_t count = 0;
+  for (size_t c = 0; c < NUM_CHUNKS; ++c) {
+    const Chunk* chunk = chunks_[c].load(std::memory_order_acquire);
+    if (chunk == nullptr) {
+      continue;
+    }
+    for (size_t i = 0; i < CHUNK_SIZE; ++i) {
+      uint64_t x = (*chunk)[i].load(std::memory_order_relaxed);
+      if (x == 0) {
+        continue;
+      }
+      if (!dd_assert(x <= std::numeric_limits<uint64_t>::max() - count,
+                     "Histogram total count overflowed: %s",
+                     toShortString().c_str())) {
+        // Skip the bucket that overflows the count, like CompactHistogram.
+        continue;
+      }
+      count += x;
+      out.emplace_back(c * CHUNK_SIZE + i, x);
+    }
+  }
+  return count;
+}
+
+void SketchHistogram::estimatePercentiles(const double* percentiles,
+                                          size_t npercentiles,
+                                          int64_t* samples_out,
+                                          uint64_t* count_out,
+                                          int64_t* sum_out) const {
+  // Work on a copy to avoid race conditions with concurrent updates.
+  std::vector<std::pair<size_t, uint64_t>> buckets;
+  uint64_t count = snapshotBuckets(buckets);
+  if (count_out) {
+    *count_out = count;
+  }
+  if (sum_out) {
+    *sum_out = sum_.load(std::memory_order_relaxed);
+  }
+
+  if (npercentiles == 0) {
+    return;
+  }
+
+  ld_check(samples_out != nullptr);
+  ld_check(std::is_sorted(percentiles, percentiles + npercentiles));
+  ld_check(std::all_of(percentiles, percentiles + npercentiles, [](double p) {
+    return p >= 0.0 && p <= 1.0;
+  }));
+
+  if (count == 0) {
+    std::fill(samples_out, samples_out + npercentiles, 0l);
+    return;
+  }
+
+  size_t idx = 0;    // index in percentiles
+  uint64_t seen = 0; // count in buckets seen so far
+  for (size_t i = 0; i < buckets.size() && idx < npercentiles; ++i) {
+    uint64_t next = seen + buckets[i].second;
+    ld_check_le(next, count);
+    int64_t min = indexToMin(buckets[i].first);
+    int64_t max = indexToMax(buckets[i].first);
+    while (idx < npercentiles &&
+           (percentiles[idx] * count <= next || next == count)) {
+      // Linearly interpolate inside the bucket.
+      double p = (percentiles[idx] * count - seen) / (next - seen);
+      p = std::min(1., std::max(0., p));
+      samples_out[idx] = min + static_cast<int64_t>(p * (max - min) + .5);
+      ++idx;
+    }
+    seen = next;
+  }
+
+  ld_check(idx == npercentiles);
+}
+
+void SketchHistogram::print(std::ostream& out) const {
+  std::array<double, 4> pct = {.5, .75, .95, .99};
+
+  std::vector<std::pair<size_t, uint64_t>> buckets;
+  uint64_t count = snapshotBuckets(buckets);
+
+  // Print one line per power of two rather than per bucket, there can be
+  // hundreds of those.
+  size_t idx = 0;    // in `pct`
+  uint64_t seen = 0; // count in buckets seen so far
+  for (size_t i = 0; i < buckets.size();) {
+    int64_t min = indexToMin(buckets[i].first);
+    int bits = folly::findLastSet(min);
+    int64_t max = min;
+    uint64_t x = 0;
+    for (; i < buckets.size() &&
+         folly::findLastSet(indexToMin(buckets[i].first)) == bits;
+         ++i) {
+      max = indexToMax(buckets[i].first);
+      x += buckets[i].second;
+    }
+    uint64_t next = seen + x;
+
+    const HistogramUnit& u = pickHistogramUnit(units_, min);
+    std::string label = folly::sformat(
+        "{:.3f}..{:.3f}{}", 1. * min / u.unit, 1. * max / u.unit, u.name);
+
+    std::string pct_str;
+    while (idx < pct.size() && (pct[idx] * count <= next || next == count)) {
+      pct_str += folly::sformat(" p{}", static_cast<int>(pct[idx] * 100 + .5));
+      ++idx;
+    }
+
+    out << std::setw(20) << std::right << label << std::setw(1) << " : "
+        << std::setw(10) << std::left << x << std::setw(1) << pct_str
+        << std::endl;
+
+    seen = next;
+  }
+}
+
+std::string SketchHistogram::getUnitName() const {
+  return units_ ? units_->at(0).name : "";
+}
+
+std::string SketchHistogram::valueToString(int64_t value) const {
+  const HistogramUnit& u = pickHistogramUnit(units_, value);
+  return folly::sformat("{:.3f}{}", 1. * value / u.unit, u.name);
+}
+
+std::string SketchHistogram::toShortString() const {
+  std::vector<std::pair<size_t, uint64_t>> buckets;
+  snapshotBuckets(buckets);
+  if (buckets.empty()) {
+    return "";
+  }
+  std::stringstream ss;
+  ss << sum_.load(std::memory_order_relaxed) << ";";
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    if (i > 0) {
+      ss << ",";
+    }
+    ss << buckets[i].first << ":" << buckets[i].second;
+  }
+  return ss.str();
+}
+
+bool SketchHistogram::fromShortString(folly::StringPiece s) {
+  clear();
+  if (s.empty()) {
+    return true;
+  }
+
+  folly::StringPiece sum_str, buckets_str;
+  if (!folly::split(';', s, sum_str, buckets_str)) {
+    return false;
+  }
+  auto sum = folly::tryTo<int64_t>(sum_str);
+  if (!sum.hasValue()) {
+    return false;
+  }
+
+  std::vector<folly::StringPiece> tokens;
+  folly::split(',', buckets_str, tokens);
+  size_t prev_idx = 0;
+  bool first = true;
+  for (folly::StringPiece tok : tokens) {
+    size_t idx;
+    uint64_t x;
+    try {
+      if (!folly::split(':', tok, idx, x)) {
+        clear();
+        return false;
+      }
+    } catch (std::range_error&) {
+      clear();
+      return false;
+    }
+    // Indices must be in range and strictly increasing, which also rules
+    // out duplicates.
+    if (idx >= NUM_BUCKETS || (!first && idx <= prev_idx)) {
+      clear();
+      return false;
+    }
+    getOrCreateChunk(idx / CHUNK_SIZE)[idx % CHUNK_SIZE].store(
+        x, std::memory_order_relaxed);
+    prev_idx = idx;
+    first = false;
+  }
+  sum_.store(sum.value(), std::memory_order_relaxed);
+  return true;
+}
+
+SketchLatencyHistogram::SketchLatencyHistogram()
+    : SketchHistogram(latencyUnits()) {}
+
+SketchSizeHistogram::SketchSizeHistogram() : SketchHistogram(sizeUnits()) {}
+
+SketchRecordAgeHistogram::SketchRecordAgeHistogram()
+    : SketchHistogram([] {
+        static std::vector<HistogramUnit> units{{1l, "s"},
+                                                {60l, "min"},
+                                                {3600l, "hr"},
+                                                {86400l, "day"}};
         return &units;
       }()) {}
+
+SketchNoUnitHistogram::SketchNoUnitHistogram()
+    : SketchHistogram(noUnitUnits()) {}
 }} // namespace facebook::logdevice
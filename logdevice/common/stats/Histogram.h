@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <cstdint>
 #include <iosfwd>
@@ -32,8 +33,9 @@ namespace facebook { namespace logdevice {
  *
  * HistogramInterface is a common interface for the histograms, allowing to
  * add values, merge/subtract histograms and get percentiles.
- * Two implementations of this interface are MultiScaleHistogram and
- * CompactHistogram; those define how the histogram actually works.
+ * Three implementations of this interface are MultiScaleHistogram,
+ * CompactHistogram and SketchHistogram; those define how the histogram
+ * actually works.
  *
  * MultiScaleHistogram is an older, fancier and heavyweight implementation
  * with round bucket boundaries and more precise percentiles.
@@ -43,7 +45,11 @@ namespace facebook { namespace logdevice {
  * fewer buckets. Main caveat is that it's sometimes not responsive to small
  * changes in values, see comment starting with "IMPORTANT" below.
  *
- * Each of the two implementations has multiple subclasses for different units
+ * SketchHistogram is a log-linear (HDR-style) histogram with a bounded
+ * relative error on every percentile, lock-free to update and mergeable
+ * across threads and nodes. It's the default for server histograms.
+ *
+ * Each of the implementations has multiple subclasses for different units
  * of measurement. They define how the histograms are presented
  * (e.g. "1h" instead of "3600000000") and, for MultiScaleHistogram, what
  * the block boundaries are.
@@ -424,6 +430,13 @@ class NoUnitHistogram final : public MultiScaleHistogram {
 //  - less precision: 3x fewer buckets
 //  - bucket boundaries are not round (unless powers of two are considered
 //    round, e.g. for sizes in KiB/MiB/etc)
+// A unit of measurement used to print histogram values, e.g. {1000, "ms"}.
+struct HistogramUnit {
+  // What value constitutes one of this unit. E.g. 1<<20 for "MiB".
+  int64_t unit;
+  const char* name;
+};
+
 class CompactHistogram : public HistogramInterface {
  public:
   CompactHistogram() = default;
@@ -465,11 +478,7 @@ class CompactHistogram : public HistogramInterface {
   CumulativeFrequencyCounters getCumulativeFrequencyCounters() const override;
 
  protected:
-  struct Unit {
-    // What value constitutes one of this unit. E.g. 1<<20 for "MiB".
-    int64_t unit;
-    const char* name;
-  };
+  using Unit = HistogramUnit;
 
   explicit CompactHistogram(
       const std::vector<Unit>* units,
@@ -502,4 +511,108 @@ class CompactNoUnitHistogram : public CompactHistogram {
   CompactNoUnitHistogram();
 };
 
+// Log-linear histogram in the spirit of HdrHistogram and DDSketch: values
+// below 64 have a bucket each, and every power-of-two range above that is
+// split into 32 equal buckets. Any percentile estimate is therefore within
+// 1/32 (~3%) of a value that was actually recorded, regardless of the
+// magnitude of values. Negative values are counted as 0.
+//
+// Buckets are allocated lazily, 64 at a time (two powers of two), so a
+// histogram only pays for the range of values it has seen: e.g. latencies
+// between 10us and 10s take ~11 chunks, 5.5 KB. An empty histogram is ~260
+// bytes. add() is a couple of relaxed atomic increments, plus a
+// compare-and-swap the first time a chunk is needed; no mutexes and no
+// staging, unlike MultiScaleHistogram. The exact sum of values is kept too,
+// so means are exact.
+//
+// All methods are thread-safe. Histograms of the same subclass can be merged
+// and subtracted bucket by bucket without losing precision, including ones
+// received from other nodes via toShortString()/fromShortString().
+class SketchHistogram : public HistogramInterface {
+ public:
+  // One bucket per value below 64, then 32 per power of two from 2^6 to
+  // 2^62. Buckets are allocated in chunks of CHUNK_SIZE.
+  static constexpr size_t NUM_BUCKETS = 64 + 57 * 32;
+  static constexpr size_t CHUNK_SIZE = 64;
+
+  // Must be the same subclass.
+  SketchHistogram(const SketchHistogram& rhs);
+  SketchHistogram& operator=(const SketchHistogram& rhs);
+  ~SketchHistogram() override;
+
+  void add(int64_t value) override;
+  void clear() override;
+  void assign(const HistogramInterface& other) override;
+  void merge(const HistogramInterface& other) override;
+  void subtract(const HistogramInterface& other) override;
+  void estimatePercentiles(const double* percentiles,
+                           size_t npercentiles,
+                           int64_t* samples_out,
+                           uint64_t* count_out = nullptr,
+                           int64_t* sum_out = nullptr) const override;
+  void print(std::ostream& out) const override;
+
+  std::string getUnitName() const override;
+  std::string valueToString(int64_t value) const override;
+
+  // A short string representation of the histogram: the sum of values
+  // followed by a comma-separated list of pairs "<bucket_idx>:<count>",
+  // listing only nonempty buckets. E.g.: "61251;3:2,70:1,1210:3".
+  // If histogram is empty, empty string is returned.
+  std::string toShortString() const;
+
+  // Parses the histogram from a string in format produced by toShortString().
+  // If the string is not in the right format, returns false.
+  bool fromShortString(folly::StringPiece s);
+
+  // Index of the bucket `value` goes to, and the smallest and largest values
+  // of a bucket.
+  static size_t valueToIndex(int64_t value);
+  static int64_t indexToMin(size_t index);
+  static int64_t indexToMax(size_t index);
+
+ protected:
+  explicit SketchHistogram(const std::vector<HistogramUnit>* units);
+
+ private:
+  static constexpr size_t NUM_CHUNKS =
+      (NUM_BUCKETS + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+  using Chunk = std::array<std::atomic<uint64_t>, CHUNK_SIZE>;
+
+  // Chunks are allocated on first use and only freed by the destructor, so
+  // that add() never races with a deallocation.
+  std::array<std::atomic<Chunk*>, NUM_CHUNKS> chunks_{};
+  std::atomic<int64_t> sum_{0};
+  const std::vector<HistogramUnit>* units_;
+
+  Chunk& getOrCreateChunk(size_t chunk_idx);
+
+  // Copies nonzero buckets into `out` as (bucket index, count) pairs, sorted
+  // by index. Returns their total count.
+  uint64_t
+  snapshotBuckets(std::vector<std::pair<size_t, uint64_t>>& out) const;
+};
+
+class SketchLatencyHistogram : public SketchHistogram {
+ public:
+  SketchLatencyHistogram();
+};
+
+class SketchSizeHistogram : public SketchHistogram {
+ public:
+  SketchSizeHistogram();
+};
+
+// Values are in seconds.
+class SketchRecordAgeHistogram : public SketchHistogram {
+ public:
+  SketchRecordAgeHistogram();
+};
+
+class SketchNoUnitHistogram : public SketchHistogram {
+ public:
+  SketchNoUnitHistogram();
+};
+
 }} // namespace facebook::logdevice
@@ -20,10 +20,10 @@ struct PerShardHistograms : public PerShardHistogramBundle {
   using compact_latency_histogram_t = ShardedHistogram<CompactLatencyHistogram>;
   using compact_size_histogram_t = ShardedHistogram<CompactSizeHistogram>;
   using compact_no_unit_histogram_t = ShardedHistogram<CompactNoUnitHistogram>;
-  using latency_histogram_t = ShardedHistogram<LatencyHistogram>;
-  using size_histogram_t = ShardedHistogram<SizeHistogram>;
-  using record_age_histogram_t = ShardedHistogram<RecordAgeHistogram>;
-  using no_unit_histogram_t = ShardedHistogram<NoUnitHistogram>;
+  using latency_histogram_t = ShardedHistogram<SketchLatencyHistogram>;
+  using size_histogram_t = ShardedHistogram<SketchSizeHistogram>;
+  using record_age_histogram_t = ShardedHistogram<SketchRecordAgeHistogram>;
+  using no_unit_histogram_t = ShardedHistogram<SketchNoUnitHistogram>;
 
   explicit PerShardHistograms() {}
 
@@ -35,6 +35,8 @@ struct PerShardHistograms : public PerShardHistogramBundle {
     return {
         {"store_latency", &store_latency},
         {"store_latency_rebuilding", &store_latency_rebuilding},
+        {"store_stage_queue", &store_stage_queue},
+        {"store_stage_write", &store_stage_write},
         {"rocks_wal", &rocks_wal},
         {"rocks_memtable", &rocks_memtable},
         {"rocks_memtable_age", &rocks_memtable_age},
@@ -46,6 +48,8 @@ struct PerShardHistograms : public PerShardHistogramBundle {
         {"flushed_log_run_length", &flushed_log_run_length},
         {"compacted_log_run_length", &compacted_log_run_length},
         {"trimmed_record_age", &trimmed_record_age},
+        {"wal_sync_group_size", &wal_sync_group_size},
+        {"wal_sync_group_wait", &wal_sync_group_wait},
 
         // Rebuilding related histograms
         {"record_rebuilding", &record_rebuilding},
@@ -72,6 +76,20 @@ struct PerShardHistograms : public PerShardHistogramBundle {
       {"queue_time." class_name,                                         \
        &storage_task_queue_time[static_cast<int>(StorageTaskType::name)]},
 #include "logdevice/common/storage_task_types.inc"
+
+    // IO done by storage tasks, see IOAttribution.
+#define STORAGE_TASK_TYPE(name, class_name, _)                            \
+  {"io_read_latency." class_name,                                         \
+   &io_read_latency[static_cast<int>(StorageTaskType::name)]},            \
+      {"io_read_size." class_name,                                        \
+       &io_read_size[static_cast<int>(StorageTaskType::name)]},           \
+      {"io_write_latency." class_name,                                    \
+       &io_write_latency[static_cast<int>(StorageTaskType::name)]},       \
+      {"io_write_size." class_name,                                       \
+       &io_write_size[static_cast<int>(StorageTaskType::name)]},          \
+      {"io_block_cache_misses." class_name,                               \
+       &io_block_cache_misses[static_cast<int>(StorageTaskType::name)]},
+#include "logdevice/common/storage_task_types.inc"
     };
   }
 
@@ -82,6 +100,12 @@ struct PerShardHistograms : public PerShardHistogramBundle {
   // Same as store_latency but for rebuilding-related stores
   latency_histogram_t store_latency_rebuilding;
 
+  // Breakdown of store_latency: time from receiving a STORE until a storage
+  // thread picked up the write, and time spent writing the batch the record
+  // was in to the local log store. See StoreStageTimes.
+  latency_histogram_t store_stage_queue;
+  latency_histogram_t store_stage_write;
+
   // Time spent by RocksDB writing to WAL.
   latency_histogram_t rocks_wal;
 
@@ -113,6 +137,11 @@ struct PerShardHistograms : public PerShardHistogramBundle {
   // The Histogram of trimmed records age, in seconds
   record_age_histogram_t trimmed_record_age;
 
+  // Number of shards whose WAL syncs were released together by a
+  // WALSyncGroup round, and how long each sync waited for its round.
+  compact_no_unit_histogram_t wal_sync_group_size;
+  latency_histogram_t wal_sync_group_wait;
+
   // Latency of RecordRebuilding state machine.
   compact_latency_histogram_t record_rebuilding;
 
@@ -125,6 +154,21 @@ struct PerShardHistograms : public PerShardHistogramBundle {
   // Queueing latencies for storage threads (by storage thread type)
   compact_latency_histogram_t storage_threads_queue_time[static_cast<size_t>(
       StorageTaskThreadType::MAX)];
+
+  // Latencies and sizes of file reads and writes done by rocksdb on behalf of
+  // storage tasks (by storage task type; UNKNOWN is IO outside of storage
+  // tasks, e.g. flushes and compactions), and block cache misses per storage
+  // task execution. See IOAttribution.
+  compact_latency_histogram_t
+      io_read_latency[static_cast<size_t>(StorageTaskType::MAX)];
+  compact_size_histogram_t
+      io_read_size[static_cast<size_t>(StorageTaskType::MAX)];
+  compact_latency_histogram_t
+      io_write_latency[static_cast<size_t>(StorageTaskType::MAX)];
+  compact_size_histogram_t
+      io_write_size[static_cast<size_t>(StorageTaskType::MAX)];
+  compact_no_unit_histogram_t
+      io_block_cache_misses[static_cast<size_t>(StorageTaskType::MAX)];
 };
 
 }} // namespace facebook::logdevice
@@ -22,8 +22,12 @@ namespace facebook { namespace logdevice {
  */
 struct ServerHistograms : public HistogramBundle {
   HistogramBundle::MapType getMap() override {
-    return {
+    HistogramBundle::MapType map = {
         {"append_latency", &append_latency},
+        {"append_stage_sequencer_queue", &append_stage_sequencer_queue},
+        {"append_stage_store", &append_stage_store},
+        {"append_stage_store_network", &append_stage_store_network},
+        {"append_stage_release", &append_stage_release},
         {"store_bw_wait_latency", &store_bw_wait_latency},
         {"write_to_read_latency", &write_to_read_latency},
         {"store_timeouts", &store_timeouts},
@@ -33,6 +37,7 @@ struct ServerHistograms : public HistogramBundle {
         {"mid_pri_requests_latency", &mid_pri_requests_latency},
         {"gossip_queue_latency", &gossip_queue_latency},
         {"gossip_recv_latency", &gossip_recv_latency},
+        {"gossip_processing_time", &gossip_processing_time},
         {"traffic_shaper_bw_dispatch_latency", &traffic_shaper_bw_dispatch},
         {"log_recovery_seal_latency", &log_recovery_seal_node},
         {"log_recovery_digesting_latency", &log_recovery_digesting},
@@ -40,6 +45,7 @@ struct ServerHistograms : public HistogramBundle {
         {"log_recovery_cleaning_latency", &log_recovery_cleaning},
         {"log_recovery_epoch_recovery_latency", &log_recovery_epoch},
         {"log_recovery_epoch_recovery_restarts", &log_recovery_epoch_restarts},
+        {"log_recovery_full_latency", &log_recovery_full},
         {"flow_groups_run_event_loop_delay", &flow_groups_run_event_loop_delay},
         {"flow_groups_run_event_loop_delay_rt",
          &flow_groups_run_event_loop_delay_rt},
@@ -50,6 +56,8 @@ struct ServerHistograms : public HistogramBundle {
         {"logsconfig_manager_delta_apply_latency",
          &logsconfig_manager_delta_apply_latency},
         {"background_thread_duration", &background_thread_duration},
+        {"buffered_writer_batch_size", &buffered_writer_batch_size},
+        {"buffered_writer_batch_delay", &buffered_writer_batch_delay},
         {"nodes_configuration_manager_propagation_latency",
          &nodes_configuration_manager_propagation_latency},
 #define REQUEST_TYPE(name)              \
@@ -67,36 +75,81 @@ struct ServerHistograms : public HistogramBundle {
    &storage_task_response_duration[int(StorageTaskType::type)]},
 #include "logdevice/common/storage_task_types.inc" // nolint
     };
+    for (int i = 0;
+         i < static_cast<int>(StorageTaskPriority::NUM_PRIORITIES);
+         ++i) {
+      const std::string& name =
+          storageTaskPriorityNames[static_cast<StorageTaskPriority>(i)];
+      map["storage_task_queue_time.priority." + name] =
+          &storage_task_queue_time_by_priority[i];
+      map["storage_task_batching_time.priority." + name] =
+          &storage_task_batching_time_by_priority[i];
+      map["storage_task_execution_time.priority." + name] =
+          &storage_task_execution_time_by_priority[i];
+    }
+    for (int i = 0;
+         i < static_cast<int>(StorageTaskPrincipal::NUM_PRINCIPALS);
+         ++i) {
+      const std::string& name =
+          storageTaskPrincipalNames[static_cast<StorageTaskPrincipal>(i)];
+      map["storage_task_queue_time.principal." + name] =
+          &storage_task_queue_time_by_principal[i];
+      map["storage_task_batching_time.principal." + name] =
+          &storage_task_batching_time_by_principal[i];
+      map["storage_task_execution_time.principal." + name] =
+          &storage_task_execution_time_by_principal[i];
+    }
+    return map;
   }
   // Latency of appends as seen by the sequencer
-  LatencyHistogram append_latency;
-
-  LatencyHistogram write_to_read_latency;
-
-  LatencyHistogram store_bw_wait_latency;
-
-  LatencyHistogram store_timeouts;
+  SketchLatencyHistogram append_latency;
+
+  // Breakdown of append latency by stage:
+  //  - sequencer_queue: from the Appender's creation until it got an LSN and
+  //    sent its first wave, e.g. while buffered for sequencer activation;
+  //  - store: from getting an LSN until the record was fully replicated;
+  //  - store_network: for each copy, time between sending the wave and
+  //    getting STORED that the storage node didn't account for, i.e.
+  //    network, chain forwarding and traffic shaping. Only if storage nodes
+  //    report StoreStageTimes, see --append-stage-times;
+  //  - release: from full replication until the Appender was reaped and
+  //    RELEASE could be sent, i.e. waiting for earlier records in the
+  //    sliding window.
+  // Storage node stages are in PerShardHistograms::store_stage_*.
+  SketchLatencyHistogram append_stage_sequencer_queue;
+  SketchLatencyHistogram append_stage_store;
+  SketchLatencyHistogram append_stage_store_network;
+  SketchLatencyHistogram append_stage_release;
+
+  SketchLatencyHistogram write_to_read_latency;
+
+  SketchLatencyHistogram store_bw_wait_latency;
+
+  SketchLatencyHistogram store_timeouts;
 
   // Latency of posting a request
-  LatencyHistogram requests_queue_latency;
+  SketchLatencyHistogram requests_queue_latency;
 
-  LatencyHistogram hi_pri_requests_latency;
+  SketchLatencyHistogram hi_pri_requests_latency;
 
-  LatencyHistogram mid_pri_requests_latency;
+  SketchLatencyHistogram mid_pri_requests_latency;
 
-  LatencyHistogram lo_pri_requests_latency;
+  SketchLatencyHistogram lo_pri_requests_latency;
 
   // How long the gossip requests stay in the pipe
-  LatencyHistogram gossip_queue_latency;
+  SketchLatencyHistogram gossip_queue_latency;
 
   // Time elapsed since a gossip message was sent by a node
   // to the time it was actually taken out from recepient pipe
-  LatencyHistogram gossip_recv_latency;
+  SketchLatencyHistogram gossip_recv_latency;
+
+  // Time the failure detector spent processing a received gossip message
+  SketchLatencyHistogram gossip_processing_time;
 
   // Time delay between the deadline for releasing the next
   // quantum of bandwidth and the TrafficShaper actually
   // releasing the quantum.
-  LatencyHistogram traffic_shaper_bw_dispatch;
+  SketchLatencyHistogram traffic_shaper_bw_dispatch;
 
   // Time taken to seal a node participating in recovery.
   CompactLatencyHistogram log_recovery_seal_node;
@@ -114,26 +167,36 @@ struct ServerHistograms : public HistogramBundle {
   CompactLatencyHistogram log_recovery_epoch;
 
   // number of restarts in epoch recovery
-  NoUnitHistogram log_recovery_epoch_restarts;
+  SketchNoUnitHistogram log_recovery_epoch_restarts;
+
+  // Time from sequencer activation until recovery of the log completed
+  // successfully, including time spent in the recovery queue and retries.
+  CompactLatencyHistogram log_recovery_full;
 
   // Time between when we trigger the flow_groups_run_requested libevent event,
   // and when it actually runs.
-  LatencyHistogram flow_groups_run_event_loop_delay;
-  LatencyHistogram flow_groups_run_event_loop_delay_rt;
+  SketchLatencyHistogram flow_groups_run_event_loop_delay;
+  SketchLatencyHistogram flow_groups_run_event_loop_delay_rt;
 
   // Duration of Sender::runFlowGroups.
-  LatencyHistogram flow_groups_run_time;
-  LatencyHistogram flow_groups_run_time_rt;
+  SketchLatencyHistogram flow_groups_run_time;
+  SketchLatencyHistogram flow_groups_run_time_rt;
 
   // How long does it take the LogsConfigManager to clone a LogsConfigTree and
   // make it available to the rest of the system
-  LatencyHistogram logsconfig_manager_tree_clone_latency;
+  SketchLatencyHistogram logsconfig_manager_tree_clone_latency;
 
   // How long does it take to apply deltas to LogsConfig Tree
-  LatencyHistogram logsconfig_manager_delta_apply_latency;
+  SketchLatencyHistogram logsconfig_manager_delta_apply_latency;
 
   CompactLatencyHistogram background_thread_duration;
 
+  // Uncompressed payload bytes in batches built by BufferedWriter on the
+  // server (i.e. by sequencer batching), and how long the oldest append in
+  // each batch was buffered before the batch was sent.
+  SketchSizeHistogram buffered_writer_batch_size;
+  SketchLatencyHistogram buffered_writer_batch_delay;
+
   // How long did it take between when the config is published and when it
   // was received on the server in msec.
   CompactLatencyHistogram nodes_configuration_manager_propagation_latency;
@@ -144,6 +207,28 @@ struct ServerHistograms : public HistogramBundle {
       message_callback_duration;
   std::array<CompactLatencyHistogram, static_cast<int>(StorageTaskType::MAX)>
       storage_task_response_duration;
+
+  // Where storage tasks spend their time between being put on a storage
+  // thread pool's queue and finishing execution, by priority and principal:
+  //  - queue: waiting in the pool's queue (PrioritizedQueue or DRR). For
+  //    writes, waiting in the write queue for a WriteBatchStorageTask;
+  //  - batching: writes only, from being picked up by a WriteBatchStorageTask
+  //    until the batch is written, including write throttling;
+  //  - execution: executing, for writes the whole batch's write.
+  // WriteBatchStorageTasks themselves are left out, their writes are counted
+  // instead. See ExecStorageThread::reportTaskStageTimes().
+  using PerStorageTaskPriorityHistograms = std::array<
+      CompactLatencyHistogram,
+      static_cast<int>(StorageTaskPriority::NUM_PRIORITIES)>;
+  using PerStorageTaskPrincipalHistograms = std::array<
+      CompactLatencyHistogram,
+      static_cast<int>(StorageTaskPrincipal::NUM_PRINCIPALS)>;
+  PerStorageTaskPriorityHistograms storage_task_queue_time_by_priority;
+  PerStorageTaskPriorityHistograms storage_task_batching_time_by_priority;
+  PerStorageTaskPriorityHistograms storage_task_execution_time_by_priority;
+  PerStorageTaskPrincipalHistograms storage_task_queue_time_by_principal;
+  PerStorageTaskPrincipalHistograms storage_task_batching_time_by_principal;
+  PerStorageTaskPrincipalHistograms storage_task_execution_time_by_principal;
 };
 
 }} // namespace facebook::logdevice
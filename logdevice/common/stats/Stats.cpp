@@ -14,10 +14,13 @@
 
 #include <boost/algorithm/string/predicate.hpp>
 #include <folly/Conv.h>
+#include <folly/Random.h>
 #include <folly/Synchronized.h>
+#include <folly/lang/Bits.h>
 #include <folly/stats/BucketedTimeSeries.h>
 #include <folly/stats/MultiLevelTimeSeries.h>
 
+#include "logdevice/common/PrincipalIdentity.h"
 #include "logdevice/common/stats/ClientHistograms.h"
 #include "logdevice/common/stats/Histogram.h"
 #include "logdevice/common/stats/PerMonitoringTagHistograms.h"
@@ -117,6 +120,123 @@ void PerLogStats::aggregate(PerLogStats const& other,
 #include "logdevice/common/stats/per_log_stats.inc" // nolint
 }
 
+constexpr size_t PerLogStatsSlab::FIRST_CHUNK_SIZE;
+constexpr size_t PerLogStatsSlab::MAX_CHUNKS;
+
+PerLogStatsSlab::~PerLogStatsSlab() = default;
+
+std::pair<size_t, size_t> PerLogStatsSlab::locate(size_t idx) {
+  // Chunk i starts at index FIRST_CHUNK_SIZE * (2^i - 1).
+  const size_t chunk = folly::findLastSet(idx / FIRST_CHUNK_SIZE + 1) - 1;
+  return {chunk, idx - FIRST_CHUNK_SIZE * ((size_t(1) << chunk) - 1)};
+}
+
+void PerLogStatsSlab::append(std::string log_group,
+                             std::shared_ptr<PerLogStats> stats) {
+  // Only the writer modifies size_.
+  const size_t idx = size_.load(std::memory_order_relaxed);
+  auto loc = locate(idx);
+  ld_check(loc.first < MAX_CHUNKS);
+  if (loc.second == 0) {
+    chunks_[loc.first] =
+        std::make_unique<Entry[]>(FIRST_CHUNK_SIZE << loc.first);
+  }
+  Entry& entry = chunks_[loc.first][loc.second];
+  entry.log_group = std::move(log_group);
+  entry.stats = std::move(stats);
+  size_.store(idx + 1, std::memory_order_release);
+}
+
+void PerLogHeavyHitters::add(
+    std::unique_ptr<WindowedHeavyHitters> PerLogHeavyHitters::*series,
+    std::chrono::milliseconds span,
+    const StatsParams& params,
+    folly::StringPiece log_group,
+    int64_t val) {
+  if (params.per_log_stats_sample_period > 1) {
+    if (sample_countdown > 0) {
+      --sample_countdown;
+      return;
+    }
+    // Random gaps between samples, averaging the sample period, so that
+    // periodic patterns in the workload don't bias the sample.
+    sample_countdown =
+        folly::Random::rand32(2 * params.per_log_stats_sample_period - 1);
+    val *= params.per_log_stats_sample_period;
+  }
+  const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now().time_since_epoch());
+
+  std::lock_guard<std::mutex> guard(mutex);
+  auto& hh = this->*series;
+  if (UNLIKELY(!hh)) {
+    hh = std::make_unique<WindowedHeavyHitters>(
+        span, params.per_log_stats_top_k);
+  }
+  hh->add(log_group, std::max<int64_t>(val, 0), now);
+}
+
+const char* clientResourceName(ClientResource resource) {
+  switch (resource) {
+#define CLIENT_RESOURCE_DEFINE(name, str) \
+  case ClientResource::name:              \
+    return str;
+#include "logdevice/common/stats/per_client_resources.inc" // nolint
+    case ClientResource::MAX:
+      break;
+  }
+  return "unknown";
+}
+
+constexpr std::chrono::milliseconds PerClientHeavyHitters::SPAN;
+
+void PerClientHeavyHitters::add(ClientResource resource,
+                                const PrincipalIdentity* principal,
+                                int64_t val,
+                                const StatsParams& params) {
+  if (val <= 0) {
+    return;
+  }
+  const std::string principal_name =
+      principal ? principal->accountingName() : "";
+  const std::string& client_name = principal ? principal->client_address : "";
+  const folly::StringPiece names[NUM_DIMENSIONS] = {
+      principal_name.empty() ? "UNKNOWN" : principal_name,
+      client_name.empty() ? "UNKNOWN" : client_name};
+  const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now().time_since_epoch());
+  const size_t idx = static_cast<size_t>(resource);
+  std::lock_guard<std::mutex> guard(mutex);
+  for (int dim = 0; dim < NUM_DIMENSIONS; ++dim) {
+    auto& hh = series[dim][idx];
+    if (UNLIKELY(!hh)) {
+      hh = std::make_unique<WindowedHeavyHitters>(
+          SPAN, params.per_client_stats_top_k);
+    }
+    hh->add(names[dim], val, now);
+  }
+}
+
+void PerClientHeavyHitters::reset() {
+  std::lock_guard<std::mutex> guard(mutex);
+  for (auto& dim : series) {
+    for (auto& hh : dim) {
+      if (hh) {
+        hh->clear();
+      }
+    }
+  }
+}
+
+void PerLogHeavyHitters::reset() {
+  std::lock_guard<std::mutex> guard(mutex);
+#define TIME_SERIES_DEFINE(name, _, __, ___) \
+  if (name) {                                \
+    name->clear();                           \
+  }
+#include "logdevice/common/stats/per_log_time_series.inc" // nolint
+}
+
 void PerTrafficClassStats::aggregate(PerTrafficClassStats const& other,
                                      StatsAggOptional agg_override) {
 #define STAT_DEFINE(name, agg) \
@@ -174,6 +294,19 @@ void PerMonitoringTagStats::reset() {
 #include "logdevice/common/stats/per_monitoring_tag_stats.inc" // nolint
 }
 
+PerLogGroupE2EStats::PerLogGroupE2EStats()
+    : histograms{std::make_unique<E2ELatencyHistograms>()} {}
+
+PerLogGroupE2EStats::PerLogGroupE2EStats(const PerLogGroupE2EStats& other)
+    : histograms{std::make_unique<E2ELatencyHistograms>(*other.histograms)} {}
+
+PerLogGroupE2EStats::~PerLogGroupE2EStats() = default;
+
+void PerLogGroupE2EStats::aggregate(PerLogGroupE2EStats const& other,
+                                    StatsAggOptional agg_override) {
+  aggregateHistogram(agg_override, *histograms, *other.histograms);
+}
+
 PerShapingPriorityStats::PerShapingPriorityStats()
     : time_in_queue(std::make_unique<LatencyHistogram>()) {}
 
@@ -312,6 +445,16 @@ Stats::Stats(Stats&& other) noexcept(true) = default;
 
 Stats& Stats::operator=(Stats&& other) noexcept(false) = default;
 
+PerLogStatsMap::iterator
+Stats::emplacePerLogStats(PerLogStatsMap& locked_map,
+                          const std::string& log_group,
+                          std::shared_ptr<PerLogStats> stats) {
+  auto res = locked_map.emplace(log_group, stats);
+  ld_check(res.second);
+  per_log_stats_slab->append(log_group, std::move(stats));
+  return res.first;
+}
+
 void Stats::aggregate(Stats const& other, StatsAggOptional agg_override) {
   switch (params->get()->stats_set) {
     case StatsParams::StatsSet::DEFAULT:
@@ -441,6 +584,15 @@ void Stats::aggregateCompoundStats(Stats const& other,
         }
       });
 
+  per_log_group_e2e_stats.withWLock(
+      [&agg_override,
+       other_copy = other.synchronizedCopy(&Stats::per_log_group_e2e_stats)](
+          auto& stats) {
+        for (const auto& [log_group, other_stats] : other_copy) {
+          stats[log_group].aggregate(other_stats, agg_override);
+        }
+      });
+
   for (int i = 0; i < per_flow_group_stats.size(); ++i) {
     per_flow_group_stats[i].aggregate(
         other.per_flow_group_stats[i], agg_override);
@@ -465,22 +617,20 @@ void Stats::aggregateCompoundStats(Stats const& other,
         other.per_storage_task_type_stats[i], agg_override);
   }
 
-  // Aggregate per log stats. Use synchronizedCopy() to copy other's
-  // per_log_stats into temporary vector, to avoid holding a read lock on it
-  // while we aggregate.
-  this->per_log_stats.withWLock(
-      [&agg_override,
-       other_per_log_stats_entries = other.synchronizedCopy(
-           &Stats::per_log_stats)](auto& this_per_log_stats) {
-        for (const auto& kv : other_per_log_stats_entries) {
-          ld_check(kv.second != nullptr);
-          auto& stats_ptr = this_per_log_stats[kv.first];
-          if (stats_ptr == nullptr) {
-            stats_ptr = std::make_shared<PerLogStats>();
-          }
-          stats_ptr->aggregate(*kv.second, agg_override);
-        }
-      });
+  // Aggregate per log stats. Go over other's per_log_stats_slab rather than
+  // its map, so that neither its lock is taken nor the map copied (which is
+  // slow with many log groups and threads).
+  this->per_log_stats.withWLock([&](auto& this_per_log_stats) {
+    other.per_log_stats_slab->forEach([&](const PerLogStatsSlab::Entry& e) {
+      ld_check(e.stats != nullptr);
+      auto it = this_per_log_stats.find(e.log_group);
+      if (it == this_per_log_stats.end()) {
+        it = emplacePerLogStats(
+            this_per_log_stats, e.log_group, std::make_shared<PerLogStats>());
+      }
+      it->second->aggregate(*e.stats, agg_override);
+    });
+  });
 
   // Aggregate per worker stats. Also use synchronizedCopy()
   this->per_worker_stats.withWLock(
@@ -547,6 +697,7 @@ void Stats::reset() {
 #define STAT_DEFINE(name, _) client.name = {};
 #include "logdevice/common/stats/client_stats.inc" // nolint
         client.histograms->clear();
+        per_log_group_e2e_stats.wlock()->clear();
       }
 
       for (auto& tcs : per_traffic_class_stats) {
@@ -573,7 +724,13 @@ void Stats::reset() {
 
       per_worker_stats.wlock()->clear();
 
-      per_log_stats.wlock()->clear();
+      {
+        auto locked = per_log_stats.wlock();
+        locked->clear();
+        per_log_stats_slab = std::make_unique<PerLogStatsSlab>();
+      }
+      per_log_heavy_hitters.reset();
+      per_client_heavy_hitters.reset();
       break;
     case StatsParams::StatsSet::LDBENCH_WORKER:
 #define STAT_DEFINE(name, _) ldbench->name = {};
@@ -812,11 +969,20 @@ void Stats::enumerate(EnumerationCallbacks* cb, bool list_all) const {
   cb->stat(
       "request_worker_usec.INVALID",
       per_request_type_stats[int(RequestType::INVALID)].request_worker_usec);
+  cb->stat("request_worker_cpu_usec.INVALID",
+           per_request_type_stats[int(RequestType::INVALID)]
+               .request_worker_cpu_usec);
 
   // Per storage task type
   std::array<bool, static_cast<int>(StorageTaskType::MAX)>
       publish_stats_by_index = {};
   std::unordered_map<std::string, bool> publish_stats_by_name;
+  const std::array<const char*, 5> io_histogram_prefixes = {
+      "io_read_latency.",
+      "io_read_size.",
+      "io_write_latency.",
+      "io_write_size.",
+      "io_block_cache_misses."};
 #define STORAGE_TASK_TYPE(type, str_name, v)                              \
   {                                                                       \
     bool publish = list_all ? true : v;                                   \
@@ -824,6 +990,9 @@ void Stats::enumerate(EnumerationCallbacks* cb, bool list_all) const {
     publish_stats_by_index[int(StorageTaskType::type)] = publish;         \
     publish_stats_by_name[str_name] = publish;                            \
     publish_stats_by_name["queue_time." str_name] = publish;              \
+    for (const char* prefix : io_histogram_prefixes) {                    \
+      publish_stats_by_name[std::string(prefix) + str_name] = publish;    \
+    }                                                                     \
   }
 #include "logdevice/common/storage_task_types.inc"
 
@@ -888,6 +1057,10 @@ void Stats::enumerate(EnumerationCallbacks* cb, bool list_all) const {
     for (auto& hist : per_shard_histograms->map()) {
       auto it = publish_stats_by_name.find(hist.first);
       if (it != publish_stats_by_name.end() && !it->second) {
+        if (boost::starts_with(hist.first, "io_")) {
+          // Not worth publishing for the task types that aren't.
+          continue;
+        }
         if (boost::starts_with(hist.first, "queue_time.")) {
           unknown_queue_histogram.merge(*hist.second);
         } else {
@@ -913,6 +1086,13 @@ void Stats::enumerate(EnumerationCallbacks* cb, bool list_all) const {
     for (auto& i : client.histograms->map()) {
       cb->histogram(i.first, *i.second);
     }
+
+    // Per log group end-to-end latency, with the log group as tag.
+    for (const auto& [log_group, stats] : *per_log_group_e2e_stats.ulock()) {
+      for (auto& i : stats.histograms->map()) {
+        cb->histogramWithTag(i.first, log_group, *i.second);
+      }
+    }
   }
 }
 
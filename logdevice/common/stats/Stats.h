@@ -8,6 +8,7 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <map>
@@ -15,6 +16,7 @@
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <folly/Conv.h>
@@ -31,6 +33,7 @@
 #include "logdevice/common/configuration/NodeLocation.h"
 #include "logdevice/common/configuration/TrafficClass.h"
 #include "logdevice/common/protocol/MessageType.h"
+#include "logdevice/common/stats/HeavyHitters.h"
 #include "logdevice/common/stats/StatsCounter.h"
 #include "logdevice/common/types_internal.h"
 #include "logdevice/common/util.h"
@@ -61,6 +64,7 @@ struct ClientHistograms;
 struct PerShardHistograms;
 struct ServerHistograms;
 struct PerMonitoringTagHistograms;
+struct E2ELatencyHistograms;
 
 /**
  * How to combine two Stats objects.
@@ -152,6 +156,141 @@ struct PerLogStats {
   std::mutex mutex;
 };
 
+using PerLogStatsMap =
+    std::unordered_map<std::string, std::shared_ptr<PerLogStats>>;
+
+/**
+ * Append-only list of the entries of one Stats::per_log_stats map, so that
+ * aggregation can go over them without locking the map (and making the
+ * owning worker wait to add a log group) or copying it.
+ *
+ * Entries live in chunks of doubling size that are never moved, and are
+ * published by a release store of the size. One writer at a time, any number
+ * of lock-free readers.
+ */
+class PerLogStatsSlab {
+ public:
+  struct Entry {
+    std::string log_group;
+    std::shared_ptr<PerLogStats> stats;
+  };
+
+  PerLogStatsSlab() = default;
+  ~PerLogStatsSlab();
+
+  PerLogStatsSlab(const PerLogStatsSlab&) = delete;
+  PerLogStatsSlab& operator=(const PerLogStatsSlab&) = delete;
+
+  void append(std::string log_group, std::shared_ptr<PerLogStats> stats);
+
+  /**
+   * Calls f(const Entry&) for each entry appended before the call.
+   */
+  template <typename F>
+  void forEach(F&& f) const {
+    const size_t n = size_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < n; ++i) {
+      auto loc = locate(i);
+      f(chunks_[loc.first][loc.second]);
+    }
+  }
+
+  size_t size() const {
+    return size_.load(std::memory_order_acquire);
+  }
+
+ private:
+  static constexpr size_t FIRST_CHUNK_SIZE = 64;
+  static constexpr size_t MAX_CHUNKS = 32;
+
+  // @return chunk and offset in the chunk of the entry at `idx`
+  static std::pair<size_t, size_t> locate(size_t idx);
+
+  // Chunk i has FIRST_CHUNK_SIZE << i entries.
+  std::array<std::unique_ptr<Entry[]>, MAX_CHUNKS> chunks_;
+  std::atomic<size_t> size_{0};
+};
+
+struct PrincipalIdentity;
+struct StatsParams;
+
+/**
+ * Log group throughput tracked by one thread when
+ * StatsParams::per_log_stats_top_k is positive, instead of the time series in
+ * PerLogStats: one WindowedHeavyHitters per time series of
+ * per_log_time_series.inc, spanning its longest interval. Memory is bounded
+ * no matter how many log groups there are, and updates don't need
+ * per-log-group allocations or a lookup in a shared map.
+ */
+struct PerLogHeavyHitters {
+  /**
+   * Adds `val` for `log_group` to `series`, created with the given span on
+   * first use. Only called by the owning thread.
+   */
+  void add(std::unique_ptr<WindowedHeavyHitters> PerLogHeavyHitters::*series,
+           std::chrono::milliseconds span,
+           const StatsParams& params,
+           folly::StringPiece log_group,
+           int64_t val);
+
+  void reset();
+
+#define TIME_SERIES_DEFINE(name, _, __, ___) \
+  std::unique_ptr<WindowedHeavyHitters> name;
+#include "logdevice/common/stats/per_log_time_series.inc" // nolint
+
+  // Locked by the owning thread on updates and by readers, so it's almost
+  // never contended.
+  std::mutex mutex;
+
+  // Number of updates to skip before the next sampled one. Only accessed by
+  // the owning thread.
+  uint32_t sample_countdown = 0;
+};
+
+enum class ClientResource : uint8_t {
+#define CLIENT_RESOURCE_DEFINE(name, _) name,
+#include "logdevice/common/stats/per_client_resources.inc" // nolint
+  MAX
+};
+
+const char* clientResourceName(ClientResource resource);
+
+/**
+ * Resources of a server used by each principal and each client host, tracked
+ * by one thread when StatsParams::per_client_stats_top_k is positive: one
+ * WindowedHeavyHitters spanning SPAN per resource of per_client_resources.inc
+ * and per dimension. Like PerLogHeavyHitters, memory is bounded no matter
+ * how many clients there are, and the top ones are accurate. See
+ * CLIENT_RESOURCE_ADD().
+ */
+struct PerClientHeavyHitters {
+  static constexpr std::chrono::milliseconds SPAN{std::chrono::minutes(10)};
+
+  enum Dimension { PRINCIPAL, CLIENT, NUM_DIMENSIONS };
+
+  /**
+   * Adds `val` of `resource` to the principal (its accountingName()) and to
+   * the client host (its client_address) of `principal`, or to "UNKNOWN" for
+   * what isn't known. Only called by the owning thread.
+   */
+  void add(ClientResource resource,
+           const PrincipalIdentity* principal,
+           int64_t val,
+           const StatsParams& params);
+
+  void reset();
+
+  // Created on first use.
+  std::array<std::array<std::unique_ptr<WindowedHeavyHitters>,
+                        static_cast<size_t>(ClientResource::MAX)>,
+             NUM_DIMENSIONS>
+      series;
+
+  // Locked by the owning thread on updates and by readers.
+  std::mutex mutex;
+};
+
 struct PerTrafficClassStats {
   PerTrafficClassStats() {}
 
@@ -191,6 +330,21 @@ struct PerMonitoringTagStats {
   std::unique_ptr<PerMonitoringTagHistograms> histograms;
 };
 
+/**
+ * Client-side stats of the records of a log group that were sampled for
+ * end-to-end latency tracing.
+ */
+struct PerLogGroupE2EStats {
+  PerLogGroupE2EStats();
+  PerLogGroupE2EStats(const PerLogGroupE2EStats&);
+  ~PerLogGroupE2EStats();
+
+  void aggregate(PerLogGroupE2EStats const& other,
+                 StatsAggOptional agg_override);
+
+  std::unique_ptr<E2ELatencyHistograms> histograms;
+};
+
 struct PerShapingPriorityStats {
   PerShapingPriorityStats();
   ~PerShapingPriorityStats();
@@ -484,6 +638,20 @@ struct StatsParams {
   std::chrono::milliseconds worker_stats_retention_time =
       std::chrono::seconds(60);
 
+  // If positive, log group throughput (per_log_time_series.inc) is tracked
+  // with a count-min sketch and this many top log groups per thread, in
+  // PerLogHeavyHitters, rather than with a time series per log group.
+  size_t per_log_stats_top_k = 0;
+
+  // With per_log_stats_top_k, only one in this many log group throughput
+  // updates (on average) is recorded, with its value scaled up accordingly.
+  uint32_t per_log_stats_sample_period = 1;
+
+  // If positive, resources used by each principal and client are tracked in
+  // PerClientHeavyHitters, with this many top principals and clients per
+  // thread. 0 disables it.
+  size_t per_client_stats_top_k = 0;
+
 #define TIME_SERIES_DEFINE(name, _, t, buckets)                     \
   std::vector<std::chrono::milliseconds> time_intervals_##name = t; \
   StatsParams& setTimeIntervals_##name(                             \
@@ -520,6 +688,21 @@ struct StatsParams {
     stats_set = set;
     return *this;
   }
+
+  StatsParams& setPerLogStatsTopK(size_t top_k) {
+    per_log_stats_top_k = top_k;
+    return *this;
+  }
+
+  StatsParams& setPerLogStatsSamplePeriod(uint32_t period) {
+    per_log_stats_sample_period = period;
+    return *this;
+  }
+
+  StatsParams& setPerClientStatsTopK(size_t top_k) {
+    per_client_stats_top_k = top_k;
+    return *this;
+  }
 };
 
 /**
@@ -658,6 +841,15 @@ struct Stats final {
     });
   }
 
+  /**
+   * Adds PerLogStats for a new log group to per_log_stats, which the caller
+   * must have write-locked, and to per_log_stats_slab.
+   */
+  PerLogStatsMap::iterator
+  emplacePerLogStats(PerLogStatsMap& locked_map,
+                     const std::string& log_group,
+                     std::shared_ptr<PerLogStats> stats);
+
 #define STAT_DEFINE(name, _) StatsCounter name{};
 #include "logdevice/common/stats/server_stats.inc" // nolint
 #define STAT_DEFINE(name, _) StatsCounter name{};
@@ -671,6 +863,11 @@ struct Stats final {
   folly::Synchronized<folly::F14FastMap<std::string, PerMonitoringTagStats>>
       per_monitoring_tag_stats;
 
+  // Client only. Per-log-group stats of records sampled for end-to-end
+  // latency tracing, see LOG_GROUP_E2E_LATENCY_ADD().
+  folly::Synchronized<folly::F14FastMap<std::string, PerLogGroupE2EStats>>
+      per_log_group_e2e_stats;
+
   // per-flow group stats
   // For Network Traffic Shaping
   std::array<PerFlowGroupStats, static_cast<int>(NodeLocation::NUM_ALL_SCOPES)>
@@ -690,10 +887,23 @@ struct Stats final {
   std::array<PerStorageTaskTypeStats, static_cast<int>(StorageTaskType::MAX)>
       per_storage_task_type_stats = {};
 
-  // Per-log-group stats
-  folly::Synchronized<
-      std::unordered_map<std::string, std::shared_ptr<PerLogStats>>>
-      per_log_stats;
+  // Per-log-group stats. New entries must be added with
+  // emplacePerLogStats().
+  folly::Synchronized<PerLogStatsMap> per_log_stats;
+
+  // The entries of per_log_stats, for readers in other threads. Replaced by
+  // reset(), so only read while StatsHolder's list of threads is locked (like
+  // in StatsHolder::aggregate() and runForEach()), which reset() also holds.
+  std::unique_ptr<PerLogStatsSlab> per_log_stats_slab =
+      std::make_unique<PerLogStatsSlab>();
+
+  // Per-log-group throughput, when StatsParams::per_log_stats_top_k is
+  // positive. Not aggregated.
+  PerLogHeavyHitters per_log_heavy_hitters;
+
+  // Resources used by each principal and client, when
+  // StatsParams::per_client_stats_top_k is positive. Not aggregated.
+  PerClientHeavyHitters per_client_heavy_hitters;
 
   // Server histograms. Initialized only on servers.
   std::unique_ptr<ServerHistograms> server_histograms;
@@ -1088,42 +1298,60 @@ class PerShardStatToken {
         /* No risk of deadlock because we are the only writer thread. */ \
         auto stats_ptr = std::make_shared<PerLogStats>();                \
         stats_ptr->name += (val);                                        \
-        stats_ulock.moveFromUpgradeToWrite()->emplace_hint(              \
-            stats_it, (log_name), std::move(stats_ptr));                 \
+        (stats_struct)                                                   \
+            ->get()                                                      \
+            .emplacePerLogStats(*stats_ulock.moveFromUpgradeToWrite(),   \
+                                (log_name),                              \
+                                std::move(stats_ptr));                   \
       }                                                                  \
     }                                                                    \
   } while (0)
 
 #define LOG_GROUP_TIME_SERIES_ADD(stats_struct, stat_name, log_name, val)      \
   do {                                                                         \
-    if (stats_struct) {                                                        \
-      auto stats_ulock = (stats_struct)->get().per_log_stats.ulock();          \
-      /* Unfortunately, the type of the lock after a downgrade from write to   \
-       * upgrade isn't the same as the type of upgrade lock initially acquired \
-       */                                                                      \
-      folly::LockedPtr<decltype(stats_ulock)::Synchronized,                    \
-                       folly::LockPolicyFromExclusiveToUpgrade>                \
-          stats_downgraded_ulock;                                              \
-      auto stats_it = stats_ulock->find((log_name));                           \
-      if (UNLIKELY(stats_it == stats_ulock->end())) {                          \
-        /* PerLogStats for log_name do not exist yet (rare case). */           \
-        /* Upgrade ulock to wlock and emplace new PerLogStats. */              \
-        /* No risk of deadlock because we are the only writer thread. */       \
-        auto stats_ptr = std::make_shared<PerLogStats>();                      \
-        auto stats_wlock = stats_ulock.moveFromUpgradeToWrite();               \
-        stats_it =                                                             \
-            stats_wlock->emplace((log_name), std::move(stats_ptr)).first;      \
-        stats_downgraded_ulock = stats_wlock.moveFromWriteToUpgrade();         \
-      }                                                                        \
-      {                                                                        \
-        std::lock_guard<std::mutex> guard(stats_it->second->mutex);            \
-        if (UNLIKELY(!stats_it->second->stat_name)) {                          \
-          stats_it->second->stat_name = std::make_shared<PerLogTimeSeries>(    \
-              (stats_struct)->params_.get()->num_buckets_##stat_name,          \
-              (stats_struct)->params_.get()->time_intervals_##stat_name);      \
-        }                                                                      \
-        stats_it->second->stat_name->addValue(val);                            \
+    if (!(stats_struct)) {                                                     \
+      break;                                                                   \
+    }                                                                          \
+    auto stats_params = (stats_struct)->params_.get();                         \
+    if (stats_params->per_log_stats_top_k > 0) {                               \
+      (stats_struct)                                                           \
+          ->get()                                                              \
+          .per_log_heavy_hitters.add(                                          \
+              &PerLogHeavyHitters::stat_name,                                  \
+              stats_params->time_intervals_##stat_name.back(),                 \
+              *stats_params,                                                   \
+              (log_name),                                                      \
+              (val));                                                          \
+      break;                                                                   \
+    }                                                                          \
+    auto stats_ulock = (stats_struct)->get().per_log_stats.ulock();            \
+    /* Unfortunately, the type of the lock after a downgrade from write to     \
+     * upgrade isn't the same as the type of upgrade lock initially acquired   \
+     */                                                                        \
+    folly::LockedPtr<decltype(stats_ulock)::Synchronized,                      \
+                     folly::LockPolicyFromExclusiveToUpgrade>                  \
+        stats_downgraded_ulock;                                                \
+    auto stats_it = stats_ulock->find((log_name));                             \
+    if (UNLIKELY(stats_it == stats_ulock->end())) {                            \
+      /* PerLogStats for log_name do not exist yet (rare case). */             \
+      /* Upgrade ulock to wlock and emplace new PerLogStats. */                \
+      /* No risk of deadlock because we are the only writer thread. */         \
+      auto stats_ptr = std::make_shared<PerLogStats>();                        \
+      auto stats_wlock = stats_ulock.moveFromUpgradeToWrite();                 \
+      stats_it = (stats_struct)                                                \
+                     ->get()                                                   \
+                     .emplacePerLogStats(                                      \
+                         *stats_wlock, (log_name), std::move(stats_ptr));      \
+      stats_downgraded_ulock = stats_wlock.moveFromWriteToUpgrade();           \
+    }                                                                          \
+    {                                                                          \
+      std::lock_guard<std::mutex> guard(stats_it->second->mutex);              \
+      if (UNLIKELY(!stats_it->second->stat_name)) {                            \
+        stats_it->second->stat_name = std::make_shared<PerLogTimeSeries>(      \
+            stats_params->num_buckets_##stat_name,                             \
+            stats_params->time_intervals_##stat_name);                         \
       }                                                                        \
+      stats_it->second->stat_name->addValue(val);                              \
     }                                                                          \
   } while (0)
 
@@ -1144,8 +1372,10 @@ class PerShardStatToken {
         /* No risk of deadlock because we are the only writer thread. */       \
         auto stats_ptr = std::make_shared<PerLogStats>();                      \
         auto stats_wlock = stats_ulock.moveFromUpgradeToWrite();               \
-        stats_it =                                                             \
-            stats_wlock->emplace((log_name), std::move(stats_ptr)).first;      \
+        stats_it = (stats_struct)                                              \
+                       ->get()                                                 \
+                       .emplacePerLogStats(                                    \
+                           *stats_wlock, (log_name), std::move(stats_ptr));    \
         stats_downgraded_ulock = stats_wlock.moveFromWriteToUpgrade();         \
       }                                                                        \
       {                                                                        \
@@ -1254,6 +1484,36 @@ class PerShardStatToken {
     }                                                           \
   } while (0);
 
+#define LOG_GROUP_E2E_LATENCY_ADD(stats_struct, log_group, name, usecs) \
+  do {                                                                 \
+    if (stats_struct) {                                                \
+      (stats_struct)->get().per_log_group_e2e_stats.withWLock(         \
+          [&](auto& stats) {                                           \
+            stats[(log_group)].histograms->name.add(usecs);            \
+          });                                                          \
+    }                                                                  \
+  } while (0)
+
+/**
+ * Adds `val` of ClientResource::`resource` used by the client with the given
+ * `const PrincipalIdentity*` to PerClientHeavyHitters, if
+ * StatsParams::per_client_stats_top_k is positive. `principal` is only
+ * evaluated in that case.
+ */
+#define CLIENT_RESOURCE_ADD(stats_struct, resource, principal, val)   \
+  do {                                                               \
+    if (stats_struct &&                                              \
+        (stats_struct)->params_.get()->per_client_stats_top_k > 0) { \
+      (stats_struct)                                                 \
+          ->get()                                                    \
+          .per_client_heavy_hitters.add(                             \
+              ClientResource::resource,                              \
+              (principal),                                           \
+              (val),                                                 \
+              *(stats_struct)->params_.get());                       \
+    }                                                                \
+  } while (0)
+
 #define HISTOGRAM_ADD(stats_struct, name, usecs)                   \
   do {                                                             \
     if (stats_struct && (stats_struct)->get().server_histograms) { \
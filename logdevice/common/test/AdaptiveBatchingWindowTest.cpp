@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/buffered_writer/AdaptiveBatchingWindow.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+using namespace std::chrono_literals;
+
+namespace {
+
+using Clock = AdaptiveBatchingWindow::Clock;
+
+// Feeds `count` appends of `bytes` each, `gap` apart.
+Clock::time_point feed(AdaptiveBatchingWindow& window,
+                       Clock::time_point start,
+                       int count,
+                       std::chrono::microseconds gap,
+                       size_t bytes) {
+  Clock::time_point t = start;
+  for (int i = 0; i < count; ++i) {
+    window.onAppend(t, bytes);
+    t += gap;
+  }
+  return t;
+}
+
+} // namespace
+
+TEST(AdaptiveBatchingWindowTest, NoHistory) {
+  AdaptiveBatchingWindow window;
+  EXPECT_EQ(0ms, window.getWindow(100ms, -1));
+  window.onAppend(Clock::now(), 100);
+  EXPECT_EQ(0ms, window.getWindow(100ms, -1));
+  // No time trigger stays no time trigger.
+  EXPECT_EQ(-1ms, window.getWindow(-1ms, -1));
+}
+
+TEST(AdaptiveBatchingWindowTest, QuietLogFlushesRightAway) {
+  AdaptiveBatchingWindow window;
+  // One append every second; nothing else is going to show up within 100ms.
+  feed(window, Clock::now(), 20, 1s, 100);
+  EXPECT_EQ(0ms, window.getWindow(100ms, -1));
+  // But with a large enough budget it's worth waiting.
+  EXPECT_EQ(5s, window.getWindow(5s, -1));
+}
+
+TEST(AdaptiveBatchingWindowTest, BusyLogWaitsToFillBatch) {
+  AdaptiveBatchingWindow window;
+  // One 100-byte append per millisecond.
+  feed(window, Clock::now(), 50, 1ms, 100);
+  EXPECT_NEAR(1000, window.averageGapUsec(), 1);
+  EXPECT_NEAR(100, window.averageBytes(), 1e-6);
+
+  // No size trigger: use the whole budget.
+  EXPECT_EQ(100ms, window.getWindow(100ms, -1));
+  // 2000 bytes take 20 appends, i.e. 19 more after the first one.
+  EXPECT_EQ(19ms, window.getWindow(100ms, 2000));
+  // Never more than the budget.
+  EXPECT_EQ(10ms, window.getWindow(10ms, 2000));
+}
+
+TEST(AdaptiveBatchingWindowTest, FollowsRateChanges) {
+  AdaptiveBatchingWindow window;
+  auto t = feed(window, Clock::now(), 50, 1ms, 100);
+  EXPECT_EQ(100ms, window.getWindow(100ms, -1));
+  // Traffic dies down.
+  feed(window, t + 1s, 50, 1s, 100);
+  EXPECT_EQ(0ms, window.getWindow(100ms, -1));
+}
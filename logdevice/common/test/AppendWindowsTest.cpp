@@ -0,0 +1,121 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/AppendWindows.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+
+namespace {
+
+const logid_t LOG(1);
+
+class TestAppendWindows : public AppendWindows {
+ public:
+  TestAppendWindows()
+      : AppendWindows([this](request_id_t rqid) { resumed.push_back(rqid); }) {}
+
+  // Runs what the timer would.
+  void runResume() {
+    ASSERT_TRUE(scheduled);
+    scheduled = false;
+    resumeQueued();
+  }
+
+  std::vector<request_id_t> resumed;
+  bool scheduled = false;
+
+ protected:
+  void scheduleResume() override {
+    scheduled = true;
+  }
+};
+
+} // namespace
+
+TEST(AppendWindowsTest, QueuesBeyondWindowInOrder) {
+  TestAppendWindows windows;
+  EXPECT_TRUE(windows.admit(LOG, request_id_t(1), 2));
+  EXPECT_TRUE(windows.admit(LOG, request_id_t(2), 2));
+  EXPECT_FALSE(windows.admit(LOG, request_id_t(3), 2));
+  EXPECT_FALSE(windows.admit(LOG, request_id_t(4), 2));
+  // Other logs have their own windows.
+  EXPECT_TRUE(windows.admit(logid_t(2), request_id_t(5), 2));
+  EXPECT_EQ(2, windows.getInFlight(LOG));
+  EXPECT_EQ(2, windows.getQueued(LOG));
+
+  windows.onAppendDone(LOG, E::OK, 2);
+  // Queued appends are not resumed from within onAppendDone().
+  EXPECT_TRUE(windows.resumed.empty());
+  windows.runResume();
+  EXPECT_EQ(std::vector<request_id_t>({request_id_t(3)}), windows.resumed);
+  EXPECT_EQ(2, windows.getInFlight(LOG));
+
+  // A cancelled append doesn't hold a slot.
+  windows.cancel(LOG, request_id_t(4));
+  EXPECT_EQ(0, windows.getQueued(LOG));
+  windows.onAppendDone(LOG, E::OK, 2);
+  EXPECT_FALSE(windows.scheduled);
+  EXPECT_EQ(1, windows.getInFlight(LOG));
+}
+
+TEST(AppendWindowsTest, NewAppendsDontOvertakeQueuedOnes) {
+  TestAppendWindows windows;
+  EXPECT_TRUE(windows.admit(LOG, request_id_t(1), 1));
+  EXPECT_FALSE(windows.admit(LOG, request_id_t(2), 1));
+  windows.onAppendDone(LOG, E::OK, 1);
+  // A slot is free, but append 2 is waiting for it.
+  EXPECT_FALSE(windows.admit(LOG, request_id_t(3), 1));
+  windows.runResume();
+  EXPECT_EQ(std::vector<request_id_t>({request_id_t(2)}), windows.resumed);
+  EXPECT_EQ(1, windows.getQueued(LOG));
+}
+
+TEST(AppendWindowsTest, AdaptsToBackpressure) {
+  TestAppendWindows windows;
+  const size_t max_window = 8;
+  for (uint64_t i = 1; i <= 8; ++i) {
+    EXPECT_TRUE(windows.admit(LOG, request_id_t(i), max_window));
+  }
+  EXPECT_EQ(8, windows.getWindow(LOG));
+
+  // The whole window is rejected, but the window is only halved once.
+  for (int i = 0; i < 8; ++i) {
+    windows.onAppendDone(LOG, E::SEQNOBUFS, max_window);
+  }
+  EXPECT_EQ(4, windows.getWindow(LOG));
+
+  // Errors that aren't about load leave the window alone.
+  EXPECT_TRUE(windows.admit(LOG, request_id_t(9), max_window));
+  windows.onAppendDone(LOG, E::ACCESS, max_window);
+  EXPECT_EQ(4, windows.getWindow(LOG));
+
+  for (uint64_t i = 10; i <= 13; ++i) {
+    EXPECT_TRUE(windows.admit(LOG, request_id_t(i), max_window));
+  }
+  EXPECT_FALSE(windows.admit(LOG, request_id_t(14), max_window));
+
+  // A window's worth of successes grows the window by about one.
+  for (int i = 0; i < 4; ++i) {
+    windows.onAppendDone(LOG, E::OK, max_window);
+  }
+  EXPECT_GT(windows.getWindow(LOG), 4.9);
+  EXPECT_LT(windows.getWindow(LOG), 5);
+  windows.runResume();
+  EXPECT_EQ(
+      std::vector<request_id_t>({request_id_t(14)}), windows.resumed);
+
+  // Timeouts count as backpressure, and the window never goes below 1.
+  for (int i = 0; i < 10; ++i) {
+    windows.onAppendDone(LOG, E::TIMEDOUT, max_window);
+    EXPECT_TRUE(windows.admit(LOG, request_id_t(100 + i), max_window));
+  }
+  EXPECT_EQ(1, windows.getWindow(LOG));
+}
@@ -10,12 +10,16 @@
 
 #include <unordered_map>
 #include <variant>
+#include <zdict.h>
 
+#include <folly/Format.h>
 #include <folly/Overload.h>
 #include <folly/Varint.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include "logdevice/common/buffered_writer/ZstdDictionaryRegistry.h"
+
 namespace facebook { namespace logdevice {
 
 namespace {
@@ -264,6 +268,78 @@ INSTANTIATE_TEST_CASE_P(EncodeDecodeMatch,
                             std::vector<std::string>(100000, "p100000"),
                         }));
 
+TEST(BufferedWriteCodecTest, ZstdDictionary) {
+  auto make_doc = [](int i) {
+    return folly::sformat(
+        "{{\"user_id\":{},\"event\":\"{}\",\"page\":\"/home/{}\","
+        "\"ts\":{}}}",
+        i * 7919,
+        i % 3 ? "click" : "view",
+        i % 17,
+        1600000000 + i);
+  };
+
+  // Train a dictionary on samples similar to the payloads.
+  std::string samples;
+  std::vector<size_t> sample_sizes;
+  for (int i = 0; i < 2000; ++i) {
+    std::string doc = make_doc(i);
+    samples += doc;
+    sample_sizes.push_back(doc.size());
+  }
+  std::string dict(4096, '\0');
+  size_t dict_size = ZDICT_trainFromBuffer(&dict[0],
+                                           dict.size(),
+                                           samples.data(),
+                                           sample_sizes.data(),
+                                           sample_sizes.size());
+  ASSERT_FALSE(ZDICT_isError(dict_size));
+  dict.resize(dict_size);
+  const uint32_t dict_id = ZDICT_getDictID(dict.data(), dict.size());
+  ASSERT_NE(0, dict_id);
+
+  EXPECT_EQ(-1, ZstdDictionaryRegistry::registerDictionary("not a dict"));
+  ASSERT_EQ(0, ZstdDictionaryRegistry::registerDictionary(dict));
+
+  std::vector<std::string> payloads_in;
+  for (int i = 5000; i < 5020; ++i) {
+    payloads_in.push_back(make_doc(i));
+  }
+  const auto converted = convert(payloads_in);
+  const size_t capacity = estimate(converted).calculateSize(0);
+  auto encode_zstd = [&](uint32_t id) {
+    BufferedWriteCodec::Encoder<BufferedWriteSinglePayloadsCodec::Encoder>
+        encoder(0, converted.size(), capacity);
+    for (const auto& payload : converted) {
+      withPayload(payload, [&](auto&& p) { encoder.append(std::move(p)); });
+    }
+    folly::IOBufQueue queue;
+    encoder.encode(queue, Compression::ZSTD, 3, id);
+    return queue.moveAsValue();
+  };
+  folly::IOBuf plain = encode_zstd(0);
+  folly::IOBuf with_dict = encode_zstd(dict_id);
+  with_dict.coalesce();
+  EXPECT_LT(with_dict.computeChainDataLength(), plain.computeChainDataLength());
+
+  Compression compression;
+  ASSERT_TRUE(BufferedWriteCodec::decodeCompression(
+      Slice(with_dict.data(), with_dict.length()), &compression));
+  EXPECT_EQ(Compression::ZSTD, compression);
+
+  std::vector<folly::IOBuf> decoded;
+  size_t consumed =
+      BufferedWriteCodec::decode(Slice(with_dict.data(), with_dict.length()),
+                                 decoded,
+                                 /* allow_buffer_sharing */ true);
+  EXPECT_EQ(with_dict.length(), consumed);
+  std::vector<std::string> payloads_out;
+  for (auto& payload : decoded) {
+    payloads_out.push_back(payload.moveToFbString().toStdString());
+  }
+  EXPECT_EQ(payloads_in, payloads_out);
+}
+
 TEST(BufferedWriteEstimatorTest, FormatChange) {
   const folly::IOBuf payload1 =
       folly::IOBuf::wrapBufferAsValue(folly::StringPiece("payload1"));
@@ -335,6 +411,62 @@ TEST_P(BufferedWriteCodecTest, EncodeDecodeMatch) {
   }
 }
 
+TEST_P(BufferedWriteCodecTest, ColumnarDecodeMatch) {
+  const auto& [checksum_bits, payloads_in] = GetParam();
+
+  BufferedWriteCodec::Estimator estimator = estimate(payloads_in);
+  size_t size = estimator.calculateSize(checksum_bits);
+  folly::IOBuf encoded;
+  switch (estimator.getFormat()) {
+    case BufferedWriteCodec::Format::SINGLE_PAYLOADS:
+      encoded = encode<BufferedWriteSinglePayloadsCodec::Encoder>(
+          checksum_bits, size, payloads_in);
+      break;
+    case BufferedWriteCodec::Format::PAYLOAD_GROUPS:
+      encoded =
+          encode<PayloadGroupCodec::Encoder>(checksum_bits, size, payloads_in);
+      break;
+  }
+  encoded.coalesce();
+  encoded.trimStart(checksum_bits / 8);
+
+  std::vector<PayloadGroupCodec::DecodedColumn> columns;
+  size_t consumed =
+      BufferedWriteCodec::decode(Slice(encoded.data(), encoded.length()),
+                                 columns,
+                                 /* allow_buffer_sharing */ true);
+  EXPECT_EQ(consumed, encoded.length());
+
+  // Reassemble payload groups from the columns and compare with the input.
+  std::vector<PayloadGroup> payloads_out(payloads_in.size());
+  for (const auto& column : columns) {
+    ASSERT_EQ(column.ranges.size(), payloads_in.size());
+    for (int i = 0; i < column.ranges.size(); i++) {
+      const auto& range = column.ranges[i];
+      if (range.present) {
+        ASSERT_LE(range.offset + range.length, column.data.length());
+        payloads_out[i][column.key] = *folly::IOBuf::copyBuffer(
+            column.data.data() + range.offset, range.length);
+      } else {
+        EXPECT_EQ(range.length, 0);
+      }
+    }
+  }
+  for (int i = 0; i < payloads_in.size(); i++) {
+    std::visit(
+        folly::overload(
+            [&](const PayloadGroup& payload_group) {
+              EXPECT_THAT(payloads_out[i], PayloadGroupEq(payload_group));
+            },
+            [&](const std::string& payload) {
+              ASSERT_EQ(payloads_out[i].size(), 1);
+              EXPECT_EQ(payloads_out[i].at(0).moveToFbString().toStdString(),
+                        payload);
+            }),
+        payloads_in[i]);
+  }
+}
+
 namespace {
 folly::IOBuf iobuf_empty;
 folly::IOBuf iobuf_payload =
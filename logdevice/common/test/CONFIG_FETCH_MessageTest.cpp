@@ -15,11 +15,14 @@
 #include <gtest/gtest_prod.h>
 
 #include "logdevice/common/configuration/nodes/NodesConfigurationCodec.h"
+#include "logdevice/common/configuration/nodes/NodesConfigurationDiff.h"
+#include "logdevice/common/configuration/nodes/NodesConfigurationHistory.h"
 #include "logdevice/common/protocol/CONFIG_CHANGED_Message.h"
 #include "logdevice/common/protocol/Compatibility.h"
 #include "logdevice/common/protocol/FixedSizeMessage.h"
 #include "logdevice/common/protocol/ProtocolReader.h"
 #include "logdevice/common/protocol/ProtocolWriter.h"
+#include "logdevice/common/test/NodesConfigurationTestUtil.h"
 #include "logdevice/common/test/TestUtil.h"
 
 using namespace std::literals::chrono_literals;
@@ -89,6 +92,33 @@ TEST(CONFIG_FETCH_MessageTest, LegacySerializeAndDeserialize) {
   EXPECT_EQ(0, deserialized_msg->getHeader().my_version);
 }
 
+TEST(CONFIG_FETCH_MessageTest, FlagsSerialization) {
+  CONFIG_FETCH_Header header{
+      request_id_t(3),
+      CONFIG_FETCH_Header::ConfigType::NODES_CONFIGURATION,
+      10,
+      CONFIG_FETCH_Header::ACCEPT_NODES_CONFIGURATION_DIFF};
+  CONFIG_FETCH_Message msg{header};
+
+  for (uint16_t proto :
+       {Compatibility::ProtocolVersion::MULTI_AMEND_SUPPORT,
+        Compatibility::ProtocolVersion::NODES_CONFIGURATION_DIFFS}) {
+    std::string dest;
+    ProtocolWriter writer(&dest, "", proto);
+    msg.serialize(writer);
+    ASSERT_GT(writer.result(), 0);
+
+    auto deserialized_msg = tryRead<CONFIG_FETCH_Message>(dest, proto);
+    EXPECT_EQ(10, deserialized_msg->getHeader().my_version);
+    // Older protocols don't carry flags.
+    EXPECT_EQ(
+        proto >= Compatibility::ProtocolVersion::NODES_CONFIGURATION_DIFFS
+            ? CONFIG_FETCH_Header::ACCEPT_NODES_CONFIGURATION_DIFF
+            : 0,
+        deserialized_msg->getHeader().flags);
+  }
+}
+
 struct CONFIG_FETCH_MessageMock : public CONFIG_FETCH_Message {
   using CONFIG_FETCH_Message::CONFIG_FETCH_Message;
 
@@ -101,6 +131,11 @@ struct CONFIG_FETCH_MessageMock : public CONFIG_FETCH_Message {
     return nodes_config;
   }
 
+  configuration::nodes::NodesConfigurationHistory*
+  getNodesConfigurationHistory() override {
+    return history.get();
+  }
+
   int sendMessage(std::unique_ptr<CONFIG_CHANGED_Message> msg,
                   const Address& to) override {
     return sendMessage_(msg, to);
@@ -110,6 +145,7 @@ struct CONFIG_FETCH_MessageMock : public CONFIG_FETCH_Message {
                int(std::unique_ptr<CONFIG_CHANGED_Message>& msg, Address to));
 
   std::shared_ptr<const NodesConfiguration> nodes_config;
+  std::unique_ptr<configuration::nodes::NodesConfigurationHistory> history;
 };
 
 void compareChangedMessages(std::unique_ptr<CONFIG_CHANGED_Message>& expected,
@@ -202,3 +238,55 @@ TEST(CONFIG_FETCH_MessageTest, OnReceivedNodesConfigurationConditional) {
   EXPECT_EQ(CONFIG_FETCH_MessageMock::Disposition::NORMAL,
             msg.onReceived(Address(NodeID(1, 1))));
 }
+
+TEST(CONFIG_FETCH_MessageTest, OnReceivedNodesConfigurationDiff) {
+  using namespace configuration::nodes;
+  auto base = NodesConfigurationTestUtil::provisionNodes();
+  auto nodes_config = base->applyUpdate(
+      NodesConfigurationTestUtil::addNewNodeUpdate(*base, 17));
+  ASSERT_NE(nullptr, nodes_config);
+
+  CONFIG_FETCH_MessageMock msg{
+      CONFIG_FETCH_Header{
+          request_id_t(4),
+          CONFIG_FETCH_Header::ConfigType::NODES_CONFIGURATION,
+          base->getVersion().val(),
+          CONFIG_FETCH_Header::ACCEPT_NODES_CONFIGURATION_DIFF,
+      },
+  };
+  msg.nodes_config = nodes_config;
+  msg.history = std::make_unique<NodesConfigurationHistory>(4);
+  msg.history->add(base);
+
+  auto expected = std::make_unique<CONFIG_CHANGED_Message>(
+      CONFIG_CHANGED_Header{
+          Status::OK,
+          request_id_t(4),
+          static_cast<uint64_t>(nodes_config->getLastChangeTimestamp()
+                                    .time_since_epoch()
+                                    .count()),
+          nodes_config->getVersion(),
+          NodeID(2, 1),
+          CONFIG_CHANGED_Header::ConfigType::NODES_CONFIGURATION_DIFF,
+          CONFIG_CHANGED_Header::Action::CALLBACK},
+      "");
+
+  EXPECT_CALL(msg, sendMessage_(_, Address(NodeID(1, 1))))
+      .WillOnce(
+          Invoke([&](std::unique_ptr<CONFIG_CHANGED_Message>& got, Address) {
+            compareChangedMessages(expected, got, false);
+            auto full = NodesConfigurationDiff::apply(
+                NodesConfigurationDiff::serializeForDiff(*base),
+                got->getConfigStr());
+            EXPECT_TRUE(full.hasValue());
+            if (full.hasValue()) {
+              auto deserialized = NodesConfigurationCodec::deserialize(*full);
+              EXPECT_NE(nullptr, deserialized);
+              EXPECT_EQ(*nodes_config, *deserialized);
+            }
+            return 0;
+          }));
+
+  EXPECT_EQ(CONFIG_FETCH_MessageMock::Disposition::NORMAL,
+            msg.onReceived(Address(NodeID(1, 1))));
+}
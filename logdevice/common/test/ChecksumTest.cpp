@@ -8,6 +8,8 @@
 #include "logdevice/common/Checksum.h"
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <folly/ScopeGuard.h>
 #include <gtest/gtest.h>
@@ -199,4 +201,78 @@ TEST_F(ChecksumTest, RoundTripNoChecksumFlagsZeroed) {
   ASSERT_EQ(-1, verifyChecksum(*recv));
 }
 
+// Batched checksums must match the one-at-a-time ones for all sizes,
+// including the ones that don't fill the SIMD lanes evenly.
+TEST_F(ChecksumTest, Batch) {
+  std::vector<std::string> blobs;
+  for (size_t size = 0; size < 70; ++size) {
+    blobs.push_back(std::string(size, static_cast<char>('a' + size % 26)));
+  }
+  blobs.push_back(std::string(10000, 'x'));
+  blobs.push_back("123456789");
+
+  std::vector<Slice> slices;
+  for (const std::string& b : blobs) {
+    slices.push_back(Slice::fromString(b));
+  }
+  // Use every suffix of the list so that a record lands in every lane.
+  for (size_t start = 0; start < 4; ++start) {
+    const size_t n = slices.size() - start;
+    std::vector<uint32_t> out32(n);
+    std::vector<uint64_t> out64(n);
+    checksum_32bit_batch(slices.data() + start, n, out32.data());
+    checksum_64bit_batch(slices.data() + start, n, out64.data());
+    for (size_t i = 0; i < n; ++i) {
+      EXPECT_EQ(checksum_32bit(slices[start + i]), out32[i]);
+      EXPECT_EQ(checksum_64bit(slices[start + i]), out64[i]);
+    }
+  }
+}
+
+// Hashing an IOBuf chain in place must give the same result as hashing the
+// coalesced data, wherever the chain is split.
+TEST_F(ChecksumTest, Chain64) {
+  std::string data;
+  for (size_t i = 0; i < 1000; ++i) {
+    data += static_cast<char>('a' + i % 26);
+  }
+  for (size_t split : {0, 1, 100, 191, 192, 193, 500, 999, 1000}) {
+    auto chain = folly::IOBuf::copyBuffer(data.data(), split);
+    chain->prependChain(
+        folly::IOBuf::copyBuffer(data.data() + split, data.size() - split));
+    EXPECT_EQ(checksum_64bit(Slice::fromString(data)), checksum_64bit(*chain))
+        << split;
+  }
+  EXPECT_EQ(checksum_64bit(Slice("", 0)), checksum_64bit(folly::IOBuf()));
+}
+
+// A checksum precomputed by AppendRequest must serialize to the same bytes as
+// one computed in APPEND_Message::serialize().
+TEST_F(ChecksumTest, PrecomputedAppendChecksum) {
+  for (APPEND_flags_t flags : {FLAGS_32, FLAGS_64}) {
+    const int bits = (flags & APPEND_Header::CHECKSUM_64BIT) ? 64 : 32;
+    auto serialize = [&](bool precompute) {
+      APPEND_Header hdr = {
+          request_id_t(1), logid_t(1), EPOCH_INVALID, 0, flags};
+      APPEND_Message msg(hdr,
+                         LSN_INVALID,
+                         AppendAttributes(),
+                         PayloadHolder::copyString("123456789"));
+      if (precompute) {
+        const Slice payload("123456789", 9);
+        msg.setPayloadChecksum(bits,
+                               bits == 64 ? checksum_64bit(payload)
+                                          : checksum_32bit(payload));
+      }
+      auto buffer = folly::IOBuf::create(IOBUF_ALLOCATION_UNIT);
+      ProtocolWriter writer(
+          msg.type_, buffer.get(), Compatibility::MAX_PROTOCOL_SUPPORTED);
+      msg.serialize(writer);
+      EXPECT_GT(writer.result(), 0);
+      return buffer->coalesce().str();
+    };
+    EXPECT_EQ(serialize(false), serialize(true)) << bits;
+  }
+}
+
 }} // namespace facebook::logdevice
@@ -14,6 +14,7 @@
 #include "logdevice/common/Timer.h"
 #include "logdevice/common/client_read_stream/ClientReadStream.h"
 #include "logdevice/common/client_read_stream/ClientReadStreamBufferFactory.h"
+#include "logdevice/common/client_read_stream/ClientReadStreamChunkedBuffer.h"
 #include "logdevice/common/client_read_stream/ClientReadStreamCircularBuffer.h"
 #include "logdevice/common/client_read_stream/ClientReadStreamOrderedMapBuffer.h"
 #include "logdevice/include/types.h"
@@ -39,11 +40,7 @@ class ClientReadStreamBufferTest
     : public ::testing::TestWithParam<ClientReadStreamBufferType> {
  public:
   void SetUp() override {
-    if (GetParam() == ClientReadStreamBufferType::CIRCULAR) {
-      buf = std::make_unique<ClientReadStreamCircularBuffer>(10, 100);
-    } else {
-      buf = std::make_unique<ClientReadStreamOrderedMapBuffer>(10, 100);
-    }
+    buf = ClientReadStreamBufferFactory::create(GetParam(), 10, 100);
   }
   std::unique_ptr<ClientReadStreamBuffer> buf;
 };
@@ -59,8 +56,8 @@ TEST_P(ClientReadStreamBufferTest, ForEachForward) {
 }
 
 TEST_P(ClientReadStreamBufferTest, ForEachWithHoles) {
-  // holes are only supported in ordered map
-  if (GetParam() != ClientReadStreamBufferType::ORDERED_MAP) {
+  // holes are only supported in sparse buffers
+  if (GetParam() == ClientReadStreamBufferType::CIRCULAR) {
     return;
   }
   auto reset_buffer = [&]() {
@@ -122,9 +119,9 @@ TEST_P(ClientReadStreamBufferTest, ForEachBackward2) {
 TEST_P(ClientReadStreamBufferTest, ForEachForwardEmpty) {
   Collector collector;
   buf->forEach(100, 102, std::ref(collector));
-  if (GetParam() == ClientReadStreamBufferType::ORDERED_MAP) {
-    // Ordered map only returns actual entries
-    // but since the map is empty, it should not return anything
+  if (GetParam() != ClientReadStreamBufferType::CIRCULAR) {
+    // Sparse buffers only return actual entries
+    // but since the buffer is empty, it should not return anything
     ASSERT_COLLECTED(collector);
   } else {
     ASSERT_COLLECTED(collector, 100, 101, 102);
@@ -135,9 +132,9 @@ TEST_P(ClientReadStreamBufferTest, ForEachForwardEmpty) {
 TEST_P(ClientReadStreamBufferTest, ForEachBackwardEmpty) {
   Collector collector;
   buf->forEach(102, 100, std::ref(collector));
-  if (GetParam() == ClientReadStreamBufferType::ORDERED_MAP) {
-    // Ordered map only returns actual entries
-    // but since the map is empty, it should not return anything
+  if (GetParam() != ClientReadStreamBufferType::CIRCULAR) {
+    // Sparse buffers only return actual entries
+    // but since the buffer is empty, it should not return anything
     ASSERT_COLLECTED(collector);
   } else {
     ASSERT_COLLECTED(collector, 102, 101, 100);
@@ -145,10 +142,75 @@ TEST_P(ClientReadStreamBufferTest, ForEachBackwardEmpty) {
   ASSERT_TRUE(true);
 }
 
+TEST_P(ClientReadStreamBufferTest, FindFirstMarker) {
+  buf = ClientReadStreamBufferFactory::create(GetParam(), 1000, 100);
+  ASSERT_EQ(nullptr, buf->findFirstMarker().first);
+
+  buf->createOrGet(lsn_t{900})->gap = true;
+  auto marker = buf->findFirstMarker();
+  ASSERT_NE(nullptr, marker.first);
+  EXPECT_EQ(lsn_t{900}, marker.second);
+
+  buf->createOrGet(lsn_t{1099})->gap = true;
+  buf->createOrGet(lsn_t{163})->gap = true;
+  EXPECT_EQ(lsn_t{163}, buf->findFirstMarker().second);
+  EXPECT_EQ(nullptr, buf->createOrGet(lsn_t{1100}));
+
+  Collector collector;
+  buf->forEach(1099, 150, std::ref(collector));
+  if (GetParam() != ClientReadStreamBufferType::CIRCULAR) {
+    ASSERT_COLLECTED(collector, 1099, 900, 163);
+  }
+  collector.collected.clear();
+
+  // Clear the markers and move past them.
+  buf->forEachUpto(1099, [](lsn_t, ClientReadStreamRecordState& state) {
+    state.gap = false;
+  });
+  buf->advanceBufferHead(1000);
+  EXPECT_EQ(nullptr, buf->findFirstMarker().first);
+  buf->createOrGet(lsn_t{1100})->gap = true;
+  EXPECT_EQ(lsn_t{1100}, buf->findFirstMarker().second);
+  EXPECT_EQ(buf->front(), buf->findFirstMarker().first);
+}
+
+TEST(ClientReadStreamChunkedBufferTest, ReleasesEmptyChunks) {
+  ClientReadStreamChunkedBuffer buf(1000, 100);
+  buf.createOrGet(lsn_t{100})->gap = true;
+  buf.createOrGet(lsn_t{101})->gap = true;
+  buf.createOrGet(lsn_t{600});
+  EXPECT_EQ(2, buf.numChunks());
+
+  buf.front()->gap = false;
+  buf.popFront();
+  buf.advanceBufferHead();
+  EXPECT_EQ(2, buf.numChunks());
+  buf.front()->gap = false;
+  buf.popFront();
+  EXPECT_EQ(1, buf.numChunks());
+
+  // Placeholders are skipped, and released once visited by forEach().
+  EXPECT_EQ(nullptr, buf.findFirstMarker().first);
+  buf.forEach(600, 600, [](lsn_t, ClientReadStreamRecordState&) {
+    return true;
+  });
+  EXPECT_EQ(0, buf.numChunks());
+
+  // LSNs map to the slot of the released chunk in the index once the head
+  // moves past it.
+  buf.advanceBufferHead(1000);
+  buf.createOrGet(lsn_t{1200});
+  buf.createOrGet(lsn_t{1674})->gap = true;
+  EXPECT_EQ(lsn_t{1674}, buf.findFirstMarker().second);
+  buf.clear();
+  EXPECT_EQ(0, buf.numChunks());
+}
+
 INSTANTIATE_TEST_CASE_P(
     ClientReadStreamBufferTest,
     ClientReadStreamBufferTest,
     ::testing::Values(ClientReadStreamBufferType::CIRCULAR,
-                      ClientReadStreamBufferType::ORDERED_MAP));
+                      ClientReadStreamBufferType::ORDERED_MAP,
+                      ClientReadStreamBufferType::CHUNKED));
 
 }} // namespace facebook::logdevice
@@ -345,4 +345,40 @@ TEST_F(ClientReadStreamFailureDetectorTest, Scenario1) {
   ASSERT_TRUE(detector->getCurrentOutliers().empty());
 }
 
+// With speculative detection, N0 is declared an outlier as soon as it is
+// slower than the p90 latency of the other shards, well before the outlier
+// detection algorithm would be confident about it.
+TEST_F(ClientReadStreamFailureDetectorTest, Speculative) {
+  ClientReadStreamFailureDetectorSettings speculative_settings;
+  speculative_settings.moving_avg_duration = std::chrono::seconds{10};
+  speculative_settings.required_margin = 1.0;
+  speculative_settings.required_margin_decrease_rate = 0.25;
+  speculative_settings.outlier_duration =
+      chrono_expbackoff_t<std::chrono::seconds>(1min, 1min, 2.0);
+  speculative_settings.outlier_duration_decrease_rate = 1.0;
+  speculative_settings.speculative_percentile = 90;
+  detector->setSettings(speculative_settings);
+
+  // All shards complete the first window in 20ms.
+  onWindowSlid(lsn_t(100));
+  advanceTime(20ms);
+  onShardsNextLsnChanged(lsn_t(101),
+                         N0, N1, N2, N3, N4, N5, N6, N7,
+                         N8, N9, N10, N11, N12, N13, N14, N15);
+  ASSERT_FALSE(timerIsActive());
+
+  // All shards but N0 complete the second window in 15ms. The p90 latency is
+  // 20ms, so N0 becomes an outlier 5ms later.
+  onWindowSlid(lsn_t(200));
+  advanceTime(15ms);
+  onShardsNextLsnChanged(lsn_t(201),
+                         N1, N2, N3, N4, N5, N6, N7,
+                         N8, N9, N10, N11, N12, N13, N14, N15);
+  ASSERT_TRUE(detector->getCurrentOutliers().empty());
+  ASSERT_TRUE(timerIsActive());
+  advanceTime(5ms);
+  triggerTimer();
+  ASSERT_EQ(ShardSet({N0}), detector->getCurrentOutliers());
+}
+
 }} // namespace facebook::logdevice
@@ -8,6 +8,7 @@
 #include "logdevice/common/client_read_stream/ClientReadStream.h"
 
 #include <functional>
+#include <limits>
 #include <map>
 #include <memory>
 #include <unordered_map>
@@ -179,6 +180,13 @@ struct TestState {
   bool callbacks_accepting = true;
   bool disposed = false;
 
+  // If set, the read stream delivers records and gaps in batches. Batch
+  // callbacks consume at most `batch_entries_accepted' entries.
+  bool read_in_batches = false;
+  size_t batch_entries_accepted = std::numeric_limits<size_t>::max();
+  // Sizes of batches passed to the batch callback
+  std::vector<size_t> batches;
+
   // default metadata to be delivered when epoch metadata is requested
   EpochMetaData default_metadata;
   // If set, deps_->getMetaDataForEpoch() will be a no-op and tests are
@@ -321,6 +329,28 @@ class MockClientReadStreamDependencies : public ClientReadStreamDependencies {
     return state_.callbacks_accepting;
   }
 
+  bool hasRecordBatchCallback() const override {
+    return state_.read_in_batches;
+  }
+
+  size_t recordBatchCallback(std::vector<RecordBatchEntry>& batch) override {
+    state_.batches.push_back(batch.size());
+    if (!state_.callbacks_accepting) {
+      return 0;
+    }
+    size_t consumed = std::min(batch.size(), state_.batch_entries_accepted);
+    for (size_t i = 0; i < consumed; ++i) {
+      const RecordBatchEntry& entry = batch[i];
+      if (entry.isGap()) {
+        state_.gap.push_back(
+            GapMessage{entry.gap.type, entry.gap.lo, entry.gap.hi});
+      } else {
+        state_.recv.push_back(entry.record->attrs.lsn);
+      }
+    }
+    return consumed;
+  }
+
   void healthCallback(bool is_healthy) override {
     state_.connection_healthy = is_healthy;
   }
@@ -346,8 +376,8 @@ class MockClientReadStreamDependencies : public ClientReadStreamDependencies {
   }
 
   std::unique_ptr<Timer>
-  createTimer(std::function<void()> /*cb*/ = nullptr) override {
-    return std::make_unique<MockTimer>();
+  createTimer(std::function<void()> cb = nullptr) override {
+    return std::make_unique<MockTimer>(std::move(cb));
   }
 
   void setClientReadStream(ClientReadStream* client_read_stream) {
@@ -608,6 +638,9 @@ class ClientReadStreamTest
   BackoffTimer* getRedeliveryTimer() const {
     return read_stream_->redelivery_timer_.get();
   }
+  MockTimer* getRecordBatchTimer() const {
+    return dynamic_cast<MockTimer*>(read_stream_->record_batch_timer_.get());
+  }
   BackoffTimer* getReattemptStartTimer() const {
     return read_stream_->reattempt_start_timer_.get();
   }
@@ -907,7 +940,8 @@ INSTANTIATE_TEST_CASE_P(
     ClientReadStreamTest,
     ClientReadStreamTest,
     ::testing::Values(ClientReadStreamBufferType::CIRCULAR,
-                      ClientReadStreamBufferType::ORDERED_MAP));
+                      ClientReadStreamBufferType::ORDERED_MAP,
+                      ClientReadStreamBufferType::CHUNKED));
 
 /**
  * Simple test where records come in order from different nodes.
@@ -924,6 +958,40 @@ TEST_P(ClientReadStreamTest, Simple) {
   ASSERT_RECV(lsn(1, 4));
 }
 
+/**
+ * Records are delivered in batches once the event loop gets to the batch
+ * timer. A batch that isn't fully consumed blocks delivery until it is
+ * redelivered, and the last record is only delivered after the batch.
+ */
+TEST_P(ClientReadStreamTest, RecordBatches) {
+  state_.read_in_batches = true;
+  until_lsn_ = lsn(1, 5);
+  start();
+  onDataRecord(N0, mockRecord(lsn(1, 1)));
+  onDataRecord(N1, mockRecord(lsn(1, 2)));
+  ASSERT_RECV();
+  ASSERT_TRUE(getRecordBatchTimer()->isActive());
+  getRecordBatchTimer()->trigger();
+  ASSERT_RECV(lsn(1, 1), lsn(1, 2));
+
+  state_.batch_entries_accepted = 1;
+  onDataRecord(N0, mockRecord(lsn(1, 3)));
+  onDataRecord(N0, mockRecord(lsn(1, 4)));
+  getRecordBatchTimer()->trigger();
+  ASSERT_RECV(lsn(1, 3));
+  ASSERT_TRUE(getRedeliveryTimer()->isActive());
+
+  onDataRecord(N1, mockRecord(lsn(1, 5)));
+  ASSERT_RECV();
+  ASSERT_FALSE(state_.disposed);
+
+  state_.batch_entries_accepted = std::numeric_limits<size_t>::max();
+  dynamic_cast<MockBackoffTimer*>(getRedeliveryTimer())->trigger();
+  ASSERT_RECV(lsn(1, 4), lsn(1, 5));
+  EXPECT_EQ(std::vector<size_t>({2, 2, 1}), state_.batches);
+  ASSERT_TRUE(state_.disposed);
+}
+
 /**
  * Buffering and delivering records that are received out of order.
  */
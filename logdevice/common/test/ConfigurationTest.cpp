@@ -22,6 +22,7 @@
 #include "logdevice/common/Semaphore.h"
 #include "logdevice/common/configuration/LocalLogsConfig.h"
 #include "logdevice/common/configuration/ParsingHelpers.h"
+#include "logdevice/common/configuration/UpdateableConfig.h"
 #include "logdevice/common/configuration/logs/LogsConfigTree.h"
 #include "logdevice/common/configuration/nodes/utils.h"
 #include "logdevice/common/debug.h"
@@ -1754,3 +1755,25 @@ TEST(ConfigurationTest, StorageCapacityVsWeight) {
     ASSERT_EQ(config, nullptr);
   }
 }
+
+TEST(ConfigurationTest, UpdateableConfigVersion) {
+  auto updateable_config = UpdateableConfig::createEmpty();
+  const uint64_t v0 = updateable_config->getVersion();
+  auto config = updateable_config->get();
+  ASSERT_NE(nullptr, config);
+
+  updateable_config->updateableServerConfig()->update(
+      ServerConfig::createEmpty());
+  const uint64_t v1 = updateable_config->getVersion();
+  EXPECT_GT(v1, v0);
+  EXPECT_NE(config->serverConfig(), updateable_config->get()->serverConfig());
+
+  updateable_config->updateableNodesConfiguration()->update(
+      std::make_shared<nodes::NodesConfiguration>());
+  EXPECT_GT(updateable_config->getVersion(), v1);
+
+  // reading doesn't change the version
+  const uint64_t v2 = updateable_config->getVersion();
+  updateable_config->get();
+  EXPECT_EQ(v2, updateable_config->getVersion());
+}
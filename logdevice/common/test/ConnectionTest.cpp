@@ -247,6 +247,110 @@ TEST_F(ClientConnectionTest, SerializationStages) {
   CHECK_SERIALIZEQ();
 }
 
+// Small messages batched for the same write are coalesced into one buffer.
+TEST_F(ClientConnectionTest, CoalesceSmallMessages) {
+  std::unique_ptr<folly::IOBuf> write_buf;
+  ON_CALL(*sock_, connect_(_, _, _, _, _))
+      .WillByDefault(SaveArg<0>(&conn_callback_));
+  ON_CALL(*sock_, writeChain_(_, _, _))
+      .WillByDefault(
+          Invoke([this, &write_buf](folly::AsyncSocket::WriteCallback* cb,
+                                    folly::IOBuf* buf,
+                                    folly::WriteFlags) {
+            wr_callback_ = cb;
+            write_buf.reset(buf);
+          }));
+  ON_CALL(*sock_, setReadCB(_)).WillByDefault(SaveArg<0>(&rd_callback_));
+  EXPECT_EQ(conn_->connect(), 0);
+  conn_callback_->connectSuccess();
+  ev_base_folly_.loopOnce();
+  writeSuccess();
+  CHECK_ON_SENT(MessageType::HELLO, E::OK);
+  receiveAckMessage();
+  EXPECT_TRUE(handshaken());
+
+  for (int i = 0; i < 2; ++i) {
+    auto envelope = create_message(*conn_);
+    ASSERT_NE(envelope, nullptr);
+    conn_->releaseMessage(*envelope);
+  }
+  ev_base_folly_.loopOnce();
+  ASSERT_NE(write_buf, nullptr);
+  EXPECT_EQ(1, write_buf->countChainElements());
+  writeSuccess();
+  CHECK_ON_SENT(MessageType::GET_SEQ_STATE, E::OK);
+  CHECK_ON_SENT(MessageType::GET_SEQ_STATE, E::OK);
+  CHECK_NO_MESSAGE_SENT();
+}
+
+// Once the socket has socket_write_chunk_size bytes buffered, messages are
+// held back and then serialized highest priority first. Priority::MAX
+// messages are never held back.
+TEST_F(ClientConnectionTest, DeferLowPriorityMessages) {
+  settings_.socket_write_chunk_size = 100;
+  std::unique_ptr<folly::IOBuf> write_buf;
+  ON_CALL(*sock_, connect_(_, _, _, _, _))
+      .WillByDefault(SaveArg<0>(&conn_callback_));
+  ON_CALL(*sock_, writeChain_(_, _, _))
+      .WillByDefault(
+          Invoke([this, &write_buf](folly::AsyncSocket::WriteCallback* cb,
+                                    folly::IOBuf* buf,
+                                    folly::WriteFlags) {
+            wr_callback_ = cb;
+            write_buf.reset(buf);
+          }));
+  ON_CALL(*sock_, setReadCB(_)).WillByDefault(SaveArg<0>(&rd_callback_));
+  EXPECT_EQ(conn_->connect(), 0);
+  conn_callback_->connectSuccess();
+  ev_base_folly_.loopOnce();
+  writeSuccess();
+  CHECK_ON_SENT(MessageType::HELLO, E::OK);
+  receiveAckMessage();
+  EXPECT_TRUE(handshaken());
+
+  auto send = [&](size_t size, TrafficClass tc) {
+    std::unique_ptr<facebook::logdevice::Message> msg(
+        new VarLengthTestMessage(1 /* min_proto */, size, tc));
+    size_t len = msg->size(conn_->getProto());
+    auto envelope = conn_->registerMessage(std::move(msg));
+    EXPECT_NE(envelope, nullptr);
+    conn_->releaseMessage(*envelope);
+    return len;
+  };
+
+  size_t rebuild_len = send(200, TrafficClass::REBUILD);
+  // The socket now has more than a chunk buffered.
+  size_t backlog_len = send(150, TrafficClass::READ_BACKLOG);
+  size_t append_len = send(150, TrafficClass::APPEND);
+  // RECOVERY maps to Priority::MAX.
+  size_t recovery_len = send(10, TrafficClass::RECOVERY);
+  ev_base_folly_.loopOnce();
+  ASSERT_NE(write_buf, nullptr);
+  EXPECT_EQ(rebuild_len + recovery_len, write_buf->computeChainDataLength());
+  CHECK_ON_SENT(MessageType::TEST, E::OK);
+  CHECK_ON_SENT(MessageType::TEST, E::OK);
+  CHECK_NO_MESSAGE_SENT();
+  // Deferred messages still count towards the bytes pending.
+  EXPECT_EQ(rebuild_len + recovery_len + backlog_len + append_len,
+            conn_->getBytesPending());
+
+  // The append goes out first even though it was sent after the backlog
+  // message, and it puts the socket back over the chunk size.
+  writeSuccess();
+  ev_base_folly_.loopOnce();
+  EXPECT_EQ(append_len, write_buf->computeChainDataLength());
+  CHECK_ON_SENT(MessageType::TEST, E::OK);
+  CHECK_NO_MESSAGE_SENT();
+
+  writeSuccess();
+  ev_base_folly_.loopOnce();
+  EXPECT_EQ(backlog_len, write_buf->computeChainDataLength());
+  CHECK_ON_SENT(MessageType::TEST, E::OK);
+  writeSuccess();
+  CHECK_NO_MESSAGE_SENT();
+  EXPECT_EQ(0, conn_->getBytesPending());
+}
+
 // Verify that handshake works for a server Socket.
 TEST_F(ServerConnectionTest, Handshake) {
   // Simulate HELLO to be received by the server.
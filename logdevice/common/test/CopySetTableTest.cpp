@@ -0,0 +1,165 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/CopySetTable.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "logdevice/common/CopySet.h"
+#include "logdevice/common/test/CopySetSelectorTestUtil.h"
+#include "logdevice/common/test/NodeSetStateTest.h"
+
+using namespace facebook::logdevice;
+
+namespace {
+
+// Picks {N0, N1}, {N1, N2}, {N2, N3}, {N3, N0}, ... plus `extras` more shards.
+class RotatingCopySetSelector : public CopySetSelector {
+ public:
+  Result select(copyset_size_t extras,
+                StoreChainLink copyset_out[],
+                copyset_size_t* copyset_size_out,
+                bool* /* chain_out */,
+                State* /* selector_state */,
+                RNG& /* rng */,
+                bool /* retry */) const override {
+    const size_t first = calls_++;
+    *copyset_size_out = getReplicationFactor() + extras;
+    for (size_t i = 0; i < *copyset_size_out; ++i) {
+      copyset_out[i] = StoreChainLink{
+          ShardID(node_index_t((first + i) % 4), 0), ClientID::MIN};
+    }
+    return Result::SUCCESS;
+  }
+
+  Result augment(ShardID[],
+                 copyset_size_t,
+                 copyset_size_t*,
+                 RNG&,
+                 bool) const override {
+    return Result::FAILED;
+  }
+
+  Result augment(StoreChainLink[],
+                 copyset_size_t,
+                 copyset_size_t*,
+                 bool,
+                 bool*,
+                 RNG&,
+                 bool) const override {
+    return Result::FAILED;
+  }
+
+  copyset_size_t getReplicationFactor() const override {
+    return 2;
+  }
+
+  mutable size_t calls_ = 0;
+};
+
+class TestCopySetTable : public CopySetTable {
+ public:
+  using CopySetTable::CopySetTable;
+
+  std::chrono::steady_clock::time_point now() const override {
+    return now_;
+  }
+
+  std::chrono::steady_clock::time_point now_{std::chrono::seconds(100)};
+};
+
+class CopySetTableTest : public NodeSetStateTest {
+ public:
+  // Takes a copyset from the table.
+  folly::Optional<std::vector<ShardID>> select(copyset_size_t extras = 0) {
+    StoreChainLink copyset[COPYSET_SIZE_MAX];
+    copyset_size_t size;
+    bool chain = true;
+    if (!table_.select(
+            selector_, nodeset_state_, extras, copyset, &size, &chain)) {
+      return folly::none;
+    }
+    std::vector<ShardID> res;
+    for (copyset_size_t i = 0; i < size; ++i) {
+      res.push_back(copyset[i].destination);
+    }
+    return res;
+  }
+
+  TestCopySetSelectorDeps deps_;
+  RotatingCopySetSelector selector_;
+  MyNodeSetState nodeset_state_{storage_set_,
+                                LOG_ID,
+                                NodeSetState::HealthCheck::DISABLED};
+  TestCopySetTable table_{4, &deps_};
+};
+
+} // namespace
+
+TEST_F(CopySetTableTest, BuiltForBusyLogs) {
+  // The caller uses the selector until the log picked as many copysets as the
+  // table holds.
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_FALSE(select().hasValue());
+  }
+  EXPECT_EQ(0, table_.numCopySets());
+  EXPECT_EQ(0, selector_.calls_);
+
+  auto copyset = select();
+  ASSERT_TRUE(copyset.hasValue());
+  EXPECT_EQ(4, table_.numCopySets());
+  EXPECT_EQ(4, selector_.calls_);
+  EXPECT_EQ(std::vector<ShardID>({N0, N1}), copyset.value());
+
+  // Entries are used in rotation without asking the selector.
+  EXPECT_EQ(std::vector<ShardID>({N1, N2}), select().value());
+  EXPECT_EQ(std::vector<ShardID>({N2, N3}), select().value());
+  EXPECT_EQ(std::vector<ShardID>({N3, N0}), select().value());
+  EXPECT_EQ(std::vector<ShardID>({N0, N1}), select().value());
+  EXPECT_EQ(4, selector_.calls_);
+}
+
+TEST_F(CopySetTableTest, SkipsUnavailableEntries) {
+  for (int i = 0; i < 4; ++i) {
+    select();
+  }
+  deps_.setNotAvailableNodes({N2});
+  EXPECT_TRUE(select().hasValue());   // {N0, N1}
+  EXPECT_FALSE(select().hasValue());  // {N1, N2}
+  EXPECT_FALSE(select().hasValue());  // {N2, N3}
+  EXPECT_TRUE(select().hasValue());   // {N3, N0}
+  EXPECT_EQ(4, selector_.calls_);
+}
+
+TEST_F(CopySetTableTest, Rebuilds) {
+  for (int i = 0; i < 5; ++i) {
+    select();
+  }
+  ASSERT_EQ(4, selector_.calls_);
+
+  // A shard became unavailable. The table is rebuilt, but not right away.
+  ASSERT_TRUE(nodeset_state_.setNotAvailableUntil(
+      N3,
+      std::chrono::steady_clock::now() + std::chrono::seconds(10),
+      NodeSetState::NotAvailableReason::OVERLOADED));
+  table_.now_ += std::chrono::milliseconds(500);
+  select();
+  EXPECT_EQ(4, selector_.calls_);
+  table_.now_ += std::chrono::milliseconds(500);
+  select();
+  EXPECT_EQ(8, selector_.calls_);
+  select();
+  EXPECT_EQ(8, selector_.calls_);
+
+  // A change in the number of extras rebuilds the table immediately.
+  auto copyset = select(1);
+  EXPECT_EQ(12, selector_.calls_);
+  ASSERT_TRUE(copyset.hasValue());
+  EXPECT_EQ(3, copyset->size());
+}
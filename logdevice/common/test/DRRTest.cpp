@@ -6,6 +6,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <memory>
@@ -455,3 +456,43 @@ TEST_F(DRRIntegrationTest, ByteBasedSmallQuantaVariableSize) {
   while ((task = params.q->dequeue()))
     ;
 }
+
+// Tasks are dequeued at a cost of 1 and charged their measured cost
+// afterwards. A principal whose tasks cost 10 times as much should get 10
+// times fewer of them through.
+TEST_F(DRRIntegrationTest, ChargeMeasuredCost) {
+  const uint64_t quanta = 10;
+  const std::array<uint64_t, 2> cost{{10, 1}};
+  std::vector<DRRPrincipal> shares;
+  for (int i = 0; i < 2; i++) {
+    DRRPrincipal principal;
+    principal.name = "DRR-principalt-" + std::to_string(i);
+    principal.share = 1;
+    shares.push_back(principal);
+  }
+
+  DRRScheduler<TestTask, &TestTask::schedulerQHook_> ioq;
+  ioq.initShares("unit-test-q", quanta, shares);
+
+  std::vector<std::unique_ptr<TestTask>> tasks;
+  for (int i = 0; i < 2; i++) {
+    tasks.push_back(std::make_unique<TestTask>(1));
+    tasks.back()->principal_ = i;
+    ioq.enqueue(tasks.back().get(), i);
+  }
+
+  std::array<uint64_t, 2> dequeued{{0, 0}};
+  for (int i = 0; i < 1100; i++) {
+    TestTask* task = ioq.dequeue();
+    ASSERT_NE(nullptr, task);
+    const int principal = task->principal_;
+    dequeued[principal]++;
+    ioq.chargeCost(task->reqSize(), cost[principal], principal);
+    ioq.enqueue(task, principal);
+  }
+  EXPECT_EQ(100, dequeued[0]);
+  EXPECT_EQ(1000, dequeued[1]);
+
+  while (ioq.dequeue())
+    ;
+}
@@ -48,11 +48,12 @@ class EpochMetaDataCacheTest : public ::testing::Test {
 
   static constexpr logid_t LOG_ID{233};
   size_t capacity_ = 1024;
+  std::chrono::milliseconds soft_ttl_ = std::chrono::milliseconds::max();
   std::unique_ptr<EpochMetaDataCache> cache_;
   Result result_;
 
   void setUp() {
-    cache_ = std::make_unique<EpochMetaDataCache>(capacity_);
+    cache_ = std::make_unique<EpochMetaDataCache>(capacity_, soft_ttl_);
   }
 
   bool get(epoch_t epoch, bool require_consistent) {
@@ -155,6 +156,87 @@ TEST_F(EpochMetaDataCacheTest, Overwrite) {
   ASSERT_EQ(expected, result_);
 }
 
-// TODO: add test(s) for eviction
+TEST_F(EpochMetaDataCacheTest, RangedLookup) {
+  setUp();
+  cache_->setMetaData(LOG_ID,
+                      epoch_t(5),
+                      epoch_t(10),
+                      RecordSource::CACHED_CONSISTENT,
+                      genEpochMetaData(epoch_t(3)));
+  cache_->setMetaData(LOG_ID,
+                      epoch_t(20),
+                      epoch_t(30),
+                      RecordSource::CACHED_SOFT,
+                      genEpochMetaData(epoch_t(20)));
+  Result expected{epoch_t(10),
+                  RecordSource::CACHED_CONSISTENT,
+                  genEpochMetaData(epoch_t(3))};
+  // any epoch in the range of a consistent entry is a hit
+  for (epoch_t::raw_type e = 5; e <= 10; ++e) {
+    ASSERT_TRUE(get(epoch_t(e), true));
+    ASSERT_EQ(expected, result_);
+    ASSERT_TRUE(getNoPromotion(epoch_t(e), false));
+    ASSERT_EQ(expected, result_);
+  }
+  ASSERT_FALSE(get(epoch_t(4), false));
+  ASSERT_FALSE(get(epoch_t(11), false));
+  // soft entries only answer lookups of their own epoch
+  ASSERT_TRUE(get(epoch_t(20), false));
+  ASSERT_FALSE(get(epoch_t(21), false));
+  // a consistent entry of another log doesn't count
+  cache_->setMetaData(logid_t(LOG_ID.val_ + 1),
+                      epoch_t(1),
+                      epoch_t(100),
+                      RecordSource::CACHED_CONSISTENT,
+                      genEpochMetaData(epoch_t(1)));
+  ASSERT_FALSE(get(epoch_t(50), false));
+}
+
+TEST_F(EpochMetaDataCacheTest, SoftEntryExpiration) {
+  soft_ttl_ = std::chrono::milliseconds(0);
+  setUp();
+  cache_->setMetaData(LOG_ID,
+                      epoch_t(1),
+                      epoch_t(10),
+                      RecordSource::CACHED_SOFT,
+                      genEpochMetaData(epoch_t(1)));
+  ASSERT_FALSE(get(epoch_t(1), false));
+  ASSERT_FALSE(getNoPromotion(epoch_t(1), false));
+  // consistent entries never expire
+  cache_->setMetaData(LOG_ID,
+                      epoch_t(1),
+                      epoch_t(10),
+                      RecordSource::CACHED_CONSISTENT,
+                      genEpochMetaData(epoch_t(1)));
+  ASSERT_TRUE(get(epoch_t(1), false));
+  ASSERT_TRUE(get(epoch_t(7), true));
+}
+
+TEST_F(EpochMetaDataCacheTest, Eviction) {
+  capacity_ = 2;
+  setUp();
+  cache_->setMetaData(LOG_ID,
+                      epoch_t(1),
+                      epoch_t(10),
+                      RecordSource::CACHED_CONSISTENT,
+                      genEpochMetaData(epoch_t(1)));
+  cache_->setMetaData(LOG_ID,
+                      epoch_t(11),
+                      epoch_t(20),
+                      RecordSource::CACHED_CONSISTENT,
+                      genEpochMetaData(epoch_t(11)));
+  // promote the first entry so that the second one gets evicted
+  ASSERT_TRUE(get(epoch_t(5), true));
+  cache_->setMetaData(LOG_ID,
+                      epoch_t(30),
+                      epoch_t(30),
+                      RecordSource::CACHED_SOFT,
+                      genEpochMetaData(epoch_t(30)));
+  ASSERT_TRUE(get(epoch_t(5), true));
+  ASSERT_TRUE(get(epoch_t(30), false));
+  // the range of the evicted entry is gone with it
+  ASSERT_FALSE(get(epoch_t(11), false));
+  ASSERT_FALSE(get(epoch_t(15), false));
+}
 
 } // namespace
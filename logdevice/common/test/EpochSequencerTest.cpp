@@ -776,6 +776,58 @@ TEST_F(EpochSequencerTest, WindowFull) {
   maybeDeleteEpochSequencer();
 }
 
+// storage feedback shrinks the window limit below maxWritesInFlight and
+// successful appends grow it back
+TEST_F(EpochSequencerTest, AdaptiveWindow) {
+  window_size_ = 8;
+  setUp();
+  EXPECT_EQ(window_size_, es_->getWindowLimit());
+  EXPECT_EQ(window_size_, es_->getMaxWindowSize());
+
+  // only the first push back from appends of the same window counts
+  EXPECT_TRUE(es_->noteWindowFeedback(compose_lsn(EPOCH, ESN_MIN), true));
+  EXPECT_EQ(4, es_->getWindowLimit());
+  EXPECT_FALSE(es_->noteWindowFeedback(compose_lsn(EPOCH, ESN_MIN), true));
+  EXPECT_EQ(4, es_->getWindowLimit());
+
+  lsn_t expect_first_lsn = compose_lsn(EPOCH, ESN_MIN);
+  auto test = [&]() {
+    for (int i = 0; i < 4; ++i) {
+      MockAppender* appender = createAppender(/*not_retire=*/true);
+      auto status = es_->runAppender(appender);
+      EXPECT_EQ(RunAppenderStatus::SUCCESS_KEEP, status);
+      EXPECT_EQ(expect_first_lsn + i, appender->getLSN());
+    }
+
+    MockAppender* appender = createAppender();
+    auto status = es_->runAppender(appender);
+    EXPECT_EQ(RunAppenderStatus::ERROR_DELETE, status);
+    EXPECT_EQ(E::NOBUFS, err);
+    EXPECT_FALSE(appender->started());
+    delete appender;
+    return 0;
+  };
+  run_on_worker(processor_.get(), /*worker_id=*/0, test);
+  EXPECT_EQ(4, es_->getNumAppendsInFlight());
+
+  // a window's worth of successes increases the limit by one
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_FALSE(es_->noteWindowFeedback(expect_first_lsn + i, false));
+    EXPECT_EQ(4, es_->getWindowLimit());
+  }
+  EXPECT_FALSE(es_->noteWindowFeedback(expect_first_lsn + 3, false));
+  EXPECT_EQ(5, es_->getWindowLimit());
+
+  // appends admitted after the last decrease may decrease it again, but
+  // never below the minimum window size
+  EXPECT_TRUE(es_->noteWindowFeedback(expect_first_lsn + 3, true));
+  EXPECT_EQ(2, es_->getWindowLimit());
+  EXPECT_FALSE(es_->noteWindowFeedback(expect_first_lsn + 3, true));
+  EXPECT_EQ(2, es_->getWindowLimit());
+
+  maybeDeleteEpochSequencer();
+}
+
 // starting Appender will get E::TOOBIG as maximum esn is reached for the epoch
 TEST_F(EpochSequencerTest, ESN_MAX) {
   esn_max_ = esn_t(64);
@@ -7,7 +7,9 @@
  */
 #include "logdevice/common/EventLoopTaskQueue.h"
 
+#include <chrono>
 #include <memory>
+#include <thread>
 
 #include <folly/Executor.h>
 #include <gtest/gtest.h>
@@ -94,3 +96,91 @@ TEST(EventLoopTaskQueue, PostPrioritizedWork) {
   EXPECT_EQ(num_mid_pri_task, num_mid_pri_executed);
   EXPECT_EQ(num_lo_pri_task, num_lo_pri_executed);
 }
+
+namespace {
+// Runs `n` tasks calling `f` on `el` in a burst and returns the dequeue
+// budget once they are done.
+template <typename F>
+uint32_t runBurst(EventLoop& el,
+                  std::chrono::microseconds target,
+                  size_t n,
+                  F f) {
+  Semaphore primed, start;
+  el.add([&] {
+    el.getTaskQueue().setDequeuesPerIteration({4, 4, 4});
+    el.getTaskQueue().setTargetIterationLatency(target);
+    primed.post();
+    start.wait();
+  });
+  primed.wait();
+  for (size_t i = 0; i < n; ++i) {
+    el.addWithPriority(f, folly::Executor::HI_PRI);
+  }
+  start.post();
+
+  Semaphore done;
+  uint32_t budget = 0;
+  el.addWithPriority(
+      [&] {
+        budget = el.getTaskQueue().getDequeueBudget();
+        done.post();
+      },
+      // runs after the burst, as tasks of the same priority are FIFO
+      folly::Executor::HI_PRI);
+  done.wait();
+  return budget;
+}
+} // namespace
+
+TEST(EventLoopTaskQueue, AdaptiveBudgetShrinksWhenTasksAreSlow) {
+  auto el = std::make_unique<EventLoop>();
+  uint32_t budget = runBurst(*el, std::chrono::microseconds(1), 100, [] {
+    /* sleep override */
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+  });
+  EXPECT_EQ(EventLoopTaskQueue::kNumberOfPriorities, budget);
+}
+
+TEST(EventLoopTaskQueue, AdaptiveBudgetGrowsWhenTasksQueueUp) {
+  auto el = std::make_unique<EventLoop>();
+  uint32_t budget = runBurst(*el, std::chrono::seconds(10), 1000, [] {});
+  EXPECT_GT(budget, 12);
+  EXPECT_LE(budget, 12 * EventLoopTaskQueue::kMaxBudgetMultiplier);
+}
+
+TEST(EventLoopTaskQueue, BusyPolling) {
+  auto el = std::make_unique<EventLoop>();
+  Semaphore sem;
+  el->add([&] {
+    el->setBusyPoll(std::chrono::milliseconds(10));
+    sem.post();
+  });
+  sem.wait();
+
+  // Tasks keep running while the loop busy-polls, each in its own batch.
+  for (int i = 0; i < 100; ++i) {
+    el->add([&] { sem.post(); });
+    sem.wait();
+  }
+  uint64_t batches = 0;
+  el->add([&] {
+    EXPECT_EQ(std::chrono::milliseconds(10), el->getBusyPoll());
+    batches = el->getTaskQueue().getNumBatches();
+    sem.post();
+  });
+  sem.wait();
+  EXPECT_GE(batches, 102);
+
+  // Back to blocking, and on again: shutting down works in either mode.
+  el->add([&] {
+    el->setBusyPoll(std::chrono::microseconds::zero());
+    sem.post();
+  });
+  sem.wait();
+  el->add([&] {
+    el->setBusyPoll(std::chrono::microseconds(100));
+    sem.post();
+  });
+  sem.wait();
+  el.reset();
+}
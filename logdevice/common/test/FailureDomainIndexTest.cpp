@@ -0,0 +1,85 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "logdevice/common/configuration/nodes/FailureDomainIndex.h"
+
+#include <gtest/gtest.h>
+
+#include "logdevice/common/test/NodesConfigurationTestUtil.h"
+
+namespace {
+
+using namespace facebook::logdevice;
+using namespace facebook::logdevice::configuration;
+using facebook::logdevice::configuration::nodes::FailureDomainIndex;
+
+Node buildNode(folly::Optional<std::string> location) {
+  Node node;
+  node.addStorageRole();
+  node.addSequencerRole();
+  if (location.hasValue()) {
+    node.setLocation(*location);
+  }
+  return node;
+}
+
+TEST(FailureDomainIndexTest, Basic) {
+  Nodes nodes;
+  nodes.emplace(0, buildNode("rg0.dc0.cl0.row0.rk0"));
+  nodes.emplace(1, buildNode("rg0.dc0.cl0.row0.rk1"));
+  nodes.emplace(3, buildNode("rg0.dc0.cl0.row1.rk0"));
+  nodes.emplace(4, buildNode("rg0.dc0.cl0.row0.rk0"));
+  nodes.emplace(5, buildNode("rg0.dc0.cl0.row1"));
+  nodes.emplace(6, buildNode(folly::none));
+  auto config = NodesConfigurationTestUtil::provisionNodes(std::move(nodes));
+  ASSERT_NE(nullptr, config);
+  const FailureDomainIndex& index = *config->getFailureDomainIndex();
+
+  // every node is its own domain at NODE scope
+  EXPECT_EQ(6, index.numDomains(NodeLocationScope::NODE));
+  EXPECT_EQ(FailureDomainIndex::NO_DOMAIN,
+            index.getDomain(NodeLocationScope::NODE, 2));
+  EXPECT_EQ(std::vector<node_index_t>({6}),
+            index.getNodes(NodeLocationScope::NODE,
+                           index.getDomain(NodeLocationScope::NODE, 6)));
+
+  // racks with the same label in different rows are different domains
+  const auto rack = index.getDomain(NodeLocationScope::RACK, 0);
+  EXPECT_EQ(rack, index.getDomain(NodeLocationScope::RACK, 4));
+  EXPECT_NE(rack, index.getDomain(NodeLocationScope::RACK, 1));
+  EXPECT_NE(rack, index.getDomain(NodeLocationScope::RACK, 3));
+  EXPECT_EQ("rg0.dc0.cl0.row0.rk0",
+            index.getDomainName(NodeLocationScope::RACK, rack));
+  EXPECT_EQ(std::vector<node_index_t>({0, 4}),
+            index.getNodes(NodeLocationScope::RACK, rack));
+  EXPECT_EQ(4, index.numDomains(NodeLocationScope::RACK));
+
+  const auto row1 = index.getDomain(NodeLocationScope::ROW, 3);
+  EXPECT_EQ(row1, index.getDomain(NodeLocationScope::ROW, 5));
+  EXPECT_EQ(std::vector<node_index_t>({0, 1, 4}),
+            index.getNodes(NodeLocationScope::ROW,
+                           index.getDomain(NodeLocationScope::ROW, 0)));
+  EXPECT_EQ(1, index.numDomains(NodeLocationScope::REGION));
+
+  EXPECT_TRUE(index.scopeSpecified(NodeLocationScope::RACK, 3));
+  EXPECT_FALSE(index.scopeSpecified(NodeLocationScope::RACK, 5));
+  EXPECT_TRUE(index.scopeSpecified(NodeLocationScope::ROW, 5));
+  EXPECT_FALSE(index.scopeSpecified(NodeLocationScope::NODE, 3));
+
+  // nodes without a location are only indexed at NODE scope
+  EXPECT_EQ(FailureDomainIndex::NO_DOMAIN,
+            index.getDomain(NodeLocationScope::RACK, 6));
+  EXPECT_FALSE(index.scopeSpecified(NodeLocationScope::REGION, 6));
+
+  // copies that only bump the version share the index
+  auto bumped = config->withIncrementedVersionAndTimestamp();
+  ASSERT_NE(nullptr, bumped);
+  EXPECT_EQ(config->getFailureDomainIndex(), bumped->getFailureDomainIndex());
+}
+
+} // namespace
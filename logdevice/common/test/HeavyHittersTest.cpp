@@ -0,0 +1,124 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/stats/HeavyHitters.h"
+
+#include <string>
+#include <unordered_map>
+
+#include <folly/Conv.h>
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+
+namespace {
+// 10 heavy keys adding 1000 * (i + 1) each, and 100k light ones adding 1.
+std::unordered_map<std::string, uint64_t> fill(HeavyHitters& hh,
+                                               int seed = 0) {
+  std::unordered_map<std::string, uint64_t> totals;
+  for (int round = 0; round < 10; ++round) {
+    for (int i = 0; i < 10000; ++i) {
+      std::string key = "light" + folly::to<std::string>(seed, ".", round, i);
+      hh.add(key, 1);
+      totals[key] += 1;
+    }
+    for (int i = 0; i < 10; ++i) {
+      std::string key = "heavy" + folly::to<std::string>(i);
+      hh.add(key, 100 * (i + 1));
+      totals[key] += 100 * (i + 1);
+    }
+  }
+  return totals;
+}
+} // namespace
+
+TEST(HeavyHittersTest, TopKeysAreExact) {
+  HeavyHitters hh(10);
+  auto totals = fill(hh);
+
+  auto top = hh.top();
+  ASSERT_EQ(10, top.size());
+  for (int i = 0; i < 10; ++i) {
+    // Highest first, and only off by the estimate when they got into the
+    // top.
+    EXPECT_EQ("heavy" + folly::to<std::string>(9 - i), top[i].first);
+    EXPECT_GE(top[i].second, totals[top[i].first]);
+    EXPECT_LE(top[i].second, totals[top[i].first] + 100);
+  }
+
+  uint64_t total = 0;
+  for (const auto& kv : totals) {
+    total += kv.second;
+    // Never undercounts.
+    ASSERT_GE(hh.count(kv.first), kv.second);
+  }
+  EXPECT_EQ(total, hh.total());
+  EXPECT_EQ(0, HeavyHitters(10).count("heavy0"));
+}
+
+TEST(HeavyHittersTest, Merge) {
+  HeavyHitters a(10), b(10);
+  auto totals_a = fill(a, 1);
+  auto totals_b = fill(b, 2);
+  b.add("heavy0", 100000);
+
+  a.merge(b);
+  EXPECT_EQ("heavy0", a.top()[0].first);
+  for (int i = 0; i < 10; ++i) {
+    std::string key = "heavy" + folly::to<std::string>(i);
+    uint64_t expected =
+        totals_a[key] + totals_b[key] + (i == 0 ? 100000 : 0);
+    EXPECT_GE(a.count(key), expected);
+    EXPECT_LE(a.count(key), expected + 200);
+  }
+
+  a.clear();
+  EXPECT_EQ(0, a.total());
+  EXPECT_TRUE(a.top().empty());
+}
+
+TEST(HeavyHittersTest, WindowedRates) {
+  // 6 windows of 12s.
+  WindowedHeavyHitters hh(seconds(60), 2);
+  milliseconds start = seconds(1200);
+  // "a" appends 100 B/s for 60s, "b" 10 B/s for the last 12s.
+  for (int s = 0; s < 60; ++s) {
+    hh.add("a", 100, start + seconds(s));
+  }
+  for (int s = 48; s < 60; ++s) {
+    hh.add("b", 10, start + seconds(s));
+  }
+  milliseconds now = start + seconds(60);
+
+  auto rates = hh.rates({seconds(12), seconds(60), seconds(600)}, now);
+  ASSERT_EQ(2, rates.size());
+  EXPECT_NEAR(100, rates["a"][0], 1);
+  EXPECT_NEAR(100, rates["a"][1], 1);
+  // Intervals are cut to the span.
+  EXPECT_NEAR(100, rates["a"][2], 1);
+  EXPECT_NEAR(10, rates["b"][0], 1);
+  EXPECT_NEAR(2, rates["b"][1], 1);
+
+  // Merging another thread's windows.
+  WindowedHeavyHitters other(seconds(60), 2);
+  for (int s = 0; s < 60; ++s) {
+    other.add("c", 1000, start + seconds(s));
+  }
+  hh.merge(other);
+  rates = hh.rates({seconds(60)}, now, {"b"});
+  EXPECT_NEAR(1000, rates["c"][0], 1);
+  EXPECT_NEAR(100, rates["a"][0], 1);
+  EXPECT_NEAR(2, rates["b"][0], 1);
+
+  // Old windows expire.
+  hh.add("d", 1, now + seconds(600));
+  rates = hh.rates({seconds(60)}, now + seconds(601));
+  EXPECT_EQ(1, rates.size());
+  EXPECT_EQ(1, rates.count("d"));
+}
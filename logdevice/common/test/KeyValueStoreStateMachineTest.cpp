@@ -129,6 +129,60 @@ TEST_F(KeyValueStoreStateMachineTest, AppliesDeltaForUpdate) {
   EXPECT_EQ(60, state.version);
 }
 
+TEST_F(KeyValueStoreStateMachineTest, AppliesDeltaForRemove) {
+  KeyValueStoreState state;
+  state.store = std::map<std::string, std::string>(
+      {{"customer1", "abc"}, {"customer2", "def"}});
+  state.version = 5;
+
+  RemoveValue remove_value;
+  remove_value.key = "customer1";
+  KeyValueStoreDelta delta;
+  delta.set_remove_value(remove_value);
+
+  std::string failure_reason;
+  int rv = state_machine_->applyDelta(
+      delta, state, 60, std::chrono::milliseconds(0), failure_reason);
+  EXPECT_EQ(0, rv);
+  EXPECT_EQ(1, state.store.size());
+  EXPECT_EQ(0, state.store.count("customer1"));
+  EXPECT_EQ(60, state.version);
+
+  // removing a missing key is a no-op
+  rv = state_machine_->applyDelta(
+      delta, state, 61, std::chrono::milliseconds(0), failure_reason);
+  EXPECT_EQ(0, rv);
+  EXPECT_EQ(1, state.store.size());
+  EXPECT_EQ(61, state.version);
+}
+
+TEST_F(KeyValueStoreStateMachineTest, SerializeStateAfterUpdate) {
+  KeyValueStoreState state;
+  state.store = std::map<std::string, std::string>({{"customer1", "abc"}});
+  state.version = 5;
+  const size_t len = state_machine_->serializeState(state, nullptr, 0);
+
+  // the state changed between the two calls, the first result must not be
+  // reused
+  UpdateValue update;
+  update.key = "customer2";
+  update.value = "def";
+  KeyValueStoreDelta delta;
+  delta.set_update_value(update);
+  std::string failure_reason;
+  ASSERT_EQ(0,
+            state_machine_->applyDelta(
+                delta, state, 6, std::chrono::milliseconds(0), failure_reason));
+  std::string buf(len + 1024, '\0');
+  int rv = state_machine_->serializeState(state, &buf[0], buf.size());
+  EXPECT_GT(rv, len);
+
+  auto ptr = state_machine_->deserializeState(
+      Payload(buf.data(), rv), 6, std::chrono::milliseconds(0));
+  ASSERT_NE(nullptr, ptr);
+  EXPECT_EQ(state, *ptr);
+}
+
 TEST_F(KeyValueStoreStateMachineTest, AppliesDeltaWrongDeltaType) {
   std::string value_1 = "abc";
   std::string value_2 = "def";
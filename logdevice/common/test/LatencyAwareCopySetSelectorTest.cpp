@@ -0,0 +1,146 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/LatencyAwareCopySetSelector.h"
+
+#include <unordered_map>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "logdevice/common/CopySet.h"
+
+using namespace facebook::logdevice;
+
+namespace {
+
+// Returns the given copysets in a loop.
+class ScriptedCopySetSelector : public CopySetSelector {
+ public:
+  explicit ScriptedCopySetSelector(std::vector<std::vector<ShardID>> copysets)
+      : copysets_(std::move(copysets)) {}
+
+  Result select(copyset_size_t extras,
+                StoreChainLink copyset_out[],
+                copyset_size_t* copyset_size_out,
+                bool* /* chain_out */,
+                State* /* selector_state */,
+                RNG& /* rng */,
+                bool /* retry */) const override {
+    const auto& copyset = copysets_[next_++ % copysets_.size()];
+    EXPECT_EQ(getReplicationFactor() + extras, copyset.size());
+    for (size_t i = 0; i < copyset.size(); ++i) {
+      copyset_out[i] = StoreChainLink{copyset[i], ClientID()};
+    }
+    *copyset_size_out = copyset.size();
+    return Result::SUCCESS;
+  }
+
+  Result augment(ShardID[],
+                 copyset_size_t,
+                 copyset_size_t*,
+                 RNG&,
+                 bool) const override {
+    return Result::FAILED;
+  }
+
+  Result augment(StoreChainLink[],
+                 copyset_size_t,
+                 copyset_size_t*,
+                 bool,
+                 bool*,
+                 RNG&,
+                 bool) const override {
+    return Result::FAILED;
+  }
+
+  copyset_size_t getReplicationFactor() const override {
+    return 2;
+  }
+
+  mutable size_t next_ = 0;
+
+ private:
+  std::vector<std::vector<ShardID>> copysets_;
+};
+
+class TestDependencies : public CopySetSelectorDependencies {
+ public:
+  folly::Optional<double> getStoreLatency(ShardID shard) const override {
+    auto it = latencies.find(shard);
+    return it == latencies.end() ? folly::none
+                                 : folly::Optional<double>(it->second);
+  }
+
+  std::unordered_map<ShardID, double, ShardID::Hash> latencies;
+};
+
+const ShardID N1(1, 0), N2(2, 0), N3(3, 0), N4(4, 0);
+
+} // namespace
+
+TEST(LatencyAwareCopySetSelectorTest, ExpectedLatency) {
+  TestDependencies deps;
+  deps.latencies = {{N1, 5}, {N2, 100}, {N3, 20}};
+  LatencyAwareCopySetSelector selector(
+      std::make_unique<ScriptedCopySetSelector>(
+          std::vector<std::vector<ShardID>>{{N1, N2}}),
+      2,
+      std::chrono::milliseconds(10),
+      nullptr,
+      &deps);
+
+  StoreChainLink copyset[] = {{N1, ClientID()},
+                              {N2, ClientID()},
+                              {N3, ClientID()},
+                              {N4, ClientID()}};
+  // The second fastest copy decides.
+  EXPECT_EQ(100, selector.expectedStoreLatency(copyset, 2));
+  // An extra copy hides the slow shard.
+  EXPECT_EQ(20, selector.expectedStoreLatency(copyset, 3));
+  // Shards we know nothing about are assumed to be fast.
+  StoreChainLink unknown[] = {{N4, ClientID()}, {N1, ClientID()}};
+  EXPECT_EQ(5, selector.expectedStoreLatency(unknown, 2));
+}
+
+TEST(LatencyAwareCopySetSelectorTest, AvoidsSlowShards) {
+  TestDependencies deps;
+  deps.latencies = {{N1, 2}, {N2, 3}, {N3, 2}, {N4, 4}};
+  auto scripted = std::make_unique<ScriptedCopySetSelector>(
+      std::vector<std::vector<ShardID>>{{N1, N2}, {N3, N4}});
+  auto scripted_ptr = scripted.get();
+  LatencyAwareCopySetSelector selector(
+      std::move(scripted), 2, std::chrono::milliseconds(10), nullptr, &deps);
+
+  StoreChainLink copyset[2];
+  copyset_size_t size;
+  // Everything is fast, copysets are used as they come, with one draw each.
+  ASSERT_EQ(CopySetSelector::Result::SUCCESS,
+            selector.select(0, copyset, &size));
+  EXPECT_EQ(N1, copyset[0].destination);
+  ASSERT_EQ(CopySetSelector::Result::SUCCESS,
+            selector.select(0, copyset, &size));
+  EXPECT_EQ(N3, copyset[0].destination);
+  EXPECT_EQ(2, scripted_ptr->next_);
+
+  // N2 is degraded: the other copyset replaces the one containing it.
+  deps.latencies[N2] = 500;
+  scripted_ptr->next_ = 0;
+  ASSERT_EQ(CopySetSelector::Result::SUCCESS,
+            selector.select(0, copyset, &size));
+  ASSERT_EQ(2, size);
+  EXPECT_EQ(N3, copyset[0].destination);
+  EXPECT_EQ(N4, copyset[1].destination);
+
+  // Not if the other one isn't much faster.
+  deps.latencies[N4] = 300;
+  scripted_ptr->next_ = 0;
+  ASSERT_EQ(CopySetSelector::Result::SUCCESS,
+            selector.select(0, copyset, &size));
+  EXPECT_EQ(N1, copyset[0].destination);
+  EXPECT_EQ(N2, copyset[1].destination);
+}
@@ -9,6 +9,7 @@
 
 #include <gtest/gtest.h>
 
+#include "logdevice/common/Checksum.h"
 #include "logdevice/common/RecordID.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/common/protocol/STORE_Message.h"
@@ -198,6 +199,48 @@ TEST_P(LocalLogStoreRecordFormatTest, RoundTrip) {
   ASSERT_EQ(0, rv);
   ASSERT_EQ(rec_1, copyset_read[0]);
   ASSERT_EQ(rec_2, copyset_read[1]);
+
+  // The FILTERABLE key can be read without building the optional keys map.
+  folly::Optional<folly::StringPiece> filterable_key;
+  rv = LocalLogStoreRecordFormat::parse(log_store_blob,
+                                        nullptr,
+                                        nullptr,
+                                        nullptr,
+                                        nullptr,
+                                        nullptr,
+                                        nullptr,
+                                        0,
+                                        nullptr,
+                                        nullptr,
+                                        nullptr,
+                                        -1 /* unused */,
+                                        &filterable_key);
+  ASSERT_EQ(0, rv);
+  ASSERT_TRUE(filterable_key.has_value());
+  ASSERT_EQ("abcd", filterable_key.value());
+
+  // RecordView decodes the same fields on demand.
+  LocalLogStoreRecordFormat::RecordView view;
+  ASSERT_EQ(0, view.init(log_store_blob));
+  ASSERT_EQ(timestamp, view.timestamp());
+  ASSERT_EQ(last_known_good, view.lastKnownGood());
+  ASSERT_EQ(expected_flags, view.flags());
+  ASSERT_EQ(wave_read, view.waveOrRecoveryEpoch());
+  ASSERT_EQ(2, view.copysetSize());
+  ShardID view_copyset[2];
+  view.copyset(view_copyset, this_shard);
+  ASSERT_EQ(rec_1, view_copyset[0]);
+  ASSERT_EQ(rec_2, view_copyset[1]);
+  Payload view_payload;
+  ASSERT_EQ(0, view.payload(&view_payload));
+  ASSERT_EQ("data", view_payload.toString());
+  OffsetMap view_offsets;
+  ASSERT_EQ(0, view.offsetsWithinEpoch(&view_offsets));
+  ASSERT_EQ(offsets_within_epoch_read, view_offsets);
+
+  // Truncating the blob inside the copyset is caught by init().
+  ASSERT_EQ(-1, view.init(Slice(log_store_blob.data, 19)));
+  ASSERT_EQ(E::MALFORMED_RECORD, err);
 }
 
 TEST_P(LocalLogStoreRecordFormatTest, CSIRoundTrip) {
@@ -293,3 +336,144 @@ INSTANTIATE_TEST_CASE_P(LocalLogStoreRecordFormatTest,
                                            ::testing::Bool(),
                                            ::testing::Bool(),
                                            ::testing::Bool()));
+
+TEST(LocalLogStoreRecordFormatBatchTest, CheckWellFormedBatch) {
+  const ShardID recipient(1, 0);
+  const StoreChainLink copyset[] = {{recipient, ClientID()}};
+  STORE_Header header;
+  header.rid = {esn_t(1), epoch_t(1), logid_t(1)};
+  header.timestamp = 1;
+  header.last_known_good = esn_t(0);
+  header.wave = 1;
+  header.flags = STORE_Header::CHECKSUM;
+  header.copyset_size = 1;
+
+  std::vector<std::string> header_bufs(4);
+  std::vector<std::string> payloads;
+  std::vector<Slice> headers;
+  for (size_t i = 0; i < header_bufs.size(); ++i) {
+    headers.push_back(LocalLogStoreRecordFormat::formRecordHeader(
+        header, copyset, &header_bufs[i], false, {}, STORE_Extra()));
+    // Payload is the 32-bit checksum followed by the data.
+    std::string data = "record" + std::to_string(i);
+    char checksum[8];
+    checksum_bytes(Slice::fromString(data), 32, checksum);
+    payloads.push_back(std::string(checksum, 4) + data);
+  }
+  auto payload_slices = [&] {
+    std::vector<Slice> res;
+    for (const std::string& p : payloads) {
+      res.push_back(Slice::fromString(p));
+    }
+    return res;
+  };
+
+  std::vector<Slice> slices = payload_slices();
+  EXPECT_EQ(4u,
+            LocalLogStoreRecordFormat::checkWellFormedBatch(
+                headers.data(), slices.data(), 4));
+
+  // Corrupt the data of records 1 and 3.
+  payloads[1].back() ^= 1;
+  payloads[3].back() ^= 1;
+  slices = payload_slices();
+  EXPECT_EQ(1u,
+            LocalLogStoreRecordFormat::checkWellFormedBatch(
+                headers.data(), slices.data(), 4));
+  EXPECT_EQ(E::CHECKSUM_MISMATCH, err);
+  for (size_t i = 0; i < 4; ++i) {
+    int rv = LocalLogStoreRecordFormat::checkWellFormed(headers[i], slices[i]);
+    EXPECT_EQ(i % 2 == 0 ? 0 : -1, rv);
+  }
+}
+
+TEST(LocalLogStoreRecordFormatCompressionTest, CompressedPayload) {
+  const ShardID recipient(1, 0);
+  const StoreChainLink copyset[] = {{recipient, ClientID()}};
+  STORE_Header header;
+  header.rid = {esn_t(1), epoch_t(1), logid_t(1)};
+  header.timestamp = 1;
+  header.last_known_good = esn_t(0);
+  header.wave = 1;
+  header.flags = STORE_Header::CHECKSUM;
+  header.copyset_size = 1;
+
+  std::string data;
+  for (int i = 0; i < 100; ++i) {
+    data += "{\"key\": \"value" + std::to_string(i % 7) + "\"}";
+  }
+  char checksum[8];
+  checksum_bytes(Slice::fromString(data), 32, checksum);
+  const std::string payload = std::string(checksum, 4) + data;
+
+  for (Compression c :
+       {Compression::ZSTD, Compression::LZ4, Compression::LZ4_HC}) {
+    SCOPED_TRACE(compressionToString(c));
+    std::string compressed;
+    ASSERT_TRUE(LocalLogStoreRecordFormat::compressPayload(
+        c, 3, 0, Payload(payload.data(), payload.size()), &compressed));
+    EXPECT_LT(compressed.size(), payload.size());
+
+    std::string header_buf;
+    Slice record_header = LocalLogStoreRecordFormat::formRecordHeader(
+        header,
+        copyset,
+        &header_buf,
+        false,
+        {},
+        STORE_Extra(),
+        LocalLogStoreRecordFormat::FLAG_PAYLOAD_COMPRESSED);
+    const std::string blob = header_buf + compressed;
+
+    LocalLogStoreRecordFormat::flags_t flags;
+    Payload stored;
+    ASSERT_EQ(0,
+              LocalLogStoreRecordFormat::parse(Slice::fromString(blob),
+                                               nullptr,
+                                               nullptr,
+                                               &flags,
+                                               nullptr,
+                                               nullptr,
+                                               nullptr,
+                                               0,
+                                               nullptr,
+                                               nullptr,
+                                               &stored,
+                                               -1));
+    EXPECT_TRUE(flags & LocalLogStoreRecordFormat::FLAG_PAYLOAD_COMPRESSED);
+    folly::IOBuf uncompressed;
+    ASSERT_EQ(0,
+              LocalLogStoreRecordFormat::uncompressPayload(
+                  stored, &uncompressed));
+    EXPECT_EQ(payload, uncompressed.moveToFbString().toStdString());
+
+    // The checksum is verified on the uncompressed payload, both when the
+    // payload is in the blob and when it's separate.
+    EXPECT_EQ(0, LocalLogStoreRecordFormat::checkWellFormed(
+                     Slice::fromString(blob)));
+    EXPECT_EQ(0, LocalLogStoreRecordFormat::checkWellFormed(
+                     record_header, Slice::fromString(compressed)));
+
+    // Corrupt the compressed data.
+    compressed.back() ^= 1;
+    EXPECT_EQ(-1, LocalLogStoreRecordFormat::checkWellFormed(
+                      record_header, Slice::fromString(compressed)));
+  }
+
+  // Too small or incompressible payloads are stored as is.
+  std::string compressed;
+  EXPECT_FALSE(LocalLogStoreRecordFormat::compressPayload(
+      Compression::ZSTD,
+      3,
+      payload.size() + 1,
+      Payload(payload.data(), payload.size()),
+      &compressed));
+  EXPECT_FALSE(LocalLogStoreRecordFormat::compressPayload(
+      Compression::ZSTD, 3, 0, Payload("abc", 3), &compressed));
+  EXPECT_FALSE(LocalLogStoreRecordFormat::compressPayload(
+      Compression::NONE,
+      3,
+      0,
+      Payload(payload.data(), payload.size()),
+      &compressed));
+}
@@ -0,0 +1,112 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/LogRecoveryScheduler.h"
+
+#include <unordered_map>
+
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+
+namespace {
+
+class LogRecoverySchedulerTest : public ::testing::Test {
+ protected:
+  void enqueue(logid_t log, StorageSet shards, size_t pending_appends) {
+    queue_.q.get<LogIDUniqueQueue::FIFOIndex>().push_back(log);
+    logs_[log] = LogRecoveryScheduler::LogInfo{std::move(shards),
+                                                pending_appends};
+  }
+
+  // Returns LOGID_INVALID if nothing can start.
+  logid_t pick(size_t scan_limit, size_t max_per_shard) {
+    auto it = scheduler_.pickNext(
+        queue_,
+        scan_limit,
+        max_per_shard,
+        [this](logid_t log) -> folly::Optional<LogRecoveryScheduler::LogInfo> {
+          auto info = logs_.find(log);
+          if (info == logs_.end()) {
+            return folly::none;
+          }
+          return info->second;
+        });
+    auto& index = queue_.q.get<LogIDUniqueQueue::FIFOIndex>();
+    return it == index.end() ? LOGID_INVALID : *it;
+  }
+
+  LogIDUniqueQueue queue_;
+  std::unordered_map<logid_t, LogRecoveryScheduler::LogInfo, logid_t::Hash>
+      logs_;
+  LogRecoveryScheduler scheduler_;
+};
+
+const ShardID N0(0, 0);
+const ShardID N1(1, 0);
+const ShardID N2(2, 0);
+
+} // namespace
+
+TEST_F(LogRecoverySchedulerTest, PicksLogWithMostPendingAppends) {
+  enqueue(logid_t(1), {N0}, 5);
+  enqueue(logid_t(2), {N1}, 50);
+  enqueue(logid_t(3), {N2}, 50);
+  enqueue(logid_t(4), {N2}, 500);
+
+  // Ties go to the log queued first.
+  EXPECT_EQ(logid_t(2), pick(3, 0));
+  EXPECT_EQ(logid_t(4), pick(4, 0));
+  // A scan limit of 1 means FIFO.
+  EXPECT_EQ(logid_t(1), pick(1, 0));
+  EXPECT_EQ(logid_t(1), pick(0, 0));
+}
+
+TEST_F(LogRecoverySchedulerTest, ReturnsLogsWithoutSequencerRightAway) {
+  enqueue(logid_t(1), {N0}, 5);
+  enqueue(logid_t(2), {N1}, 50);
+  queue_.q.get<LogIDUniqueQueue::FIFOIndex>().push_back(logid_t(3));
+
+  EXPECT_EQ(logid_t(3), pick(10, 0));
+}
+
+TEST_F(LogRecoverySchedulerTest, ShardLimit) {
+  enqueue(logid_t(1), {N0, N1}, 100);
+  enqueue(logid_t(2), {N1, N2}, 10);
+  enqueue(logid_t(3), {N2}, 1);
+
+  scheduler_.onStarted(logid_t(10), {N0});
+  scheduler_.onStarted(logid_t(11), {N0, N1});
+  EXPECT_EQ(2, scheduler_.getShardLoad(N0));
+  EXPECT_EQ(1, scheduler_.getShardLoad(N1));
+  EXPECT_EQ(0, scheduler_.getShardLoad(N2));
+
+  EXPECT_EQ(logid_t(1), pick(10, 0));
+  EXPECT_EQ(logid_t(1), pick(10, 3));
+  EXPECT_EQ(logid_t(2), pick(10, 2));
+  EXPECT_EQ(logid_t(3), pick(10, 1));
+  // Log 3 fits but isn't looked at.
+  EXPECT_EQ(LOGID_INVALID, pick(2, 1));
+
+  scheduler_.onFinished(logid_t(11));
+  EXPECT_EQ(1, scheduler_.getShardLoad(N0));
+  EXPECT_EQ(0, scheduler_.getShardLoad(N1));
+  EXPECT_EQ(logid_t(2), pick(10, 1));
+
+  // Finishing twice, or finishing a log that never started, is a no-op.
+  scheduler_.onFinished(logid_t(11));
+  scheduler_.onFinished(logid_t(12));
+  EXPECT_EQ(1, scheduler_.getShardLoad(N0));
+
+  // Starting again replaces the shards accounted for the log.
+  scheduler_.onStarted(logid_t(10), {N1});
+  EXPECT_EQ(0, scheduler_.getShardLoad(N0));
+  EXPECT_EQ(1, scheduler_.getShardLoad(N1));
+  EXPECT_TRUE(scheduler_.canStart({N0, N2}, 1));
+  EXPECT_FALSE(scheduler_.canStart({N0, N1}, 1));
+  EXPECT_TRUE(scheduler_.canStart({N0, N1}, 0));
+}
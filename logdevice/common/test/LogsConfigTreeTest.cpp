@@ -15,6 +15,7 @@
 
 #include "logdevice/common/MetaDataLog.h"
 #include "logdevice/common/configuration/logs/DefaultLogAttributes.h"
+#include "logdevice/common/configuration/logs/FlatLogIndex.h"
 #include "logdevice/include/LogAttributes.h"
 
 using namespace facebook::logdevice::logsconfig;
@@ -398,6 +399,58 @@ TEST(LogsConfigTreeTest, ImmutabilityTest) {
   ASSERT_TRUE(snapshot1->findDirectory("/normal_logs"));
 }
 
+// Copies share the log group maps of their directories until one of them
+// changes. Changes to either side must not be visible in the other, and the
+// copied index must point at the copy's directories.
+TEST(LogsConfigTreeTest, CopySharesLogGroupsUntilModified) {
+  std::unique_ptr<LogsConfigTree> tree = LogsConfigTree::create();
+  auto dir = tree->addDirectory(
+      tree->root(), "dir", LogAttributes().with_replicationFactor(2));
+  ASSERT_NE(nullptr, dir);
+  ASSERT_NE(nullptr,
+            tree->addLogGroup(dir,
+                              "log1",
+                              logid_range_t{logid_t(1), logid_t(10)},
+                              LogAttributes(),
+                              false));
+  ASSERT_NE(nullptr,
+            tree->addLogGroup(dir,
+                              "log2",
+                              logid_range_t{logid_t(11), logid_t(20)},
+                              LogAttributes(),
+                              false));
+
+  std::unique_ptr<LogsConfigTree> snapshot = tree->copy();
+  DirectoryNode* snapshot_dir = snapshot->findDirectory("/dir");
+  ASSERT_NE(nullptr, snapshot_dir);
+  ASSERT_NE(dir, snapshot_dir);
+  auto lgid = snapshot->getLogGroupByID(logid_t(15));
+  ASSERT_NE(nullptr, lgid);
+  EXPECT_EQ(snapshot_dir, lgid->parent);
+  EXPECT_EQ("/dir/log2", lgid->getFullyQualifiedName());
+
+  ASSERT_EQ(0, tree->deleteLogGroup("/dir/log2"));
+  ASSERT_NE(nullptr,
+            tree->addLogGroup(dir,
+                              "log3",
+                              logid_range_t{logid_t(21), logid_t(30)},
+                              LogAttributes(),
+                              false));
+  EXPECT_EQ(2, dir->logs().size());
+  EXPECT_EQ(1, dir->logs().count("log3"));
+  EXPECT_EQ(2, snapshot_dir->logs().size());
+  EXPECT_EQ(1, snapshot_dir->logs().count("log2"));
+  EXPECT_EQ(nullptr, tree->getLogGroupByID(logid_t(15)));
+  EXPECT_NE(nullptr, snapshot->getLogGroupByID(logid_t(15)));
+  EXPECT_EQ(nullptr, snapshot->getLogGroupByID(logid_t(25)));
+
+  // Modifying the snapshot leaves the original alone as well.
+  ASSERT_EQ(0, snapshot->deleteLogGroup("/dir/log1"));
+  EXPECT_EQ(1, snapshot_dir->logs().size());
+  EXPECT_EQ(1, dir->logs().count("log1"));
+  EXPECT_NE(nullptr, tree->getLogGroupByID(logid_t(5)));
+}
+
 TEST(LogsConfigTreeTest, TestSnapshottingPerformance) {
   auto defaults = DefaultLogAttributes();
   std::unique_ptr<LogsConfigTree> tree = LogsConfigTree::create();
@@ -476,6 +529,45 @@ TEST(LogsConfigTreeTest, TestFindLogByID) {
   ASSERT_FALSE(not_found);
 }
 
+TEST(LogsConfigTreeTest, FlatLogIndex) {
+  std::unique_ptr<LogsConfigTree> tree = LogsConfigTree::create();
+  auto lg1 = tree->addLogGroup(
+      "/log_group1", logid_range_t{logid_t(1), logid_t(10)});
+  auto lg2 = tree->addLogGroup(
+      "/log_group2", logid_range_t{logid_t(20), logid_t(100)});
+  auto lg3 = tree->addLogGroup(
+      "/log_group3", logid_range_t{logid_t(101), logid_t(101)});
+  ASSERT_TRUE(lg1);
+  ASSERT_TRUE(lg2);
+  ASSERT_TRUE(lg3);
+
+  FlatLogIndex index({&tree->getLogMap()});
+  ASSERT_EQ(3, index.size());
+  // Repeated lookups hit the per-thread cache of the last found range.
+  for (int i = 0; i < 2; ++i) {
+    for (logid_t::raw_type id : {1, 5, 10}) {
+      ASSERT_NE(nullptr, index.find(id));
+      EXPECT_EQ(lg1, index.find(id)->log_group);
+    }
+    EXPECT_EQ(lg2, index.find(20)->log_group);
+    EXPECT_EQ(lg2, index.find(100)->log_group);
+    EXPECT_EQ(lg3, index.find(101)->log_group);
+    for (logid_t::raw_type id : {0, 11, 19, 102, 1000}) {
+      EXPECT_EQ(nullptr, index.find(id));
+      EXPECT_EQ(E::NOTFOUND, err);
+    }
+  }
+
+  // A new index over a changed tree doesn't see the cached entries of the
+  // old one.
+  ASSERT_EQ(lg1, index.find(5)->log_group);
+  ASSERT_EQ(0, tree->deleteLogGroup("/log_group1"));
+  FlatLogIndex index2({&tree->getLogMap()});
+  EXPECT_EQ(2, index2.size());
+  EXPECT_EQ(nullptr, index2.find(5));
+  EXPECT_EQ(lg2, index2.find(50)->log_group);
+}
+
 TEST(LogsConfigTreeTest, TestMetadataLogAddFail) {
   std::unique_ptr<LogsConfigTree> tree = LogsConfigTree::create();
   LogAttributes base_attrs =
@@ -27,6 +27,7 @@
 #include "logdevice/common/protocol/MUTATED_Message.h"
 #include "logdevice/common/protocol/MessageDeserializers.h"
 #include "logdevice/common/protocol/MessageTypeNames.h"
+#include "logdevice/common/protocol/PayloadCompression.h"
 #include "logdevice/common/protocol/ProtocolReader.h"
 #include "logdevice/common/protocol/ProtocolWriter.h"
 #include "logdevice/common/protocol/RECORD_Message.h"
@@ -35,6 +36,7 @@
 #include "logdevice/common/protocol/STARTED_Message.h"
 #include "logdevice/common/protocol/START_Message.h"
 #include "logdevice/common/protocol/STOP_Message.h"
+#include "logdevice/common/protocol/STORED_Message.h"
 #include "logdevice/common/protocol/STORE_Message.h"
 #include "logdevice/common/request_util.h"
 #include "logdevice/common/test/TestUtil.h"
@@ -344,9 +346,14 @@ struct TestStoreMessageFactory {
     header_.flags = flags;
   }
 
-  void setExtra(STORE_Extra extra, std::string serialized) {
+  // If `compact_serialized' is not empty, it is expected instead of
+  // `serialized' from Compatibility::COMPACT_OFFSET_MAP on.
+  void setExtra(STORE_Extra extra,
+                std::string serialized,
+                std::string compact_serialized = "") {
     extra_ = std::move(extra);
     extra_serialized_ = std::move(serialized);
+    compact_extra_serialized_ = std::move(compact_serialized);
   }
 
   void setKey(std::map<KeyType, std::string> optional_keys,
@@ -402,7 +409,12 @@ struct TestStoreMessageFactory {
     }
 
     // Copyset, optional blobs, payload
-    rv += extra_serialized_;
+    if (proto >= Compatibility::COMPACT_OFFSET_MAP &&
+        !compact_extra_serialized_.empty()) {
+      rv += compact_extra_serialized_;
+    } else {
+      rv += extra_serialized_;
+    }
 
     // StoreChainLink
     rv += "010000000400008002000000050000800300000006000080";
@@ -435,6 +447,7 @@ struct TestStoreMessageFactory {
   std::string payload_;
   STORE_Extra extra_;
   std::string extra_serialized_;
+  std::string compact_extra_serialized_;
   std::map<KeyType, std::string> optional_keys_;
   std::string key_serialized_;
 };
@@ -573,7 +586,7 @@ TEST_F(MessageSerializationTest, STORE_WithByteOffsetMapInfo) {
   TestStoreMessageFactory factory;
   factory.setFlags(STORE_Header::OFFSET_WITHIN_EPOCH |
                    STORE_Header::OFFSET_MAP);
-  factory.setExtra(extra, "9900000000000000");
+  factory.setExtra(extra, "9900000000000000", "9901");
 
   STORE_Message m = factory.message();
   auto check = [&](const STORE_Message& m2, uint16_t proto) {
@@ -912,10 +925,17 @@ TEST_F(MessageSerializationTest, RECORD) {
     return RECORD_Message::deserialize(reader);
   };
 
-  auto expected_fn = [](uint16_t /*proto*/) {
-    return "ADCDC109386DAEB1425FA4E1402B82F8B066A8C8973993E7E75FF64680896CDA1"
-           "10300000000DA30740BE50A27DB02531D00008702000001F60400000000000000"
-           "01F60A00000000000000707265766564";
+  auto expected_fn = [](uint16_t proto) {
+    if (proto < Compatibility::COMPACT_OFFSET_MAP) {
+      return "ADCDC109386DAEB1425FA4E1402B82F8B066A8C8973993E7E75FF64680896CDA1"
+             "10300000000DA30740BE50A27DB02531D00008702000001F60400000000000000"
+             "01F60A00000000000000707265766564";
+    } else {
+      // Offset map counters are varints
+      return "ADCDC109386DAEB1425FA4E1402B82F8B066A8C8973993E7E75FF64680896CDA1"
+             "10300000000DA30740BE50A27DB02531D00008702000001F604"
+             "01F60A707265766564";
+    }
   };
 
   DO_TEST(m,
@@ -967,10 +987,14 @@ TEST_F(MessageSerializationTest, RECORD_WithWriteStream) {
       return "ADCDC109386DAEB1425FA4E1402B82F8B066A8C8973993E7E75FF64680896CDA1"
              "10300000000DA30740BE50A27DB02531D00008702000001F60400000000000000"
              "01F60A00000000000000707265766564";
-    } else {
+    } else if (proto < Compatibility::COMPACT_OFFSET_MAP) {
       return "ADCDC109386DAEB1425FA4E1402B82F8B066A8C8973993E7E75FF64680896CDA1"
              "10340000000DA30740BE50A27DB02531D00008702000001F60400000000000000"
              "01F60A00000000000000707265766564";
+    } else {
+      return "ADCDC109386DAEB1425FA4E1402B82F8B066A8C8973993E7E75FF64680896CDA1"
+             "10340000000DA30740BE50A27DB02531D00008702000001F604"
+             "01F60A707265766564";
     }
   };
 
@@ -982,6 +1006,100 @@ TEST_F(MessageSerializationTest, RECORD_WithWriteStream) {
           deserializer);
 }
 
+TEST_F(MessageSerializationTest, RECORD_CompressedPayload) {
+  RECORD_Header h = {
+      logid_t(0xb1ae6d3809c1cdad),
+      read_stream_id_t(0xf8822b40e1a45f42),
+      0xe7933997c8a866b0,
+      0xda6c898046f65fe7,
+      RECORD_Header::INCLUDES_EXTRA_METADATA,
+  };
+  ExtraMetadata reb = {{
+                           esn_t(0x0b7430da),
+                           0xdb270ae5,
+                           2,
+                       },
+                       {ShardID(0x1d53, 0), ShardID(0x0287, 0)},
+                       OffsetMap()};
+  std::string payload;
+  for (int i = 0; i < 1000; ++i) {
+    payload += "preved medved ";
+  }
+  RECORD_Message m(h,
+                   TrafficClass::REBUILD,
+                   PayloadHolder::copyString(payload),
+                   std::make_unique<ExtraMetadata>(reb));
+
+  auto serialize = [&](uint16_t proto, Compression compression) {
+    auto iobuf = folly::IOBuf::create(IOBUF_ALLOCATION_UNIT);
+    ProtocolWriter writer(m.type_, iobuf.get(), proto);
+    writer.setPayloadCompression({compression, 1, 1024});
+    m.serialize(writer);
+    EXPECT_TRUE(writer.ok());
+    return iobuf;
+  };
+
+  for (Compression compression :
+       {Compression::ZSTD, Compression::LZ4, Compression::LZ4_HC}) {
+    SCOPED_TRACE(compressionToString(compression));
+    const uint16_t proto = Compatibility::MAX_PROTOCOL_SUPPORTED;
+    auto iobuf = serialize(proto, compression);
+    EXPECT_LT(iobuf->computeChainDataLength(), payload.size() / 2);
+
+    ProtocolReader reader(m.type_, std::move(iobuf), proto);
+    std::unique_ptr<Message> found = RECORD_Message::deserialize(reader).msg;
+    ASSERT_NE(nullptr, found);
+    checkRECORD(m, *dynamic_cast<RECORD_Message*>(found.get()), proto);
+  }
+
+  // Peers that don't support compression get the payload as is.
+  auto iobuf = serialize(
+      Compatibility::PAYLOAD_COMPRESSION_SUPPORT - 1, Compression::ZSTD);
+  EXPECT_GT(iobuf->computeChainDataLength(), payload.size());
+}
+
+TEST_F(MessageSerializationTest, CompressedPayloadCache) {
+  std::string payload;
+  for (int i = 0; i < 1000; ++i) {
+    payload += "preved medved ";
+  }
+  PayloadHolder ph = PayloadHolder::copyString(payload);
+  payload_compression::CompressedPayloadCache cache;
+
+  auto compress = [&](uint16_t proto, Compression compression) {
+    auto iobuf = folly::IOBuf::create(IOBUF_ALLOCATION_UNIT);
+    ProtocolWriter writer(MessageType::STORE, iobuf.get(), proto);
+    writer.setPayloadCompression({compression, 1, 1024});
+    return cache.compress(writer, ph);
+  };
+
+  const uint16_t proto = Compatibility::MAX_PROTOCOL_SUPPORTED;
+  auto first = compress(proto, Compression::ZSTD);
+  ASSERT_TRUE(first.hasValue());
+  auto second = compress(proto, Compression::ZSTD);
+  ASSERT_TRUE(second.hasValue());
+  // Compressed once, the buffer is shared.
+  EXPECT_EQ(first->data(), second->data());
+  EXPECT_EQ(first->computeChainDataLength(), second->computeChainDataLength());
+
+  // Different options are compressed again, with the same result as without
+  // the cache.
+  auto lz4 = compress(proto, Compression::LZ4);
+  ASSERT_TRUE(lz4.hasValue());
+  EXPECT_NE(first->data(), lz4->data());
+  auto iobuf = folly::IOBuf::create(IOBUF_ALLOCATION_UNIT);
+  ProtocolWriter writer(MessageType::STORE, iobuf.get(), proto);
+  writer.setPayloadCompression({Compression::LZ4, 1, 1024});
+  auto uncached = payload_compression::compress(writer, ph);
+  ASSERT_TRUE(uncached.hasValue());
+  EXPECT_EQ(uncached->coalesce(), lz4->coalesce());
+
+  EXPECT_FALSE(compress(proto, Compression::NONE).hasValue());
+  EXPECT_FALSE(
+      compress(Compatibility::PAYLOAD_COMPRESSION_SUPPORT - 1, Compression::LZ4)
+          .hasValue());
+}
+
 namespace {
 TailRecord genTailRecord(bool include_payload) {
   TailRecordHeader::flags_t flags =
@@ -1470,6 +1588,51 @@ TEST_F(MessageSerializationTest, MUTATED) {
   }
 }
 
+TEST_F(MessageSerializationTest, STORED_WithStageTimes) {
+  STORED_Header h = {RecordID(esn_t(2), epoch_t(3), logid_t(4)),
+                     5,
+                     Status::OK,
+                     NodeID(node_index_t(6)),
+                     STORED_Header::SYNCED | STORED_Header::STAGE_TIMES,
+                     shard_index_t(7)};
+  StoreStageTimes stage_times;
+  stage_times.queue_us = 10;
+  stage_times.write_us = 20;
+  stage_times.total_us = 35;
+  STORED_Message m(h,
+                   LSN_INVALID,
+                   0,
+                   CHUNK_REBUILDING_ID_INVALID,
+                   FlushToken_INVALID,
+                   ServerInstanceId_INVALID,
+                   ShardID(),
+                   stage_times);
+  auto check = [&](const STORED_Message& m2, uint16_t /*proto*/) {
+    auto& h2 = m2.header_;
+    EXPECT_EQ(RecordID(esn_t(2), epoch_t(3), logid_t(4)), h2.rid);
+    EXPECT_EQ(5, h2.wave);
+    EXPECT_EQ(Status::OK, h2.status);
+    EXPECT_EQ(STORED_Header::SYNCED | STORED_Header::STAGE_TIMES, h2.flags);
+    EXPECT_EQ(7, h2.shard);
+    EXPECT_EQ(10, m2.stage_times_.queue_us);
+    EXPECT_EQ(20, m2.stage_times_.write_us);
+    EXPECT_EQ(35, m2.stage_times_.total_us);
+  };
+  std::string expected = "02000000030000000400000000000000" // rid
+                         "05000000"                         // wave
+                         "0000"                             // status
+                         "00000600"                         // redirect
+                         "41"                               // flags
+                         "0700"                             // shard
+                         "0A0000001400000023000000";        // stage times
+  DO_TEST(m,
+          check,
+          Compatibility::MIN_PROTOCOL_SUPPORTED,
+          Compatibility::MAX_PROTOCOL_SUPPORTED,
+          [&](uint16_t /*proto*/) { return expected; },
+          nullptr);
+}
+
 TEST_F(MessageSerializationTest, GET_SEQ_STATE) {
   logid_t log_id(1337);
   request_id_t req_id(7);
@@ -10,6 +10,7 @@
 
 #include "logdevice/common/ClusterState.h"
 #include "logdevice/common/HashBasedSequencerLocator.h"
+#include "logdevice/common/SequencerRedirectCache.h"
 #include "logdevice/common/SequencerRouter.h"
 #include "logdevice/common/StaticSequencerLocator.h"
 #include "logdevice/common/configuration/Configuration.h"
@@ -94,10 +95,20 @@ class MockSequencerRouter : public SequencerRouter {
   ClusterState* getClusterState() const override {
     return cluster_state_;
   }
+  SequencerRedirectCache* getRedirectCache() const override {
+    return redirect_cache_;
+  }
+  void prewarmConnections(NodeID node) override {
+    prewarmed_.push_back(node);
+  }
 
   Settings settings_;
   void startClusterStateRefreshTimer() override {}
 
+  // Not used unless a test sets it.
+  SequencerRedirectCache* redirect_cache_{nullptr};
+  std::vector<NodeID> prewarmed_;
+
  private:
   std::shared_ptr<const NodesConfiguration> nodes_config_;
   std::shared_ptr<SequencerLocator> locator_;
@@ -0,0 +1,98 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "logdevice/common/configuration/nodes/NodesConfigurationDiff.h"
+
+#include <gtest/gtest.h>
+
+#include "logdevice/common/configuration/nodes/NodesConfiguration.h"
+#include "logdevice/common/configuration/nodes/NodesConfigurationCodec.h"
+#include "logdevice/common/configuration/nodes/NodesConfigurationHistory.h"
+#include "logdevice/common/test/NodesConfigurationTestUtil.h"
+
+namespace {
+
+using namespace facebook::logdevice;
+using namespace facebook::logdevice::configuration::nodes;
+using namespace facebook::logdevice::NodesConfigurationTestUtil;
+
+TEST(NodesConfigurationDiffTest, ApplyGivesTarget) {
+  auto base = provisionNodes();
+  auto target = base->applyUpdate(addNewNodeUpdate(*base, 17));
+  ASSERT_NE(nullptr, target);
+
+  const std::string base_str = NodesConfigurationDiff::serializeForDiff(*base);
+  const std::string target_str =
+      NodesConfigurationDiff::serializeForDiff(*target);
+  ASSERT_FALSE(base_str.empty());
+  ASSERT_FALSE(target_str.empty());
+
+  const std::string diff =
+      NodesConfigurationDiff::compute(base_str, target_str);
+  ASSERT_FALSE(diff.empty());
+  EXPECT_LT(diff.size(), target_str.size());
+
+  auto got = NodesConfigurationDiff::apply(base_str, diff);
+  ASSERT_TRUE(got.hasValue());
+  EXPECT_EQ(target_str, *got);
+
+  auto deserialized = NodesConfigurationCodec::deserialize(*got);
+  ASSERT_NE(nullptr, deserialized);
+  EXPECT_EQ(*target, *deserialized);
+}
+
+TEST(NodesConfigurationDiffTest, WrongBase) {
+  auto base = provisionNodes();
+  auto target = base->applyUpdate(addNewNodeUpdate(*base, 17));
+  ASSERT_NE(nullptr, target);
+
+  const std::string diff = NodesConfigurationDiff::compute(
+      NodesConfigurationDiff::serializeForDiff(*base),
+      NodesConfigurationDiff::serializeForDiff(*target));
+
+  auto got = NodesConfigurationDiff::apply(
+      NodesConfigurationDiff::serializeForDiff(*target), diff);
+  EXPECT_FALSE(got.hasValue());
+  EXPECT_EQ(E::CHECKSUM_MISMATCH, err);
+
+  got = NodesConfigurationDiff::apply(
+      NodesConfigurationDiff::serializeForDiff(*base), "garbage");
+  EXPECT_FALSE(got.hasValue());
+  EXPECT_EQ(E::BADMSG, err);
+}
+
+TEST(NodesConfigurationDiffTest, History) {
+  NodesConfigurationHistory history(/*max_versions=*/2);
+
+  auto v1 = provisionNodes();
+  auto v2 = v1->applyUpdate(addNewNodeUpdate(*v1, 17));
+  ASSERT_NE(nullptr, v2);
+  auto v3 = v2->applyUpdate(addNewNodeUpdate(*v2, 18));
+  ASSERT_NE(nullptr, v3);
+
+  history.add(v1);
+  history.add(v1);
+  EXPECT_EQ(1, history.numVersions());
+
+  auto diff = history.getDiff(v1->getVersion(), v2);
+  ASSERT_TRUE(diff.hasValue());
+  EXPECT_EQ(2, history.numVersions());
+  auto got = NodesConfigurationDiff::apply(
+      NodesConfigurationDiff::serializeForDiff(*v1), *diff);
+  ASSERT_TRUE(got.hasValue());
+  EXPECT_EQ(NodesConfigurationDiff::serializeForDiff(*v2), *got);
+
+  // Adding v3 evicts v1.
+  history.add(v3);
+  EXPECT_EQ(2, history.numVersions());
+  EXPECT_FALSE(history.getDiff(v1->getVersion(), v3).hasValue());
+  EXPECT_EQ(E::NOTFOUND, err);
+  EXPECT_TRUE(history.getDiff(v2->getVersion(), v3).hasValue());
+}
+
+} // namespace
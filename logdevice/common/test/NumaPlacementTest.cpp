@@ -0,0 +1,51 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/NumaPlacement.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace facebook { namespace logdevice {
+
+TEST(NumaPlacementTest, ParseCpuList) {
+  std::vector<int> cpus;
+
+  ASSERT_EQ(0, numa::parseCpuList("0", &cpus));
+  EXPECT_EQ(std::vector<int>({0}), cpus);
+
+  ASSERT_EQ(0, numa::parseCpuList("0-3,8,10-11\n", &cpus));
+  EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 8, 10, 11}), cpus);
+
+  // Overlapping and unordered ranges are normalized.
+  ASSERT_EQ(0, numa::parseCpuList("6-7,2-3,3", &cpus));
+  EXPECT_EQ(std::vector<int>({2, 3, 6, 7}), cpus);
+
+  // A node without cpus has an empty list.
+  ASSERT_EQ(0, numa::parseCpuList("", &cpus));
+  EXPECT_TRUE(cpus.empty());
+
+  cpus = {42};
+  EXPECT_EQ(-1, numa::parseCpuList("3-1", &cpus));
+  EXPECT_EQ(-1, numa::parseCpuList("a-b", &cpus));
+  EXPECT_EQ(-1, numa::parseCpuList("1,,2", &cpus));
+  EXPECT_EQ(-1, numa::parseCpuList("-1", &cpus));
+  // Output is left untouched on failure.
+  EXPECT_EQ(std::vector<int>({42}), cpus);
+}
+
+TEST(NumaPlacementTest, UnknownNode) {
+  EXPECT_TRUE(numa::cpusOfNode(-1).empty());
+  EXPECT_EQ(-1, numa::bindThisThreadToNode(-1));
+}
+
+TEST(NumaPlacementTest, IncomingCpuOfInvalidSocket) {
+  EXPECT_EQ(-1, numa::incomingCpuOfSocket(-1));
+}
+
+}} // namespace facebook::logdevice
@@ -8,6 +8,7 @@
 
 #include "logdevice/common/OffsetMap.h"
 
+#include <algorithm>
 #include <cstring>
 #include <memory>
 #include <thread>
@@ -71,6 +72,34 @@ TEST(OffsetMapTest, Operators) {
   ASSERT_NE(result == result_test, true);
 }
 
+TEST(OffsetMapTest, MultipleCounters) {
+  // Counters set out of order are kept sorted and survive a round trip.
+  OffsetMap om;
+  om.setCounter(BYTE_OFFSET, 10);
+  om.setCounter(1, 20);
+  om.setCounter(7, 30);
+  const auto& counters = om.getCounterMap();
+  ASSERT_EQ(3, counters.size());
+  ASSERT_TRUE(std::is_sorted(counters.begin(), counters.end()));
+
+  char buf[128];
+  int nbytes = om.serialize(buf, sizeof(buf));
+  ASSERT_GT(nbytes, 0);
+  OffsetMap read;
+  ASSERT_EQ(nbytes, read.deserialize({buf, sizeof(buf)}));
+  ASSERT_EQ(om, read);
+
+  om.unsetCounter(7);
+  ASSERT_FALSE(om.isValidOffset(7));
+  ASSERT_EQ(20, om.getCounter(1));
+  ASSERT_EQ(10, om.getCounter(BYTE_OFFSET));
+  om.setCounter(1, BYTE_OFFSET_INVALID);
+  ASSERT_EQ(1, om.getCounterMap().size());
+
+  OffsetMap doubled = om * 2;
+  ASSERT_EQ(20, doubled.getCounter(BYTE_OFFSET));
+}
+
 TEST(OffsetMapTest, AtomicTest) {
   AtomicOffsetMap atomic_offset_map;
   OffsetMap offset_map_1, offset_map_2;
@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/OwnerThreadFreeList.h"
+
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace facebook { namespace logdevice {
+
+namespace {
+struct Foo {
+  char data[64];
+};
+using FooList = OwnerThreadFreeList<Foo>;
+} // namespace
+
+TEST(OwnerThreadFreeListTest, ReusesBlocksFreedOnSameThread) {
+  void* a = FooList::allocate();
+  void* b = FooList::allocate();
+  EXPECT_EQ(0, FooList::size());
+  FooList::deallocate(a);
+  FooList::deallocate(b);
+  EXPECT_EQ(2, FooList::size());
+
+  EXPECT_EQ(b, FooList::allocate());
+  EXPECT_EQ(a, FooList::allocate());
+  EXPECT_EQ(0, FooList::size());
+  FooList::deallocate(a);
+  FooList::deallocate(b);
+}
+
+TEST(OwnerThreadFreeListTest, BlocksFreedOnOtherThreadsComeBack) {
+  std::vector<void*> blocks;
+  for (int i = 0; i < 10; ++i) {
+    blocks.push_back(FooList::allocate());
+  }
+  const std::set<void*> allocated(blocks.begin(), blocks.end());
+  const size_t cached = FooList::size();
+
+  std::thread([&] {
+    for (void* p : blocks) {
+      FooList::deallocate(p);
+    }
+    // Nothing was cached on the freeing thread.
+    EXPECT_EQ(0, FooList::size());
+  }).join();
+  EXPECT_EQ(cached, FooList::size());
+
+  // Once the local list is exhausted, the remotely freed blocks are taken
+  // back all at once.
+  std::vector<void*> drained;
+  while (FooList::size() > 0) {
+    drained.push_back(FooList::allocate());
+  }
+  void* p = FooList::allocate();
+  EXPECT_EQ(1, allocated.count(p));
+  EXPECT_EQ(blocks.size() - 1, FooList::size());
+  FooList::deallocate(p);
+  for (void* q : drained) {
+    FooList::deallocate(q);
+  }
+}
+
+TEST(OwnerThreadFreeListTest, OutlivesOwnerThread) {
+  std::vector<void*> blocks;
+  std::thread([&] {
+    for (int i = 0; i < 10; ++i) {
+      blocks.push_back(FooList::allocate());
+    }
+    FooList::deallocate(blocks.back());
+    blocks.pop_back();
+  }).join();
+
+  // The pool of the exited thread is destroyed with the last block.
+  for (void* p : blocks) {
+    FooList::deallocate(p);
+  }
+}
+
+}} // namespace facebook::logdevice
@@ -13,6 +13,7 @@
 
 #include "logdevice/common/protocol/Compatibility.h"
 #include "logdevice/common/protocol/Message.h"
+#include "logdevice/common/protocol/ProtocolWriter.h"
 
 using namespace facebook::logdevice;
 
@@ -191,3 +192,44 @@ TEST_F(ProtocolReaderTest, ProtoMustBeSetToRead) {
   ASSERT_NE(0xfaceu, val);
   ASSERT_EQ(reader.status(), E::PROTO);
 }
+
+TEST_F(ProtocolReaderTest, Fields) {
+  const uint16_t proto = Compatibility::MAX_PROTOCOL_SUPPORTED;
+  std::string buf;
+  ProtocolWriter writer(&buf, "test", proto);
+  writer.writeFields(uint8_t(0x01), uint32_t(0x02030405), int64_t(-6));
+  ASSERT_EQ(13, writer.result());
+
+  // Same bytes as individual writes.
+  std::string expected;
+  ProtocolWriter expected_writer(&expected, "test", proto);
+  expected_writer.write(uint8_t(0x01));
+  expected_writer.write(uint32_t(0x02030405));
+  expected_writer.write(int64_t(-6));
+  ASSERT_EQ(expected, buf);
+
+  {
+    ProtocolReader reader(Slice(buf.data(), buf.size()), "test", proto);
+    uint8_t a = 0;
+    uint32_t b = 0;
+    int64_t c = 0;
+    reader.readFields(&a, &b, &c);
+    ASSERT_TRUE(reader.ok());
+    ASSERT_EQ(0x01, a);
+    ASSERT_EQ(0x02030405, b);
+    ASSERT_EQ(-6, c);
+  }
+
+  {
+    // One byte short: every output is zeroed.
+    ProtocolReader reader(Slice(buf.data(), buf.size() - 1), "test", proto);
+    uint8_t a = 0xff;
+    uint32_t b = 0xff;
+    int64_t c = 0xff;
+    reader.readFields(&a, &b, &c);
+    ASSERT_EQ(E::BADMSG, reader.status());
+    ASSERT_EQ(0, a);
+    ASSERT_EQ(0, b);
+    ASSERT_EQ(0, c);
+  }
+}
@@ -0,0 +1,38 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/network/ReceiveBufferPool.h"
+
+#include <cstring>
+
+#include <gtest/gtest.h>
+
+namespace facebook { namespace logdevice {
+
+TEST(ReceiveBufferPoolTest, SizeClasses) {
+  EXPECT_EQ(-1, ReceiveBufferPool::sizeClass(0));
+  EXPECT_EQ(-1, ReceiveBufferPool::sizeClass(4095));
+  EXPECT_EQ(0, ReceiveBufferPool::sizeClass(4096));
+  EXPECT_EQ(1, ReceiveBufferPool::sizeClass(4097));
+  EXPECT_EQ(1, ReceiveBufferPool::sizeClass(8192));
+  EXPECT_EQ(256 * 1024, ReceiveBufferPool::MAX_CLASS_SIZE);
+  const size_t max = ReceiveBufferPool::MAX_CLASS_SIZE;
+  EXPECT_EQ(ReceiveBufferPool::NUM_CLASSES - 1,
+            ReceiveBufferPool::sizeClass(max));
+  EXPECT_EQ(-1, ReceiveBufferPool::sizeClass(max + 1));
+}
+
+TEST(ReceiveBufferPoolTest, NotOnWorker) {
+  // Not a worker thread, so the buffer comes straight from the allocator.
+  auto buf = ReceiveBufferPool::allocate(5000);
+  EXPECT_EQ(0, buf->length());
+  EXPECT_GE(buf->tailroom(), 5000);
+  memset(buf->writableTail(), 'x', 5000);
+  buf->append(5000);
+}
+
+}} // namespace facebook::logdevice
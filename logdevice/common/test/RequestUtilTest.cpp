@@ -58,3 +58,37 @@ TEST(RequestUtilTest, fulfill) {
     EXPECT_EQ(std::move(f).get(), processor->getAllWorkersCount());
   }
 }
+
+TEST(RequestUtilTest, thenOnThisWorker) {
+  Settings settings = create_default_settings<Settings>();
+  settings.num_workers = 3;
+  auto processor = make_test_processor(settings);
+
+  folly::Promise<int> step1;
+  auto step1_future = step1.getSemiFuture();
+  folly::Baton<> continued;
+  std::atomic<int> continued_on{-1};
+  std::atomic<int> value{0};
+
+  auto started = fulfill_on_worker<folly::Unit>(
+      processor.get(),
+      worker_id_t(2),
+      WorkerType::GENERAL,
+      [&](folly::Promise<folly::Unit> p) {
+        auto f = then_on_this_worker(
+            std::move(step1_future), [&](folly::Try<int>&& result) {
+              Worker* w = Worker::onThisThread(false);
+              continued_on.store(w ? w->idx_.val() : -1);
+              value.store(*result);
+              continued.post();
+            });
+        p.setValue();
+      });
+  std::move(started).get();
+
+  // complete the first step from a non-worker thread
+  step1.setValue(42);
+  continued.wait();
+  EXPECT_EQ(2, continued_on.load());
+  EXPECT_EQ(42, value.load());
+}
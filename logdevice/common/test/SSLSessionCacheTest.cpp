@@ -7,6 +7,9 @@
  */
 #include "logdevice/common/SSLSessionCache.h"
 
+#include <thread>
+#include <vector>
+
 #include <folly/FileUtil.h>
 #include <gtest/gtest.h>
 
@@ -122,3 +125,45 @@ TEST(SSLSessionCacheTest, threadSafety) {
   write.join();
   report.join();
 }
+
+TEST(SSLSessionCacheTest, shards) {
+  auto stats = std::make_unique<StatsHolder>(StatsParams());
+  SSLSessionCache cache(stats.get(), 4);
+  EXPECT_EQ(nullptr, cache.getCachedSSLSession());
+
+  auto session =
+      getSessionFromFile(TEST_SSL_FILE("fake_openssl_session_with_ticket.der"));
+  cache.setCachedSSLSession(
+      folly::ssl::SSLSessionUniquePtr(SSL_SESSION_dup(session.get())));
+
+  // Other threads borrow the session from this thread's shard until they
+  // cache one of their own.
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&]() {
+      auto result = cache.getCachedSSLSession();
+      ASSERT_NE(nullptr, result);
+      EXPECT_EQ(id_from_session(session.get()), id_from_session(result.get()));
+      cache.setCachedSSLSession(std::move(result));
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  auto results = stats->aggregate();
+  EXPECT_EQ(4, results.ssl_session_resumption_attempt);
+  // The 4 threads cover all shards, and each shard caches the session once.
+  EXPECT_EQ(4, results.ssl_session_resumption_cached);
+}
+
+TEST(SSLSessionCacheTest, onSessionResumptionMiss) {
+  auto stats = std::make_unique<StatsHolder>(StatsParams());
+
+  SSLSessionCache cache(stats.get());
+  cache.onSessionResumptionMiss();
+
+  auto results = stats->aggregate();
+  EXPECT_EQ(1, results.ssl_session_resumption_miss);
+  EXPECT_EQ(0, results.ssl_session_resumption_success);
+}
@@ -0,0 +1,170 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/SealBatcher.h"
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "logdevice/common/protocol/MULTI_SEAL_Message.h"
+
+using namespace facebook::logdevice;
+
+namespace {
+
+SEAL_Header makeHeader(logid_t::raw_type log, shard_index_t shard) {
+  SEAL_Header header{};
+  header.rqid = request_id_t(log);
+  header.log_id = logid_t(log);
+  header.seal_epoch = epoch_t(5);
+  header.last_clean_epoch = epoch_t(3);
+  header.sealed_by = NodeID(7, 1);
+  header.shard = shard;
+  return header;
+}
+
+class TestSealBatcher : public SealBatcher {
+ public:
+  // Runs what the timer would.
+  void runFlush() {
+    ASSERT_TRUE(scheduled);
+    scheduled = false;
+    flush();
+  }
+
+  struct Sent {
+    node_index_t node;
+    std::vector<logid_t::raw_type> logs;
+    bool multi;
+  };
+
+  bool scheduled = false;
+  std::set<node_index_t> multi_seal_nodes;
+  std::set<node_index_t> failing_nodes;
+  std::vector<Sent> sent;
+  std::vector<std::pair<node_index_t, logid_t::raw_type>> failed;
+
+ protected:
+  void scheduleFlush() override {
+    scheduled = true;
+  }
+
+  bool supportsMultiSeal(node_index_t node) const override {
+    return multi_seal_nodes.count(node);
+  }
+
+  int sendSeal(node_index_t node, const SEAL_Header& header) override {
+    if (failing_nodes.count(node)) {
+      err = E::NOBUFS;
+      return -1;
+    }
+    sent.push_back(Sent{node, {header.log_id.val_}, false});
+    return 0;
+  }
+
+  int sendMultiSeal(node_index_t node,
+                    std::vector<SEAL_Header> headers) override {
+    if (failing_nodes.count(node)) {
+      err = E::NOBUFS;
+      return -1;
+    }
+    Sent s{node, {}, true};
+    for (const auto& header : headers) {
+      s.logs.push_back(header.log_id.val_);
+    }
+    sent.push_back(std::move(s));
+    return 0;
+  }
+
+  void onSendFailed(node_index_t node,
+                    const SEAL_Header& header,
+                    Status status) override {
+    EXPECT_EQ(E::NOBUFS, status);
+    failed.emplace_back(node, header.log_id.val_);
+  }
+};
+
+} // namespace
+
+TEST(SealBatcherTest, BatchesPerNode) {
+  TestSealBatcher batcher;
+  batcher.multi_seal_nodes = {1, 2};
+  batcher.queue(1, makeHeader(10, 0));
+  batcher.queue(2, makeHeader(10, 1));
+  batcher.queue(1, makeHeader(11, 0));
+  batcher.queue(1, makeHeader(12, 1));
+  EXPECT_EQ(3, batcher.getQueued(1));
+  EXPECT_EQ(1, batcher.getQueued(2));
+  EXPECT_TRUE(batcher.sent.empty());
+
+  batcher.runFlush();
+  EXPECT_EQ(0, batcher.getQueued(1));
+  ASSERT_EQ(2, batcher.sent.size());
+  for (const auto& s : batcher.sent) {
+    if (s.node == 1) {
+      EXPECT_TRUE(s.multi);
+      EXPECT_EQ(std::vector<logid_t::raw_type>({10, 11, 12}), s.logs);
+    } else {
+      // A single SEAL goes out as is.
+      EXPECT_EQ(2, s.node);
+      EXPECT_FALSE(s.multi);
+      EXPECT_EQ(std::vector<logid_t::raw_type>({10}), s.logs);
+    }
+  }
+  EXPECT_TRUE(batcher.failed.empty());
+}
+
+TEST(SealBatcherTest, OldNodesGetPlainSeals) {
+  TestSealBatcher batcher;
+  batcher.queue(1, makeHeader(10, 0));
+  batcher.queue(1, makeHeader(11, 0));
+  batcher.runFlush();
+  ASSERT_EQ(2, batcher.sent.size());
+  EXPECT_FALSE(batcher.sent[0].multi);
+  EXPECT_FALSE(batcher.sent[1].multi);
+}
+
+TEST(SealBatcherTest, SplitsLargeBatches) {
+  TestSealBatcher batcher;
+  batcher.multi_seal_nodes = {1};
+  const size_t n = MULTI_SEAL_Message::MAX_ENTRIES + 10;
+  for (size_t i = 0; i < n; ++i) {
+    batcher.queue(1, makeHeader(i + 1, 0));
+  }
+  batcher.runFlush();
+  ASSERT_EQ(2, batcher.sent.size());
+  EXPECT_EQ(MULTI_SEAL_Message::MAX_ENTRIES, batcher.sent[0].logs.size());
+  EXPECT_EQ(10, batcher.sent[1].logs.size());
+  EXPECT_EQ(n, batcher.sent[1].logs.back());
+}
+
+TEST(SealBatcherTest, ReportsSendFailures) {
+  TestSealBatcher batcher;
+  batcher.multi_seal_nodes = {1, 2};
+  batcher.failing_nodes = {1, 3};
+  batcher.queue(1, makeHeader(10, 0));
+  batcher.queue(1, makeHeader(11, 0));
+  batcher.queue(3, makeHeader(12, 0));
+  batcher.queue(2, makeHeader(13, 0));
+  batcher.runFlush();
+
+  ASSERT_EQ(1, batcher.sent.size());
+  EXPECT_EQ(2, batcher.sent[0].node);
+  std::sort(batcher.failed.begin(), batcher.failed.end());
+  EXPECT_EQ((std::vector<std::pair<node_index_t, logid_t::raw_type>>{
+                {1, 10}, {1, 11}, {3, 12}}),
+            batcher.failed);
+
+  // Nothing is left queued.
+  batcher.queue(2, makeHeader(14, 0));
+  batcher.runFlush();
+  ASSERT_EQ(2, batcher.sent.size());
+  EXPECT_EQ(std::vector<logid_t::raw_type>({14}), batcher.sent[1].logs);
+}
@@ -342,4 +342,71 @@ TEST_F(SequencerRouterTest, LogNotFound) {
   EXPECT_EQ(E::NOTFOUND, status_);
 }
 
+// Tests that a redirect cycle is broken in favor of the node that the node the
+// log maps to redirected to, e.g. because sequencer rebalancing moved the log
+// there, rather than the node with the highest id.
+TEST_F(SequencerRouterTest, RedirectCycleFollowsLocatedNode) {
+  const NodeID N0(0, 1), N1(1, 1);
+
+  // N1 takes care of all logs by default
+  locator_ = std::make_shared<StaticLocator>(N1);
+
+  auto router = createRouter(logid_t(1), createSimpleNodesConfig(4));
+  router->start();
+  ASSERT_EQ(std::make_pair(N1, SequencerRouter::flags_t(0)), next_node_);
+
+  // N1 moved the log to N0, which redirects back to N1
+  router->onRedirected(N1, N0, E::REDIRECTED);
+  ASSERT_EQ(std::make_pair(N0, SequencerRouter::flags_t(0)), next_node_);
+  router->onRedirected(N0, N1, E::REDIRECTED);
+  SequencerRouter::flags_t expected_flags = SequencerRouter::REDIRECT_CYCLE;
+  EXPECT_EQ(std::make_pair(N0, expected_flags), next_node_);
+}
+
+// Tests that a redirect is remembered for later requests to the same log, and
+// forgotten once the node it points to can't be reached.
+TEST_F(SequencerRouterTest, RedirectCache) {
+  const NodeID N0(0, 1), N1(1, 1);
+
+  // N0 takes care of all logs by default
+  locator_ = std::make_shared<StaticLocator>(N0);
+  auto nodes_config = createSimpleNodesConfig(4);
+  SequencerRedirectCache cache;
+  auto create = [&](logid_t log_id) {
+    auto router = createRouter(log_id, nodes_config);
+    static_cast<MockSequencerRouter*>(router.get())->redirect_cache_ = &cache;
+    return router;
+  };
+  auto prewarmed = [](const std::unique_ptr<SequencerRouter>& router) {
+    return static_cast<MockSequencerRouter*>(router.get())->prewarmed_;
+  };
+
+  auto router = create(logid_t(1));
+  router->start();
+  ASSERT_EQ(std::make_pair(N0, SequencerRouter::flags_t(0)), next_node_);
+  router->onRedirected(N0, N1, E::REDIRECTED);
+  ASSERT_EQ(std::make_pair(N1, SequencerRouter::flags_t(0)), next_node_);
+  EXPECT_EQ(std::vector<NodeID>({N1}), prewarmed(router));
+
+  // Other logs still go to N0. N1 is already known as a sequencer, no need
+  // to warm up connections to it again.
+  router = create(logid_t(2));
+  router->start();
+  EXPECT_EQ(std::make_pair(N0, SequencerRouter::flags_t(0)), next_node_);
+  router->onRedirected(N0, N1, E::REDIRECTED);
+  EXPECT_TRUE(prewarmed(router).empty());
+
+  // The next request for log 1 goes straight to N1.
+  router = create(logid_t(1));
+  router->start();
+  EXPECT_EQ(std::make_pair(N1, SequencerRouter::flags_t(0)), next_node_);
+
+  // N1 goes down, the request falls back to N0 and so do later ones.
+  router->onNodeUnavailable(N1, E::CONNFAILED);
+  EXPECT_EQ(std::make_pair(N0, SequencerRouter::flags_t(0)), next_node_);
+  router = create(logid_t(1));
+  router->start();
+  EXPECT_EQ(std::make_pair(N0, SequencerRouter::flags_t(0)), next_node_);
+}
+
 }} // namespace facebook::logdevice
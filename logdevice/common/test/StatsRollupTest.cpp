@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/StatsRollup.h"
+
+#include <map>
+
+#include <gtest/gtest.h>
+
+#include "logdevice/common/stats/Stats.h"
+
+using namespace facebook::logdevice;
+using namespace std::chrono;
+
+namespace {
+
+using Counters = std::vector<std::pair<std::string, int64_t>>;
+
+// name -> (delta, value)
+std::map<std::string, std::pair<int64_t, int64_t>>
+changes(const StatsRollup::Bucket& bucket) {
+  std::map<std::string, std::pair<int64_t, int64_t>> res;
+  for (const auto& change : bucket.changes) {
+    res[*change.name] = std::make_pair(change.delta, change.value);
+  }
+  return res;
+}
+
+} // namespace
+
+TEST(StatsRollupTest, OnlyChangedCounters) {
+  StatsRollup rollup({seconds(1), seconds(10)}, 60);
+  const auto t0 = steady_clock::now();
+
+  // The first snapshot is the baseline.
+  EXPECT_TRUE(rollup.add(Counters{{"a", 5}, {"b", 7}, {"c", 0}}, t0).empty());
+  EXPECT_EQ(3, rollup.numCounters());
+
+  auto closed = rollup.add(
+      Counters{{"a", 8}, {"b", 7}, {"c", 0}, {"d", 2}}, t0 + seconds(1));
+  ASSERT_EQ(1, closed.size());
+  EXPECT_EQ(seconds(1), closed[0]->resolution);
+  using M = std::map<std::string, std::pair<int64_t, int64_t>>;
+  // "d" is new, so it changed from 0.
+  EXPECT_EQ(M({{"a", {3, 8}}, {"d", {2, 2}}}), changes(*closed[0]));
+
+  // Nothing changed.
+  closed = rollup.add(Counters{{"a", 8}, {"b", 7}}, t0 + seconds(2));
+  ASSERT_EQ(1, closed.size());
+  EXPECT_TRUE(closed[0]->changes.empty());
+}
+
+TEST(StatsRollupTest, Resolutions) {
+  StatsRollup rollup({seconds(1), seconds(10)}, 3);
+  const auto t0 = steady_clock::now();
+  rollup.add(Counters{{"a", 0}, {"b", 0}}, t0);
+
+  for (int i = 1; i <= 10; ++i) {
+    // "b" only changes in the first second.
+    auto closed = rollup.add(
+        Counters{{"a", i * 10}, {"b", 1}}, t0 + seconds(i));
+    ASSERT_EQ(i == 10 ? 2 : 1, closed.size());
+  }
+
+  // The 1s ring buffer only keeps the last 3 buckets.
+  const auto* fine = rollup.getBuckets(seconds(1));
+  ASSERT_NE(nullptr, fine);
+  ASSERT_EQ(3, fine->size());
+  using M = std::map<std::string, std::pair<int64_t, int64_t>>;
+  EXPECT_EQ(M({{"a", {10, 100}}}), changes(fine->back()));
+
+  // The 10s bucket has the sum of the changes.
+  const auto* coarse = rollup.getBuckets(seconds(10));
+  ASSERT_NE(nullptr, coarse);
+  ASSERT_EQ(1, coarse->size());
+  EXPECT_EQ(t0, coarse->front().start);
+  EXPECT_EQ(t0 + seconds(10), coarse->front().end);
+  EXPECT_EQ(M({{"a", {100, 100}}, {"b", {1, 1}}}), changes(coarse->front()));
+
+  EXPECT_EQ(nullptr, rollup.getBuckets(seconds(60)));
+}
+
+TEST(StatsRollupTest, FlattensStats) {
+  StatsHolder holder(StatsParams().setIsServer(false));
+  StatsRollup rollup;
+  const auto t0 = steady_clock::now();
+  rollup.add(holder.aggregate(), t0);
+  EXPECT_GT(rollup.numCounters(), 0);
+
+  STAT_ADD(&holder, client.append_success, 3);
+  auto closed = rollup.add(holder.aggregate(), t0 + seconds(1));
+  ASSERT_EQ(1, closed.size());
+  bool found = false;
+  for (const auto& change : closed[0]->changes) {
+    if (*change.name == "append_success") {
+      EXPECT_EQ(3, change.delta);
+      found = true;
+    }
+  }
+  EXPECT_TRUE(found);
+}
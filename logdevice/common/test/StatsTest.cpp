@@ -11,6 +11,7 @@
 #include <atomic>
 #include <condition_variable>
 #include <mutex>
+#include <string>
 #include <thread>
 #include <unistd.h>
 #include <vector>
@@ -22,6 +23,7 @@
 #include <gtest/gtest.h>
 
 #include "logdevice/common/ClientID.h"
+#include "logdevice/common/PrincipalIdentity.h"
 #include "logdevice/common/Semaphore.h"
 #include "logdevice/common/stats/ClientHistograms.h"
 #include "logdevice/common/stats/Histogram.h"
@@ -57,6 +59,113 @@ TEST(StatsTest, StatsAggregateTest) {
   EXPECT_EQ(2, total.records_delivered);
 }
 
+// Per-log-group stats of several threads, spanning several chunks of
+// PerLogStatsSlab, are aggregated and reset.
+TEST(StatsTest, PerLogStatsAggregateTest) {
+  StatsHolder holder(StatsParams().setIsServer(true));
+  constexpr int nlogs = 1000;
+  auto log_group = [](int i) { return "/log_group_" + std::to_string(i); };
+
+  std::thread thread([&] {
+    for (int i = 0; i < nlogs; ++i) {
+      LOG_GROUP_STAT_ADD(&holder, log_group(i), append_success, i);
+    }
+  });
+  thread.join();
+  for (int i = 0; i < nlogs; i += 2) {
+    LOG_GROUP_STAT_ADD(&holder, log_group(i), append_success, 1);
+  }
+  EXPECT_EQ(nlogs / 2, holder.get().per_log_stats_slab->size());
+
+  Stats total = holder.aggregate();
+  {
+    auto per_log = total.per_log_stats.rlock();
+    ASSERT_EQ(nlogs, per_log->size());
+    for (int i = 0; i < nlogs; ++i) {
+      EXPECT_EQ(i + (i % 2 == 0), per_log->at(log_group(i))->append_success);
+    }
+  }
+  EXPECT_EQ(nlogs, total.per_log_stats_slab->size());
+
+  holder.reset();
+  total = holder.aggregate();
+  EXPECT_TRUE(total.per_log_stats.rlock()->empty());
+
+  LOG_GROUP_STAT_ADD(&holder, log_group(1), append_success, 5);
+  total = holder.aggregate();
+  EXPECT_EQ(1, total.per_log_stats.rlock()->size());
+  EXPECT_EQ(5, total.per_log_stats.rlock()->at(log_group(1))->append_success);
+}
+
+// End-to-end latency histograms of several threads are aggregated per log
+// group, and cleared on reset.
+TEST(StatsTest, PerLogGroupE2ELatencyTest) {
+  StatsHolder holder(StatsParams().setIsServer(false));
+
+  std::thread thread([&] {
+    LOG_GROUP_E2E_LATENCY_ADD(&holder, "/a", tailing, 1000);
+    LOG_GROUP_E2E_LATENCY_ADD(&holder, "/b", backfill, 5000000);
+  });
+  thread.join();
+  LOG_GROUP_E2E_LATENCY_ADD(&holder, "/a", tailing, 2000);
+
+  Stats total = holder.aggregate();
+  {
+    auto per_log_group = total.per_log_group_e2e_stats.rlock();
+    ASSERT_EQ(2, per_log_group->size());
+    const auto& a = *per_log_group->at("/a").histograms;
+    EXPECT_EQ(2, a.tailing.getCountAndSum().first);
+    EXPECT_EQ(0, a.backfill.getCountAndSum().first);
+    const auto& b = *per_log_group->at("/b").histograms;
+    EXPECT_EQ(0, b.tailing.getCountAndSum().first);
+    EXPECT_EQ(1, b.backfill.getCountAndSum().first);
+  }
+
+  holder.reset();
+  total = holder.aggregate();
+  EXPECT_TRUE(total.per_log_group_e2e_stats.rlock()->empty());
+}
+
+// Per-client resource accounting is kept by both principal and client host,
+// with "UNKNOWN" for requests without a principal.
+TEST(StatsTest, PerClientHeavyHittersTest) {
+  StatsHolder holder(
+      StatsParams().setIsServer(true).setPerClientStatsTopK(10));
+  PrincipalIdentity alice("USER", std::make_pair("USER", "alice"));
+  alice.client_address = "10.0.0.1";
+
+  CLIENT_RESOURCE_ADD(&holder, read_bytes, &alice, 100);
+  CLIENT_RESOURCE_ADD(&holder, read_bytes, nullptr, 7);
+  CLIENT_RESOURCE_ADD(&holder, read_bytes, &alice, 50);
+
+  const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now().time_since_epoch());
+  const size_t idx = static_cast<size_t>(ClientResource::read_bytes);
+  auto total = [&](PerClientHeavyHitters::Dimension dim) {
+    std::unordered_map<std::string, double> res;
+    holder.runForEach([&](Stats& s) {
+      std::lock_guard<std::mutex> guard(s.per_client_heavy_hitters.mutex);
+      const auto& hh = s.per_client_heavy_hitters.series[dim][idx];
+      if (hh) {
+        for (const auto& kv : hh->rates({hh->getSpan()}, now)) {
+          res[kv.first] += kv.second[0];
+        }
+      }
+    });
+    return res;
+  };
+
+  auto by_principal = total(PerClientHeavyHitters::PRINCIPAL);
+  ASSERT_EQ(2, by_principal.size());
+  EXPECT_GT(by_principal["USER:alice"], by_principal["UNKNOWN"]);
+  auto by_client = total(PerClientHeavyHitters::CLIENT);
+  ASSERT_EQ(2, by_client.size());
+  EXPECT_GT(by_client["10.0.0.1"], by_client["UNKNOWN"]);
+
+  holder.reset();
+  EXPECT_TRUE(total(PerClientHeavyHitters::PRINCIPAL).empty());
+}
+
 // This test creates N threads, each of which increments num_connections and
 // store_synced stats. Before threads exit, test asserts that both
 // aggregated counters are N. After threads exit, test that
@@ -310,6 +419,84 @@ TEST(StatsTest, CompactLatencyHistogramShouldGetCumulativeFrequencyCounters) {
   ASSERT_EQ(expected_result2, frequency_counters2);
 }
 
+TEST(StatsTest, SketchHistogramBuckets) {
+  const size_t last = SketchHistogram::NUM_BUCKETS - 1;
+  ASSERT_EQ(0, SketchHistogram::valueToIndex(-5));
+  ASSERT_EQ(0, SketchHistogram::valueToIndex(0));
+  ASSERT_EQ(63, SketchHistogram::valueToIndex(63));
+  ASSERT_EQ(last,
+            SketchHistogram::valueToIndex(std::numeric_limits<int64_t>::max()));
+  ASSERT_EQ(std::numeric_limits<int64_t>::max(),
+            SketchHistogram::indexToMax(last));
+
+  // Buckets are contiguous and at most 1/32 of their values wide.
+  for (size_t i = 0; i < last; ++i) {
+    int64_t min = SketchHistogram::indexToMin(i);
+    int64_t max = SketchHistogram::indexToMax(i);
+    ASSERT_LE(min, max);
+    ASSERT_LE(max - min, min / 32);
+    ASSERT_EQ(max + 1, SketchHistogram::indexToMin(i + 1));
+    ASSERT_EQ(i, SketchHistogram::valueToIndex(min));
+    ASSERT_EQ(i, SketchHistogram::valueToIndex(max));
+  }
+}
+
+TEST(StatsTest, SketchHistogramPercentiles) {
+  SketchLatencyHistogram hist;
+  int64_t sum = 0;
+  for (int64_t v = 1; v <= 1000000; ++v) {
+    hist.add(v);
+    sum += v;
+  }
+  std::array<double, 5> pct = {0, .5, .9, .999, 1};
+  std::array<int64_t, 5> out;
+  uint64_t count;
+  int64_t hist_sum;
+  hist.estimatePercentiles(
+      pct.data(), pct.size(), out.data(), &count, &hist_sum);
+  EXPECT_EQ(1000000, count);
+  EXPECT_EQ(sum, hist_sum);
+  for (size_t i = 0; i < pct.size(); ++i) {
+    double expected = std::max(1., pct[i] * 1000000);
+    EXPECT_NEAR(expected, out[i], expected / 32) << pct[i];
+  }
+}
+
+TEST(StatsTest, SketchHistogramMergeAndSerialize) {
+  SketchLatencyHistogram a, b;
+  for (int64_t v : {0l, 7l, 1000l, 1001l, 123456789l}) {
+    a.add(v);
+  }
+  for (int64_t v : {7l, 5000000000l}) {
+    b.add(v);
+  }
+
+  SketchLatencyHistogram merged(a);
+  merged.merge(b);
+  EXPECT_EQ(std::make_pair(uint64_t(7), int64_t(5123458804l)),
+            merged.getCountAndSum());
+  EXPECT_EQ(0, merged.estimatePercentile(0));
+  EXPECT_EQ(7, merged.estimatePercentile(.4));
+
+  // The serialized form is lossless.
+  SketchLatencyHistogram parsed;
+  ASSERT_TRUE(parsed.fromShortString(merged.toShortString()));
+  EXPECT_EQ(merged.toShortString(), parsed.toShortString());
+  EXPECT_EQ(merged.getCountAndSum(), parsed.getCountAndSum());
+
+  parsed.subtract(b);
+  EXPECT_EQ(a.toShortString(), parsed.toShortString());
+
+  parsed.clear();
+  EXPECT_EQ("", parsed.toShortString());
+  EXPECT_TRUE(parsed.fromShortString(""));
+  EXPECT_FALSE(parsed.fromShortString("10;3:1,3:2"));
+  EXPECT_FALSE(parsed.fromShortString("10;5:1,3:2"));
+  EXPECT_FALSE(parsed.fromShortString("10;100000:1"));
+  EXPECT_FALSE(parsed.fromShortString("3:1"));
+  EXPECT_EQ("", parsed.toShortString());
+}
+
 TEST(StatsTest, PerNodeTimeSeriesSingleThread) {
   StatsHolder holder(
       StatsParams().setIsServer(false).setNodeStatsRetentionTimeOnClients(
@@ -0,0 +1,44 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/StorageSetRegistry.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+
+TEST(StorageSetRegistryTest, SharesEqualSets) {
+  StorageSetRegistry registry;
+  const StorageSet a{ShardID(1, 0), ShardID(2, 0), ShardID(3, 1)};
+  const StorageSet b{ShardID(1, 0), ShardID(2, 0), ShardID(3, 0)};
+
+  auto p1 = registry.intern(a);
+  auto p2 = registry.intern(StorageSet(a));
+  auto p3 = registry.intern(b);
+  EXPECT_EQ(p1.get(), p2.get());
+  EXPECT_NE(p1.get(), p3.get());
+  EXPECT_EQ(a, *p1);
+  EXPECT_EQ(b, *p3);
+  EXPECT_EQ(2, registry.size());
+}
+
+TEST(StorageSetRegistryTest, FreesUnusedSets) {
+  StorageSetRegistry registry;
+  const StorageSet a{ShardID(1, 0), ShardID(2, 0)};
+
+  auto p1 = registry.intern(a);
+  auto p2 = registry.intern(a);
+  p1.reset();
+  EXPECT_EQ(1, registry.size());
+  p2.reset();
+  EXPECT_EQ(0, registry.size());
+
+  // Interning it again after it was freed gives a new copy.
+  auto p3 = registry.intern(a);
+  EXPECT_EQ(a, *p3);
+  EXPECT_EQ(1, registry.size());
+}
@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/TailInfoCache.h"
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+using namespace std::literals::chrono_literals;
+
+namespace {
+
+class TestTailInfoCache : public TailInfoCache {
+ public:
+  TimePoint time{std::chrono::hours(1)};
+
+ protected:
+  TimePoint now() const override {
+    return time;
+  }
+};
+
+const logid_t LOG(1);
+
+} // namespace
+
+TEST(TailInfoCacheTest, Expiry) {
+  TestTailInfoCache cache;
+  EXPECT_FALSE(cache.getNextLSN(LOG, 1s).has_value());
+
+  cache.update(LOG, lsn_t(42), nullptr, folly::none, 1s);
+  EXPECT_EQ(lsn_t(42), cache.getNextLSN(LOG, 1s).value());
+  // Only the fields included in the reply were cached.
+  EXPECT_EQ(nullptr, cache.getTailAttributes(LOG, 1s));
+  EXPECT_FALSE(cache.getIsLogEmpty(LOG, 1s).has_value());
+
+  cache.time += 500ms;
+  EXPECT_TRUE(cache.getNextLSN(LOG, 1s).has_value());
+  EXPECT_FALSE(cache.getNextLSN(LOG, 200ms).has_value());
+  cache.time += 500ms;
+  EXPECT_FALSE(cache.getNextLSN(LOG, 1s).has_value());
+}
+
+TEST(TailInfoCacheTest, FieldsAgeIndependently) {
+  TestTailInfoCache cache;
+  LogTailAttributes attrs(lsn_t(10), 123ms, RecordOffset());
+  cache.update(LOG, lsn_t(11), &attrs, false, 1s);
+
+  cache.time += 600ms;
+  cache.update(LOG, lsn_t(12), nullptr, folly::none, 1s);
+
+  cache.time += 600ms;
+  EXPECT_EQ(lsn_t(12), cache.getNextLSN(LOG, 1s).value());
+  EXPECT_EQ(nullptr, cache.getTailAttributes(LOG, 1s));
+  EXPECT_FALSE(cache.getIsLogEmpty(LOG, 1s).has_value());
+
+  auto cached = cache.getTailAttributes(LOG, 2s);
+  ASSERT_NE(nullptr, cached);
+  EXPECT_EQ(lsn_t(10), cached->last_released_real_lsn);
+  EXPECT_EQ(false, cache.getIsLogEmpty(LOG, 2s).value());
+
+  cache.invalidate(LOG);
+  EXPECT_FALSE(cache.getNextLSN(LOG, 2s).has_value());
+}
@@ -0,0 +1,63 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/common/ThreadLocalFreeList.h"
+
+#include <thread>
+
+#include <gtest/gtest.h>
+
+namespace facebook { namespace logdevice {
+
+namespace {
+struct Foo {
+  char data[64];
+};
+using FooList = ThreadLocalFreeList<Foo>;
+} // namespace
+
+TEST(ThreadLocalFreeListTest, ReusesFreedBlocks) {
+  EXPECT_EQ(nullptr, FooList::get());
+
+  void* a = ::operator new(sizeof(Foo));
+  void* b = ::operator new(sizeof(Foo));
+  EXPECT_TRUE(FooList::put(a, 2));
+  EXPECT_TRUE(FooList::put(b, 2));
+  EXPECT_EQ(2, FooList::size());
+
+  // Full.
+  void* c = ::operator new(sizeof(Foo));
+  EXPECT_FALSE(FooList::put(c, 2));
+  ::operator delete(c);
+
+  // LIFO, so the most recently freed (and likely hot in cache) block is
+  // reused first.
+  EXPECT_EQ(b, FooList::get());
+  EXPECT_EQ(a, FooList::get());
+  EXPECT_EQ(nullptr, FooList::get());
+  EXPECT_EQ(0, FooList::size());
+  ::operator delete(a);
+  ::operator delete(b);
+}
+
+TEST(ThreadLocalFreeListTest, PerThread) {
+  void* a = ::operator new(sizeof(Foo));
+  EXPECT_TRUE(FooList::put(a, 10));
+
+  std::thread([] {
+    EXPECT_EQ(0, FooList::size());
+    EXPECT_EQ(nullptr, FooList::get());
+    // Freed when the thread exits.
+    EXPECT_TRUE(FooList::put(::operator new(sizeof(Foo)), 10));
+  }).join();
+
+  EXPECT_EQ(1, FooList::size());
+  EXPECT_EQ(1, FooList::clear());
+  EXPECT_EQ(0, FooList::size());
+}
+
+}} // namespace facebook::logdevice
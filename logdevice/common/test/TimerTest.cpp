@@ -136,3 +136,71 @@ TEST(Timer, RaceConditionInDestroy) {
   folly::Baton<> baton;
   baton.try_wait_for(1s);
 }
+
+TEST(Timer, EventLoopWheel) {
+  Settings settings = create_default_settings<Settings>();
+  settings.num_workers = 1;
+  settings.enable_event_loop_wheel_timers = true;
+  auto processor = make_test_processor(settings);
+
+  auto promise = std::make_shared<folly::Promise<int>>();
+  auto ready = promise->getSemiFuture();
+
+  folly::Synchronized<std::vector<Timer>> vec;
+  vec.wlock()->reserve(6);
+
+  std::unique_ptr<Request> request =
+      std::make_unique<CallbackRequest>([promise, &vec] {
+        auto nfired = std::make_shared<std::atomic<int>>(0);
+        auto tstart = steady_clock::now();
+        // delays are rounded to the 10ms tick of the wheel
+        auto assert_passed = [tstart](milliseconds ms) {
+          ASSERT_GE(steady_clock::now() - tstart, ms - 10ms);
+        };
+
+        vec.wlock()->emplace_back([nfired, assert_passed] {
+          ++*nfired;
+          assert_passed(0ms);
+        });
+        vec.wlock()->back().activate(0ms);
+
+        // cancelling a zero delay activation
+        vec.wlock()->emplace_back([] { FAIL() << "timer not cancelled"; });
+        vec.wlock()->back().activate(0ms);
+        EXPECT_TRUE(vec.wlock()->back().isActive());
+        vec.wlock()->back().cancel();
+        EXPECT_FALSE(vec.wlock()->back().isActive());
+
+        vec.wlock()->emplace_back([] { FAIL() << "timer not cancelled"; });
+        vec.wlock()->back().activate(50ms);
+        vec.wlock()->back().cancel();
+
+        // reactivation replaces the previous activation
+        vec.wlock()->emplace_back([nfired, assert_passed] {
+          ++*nfired;
+          assert_passed(100ms);
+        });
+        vec.wlock()->back().activate(0ms);
+        vec.wlock()->back().activate(10ms);
+        vec.wlock()->back().activate(100ms);
+
+        // a timer can reactivate itself from its callback
+        auto nrepeats = std::make_shared<int>(0);
+        vec.wlock()->emplace_back([nfired, nrepeats, &vec] {
+          if (++*nrepeats < 3) {
+            (*vec.wlock())[4].activate(20ms);
+          } else {
+            ++*nfired;
+          }
+        });
+        vec.wlock()->back().activate(20ms);
+
+        vec.wlock()->emplace_back(
+            [nfired, promise] { promise->setValue(*nfired); });
+        vec.wlock()->back().activate(1s);
+      });
+
+  ASSERT_EQ(processor->postRequest(request), 0);
+  std::move(ready).wait();
+  ASSERT_EQ(ready.value(), 3);
+}
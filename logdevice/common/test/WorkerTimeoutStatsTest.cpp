@@ -84,4 +84,41 @@ TEST(WorkerTimeoutStatsTest, StressTest) {
   }
 }
 
+TEST(WorkerTimeoutStatsTest, ShardLatencyEWMA) {
+  MockWorkerTimeoutStats stats;
+  ShardID shard_id{1, 1};
+  STORE_Header store_hdr{};
+  store_hdr.rid = RecordID{1, logid_t{1}};
+  store_hdr.wave = 1;
+
+  auto reply_after = [&](steady_clock::time_point sent, milliseconds rtt) {
+    stats.onCopySent(Status::OK, shard_id, store_hdr, sent);
+    stats.onReply(shard_id, store_hdr, sent + rtt);
+    store_hdr.wave++;
+  };
+
+  auto t = steady_clock::now();
+  ASSERT_FALSE(stats.getStoreLatencyEWMA(shard_id, t).has_value());
+  reply_after(t, 10ms);
+  EXPECT_DOUBLE_EQ(10, stats.getStoreLatencyEWMA(shard_id, t + 10ms).value());
+  // Other shards of the same node are tracked separately.
+  EXPECT_FALSE(stats.getStoreLatencyEWMA(ShardID{1, 2}, t).has_value());
+
+  // The shard becomes slow, the average follows.
+  for (int i = 0; i < 30; ++i) {
+    t += 1ms;
+    reply_after(t, 1000ms);
+  }
+  auto latency = stats.getStoreLatencyEWMA(shard_id, t + 1s);
+  ASSERT_TRUE(latency.has_value());
+  EXPECT_GT(latency.value(), 900);
+  EXPECT_LT(latency.value(), 1000);
+
+  // Old averages are forgotten.
+  EXPECT_FALSE(stats.getStoreLatencyEWMA(shard_id, t + 1min).has_value());
+  reply_after(t + 1min, 5ms);
+  EXPECT_DOUBLE_EQ(
+      5, stats.getStoreLatencyEWMA(shard_id, t + 1min + 5ms).value());
+}
+
 }} // namespace facebook::logdevice
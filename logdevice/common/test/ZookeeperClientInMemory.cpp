@@ -229,16 +229,37 @@ int ZookeeperClientInMemory::multiOp(int count,
         } else {
           return fill_result(ZNONODE);
         }
+      } else if (ops[i].type == ZOO_SETDATA_OP) {
+        const auto& op = ops[i].set_op;
+        auto it = new_map.find(op.path);
+        if (it == new_map.end()) {
+          return fill_result(ZNONODE);
+        }
+        auto old_version = it->second.second.version_;
+        if (old_version != op.version && op.version != -1) {
+          return fill_result(ZBADVERSION);
+        }
+        it->second = std::make_pair(
+            std::string(op.data, op.datalen),
+            zk::Stat{.version_ = old_version + 1, .mtime_ = mtime});
       } else {
         // no other ops supported currently
-        ld_critical("Only create/delete operations supported in multi-ops");
+        ld_critical(
+            "Only create/delete/set operations supported in multi-ops");
         ld_check(false);
         return -1;
       }
     }
 
     std::swap(map_, new_map);
-    return fill_result(ZOK);
+    fill_result(ZOK);
+    for (int i = 0; i < count; ++i) {
+      if (ops[i].type == ZOO_SETDATA_OP && ops[i].set_op.stat) {
+        *ops[i].set_op.stat = toCStat(map_[ops[i].set_op.path].second);
+        results[i].stat = ops[i].set_op.stat;
+      }
+    }
+    return ZOK;
   };
   int rv = locked_operations();
 
@@ -0,0 +1,564 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/Singleton.h>
+#include <folly/io/IOBuf.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/common/Appender.h"
+#include "logdevice/common/EpochMetaData.h"
+#include "logdevice/common/EpochSequencer.h"
+#include "logdevice/common/NodeSetState.h"
+#include "logdevice/common/PassThroughCopySetManager.h"
+#include "logdevice/common/Processor.h"
+#include "logdevice/common/Semaphore.h"
+#include "logdevice/common/Sender.h"
+#include "logdevice/common/Timer.h"
+#include "logdevice/common/WeightedCopySetSelector.h"
+#include "logdevice/common/Worker.h"
+#include "logdevice/common/configuration/UpdateableConfig.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/protocol/Compatibility.h"
+#include "logdevice/common/protocol/ProtocolWriter.h"
+#include "logdevice/common/protocol/STORED_Message.h"
+#include "logdevice/common/protocol/STORE_Message.h"
+#include "logdevice/common/request_util.h"
+#include "logdevice/common/test/CopySetSelectorTestUtil.h"
+#include "logdevice/common/test/TestUtil.h"
+
+using namespace facebook::logdevice;
+
+/**
+ * @file Sequencer-side CPU cost of an append without a cluster: real
+ *       EpochSequencer, Appender, copyset selection (WeightedCopySetSelector
+ *       behind a PassThroughCopySetManager) and STORE/RELEASE serialization
+ *       with ProtocolWriter, against an in-process fake node set. The fake
+ *       storage nodes reply STORED after a log-normally distributed delay,
+ *       so replies arrive out of order and appends overlap in the sliding
+ *       window the same way they do in production.
+ *
+ *       Each worker keeps --append_path_window appends in flight on its own
+ *       EpochSequencer. The time per iteration is the time per append, and
+ *       the number of heap allocations per append on worker threads is
+ *       printed after each benchmark (counted by the operator new below,
+ *       so only in the standalone binary).
+ *
+ *       Run with --bm_min_usec=1000000. To catch regressions per commit,
+ *       compare allocations per append too, they're much less noisy than
+ *       time.
+ */
+
+DEFINE_int32(append_path_window,
+             256,
+             "Appends in flight per worker (sliding window size).");
+DEFINE_int32(append_path_nodeset_size, 20, "Number of fake storage nodes.");
+DEFINE_int32(append_path_payload_size, 1000, "Payload size in bytes.");
+DEFINE_int32(append_path_store_latency_median_us,
+             500,
+             "Median delay before a fake storage node replies STORED.");
+DEFINE_double(append_path_store_latency_sigma,
+              0.5,
+              "Sigma of the log-normal distribution of STORED delays. 0 "
+              "makes all delays equal to the median.");
+
+namespace {
+
+#ifndef BENCHMARK_BUNDLE
+thread_local uint64_t allocations_on_this_thread = 0;
+#endif
+
+uint64_t allocationsOnThisThread() {
+#ifndef BENCHMARK_BUNDLE
+  return allocations_on_this_thread;
+#else
+  return 0;
+#endif
+}
+
+class AppendPathBenchmark;
+
+class BenchEpochSequencer : public EpochSequencer {
+ public:
+  BenchEpochSequencer(Processor* processor,
+                      logid_t log_id,
+                      epoch_t epoch,
+                      const EpochSequencerImmutableOptions& options)
+      : EpochSequencer(log_id,
+                       epoch,
+                       std::make_unique<EpochMetaData>(),
+                       options,
+                       /* parent */ nullptr),
+        processor_(processor) {}
+
+  bool updateLastReleased(lsn_t /* reaped_lsn */,
+                          epoch_t* /* last_released_epoch_out */) override {
+    return true;
+  }
+
+  void noteDrainingCompleted(Status /* drain_status */) override {}
+
+  Processor* getProcessor() const override {
+    return processor_;
+  }
+
+ private:
+  Processor* const processor_;
+};
+
+/**
+ * Appends of one worker and the fake storage nodes' responses that are yet
+ * to be delivered to them. Only accessed on the worker thread.
+ */
+class WorkerState {
+ public:
+  WorkerState(AppendPathBenchmark* bench,
+              std::shared_ptr<EpochSequencer> epoch_sequencer,
+              uint64_t appends_to_do)
+      : bench_(bench),
+        epoch_sequencer_(std::move(epoch_sequencer)),
+        appends_to_do_(appends_to_do),
+        latency_us_(std::log(FLAGS_append_path_store_latency_median_us),
+                    FLAGS_append_path_store_latency_sigma),
+        timer_([this] { deliverResponses(); }) {}
+
+  void start() {
+    allocations_at_start_ = allocationsOnThisThread();
+    startAppends();
+    maybeFinish();
+  }
+
+  // Called by the fake Sender for every STORE.
+  void onStoreSent(const STORE_Header& header, ShardID shard);
+
+  // Called when an Appender is reaped, or fails to start.
+  void onAppendDone() {
+    ld_check(in_flight_ > 0);
+    --in_flight_;
+    ++appends_done_;
+  }
+
+  AppendPathBenchmark* bench() const {
+    return bench_;
+  }
+
+  // Posted when all appends are done.
+  Semaphore finished;
+  uint64_t allocations = 0;
+  uint64_t appends_failed = 0;
+
+ private:
+  struct Response {
+    std::chrono::steady_clock::time_point due;
+    // If false, this is the socket confirming that the STORE was sent,
+    // otherwise it's the STORED reply.
+    bool stored;
+    STORE_Header header;
+    ShardID shard;
+
+    bool operator>(const Response& other) const {
+      return due > other.due;
+    }
+  };
+
+  AppendPathBenchmark* const bench_;
+  std::shared_ptr<EpochSequencer> epoch_sequencer_;
+  const uint64_t appends_to_do_;
+  uint64_t appends_started_ = 0;
+  uint64_t appends_done_ = 0;
+  int in_flight_ = 0;
+  uint64_t allocations_at_start_ = 0;
+  bool finished_posted_ = false;
+  std::mt19937_64 rng_{0xbe7c};
+  std::lognormal_distribution<double> latency_us_;
+  std::priority_queue<Response, std::vector<Response>, std::greater<Response>>
+      responses_;
+  Timer timer_;
+
+  // Starts appends until the window is full or all appends are started.
+  void startAppends();
+  void deliverResponses();
+  void scheduleResponse(Response response);
+  // Activates the timer for the earliest response.
+  void activateTimer();
+  // Posts `finished` if all appends are done.
+  void maybeFinish();
+};
+
+class BenchAppender : public Appender {
+ public:
+  using MockSender = SenderTestProxy<BenchAppender>;
+
+  BenchAppender(WorkerState* state, logid_t log_id, PayloadHolder payload)
+      : Appender(Worker::onThisThread(),
+                 Worker::onThisThread()->getTraceLogger(),
+                 std::chrono::seconds(10), // client timeout
+                 request_id_t(0),
+                 STORE_flags_t(0),
+                 log_id,
+                 std::move(payload),
+                 epoch_t(0),
+                 FLAGS_append_path_payload_size),
+        state_(state) {
+    sender_ = std::make_unique<MockSender>(this);
+  }
+
+  ~BenchAppender() override {
+    state_->onAppendDone();
+  }
+
+  // Serializes the message the way Connection does, then hands STOREs to
+  // the fake storage nodes.
+  int sendMessageImpl(std::unique_ptr<Message>&& msg,
+                      const Address& addr,
+                      BWAvailableCallback*,
+                      SocketCallback*) {
+    auto iobuf = folly::IOBuf::create(IOBUF_ALLOCATION_UNIT);
+    ProtocolWriter writer(
+        msg->type_, iobuf.get(), Compatibility::MAX_PROTOCOL_SUPPORTED);
+    msg->serialize(writer);
+    folly::doNotOptimizeAway(writer.computeChecksum());
+
+    if (msg->type_ == MessageType::STORE && !addr.isClientAddress()) {
+      const auto* store = static_cast<const STORE_Message*>(msg.get());
+      const STORE_Header& header = store->getHeader();
+      state_->onStoreSent(
+          header, store->getCopyset()[header.copyset_offset].destination);
+    }
+    return 0;
+  }
+
+  bool canSendToImpl(const Address&, TrafficClass, BWAvailableCallback&) {
+    return true;
+  }
+
+  std::shared_ptr<CopySetManager> getCopySetManager() const override;
+
+  NodeID checkIfPreempted(epoch_t /* epoch */) override {
+    return NodeID();
+  }
+  bool epochMetaDataAvailable(epoch_t /* epoch */) const override {
+    return true;
+  }
+  bool checkNodeSet() const override {
+    return true;
+  }
+  void schedulePeriodicReleases() override {}
+  int registerOnSocketClosed(NodeID /* nid */,
+                             SocketCallback& /* cb */) override {
+    return 0;
+  }
+  NodeLocationScope getCurrentBiggestReplicationScope() const override {
+    return NodeLocationScope::NODE;
+  }
+
+ private:
+  WorkerState* const state_;
+};
+
+class AppendPathBenchmark {
+ public:
+  struct Params {
+    uint64_t num_appends;
+    int nworkers{1};
+    int replication{3};
+  };
+
+  explicit AppendPathBenchmark(Params params);
+
+  // Runs the appends and blocks until they're all done.
+  void run();
+
+  // Shuts down the workers and prints allocations per append.
+  void shutdown();
+
+  const std::shared_ptr<CopySetManager>& copysetManager() const {
+    return copyset_manager_;
+  }
+
+  PayloadHolder payload() const {
+    return PayloadHolder::copyString(payload_);
+  }
+
+ private:
+  static constexpr logid_t LOG_ID{1};
+
+  const Params params_;
+  const std::string payload_;
+  Settings settings_;
+  std::shared_ptr<UpdateableConfig> updateable_config_;
+  TestCopySetSelectorDeps deps_;
+  std::shared_ptr<CopySetManager> copyset_manager_;
+  std::shared_ptr<Processor> processor_;
+  std::vector<std::unique_ptr<WorkerState>> states_;
+};
+
+constexpr logid_t AppendPathBenchmark::LOG_ID;
+
+std::shared_ptr<CopySetManager> BenchAppender::getCopySetManager() const {
+  return state_->bench()->copysetManager();
+}
+
+void WorkerState::startAppends() {
+  while (in_flight_ < FLAGS_append_path_window &&
+         appends_started_ < appends_to_do_) {
+    ++appends_started_;
+    ++in_flight_;
+    auto appender = std::make_unique<BenchAppender>(
+        this, epoch_sequencer_->getLogID(), bench_->payload());
+    if (epoch_sequencer_->runAppender(appender.get()) ==
+        RunAppenderStatus::SUCCESS_KEEP) {
+      // Deleted when reaped.
+      appender.release();
+    } else {
+      ++appends_failed;
+      // Deleting the appender counts it as done. If others are in flight,
+      // start more once some of them are reaped.
+      appender.reset();
+      if (in_flight_ > 0) {
+        break;
+      }
+    }
+  }
+}
+
+void WorkerState::onStoreSent(const STORE_Header& header, ShardID shard) {
+  const auto now = std::chrono::steady_clock::now();
+  scheduleResponse({now, false, header, shard});
+  scheduleResponse(
+      {now +
+           std::chrono::microseconds(
+               static_cast<int64_t>(latency_us_(rng_))),
+       true,
+       header,
+       shard});
+}
+
+void WorkerState::scheduleResponse(Response response) {
+  const bool earliest =
+      responses_.empty() || response.due < responses_.top().due;
+  responses_.push(std::move(response));
+  if (earliest) {
+    activateTimer();
+  }
+}
+
+void WorkerState::activateTimer() {
+  timer_.activate(
+      std::max(std::chrono::microseconds(0),
+               std::chrono::duration_cast<std::chrono::microseconds>(
+                   responses_.top().due - std::chrono::steady_clock::now())));
+}
+
+void WorkerState::maybeFinish() {
+  if (appends_done_ >= appends_to_do_ && !finished_posted_) {
+    finished_posted_ = true;
+    allocations = allocationsOnThisThread() - allocations_at_start_;
+    finished.post();
+  }
+}
+
+void WorkerState::deliverResponses() {
+  const auto now = std::chrono::steady_clock::now();
+  AppenderMap& appenders = Worker::onThisThread()->activeAppenders();
+  while (!responses_.empty() && responses_.top().due <= now) {
+    const Response r = responses_.top();
+    responses_.pop();
+    // Like STORED_Message::onReceived(), look the Appender up: it may have
+    // been reaped already.
+    Appender* appender = appenders.map.find(r.header.rid);
+    if (appender == nullptr) {
+      continue;
+    }
+    if (!r.stored) {
+      appender->onCopySent(E::OK, r.shard, r.header);
+      continue;
+    }
+    STORED_Header reply;
+    reply.rid = r.header.rid;
+    reply.wave = r.header.wave;
+    reply.status = E::OK;
+    reply.redirect = NodeID();
+    reply.flags = 0;
+    reply.shard = r.shard.shard();
+    appender->onReply(reply, r.shard);
+  }
+
+  startAppends();
+  if (!responses_.empty()) {
+    activateTimer();
+  }
+  maybeFinish();
+}
+
+AppendPathBenchmark::AppendPathBenchmark(Params params)
+    : params_(params),
+      payload_(FLAGS_append_path_payload_size, 'c'),
+      settings_(create_default_settings<Settings>()) {
+  settings_.server = true;
+  settings_.num_workers = params_.nworkers;
+  // One STORE per recipient, like most production appends.
+  settings_.disable_chain_sending = true;
+  // TODO the following 2 settings are required to make the NCPublisher pick
+  // the NCM NodesConfiguration. Should be removed when NCM is the default.
+  settings_.enable_nodes_configuration_manager = true;
+  settings_.use_nodes_configuration_manager_nodes_configuration = true;
+
+  auto nodes_configuration =
+      createSimpleNodesConfig(FLAGS_append_path_nodeset_size);
+  updateable_config_ = std::make_shared<UpdateableConfig>(
+      Configuration::fromJsonFile(TEST_CONFIG_FILE("sequencer_test.conf")));
+  updateable_config_->updateableNCMNodesConfiguration()->update(
+      nodes_configuration);
+
+  StorageSet shards;
+  for (node_index_t i = 0; i < FLAGS_append_path_nodeset_size; ++i) {
+    shards.emplace_back(i, 0);
+  }
+  auto nodeset_state = std::make_shared<NodeSetState>(
+      shards, LOG_ID, NodeSetState::HealthCheck::DISABLED);
+  EpochMetaData metadata(
+      shards,
+      ReplicationProperty({{NodeLocationScope::NODE, params_.replication}}));
+  std::unique_ptr<CopySetSelector> selector =
+      std::make_unique<WeightedCopySetSelector>(LOG_ID,
+                                                metadata,
+                                                nodeset_state,
+                                                nodes_configuration,
+                                                folly::none, // my_node_id
+                                                nullptr,     // log_attrs
+                                                false, // locality_enabled
+                                                nullptr, // stats
+                                                DefaultRNG::get(),
+                                                false, // print_bias_warnings
+                                                &deps_);
+  copyset_manager_ = std::make_shared<PassThroughCopySetManager>(
+      std::move(selector), nodeset_state);
+
+  processor_ = make_test_processor(
+      settings_, updateable_config_, /* stats */ nullptr, NodeID(1, 1));
+  ld_check(processor_ != nullptr);
+
+  EpochSequencerImmutableOptions options;
+  options.window_size = FLAGS_append_path_window;
+  states_.resize(params_.nworkers);
+  for (int i = 0; i < params_.nworkers; ++i) {
+    const uint64_t appends = params_.num_appends / params_.nworkers +
+        (uint64_t(i) < params_.num_appends % params_.nworkers ? 1 : 0);
+    run_on_worker(processor_.get(), i, [&] {
+      // Different epochs so that record ids differ between workers.
+      states_[i] = std::make_unique<WorkerState>(
+          this,
+          std::make_shared<BenchEpochSequencer>(
+              processor_.get(), LOG_ID, epoch_t(i + 1), options),
+          appends);
+      return 0;
+    });
+  }
+}
+
+void AppendPathBenchmark::run() {
+  for (int i = 0; i < params_.nworkers; ++i) {
+    run_on_worker(processor_.get(), i, [&] {
+      states_[i]->start();
+      return 0;
+    });
+  }
+  for (auto& state : states_) {
+    state->finished.wait();
+  }
+}
+
+void AppendPathBenchmark::shutdown() {
+  uint64_t allocations = 0;
+  uint64_t failed = 0;
+  for (int i = 0; i < params_.nworkers; ++i) {
+    allocations += states_[i]->allocations;
+    failed += states_[i]->appends_failed;
+    // Timers must be destroyed on their worker.
+    run_on_worker(processor_.get(), i, [&] {
+      states_[i].reset();
+      return 0;
+    });
+  }
+  gracefully_shutdown_processor(processor_.get());
+  processor_.reset();
+
+#ifndef BENCHMARK_BUNDLE
+  printf("%lu appends on %d workers, R%d: %.1f allocations per append, %lu "
+         "appends rejected\n",
+         params_.num_appends,
+         params_.nworkers,
+         params_.replication,
+         double(allocations) / std::max<uint64_t>(1, params_.num_appends),
+         failed);
+#endif
+}
+
+size_t runBenchmark(AppendPathBenchmark::Params params) {
+  std::unique_ptr<AppendPathBenchmark> b;
+  BENCHMARK_SUSPEND {
+    b = std::make_unique<AppendPathBenchmark>(params);
+  }
+  b->run();
+  BENCHMARK_SUSPEND {
+    b->shutdown();
+  }
+  return params.num_appends;
+}
+
+BENCHMARK_MULTI(AppendPathR3, n) {
+  return runBenchmark({n, /* nworkers */ 1, /* replication */ 3});
+}
+
+BENCHMARK_MULTI(AppendPathR5, n) {
+  return runBenchmark({n, /* nworkers */ 1, /* replication */ 5});
+}
+
+// Time per append is wall time, so this shows how per-worker throughput
+// holds up when workers run in parallel.
+BENCHMARK_MULTI(AppendPathR3FourWorkers, n) {
+  return runBenchmark({n, /* nworkers */ 4, /* replication */ 3});
+}
+
+} // namespace
+
+#ifndef BENCHMARK_BUNDLE
+
+// Counts allocations per thread, see allocationsOnThisThread(). The other
+// forms of operator new and delete forward to these.
+void* operator new(size_t size) {
+  ++allocations_on_this_thread;
+  void* p = std::malloc(size == 0 ? 1 : size);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+int main(int argc, char** argv) {
+  dbg::currentLevel = dbg::Level::ERROR;
+  folly::SingletonVault::singleton()->registrationComplete();
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
+#endif
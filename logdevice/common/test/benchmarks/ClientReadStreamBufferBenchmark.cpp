@@ -0,0 +1,147 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <folly/Benchmark.h>
+#include <folly/Singleton.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/common/DataRecordOwnsPayload.h"
+#include "logdevice/common/Timer.h"
+#include "logdevice/common/client_read_stream/ClientReadStream.h"
+#include "logdevice/common/client_read_stream/ClientReadStreamBufferFactory.h"
+#include "logdevice/common/debug.h"
+
+using namespace facebook::logdevice;
+
+/**
+ * @file Compares ClientReadStreamBuffer implementations on the operations
+ *       ClientReadStream does for every record: buffering a record or gap
+ *       marker, finding the first marker, and popping the front of the
+ *       buffer. The buffer is as large as a wide client read window.
+ */
+
+namespace {
+
+constexpr size_t CAPACITY = 100000;
+
+// Buffers every `stride`-th LSN of the window, then delivers them all in
+// order, `n` times.
+void fillAndDrain(size_t n, ClientReadStreamBufferType type, size_t stride) {
+  std::unique_ptr<ClientReadStreamBuffer> buf;
+  BENCHMARK_SUSPEND {
+    buf = ClientReadStreamBufferFactory::create(type, CAPACITY, 1);
+  }
+  for (size_t i = 0; i < n; ++i) {
+    const lsn_t head = buf->getBufferHead();
+    for (lsn_t lsn = head; lsn <= buf->maxLSNToAccept(); lsn += stride) {
+      buf->createOrGet(lsn)->gap = true;
+    }
+    while (true) {
+      auto marker = buf->findFirstMarker();
+      if (!marker.first) {
+        break;
+      }
+      buf->advanceBufferHead(marker.second - buf->getBufferHead());
+      buf->front()->gap = false;
+      buf->popFront();
+      buf->advanceBufferHead();
+    }
+  }
+  folly::doNotOptimizeAway(buf->getBufferHead());
+}
+
+// Looks for the first marker when the only one is at the end of the window,
+// like a stream waiting for a gap to be detected.
+void findFarMarker(size_t n, ClientReadStreamBufferType type) {
+  std::unique_ptr<ClientReadStreamBuffer> buf;
+  BENCHMARK_SUSPEND {
+    buf = ClientReadStreamBufferFactory::create(type, CAPACITY, 1);
+    buf->createOrGet(buf->maxLSNToAccept())->gap = true;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    folly::doNotOptimizeAway(buf->findFirstMarker());
+  }
+}
+
+// Visits the whole window with forEachUpto() while a tenth of it is buffered.
+void scanWindow(size_t n, ClientReadStreamBufferType type) {
+  std::unique_ptr<ClientReadStreamBuffer> buf;
+  BENCHMARK_SUSPEND {
+    buf = ClientReadStreamBufferFactory::create(type, CAPACITY, 1);
+    for (lsn_t lsn = 1; lsn <= buf->maxLSNToAccept(); lsn += 10) {
+      buf->createOrGet(lsn)->gap = true;
+    }
+  }
+  size_t visited = 0;
+  for (size_t i = 0; i < n; ++i) {
+    buf->forEachUpto(buf->maxLSNToAccept(),
+                     [&](lsn_t, ClientReadStreamRecordState&) { ++visited; });
+  }
+  folly::doNotOptimizeAway(visited);
+}
+
+} // namespace
+
+BENCHMARK_NAMED_PARAM(fillAndDrain,
+                      circular_dense,
+                      ClientReadStreamBufferType::CIRCULAR,
+                      1)
+BENCHMARK_RELATIVE_NAMED_PARAM(fillAndDrain,
+                               ordered_map_dense,
+                               ClientReadStreamBufferType::ORDERED_MAP,
+                               1)
+BENCHMARK_RELATIVE_NAMED_PARAM(fillAndDrain,
+                               chunked_dense,
+                               ClientReadStreamBufferType::CHUNKED,
+                               1)
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_NAMED_PARAM(fillAndDrain,
+                      circular_sparse,
+                      ClientReadStreamBufferType::CIRCULAR,
+                      100)
+BENCHMARK_RELATIVE_NAMED_PARAM(fillAndDrain,
+                               ordered_map_sparse,
+                               ClientReadStreamBufferType::ORDERED_MAP,
+                               100)
+BENCHMARK_RELATIVE_NAMED_PARAM(fillAndDrain,
+                               chunked_sparse,
+                               ClientReadStreamBufferType::CHUNKED,
+                               100)
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_NAMED_PARAM(findFarMarker,
+                      circular,
+                      ClientReadStreamBufferType::CIRCULAR)
+BENCHMARK_RELATIVE_NAMED_PARAM(findFarMarker,
+                               ordered_map,
+                               ClientReadStreamBufferType::ORDERED_MAP)
+BENCHMARK_RELATIVE_NAMED_PARAM(findFarMarker,
+                               chunked,
+                               ClientReadStreamBufferType::CHUNKED)
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_NAMED_PARAM(scanWindow,
+                      circular,
+                      ClientReadStreamBufferType::CIRCULAR)
+BENCHMARK_RELATIVE_NAMED_PARAM(scanWindow,
+                               ordered_map,
+                               ClientReadStreamBufferType::ORDERED_MAP)
+BENCHMARK_RELATIVE_NAMED_PARAM(scanWindow,
+                               chunked,
+                               ClientReadStreamBufferType::CHUNKED)
+
+#ifndef BENCHMARK_BUNDLE
+
+int main(int argc, char** argv) {
+  dbg::currentLevel = dbg::Level::ERROR;
+  folly::SingletonVault::singleton()->registrationComplete();
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
+#endif
@@ -0,0 +1,715 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/Singleton.h>
+#include <folly/io/IOBuf.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/common/EpochMetaData.h"
+#include "logdevice/common/Processor.h"
+#include "logdevice/common/Semaphore.h"
+#include "logdevice/common/Timer.h"
+#include "logdevice/common/Worker.h"
+#include "logdevice/common/buffered_writer/BufferedWriterImpl.h"
+#include "logdevice/common/client_read_stream/AllClientReadStreams.h"
+#include "logdevice/common/client_read_stream/ClientReadStream.h"
+#include "logdevice/common/client_read_stream/ClientReadStreamBufferFactory.h"
+#include "logdevice/common/configuration/LocalLogsConfig.h"
+#include "logdevice/common/configuration/UpdateableConfig.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/protocol/APPEND_Message.h"
+#include "logdevice/common/protocol/Compatibility.h"
+#include "logdevice/common/protocol/GAP_Message.h"
+#include "logdevice/common/protocol/ProtocolReader.h"
+#include "logdevice/common/protocol/ProtocolWriter.h"
+#include "logdevice/common/protocol/RECORD_Message.h"
+#include "logdevice/common/protocol/STARTED_Message.h"
+#include "logdevice/common/protocol/START_Message.h"
+#include "logdevice/common/request_util.h"
+#include "logdevice/common/test/TestUtil.h"
+
+using namespace facebook::logdevice;
+
+/**
+ * @file Client-side CPU cost of reading and writing, without a cluster.
+ *
+ *       Reading: a real ClientReadStream on a client Processor's worker reads
+ *       from an in-process fake storage node set. Instead of sending START
+ *       and WINDOW into a socket, the read stream hands them to the fake
+ *       nodes, which answer with STARTED and then stream RECORDs as fast as
+ *       the window allows, and NO_RECORDS GAPs for the parts of the window
+ *       they have nothing in, like real storage nodes. Each message the fake
+ *       nodes send is serialized with ProtocolWriter, deserialized with
+ *       ProtocolReader and dispatched with Message::onReceived() on the
+ *       worker, which is what Connection does with messages read from a
+ *       socket. So the benchmark covers RECORD/GAP/STARTED decoding,
+ *       AllClientReadStreams routing, ClientReadStream buffering, gap
+ *       detection, flow control and callback dispatch.
+ *
+ *       Writing: a real BufferedWriter batches and compresses appends and
+ *       hands the batches to a fake append sink in place of ClientImpl.
+ *       The sink serializes the APPEND message the client would send and
+ *       acknowledges the batch on the next iteration of the worker's event
+ *       loop, like a sequencer that accepts appends instantly.
+ *
+ *       The time per iteration is the time per record, so the iterations
+ *       per second folly prints are the records per second one client
+ *       process can consume or produce. Sockets, TLS and the sequencer
+ *       routing of AppendRequest are not included.
+ */
+
+DEFINE_int32(client_bench_nodeset_size, 10, "Number of fake storage nodes.");
+DEFINE_int32(client_bench_replication,
+             3,
+             "Copies of each record on the fake storage nodes. Readers not "
+             "using single copy delivery receive all of them.");
+DEFINE_int32(client_bench_payload_size, 100, "Payload size in bytes.");
+DEFINE_int32(client_bench_read_buffer_size,
+             4096,
+             "Size of the ClientReadStream buffer, in records.");
+DEFINE_int32(client_bench_messages_per_iteration,
+             64,
+             "Messages the fake storage nodes send to the client per "
+             "iteration of the worker's event loop, like the messages read "
+             "from a socket at once.");
+DEFINE_int32(client_bench_batch_size,
+             64 * 1024,
+             "Size trigger of the BufferedWriter, in bytes.");
+
+namespace {
+
+constexpr logid_t LOG_ID{1};
+
+/**
+ * Fake storage nodes of one worker. They serve a single log whose epoch 1
+ * contains a record at every ESN; the copyset of ESN e starts at node
+ * (e - 1) % nodeset size and has the next `replication` nodes. With single
+ * copy delivery only the first node of the copyset sends the record.
+ */
+class FakeStorageNodes {
+ public:
+  FakeStorageNodes()
+      : payload_(folly::IOBuf::COPY_BUFFER,
+                 std::string(FLAGS_client_bench_payload_size, 'r')),
+        pump_timer_([this] { pump(); }) {
+    for (node_index_t i = 0; i < FLAGS_client_bench_nodeset_size; ++i) {
+      shards_.push_back(Stream{ShardID(i, 0)});
+    }
+  }
+
+  StorageSet storageSet() const {
+    StorageSet shards;
+    for (const Stream& s : shards_) {
+      shards.push_back(s.shard);
+    }
+    return shards;
+  }
+
+  void onStart(ShardID shard, const START_Header& header);
+  void onWindow(ShardID shard, lsn_t window_high);
+  void onStop(ShardID shard);
+
+  uint64_t messages_sent = 0;
+  uint64_t bytes_sent = 0;
+
+ private:
+  struct Stream {
+    ShardID shard;
+    read_stream_id_t rsid{READ_STREAM_ID_INVALID};
+    bool active{false};
+    bool started_pending{false};
+    bool scd{false};
+    lsn_t next_lsn{LSN_INVALID};
+    lsn_t until_lsn{LSN_INVALID};
+    lsn_t window_high{LSN_INVALID};
+    filter_version_t filter_version{0};
+
+    lsn_t limit() const {
+      return std::min(until_lsn, window_high);
+    }
+    bool hasWork() const {
+      return active && (started_pending || next_lsn <= limit());
+    }
+  };
+
+  // Sends messages round-robin across the nodes until either the budget for
+  // this iteration is spent or no node has anything to send.
+  void pump();
+  // Sends the next message of the stream.
+  void sendNext(Stream& s);
+  // Whether the record at `lsn' is sent by node number `pos'.
+  bool sends(const Stream& s, size_t pos, lsn_t lsn) const;
+  // Serializes, deserializes and dispatches a message the way Connection
+  // would on receiving it from node `from'.
+  void deliver(NodeID from,
+               const Message& msg,
+               Message::deserializer_t* deserializer);
+  void schedulePump() {
+    if (!pump_timer_.isActive()) {
+      pump_timer_.activate(std::chrono::microseconds(0));
+    }
+  }
+
+  const folly::IOBuf payload_;
+  std::vector<Stream> shards_;
+  Timer pump_timer_;
+};
+
+void FakeStorageNodes::onStart(ShardID shard, const START_Header& header) {
+  for (Stream& s : shards_) {
+    if (s.shard != shard) {
+      continue;
+    }
+    s.rsid = header.read_stream_id;
+    s.active = true;
+    s.started_pending = true;
+    s.scd = header.flags & START_Header::SINGLE_COPY_DELIVERY;
+    s.next_lsn = header.start_lsn;
+    s.until_lsn = header.until_lsn;
+    s.window_high = header.window_high;
+    s.filter_version = header.filter_version;
+  }
+  schedulePump();
+}
+
+void FakeStorageNodes::onWindow(ShardID shard, lsn_t window_high) {
+  for (Stream& s : shards_) {
+    if (s.shard == shard) {
+      s.window_high = window_high;
+    }
+  }
+  schedulePump();
+}
+
+void FakeStorageNodes::onStop(ShardID shard) {
+  for (Stream& s : shards_) {
+    if (s.shard == shard) {
+      s.active = false;
+    }
+  }
+}
+
+void FakeStorageNodes::pump() {
+  int budget = FLAGS_client_bench_messages_per_iteration;
+  bool more = true;
+  while (budget > 0 && more) {
+    more = false;
+    for (Stream& s : shards_) {
+      if (budget > 0 && s.hasWork()) {
+        sendNext(s);
+        --budget;
+      }
+      more |= s.hasWork();
+    }
+  }
+  if (more) {
+    // Let the worker process other events, like a socket that has no more
+    // data buffered.
+    schedulePump();
+  }
+}
+
+bool FakeStorageNodes::sends(const Stream& s, size_t pos, lsn_t lsn) const {
+  const size_t n = shards_.size();
+  const size_t first = (lsn_to_esn(lsn).val_ - 1) % n;
+  const size_t offset = (pos + n - first) % n;
+  return s.scd ? offset == 0
+               : offset < size_t(FLAGS_client_bench_replication);
+}
+
+void FakeStorageNodes::sendNext(Stream& s) {
+  const NodeID from = s.shard.asNodeID();
+  if (s.started_pending) {
+    s.started_pending = false;
+    STARTED_Header header{};
+    header.log_id = LOG_ID;
+    header.read_stream_id = s.rsid;
+    header.status = E::OK;
+    header.filter_version = s.filter_version;
+    header.last_released_lsn = s.until_lsn;
+    header.shard = s.shard.shard();
+    deliver(from,
+            STARTED_Message(header, TrafficClass::READ_BACKLOG),
+            &STARTED_Message::deserialize);
+    return;
+  }
+
+  // Every record has a copy on one of any nodeset-size consecutive LSNs, so
+  // this loop is short.
+  const size_t pos = &s - shards_.data();
+  lsn_t lsn = s.next_lsn;
+  while (lsn <= s.limit() && !sends(s, pos, lsn)) {
+    ++lsn;
+  }
+
+  if (lsn > s.next_lsn) {
+    // Nothing up to `lsn', tell the client so that it can detect gaps.
+    GAP_Header header{LOG_ID,
+                      s.rsid,
+                      s.next_lsn,
+                      lsn - 1,
+                      GapReason::NO_RECORDS,
+                      GAP_flags_t(0),
+                      s.shard.shard()};
+    s.next_lsn = lsn;
+    deliver(from,
+            GAP_Message(header, TrafficClass::READ_BACKLOG),
+            &GAP_Message::deserialize);
+    return;
+  }
+
+  RECORD_Header header{};
+  header.log_id = LOG_ID;
+  header.read_stream_id = s.rsid;
+  header.lsn = lsn;
+  header.timestamp = 0;
+  // No checksum, so the parity bit must be set.
+  header.flags = RECORD_Header::CHECKSUM_PARITY;
+  header.shard = s.shard.shard();
+  s.next_lsn = lsn + 1;
+  deliver(from,
+          RECORD_Message(header,
+                         TrafficClass::READ_BACKLOG,
+                         PayloadHolder(payload_.cloneAsValue()),
+                         nullptr),
+          &RECORD_Message::deserialize);
+}
+
+void FakeStorageNodes::deliver(NodeID from,
+                               const Message& msg,
+                               Message::deserializer_t* deserializer) {
+  const uint16_t proto = Compatibility::MAX_PROTOCOL_SUPPORTED;
+  auto iobuf = folly::IOBuf::create(IOBUF_ALLOCATION_UNIT);
+  ProtocolWriter writer(msg.type_, iobuf.get(), proto);
+  msg.serialize(writer);
+  ssize_t size = writer.result();
+  ld_check(size > 0);
+  ++messages_sent;
+  bytes_sent += size;
+
+  ProtocolReader reader(msg.type_, std::move(iobuf), proto);
+  std::unique_ptr<Message> received = deserializer(reader).msg;
+  ld_check(received != nullptr);
+  if (received->onReceived(Address(from)) == Message::Disposition::KEEP) {
+    // The message took ownership of itself.
+    received.release();
+  }
+}
+
+class BenchReadStreamDependencies : public ClientReadStreamDependencies {
+ public:
+  BenchReadStreamDependencies(read_stream_id_t rsid,
+                              FakeStorageNodes* nodes,
+                              record_cb_t record_cb,
+                              gap_cb_t gap_cb,
+                              done_cb_t done_cb)
+      : ClientReadStreamDependencies(rsid,
+                                     LOG_ID,
+                                     "",
+                                     std::move(record_cb),
+                                     std::move(gap_cb),
+                                     std::move(done_cb),
+                                     nullptr, // metadata cache
+                                     nullptr), // health callback
+        nodes_(nodes) {}
+
+  bool getMetaDataForEpoch(read_stream_id_t /* rsid */,
+                           epoch_t epoch,
+                           MetaDataLogReader::Callback cb,
+                           bool /* allow_from_cache */,
+                           bool /* require_consistent_from_cache */) override {
+    auto metadata = std::make_unique<EpochMetaData>(
+        nodes_->storageSet(),
+        ReplicationProperty(
+            {{NodeLocationScope::NODE, FLAGS_client_bench_replication}}),
+        EPOCH_MIN,
+        EPOCH_MIN);
+    cb(E::OK,
+       MetaDataLogReader::Result{LOG_ID,
+                                 epoch,
+                                 EPOCH_MAX,
+                                 MetaDataLogReader::RecordSource::LAST,
+                                 LSN_INVALID,
+                                 std::chrono::milliseconds(0),
+                                 std::move(metadata)});
+    return true;
+  }
+
+  int sendStartMessage(ShardID shard,
+                       SocketCallback* /* onclose */,
+                       START_Header header,
+                       const small_shardset_t& /* filtered_out */,
+                       const ReadStreamAttributes* /* attrs */) override {
+    header.log_id = LOG_ID;
+    header.read_stream_id = getReadStreamID();
+    nodes_->onStart(shard, header);
+    return 0;
+  }
+
+  int sendStopMessage(ShardID shard) override {
+    nodes_->onStop(shard);
+    return 0;
+  }
+
+  int sendWindowMessage(ShardID shard,
+                        lsn_t /* window_low */,
+                        lsn_t window_high) override {
+    nodes_->onWindow(shard, window_high);
+    return 0;
+  }
+
+  folly::Optional<uint16_t>
+  getSocketProtocolVersion(node_index_t /* nid */) const override {
+    return Compatibility::MAX_PROTOCOL_SUPPORTED;
+  }
+
+  void refreshClusterState() override {}
+
+ private:
+  FakeStorageNodes* const nodes_;
+};
+
+class ReadBenchmark {
+ public:
+  enum class Mode { ALL_SEND_ALL, SCD, SCD_BATCHED };
+
+  ReadBenchmark(uint64_t num_records, Mode mode);
+  ~ReadBenchmark();
+
+  // Reads all the records and blocks until the read stream is done.
+  void run();
+
+ private:
+  const uint64_t num_records_;
+  const Mode mode_;
+  Settings settings_;
+  std::shared_ptr<UpdateableConfig> updateable_config_;
+  std::shared_ptr<Processor> processor_;
+  std::unique_ptr<FakeStorageNodes> nodes_;
+  // Only accessed on the worker.
+  uint64_t records_received_ = 0;
+  Semaphore done_;
+};
+
+ReadBenchmark::ReadBenchmark(uint64_t num_records, Mode mode)
+    : num_records_(num_records),
+      mode_(mode),
+      settings_(create_default_settings<Settings>()) {
+  settings_.num_workers = 1;
+  // TODO the following 2 settings are required to make the NCPublisher pick
+  // the NCM NodesConfiguration. Should be removed when NCM is the default.
+  settings_.enable_nodes_configuration_manager = true;
+  settings_.use_nodes_configuration_manager_nodes_configuration = true;
+
+  updateable_config_ = std::make_shared<UpdateableConfig>(
+      Configuration::fromJsonFile(TEST_CONFIG_FILE("sequencer_test.conf")));
+  updateable_config_->updateableNCMNodesConfiguration()->update(
+      createSimpleNodesConfig(FLAGS_client_bench_nodeset_size));
+  auto logs_config = std::make_shared<configuration::LocalLogsConfig>();
+  logs_config->insert(
+      boost::icl::right_open_interval<logid_t::raw_type>(
+          LOG_ID.val_, LOG_ID.val_ + 1),
+      "log",
+      logsconfig::LogAttributes()
+          .with_replicationFactor(FLAGS_client_bench_replication)
+          .with_scdEnabled(mode_ != Mode::ALL_SEND_ALL));
+  updateable_config_->updateableLogsConfig()->update(std::move(logs_config));
+
+  processor_ = make_test_processor(settings_, updateable_config_);
+  ld_check(processor_ != nullptr);
+  run_on_worker(processor_.get(), 0, [&] {
+    nodes_ = std::make_unique<FakeStorageNodes>();
+    return 0;
+  });
+}
+
+
+ReadBenchmark::~ReadBenchmark() {
+  uint64_t messages = 0;
+  uint64_t bytes = 0;
+  // The timer must be destroyed on the worker.
+  run_on_worker(processor_.get(), 0, [&] {
+    messages = nodes_->messages_sent;
+    bytes = nodes_->bytes_sent;
+    nodes_.reset();
+    return 0;
+  });
+  gracefully_shutdown_processor(processor_.get());
+  processor_.reset();
+
+#ifndef BENCHMARK_BUNDLE
+  printf("%lu records read: %.2f messages, %.1f bytes received per record\n",
+         records_received_,
+         double(messages) / std::max<uint64_t>(1, records_received_),
+         double(bytes) / std::max<uint64_t>(1, records_received_));
+#endif
+}
+
+void ReadBenchmark::run() {
+  run_on_worker(processor_.get(), 0, [&] {
+    const read_stream_id_t rsid = processor_->issueReadStreamID();
+    const lsn_t start_lsn = compose_lsn(EPOCH_MIN, ESN_MIN);
+    // Like an application callback that looks at the payload and returns.
+    auto deps = std::make_unique<BenchReadStreamDependencies>(
+        rsid,
+        nodes_.get(),
+        [this](std::unique_ptr<DataRecord>& record) {
+          folly::doNotOptimizeAway(record->payload.size());
+          ++records_received_;
+          return true;
+        },
+        [](const GapRecord&) { return true; },
+        [this](logid_t) { done_.post(); });
+    if (mode_ == Mode::SCD_BATCHED) {
+      deps->setRecordBatchCallback(
+          [this](std::vector<RecordBatchEntry>& batch) {
+            for (const RecordBatchEntry& entry : batch) {
+              if (!entry.isGap()) {
+                folly::doNotOptimizeAway(entry.record->payload.size());
+                ++records_received_;
+              }
+            }
+            return batch.size();
+          });
+    }
+    auto stream = std::make_unique<ClientReadStream>(
+        rsid,
+        LOG_ID,
+        start_lsn,
+        start_lsn + num_records_ - 1,
+        settings_.client_read_flow_control_threshold,
+        ClientReadStreamBufferType::CIRCULAR,
+        FLAGS_client_bench_read_buffer_size,
+        std::move(deps),
+        updateable_config_);
+    if (mode_ == Mode::ALL_SEND_ALL) {
+      stream->forceNoSingleCopyDelivery();
+    }
+    Worker::onThisThread()->clientReadStreams().insertAndStart(
+        std::move(stream));
+    return 0;
+  });
+  done_.wait();
+}
+
+/**
+ * Takes the place of ClientImpl for BufferedWriter. Serializes the APPEND
+ * message for each batch and reports success on the batch's worker right
+ * away.
+ */
+class BenchAppendSink : public BufferedWriterAppendSink {
+ public:
+  explicit BenchAppendSink(Processor* processor) : processor_(processor) {}
+
+  bool checkAppend(logid_t, size_t, bool) override {
+    return true;
+  }
+
+  std::pair<Status, NodeID>
+  appendBuffered(logid_t logid,
+                 const BufferedWriter::AppendCallback::ContextSet&,
+                 AppendAttributes attrs,
+                 PayloadHolder&& payload,
+                 AppendRequestCallback callback,
+                 worker_id_t target_worker,
+                 int /* checksum_bits */) override {
+    const uint64_t seq = ++appends_;
+    APPEND_Header header{
+        request_id_t(seq),
+        logid,
+        EPOCH_INVALID,
+        10000, // timeout_ms
+        APPEND_flags_t(appendFlagsForChecksum(32) |
+                       APPEND_Header::BUFFERED_WRITER_BLOB)};
+    APPEND_Message msg(header, LSN_INVALID, std::move(attrs), payload);
+    auto iobuf = folly::IOBuf::create(IOBUF_ALLOCATION_UNIT);
+    ProtocolWriter writer(
+        msg.type_, iobuf.get(), Compatibility::MAX_PROTOCOL_SUPPORTED);
+    msg.serialize(writer);
+    bytes_ += writer.result();
+
+    // Acknowledge on the next iteration of the event loop, not from within
+    // BufferedWriter's call.
+    const lsn_t lsn = compose_lsn(EPOCH_MIN, esn_t(seq));
+    run_on_worker_nonblocking(
+        processor_,
+        target_worker,
+        WorkerType::GENERAL,
+        RequestType::MISC,
+        [callback = std::move(callback), logid, payload = std::move(payload),
+         lsn] {
+          DataRecord record(logid, payload.getPayload(), lsn);
+          callback(E::OK, record, NodeID());
+        },
+        /* with_retrying */ true);
+    return std::make_pair(E::OK, NodeID());
+  }
+
+  uint64_t appends() const {
+    return appends_.load();
+  }
+  uint64_t bytes() const {
+    return bytes_.load();
+  }
+
+ private:
+  Processor* const processor_;
+  std::atomic<uint64_t> appends_{0};
+  std::atomic<uint64_t> bytes_{0};
+};
+
+class WriteBenchmark : public BufferedWriter::AppendCallback {
+ public:
+  WriteBenchmark(uint64_t num_records, Compression compression);
+  ~WriteBenchmark() override;
+
+  // Appends all the records and blocks until they're all acknowledged.
+  void run();
+
+  void onSuccess(logid_t,
+                 ContextSet contexts,
+                 const DataRecordAttributes&) override {
+    onDone(contexts.size());
+  }
+
+  void onFailure(logid_t, ContextSet contexts, Status) override {
+    failed_ += contexts.size();
+    onDone(contexts.size());
+  }
+
+ private:
+  void onDone(uint64_t n) {
+    if (done_count_.fetch_add(n) + n == num_records_) {
+      done_.post();
+    }
+  }
+
+  const uint64_t num_records_;
+  const std::string payload_;
+  Settings settings_;
+  std::shared_ptr<Processor> processor_;
+  std::unique_ptr<BenchAppendSink> sink_;
+  std::unique_ptr<BufferedWriterImpl> writer_;
+  std::atomic<uint64_t> done_count_{0};
+  std::atomic<uint64_t> failed_{0};
+  Semaphore done_;
+};
+
+WriteBenchmark::WriteBenchmark(uint64_t num_records, Compression compression)
+    : num_records_(num_records),
+      payload_(FLAGS_client_bench_payload_size, 'w'),
+      settings_(create_default_settings<Settings>()) {
+  settings_.num_workers = 1;
+  processor_ = make_test_processor(settings_);
+  ld_check(processor_ != nullptr);
+  sink_ = std::make_unique<BenchAppendSink>(processor_.get());
+
+  BufferedWriter::LogOptions options;
+  options.size_trigger = FLAGS_client_bench_batch_size;
+  options.compression = compression;
+  writer_ = std::make_unique<BufferedWriterImpl>(
+      new ProcessorProxy(processor_.get()),
+      this,
+      [options](logid_t) { return options; },
+      -1, // memory_limit_mb
+      sink_.get(),
+      nullptr); // stats
+}
+
+WriteBenchmark::~WriteBenchmark() {
+  writer_.reset();
+  gracefully_shutdown_processor(processor_.get());
+  processor_.reset();
+
+#ifndef BENCHMARK_BUNDLE
+  printf("%lu records written in %lu appends: %.1f bytes sent per record, "
+         "%lu failed\n",
+         num_records_,
+         sink_->appends(),
+         double(sink_->bytes()) / std::max<uint64_t>(1, num_records_),
+         failed_.load());
+#endif
+}
+
+void WriteBenchmark::run() {
+  for (uint64_t i = 0; i < num_records_; ++i) {
+    if (writer_->append(LOG_ID, std::string(payload_), nullptr) != 0) {
+      ++failed_;
+      onDone(1);
+    }
+  }
+  writer_->flushAll();
+  done_.wait();
+}
+
+size_t runReadBenchmark(size_t n, ReadBenchmark::Mode mode) {
+  std::unique_ptr<ReadBenchmark> b;
+  BENCHMARK_SUSPEND {
+    b = std::make_unique<ReadBenchmark>(n, mode);
+  }
+  b->run();
+  BENCHMARK_SUSPEND {
+    b.reset();
+  }
+  return n;
+}
+
+size_t runWriteBenchmark(size_t n, Compression compression) {
+  std::unique_ptr<WriteBenchmark> b;
+  BENCHMARK_SUSPEND {
+    b = std::make_unique<WriteBenchmark>(n, compression);
+  }
+  b->run();
+  BENCHMARK_SUSPEND {
+    b.reset();
+  }
+  return n;
+}
+
+// Every record arrives from all `replication` copies.
+BENCHMARK_MULTI(ClientReadAllSendAll, n) {
+  return runReadBenchmark(n, ReadBenchmark::Mode::ALL_SEND_ALL);
+}
+
+BENCHMARK_MULTI(ClientReadSCD, n) {
+  return runReadBenchmark(n, ReadBenchmark::Mode::SCD);
+}
+
+// Delivers records to a batch callback, as AsyncReader does with
+// setRecordBatchCallback().
+BENCHMARK_MULTI(ClientReadSCDBatched, n) {
+  return runReadBenchmark(n, ReadBenchmark::Mode::SCD_BATCHED);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK_MULTI(ClientBufferedWrite, n) {
+  return runWriteBenchmark(n, Compression::NONE);
+}
+
+BENCHMARK_MULTI(ClientBufferedWriteLZ4, n) {
+  return runWriteBenchmark(n, Compression::LZ4);
+}
+
+} // namespace
+
+#ifndef BENCHMARK_BUNDLE
+int main(int argc, char** argv) {
+  dbg::currentLevel = dbg::Level::ERROR;
+  folly::SingletonVault::singleton()->registrationComplete();
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  return 0;
+}
+#endif
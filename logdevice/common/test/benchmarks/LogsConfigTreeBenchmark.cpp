@@ -11,9 +11,11 @@
 #include <vector>
 
 #include <folly/Benchmark.h>
+#include <folly/Random.h>
 #include <folly/ScopeGuard.h>
 #include <folly/Singleton.h>
 
+#include "logdevice/common/configuration/LocalLogsConfig.h"
 #include "logdevice/common/configuration/logs/LogsConfigTree.h"
 #include "logdevice/include/LogAttributes.h"
 
@@ -25,6 +27,14 @@ DEFINE_int32(num_log_groups,
              500000,
              "Number of log groups in the logs config tree");
 
+DEFINE_int32(num_large_tree_directories,
+             1000,
+             "Number of directories in the tree of the *Large benchmarks");
+
+DEFINE_int32(num_large_tree_log_groups,
+             1000000,
+             "Number of log groups in the tree of the *Large benchmarks");
+
 using namespace facebook::logdevice;
 using namespace facebook::logdevice::logsconfig;
 
@@ -59,6 +69,104 @@ BENCHMARK(LogsConfigTreeCloning, n) {
   }
 }
 
+// A tree with distinct log ids, so that every log group has its own entry
+// in the index.
+std::unique_ptr<LogsConfigTree> createLargeTestTree() {
+  std::unique_ptr<LogsConfigTree> tree = LogsConfigTree::create();
+  auto defaults = DefaultLogAttributes().with_replicationFactor(3);
+  const int per_dir =
+      FLAGS_num_large_tree_log_groups / FLAGS_num_large_tree_directories;
+  logid_t::raw_type next_log = 1;
+  for (int i = 1; i <= FLAGS_num_large_tree_directories; i++) {
+    auto dir =
+        tree->addDirectory(tree->root(), "dir" + std::to_string(i), defaults);
+    for (int j = 1; j <= per_dir; j++, next_log++) {
+      tree->addLogGroup(dir,
+                        "log-" + std::to_string(j),
+                        logid_range_t{logid_t(next_log), logid_t(next_log)},
+                        LogAttributes(),
+                        false);
+    }
+  }
+  return tree;
+}
+
+// Clone a tree of num_large_tree_log_groups log groups N times.
+BENCHMARK(LogsConfigTreeCloningLarge, n) {
+  folly::BenchmarkSuspender benchmark_suspender;
+  std::unique_ptr<LogsConfigTree> tree = createLargeTestTree();
+  benchmark_suspender.dismiss();
+  for (int i = 1; i <= n; i++) {
+    tree->copy();
+  }
+}
+
+// What LogsConfigManager does for every published update: apply a small
+// change (here, renaming a log group) to the tree, then clone it. The
+// snapshots are kept alive until the next iteration, like the published
+// config is, so the change has to copy whatever it shares with them.
+BENCHMARK(LogsConfigTreeRenameAndCloneLarge, n) {
+  folly::BenchmarkSuspender benchmark_suspender;
+  std::unique_ptr<LogsConfigTree> tree = createLargeTestTree();
+  std::unique_ptr<LogsConfigTree> snapshot = tree->copy();
+  benchmark_suspender.dismiss();
+  for (int i = 1; i <= n; i++) {
+    const std::string from = folly::sformat("/dir1/log-{}", i % 2 ? 1 : 0);
+    const std::string to = folly::sformat("/dir1/log-{}", i % 2 ? 0 : 1);
+    tree->rename(from, to);
+    snapshot = tree->copy();
+  }
+}
+
+std::vector<logid_t> randomLogIds(size_t count) {
+  std::vector<logid_t> ids(count);
+  for (auto& id : ids) {
+    id = logid_t(folly::Random::rand64(1, FLAGS_num_large_tree_log_groups + 1));
+  }
+  return ids;
+}
+
+// Lookups of random log ids in a config with num_large_tree_log_groups log
+// groups, through the interval_map index of the tree (baseline) ...
+BENCHMARK(LogsConfigTreeLookupByIDLarge, n) {
+  folly::BenchmarkSuspender benchmark_suspender;
+  std::unique_ptr<LogsConfigTree> tree = createLargeTestTree();
+  std::vector<logid_t> ids = randomLogIds(n);
+  benchmark_suspender.dismiss();
+  for (logid_t id : ids) {
+    folly::doNotOptimizeAway(tree->getLogGroupByID(id));
+  }
+}
+
+// ... and through LocalLogsConfig, which uses a flat sorted index.
+BENCHMARK_RELATIVE(LocalLogsConfigLookupByIDLarge, n) {
+  folly::BenchmarkSuspender benchmark_suspender;
+  configuration::LocalLogsConfig config;
+  config.setLogsConfigTree(createLargeTestTree());
+  config.prepareLookupIndex();
+  std::vector<logid_t> ids = randomLogIds(n);
+  benchmark_suspender.dismiss();
+  for (logid_t id : ids) {
+    folly::doNotOptimizeAway(config.getLogGroupByIDShared(id));
+  }
+}
+
+// Repeated lookups of the same log, as an append or read path does, which
+// hit the per-thread cache of the last found range.
+BENCHMARK(LocalLogsConfigLookupSameIDLarge, n) {
+  folly::BenchmarkSuspender benchmark_suspender;
+  configuration::LocalLogsConfig config;
+  config.setLogsConfigTree(createLargeTestTree());
+  config.prepareLookupIndex();
+  benchmark_suspender.dismiss();
+  for (int i = 1; i <= n; i++) {
+    folly::doNotOptimizeAway(
+        config.getLogGroupByIDShared(logid_t(FLAGS_num_large_tree_log_groups)));
+  }
+}
+
+BENCHMARK_DRAW_LINE();
+
 BENCHMARK(LogsConfigTreeAdd, n) {
   folly::BenchmarkSuspender benchmark_suspender;
   auto tree = LogsConfigTree::create();
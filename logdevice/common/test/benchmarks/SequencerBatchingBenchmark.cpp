@@ -45,6 +45,9 @@ class SequencerBatchingBenchmark {
     // by default batch 50 records
     ssize_t size_trigger{7000};
     Compression compression{Compression::NONE};
+    // if true, time_trigger is a latency budget and the flush time is picked
+    // from the append rate, see Settings::sequencer_batching_adaptive
+    bool adaptive{false};
 
     // how many appends can be in-flight for each writer
     size_t writer_max_in_flight{1000};
@@ -205,6 +208,7 @@ SequencerBatchingBenchmark::SequencerBatchingBenchmark(Params params)
   settings_.sequencer_batching = true;
   settings_.sequencer_batching_time_trigger = params_.time_trigger;
   settings_.sequencer_batching_size_trigger = params_.size_trigger;
+  settings_.sequencer_batching_adaptive = params_.adaptive;
 
   updateable_config_ = std::make_shared<UpdateableConfig>(
       Configuration::fromJsonFile(TEST_CONFIG_FILE("sequencer_test.conf")));
@@ -288,12 +292,12 @@ void SequencerBatchingBenchmark::shutdown() {
           test_stats_.append_failed.load());
 }
 
-BENCHMARK_MULTI(LDSequencerBatchingBenchmark, n) {
-  SequencerBatchingBenchmark::Params params{n};
+size_t runBenchmark(SequencerBatchingBenchmark::Params params) {
+  const size_t n = params.num_appends;
   std::unique_ptr<SequencerBatchingBenchmark> b;
   BENCHMARK_SUSPEND {
     b = std::make_unique<SequencerBatchingBenchmark>(params);
-    ld_info("n appends = %u", n);
+    ld_info("n appends = %lu", n);
   }
 
   b->run();
@@ -303,6 +307,37 @@ BENCHMARK_MULTI(LDSequencerBatchingBenchmark, n) {
   return b->test_stats_.append_success.load();
 }
 
+BENCHMARK_MULTI(LDSequencerBatchingBenchmark, n) {
+  SequencerBatchingBenchmark::Params params{n};
+  return runBenchmark(params);
+}
+
+BENCHMARK_MULTI(LDSequencerBatchingAdaptiveBenchmark, n) {
+  SequencerBatchingBenchmark::Params params{n};
+  params.adaptive = true;
+  return runBenchmark(params);
+}
+
+// Few writers with a single append in flight each, spread over 100 logs, so
+// that each log sees little traffic. With a fixed time trigger every append
+// waits out the whole trigger; the adaptive mode should flush right away.
+BENCHMARK_MULTI(LDSequencerBatchingLowTrafficBenchmark, n) {
+  SequencerBatchingBenchmark::Params params{n};
+  params.nwriters = 4;
+  params.writer_max_in_flight = 1;
+  params.time_trigger = 5ms;
+  return runBenchmark(params);
+}
+
+BENCHMARK_MULTI(LDSequencerBatchingLowTrafficAdaptiveBenchmark, n) {
+  SequencerBatchingBenchmark::Params params{n};
+  params.nwriters = 4;
+  params.writer_max_in_flight = 1;
+  params.time_trigger = 5ms;
+  params.adaptive = true;
+  return runBenchmark(params);
+}
+
 } // namespace
 
 #ifndef BENCHMARK_BUNDLE
@@ -16,6 +16,7 @@
 #include <folly/Memory.h>
 #include <folly/SharedMutex.h>
 #include <folly/ThreadLocal.h>
+#include <folly/concurrency/ConcurrentHashMap.h>
 #include <folly/container/F14Map.h>
 #include <gflags/gflags.h>
 #include <google/dense_hash_map>
@@ -30,8 +31,9 @@ namespace {
 
 /**
  * @file Benchmark comparing access and update performance of folly's
- *       AtomicHashMap, and a std::unorderd_map protected by folly's
- *       SharedMutex.
+ *       AtomicHashMap and ConcurrentHashMap, and of maps protected by folly's
+ *       SharedMutex.  The ReadsIn64Threads case is closest to sequencer
+ *       lookups by all Workers of a big server.
  *
  *       Run with --bm_min_usec=1000000.
  */
@@ -396,6 +398,40 @@ logid_t* Map::find(const logid_t& k) {
 }
 } // namespace f14_map_of_shared_ptrs
 
+namespace concurrent_map_of_shared_ptrs {
+class Map {
+  using MapType = folly::ConcurrentHashMap<logid_t::raw_type,
+                                           std::shared_ptr<logid_t>,
+                                           Hash64<logid_t::raw_type>>;
+
+ public:
+  int insert(const logid_t& k);
+  int erase(const logid_t& k);
+  logid_t* find(const logid_t& k);
+
+ private:
+  MapType map_;
+};
+
+int Map::insert(const logid_t& k) {
+  auto logid = std::make_shared<logid_t>(k);
+  auto insertion_result = map_.insert(k.val(), std::move(logid));
+  return insertion_result.second ? 0 : 1;
+}
+
+int Map::erase(const logid_t& k) {
+  return map_.erase(k.val_);
+}
+
+logid_t* Map::find(const logid_t& k) {
+  auto it = map_.find(k.val_);
+  if (it == map_.cend()) {
+    return nullptr;
+  }
+  return it->second.get();
+}
+} // namespace concurrent_map_of_shared_ptrs
+
 template <typename Map>
 void benchInit(Map& m) {
   BENCHMARK_SUSPEND {
@@ -506,11 +542,10 @@ void benchWritesWhenReading(int n) {
   }
 }
 
-template <class MapType>
-void benchReadsIn10Threads(int n) {
+template <class MapType, size_t NumThreads>
+void benchReadsInThreads(int n) {
   MapType map;
-  std::atomic<bool> shutdown{false};
-  std::vector<std::thread> threads(10);
+  std::vector<std::thread> threads(NumThreads);
   int threadNumber{1};
 
   benchInit(map);
@@ -530,6 +565,16 @@ void benchReadsIn10Threads(int n) {
   }
 }
 
+template <class MapType>
+void benchReadsIn10Threads(int n) {
+  benchReadsInThreads<MapType, 10>(n);
+}
+
+template <class MapType>
+void benchReadsIn64Threads(int n) {
+  benchReadsInThreads<MapType, 64>(n);
+}
+
 #define BENCH(name)                                               \
   BENCHMARK(name##_AtomicMapOfPtrs, n) {                          \
     bench##name<atomic_map_of_ptrs::Map>(n);                      \
@@ -552,6 +597,9 @@ void benchReadsIn10Threads(int n) {
   BENCHMARK_RELATIVE(name##_F14MapOfSharedPtrs, n) {              \
     bench##name<f14_map_of_shared_ptrs::Map>(n);                  \
   }                                                               \
+  BENCHMARK_RELATIVE(name##_ConcurrentMapOfSharedPtrs, n) {       \
+    bench##name<concurrent_map_of_shared_ptrs::Map>(n);           \
+  }                                                               \
   BENCHMARK_DRAW_LINE();
 
 BENCH(Reads);
@@ -559,6 +607,7 @@ BENCH(Writes);
 BENCH(ReadsWhenWriting);
 BENCH(WritesWhenReading);
 BENCH(ReadsIn10Threads);
+BENCH(ReadsIn64Threads);
 
 } // namespace
 
@@ -9,6 +9,7 @@
 #include <condition_variable>
 #include <functional>
 #include <mutex>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -21,6 +22,9 @@
 #include "logdevice/common/test/TestUtil.h"
 
 DEFINE_int32(num_threads, 32, "Number of threads for benchmarks.");
+DEFINE_int32(num_log_groups,
+             10000,
+             "Number of log groups for per-log-group stats benchmarks.");
 
 namespace facebook { namespace logdevice {
 
@@ -179,6 +183,110 @@ BENCHMARK(BM_stats_aggregate, iters) {
       });
 }
 
+// Per-log-group stats for many log groups: the cost of aggregating them, and
+// of recording them while they are being aggregated.
+
+namespace {
+std::vector<std::string> makeLogGroups() {
+  std::vector<std::string> log_groups;
+  for (int i = 0; i < FLAGS_num_log_groups; ++i) {
+    log_groups.push_back("/log_group_" + std::to_string(i));
+  }
+  return log_groups;
+}
+
+} // namespace
+
+BENCHMARK(BM_stats_aggregate_per_log, iters) {
+  StatsHolder stats(StatsParams().setIsServer(true));
+  std::vector<std::string> log_groups;
+  // Threads stay alive while aggregating, otherwise their stats would be
+  // folded into the stats of destroyed threads.
+  std::vector<std::thread> threads;
+  MultiBaton populated(FLAGS_num_threads);
+  ThreadsState release;
+  BENCHMARK_SUSPEND {
+    log_groups = makeLogGroups();
+    for (int i = 0; i < FLAGS_num_threads; ++i) {
+      threads.emplace_back([&] {
+        for (const auto& log_group : log_groups) {
+          LOG_GROUP_STAT_ADD(&stats, log_group, append_success, 1);
+        }
+        populated.post();
+        std::unique_lock<std::mutex> lock(release.mtx);
+        release.cond.wait(lock, [&]() { return release.go; });
+      });
+    }
+    populated.wait();
+  }
+
+  for (size_t i = 0; i < iters; ++i) {
+    auto agg = stats.aggregate();
+    folly::doNotOptimizeAway(agg);
+  }
+
+  BENCHMARK_SUSPEND {
+    {
+      std::lock_guard<std::mutex> lock(release.mtx);
+      release.go = true;
+    }
+    release.cond.notify_all();
+    for (auto& t : threads) {
+      t.join();
+    }
+  }
+}
+
+BENCHMARK(BM_stats_per_log_record, iters) {
+  const int pt = iters / FLAGS_num_threads;
+  CHECK_GT(pt, 0);
+  StatsHolder stats(StatsParams().setIsServer(true));
+  std::vector<std::string> log_groups;
+  BENCHMARK_SUSPEND {
+    log_groups = makeLogGroups();
+  }
+
+  stats_benchmark(FLAGS_num_threads, pt, [&stats, &log_groups]() {
+    thread_local size_t next = 0;
+    LOG_GROUP_STAT_ADD(&stats,
+                       log_groups[next++ % log_groups.size()],
+                       append_success,
+                       1);
+  });
+}
+
+BENCHMARK_RELATIVE(BM_stats_per_log_record_while_aggregating, iters) {
+  const int pt = iters / FLAGS_num_threads;
+  CHECK_GT(pt, 0);
+  StatsHolder stats(StatsParams().setIsServer(true));
+  std::vector<std::string> log_groups;
+  BENCHMARK_SUSPEND {
+    log_groups = makeLogGroups();
+  }
+
+  std::atomic<bool> stop{false};
+  std::thread aggregator;
+  BENCHMARK_SUSPEND {
+    aggregator = std::thread([&] {
+      while (!stop.load()) {
+        auto agg = stats.aggregate();
+        folly::doNotOptimizeAway(agg);
+      }
+    });
+  }
+  stats_benchmark(FLAGS_num_threads, pt, [&stats, &log_groups]() {
+    thread_local size_t next = 0;
+    LOG_GROUP_STAT_ADD(&stats,
+                       log_groups[next++ % log_groups.size()],
+                       append_success,
+                       1);
+  });
+  BENCHMARK_SUSPEND {
+    stop.store(true);
+    aggregator.join();
+  }
+}
+
 }} // namespace facebook::logdevice
 
 #ifndef BENCHMARK_BUNDLE
@@ -0,0 +1,129 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/io/IOBuf.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/common/CopySet.h"
+#include "logdevice/common/protocol/Compatibility.h"
+#include "logdevice/common/protocol/PayloadCompression.h"
+#include "logdevice/common/protocol/ProtocolWriter.h"
+#include "logdevice/common/protocol/STORE_Message.h"
+
+using namespace facebook::logdevice;
+
+namespace {
+
+/**
+ * @file Sequencer-side cost of sending one record to all of its recipients:
+ *       building a STORE per recipient, serializing it the way Connection
+ *       does (with wire compression and the protocol checksum) for
+ *       replication factors 3 and 5.  Every iteration appends 1MB, so the
+ *       time per iteration is the CPU time per appended MB.
+ *
+ *       Run with --bm_min_usec=1000000.
+ */
+
+constexpr size_t PAYLOAD_SIZE = 1024 * 1024;
+
+const std::string& payload() {
+  static const std::string p = [] {
+    // Compresses about 3:1 with zstd.
+    std::mt19937 rng(0);
+    std::string s;
+    s.reserve(PAYLOAD_SIZE);
+    while (s.size() < PAYLOAD_SIZE) {
+      s += "record " + std::to_string(rng() % 1000) + " ";
+    }
+    s.resize(PAYLOAD_SIZE);
+    return s;
+  }();
+  return p;
+}
+
+void sendToRecipients(uint32_t n,
+                      size_t replication,
+                      Compression compression,
+                      bool shared_cache) {
+  STORE_Header header;
+  std::vector<StoreChainLink> copyset;
+  PayloadHolder ph;
+  BENCHMARK_SUSPEND {
+    header = STORE_Header{RecordID(esn_t(1), epoch_t(1), logid_t(1)),
+                          1000,     // timestamp
+                          esn_t(0), // lng
+                          1,        // wave
+                          0,        // flags
+                          1,        // nsync
+                          0,        // copyset_offset
+                          static_cast<copyset_size_t>(replication),
+                          0, // timeout_ms
+                          NodeID(0, 1)};
+    for (size_t i = 0; i < replication; ++i) {
+      copyset.push_back(
+          {ShardID(static_cast<node_index_t>(i + 1), 0), ClientID::INVALID});
+    }
+    ph = PayloadHolder::copyString(payload());
+  }
+
+  for (uint32_t i = 0; i < n; ++i) {
+    std::shared_ptr<payload_compression::CompressedPayloadCache> cache;
+    if (shared_cache) {
+      cache = std::make_shared<payload_compression::CompressedPayloadCache>();
+    }
+    for (size_t r = 0; r < replication; ++r) {
+      STORE_Message msg(header, copyset.data(), r, 0, STORE_Extra(), {}, ph);
+      if (cache) {
+        msg.setCompressedPayloadCache(cache);
+      }
+      auto iobuf = folly::IOBuf::create(IOBUF_ALLOCATION_UNIT);
+      ProtocolWriter writer(
+          msg.type_, iobuf.get(), Compatibility::MAX_PROTOCOL_SUPPORTED);
+      writer.setPayloadCompression({compression, 1, 1024});
+      msg.serialize(writer);
+      folly::doNotOptimizeAway(writer.computeChecksum());
+    }
+  }
+}
+
+void uncompressed(uint32_t n, size_t replication) {
+  sendToRecipients(n, replication, Compression::NONE, false);
+}
+
+void compressedPerRecipient(uint32_t n, size_t replication) {
+  sendToRecipients(n, replication, Compression::ZSTD, false);
+}
+
+void compressedOnce(uint32_t n, size_t replication) {
+  sendToRecipients(n, replication, Compression::ZSTD, true);
+}
+
+BENCHMARK_NAMED_PARAM(uncompressed, R3, 3)
+BENCHMARK_RELATIVE_NAMED_PARAM(compressedPerRecipient, R3, 3)
+BENCHMARK_RELATIVE_NAMED_PARAM(compressedOnce, R3, 3)
+BENCHMARK_DRAW_LINE();
+BENCHMARK_NAMED_PARAM(uncompressed, R5, 5)
+BENCHMARK_RELATIVE_NAMED_PARAM(compressedPerRecipient, R5, 5)
+BENCHMARK_RELATIVE_NAMED_PARAM(compressedOnce, R5, 5)
+
+} // namespace
+
+#ifndef BENCHMARK_BUNDLE
+
+int main(int argc, char** argv) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+
+  return 0;
+}
+#endif
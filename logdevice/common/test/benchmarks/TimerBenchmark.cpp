@@ -13,6 +13,8 @@
 #include <folly/Benchmark.h>
 #include <folly/ScopeGuard.h>
 #include <folly/Singleton.h>
+#include <folly/io/async/EventBase.h>
+#include <folly/io/async/HHWheelTimer.h>
 
 #include "logdevice/common/LibeventTimer.h"
 #include "logdevice/common/WheelTimer.h"
@@ -73,6 +75,64 @@ BENCHMARK_RELATIVE(LibeventTimerParallel, n) {
   }
 }
 
+// The following benchmarks reactivate timers while kLiveTimers timers are
+// outstanding, which is what the cost of activation depends on for a heap.
+constexpr size_t kLiveTimers = 10 * 1000 * 1000;
+
+BENCHMARK(LibeventTimerReactivate10MLive, n) {
+  dbg::currentLevel = dbg::Level::NONE;
+  std::unique_ptr<EvBase> base;
+  std::vector<std::unique_ptr<LibeventTimer>> timers;
+  BENCHMARK_SUSPEND {
+    base = std::make_unique<EvBase>();
+    auto rv = base->init();
+    assert(rv == EvBase::Status::OK);
+    timers.reserve(kLiveTimers);
+    for (size_t i = 0; i < kLiveTimers; ++i) {
+      timers.emplace_back(std::make_unique<LibeventTimer>(base.get(), [] {}));
+      timers.back()->activate(1h + microseconds(i));
+    }
+  }
+  for (size_t i = 0; i < n; ++i) {
+    timers[i % kLiveTimers]->activate(2h + microseconds(i));
+  }
+  BENCHMARK_SUSPEND {
+    timers.clear();
+  }
+}
+
+namespace {
+struct NoopWheelCallback : public folly::HHWheelTimer::Callback {
+  void timeoutExpired() noexcept override {}
+  void callbackCanceled() noexcept override {}
+};
+} // namespace
+
+// The wheel of an EventBase, as used by timers with
+// --enable-event-loop-wheel-timers.
+BENCHMARK_RELATIVE(EventLoopWheelTimerReactivate10MLive, n) {
+  std::unique_ptr<EvBase> base;
+  std::unique_ptr<std::vector<NoopWheelCallback>> timers;
+  BENCHMARK_SUSPEND {
+    base = std::make_unique<EvBase>();
+    auto rv = base->init();
+    assert(rv == EvBase::Status::OK);
+    timers = std::make_unique<std::vector<NoopWheelCallback>>(kLiveTimers);
+    auto& wheel = base->getEventBase()->timer();
+    for (size_t i = 0; i < kLiveTimers; ++i) {
+      wheel.scheduleTimeout(&(*timers)[i], 1h + milliseconds(i % 1000));
+    }
+  }
+  auto& wheel = base->getEventBase()->timer();
+  for (size_t i = 0; i < n; ++i) {
+    wheel.scheduleTimeout(
+        &(*timers)[i % kLiveTimers], 2h + milliseconds(i % 1000));
+  }
+  BENCHMARK_SUSPEND {
+    timers.reset();
+  }
+}
+
 #ifndef BENCHMARK_BUNDLE
 
 int main(int argc, char** argv) {
@@ -0,0 +1,364 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/Singleton.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/common/BWAvailableCallback.h"
+#include "logdevice/common/FlowGroup.h"
+#include "logdevice/common/FlowGroupDependencies.h"
+#include "logdevice/common/PriorityMap.h"
+#include "logdevice/common/ShapingContainer.h"
+#include "logdevice/common/configuration/ShapingConfig.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/stats/Stats.h"
+
+DEFINE_int32(shaping_bench_senders,
+             16,
+             "Number of Senders (workers) the sockets are spread over");
+DEFINE_int64(shaping_bench_rate,
+             1ll << 30,
+             "Configured guaranteed bandwidth of the shaped scope, in bytes "
+             "per second, split evenly across the shaped priorities");
+DEFINE_int64(shaping_bench_burst,
+             16ll << 20,
+             "Configured burst capacity per priority, in bytes");
+DEFINE_int32(shaping_bench_message_size, 16 * 1024, "Message size in bytes");
+DEFINE_double(shaping_bench_overcommit,
+              2.0,
+              "Total demand of sockets relative to the configured rate");
+DEFINE_double(shaping_bench_demand_skew,
+              1.2,
+              "Pareto shape of per-socket demand; smaller is more skewed");
+DEFINE_int32(shaping_bench_max_backlog,
+             64,
+             "Messages a socket buffers before its demand is dropped, as an "
+             "application blocked on a full output buffer would");
+
+using namespace facebook::logdevice;
+
+/**
+ * @file Simulates thousands of sockets with varying demand sending through
+ *       the real traffic shaping code: a ShapingContainer (and so a set of
+ *       FlowGroups) per simulated Sender, receiving bandwidth in quanta the
+ *       way TrafficShaper hands it out. Time is simulated: each benchmark
+ *       iteration is one TrafficShaper quantum, during which every socket
+ *       adds its demand for the quantum to its backlog and sends as much as
+ *       the FlowGroup lets it, queuing for bandwidth otherwise.
+ *
+ *       Besides the CPU cost per quantum, reports for each shaped priority
+ *       the achieved vs configured rate and Jain's fairness index of socket
+ *       throughput normalized by the socket's max-min fair share, and the
+ *       CPU time per shaped MB. The report is printed after all benchmarks
+ *       have run.
+ */
+
+namespace {
+
+// Sockets are spread round-robin over these priorities, and the configured
+// rate is split evenly between them.
+const std::vector<Priority> SHAPED_PRIORITIES = {Priority::CLIENT_HIGH,
+                                                 Priority::CLIENT_NORMAL,
+                                                 Priority::BACKGROUND};
+
+// Same as TrafficShaper::updateInterval_.
+constexpr std::chrono::microseconds QUANTUM{1000};
+
+struct Report {
+  struct PerPriority {
+    double configured_rate;
+    double achieved_rate;
+    double jain_index;
+  };
+  std::vector<PerPriority> priorities;
+  double cpu_ns_per_mb;
+};
+
+std::map<std::string, Report>& reports() {
+  static std::map<std::string, Report> r;
+  return r;
+}
+
+class TrafficShapingSim {
+ public:
+  TrafficShapingSim(size_t nsockets, bool shaped);
+
+  // Simulates one TrafficShaper quantum.
+  void runQuantum();
+
+  Report report(size_t nquanta, std::chrono::nanoseconds cpu_time) const;
+
+ private:
+  class Socket : public BWAvailableCallback {
+   public:
+    Socket(TrafficShapingSim* sim, Priority p, double demand)
+        : sim_(sim), prio_(p), demand_(demand) {}
+
+    void addDemand() {
+      backlog_ = std::min(backlog_ + demand_, sim_->max_backlog_);
+    }
+
+    // Sends messages while there is bandwidth, queues for more otherwise.
+    void trySend(FlowGroup& fg) {
+      while (backlog_ >= sim_->message_size_) {
+        if (!fg.drain(sim_->message_size_, prio_)) {
+          fg.push(*this, prio_);
+          return;
+        }
+        backlog_ -= sim_->message_size_;
+        sent_ += sim_->message_size_;
+      }
+    }
+
+    void operator()(FlowGroup& fg, std::mutex&) override {
+      trySend(fg);
+    }
+
+    TrafficShapingSim* const sim_;
+    const Priority prio_;
+    // Bytes per quantum.
+    const double demand_;
+    double backlog_ = 0;
+    uint64_t sent_ = 0;
+  };
+
+  // Mirrors TrafficShaper::dispatchUpdateCommon() and dispatchUpdateNw().
+  void dispatchUpdate();
+
+  const double message_size_ = FLAGS_shaping_bench_message_size;
+  const double max_backlog_ = message_size_ * FLAGS_shaping_bench_max_backlog;
+
+  StatsHolder stats_{StatsParams().setIsServer(true)};
+  std::unique_ptr<configuration::ShapingConfig> config_;
+  FlowGroupsUpdate update_;
+  std::vector<std::unique_ptr<ShapingContainer>> senders_;
+  // Sockets of each sender. Declared after senders_ since sockets unlink
+  // themselves from FlowGroup queues on destruction.
+  std::vector<std::vector<std::unique_ptr<Socket>>> sockets_;
+  std::mt19937_64 rng_{0xF10};
+};
+
+TrafficShapingSim::TrafficShapingSim(size_t nsockets, bool shaped)
+    : update_({NodeLocationScope::ROOT}) {
+  std::set<NodeLocationScope> scopes = {NodeLocationScope::NODE,
+                                        NodeLocationScope::RACK,
+                                        NodeLocationScope::ROW,
+                                        NodeLocationScope::CLUSTER,
+                                        NodeLocationScope::DATA_CENTER,
+                                        NodeLocationScope::REGION,
+                                        NodeLocationScope::ROOT};
+  config_ = std::make_unique<configuration::ShapingConfig>(
+      scopes, std::set<NodeLocationScope>{NodeLocationScope::ROOT});
+  auto& policy = config_->flowGroupPolicies[NodeLocationScope::ROOT];
+  policy.setEnabled(shaped);
+  for (Priority p : SHAPED_PRIORITIES) {
+    policy.set(p,
+               FLAGS_shaping_bench_burst,
+               FLAGS_shaping_bench_rate / SHAPED_PRIORITIES.size());
+  }
+
+  auto deps = std::make_shared<NwShapingFlowGroupDeps>(&stats_, nullptr);
+  sockets_.resize(FLAGS_shaping_bench_senders);
+  for (int i = 0; i < FLAGS_shaping_bench_senders; ++i) {
+    senders_.push_back(std::make_unique<ShapingContainer>(
+        static_cast<size_t>(NodeLocation::NUM_ALL_SCOPES),
+        nullptr,
+        *config_,
+        deps));
+    auto scope = NodeLocationScope::NODE;
+    for (auto& fg : senders_.back()->flow_groups_) {
+      fg.setScope(scope);
+      scope = NodeLocation::nextGreaterScope(scope);
+    }
+  }
+
+  // Pareto-distributed demand, scaled so that each priority's total demand
+  // is shaping_bench_overcommit times its configured rate.
+  std::vector<double> weights(nsockets);
+  std::vector<double> priority_weight(SHAPED_PRIORITIES.size());
+  std::uniform_real_distribution<double> uniform(0, 1);
+  for (size_t i = 0; i < nsockets; ++i) {
+    weights[i] =
+        std::pow(1 - uniform(rng_), -1.0 / FLAGS_shaping_bench_demand_skew);
+    priority_weight[i % SHAPED_PRIORITIES.size()] += weights[i];
+  }
+  double rate_per_quantum = double(FLAGS_shaping_bench_rate) /
+      SHAPED_PRIORITIES.size() * QUANTUM.count() / 1e6;
+  for (size_t i = 0; i < nsockets; ++i) {
+    size_t pidx = i % SHAPED_PRIORITIES.size();
+    double demand = weights[i] / priority_weight[pidx] * rate_per_quantum *
+        FLAGS_shaping_bench_overcommit;
+    size_t sender = rng_() % senders_.size();
+    sockets_[sender].push_back(
+        std::make_unique<Socket>(this, SHAPED_PRIORITIES[pidx], demand));
+  }
+}
+
+void TrafficShapingSim::dispatchUpdate() {
+  for (auto& policy_it : config_->flowGroupPolicies) {
+    auto& ge = update_.group_entries.at(policy_it.first);
+    ge.policy = policy_it.second.normalize(senders_.size(), QUANTUM);
+    auto& pq_overflow_entry = ge.priorityQEntry();
+    pq_overflow_entry.last_overflow = 0;
+    for (auto& overflow_entry : ge.overflow_entries) {
+      pq_overflow_entry.cur_overflow += overflow_entry.last_overflow;
+      overflow_entry.last_overflow = overflow_entry.cur_overflow;
+      overflow_entry.cur_overflow = 0;
+      overflow_entry.last_deposit_budget_overflow =
+          overflow_entry.cur_deposit_budget_overflow;
+      overflow_entry.cur_deposit_budget_overflow = 0;
+    }
+  }
+
+  // Like Processor::applyToWorkers(..., Order::RANDOM).
+  std::vector<size_t> order(senders_.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), rng_);
+  for (size_t idx : order) {
+    ShapingContainer& sender = *senders_[idx];
+    if (sender.applyFlowGroupsUpdate(update_, &stats_)) {
+      // ShapingContainer::runFlowGroups() needs a Worker, so run the
+      // FlowGroups directly.
+      for (auto& fg : sender.flow_groups_) {
+        fg.run(sender.flow_meters_mutex_,
+               SteadyTimestamp::now() + std::chrono::seconds(1));
+      }
+    }
+  }
+}
+
+void TrafficShapingSim::runQuantum() {
+  dispatchUpdate();
+  for (size_t i = 0; i < senders_.size(); ++i) {
+    // All traffic crosses the shaped ROOT scope.
+    FlowGroup& fg = senders_[i]->getFlowGroup(NodeLocationScope::ROOT);
+    for (auto& socket : sockets_[i]) {
+      socket->addDemand();
+      if (!socket->active()) {
+        socket->trySend(fg);
+      }
+    }
+  }
+}
+
+Report TrafficShapingSim::report(size_t nquanta,
+                                 std::chrono::nanoseconds cpu_time) const {
+  Report r;
+  double seconds = nquanta * QUANTUM.count() / 1e6;
+  double configured = double(FLAGS_shaping_bench_rate) /
+      SHAPED_PRIORITIES.size() * QUANTUM.count() / 1e6;
+  uint64_t total_sent = 0;
+  for (size_t pidx = 0; pidx < SHAPED_PRIORITIES.size(); ++pidx) {
+    std::vector<const Socket*> sockets;
+    for (auto& s : sockets_) {
+      for (auto& socket : s) {
+        if (socket->prio_ == SHAPED_PRIORITIES[pidx]) {
+          sockets.push_back(socket.get());
+        }
+      }
+    }
+
+    // Max-min fair share of the configured rate, by water filling in order
+    // of increasing demand.
+    std::sort(sockets.begin(), sockets.end(), [](auto a, auto b) {
+      return a->demand_ < b->demand_;
+    });
+    double left = configured;
+    double sum_x = 0;
+    double sum_x2 = 0;
+    uint64_t sent = 0;
+    for (size_t i = 0; i < sockets.size(); ++i) {
+      double share =
+          std::min(sockets[i]->demand_, left / (sockets.size() - i));
+      left -= share;
+      double x = sockets[i]->sent_ / (share * nquanta);
+      sum_x += x;
+      sum_x2 += x * x;
+      sent += sockets[i]->sent_;
+    }
+    total_sent += sent;
+    r.priorities.push_back(
+        {configured / QUANTUM.count() * 1e6,
+         sent / seconds,
+         sum_x2 > 0 ? sum_x * sum_x / (sockets.size() * sum_x2) : 0});
+  }
+  r.cpu_ns_per_mb =
+      total_sent > 0 ? cpu_time.count() / (total_sent / double(1 << 20)) : 0;
+  return r;
+}
+
+size_t runSim(size_t n, const std::string& name, size_t sockets, bool shaped) {
+  std::unique_ptr<TrafficShapingSim> sim;
+  BENCHMARK_SUSPEND {
+    sim = std::make_unique<TrafficShapingSim>(sockets, shaped);
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < n; ++i) {
+    sim->runQuantum();
+  }
+  auto cpu_time = std::chrono::steady_clock::now() - start;
+  BENCHMARK_SUSPEND {
+    // Folly calls the benchmark with increasing n; keep the longest run.
+    reports()[name] = sim->report(n, cpu_time);
+    sim.reset();
+  }
+  return n;
+}
+
+BENCHMARK_NAMED_PARAM_MULTI(runSim, unshaped_1k, "unshaped_1k", 1000, false)
+BENCHMARK_NAMED_PARAM_MULTI(runSim, shaped_1k, "shaped_1k", 1000, true)
+BENCHMARK_NAMED_PARAM_MULTI(runSim, unshaped_10k, "unshaped_10k", 10000, false)
+BENCHMARK_NAMED_PARAM_MULTI(runSim, shaped_10k, "shaped_10k", 10000, true)
+
+void printReports() {
+  printf("%-14s %-14s %12s %12s %8s\n",
+         "benchmark",
+         "priority",
+         "config MB/s",
+         "actual MB/s",
+         "jain");
+  for (auto& kv : reports()) {
+    for (size_t i = 0; i < kv.second.priorities.size(); ++i) {
+      auto& p = kv.second.priorities[i];
+      printf("%-14s %-14s %12.1f %12.1f %8.3f\n",
+             kv.first.c_str(),
+             PriorityMap::toName()[SHAPED_PRIORITIES[i]].c_str(),
+             p.configured_rate / (1 << 20),
+             p.achieved_rate / (1 << 20),
+             p.jain_index);
+    }
+    printf("%-14s cpu per shaped MB: %.0f ns\n",
+           kv.first.c_str(),
+           kv.second.cpu_ns_per_mb);
+  }
+}
+
+} // namespace
+
+#ifndef BENCHMARK_BUNDLE
+int main(int argc, char** argv) {
+  dbg::currentLevel = dbg::Level::ERROR;
+  folly::SingletonVault::singleton()->registrationComplete();
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  printReports();
+  return 0;
+}
+#endif
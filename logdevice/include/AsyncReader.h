@@ -9,6 +9,7 @@
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "logdevice/include/Record.h"
 #include "logdevice/include/types.h"
@@ -22,6 +23,25 @@ enum class HealthChangeType {
   LOG_UNHEALTHY = 1,
 };
 
+/**
+ * One entry of a batch passed to the callback set with
+ * AsyncReader::setRecordBatchCallback(). An entry is either a data record
+ * (`record` is set) or a gap (`record` is nullptr and `gap` is valid).
+ */
+struct RecordBatchEntry {
+  RecordBatchEntry() {}
+  explicit RecordBatchEntry(std::unique_ptr<DataRecord> r)
+      : record(std::move(r)) {}
+  explicit RecordBatchEntry(const GapRecord& g) : gap(g) {}
+
+  bool isGap() const {
+    return record == nullptr;
+  }
+
+  std::unique_ptr<DataRecord> record;
+  GapRecord gap;
+};
+
 /**
  * @file AsyncReader objects offer an alternative interface (to the
  * synchronous Reader) for reading logs.  Records are delivered via callbacks.
@@ -71,6 +91,26 @@ class AsyncReader {
    */
   virtual void setGapCallback(std::function<bool(const GapRecord&)>) = 0;
 
+  /**
+   * Sets a callback that the LogDevice client library will call with batches
+   * of records and gaps instead of calling the record and gap callbacks once
+   * per record or gap. Records and gaps read from one log during one
+   * iteration of the client's event loop are delivered in one call, in LSN
+   * order. Records keep referencing the buffers they were received in.
+   *
+   * The callback returns the number of entries at the front of the batch it
+   * consumed. The callback may move records out of consumed entries. The
+   * remaining entries must be left intact; they will be delivered again,
+   * possibly followed by more entries, after some time or on a
+   * resumeReading() call. Records and gaps that come after them are not
+   * delivered in the meantime.
+   *
+   * If set, the record and gap callbacks are not called. Only affects
+   * subsequent startReading() calls.
+   */
+  virtual void setRecordBatchCallback(
+      std::function<size_t(logid_t, std::vector<RecordBatchEntry>&)>) = 0;
+
   /**
    * Sets a callback that the LogDevice client library will call when it has
    * finished reading the requested range of LSNs.
@@ -218,6 +258,22 @@ class AsyncReader {
    */
   virtual void withoutPayload() = 0;
 
+  /**
+   * If called, data records read by this AsyncReader will not include payloads.
+   * Instead, the payload of each record is 8 bytes: the length of the
+   * original payload and its CRC32C, both as little-endian 32-bit integers.
+   * For records written with 32-bit checksums (the default), storage nodes
+   * take the hash from the stored checksum without touching the rest of the
+   * payload.
+   *
+   * This is meant for audits that compare copies of records without paying
+   * for transferring them. Buffered writes are not decoded: the hash covers
+   * the whole batch. withoutPayload() takes precedence over this.
+   *
+   * Only affects subsequent startReading() calls.
+   */
+  virtual void payloadHashOnly() = 0;
+
   /**
    * If called, disable the single copy delivery optimization even if the log is
    * configured to support it. Each data record will be sent by all storage
@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -20,11 +21,48 @@ namespace facebook { namespace logdevice {
  *
  * This class is not thread-safe; all calls must be made on the same thread.
  *
+ * Records compressed with a zstd dictionary can only be decoded once the
+ * dictionary is registered with BufferedWriter::registerZstdDictionary().
+ *
  * See logdevice/test/BufferedWriterTest.cpp for an example of how to use.
  */
 
 class BufferedWriteDecoderImpl;
 
+/**
+ * Columnar view of the payloads decoded by
+ * BufferedWriteDecoder::decodeColumns().  Every original append (payload
+ * group) is a row; every payload key is a column.  Payloads written with the
+ * single-payload API are in the column with key 0.
+ *
+ * All payload data lives in one contiguous buffer owned by the decoder, so
+ * the view is only valid as long as the decoder exists.
+ */
+struct PayloadColumns {
+  struct Column {
+    PayloadKey key;
+    // Start of the data of this column.  Payload of row i is
+    // [data + offsets[i], data + offsets[i + 1]).
+    const char* data = nullptr;
+    // rows + 1 entries.
+    std::vector<size_t> offsets;
+    // present[i] is 0 if row i doesn't contain this key (its payload is then
+    // empty).
+    std::vector<uint8_t> present;
+
+    Payload payload(size_t row) const {
+      const size_t len = offsets[row + 1] - offsets[row];
+      return Payload(len ? data + offsets[row] : nullptr, len);
+    }
+  };
+
+  // Number of decoded payload groups across all records, in the order of
+  // the records.
+  size_t rows = 0;
+  // Sorted by key.
+  std::vector<Column> columns;
+};
+
 class BufferedWriteDecoder {
  public:
   /**
@@ -74,6 +112,23 @@ class BufferedWriteDecoder {
   int decodeOne(std::unique_ptr<DataRecord>&& record,
                 std::vector<PayloadGroup>& payload_groups_out);
 
+  /**
+   * Bulk variant of decode() for consumers of many small payloads.  All
+   * payloads of `records' are decompressed into a single buffer owned by this
+   * decoder, and described by `columns_out' (which is overwritten) instead of
+   * one Payload or PayloadGroup per append, so decoding doesn't allocate per
+   * payload.
+   *
+   * Same ownership rules as decode(): successfully decoded records are
+   * consumed; the returned view is valid as long as this decoder exists.
+   *
+   * @returns On success, returns 0.  If some DataRecord's failed to decode,
+   *          return -1, leaving malformed records in `records'; the other
+   *          records are still decoded into `columns_out'.
+   */
+  int decodeColumns(std::vector<std::unique_ptr<DataRecord>>&& records,
+                    PayloadColumns& columns_out);
+
   /**
    * Decodes record without uncompressing any of the payloads. Batch must be
    * written using PayloadGroups API in BufferedWriter, otherwise decoding will
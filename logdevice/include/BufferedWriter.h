@@ -171,6 +171,14 @@ class BufferedWriter {
     // bytes buffered (negative for no trigger)
     ssize_t size_trigger = -1;
 
+    // If true, time_trigger is only an upper bound: the time a new batch is
+    // held open is picked based on the rate at which appends arrive for the
+    // log, flushing right away if no other append is expected within
+    // time_trigger, or once enough has likely arrived to reach size_trigger.
+    // Lowers the latency of quiet logs without shrinking batches of busy
+    // ones.  Has no effect if time_trigger is negative.
+    bool adaptive_time_trigger = false;
+
     enum class Mode {
       // Write each batch independently (also applies to retries if
       // configured).
@@ -232,6 +240,12 @@ class BufferedWriter {
     // will not contain payloads.
     bool destroy_payloads = false;
 
+    // If nonzero and compression is ZSTD, compress batches with the zstd
+    // dictionary with this ID (see registerZstdDictionary()).  Helps small
+    // batches of similar payloads the most.  Batches containing
+    // PayloadGroups don't use the dictionary.
+    uint32_t zstd_dictionary_id = 0;
+
     // Returns "independent" or "one_at_a_time".
     static std::string modeToString(Mode mode);
     // Returns 0 on success, -1 on error.
@@ -272,6 +286,18 @@ class BufferedWriter {
                                                 AppendCallback* callback,
                                                 Options options = Options());
 
+  /**
+   * Registers a zstd dictionary (e.g. trained with `zstd --train` on sample
+   * payloads) for this process, for LogOptions::zstd_dictionary_id.  Readers
+   * decoding batches compressed with it (BufferedWriteDecoder) must register
+   * it too; the batch names the dictionary it needs.  Registering a
+   * dictionary with the same ID again replaces it.
+   *
+   * @return 0 on success, -1 if the dictionary isn't in zstd dictionary
+   *         format or has no ID, with err set to E::INVALID_PARAM
+   */
+  static int registerZstdDictionary(std::string dictionary);
+
   /**
    * Same as Client::append() except the append may get buffered. If the call
    * succeeds it is added into a buffer, and finally appended to the log as a
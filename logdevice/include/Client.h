@@ -13,6 +13,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "logdevice/include/AsyncReader.h"
 #include "logdevice/include/ClientFactory.h"
@@ -75,6 +76,16 @@ typedef std::function<void(Status st, const DataRecord& r)> append_callback_t;
  */
 typedef std::function<void(Status, lsn_t result)> find_time_callback_t;
 
+/**
+ * Type of callback that is called when a non-blocking findTimeBatch() request
+ * completes. `results' has one (status, lsn) pair per log, in the order the
+ * logs were given.
+ *
+ * See findTimeBatch() for docs.
+ */
+typedef std::function<void(std::vector<std::pair<Status, lsn_t>> results)>
+    find_time_batch_callback_t;
+
 /**
  * Type of callback that is called when a non-blocking findKey() request
  * completes.
@@ -99,6 +110,16 @@ typedef std::function<void(Status, uint64_t result)> byte_offset_callback_t;
  */
 typedef std::function<void(Status)> trim_callback_t;
 
+/**
+ * Type of callback that is called when a non-blocking trimBatch() request
+ * completes. `results' has one status per trim, in the order the trims were
+ * given.
+ *
+ * See trimBatch() for docs.
+ */
+typedef std::function<void(std::vector<Status> results)>
+    trim_batch_callback_t;
+
 /**
  * Type of callback that is called when a non-blocking isLogEmpty() request
  * completes.
@@ -481,6 +502,19 @@ class Client {
    */
   virtual int trim(logid_t logid, lsn_t lsn, trim_callback_t cb) noexcept = 0;
 
+  /**
+   * Runs trim() for each (log, trim point) pair of `trims' and calls `cb'
+   * once, when all of them have completed. Meant for consumers that commit
+   * checkpoints of many logs at once.
+   *
+   * @return If at least one trim() was submitted, returns 0 and `cb' is
+   * guaranteed to be called later. Trims that couldn't be submitted get the
+   * error trim() failed with. Otherwise returns -1 with err set to
+   * E::INVALID_PARAM if `trims' is empty, or to the error of trim().
+   */
+  virtual int trimBatch(std::vector<std::pair<logid_t, lsn_t>> trims,
+                        trim_batch_callback_t cb) noexcept = 0;
+
   /**
    * Supply a write token.  Without this, writes to any logs configured to
    * require a write token will fail.
@@ -661,6 +695,23 @@ class Client {
            find_time_callback_t cb,
            FindKeyAccuracy accuracy = FindKeyAccuracy::STRICT) noexcept = 0;
 
+  /**
+   * Runs findTime() with the same timestamp for each of `logs' and calls `cb'
+   * once, when all of them have completed. Meant for jobs that start reading
+   * many logs from the same point in time; callers don't need to keep track
+   * of thousands of outstanding callbacks themselves.
+   *
+   * @return If at least one findTime() was submitted, returns 0 and `cb' is
+   * guaranteed to be called later. Logs whose request couldn't be submitted
+   * get the error findTime() failed with. Otherwise returns -1 with err set
+   * to E::INVALID_PARAM if `logs' is empty, or to the error of findTime().
+   */
+  virtual int findTimeBatch(std::vector<logid_t> logs,
+                            std::chrono::milliseconds timestamp,
+                            find_time_batch_callback_t cb,
+                            FindKeyAccuracy accuracy =
+                                FindKeyAccuracy::STRICT) noexcept = 0;
+
   /**
    * A non-blocking version of findKeySync().
    *
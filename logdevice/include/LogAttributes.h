@@ -59,6 +59,7 @@ constexpr char const* SHADOW = "shadow";
 constexpr char const* SHADOW_DEST = "destination";
 constexpr char const* SHADOW_RATIO = "ratio";
 constexpr char const* TAIL_OPTIMIZED = "tail_optimized";
+constexpr char const* STORAGE_COMPRESSION = "storage_compression";
 
 constexpr char const* EXTRAS = "extra_attributes";
 
@@ -324,7 +325,8 @@ class LogAttributes {
                       cv.sequencerBatchingCompression_,
                       cv.sequencerBatchingPassthruThreshold_,
                       cv.shadow_,
-                      cv.tailOptimized_);
+                      cv.tailOptimized_,
+                      cv.storageCompression_);
     }
 
    public:
@@ -358,7 +360,8 @@ class LogAttributes {
         const Attribute<Compression>& sequencerBatchingCompression,
         const Attribute<ssize_t>& sequencerBatchingPassthruThreshold,
         const Attribute<Shadow>& shadow,
-        const Attribute<bool>& tailOptimized)
+        const Attribute<bool>& tailOptimized,
+        const Attribute<Compression>& storageCompression)
         : replicationFactor_(replicationFactor),
           extraCopies_(extraCopies),
           syncedCopies_(syncedCopies),
@@ -385,7 +388,8 @@ class LogAttributes {
           sequencerBatchingPassthruThreshold_(
               sequencerBatchingPassthruThreshold),
           shadow_(shadow),
-          tailOptimized_(tailOptimized) {}
+          tailOptimized_(tailOptimized),
+          storageCompression_(storageCompression) {}
 
     bool operator==(const CommonValues& other) const {
       return as_tuple(*this) == as_tuple(other);
@@ -560,6 +564,13 @@ class LogAttributes {
      */
     Attribute<bool> tailOptimized_;
 
+    /**
+     * Compression of record payloads in the local log stores of storage
+     * nodes. Payloads are uncompressed before being sent to readers. Useful
+     * for compressible payloads that aren't compressed by BufferedWriter.
+     */
+    Attribute<Compression> storageCompression_;
+
     // WARNING: update operator== and friends when adding a new attribute
 
    public:
@@ -600,6 +611,7 @@ class LogAttributes {
     ACCESSOR(sequencerBatchingPassthruThreshold)
     ACCESSOR(shadow)
     ACCESSOR(tailOptimized)
+    ACCESSOR(storageCompression)
 
 #undef ACCESSOR
   };
@@ -645,6 +657,7 @@ class LogAttributes {
       const Attribute<ssize_t>& sequencerBatchingPassthruThreshold,
       const Attribute<Shadow>& shadow,
       const Attribute<bool>& tailOptimized,
+      const Attribute<Compression>& storageCompression,
       const Attribute<ExtrasMap>& extras)
       : common_(std::make_shared<const CommonValues>(
             replicationFactor,
@@ -672,7 +685,8 @@ class LogAttributes {
             sequencerBatchingCompression,
             sequencerBatchingPassthruThreshold,
             shadow,
-            tailOptimized)),
+            tailOptimized,
+            storageCompression)),
         extras_(extras) {}
 
   /**
@@ -727,7 +741,9 @@ class LogAttributes {
                       parent.common_->sequencerBatchingPassthruThreshold_),
             Attribute(attrs.common_->shadow_, parent.common_->shadow_),
             Attribute(attrs.common_->tailOptimized_,
-                      parent.common_->tailOptimized_))),
+                      parent.common_->tailOptimized_),
+            Attribute(attrs.common_->storageCompression_,
+                      parent.common_->storageCompression_))),
         extras_(attrs.extras_, parent.extras_) {}
 
   LogAttributes(CommonValuesPtr common, Attribute<ExtrasMap> extras)
@@ -815,6 +831,7 @@ class LogAttributes {
   ACCESSOR1(sequencerBatchingPassthruThreshold)
   ACCESSOR1(shadow)
   ACCESSOR1(tailOptimized)
+  ACCESSOR1(storageCompression)
 
   ACCESSOR2(extras)
 
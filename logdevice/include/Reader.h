@@ -192,6 +192,22 @@ class Reader {
    */
   virtual void withoutPayload() = 0;
 
+  /**
+   * If called, data records read by this Reader will not include payloads.
+   * Instead, the payload of each record is 8 bytes: the length of the
+   * original payload and its CRC32C, both as little-endian 32-bit integers.
+   * For records written with 32-bit checksums (the default), storage nodes
+   * take the hash from the stored checksum without touching the rest of the
+   * payload.
+   *
+   * This is meant for audits that compare copies of records without paying
+   * for transferring them. Buffered writes are not decoded: the hash covers
+   * the whole batch. withoutPayload() takes precedence over this.
+   *
+   * Only affects subsequent startReading() calls.
+   */
+  virtual void payloadHashOnly() = 0;
+
   /**
    * If called, disable the single copy delivery optimization even if the log is
    * configured to support it. Each data record will be sent by all storage
@@ -7,6 +7,8 @@
  */
 #include "logdevice/lib/AsyncReaderImpl.h"
 
+#include <algorithm>
+#include <iterator>
 #include <thread>
 
 #include <folly/Memory.h>
@@ -93,6 +95,11 @@ void AsyncReaderImpl::setRecordCallback(
   record_callback_ = std::move(cb);
 }
 
+void AsyncReaderImpl::setRecordBatchCallback(
+    std::function<size_t(logid_t, std::vector<RecordBatchEntry>&)> cb) {
+  record_batch_callback_ = std::move(cb);
+}
+
 void AsyncReaderImpl::setGapCallback(std::function<bool(const GapRecord&)> cb) {
   gap_callback_ = std::move(cb);
 }
@@ -202,7 +209,7 @@ bool AsyncReaderImpl::recordCallbackWrapper(
   // must be a DataRecordOwnsPayload. Downcast so we can access the metadata.
   ld_assert(dynamic_cast<DataRecordOwnsPayload*>(record.get()) != nullptr);
 
-  if (!record_callback_) {
+  if (!record_callback_ && !record_batch_callback_) {
     return true;
   }
 
@@ -226,10 +233,10 @@ bool AsyncReaderImpl::recordCallbackWrapper(
   DataRecordOwnsPayload* record_with_attributes =
       static_cast<DataRecordOwnsPayload*>(record.get());
   if ((record_with_attributes->flags_ & RECORD_Header::BUFFERED_WRITER_BLOB) &&
-      decode_buffered_writes_ && !without_payload_) {
+      decode_buffered_writes_ && !without_payload_ && !payload_hash_only_) {
     return handleBufferedWrite(record);
   } else {
-    bool rv = record_callback_(record);
+    bool rv = deliverRecordToApplication(record);
     if (!rv) {
       RATELIMIT_DEBUG(std::chrono::seconds(10),
                       10,
@@ -261,7 +268,7 @@ int AsyncReaderImpl::startReading(logid_t log_id,
     return -1;
   }
 
-  if (!record_callback_) {
+  if (!record_callback_ && !record_batch_callback_) {
     ld_error("called without specifying record callback for log_id %lu",
              log_id.val_);
     err = E::INVALID_PARAM;
@@ -295,6 +302,13 @@ int AsyncReaderImpl::startReading(logid_t log_id,
   read_stream_id_t rsid = processor_->issueReadStreamID();
 
   namespace arg = std::placeholders;
+  // When reading in batches, ClientReadStream only calls the gap callback for
+  // the last gap of the stream. It reaches the application as a batch of one.
+  ClientReadStreamDependencies::gap_cb_t gap_cb = gap_callback_;
+  if (record_batch_callback_) {
+    gap_cb =
+        std::bind(&AsyncReaderImpl::deliverGapToApplication, this, arg::_1);
+  }
   auto deps = std::make_unique<ClientReadStreamDependencies>(
       rsid,
       log_id,
@@ -302,7 +316,7 @@ int AsyncReaderImpl::startReading(logid_t log_id,
       // Safe to bind to `this', destructor blocks until ClientReadStream is
       // destroyed
       std::bind(&AsyncReaderImpl::recordCallbackWrapper, this, arg::_1),
-      gap_callback_,
+      std::move(gap_cb),
       done_callback_,
       client_->getEpochMetaDataCache(),
       // NOTE: The callback keeps a pointer to `this`.  No danger of the pointer
@@ -326,6 +340,12 @@ int AsyncReaderImpl::startReading(logid_t log_id,
         }
       });
   deps->setReaderName(reader_name_);
+  if (record_batch_callback_) {
+    deps->setRecordBatchCallback([this, log_id](
+                                     std::vector<RecordBatchEntry>& batch) {
+      return recordBatchCallbackWrapper(log_id, batch);
+    });
+  }
 
   auto read_stream = std::make_unique<ClientReadStream>(
       rsid,
@@ -458,35 +478,61 @@ int AsyncReaderImpl::isConnectionHealthy(logid_t log_id) const {
   return it->second.healthy.load() ? 1 : 0;
 }
 
-bool AsyncReaderImpl::handleBufferedWrite(std::unique_ptr<DataRecord>& record) {
-  // Make a copy of attributes, we'll need them after we pass
-  // ownership of `record'.
-  DataRecordOwnsPayload* record_with_attributes =
-      static_cast<DataRecordOwnsPayload*>(record.get());
-  const logid_t log_id = record_with_attributes->logid;
-  const DataRecordAttributes attrs = record_with_attributes->attrs;
-  const RECORD_flags_t flags = record_with_attributes->flags_;
-  record_with_attributes = nullptr; // no longer safe
+int AsyncReaderImpl::decodeBufferedWrite(
+    const DataRecord& record,
+    std::vector<std::unique_ptr<DataRecord>>& sub_records) {
+  const DataRecordOwnsPayload& record_with_attributes =
+      static_cast<const DataRecordOwnsPayload&>(record);
+  const DataRecordAttributes& attrs = record_with_attributes.attrs;
+  const RECORD_flags_t flags = record_with_attributes.flags_;
 
   auto decoder = std::make_shared<BufferedWriteDecoderImpl>();
   std::vector<PayloadGroup> payload_groups;
   // We use an overload of BufferedWriteDecoderImpl that does not claim
   // ownership of the input DataRecord, in case the client rejects delivery
   // and we need to return the record to ClientReadStream intact.
-  int rv = decoder->decodeOne(*record, payload_groups);
+  int rv = decoder->decodeOne(record, payload_groups);
   if (rv != 0) {
-    // Whoops, decoding failed. This is tragic and unlikely with checksums
-    // but let's generate a DATALOSS gap to inform the client.
-    if (!gap_callback_) {
-      return true;
-    }
-    GapRecord gap(log_id, GapType::DATALOSS, attrs.lsn, attrs.lsn);
-    return gap_callback_(gap);
+    return rv;
   }
 
   // Decoding succeeded. Now we need to create a DataRecordOwnsPayload for
-  // each original record, and call the callback for each one.
+  // each original record.
   int batch_offset = 0;
+  for (PayloadGroup& payload_group : payload_groups) {
+    sub_records.push_back(std::make_unique<DataRecordOwnsPayload>(
+        record.logid,
+        std::move(payload_group),
+        decoder, // shared ownership of the decoder
+        attrs.lsn,
+        attrs.timestamp,
+        flags & ~RECORD_Header::BUFFERED_WRITER_BLOB,
+        nullptr, // no rebuilding metadata
+        batch_offset++,
+        // Report the same offsets for all subrecords. This may be
+        // confusing but we don't have better options since offsets
+        // currently count the bytes of compressed batches.
+        attrs.offsets));
+  }
+  return 0;
+}
+
+bool AsyncReaderImpl::handleBufferedWrite(std::unique_ptr<DataRecord>& record) {
+  // Make a copy of attributes, we'll need them after we pass
+  // ownership of `record'.
+  const logid_t log_id = record->logid;
+  const lsn_t lsn = record->attrs.lsn;
+
+  std::vector<std::unique_ptr<DataRecord>> sub_records;
+  int rv = decodeBufferedWrite(*record, sub_records);
+  if (rv != 0) {
+    // Whoops, decoding failed. This is tragic and unlikely with checksums
+    // but let's generate a DATALOSS gap to inform the client.
+    return deliverGapToApplication(
+        GapRecord(log_id, GapType::DATALOSS, lsn, lsn));
+  }
+
+  // Call the callback for each original record.
   // If the client callback starts rejecting delivery halfway through the
   // batch, we buffer the rest of the batch for redelivery next time
   // ClientReadStream pokes us.
@@ -496,33 +542,19 @@ bool AsyncReaderImpl::handleBufferedWrite(std::unique_ptr<DataRecord>& record) {
   folly::SharedMutex::ReadHolder guard_map(nullptr);
   LogState* log_state = nullptr;
 
-  for (PayloadGroup& payload_group : payload_groups) {
-    std::unique_ptr<DataRecord> sub_record =
-        std::make_unique<DataRecordOwnsPayload>(
-            log_id,
-            std::move(payload_group),
-            decoder, // shared ownership of the decoder
-            attrs.lsn,
-            attrs.timestamp,
-            flags & ~RECORD_Header::BUFFERED_WRITER_BLOB,
-            nullptr, // no rebuilding metadata
-            batch_offset++,
-            // Report the same offsets for all subrecords. This may be
-            // confusing but we don't have better options since offsets
-            // currently count the bytes of compressed batches.
-            attrs.offsets);
+  for (std::unique_ptr<DataRecord>& sub_record : sub_records) {
     if (buffer_rest) {
       // The application already rejected a previous record in this batch,
       // just buffer for later redelivery
       log_state->pre_queue.push_back(std::move(sub_record));
       continue;
     }
-    if (!record_callback_(sub_record)) {
+    if (!deliverRecordToApplication(sub_record)) {
       RATELIMIT_DEBUG(std::chrono::seconds(10),
                       10,
                       "Record callback rejected sub-record of record %lu%s",
                       log_id.val_,
-                      lsn_to_string(attrs.lsn).c_str());
+                      lsn_to_string(lsn).c_str());
       // We'll buffer the rest.
       buffered_delivery_failed_.store(true);
       buffer_rest = true;
@@ -543,6 +575,84 @@ bool AsyncReaderImpl::handleBufferedWrite(std::unique_ptr<DataRecord>& record) {
   return !buffer_rest;
 }
 
+bool AsyncReaderImpl::deliverRecordToApplication(
+    std::unique_ptr<DataRecord>& record) {
+  if (!record_batch_callback_) {
+    return record_callback_(record);
+  }
+  // Last record of the stream, see ClientReadStream::record_batch_. Deliver
+  // it as a batch of one.
+  std::vector<RecordBatchEntry> batch;
+  batch.emplace_back(std::move(record));
+  const logid_t log_id = batch.front().record->logid;
+  if (record_batch_callback_(log_id, batch) > 0) {
+    return true;
+  }
+  record = std::move(batch.front().record);
+  return false;
+}
+
+bool AsyncReaderImpl::deliverGapToApplication(const GapRecord& gap) {
+  if (record_batch_callback_) {
+    std::vector<RecordBatchEntry> batch;
+    batch.emplace_back(gap);
+    return record_batch_callback_(gap.logid, batch) > 0;
+  }
+  return gap_callback_ ? gap_callback_(gap) : true;
+}
+
+size_t AsyncReaderImpl::recordBatchCallbackWrapper(
+    logid_t log_id,
+    std::vector<RecordBatchEntry>& batch) {
+  if (decode_buffered_writes_ && !without_payload_ && !payload_hash_only_) {
+    // Replace buffered writes with the records they contain. Entries that
+    // aren't consumed stay in the batch in their decoded form, so this only
+    // decodes each buffered write once.
+    auto is_blob = [](const RecordBatchEntry& entry) {
+      return !entry.isGap() &&
+          (static_cast<const DataRecordOwnsPayload*>(entry.record.get())
+               ->flags_ &
+           RECORD_Header::BUFFERED_WRITER_BLOB);
+    };
+    auto first_blob = std::find_if(batch.begin(), batch.end(), is_blob);
+    if (first_blob != batch.end()) {
+      std::vector<RecordBatchEntry> decoded;
+      decoded.reserve(batch.size());
+      std::move(batch.begin(), first_blob, std::back_inserter(decoded));
+      std::vector<std::unique_ptr<DataRecord>> sub_records;
+      for (auto it = first_blob; it != batch.end(); ++it) {
+        if (!is_blob(*it)) {
+          decoded.push_back(std::move(*it));
+          continue;
+        }
+        sub_records.clear();
+        if (decodeBufferedWrite(*it->record, sub_records) != 0) {
+          const lsn_t lsn = it->record->attrs.lsn;
+          decoded.emplace_back(
+              GapRecord(log_id, GapType::DATALOSS, lsn, lsn));
+          continue;
+        }
+        for (auto& sub_record : sub_records) {
+          decoded.emplace_back(std::move(sub_record));
+        }
+      }
+      batch.swap(decoded);
+    }
+  }
+
+  size_t consumed = record_batch_callback_(log_id, batch);
+  if (consumed < batch.size()) {
+    RATELIMIT_DEBUG(std::chrono::seconds(10),
+                    10,
+                    "Record batch callback consumed %zu of %zu entries of "
+                    "log %lu",
+                    consumed,
+                    batch.size(),
+                    log_id.val_);
+  }
+  return consumed;
+}
+
 int AsyncReaderImpl::drainBufferedRecords(logid_t log_id,
                                           const DataRecord& batch) {
   // This is a bit inefficient; we keep reacquiring the lock and repeating
@@ -587,7 +697,7 @@ int AsyncReaderImpl::drainBufferedRecords(logid_t log_id,
       record_mismatch = true;
     }
 
-    if (!record_callback_(record)) {
+    if (!deliverRecordToApplication(record)) {
       RATELIMIT_DEBUG(std::chrono::seconds(10),
                       10,
                       "Record callback rejected record %lu%s",
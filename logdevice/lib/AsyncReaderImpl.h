@@ -11,6 +11,7 @@
 #include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 
 #include <folly/SharedMutex.h>
 
@@ -31,6 +32,9 @@ class AsyncReaderImpl : public AsyncReader {
   void
   setRecordCallback(std::function<bool(std::unique_ptr<DataRecord>&)>) override;
   void setGapCallback(std::function<bool(const GapRecord&)>) override;
+  void setRecordBatchCallback(
+      std::function<size_t(logid_t, std::vector<RecordBatchEntry>&)>)
+      override;
   void setDoneCallback(std::function<void(logid_t)>) override;
   void setHealthChangeCallback(
       std::function<void(logid_t, HealthChangeType)>) override;
@@ -43,7 +47,7 @@ class AsyncReaderImpl : public AsyncReader {
   void setMonitoringTier(MonitoringTier tier) override;
   void addMonitoringTag(std::string) override;
   void withoutPayload() override;
-  void payloadHashOnly();
+  void payloadHashOnly() override;
   void forceNoSingleCopyDelivery() override;
   int isConnectionHealthy(logid_t) const override;
   void doNotDecodeBufferedWrites() override;
@@ -77,6 +81,23 @@ class AsyncReaderImpl : public AsyncReader {
   // Handles a record that is a buffered write and needs automatic decoding
   bool handleBufferedWrite(std::unique_ptr<DataRecord>& record);
 
+  // Decodes a buffered write into the records it contains, appending them to
+  // `sub_records'. Leaves `record' intact. Returns 0 on success, -1 if the
+  // record could not be decoded.
+  int decodeBufferedWrite(
+      const DataRecord& record,
+      std::vector<std::unique_ptr<DataRecord>>& sub_records);
+
+  // Call the application's record or gap callback. If the application reads
+  // in batches, these deliver a batch of one.
+  bool deliverRecordToApplication(std::unique_ptr<DataRecord>& record);
+  bool deliverGapToApplication(const GapRecord& gap);
+
+  // Wrapper around the application-provided batch callback that decodes
+  // buffered writes in the batch
+  size_t recordBatchCallbackWrapper(logid_t log_id,
+                                    std::vector<RecordBatchEntry>& batch);
+
   // Drains any BufferedWriter-originated records that were decoded by
   // handleBufferedWrite() but not successfully delivered to the application.
   // If there are such records, `batch' is expected to be the full batch
@@ -94,6 +115,8 @@ class AsyncReaderImpl : public AsyncReader {
 
   std::function<bool(std::unique_ptr<DataRecord>&)> record_callback_;
   std::function<bool(const GapRecord&)> gap_callback_;
+  std::function<size_t(logid_t, std::vector<RecordBatchEntry>&)>
+      record_batch_callback_;
   std::function<void(logid_t)> done_callback_;
   std::function<void(logid_t, HealthChangeType)> health_change_callback_;
 
@@ -45,6 +45,12 @@ int BufferedWriteDecoder::decodeOne(
   return impl()->decodeOne(std::move(record), payload_groups_out);
 }
 
+int BufferedWriteDecoder::decodeColumns(
+    std::vector<std::unique_ptr<DataRecord>>&& records,
+    PayloadColumns& columns_out) {
+  return impl()->decodeColumns(std::move(records), columns_out);
+}
+
 int BufferedWriteDecoder::decodeOneCompressed(
     std::unique_ptr<DataRecord>&& record,
     CompressedPayloadGroups& compressed_payload_groups_out) {
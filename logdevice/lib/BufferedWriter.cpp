@@ -11,6 +11,7 @@
 
 #include "logdevice/common/StreamWriterAppendSink.h"
 #include "logdevice/common/buffered_writer/BufferedWriterImpl.h"
+#include "logdevice/common/buffered_writer/ZstdDictionaryRegistry.h"
 #include "logdevice/common/util.h"
 #include "logdevice/lib/ClientImpl.h"
 #include "logdevice/lib/ClientProcessor.h"
@@ -57,6 +58,10 @@ BufferedWriter::create(std::shared_ptr<Client> client,
   return std::move(buffered_writer);
 }
 
+int BufferedWriter::registerZstdDictionary(std::string dictionary) {
+  return ZstdDictionaryRegistry::registerDictionary(std::move(dictionary));
+}
+
 int BufferedWriter::append(logid_t log_id,
                            std::string&& payload,
                            AppendCallback::Context cb_context,
@@ -8,11 +8,13 @@
 #include "logdevice/include/ClientFactory.h"
 
 #include <memory>
+#include <unordered_map>
 #include <utility>
 
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_generators.hpp>
 #include <boost/uuid/uuid_io.hpp>
+#include <folly/Synchronized.h>
 
 #include "logdevice/common/ConfigInit.h"
 #include "logdevice/common/NodesConfigurationInit.h"
@@ -89,6 +91,42 @@ bool applySettingOverrides(SettingsUpdater& updater) {
   return true;
 }
 
+using SharedRuntimeMap =
+    std::unordered_map<std::string, std::weak_ptr<ClientRuntime>>;
+
+// Runtimes of the clients created with --share-client-runtime, by config URL,
+// cluster name and credentials. Never destroyed, so that clients destroyed
+// during static destruction can still look it up.
+folly::Synchronized<SharedRuntimeMap>& sharedRuntimes() {
+  static auto* runtimes = new folly::Synchronized<SharedRuntimeMap>();
+  return *runtimes;
+}
+
+std::shared_ptr<ClientRuntime> findSharedRuntime(const std::string& key) {
+  auto runtimes = sharedRuntimes().wlock();
+  auto it = runtimes->find(key);
+  if (it == runtimes->end()) {
+    return nullptr;
+  }
+  std::shared_ptr<ClientRuntime> runtime = it->second.lock();
+  if (!runtime) {
+    // All clients that used it are gone.
+    runtimes->erase(it);
+  }
+  return runtime;
+}
+
+void addSharedRuntime(const std::string& key,
+                      std::shared_ptr<ClientRuntime> runtime) {
+  auto runtimes = sharedRuntimes().wlock();
+  auto& entry = (*runtimes)[key];
+  // If clients for the same cluster were created concurrently, the first one
+  // to finish gets to share its runtime.
+  if (!entry.lock()) {
+    entry = runtime;
+  }
+}
+
 } // namespace
 
 ClientFactory&
@@ -160,7 +198,10 @@ int ClientFactory::loadConfig(const std::string& config_url,
     // on_demand_logs_config enabled
     ld_info("Remote (on-demand) LogsConfig is ENABLED");
     auto cache_ttl = impl_settings->getSettings()->remote_logs_config_cache_ttl;
-    RemoteLogsConfig* raw_logs_cfg = new RemoteLogsConfig(timeout_, cache_ttl);
+    RemoteLogsConfig* raw_logs_cfg = new RemoteLogsConfig(
+        timeout_,
+        cache_ttl,
+        impl_settings->getSettings()->remote_logs_config_disk_cache_path);
     logs_cfg_processor_ptr_ptr = raw_logs_cfg->getProcessorPtrPtr();
     logs_cfg.reset(raw_logs_cfg);
   }
@@ -335,6 +376,40 @@ std::shared_ptr<Client> ClientFactory::create(std::string config_url) noexcept {
     return true;
   };
 
+  const bool share_runtime =
+      impl_settings->getSettings()->share_client_runtime;
+  const std::string runtime_key =
+      config_url + '\n' + cluster_name_ + '\n' + credentials_;
+  if (share_runtime) {
+    std::shared_ptr<ClientRuntime> runtime = findSharedRuntime(runtime_key);
+    if (runtime) {
+      auto config = runtime->config;
+      // The hook only sees later config updates, apply the client settings
+      // from the current config here.
+      if (!update_settings(*config->getServerConfig())) {
+        err = E::INVALID_CONFIG;
+        return nullptr;
+      }
+      auto config_update_handle =
+          config->updateableServerConfig()->addHook(std::move(update_settings));
+      auto client_impl = std::make_shared<ClientImpl>(cluster_name_,
+                                                      config,
+                                                      credentials_,
+                                                      csid_,
+                                                      timeout_,
+                                                      std::move(impl_settings),
+                                                      plugin_registry,
+                                                      std::move(runtime));
+      client_impl->addServerConfigHookHandle(std::move(config_update_handle));
+      logTimeTaken(start_time,
+                   cluster_name_.empty()
+                       ? config->getServerConfig()->getClusterName()
+                       : cluster_name_,
+                   config_url);
+      return client_impl;
+    }
+  }
+
   std::shared_ptr<std::weak_ptr<Processor>> processor_ptr_ptr;
   auto config = std::make_shared<UpdateableConfig>();
   auto config_update_handle =
@@ -367,6 +442,9 @@ std::shared_ptr<Client> ClientFactory::create(std::string config_url) noexcept {
 
   auto client_impl = std::static_pointer_cast<ClientImpl>(client_instance);
   client_impl->addServerConfigHookHandle(std::move(config_update_handle));
+  if (share_runtime) {
+    addSharedRuntime(runtime_key, client_impl->getRuntime());
+  }
 
   auto cluster_name = cluster_name_.empty()
       ? config->getServerConfig()->getClusterName()
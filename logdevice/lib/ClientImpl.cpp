@@ -33,6 +33,7 @@
 #include "logdevice/common/SnapshotStoreTypes.h"
 #include "logdevice/common/StatsCollectionThread.h"
 #include "logdevice/common/SyncSequencerRequest.h"
+#include "logdevice/common/TailInfoCache.h"
 #include "logdevice/common/TailRecord.h"
 #include "logdevice/common/ThreadID.h"
 #include "logdevice/common/TrimRequest.h"
@@ -49,6 +50,7 @@
 #include "logdevice/common/plugin/TraceLoggerFactory.h"
 #include "logdevice/common/plugin/ZookeeperClientFactory.h"
 #include "logdevice/common/replicated_state_machine/RsmSnapshotStoreFactory.h"
+#include "logdevice/common/request_util.h"
 #include "logdevice/common/settings/Settings.h"
 #include "logdevice/common/settings/UpdateableSettings.h"
 #include "logdevice/common/stats/Stats.h"
@@ -67,6 +69,19 @@ using facebook::logdevice::logsconfig::FBuffersLogsConfigCodec;
 
 namespace facebook { namespace logdevice {
 
+ClientRuntime::ClientRuntime() {}
+
+ClientRuntime::~ClientRuntime() {
+  if (processor) {
+    processor->shutdown();
+  }
+}
+
+void ClientRuntime::retireBridge(std::unique_ptr<ClientBridgeImpl> bridge) {
+  std::lock_guard<std::mutex> lock(retired_bridges_mutex_);
+  retired_bridges_.push_back(std::move(bridge));
+}
+
 bool ClientImpl::validateServerConfig(ServerConfig& cfg) const {
   ld_check(config_);
   ld_check(config_->get());
@@ -88,14 +103,14 @@ ClientImpl::ClientImpl(std::string cluster_name,
                        std::string csid,
                        std::chrono::milliseconds timeout,
                        std::unique_ptr<ClientSettings>&& client_settings,
-                       std::shared_ptr<PluginRegistry> plugin_registry)
+                       std::shared_ptr<PluginRegistry> plugin_registry,
+                       std::shared_ptr<ClientRuntime> shared_runtime)
     : plugin_registry_(std::move(plugin_registry)),
       cluster_name_(cluster_name),
       credentials_(std::move(credentials)),
       csid_(std::move(csid)),
       timeout_(timeout),
-      config_(std::move(config)),
-      bridge_(new ClientBridgeImpl(this)) {
+      config_(std::move(config)) {
   addServerConfigHookHandle(
       config_->updateableServerConfig()->addHook(std::bind(
           &ClientImpl::validateServerConfig, this, std::placeholders::_1)));
@@ -117,9 +132,17 @@ ClientImpl::ClientImpl(std::string cluster_name,
   const size_t metadata_cache_size = settings->client_epoch_metadata_cache_size;
   if (metadata_cache_size > 0) {
     epoch_metadata_cache_ =
-        std::make_unique<EpochMetaDataCache>(metadata_cache_size);
+        std::make_unique<EpochMetaDataCache>(
+            metadata_cache_size,
+            settings->client_epoch_metadata_cache_soft_ttl);
   }
 
+  if (shared_runtime) {
+    useSharedRuntime(std::move(shared_runtime));
+    return;
+  }
+
+  runtime_ = std::make_shared<ClientRuntime>();
   if (settings->stats_collection_interval.count() > 0 ||
       settings->client_test_force_stats) {
     auto params =
@@ -127,7 +150,7 @@ ClientImpl::ClientImpl(std::string cluster_name,
             settings->sequencer_boycotting.node_stats_send_period);
     // Only create StatsHolder when we're going to collect stats, primarily to
     // avoid instantianting thread-local Stats unnecessarily
-    stats_ = std::make_unique<StatsHolder>(std::move(params));
+    stats_ = std::make_shared<StatsHolder>(std::move(params));
   }
 
   STAT_SET(stats_.get(), client.client_started, 1);
@@ -147,6 +170,7 @@ ClientImpl::ClientImpl(std::string cluster_name,
 
   event_tracer_ =
       std::make_unique<ClientEventTracer>(trace_logger_, stats_.get());
+  bridge_ = std::make_unique<ClientBridgeImpl>(trace_logger_);
 
   processor_ = ClientProcessor::create(config_,
                                        trace_logger_,
@@ -210,7 +234,7 @@ ClientImpl::ClientImpl(std::string cluster_name,
     throw ConstructorFailed();
   }
 
-  stats_thread_ =
+  runtime_->stats_thread =
       StatsCollectionThread::maybeCreate(settings_->getSettings(),
                                          config_->get()->serverConfig(),
                                          plugin_registry_,
@@ -286,15 +310,55 @@ ClientImpl::ClientImpl(std::string cluster_name,
   settings_subscription_handle_ =
       settings.subscribeToUpdates([this] { this->updateStatsSettings(); });
 
+  runtime_->settings = settings_;
+  runtime_->config = config_;
+  runtime_->stats = stats_;
+  runtime_->trace_logger = trace_logger_;
+  runtime_->plugin_registry = plugin_registry_;
+  runtime_->processor = processor_;
+
   ld_info("Client created with Client Session id=%s", csid_.c_str());
 }
 
+void ClientImpl::useSharedRuntime(std::shared_ptr<ClientRuntime> runtime) {
+  ld_check(runtime->processor);
+  ld_check(config_ == runtime->config);
+  runtime_ = std::move(runtime);
+  stats_ = runtime_->stats;
+  trace_logger_ = runtime_->trace_logger;
+  processor_ = runtime_->processor;
+  csid_ = processor_->csid_;
+
+  STAT_SET(stats_.get(), client.client_started, 1);
+
+  event_tracer_ =
+      std::make_unique<ClientEventTracer>(trace_logger_, stats_.get());
+  bridge_ = std::make_unique<ClientBridgeImpl>(trace_logger_);
+
+  // The runtime already waited for the LogsConfig to be fully loaded.
+  ld_check(config_->getLogsConfig() != nullptr);
+
+  if (!settings_->getSettings()->shadow_client) {
+    shadow_ = std::make_unique<Shadow>(
+        cluster_name_, config_, settings_->getSettings(), stats_.get());
+  }
+
+  ld_info("Client created on a shared runtime with Client Session id=%s",
+          csid_.c_str());
+}
+
 ClientImpl::~ClientImpl() {
   auto start_time = std::chrono::steady_clock::now();
   ld_info("Destroying Client. Cluster name: %s", cluster_name_.c_str());
 
   server_config_hook_handles_.clear();
-  processor_->shutdown();
+  if (runtime_.use_count() > 1) {
+    // Other clients keep the Processor running, and requests of this client
+    // may still be in flight on it.
+    runtime_->retireBridge(std::move(bridge_));
+  }
+  // Shuts down the Processor if this was the last client using it.
+  runtime_.reset();
 
   auto end_time = std::chrono::steady_clock::now();
   ld_info("Destroyed Client in %.3f seconds. Cluster name: %s",
@@ -1552,6 +1616,62 @@ int ClientImpl::trim(logid_t logid, lsn_t lsn, trim_callback_t cb) noexcept {
   ;
 }
 
+int ClientImpl::trimBatch(std::vector<std::pair<logid_t, lsn_t>> trims,
+                          trim_batch_callback_t cb) noexcept {
+  if (trims.empty()) {
+    err = E::INVALID_PARAM;
+    return -1;
+  }
+
+  struct BatchState {
+    explicit BatchState(size_t n, trim_batch_callback_t c)
+        : results(n, E::UNKNOWN), remaining(n + 1), cb(std::move(c)) {}
+    std::vector<Status> results;
+    // One more than the number of trim()s in flight until all of them were
+    // submitted, so that `cb' isn't called before that.
+    std::atomic<size_t> remaining;
+    trim_batch_callback_t cb;
+  };
+  auto state = std::make_shared<BatchState>(trims.size(), std::move(cb));
+
+  size_t submitted = 0;
+  Status submit_error = E::OK;
+  for (size_t i = 0; i < trims.size(); ++i) {
+    int rv = trim(trims[i].first, trims[i].second, [state, i](Status st) {
+      // Each trim() writes only its own slot.
+      state->results[i] = st;
+      if (--state->remaining == 0) {
+        state->cb(std::move(state->results));
+      }
+    });
+    if (rv != 0) {
+      submit_error = err;
+      state->results[i] = err;
+      --state->remaining;
+    } else {
+      ++submitted;
+    }
+  }
+
+  if (submitted == 0) {
+    err = submit_error;
+    return -1;
+  }
+  if (--state->remaining == 0) {
+    // All trim()s already completed. Still call `cb' on a worker thread,
+    // like all other callbacks.
+    std::unique_ptr<Request> req = FuncRequest::make(
+        worker_id_t(-1), WorkerType::GENERAL, RequestType::MISC, [state] {
+          state->cb(std::move(state->results));
+        });
+    if (processor_->postRequest(req) != 0) {
+      // Better late than never.
+      state->cb(std::move(state->results));
+    }
+  }
+  return 0;
+}
+
 struct FindTimeGate {
   // called by FindKeyRequest when request processing completes or
   // timeout expires
@@ -1645,6 +1765,69 @@ int ClientImpl::findTime(logid_t logid,
   return processor_->postRequest(req);
 }
 
+int ClientImpl::findTimeBatch(std::vector<logid_t> logs,
+                              std::chrono::milliseconds timestamp,
+                              find_time_batch_callback_t cb,
+                              FindKeyAccuracy accuracy) noexcept {
+  if (logs.empty()) {
+    err = E::INVALID_PARAM;
+    return -1;
+  }
+
+  struct BatchState {
+    explicit BatchState(size_t n, find_time_batch_callback_t c)
+        : results(n, std::make_pair(E::UNKNOWN, LSN_INVALID)),
+          remaining(n + 1),
+          cb(std::move(c)) {}
+    std::vector<std::pair<Status, lsn_t>> results;
+    // One more than the number of findTime()s in flight until all of them
+    // were submitted, so that `cb' isn't called before that.
+    std::atomic<size_t> remaining;
+    find_time_batch_callback_t cb;
+  };
+  auto state = std::make_shared<BatchState>(logs.size(), std::move(cb));
+
+  size_t submitted = 0;
+  Status submit_error = E::OK;
+  for (size_t i = 0; i < logs.size(); ++i) {
+    int rv = findTime(logs[i],
+                      timestamp,
+                      [state, i](Status st, lsn_t result) {
+                        // Each findTime() writes only its own slot.
+                        state->results[i] = std::make_pair(st, result);
+                        if (--state->remaining == 0) {
+                          state->cb(std::move(state->results));
+                        }
+                      },
+                      accuracy);
+    if (rv != 0) {
+      submit_error = err;
+      state->results[i] = std::make_pair(err, LSN_INVALID);
+      --state->remaining;
+    } else {
+      ++submitted;
+    }
+  }
+
+  if (submitted == 0) {
+    err = submit_error;
+    return -1;
+  }
+  if (--state->remaining == 0) {
+    // All findTime()s already completed. Still call `cb' on a worker thread,
+    // like all other callbacks.
+    std::unique_ptr<Request> req = FuncRequest::make(
+        worker_id_t(-1), WorkerType::GENERAL, RequestType::MISC, [state] {
+          state->cb(std::move(state->results));
+        });
+    if (processor_->postRequest(req) != 0) {
+      // Better late than never.
+      state->cb(std::move(state->results));
+    }
+  }
+  return 0;
+}
+
 FindKeyResult ClientImpl::findKeySync(logid_t logid,
                                       std::string key,
                                       FindKeyAccuracy accuracy) noexcept {
@@ -1736,11 +1919,20 @@ int ClientImpl::isLogEmptySync(logid_t logid, bool* empty) noexcept {
 }
 
 int ClientImpl::isLogEmpty(logid_t logid, is_empty_callback_t cb) noexcept {
+  const auto ttl = settings_->getSettings()->tail_info_cache_ttl;
+  if (ttl.count() > 0) {
+    auto cached = processor_->tailInfoCache().getIsLogEmpty(logid, ttl);
+    if (cached.has_value()) {
+      return postCachedTailReply([cb, empty = cached.value()] {
+        cb(E::OK, empty);
+      });
+    }
+  }
   auto cb_wrapper =
-      [logid, cb, start = SteadyClock::now()](
+      [logid, cb, ttl, start = SteadyClock::now()](
           Status st,
           NodeID /*seq*/,
-          lsn_t /*next_lsn*/,
+          lsn_t next_lsn,
           std::unique_ptr<LogTailAttributes> /*tail_attributes*/,
           std::shared_ptr<const EpochMetaDataMap> /*metadata_map*/,
           std::shared_ptr<TailRecord> /*tail_record*/,
@@ -1748,6 +1940,9 @@ int ClientImpl::isLogEmpty(logid_t logid, is_empty_callback_t cb) noexcept {
         if (!is_log_empty.has_value()) {
           ld_check_ne(st, E::OK);
           is_log_empty = false;
+        } else if (st == E::OK && ttl.count() > 0) {
+          Worker::onThisThread()->processor_->tailInfoCache().update(
+              logid, next_lsn, nullptr, is_log_empty, ttl);
         }
         // log response
         Worker* w = Worker::onThisThread();
@@ -1880,8 +2075,17 @@ lsn_t ClientImpl::getTailLSNSync(logid_t logid) noexcept {
 }
 
 int ClientImpl::getTailLSN(logid_t logid, get_tail_lsn_callback_t cb) noexcept {
+  const auto ttl = settings_->getSettings()->tail_info_cache_ttl;
+  if (ttl.count() > 0) {
+    auto cached = processor_->tailInfoCache().getNextLSN(logid, ttl);
+    if (cached.has_value()) {
+      lsn_t next_lsn = cached.value();
+      auto resp = next_lsn <= LSN_OLDEST ? next_lsn : next_lsn - 1;
+      return postCachedTailReply([cb, resp] { cb(E::OK, resp); });
+    }
+  }
   auto cb_wrapper =
-      [logid, cb, start = SteadyClock::now()](
+      [logid, cb, ttl, start = SteadyClock::now()](
           Status st,
           NodeID /*seq*/,
           lsn_t next_lsn,
@@ -1889,6 +2093,10 @@ int ClientImpl::getTailLSN(logid_t logid, get_tail_lsn_callback_t cb) noexcept {
           std::shared_ptr<const EpochMetaDataMap> /*metadata_map*/,
           std::shared_ptr<TailRecord> /*tail_record*/,
           folly::Optional<bool> /*is_log_empty*/) {
+        if (st == E::OK && ttl.count() > 0) {
+          Worker::onThisThread()->processor_->tailInfoCache().update(
+              logid, next_lsn, nullptr, folly::none, ttl);
+        }
         auto resp = next_lsn <= LSN_OLDEST ? next_lsn : next_lsn - 1;
         // log response
         Worker* w = Worker::onThisThread();
@@ -1909,6 +2117,16 @@ int ClientImpl::getTailLSN(logid_t logid, get_tail_lsn_callback_t cb) noexcept {
   return processor_->postRequest(req);
 }
 
+int ClientImpl::postCachedTailReply(std::function<void()> reply) noexcept {
+  // Callbacks are always called on a worker thread, also for answers that
+  // came from the cache.
+  std::unique_ptr<Request> req = FuncRequest::make(worker_id_t(-1),
+                                                   WorkerType::GENERAL,
+                                                   RequestType::MISC,
+                                                   std::move(reply));
+  return processor_->postRequest(req);
+}
+
 std::unique_ptr<LogTailAttributes>
 ClientImpl::getTailAttributesSync(logid_t logid) noexcept {
   std::unique_ptr<LogTailAttributes> tail_attributes;
@@ -1937,14 +2155,28 @@ ClientImpl::getTailAttributesSync(logid_t logid) noexcept {
 
 int ClientImpl::getTailAttributes(logid_t logid,
                                   get_tail_attributes_callback_t cb) noexcept {
-  auto cb_wrapper = [logid, cb, start = SteadyClock::now()](
+  const auto ttl = settings_->getSettings()->tail_info_cache_ttl;
+  if (ttl.count() > 0) {
+    std::shared_ptr<LogTailAttributes> cached =
+        processor_->tailInfoCache().getTailAttributes(logid, ttl);
+    if (cached) {
+      return postCachedTailReply([cb, cached] {
+        cb(E::OK, std::make_unique<LogTailAttributes>(*cached));
+      });
+    }
+  }
+  auto cb_wrapper = [logid, cb, ttl, start = SteadyClock::now()](
                         Status st,
                         NodeID /*seq*/,
-                        lsn_t /*next_lsn*/,
+                        lsn_t next_lsn,
                         std::unique_ptr<LogTailAttributes> tail_attributes,
                         std::shared_ptr<const EpochMetaDataMap> /*unused*/,
                         std::shared_ptr<TailRecord> /*unused*/,
                         folly::Optional<bool> /*unused*/) {
+    if (st == E::OK && tail_attributes && ttl.count() > 0) {
+      Worker::onThisThread()->processor_->tailInfoCache().update(
+          logid, next_lsn, tail_attributes.get(), folly::none, ttl);
+    }
     // log response
     Worker* w = Worker::onThisThread();
     if (w) {
@@ -2309,13 +2541,25 @@ ClientImpl::createRequest(logid_t logid,
                           AppendAttributes attrs,
                           worker_id_t target_worker,
                           std::unique_ptr<std::string> per_request_token) {
+  const auto settings = settings_->getSettings();
+  const bool precompute_checksum = settings->checksum_bits > 0 &&
+      settings->precompute_checksum_min_size > 0 &&
+      payload.size() >= settings->precompute_checksum_min_size;
   auto req = std::make_unique<AppendRequest>(
       bridge_.get(),
       logid,
       std::move(attrs),
       std::move(payload),
-      settings_->getSettings()->append_timeout.value_or(timeout_),
+      settings->append_timeout.value_or(timeout_),
       std::move(cb));
+  if (precompute_checksum) {
+    // Large payload, checksum it here rather than on the Worker.
+    req->precomputeChecksum(settings->checksum_bits);
+  }
+  if (settings->e2e_latency_sampling_rate > 0 &&
+      folly::Random::randDouble01() < settings->e2e_latency_sampling_rate) {
+    req->setE2ETracedFlag();
+  }
 
   if (target_worker.val_ > -1) {
     ld_check(target_worker.val_ <
@@ -2361,6 +2605,14 @@ void ClientImpl::updateStatsSettings() {
   }
 }
 
+void ClientImpl::addWriteToken(std::string token) noexcept {
+  bridge_->addWriteToken(std::move(token));
+}
+
+bool ClientImpl::hasWriteToken(const std::string& required) const {
+  return bridge_->hasWriteToken(required);
+}
+
 void ClientImpl::setAppendErrorInjector(
     folly::Optional<AppendErrorInjector> injector) {
   append_error_injector_ = injector;
@@ -2371,7 +2623,7 @@ void ClientImpl::registerCustomStats(StatsHolder* custom_stats) {
   // also means that we won't have to take care of starting the stats
   // collection thread or anything like that.
   if (stats_) {
-    stats_thread_->addStatsSource(custom_stats);
+    runtime_->stats_thread->addStatsSource(custom_stats);
   }
 }
 
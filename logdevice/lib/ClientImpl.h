@@ -14,6 +14,7 @@
 #include <string>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include <folly/SharedMutex.h>
 
@@ -59,6 +60,38 @@ class StatsHolder;
 class TailRecord;
 class TraceLogger;
 
+/**
+ * The part of a client that talks to the cluster: the Processor with its
+ * workers and connections, the config it keeps up to date and stats. Each
+ * client has its own, unless clients are created with --share-client-runtime,
+ * in which case ClientFactory hands the runtime of the first client of a
+ * cluster to the next ones. Shuts the Processor down when the last client
+ * using it is destroyed.
+ */
+class ClientRuntime {
+ public:
+  ClientRuntime();
+  ~ClientRuntime();
+
+  // Keeps the bridge of a destroyed client alive until the Processor is shut
+  // down, for requests of that client still running on its workers.
+  void retireBridge(std::unique_ptr<ClientBridgeImpl> bridge);
+
+  // Settings of the client that created the runtime, which the Processor
+  // runs with.
+  std::shared_ptr<ClientSettingsImpl> settings;
+  std::shared_ptr<UpdateableConfig> config;
+  std::shared_ptr<StatsHolder> stats;
+  std::shared_ptr<TraceLogger> trace_logger;
+  std::shared_ptr<PluginRegistry> plugin_registry;
+  std::shared_ptr<ClientProcessor> processor;
+  std::unique_ptr<StatsCollectionThread> stats_thread;
+
+ private:
+  std::mutex retired_bridges_mutex_;
+  std::vector<std::unique_ptr<ClientBridgeImpl>> retired_bridges_;
+};
+
 class ClientImpl : public Client,
                    public std::enable_shared_from_this<ClientImpl>,
                    public BufferedWriterAppendSink {
@@ -72,6 +105,9 @@ class ClientImpl : public Client,
    * call shared_from_this() which requires the object to already be managed
    * by a shared_ptr. See Client::create() for a description of
    * arguments. credentials are currently unused.
+   *
+   * If `shared_runtime` is given, the client uses it instead of creating its
+   * own Processor, and `config` must be the runtime's.
    */
   ClientImpl(std::string cluster_name,
              std::shared_ptr<UpdateableConfig> config,
@@ -79,7 +115,8 @@ class ClientImpl : public Client,
              std::string csid,
              std::chrono::milliseconds timeout,
              std::unique_ptr<ClientSettings>&& settings,
-             std::shared_ptr<PluginRegistry> plugin_registry);
+             std::shared_ptr<PluginRegistry> plugin_registry,
+             std::shared_ptr<ClientRuntime> shared_runtime = nullptr);
 
   virtual ~ClientImpl() override;
 
@@ -185,10 +222,10 @@ class ClientImpl : public Client,
 
   int trim(logid_t logid, lsn_t lsn, trim_callback_t cb) noexcept override;
 
-  void addWriteToken(std::string token) noexcept override {
-    folly::SharedMutex::WriteHolder guard(write_tokens_mutex_);
-    write_tokens_.insert(token);
-  }
+  int trimBatch(std::vector<std::pair<logid_t, lsn_t>> trims,
+                trim_batch_callback_t cb) noexcept override;
+
+  void addWriteToken(std::string token) noexcept override;
 
   lsn_t findTimeSync(logid_t logid,
                      std::chrono::milliseconds timestamp,
@@ -200,6 +237,11 @@ class ClientImpl : public Client,
                find_time_callback_t cb,
                FindKeyAccuracy accuracy) noexcept override;
 
+  int findTimeBatch(std::vector<logid_t> logs,
+                    std::chrono::milliseconds timestamp,
+                    find_time_batch_callback_t cb,
+                    FindKeyAccuracy accuracy) noexcept override;
+
   FindKeyResult findKeySync(logid_t logid,
                             std::string key,
                             FindKeyAccuracy accuracy) noexcept override;
@@ -401,6 +443,10 @@ class ClientImpl : public Client,
     return processor_;
   }
 
+  const std::shared_ptr<ClientRuntime>& getRuntime() const {
+    return runtime_;
+  }
+
   StatsHolder* stats() const {
     return stats_.get();
   }
@@ -445,10 +491,7 @@ class ClientImpl : public Client,
     return checkAppendImpl(logid, payload_size, allow_extra, false);
   }
 
-  bool hasWriteToken(const std::string& required) const {
-    folly::SharedMutex::ReadHolder guard(write_tokens_mutex_);
-    return write_tokens_.count(required);
-  }
+  bool hasWriteToken(const std::string& required) const;
 
   const std::string& getClientSessionID() const {
     return csid_;
@@ -504,6 +547,9 @@ class ClientImpl : public Client,
 
   void updateStatsSettings();
 
+  // Takes the Processor, stats etc. from `runtime` instead of creating them.
+  void useSharedRuntime(std::shared_ptr<ClientRuntime> runtime);
+
   int getLocalDirectory(const std::string& path,
                         get_directory_callback_t cb) noexcept;
 
@@ -515,6 +561,10 @@ class ClientImpl : public Client,
 
   bool hasFullyLoadedLocalLogsConfig() const;
 
+  // Runs `reply' on a worker to answer getTailLSN(), getTailAttributes() or
+  // isLogEmpty() from the TailInfoCache. Returns the result of postRequest().
+  int postCachedTailReply(std::function<void()> reply) noexcept;
+
   std::shared_ptr<PluginRegistry> plugin_registry_;
 
   std::string cluster_name_;
@@ -532,28 +582,26 @@ class ClientImpl : public Client,
   uint64_t logsconfig_api_random_seed_;
 
   // Order matters.  Settings need to stick around longer than the Processor.
-  std::unique_ptr<ClientSettingsImpl> settings_;
+  // Shared with runtime_ if this client created it.
+  std::shared_ptr<ClientSettingsImpl> settings_;
 
   // cache epoch metadata entries read from the metadata log
   std::unique_ptr<EpochMetaDataCache> epoch_metadata_cache_;
 
   std::shared_ptr<UpdateableConfig> config_;
 
-  std::unique_ptr<StatsHolder> stats_;
+  std::shared_ptr<StatsHolder> stats_;
 
   std::unique_ptr<ClientBridgeImpl> bridge_;
 
   std::unique_ptr<ClientEventTracer> event_tracer_;
 
-  // Set of write tokens added with addWriteToken().  Consulted on every write
-  // to see if the write should be allowed.
-  std::unordered_set<std::string> write_tokens_;
-  folly::SharedMutex write_tokens_mutex_;
-
   // The pointer to the processor might be shared with RemoteLogsConfig
   std::shared_ptr<ClientProcessor> processor_;
 
-  std::unique_ptr<StatsCollectionThread> stats_thread_;
+  // Owns the Processor, possibly shared with other clients. Its members
+  // above are copies of the runtime's.
+  std::shared_ptr<ClientRuntime> runtime_;
 
   // Should be deleted before config and settings
   std::unique_ptr<Shadow> shadow_;
@@ -572,20 +620,34 @@ class ClientImpl : public Client,
   folly::Optional<AppendErrorInjector> append_error_injector_;
 };
 
+// Doesn't refer back to the client, so that it can outlive it, see
+// ClientRuntime::retireBridge().
 class ClientBridgeImpl : public ClientBridge {
  public:
-  explicit ClientBridgeImpl(ClientImpl* parent) : parent_(parent) {}
+  explicit ClientBridgeImpl(std::shared_ptr<TraceLogger> trace_logger)
+      : trace_logger_(std::move(trace_logger)) {}
 
   const std::shared_ptr<TraceLogger> getTraceLogger() const override {
-    return parent_->getTraceLogger();
+    return trace_logger_;
   }
 
   bool hasWriteToken(const std::string& required) const override {
-    return parent_->hasWriteToken(required);
+    folly::SharedMutex::ReadHolder guard(write_tokens_mutex_);
+    return write_tokens_.count(required);
+  }
+
+  void addWriteToken(std::string token) {
+    folly::SharedMutex::WriteHolder guard(write_tokens_mutex_);
+    write_tokens_.insert(std::move(token));
   }
 
  private:
-  ClientImpl* parent_;
+  std::shared_ptr<TraceLogger> trace_logger_;
+
+  // Set of write tokens added with addWriteToken().  Consulted on every write
+  // to see if the write should be allowed.
+  std::unordered_set<std::string> write_tokens_;
+  mutable folly::SharedMutex write_tokens_mutex_;
 };
 
 }} // namespace facebook::logdevice
@@ -35,9 +35,13 @@ ClientMessageDispatch::onReceivedImpl(Message* msg,
     case MessageType::GET_EPOCH_RECOVERY_METADATA:
     case MessageType::GET_EPOCH_RECOVERY_METADATA_REPLY:
     case MessageType::GET_HEAD_ATTRIBUTES:
+    case MessageType::MULTI_AMEND:
+    case MessageType::MULTI_RELEASE:
+    case MessageType::MULTI_SEAL:
     case MessageType::NODE_STATS:
     case MessageType::NODE_STATS_AGGREGATE:
     case MessageType::NODE_STATS_AGGREGATE_REPLY:
+    case MessageType::READ_CONTROL:
     case MessageType::RELEASE:
     case MessageType::SEAL:
     case MessageType::START:
@@ -76,6 +80,7 @@ void ClientMessageDispatch::onSentImpl(const Message& msg,
       return;
 
     case MessageType::GET_EPOCH_RECOVERY_METADATA:
+    case MessageType::MULTI_RECORD:
     case MessageType::NODE_STATS_AGGREGATE:
     case MessageType::NODE_STATS_AGGREGATE_REPLY:
     case MessageType::NODE_STATS_REPLY:
@@ -0,0 +1,256 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/lib/LogsConfigDiskCache.h"
+
+#include <cstring>
+
+#include <folly/ExceptionString.h>
+#include <folly/FileUtil.h>
+#include <folly/Range.h>
+
+#include "logdevice/common/Checksum.h"
+#include "logdevice/common/configuration/logs/FBuffersLogsConfigCodec.h"
+#include "logdevice/common/debug.h"
+
+namespace facebook { namespace logdevice {
+
+namespace {
+
+constexpr uint32_t MAGIC = 0x434c444c; // "LDLC"
+constexpr uint8_t FORMAT_VERSION = 1;
+// Larger files are not ours or not worth loading.
+constexpr size_t MAX_FILE_SIZE = 256 * 1024 * 1024;
+
+template <typename T>
+void append(std::string& out, T value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendString(std::string& out, const std::string& s) {
+  append<uint32_t>(out, s.size());
+  out.append(s);
+}
+
+template <typename T>
+bool consume(folly::StringPiece& in, T* value) {
+  if (in.size() < sizeof(T)) {
+    return false;
+  }
+  std::memcpy(value, in.data(), sizeof(T));
+  in.advance(sizeof(T));
+  return true;
+}
+
+bool consumeString(folly::StringPiece& in, std::string* s) {
+  uint32_t size;
+  if (!consume(in, &size) || in.size() < size) {
+    return false;
+  }
+  s->assign(in.data(), size);
+  in.advance(size);
+  return true;
+}
+
+} // namespace
+
+constexpr std::chrono::seconds LogsConfigDiskCache::MIN_WRITE_INTERVAL;
+
+LogsConfigDiskCache::LogsConfigDiskCache(std::string path)
+    : path_(std::move(path)) {
+  ld_check(!path_.empty());
+}
+
+LogsConfigDiskCache::~LogsConfigDiskCache() {
+  flush();
+}
+
+logsconfig::LogGroupNodePtr
+LogsConfigDiskCache::get(logid_t id,
+                         const std::string& cluster_name,
+                         const std::string& delimiter) {
+  if (cluster_name.empty()) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  loadLocked(cluster_name, delimiter);
+
+  auto it = entries_.upper_bound(id.val_);
+  if (it == entries_.begin()) {
+    return nullptr;
+  }
+  --it;
+  if (it->second.hi < id.val_) {
+    return nullptr;
+  }
+  const std::string& payload = it->second.payload;
+  std::shared_ptr<logsconfig::LogGroupNode> log =
+      logsconfig::FBuffersLogsConfigCodec::deserialize<
+          logsconfig::LogGroupNode>(
+          Payload(payload.data(), payload.size()), delimiter_);
+  if (log == nullptr) {
+    ld_error("Failed to deserialize log group of log %lu from %s, dropping it "
+             "from the cache",
+             id.val_,
+             path_.c_str());
+    entries_.erase(it);
+    dirty_ = true;
+  }
+  return log;
+}
+
+void LogsConfigDiskCache::put(const logsconfig::LogGroupNodePtr& log,
+                              const std::string& cluster_name,
+                              const std::string& delimiter) {
+  ld_check(log);
+  if (cluster_name.empty()) {
+    return;
+  }
+  const logid_range_t range = log->range();
+  PayloadHolder serialized =
+      logsconfig::FBuffersLogsConfigCodec::serialize(*log, /*flatten=*/true);
+  Payload payload = serialized.getPayload();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  loadLocked(cluster_name, delimiter);
+
+  // Drop the log groups overlapping with the new one.
+  auto it = entries_.upper_bound(range.first.val_);
+  if (it != entries_.begin() &&
+      std::prev(it)->second.hi >= range.first.val_) {
+    --it;
+  }
+  while (it != entries_.end() && it->first <= range.second.val_) {
+    it = entries_.erase(it);
+  }
+  entries_[range.first.val_] = Entry{
+      range.second.val_,
+      std::string(static_cast<const char*>(payload.data()), payload.size())};
+  dirty_ = true;
+
+  if (std::chrono::steady_clock::now() - last_write_ >= MIN_WRITE_INTERVAL) {
+    flushLocked();
+  }
+}
+
+void LogsConfigDiskCache::flush() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  flushLocked();
+}
+
+void LogsConfigDiskCache::loadLocked(const std::string& cluster_name,
+                                     const std::string& delimiter) {
+  if (loaded_) {
+    return;
+  }
+  loaded_ = true;
+  cluster_name_ = cluster_name;
+  delimiter_ = delimiter;
+
+  std::string data;
+  if (!folly::readFile(path_.c_str(), data, MAX_FILE_SIZE)) {
+    if (errno != ENOENT) {
+      ld_warning("Failed to read LogsConfig cache file %s: %s",
+                 path_.c_str(),
+                 strerror(errno));
+    }
+    return;
+  }
+  if (!parse(data)) {
+    entries_.clear();
+    return;
+  }
+  ld_info("Loaded %zu log groups from LogsConfig cache file %s",
+          entries_.size(),
+          path_.c_str());
+}
+
+bool LogsConfigDiskCache::parse(const std::string& data) {
+  if (data.size() < sizeof(uint64_t)) {
+    ld_warning("LogsConfig cache file %s is truncated, ignoring it",
+               path_.c_str());
+    return false;
+  }
+  folly::StringPiece in(data.data(), data.size() - sizeof(uint64_t));
+  uint64_t expected_checksum;
+  std::memcpy(&expected_checksum, in.end(), sizeof(expected_checksum));
+  if (checksum_64bit(Slice(in.data(), in.size())) != expected_checksum) {
+    ld_warning("Checksum mismatch in LogsConfig cache file %s, ignoring it",
+               path_.c_str());
+    return false;
+  }
+
+  uint32_t magic;
+  uint8_t format, codec;
+  std::string cluster_name, delimiter;
+  if (!consume(in, &magic) || !consume(in, &format) || !consume(in, &codec) ||
+      !consumeString(in, &cluster_name) || !consumeString(in, &delimiter) ||
+      magic != MAGIC) {
+    ld_warning("LogsConfig cache file %s is malformed, ignoring it",
+               path_.c_str());
+    return false;
+  }
+  if (format != FORMAT_VERSION ||
+      codec != logsconfig::FBuffersLogsConfigCodec::CODEC_VERSION ||
+      cluster_name != cluster_name_ || delimiter != delimiter_) {
+    ld_info("LogsConfig cache file %s was written for another cluster or "
+            "version, ignoring it",
+            path_.c_str());
+    return false;
+  }
+
+  while (!in.empty()) {
+    logid_t::raw_type lo, hi;
+    Entry entry;
+    if (!consume(in, &lo) || !consume(in, &hi) ||
+        !consumeString(in, &entry.payload) || hi < lo) {
+      ld_warning("LogsConfig cache file %s is malformed, ignoring it",
+                 path_.c_str());
+      return false;
+    }
+    entry.hi = hi;
+    entries_[lo] = std::move(entry);
+  }
+  return true;
+}
+
+void LogsConfigDiskCache::flushLocked() {
+  if (!dirty_) {
+    return;
+  }
+  ld_check(loaded_);
+
+  std::string out;
+  append(out, MAGIC);
+  append(out, FORMAT_VERSION);
+  append(out, logsconfig::FBuffersLogsConfigCodec::CODEC_VERSION);
+  appendString(out, cluster_name_);
+  appendString(out, delimiter_);
+  for (const auto& kv : entries_) {
+    append(out, kv.first);
+    append(out, kv.second.hi);
+    appendString(out, kv.second.payload);
+  }
+  append(out, checksum_64bit(Slice(out.data(), out.size())));
+
+  // Whether or not it succeeds, don't retry before MIN_WRITE_INTERVAL.
+  last_write_ = std::chrono::steady_clock::now();
+  dirty_ = false;
+  try {
+    // writes to a temporary file and renames it, so that a crashing client
+    // leaves either the old or the new file behind
+    folly::writeFileAtomic(path_, out);
+  } catch (const std::exception& ex) {
+    RATELIMIT_WARNING(std::chrono::seconds(10),
+                      1,
+                      "Failed to write LogsConfig cache file %s: %s",
+                      path_.c_str(),
+                      folly::exceptionStr(ex).toStdString().c_str());
+  }
+}
+
+}} // namespace facebook::logdevice
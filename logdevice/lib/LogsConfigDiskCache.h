@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "logdevice/common/configuration/logs/LogsConfigTree.h"
+#include "logdevice/include/types.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file LogsConfigDiskCache persists the log groups a RemoteLogsConfig has
+ * fetched from the cluster, so that a restarted client can resolve the
+ * attributes of the logs it used last time without waiting for a round trip
+ * to a server. Each log group is stored as FlatBuffers, in the format of
+ * FBuffersLogsConfigCodec, and only decoded when looked up.
+ *
+ * The file is only used if it was written with the same file format and codec
+ * versions, for the same cluster name and with the same namespace delimiter,
+ * and if its checksum matches. Otherwise it is ignored and overwritten.
+ *
+ * Entries are served as a hint: RemoteLogsConfig refreshes every entry it
+ * reads from the cache in the background.
+ *
+ * Thread safe.
+ */
+class LogsConfigDiskCache {
+ public:
+  // Minimum time between two writes of the file. Updates are batched in the
+  // meantime and written by the next put() after that, or on destruction.
+  static constexpr std::chrono::seconds MIN_WRITE_INTERVAL{10};
+
+  explicit LogsConfigDiskCache(std::string path);
+
+  // Writes the pending updates, if any.
+  ~LogsConfigDiskCache();
+
+  /**
+   * Looks up the log group containing `id`. The first call to get() or put()
+   * reads the file, and ignores it unless it was written for `cluster_name`
+   * and `delimiter`. Calls with an empty `cluster_name` are no-ops.
+   *
+   * @return  the log group, or nullptr if not in the cache.
+   */
+  logsconfig::LogGroupNodePtr get(logid_t id,
+                                  const std::string& cluster_name,
+                                  const std::string& delimiter);
+
+  // Records `log`, replacing the log groups it overlaps with.
+  void put(const logsconfig::LogGroupNodePtr& log,
+           const std::string& cluster_name,
+           const std::string& delimiter);
+
+  // Writes the pending updates to the file.
+  void flush();
+
+ private:
+  struct Entry {
+    // last log id of the range, the first one is the map key
+    logid_t::raw_type hi;
+    // FBuffersLogsConfigCodec-serialized LogGroupNode
+    std::string payload;
+  };
+
+  const std::string path_;
+
+  std::mutex mutex_;
+  bool loaded_{false};
+  std::string cluster_name_;
+  std::string delimiter_;
+  std::map<logid_t::raw_type, Entry> entries_;
+  bool dirty_{false};
+  std::chrono::steady_clock::time_point last_write_;
+
+  void loadLocked(const std::string& cluster_name,
+                  const std::string& delimiter);
+  bool parse(const std::string& data);
+  void flushLocked();
+};
+
+}} // namespace facebook::logdevice
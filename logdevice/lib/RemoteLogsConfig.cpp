@@ -20,6 +20,7 @@
 #include "logdevice/common/configuration/ParsingHelpers.h"
 #include "logdevice/common/configuration/logs/LogsConfigStateMachine.h"
 #include "logdevice/include/LogAttributes.h"
+#include "logdevice/lib/LogsConfigDiskCache.h"
 
 using facebook::logdevice::logsconfig::LogGroupNodePtr;
 using folly::RWSpinLock;
@@ -136,8 +137,28 @@ void RemoteLogsConfig::getLogGroupByIDAsync(
     }
   }
 
-  std::string delimiter = getNamespaceDelimiter();
+  if (read_disk_cache_) {
+    LogGroupNodePtr cached =
+        disk_cache_->get(id, getClusterName(), getNamespaceDelimiter());
+    if (cached) {
+      // Use what the previous run of the client knew about the log right
+      // away, and refresh it in the background. Until then it is served from
+      // the in-memory cache like a fetched log group.
+      insertIntoIdCache(cached, /*persist=*/false);
+      fetchLogGroupByID(id, [](LogGroupNodePtr) {});
+      cb(std::move(cached));
+      return;
+    }
+  }
+
   // No suitable results in cache - proceed to get them from remote hosts.
+  fetchLogGroupByID(id, std::move(cb));
+}
+
+void RemoteLogsConfig::fetchLogGroupByID(
+    logid_t id,
+    std::function<void(LogGroupNodePtr)> cb) const {
+  std::string delimiter = getNamespaceDelimiter();
   auto request_callback = [cb, delimiter](Status st, std::string payload) {
     auto config = Worker::onThisThread()->getConfig();
     RemoteLogsConfig* rlc = checked_downcast<RemoteLogsConfig*>(
@@ -180,7 +201,11 @@ void RemoteLogsConfig::getLogGroupByIDAsync(
   }
 }
 
-void RemoteLogsConfig::insertIntoIdCache(const LogGroupNodePtr& log) const {
+void RemoteLogsConfig::insertIntoIdCache(const LogGroupNodePtr& log,
+                                         bool persist) const {
+  if (persist && disk_cache_) {
+    disk_cache_->put(log, getClusterName(), getNamespaceDelimiter());
+  }
   auto range = log->range();
   boost::icl::right_open_interval<logid_t::raw_type> interval(
       range.first.val_, range.second.val_ + 1);
@@ -440,6 +465,20 @@ RemoteLogsConfig::getProcessorPtrPtr() {
   return processor_;
 }
 
+RemoteLogsConfig::RemoteLogsConfig(std::chrono::milliseconds timeout,
+                                   std::chrono::milliseconds cache_ttl,
+                                   std::string disk_cache_path)
+    : timeout_(timeout),
+      max_data_age_(cache_ttl),
+      processor_(new std::weak_ptr<Processor>()),
+      target_node_info_(std::make_shared<GetLogInfoRequestSharedState>()) {
+  if (!disk_cache_path.empty()) {
+    disk_cache_ =
+        std::make_shared<LogsConfigDiskCache>(std::move(disk_cache_path));
+    read_disk_cache_ = true;
+  }
+}
+
 RemoteLogsConfig::RemoteLogsConfig(const RemoteLogsConfig& src)
     : LogsConfig(src) {
   // not copying the cache
@@ -447,6 +486,10 @@ RemoteLogsConfig::RemoteLogsConfig(const RemoteLogsConfig& src)
   max_data_age_ = src.max_data_age_;
   processor_ = src.processor_;
   target_node_info_ = src.target_node_info_;
+  // Copies are made when the config is invalidated, the disk cache may be as
+  // stale as the in-memory one. Keep updating it with fetched log groups.
+  disk_cache_ = src.disk_cache_;
+  read_disk_cache_ = false;
 
   // Enabling sending LOGS_CONFIG_API messages if it's disabled
   std::unique_lock<std::mutex> lock(target_node_info_->mutex_);
@@ -455,6 +498,14 @@ RemoteLogsConfig::RemoteLogsConfig(const RemoteLogsConfig& src)
   }
 }
 
+std::string RemoteLogsConfig::getClusterName() const {
+  std::shared_ptr<Processor> processor = processor_->lock();
+  if (!processor) {
+    return "";
+  }
+  return processor->config_->getServerConfig()->getClusterName();
+}
+
 std::shared_ptr<GetLogInfoRequestSharedState>
 RemoteLogsConfig::getTargetNodeInfo() const {
   return target_node_info_;
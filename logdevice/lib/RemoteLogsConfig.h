@@ -18,18 +18,22 @@
 
 namespace facebook { namespace logdevice {
 
+class LogsConfigDiskCache;
+
 /*
  * This class resolves the log configuration via sending requests to servers
  * and parsing the json blobs it receives in response.
  */
 class RemoteLogsConfig : public LogsConfig {
  public:
+  /**
+   * @param disk_cache_path  if not empty, log groups fetched by id or name are
+   *                         persisted in this file, and used at the next
+   *                         start of the client, see LogsConfigDiskCache
+   */
   RemoteLogsConfig(std::chrono::milliseconds timeout,
-                   std::chrono::milliseconds cache_ttl)
-      : timeout_(timeout),
-        max_data_age_(cache_ttl),
-        processor_(new std::weak_ptr<Processor>()),
-        target_node_info_(std::make_shared<GetLogInfoRequestSharedState>()) {}
+                   std::chrono::milliseconds cache_ttl,
+                   std::string disk_cache_path = "");
 
   bool isLocal() const override {
     return false;
@@ -74,8 +78,17 @@ class RemoteLogsConfig : public LogsConfig {
  private:
   using RangeLookupMap = LogsConfig::NamespaceRangeLookupMap;
 
-  // Inserts entries into logid->log struct cache
-  void insertIntoIdCache(const LogGroupNodePtr& log) const;
+  // Inserts entries into logid->log struct cache, and into the disk cache if
+  // `persist` is true
+  void insertIntoIdCache(const LogGroupNodePtr& log,
+                         bool persist = true) const;
+
+  // Fetches the log group containing `id` from a server and caches it
+  void fetchLogGroupByID(logid_t id,
+                         std::function<void(LogGroupNodePtr)> cb) const;
+
+  // Name of the cluster in the server config, empty if there is no processor
+  std::string getClusterName() const;
 
   // attempts to fetch results from cache into res. Returns true on success,
   // false on failure.
@@ -138,6 +151,12 @@ class RemoteLogsConfig : public LogsConfig {
   // This is a structure shared between all GetLogInfoRequest instances, which
   // defines where the request should be sent to
   std::shared_ptr<GetLogInfoRequestSharedState> target_node_info_;
+
+  // Shared between all copies, nullptr if disabled
+  std::shared_ptr<LogsConfigDiskCache> disk_cache_;
+  // Only the instance created at startup serves log groups from disk_cache_,
+  // the ones made after a config change know they must fetch them again.
+  bool read_disk_cache_{false};
 };
 
 }} // namespace facebook::logdevice
@@ -68,6 +68,27 @@ void AsyncCheckpointedReaderImpl::setGapCallback(
   reader_->setGapCallback(std::move(save_cb));
 }
 
+void AsyncCheckpointedReaderImpl::setRecordBatchCallback(
+    std::function<size_t(logid_t, std::vector<RecordBatchEntry>&)> cb) {
+  auto save_cb = [this, cb](logid_t log_id,
+                            std::vector<RecordBatchEntry>& batch) {
+    // Walk back to the last entry that advances the checkpoint, same as the
+    // record and gap callbacks do for every record and gap.
+    for (auto it = batch.rbegin(); it != batch.rend(); ++it) {
+      if (!it->isGap()) {
+        setLastLSNInMap(log_id, it->record->attrs.lsn);
+        break;
+      }
+      if (it->gap.hi != LSN_MAX) {
+        setLastLSNInMap(log_id, it->gap.hi);
+        break;
+      }
+    }
+    return cb(log_id, batch);
+  };
+  reader_->setRecordBatchCallback(std::move(save_cb));
+}
+
 void AsyncCheckpointedReaderImpl::setDoneCallback(
     std::function<void(logid_t)> cb) {
   reader_->setDoneCallback(cb);
@@ -107,6 +128,10 @@ void AsyncCheckpointedReaderImpl::withoutPayload() {
   reader_->withoutPayload();
 }
 
+void AsyncCheckpointedReaderImpl::payloadHashOnly() {
+  reader_->payloadHashOnly();
+}
+
 void AsyncCheckpointedReaderImpl::forceNoSingleCopyDelivery() {
   reader_->forceNoSingleCopyDelivery();
 }
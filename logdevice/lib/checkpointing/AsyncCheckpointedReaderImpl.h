@@ -33,6 +33,10 @@ class AsyncCheckpointedReaderImpl : public AsyncCheckpointedReader {
 
   void setGapCallback(std::function<bool(const GapRecord&)>) override;
 
+  void setRecordBatchCallback(
+      std::function<size_t(logid_t, std::vector<RecordBatchEntry>&)>)
+      override;
+
   void setDoneCallback(std::function<void(logid_t)>) override;
 
   void setHealthChangeCallback(
@@ -54,6 +58,8 @@ class AsyncCheckpointedReaderImpl : public AsyncCheckpointedReader {
 
   void withoutPayload() override;
 
+  void payloadHashOnly() override;
+
   void forceNoSingleCopyDelivery() override;
 
   void includeByteOffset() override;
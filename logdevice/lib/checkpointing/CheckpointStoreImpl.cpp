@@ -16,6 +16,7 @@
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
 #include "logdevice/common/ThriftCodec.h"
+#include "logdevice/common/debug.h"
 #include "logdevice/common/toString.h"
 #include "logdevice/common/types_internal.h"
 #include "logdevice/common/util.h"
@@ -191,9 +192,42 @@ CheckpointStoreImpl::removeAllCheckpointsSync(const std::string& customer_id) {
 
 void CheckpointStoreImpl::updateCheckpoints(
     const std::string& customer_id,
-    folly::Function<void(Checkpoint&) const> modify_checkpoint,
+    ModifyCheckpointFunc modify_checkpoint,
     StatusCallback cb) {
-  auto mcb = [modify_checkpoint = std::move(modify_checkpoint)](
+  {
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    PendingUpdates& pending = pending_[customer_id];
+    pending.modifications.push_back(std::move(modify_checkpoint));
+    pending.callbacks.push_back(std::move(cb));
+    if (pending.in_flight) {
+      // Will be written when the write in flight completes.
+      return;
+    }
+    pending.in_flight = true;
+  }
+  flushCheckpointUpdates(customer_id);
+}
+
+void CheckpointStoreImpl::flushCheckpointUpdates(
+    const std::string& customer_id) {
+  std::vector<ModifyCheckpointFunc> modifications;
+  std::vector<StatusCallback> callbacks;
+  {
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    auto it = pending_.find(customer_id);
+    ld_check(it != pending_.end());
+    ld_check(it->second.in_flight);
+    if (it->second.modifications.empty()) {
+      pending_.erase(it);
+      return;
+    }
+    modifications = std::move(it->second.modifications);
+    callbacks = std::move(it->second.callbacks);
+    it->second.modifications.clear();
+    it->second.callbacks.clear();
+  }
+
+  auto mcb = [modifications = std::move(modifications)](
                  folly::Optional<std::string> value) {
     auto value_thrift = std::make_unique<Checkpoint>();
     if (value.has_value()) {
@@ -203,14 +237,19 @@ void CheckpointStoreImpl::updateCheckpoints(
         return std::make_pair(Status::BADMSG, std::string());
       }
     }
-    modify_checkpoint(*value_thrift);
+    for (const auto& modify_checkpoint : modifications) {
+      modify_checkpoint(*value_thrift);
+    }
     value_thrift->version++;
     auto serialized_thrift =
         ThriftCodec::serialize<BinarySerializer>(*value_thrift);
     return std::make_pair(Status::OK, std::move(serialized_thrift));
   };
 
-  auto ucb = [customer_id, cb = std::move(cb)](
+  auto ucb = [this,
+              ref = holder_.ref(),
+              customer_id,
+              callbacks = std::move(callbacks)](
                  Status status, CheckpointStore::Version, std::string) mutable {
     if (status == Status::VERSION_MISMATCH) {
       RATELIMIT_ERROR(
@@ -223,7 +262,12 @@ void CheckpointStoreImpl::updateCheckpoints(
           "leave the checkpoint in an inconsistent state. Customer ID: %s",
           customer_id.c_str());
     }
-    cb(status);
+    for (auto& cb : callbacks) {
+      cb(status);
+    }
+    if (ref) {
+      flushCheckpointUpdates(customer_id);
+    }
   };
   vcs_->readModifyWriteConfig(
       createKey(customer_id), std::move(mcb), std::move(ucb));
@@ -7,6 +7,10 @@
  */
 #pragma once
 
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include <folly/io/async/HHWheelTimer.h>
 
 #include "logdevice/common/VersionedConfigStore.h"
@@ -19,6 +23,11 @@ namespace facebook { namespace logdevice {
 /*
  * @file CheckpointStoreImpl implements CheckpointStore. It stores LSNs for logs
  *       using VersionedConfigStore.
+ *
+ *       At most one write per customer ID is in flight. Updates that arrive
+ *       while it is are applied together in the next write, so a reader that
+ *       commits often costs one read-modify-write per round trip rather than
+ *       one per commit.
  */
 class CheckpointStoreImpl : public CheckpointStore {
  public:
@@ -72,11 +81,22 @@ class CheckpointStoreImpl : public CheckpointStore {
  private:
   static constexpr auto kRetryDuration = std::chrono::seconds(1);
 
-  void updateCheckpoints(
-      const std::string& customer_id,
-      folly::Function<void(checkpointing::thrift::Checkpoint&) const>
-          modify_checkpoint,
-      StatusCallback cb);
+  using ModifyCheckpointFunc =
+      folly::Function<void(checkpointing::thrift::Checkpoint&) const>;
+
+  void updateCheckpoints(const std::string& customer_id,
+                         ModifyCheckpointFunc modify_checkpoint,
+                         StatusCallback cb);
+
+  // Writes all updates queued for the customer in one read-modify-write, or
+  // marks the customer idle if there are none.
+  void flushCheckpointUpdates(const std::string& customer_id);
+
+  struct PendingUpdates {
+    bool in_flight = false;
+    std::vector<ModifyCheckpointFunc> modifications;
+    std::vector<StatusCallback> callbacks;
+  };
 
   std::string createKey(const std::string& customer_id) const;
 
@@ -84,6 +104,8 @@ class CheckpointStoreImpl : public CheckpointStore {
   std::string prefix_;
   folly::EventBase* event_base_;
   folly::HHWheelTimer::UniquePtr timer_;
+  std::mutex pending_mutex_;
+  std::unordered_map<std::string, PendingUpdates> pending_;
   WeakRefHolder<CheckpointStoreImpl> holder_;
 };
 
@@ -102,6 +102,10 @@ void SyncCheckpointedReaderImpl::withoutPayload() {
   reader_->withoutPayload();
 }
 
+void SyncCheckpointedReaderImpl::payloadHashOnly() {
+  reader_->payloadHashOnly();
+}
+
 void SyncCheckpointedReaderImpl::forceNoSingleCopyDelivery() {
   reader_->forceNoSingleCopyDelivery();
 }
@@ -52,6 +52,8 @@ class SyncCheckpointedReaderImpl : public SyncCheckpointedReader {
 
   void withoutPayload() override;
 
+  void payloadHashOnly() override;
+
   void forceNoSingleCopyDelivery() override;
 
   void includeByteOffset() override;
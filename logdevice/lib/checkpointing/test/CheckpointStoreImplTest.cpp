@@ -197,6 +197,52 @@ TEST_F(CheckpointStoreImplTest, UpdateHandleIncorrectValue) {
   checkpointStore->updateLSN("customer3", logid_t(3), 7, std::move(cb_));
 }
 
+TEST_F(CheckpointStoreImplTest, UpdatesCoalescedWhileWriteInFlight) {
+  VersionedConfigStore::mutation_callback_t first_mcb;
+  VersionedConfigStore::write_callback_t first_cb;
+  EXPECT_CALL(
+      *mock_versioned_config_store_, readModifyWriteConfig("customer", _, _))
+      .Times(2)
+      .WillOnce(Invoke([&](auto, auto mcb, auto cb) {
+        // Keep the first write in flight.
+        first_mcb = std::move(mcb);
+        first_cb = std::move(cb);
+      }))
+      .WillOnce(Invoke([](auto, auto mcb, auto cb) {
+        Checkpoint before;
+        before.log_lsn_map = {{1, 2}};
+        before.version = 1;
+        auto [status, value] =
+            mcb(ThriftCodec::serialize<BinarySerializer>(before));
+        EXPECT_EQ(Status::OK, status);
+        auto value_thrift =
+            ThriftCodec::deserialize<BinarySerializer, Checkpoint>(
+                Slice::fromString(value));
+        ASSERT_NE(nullptr, value_thrift);
+        Checkpoint correct;
+        correct.log_lsn_map = {{1, 4}, {3, 5}};
+        correct.version = 2;
+        EXPECT_EQ(correct, *value_thrift);
+        cb(status, CheckpointStore::Version(2), "");
+      }));
+
+  auto checkpointStore = std::make_unique<CheckpointStoreImpl>(
+      std::move(mock_versioned_config_store_));
+
+  std::vector<Status> statuses;
+  auto cb = [&statuses](Status st) { statuses.push_back(st); };
+  checkpointStore->updateLSN("customer", logid_t(1), 2, cb);
+  checkpointStore->updateLSN("customer", logid_t(1), 4, cb);
+  checkpointStore->updateLSN("customer", logid_t(3), 5, cb);
+  EXPECT_TRUE(statuses.empty());
+
+  // Completing the first write sends the other two updates in one write.
+  auto [status, value] = first_mcb(folly::none);
+  EXPECT_EQ(Status::OK, status);
+  first_cb(status, CheckpointStore::Version(1), std::move(value));
+  EXPECT_EQ(std::vector<Status>(3, Status::OK), statuses);
+}
+
 TEST_F(CheckpointStoreImplTest, UpdateAndGetWithInMemVersionedConfigStore) {
   auto checkpointStore = std::make_unique<CheckpointStoreImpl>(
       std::move(in_mem_versioned_config_store_));
@@ -7,6 +7,7 @@
  */
 #include "logdevice/lib/shadow/ShadowClient.h"
 
+#include <algorithm>
 #include <functional>
 
 #include "logdevice/common/AppendRequest.h"
@@ -147,7 +148,11 @@ void ShadowClientFactory::clientInitThreadMain() {
              attrs->destination().c_str());
     ld_check(client_timeout_.count() > 0);
     std::shared_ptr<ShadowClient> shadow_client =
-        ShadowClient::create(origin_name_, attrs, client_timeout_, stats_);
+        ShadowClient::create(origin_name_,
+                             attrs,
+                             client_timeout_,
+                             client_settings_->shadow_append_queue_size,
+                             stats_);
     if (shadow_client == nullptr) {
       // TODO scuba detailed stats T20416930 about which shadow and error code
       if (retry) {
@@ -175,6 +180,7 @@ std::shared_ptr<ShadowClient>
 ShadowClient::create(const std::string& origin_name,
                      const Shadow::Attrs& attrs,
                      std::chrono::milliseconds timeout,
+                     size_t queue_size,
                      StatsHolder* stats) {
   std::string shadow_name(origin_name + ".shadow:" + attrs->destination());
   std::shared_ptr<Client> client =
@@ -194,25 +200,68 @@ ShadowClient::create(const std::string& origin_name,
     return nullptr;
   }
 
-  return std::shared_ptr<ShadowClient>{new ShadowClient(client, attrs, stats)};
+  return std::shared_ptr<ShadowClient>{
+      new ShadowClient(client, attrs, queue_size, stats)};
 }
 
 ShadowClient::ShadowClient(std::shared_ptr<Client> client,
                            const Shadow::Attrs& attrs,
+                           size_t queue_size,
                            StatsHolder* stats)
-    : client_(std::move(client)), shadow_attrs_(attrs), stats_(stats) {}
+    : client_(std::move(client)),
+      shadow_attrs_(attrs),
+      stats_(stats),
+      queue_(std::max<size_t>(queue_size, 1)) {
+  sender_thread_ = std::thread(&ShadowClient::senderThreadMain, this);
+}
 
-ShadowClient::~ShadowClient() {}
+ShadowClient::~ShadowClient() {
+  // Appends already in the queue are posted before the thread exits
+  queue_.blockingWrite(PendingAppend{});
+  sender_thread_.join();
+}
 
 int ShadowClient::append(logid_t logid,
                          PayloadHolder&& payload,
                          AppendAttributes attrs,
                          bool buffered_writer_blob,
                          bool payload_group) noexcept {
+  ld_check(logid != LOGID_INVALID);
+  PendingAppend pending{logid,
+                        std::move(payload),
+                        std::move(attrs),
+                        buffered_writer_blob,
+                        payload_group};
+  if (!queue_.write(std::move(pending))) {
+    STAT_INCR(stats_, client.shadow_append_dropped);
+    RATELIMIT_WARNING(1s,
+                      1,
+                      LD_SHADOW_PREFIX "Queue of appends to shadow '%s' is "
+                                       "full, dropping append",
+                      shadow_attrs_->destination().c_str());
+    err = E::NOBUFS;
+    return -1;
+  }
+  return 0;
+}
+
+void ShadowClient::senderThreadMain() {
+  ThreadID::set(ThreadID::UTILITY, "shadow:S0");
+  while (true) {
+    PendingAppend pending;
+    queue_.blockingRead(pending);
+    if (pending.logid == LOGID_INVALID) {
+      break;
+    }
+    postAppend(std::move(pending));
+  }
+}
+
+void ShadowClient::postAppend(PendingAppend&& pending) {
   auto callback = [&](auto a, const auto& b) { this->appendCallback(a, b); };
 
   ld_spew(LD_SHADOW_PREFIX "Shadowing payload of size %zu to shadow '%s'",
-          payload.size(),
+          pending.payload.size(),
           shadow_attrs_->destination().c_str()); // TODO replace with stats
 
   // Downcast client in order to use lower level API. The reason is we need
@@ -222,25 +271,29 @@ int ShadowClient::append(logid_t logid,
   // PayloadGroups and unpack them.
   ClientImpl* client_impl = checked_downcast<ClientImpl*>(client_.get());
   int rv = -1;
-  auto req = client_impl->prepareRequest(
-      logid, std::move(payload), callback, attrs, worker_id_t{-1}, nullptr);
+  auto req = client_impl->prepareRequest(pending.logid,
+                                         std::move(pending.payload),
+                                         callback,
+                                         std::move(pending.attrs),
+                                         worker_id_t{-1},
+                                         nullptr);
   if (req) {
-    if (buffered_writer_blob) {
+    if (pending.buffered_writer_blob) {
       req->setBufferedWriterBlobFlag();
     }
-    if (payload_group) {
+    if (pending.payload_group) {
       req->setPayloadGroupFlag();
     }
     rv = client_impl->postAppend(std::move(req));
   }
 
   if (rv == -1) {
+    STAT_INCR(stats_, client.shadow_append_failed);
     RATELIMIT_WARNING(1s,
                       1,
                       LD_SHADOW_PREFIX "Shadow append failed with '%s'",
                       error_description(err));
   }
-  return rv;
 }
 
 void ShadowClient::appendCallback(Status status, const DataRecord& record) {
@@ -16,8 +16,10 @@
 #include <string>
 #include <thread>
 
+#include <folly/MPMCQueue.h>
 #include <folly/Synchronized.h>
 
+#include "logdevice/common/PayloadHolder.h"
 #include "logdevice/include/Client.h"
 #include "logdevice/include/Err.h"
 #include "logdevice/include/Record.h"
@@ -32,7 +34,6 @@
 
 namespace facebook { namespace logdevice {
 
-class PayloadHolder;
 class Shadow;
 class ShadowClient;
 
@@ -112,14 +113,26 @@ class ShadowClient {
   /**
    * Creates a shadow client object backed by a Client object used for shadow
    * appends. Runs on current thread, so should only be used by the factory.
+   *
+   * @param queue_size  capacity of the queue of appends waiting to be posted
+   *                    to the shadow cluster, see append()
    */
   static std::shared_ptr<ShadowClient> create(const std::string& origin_name,
                                               const Shadow::Attrs& attrs,
                                               std::chrono::milliseconds timeout,
+                                              size_t queue_size,
                                               StatsHolder* stats);
 
   ~ShadowClient();
 
+  /**
+   * Enqueues an append for the shadow cluster. The append is posted to the
+   * shadow Client from a dedicated thread, so the caller (the thread doing
+   * the original append) never waits on the shadow cluster.
+   *
+   * @return 0 if the append was enqueued, -1 with err set to E::NOBUFS if the
+   *         queue is full, in which case the append is dropped
+   */
   int append(logid_t logid,
              PayloadHolder&& payload,
              AppendAttributes attrs,
@@ -127,16 +140,32 @@ class ShadowClient {
              bool payload_group) noexcept;
 
  private:
+  struct PendingAppend {
+    // LOGID_INVALID tells the sender thread to exit
+    logid_t logid{LOGID_INVALID};
+    PayloadHolder payload;
+    AppendAttributes attrs;
+    bool buffered_writer_blob{false};
+    bool payload_group{false};
+  };
+
   ShadowClient(std::shared_ptr<Client> client,
                const Shadow::Attrs& attrs,
+               size_t queue_size,
                StatsHolder* stats);
 
+  void senderThreadMain();
+  void postAppend(PendingAppend&& pending);
   void appendCallback(Status status, const DataRecord& record);
 
   std::shared_ptr<Client> client_;
   Shadow::Attrs shadow_attrs_;
   StatsHolder* stats_;
   std::chrono::milliseconds client_timeout_{0};
+
+  // Appends waiting to be posted by sender_thread_
+  folly::MPMCQueue<PendingAppend> queue_;
+  std::thread sender_thread_;
 };
 
 }} // namespace facebook::logdevice
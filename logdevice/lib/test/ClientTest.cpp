@@ -18,6 +18,7 @@
 #include "logdevice/common/test/TestUtil.h"
 #include "logdevice/common/types_internal.h"
 #include "logdevice/include/ClientFactory.h"
+#include "logdevice/lib/ClientImpl.h"
 
 using namespace ::testing;
 
@@ -297,4 +298,50 @@ TEST_F(ClientTest, DontBumpMetricOnUnworthyFailures) {
   EXPECT_EQ(0, stats.client.client_init_failed);
 }
 
+TEST_F(ClientTest, SharedRuntime) {
+  std::string config_path =
+      std::string("file:") + TEST_CONFIG_FILE("sample_no_ssl.conf");
+  auto create = [&](bool share, int64_t max_payload_size) {
+    return std::dynamic_pointer_cast<ClientImpl>(
+        ClientFactory()
+            .setSetting("share-client-runtime", share ? "true" : "false")
+            .setSetting("max-payload-size", max_payload_size)
+            .create(config_path));
+  };
+  auto client1 = create(true, 1000);
+  auto client2 = create(true, 2000);
+  auto client3 = create(false, 3000);
+  ASSERT_NE(nullptr, client1);
+  ASSERT_NE(nullptr, client2);
+  ASSERT_NE(nullptr, client3);
+
+  EXPECT_EQ(client1->getRuntime(), client2->getRuntime());
+  EXPECT_EQ(client1->getProcessorPtr(), client2->getProcessorPtr());
+  EXPECT_NE(client1->getProcessorPtr(), client3->getProcessorPtr());
+  EXPECT_EQ(client1->getClientSessionID(), client2->getClientSessionID());
+
+  // Each client keeps its own settings.
+  EXPECT_EQ(1000, client1->getMaxPayloadSize());
+  EXPECT_EQ(2000, client2->getMaxPayloadSize());
+
+  // Write tokens are per client too.
+  client1->addWriteToken("token");
+  EXPECT_TRUE(client1->hasWriteToken("token"));
+  EXPECT_FALSE(client2->hasWriteToken("token"));
+
+  // The runtime outlives the client that created it.
+  std::weak_ptr<ClientRuntime> runtime = client1->getRuntime();
+  client1.reset();
+  EXPECT_NE(nullptr, runtime.lock());
+  EXPECT_EQ(2000, client2->getMaxPayloadSize());
+  EXPECT_NE(nullptr, client2->getConfig()->getLogsConfig());
+  client2.reset();
+  EXPECT_EQ(nullptr, runtime.lock());
+
+  // Once all clients are gone, the next one starts a new runtime.
+  auto client4 = create(true, 1000);
+  ASSERT_NE(nullptr, client4);
+  EXPECT_NE(client4->getRuntime(), client3->getRuntime());
+}
+
 }} // namespace facebook::logdevice
@@ -0,0 +1,106 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "logdevice/lib/LogsConfigDiskCache.h"
+
+#include <folly/FileUtil.h>
+#include <gtest/gtest.h>
+
+#include "logdevice/common/test/TestUtil.h"
+
+using namespace facebook::logdevice;
+using namespace facebook::logdevice::logsconfig;
+
+namespace {
+
+LogGroupNodePtr makeLogGroup(std::string name,
+                             logid_t::raw_type lo,
+                             logid_t::raw_type hi,
+                             int replication) {
+  return std::make_shared<LogGroupNode>(
+      std::move(name),
+      LogAttributes().with_replicationFactor(replication),
+      logid_range_t(logid_t(lo), logid_t(hi)));
+}
+
+class LogsConfigDiskCacheTest : public ::testing::Test {
+ protected:
+  LogsConfigDiskCacheTest()
+      : dir_("LogsConfigDiskCacheTest"),
+        path_((dir_.path() / "logs_config_cache").string()) {}
+
+  TemporaryDirectory dir_;
+  const std::string path_;
+};
+
+TEST_F(LogsConfigDiskCacheTest, PersistsAcrossInstances) {
+  {
+    LogsConfigDiskCache cache(path_);
+    EXPECT_EQ(nullptr, cache.get(logid_t(1), "cluster", "/"));
+    cache.put(makeLogGroup("a", 1, 10, 2), "cluster", "/");
+    cache.put(makeLogGroup("b", 20, 20, 3), "cluster", "/");
+    auto got = cache.get(logid_t(5), "cluster", "/");
+    ASSERT_NE(nullptr, got);
+    EXPECT_EQ("a", got->name());
+  }
+
+  LogsConfigDiskCache cache(path_);
+  auto got = cache.get(logid_t(10), "cluster", "/");
+  ASSERT_NE(nullptr, got);
+  EXPECT_EQ("a", got->name());
+  EXPECT_EQ(logid_range_t(logid_t(1), logid_t(10)), got->range());
+  EXPECT_EQ(2, got->attrs().replicationFactor().value());
+  got = cache.get(logid_t(20), "cluster", "/");
+  ASSERT_NE(nullptr, got);
+  EXPECT_EQ(3, got->attrs().replicationFactor().value());
+  EXPECT_EQ(nullptr, cache.get(logid_t(11), "cluster", "/"));
+  EXPECT_EQ(nullptr, cache.get(logid_t(21), "cluster", "/"));
+}
+
+TEST_F(LogsConfigDiskCacheTest, OverlappingRangesAreReplaced) {
+  LogsConfigDiskCache cache(path_);
+  cache.put(makeLogGroup("a", 1, 10, 2), "cluster", "/");
+  cache.put(makeLogGroup("b", 11, 20, 2), "cluster", "/");
+  cache.put(makeLogGroup("c", 5, 15, 2), "cluster", "/");
+  EXPECT_EQ(nullptr, cache.get(logid_t(1), "cluster", "/"));
+  EXPECT_EQ(nullptr, cache.get(logid_t(20), "cluster", "/"));
+  auto got = cache.get(logid_t(10), "cluster", "/");
+  ASSERT_NE(nullptr, got);
+  EXPECT_EQ("c", got->name());
+}
+
+TEST_F(LogsConfigDiskCacheTest, IgnoresFileOfAnotherCluster) {
+  {
+    LogsConfigDiskCache cache(path_);
+    cache.put(makeLogGroup("a", 1, 10, 2), "cluster", "/");
+  }
+  {
+    LogsConfigDiskCache cache(path_);
+    EXPECT_EQ(nullptr, cache.get(logid_t(1), "other_cluster", "/"));
+  }
+  {
+    LogsConfigDiskCache cache(path_);
+    EXPECT_EQ(nullptr, cache.get(logid_t(1), "cluster", ":"));
+  }
+}
+
+TEST_F(LogsConfigDiskCacheTest, IgnoresCorruptedFile) {
+  {
+    LogsConfigDiskCache cache(path_);
+    cache.put(makeLogGroup("a", 1, 10, 2), "cluster", "/");
+  }
+  std::string data;
+  ASSERT_TRUE(folly::readFile(path_.c_str(), data));
+  data[data.size() / 2] ^= 1;
+  ASSERT_TRUE(folly::writeFile(data, path_.c_str()));
+
+  LogsConfigDiskCache cache(path_);
+  EXPECT_EQ(nullptr, cache.get(logid_t(1), "cluster", "/"));
+}
+
+} // namespace
@@ -27,6 +27,10 @@ class MockAsyncReader : public AsyncReader {
 
   MOCK_METHOD1(setGapCallback, void(std::function<bool(const GapRecord&)>));
 
+  MOCK_METHOD1(
+      setRecordBatchCallback,
+      void(std::function<size_t(logid_t, std::vector<RecordBatchEntry>&)>));
+
   MOCK_METHOD1(setDoneCallback, void(std::function<void(logid_t)>));
 
   MOCK_METHOD1(setHealthChangeCallback,
@@ -43,6 +47,8 @@ class MockAsyncReader : public AsyncReader {
 
   MOCK_METHOD0(withoutPayload, void());
 
+  MOCK_METHOD0(payloadHashOnly, void());
+
   MOCK_METHOD0(forceNoSingleCopyDelivery, void());
 
   MOCK_METHOD0(includeByteOffset, void());
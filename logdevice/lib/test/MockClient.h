@@ -29,6 +29,9 @@ class MockClient : public Client {
   MOCK_METHOD1(setTimeout, void(std::chrono::milliseconds timeout));
   MOCK_METHOD2(trimSync, int(logid_t logid, lsn_t lsn));
   MOCK_METHOD3(trim, int(logid_t logid, lsn_t lsn, trim_callback_t cb));
+  MOCK_METHOD2(trimBatch,
+               int(std::vector<std::pair<logid_t, lsn_t>>,
+                   trim_batch_callback_t));
   MOCK_METHOD1(addWriteToken, void(std::string));
   MOCK_METHOD4(
       findTimeSync,
@@ -40,6 +43,11 @@ class MockClient : public Client {
                    std::chrono::milliseconds,
                    find_time_callback_t,
                    FindKeyAccuracy));
+  MOCK_METHOD4(findTimeBatch,
+               int(std::vector<logid_t>,
+                   std::chrono::milliseconds,
+                   find_time_batch_callback_t,
+                   FindKeyAccuracy));
   MOCK_METHOD4(findKey,
                int(logid_t, std::string, find_key_callback_t, FindKeyAccuracy));
   MOCK_METHOD2(isLogEmptySync, int(logid_t logid, bool* empty));
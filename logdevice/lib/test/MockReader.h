@@ -42,6 +42,8 @@ class MockReader : public Reader {
 
   MOCK_METHOD0(withoutPayload, void());
 
+  MOCK_METHOD0(payloadHashOnly, void());
+
   MOCK_METHOD0(forceNoSingleCopyDelivery, void());
 
   MOCK_METHOD0(includeByteOffset, void());
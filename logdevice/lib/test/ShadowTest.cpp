@@ -287,7 +287,7 @@ TEST(ShadowClientTest, ShadowClientInitAppend) {
   LogAttributes::Shadow shadowAttr{
       std::string("file:") + TEST_CONFIG_FILE("sample_no_ssl.conf"), 0.1};
   std::shared_ptr<ShadowClient> shadow_client = ShadowClient::create(
-      "test", shadowAttr, std::chrono::seconds(10), nullptr);
+      "test", shadowAttr, std::chrono::seconds(10), 16, nullptr);
   ASSERT_NE(shadow_client, nullptr);
 
   int rv = shadow_client->append(logid_t{1},
@@ -50,7 +50,9 @@
 #include "tables/Shards.h"
 #include "tables/Sockets.h"
 #include "tables/Stats.h"
+#include "tables/StatsCpuTime.h"
 #include "tables/StatsRocksdb.h"
+#include "tables/StorageTaskIO.h"
 #include "tables/StorageTasks.h"
 #include "tables/StoredLogs.h"
 #include "tables/SyncSequencerRequests.h"
@@ -184,8 +186,10 @@ LDQuery::LDQuery(std::string config_path,
   table_registry_.registerTable<tables::Shards>(ctx_);
   table_registry_.registerTable<tables::Sockets>(ctx_);
   table_registry_.registerTable<tables::Stats>(ctx_);
+  table_registry_.registerTable<tables::StatsCpuTime>(ctx_);
   table_registry_.registerTable<tables::StatsRocksdb>(ctx_);
   table_registry_.registerTable<tables::StorageTasks>(ctx_);
+  table_registry_.registerTable<tables::StorageTaskIO>(ctx_);
   table_registry_.registerTable<tables::StoredLogs>(ctx_);
   table_registry_.registerTable<tables::SyncSequencerRequests>(ctx_);
 
@@ -7,10 +7,10 @@
  */
 #include "logdevice/ops/ldquery/tables/AdminCommandTable.h"
 
-#include <thread>
-
 #include <folly/Memory.h>
 #include <folly/String.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/futures/Future.h>
 #include <folly/json.h>
 
 #include "external/gason/gason.h"
@@ -253,7 +253,7 @@ void AdminCommandTable::refillCache(QueryContext& ctx) {
     }
   }
 
-  AdminCommandClient ld_admin_client;
+  AdminCommandClient ld_admin_client(FAN_OUT_THREADS);
 
   std::unordered_map<folly::SocketAddress, node_index_t> addr_to_node_id;
   std::vector<AdminCommandClient::Request> requests;
@@ -282,8 +282,26 @@ void AdminCommandTable::refillCache(QueryContext& ctx) {
           folly::rtrimWhitespace(cmd.c_str()).str().c_str(),
           requests.size());
 
+  // Each response is parsed as soon as it arrives, while waiting for the
+  // slower nodes, rather than after all nodes replied or timed out.
   steady_clock::time_point tstart = steady_clock::now();
-  auto responses = ld_admin_client.send(requests, command_timeout_);
+  folly::CPUThreadPoolExecutor parse_executor(PARSE_THREADS);
+  std::vector<folly::SemiFuture<NodeResult>> futures;
+  futures.reserve(requests.size());
+  for (auto& f : ld_admin_client.asyncSend(requests, command_timeout_)) {
+    futures.push_back(
+        std::move(f)
+            .via(&parse_executor)
+            .thenTry([this](folly::Try<AdminCommandClient::Response> t) {
+              return parseResponse(std::move(t));
+            })
+            .semi());
+  }
+  std::vector<NodeResult> responses;
+  responses.reserve(requests.size());
+  for (auto& t : folly::collectAll(std::move(futures)).get()) {
+    responses.push_back(std::move(t.value()));
+  }
   ld_check(requests.size() == responses.size());
   steady_clock::time_point tend = steady_clock::now();
   double duration =
@@ -293,27 +311,16 @@ void AdminCommandTable::refillCache(QueryContext& ctx) {
   for (const auto& r : responses) {
     replies += r.success;
   }
-  ld_info("Receiving data took %.1fs, %lu/%lu nodes replied",
+  ld_info("Receiving and parsing data took %.1fs, %lu/%lu nodes replied",
           duration,
           replies,
           responses.size());
-  tstart = tend;
-
-  ld_info("Parsing json data...");
-  std::vector<TableData> results = transformDataParallel(responses);
-  ld_check(results.size() == responses.size());
-  for (int i = 0; i < results.size(); ++i) {
-    if (!results[i].cols.empty()) {
-      size_t rows = results[i].cols.begin()->second.size();
-      std::string node_id_str =
-          folly::to<std::string>(addr_to_node_id[requests[i].sockaddr]);
-      results[i].cols["node_id"] = Column(rows, node_id_str);
-    }
-  }
 
+  std::vector<TableData> results;
+  results.reserve(responses.size());
   for (int i = 0; i < requests.size(); i++) {
+    node_index_t node_id = addr_to_node_id[requests[i].sockaddr];
     if (!responses[i].success) {
-      node_index_t node_id = addr_to_node_id[requests[i].sockaddr];
       ld_info("Failed request for N%d (%s): %s",
               node_id,
               requests[i].sockaddr.describe().c_str(),
@@ -321,14 +328,14 @@ void AdminCommandTable::refillCache(QueryContext& ctx) {
       ld_ctx_->activeQueryMetadata.failures[node_id] = FailedNodeDetails{
           requests[i].sockaddr.describe(), responses[i].failure_reason};
     }
+    results.push_back(std::move(responses[i].data));
+    if (!results[i].cols.empty()) {
+      size_t rows = results[i].cols.begin()->second.size();
+      results[i].cols["node_id"] =
+          Column(rows, folly::to<std::string>(node_id));
+    }
   }
 
-  tend = steady_clock::now();
-  duration =
-      std::chrono::duration_cast<std::chrono::duration<double>>(tend - tstart)
-          .count();
-  ld_info("Json parsing took %.1fs", duration);
-
   tstart = tend;
   Data data;
   ld_info("Aggregating data from %lu nodes...", responses.size());
@@ -698,41 +705,25 @@ AdminCommandTable::transformData(std::string response_from_node) const {
   return PartialTableData{folly::none, false, "UNEXPECTED"};
 }
 
-std::vector<TableData> AdminCommandTable::transformDataParallel(
-    std::vector<AdminCommandClient::Response>& responses) {
-  std::vector<TableData> outputs(responses.size());
-
-  auto thread_func = [&](size_t from, size_t to) {
-    for (size_t i = from; i < std::min(to, responses.size()); ++i) {
-      if (responses[i].success) {
-        PartialTableData partial_data =
-            transformData(std::move(responses[i].response));
-        if (partial_data.success) {
-          outputs[i] = std::move(*(partial_data.data));
-        } else {
-          responses[i].success = false;
-          responses[i].failure_reason = partial_data.failure_reason;
-        }
-      }
-    }
-  };
-
-  const size_t num_threads = 32;
-  const size_t num_per_thread = responses.size() / num_threads + 1;
-
-  std::vector<std::thread> threads;
-  for (int i = 0; i < num_threads && i * num_per_thread < responses.size();
-       i++) {
-    const size_t from = i * num_per_thread;
-    const size_t to = from + num_per_thread;
-    threads.push_back(std::thread(thread_func, from, to));
-  }
-
-  for (int i = 0; i < threads.size(); ++i) {
-    threads[i].join();
+AdminCommandTable::NodeResult AdminCommandTable::parseResponse(
+    folly::Try<AdminCommandClient::Response> response) const {
+  NodeResult res;
+  if (response.hasException()) {
+    res.failure_reason = response.exception().what().toStdString();
+    return res;
+  }
+  if (!response->success) {
+    res.failure_reason = std::move(response->failure_reason);
+    return res;
+  }
+  PartialTableData partial_data = transformData(std::move(response->response));
+  if (partial_data.success) {
+    res.success = true;
+    res.data = std::move(*(partial_data.data));
+  } else {
+    res.failure_reason = std::move(partial_data.failure_reason);
   }
-
-  return outputs;
+  return res;
 }
 
 }}} // namespace facebook::logdevice::ldquery
@@ -36,6 +36,11 @@ class AdminCommandTable : public Table {
   // @see num_fetches_.
   static constexpr int MAX_FETCHES = 5;
 
+  // Threads running the connections to the nodes, and parsing their
+  // responses.
+  static constexpr size_t FAN_OUT_THREADS = 16;
+  static constexpr size_t PARSE_THREADS = 32;
+
   enum class Type { JSON_TABLE, STAT };
 
   explicit AdminCommandTable(std::shared_ptr<Context> ctx,
@@ -125,8 +130,17 @@ class AdminCommandTable : public Table {
   // getFetchableColumns().
   std::unordered_map<ColumnName, int> nameToPosMap_;
 
-  std::vector<TableData>
-  transformDataParallel(std::vector<AdminCommandClient::Response>& responses);
+  // The response of one node, parsed.
+  struct NodeResult {
+    TableData data;
+    bool success = false;
+    std::string failure_reason;
+  };
+
+  // Calls transformData() on the response of a node. Called on the parsing
+  // threads, concurrently for different nodes.
+  NodeResult parseResponse(folly::Try<AdminCommandClient::Response> response)
+      const;
 
   std::chrono::milliseconds command_timeout_;
   Type type_;
@@ -69,6 +69,23 @@ class Iterators : public AdminCommandTable {
         {"version",
          DataType::BIGINT,
          "RocksDB superversion that this iterator points to."},
+        {"rocksdb_iterators_created",
+         DataType::BIGINT,
+         "Number of RocksDB iterators this iterator created over its "
+         "lifetime."},
+        {"rocksdb_iterators_reused",
+         DataType::BIGINT,
+         "Number of RocksDB iterators this iterator took from the shard's "
+         "iterator pool instead of creating them. See "
+         "\"rocksdb-iterator-pool-max-pinned-bytes\"."},
+        {"creations_per_minute",
+         DataType::REAL,
+         "Average number of RocksDB iterators created per minute over the "
+         "lifetime of this iterator."},
+        {"pinned_bytes",
+         DataType::BIGINT,
+         "For POOLED iterators that are idle, estimated memtable and block "
+         "memory that they keep alive."},
     };
   }
   std::string getCommandToSend(QueryContext& /*ctx*/) const override {
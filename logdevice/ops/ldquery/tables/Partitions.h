@@ -112,7 +112,43 @@ class Partitions : public AdminCommandTable {
          "Nodes that have uncommitted append data in this partition."},
         {"rebuild_dirtied_by",
          DataType::TEXT,
-         "Nodes that have uncommitted rebuild data in this partition."}};
+         "Nodes that have uncommitted rebuild data in this partition."},
+        {"tier",
+         DataType::TEXT,
+         "\"hot\" if all records in the partition are younger than "
+         "--rocksdb-partition-hot-age, \"cold\" if some of its sst files "
+         "were offloaded to remote storage (see --rocksdb-partition-cold-age), "
+         "\"warm\" otherwise. Sum approx_size grouped by tier to get hot, "
+         "warm and cold bytes."},
+        {"offloaded_bytes",
+         DataType::BIGINT,
+         "Bytes of this partition's sst files that are stored remotely and "
+         "are fetched on demand."},
+        {"io_reads",
+         DataType::BIGINT,
+         "Number of reads from this partition's files by iterators, flushes "
+         "and compactions since the node started. Reads by iterators are "
+         "block cache misses."},
+        {"io_read_bytes",
+         DataType::BIGINT,
+         "Bytes read from this partition's files, see io_reads."},
+        {"io_read_p50_us",
+         DataType::BIGINT,
+         "Median latency of io_reads in microseconds."},
+        {"io_read_p99_us",
+         DataType::BIGINT,
+         "99th percentile latency of io_reads in microseconds. Compare "
+         "across tiers to see if cold partitions make reads slow."},
+        {"io_writes",
+         DataType::BIGINT,
+         "Number of writes to this partition's files by flushes and "
+         "compactions since the node started."},
+        {"io_write_bytes",
+         DataType::BIGINT,
+         "Bytes written to this partition's files, see io_writes."},
+        {"io_write_p99_us",
+         DataType::BIGINT,
+         "99th percentile latency of io_writes in microseconds."}};
   }
   std::string getCommandToSend(QueryContext& ctx) const override {
     std::string expr;
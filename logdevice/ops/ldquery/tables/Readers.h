@@ -120,6 +120,30 @@ class Readers : public AdminCommandTable {
         {"tcp_sndbuf",
          DataType::INTEGER,
          "Number of bytes in TCP sndbuf waiting to be sent"},
+        {"readahead_size",
+         DataType::BIGINT,
+         "Read-ahead size in bytes that the next storage task of this stream "
+         "will use, picked from how its recent batches ended (see the "
+         "--catchup-readahead-max-size setting). 0 if the stream is tailing "
+         "or adaptive read-ahead is disabled."},
+        {"read_amplification",
+         DataType::REAL,
+         "Bytes read from the local log store by storage tasks of this "
+         "stream, divided by the record bytes out of those that passed the "
+         "filters and were delivered. High values mean most of what is read "
+         "is filtered out, e.g. by single copy delivery. Null until a record "
+         "has been delivered from a storage task."},
+        {"principal",
+         DataType::TEXT,
+         "Principal of the client's connection: its primary identity as "
+         "\"<type>:<name>\", or the principal type. Empty if the client didn't "
+         "authenticate."},
+        {"records_sent",
+         DataType::BIGINT,
+         "Number of records sent to the client for this stream."},
+        {"record_bytes_sent",
+         DataType::BIGINT,
+         "Size of the RECORD messages sent to the client for this stream."},
     };
   }
   std::string getCommandToSend(QueryContext& ctx) const override {
@@ -109,6 +109,15 @@ class Sequencers : public AdminCommandTable {
          "Time until the next potential nodeset size adjustment or nodeset "
          "randomization. Zero if nodeset adjustment is disabled or if "
          "the sequencer reactivation is in progress."},
+        {"window_size",
+         DataType::BIGINT,
+         "Current limit on the number of appends in flight in the current "
+         "epoch.  Equal to max_window_size unless --sequencer-window-adaptive "
+         "shrank it because storage nodes pushed back."},
+        {"max_window_size",
+         DataType::BIGINT,
+         "Size of the sliding window of the current epoch, i.e. the "
+         "maxWritesInFlight of the log when the epoch started."},
     };
   }
   std::string getCommandToSend(QueryContext& ctx) const override {
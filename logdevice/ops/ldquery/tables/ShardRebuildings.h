@@ -104,6 +104,37 @@ class ShardRebuildings : public AdminCommandTable {
          DataType::REAL,
          "Approximately what fraction of the work is done, between 0 and 1. "
          "-1 if the implementation doesn't support progress estimation."},
+        {"read_pass",
+         DataType::TEXT,
+         "\"full\" if reading everything from the beginning. \"resumed\" if "
+         "shards were added to the rebuilding set, and we continued reading "
+         "from where the previous rebuilding left off. \"follow-up\" if we're "
+         "then reading what the resumed pass skipped, for the added shards "
+         "only, or for the logs that got planned after reading had started."},
+        {"bytes_read",
+         DataType::BIGINT,
+         "Bytes read so far by this rebuilding, including filtered out "
+         "records and copyset index."},
+        {"restart_wasted_bytes",
+         DataType::TEXT,
+         "Comma-separated list of how many bytes had to be read again after "
+         "each of the last few restarts of this rebuilding, caused by changes "
+         "of the rebuilding set."},
+        {"bytes_left_to_read",
+         DataType::BIGINT,
+         "Approximately how many bytes are left to read in the current read "
+         "pass, based on partition size estimates. Null if the local log "
+         "store doesn't support progress estimation."},
+        {"bytes_left_to_rebuild",
+         DataType::BIGINT,
+         "Approximately how many bytes are left to re-replicate: the bytes "
+         "left to read times the fraction of bytes read so far that needed "
+         "rebuilding, plus what's buffered and in flight."},
+        {"eta",
+         DataType::BIGINT,
+         "Estimated number of seconds until this donor finishes, extrapolated "
+         "from the read and re-replication throughput so far, not counting "
+         "time stalled on global window. Null if not known yet."},
     };
   }
   std::string getCommandToSend(QueryContext& /*ctx*/) const override {
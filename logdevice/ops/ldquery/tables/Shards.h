@@ -56,6 +56,13 @@ class Shards : public AdminCommandTable {
         {"dirty_state",
          DataType::TEXT,
          "Status indicating if this shard has dirty ranges or not."},
+        {"numa_node",
+         DataType::BIGINT,
+         "NUMA node the disk of this shard is attached to, or -1 if unknown."},
+        {"storage_threads_pinned",
+         DataType::BIGINT,
+         "If true, the storage threads of this shard are pinned to the cpus of "
+         "\"numa_node\".  See the \"numa-aware-storage-threads\" setting."},
     };
   }
   std::string getCommandToSend(QueryContext& /*ctx*/) const override {
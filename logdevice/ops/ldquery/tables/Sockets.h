@@ -89,6 +89,24 @@ class Sockets : public AdminCommandTable {
         {"fd",
          DataType::INTEGER,
          "The file descriptor of the underlying os socket."},
+        {"msgs_per_write",
+         DataType::REAL,
+         "Average number of messages written to the socket per vectored "
+         "write. Higher means better batching, see "
+         "socket-batching-time-trigger."},
+        {"bytes_per_write",
+         DataType::REAL,
+         "Average number of bytes written to the socket per vectored write."},
+        {"ktls",
+         DataType::TEXT,
+         "Directions in which encryption of this SSL connection is offloaded "
+         "to the kernel: \"tx\", \"rx\", \"tx+rx\", or empty if none. See "
+         "ssl-ktls-offload."},
+        {"principal",
+         DataType::TEXT,
+         "Principal of the peer: its primary identity as \"<type>:<name>\", "
+         "or the principal type. Empty if the peer didn't authenticate. Group "
+         "by it to see which clients hold the most connections."},
     };
   }
   std::string getCommandToSend(QueryContext& /*ctx*/) const override {
@@ -0,0 +1,59 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "../Context.h"
+#include "AdminCommandTable.h"
+
+namespace facebook {
+  namespace logdevice {
+    namespace ldquery {
+      namespace tables {
+
+class StatsCpuTime : public AdminCommandTable {
+ public:
+  explicit StatsCpuTime(std::shared_ptr<Context> ctx)
+      : AdminCommandTable(ctx) {}
+  static std::string getName() {
+    return "stats_cpu_time";
+  }
+  std::string getDescription() override {
+    return "Time worker threads spent on each type of request, message and "
+           "storage task response since the node started or stats were "
+           "reset. Use it to find what saturates workers.";
+  }
+  TableColumns getFetchableColumns() const override {
+    return {
+        {"kind",
+         DataType::TEXT,
+         "What is processed: \"request\", \"message\" or "
+         "\"storage_task_response\"."},
+        {"type",
+         DataType::TEXT,
+         "Request type, message type or storage task type."},
+        {"cpu_usec",
+         DataType::BIGINT,
+         "Estimated worker thread CPU time in microseconds, extrapolated from "
+         "the executions sampled according to "
+         "--worker-cpu-time-sample-period."},
+        {"wall_usec",
+         DataType::BIGINT,
+         "Wall clock time in microseconds, including time the worker thread "
+         "was descheduled or blocked."},
+    };
+  }
+
+  std::string getCommandToSend(QueryContext& /*ctx*/) const override {
+    return std::string("stats cpu_time --json\n");
+  }
+};
+
+}}}} // namespace facebook::logdevice::ldquery::tables
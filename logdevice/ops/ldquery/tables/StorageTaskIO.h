@@ -0,0 +1,77 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "../Context.h"
+#include "AdminCommandTable.h"
+
+namespace facebook {
+  namespace logdevice {
+    namespace ldquery {
+      namespace tables {
+
+class StorageTaskIO : public AdminCommandTable {
+ public:
+  explicit StorageTaskIO(std::shared_ptr<Context> ctx)
+      : AdminCommandTable(ctx) {}
+  static std::string getName() {
+    return "storage_task_io";
+  }
+  std::string getDescription() override {
+    return "File reads and writes done by RocksDB on behalf of each type of "
+           "storage task, per shard, since the node started or stats were "
+           "reset. Complements storage_tasks, which only shows tasks waiting "
+           "in queues: use it to tell whether a type of task is slow because "
+           "of queueing, block cache misses or slow IO. IO not done by a "
+           "storage task, e.g. by flushes and compactions, is reported under "
+           "task type UNKNOWN. See the io_* columns of the partitions table "
+           "for IO per partition.";
+  }
+  TableColumns getFetchableColumns() const override {
+    return {
+        {"shard", DataType::BIGINT, "Index of the local log store shard."},
+        {"task_type", DataType::TEXT, "Type of the storage task."},
+        {"reads",
+         DataType::BIGINT,
+         "Number of file reads. Reads of sst files are block cache misses."},
+        {"read_bytes", DataType::BIGINT, "Bytes read."},
+        {"read_p50_us",
+         DataType::BIGINT,
+         "Median latency of reads in microseconds."},
+        {"read_p99_us",
+         DataType::BIGINT,
+         "99th percentile latency of reads in microseconds."},
+        {"writes", DataType::BIGINT, "Number of file writes."},
+        {"write_bytes", DataType::BIGINT, "Bytes written."},
+        {"write_p99_us",
+         DataType::BIGINT,
+         "99th percentile latency of writes in microseconds."},
+        {"executions",
+         DataType::BIGINT,
+         "Number of executed tasks of this type."},
+        {"block_cache_misses",
+         DataType::BIGINT,
+         "Number of RocksDB block cache misses while executing tasks of this "
+         "type. Some of them may be served from the OS page cache rather "
+         "than the disk."},
+    };
+  }
+  std::string getCommandToSend(QueryContext& ctx) const override {
+    std::string expr;
+    if (columnHasEqualityConstraint(0, ctx, expr)) {
+      return std::string("info storage_task_io ") + expr.c_str() + " --json\n";
+    } else {
+      return std::string("info storage_task_io --json\n");
+    }
+  }
+};
+
+}}}} // namespace facebook::logdevice::ldquery::tables
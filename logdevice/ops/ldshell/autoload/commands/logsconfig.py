@@ -268,6 +268,17 @@ _attributes = [
             """
         ),
     ),
+    argument(
+        "storage_compression",
+        type=str,
+        description=dedent(
+            """
+               Compression of record payloads on storage nodes: 'none', 'zstd',
+               'lz4' or 'lz4_hc'. Payloads are uncompressed before being sent
+               to readers. The default is no compression.
+             """
+        ),
+    ),
     argument(
         "extra_attributes",
         type=typing.Mapping[str, str],
@@ -187,6 +187,14 @@ void ReplicationCheckerSettings::defineSettings(SettingEasyInit& init) {
        "errors. This allows quick failure of tests instead of spending a lot "
        "of time continuing and failing later.",
        CLIENT);
+  init("progress-file",
+       &progress_file,
+       "",
+       nullptr,
+       "If set, the ids of logs that were checked without errors are appended "
+       "to this file, and logs already listed in it are skipped. Lets an "
+       "interrupted run be resumed by restarting it with the same file.",
+       CLIENT);
 }
 
 }} // namespace facebook::logdevice
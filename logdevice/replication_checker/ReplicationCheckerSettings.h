@@ -53,6 +53,7 @@ class ReplicationCheckerSettings : public SettingsBundle {
   ReportErrorsMode report_errors;
   // See .cpp
   size_t stop_after_num_errors;
+  std::string progress_file;
 
  private:
   std::string dont_fail_on_tmp_;
@@ -5,6 +5,8 @@
  * This source code is licensed under the BSD-style license found in the
  * LICENSE file in the root directory of this source tree.
  */
+#include <algorithm>
+#include <fstream>
 #include <signal.h>
 #include <unordered_map>
 #include <unordered_set>
@@ -94,6 +96,8 @@ Processor* processor;
 
 std::mutex mutex;
 std::vector<LogCheckRequest> logs_to_check;
+// Open if --progress-file is set. Protected by `mutex`.
+std::ofstream progress_file_out;
 
 std::chrono::steady_clock::time_point start_time;
 size_t logs_to_check_initial_count;
@@ -1539,6 +1543,12 @@ class PerWorkerCoordinatorRequest : public Request {
         per_log_stats[logid] = std::move(d);
       }
     }
+    if (c->getError().empty() && !st.hasFailures()) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (progress_file_out.is_open()) {
+        progress_file_out << rq.log_id.val_ << std::endl;
+      }
+    }
     mergeStats(stats_, c);
     startMoreWork();
     if (in_flight_.empty()) {
@@ -1989,6 +1999,34 @@ int main(int argc, const char** argv) {
                   .getReplicationFactor());
     }
   }
+  if (!checker_settings->progress_file.empty()) {
+    // Skip logs that a previous run already checked successfully.
+    std::unordered_set<logid_t::raw_type> done;
+    std::ifstream progress_in(checker_settings->progress_file);
+    logid_t::raw_type id;
+    while (progress_in >> id) {
+      done.insert(id);
+    }
+    if (!done.empty()) {
+      size_t before = logs_to_check.size();
+      logs_to_check.erase(
+          std::remove_if(logs_to_check.begin(),
+                         logs_to_check.end(),
+                         [&](const LogCheckRequest& rq) {
+                           return done.count(rq.log_id.val_);
+                         }),
+          logs_to_check.end());
+      ld_info("Skipping %lu logs already checked according to %s",
+              before - logs_to_check.size(),
+              checker_settings->progress_file.c_str());
+    }
+    progress_file_out.open(checker_settings->progress_file, std::ios::app);
+    if (!progress_file_out.is_open()) {
+      ld_error("Could not open progress file %s",
+               checker_settings->progress_file.c_str());
+      return 1;
+    }
+  }
   std::shuffle(
       logs_to_check.begin(), logs_to_check.end(), folly::ThreadLocalPRNG());
   if (checker_settings->num_logs_to_check >= 0) {
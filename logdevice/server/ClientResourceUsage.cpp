@@ -0,0 +1,82 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/ClientResourceUsage.h"
+
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <unordered_map>
+
+#include "logdevice/common/stats/HeavyHitters.h"
+
+namespace facebook { namespace logdevice {
+
+std::vector<ClientResourceUsage>
+getTopClientResourceUsage(StatsHolder* stats,
+                          PerClientHeavyHitters::Dimension dimension,
+                          std::chrono::milliseconds interval,
+                          ClientResource sort_by) {
+  std::vector<ClientResourceUsage> res;
+  const size_t top_k = stats ? stats->params_.get()->per_client_stats_top_k : 0;
+  if (top_k == 0) {
+    return res;
+  }
+
+  constexpr size_t kNumResources = static_cast<size_t>(ClientResource::MAX);
+  std::vector<std::unique_ptr<WindowedHeavyHitters>> merged;
+  for (size_t r = 0; r < kNumResources; ++r) {
+    merged.push_back(std::make_unique<WindowedHeavyHitters>(
+        PerClientHeavyHitters::SPAN, top_k));
+  }
+  stats->runForEach([&](Stats& s) {
+    auto& hh = s.per_client_heavy_hitters;
+    std::lock_guard<std::mutex> guard(hh.mutex);
+    for (size_t r = 0; r < kNumResources; ++r) {
+      if (hh.series[dimension][r]) {
+        merged[r]->merge(*hh.series[dimension][r]);
+      }
+    }
+  });
+
+  const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now().time_since_epoch());
+  const std::vector<std::chrono::milliseconds> intervals{interval};
+
+  // First the top users of each resource, then the rates of all of them for
+  // every resource, so that a client heavy on one resource shows its usage
+  // of the others.
+  std::set<std::string> names;
+  for (size_t r = 0; r < kNumResources; ++r) {
+    for (const auto& kv : merged[r]->rates(intervals, now)) {
+      names.insert(kv.first);
+    }
+  }
+  const std::vector<std::string> keys(names.begin(), names.end());
+  std::unordered_map<std::string, ClientResourceUsage> usage;
+  for (size_t r = 0; r < kNumResources; ++r) {
+    for (const auto& kv : merged[r]->rates(intervals, now, keys)) {
+      ClientResourceUsage& u = usage[kv.first];
+      u.name = kv.first;
+      u.rates[r] = kv.second[0];
+    }
+  }
+
+  res.reserve(usage.size());
+  for (auto& kv : usage) {
+    res.push_back(std::move(kv.second));
+  }
+  const size_t sort_idx = static_cast<size_t>(sort_by);
+  std::sort(res.begin(), res.end(), [&](const auto& a, const auto& b) {
+    return a.rates[sort_idx] != b.rates[sort_idx]
+        ? a.rates[sort_idx] > b.rates[sort_idx]
+        : a.name < b.name;
+  });
+  return res;
+}
+
+}} // namespace facebook::logdevice
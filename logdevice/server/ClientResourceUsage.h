@@ -0,0 +1,46 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "logdevice/common/stats/Stats.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * Rates at which a principal or client host used the resources of this node,
+ * see PerClientHeavyHitters.
+ */
+struct ClientResourceUsage {
+  // PrincipalIdentity::accountingName() or client address
+  std::string name;
+  // Per second, indexed by ClientResource.
+  std::array<double, static_cast<size_t>(ClientResource::MAX)> rates{};
+};
+
+/**
+ * Merges the PerClientHeavyHitters of all threads and returns the usage over
+ * `interval` (capped to PerClientHeavyHitters::SPAN) of the principals or
+ * client hosts, depending on `dimension`, that are among the top users of
+ * any resource, heaviest users of `sort_by` first. Empty if
+ * StatsParams::per_client_stats_top_k is 0.
+ *
+ * Meant for finding the clients that drive a saturated node, e.g. to pick
+ * which ones to throttle first.
+ */
+std::vector<ClientResourceUsage>
+getTopClientResourceUsage(StatsHolder* stats,
+                          PerClientHeavyHitters::Dimension dimension,
+                          std::chrono::milliseconds interval,
+                          ClientResource sort_by);
+
+}} // namespace facebook::logdevice
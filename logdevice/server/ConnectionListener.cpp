@@ -7,6 +7,7 @@
  */
 #include "logdevice/server/ConnectionListener.h"
 
+#include <algorithm>
 #include <memory>
 #include <netdb.h>
 #include <pthread.h>
@@ -15,6 +16,7 @@
 #include <sys/socket.h>
 
 #include "logdevice/common/ClientID.h"
+#include "logdevice/common/NumaPlacement.h"
 #include "logdevice/common/Request.h"
 #include "logdevice/common/Sockaddr.h"
 #include "logdevice/common/debug.h"
@@ -71,6 +73,14 @@ void ConnectionListener::ReadEventHandler::handlerReady(
       return;
     }
     connection_request_->setConnectionType(conn_type);
+    if (connection_request_->getWorkerTypeAffinity() == WorkerType::GENERAL) {
+      // The first bytes have arrived, so the socket knows which cpu handles
+      // its packets.
+      worker_id_t worker_id = connection_listener_->workerForSocket(sock_);
+      if (worker_id != WORKER_ID_INVALID) {
+        connection_request_->setWorkerId(worker_id);
+      }
+    }
     std::unique_ptr<Request> request = std::move(connection_request_);
     int rv;
     STAT_INCR(processor_.stats_, num_backlog_connections);
@@ -100,6 +110,27 @@ void ConnectionListener::ReadEventHandler::handlerReady(
   connection_listener_->read_event_handlers_.erase(sock_);
 }
 
+worker_id_t
+ConnectionListener::workerForSocket(folly::NetworkSocket sock) const {
+  std::shared_ptr<const Settings> settings = processor_->settings();
+  const std::vector<int>& cpus = settings->worker_cpus;
+  if (cpus.empty()) {
+    return WORKER_ID_INVALID;
+  }
+  const int cpu = numa::incomingCpuOfSocket(sock.toFd());
+  auto it = std::find(cpus.begin(), cpus.end(), cpu);
+  if (cpu < 0 || it == cpus.end()) {
+    return WORKER_ID_INVALID;
+  }
+  // Worker i is pinned to cpus[i % cpus.size()].
+  const int idx = it - cpus.begin();
+  if (idx >= processor_->getWorkerCount(WorkerType::GENERAL)) {
+    return WORKER_ID_INVALID;
+  }
+  STAT_INCR(processor_->stats_, connections_steered_to_incoming_cpu);
+  return worker_id_t(idx);
+}
+
 void ConnectionListener::ReadEventHandler::timeoutExpired() noexcept {
   unregisterHandler();
   ld_error("registerHandler() on file descriptor %d failed to read before "
@@ -73,6 +73,10 @@ class ConnectionListener : public Listener {
 
   static ConnectionType getConnectionType(folly::NetworkSocket sock);
 
+  // With Settings::worker_cpus, the general worker pinned to the cpu that
+  // receives the packets of `sock`. WORKER_ID_INVALID if there is none.
+  worker_id_t workerForSocket(folly::NetworkSocket sock) const;
+
  private:
   class ReadEventHandler : public folly::EventHandler,
                            public folly::AsyncTimeout {
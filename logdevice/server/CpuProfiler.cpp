@@ -0,0 +1,509 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/CpuProfiler.h"
+
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <signal.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <folly/Conv.h>
+#include <folly/Demangle.h>
+#include <folly/Format.h>
+#include <folly/experimental/symbolizer/StackTrace.h>
+#include <folly/experimental/symbolizer/Symbolizer.h>
+
+#include "logdevice/common/debug.h"
+#include "logdevice/include/Err.h"
+
+namespace facebook { namespace logdevice {
+
+namespace {
+
+constexpr size_t kMaxFrames = 64;
+// Frames of the signal handler and of the kernel's signal trampoline, on top
+// of the interrupted code.
+constexpr size_t kSkipFrames = 2;
+constexpr size_t kBufferSize = 8192;
+constexpr uint32_t kMaxFrequencyHz = 10000;
+constexpr std::chrono::milliseconds kDrainInterval{100};
+constexpr std::chrono::seconds kScanThreadsInterval{1};
+
+enum SampleState : uint8_t { FREE, WRITING, READY };
+
+struct Sample {
+  std::atomic<uint8_t> state{FREE};
+  ThreadID::Type type;
+  const char* tag;
+  std::array<char, 16> thread_name;
+  size_t num_frames;
+  // leaf first
+  std::array<uintptr_t, kMaxFrames> frames;
+};
+
+// Everything the signal handler touches. Allocated on the first start() and
+// never freed, as signals may still be in flight after a profile stops.
+struct SignalState {
+  std::atomic<bool> running{false};
+  // Bit i is set if threads of ThreadID::Type i are sampled.
+  std::atomic<uint32_t> type_mask{0};
+  std::atomic<size_t> next{0};
+  std::atomic<uint64_t> dropped{0};
+  std::array<Sample, kBufferSize> samples;
+};
+
+std::atomic<SignalState*> g_signal_state{nullptr};
+
+__thread const char* g_thread_tag = nullptr;
+
+void recordSample(SignalState& st) {
+  Sample& s = st.samples[st.next.fetch_add(1, std::memory_order_relaxed) %
+                         kBufferSize];
+  uint8_t expected = FREE;
+  if (!s.state.compare_exchange_strong(
+          expected, WRITING, std::memory_order_acquire)) {
+    // The background thread is behind.
+    st.dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  std::array<uintptr_t, kMaxFrames + kSkipFrames> frames;
+  ssize_t n =
+      folly::symbolizer::getStackTraceSafe(frames.data(), frames.size());
+  s.num_frames = n > static_cast<ssize_t>(kSkipFrames) ? n - kSkipFrames : 0;
+  std::copy(frames.begin() + kSkipFrames,
+            frames.begin() + kSkipFrames + s.num_frames,
+            s.frames.begin());
+  s.type = ThreadID::getType();
+  s.tag = g_thread_tag;
+  strncpy(s.thread_name.data(), ThreadID::getName(), s.thread_name.size());
+  s.thread_name.back() = '\0';
+  s.state.store(READY, std::memory_order_release);
+}
+
+void handleSignal(int /*sig*/, siginfo_t* info, void* /*ucontext*/) {
+  const int saved_errno = errno;
+  SignalState* st = g_signal_state.load(std::memory_order_acquire);
+  // Only counter overflows, not SIGPROF from elsewhere.
+  const bool from_counter =
+      info->si_code == POLL_HUP || info->si_code == POLL_IN;
+  if (st && from_counter && st->running.load(std::memory_order_relaxed) &&
+      (st->type_mask.load(std::memory_order_relaxed) &
+       (1u << ThreadID::getType()))) {
+    recordSample(*st);
+    // The counter disables itself after each overflow. Threads that aren't
+    // sampled are left disabled, so they don't get any more signals.
+    ioctl(info->si_fd, PERF_EVENT_IOC_REFRESH, 1);
+  }
+  errno = saved_errno;
+}
+
+void installSignalHandler() {
+  // Stays installed once profiling was used: signals may arrive after a
+  // profile stops, and the default action of SIGPROF is to terminate.
+  static std::once_flag once;
+  std::call_once(once, [] {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = handleSignal;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    int rv = sigaction(SIGPROF, &sa, nullptr);
+    ld_check(rv == 0);
+  });
+}
+
+// Opens a disabled counter sending SIGPROF to thread `tid` every
+// 1/frequency_hz seconds of its CPU time.
+int openCounter(pid_t tid, uint32_t frequency_hz) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_SOFTWARE;
+  // Counts nanoseconds.
+  attr.config = PERF_COUNT_SW_TASK_CLOCK;
+  attr.sample_period = 1000000000ull / frequency_hz;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  int fd = syscall(__NR_perf_event_open,
+                   &attr,
+                   tid,
+                   -1 /* any cpu */,
+                   -1 /* no group */,
+                   PERF_FLAG_FD_CLOEXEC);
+  if (fd < 0) {
+    return -1;
+  }
+  struct f_owner_ex owner;
+  owner.type = F_OWNER_TID;
+  owner.pid = tid;
+  if (fcntl(fd, F_SETFL, O_ASYNC) != 0 || fcntl(fd, F_SETSIG, SIGPROF) != 0 ||
+      fcntl(fd, F_SETOWN_EX, &owner) != 0) {
+    const int saved_errno = errno;
+    close(fd);
+    errno = saved_errno;
+    return -1;
+  }
+  return fd;
+}
+
+std::unordered_set<pid_t> listThreads() {
+  std::unordered_set<pid_t> tids;
+  DIR* dir = opendir("/proc/self/task");
+  if (!dir) {
+    return tids;
+  }
+  while (struct dirent* entry = readdir(dir)) {
+    pid_t tid = atoi(entry->d_name);
+    if (tid > 0) {
+      tids.insert(tid);
+    }
+  }
+  closedir(dir);
+  return tids;
+}
+
+// "rocks-high-12" -> "rocks-high-", so that threads of a pool are grouped.
+std::string threadGroup(const char* thread_name) {
+  std::string name(thread_name);
+  while (!name.empty() && isdigit(name.back())) {
+    name.pop_back();
+  }
+  return name;
+}
+
+class Profiler {
+ public:
+  int start(const CpuProfiler::Options& options);
+  int stop();
+  bool isRunning();
+  std::map<std::string, uint64_t> getFoldedStacks();
+  CpuProfiler::Counts getCounts();
+
+ private:
+  // Serializes start() and stop().
+  std::mutex start_stop_mutex_;
+  std::thread thread_;
+  uint32_t frequency_hz_;
+
+  // Protects everything below, and is used with cv_ to stop thread_.
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stop_requested_ = false;
+  // Counts per (prefix, frames leaf first).
+  std::map<std::pair<std::string, std::vector<uintptr_t>>, uint64_t> stacks_;
+  std::unordered_map<uintptr_t, std::string> symbols_;
+  uint64_t samples_ = 0;
+  size_t num_threads_ = 0;
+
+  // Only accessed by thread_. Counter of each sampled thread.
+  std::unordered_map<pid_t, int> fds_;
+
+  void run();
+  void attachThreads();
+  void detachThreads();
+  // Moves samples from the buffer into stacks_. Called with mutex_ locked.
+  // @return addresses that aren't symbolized yet
+  std::vector<uintptr_t> drain(SignalState& st);
+  void symbolize(const std::vector<uintptr_t>& addresses);
+};
+
+Profiler& profiler() {
+  static Profiler* p = new Profiler();
+  return *p;
+}
+
+SignalState& signalState() {
+  static SignalState* st = [] {
+    auto res = new SignalState();
+    g_signal_state.store(res, std::memory_order_release);
+    return res;
+  }();
+  return *st;
+}
+
+int Profiler::start(const CpuProfiler::Options& options) {
+  if (options.frequency_hz == 0 || options.frequency_hz > kMaxFrequencyHz) {
+    err = E::INVALID_PARAM;
+    return -1;
+  }
+  std::lock_guard<std::mutex> start_stop_guard(start_stop_mutex_);
+  if (thread_.joinable()) {
+    err = E::INPROGRESS;
+    return -1;
+  }
+  // Check that counters can be opened before going any further.
+  int fd = openCounter(ThreadID::getId(), options.frequency_hz);
+  if (fd < 0) {
+    ld_error("perf_event_open() failed: %s", strerror(errno));
+    err = errno == EACCES || errno == EPERM ? E::ACCESS : E::NOTSUPPORTED;
+    return -1;
+  }
+  close(fd);
+
+  SignalState& st = signalState();
+  installSignalHandler();
+  uint32_t mask = 0;
+  for (ThreadID::Type type : options.thread_types) {
+    mask |= 1u << type;
+  }
+  st.type_mask.store(options.thread_types.empty() ? ~0u : mask);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_requested_ = false;
+    // Also discards samples left over from the last profile.
+    drain(st);
+    stacks_.clear();
+    samples_ = 0;
+  }
+  st.dropped.store(0);
+  frequency_hz_ = options.frequency_hz;
+  st.running.store(true, std::memory_order_release);
+  thread_ = std::thread([this] { run(); });
+  ld_info("Started CPU profiling at %u Hz", frequency_hz_);
+  return 0;
+}
+
+int Profiler::stop() {
+  std::lock_guard<std::mutex> start_stop_guard(start_stop_mutex_);
+  if (!thread_.joinable()) {
+    err = E::NOTFOUND;
+    return -1;
+  }
+  signalState().running.store(false);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_requested_ = true;
+  }
+  cv_.notify_all();
+  thread_.join();
+  ld_info("Stopped CPU profiling");
+  return 0;
+}
+
+bool Profiler::isRunning() {
+  SignalState* st = g_signal_state.load();
+  return st && st->running.load();
+}
+
+void Profiler::run() {
+  ThreadID::set(ThreadID::Type::UTILITY, "ld:profiler");
+  SignalState& st = signalState();
+  auto next_scan = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stop_requested_) {
+    if (std::chrono::steady_clock::now() >= next_scan) {
+      lock.unlock();
+      attachThreads();
+      lock.lock();
+      next_scan = std::chrono::steady_clock::now() + kScanThreadsInterval;
+    }
+    auto unknown = drain(st);
+    if (!unknown.empty()) {
+      // Symbolizing reads debug info, keep it out of the lock.
+      lock.unlock();
+      symbolize(unknown);
+      lock.lock();
+    }
+    cv_.wait_for(lock, kDrainInterval, [this] { return stop_requested_; });
+  }
+  lock.unlock();
+  detachThreads();
+  lock.lock();
+  auto unknown = drain(st);
+  lock.unlock();
+  symbolize(unknown);
+}
+
+void Profiler::attachThreads() {
+  const pid_t self = ThreadID::getId();
+  std::unordered_set<pid_t> tids = listThreads();
+  for (auto it = fds_.begin(); it != fds_.end();) {
+    if (!tids.count(it->first)) {
+      // Thread exited.
+      close(it->second);
+      it = fds_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  for (pid_t tid : tids) {
+    if (tid == self || fds_.count(tid)) {
+      continue;
+    }
+    int fd = openCounter(tid, frequency_hz_);
+    if (fd < 0) {
+      if (errno != ESRCH) {
+        RATELIMIT_WARNING(std::chrono::seconds(10),
+                          1,
+                          "Cannot profile thread %d: %s",
+                          tid,
+                          strerror(errno));
+      }
+      continue;
+    }
+    ioctl(fd, PERF_EVENT_IOC_REFRESH, 1);
+    fds_[tid] = fd;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  num_threads_ = fds_.size();
+}
+
+void Profiler::detachThreads() {
+  for (const auto& kv : fds_) {
+    ioctl(kv.second, PERF_EVENT_IOC_DISABLE, 0);
+    close(kv.second);
+  }
+  fds_.clear();
+  std::lock_guard<std::mutex> lock(mutex_);
+  num_threads_ = 0;
+}
+
+std::vector<uintptr_t> Profiler::drain(SignalState& st) {
+  std::vector<uintptr_t> unknown;
+  for (Sample& s : st.samples) {
+    if (s.state.load(std::memory_order_acquire) != READY) {
+      continue;
+    }
+    std::string prefix = CpuProfiler::threadTypeName(s.type);
+    prefix += ';';
+    prefix += threadGroup(s.thread_name.data());
+    if (s.tag) {
+      prefix += ';';
+      prefix += s.tag;
+    }
+    std::vector<uintptr_t> frames(
+        s.frames.begin(), s.frames.begin() + s.num_frames);
+    s.state.store(FREE, std::memory_order_release);
+
+    for (uintptr_t addr : frames) {
+      if (!symbols_.count(addr)) {
+        // Placeholder until symbolized, also avoids duplicates in `unknown`.
+        symbols_[addr] = folly::sformat("{:#x}", addr);
+        unknown.push_back(addr);
+      }
+    }
+    ++stacks_[std::make_pair(std::move(prefix), std::move(frames))];
+    ++samples_;
+  }
+  return unknown;
+}
+
+void Profiler::symbolize(const std::vector<uintptr_t>& addresses) {
+  if (addresses.empty()) {
+    return;
+  }
+  folly::symbolizer::Symbolizer symbolizer(
+      folly::symbolizer::LocationInfoMode::DISABLED);
+  std::vector<std::pair<uintptr_t, std::string>> names;
+  names.reserve(addresses.size());
+  for (uintptr_t addr : addresses) {
+    folly::symbolizer::SymbolizedFrame frame;
+    symbolizer.symbolize(addr, frame);
+    if (frame.found && frame.name) {
+      names.emplace_back(addr, folly::demangle(frame.name).toStdString());
+    }
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& kv : names) {
+    symbols_[kv.first] = std::move(kv.second);
+  }
+}
+
+std::map<std::string, uint64_t> Profiler::getFoldedStacks() {
+  std::map<std::string, uint64_t> res;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& kv : stacks_) {
+    std::string stack = kv.first.first;
+    const auto& frames = kv.first.second;
+    for (auto it = frames.rbegin(); it != frames.rend(); ++it) {
+      stack += ';';
+      stack += symbols_.at(*it);
+    }
+    // Different addresses may be in the same function.
+    res[stack] += kv.second;
+  }
+  return res;
+}
+
+CpuProfiler::Counts Profiler::getCounts() {
+  SignalState& st = signalState();
+  std::lock_guard<std::mutex> lock(mutex_);
+  return CpuProfiler::Counts{samples_, st.dropped.load(), num_threads_};
+}
+
+} // namespace
+
+int CpuProfiler::start(const Options& options) {
+  return profiler().start(options);
+}
+
+int CpuProfiler::stop() {
+  return profiler().stop();
+}
+
+bool CpuProfiler::isRunning() {
+  return profiler().isRunning();
+}
+
+std::map<std::string, uint64_t> CpuProfiler::getFoldedStacks() {
+  return profiler().getFoldedStacks();
+}
+
+CpuProfiler::Counts CpuProfiler::getCounts() {
+  return profiler().getCounts();
+}
+
+void CpuProfiler::setThreadTag(const char* tag) {
+  g_thread_tag = tag;
+}
+
+const char* CpuProfiler::threadTypeName(ThreadID::Type type) {
+  switch (type) {
+    case ThreadID::UNKNOWN:
+      return "unknown";
+    case ThreadID::SERVER_WORKER:
+      return "worker";
+    case ThreadID::CLIENT_WORKER:
+      return "client_worker";
+    case ThreadID::CPU_EXEC:
+      return "cpu_exec";
+    case ThreadID::UNKNOWN_WORKER:
+      return "unknown_worker";
+    case ThreadID::UNKNOWN_EVENT_LOOP:
+      return "event_loop";
+    case ThreadID::STORAGE:
+      return "storage";
+    case ThreadID::LOGSDB:
+      return "logsdb";
+    case ThreadID::ROCKSDB:
+      return "rocksdb";
+    case ThreadID::UTILITY:
+      return "utility";
+    case ThreadID::WHEEL_TIMER:
+      return "wheel_timer";
+  }
+  return "unknown";
+}
+
+}} // namespace facebook::logdevice
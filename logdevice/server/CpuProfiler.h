@@ -0,0 +1,94 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "logdevice/common/ThreadID.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Sampling CPU profiler for the threads of this process, driven by the
+ *       "profile cpu" admin commands, so that a CPU-hot server can be looked
+ *       at without attaching perf by hand.
+ *
+ *       Each thread gets a perf_event_open() task clock counter that
+ *       overflows every 1/frequency seconds of the thread's CPU time and then
+ *       sends SIGPROF to that thread. The signal handler records the stack
+ *       of the thread with its ThreadID type and name and the tag set with
+ *       setThreadTag() (e.g. the storage task being executed) into a
+ *       fixed-size buffer. A background thread drains the buffer into
+ *       per-stack counts, symbolizes new addresses and attaches counters to
+ *       new threads, so getFoldedStacks() is cheap.
+ *
+ *       One profile per process at a time. All methods are thread-safe.
+ */
+class CpuProfiler {
+ public:
+  struct Options {
+    uint32_t frequency_hz = 99;
+    // Types of the threads to sample. Empty means all threads.
+    std::vector<ThreadID::Type> thread_types;
+  };
+
+  /**
+   * Starts sampling, discarding the samples of the previous profile.
+   *
+   * @return 0 on success, -1 with err set to
+   *           INPROGRESS    a profile is already running,
+   *           INVALID_PARAM frequency is 0 or above 10 kHz,
+   *           ACCESS        perf_event_open() is not allowed, see
+   *                         /proc/sys/kernel/perf_event_paranoid,
+   *           NOTSUPPORTED  perf_event_open() is not available.
+   */
+  static int start(const Options& options);
+
+  /**
+   * Stops sampling. Samples are kept until the next start().
+   *
+   * @return 0 on success, -1 with err set to NOTFOUND if not running.
+   */
+  static int stop();
+
+  static bool isRunning();
+
+  /**
+   * Stacks sampled by the current or last profile, in the "folded" format of
+   * flame graph tools, mapped to their number of samples:
+   *   <thread type>;<thread name>[;<tag>];<root frame>;...;<leaf frame>
+   * Thread names have their trailing digits removed to group thread pools.
+   */
+  static std::map<std::string, uint64_t> getFoldedStacks();
+
+  struct Counts {
+    // recorded into the folded stacks
+    uint64_t samples;
+    // lost because the buffer was full
+    uint64_t dropped;
+    // currently sampled
+    size_t threads;
+  };
+  static Counts getCounts();
+
+  /**
+   * Tags the samples taken on this thread until reset to nullptr. `tag` must
+   * stay valid for the lifetime of the process, e.g. a string literal or an
+   * entry of a type name table. Cheap enough to call for every task.
+   */
+  static void setThreadTag(const char* tag);
+
+  // The name used in folded stacks for a thread type.
+  static const char* threadTypeName(ThreadID::Type type);
+};
+
+}} // namespace facebook::logdevice
@@ -164,6 +164,19 @@ class EpochMetaDataZRQ : public ZookeeperEpochStoreRequest {
         *metadata_, buf, size, node_id_to_write);
   }
 
+  // see ZookeeperEpochStoreRequest.h. The updater is only ever given the
+  // metadata it's called with, so calling it again on a fresher value is
+  // fine.
+  bool canRewind() const override {
+    return true;
+  }
+
+  void rewind() override {
+    epoch_ = EPOCH_INVALID;
+    metadata_.reset();
+    meta_properties_.reset();
+  }
+
   static constexpr const char* znodeName = "sequencer";
 
  private:
@@ -41,7 +41,8 @@ EpochRecordCache::EpochRecordCache(logid_t log_id,
       deps_(deps),
       tail_optimized_(tail_optimized),
       stored_(stored),
-      buffer_(capacity) {
+      buffer_(capacity),
+      slab_(deps->getPayloadSlabSegmentSize(), deps->getStatsHolder()) {
   ld_check(capacity > 0);
   ld_check(deps_ != nullptr);
 }
@@ -354,6 +355,9 @@ int EpochRecordCache::putRecord(RecordID rid,
     // we reach here either because there is no exising entry, or we decided
     // to replace it with the new one
     ld_check(buffer_[getIndex(rid.esn)] == nullptr);
+    // copy the payload out of the buffer it was received in. The entry has
+    // not been shared yet, so it can still be modified.
+    entry->payload = slab_.store(entry->payload);
     noteEntryAdded(*entry);
     buffer_[getIndex(rid.esn)] = std::move(entry);
 
@@ -401,16 +405,29 @@ void EpochRecordCache::updateTailRecord(
     flags |= TailRecordHeader::CHECKSUM_PARITY;
   }
 
+  const TailRecordHeader header{
+      log_id_,
+      tail->lsn,
+      tail->timestamp,
+      {BYTE_OFFSET_INVALID /* deprecated, use offsets instead */},
+      flags,
+      {}};
+
   // replace the existing tail record
-  tail_record_ =
-      TailRecord({log_id_,
-                  tail->lsn,
-                  tail->timestamp,
-                  {BYTE_OFFSET_INVALID /* deprecated, use offsets instead */},
-                  flags,
-                  {}},
-                 std::move(offsets),
-                 tail_optimized_ == TailOptimized::YES ? tail : nullptr);
+  if (tail_optimized_ == TailOptimized::YES &&
+      slab_.stores(tail->payload.size())) {
+    // The tail record may outlive all other records of the epoch by far,
+    // don't let it hold on to a whole slab segment.
+    tail_record_ = TailRecord(
+        header,
+        std::move(offsets),
+        PayloadHolder::copyPayload(tail->payload.getPayload()));
+  } else {
+    tail_record_ =
+        TailRecord(header,
+                   std::move(offsets),
+                   tail_optimized_ == TailOptimized::YES ? tail : nullptr);
+  }
 }
 
 // must be called with write lock held
@@ -678,6 +695,9 @@ EpochRecordCache::Snapshot::createFromLinearBuffer(
 
   std::unique_ptr<Snapshot> snapshot;
   size_t cumulative_size = 0;
+  // Payloads of the snapshot are packed into segments as they are read.
+  RecordCacheSlab slab(
+      deps->getPayloadSlabSegmentSize(), deps->getStatsHolder());
   {
     // 1) Read the header
     CacheHeader header;
@@ -787,7 +807,8 @@ EpochRecordCache::Snapshot::createFromLinearBuffer(
         buffer + cumulative_size,
         size - cumulative_size,
         EpochRecordCacheEntry::Disposer(deps),
-        &entry_size);
+        &entry_size,
+        &slab);
     if (entry == nullptr) {
       return nullptr;
     }
@@ -23,6 +23,7 @@
 #include "logdevice/common/types_internal.h"
 #include "logdevice/common/util.h"
 #include "logdevice/server/RecordCacheDependencies.h"
+#include "logdevice/server/RecordCacheSlab.h"
 
 namespace facebook { namespace logdevice {
 
@@ -34,7 +35,8 @@ namespace facebook { namespace logdevice {
  *       EpochRecordCache is being written frequently by many threads, and
  *       read rarely only during log recovery procedures. Currently it is
  *       implemented as a circular buffer protected by a write favorable
- *       high performance lock.
+ *       high performance lock. Payloads of cached records are packed into
+ *       per-epoch segments by a RecordCacheSlab.
  */
 
 class EpochRecordCacheEntry;
@@ -468,6 +470,9 @@ class EpochRecordCache {
   // actual buffer for storing (pointers to) cache entries
   CircularBuffer<std::shared_ptr<EpochRecordCacheEntry>> buffer_;
 
+  // storage for payloads of entries in buffer_, protected by rw_lock_
+  RecordCacheSlab slab_;
+
   // number and total size of payloads in buffer_.
   // Uses the same synchronization (rw_lock_) as buffer_. They are atomic
   // to allow concurrent reading while being modified
@@ -18,6 +18,7 @@
 #include "logdevice/include/Err.h"
 #include "logdevice/server/EpochRecordCache.h"
 #include "logdevice/server/RecordCacheDependencies.h"
+#include "logdevice/server/RecordCacheSlab.h"
 
 namespace facebook { namespace logdevice {
 
@@ -47,7 +48,8 @@ EpochRecordCacheEntry::EpochRecordCacheEntry(
 
 int EpochRecordCacheEntry::fromLinearBuffer(lsn_t lsn,
                                             const char* buffer,
-                                            size_t size) {
+                                            size_t size,
+                                            RecordCacheSlab* slab) {
   this->lsn = lsn;
   if (sizeof(EntryHeader) > size) {
     RATELIMIT_ERROR(std::chrono::seconds(10),
@@ -99,8 +101,9 @@ int EpochRecordCacheEntry::fromLinearBuffer(lsn_t lsn,
 
   // reconstruct payload
   if (header.payload_size > 0) {
-    payload =
-        PayloadHolder::copyBuffer(buffer + current_size, header.payload_size);
+    payload = slab != nullptr
+        ? slab->store(buffer + current_size, header.payload_size)
+        : PayloadHolder::copyBuffer(buffer + current_size, header.payload_size);
     current_size += header.payload_size;
   } else {
     payload = PayloadHolder();
@@ -183,10 +186,11 @@ EpochRecordCacheEntry::createFromLinearBuffer(lsn_t lsn,
                                               const char* buffer,
                                               size_t size,
                                               Disposer disposer,
-                                              size_t* result_size) {
+                                              size_t* result_size,
+                                              RecordCacheSlab* slab) {
   auto result = std::shared_ptr<EpochRecordCacheEntry>(
       new EpochRecordCacheEntry(), disposer);
-  ssize_t linear_size = result->fromLinearBuffer(lsn, buffer, size);
+  ssize_t linear_size = result->fromLinearBuffer(lsn, buffer, size, slab);
   if (result_size != nullptr) {
     *result_size = linear_size;
   }
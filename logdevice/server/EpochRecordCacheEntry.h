@@ -20,6 +20,7 @@
 namespace facebook { namespace logdevice {
 
 class EpochRecordCacheDependencies;
+class RecordCacheSlab;
 
 namespace EpochRecordCacheSerializer {
 class EpochRecordCacheCompare;
@@ -40,13 +41,16 @@ class EpochRecordCacheEntry : public ZeroCopiedRecord {
    *
    * If result_size is not nullptr, it will be set to the size in the buffer
    * that the reconstructed entry was using, or 0 if the buffer is too small.
+   *
+   * If slab is not nullptr, the payload is copied into it.
    */
   static std::shared_ptr<EpochRecordCacheEntry>
   createFromLinearBuffer(lsn_t lsn,
                          const char* buffer,
                          size_t size,
                          Disposer disposer,
-                         size_t* result_size = nullptr);
+                         size_t* result_size = nullptr,
+                         RecordCacheSlab* slab = nullptr);
 
   /**
    * Calculate the size that this cache, in its current state, would have in
@@ -73,7 +77,10 @@ class EpochRecordCacheEntry : public ZeroCopiedRecord {
                         const PayloadHolder& payload_holder);
 
  private:
-  int fromLinearBuffer(lsn_t lsn, const char* buffer, size_t size);
+  int fromLinearBuffer(lsn_t lsn,
+                       const char* buffer,
+                       size_t size,
+                       RecordCacheSlab* slab);
 
   friend class ZeroCopiedRecord;
   friend class EpochRecordCacheSerializer::EpochRecordCacheCompare;
@@ -13,6 +13,7 @@
 
 #include <folly/Memory.h>
 #include <folly/Random.h>
+#include <folly/ScopeGuard.h>
 #include <folly/small_vector.h>
 
 #include "logdevice/common/ClusterState.h"
@@ -20,6 +21,7 @@
 #include "logdevice/common/GetClusterStateRequest.h"
 #include "logdevice/common/NodeID.h"
 #include "logdevice/common/Sender.h"
+#include "logdevice/common/chrono_util.h"
 #include "logdevice/common/configuration/Configuration.h"
 #include "logdevice/common/configuration/nodes/utils.h"
 #include "logdevice/common/request_util.h"
@@ -446,6 +448,10 @@ void FailureDetector::gossip() {
         uint32_t gl = it.second.gossip_;
         it.second.gossip_ = std::max(gl, gl + 1);
       }
+      if (it.second.last_sent_.hasValue()) {
+        uint32_t sent = it.second.last_sent_->gossip_;
+        it.second.last_sent_->gossip_ = std::max(sent, sent + 1);
+      }
     }
     last_gossip_tick_time_ = now;
   }
@@ -539,6 +545,14 @@ void FailureDetector::gossip() {
 
   GOSSIP_Message::node_list_t gossip_node_list;
   GOSSIP_Message::versions_node_list_t versions_list;
+  // Entries that didn't change since we last sent them tell the recipient
+  // nothing new: their gossip_ only went up by the number of ticks, and the
+  // recipient's own counters did the same. Leave them out of most messages
+  // and send everything once in a while, in case the recipient missed
+  // something.
+  const bool full_gossip = !skip_full_gossip_;
+  std::vector<bool> changed;
+  size_t num_unchanged = 0;
   if (!skip_sending_versions_) {
     fetchVersions(rsm_version_type_to_send_);
     if (rsm_version_type_to_send_ == RsmVersionType::IN_MEMORY) {
@@ -577,6 +591,19 @@ void FailureDetector::gossip() {
     gnode.node_status_ = fdnode.status_;
     gossip_node_list.push_back(gnode);
 
+    const auto& last = fdnode.last_sent_;
+    const bool node_changed = !last.hasValue() ||
+        gnode.gossip_ < last->gossip_ || gnode.gossip_ts_ != last->gossip_ts_ ||
+        gnode.failover_ != last->failover_ ||
+        gnode.is_node_starting_ != last->is_node_starting_ ||
+        gnode.node_status_ != last->node_status_;
+    if (full_gossip || node_changed) {
+      fdnode.last_sent_ = gnode;
+    } else {
+      ++num_unchanged;
+    }
+    changed.push_back(node_changed);
+
     if (flags & GOSSIP_Message::HAS_IN_MEM_VERSIONS ||
         flags & GOSSIP_Message::HAS_DURABLE_SNAPSHOT_VERSIONS) {
       Versions_Node rnode;
@@ -618,21 +645,28 @@ void FailureDetector::gossip() {
 
   skip_sending_versions_ = (skip_sending_versions_ + 1) %
       (settings_->gossip_include_rsm_versions_frequency);
+  skip_full_gossip_ =
+      (skip_full_gossip_ + 1) % (settings_->gossip_full_sync_frequency);
 
   // bump the message sequence number
   ++current_msg_id_;
-  int rv = sendGossipMessage(
-      dest,
-      std::make_unique<GOSSIP_Message>(this_node,
-                                       std::move(gossip_node_list),
-                                       instance_id_,
-                                       getCurrentTimeInMillis(),
-                                       std::move(boycotts),
-                                       std::move(boycott_durations),
-                                       flags,
-                                       current_msg_id_,
-                                       registered_rsms_,
-                                       std::move(versions_list)));
+  auto msg = std::make_unique<GOSSIP_Message>(this_node,
+                                              std::move(gossip_node_list),
+                                              instance_id_,
+                                              getCurrentTimeInMillis(),
+                                              std::move(boycotts),
+                                              std::move(boycott_durations),
+                                              flags,
+                                              current_msg_id_,
+                                              registered_rsms_,
+                                              std::move(versions_list));
+  if (!full_gossip) {
+    msg->changed_ = std::move(changed);
+    STAT_INCR(getStats(), gossips_sent_delta);
+    STAT_ADD(getStats(), gossip_nodes_unchanged, num_unchanged);
+  }
+
+  int rv = sendGossipMessage(dest, std::move(msg));
 
   if (rv != 0) {
     RATELIMIT_DEBUG(std::chrono::seconds(1),
@@ -780,6 +814,11 @@ void FailureDetector::onGossipReceived(const GOSSIP_Message& msg) {
     return;
   }
 
+  const auto start_time = std::chrono::steady_clock::now();
+  SCOPE_EXIT {
+    HISTOGRAM_ADD(getStats(), gossip_processing_time, usec_since(start_time));
+  };
+
   node_index_t this_index = getMyNodeID().index();
 
   if (shouldDumpState()) {
@@ -824,6 +863,11 @@ void FailureDetector::onGossipReceived(const GOSSIP_Message& msg) {
   const bool has_starting_list =
       msg.flags_ & GOSSIP_Message::HAS_STARTING_LIST_FLAG;
 
+  if (msg.is_delta_) {
+    STAT_INCR(getStats(), gossips_received_delta);
+  }
+  STAT_ADD(getStats(), gossip_nodes_received, msg.node_list_.size());
+
   bool update_statuses = senderUsingHealthMonitor(sender_idx, msg.node_list_);
   std::unordered_set<size_t> node_ids_to_skip;
   std::unordered_set<size_t> nodes_with_new_instances;
@@ -1044,8 +1088,11 @@ void FailureDetector::shutdown() {
 }
 
 void FailureDetector::dumpGossipMessage(const GOSSIP_Message& msg) {
-  ld_info(
-      "Flags from %s 0x%x", msg.gossip_node_.toString().c_str(), msg.flags_);
+  ld_info("Flags from %s 0x%x, %zu nodes%s",
+          msg.gossip_node_.toString().c_str(),
+          msg.flags_,
+          msg.node_list_.size(),
+          msg.is_delta_ ? " (delta)" : "");
 }
 
 void FailureDetector::getClusterDeadNodeStats(size_t* effective_dead_cnt,
@@ -337,6 +337,11 @@ class FailureDetector {
     // indicated by a setting GOSSIP_Message::LONG_TIME_SINCE_LAST_GOSSIP flag.
     bool stalled_gossip_processor_{false};
 
+    // This node's entry in the last gossip message we sent that included it,
+    // with gossip_ bumped on every tick since. Unset if we never sent one.
+    // Used to leave unchanged entries out of delta gossip messages.
+    folly::Optional<GOSSIP_Node> last_sent_;
+
     Node()
         : state_(NodeState::DEAD),
           blacklisted_(false),
@@ -600,6 +605,9 @@ class FailureDetector {
   // keeps track of when RSM version information should be sent along with
   // the GOSSIP_Message
   uint32_t skip_sending_versions_{0};
+  // keeps track of when the next gossip message should include all nodes
+  // rather than just the ones that changed
+  uint32_t skip_full_gossip_{0};
   RsmVersionType rsm_version_type_to_send_{RsmVersionType::IN_MEMORY};
 
   // these helper functions are overridden in unit tests
@@ -237,6 +237,7 @@ void HealthMonitor::processReports() {
   node_status_ = (sleep_period_ < state_timer_.getCurrentValue())
       ? NodeHealthStatus::UNHEALTHY
       : overloaded_ ? NodeHealthStatus::OVERLOADED : NodeHealthStatus::HEALTHY;
+  published_status_.store(node_status_);
   stats.curr_state_timer_value_ms = state_timer_.getCurrentValue().count();
   updateFailureDetectorStatus(node_status_);
   updateNodeHealthStats(stats);
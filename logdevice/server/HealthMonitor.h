@@ -41,6 +41,10 @@ class HealthMonitor {
   folly::SemiFuture<folly::Unit> shutdown();
   void setFailureDetector(FailureDetector* failure_detector);
   NodeHealthStats getNodeHealthStats();
+  // Node status as of the last completed monitoring loop. Thread-safe.
+  NodeHealthStatus getNodeStatus() const {
+    return published_status_.load();
+  }
 
   // reporter methods
   void reportWatchdogHealth(bool delayed);
@@ -119,6 +123,7 @@ class HealthMonitor {
 
  protected:
   NodeHealthStatus node_status_{NodeHealthStatus::HEALTHY};
+  std::atomic<NodeHealthStatus> published_status_{NodeHealthStatus::HEALTHY};
   bool overloaded_{false};
   const std::chrono::milliseconds sleep_period_;
   ChronoExponentialBackoffAdaptiveVariable<std::chrono::milliseconds>
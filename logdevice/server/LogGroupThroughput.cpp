@@ -18,12 +18,66 @@
 
 namespace facebook { namespace logdevice {
 
+namespace {
+
+// Merges the thread-local PerLogHeavyHitters of `time_series` and returns
+// the rates of their top log groups and of `log_groups`.
+AggregateMap
+doAggregateHeavyHitters(StatsHolder* stats,
+                        const std::string& time_series,
+                        const std::vector<Duration>& intervals,
+                        const std::vector<std::string>& log_groups) {
+  std::unique_ptr<WindowedHeavyHitters> PerLogHeavyHitters::*member_ptr =
+      nullptr;
+  std::chrono::milliseconds span{0};
+#define TIME_SERIES_DEFINE(name, strings, _, __)                   \
+  for (const std::string& str : strings) {                         \
+    if (str == time_series) {                                      \
+      member_ptr = &PerLogHeavyHitters::name;                      \
+      span = stats->params_.get()->time_intervals_##name.back();   \
+      break;                                                       \
+    }                                                              \
+  }
+#include "logdevice/common/stats/per_log_time_series.inc" // nolint
+  ld_check(member_ptr != nullptr);
+
+  WindowedHeavyHitters merged(span, stats->params_.get()->per_log_stats_top_k);
+  stats->runForEach([&](Stats& s) {
+    std::lock_guard<std::mutex> guard(s.per_log_heavy_hitters.mutex);
+    const auto& hh = s.per_log_heavy_hitters.*member_ptr;
+    if (hh) {
+      merged.merge(*hh);
+    }
+  });
+
+  std::vector<std::chrono::milliseconds> intervals_ms;
+  for (Duration interval : intervals) {
+    intervals_ms.push_back(
+        std::chrono::duration_cast<std::chrono::milliseconds>(interval));
+  }
+  const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now().time_since_epoch());
+
+  AggregateMap output;
+  for (auto& kv : merged.rates(intervals_ms, now, log_groups)) {
+    output[kv.first] = OneGroupResults(kv.second.begin(), kv.second.end());
+  }
+  return output;
+}
+
+} // namespace
+
 // Accesses thread-local per-log-group stats and aggregates them all into a
 // big map
 AggregateMap doAggregate(StatsHolder* stats,
                          std::string time_series_,
                          const std::vector<Duration>& intervals,
-                         std::shared_ptr<LogsConfig> logs_config) {
+                         std::shared_ptr<LogsConfig> logs_config,
+                         const std::vector<std::string>& log_groups) {
+  if (stats->params_.get()->per_log_stats_top_k > 0) {
+    return doAggregateHeavyHitters(stats, time_series_, intervals, log_groups);
+  }
+
   // Okay...  For each thread, for each log group in the thread-local
   // PerLogStats, for each query interval, calculate the rate in B/s and
   // aggregate.  Output is a map (log group, query interval) -> (sum of
@@ -28,10 +28,15 @@ using TimePoint = PerLogTimeSeries::TimeSeries::TimePoint;
 
 using AggregateMap = folly::StringKeyedUnorderedMap<OneGroupResults>;
 
+// Aggregates the rates of `time_series_` over `intervals` of all log groups
+// across threads. With StatsParams::per_log_stats_top_k, only the top log
+// groups and the ones in `log_groups` are included, and the latter may be
+// approximate.
 AggregateMap doAggregate(StatsHolder* stats,
                          std::string time_series_,
                          const std::vector<Duration>& intervals,
-                         std::shared_ptr<LogsConfig> logs_config);
+                         std::shared_ptr<LogsConfig> logs_config,
+                         const std::vector<std::string>& log_groups = {});
 
 Duration getMaxInterval(StatsHolder* stats_holder, std::string time_series);
 
@@ -211,6 +211,8 @@ void LogStoreMonitor::checkFreeSpace() {
     return;
   }
 
+  sharded_rocks_store->trimInMemoryShardsIfNeeded();
+
   const std::unordered_map<dev_t,
                            ShardedRocksDBLocalLogStore::DiskShardMappingEntry>&
       shards_to_disks = sharded_rocks_store->getShardToDiskMapping();
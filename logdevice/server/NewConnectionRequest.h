@@ -65,9 +65,13 @@ class NewConnectionRequest : public Request {
     conntype_ = conntype;
   }
 
+  void setWorkerId(worker_id_t worker_id) {
+    worker_id_ = worker_id;
+  }
+
  private:
   const int fd_;
-  const worker_id_t worker_id_;
+  worker_id_t worker_id_;
   const Sockaddr client_addr_;
   ResourceBudget::Token conn_token_;
   ResourceBudget::Token conn_backlog_token_;
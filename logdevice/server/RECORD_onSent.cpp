@@ -56,4 +56,17 @@ void RECORD_onSent(const RECORD_Message& msg,
   }
 }
 
+void MULTI_RECORD_onSent(const MULTI_RECORD_Message& msg,
+                         Status st,
+                         const Address& to,
+                         const SteadyTimestamp enqueue_time) {
+  if (st == E::OK) {
+    WORKER_STAT_INCR(multi_record_messages_sent);
+    WORKER_STAT_ADD(multi_record_records_batched, msg.getRecords().size());
+  }
+  for (const auto& record : msg.getRecords()) {
+    RECORD_onSent(*record, st, to, enqueue_time);
+  }
+}
+
 }} // namespace facebook::logdevice
@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include "logdevice/common/protocol/MULTI_RECORD_Message.h"
 #include "logdevice/common/protocol/Message.h"
 #include "logdevice/common/protocol/RECORD_Message.h"
 
@@ -15,4 +16,10 @@ void RECORD_onSent(const RECORD_Message& msg,
                    Status st,
                    const Address& to,
                    const SteadyTimestamp enqueue_time);
+
+// Same as RECORD_onSent() for each of the records in the message.
+void MULTI_RECORD_onSent(const MULTI_RECORD_Message& msg,
+                         Status st,
+                         const Address& to,
+                         const SteadyTimestamp enqueue_time);
 }} // namespace facebook::logdevice
@@ -7,7 +7,10 @@
  */
 #include "logdevice/server/RealTimeRecordBuffer.h"
 
+#include <algorithm>
+
 #include <folly/Format.h>
+#include <folly/hash/Hash.h>
 
 #include "logdevice/common/ZeroCopiedRecord.h"
 #include "logdevice/common/debug.h"
@@ -65,6 +68,49 @@ bool RealTimeRecordBuffer::appendReleasedRecords(
   return new_size > eviction_threshold_bytes_;
 }
 
+namespace {
+
+std::pair<size_t, size_t> demandSlots(logid_t logid, size_t num_counters) {
+  const uint64_t h = folly::hash::twang_mix64(logid.val());
+  return {h % num_counters, (h >> 32) % num_counters};
+}
+
+} // namespace
+
+void RealTimeRecordBuffer::noteDemand(logid_t logid) {
+  if (!admission_control_) {
+    return;
+  }
+  auto slots = demandSlots(logid, DEMAND_COUNTERS);
+  for (size_t slot : {slots.first, slots.second}) {
+    if (demand_[slot] < DEMAND_MAX) {
+      demand_[slot]++;
+    }
+  }
+  if (++demand_increments_ >= DEMAND_SAMPLE_SIZE) {
+    for (uint8_t& counter : demand_) {
+      counter /= 2;
+    }
+    demand_increments_ = 0;
+  }
+}
+
+uint8_t RealTimeRecordBuffer::demandEstimate(logid_t logid) const {
+  auto slots = demandSlots(logid, DEMAND_COUNTERS);
+  return std::min(demand_[slots.first], demand_[slots.second]);
+}
+
+bool RealTimeRecordBuffer::admit(logid_t logid) const {
+  if (!admission_control_ || !overEvictionThreshold()) {
+    return true;
+  }
+  const logid_t victim = logids_.getLRU();
+  if (victim == LOGID_INVALID || victim == logid) {
+    return true;
+  }
+  return demandEstimate(logid) >= demandEstimate(victim);
+}
+
 size_t RealTimeRecordBuffer::shutdown() {
   shutdown_.store(true);
   size_t count = 0;
@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include <array>
 #include <memory>
 #include <string>
 
@@ -101,13 +102,30 @@ class ReleasedRecords {
 // There is one of these per Worker, it lives in AllServerReadStreams.
 class RealTimeRecordBuffer {
  public:
+  /**
+   * @param max_bytes_per_log   If nonzero, a log whose distributed records
+   *                            take up more than this is evicted, so that one
+   *                            high-throughput log can't push the records of
+   *                            all other logs out of the buffer.
+   * @param admission_control   If true, once the buffer is over the eviction
+   *                            threshold, newly released records of a log are
+   *                            only admitted if readers have recently asked
+   *                            for that log at least as often as for the
+   *                            log that would be evicted next.
+   */
   RealTimeRecordBuffer(size_t eviction_threshold_bytes,
                        size_t max_bytes,
-                       StatsHolder* stats)
+                       StatsHolder* stats,
+                       size_t max_bytes_per_log = 0,
+                       bool admission_control = false)
       : eviction_threshold_bytes_(eviction_threshold_bytes),
         max_bytes_(max_bytes),
+        max_bytes_per_log_(max_bytes_per_log),
+        admission_control_(admission_control),
         stats_(stats),
-        logids_(LOGID_INVALID, LOGID_INVALID2) {}
+        logids_(LOGID_INVALID, LOGID_INVALID2) {
+    demand_.fill(0);
+  }
 
   RealTimeRecordBuffer(const RealTimeRecordBuffer&) = delete;
   RealTimeRecordBuffer operator=(const RealTimeRecordBuffer&) = delete;
@@ -136,6 +154,14 @@ class RealTimeRecordBuffer {
     return released_records_bytes_.load() > max_bytes_;
   }
 
+  size_t getBytes() const {
+    return released_records_bytes_.load();
+  }
+
+  size_t getMaxBytes() const {
+    return max_bytes_;
+  }
+
   logid_t toEvict() {
     return logids_.getLRU();
   }
@@ -147,14 +173,47 @@ class RealTimeRecordBuffer {
   void deletedReleasedRecords(const ReleasedRecords* records) {
     released_records_bytes_.fetch_sub(records->getBytesEstimate());
 
-    auto count_and_iter = logids_.getWithoutPromotion(records->logid_);
-    ld_check(count_and_iter.first != nullptr);
+    auto entry_and_iter = logids_.getWithoutPromotion(records->logid_);
+    ld_check(entry_and_iter.first != nullptr);
+
+    LogEntry& entry = *entry_and_iter.first;
+    ld_check(entry.count > 0);
+    ld_check(entry.bytes >= records->getBytesEstimate());
+    entry.count--;
+    entry.bytes -= records->getBytesEstimate();
+    if (entry.count == 0) {
+      logids_.erase(entry_and_iter.second);
+    }
+  }
+
+  /**
+   * Called when a reader tailing `logid` wants newly released records,
+   * whether or not they end up being served from this buffer.  Feeds the
+   * demand estimate used by admit().
+   */
+  void noteDemand(logid_t logid);
+
+  /**
+   * Decides whether newly released records of `logid` should be handed to
+   * read streams.  Always true unless admission control is enabled and the
+   * buffer is over its eviction threshold, in which case the records are
+   * admitted only if the recent reader demand for `logid` is at least that of
+   * the least recently used log, which would be evicted to make room.
+   * Must be called before addToLRU() for the records.
+   */
+  bool admit(logid_t logid) const;
 
-    ld_check(*count_and_iter.first > 0);
-    (*count_and_iter.first)--;
-    if (*count_and_iter.first == 0) {
-      logids_.erase(count_and_iter.second);
+  /**
+   * @return true if records of `logid` handed to read streams take up more
+   *         than the per-log quota.
+   */
+  bool overLogQuota(logid_t logid) {
+    if (max_bytes_per_log_ == 0) {
+      return false;
     }
+    auto entry_and_iter = logids_.getWithoutPromotion(logid);
+    return entry_and_iter.first != nullptr &&
+        entry_and_iter.first->bytes > max_bytes_per_log_;
   }
 
   // This moves ZeroCopiedRecords to various workers, so must be run before
@@ -162,8 +221,10 @@ class RealTimeRecordBuffer {
   // Returns the number of groups of records that were removed.
   size_t shutdown();
 
-  void addToLRU(logid_t logid) {
-    logids_.getOrAddWithoutPromotion(logid)++;
+  void addToLRU(const ReleasedRecords& records) {
+    LogEntry& entry = logids_.getOrAddWithoutPromotion(records.logid_);
+    entry.count++;
+    entry.bytes += records.getBytesEstimate();
   }
 
  private:
@@ -180,8 +241,33 @@ class RealTimeRecordBuffer {
 
   const size_t max_bytes_;
 
+  const size_t max_bytes_per_log_;
+
+  const bool admission_control_;
+
   StatsHolder* const stats_;
 
+  // @return estimate of how many times noteDemand() was recently called for
+  // `logid`.
+  uint8_t demandEstimate(logid_t logid) const;
+
+  // A count-min sketch of reader demand per log, in the spirit of TinyLFU:
+  // two saturating counters per log, in a fixed-size table.  All counters are
+  // halved every DEMAND_SAMPLE_SIZE increments, so the estimate reflects
+  // recent demand rather than the whole history.
+  static constexpr size_t DEMAND_COUNTERS = 4096;
+  static constexpr uint8_t DEMAND_MAX = 15;
+  static constexpr size_t DEMAND_SAMPLE_SIZE = 10 * DEMAND_COUNTERS;
+  std::array<uint8_t, DEMAND_COUNTERS> demand_;
+  size_t demand_increments_{0};
+
+  struct LogEntry {
+    // Number of ReleasedRecords instances for the log.
+    size_t count{0};
+    // Sum of their getBytesEstimate().
+    size_t bytes{0};
+  };
+
   struct GetVal {
     size_t operator()(const logid_t logid) const {
       return logid.val();
@@ -189,17 +275,17 @@ class RealTimeRecordBuffer {
   };
 
   // This maps logids to a count of how many ReleasedRecords instances we have
-  // for that logid.  Its only for the ones in ServerReadStream's
-  // released_records_, NOT the ones in our released_records_.  This also keeps
-  // them in order of when we last sent them to a client, or if they've never
-  // been sent, when we added them.  It's used for evicting from the cache when
-  // it is full.
+  // for that logid, and how many bytes they take up.  Its only for the ones in
+  // ServerReadStream's released_records_, NOT the ones in our
+  // released_records_.  This also keeps them in order of when we last sent
+  // them to a client, or if they've never been sent, when we added them.  It's
+  // used for evicting from the cache when it is full.
   //
   // The count is decremeneted whenever a ReleasedRecords() is destroyed and
   // incremented in addToLRU(), so addToLRU() must be called once for
   // every ReleasedRecords we create.
 
-  UnorderedMapWithLRU<logid_t, size_t, GetVal> logids_;
+  UnorderedMapWithLRU<logid_t, LogEntry, GetVal> logids_;
 
   // After shutdown() is called, no more records should be appended.  Assert
   // that in debug builds.
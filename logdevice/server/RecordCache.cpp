@@ -7,6 +7,8 @@
  */
 #include "logdevice/server/RecordCache.h"
 
+#include <folly/ScopeGuard.h>
+
 #include "logdevice/common/AdminCommandTable.h"
 #include "logdevice/common/RecordID.h"
 #include "logdevice/common/debug.h"
@@ -56,6 +58,9 @@ int RecordCache::putRecord(RecordID rid,
                            const PayloadHolder& payload_holder,
                            OffsetMap offsets_within_epoch) {
   ld_check(rid.logid == log_id_);
+  SCOPE_EXIT {
+    noteModified();
+  };
 
   if (folly::kIsDebug) {
     if (shutdown_.load()) {
@@ -261,6 +266,9 @@ RecordCache::getEpochRecordCache(epoch_t epoch) const {
 }
 
 void RecordCache::onLastCleanEpochAdvanced(epoch_t lce) {
+  SCOPE_EXIT {
+    noteModified();
+  };
   epoch_t head_epoch_cached = epoch_t(head_epoch_cached_.load());
   if (head_epoch_cached == EPOCH_INVALID || lce < head_epoch_cached) {
     // cache is empty or already discarded beyond lce; nothing to do
@@ -298,6 +306,9 @@ void RecordCache::onLastCleanEpochAdvanced(epoch_t lce) {
 }
 
 void RecordCache::onRelease(lsn_t last_released) {
+  SCOPE_EXIT {
+    noteModified();
+  };
   const esn_t release_esn = lsn_to_esn(last_released);
   if (release_esn > ESN_INVALID) {
     // find the epoch cache of the epoch being release. If found, try to evict
@@ -326,6 +337,9 @@ void RecordCache::onRelease(lsn_t last_released) {
 }
 
 void RecordCache::updateLastNonAuthoritativeEpoch(logid_t logid) {
+  SCOPE_EXIT {
+    noteModified();
+  };
   // no-op if last_nonauthoritative_epoch_ already has non-default value
   if (last_nonauthoritative_epoch_.load() != EPOCH_MAX.val_) {
     return;
@@ -372,9 +386,13 @@ void RecordCache::updateLastNonAuthoritativeEpoch(logid_t logid) {
 
 void RecordCache::neverStored() {
   last_nonauthoritative_epoch_.store(EPOCH_INVALID.val_);
+  noteModified();
 }
 
 void RecordCache::shutdown() {
+  SCOPE_EXIT {
+    noteModified();
+  };
   // clearing the cache by evicting all epochs, this is done when the cache is
   // no longer used, and nothing got persisted
 
@@ -386,6 +404,9 @@ void RecordCache::shutdown() {
 }
 
 void RecordCache::evictResetEpoch(epoch_t epoch) {
+  SCOPE_EXIT {
+    noteModified();
+  };
   std::shared_ptr<EpochRecordCache> epoch_cache = epoch_caches_.get(epoch.val_);
   if (epoch_cache == nullptr || epoch_cache->emptyWithoutTailPayload()) {
     // epoch cache does not exist or empty (does not store any record payload),
@@ -424,6 +445,9 @@ void RecordCache::evictResetEpochImpl(epoch_t epoch) {
 }
 
 void RecordCache::evictResetAllEpochs() {
+  SCOPE_EXIT {
+    noteModified();
+  };
   std::lock_guard<std::mutex> cache_lock(epoch_cache_lock_);
   accessAllEpochCaches([this](EpochRecordCache& epoch_cache) {
     evictResetEpochImpl(epoch_cache.getEpoch());
@@ -213,6 +213,26 @@ class RecordCache {
                    RecordCacheDependencies* deps,
                    shard_index_t shard);
 
+  /**
+   * Returns a number that changes every time the content of the cache is
+   * modified. Used by RecordCachePersistence to skip caches that haven't
+   * changed since they were last persisted. The version is bumped after the
+   * modification is done, so a copy serialized after reading the version is
+   * at least as recent as that version.
+   */
+  uint64_t getVersion() const {
+    return version_.load(std::memory_order_acquire);
+  }
+
+  // Version and serialized size of the copy of this cache last written to
+  // the local log store. Only accessed by RecordCachePersistence, under the
+  // persistence mutex of the shard.
+  struct PersistedCopy {
+    uint64_t version{0};
+    size_t bytes{0};
+  };
+  PersistedCopy persisted_copy_;
+
   // NOTE Should only be used for deserialization of record caches, left public
   // only for testing. ONLY to be called when head != EPOCH_INVALID. If
   // head == EPOCH_INVALID, the RecordCache should be like an empty one, but to
@@ -266,6 +286,13 @@ class RecordCache {
   // indicate the record cache is shutdown and shouldn't take new writes
   std::atomic<bool> shutdown_{false};
 
+  // see getVersion()
+  std::atomic<uint64_t> version_{1};
+
+  void noteModified() {
+    version_.fetch_add(1, std::memory_order_release);
+  }
+
   // actual implementation for evictResetEpoch(), must be called under
   // mutex_
   void evictResetEpochImpl(epoch_t epoch);
@@ -46,6 +46,15 @@ class EpochRecordCacheDependencies {
     return nullptr;
   }
 
+  /**
+   * Largest segment that EpochRecordCache allocates for storing payloads of
+   * cached records, see RecordCacheSlab. 0 means that cached records keep
+   * the payloads they were stored with.
+   */
+  virtual size_t getPayloadSlabSegmentSize() const {
+    return 0;
+  }
+
   /**
    * Called, with lock held, whenever entries are removed from the cache because
    * they've been released.  Not called when they're evicted due to memory
@@ -145,4 +145,16 @@ bool RecordCacheDisposal::tailOptimized(logid_t logid) const {
   return log->attrs().tailOptimized().value();
 }
 
+StatsHolder* RecordCacheDisposal::getStatsHolder() const {
+  return owner_->getStats();
+}
+
+size_t RecordCacheDisposal::getPayloadSlabSegmentSize() const {
+  auto processor = owner_->getProcessor();
+  // Caches may be repopulated from snapshots before the processor is set.
+  return processor != nullptr
+      ? processor->settings()->record_cache_slab_segment_size
+      : 0;
+}
+
 }} // namespace facebook::logdevice
@@ -46,6 +46,10 @@ class RecordCacheDisposal : public RecordCacheDependencies {
 
   bool tailOptimized(logid_t logid) const override;
 
+  StatsHolder* getStatsHolder() const override;
+
+  size_t getPayloadSlabSegmentSize() const override;
+
  private:
   LogStorageStateMap* const owner_;
 };
@@ -7,6 +7,7 @@
  */
 #include "logdevice/server/RecordCacheMonitorThread.h"
 
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <queue>
@@ -15,8 +16,10 @@
 #include "logdevice/common/ThreadID.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/common/stats/Stats.h"
+#include "logdevice/server/RecordCachePersistence.h"
 #include "logdevice/server/ServerProcessor.h"
 #include "logdevice/server/read_path/LogStorageStateMap.h"
+#include "logdevice/server/storage_tasks/ShardedStorageThreadPool.h"
 
 namespace facebook { namespace logdevice {
 
@@ -43,7 +46,18 @@ void RecordCacheMonitorThread::threadMain() {
           "to %lu bytes.",
           processor_->settings()->record_cache_max_size);
 
+  auto last_checkpoint = std::chrono::steady_clock::now();
+
   while (!shutdown_.signaled()) {
+    const auto checkpoint_interval =
+        processor_->settings()->record_cache_checkpoint_interval;
+    if (checkpoint_interval.count() > 0 &&
+        std::chrono::steady_clock::now() - last_checkpoint >=
+            checkpoint_interval) {
+      checkpointCaches();
+      last_checkpoint = std::chrono::steady_clock::now();
+    }
+
     auto result = recordCacheNeedsEviction();
     if (result.first) {
       RATELIMIT_INFO(
@@ -135,10 +149,11 @@ void RecordCacheMonitorThread::evictCaches(size_t target_bytes) {
 
   auto access_log = [target_bytes, &bytes_in_queue, &min_queue](
                         logid_t logid, const LogStorageState& state) {
-    if (state.record_cache_ == nullptr) {
+    const RecordCache* cache = state.getRecordCache();
+    if (cache == nullptr) {
       return 0;
     }
-    const size_t log_size = state.record_cache_->getPayloadSizeEstimate();
+    const size_t log_size = cache->getPayloadSizeEstimate();
     if (log_size == 0) {
       return 0;
     }
@@ -176,7 +191,8 @@ void RecordCacheMonitorThread::evictCaches(size_t target_bytes) {
   // evict all logs in queue
   while (!min_queue.empty()) {
     const LogEntry& e = min_queue.top();
-    auto& record_cache_ptr = log_map.get(e.log_id, e.shard).record_cache_;
+    RecordCache* record_cache_ptr =
+        log_map.get(e.log_id, e.shard).getRecordCache();
     // RecordCache pointer shouldn't get destroyed before this thread exists
     ld_check(record_cache_ptr != nullptr);
     record_cache_ptr->evictResetAllEpochs();
@@ -199,4 +215,19 @@ void RecordCacheMonitorThread::evictCaches(size_t target_bytes) {
       target_bytes);
 }
 
+void RecordCacheMonitorThread::checkpointCaches() {
+  ShardedStorageThreadPool* sharded_pool =
+      processor_->sharded_storage_thread_pool_;
+  if (sharded_pool == nullptr) {
+    return;
+  }
+  for (shard_index_t shard = 0; shard < sharded_pool->numShards(); ++shard) {
+    if (shutdown_.signaled()) {
+      return;
+    }
+    RecordCachePersistence::checkpointRecordCaches(
+        shard, &sharded_pool->getByIndex(shard));
+  }
+}
+
 }} // namespace facebook::logdevice
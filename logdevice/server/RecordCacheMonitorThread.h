@@ -27,6 +27,9 @@ class ServerProcessor;
  *         epochs currently cached. This could help to leave more logs in the
  *         cache, achieving better availability in terms of logs and less seeks
  *         durng epoch recovery.
+ *
+ *         The thread also periodically checkpoints record caches to the local
+ *         log store if record-cache-checkpoint-interval is set.
  */
 
 class RecordCacheMonitorThread {
@@ -57,6 +60,10 @@ class RecordCacheMonitorThread {
 
   // Perform eviction for all logs, attempting to evict @param target_bytes
   void evictCaches(size_t target_bytes);
+
+  // Write the record caches that changed since the last checkpoint, see
+  // RecordCachePersistence.h
+  void checkpointCaches();
 };
 
 }} // namespace facebook::logdevice
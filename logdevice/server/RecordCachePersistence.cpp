@@ -7,7 +7,12 @@
  */
 #include "logdevice/server/RecordCachePersistence.h"
 
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
 #include "logdevice/common/Worker.h"
+#include "logdevice/common/stats/Stats.h"
 #include "logdevice/server/RecordCache.h"
 #include "logdevice/server/ServerProcessor.h"
 #include "logdevice/server/read_path/LogStorageStateMap.h"
@@ -20,13 +25,49 @@ namespace facebook { namespace logdevice { namespace RecordCachePersistence {
 // Write in batches of 10Mib
 static const size_t SNAPSHOT_BATCH_SIZE_LIMIT = 10 * 1024 * 1024;
 
-void persistRecordCaches(shard_index_t shard_idx,
-                         StorageThreadPool* storage_thread_pool) {
+namespace {
+
+struct Manifest {
+  uint32_t magic;
+  // 1 if the blobs were completely written on shutdown
+  uint8_t clean_shutdown;
+  // If not 0, the blobs hold every record stored on the shard up to this
+  // sequence number of the local log store. Not written by older versions.
+  uint64_t sequence_number;
+} __attribute__((__packed__));
+
+constexpr uint32_t MANIFEST_MAGIC = 0x4d435252; // RRCM
+
+// How long a checkpoint waits for stores in flight to reach the caches before
+// giving up on marking itself consistent.
+constexpr std::chrono::milliseconds PENDING_CACHE_WRITES_TIMEOUT{500};
+
+enum class Mode { CHECKPOINT, SHUTDOWN };
+
+const char* modeName(Mode mode) {
+  return mode == Mode::CHECKPOINT ? "Checkpointed" : "Persisted";
+}
+
+void persist(shard_index_t shard_idx,
+             StorageThreadPool* storage_thread_pool,
+             Mode mode) {
   LocalLogStore& shard = storage_thread_pool->getLocalLogStore();
   LogStorageStateMap& log_storage_state_map =
       storage_thread_pool->getProcessor().getLogStorageStateMap();
   ShardedStorageThreadPool* sharded_store =
       storage_thread_pool->getProcessor().sharded_storage_thread_pool_;
+  StatsHolder* stats = storage_thread_pool->stats();
+
+  auto& persistence_state =
+      log_storage_state_map.getRecordCachePersistenceState(shard_idx);
+  std::lock_guard<std::mutex> guard(persistence_state.mutex);
+  if (mode == Mode::CHECKPOINT) {
+    if (!persistence_state.repopulated || persistence_state.shut_down) {
+      return;
+    }
+  } else {
+    persistence_state.shut_down = true;
+  }
 
   Status accepting = shard.acceptingWrites();
   if (accepting != Status::OK && accepting != Status::LOW_ON_SPC) {
@@ -42,15 +83,36 @@ void persistRecordCaches(shard_index_t shard_idx,
       storage_thread_pool->getProcessor().settings()->record_cache_max_size /
       sharded_store->numShards();
 
+  // Caches in the current batch, with the version and size of their copy in
+  // the batch. persisted_copy_ is updated once the batch is written.
+  struct PendingCopy {
+    RecordCache* cache;
+    RecordCache::PersistedCopy copy;
+  };
+
   // Keep owners of RecordCache blobs in memory so contents aren't freed
   std::vector<std::unique_ptr<uint8_t[]>> record_cache_snapshot_owners;
   std::vector<std::pair<logid_t, Slice>> record_cache_snapshot_batch;
-  size_t logs_in_current_batch = 0;
+  std::vector<PendingCopy> pending_copies;
   size_t total_persisted_logs = 0;
   size_t bytes_in_current_batch = 0;
   size_t total_bytes = 0;
+  // Change of persistence_state.bytes once the current batch is written.
+  ssize_t bytes_delta_in_current_batch = 0;
+  bool manifest_written = false;
+  const Manifest dirty_manifest{MANIFEST_MAGIC, 0, 0};
+  const Manifest clean_manifest{MANIFEST_MAGIC, 1, 0};
 
-  auto commit_batch = [&]() -> int {
+  // The first batch of every run marks the blobs as incomplete, only the last
+  // batch of the shutdown marks them complete.
+  auto commit_batch = [&](bool last) -> int {
+    if (last && mode == Mode::SHUTDOWN) {
+      record_cache_snapshot_batch.emplace_back(
+          MANIFEST_LOG_ID, Slice(&clean_manifest, sizeof(clean_manifest)));
+    } else if (!manifest_written) {
+      record_cache_snapshot_batch.emplace_back(
+          MANIFEST_LOG_ID, Slice(&dirty_manifest, sizeof(dirty_manifest)));
+    }
     int rv = shard.writeLogSnapshotBlobs(
         LocalLogStore::LogSnapshotBlobType::RECORD_CACHE,
         record_cache_snapshot_batch);
@@ -63,67 +125,122 @@ void persistRecordCaches(shard_index_t shard_idx,
                total_persisted_logs,
                total_bytes);
     } else {
+      manifest_written = true;
+      for (const PendingCopy& pending : pending_copies) {
+        pending.cache->persisted_copy_ = pending.copy;
+      }
       total_bytes += bytes_in_current_batch;
-      total_persisted_logs += logs_in_current_batch;
+      total_persisted_logs += pending_copies.size();
+      persistence_state.bytes += bytes_delta_in_current_batch;
     }
 
-    bytes_in_current_batch = logs_in_current_batch = 0;
+    bytes_in_current_batch = bytes_delta_in_current_batch = 0;
     record_cache_snapshot_batch.clear();
     record_cache_snapshot_owners.clear();
+    pending_copies.clear();
     return rv;
   };
 
+  auto add_to_batch = [&](logid_t log_id,
+                          RecordCache* record_cache,
+                          RecordCache::PersistedCopy copy,
+                          std::unique_ptr<uint8_t[]> buffer) {
+    bytes_in_current_batch += copy.bytes;
+    bytes_delta_in_current_batch +=
+        ssize_t(copy.bytes) - ssize_t(record_cache->persisted_copy_.bytes);
+    record_cache_snapshot_batch.emplace_back(
+        log_id, Slice(buffer.get(), copy.bytes));
+    record_cache_snapshot_owners.push_back(std::move(buffer));
+    pending_copies.push_back(PendingCopy{record_cache, copy});
+  };
+
+  // Set once the shutdown hit the byte limit. Caches that can't be written
+  // anymore have their earlier copies replaced by empty blobs, so that they
+  // aren't repopulated with stale contents.
+  bool over_limit = false;
+
   // A callback function called for each log, which will write batches of
   // serialized representations of record caches to disk.
   auto callback = [&](logid_t log_id, const LogStorageState& state) {
-    // Serialize the record cache
-    RecordCache* record_cache = state.record_cache_.get();
+    RecordCache* record_cache = state.getRecordCache();
     if (!record_cache) {
       return 0;
     }
-    ssize_t size = record_cache->sizeInLinearBuffer();
-    if (size == -1) {
+    // Read the version before serializing. If the cache changes while it's
+    // being serialized, the next run writes it again.
+    const uint64_t version = record_cache->getVersion();
+    if (version == record_cache->persisted_copy_.version) {
+      return 0;
+    }
+
+    auto drop = [&] {
+      if (mode == Mode::SHUTDOWN &&
+          record_cache->persisted_copy_.version != 0) {
+        add_to_batch(log_id, record_cache, RecordCache::PersistedCopy{}, {});
+      }
+    };
+
+    ssize_t size = over_limit ? -1 : record_cache->sizeInLinearBuffer();
+    if (!over_limit && size == -1) {
       ld_error("Failed to calculate size of RecordCache in linear buffer on "
                "shard %d",
                shard_idx);
-      return -1;
+    }
+    // size of the blobs on the shard once this copy is written
+    const ssize_t bytes_after = ssize_t(persistence_state.bytes) +
+        bytes_delta_in_current_batch -
+        ssize_t(record_cache->persisted_copy_.bytes) + size;
+    if (size != -1 && bytes_limit_per_shard > 0 &&
+        bytes_after >= ssize_t(bytes_limit_per_shard)) {
+      // the snapshot is about to exceed the byte limit
+      RATELIMIT_ERROR(std::chrono::minutes(1),
+                      1,
+                      "Snapshot of record cache on shard %d reached the byte "
+                      "limit of %lu bytes per-shard. Already persisted %lu, "
+                      "current batch %lu. Stop persisting record caches on "
+                      "this shard.",
+                      shard_idx,
+                      bytes_limit_per_shard,
+                      persistence_state.bytes,
+                      bytes_in_current_batch);
+      if (mode == Mode::CHECKPOINT) {
+        return -1;
+      }
+      over_limit = true;
+      size = -1;
     }
 
-    if (bytes_limit_per_shard > 0 &&
-        total_bytes + bytes_in_current_batch + size >= bytes_limit_per_shard) {
-      // the snapshot is about to exceed the byte limit, commit the current
-      // batch and abort the operation
-      commit_batch();
-      ld_error("Snapshot of record cache on shard %d reached the byte limit of "
-               "%lu bytes per-shard. Already persisted %lu, current batch %lu. "
-               "Stop persisting record caches on this shard.",
-               shard_idx,
-               bytes_limit_per_shard,
-               total_bytes,
-               bytes_in_current_batch);
-      return -1;
+    std::unique_ptr<uint8_t[]> buffer;
+    ssize_t linear_size = -1;
+    if (size != -1) {
+      buffer = std::make_unique<uint8_t[]>(size);
+      linear_size = record_cache->toLinearBuffer(
+          reinterpret_cast<char*>(buffer.get()), size);
+      if (linear_size == -1) {
+        // While checkpointing, the cache may have grown since its size was
+        // computed. It will be written by a later run.
+        if (mode == Mode::SHUTDOWN) {
+          ld_error("Failed to linearize RecordCache on shard %d", shard_idx);
+        }
+      } else {
+        ld_check(linear_size <= size);
+        ld_check(mode == Mode::CHECKPOINT || size == linear_size);
+      }
     }
 
-    auto buffer = std::make_unique<uint8_t[]>(size);
-    ssize_t linear_size = record_cache->toLinearBuffer(
-        reinterpret_cast<char*>(buffer.get()), size);
     if (linear_size == -1) {
-      ld_error("Failed to linearize RecordCache on shard %d", shard_idx);
-      return -1;
+      drop();
+    } else {
+      add_to_batch(log_id,
+                   record_cache,
+                   RecordCache::PersistedCopy{version, size_t(linear_size)},
+                   std::move(buffer));
     }
-    ld_check(size == linear_size);
-
-    // Add serialized representation to batch. If the batch's size now exceeds
-    // the batch limit, write it and start a new one.
-    // TODO 12730327: make code cleaner without sharing states between two
-    // lambdas
-    bytes_in_current_batch += linear_size;
-    logs_in_current_batch++;
-    record_cache_snapshot_batch.emplace_back(
-        log_id, Slice(buffer.get(), linear_size));
-    record_cache_snapshot_owners.push_back(std::move(buffer));
+
+    // If the batch's size now exceeds the batch limit, write it and start a
+    // new one.
     if (bytes_in_current_batch >= SNAPSHOT_BATCH_SIZE_LIMIT) {
-      return commit_batch();
+      return commit_batch(false);
     }
     return 0;
   };
@@ -131,15 +248,96 @@ void persistRecordCaches(shard_index_t shard_idx,
   // Run above lambda for each log
   int rv = log_storage_state_map.forEachLogOnShard(shard_idx, callback);
 
-  // Write the last batch, unless we've previously encountered an error
-  if (rv == 0) {
-    commit_batch();
+  // Write the last batch, unless we've previously encountered an error. The
+  // shutdown always writes one to mark the blobs complete.
+  if (rv == 0 || mode == Mode::CHECKPOINT) {
+    if (!record_cache_snapshot_batch.empty() || mode == Mode::SHUTDOWN) {
+      rv = commit_batch(rv == 0);
+    }
   }
 
-  ld_info("Persisted record caches for %ju logs on shard %d, totaling %ju "
-          "bytes.",
-          total_persisted_logs,
-          shard_idx,
-          total_bytes);
+  // A checkpoint that wrote every cache marks the blobs consistent with the
+  // current sequence number of the local log store, once the stores that
+  // were numbered before it have reached the caches. Caches that changed
+  // since they were written may miss some of those.
+  auto mark_consistent = [&]() -> bool {
+    const uint64_t sequence_number = shard.getLatestSequenceNumber();
+    if (sequence_number == 0 ||
+        !storage_thread_pool->getPendingCacheWrites().waitForEarlierWrites(
+            PENDING_CACHE_WRITES_TIMEOUT)) {
+      return false;
+    }
+    int changed = log_storage_state_map.forEachLogOnShard(
+        shard_idx, [](logid_t, const LogStorageState& state) {
+          RecordCache* record_cache = state.getRecordCache();
+          if (record_cache &&
+              record_cache->getVersion() !=
+                  record_cache->persisted_copy_.version) {
+            return -1;
+          }
+          return 0;
+        });
+    if (changed != 0) {
+      return false;
+    }
+    const Manifest manifest{MANIFEST_MAGIC, 0, sequence_number};
+    return shard.writeLogSnapshotBlobs(
+               LocalLogStore::LogSnapshotBlobType::RECORD_CACHE,
+               {{MANIFEST_LOG_ID, Slice(&manifest, sizeof(manifest))}}) == 0;
+  };
+
+  if (mode == Mode::CHECKPOINT) {
+    const bool recover_checkpoints = storage_thread_pool->getProcessor()
+                                         .settings()
+                                         ->record_cache_recover_checkpoints;
+    if (rv == 0 && recover_checkpoints && mark_consistent()) {
+      STAT_INCR(stats, record_cache_checkpoints_consistent);
+    }
+    STAT_INCR(stats, record_cache_checkpoints);
+    STAT_ADD(stats, record_cache_checkpoint_logs_written, total_persisted_logs);
+    STAT_ADD(stats, record_cache_checkpoint_bytes_written, total_bytes);
+  }
+
+  ld_log(mode == Mode::SHUTDOWN || total_persisted_logs > 0
+             ? dbg::Level::INFO
+             : dbg::Level::DEBUG,
+         "%s record caches for %ju logs on shard %d, totaling %ju bytes. "
+         "Record caches persisted on the shard total %ju bytes.",
+         modeName(mode),
+         total_persisted_logs,
+         shard_idx,
+         total_bytes,
+         persistence_state.bytes);
+}
+
+} // namespace
+
+void persistRecordCaches(shard_index_t shard_idx,
+                         StorageThreadPool* storage_thread_pool) {
+  persist(shard_idx, storage_thread_pool, Mode::SHUTDOWN);
+}
+
+void checkpointRecordCaches(shard_index_t shard_idx,
+                            StorageThreadPool* storage_thread_pool) {
+  persist(shard_idx, storage_thread_pool, Mode::CHECKPOINT);
+}
+
+int readManifest(Slice blob,
+                 bool* clean_shutdown,
+                 uint64_t* sequence_number) {
+  ld_check(clean_shutdown);
+  ld_check(sequence_number);
+  Manifest manifest{};
+  if (blob.size != sizeof(manifest) &&
+      blob.size != offsetof(Manifest, sequence_number)) {
+    return -1;
+  }
+  memcpy(&manifest, blob.data, blob.size);
+  if (manifest.magic != MANIFEST_MAGIC) {
+    return -1;
+  }
+  *clean_shutdown = manifest.clean_shutdown != 0;
+  *sequence_number = manifest.sequence_number;
+  return 0;
 }
 }}} // namespace facebook::logdevice::RecordCachePersistence
@@ -16,14 +16,60 @@ namespace facebook { namespace logdevice {
 class StorageThreadPool;
 
 /**
- * @file  A function for persisting record caches for all logs stored
- *        on a particular shard. Called at the very end of shutting down storage
- *        threads, from the last thread to be shut down.
+ * @file  Functions for persisting record caches for all logs stored on a
+ *        particular shard, as log snapshot blobs of the local log store.
+ *
+ *        Each run only writes the caches that changed since they were last
+ *        written by this server, so caches of idle logs are written at most
+ *        once. Besides the final run on shutdown, the record cache monitor
+ *        thread may periodically checkpoint the caches, so that the shutdown
+ *        only has to write what changed since the last checkpoint.
+ *
+ *        A manifest blob, stored under LOGID_INVALID, tells whether the
+ *        blobs are a complete snapshot taken at shutdown. Checkpoints left
+ *        by a server that crashed miss the records stored after them and
+ *        must not be used as is to repopulate caches, which would then claim
+ *        to have all records of their epochs.
+ *
+ *        A checkpoint after which no cache differs from its blob waits for
+ *        the stores in flight to reach the caches (see PendingCacheWrites),
+ *        then records the local log store sequence number in the manifest:
+ *        the blobs hold every record stored up to it. After a crash, the
+ *        logs written since then are found in the write-ahead log and only
+ *        their caches are discarded.
  */
 
 namespace RecordCachePersistence {
 
+// Log id of the manifest blob.
+constexpr logid_t MANIFEST_LOG_ID = LOGID_INVALID;
+
+/**
+ * Writes the record caches of the shard that changed since the last run.
+ * Called at the very end of shutting down storage threads, from the last
+ * thread to be shut down. Marks the blobs on the shard as a complete snapshot
+ * if all caches were written.
+ */
 void persistRecordCaches(shard_index_t, StorageThreadPool*);
-}
+
+/**
+ * Writes the record caches of the shard that changed since the last run,
+ * while the server is running. Does nothing before the record caches of the
+ * shard were repopulated or after persistRecordCaches() was called.
+ */
+void checkpointRecordCaches(shard_index_t, StorageThreadPool*);
+
+/**
+ * Parses the manifest blob.
+ *
+ * @param clean_shutdown   set to true if the blobs were completely written on
+ *                         shutdown
+ * @param sequence_number  set to the sequence number of the local log store
+ *                         up to which the blobs hold every stored record, 0
+ *                         if unknown
+ * @return  0 on success, -1 if the blob is not a valid manifest
+ */
+int readManifest(Slice blob, bool* clean_shutdown, uint64_t* sequence_number);
+} // namespace RecordCachePersistence
 
 }} // namespace facebook::logdevice
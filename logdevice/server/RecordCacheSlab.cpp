@@ -0,0 +1,56 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/RecordCacheSlab.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "logdevice/common/debug.h"
+#include "logdevice/common/stats/Stats.h"
+
+namespace facebook { namespace logdevice {
+
+PayloadHolder RecordCacheSlab::store(const PayloadHolder& payload) {
+  if (!stores(payload.size())) {
+    return payload;
+  }
+  Payload p = payload.getPayload();
+  return store(p.data(), p.size());
+}
+
+PayloadHolder RecordCacheSlab::store(const void* data, size_t size) {
+  if (!stores(size)) {
+    return PayloadHolder::copyBuffer(data, size);
+  }
+
+  if (segment_ == nullptr || segment_->tailroom() < size) {
+    // Start a new segment, twice as large as the last one. The old segment
+    // stays alive for as long as payloads reference it.
+    size_t segment_size = std::min(
+        segment_ == nullptr ? MIN_SEGMENT_SIZE : segment_->capacity() * 2,
+        max_segment_size_);
+    segment_size = std::max(segment_size, size);
+    segment_ = folly::IOBuf::create(segment_size);
+    bytes_allocated_ += segment_->capacity();
+    STAT_INCR(stats_, record_cache_slab_segments_allocated);
+    STAT_ADD(stats_, record_cache_slab_bytes_allocated, segment_->capacity());
+  }
+
+  // Payloads only ever reference the part of the segment below its tail, so
+  // the tailroom can be written even though the buffer is shared.
+  const size_t offset = segment_->length();
+  memcpy(segment_->writableTail(), data, size);
+  segment_->append(size);
+
+  folly::IOBuf slice = segment_->cloneOneAsValue();
+  slice.trimStart(offset);
+  ld_check(slice.length() == size);
+  return PayloadHolder(std::move(slice));
+}
+
+}} // namespace facebook::logdevice
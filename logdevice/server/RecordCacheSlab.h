@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include <folly/io/IOBuf.h>
+
+#include "logdevice/common/PayloadHolder.h"
+
+namespace facebook { namespace logdevice {
+
+class StatsHolder;
+
+/**
+ * @file RecordCacheSlab packs the payloads of cached records into large
+ *       segments, so that the record cache pays one allocation and one
+ *       refcount per segment instead of one per record, and doesn't pin the
+ *       (possibly much larger) network buffers that records arrived in.
+ *
+ *       Each payload handed out by store() is a slice of a segment that
+ *       shares the segment's refcount. A segment is freed once all records
+ *       referencing it are gone. Records of an epoch are evicted roughly in
+ *       ESN order, so segments of one EpochRecordCache are freed roughly in
+ *       the order they were filled.
+ *
+ *       Segments start small and double in size up to the configured maximum,
+ *       so that caches of logs that see few records stay small.
+ *
+ *       Not thread safe.
+ */
+
+class RecordCacheSlab {
+ public:
+  // Size of the first segment.
+  static constexpr size_t MIN_SEGMENT_SIZE = 1024;
+
+  /**
+   * @param max_segment_size  size of the largest segment to allocate. Payloads
+   *                          larger than a quarter of it are not copied.
+   *                          0 disables the slab.
+   */
+  explicit RecordCacheSlab(size_t max_segment_size,
+                           StatsHolder* stats = nullptr)
+      : max_segment_size_(max_segment_size), stats_(stats) {}
+
+  /**
+   * @return true if store() copies payloads of the given size into a segment.
+   */
+  bool stores(size_t payload_size) const {
+    return payload_size > 0 && payload_size <= max_segment_size_ / 4;
+  }
+
+  /**
+   * @return a PayloadHolder for a copy of the given payload in the current
+   *         segment, or `payload` itself if !stores(payload.size()).
+   */
+  PayloadHolder store(const PayloadHolder& payload);
+
+  /**
+   * Same as store(), but copies from a raw buffer.
+   */
+  PayloadHolder store(const void* data, size_t size);
+
+  // Total size of segments allocated by this slab, including freed ones.
+  size_t bytesAllocated() const {
+    return bytes_allocated_;
+  }
+
+ private:
+  const size_t max_segment_size_;
+  StatsHolder* const stats_;
+
+  // Segment that payloads are currently appended to. Earlier segments are
+  // only referenced by the payloads they hold.
+  std::unique_ptr<folly::IOBuf> segment_;
+  size_t bytes_allocated_{0};
+};
+
+}} // namespace facebook::logdevice
@@ -7,6 +7,7 @@
  */
 #include "logdevice/server/ReleaseRequest.h"
 
+#include "logdevice/common/OwnerThreadFreeList.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/server/ServerProcessor.h"
 #include "logdevice/server/ServerWorker.h"
@@ -15,13 +16,30 @@
 
 namespace facebook { namespace logdevice {
 
+void* ReleaseRequest::operator new(size_t size) {
+  if (size == sizeof(ReleaseRequest)) {
+    return OwnerThreadFreeList<ReleaseRequest>::allocate();
+  }
+  return ::operator new(size);
+}
+
+void ReleaseRequest::operator delete(void* ptr, size_t size) {
+  if (size == sizeof(ReleaseRequest)) {
+    OwnerThreadFreeList<ReleaseRequest>::deallocate(ptr);
+    return;
+  }
+  ::operator delete(ptr);
+}
+
 Request::Execution ReleaseRequest::execute() {
-  ld_spew("ReleaseRequest(%s) running on worker %s for shard %u",
-          rid_.toString().c_str(),
-          Worker::onThisThread()->getName().c_str(),
-          shard_);
-  ServerWorker::onThisThread()->serverReadStreams().onRelease(
-      rid_, shard_, force_);
+  auto& read_streams = ServerWorker::onThisThread()->serverReadStreams();
+  for (const Release& release : releases_) {
+    ld_spew("ReleaseRequest(%s) running on worker %s for shard %u",
+            release.rid.toString().c_str(),
+            Worker::onThisThread()->getName().c_str(),
+            release.shard);
+    read_streams.onRelease(release.rid, release.shard, release.force);
+  }
   return Execution::COMPLETE;
 }
 
@@ -36,4 +54,56 @@ void ReleaseRequest::retry(ServerProcessor* processor,
       .retryRelease(idx, force);
 }
 
+namespace {
+thread_local ReleaseRequest::Batch* current_release_batch = nullptr;
+} // namespace
+
+ReleaseRequest::Batch::Batch(ServerProcessor* processor)
+    : processor_(processor), outer_(current_release_batch) {
+  current_release_batch = this;
+}
+
+ReleaseRequest::Batch* ReleaseRequest::Batch::current() {
+  return current_release_batch;
+}
+
+void ReleaseRequest::Batch::add(worker_id_t idx, const Release& release) {
+  ld_check(idx.val_ >= 0);
+  if (per_worker_.size() <= static_cast<size_t>(idx.val_)) {
+    per_worker_.resize(idx.val_ + 1);
+  }
+  per_worker_[idx.val_].push_back(release);
+}
+
+ReleaseRequest::Batch::~Batch() {
+  ld_check(current_release_batch == this);
+  current_release_batch = outer_;
+
+  for (size_t i = 0; i < per_worker_.size(); ++i) {
+    const std::vector<Release>& releases = per_worker_[i];
+    if (releases.empty()) {
+      continue;
+    }
+    const worker_id_t idx(static_cast<int>(i));
+    std::unique_ptr<Request> req =
+        std::make_unique<ReleaseRequest>(idx, releases);
+    if (processor_->postRequest(req) != 0) {
+      RATELIMIT_ERROR(std::chrono::seconds(10),
+                      5,
+                      "Could not propagate %zu RELEASEs to worker #%d.  "
+                      "postRequest() failed with error %s",
+                      releases.size(),
+                      idx.val_,
+                      error_description(err));
+      for (const Release& release : releases) {
+        retry(processor_,
+              release.rid.logid,
+              release.shard,
+              idx,
+              release.force);
+      }
+    }
+  }
+}
+
 }} // namespace facebook::logdevice
@@ -7,6 +7,10 @@
  */
 #pragma once
 
+#include <vector>
+
+#include <folly/small_vector.h>
+
 #include "logdevice/common/RecordID.h"
 #include "logdevice/common/Request.h"
 #include "logdevice/common/RequestType.h"
@@ -26,10 +30,20 @@ enum class ReleaseType : uint8_t;
  *
  * The worker receiving this request reads the new record from the local log
  * store and sends it to clients reading from the log.
+ *
+ * While handling a MULTI_RELEASE message, the releases of all its logs are
+ * collected in a ReleaseRequest::Batch, and each worker gets one
+ * ReleaseRequest carrying all the releases it is subscribed to.
  */
 
 class ReleaseRequest : public Request {
  public:
+  struct Release {
+    RecordID rid;
+    shard_index_t shard;
+    bool force;
+  };
+
   /**
    * @param target        worker thread that should process this request
    * @param rid           record that was released
@@ -44,9 +58,15 @@ class ReleaseRequest : public Request {
                           bool force)
       : Request(RequestType::RELEASE),
         target_(target),
-        rid_(rid),
-        shard_(shard),
-        force_(force) {}
+        releases_({Release{rid, shard, force}}) {}
+
+  /**
+   * Same as above for several releases at once.
+   */
+  ReleaseRequest(worker_id_t target, const std::vector<Release>& releases)
+      : Request(RequestType::RELEASE),
+        target_(target),
+        releases_(releases.begin(), releases.end()) {}
 
   int getThreadAffinity(int /*nthreads*/) override {
     // ReleaseRequest gets targeted at a specific worker.  Multiple instances
@@ -72,11 +92,16 @@ class ReleaseRequest : public Request {
                                       shard_index_t shard,
                                       Func&& filter,
                                       bool force = false) {
+    Batch* batch = Batch::current();
     processor->applyToWorkerIdxs(
         [&](worker_id_t idx, WorkerType /*unused*/) {
           if (!filter(idx)) {
             return;
           }
+          if (batch != nullptr) {
+            batch->add(idx, Release{rid, shard, force});
+            return;
+          }
 
           std::unique_ptr<Request> req =
               std::make_unique<ReleaseRequest>(idx, rid, shard, force);
@@ -99,11 +124,43 @@ class ReleaseRequest : public Request {
   static void
   retry(ServerProcessor*, logid_t, shard_index_t, worker_id_t, bool force);
 
+  /**
+   * While a Batch exists on a worker thread, broadcastReleaseRequest() on
+   * that thread collects releases instead of posting requests. The
+   * destructor posts one ReleaseRequest per worker with everything collected
+   * for it.
+   */
+  class Batch {
+   public:
+    explicit Batch(ServerProcessor* processor);
+    ~Batch();
+
+    Batch(const Batch&) = delete;
+    Batch& operator=(const Batch&) = delete;
+
+    // The innermost Batch on this thread, or nullptr.
+    static Batch* current();
+
+    void add(worker_id_t idx, const Release& release);
+
+   private:
+    ServerProcessor* const processor_;
+    // Releases to post, indexed by worker index.
+    std::vector<std::vector<Release>> per_worker_;
+    Batch* const outer_;
+  };
+
+  /**
+   * One ReleaseRequest per subscribed worker is posted for every RELEASE;
+   * their memory goes back to the posting worker (see OwnerThreadFreeList)
+   * rather than through a cross-thread free.
+   */
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size);
+
  private:
   worker_id_t target_;
-  RecordID rid_;
-  shard_index_t shard_;
-  bool force_;
+  folly::small_vector<Release, 1> releases_;
 };
 
 }} // namespace facebook::logdevice
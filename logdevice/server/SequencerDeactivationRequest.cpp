@@ -6,14 +6,13 @@
  * LICENSE file in the root directory of this source tree.
  */
 
-#include "logdevice/server/admincommands/SequencerDeactivationRequest.h"
+#include "logdevice/server/SequencerDeactivationRequest.h"
 
 #include "logdevice/common/AllSequencers.h"
 #include "logdevice/common/Processor.h"
 #include "logdevice/common/Sequencer.h"
 #include "logdevice/common/commandline_util_chrono.h"
 #include "logdevice/common/settings/SettingsUpdater.h"
-#include "logdevice/server/Server.h"
 #include "logdevice/server/ServerWorker.h"
 
 namespace facebook { namespace logdevice {
@@ -38,8 +37,8 @@ void SequencerDeactivationRequest::onTimeout() {
     setupTimer();
   } else {
     destroy();
-    ld_info("All active sequencers specified by the sequencer_stop command "
-            "have been disabled");
+    ld_info("All active sequencers specified in the request have been "
+            "disabled");
   }
 }
 
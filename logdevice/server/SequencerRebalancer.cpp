@@ -0,0 +1,221 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/SequencerRebalancer.h"
+
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
+
+#include <folly/ScopeGuard.h>
+
+#include "logdevice/common/AllSequencers.h"
+#include "logdevice/common/ClusterState.h"
+#include "logdevice/common/HashBasedSequencerLocator.h"
+#include "logdevice/common/Processor.h"
+#include "logdevice/common/Sequencer.h"
+#include "logdevice/common/Worker.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/server/LogGroupThroughput.h"
+#include "logdevice/server/SequencerDeactivationRequest.h"
+
+namespace facebook { namespace logdevice {
+
+void SequencerRebalancer::executionBody() {
+  setupTimer();
+}
+
+WorkerType SequencerRebalancer::getWorkerTypeAffinity() {
+  return WorkerType::BACKGROUND;
+}
+
+void SequencerRebalancer::setupTimer() {
+  timer_.assign([this] { onTimeout(); });
+  timer_.activate(Worker::settings().sequencer_rebalancing_interval);
+}
+
+void SequencerRebalancer::onTimeout() {
+  SCOPE_EXIT {
+    setupTimer();
+  };
+
+  const Settings& settings = Worker::settings();
+  const size_t budget =
+      migrationBudget(settings.sequencer_rebalancing_max_migrations_per_minute);
+  if (budget == 0) {
+    return;
+  }
+  std::vector<logid_t> logs = pickLogsToMove(
+      getThroughput(),
+      settings.sequencer_rebalancing_throughput_threshold,
+      budget);
+
+  Processor* processor = Worker::onThisThread()->processor_;
+  std::queue<logid_t> moved;
+  for (logid_t log_id : logs) {
+    std::shared_ptr<Sequencer> sequencer =
+        processor->allSequencers().findSequencer(log_id);
+    if (!sequencer) {
+      continue;
+    }
+    const NodeID target = pickTarget(log_id);
+    if (!target.isNodeID()) {
+      continue;
+    }
+    ld_info("Moving sequencer for log %lu to %s",
+            log_id.val_,
+            target.toString().c_str());
+    sequencer->setRebalancedTo(
+        target, settings.sequencer_rebalancing_hold_time);
+    migrations_.push_back(std::chrono::steady_clock::now());
+    moved.push(log_id);
+  }
+
+  if (moved.empty()) {
+    return;
+  }
+  const int count = moved.size();
+  WORKER_STAT_ADD(sequencer_rebalancing_migrations, count);
+  std::unique_ptr<Request> req =
+      std::make_unique<SequencerDeactivationRequest>(std::move(moved), count);
+  if (processor->postRequest(req) != 0) {
+    // Appends are redirected anyway. The sequencers will be preempted once
+    // the target nodes activate theirs.
+    RATELIMIT_WARNING(std::chrono::seconds(10),
+                      1,
+                      "Failed to post SequencerDeactivationRequest for %d "
+                      "moved logs: %s",
+                      count,
+                      error_description(err));
+  }
+}
+
+size_t SequencerRebalancer::migrationBudget(size_t max_per_minute) {
+  const auto now = std::chrono::steady_clock::now();
+  while (!migrations_.empty() &&
+         now - migrations_.front() >= std::chrono::minutes(1)) {
+    migrations_.pop_front();
+  }
+  return max_per_minute > migrations_.size()
+      ? max_per_minute - migrations_.size()
+      : 0;
+}
+
+std::vector<SequencerRebalancer::LogThroughput>
+SequencerRebalancer::getThroughput() const {
+  Worker* worker = Worker::onThisThread();
+  StatsHolder* stats = worker->processor_->stats_;
+  if (!stats) {
+    return {};
+  }
+  auto config = worker->getConfiguration();
+
+  // Logs with an active sequencer on this node, by log group.
+  std::unordered_map<std::string, std::vector<logid_t>> groups;
+  for (const auto& seq : worker->processor_->allSequencers().accessAll()) {
+    if (seq.getState() != Sequencer::State::ACTIVE) {
+      continue;
+    }
+    auto path = config->getLogGroupPath(seq.getLogID());
+    if (path.hasValue()) {
+      groups[path.value()].push_back(seq.getLogID());
+    }
+  }
+  if (groups.empty()) {
+    return {};
+  }
+
+  // Append throughput that this node's sequencers took for each log group,
+  // split evenly between the group's logs.
+  const std::vector<Duration> intervals{
+      std::chrono::duration_cast<Duration>(std::chrono::minutes(1))};
+  AggregateMap rates =
+      doAggregate(stats,
+                  "appends_out",
+                  intervals,
+                  worker->processor_->config_->getLogsConfig());
+  std::vector<LogThroughput> res;
+  for (const auto& kv : groups) {
+    auto it = rates.find(kv.first);
+    if (it == rates.end() || it->second.empty()) {
+      continue;
+    }
+    const double per_log = it->second[0] / kv.second.size();
+    for (logid_t log_id : kv.second) {
+      res.push_back(LogThroughput{log_id, per_log});
+    }
+  }
+  return res;
+}
+
+NodeID SequencerRebalancer::pickTarget(logid_t log_id) const {
+  Worker* worker = Worker::onThisThread();
+  const Settings& settings = Worker::settings();
+  auto nodes_configuration = worker->getNodesConfiguration();
+  ClusterState* cs = Worker::getClusterState();
+
+  // With this node's weight set to zero, consistent hashing maps the log to
+  // the node it'd fail over to, so moved logs spread across the other nodes
+  // in proportion to their weights.
+  auto sequencers = std::make_shared<configuration::SequencersConfig>(
+      nodes_configuration->getSequencersConfig());
+  const node_index_t my_index = worker->processor_->getMyNodeID().index();
+  for (size_t i = 0; i < sequencers->nodes.size(); ++i) {
+    if (sequencers->nodes[i].index() == my_index) {
+      sequencers->weights[i] = 0;
+    }
+  }
+
+  auto log_group = worker->getConfiguration()->getLogGroupByIDShared(log_id);
+  NodeID target;
+  int rv = HashBasedSequencerLocator::locateSequencer(
+      log_id,
+      nodes_configuration.get(),
+      settings.use_sequencer_affinity && log_group ? &log_group->attrs()
+                                                   : nullptr,
+      cs,
+      settings.enable_health_based_sequencer_placement,
+      &target,
+      std::move(sequencers));
+  if (rv != 0) {
+    return NodeID();
+  }
+  if (cs && cs->isNodeOverloaded(target.index())) {
+    return NodeID();
+  }
+  return target;
+}
+
+std::vector<logid_t>
+SequencerRebalancer::pickLogsToMove(std::vector<LogThroughput> logs,
+                                    double threshold,
+                                    size_t budget) {
+  double total = 0;
+  for (const LogThroughput& log : logs) {
+    total += log.bytes_per_sec;
+  }
+  std::sort(logs.begin(),
+            logs.end(),
+            [](const LogThroughput& a, const LogThroughput& b) {
+              return a.bytes_per_sec > b.bytes_per_sec;
+            });
+
+  std::vector<logid_t> res;
+  for (const LogThroughput& log : logs) {
+    if (total <= threshold || res.size() >= budget) {
+      break;
+    }
+    if (log.bytes_per_sec > threshold) {
+      continue;
+    }
+    res.push_back(log.log_id);
+    total -= log.bytes_per_sec;
+  }
+  return res;
+}
+
+}} // namespace facebook::logdevice
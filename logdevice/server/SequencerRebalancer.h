@@ -0,0 +1,91 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <vector>
+
+#include "logdevice/common/FireAndForgetRequest.h"
+#include "logdevice/common/NodeID.h"
+#include "logdevice/common/Timer.h"
+#include "logdevice/include/types.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file SequencerRebalancer moves hot logs off a sequencer node whose
+ *       sequencers take more appends than it can handle.
+ *
+ *       Every --sequencer-rebalancing-interval it measures the append
+ *       throughput of the log groups this node sequences (see
+ *       LogGroupThroughput.h) over the last minute. If the total exceeds
+ *       --sequencer-rebalancing-throughput-threshold, the hottest logs are
+ *       moved to the node each of them would map to if this node didn't run
+ *       sequencers, skipping targets that report themselves overloaded.
+ *
+ *       Moving a log marks its sequencer with the target (see
+ *       Sequencer::setRebalancedTo()) and deactivates it with a
+ *       SequencerDeactivationRequest. Appends that reach this node are then
+ *       redirected to the target for --sequencer-rebalancing-hold-time, and the
+ *       target activates a sequencer for the log once clients break the
+ *       redirect cycle in its favor. At most
+ *       --sequencer-rebalancing-max-migrations-per-minute logs are moved per
+ *       minute.
+ *
+ *       Runs on a background worker until the worker shuts down.
+ */
+class SequencerRebalancer : public FireAndForgetRequest {
+ public:
+  SequencerRebalancer()
+      : FireAndForgetRequest(RequestType::SEQUENCER_REBALANCER) {}
+
+  // see FireAndForgetRequest.h
+  void executionBody() override;
+
+  struct LogThroughput {
+    logid_t log_id;
+    double bytes_per_sec;
+  };
+
+  /**
+   * Picks logs to move off a node whose sequencers have the given throughput,
+   * hottest first, until the throughput left is at most `threshold` or
+   * `budget` logs are picked. Logs hotter than `threshold` on their own are
+   * never picked: they'd overload whichever node they were moved to.
+   */
+  static std::vector<logid_t> pickLogsToMove(std::vector<LogThroughput> logs,
+                                             double threshold,
+                                             size_t budget);
+
+ protected:
+  WorkerType getWorkerTypeAffinity() override;
+
+ private:
+  void onTimeout();
+
+  void setupTimer();
+
+  // Append throughput of the logs with an active sequencer on this node.
+  std::vector<LogThroughput> getThroughput() const;
+
+  // Node that `log_id' would map to if this node didn't run sequencers, or
+  // an invalid NodeID if there's none or it's overloaded.
+  NodeID pickTarget(logid_t log_id) const;
+
+  // Number of logs that can be moved now without exceeding the per-minute
+  // limit.
+  size_t migrationBudget(size_t max_per_minute);
+
+  Timer timer_;
+
+  // Times at which logs were moved in the last minute.
+  std::deque<std::chrono::steady_clock::time_point> migrations_;
+};
+
+}} // namespace facebook::logdevice
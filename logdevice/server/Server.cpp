@@ -54,6 +54,7 @@
 #include "logdevice/server/MyNodeIDFinder.h"
 #include "logdevice/server/NodeRegistrationHandler.h"
 #include "logdevice/server/RsmServerSnapshotStoreFactory.h"
+#include "logdevice/server/SequencerRebalancer.h"
 #include "logdevice/server/ServerProcessor.h"
 #include "logdevice/server/UnreleasedRecordDetector.h"
 #include "logdevice/server/ZookeeperEpochStore.h"
@@ -384,7 +385,15 @@ ServerParameters::ServerParameters(
     std::shared_ptr<PluginRegistry> plugin_registry,
     std::function<void()> stop_handler)
     : plugin_registry_(std::move(plugin_registry)),
-      server_stats_(StatsParams().setIsServer(true)),
+      // server_settings is not moved from yet, server_stats_ is declared
+      // before server_settings_.
+      server_stats_(
+          StatsParams()
+              .setIsServer(true)
+              .setPerLogStatsTopK(server_settings->per_log_stats_top_k)
+              .setPerLogStatsSamplePeriod(
+                  server_settings->per_log_stats_sample_period)
+              .setPerClientStatsTopK(server_settings->per_client_stats_top_k)),
       settings_updater_(std::move(settings_updater)),
       server_settings_(std::move(server_settings)),
       rebuilding_settings_(std::move(rebuilding_settings)),
@@ -639,6 +648,7 @@ Server::Server(ServerParameters* params)
       conn_budget_backlog_unlimited_(std::numeric_limits<uint64_t>::max()) {
   ld_check(params_);
   start_time_ = std::chrono::system_clock::now();
+  SteadyTimestamp start_ts(SteadyTimestamp::now());
 
   if (!(initListeners() && initStore() && initLogStorageStateMap() &&
         initStorageThreadPool() && initProcessor() && initFailureDetector() &&
@@ -650,6 +660,10 @@ Server::Server(ServerParameters* params)
         initRocksDBMetricsExport())) {
     _exit(EXIT_FAILURE);
   }
+
+  const auto startup_ms = msec_since(start_ts.timePoint());
+  STAT_SET(params_->getStats(), startup_total_ms, startup_ms);
+  ld_info("Server initialization took %ldms", startup_ms);
 }
 
 template <typename T, typename... Args>
@@ -883,6 +897,13 @@ Server::initThriftServer(std::string name, int port, std::string unix_socket) {
 }
 
 bool Server::initStore() {
+  SteadyTimestamp start_ts(SteadyTimestamp::now());
+  SCOPE_EXIT {
+    STAT_SET(params_->getStats(),
+             startup_open_store_ms,
+             msec_since(start_ts.timePoint()));
+  };
+
   const std::string local_log_store_path =
       params_->getLocalLogStoreSettings()->local_log_store_path;
   if (params_->isStorageNode()) {
@@ -1042,6 +1063,13 @@ bool Server::initLogStorageStateMap() {
     return true;
   }
 
+  SteadyTimestamp start_ts(SteadyTimestamp::now());
+  SCOPE_EXIT {
+    STAT_SET(params_->getStats(),
+             startup_populate_log_state_ms,
+             msec_since(start_ts.timePoint()));
+  };
+
   shard_size_t nshards = sharded_store_->numShards();
   log_storage_state_map_ = std::make_unique<LogStorageStateMap>(
       nshards,
@@ -1100,64 +1128,69 @@ bool Server::initLogStorageStateMap() {
         };
       };
 
+  // The three kinds of metadata are in different key ranges and are read
+  // in parallel, in addition to shards being processed in parallel.
+  struct MetadataKind {
+    LogMetadataType type;
+    const char* name;
+    std::function<void(LogStorageState*, std::unique_ptr<LogMetadata>)> fn;
+  };
+  const std::vector<MetadataKind> kinds = {
+      {LogMetadataType::TRIM_POINT,
+       "Trim Points",
+       [](LogStorageState* log_state, std::unique_ptr<LogMetadata> meta) {
+         log_state->updateTrimPoint(
+             dynamic_cast<TrimMetadata*>(meta.get())->trim_point_);
+       }},
+      {LogMetadataType::LAST_CLEAN,
+       "Last Clean Epochs",
+       [](LogStorageState* log_state, std::unique_ptr<LogMetadata> meta) {
+         log_state->updateLastCleanEpoch(
+             dynamic_cast<LastCleanMetadata*>(meta.get())->epoch_);
+       }},
+      {LogMetadataType::LAST_RELEASED,
+       "Last Released LSN",
+       [](LogStorageState* log_state, std::unique_ptr<LogMetadata> meta) {
+         log_state->updateLastReleasedLSN(
+             dynamic_cast<LastReleasedMetadata*>(meta.get())
+                 ->last_released_lsn_,
+             LogStorageState::LastReleasedSource::LOCAL_LOG_STORE);
+       }},
+  };
+
   std::vector<std::future<bool>> futures;
   for (shard_index_t shard = 0; shard < nshards; ++shard) {
     futures.push_back(std::async(
         std::launch::async,
-        [shard, &make_traverser, &sharded_store = sharded_store_]() {
+        [shard, &kinds, &make_traverser, &sharded_store = sharded_store_]() {
           ThreadID::set(ThreadID::UTILITY,
                         folly::sformat("ld:populateLogState{}", shard));
           auto store = sharded_store->getByIndex(shard);
-          auto trim_point_traverser = make_traverser(
-              shard,
-              [](LogStorageState* log_state,
-                 std::unique_ptr<LogMetadata> meta) {
-                log_state->updateTrimPoint(
-                    dynamic_cast<TrimMetadata*>(meta.get())->trim_point_);
-              });
-          auto lce_traverser = make_traverser(
-              shard,
-              [](LogStorageState* log_state,
-                 std::unique_ptr<LogMetadata> meta) {
-                log_state->updateLastCleanEpoch(
-                    dynamic_cast<LastCleanMetadata*>(meta.get())->epoch_);
-              });
-          auto last_released_traverser = make_traverser(
-              shard,
-              [](LogStorageState* log_state,
-                 std::unique_ptr<LogMetadata> meta) {
-                log_state->updateLastReleasedLSN(
-                    dynamic_cast<LastReleasedMetadata*>(meta.get())
-                        ->last_released_lsn_,
-                    LogStorageState::LastReleasedSource::LOCAL_LOG_STORE);
-              });
-          int rv = store->traverseLogsMetadata(
-              LogMetadataType::TRIM_POINT, trim_point_traverser);
-          if (rv != 0) {
-            ld_error("Failed to populate Trim Points from shard %d: %s.",
-                     shard,
-                     error_name(err));
-            goto out;
-          }
 
-          rv = store->traverseLogsMetadata(
-              LogMetadataType::LAST_CLEAN, lce_traverser);
-          if (rv != 0) {
-            ld_error("Failed to populate Last Clean Epochs from shard %d: %s",
-                     shard,
-                     error_name(err));
-            goto out;
+          std::vector<std::future<int>> traversals;
+          for (size_t i = 0; i < kinds.size(); ++i) {
+            traversals.push_back(std::async(std::launch::async, [&, i]() {
+              ThreadID::set(ThreadID::UTILITY,
+                            folly::sformat("ld:populateLogState{}", shard));
+              const MetadataKind& kind = kinds[i];
+              int rv = store->traverseLogsMetadata(
+                  kind.type, make_traverser(shard, kind.fn));
+              if (rv != 0) {
+                ld_error("Failed to populate %s from shard %d: %s.",
+                         kind.name,
+                         shard,
+                         error_name(err));
+              }
+              return rv;
+            }));
           }
 
-          rv = store->traverseLogsMetadata(
-              LogMetadataType::LAST_RELEASED, last_released_traverser);
-          if (rv != 0) {
-            ld_error("Failed to populate Last Released LSN from shard %d: %s",
-                     shard,
-                     error_name(err));
+          int rv = 0;
+          for (auto& f : traversals) {
+            if (f.get() != 0) {
+              rv = -1;
+            }
           }
-
-        out:
           if (rv != 0 && !sharded_store->switchToFailingLocalLogStore(shard)) {
             ld_critical("Failed to disable shard %d.", shard);
             return false;
@@ -1262,6 +1295,13 @@ bool Server::repopulateRecordCaches() {
     return true;
   }
 
+  SteadyTimestamp start_ts(SteadyTimestamp::now());
+  SCOPE_EXIT {
+    STAT_SET(params_->getStats(),
+             startup_repopulate_record_caches_ms,
+             msec_since(start_ts.timePoint()));
+  };
+
   // Callback function for each status
   std::map<Status, std::vector<int>> status_counts;
   auto callback = [&status_counts](Status status, shard_index_t shard_idx) {
@@ -1398,6 +1438,9 @@ bool Server::initSequencerPlacement() {
           ld_info("using SequencerOptions::LAZY");
           placement_ptr = std::make_shared<LazySequencerPlacement>(
               processor_.get(), params_->getGossipSettings());
+          if (!startSequencerRebalancer()) {
+            return false;
+          }
           break;
 
         case SequencerOptions::NONE:
@@ -1415,6 +1458,19 @@ bool Server::initSequencerPlacement() {
   return true;
 }
 
+bool Server::startSequencerRebalancer() {
+  if (processor_->settings()->sequencer_rebalancing_interval.count() == 0) {
+    return true;
+  }
+  ld_info("Starting sequencer rebalancing");
+  std::unique_ptr<Request> req = std::make_unique<SequencerRebalancer>();
+  if (processor_->postImportant(req) != 0) {
+    ld_error("Failed to post SequencerRebalancer: %s", error_name(err));
+    return false;
+  }
+  return true;
+}
+
 bool Server::initRebuildingCoordinator() {
   std::shared_ptr<Configuration> config = processor_->config_->get();
 
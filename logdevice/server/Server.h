@@ -359,6 +359,8 @@ class Server {
   bool initSequencers();
   bool initLogStoreMonitor();
   bool initSequencerPlacement();
+  // Starts SequencerRebalancer if --sequencer-rebalancing-interval is set.
+  bool startSequencerRebalancer();
   bool initRebuildingCoordinator();
   bool initClusterMaintenanceStateMachine();
   bool createAndAttachMaintenanceManager(AdminAPIHandler*);
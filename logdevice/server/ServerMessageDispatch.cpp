@@ -12,6 +12,7 @@
 #include "logdevice/common/UpdateableSecurityInfo.h"
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/protocol/CLEAN_Message.h"
+#include "logdevice/common/protocol/MULTI_RELEASE_Message.h"
 #include "logdevice/common/protocol/MessageTypeNames.h"
 #include "logdevice/common/protocol/RELEASE_Message.h"
 #include "logdevice/common/protocol/STOP_Message.h"
@@ -40,6 +41,9 @@
 #include "logdevice/server/message_handlers/GOSSIP_onReceived.h"
 #include "logdevice/server/message_handlers/LOGS_CONFIG_API_onReceived.h"
 #include "logdevice/server/message_handlers/MEMTABLE_FLUSHED_onReceived.h"
+#include "logdevice/server/message_handlers/MULTI_AMEND_onReceived.h"
+#include "logdevice/server/message_handlers/MULTI_SEAL_onReceived.h"
+#include "logdevice/server/message_handlers/READ_CONTROL_onReceived.h"
 #include "logdevice/server/message_handlers/SEAL_onReceived.h"
 #include "logdevice/server/message_handlers/START_onReceived.h"
 #include "logdevice/server/message_handlers/STOP_onReceived.h"
@@ -183,9 +187,21 @@ Message::Disposition ServerMessageDispatch::onReceivedHandler(
       return PurgeCoordinator::onReceived(
           checked_downcast<RELEASE_Message*>(msg), from);
 
+    case MessageType::MULTI_RELEASE:
+      return PurgeCoordinator::onReceived(
+          checked_downcast<MULTI_RELEASE_Message*>(msg), from);
+
     case MessageType::SEAL:
       return SEAL_onReceived(checked_downcast<SEAL_Message*>(msg), from);
 
+    case MessageType::MULTI_AMEND:
+      return MULTI_AMEND_onReceived(
+          checked_downcast<MULTI_AMEND_Message*>(msg), from);
+
+    case MessageType::MULTI_SEAL:
+      return MULTI_SEAL_onReceived(
+          checked_downcast<MULTI_SEAL_Message*>(msg), from);
+
     case MessageType::START:
       return START_onReceived(
           checked_downcast<START_Message*>(msg), from, permission_status);
@@ -208,6 +224,10 @@ Message::Disposition ServerMessageDispatch::onReceivedHandler(
       return AllServerReadStreams::onWindowMessage(
           checked_downcast<WINDOW_Message*>(msg), from);
 
+    case MessageType::READ_CONTROL:
+      return READ_CONTROL_onReceived(
+          checked_downcast<READ_CONTROL_Message*>(msg), from);
+
     case MessageType::LOGS_CONFIG_API:
       return LOGS_CONFIG_API_onReceived(
           checked_downcast<LOGS_CONFIG_API_Message*>(msg),
@@ -250,6 +270,20 @@ void ServerMessageDispatch::onSentImpl(const Message& msg,
       return GOSSIP_onSent(
           checked_downcast<const GOSSIP_Message&>(msg), st, to, enqueue_time);
 
+    case MessageType::MULTI_AMEND:
+      return MULTI_AMEND_onSent(
+          checked_downcast<const MULTI_AMEND_Message&>(msg),
+          st,
+          to,
+          enqueue_time);
+
+    case MessageType::MULTI_RECORD:
+      return MULTI_RECORD_onSent(
+          checked_downcast<const MULTI_RECORD_Message&>(msg),
+          st,
+          to,
+          enqueue_time);
+
     case MessageType::NODE_STATS:
       RATELIMIT_ERROR(std::chrono::seconds(60),
                       1,
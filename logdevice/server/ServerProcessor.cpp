@@ -8,6 +8,8 @@
 #include "logdevice/server/ServerProcessor.h"
 
 #include "logdevice/common/UpdateableSecurityInfo.h"
+#include "logdevice/common/configuration/UpdateableConfig.h"
+#include "logdevice/common/configuration/nodes/NodesConfigurationHistory.h"
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/server/FailureDetector.h"
 #include "logdevice/server/ServerTLSCredMonitor.h"
@@ -62,6 +64,21 @@ void ServerProcessor::init() {
   // because it needs to talk to all workers and wait for replies, it would
   // be suspect to deadlocks.
   sequencer_batching_.reset(new SequencerBatching(this));
+  if (updateableSettings()->nodes_configuration_diff_history_size > 0) {
+    nodes_configuration_history_ =
+        std::make_unique<configuration::nodes::NodesConfigurationHistory>(
+            updateableSettings()->nodes_configuration_diff_history_size);
+    // Record every version we see, not only the ones clients poll for, so
+    // that clients which got their version from another server can still be
+    // sent a diff.
+    nodes_configuration_history_handle_ =
+        config_->updateableNodesConfiguration()->callAndSubscribeToUpdates(
+            [this] {
+              if (auto nc = getNodesConfiguration()) {
+                nodes_configuration_history_->add(std::move(nc));
+              }
+            });
+  }
   if (sharded_storage_thread_pool_ != nullptr) {
     // All shards are assumed to be waiting to be rebuilt until
     // markShardAsNotMissingData() is called.
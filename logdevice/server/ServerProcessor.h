@@ -15,6 +15,7 @@
 #include "logdevice/common/SequencerBatching.h"
 #include "logdevice/common/TrafficShaper.h"
 #include "logdevice/common/settings/GossipSettings.h"
+#include "logdevice/include/ConfigSubscriptionHandle.h"
 #include "logdevice/server/FailureDetector.h"
 #include "logdevice/server/HealthMonitor.h"
 #include "logdevice/server/ServerSettings.h"
@@ -147,6 +148,18 @@ class ServerProcessor : public Processor {
     return health_monitor_.get();
   }
 
+  // Called on workers when read IO shaping throttles a read stream because
+  // the node's read bandwidth is used up.
+  void noteReadIoThrottled() {
+    last_read_io_throttled_.storeMax(SteadyTimestamp::now());
+  }
+
+  // Last time noteReadIoThrottled() was called, SteadyTimestamp::min() if
+  // never. LogsDB postpones non-urgent compactions for a while after that.
+  SteadyTimestamp lastReadIoThrottled() const {
+    return last_read_io_throttled_.load();
+  }
+
  private:
   void fixupLogStorageStateMap();
 
@@ -168,5 +181,10 @@ class ServerProcessor : public Processor {
 
   // HealthMonitor pointer. Used on server side to keep track of node status.
   std::unique_ptr<HealthMonitor> health_monitor_;
+
+  // Feeds nodes_configuration_history_ with NodesConfiguration updates.
+  ConfigSubscriptionHandle nodes_configuration_history_handle_;
+
+  AtomicSteadyTimestamp last_read_io_throttled_{SteadyTimestamp::min()};
 };
 }} // namespace facebook::logdevice
@@ -0,0 +1,441 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/ServerRecordExpressionFilter.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include <folly/Conv.h>
+#include <folly/Format.h>
+
+#include "logdevice/common/debug.h"
+#include "logdevice/common/util.h"
+
+namespace facebook { namespace logdevice {
+
+using Instruction = ServerRecordExpressionFilter::Instruction;
+using Field = ServerRecordExpressionFilter::Field;
+using Cmp = ServerRecordExpressionFilter::Cmp;
+
+namespace {
+
+bool isKeyField(Field field) {
+  return field == Field::KEY || field == Field::FINDKEY;
+}
+
+// Recursive descent parser that emits the program as it goes.
+class Compiler {
+ public:
+  explicit Compiler(folly::StringPiece text) : text_(text) {}
+
+  bool compile(std::vector<Instruction>* program, std::string* error) {
+    if (text_.size() > ServerRecordExpressionFilter::MAX_EXPRESSION_LENGTH) {
+      fail(folly::sformat(
+          "expression is longer than {} bytes",
+          ServerRecordExpressionFilter::MAX_EXPRESSION_LENGTH));
+    } else if (parseOr() && !atEnd()) {
+      fail("unexpected input");
+    }
+    if (!error_.empty()) {
+      if (error) {
+        *error = folly::sformat("{} at offset {}", error_, pos_);
+      }
+      return false;
+    }
+    *program = std::move(program_);
+    return true;
+  }
+
+ private:
+  bool fail(std::string error) {
+    if (error_.empty()) {
+      error_ = std::move(error);
+    }
+    return false;
+  }
+
+  void skipSpace() {
+    while (pos_ < text_.size() && isspace(text_[pos_])) {
+      ++pos_;
+    }
+  }
+
+  bool atEnd() {
+    skipSpace();
+    return pos_ == text_.size();
+  }
+
+  // Consumes `token` if the input continues with it.
+  bool accept(folly::StringPiece token) {
+    skipSpace();
+    if (text_.subpiece(pos_).startsWith(token)) {
+      pos_ += token.size();
+      return true;
+    }
+    return false;
+  }
+
+  bool expect(folly::StringPiece token) {
+    return accept(token) || fail(folly::sformat("expected '{}'", token));
+  }
+
+  // Reads a run of alphanumeric characters and underscores.
+  folly::StringPiece word() {
+    skipSpace();
+    size_t start = pos_;
+    while (pos_ < text_.size() &&
+           (isalnum(text_[pos_]) || text_[pos_] == '_')) {
+      ++pos_;
+    }
+    return text_.subpiece(start, pos_ - start);
+  }
+
+  // Emits a jump with a destination to be patched by patch().
+  size_t emitJump(Instruction::Op op) {
+    Instruction instr{};
+    instr.op = op;
+    program_.push_back(std::move(instr));
+    return program_.size() - 1;
+  }
+
+  void patch(const std::vector<size_t>& jumps) {
+    for (size_t jump : jumps) {
+      program_[jump].target = program_.size();
+    }
+  }
+
+  bool parseOr() {
+    if (++depth_ > ServerRecordExpressionFilter::MAX_NESTING_DEPTH) {
+      return fail("expression is nested too deeply");
+    }
+    std::vector<size_t> jumps;
+    if (!parseAnd()) {
+      return false;
+    }
+    while (accept("||")) {
+      jumps.push_back(emitJump(Instruction::Op::JUMP_IF_TRUE));
+      if (!parseAnd()) {
+        return false;
+      }
+    }
+    patch(jumps);
+    --depth_;
+    return true;
+  }
+
+  bool parseAnd() {
+    std::vector<size_t> jumps;
+    if (!parseUnary()) {
+      return false;
+    }
+    while (accept("&&")) {
+      jumps.push_back(emitJump(Instruction::Op::JUMP_IF_FALSE));
+      if (!parseUnary()) {
+        return false;
+      }
+    }
+    patch(jumps);
+    return true;
+  }
+
+  bool parseUnary() {
+    // "!=" is not a unary operator, but it can't start a term either.
+    skipSpace();
+    if (!text_.subpiece(pos_).startsWith("!=") && accept("!")) {
+      if (++depth_ > ServerRecordExpressionFilter::MAX_NESTING_DEPTH) {
+        return fail("expression is nested too deeply");
+      }
+      if (!parseUnary()) {
+        return false;
+      }
+      --depth_;
+      Instruction instr{};
+      instr.op = Instruction::Op::NOT;
+      program_.push_back(std::move(instr));
+      return true;
+    }
+    if (accept("(")) {
+      return parseOr() && expect(")");
+    }
+    return parseTest();
+  }
+
+  bool parseField(Field* field) {
+    folly::StringPiece name = word();
+    if (name == "key") {
+      *field = Field::KEY;
+    } else if (name == "findkey") {
+      *field = Field::FINDKEY;
+    } else if (name == "lsn") {
+      *field = Field::LSN;
+    } else if (name == "timestamp") {
+      *field = Field::TIMESTAMP;
+    } else if (name == "size") {
+      *field = Field::SIZE;
+    } else {
+      return fail(name.empty()
+                      ? std::string("expected a field")
+                      : folly::sformat("unknown field '{}'", name));
+    }
+    return true;
+  }
+
+  bool parseString(std::string* out) {
+    if (!expect("\"")) {
+      return false;
+    }
+    out->clear();
+    while (pos_ < text_.size() && text_[pos_] != '"') {
+      if (text_[pos_] == '\\') {
+        ++pos_;
+        if (pos_ == text_.size() ||
+            (text_[pos_] != '"' && text_[pos_] != '\\')) {
+          return fail("bad escape sequence");
+        }
+      }
+      out->push_back(text_[pos_++]);
+    }
+    if (pos_ == text_.size()) {
+      return fail("unterminated string");
+    }
+    ++pos_;
+    return true;
+  }
+
+  bool parseNumber(Field field, uint64_t* out) {
+    folly::StringPiece token = word();
+    if (field == Field::LSN) {
+      lsn_t lsn;
+      if (!token.empty() && string_to_lsn(token.str(), lsn) == 0) {
+        *out = lsn;
+        return true;
+      }
+    } else {
+      auto result = folly::tryTo<uint64_t>(token);
+      if (result.hasValue()) {
+        *out = result.value();
+        return true;
+      }
+    }
+    return fail("expected a number");
+  }
+
+  bool parseLiteral(Instruction* instr) {
+    if (isKeyField(instr->field)) {
+      std::string value;
+      if (!parseString(&value)) {
+        return false;
+      }
+      instr->strings.push_back(std::move(value));
+    } else {
+      uint64_t value;
+      if (!parseNumber(instr->field, &value)) {
+        return false;
+      }
+      instr->numbers.push_back(value);
+    }
+    return true;
+  }
+
+  bool parseTest() {
+    Instruction instr{};
+    instr.op = Instruction::Op::TEST;
+
+    size_t start = pos_;
+    if (word() == "has") {
+      instr.cmp = Cmp::HAS;
+      if (!expect("(") || !parseField(&instr.field)) {
+        return false;
+      }
+      if (!isKeyField(instr.field)) {
+        return fail("has() only applies to keys");
+      }
+      if (!expect(")")) {
+        return false;
+      }
+      program_.push_back(std::move(instr));
+      return true;
+    }
+    pos_ = start;
+
+    if (!parseField(&instr.field)) {
+      return false;
+    }
+
+    // Two-character operators first, so that "<=" isn't read as "<".
+    static const std::pair<const char*, Cmp> ops[] = {{"==", Cmp::EQ},
+                                                      {"!=", Cmp::NE},
+                                                      {"<=", Cmp::LE},
+                                                      {">=", Cmp::GE},
+                                                      {"^=", Cmp::PREFIX},
+                                                      {"<", Cmp::LT},
+                                                      {">", Cmp::GT}};
+    bool found = false;
+    for (const auto& op : ops) {
+      if (accept(op.first)) {
+        instr.cmp = op.second;
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      start = pos_;
+      if (word() != "in") {
+        pos_ = start;
+        return fail("expected a comparison operator");
+      }
+      instr.cmp = Cmp::IN;
+    }
+
+    if (instr.cmp == Cmp::PREFIX && !isKeyField(instr.field)) {
+      return fail("'^=' only applies to keys");
+    }
+
+    if (instr.cmp == Cmp::IN) {
+      if (!expect("(")) {
+        return false;
+      }
+      do {
+        if (!parseLiteral(&instr)) {
+          return false;
+        }
+      } while (accept(","));
+      if (!expect(")")) {
+        return false;
+      }
+      // Sort so that evaluation is a binary search.
+      std::sort(instr.strings.begin(), instr.strings.end());
+      instr.strings.erase(
+          std::unique(instr.strings.begin(), instr.strings.end()),
+          instr.strings.end());
+      std::sort(instr.numbers.begin(), instr.numbers.end());
+      instr.numbers.erase(
+          std::unique(instr.numbers.begin(), instr.numbers.end()),
+          instr.numbers.end());
+    } else if (!parseLiteral(&instr)) {
+      return false;
+    }
+
+    program_.push_back(std::move(instr));
+    return true;
+  }
+
+  const folly::StringPiece text_;
+  size_t pos_{0};
+  size_t depth_{0};
+  std::string error_;
+  std::vector<Instruction> program_;
+};
+
+template <typename T>
+bool compare(Cmp cmp, const T& value, const std::vector<T>& operand) {
+  switch (cmp) {
+    case Cmp::EQ:
+      return value == operand[0];
+    case Cmp::NE:
+      return value != operand[0];
+    case Cmp::LT:
+      return value < operand[0];
+    case Cmp::LE:
+      return value <= operand[0];
+    case Cmp::GT:
+      return value > operand[0];
+    case Cmp::GE:
+      return value >= operand[0];
+    case Cmp::IN:
+      return std::binary_search(operand.begin(), operand.end(), value);
+    case Cmp::PREFIX:
+    case Cmp::HAS:
+      break;
+  }
+  ld_check(false);
+  return false;
+}
+
+} // namespace
+
+std::unique_ptr<ServerRecordExpressionFilter>
+ServerRecordExpressionFilter::compile(folly::StringPiece expression,
+                                      std::string* error) {
+  std::vector<Instruction> program;
+  if (!Compiler(expression).compile(&program, error)) {
+    return nullptr;
+  }
+  return std::unique_ptr<ServerRecordExpressionFilter>(
+      new ServerRecordExpressionFilter(expression.str(), std::move(program)));
+}
+
+bool ServerRecordExpressionFilter::test(const Instruction& instr,
+                                        const RecordAttributes& record) {
+  switch (instr.field) {
+    case Field::KEY:
+    case Field::FINDKEY: {
+      auto it = record.optional_keys.find(
+          instr.field == Field::KEY ? KeyType::FILTERABLE : KeyType::FINDKEY);
+      if (it == record.optional_keys.end()) {
+        return false;
+      }
+      if (instr.cmp == Cmp::HAS) {
+        return true;
+      }
+      if (instr.cmp == Cmp::PREFIX) {
+        return folly::StringPiece(it->second).startsWith(instr.strings[0]);
+      }
+      return compare<std::string>(instr.cmp, it->second, instr.strings);
+    }
+    case Field::LSN:
+      return compare<uint64_t>(instr.cmp, record.lsn, instr.numbers);
+    case Field::TIMESTAMP:
+      return compare<uint64_t>(
+          instr.cmp, record.timestamp.count(), instr.numbers);
+    case Field::SIZE:
+      return compare<uint64_t>(instr.cmp, record.payload_size, instr.numbers);
+  }
+  ld_check(false);
+  return false;
+}
+
+bool ServerRecordExpressionFilter::matches(const RecordAttributes& record) {
+  bool result = true;
+  size_t pc = 0;
+  while (pc < program_.size()) {
+    const Instruction& instr = program_[pc++];
+    switch (instr.op) {
+      case Instruction::Op::TEST:
+        result = test(instr, record);
+        break;
+      case Instruction::Op::NOT:
+        result = !result;
+        break;
+      case Instruction::Op::JUMP_IF_FALSE:
+        if (!result) {
+          pc = instr.target;
+        }
+        break;
+      case Instruction::Op::JUMP_IF_TRUE:
+        if (result) {
+          pc = instr.target;
+        }
+        break;
+    }
+  }
+  return result;
+}
+
+bool ServerRecordExpressionFilter::operator()(folly::StringPiece record_key) {
+  const std::map<KeyType, std::string> keys{
+      {KeyType::FILTERABLE, record_key.str()}};
+  return matches(RecordAttributes{
+      LSN_INVALID, std::chrono::milliseconds(0), 0, keys});
+}
+
+std::string ServerRecordExpressionFilter::toString() const {
+  return "Server-side filter type: EXPRESSION, expression: " + text_;
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,115 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "logdevice/common/ServerRecordFilter.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file ServerRecordExpressionFilter evaluates a boolean expression over the
+ *       optional keys and attributes of a record. The expression is compiled
+ *       once, when the read stream is started, into a flat program that is
+ *       run for every record read. Experimental feature: Use with caution.
+ *
+ *       Syntax:
+ *
+ *         expr       := and_expr ( "||" and_expr )*
+ *         and_expr   := unary ( "&&" unary )*
+ *         unary      := "!" unary | "(" expr ")" | "has" "(" key_field ")"
+ *                     | field op literal
+ *                     | field "in" "(" literal ( "," literal )* ")"
+ *         key_field  := "key" | "findkey"
+ *         field      := key_field | "lsn" | "timestamp" | "size"
+ *         op         := "==" | "!=" | "<" | "<=" | ">" | ">=" | "^="
+ *
+ *       "key" is the FILTERABLE key and "findkey" the FINDKEY key of the
+ *       record, compared as strings with string literals ("..." with \" and
+ *       \\ escapes). "^=" is a prefix match and only applies to keys. A
+ *       comparison on a key the record doesn't have is false, whatever the
+ *       operator; use has() to test for presence. "lsn" (decimal or eXnY),
+ *       "timestamp" (milliseconds since epoch) and "size" (bytes of payload
+ *       as stored) are compared as unsigned integers.
+ *
+ *       Example: key in ("us", "eu") && (has(findkey) || timestamp >= 100)
+ */
+
+class ServerRecordExpressionFilter final : public ServerRecordFilter {
+ public:
+  // Longest expression text and deepest nesting accepted by compile().
+  static constexpr size_t MAX_EXPRESSION_LENGTH = 4096;
+  static constexpr size_t MAX_NESTING_DEPTH = 32;
+
+  /**
+   * @param expression  text of the expression
+   * @param error       if not null, set to a description of the problem if
+   *                    the expression is invalid
+   * @return            compiled filter, or nullptr if the expression is
+   *                    invalid
+   */
+  static std::unique_ptr<ServerRecordExpressionFilter>
+  compile(folly::StringPiece expression, std::string* error = nullptr);
+
+  /**
+   * Evaluates the expression for a record that only has the given FILTERABLE
+   * key and no other attributes.
+   */
+  bool operator()(folly::StringPiece record_key) override;
+
+  bool matches(const RecordAttributes& record) override;
+
+  // Expressions may look at any attribute of the record.
+  bool onlyUsesFilterableKey() const override {
+    return false;
+  }
+
+  /**
+   *  @return             A human-readable string which describes this
+   *                      server-side filter.
+   */
+  std::string toString() const override;
+
+  enum class Field : uint8_t { KEY, FINDKEY, LSN, TIMESTAMP, SIZE };
+  enum class Cmp : uint8_t { EQ, NE, LT, LE, GT, GE, PREFIX, IN, HAS };
+
+  // One step of the compiled program. The program keeps a single boolean
+  // result: TEST sets it, NOT negates it, and the jumps skip the rest of an
+  // && or || chain once its result is known.
+  struct Instruction {
+    enum class Op : uint8_t { TEST, NOT, JUMP_IF_FALSE, JUMP_IF_TRUE };
+
+    Op op;
+    Field field;
+    Cmp cmp;
+    // Operand of a string comparison, sorted and deduplicated for IN.
+    std::vector<std::string> strings;
+    // Operand of an integer comparison, sorted and deduplicated for IN.
+    std::vector<uint64_t> numbers;
+    // Jump destination.
+    size_t target;
+  };
+
+  const std::vector<Instruction>& program() const {
+    return program_;
+  }
+
+ private:
+  ServerRecordExpressionFilter(std::string text,
+                               std::vector<Instruction> program)
+      : text_(std::move(text)), program_(std::move(program)) {}
+
+  static bool test(const Instruction& instr, const RecordAttributes& record);
+
+  const std::string text_;
+  const std::vector<Instruction> program_;
+};
+}} // namespace facebook::logdevice
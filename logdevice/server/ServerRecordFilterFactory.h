@@ -16,6 +16,7 @@
 #include "logdevice/common/ServerRecordFilter.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/server/ServerRecordEqualityFilter.h"
+#include "logdevice/server/ServerRecordExpressionFilter.h"
 #include "logdevice/server/ServerRecordRangeFilter.h"
 
 namespace facebook { namespace logdevice {
@@ -30,7 +31,8 @@ class ServerRecordFilterFactory {
   /**
    *  @param type  specifies type of filter we are constructing here.
    *               Type is defined in ServerRecordFilter.h
-   *         key1  param for constructing ServerRecordFilter
+   *         key1  param for constructing ServerRecordFilter. Text of the
+   *               expression for ServerRecordExpressionFilter.
    *         key2  param for constructing ServerRecordFilter, only used for
    *               ServerRecordRangeFilter. Serves as high_limit_.
    *  @return      unique_ptr to a ServerRecordFilter object; return nullptr
@@ -52,6 +54,17 @@ class ServerRecordFilterFactory {
           return nullptr;
         }
         return std::make_unique<ServerRecordRangeFilter>(key1, key2);
+      case ServerRecordFilterType::EXPRESSION: {
+        std::string error;
+        auto filter = ServerRecordExpressionFilter::compile(key1, &error);
+        if (filter == nullptr) {
+          ld_error("ServerRecordExpressionFilter failed to compile "
+                   "expression \"%s\": %s",
+                   key1.str().c_str(),
+                   error.c_str());
+        }
+        return std::move(filter);
+      }
       case ServerRecordFilterType::NOFILTER:
         return nullptr;
       default:
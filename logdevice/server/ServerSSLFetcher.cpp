@@ -21,9 +21,15 @@ ServerSSLFetcher::create(const std::string& cert_path,
                          const std::string& ca_path,
                          bool use_tls_ticket_seeds,
                          const std::string& tls_ticket_seeds_path,
-                         StatsHolder* stats) {
-  std::unique_ptr<ServerSSLFetcher> fetcher{new ServerSSLFetcher(
-      cert_path, key_path, ca_path, use_tls_ticket_seeds, stats)};
+                         StatsHolder* stats,
+                         bool ktls_offload) {
+  std::unique_ptr<ServerSSLFetcher> fetcher{
+      new ServerSSLFetcher(cert_path,
+                           key_path,
+                           ca_path,
+                           use_tls_ticket_seeds,
+                           stats,
+                           ktls_offload)};
   fetcher->reloadSSLContext();
 
   if (use_tls_ticket_seeds) {
@@ -46,8 +52,9 @@ ServerSSLFetcher::ServerSSLFetcher(const std::string& cert_path,
                                    const std::string& key_path,
                                    const std::string& ca_path,
                                    bool use_tls_ticket_seeds,
-                                   StatsHolder* stats)
-    : SSLFetcher(cert_path, key_path, ca_path, true, stats),
+                                   StatsHolder* stats,
+                                   bool ktls_offload)
+    : SSLFetcher(cert_path, key_path, ca_path, true, stats, ktls_offload),
       use_tls_ticket_seeds_(use_tls_ticket_seeds) {}
 
 void ServerSSLFetcher::reloadSSLContext() {
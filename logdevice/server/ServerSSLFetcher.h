@@ -34,7 +34,8 @@ class ServerSSLFetcher : public SSLFetcher {
          const std::string& ca_path,
          bool use_tls_ticket_seeds,
          const std::string& tls_ticket_seeds_path,
-         StatsHolder* stats = nullptr);
+         StatsHolder* stats = nullptr,
+         bool ktls_offload = false);
 
   virtual ~ServerSSLFetcher() = default;
 
@@ -58,7 +59,8 @@ class ServerSSLFetcher : public SSLFetcher {
                    const std::string& key_path,
                    const std::string& ca_path,
                    bool enable_shared_tickets,
-                   StatsHolder* stats = nullptr);
+                   StatsHolder* stats = nullptr,
+                   bool ktls_offload = false);
 
  private:
   const bool use_tls_ticket_seeds_;
@@ -337,6 +337,63 @@ void ServerSettings::defineSettings(SettingEasyInit& init) {
      SERVER,
      SettingsCategory::Storage)
 
+    ("storage-task-response-batch-delay",
+     &storage_task_response_batch_delay,
+     "0",
+     validate_nonnegative<ssize_t>(),
+     "If positive, storage threads collect responses to finished storage "
+     "tasks going to the same worker and post them together, waking the "
+     "worker up once per batch. A response is held for at most this long, "
+     "and never while the storage thread is waiting for more tasks. 0 "
+     "posts every response on its own.",
+     SERVER,
+     SettingsCategory::Storage)
+
+    ("per-log-stats-top-k",
+     &per_log_stats_top_k,
+     "0",
+     nullptr,
+     "If positive, throughput of log groups (as reported by 'stats "
+     "throughput' and the admin API) is tracked with a count-min sketch and "
+     "this many top log groups per worker, rather than with a time series "
+     "per log group. Memory and aggregation cost are then bounded no matter "
+     "how many log groups there are; rates of the top log groups are "
+     "accurate and the rest are approximated.",
+     SERVER | REQUIRES_RESTART,
+     SettingsCategory::Monitoring)
+
+    ("per-log-stats-sample-period",
+     &per_log_stats_sample_period,
+     "1",
+     validate_positive<ssize_t>(),
+     "With --per-log-stats-top-k, record only one in this many log group "
+     "throughput updates on average, scaling the recorded values up "
+     "accordingly. 1 records all of them.",
+     SERVER | REQUIRES_RESTART,
+     SettingsCategory::Monitoring)
+
+    ("per-client-stats-top-k",
+     &per_client_stats_top_k,
+     "0",
+     nullptr,
+     "If positive, bytes and records read, read storage task time, append "
+     "bytes and new connections are accounted per principal and per client "
+     "host, tracking this many top principals and clients per thread with "
+     "a count-min sketch. See 'info client_resources'. 0 disables it.",
+     SERVER | REQUIRES_RESTART,
+     SettingsCategory::Monitoring)
+
+    ("wal-sync-group-commit-window",
+     &wal_sync_group_commit_window,
+     "0",
+     validate_nonnegative<ssize_t>(),
+     "If positive, the syncing storage threads of all shards wait for each "
+     "other for up to this long before syncing their WALs, so that syncs "
+     "from different shards reach the devices together and can share "
+     "device flushes. Useful when many shards share a device. 0 disables.",
+     SERVER,
+     SettingsCategory::Storage)
+
     ("fd-limit", &fd_limit, "0",
      [](int val) -> void {
        if (val < 0) {
@@ -72,6 +72,23 @@ struct ServerSettings : public SettingsBundle {
   // Interval between invoking syncs for delayable storage tasks.
   // Ignored when undelayable task is being enqueued.
   std::chrono::milliseconds storage_thread_delaying_sync_interval;
+  // If positive, syncing threads of all shards line up their WAL syncs in
+  // rounds of at most this long. See WALSyncGroup.
+  std::chrono::microseconds wal_sync_group_commit_window;
+  // If positive, storage threads send responses to finished tasks back to
+  // workers in batches, holding a response for at most this long. See
+  // StorageTaskResponseBatcher.
+  std::chrono::microseconds storage_task_response_batch_delay;
+  // If positive, log group throughput is tracked for this many top log
+  // groups per thread with a count-min sketch rather than with a time series
+  // per log group. See StatsParams::per_log_stats_top_k.
+  size_t per_log_stats_top_k;
+  // With per_log_stats_top_k, record one in this many throughput updates.
+  uint32_t per_log_stats_sample_period;
+  // If positive, resources used by each principal and client host are
+  // tracked for this many top principals and clients per thread. See
+  // StatsParams::per_client_stats_top_k.
+  size_t per_client_stats_top_k;
   std::string server_id;
   int fd_limit;
   bool eagerly_allocate_fdtable;
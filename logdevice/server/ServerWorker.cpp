@@ -14,6 +14,7 @@
 #include "logdevice/server/ServerProcessor.h"
 #include "logdevice/server/ServerSSLFetcher.h"
 #include "logdevice/server/read_path/AllServerReadStreams.h"
+#include "logdevice/server/rebuilding/AmendBatcher.h"
 #include "logdevice/server/rebuilding/ChunkRebuilding.h"
 #include "logdevice/server/sequencer_boycotting/NodeStatsController.h"
 #include "logdevice/server/sequencer_boycotting/NodeStatsControllerLocator.h"
@@ -44,6 +45,7 @@ class ServerWorkerImpl {
   AllCachedDigests cachedDigests_;
   PurgeUncleanEpochsMap activePurges_;
   ChunkRebuildingMap runningChunkRebuildings_;
+  AmendBatcher amendBatcher_;
 
   /**
    * Should only be instantiated on a single worker, decided by
@@ -164,6 +166,10 @@ ChunkRebuildingMap& ServerWorker::runningChunkRebuildings() const {
   return impl_->runningChunkRebuildings_;
 }
 
+AmendBatcher& ServerWorker::amendBatcher() const {
+  return impl_->amendBatcher_;
+}
+
 AllServerReadStreams& ServerWorker::serverReadStreams() const {
   ld_assert(server_read_streams_.get());
   return *server_read_streams_;
@@ -201,7 +207,8 @@ void ServerWorker::initSSLFetcher() {
                                setting.ssl_ca_path,
                                server_settings->use_tls_ticket_seeds,
                                server_settings->tls_ticket_seeds_path,
-                               stats());
+                               stats(),
+                               setting.ssl_ktls_offload);
 }
 
 void ServerWorker::setupWorker() {
@@ -19,6 +19,7 @@
 namespace facebook { namespace logdevice {
 
 class AllCachedDigests;
+class AmendBatcher;
 class AllServerReadStreams;
 class BoycottingStatsHolder;
 class NodeStatsControllerCallback;
@@ -72,6 +73,9 @@ class ServerWorker : public Worker {
 
   ChunkRebuildingMap& runningChunkRebuildings() const;
 
+  // Batches the amends that rebuilding sends to other storage nodes.
+  AmendBatcher& amendBatcher() const;
+
   // Intentionally shadows `Worker::processor_' to expose a more specific
   // subclass of Processor
   ServerProcessor* const processor_;
@@ -0,0 +1,295 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/StallStackCapture.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include <signal.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <folly/Demangle.h>
+#include <folly/Format.h>
+#include <folly/experimental/symbolizer/StackTrace.h>
+#include <folly/experimental/symbolizer/Symbolizer.h>
+
+#include "logdevice/common/RunContext.h"
+#include "logdevice/common/ThreadID.h"
+#include "logdevice/common/Worker.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/include/Err.h"
+
+namespace facebook { namespace logdevice {
+
+namespace {
+
+constexpr size_t kMaxFrames = 64;
+// Frames of the signal handler and of the kernel's signal trampoline, on top
+// of the interrupted code.
+constexpr size_t kSkipFrames = 2;
+// Distinct (context, stack) pairs kept by record(). Stalls with a new pair
+// are dropped once reached, until clear().
+constexpr size_t kMaxEntries = 1000;
+
+int captureSignal() {
+  // Real-time signals aren't used elsewhere in the process.
+  return SIGRTMIN + 1;
+}
+
+enum CaptureState : uint8_t { IDLE, REQUESTED, WRITING, DONE };
+
+// Everything the signal handler touches. Only one capture at a time.
+struct SignalState {
+  std::atomic<uint8_t> state{IDLE};
+  std::atomic<pid_t> target{0};
+  RunContext context;
+  std::chrono::steady_clock::time_point running_since;
+  bool has_worker;
+  size_t num_frames;
+  // leaf first
+  std::array<uintptr_t, kMaxFrames + kSkipFrames> frames;
+};
+
+SignalState g_signal_state;
+
+void handleSignal(int /*sig*/) {
+  const int saved_errno = errno;
+  SignalState& st = g_signal_state;
+  uint8_t expected = REQUESTED;
+  // Ignores signals meant for another thread, or arriving after the watchdog
+  // gave up.
+  if (st.target.load(std::memory_order_acquire) == ThreadID::getId() &&
+      st.state.compare_exchange_strong(
+          expected, WRITING, std::memory_order_acquire)) {
+    ssize_t n = folly::symbolizer::getStackTraceSafe(
+        st.frames.data(), st.frames.size());
+    st.num_frames = std::max<ssize_t>(n, 0);
+    // Only reads thread-local and worker fields, no allocation.
+    Worker* w = Worker::onThisThread(false);
+    st.has_worker = w != nullptr;
+    if (w) {
+      st.context = w->currentlyRunning_;
+      st.running_since = w->currentlyRunningStart_;
+    }
+    st.state.store(DONE, std::memory_order_release);
+  }
+  errno = saved_errno;
+}
+
+void installSignalHandler() {
+  static std::once_flag once;
+  std::call_once(once, [] {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = handleSignal;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    int rv = sigaction(captureSignal(), &sa, nullptr);
+    ld_check(rv == 0);
+  });
+}
+
+class Aggregator {
+ public:
+  void record(const std::string& worker,
+              const StallStackCapture::Stack& stack,
+              std::chrono::milliseconds stalled_for);
+  std::vector<std::string> symbolize(const std::vector<uintptr_t>& frames);
+  std::vector<StallStackCapture::Entry> getEntries();
+  void clear();
+
+ private:
+  struct Value {
+    uint64_t captures = 0;
+    std::chrono::milliseconds max_stalled_for{0};
+    std::chrono::milliseconds max_running_for{0};
+    std::string last_worker;
+    SystemTimestamp last_seen;
+  };
+
+  std::mutex mutex_;
+  // Keyed by context and frames, leaf first.
+  std::map<std::pair<std::string, std::vector<uintptr_t>>, Value> entries_;
+  std::unordered_map<uintptr_t, std::string> symbols_;
+};
+
+Aggregator& aggregator() {
+  static Aggregator* a = new Aggregator();
+  return *a;
+}
+
+// Serializes captures.
+std::mutex g_capture_mutex;
+
+} // namespace
+
+std::vector<std::string>
+Aggregator::symbolize(const std::vector<uintptr_t>& frames) {
+  std::vector<uintptr_t> unknown;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (uintptr_t addr : frames) {
+      if (!symbols_.count(addr)) {
+        unknown.push_back(addr);
+      }
+    }
+  }
+  std::vector<std::pair<uintptr_t, std::string>> names;
+  if (!unknown.empty()) {
+    // Reads debug info, keep it out of the lock.
+    folly::symbolizer::Symbolizer symbolizer(
+        folly::symbolizer::LocationInfoMode::DISABLED);
+    for (uintptr_t addr : unknown) {
+      folly::symbolizer::SymbolizedFrame frame;
+      symbolizer.symbolize(addr, frame);
+      names.emplace_back(addr,
+                         frame.found && frame.name
+                             ? folly::demangle(frame.name).toStdString()
+                             : folly::sformat("{:#x}", addr));
+    }
+  }
+  std::vector<std::string> res;
+  res.reserve(frames.size());
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& kv : names) {
+    symbols_[kv.first] = std::move(kv.second);
+  }
+  for (uintptr_t addr : frames) {
+    res.push_back(symbols_.at(addr));
+  }
+  return res;
+}
+
+void Aggregator::record(const std::string& worker,
+                        const StallStackCapture::Stack& stack,
+                        std::chrono::milliseconds stalled_for) {
+  // Symbolizes new addresses.
+  symbolize(stack.frames);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto key = std::make_pair(stack.context, stack.frames);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    if (entries_.size() >= kMaxEntries) {
+      RATELIMIT_WARNING(std::chrono::minutes(1),
+                        1,
+                        "Not recording the stack of stalled worker %s: "
+                        "already %zu different stacks",
+                        worker.c_str(),
+                        entries_.size());
+      return;
+    }
+    it = entries_.emplace(std::move(key), Value()).first;
+  }
+  Value& v = it->second;
+  ++v.captures;
+  v.max_stalled_for = std::max(v.max_stalled_for, stalled_for);
+  v.max_running_for = std::max(v.max_running_for, stack.running_for);
+  v.last_worker = worker;
+  v.last_seen = SystemTimestamp::now();
+}
+
+std::vector<StallStackCapture::Entry> Aggregator::getEntries() {
+  std::vector<StallStackCapture::Entry> res;
+  std::lock_guard<std::mutex> lock(mutex_);
+  res.reserve(entries_.size());
+  for (const auto& kv : entries_) {
+    StallStackCapture::Entry e;
+    e.context = kv.first.first;
+    for (uintptr_t addr : kv.first.second) {
+      e.frames.push_back(symbols_.at(addr));
+    }
+    e.captures = kv.second.captures;
+    e.max_stalled_for = kv.second.max_stalled_for;
+    e.max_running_for = kv.second.max_running_for;
+    e.last_worker = kv.second.last_worker;
+    e.last_seen = kv.second.last_seen;
+    res.push_back(std::move(e));
+  }
+  std::stable_sort(res.begin(), res.end(), [](const auto& a, const auto& b) {
+    return a.captures > b.captures;
+  });
+  return res;
+}
+
+void Aggregator::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+}
+
+int StallStackCapture::capture(pid_t tid,
+                               std::chrono::milliseconds timeout,
+                               Stack* out) {
+  ld_check(out);
+  std::lock_guard<std::mutex> capture_guard(g_capture_mutex);
+  installSignalHandler();
+  SignalState& st = g_signal_state;
+  st.target.store(tid, std::memory_order_relaxed);
+  st.state.store(REQUESTED, std::memory_order_release);
+  if (syscall(SYS_tgkill, getpid(), tid, captureSignal()) != 0) {
+    st.state.store(IDLE);
+    err = E::NOTFOUND;
+    return -1;
+  }
+
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (st.state.load(std::memory_order_acquire) != DONE) {
+    if (std::chrono::steady_clock::now() >= deadline) {
+      uint8_t expected = REQUESTED;
+      if (st.state.compare_exchange_strong(expected, IDLE)) {
+        // The handler will ignore the signal if it runs later.
+        err = E::TIMEDOUT;
+        return -1;
+      }
+      // The handler is running, it won't take long.
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  out->frames.assign(st.frames.begin() + std::min(kSkipFrames, st.num_frames),
+                     st.frames.begin() + st.num_frames);
+  if (st.has_worker) {
+    out->context = st.context.describe();
+    out->running_for = st.context.type_ == RunContext::NONE
+        ? std::chrono::milliseconds::zero()
+        : std::chrono::duration_cast<std::chrono::milliseconds>(
+              std::chrono::steady_clock::now() - st.running_since);
+  } else {
+    out->context = RunContext().describe();
+    out->running_for = std::chrono::milliseconds::zero();
+  }
+  st.state.store(IDLE, std::memory_order_release);
+  return 0;
+}
+
+void StallStackCapture::record(const std::string& worker,
+                               const Stack& stack,
+                               std::chrono::milliseconds stalled_for) {
+  aggregator().record(worker, stack, stalled_for);
+}
+
+std::vector<std::string> StallStackCapture::symbolize(const Stack& stack) {
+  return aggregator().symbolize(stack.frames);
+}
+
+std::vector<StallStackCapture::Entry> StallStackCapture::getEntries() {
+  return aggregator().getEntries();
+}
+
+void StallStackCapture::clear() {
+  aggregator().clear();
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,91 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+
+#include "logdevice/common/Timestamp.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Captures what a stalled worker thread is doing, for WatchDogThread.
+ *
+ *       capture() sends a signal to the worker. Its handler, running on the
+ *       stuck thread, unwinds the thread's stack and copies the RunContext
+ *       (Request, message or storage task response) the worker is running
+ *       and since when. The watchdog thread waits for the handler, then
+ *       record() symbolizes the stack and aggregates it with the other stalls
+ *       of the same context and stack, for the "info stalls" admin command.
+ *
+ *       A thread blocked in a system call is interrupted by the signal, the
+ *       stack then ends in that call; the call is restarted afterwards.
+ *
+ *       All methods are thread-safe, but captures are serialized.
+ */
+class StallStackCapture {
+ public:
+  struct Stack {
+    // RunContext::describe() of what the worker was running.
+    std::string context;
+    // How long the worker had been running it.
+    std::chrono::milliseconds running_for{0};
+    // Return addresses, leaf first.
+    std::vector<uintptr_t> frames;
+  };
+
+  /**
+   * Interrupts thread `tid` of this process and waits up to `timeout` for it
+   * to record its stack.
+   *
+   * @return 0 on success, -1 with err set to
+   *           TIMEDOUT  the thread didn't handle the signal in time, e.g.
+   *                     because it's blocked in an uninterruptible state,
+   *           NOTFOUND  there's no such thread.
+   */
+  static int capture(pid_t tid, std::chrono::milliseconds timeout, Stack* out);
+
+  /**
+   * Adds a captured stack to the aggregated stalls.
+   *
+   * @param worker      name of the stalled worker
+   * @param stalled_for how long the worker had been stalled so far
+   */
+  static void record(const std::string& worker,
+                     const Stack& stack,
+                     std::chrono::milliseconds stalled_for);
+
+  // Symbolized frames of a stack, leaf first.
+  static std::vector<std::string> symbolize(const Stack& stack);
+
+  struct Entry {
+    std::string context;
+    // Symbolized frames, leaf first.
+    std::vector<std::string> frames;
+    // Number of captures of this context and stack. A long stall is
+    // captured on every watchdog poll.
+    uint64_t captures;
+    // Longest time a worker was seen stalled and running for with this
+    // context and stack.
+    std::chrono::milliseconds max_stalled_for;
+    std::chrono::milliseconds max_running_for;
+    std::string last_worker;
+    SystemTimestamp last_seen;
+  };
+
+  // Aggregated stalls, most captured first.
+  static std::vector<Entry> getEntries();
+
+  static void clear();
+};
+
+}} // namespace facebook::logdevice
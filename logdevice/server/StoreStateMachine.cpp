@@ -226,6 +226,22 @@ Message::Disposition StoreStateMachine::onReceived(STORE_Message* msg,
     return Message::Disposition::NORMAL;
   }
 
+  // Cut-through chain sending: forward a copy right away rather than after
+  // the seal is known and the local write is queued, so that the next nodes
+  // don't wait for us.  They check seals themselves and reply to the
+  // Appender directly, and the local checks below only concern this node.
+  // Recovery and rebuilding stores keep the sequential path.
+  bool forwarded = false;
+  if ((msg->header_.flags & STORE_Header::CHAIN) &&
+      !(msg->header_.flags &
+        (STORE_Header::RECOVERY | STORE_Header::REBUILDING)) &&
+      msg->my_pos_in_copyset_ + 1 < msg->header_.copyset_size &&
+      Worker::settings().chain_sending_cut_through) {
+    forward(msg->copyForForwarding(), from);
+    STAT_INCR(stats, store_forwarded_cut_through);
+    forwarded = true;
+  }
+
   if (worker->processor_->isDataMissingFromShard(shard_idx)) {
     ld_debug("Got STORE %s from %s but shard %u is waiting for rebuilding",
              msg->header_.rid.toString().c_str(),
@@ -274,7 +290,8 @@ Message::Disposition StoreStateMachine::onReceived(STORE_Message* msg,
       std::unique_ptr<STORE_Message>(msg),
       from,
       start_time,
-      requested_sync ? Durability::SYNC_WRITE : default_durability);
+      requested_sync ? Durability::SYNC_WRITE : default_durability,
+      forwarded);
   sm->execute();
 
   // ownership was transferred
@@ -403,7 +420,7 @@ class StoreStateMachine::SoftSealStorageTask : public StorageTask {
     log_state->updateSeal(
         softseal_metadata.seal_, LogStorageState::SealType::SOFT);
 
-    RecordCache* cache = log_state->record_cache_.get();
+    RecordCache* cache = log_state->getOrCreateRecordCache();
     if (cache != nullptr) {
       cache->updateLastNonAuthoritativeEpoch(rid.logid);
     }
@@ -478,7 +495,7 @@ void StoreStateMachine::execute() {
             lsn_to_string(last_released_lsn.value()).c_str(),
             seq.toString().c_str());
 
-        log_state->purge_coordinator_->onReleaseMessage(
+        log_state->getPurgeCoordinator().onReleaseMessage(
             message_->header_.rid.lsn(), seq, ReleaseType::GLOBAL, true);
         message_->sendReply(E::DISABLED);
       } else if (MetaDataLog::isMetaDataLog(message_->header_.rid.logid)) {
@@ -517,11 +534,13 @@ StoreStateMachine::StoreStateMachine(
     std::unique_ptr<STORE_Message> message,
     Address from,
     std::chrono::steady_clock::time_point start_time,
-    Durability durability)
+    Durability durability,
+    bool forwarded)
     : message_(std::move(message)),
       from_(from),
       start_time_(start_time),
-      durability_(durability) {
+      durability_(durability),
+      forwarded_(forwarded) {
   ld_check(message_->header_.copyset_offset < message_->copyset_.size());
   shard_ =
       message_->copyset_[message_->header_.copyset_offset].destination.shard();
@@ -621,7 +640,7 @@ void StoreStateMachine::storeAndForward() {
   if (merge_mutable_per_epoch_log_metadata) {
     if (const LogStorageState* log_state =
             worker->processor_->getLogStorageStateMap().find(log_id, shard_)) {
-      if (const auto& record_cache = log_state->record_cache_) {
+      if (RecordCache* record_cache = log_state->getRecordCache()) {
         epoch_t epoch = header.rid.epoch;
         const auto& result = record_cache->getEpochRecordCache(epoch);
         if (result.first == RecordCache::Result::HIT &&
@@ -646,6 +665,16 @@ void StoreStateMachine::storeAndForward() {
     block_starting_lsn.assign(message_->block_starting_lsn_);
   }
 
+  PayloadCompressionOptions storage_compression;
+  if (log_config && log_config->attrs().storageCompression().hasValue()) {
+    storage_compression.compression =
+        log_config->attrs().storageCompression().value();
+    storage_compression.zstd_level =
+        worker_settings.storage_payload_compression_zstd_level;
+    storage_compression.min_size =
+        worker_settings.storage_payload_compression_min_size;
+  }
+
   // First create a storage task for the local log store.  The constructor
   // will copy any needed data from the parameters (as well as attach to the
   // PayloadHolder), making the task self-sufficient.  We'll
@@ -663,36 +692,13 @@ void StoreStateMachine::storeAndForward() {
       durability_,
       worker_settings.write_find_time_index,
       merge_mutable_per_epoch_log_metadata,
-      worker_settings.write_shard_id_in_copyset);
+      worker_settings.write_shard_id_in_copyset,
+      storage_compression);
 
   // Forward to next node in chain
-  if (header.flags & STORE_Header::CHAIN) {
-    if (message_->my_pos_in_copyset_ + 1 < header.copyset_size) {
-      ShardID next_dest =
-          message_->copyset_[message_->my_pos_in_copyset_ + 1].destination;
-
-      ld_debug("Forwarding a STORE %s that we got from %s to %s "
-               "(link #%d).",
-               header.rid.toString().c_str(),
-               Sender::describeConnection(from_).c_str(),
-               next_dest.toString().c_str(),
-               message_->my_pos_in_copyset_ + 1);
-
-      if (message_->my_pos_in_copyset_ == header.nsync) {
-        header.flags &= ~STORE_Header::SYNC;
-      }
-      header.copyset_offset = message_->my_pos_in_copyset_ + 1;
-      if (header.copyset_offset >= message_->extra_.first_amendable_offset) {
-        header.flags |= STORE_Header::AMEND;
-      }
-
-      int rv = worker->sender().sendMessage(
-          std::move(message_), next_dest.asNodeID());
-      if (rv != 0) {
-        // sendMessage() failed, we still own message_
-        message_->onForwardingFailure(err);
-      }
-    }
+  if ((header.flags & STORE_Header::CHAIN) && !forwarded_ &&
+      message_->my_pos_in_copyset_ + 1 < header.copyset_size) {
+    forward(std::move(message_), from_);
   }
 
   // At this point message_ may already be destroyed if we forwarded to the next
@@ -702,4 +708,34 @@ void StoreStateMachine::storeAndForward() {
   worker->getStorageTaskQueueForShard(shard_)->putTask(std::move(task));
 }
 
+void StoreStateMachine::forward(std::unique_ptr<STORE_Message> msg,
+                                const Address& from) {
+  auto& header = msg->header_;
+  ld_check(header.flags & STORE_Header::CHAIN);
+  ld_check(msg->my_pos_in_copyset_ + 1 < header.copyset_size);
+  ShardID next_dest = msg->copyset_[msg->my_pos_in_copyset_ + 1].destination;
+
+  ld_debug("Forwarding a STORE %s that we got from %s to %s "
+           "(link #%d).",
+           header.rid.toString().c_str(),
+           Sender::describeConnection(from).c_str(),
+           next_dest.toString().c_str(),
+           msg->my_pos_in_copyset_ + 1);
+
+  if (msg->my_pos_in_copyset_ == header.nsync) {
+    header.flags &= ~STORE_Header::SYNC;
+  }
+  header.copyset_offset = msg->my_pos_in_copyset_ + 1;
+  if (header.copyset_offset >= msg->extra_.first_amendable_offset) {
+    header.flags |= STORE_Header::AMEND;
+  }
+
+  int rv = ServerWorker::onThisThread()->sender().sendMessage(
+      std::move(msg), next_dest.asNodeID());
+  if (rv != 0) {
+    // sendMessage() failed, we still own msg
+    msg->onForwardingFailure(err);
+  }
+}
+
 }} // namespace facebook::logdevice
@@ -25,6 +25,10 @@ class STORE_Message;
  *          1. obtains the seal
  *          2. forwards the message if chain sending is requested
  *          3. writes the record to the local log store
+ *
+ *        With --chain-sending-cut-through, appends are instead forwarded as
+ *        soon as the message passed validation, and the seal is obtained and
+ *        the record stored in parallel with the rest of the chain.
  */
 
 class StoreStateMachine {
@@ -60,7 +64,8 @@ class StoreStateMachine {
   StoreStateMachine(std::unique_ptr<STORE_Message> message,
                     Address from,
                     std::chrono::steady_clock::time_point start_time,
-                    Durability durability);
+                    Durability durability,
+                    bool forwarded = false);
 
   ~StoreStateMachine();
 
@@ -76,14 +81,22 @@ class StoreStateMachine {
   class SoftSealStorageTask;
 
   // Forwards the record to the next node in chain (if chain sending is
-  // enabled) and stores it in the local log store.
+  // enabled and it wasn't forwarded already) and stores it in the local log
+  // store.
   void storeAndForward();
 
+  // Sends `msg' to the node after ours in its delivery chain, reporting
+  // E::FORWARD to the Appender on failure.
+  static void forward(std::unique_ptr<STORE_Message> msg, const Address& from);
+
   std::unique_ptr<STORE_Message> message_;
   shard_index_t shard_;
   Address from_; // sender of the STORE message
   std::chrono::steady_clock::time_point start_time_;
   Durability durability_;
+  // True if onReceived() already forwarded a copy of the message down the
+  // chain (cut-through).
+  const bool forwarded_;
 };
 
 }} // namespace facebook::logdevice
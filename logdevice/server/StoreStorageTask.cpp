@@ -7,7 +7,9 @@
  */
 #include "logdevice/server/StoreStorageTask.h"
 
+#include <algorithm>
 #include <initializer_list>
+#include <limits>
 
 #include <folly/Format.h>
 
@@ -43,12 +45,13 @@ StoreStorageTask::StoreStorageTask(
     Durability durability,
     bool write_find_time_index,
     bool merge_mutable_per_epoch_log_metadata,
-    bool write_shard_id_in_copyset)
+    bool write_shard_id_in_copyset,
+    PayloadCompressionOptions storage_compression)
     : WriteStorageTask(StorageTask::Type::STORE),
       payload_holder_(payload_holder),
       timestamp_(store_header.timestamp),
       lng_(store_header.last_known_good),
-      flags_(store_header.flags),
+      flags_(store_header.flags & ~STORE_Header::STAGE_TIMES),
       rid_(store_header.rid),
       wave_(store_header.wave),
       reply_to_(reply_to),
@@ -56,9 +59,11 @@ StoreStorageTask::StoreStorageTask(
       rebuilding_(store_header.flags & STORE_Header::REBUILDING),
       amend_copyset_(store_header.flags & STORE_Header::AMEND),
       drain_(store_header.flags & STORE_Header::DRAINING),
+      report_stage_times_(store_header.flags & STORE_Header::STAGE_TIMES),
       extra_(extra),
       start_time_(start_time),
       record_header_buf_({}),
+      local_flags_(maybeCompressPayload(store_header, storage_compression)),
       write_op_(
           store_header.rid.logid,
           compose_lsn(store_header.rid.epoch, store_header.rid.esn),
@@ -67,8 +72,10 @@ StoreStorageTask::StoreStorageTask(
                                                       &record_header_buf_,
                                                       write_shard_id_in_copyset,
                                                       optional_keys,
-                                                      extra_),
-          Slice(payload_holder_.getPayload()),
+                                                      extra_,
+                                                      local_flags_),
+          local_flags_ ? Slice::fromString(compressed_payload_buf_)
+                       : Slice(payload_holder_.getPayload()),
           rebuilding_ ? copyset[0].destination.node()
                       : (store_header.sequencer_node_id.isNodeID()
                              ? folly::make_optional(
@@ -128,6 +135,25 @@ StoreStorageTask::StoreStorageTask(
 
 StoreStorageTask::~StoreStorageTask() = default;
 
+LocalLogStoreRecordFormat::flags_t StoreStorageTask::maybeCompressPayload(
+    const STORE_Header& store_header,
+    const PayloadCompressionOptions& options) {
+  // Amends have no payload. BufferedWriter batches are usually compressed
+  // already and a second pass rarely gains anything.
+  if (store_header.flags &
+      (STORE_Header::AMEND | STORE_Header::HOLE |
+       STORE_Header::BUFFERED_WRITER_BLOB)) {
+    return 0;
+  }
+  const bool compressed =
+      LocalLogStoreRecordFormat::compressPayload(options.compression,
+                                                 options.zstd_level,
+                                                 options.min_size,
+                                                 payload_holder_.getPayload(),
+                                                 &compressed_payload_buf_);
+  return compressed ? LocalLogStoreRecordFormat::FLAG_PAYLOAD_COMPRESSED : 0;
+}
+
 LogStorageStateMap* StoreStorageTask::getLogStateMap() const {
   return &storageThreadPool_->getProcessor().getLogStorageStateMap();
 }
@@ -237,6 +263,13 @@ void StoreStorageTask::onDone() {
     STAT_INCR(worker->stats(), mutable_per_epoch_log_metadata_writes);
   }
 
+  if (status_ == E::OK && local_flags_) {
+    STAT_INCR(worker->stats(), records_stored_compressed);
+    STAT_ADD(worker->stats(),
+             storage_compression_bytes_saved,
+             payload_holder_.size() - compressed_payload_buf_.size());
+  }
+
   // Bump stat to trigger alarm if corruption was detected
   if (status_ == E::CHECKSUM_MISMATCH) {
     STAT_INCR(worker->stats(), payload_corruption);
@@ -251,6 +284,13 @@ void StoreStorageTask::onDone() {
   } else {
     PER_SHARD_HISTOGRAM_ADD(
         Worker::stats(), store_latency, getShardIdx(), usec_since(start_time_));
+    if (execution_start_time_.has_value() && execution_end_time_.has_value()) {
+      const StoreStageTimes stages = getStageTimes();
+      PER_SHARD_HISTOGRAM_ADD(
+          Worker::stats(), store_stage_queue, getShardIdx(), stages.queue_us);
+      PER_SHARD_HISTOGRAM_ADD(
+          Worker::stats(), store_stage_write, getShardIdx(), stages.write_us);
+    }
   }
 
   sendReply(status_);
@@ -317,20 +357,50 @@ void StoreStorageTask::sendReply(Status status) const {
     flags |= STORE_Header::OFFSET_MAP;
   }
 
+  StoreStageTimes stage_times;
+  if (report_stage_times_) {
+    flags |= STORED_Header::STAGE_TIMES;
+    stage_times = getStageTimes();
+  }
+
   STORED_Message::createAndSend(
       STORED_Header{rid_, wave_, status, seal_.seq_node, flags, getShardIdx()},
       reply_to_,
       extra_.rebuilding_version,
       extra_.rebuilding_wave,
       extra_.rebuilding_id,
-      flushToken_);
+      flushToken_,
+      ShardID(),
+      stage_times);
+}
+
+StoreStageTimes StoreStorageTask::getStageTimes() const {
+  using namespace std::chrono;
+  auto usec = [](steady_clock::duration d) {
+    return static_cast<uint32_t>(std::min<int64_t>(
+        std::max<int64_t>(0, duration_cast<microseconds>(d).count()),
+        std::numeric_limits<uint32_t>::max()));
+  };
+
+  StoreStageTimes stages;
+  // A store rejected before it got to a storage thread, e.g. dropped or
+  // preempted, only has a total.
+  if (execution_start_time_.has_value()) {
+    stages.queue_us = usec(execution_start_time_.value() - start_time_);
+    if (execution_end_time_.has_value()) {
+      stages.write_us =
+          usec(execution_end_time_.value() - execution_start_time_.value());
+    }
+  }
+  stages.total_us = usec(steady_clock::now() - start_time_);
+  return stages;
 }
 
 int StoreStorageTask::putCache() {
   // the write must have been succeeded
   ld_check(status_ == E::OK);
-  const auto& log_state = getLogStorageState();
-  RecordCache* cache = log_state.record_cache_.get();
+  auto& log_state = getLogStorageState();
+  RecordCache* cache = log_state.getOrCreateRecordCache();
   if (cache == nullptr) {
     // caching not enabled
     return -1;
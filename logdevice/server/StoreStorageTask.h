@@ -17,6 +17,8 @@
 #include "logdevice/common/CopySet.h"
 #include "logdevice/common/Metadata.h"
 #include "logdevice/common/RecordID.h"
+#include "logdevice/common/protocol/ProtocolWriter.h"
+#include "logdevice/common/protocol/STORED_Message.h"
 #include "logdevice/common/types_internal.h"
 #include "logdevice/include/Err.h"
 #include "logdevice/server/locallogstore/WriteOps.h"
@@ -43,6 +45,11 @@ class StoreStorageTask : public WriteStorageTask {
    * This needs to extract and make copies of parts of STORE message that it
    * needs to keep around (parts of header, copyset, reply address).  Assumes
    * shared ownership of the payload.
+   *
+   * @param storage_compression  how to compress the payload in the local log
+   *                             store, from the log's storage_compression
+   *                             attribute; see
+   *                             LocalLogStoreRecordFormat::compressPayload()
    */
   StoreStorageTask(const STORE_Header& store_header,
                    const StoreChainLink* copyset,
@@ -55,7 +62,9 @@ class StoreStorageTask : public WriteStorageTask {
                    Durability durability,
                    bool write_find_time_index,
                    bool merge_mutable_per_epoch_log_metadata,
-                   bool write_shard_id_in_copyset);
+                   bool write_shard_id_in_copyset,
+                   PayloadCompressionOptions storage_compression =
+                       PayloadCompressionOptions());
 
   ~StoreStorageTask() override;
 
@@ -131,6 +140,9 @@ class StoreStorageTask : public WriteStorageTask {
   // Convenience wrapper for STORED_Message_createAndSend
   void sendReply(Status status) const;
 
+  // How long this store spent in each stage so far, for the STORED reply.
+  StoreStageTimes getStageTimes() const;
+
   // called when the storage task is sent back to the worker thread,
   // in case record caching is on, free evicted cache entries previously
   // disposed on the same worker thread
@@ -140,6 +152,13 @@ class StoreStorageTask : public WriteStorageTask {
 
   LogStorageState& getLogStorageState();
 
+  // Compresses the payload into compressed_payload_buf_ if the options and
+  // the kind of record allow it. Returns FLAG_PAYLOAD_COMPRESSED if it did,
+  // 0 otherwise.
+  LocalLogStoreRecordFormat::flags_t
+  maybeCompressPayload(const STORE_Header& store_header,
+                       const PayloadCompressionOptions& options);
+
   // Shared ownership of the payload.  Note that all modifications (like
   // destruction) should happen on the worker thread.  The
   // storage thread should get just a raw pointer to the data.
@@ -160,6 +179,8 @@ class StoreStorageTask : public WriteStorageTask {
   bool amend_copyset_;
   bool drain_;
   bool soft_preempted_only_{false};
+  // the STORE asked for StoreStageTimes in the reply
+  bool report_stage_times_;
 
   // deadline after which the store operation is presumed to have timed out
   std::chrono::steady_clock::time_point task_deadline_;
@@ -180,6 +201,11 @@ class StoreStorageTask : public WriteStorageTask {
   // a Slice that points into this string.
   std::string copyset_index_entry_buf_;
 
+  // Payload as it will be written into the local log store, if it's stored
+  // compressed. See maybeCompressPayload().
+  std::string compressed_payload_buf_;
+  LocalLogStoreRecordFormat::flags_t local_flags_;
+
   PutWriteOp write_op_;
 
   // Mutable per-epoch metadata written/updated together with the record store.
@@ -9,6 +9,8 @@
 
 #include <signal.h>
 
+#include <folly/String.h>
+
 #include "logdevice/common/Processor.h"
 #include "logdevice/common/ThreadID.h"
 #include "logdevice/common/Worker.h"
@@ -16,9 +18,19 @@
 #include "logdevice/common/plugin/BacktraceRunner.h"
 #include "logdevice/common/plugin/PluginRegistry.h"
 #include "logdevice/common/stats/Stats.h"
+#include "logdevice/server/StallStackCapture.h"
 
 namespace facebook { namespace logdevice {
 
+namespace {
+
+// How long to wait for a stalled worker to handle the stack capture signal.
+constexpr std::chrono::milliseconds kStackCaptureTimeout{500};
+// Frames of a captured stack included in the log message.
+constexpr size_t kMaxLoggedFrames = 16;
+
+} // namespace
+
 WatchDogThread::WatchDogThread(Processor* p,
                                std::chrono::milliseconds poll_interval,
                                rate_limit_t bt_ratelimit)
@@ -42,6 +54,7 @@ void WatchDogThread::startRunning() {
 void WatchDogThread::detectStalls() {
   std::vector<int> stalled_worker_pids;
   std::vector<std::string> stalled_worker_names;
+  std::vector<std::chrono::milliseconds> stalled_worker_times;
   processor_->applyToWorkerPool(
       [&](Worker& w) {
         if (!w.isAcceptingWork()) {
@@ -70,6 +83,7 @@ void WatchDogThread::detectStalls() {
           stalled_worker_pids.push_back(w.getThreadId());
           stalled_worker_names.push_back(w.getName());
           total_stalled_time_ms_[idx] += poll_interval_ms_;
+          stalled_worker_times.push_back(total_stalled_time_ms_[idx]);
 
           ld_info("WatchDog found %s(tid:%d) stalled for %ld ms, old("
                   "posted:%zu, completed:%zu), new(posted:%zu, completed:%zu)",
@@ -108,6 +122,16 @@ void WatchDogThread::detectStalls() {
     STAT_ADD(
         processor_->stats_, num_stalled_workers, stalled_worker_pids.size());
 
+    if (processor_->settings()->watchdog_capture_stacks_on_stall) {
+      for (size_t i = 0;
+           i < stalled_worker_pids.size() && !processor_->isShuttingDown();
+           ++i) {
+        captureStack(stalled_worker_pids[i],
+                     stalled_worker_names[i],
+                     stalled_worker_times[i]);
+      }
+    }
+
     if (processor_->settings()->watchdog_print_bt_on_stall) {
       auto plugin =
           processor_->getPluginRegistry()->getSinglePlugin<BacktraceRunner>(
@@ -133,6 +157,37 @@ void WatchDogThread::detectStalls() {
   }
 }
 
+void WatchDogThread::captureStack(int tid,
+                                  const std::string& name,
+                                  std::chrono::milliseconds stalled_for) {
+  StallStackCapture::Stack stack;
+  if (StallStackCapture::capture(tid, kStackCaptureTimeout, &stack) != 0) {
+    ld_warning("Could not capture the stack of stalled worker %s(tid:%d): %s",
+               name.c_str(),
+               tid,
+               error_description(err));
+    return;
+  }
+  StallStackCapture::record(name, stack, stalled_for);
+
+  // Logged in full on the first poll of a stall only, later polls of the
+  // same stall are in "info stalls".
+  if (stalled_for <= poll_interval_ms_) {
+    std::vector<std::string> frames = StallStackCapture::symbolize(stack);
+    if (frames.size() > kMaxLoggedFrames) {
+      frames.resize(kMaxLoggedFrames);
+      frames.push_back("...");
+    }
+    ld_warning("Stalled worker %s(tid:%d) has been running %s for %ld ms, "
+               "stack: %s",
+               name.c_str(),
+               tid,
+               stack.context.c_str(),
+               stack.running_for.count(),
+               folly::join(" <- ", frames).c_str());
+  }
+}
+
 void WatchDogThread::run() {
   ThreadID::set(ThreadID::Type::UTILITY, "ld:watchdog");
 
@@ -10,6 +10,7 @@
 #include <chrono>
 #include <condition_variable>
 #include <mutex>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -70,6 +71,12 @@ class WatchDogThread {
   void run();
 
   void detectStalls();
+
+  // Captures the stack and RunContext of a stalled worker with
+  // StallStackCapture, aggregates it and logs it.
+  void captureStack(int tid,
+                    const std::string& name,
+                    std::chrono::milliseconds stalled_for);
 };
 
 }} // namespace facebook::logdevice
@@ -7,7 +7,9 @@
  */
 #include "logdevice/server/ZookeeperEpochStore.h"
 
+#include <algorithm>
 #include <cstring>
+#include <iterator>
 
 #include <boost/filesystem.hpp>
 #include <folly/Memory.h>
@@ -210,6 +212,10 @@ void ZookeeperEpochStore::provisionLogZnodes(
       for (const auto& res : results) {
         ld_check(completionStatus(res.rc_, zrq->logid_) == E::OK);
       }
+      if (useCache(*zrq)) {
+        // newly created znodes have version 0
+        cacheZnode(zrq->getZnodePath(), znode_value, 0);
+      }
     } else if (st == E::NOTFOUND) {
       // znode creation operation failed because the root znode was not found.
       if (settings_->zk_create_root_znodes) {
@@ -274,7 +280,8 @@ void ZookeeperEpochStore::onGetZnodeComplete(
     int rc,
     std::string value_from_zk,
     const zk::Stat& stat,
-    std::unique_ptr<ZookeeperEpochStoreRequest> zrq) {
+    std::unique_ptr<ZookeeperEpochStoreRequest> zrq,
+    bool from_cache) {
   ZookeeperEpochStoreRequest::NextStep next_step;
   bool do_provision = false;
   ld_check(zrq);
@@ -289,9 +296,19 @@ void ZookeeperEpochStore::onGetZnodeComplete(
   if (st == E::NOTFOUND) {
     // no znode exists, passing nullptr with length 0 to zrq
     value_for_zrq = nullptr;
+  } else if (!from_cache && useCache(*zrq)) {
+    cacheZnode(zrq->getZnodePath(), value_from_zk, stat.version_);
   }
 
   next_step = zrq->onGotZnodeValue(value_for_zrq, value_from_zk.size());
+  if (from_cache && next_step != ZookeeperEpochStoreRequest::NextStep::MODIFY) {
+    // A cached value is only good enough as the base of a conditional write,
+    // which fails if the value is stale. Any other outcome is reported to the
+    // caller as is, so it has to come from a fresh read.
+    zrq->rewind();
+    readZnode(std::move(zrq));
+    return;
+  }
   switch (next_step) {
     case ZookeeperEpochStoreRequest::NextStep::PROVISION:
       // continue with creation of new znodes
@@ -355,14 +372,34 @@ void ZookeeperEpochStore::onGetZnodeComplete(
       // number of znode on every write to that znode. If the versions do not
       // match zkSetCf() will be called with status ZBADVERSION. This ensures
       // that if our read-modify-write of znode_path succeeds, it was atomic.
-      std::shared_ptr<ZookeeperClientBase> zkclient = zkclient_.load();
-      auto cb = [this, req = std::move(zrq)](int res, zk::Stat) mutable {
+      const bool cached = useCache(*zrq);
+      auto cb = [this,
+                 req = std::move(zrq),
+                 cached,
+                 from_cache,
+                 znode_path,
+                 value = cached ? znode_value_str : std::string()](
+                    int res, zk::Stat new_stat) mutable {
+        if (cached) {
+          if (res == ZOK) {
+            cacheZnode(znode_path, std::move(value), new_stat.version_);
+          } else {
+            invalidateCachedZnode(znode_path);
+          }
+        }
+        if (from_cache && res == ZBADVERSION) {
+          // someone else wrote the znode since we cached it, start over
+          STAT_INCR(processor_->stats_, zookeeper_epoch_store_cache_stale);
+          req->rewind();
+          readZnode(std::move(req));
+          return;
+        }
         postRequestCompletion(res, std::move(req));
       };
-      zkclient->setData(std::move(znode_path),
-                        std::move(znode_value_str),
-                        std::move(cb),
-                        stat.version_);
+      writeZnode(std::move(znode_path),
+                 std::move(znode_value_str),
+                 stat.version_,
+                 std::move(cb));
       return;
     }
   }
@@ -400,14 +437,181 @@ int ZookeeperEpochStore::runRequest(
     std::unique_ptr<ZookeeperEpochStoreRequest> zrq) {
   ld_check(zrq);
 
+  if (useCache(*zrq)) {
+    folly::Optional<CachedZnode> cached =
+        lookupCachedZnode(zrq->getZnodePath());
+    if (cached.hasValue()) {
+      STAT_INCR(processor_->stats_, zookeeper_epoch_store_cache_hits);
+      zk::Stat stat;
+      stat.version_ = cached->version;
+      onGetZnodeComplete(ZOK,
+                         std::move(cached->value),
+                         stat,
+                         std::move(zrq),
+                         /* from_cache */ true);
+      return 0;
+    }
+  }
+
+  readZnode(std::move(zrq));
+  return 0;
+}
+
+void ZookeeperEpochStore::readZnode(
+    std::unique_ptr<ZookeeperEpochStoreRequest> zrq) {
   std::string znode_path = zrq->getZnodePath();
   std::shared_ptr<ZookeeperClientBase> zkclient = zkclient_.load();
   auto cb = [this, req = std::move(zrq)](
                 int rc, std::string value, zk::Stat stat) mutable {
-    onGetZnodeComplete(rc, std::move(value), stat, std::move(req));
+    onGetZnodeComplete(
+        rc, std::move(value), stat, std::move(req), /* from_cache */ false);
   };
   zkclient->getData(znode_path, std::move(cb));
-  return 0;
+}
+
+bool ZookeeperEpochStore::useCache(
+    const ZookeeperEpochStoreRequest& zrq) const {
+  return zrq.canRewind() && settings_->zk_epoch_store_metadata_cache;
+}
+
+folly::Optional<ZookeeperEpochStore::CachedZnode>
+ZookeeperEpochStore::lookupCachedZnode(const std::string& path) {
+  std::lock_guard<std::mutex> guard(znode_cache_mutex_);
+  auto it = znode_cache_.find(path);
+  if (it == znode_cache_.end()) {
+    return folly::none;
+  }
+  return it->second;
+}
+
+void ZookeeperEpochStore::cacheZnode(const std::string& path,
+                                     std::string value,
+                                     zk::version_t version) {
+  std::lock_guard<std::mutex> guard(znode_cache_mutex_);
+  CachedZnode& entry = znode_cache_[path];
+  entry.value = std::move(value);
+  entry.version = version;
+}
+
+void ZookeeperEpochStore::invalidateCachedZnode(const std::string& path) {
+  std::lock_guard<std::mutex> guard(znode_cache_mutex_);
+  znode_cache_.erase(path);
+}
+
+void ZookeeperEpochStore::writeZnode(std::string path,
+                                     std::string value,
+                                     zk::version_t version,
+                                     ZookeeperClientBase::stat_callback_t cb) {
+  if (settings_->zk_epoch_store_write_batch_size <= 1) {
+    std::shared_ptr<ZookeeperClientBase> zkclient = zkclient_.load();
+    zkclient->setData(
+        std::move(path), std::move(value), std::move(cb), version);
+    return;
+  }
+
+  std::vector<std::vector<PendingWrite>> batches;
+  {
+    std::lock_guard<std::mutex> guard(pending_writes_mutex_);
+    pending_writes_.push_back(PendingWrite{
+        std::move(path), std::move(value), version, std::move(cb)});
+    if (write_batches_in_flight_ > 0) {
+      // sent together with other queued writes in onWriteBatchDone()
+      return;
+    }
+    batches = takePendingWriteBatches();
+  }
+  for (auto& batch : batches) {
+    sendWriteBatch(std::move(batch));
+  }
+}
+
+std::vector<std::vector<ZookeeperEpochStore::PendingWrite>>
+ZookeeperEpochStore::takePendingWriteBatches() {
+  const size_t batch_size =
+      std::max<size_t>(settings_->zk_epoch_store_write_batch_size, 1);
+  std::vector<std::vector<PendingWrite>> batches;
+  for (size_t i = 0; i < pending_writes_.size(); i += batch_size) {
+    auto begin = pending_writes_.begin() + i;
+    auto end = pending_writes_.begin() +
+        std::min(i + batch_size, pending_writes_.size());
+    batches.emplace_back(
+        std::make_move_iterator(begin), std::make_move_iterator(end));
+  }
+  pending_writes_.clear();
+  write_batches_in_flight_ += batches.size();
+  return batches;
+}
+
+void ZookeeperEpochStore::sendWriteBatch(std::vector<PendingWrite> batch) {
+  ld_check(!batch.empty());
+  std::shared_ptr<ZookeeperClientBase> zkclient = zkclient_.load();
+
+  if (batch.size() == 1) {
+    PendingWrite& write = batch[0];
+    auto cb = [this, write_cb = std::move(write.cb)](
+                  int rc, zk::Stat stat) mutable {
+      write_cb(rc, stat);
+      onWriteBatchDone();
+    };
+    zkclient->setData(std::move(write.path),
+                      std::move(write.value),
+                      std::move(cb),
+                      write.version);
+    return;
+  }
+
+  STAT_INCR(processor_->stats_, zookeeper_epoch_store_write_batches);
+  STAT_ADD(processor_->stats_,
+           zookeeper_epoch_store_batched_writes,
+           batch.size());
+
+  std::vector<zk::Op> ops;
+  ops.reserve(batch.size());
+  for (const PendingWrite& write : batch) {
+    ops.emplace_back(
+        ZookeeperClientBase::makeSetOp(write.path, write.value, write.version));
+  }
+
+  auto cb = [this, batch = std::move(batch)](
+                int rc, std::vector<zk::OpResponse> results) mutable {
+    if (rc == ZOK) {
+      ld_check_eq(results.size(), batch.size());
+      for (size_t i = 0; i < batch.size(); ++i) {
+        batch[i].cb(results[i].rc_, results[i].stat_);
+      }
+    } else if (rc == ZBADVERSION || rc == ZNONODE) {
+      // One of the writes failed, so none of them were applied. Retry them
+      // one by one so that the others don't fail with it.
+      std::shared_ptr<ZookeeperClientBase> client = zkclient_.load();
+      for (PendingWrite& write : batch) {
+        client->setData(std::move(write.path),
+                        std::move(write.value),
+                        std::move(write.cb),
+                        write.version);
+      }
+    } else {
+      for (PendingWrite& write : batch) {
+        write.cb(rc, zk::Stat());
+      }
+    }
+    onWriteBatchDone();
+  };
+  zkclient->multiOp(std::move(ops), std::move(cb));
+}
+
+void ZookeeperEpochStore::onWriteBatchDone() {
+  std::vector<std::vector<PendingWrite>> batches;
+  {
+    std::lock_guard<std::mutex> guard(pending_writes_mutex_);
+    ld_check(write_batches_in_flight_ > 0);
+    if (--write_batches_in_flight_ > 0) {
+      return;
+    }
+    batches = takePendingWriteBatches();
+  }
+  for (auto& batch : batches) {
+    sendWriteBatch(std::move(batch));
+  }
 }
 
 void ZookeeperEpochStore::onConfigUpdate() {
@@ -435,6 +639,10 @@ void ZookeeperEpochStore::onConfigUpdate() {
     return;
   }
   zkclient_.store(zkclient);
+
+  // The new quorum may not have the same znode versions.
+  std::lock_guard<std::mutex> guard(znode_cache_mutex_);
+  znode_cache_.clear();
 }
 
 int ZookeeperEpochStore::getLastCleanEpoch(logid_t logid, CompletionLCE cf) {
@@ -9,7 +9,10 @@
 
 #include <chrono>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <boost/noncopyable.hpp>
 #include <folly/Optional.h>
@@ -32,6 +35,13 @@
 /**
  * @file ZookeeperEpochStore implements an EpochStore interface to a
  *       Zookeeper-based epoch store.
+ *
+ *       Two settings cut the number of Zookeeper round trips when many logs
+ *       are updated at once, e.g. when a node activates all its sequencers:
+ *       --zk-epoch-store-metadata-cache lets updates of epoch metadata skip
+ *       the read of their read-modify-write, and
+ *       --zk-epoch-store-write-batch-size sends writes of different logs
+ *       together in multi-ops.
  */
 
 namespace facebook { namespace logdevice {
@@ -160,6 +170,29 @@ class ZookeeperEpochStore : public EpochStore, boost::noncopyable {
   // ZookeeperClientFactory to create ZookeeperClient
   std::shared_ptr<ZookeeperClientFactory> zkFactory_;
 
+  struct CachedZnode {
+    std::string value;
+    zk::version_t version;
+  };
+
+  // Last known value and version of the znodes of requests that
+  // canRewind(), keyed by path. Only used with
+  // --zk-epoch-store-metadata-cache.
+  std::unordered_map<std::string, CachedZnode> znode_cache_;
+  std::mutex znode_cache_mutex_;
+
+  struct PendingWrite {
+    std::string path;
+    std::string value;
+    zk::version_t version;
+    ZookeeperClientBase::stat_callback_t cb;
+  };
+
+  // Writes waiting for the batches in flight to complete, see writeZnode().
+  std::vector<PendingWrite> pending_writes_;
+  size_t write_batches_in_flight_{0};
+  std::mutex pending_writes_mutex_;
+
   /**
    * Run a zoo_aget() on a znode, optionally followed by a modify and a
    * version-conditional zoo_aset() of a new value into the same znode.
@@ -173,6 +206,39 @@ class ZookeeperEpochStore : public EpochStore, boost::noncopyable {
    */
   int runRequest(std::unique_ptr<ZookeeperEpochStoreRequest> zrq);
 
+  /**
+   * Fetches the znode of `zrq' from Zookeeper and continues with
+   * onGetZnodeComplete(). runRequest() does this unless the znode is cached.
+   */
+  void readZnode(std::unique_ptr<ZookeeperEpochStoreRequest> zrq);
+
+  // true if the znode of `zrq' may be served from and kept in znode_cache_
+  bool useCache(const ZookeeperEpochStoreRequest& zrq) const;
+
+  folly::Optional<CachedZnode> lookupCachedZnode(const std::string& path);
+  void cacheZnode(const std::string& path,
+                  std::string value,
+                  zk::version_t version);
+  void invalidateCachedZnode(const std::string& path);
+
+  /**
+   * Version-conditional write of a znode. With
+   * --zk-epoch-store-write-batch-size, writes made while others are in
+   * flight are queued and sent together once those complete.
+   */
+  void writeZnode(std::string path,
+                  std::string value,
+                  zk::version_t version,
+                  ZookeeperClientBase::stat_callback_t cb);
+
+  // Splits pending_writes_ into batches and counts them as in flight.
+  // pending_writes_mutex_ must be held.
+  std::vector<std::vector<PendingWrite>> takePendingWriteBatches();
+
+  void sendWriteBatch(std::vector<PendingWrite> batch);
+
+  void onWriteBatchDone();
+
   // Callback invoked when the config has changed.  Checks if the Zookeper
   // quorum changed; if so, creates a new ZookeperClient.
   void onConfigUpdate();
@@ -186,11 +252,15 @@ class ZookeeperEpochStore : public EpochStore, boost::noncopyable {
 
   /**
    * The callback executed when a znode has been fetched.
+   *
+   * @param from_cache  true if value and stat came from znode_cache_ rather
+   *                    than from Zookeeper
    */
   void onGetZnodeComplete(int rc,
                           std::string value,
                           const zk::Stat& stat,
-                          std::unique_ptr<ZookeeperEpochStoreRequest> zrq);
+                          std::unique_ptr<ZookeeperEpochStoreRequest> zrq,
+                          bool from_cache);
 
   /**
    * Provisions znodes for a log that a particular zrq runs on. Executes
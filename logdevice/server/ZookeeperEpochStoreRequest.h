@@ -103,6 +103,23 @@ class ZookeeperEpochStoreRequest {
    */
   virtual int composeZnodeValue(char* buf, size_t size) = 0;
 
+  /**
+   * @return true if rewind() is supported. ZookeeperEpochStore may then start
+   *         the request from a cached znode value and, if that value turns
+   *         out to be stale, run it again from a fresh read.
+   */
+  virtual bool canRewind() const {
+    return false;
+  }
+
+  /**
+   * Undoes the effects of onGotZnodeValue(), so that it can be called again
+   * with another value.
+   */
+  virtual void rewind() {
+    ld_check(false);
+  }
+
   // EpochStore that created this ZookeeperEpochStoreRequest
   ZookeeperEpochStore* const store_;
 
@@ -29,13 +29,16 @@
 #include "logdevice/server/admincommands/InfoBoycotts.h"
 #include "logdevice/server/admincommands/InfoCatchupQueues.h"
 #include "logdevice/server/admincommands/InfoClientReadStreams.h"
+#include "logdevice/server/admincommands/InfoClientResources.h"
 #include "logdevice/server/admincommands/InfoConfig.h"
 #include "logdevice/server/admincommands/InfoEventLog.h"
+#include "logdevice/server/admincommands/InfoEventLoops.h"
 #include "logdevice/server/admincommands/InfoGossip.h"
 #include "logdevice/server/admincommands/InfoGraylist.h"
 #include "logdevice/server/admincommands/InfoIterators.h"
 #include "logdevice/server/admincommands/InfoLogsConfigRsm.h"
 #include "logdevice/server/admincommands/InfoLogsDBMetadata.h"
+#include "logdevice/server/admincommands/InfoMemory.h"
 #include "logdevice/server/admincommands/InfoPartitions.h"
 #include "logdevice/server/admincommands/InfoPurges.h"
 #include "logdevice/server/admincommands/InfoReaders.h"
@@ -51,6 +54,8 @@
 #include "logdevice/server/admincommands/InfoShardOperationalState.h"
 #include "logdevice/server/admincommands/InfoShards.h"
 #include "logdevice/server/admincommands/InfoSockets.h"
+#include "logdevice/server/admincommands/InfoStalls.h"
+#include "logdevice/server/admincommands/InfoStorageTaskIO.h"
 #include "logdevice/server/admincommands/InfoStorageTasks.h"
 #include "logdevice/server/admincommands/InfoStoredLogs.h"
 #include "logdevice/server/admincommands/InfoSyncSequencerRequests.h"
@@ -62,6 +67,7 @@
 #include "logdevice/server/admincommands/Partitions.h"
 #include "logdevice/server/admincommands/PauseOrUnpauseFileEpochStore.h"
 #include "logdevice/server/admincommands/PrintLogsDBDirectories.h"
+#include "logdevice/server/admincommands/ProfileCpu.h"
 #include "logdevice/server/admincommands/RSMTrim.h"
 #include "logdevice/server/admincommands/RSMWriteSnapshot.h"
 #include "logdevice/server/admincommands/Rebuilding.h"
@@ -69,6 +75,7 @@
 #include "logdevice/server/admincommands/Setting.h"
 #include "logdevice/server/admincommands/StartRecovery.h"
 #include "logdevice/server/admincommands/Stats.h"
+#include "logdevice/server/admincommands/StatsCpuTime.h"
 #include "logdevice/server/admincommands/StatsHistogram.h"
 #include "logdevice/server/admincommands/StatsJemalloc.h"
 #include "logdevice/server/admincommands/StatsRocks.h"
@@ -112,12 +119,14 @@ AdminCommandFactory::AdminCommandFactory() {
   selector_.add<commands::InfoCatchupQueues>("info catchup_queues");
   selector_.add<commands::InfoClientReadStreams>("info client_read_streams");
   selector_.add<commands::InfoEventLog>("info event_log");
+  selector_.add<commands::InfoEventLoops>("info event_loops");
   selector_.add<commands::InfoLogsConfigRsm>("info logsconfig_rsm");
   selector_.add<commands::InfoRecoveries>("info recoveries");
   selector_.add<commands::InfoPurges>("info purges");
   selector_.add<commands::InfoRecord>("info record");
   selector_.add<commands::InfoPartitions>("info partitions");
   selector_.add<commands::InfoLogsDBMetadata>("info logsdb metadata");
+  selector_.add<commands::InfoMemory>("info memory");
   selector_.add<commands::InfoWriteMetaDataRecord>(
       "info write_metadata_record");
   selector_.add<commands::InfoRsm>("info rsm");
@@ -130,6 +139,9 @@ AdminCommandFactory::AdminCommandFactory() {
   selector_.add<commands::InfoSettings>("info settings");
   selector_.add<commands::InfoRecordCache>("info record_cache");
   selector_.add<commands::InfoStorageTasks>("info storage_tasks");
+  selector_.add<commands::InfoStorageTaskIO>("info storage_task_io");
+  selector_.add<commands::InfoStalls>("info stalls");
+  selector_.add<commands::InfoClientResources>("info client_resources");
   selector_.add<commands::InfoStoredLogs>("info stored_logs");
   selector_.add<commands::InfoReplication>("info replication");
   selector_.add<commands::InfoShardOperationalState>("info shardopstate");
@@ -166,8 +178,14 @@ AdminCommandFactory::AdminCommandFactory() {
   selector_.add<commands::StoreTimeoutHistogram>("stats2 store_timeouts");
 
   selector_.add<commands::StatsThroughput>("stats throughput");
+  selector_.add<commands::StatsCpuTime>("stats cpu_time");
   selector_.add<commands::StatsCustomCounters>("stats custom counters");
 
+  selector_.add<commands::ProfileCpu>("profile cpu");
+  selector_.add<commands::ProfileCpuStart>("profile cpu start");
+  selector_.add<commands::ProfileCpuStop>("profile cpu stop");
+  selector_.add<commands::ProfileCpuStatus>("profile cpu status");
+
 #ifdef LOGDEVICE_USING_JEMALLOC
   selector_.add<commands::StatsJemalloc>("stats jemalloc");
   selector_.add<commands::StatsJemallocFull>("stats jemalloc full");
@@ -0,0 +1,123 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include "logdevice/common/AdminCommandTable.h"
+#include "logdevice/server/ClientResourceUsage.h"
+#include "logdevice/server/admincommands/AdminCommand.h"
+
+namespace facebook { namespace logdevice { namespace commands {
+
+/**
+ * Rates at which the top principals or client hosts use the resources of
+ * this node, see getTopClientResourceUsage(). Requires
+ * --per-client-stats-top-k.
+ */
+class InfoClientResources : public AdminCommand {
+  using AdminCommand::AdminCommand;
+
+ private:
+  std::string by_ = "principal";
+  uint32_t interval_sec_ = 60;
+  std::string sort_ = "read_bytes";
+  size_t top_ = 0;
+  bool json_ = false;
+
+ public:
+  using InfoClientResourcesTable =
+      AdminCommandTable<std::string, // By
+                        std::string, // Name
+                        double,      // Read bytes/s
+                        double,      // Records read/s
+                        double,      // Storage task usec/s
+                        double,      // Append bytes/s
+                        double       // Connections/s
+                        >;
+
+  void getOptions(boost::program_options::options_description& opts) override {
+    opts.add_options()("by",
+                       boost::program_options::value<std::string>(&by_)
+                           ->default_value(by_),
+                       "'principal' or 'client'")(
+        "interval",
+        boost::program_options::value<uint32_t>(&interval_sec_)
+            ->default_value(interval_sec_),
+        "Seconds over which to calculate rates, at most 600")(
+        "sort",
+        boost::program_options::value<std::string>(&sort_)->default_value(
+            sort_),
+        "Resource to sort by")("top",
+                               boost::program_options::value<size_t>(&top_),
+                               "Only print this many heaviest users")(
+        "json", boost::program_options::bool_switch(&json_));
+  }
+
+  std::string getUsage() override {
+    return "info client_resources [--by=principal|client] "
+           "[--interval=<seconds>] [--sort=<resource>] [--top=<n>] [--json]";
+  }
+
+  void run() override {
+    PerClientHeavyHitters::Dimension dimension;
+    if (by_ == "principal") {
+      dimension = PerClientHeavyHitters::PRINCIPAL;
+    } else if (by_ == "client") {
+      dimension = PerClientHeavyHitters::CLIENT;
+    } else {
+      out_.printf("Invalid --by '%s'\r\n", by_.c_str());
+      return;
+    }
+    folly::Optional<ClientResource> sort_by;
+    for (size_t r = 0; r < static_cast<size_t>(ClientResource::MAX); ++r) {
+      if (sort_ == clientResourceName(static_cast<ClientResource>(r))) {
+        sort_by = static_cast<ClientResource>(r);
+      }
+    }
+    if (!sort_by) {
+      out_.printf("Invalid --sort '%s'\r\n", sort_.c_str());
+      return;
+    }
+
+    StatsHolder* stats = server_->getParameters()->getStats();
+    if (!stats || stats->params_.get()->per_client_stats_top_k == 0) {
+      out_.printf("Per-client stats are disabled, see "
+                  "--per-client-stats-top-k\r\n");
+      return;
+    }
+
+    InfoClientResourcesTable table(!json_,
+                                   "By",
+                                   "Name",
+                                   "Read bytes/s",
+                                   "Records read/s",
+                                   "Storage task usec/s",
+                                   "Append bytes/s",
+                                   "Connections/s");
+    auto usage = getTopClientResourceUsage(
+        stats, dimension, std::chrono::seconds(interval_sec_), *sort_by);
+    if (top_ > 0 && usage.size() > top_) {
+      usage.resize(top_);
+    }
+    auto rate = [](const ClientResourceUsage& u, ClientResource r) {
+      return u.rates[static_cast<size_t>(r)];
+    };
+    for (const auto& u : usage) {
+      table.next()
+          .set<0>(by_)
+          .set<1>(u.name)
+          .set<2>(rate(u, ClientResource::read_bytes))
+          .set<3>(rate(u, ClientResource::records_read))
+          .set<4>(rate(u, ClientResource::storage_task_usec))
+          .set<5>(rate(u, ClientResource::append_bytes))
+          .set<6>(rate(u, ClientResource::connections));
+    }
+    json_ ? table.printJson(out_) : table.print(out_);
+  }
+};
+
+}}} // namespace facebook::logdevice::commands
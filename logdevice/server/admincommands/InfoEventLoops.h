@@ -0,0 +1,133 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include "logdevice/common/AdminCommandTable.h"
+#include "logdevice/common/EventLoop.h"
+#include "logdevice/common/Worker.h"
+#include "logdevice/common/request_util.h"
+#include "logdevice/server/admincommands/AdminCommand.h"
+
+namespace facebook { namespace logdevice { namespace commands {
+
+/**
+ * Per worker: the number of requests dequeued per event loop iteration, the
+ * pending requests by priority, percentiles of the time spent on the rest of
+ * the loop while requests were pending and of the time spent running them,
+ * the busy-poll duration and percentiles of the time requests spent queued.
+ */
+class InfoEventLoops : public AdminCommand {
+  using AdminCommand::AdminCommand;
+
+ private:
+  bool json_ = false;
+
+  struct Row {
+    std::string worker;
+    int64_t target_us;
+    uint32_t budget;
+    size_t queued[EventLoopTaskQueue::kNumberOfPriorities];
+    int64_t loop_delay_us[3];
+    int64_t batch_time_us[3];
+    int64_t busy_poll_us;
+    int64_t queue_latency_us[3];
+  };
+
+ public:
+  using InfoEventLoopsTable = AdminCommandTable<std::string, // Worker
+                                                int64_t,     // Target latency
+                                                uint32_t,    // Budget
+                                                size_t,      // Queued HI_PRI
+                                                size_t,      // Queued MID_PRI
+                                                size_t,      // Queued LO_PRI
+                                                int64_t,     // Loop delay p50
+                                                int64_t,     // Loop delay p99
+                                                int64_t,     // Loop delay max
+                                                int64_t,     // Batch time p50
+                                                int64_t,     // Batch time p99
+                                                int64_t,     // Batch time max
+                                                int64_t,     // Busy poll
+                                                int64_t,     // Queue lat. p50
+                                                int64_t,     // Queue lat. p99
+                                                int64_t      // Queue lat. max
+                                                >;
+
+  void getOptions(boost::program_options::options_description& opts) override {
+    opts.add_options()("json", boost::program_options::bool_switch(&json_));
+  }
+
+  std::string getUsage() override {
+    return "info event_loops [--json]";
+  }
+
+  void run() override {
+    auto get_row = []() -> Row {
+      Worker* w = Worker::onThisThread();
+      EventLoop* ev = checked_downcast<EventLoop*>(w->getExecutor());
+      const EventLoopTaskQueue& q = ev->getTaskQueue();
+      static const double percentiles[] = {.5, .99, 1};
+      Row row;
+      row.worker = w->getName();
+      row.target_us = q.getTargetIterationLatency().count();
+      row.budget = q.getDequeueBudget();
+      row.queued[0] = q.getQueueSize(folly::Executor::HI_PRI);
+      row.queued[1] = q.getQueueSize(folly::Executor::MID_PRI);
+      row.queued[2] = q.getQueueSize(folly::Executor::LO_PRI);
+      q.getLoopDelayHistogram().estimatePercentiles(
+          percentiles, 3, row.loop_delay_us);
+      q.getBatchTimeHistogram().estimatePercentiles(
+          percentiles, 3, row.batch_time_us);
+      row.busy_poll_us = ev->getBusyPoll().count();
+      w->getQueueLatencyHistogram().estimatePercentiles(
+          percentiles, 3, row.queue_latency_us);
+      return row;
+    };
+
+    InfoEventLoopsTable table(!json_,
+                              "Worker",
+                              "Target latency us",
+                              "Budget",
+                              "Queued HI_PRI",
+                              "Queued MID_PRI",
+                              "Queued LO_PRI",
+                              "Loop delay p50 us",
+                              "Loop delay p99 us",
+                              "Loop delay max us",
+                              "Batch time p50 us",
+                              "Batch time p99 us",
+                              "Batch time max us",
+                              "Busy poll us",
+                              "Queue latency p50 us",
+                              "Queue latency p99 us",
+                              "Queue latency max us");
+    const auto rows = run_on_all_workers(server_->getProcessor(), get_row);
+    for (const Row& row : rows) {
+      table.next()
+          .set<0>(row.worker)
+          .set<1>(row.target_us)
+          .set<2>(row.budget)
+          .set<3>(row.queued[0])
+          .set<4>(row.queued[1])
+          .set<5>(row.queued[2])
+          .set<6>(row.loop_delay_us[0])
+          .set<7>(row.loop_delay_us[1])
+          .set<8>(row.loop_delay_us[2])
+          .set<9>(row.batch_time_us[0])
+          .set<10>(row.batch_time_us[1])
+          .set<11>(row.batch_time_us[2])
+          .set<12>(row.busy_poll_us)
+          .set<13>(row.queue_latency_us[0])
+          .set<14>(row.queue_latency_us[1])
+          .set<15>(row.queue_latency_us[2]);
+    }
+
+    json_ ? table.printJson(out_) : table.print(out_);
+  }
+};
+
+}}} // namespace facebook::logdevice::commands
@@ -52,7 +52,11 @@ class InfoIterators : public AdminCommand {
                              "More context",
                              "Last seek LSN",
                              "Last seek timestamp",
-                             "Version");
+                             "Version",
+                             "RocksDB iterators created",
+                             "RocksDB iterators reused",
+                             "Creations per minute",
+                             "Pinned bytes");
 
     auto info = IteratorTracker::get()->getDebugInfo();
 
@@ -68,6 +72,8 @@ class InfoIterators : public AdminCommand {
           return "PARTITIONED";
         case TrackableIterator::IteratorType::PARTITIONED_ALL_LOGS:
           return "PARTITIONED_ALL_LOGS";
+        case TrackableIterator::IteratorType::POOLED:
+          return "POOLED";
       }
       ld_check(false);
       return std::string();
@@ -91,6 +97,18 @@ class InfoIterators : public AdminCommand {
             .set<10>(row.mut.last_seek_time)
             .set<11>(row.mut.last_seek_version);
       }
+      if (row.mut.rocksdb_iterators_created + row.mut.rocksdb_iterators_reused >
+          0) {
+        // Rate over the lifetime of the iterator, at least a second long.
+        const auto age = std::max<std::chrono::milliseconds>(
+            RecordTimestamp::now() - row.imm.created, std::chrono::seconds(1));
+        table.set<12>(row.mut.rocksdb_iterators_created)
+            .set<13>(row.mut.rocksdb_iterators_reused)
+            .set<14>(row.mut.rocksdb_iterators_created * 60000.0 / age.count());
+      }
+      if (row.imm.type == TrackableIterator::IteratorType::POOLED) {
+        table.set<15>(row.mut.pinned_bytes);
+      }
     }
 
     json_ ? table.printJson(out_) : table.print(out_);
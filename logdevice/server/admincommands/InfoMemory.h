@@ -0,0 +1,124 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <rocksdb/cache.h>
+
+#include "logdevice/common/AdminCommandTable.h"
+#include "logdevice/common/request_util.h"
+#include "logdevice/common/stats/Stats.h"
+#include "logdevice/server/RealTimeRecordBuffer.h"
+#include "logdevice/server/ServerWorker.h"
+#include "logdevice/server/admincommands/AdminCommand.h"
+#include "logdevice/server/fatalsignal.h"
+#include "logdevice/server/read_path/AllServerReadStreams.h"
+
+namespace facebook { namespace logdevice { namespace commands {
+
+/**
+ * Memory used by the main consumers of memory on this node, next to their
+ * configured limits where there is one. Per-worker consumers are summed over
+ * all GENERAL workers.
+ */
+class InfoMemory : public AdminCommand {
+  using AdminCommand::AdminCommand;
+
+ private:
+  bool json_ = false;
+
+ public:
+  using InfoMemoryTable = AdminCommandTable<std::string, // Consumer
+                                            uint64_t,    // Used bytes
+                                            uint64_t     // Limit bytes
+                                            >;
+
+  void getOptions(boost::program_options::options_description& opts) override {
+    opts.add_options()("json", boost::program_options::bool_switch(&json_));
+  }
+
+  std::string getUsage() override {
+    return "info memory [--json]";
+  }
+
+  void run() override {
+    InfoMemoryTable table(!json_, "Consumer", "Used bytes", "Limit bytes");
+
+    auto add_cache = [&](const char* name,
+                         const std::weak_ptr<rocksdb::Cache>& weak_cache) {
+      auto cache = weak_cache.lock();
+      if (cache) {
+        table.next()
+            .set<0>(name)
+            .set<1>(cache->GetUsage())
+            .set<2>(cache->GetCapacity());
+      }
+    };
+    add_cache("rocksdb_block_cache", g_rocksdb_caches.block_cache);
+    add_cache("rocksdb_block_cache_compressed",
+              g_rocksdb_caches.block_cache_compressed);
+    add_cache(
+        "rocksdb_metadata_block_cache", g_rocksdb_caches.metadata_block_cache);
+
+    const auto& settings = server_->getParameters()->getProcessorSettings();
+    StatsHolder* stats = server_->getParameters()->getStats();
+    if (stats) {
+      table.next()
+          .set<0>("record_cache")
+          .set<1>(stats->aggregate().record_cache_bytes_cached_estimate);
+      if (settings->record_cache_max_size > 0) {
+        // 0 means unlimited
+        table.set<2>(settings->record_cache_max_size);
+      }
+    }
+
+    struct WorkerUsage {
+      uint64_t read_tasks_used;
+      uint64_t read_tasks_limit;
+      uint64_t real_time_used;
+      uint64_t real_time_limit;
+      uint64_t outbufs_used;
+    };
+    auto usages = run_on_worker_pool(
+        server_->getProcessor(), WorkerType::GENERAL, []() {
+          ServerWorker* w = ServerWorker::onThisThread();
+          auto& streams = w->serverReadStreams();
+          auto& budget = streams.getMemoryBudget();
+          auto& real_time = streams.getRealTimeRecordBuffer();
+          return WorkerUsage{budget.used(),
+                             budget.getLimit(),
+                             real_time.getBytes(),
+                             real_time.getMaxBytes(),
+                             w->sender().getBytesPending()};
+        });
+    WorkerUsage total{0, 0, 0, 0, 0};
+    for (const auto& u : usages) {
+      total.read_tasks_used += u.read_tasks_used;
+      total.read_tasks_limit += u.read_tasks_limit;
+      total.real_time_used += u.real_time_used;
+      total.real_time_limit += u.real_time_limit;
+      total.outbufs_used += u.outbufs_used;
+    }
+    table.next()
+        .set<0>("read_storage_tasks")
+        .set<1>(total.read_tasks_used)
+        .set<2>(total.read_tasks_limit);
+    table.next()
+        .set<0>("real_time_record_buffer")
+        .set<1>(total.real_time_used)
+        .set<2>(total.real_time_limit);
+    table.next()
+        .set<0>("socket_outbufs")
+        .set<1>(total.outbufs_used)
+        .set<2>(uint64_t(settings->outbufs_mb_max_per_thread) * 1024 * 1024 *
+                usages.size());
+
+    json_ ? table.printJson(out_) : table.print(out_);
+  }
+};
+
+}}} // namespace facebook::logdevice::commands
@@ -85,6 +85,15 @@ class InfoPartitions : public AdminCommand {
                               "Append Dirtied By",
                               "Rebuild Dirtied By",
                               "Under Replicated",
+                              "Tier",
+                              "Offloaded Bytes",
+                              "IO Reads",
+                              "IO Read Bytes",
+                              "IO Read p50 us",
+                              "IO Read p99 us",
+                              "IO Writes",
+                              "IO Write Bytes",
+                              "IO Write p99 us",
                               // Level 2
                               "Approx. Obsolete Bytes");
 
@@ -176,18 +185,35 @@ class InfoPartitions : public AdminCommand {
             PartitionDirtyMetadata meta = partition->dirty_state_.metadata();
             table.set<19>(toString(meta.getDirtiedBy(DataClass::APPEND)))
                 .set<20>(toString(meta.getDirtiedBy(DataClass::REBUILD)))
-                .set<21>(partition->isUnderReplicated());
+                .set<21>(partition->isUnderReplicated())
+                .set<22>(PartitionedRocksDBStore::partitionTierName(
+                    partitioned_store->getPartitionTier(partition)))
+                .set<23>(partition->offloaded_bytes.load());
+
+            const IOStats& io = *partition->io_stats;
+            const double percentiles[] = {.5, .99};
+            int64_t read_latency[2];
+            int64_t write_latency[2];
+            io.read_latency.estimatePercentiles(percentiles, 2, read_latency);
+            io.write_latency.estimatePercentiles(percentiles, 2, write_latency);
+            table.set<24>(io.reads.load())
+                .set<25>(io.read_bytes.load())
+                .set<26>(read_latency[0])
+                .set<27>(read_latency[1])
+                .set<28>(io.writes.load())
+                .set<29>(io.write_bytes.load())
+                .set<30>(write_latency[1]);
           }
 
           if (level_ >= 2) {
-            table.set<22>(
+            table.set<31>(
                 partitioned_store->getApproximateObsoleteBytes(partition->id_));
           }
         }
       }
     }
 
-    constexpr std::array<int, maxLevel() + 1> num_stats_per_level = {8, 14, 1};
+    constexpr std::array<int, maxLevel() + 1> num_stats_per_level = {8, 23, 1};
     static_assert(table.numCols() ==
                       num_stats_per_level[0] + num_stats_per_level[1] +
                           num_stats_per_level[2],
@@ -114,7 +114,16 @@ class InfoReaders : public AdminCommand {
                            "ReadShaping(Meter Level)",
                            "CSID",
                            "RSID",
-                           "TCP sndbuf");
+                           "TCP sndbuf",
+                           "Readahead size",
+                           "Read amplification",
+                           "Result cache hits",
+                           "Result cache misses",
+                           "Filter selectivity",
+                           "Batch size",
+                           "Principal",
+                           "Records sent",
+                           "Record bytes sent");
 
     auto tables = run_on_all_workers(server_->getProcessor(), [&]() {
       InfoReadersTable t(table);
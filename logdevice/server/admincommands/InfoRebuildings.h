@@ -54,7 +54,13 @@ class InfoRebuildingShards : public AdminCommand {
                                     "Read buffer bytes",         // 12
                                     "Records in flight",         // 13
                                     "Read pointer",              // 14
-                                    "Progress");                 // 15
+                                    "Progress",                  // 15
+                                    "Read pass",                 // 16
+                                    "Bytes read",                // 17
+                                    "Restart wasted bytes",      // 18
+                                    "Bytes left to read",        // 19
+                                    "Bytes left to rebuild",     // 20
+                                    "ETA");                      // 21
 
     auto workerType = EventLogStateMachine::workerType(server->getProcessor());
     auto workerIdx = EventLogStateMachine::getWorkerIdx(
@@ -81,7 +81,9 @@ class InfoRecordCache : public AdminCommand {
                                "tail_record_ts");
 
     auto process_one = [&](logid_t /*logid*/, const LogStorageState& state) {
-      state.record_cache_->getDebugInfo(table);
+      if (RecordCache* cache = state.getRecordCache()) {
+        cache->getDebugInfo(table);
+      }
       return 0;
     };
 
@@ -42,7 +42,9 @@ typedef AdminCommandTable<logid_t,                  // data log id
                           double,                   // bytes per second
                           double, // throughput window (seconds)
                           double, // seconds until nodeset adjustment
-                          admin_command_table::LSN // metadata trim point
+                          admin_command_table::LSN, // metadata trim point
+                          size_t, // limit on appends in flight
+                          size_t  // maximum window size
                           >
     InfoSequencersTable;
 
@@ -187,6 +189,7 @@ class InfoSequencers : public AdminCommand {
     if (metadataTrimPoint.has_value()) {
       table.set<21>(metadataTrimPoint.value());
     }
+    table.set<22>(seq.getWindowLimit()).set<23>(seq.getMaxWindowSize());
   }
 
   void run() override {
@@ -212,7 +215,9 @@ class InfoSequencers : public AdminCommand {
                               "Bytes per second",
                               "Throughput window (seconds)",
                               "Seconds until nodeset adjustment",
-                              "Metadata trim point");
+                              "Metadata trim point",
+                              "Window size",
+                              "Max window size");
 
     std::vector<std::shared_ptr<Sequencer>> sequencers;
 
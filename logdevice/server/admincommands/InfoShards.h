@@ -11,6 +11,7 @@
 #include "logdevice/server/admincommands/AdminCommand.h"
 #include "logdevice/server/locallogstore/FailingLocalLogStore.h"
 #include "logdevice/server/locallogstore/ShardedRocksDBLocalLogStore.h"
+#include "logdevice/server/storage_tasks/ShardedStorageThreadPool.h"
 
 namespace facebook { namespace logdevice { namespace commands {
 
@@ -39,7 +40,9 @@ class InfoShards : public AdminCommand {
                           "Accepting writes",
                           "Rebuilding state",
                           "Default CF Version",
-                          "Dirty State");
+                          "Dirty State",
+                          "NUMA node",
+                          "Storage threads pinned");
 
     if (server_->getProcessor()->runningOnStorageNode()) {
       auto sharded_store = server_->getShardedLocalLogStore();
@@ -58,6 +61,8 @@ class InfoShards : public AdminCommand {
             }
             return res;
           });
+      auto storage_pool =
+          server_->getServerProcessor()->sharded_storage_thread_pool_;
       shard_index_t shard_lo = 0;
       shard_index_t shard_hi = sharded_store->numShards() - 1;
 
@@ -100,13 +105,18 @@ class InfoShards : public AdminCommand {
           }
         }
 
+        const bool pinned = storage_pool != nullptr &&
+            storage_pool->getByIndex(shard_idx).getNumaNode() != -1;
+
         table.next()
             .set<0>(shard_idx)
             .set<1>(!!dynamic_cast<FailingLocalLogStore*>(store))
             .set<2>(store->acceptingWrites())
             .set<3>(std::move(rebuilding_state))
             .set<4>(store->getVersion())
-            .set<5>(std::move(dirty_state));
+            .set<5>(std::move(dirty_state))
+            .set<6>(sharded_store->getShardNumaNode(shard_idx))
+            .set<7>(pinned);
       }
     }
 
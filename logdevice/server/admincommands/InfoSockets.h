@@ -50,7 +50,11 @@ class InfoSockets : public AdminCommand {
                            "Proto",
                            "Sendbuf",
                            "Is ssl",
-                           "FD");
+                           "FD",
+                           "Msgs per write",
+                           "Bytes per write",
+                           "kTLS",
+                           "Principal");
 
     auto tables = run_on_all_workers(server_->getProcessor(), [&]() {
       InfoSocketsTable t(table);
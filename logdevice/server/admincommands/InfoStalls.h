@@ -0,0 +1,89 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <folly/String.h>
+
+#include "logdevice/common/AdminCommandTable.h"
+#include "logdevice/server/StallStackCapture.h"
+#include "logdevice/server/admincommands/AdminCommand.h"
+
+namespace facebook { namespace logdevice { namespace commands {
+
+/**
+ * Worker stalls detected by the watchdog since the node started or the last
+ * "info stalls --clear", grouped by what the worker was running and its
+ * stack, most captured first. See StallStackCapture.
+ */
+class InfoStalls : public AdminCommand {
+  using AdminCommand::AdminCommand;
+
+ private:
+  size_t top_ = 0;
+  bool clear_ = false;
+  bool json_ = false;
+
+ public:
+  using InfoStallsTable =
+      AdminCommandTable<std::string,               // Context
+                        uint64_t,                  // Captures
+                        uint64_t,                  // Max stalled ms
+                        uint64_t,                  // Max running ms
+                        std::string,               // Last worker
+                        std::chrono::milliseconds, // Last seen
+                        std::string                // Stack
+                        >;
+
+  void getOptions(boost::program_options::options_description& opts) override {
+    opts.add_options()("top",
+                       boost::program_options::value<size_t>(&top_),
+                       "Only print the most captured stacks")(
+        "clear",
+        boost::program_options::bool_switch(&clear_),
+        "Forget the stalls captured so far")(
+        "json", boost::program_options::bool_switch(&json_));
+  }
+
+  std::string getUsage() override {
+    return "info stalls [--top=<n>] [--clear] [--json]";
+  }
+
+  void run() override {
+    if (clear_) {
+      StallStackCapture::clear();
+      out_.printf("Cleared\r\n");
+      return;
+    }
+
+    InfoStallsTable table(!json_,
+                          "Context",
+                          "Captures",
+                          "Max stalled ms",
+                          "Max running ms",
+                          "Last worker",
+                          "Last seen",
+                          "Stack");
+    auto entries = StallStackCapture::getEntries();
+    if (top_ > 0 && entries.size() > top_) {
+      entries.resize(top_);
+    }
+    for (const auto& e : entries) {
+      table.next()
+          .set<0>(e.context)
+          .set<1>(e.captures)
+          .set<2>(e.max_stalled_for.count())
+          .set<3>(e.max_running_for.count())
+          .set<4>(e.last_worker)
+          .set<5>(e.last_seen.toMilliseconds())
+          .set<6>(folly::join(" <- ", e.frames));
+    }
+    json_ ? table.printJson(out_) : table.print(out_);
+  }
+};
+
+}}} // namespace facebook::logdevice::commands
@@ -0,0 +1,132 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include "logdevice/common/AdminCommandTable.h"
+#include "logdevice/common/stats/PerShardHistograms.h"
+#include "logdevice/common/stats/Stats.h"
+#include "logdevice/server/admincommands/AdminCommand.h"
+#include "logdevice/server/storage_tasks/StorageTask.h"
+
+namespace facebook { namespace logdevice { namespace commands {
+
+/**
+ * File reads and writes done by rocksdb on behalf of each type of storage
+ * task, in each shard, since the node started or stats were reset. IO outside
+ * of storage tasks, e.g. by flushes and compactions, is under UNKNOWN.
+ * See IOAttribution.
+ */
+class InfoStorageTaskIO : public AdminCommand {
+  using AdminCommand::AdminCommand;
+
+ private:
+  shard_index_t shard_ = -1;
+  bool json_ = false;
+
+ public:
+  using InfoStorageTaskIOTable =
+      AdminCommandTable<int,         // Shard
+                        std::string, // Task type
+                        uint64_t,    // Reads
+                        int64_t,     // Read bytes
+                        int64_t,     // Read p50 us
+                        int64_t,     // Read p99 us
+                        uint64_t,    // Writes
+                        int64_t,     // Write bytes
+                        int64_t,     // Write p99 us
+                        uint64_t,    // Executions
+                        int64_t      // Block cache misses
+                        >;
+
+  void getOptions(boost::program_options::options_description& opts) override {
+    opts.add_options()(
+        "shard", boost::program_options::value<shard_index_t>(&shard_))(
+        "json", boost::program_options::bool_switch(&json_));
+  }
+  void getPositionalOptions(
+      boost::program_options::positional_options_description& out_options)
+      override {
+    out_options.add("shard", 1);
+  }
+  std::string getUsage() override {
+    return "info storage_task_io [<shard>] [--json]";
+  }
+
+  void run() override {
+    InfoStorageTaskIOTable table(!json_,
+                                 "Shard",
+                                 "Task Type",
+                                 "Reads",
+                                 "Read Bytes",
+                                 "Read p50 us",
+                                 "Read p99 us",
+                                 "Writes",
+                                 "Write Bytes",
+                                 "Write p99 us",
+                                 "Executions",
+                                 "Block Cache Misses");
+
+    StatsHolder* stats = server_->getParameters()->getStats();
+    if (!stats) {
+      json_ ? table.printJson(out_) : table.print(out_);
+      return;
+    }
+    Stats agg = stats->aggregate();
+    PerShardHistograms& hists = *agg.per_shard_histograms;
+
+    const double percentiles[] = {.5, .99};
+    for (int type = 0; type < static_cast<int>(StorageTaskType::MAX);
+         ++type) {
+      auto& read_latency = hists.io_read_latency[type];
+      auto& read_size = hists.io_read_size[type];
+      auto& write_latency = hists.io_write_latency[type];
+      auto& write_size = hists.io_write_size[type];
+      auto& cache_misses = hists.io_block_cache_misses[type];
+      shard_size_t num_shards = std::max({read_latency.getNumShards(),
+                                          write_latency.getNumShards(),
+                                          cache_misses.getNumShards()});
+      for (shard_index_t shard = 0; shard < num_shards; ++shard) {
+        if (shard_ != -1 && shard != shard_) {
+          continue;
+        }
+        int64_t read_us[2];
+        int64_t write_us[2];
+        uint64_t reads, writes, executions;
+        int64_t read_bytes, write_bytes, misses;
+        read_latency.get(shard)->estimatePercentiles(
+            percentiles, 2, read_us, &reads);
+        write_latency.get(shard)->estimatePercentiles(
+            percentiles, 2, write_us, &writes);
+        std::tie(std::ignore, read_bytes) =
+            read_size.get(shard)->getCountAndSum();
+        std::tie(std::ignore, write_bytes) =
+            write_size.get(shard)->getCountAndSum();
+        std::tie(executions, misses) =
+            cache_misses.get(shard)->getCountAndSum();
+        if (reads == 0 && writes == 0 && misses == 0) {
+          continue;
+        }
+        table.next()
+            .set<0>(shard)
+            .set<1>(storageTaskTypeNames[static_cast<StorageTaskType>(type)])
+            .set<2>(reads)
+            .set<3>(read_bytes)
+            .set<4>(read_us[0])
+            .set<5>(read_us[1])
+            .set<6>(writes)
+            .set<7>(write_bytes)
+            .set<8>(write_us[1])
+            .set<9>(executions)
+            .set<10>(misses);
+      }
+    }
+    json_ ? table.printJson(out_) : table.print(out_);
+  }
+};
+
+}}} // namespace facebook::logdevice::commands
@@ -0,0 +1,147 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include <folly/String.h>
+
+#include "logdevice/server/CpuProfiler.h"
+#include "logdevice/server/admincommands/AdminCommand.h"
+
+namespace facebook { namespace logdevice { namespace commands {
+
+/**
+ * Starts the sampling CPU profiler, see CpuProfiler.
+ */
+class ProfileCpuStart : public AdminCommand {
+  using AdminCommand::AdminCommand;
+
+ private:
+  uint32_t frequency_hz_ = 99;
+  std::string threads_;
+
+ public:
+  void getOptions(boost::program_options::options_description& opts) override {
+    opts.add_options()(
+        "frequency",
+        boost::program_options::value<uint32_t>(&frequency_hz_)
+            ->default_value(frequency_hz_),
+        "Samples per second of CPU time of each thread")(
+        "threads",
+        boost::program_options::value<std::string>(&threads_),
+        "Comma-separated thread types to sample, e.g. worker,storage,rocksdb. "
+        "All threads if not given.");
+  }
+
+  std::string getUsage() override {
+    return "profile cpu start [--frequency=<hz>] [--threads=<type>,...]";
+  }
+
+  void run() override {
+    CpuProfiler::Options options;
+    options.frequency_hz = frequency_hz_;
+    std::vector<std::string> names;
+    folly::split(',', threads_, names, /* ignoreEmpty */ true);
+    for (const std::string& name : names) {
+      bool found = false;
+      for (int t = ThreadID::UNKNOWN; t <= ThreadID::WHEEL_TIMER; ++t) {
+        auto type = static_cast<ThreadID::Type>(t);
+        if (name == CpuProfiler::threadTypeName(type)) {
+          options.thread_types.push_back(type);
+          found = true;
+        }
+      }
+      if (!found) {
+        out_.printf("Unknown thread type '%s'\r\n", name.c_str());
+        return;
+      }
+    }
+
+    if (CpuProfiler::start(options) != 0) {
+      out_.printf("Failed to start profiling: %s\r\n", error_description(err));
+      return;
+    }
+    out_.printf("Started\r\n");
+  }
+};
+
+/**
+ * Stops the profiler. Its results are kept until it's started again.
+ */
+class ProfileCpuStop : public AdminCommand {
+  using AdminCommand::AdminCommand;
+
+ public:
+  void run() override {
+    if (CpuProfiler::stop() != 0) {
+      out_.printf("Not running\r\n");
+      return;
+    }
+    out_.printf("Stopped\r\n");
+  }
+};
+
+/**
+ * Prints the stacks sampled by the running or last profile in the folded
+ * format of flame graph tools, most sampled first: one line per stack, frames
+ * separated by ';' from the thread type and name to the leaf, followed by the
+ * number of samples.
+ */
+class ProfileCpu : public AdminCommand {
+  using AdminCommand::AdminCommand;
+
+ private:
+  size_t top_ = 0;
+
+ public:
+  void getOptions(boost::program_options::options_description& opts) override {
+    opts.add_options()("top",
+                       boost::program_options::value<size_t>(&top_),
+                       "Only print the most sampled stacks");
+  }
+
+  std::string getUsage() override {
+    return "profile cpu [--top=<n>]";
+  }
+
+  void run() override {
+    auto folded = CpuProfiler::getFoldedStacks();
+    std::vector<std::pair<std::string, uint64_t>> stacks(
+        folded.begin(), folded.end());
+    std::stable_sort(
+        stacks.begin(), stacks.end(), [](const auto& a, const auto& b) {
+          return a.second > b.second;
+        });
+    if (top_ > 0 && stacks.size() > top_) {
+      stacks.resize(top_);
+    }
+    for (const auto& kv : stacks) {
+      out_.printf("%s %lu\r\n", kv.first.c_str(), kv.second);
+    }
+  }
+};
+
+/**
+ * Whether the profiler is running and how much it sampled.
+ */
+class ProfileCpuStatus : public AdminCommand {
+  using AdminCommand::AdminCommand;
+
+ public:
+  void run() override {
+    auto counts = CpuProfiler::getCounts();
+    out_.printf("running: %s\r\n", CpuProfiler::isRunning() ? "yes" : "no");
+    out_.printf("threads: %lu\r\n", counts.threads);
+    out_.printf("samples: %lu\r\n", counts.samples);
+    out_.printf("dropped: %lu\r\n", counts.dropped);
+  }
+};
+
+}}} // namespace facebook::logdevice::commands
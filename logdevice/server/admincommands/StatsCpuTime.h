@@ -0,0 +1,110 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "logdevice/common/AdminCommandTable.h"
+#include "logdevice/common/RequestType.h"
+#include "logdevice/common/protocol/MessageTypeNames.h"
+#include "logdevice/common/stats/Stats.h"
+#include "logdevice/server/admincommands/AdminCommand.h"
+#include "logdevice/server/storage_tasks/StorageTask.h"
+
+namespace facebook { namespace logdevice { namespace commands {
+
+/**
+ * Worker time spent per request type, message type and storage task response
+ * type since startup or the last "stats reset", by estimated CPU time
+ * (*_worker_cpu_usec stats, see --worker-cpu-time-sample-period) and wall
+ * clock time (*_worker_usec stats), heaviest first.
+ */
+class StatsCpuTime : public AdminCommand {
+  using AdminCommand::AdminCommand;
+
+ private:
+  bool json_ = false;
+
+  struct Row {
+    const char* kind;
+    std::string type;
+    int64_t cpu_usec;
+    int64_t wall_usec;
+  };
+
+ public:
+  using StatsCpuTimeTable = AdminCommandTable<std::string, // Kind
+                                              std::string, // Type
+                                              int64_t,     // CPU time
+                                              int64_t      // Wall time
+                                              >;
+
+  void getOptions(boost::program_options::options_description& opts) override {
+    opts.add_options()("json", boost::program_options::bool_switch(&json_));
+  }
+
+  std::string getUsage() override {
+    return "stats cpu_time [--json]";
+  }
+
+  void run() override {
+    StatsHolder* stats = server_->getParameters()->getStats();
+    if (!stats) {
+      return;
+    }
+    Stats agg = stats->aggregate();
+
+    std::vector<Row> rows;
+    auto add_row = [&](const char* kind,
+                       const std::string& type,
+                       int64_t cpu_usec,
+                       int64_t wall_usec) {
+      if (!type.empty() && (cpu_usec != 0 || wall_usec != 0)) {
+        rows.push_back(Row{kind, type, cpu_usec, wall_usec});
+      }
+    };
+    for (size_t i = 0; i < agg.per_request_type_stats.size(); ++i) {
+      const auto& s = agg.per_request_type_stats[i];
+      add_row("request",
+              requestTypeNames[static_cast<RequestType>(i)],
+              s.request_worker_cpu_usec,
+              s.request_worker_usec);
+    }
+    for (size_t i = 0; i < agg.per_message_type_stats.size(); ++i) {
+      const auto& s = agg.per_message_type_stats[i];
+      add_row("message",
+              messageTypeNames()[static_cast<MessageType>(i)],
+              s.message_worker_cpu_usec,
+              s.message_worker_usec);
+    }
+    for (size_t i = 0; i < agg.per_storage_task_type_stats.size(); ++i) {
+      const auto& s = agg.per_storage_task_type_stats[i];
+      add_row("storage_task_response",
+              storageTaskTypeNames[static_cast<StorageTaskType>(i)],
+              s.storage_task_response_worker_cpu_usec,
+              s.storage_task_response_worker_usec);
+    }
+    std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+      return a.cpu_usec != b.cpu_usec ? a.cpu_usec > b.cpu_usec
+                                      : a.wall_usec > b.wall_usec;
+    });
+
+    StatsCpuTimeTable table(!json_, "Kind", "Type", "CPU us", "Wall us");
+    for (const Row& row : rows) {
+      table.next()
+          .set<0>(std::string(row.kind))
+          .set<1>(row.type)
+          .set<2>(row.cpu_usec)
+          .set<3>(row.wall_usec);
+    }
+    json_ ? table.printJson(out_) : table.print(out_);
+  }
+};
+
+}}} // namespace facebook::logdevice::commands
@@ -171,14 +171,15 @@ class StatsHistogram : public ShardedStatsHistogramBase {
 
  public:
   std::string getUsage() override {
-    return "stats2 histogram <type>|all [shard] " +
+    return "stats2 histogram <type>|all [shard] [--serialized] " +
         ShardedStatsHistogramBase::getUsage();
   }
 
   void getOptions(boost::program_options::options_description& opts) override {
     opts.add_options()(
         "type", boost::program_options::value<std::string>(&type_))(
-        "shard", boost::program_options::value<shard_index_t>(&shard_));
+        "shard", boost::program_options::value<shard_index_t>(&shard_))(
+        "serialized", boost::program_options::bool_switch(&serialized_));
     ShardedStatsHistogramBase::getOptions(opts);
   }
 
@@ -207,6 +208,10 @@ class StatsHistogram : public ShardedStatsHistogramBase {
  private:
   std::string type_;
   shard_index_t shard_{-1};
+  // Print histograms in the lossless format of
+  // SketchHistogram::toShortString(), which can be parsed and merged with
+  // histograms of other nodes, instead of a human readable one.
+  bool serialized_{false};
 
   // Find the list of histograms this command should act on based on the filters
   // passed to this admin command. Select all histograms if `type_` == "all", or
@@ -274,7 +279,12 @@ class StatsHistogram : public ShardedStatsHistogramBase {
 
   void printHist(HistTuple& tuple) override {
     std::ostringstream oss;
-    std::get<1>(tuple)->print(oss);
+    auto* sketch = dynamic_cast<const SketchHistogram*>(std::get<1>(tuple));
+    if (serialized_ && sketch) {
+      oss << sketch->toShortString();
+    } else {
+      std::get<1>(tuple)->print(oss);
+    }
 
     const std::string& name = std::get<0>(tuple);
     shard_index_t shard_idx = std::get<2>(tuple);
@@ -83,6 +83,9 @@ class FailingAllLogsIterator : public LocalLogStore::AllLogsIterator {
   void next(LocalLogStore::ReadFilter*, LocalLogStore::ReadStats*) override {
     ld_check(false);
   }
+  int compareLocations(const Location&, const Location&) const override {
+    return 0;
+  }
   std::unique_ptr<Location> minLocation() const override {
     return std::make_unique<LocationImpl>();
   }
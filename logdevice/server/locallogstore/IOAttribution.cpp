@@ -0,0 +1,122 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/locallogstore/IOAttribution.h"
+
+#include <rocksdb/perf_context.h>
+
+#include "logdevice/common/chrono_util.h"
+#include "logdevice/common/stats/PerShardHistograms.h"
+#include "logdevice/common/stats/Stats.h"
+
+namespace facebook { namespace logdevice {
+
+namespace {
+
+struct ThreadState {
+  StorageTaskType task_type = StorageTaskType::UNKNOWN;
+  IOStats* partition = nullptr;
+  // Total time spent in file reads and writes by this thread.
+  uint64_t io_usec = 0;
+};
+
+thread_local ThreadState thread_state;
+
+// Counted by rocksdb for the current thread if its perf level is at least
+// kEnableCount, which it is on storage threads.
+uint64_t blockCacheMissesOfThisThread() {
+  return rocksdb::get_perf_context()->block_cache_miss_count;
+}
+
+} // namespace
+
+IOAttribution::ScopedTaskType::ScopedTaskType(StorageTaskType type,
+                                              StatsHolder* stats,
+                                              shard_index_t shard_idx)
+    : prev_type_(thread_state.task_type),
+      stats_(stats),
+      shard_idx_(shard_idx),
+      block_cache_misses_before_(blockCacheMissesOfThisThread()),
+      io_usec_before_(thread_state.io_usec) {
+  thread_state.task_type = type;
+}
+
+IOAttribution::ScopedTaskType::~ScopedTaskType() {
+  if (shard_idx_ != -1) {
+    PER_SHARD_HISTOGRAM_ADD(
+        stats_,
+        io_block_cache_misses[static_cast<int>(thread_state.task_type)],
+        shard_idx_,
+        blockCacheMissesOfThisThread() - block_cache_misses_before_);
+  }
+  thread_state.task_type = prev_type_;
+}
+
+std::chrono::microseconds IOAttribution::ScopedTaskType::ioTime() const {
+  return std::chrono::microseconds(thread_state.io_usec - io_usec_before_);
+}
+
+IOAttribution::ScopedPartition::ScopedPartition(IOStats* io_stats)
+    : prev_(thread_state.partition) {
+  if (io_stats) {
+    thread_state.partition = io_stats;
+  }
+}
+
+IOAttribution::ScopedPartition::~ScopedPartition() {
+  thread_state.partition = prev_;
+}
+
+StorageTaskType IOAttribution::getTaskType() {
+  return thread_state.task_type;
+}
+
+IOStats* IOAttribution::getPartition() {
+  return thread_state.partition;
+}
+
+void IOAttribution::setPartition(IOStats* io_stats) {
+  thread_state.partition = io_stats;
+}
+
+void IOAttribution::onRead(StatsHolder* stats,
+                           shard_index_t shard_idx,
+                           std::chrono::steady_clock::duration duration,
+                           size_t bytes) {
+  const int64_t usec = to_usec(duration).count();
+  thread_state.io_usec += usec;
+  if (IOStats* partition = thread_state.partition) {
+    partition->reads.fetch_add(1, std::memory_order_relaxed);
+    partition->read_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    partition->read_latency.add(usec);
+  }
+  if (shard_idx != -1) {
+    const int type = static_cast<int>(thread_state.task_type);
+    PER_SHARD_HISTOGRAM_ADD(stats, io_read_latency[type], shard_idx, usec);
+    PER_SHARD_HISTOGRAM_ADD(stats, io_read_size[type], shard_idx, bytes);
+  }
+}
+
+void IOAttribution::onWrite(StatsHolder* stats,
+                            shard_index_t shard_idx,
+                            std::chrono::steady_clock::duration duration,
+                            size_t bytes) {
+  const int64_t usec = to_usec(duration).count();
+  thread_state.io_usec += usec;
+  if (IOStats* partition = thread_state.partition) {
+    partition->writes.fetch_add(1, std::memory_order_relaxed);
+    partition->write_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    partition->write_latency.add(usec);
+  }
+  if (shard_idx != -1) {
+    const int type = static_cast<int>(thread_state.task_type);
+    PER_SHARD_HISTOGRAM_ADD(stats, io_write_latency[type], shard_idx, usec);
+    PER_SHARD_HISTOGRAM_ADD(stats, io_write_size[type], shard_idx, bytes);
+  }
+}
+
+}} // namespace facebook::logdevice
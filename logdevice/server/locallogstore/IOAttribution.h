@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "logdevice/common/StorageTask-enums.h"
+#include "logdevice/common/stats/Histogram.h"
+#include "logdevice/common/types_internal.h"
+
+/**
+ * @file
+ * Attribution of the IO done through RocksDBEnv to what the thread doing it
+ * is working on: the type of the storage task being executed and the
+ * partition being read or written. Where IOTracing logs individual slow
+ * operations (if enabled), this aggregates all of them, always, so that one
+ * can tell whether slow reads come from a cold partition, from block cache
+ * misses or from a particular kind of task.
+ *
+ * Both are thread-local and set by RAII scopes:
+ *  - ExecStorageThread sets the storage task type around
+ *    StorageTask::execute(),
+ *  - partition iterators of PartitionedRocksDBStore set their partition
+ *    around seeks and nexts, and RocksDBListener sets it for the duration of
+ *    a flush or compaction.
+ *
+ * Per storage task type, the IO is recorded in the io_* histograms of
+ * PerShardHistograms. Per partition, in the partition's IOStats.
+ */
+
+namespace facebook { namespace logdevice {
+
+class StatsHolder;
+
+// Reads and writes of the files of one column family. Thread-safe.
+struct IOStats {
+  std::atomic<uint64_t> reads{0};
+  std::atomic<uint64_t> read_bytes{0};
+  std::atomic<uint64_t> writes{0};
+  std::atomic<uint64_t> write_bytes{0};
+  CompactLatencyHistogram read_latency;
+  CompactLatencyHistogram write_latency;
+};
+
+class IOAttribution {
+ public:
+  // Attributes the IO of this thread to the given storage task type until
+  // destroyed. Also records the number of block cache misses of this thread
+  // in the meantime, see io_block_cache_misses in PerShardHistograms.
+  class ScopedTaskType {
+   public:
+    ScopedTaskType(StorageTaskType type,
+                   StatsHolder* stats,
+                   shard_index_t shard_idx);
+    ~ScopedTaskType();
+
+    ScopedTaskType(const ScopedTaskType&) = delete;
+    ScopedTaskType& operator=(const ScopedTaskType&) = delete;
+
+    // Time this thread spent in file reads and writes since construction.
+    std::chrono::microseconds ioTime() const;
+
+   private:
+    StorageTaskType prev_type_;
+    StatsHolder* stats_;
+    shard_index_t shard_idx_;
+    uint64_t block_cache_misses_before_;
+    uint64_t io_usec_before_;
+  };
+
+  // Attributes the IO of this thread to the partition whose counters are
+  // `io_stats` until destroyed. `io_stats` must outlive this object. Nullptr
+  // leaves the current partition as is.
+  class ScopedPartition {
+   public:
+    explicit ScopedPartition(IOStats* io_stats);
+    ~ScopedPartition();
+
+    ScopedPartition(const ScopedPartition&) = delete;
+    ScopedPartition& operator=(const ScopedPartition&) = delete;
+
+   private:
+    IOStats* prev_;
+  };
+
+  static StorageTaskType getTaskType();
+  static IOStats* getPartition();
+
+  // For attributing a whole rocksdb background job, which has no scope in
+  // our code. The caller must keep `io_stats` alive until it resets this to
+  // nullptr.
+  static void setPartition(IOStats* io_stats);
+
+  // Called by RocksDBEnv after each read and write of a file of shard
+  // `shard_idx` (-1 if unknown).
+  static void onRead(StatsHolder* stats,
+                     shard_index_t shard_idx,
+                     std::chrono::steady_clock::duration duration,
+                     size_t bytes);
+  static void onWrite(StatsHolder* stats,
+                      shard_index_t shard_idx,
+                      std::chrono::steady_clock::duration duration,
+                      size_t bytes);
+};
+
+}} // namespace facebook::logdevice
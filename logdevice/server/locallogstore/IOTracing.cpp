@@ -76,6 +76,22 @@ void IOTracing::updateOptions(bool tracing_enabled,
   }
 }
 
+void IOTracing::registerColumnFamily(uint32_t cf_id,
+                                     std::shared_ptr<IOStats> io_stats) {
+  cf_io_stats_.wlock()->insert_or_assign(cf_id, std::move(io_stats));
+}
+
+void IOTracing::unregisterColumnFamily(uint32_t cf_id) {
+  cf_io_stats_.wlock()->erase(cf_id);
+}
+
+std::shared_ptr<IOStats>
+IOTracing::getColumnFamilyIOStats(uint32_t cf_id) const {
+  auto locked = cf_io_stats_.rlock();
+  auto it = locked->find(cf_id);
+  return it == locked->end() ? nullptr : it->second;
+}
+
 void IOTracing::stallDetectionThreadMain() {
   ThreadID::set(
       ThreadID::Type::UTILITY, folly::sformat("io-stall:s{}", shardIdx_));
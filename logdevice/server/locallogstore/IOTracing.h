@@ -13,6 +13,7 @@
 #include <folly/Synchronized.h>
 #include <folly/ThreadLocal.h>
 #include <folly/Utility.h>
+#include <folly/container/F14Map.h>
 #include <folly/lang/Aligned.h>
 
 #include "logdevice/common/ThreadID.h"
@@ -20,6 +21,7 @@
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/common/toString.h"
 #include "logdevice/common/types_internal.h"
+#include "logdevice/server/locallogstore/IOAttribution.h"
 
 /**
  * @file
@@ -240,6 +242,15 @@ class IOTracing {
                      std::chrono::milliseconds threshold,
                      std::chrono::milliseconds stall_threshold);
 
+  // IO counters of the column families of this shard that have any, by
+  // column family ID. RocksDBListener only knows the column family of a flush
+  // or compaction, and uses this to attribute its IO, see IOAttribution.
+  // Maintained by PartitionedRocksDBStore for its partitions. Thread safe.
+  void registerColumnFamily(uint32_t cf_id, std::shared_ptr<IOStats> io_stats);
+  void unregisterColumnFamily(uint32_t cf_id);
+  // @return nullptr if not registered.
+  std::shared_ptr<IOStats> getColumnFamilyIOStats(uint32_t cf_id) const;
+
  private:
   struct Options {
     std::atomic<bool> enabled{false};
@@ -270,6 +281,9 @@ class IOTracing {
 
   void stallDetectionThreadMain();
 
+  folly::Synchronized<folly::F14FastMap<uint32_t, std::shared_ptr<IOStats>>>
+      cf_io_stats_;
+
   // Logs the current context along with operation duration.
   // Does _not_ check isEnabled() or threshold; they need to be checked before
   // calling this.
@@ -0,0 +1,258 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/locallogstore/IOUring.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifdef LOGDEVICED_HAS_IO_URING
+#include <linux/io_uring.h>
+#endif
+
+#include "logdevice/common/debug.h"
+
+// Older libc headers may not know the syscall numbers. They're the same on
+// all architectures that use the unified syscall table.
+#ifdef LOGDEVICED_HAS_IO_URING
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup 425
+#endif
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter 426
+#endif
+#endif
+
+namespace facebook { namespace logdevice {
+
+namespace {
+
+// Reads [done, len) of the given range with pread(), used to finish short reads
+// returned by the kernel. Returns the total number of bytes read, or -errno.
+ssize_t preadRemainder(int fd,
+                       char* buf,
+                       size_t len,
+                       uint64_t off,
+                       size_t done) {
+  while (done < len) {
+    ssize_t r = ::pread(fd, buf + done, len - done, off + done);
+    if (r < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -errno;
+    }
+    if (r == 0) {
+      // End of file.
+      break;
+    }
+    done += r;
+  }
+  return done;
+}
+
+#ifdef LOGDEVICED_HAS_IO_URING
+int sys_io_uring_setup(unsigned entries, io_uring_params* p) {
+  return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+int sys_io_uring_enter(int fd,
+                       unsigned to_submit,
+                       unsigned min_complete,
+                       unsigned flags) {
+  return (int)syscall(
+      __NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0);
+}
+#endif
+
+} // namespace
+
+IOUring::~IOUring() {
+  if (sqes_ptr_ != nullptr) {
+    munmap(sqes_ptr_, sqes_size_);
+  }
+  if (cq_ptr_ != nullptr && cq_ptr_ != sq_ptr_) {
+    munmap(cq_ptr_, cq_size_);
+  }
+  if (sq_ptr_ != nullptr) {
+    munmap(sq_ptr_, sq_size_);
+  }
+  if (ring_fd_ != -1) {
+    ::close(ring_fd_);
+  }
+}
+
+IOUring* IOUring::forThisThread(size_t depth) {
+#ifdef LOGDEVICED_HAS_IO_URING
+  static thread_local std::unique_ptr<IOUring> ring;
+  // Set if the kernel refused to create a ring. We don't retry in that case.
+  static thread_local bool unsupported = false;
+
+  if (depth == 0 || unsupported) {
+    return nullptr;
+  }
+  if (ring != nullptr && ring->depth() == depth) {
+    return ring.get();
+  }
+
+  ring.reset();
+  std::unique_ptr<IOUring> new_ring(new IOUring());
+  if (new_ring->init(depth) != 0) {
+    unsupported = true;
+    return nullptr;
+  }
+  ring = std::move(new_ring);
+  return ring.get();
+#else
+  (void)depth;
+  return nullptr;
+#endif
+}
+
+int IOUring::init(size_t depth) {
+#ifdef LOGDEVICED_HAS_IO_URING
+  io_uring_params p;
+  memset(&p, 0, sizeof(p));
+  int fd = sys_io_uring_setup(depth, &p);
+  if (fd < 0) {
+    RATELIMIT_WARNING(std::chrono::minutes(10),
+                      1,
+                      "io_uring_setup() failed: %s. Falling back to "
+                      "synchronous reads.",
+                      strerror(errno));
+    return -1;
+  }
+  ring_fd_ = fd;
+  depth_ = depth;
+
+  sq_size_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  cq_size_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = false;
+#ifdef IORING_FEAT_SINGLE_MMAP
+  single_mmap = p.features & IORING_FEAT_SINGLE_MMAP;
+#endif
+  if (single_mmap) {
+    sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+  }
+
+  auto map = [fd](size_t size, off_t offset) -> void* {
+    void* ptr = mmap(nullptr,
+                     size,
+                     PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE,
+                     fd,
+                     offset);
+    return ptr == MAP_FAILED ? nullptr : ptr;
+  };
+
+  sq_ptr_ = map(sq_size_, IORING_OFF_SQ_RING);
+  cq_ptr_ = single_mmap ? sq_ptr_ : map(cq_size_, IORING_OFF_CQ_RING);
+  sqes_size_ = p.sq_entries * sizeof(io_uring_sqe);
+  sqes_ptr_ = map(sqes_size_, IORING_OFF_SQES);
+  if (sq_ptr_ == nullptr || cq_ptr_ == nullptr || sqes_ptr_ == nullptr) {
+    ld_error("Failed to mmap io_uring rings: %s", strerror(errno));
+    return -1;
+  }
+
+  char* sq = static_cast<char*>(sq_ptr_);
+  sq_head_ = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+  char* cq = static_cast<char*>(cq_ptr_);
+  cq_head_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+  cqes_ = cq + p.cq_off.cqes;
+
+  iovecs_.resize(depth_);
+  return 0;
+#else
+  (void)depth;
+  return -1;
+#endif
+}
+
+void IOUring::readAll(Read* reads, size_t n) {
+  for (size_t i = 0; i < n; i += depth_) {
+    submitAndWait(reads + i, std::min(depth_, n - i));
+  }
+}
+
+void IOUring::submitAndWait(Read* reads, size_t n) {
+#ifdef LOGDEVICED_HAS_IO_URING
+  ld_check(n <= depth_);
+
+  // We're the only producer, so the tail can be read without synchronization.
+  unsigned tail = *sq_tail_;
+  io_uring_sqe* sqes = static_cast<io_uring_sqe*>(sqes_ptr_);
+  for (size_t i = 0; i < n; ++i) {
+    unsigned idx = tail & *sq_mask_;
+    io_uring_sqe* sqe = &sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    iovecs_[i].iov_base = reads[i].buf;
+    iovecs_[i].iov_len = reads[i].len;
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = reads[i].fd;
+    sqe->off = reads[i].offset;
+    sqe->addr = reinterpret_cast<uint64_t>(&iovecs_[i]);
+    sqe->len = 1;
+    sqe->user_data = i;
+    sq_array_[idx] = idx;
+    ++tail;
+  }
+  __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+
+  io_uring_cqe* cqes = static_cast<io_uring_cqe*>(cqes_);
+  size_t completed = 0;
+  while (completed < n) {
+    // The kernel advances the SQ head as it consumes submissions, which also
+    // tells us how many are left to submit if io_uring_enter() got
+    // interrupted.
+    unsigned to_submit = tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    int rv = sys_io_uring_enter(
+        ring_fd_, to_submit, n - completed, IORING_ENTER_GETEVENTS);
+    if (rv < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+      // Submitted reads may still be writing into the caller's buffers, so
+      // there is no safe way to bail out.
+      ld_critical("io_uring_enter() failed: %s", strerror(errno));
+      std::abort();
+    }
+
+    unsigned head = *cq_head_;
+    unsigned cq_tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    for (; head != cq_tail; ++head) {
+      const io_uring_cqe& cqe = cqes[head & *cq_mask_];
+      ld_check(cqe.user_data < n);
+      Read& read = reads[cqe.user_data];
+      if (cqe.res > 0 && static_cast<size_t>(cqe.res) < read.len) {
+        // Short read. Finish it synchronously; this will also hit EOF if
+        // that's what caused it.
+        read.result = preadRemainder(
+            read.fd, read.buf, read.len, read.offset, cqe.res);
+      } else {
+        read.result = cqe.res;
+      }
+      ++completed;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  }
+#else
+  for (size_t i = 0; i < n; ++i) {
+    Read& read = reads[i];
+    read.result = preadRemainder(read.fd, read.buf, read.len, read.offset, 0);
+  }
+#endif
+}
+
+}} // namespace facebook::logdevice
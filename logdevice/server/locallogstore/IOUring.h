@@ -0,0 +1,101 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <vector>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define LOGDEVICED_HAS_IO_URING
+#endif
+#endif
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file A minimal io_uring instance used for submitting batches of reads with
+ *       a single system call. Talks to the kernel through the raw
+ *       io_uring_setup()/io_uring_enter() syscalls, so it doesn't need
+ *       liburing. Only supports what RocksDBRandomAccessFile::MultiRead()
+ *       needs: positional reads into caller-provided buffers.
+ *
+ *       Not thread safe; use forThisThread() to get a per-thread instance.
+ */
+
+class IOUring {
+ public:
+  struct Read {
+    int fd;
+    uint64_t offset;
+    size_t len;
+    char* buf;
+    // Output. Number of bytes read (less than len only at end of file), or
+    // -errno on error.
+    ssize_t result;
+  };
+
+  ~IOUring();
+
+  /**
+   * @return the calling thread's ring with the given queue depth, creating it
+   *         on first use. nullptr if io_uring is not supported by the kernel
+   *         or this build, or if depth is 0.  If the thread already has a ring
+   *         of a different depth it's replaced.
+   */
+  static IOUring* forThisThread(size_t depth);
+
+  /**
+   * Executes all reads, submitting up to depth() of them at a time and
+   * waiting for their completion. Always fills in `result` of all reads.
+   */
+  void readAll(Read* reads, size_t n);
+
+  size_t depth() const {
+    return depth_;
+  }
+
+ private:
+  IOUring() = default;
+
+  // @return 0 on success, -1 on failure
+  int init(size_t depth);
+
+  // Submits reads[0..n) (n <= depth_) and waits for all of them.
+  void submitAndWait(Read* reads, size_t n);
+
+  int ring_fd_ = -1;
+  size_t depth_ = 0;
+
+  // Mapped submission and completion rings.
+  void* sq_ptr_ = nullptr;
+  size_t sq_size_ = 0;
+  void* cq_ptr_ = nullptr;
+  size_t cq_size_ = 0;
+  void* sqes_ptr_ = nullptr;
+  size_t sqes_size_ = 0;
+
+  unsigned* sq_head_ = nullptr;
+  unsigned* sq_tail_ = nullptr;
+  unsigned* sq_mask_ = nullptr;
+  unsigned* sq_array_ = nullptr;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned* cq_mask_ = nullptr;
+  void* cqes_ = nullptr;
+
+  // One iovec per submission slot. IORING_OP_READV is used rather than
+  // IORING_OP_READ to support kernels older than 5.6.
+  std::vector<struct iovec> iovecs_;
+};
+
+}} // namespace facebook::logdevice
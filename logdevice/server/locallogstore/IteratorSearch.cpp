@@ -132,25 +132,14 @@ IteratorSearch::Evaluation IteratorSearch::evaluateDatabaseResult(
     return Evaluation::MOVE_HI;
   }
 
-  std::chrono::milliseconds timestamp;
-  int rv = LocalLogStoreRecordFormat::parse(it.getRecord(),
-                                            &timestamp,
-                                            nullptr,
-                                            nullptr,
-                                            nullptr,
-                                            nullptr,
-                                            nullptr,
-                                            0,
-                                            nullptr,
-                                            nullptr,
-                                            nullptr,
-                                            -1 /* unused */);
+  LocalLogStoreRecordFormat::RecordView record;
+  int rv = record.init(it.getRecord());
   if (rv < 0) {
     return Evaluation::ERROR;
   }
 
-  return timestamp.count() < target_timestamp_ ? Evaluation::MOVE_LO
-                                               : Evaluation::MOVE_HI;
+  return record.timestamp().count() < target_timestamp_ ? Evaluation::MOVE_LO
+                                                        : Evaluation::MOVE_HI;
 }
 
 int IteratorSearch::executeWithIndex(lsn_t* result_lo, lsn_t* result_hi) {
@@ -47,6 +47,17 @@ void TrackableIterator::trackIteratorRelease() {
   trackSeek(LSN_INVALID, 0);
 }
 
+void TrackableIterator::trackIteratorCreation(bool reused) {
+  std::lock_guard<std::mutex> lock(tracking_mutex_);
+  ++(reused ? mut_info_.rocksdb_iterators_reused
+            : mut_info_.rocksdb_iterators_created);
+}
+
+void TrackableIterator::trackPinnedBytes(size_t bytes) {
+  std::lock_guard<std::mutex> lock(tracking_mutex_);
+  mut_info_.pinned_bytes = bytes;
+}
+
 TrackableIterator::MutableTrackingInfo
 TrackableIterator::getMutableTrackingInfo() const {
   std::lock_guard<std::mutex> lock_guard(tracking_mutex_);
@@ -41,7 +41,10 @@ class TrackableIterator {
     CSI,
     CSI_WRAPPER,
     PARTITIONED,
-    PARTITIONED_ALL_LOGS
+    PARTITIONED_ALL_LOGS,
+    // rocksdb iterator owned by RocksDBIteratorPool, idle or lent to a DATA
+    // iterator.
+    POOLED
   };
 
   // Information that helps identify what the iterator is used for.
@@ -94,6 +97,13 @@ class TrackableIterator {
     uint64_t last_seek_version{0};
     // An arbitrary string that provides more context on what this iterator is.
     const char* more_context;
+    // How many underlying rocksdb iterators this iterator created, and how
+    // many it took from RocksDBIteratorPool instead.
+    uint64_t rocksdb_iterators_created{0};
+    uint64_t rocksdb_iterators_reused{0};
+    // Estimated memtable and read-ahead memory pinned by an idle POOLED
+    // iterator.
+    size_t pinned_bytes{0};
   };
 
   struct TrackingInfo {
@@ -162,6 +172,12 @@ class TrackableIterator {
   // Call this when the underlying RocksDB iterator is released
   void trackIteratorRelease();
 
+  // Call this when getting an underlying RocksDB iterator, either created or
+  // reused from RocksDBIteratorPool.
+  void trackIteratorCreation(bool reused);
+
+  void trackPinnedBytes(size_t bytes);
+
   ImmutableTrackingInfo imm_info_;
 
   // This mutex protects the tracking state
@@ -50,6 +50,20 @@ int LocalLogStore::findKey(logid_t /*log_id*/,
 
 void LocalLogStore::normalizeTimeRanges(RecordTimeIntervals&) const {}
 
+int LocalLogStore::findLogsInTimeRanges(
+    const RecordTimeIntervals& /*rtis*/,
+    std::unordered_set<logid_t>* /*out*/) const {
+  err = E::NOTSUPPORTED;
+  return -1;
+}
+
+int LocalLogStore::findLogsWrittenSince(
+    uint64_t /*seqno*/,
+    std::unordered_set<logid_t>* /*out*/) const {
+  err = E::NOTSUPPORTED;
+  return -1;
+}
+
 int LocalLogStore::registerOnFlushCallback(FlushCallback& cb) {
   std::unique_lock<std::mutex> lock(flushing_mtx_);
   ld_check(!cb.links.is_linked());
@@ -10,6 +10,7 @@
 #include <atomic>
 #include <condition_variable>
 #include <memory>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -265,6 +266,13 @@ class LocalLogStore : boost::noncopyable {
       return -1;
     }
 
+    // Approximate total size of the data getProgress() is measured against,
+    // in bytes. Multiply by (1 - getProgress()) to estimate how many bytes
+    // are left to read. 0 means not supported.
+    virtual uint64_t getTotalBytesEstimate() const {
+      return 0;
+    }
+
     // The filtering works the same way as in ReadIterator; see comment above.
     // `filter` can be null. `stats` can be null if `data_logs_filter` passed
     // to readAllLogs() was an empty map.
@@ -273,6 +281,13 @@ class LocalLogStore : boost::noncopyable {
                       ReadStats* stats) = 0;
     virtual void next(ReadFilter* filter, ReadStats* stats) = 0;
 
+    // Compares two locations in the order in which this iterator visits them.
+    // Returns -1 if `lhs` is visited before `rhs`, +1 if after, 0 if equal.
+    // The locations may come from a different iterator over the same store,
+    // as long as it was created with the same `new_to_old` option.
+    virtual int compareLocations(const Location& lhs,
+                                 const Location& rhs) const = 0;
+
     // To read everything, seek to minLocation() and iterate
     // until state() == AT_END.
     virtual std::unique_ptr<Location> minLocation() const = 0;
@@ -337,6 +352,11 @@ class LocalLogStore : boost::noncopyable {
     // if blocking I/O is allowed.
     bool inject_latency = false;
 
+    // If nonzero, read ahead this many bytes when the iterator has to go to
+    // disk, and prefetch asynchronously if the storage engine supports it.
+    // Meant for sequential scans. 0 means the storage engine's default.
+    size_t readahead_size = 0;
+
     // Only affects AllLogsIterator. If set to true, iterate over partitions
     // in reverse order. Inside each partition, still go in order of
     // *increasing* pair [log ID, LSN], and metadata+internal logs still go
@@ -996,6 +1016,43 @@ class LocalLogStore : boost::noncopyable {
    */
   virtual void normalizeTimeRanges(RecordTimeIntervals&) const;
 
+  /**
+   * Adds to `out` the data logs that may have records with timestamps in
+   * the given time ranges. May over-report, but never misses a log that has
+   * such records. Used by rebuilding to avoid planning every log in the
+   * config when only a short time range needs to be rebuilt.
+   *
+   * @return 0 on success, -1 with err set to E::NOTSUPPORTED if the store
+   *         can't tell which logs have records in a time range.
+   */
+  virtual int findLogsInTimeRanges(const RecordTimeIntervals& rtis,
+                                   std::unordered_set<logid_t>* out) const;
+
+  /**
+   * @return  sequence number of the latest write to the store, 0 if the store
+   *          doesn't number its writes
+   */
+  virtual uint64_t getLatestSequenceNumber() const {
+    return 0;
+  }
+
+  /**
+   * Adds to `out` the logs whose records were written or deleted after the
+   * write with sequence number `seqno` (see getLatestSequenceNumber()) and
+   * before the store was opened, as found in the write-ahead log replayed
+   * when opening it. May over-report. Used to validate record caches
+   * checkpointed by an instance that crashed.
+   *
+   * @return 0 on success, -1 on failure with err set to
+   *         NOTSUPPORTED  if the store can't tell
+   *         NOTFOUND      if some of the writes weren't replayed, e.g.
+   *                       because they skipped the write-ahead log or were
+   *                       flushed and their write-ahead log deleted, or if
+   *                       writes may have been lost in a crash
+   */
+  virtual int findLogsWrittenSince(uint64_t seqno,
+                                   std::unordered_set<logid_t>* out) const;
+
   /**
    * Some stores (e.g. PartitionedRocksDBStore) can support non blocking
    * FindTime.
@@ -1154,6 +1211,14 @@ class ShardedLocalLogStore {
    */
   virtual void setSequencerInitiatedSpaceBasedRetention(int /* shard_idx */) {}
 
+  /**
+   * @return NUMA node the disk of the given shard is attached to, or -1 if
+   *         unknown.
+   */
+  virtual int getShardNumaNode(int /* shard_idx */) const {
+    return -1;
+  }
+
   virtual ~ShardedLocalLogStore() {}
 };
 
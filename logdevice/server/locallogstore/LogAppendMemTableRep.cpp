@@ -0,0 +1,256 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/locallogstore/LogAppendMemTableRep.h"
+
+#include <algorithm>
+
+// Not part of rocksdb's public API, but needed by any MemTableRep
+// implementation. See server/CMakeLists.txt.
+#include <db/dbformat.h>
+#include <memory/arena.h>
+
+#include "logdevice/common/checks.h"
+#include "logdevice/server/locallogstore/RocksDBKeyFormat.h"
+
+namespace facebook { namespace logdevice {
+
+using RocksDBKeyFormat::DataKey;
+
+// Iterates over a sorted vector of entries, shared with the memtable or
+// with other iterators.
+class LogAppendMemTableRep::Iter : public rocksdb::MemTableRep::Iterator {
+ public:
+  Iter(const rocksdb::MemTableRep::KeyComparator& cmp,
+       std::shared_ptr<const Entries> entries)
+      : cmp_(cmp), entries_(std::move(entries)), pos_(entries_->end()) {}
+
+  bool Valid() const override {
+    return pos_ != entries_->end();
+  }
+
+  const char* key() const override {
+    ld_check(Valid());
+    return *pos_;
+  }
+
+  void Next() override {
+    ld_check(Valid());
+    ++pos_;
+  }
+
+  void Prev() override {
+    ld_check(Valid());
+    if (pos_ == entries_->begin()) {
+      pos_ = entries_->end();
+    } else {
+      --pos_;
+    }
+  }
+
+  void Seek(const rocksdb::Slice& internal_key,
+            const char* /* memtable_key */) override {
+    pos_ = std::lower_bound(entries_->begin(),
+                            entries_->end(),
+                            internal_key,
+                            [&](const char* entry, const rocksdb::Slice& k) {
+                              return cmp_(entry, k) < 0;
+                            });
+  }
+
+  void SeekForPrev(const rocksdb::Slice& internal_key,
+                   const char* /* memtable_key */) override {
+    // Last entry <= internal_key.
+    auto it = std::upper_bound(entries_->begin(),
+                               entries_->end(),
+                               internal_key,
+                               [&](const rocksdb::Slice& k, const char* entry) {
+                                 return cmp_(entry, k) > 0;
+                               });
+    pos_ = it == entries_->begin() ? entries_->end() : std::prev(it);
+  }
+
+  void SeekToFirst() override {
+    pos_ = entries_->begin();
+  }
+
+  void SeekToLast() override {
+    pos_ = entries_->empty() ? entries_->end() : std::prev(entries_->end());
+  }
+
+ private:
+  const rocksdb::MemTableRep::KeyComparator& cmp_;
+  std::shared_ptr<const Entries> entries_;
+  Entries::const_iterator pos_;
+};
+
+LogAppendMemTableRep::LogAppendMemTableRep(
+    const rocksdb::MemTableRep::KeyComparator& cmp,
+    rocksdb::Allocator* allocator)
+    : MemTableRep(allocator), cmp_(cmp) {}
+
+LogAppendMemTableRep::~LogAppendMemTableRep() {}
+
+const LogAppendMemTableRep::Entries*
+LogAppendMemTableRep::findRun(const rocksdb::Slice& user_key) const {
+  if (DataKey::valid(user_key.data(), user_key.size())) {
+    auto it = log_runs_.find(DataKey::getLogID(user_key.data()).val_);
+    return it == log_runs_.end() ? nullptr : &it->second;
+  }
+  const int prefix = user_key.empty() ? -1 : (unsigned char)user_key[0];
+  auto it = other_runs_.find(prefix);
+  return it == other_runs_.end() ? nullptr : &it->second;
+}
+
+LogAppendMemTableRep::Entries&
+LogAppendMemTableRep::getOrCreateRun(const rocksdb::Slice& user_key) {
+  if (DataKey::valid(user_key.data(), user_key.size())) {
+    const uint64_t log_id = DataKey::getLogID(user_key.data()).val_;
+    if (last_run_ == nullptr || last_log_id_ != log_id) {
+      // Pointers to values of an unordered_map are stable across rehashes.
+      last_run_ = &log_runs_[log_id];
+      last_log_id_ = log_id;
+    }
+    return *last_run_;
+  }
+  const int prefix = user_key.empty() ? -1 : (unsigned char)user_key[0];
+  return other_runs_[prefix];
+}
+
+void LogAppendMemTableRep::Insert(rocksdb::KeyHandle handle) {
+  const char* entry = static_cast<const char*>(handle);
+  folly::SharedMutex::WriteHolder lock(rwlock_);
+  ld_check(!read_only_);
+
+  Entries& run = getOrCreateRun(UserKey(entry));
+  const size_t old_capacity = run.capacity();
+  if (run.empty() || lessThan(run.back(), entry)) {
+    run.push_back(entry);
+  } else {
+    // Out of order, e.g. a rebuilding store or a key that isn't a DataKey.
+    run.insert(std::upper_bound(run.begin(),
+                                run.end(),
+                                entry,
+                                [&](const char* a, const char* b) {
+                                  return lessThan(a, b);
+                                }),
+               entry);
+  }
+  if (run.capacity() != old_capacity) {
+    index_bytes_.fetch_add(
+        (run.capacity() - old_capacity) * sizeof(entry),
+        std::memory_order_relaxed);
+  }
+  ++num_entries_;
+
+  std::lock_guard<std::mutex> sorted_lock(sorted_mutex_);
+  sorted_.reset();
+}
+
+bool LogAppendMemTableRep::Contains(const char* key) const {
+  folly::SharedMutex::ReadHolder lock(rwlock_);
+  const Entries* run = findRun(UserKey(key));
+  if (run == nullptr) {
+    return false;
+  }
+  auto it = std::lower_bound(
+      run->begin(), run->end(), key, [&](const char* a, const char* b) {
+        return lessThan(a, b);
+      });
+  return it != run->end() && cmp_(*it, key) == 0;
+}
+
+void LogAppendMemTableRep::MarkReadOnly() {
+  folly::SharedMutex::WriteHolder lock(rwlock_);
+  read_only_ = true;
+}
+
+void LogAppendMemTableRep::Get(const rocksdb::LookupKey& k,
+                               void* callback_args,
+                               bool (*callback_func)(void* arg,
+                                                     const char* entry)) {
+  // All versions of a user key are in the same run, so a point lookup
+  // doesn't need the sorted view of the whole memtable.
+  folly::SharedMutex::ReadHolder lock(rwlock_);
+  const Entries* run = findRun(k.user_key());
+  if (run == nullptr) {
+    return;
+  }
+  const rocksdb::Slice internal_key = k.internal_key();
+  auto it = std::lower_bound(
+      run->begin(),
+      run->end(),
+      internal_key,
+      [&](const char* entry, const rocksdb::Slice& key) {
+        return cmp_(entry, key) < 0;
+      });
+  while (it != run->end() && callback_func(callback_args, *it)) {
+    ++it;
+  }
+}
+
+size_t LogAppendMemTableRep::ApproximateMemoryUsage() {
+  return index_bytes_.load(std::memory_order_relaxed);
+}
+
+std::shared_ptr<const LogAppendMemTableRep::Entries>
+LogAppendMemTableRep::getSortedEntries() const {
+  std::lock_guard<std::mutex> sorted_lock(sorted_mutex_);
+  if (sorted_) {
+    return sorted_;
+  }
+
+  std::vector<const Entries*> runs;
+  runs.reserve(log_runs_.size() + other_runs_.size());
+  for (const auto& kv : log_runs_) {
+    runs.push_back(&kv.second);
+  }
+  for (const auto& kv : other_runs_) {
+    runs.push_back(&kv.second);
+  }
+  std::sort(runs.begin(), runs.end(), [&](const Entries* a, const Entries* b) {
+    return lessThan(a->front(), b->front());
+  });
+
+  auto entries = std::make_shared<Entries>();
+  entries->reserve(num_entries_);
+  bool sorted = true;
+  for (const Entries* run : runs) {
+    ld_check(!run->empty());
+    if (!entries->empty() && !lessThan(entries->back(), run->front())) {
+      // Runs overlap. This only happens for malformed keys that look like
+      // a DataKey prefix but are too short to be one.
+      sorted = false;
+    }
+    entries->insert(entries->end(), run->begin(), run->end());
+  }
+  if (!sorted) {
+    std::stable_sort(
+        entries->begin(), entries->end(), [&](const char* a, const char* b) {
+          return lessThan(a, b);
+        });
+  }
+
+  sorted_ = std::move(entries);
+  return sorted_;
+}
+
+rocksdb::MemTableRep::Iterator*
+LogAppendMemTableRep::GetIterator(rocksdb::Arena* arena) {
+  std::shared_ptr<const Entries> entries;
+  {
+    folly::SharedMutex::ReadHolder lock(rwlock_);
+    entries = getSortedEntries();
+  }
+  if (arena == nullptr) {
+    return new Iter(cmp_, std::move(entries));
+  }
+  void* mem = arena->AllocateAligned(sizeof(Iter));
+  return new (mem) Iter(cmp_, std::move(entries));
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,132 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <folly/SharedMutex.h>
+#include <rocksdb/memtablerep.h>
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file A MemTableRep specialized for the way LogsDB writes data.
+ *
+ *       Keys written to a LogsDB memtable are mostly DataKeys whose
+ *       (log id, lsn) increase within each log, interleaved across logs.
+ *       Instead of one skiplist over all keys, LogAppendMemTableRep keeps a
+ *       sorted vector of entries per log ("run"), found through a hash map
+ *       keyed by log id. An insert is usually a hash lookup and a
+ *       push_back; out of order entries are inserted in place. Keys that
+ *       aren't DataKeys go to one run per key prefix byte.
+ *
+ *       Runs of different logs never interleave, so a sorted view of the
+ *       whole memtable is the concatenation of the runs ordered by their
+ *       first key. The view is built when an iterator is created and
+ *       shared with later iterators until the next insert. Immutable
+ *       memtables build it once, which makes iteration at flush time cheap.
+ *       On the active memtable every iterator created after an insert pays
+ *       for a copy of the index, like with rocksdb's VectorRep. This makes
+ *       the rep a poor fit for workloads that create a lot of iterators on
+ *       the active memtable. Point lookups (Get()) only search one run.
+ *
+ *       Readers and the (single) writer are serialized with a shared mutex.
+ *       Concurrent inserts aren't supported.
+ */
+
+class LogAppendMemTableRep : public rocksdb::MemTableRep {
+ public:
+  LogAppendMemTableRep(const rocksdb::MemTableRep::KeyComparator& cmp,
+                       rocksdb::Allocator* allocator);
+
+  ~LogAppendMemTableRep() override;
+
+  void Insert(rocksdb::KeyHandle handle) override;
+
+  bool Contains(const char* key) const override;
+
+  void MarkReadOnly() override;
+
+  void Get(const rocksdb::LookupKey& k,
+           void* callback_args,
+           bool (*callback_func)(void* arg, const char* entry)) override;
+
+  size_t ApproximateMemoryUsage() override;
+
+  Iterator* GetIterator(rocksdb::Arena* arena) override;
+
+ private:
+  class Iter;
+
+  using Entries = std::vector<const char*>;
+
+  // Returns the run the given user key belongs to, nullptr if there's none
+  // yet.  Caller must hold rwlock_.
+  const Entries* findRun(const rocksdb::Slice& user_key) const;
+
+  // Like findRun() but creates the run if needed. Caller must hold rwlock_
+  // exclusively.
+  Entries& getOrCreateRun(const rocksdb::Slice& user_key);
+
+  // Returns a sorted view of all entries. Caller must hold rwlock_ shared.
+  std::shared_ptr<const Entries> getSortedEntries() const;
+
+  bool lessThan(const char* a, const char* b) const {
+    return cmp_(a, b) < 0;
+  }
+
+  const rocksdb::MemTableRep::KeyComparator& cmp_;
+
+  mutable folly::SharedMutex rwlock_;
+
+  // Runs of DataKeys, by log id.
+  std::unordered_map<uint64_t, Entries> log_runs_;
+  // Runs of other keys, by the first byte of the key (-1 for empty keys).
+  std::map<int, Entries> other_runs_;
+
+  // The run of the last insert, to skip the hash lookup when consecutive
+  // inserts are for the same log.
+  uint64_t last_log_id_ = 0;
+  Entries* last_run_ = nullptr;
+
+  size_t num_entries_ = 0;
+  bool read_only_ = false;
+
+  // Memory used by the runs. Keys themselves are in the allocator and are
+  // accounted for by rocksdb.
+  std::atomic<size_t> index_bytes_{0};
+
+  // Cached result of getSortedEntries(), shared by iterators until the next
+  // Insert().
+  mutable std::mutex sorted_mutex_;
+  mutable std::shared_ptr<const Entries> sorted_;
+};
+
+class LogAppendMemTableRepFactory : public rocksdb::MemTableRepFactory {
+ public:
+  using MemTableRepFactory::CreateMemTableRep;
+
+  rocksdb::MemTableRep*
+  CreateMemTableRep(const rocksdb::MemTableRep::KeyComparator& cmp,
+                    rocksdb::Allocator* allocator,
+                    const rocksdb::SliceTransform* /* unused */,
+                    rocksdb::Logger* /* unused */) override {
+    return new LogAppendMemTableRep(cmp, allocator);
+  }
+
+  const char* Name() const override {
+    return "logdevice::LogAppendMemTableRepFactory";
+  }
+};
+
+}} // namespace facebook::logdevice
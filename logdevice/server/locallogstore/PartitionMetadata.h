@@ -199,6 +199,9 @@ class PartitionDirectoryValue {
   // Any records in the partition for this log are metadata records, such as
   // bridge records.
   static const flags_t PSEUDORECORDS_ONLY = (unsigned)1 << 1;
+  // Some records of this log in this partition were written without a
+  // copyset index entry, so the copyset index can't be used to read them.
+  static const flags_t NO_COPYSET_INDEX = (unsigned)1 << 2;
 
   static std::string flagsToString(flags_t flags) {
     std::string res = "";
@@ -211,6 +214,12 @@ class PartitionDirectoryValue {
       }
       res += "PSEUDORECORDS_ONLY";
     }
+    if (NO_COPYSET_INDEX & flags) {
+      if (!res.empty()) {
+        res += "|";
+      }
+      res += "NO_COPYSET_INDEX";
+    }
     return res;
   }
 
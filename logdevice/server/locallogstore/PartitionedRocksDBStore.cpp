@@ -10,24 +10,33 @@
 #include <algorithm>
 #include <chrono>
 #include <cstdlib>
+#include <cstring>
 #include <iterator>
 #include <list>
+#include <unordered_set>
 
+#include <boost/filesystem.hpp>
 #include <folly/Conv.h>
+#include <folly/FileUtil.h>
 #include <folly/Likely.h>
 #include <folly/Optional.h>
 #include <folly/hash/Hash.h>
+#include <folly/lang/Bits.h>
 #include <rocksdb/cache.h>
 #include <rocksdb/compaction_filter.h>
 #include <rocksdb/convenience.h>
 #include <rocksdb/merge_operator.h>
 #include <rocksdb/sst_file_manager.h>
+#include <rocksdb/wal_filter.h>
 
+#include "logdevice/common/Checksum.h"
 #include "logdevice/common/ConstructorFailed.h"
 #include "logdevice/common/LocalLogStoreRecordFormat.h"
 #include "logdevice/common/MetaDataLog.h"
 #include "logdevice/common/ThreadID.h"
 #include "logdevice/common/Worker.h"
+#include "logdevice/common/chrono_util.h"
+#include "logdevice/common/commandline_util_chrono.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/common/request_util.h"
 #include "logdevice/common/stats/Stats.h"
@@ -40,6 +49,7 @@
 #include "logdevice/server/locallogstore/PartitionedRocksDBStoreIterators.h"
 #include "logdevice/server/locallogstore/RocksDBCompactionFilter.h"
 #include "logdevice/server/locallogstore/RocksDBEnv.h"
+#include "logdevice/server/locallogstore/RocksDBIteratorPool.h"
 #include "logdevice/server/locallogstore/RocksDBKeyFormat.h"
 #include "logdevice/server/locallogstore/RocksDBListener.h"
 #include "logdevice/server/locallogstore/RocksDBMemTableRep.h"
@@ -56,6 +66,7 @@ using RocksDBKeyFormat::PartitionDirectoryKey;
 using RocksDBKeyFormat::PartitionMetaKey;
 using RocksDBKeyFormat::PerEpochLogMetaKey;
 using DirectoryEntry = PartitionedRocksDBStore::DirectoryEntry;
+using FindTimeSamples = PartitionedRocksDBStore::FindTimeSamples;
 using FlushEvaluator = PartitionedRocksDBStore::FlushEvaluator;
 using CFData = FlushEvaluator::CFData;
 
@@ -63,6 +74,7 @@ const char* PartitionedRocksDBStore::METADATA_CF_NAME = "metadata";
 const char* PartitionedRocksDBStore::UNPARTITIONED_CF_NAME = "unpartitioned";
 const char* PartitionedRocksDBStore::SNAPSHOTS_CF_NAME = "snapshots";
 static const int SCHEMA_VERSION = 2;
+static const char* DIRECTORY_SNAPSHOT_FILE_NAME = "LOGSDB_DIRECTORY_SNAPSHOT";
 constexpr std::pair<node_index_t, DataClass>
     PartitionedRocksDBStore::DirtyState::SENTINEL_KEY;
 
@@ -140,6 +152,53 @@ std::string DirectoryEntry::flagsToString() const {
   return PartitionDirectoryValue::flagsToString(flags);
 }
 
+void FindTimeSamples::add(RecordTimestamp timestamp,
+                          lsn_t lsn,
+                          size_t max_samples) {
+  if (max_samples == 0) {
+    if (!samples.empty()) {
+      samples = std::vector<Sample>();
+      interval = std::chrono::milliseconds(1);
+    }
+    return;
+  }
+  if (!samples.empty()) {
+    const Sample& last = samples.back();
+    if (lsn <= last.lsn || timestamp < last.timestamp + interval) {
+      // Either too close to the last sample or out of order with it, e.g.
+      // a rebuilding write. Samples need to stay sorted by both LSN and
+      // timestamp for lookup() to work.
+      return;
+    }
+  }
+  samples.push_back(Sample{timestamp, lsn});
+  if (samples.size() > max_samples) {
+    // Keep samples 0, 2, 4, ... They are at least 2 * interval apart.
+    size_t n = 0;
+    for (size_t i = 0; i < samples.size(); i += 2) {
+      samples[n++] = samples[i];
+    }
+    samples.resize(n);
+    interval *= 2;
+  }
+}
+
+void FindTimeSamples::lookup(RecordTimestamp timestamp,
+                             lsn_t* lo,
+                             lsn_t* hi) const {
+  auto it = std::lower_bound(
+      samples.begin(),
+      samples.end(),
+      timestamp,
+      [](const Sample& s, RecordTimestamp ts) { return s.timestamp < ts; });
+  if (it != samples.end()) {
+    *hi = std::min(*hi, it->lsn);
+  }
+  if (it != samples.begin()) {
+    *lo = std::max(*lo, std::prev(it)->lsn);
+  }
+}
+
 namespace PartitionedDBKeyFormat {
 partition_id_t getIdFromCFName(const std::string& name) {
   return folly::to<partition_id_t>(name);
@@ -417,9 +476,17 @@ void PartitionedRocksDBStore::init(const Configuration* config) {
 
   ld_spew("Found %zd column families", column_families.size());
 
-  if (!open(column_families, meta_cf_options, config) || !readDirectories()) {
+  if (!open(column_families, meta_cf_options, config)) {
+    throw ConstructorFailed();
+  }
+  auto directory_start = std::chrono::steady_clock::now();
+  if (!readDirectories()) {
     throw ConstructorFailed();
   }
+  PER_SHARD_STAT_SET(stats_,
+                     logsdb_open_directory_ms,
+                     shard_idx_,
+                     msec_since(directory_start));
   if (!getSettings()->read_only) {
     if (!finishInterruptedDrops() || !convertDataKeyFormat()) {
       throw ConstructorFailed();
@@ -475,6 +542,11 @@ void PartitionedRocksDBStore::joinBackgroundThreads() {
   // Prevent threads from starting new work.
   shutdown_event_.signal();
 
+  if (!(getSettings()->read_only || inFailSafeMode())) {
+    // Writes start failing after CancelAllBackgroundWork() below.
+    writer_->flushPendingLogMetadata();
+  }
+
   // Persist all in-core data and mark partitions clean.
   if (!(getSettings()->read_only || inFailSafeMode() ||
         db_->GetOptions().avoid_flush_during_shutdown)) {
@@ -514,6 +586,311 @@ void PartitionedRocksDBStore::joinBackgroundThreads() {
   }
 
   immutable_.store(true);
+
+  if (getSettings()->partition_directory_snapshot && !inFailSafeMode() &&
+      !had_failed_writes_.load()) {
+    writeDirectorySnapshot();
+  }
+}
+
+namespace {
+// Format of the directory snapshot file: a header followed by
+// header.num_entries entries, sorted by log ID and first LSN. Integers are in
+// host byte order; the file is only read by the process that wrote it or its
+// successor on the same machine.
+struct DirectorySnapshotHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t sequence_number;
+  uint64_t num_entries;
+  // checksum_64bit() of the entries.
+  uint64_t checksum;
+} __attribute__((__packed__));
+
+struct DirectorySnapshotEntry {
+  logid_t::raw_type log_id;
+  partition_id_t partition;
+  lsn_t first_lsn;
+  lsn_t max_lsn;
+  uint64_t approximate_size_bytes;
+  PartitionDirectoryValue::flags_t flags;
+} __attribute__((__packed__));
+
+constexpr uint32_t DIRECTORY_SNAPSHOT_MAGIC = 0x4c445344; // "LDSD"
+constexpr uint32_t DIRECTORY_SNAPSHOT_VERSION = 1;
+} // namespace
+
+namespace {
+// Notes, for each data log that a write batch writes or deletes records of,
+// the given sequence number. Keys of other kinds are ignored.
+class DataLogsCollector : public rocksdb::WriteBatch::Handler {
+ public:
+  DataLogsCollector(
+      std::unordered_map<logid_t, rocksdb::SequenceNumber>* last_write,
+      rocksdb::SequenceNumber seqno)
+      : last_write_(last_write), seqno_(seqno) {}
+
+  rocksdb::Status PutCF(uint32_t /*cf*/,
+                        const rocksdb::Slice& key,
+                        const rocksdb::Slice& /*value*/) override {
+    add(key);
+    return rocksdb::Status::OK();
+  }
+  rocksdb::Status MergeCF(uint32_t /*cf*/,
+                          const rocksdb::Slice& key,
+                          const rocksdb::Slice& /*value*/) override {
+    add(key);
+    return rocksdb::Status::OK();
+  }
+  rocksdb::Status DeleteCF(uint32_t /*cf*/,
+                           const rocksdb::Slice& key) override {
+    add(key);
+    return rocksdb::Status::OK();
+  }
+  rocksdb::Status SingleDeleteCF(uint32_t /*cf*/,
+                                 const rocksdb::Slice& key) override {
+    add(key);
+    return rocksdb::Status::OK();
+  }
+  rocksdb::Status DeleteRangeCF(uint32_t /*cf*/,
+                                const rocksdb::Slice& begin,
+                                const rocksdb::Slice& end) override {
+    using RocksDBKeyFormat::DataKey;
+    const bool begin_data = DataKey::valid(begin.data(), begin.size());
+    const bool end_data = DataKey::valid(end.data(), end.size());
+    if (!begin_data && !end_data) {
+      return rocksdb::Status::OK();
+    }
+    if (!begin_data || !end_data ||
+        DataKey::getLogID(begin.data()) != DataKey::getLogID(end.data())) {
+      // Can't tell which logs the range covers.
+      return rocksdb::Status::NotSupported("range deletion across logs");
+    }
+    note(DataKey::getLogID(begin.data()));
+    return rocksdb::Status::OK();
+  }
+
+ private:
+  void add(const rocksdb::Slice& key) {
+    using RocksDBKeyFormat::DataKey;
+    if (DataKey::valid(key.data(), key.size())) {
+      note(DataKey::getLogID(key.data()));
+    }
+  }
+
+  void note(logid_t log) {
+    rocksdb::SequenceNumber& last = (*last_write_)[log];
+    last = std::max(last, seqno_);
+  }
+
+  std::unordered_map<logid_t, rocksdb::SequenceNumber>* last_write_;
+  rocksdb::SequenceNumber seqno_;
+};
+
+// Installed while opening the DB. Doesn't change what gets replayed, only
+// records it in a PartitionedRocksDBStore::RecoveredWrites.
+class RecoveredWritesFilter : public rocksdb::WalFilter {
+ public:
+  explicit RecoveredWritesFilter(
+      PartitionedRocksDBStore::RecoveredWrites* out)
+      : out_(out) {}
+
+  WalProcessingOption LogRecordFound(unsigned long long /*log_number*/,
+                                     const std::string& /*log_file_name*/,
+                                     const rocksdb::WriteBatch& batch,
+                                     rocksdb::WriteBatch* /*new_batch*/,
+                                     bool* /*batch_changed*/) override {
+    // A write batch starts with its fixed64 sequence number.
+    const std::string& rep = batch.Data();
+    uint64_t seqno;
+    if (rep.size() < sizeof(seqno)) {
+      out_->invalid = true;
+      return WalProcessingOption::kContinueProcessing;
+    }
+    memcpy(&seqno, rep.data(), sizeof(seqno));
+    seqno = folly::Endian::little(seqno);
+
+    const uint32_t count = batch.Count();
+    if (seqno != out_->next_seqno) {
+      // Writes that skipped the WAL still took up sequence numbers.
+      out_->first_seqno = seqno;
+    }
+    out_->next_seqno = seqno + count;
+    if (count == 0) {
+      return WalProcessingOption::kContinueProcessing;
+    }
+
+    DataLogsCollector collector(&out_->last_write, seqno + count - 1);
+    if (!batch.Iterate(&collector).ok()) {
+      out_->invalid = true;
+    }
+    return WalProcessingOption::kContinueProcessing;
+  }
+
+  const char* Name() const override {
+    return "RecoveredWritesFilter";
+  }
+
+ private:
+  PartitionedRocksDBStore::RecoveredWrites* out_;
+};
+} // namespace
+
+std::string PartitionedRocksDBStore::getDirectorySnapshotPath() const {
+  return (boost::filesystem::path(db_path_) / DIRECTORY_SNAPSHOT_FILE_NAME)
+      .string();
+}
+
+void PartitionedRocksDBStore::writeDirectorySnapshot() {
+  auto start_time = std::chrono::steady_clock::now();
+
+  std::vector<logid_t::raw_type> log_ids;
+  for (const auto& kv : logs_) {
+    log_ids.push_back(kv.first);
+  }
+  std::sort(log_ids.begin(), log_ids.end());
+
+  std::string data(sizeof(DirectorySnapshotHeader), '\0');
+  for (logid_t::raw_type log_id : log_ids) {
+    auto it = logs_.find(log_id);
+    ld_check(it != logs_.cend());
+    LogState* log_state = it->second.get();
+    std::lock_guard<std::mutex> lock(log_state->mutex);
+    for (const auto& dir_kv : log_state->directory) {
+      const DirectoryEntry& dir_entry = dir_kv.second;
+      DirectorySnapshotEntry entry;
+      entry.log_id = log_id;
+      entry.partition = dir_entry.id;
+      entry.first_lsn = dir_entry.first_lsn;
+      entry.max_lsn = dir_entry.max_lsn;
+      entry.approximate_size_bytes = dir_entry.approximate_size_bytes;
+      entry.flags = dir_entry.flags;
+      data.append(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    }
+  }
+
+  DirectorySnapshotHeader header;
+  header.magic = DIRECTORY_SNAPSHOT_MAGIC;
+  header.version = DIRECTORY_SNAPSHOT_VERSION;
+  header.sequence_number = db_->GetLatestSequenceNumber();
+  header.num_entries = (data.size() - sizeof(header)) /
+      sizeof(DirectorySnapshotEntry);
+  header.checksum = checksum_64bit(Slice(data.data() + sizeof(header),
+                                         data.size() - sizeof(header)));
+  memcpy(&data[0], &header, sizeof(header));
+
+  const std::string path = getDirectorySnapshotPath();
+  try {
+    folly::writeFileAtomic(path, data, 0644, folly::SyncType::WITH_SYNC);
+  } catch (const std::exception& ex) {
+    ld_error("Shard %d: failed to write partition directory snapshot %s: %s",
+             getShardIdx(),
+             path.c_str(),
+             folly::exceptionStr(ex).c_str());
+    return;
+  }
+  ld_info("Shard %d: wrote partition directory snapshot of %lu logs, %lu "
+          "entries, at sequence number %lu in %ld ms",
+          getShardIdx(),
+          log_ids.size(),
+          header.num_entries,
+          header.sequence_number,
+          msec_since(start_time));
+}
+
+bool PartitionedRocksDBStore::readDirectorySnapshot() {
+  const std::string path = getDirectorySnapshotPath();
+  std::string data;
+  if (!folly::readFile(path.c_str(), data)) {
+    // Usually doesn't exist: unclean shutdown, or snapshots are disabled.
+    return false;
+  }
+  if (!getSettings()->read_only) {
+    // Any write makes the snapshot stale. Don't leave it around.
+    boost::system::error_code ec;
+    boost::filesystem::remove(path, ec);
+    if (ec) {
+      ld_warning("Shard %d: failed to remove %s: %s",
+                 getShardIdx(),
+                 path.c_str(),
+                 ec.message().c_str());
+    }
+  }
+  if (!getSettings()->partition_directory_snapshot) {
+    return false;
+  }
+
+  DirectorySnapshotHeader header;
+  size_t entries_size = 0;
+  bool valid = data.size() >= sizeof(header);
+  if (valid) {
+    memcpy(&header, data.data(), sizeof(header));
+    entries_size = data.size() - sizeof(header);
+    valid = header.magic == DIRECTORY_SNAPSHOT_MAGIC &&
+        header.version == DIRECTORY_SNAPSHOT_VERSION &&
+        entries_size == header.num_entries * sizeof(DirectorySnapshotEntry) &&
+        header.checksum ==
+            checksum_64bit(Slice(data.data() + sizeof(header), entries_size));
+  }
+  if (!valid) {
+    ld_warning("Shard %d: partition directory snapshot %s is malformed. "
+               "Reading the directory from rocksdb.",
+               getShardIdx(),
+               path.c_str());
+    return false;
+  }
+  if (header.sequence_number != sequence_number_at_open_) {
+    ld_info("Shard %d: partition directory snapshot is at sequence number "
+            "%lu but the DB is at %lu. Reading the directory from rocksdb.",
+            getShardIdx(),
+            header.sequence_number,
+            sequence_number_at_open_);
+    return false;
+  }
+
+  LogState* log_state = nullptr;
+  logid_t::raw_type current_log_id = LOGID_INVALID.val();
+  auto finalizePreviousLogState = [&]() {
+    if (log_state) {
+      const DirectoryEntry& latest = log_state->directory.rbegin()->second;
+      log_state->latest_partition.store(
+          latest.id, latest.first_lsn, latest.max_lsn);
+    }
+  };
+  for (size_t i = 0; i < header.num_entries; ++i) {
+    DirectorySnapshotEntry entry;
+    memcpy(&entry,
+           data.data() + sizeof(header) + i * sizeof(entry),
+           sizeof(entry));
+    if (entry.log_id != current_log_id) {
+      finalizePreviousLogState();
+      auto res = logs_.emplace(entry.log_id, std::make_unique<LogState>());
+      if (entry.log_id == LOGID_INVALID.val() || !res.second) {
+        ld_error("Shard %d: partition directory snapshot has unexpected "
+                 "entries for log %lu. Reading the directory from rocksdb.",
+                 getShardIdx(),
+                 entry.log_id);
+        logs_.clear();
+        return false;
+      }
+      current_log_id = entry.log_id;
+      log_state = res.first->second.get();
+    }
+    DirectoryEntry dir_entry;
+    dir_entry.id = entry.partition;
+    dir_entry.first_lsn = entry.first_lsn;
+    dir_entry.max_lsn = entry.max_lsn;
+    dir_entry.flags = entry.flags;
+    dir_entry.approximate_size_bytes = entry.approximate_size_bytes;
+    log_state->directory.emplace_hint(
+        log_state->directory.end(), entry.first_lsn, dir_entry);
+  }
+  finalizePreviousLogState();
+
+  ld_info("Shard %d: loaded partition directory of %lu logs from snapshot",
+          getShardIdx(),
+          logs_.size());
+  return true;
 }
 
 void PartitionedRocksDBStore::setProcessor(Processor* processor) {
@@ -612,6 +989,8 @@ bool PartitionedRocksDBStore::open(
     const std::vector<std::string>& column_families,
     const rocksdb::ColumnFamilyOptions& meta_cf_options,
     const Configuration* /*config*/) {
+  auto open_start = std::chrono::steady_clock::now();
+
   // build a list of CF descriptors
   std::vector<rocksdb::ColumnFamilyDescriptor> cf_descriptors;
   for (const auto& name : column_families) {
@@ -628,6 +1007,14 @@ bool PartitionedRocksDBStore::open(
   std::vector<rocksdb::ColumnFamilyHandle*> cf_handles_raw;
   rocksdb::DB* db;
 
+  // Note which logs the writes replayed from the WAL touch, in case a record
+  // cache checkpoint wants to know. See findLogsWrittenSince().
+  RecoveredWritesFilter wal_filter(&recovered_writes_);
+  rocksdb_config_.options_.wal_filter = &wal_filter;
+  SCOPE_EXIT {
+    rocksdb_config_.options_.wal_filter = nullptr;
+  };
+
   rocksdb::Status status;
   bool read_only = getSettings()->read_only;
   if (read_only) {
@@ -660,6 +1047,10 @@ bool PartitionedRocksDBStore::open(
   }
 
   db_.reset(db);
+  sequence_number_at_open_ = db_->GetLatestSequenceNumber();
+  PER_SHARD_STAT_SET(
+      stats_, logsdb_open_db_ms, shard_idx_, msec_since(open_start));
+  auto partitions_start = std::chrono::steady_clock::now();
 
   partition_id_t latest_partition_id = PARTITION_INVALID;
   partition_id_t oldest_partition_id = PARTITION_MAX;
@@ -789,6 +1180,9 @@ bool PartitionedRocksDBStore::open(
           return false;
         }
 
+        if (getIOTracing()) {
+          getIOTracing()->unregisterColumnFamily(partition->cf_->getID());
+        }
         partitions_.pop_back();
         if (partitions_.empty()) {
           ld_error("Found incomplete latest partition %lu but no previous "
@@ -1000,6 +1394,10 @@ bool PartitionedRocksDBStore::open(
 
   latest_.update(latest_partition);
 
+  PER_SHARD_STAT_SET(stats_,
+                     logsdb_open_partitions_ms,
+                     shard_idx_,
+                     msec_since(partitions_start));
   return true;
 }
 
@@ -1484,6 +1882,12 @@ bool PartitionedRocksDBStore::readDirectories() {
 
   ld_check(logs_.empty());
 
+  if (readDirectorySnapshot()) {
+    PER_SHARD_STAT_SET(stats_, logsdb_directory_snapshot_loaded, shard_idx_, 1);
+    return true;
+  }
+  PER_SHARD_STAT_SET(stats_, logsdb_directory_snapshot_loaded, shard_idx_, 0);
+
   RocksDBIterator it = createMetadataIterator();
   it.Seek(rocksdb::Slice(&key, sizeof(key)));
 
@@ -1551,6 +1955,13 @@ bool PartitionedRocksDBStore::readDirectories() {
     }
     log_state->directory.emplace(directory_entry.first_lsn, directory_entry);
 
+    if (directory_entry.flags & PartitionDirectoryValue::NO_COPYSET_INDEX) {
+      PartitionPtr partition;
+      if (getPartition(directory_entry.id, &partition)) {
+        partition->no_copyset_index.store(true);
+      }
+    }
+
     // Update latest_partition
     latest_partition = directory_entry.id;
     first_lsn_in_latest = directory_entry.first_lsn;
@@ -1659,6 +2070,12 @@ void PartitionedRocksDBStore::addPartitions(
     std::vector<PartitionPtr> partitions) {
   ld_check(!partitions.empty());
   STAT_ADD(stats_, partitions, partitions.size());
+  if (IOTracing* io_tracing = getIOTracing()) {
+    for (const PartitionPtr& partition : partitions) {
+      io_tracing->registerColumnFamily(
+          partition->cf_->getID(), partition->io_stats);
+    }
+  }
   partition_id_t id0 = partitions[0]->id_;
   if (partitions_.empty()) {
     partitions_.setBaseID(id0);
@@ -1741,7 +2158,8 @@ PartitionedRocksDBStore::getWritePartition(
     rocksdb::WriteBatch& durable_batch,
     PartitionPtr* out_partition,
     size_t payload_size_bytes,
-    LocalLogStoreRecordFormat::flags_t flags) {
+    LocalLogStoreRecordFormat::flags_t flags,
+    bool no_copyset_index) {
   ld_check(!getSettings()->read_only);
   partition_id_t latest_partition_id = latest_.get()->id_;
   partition_id_t target_partition = timestamp.has_value()
@@ -1854,6 +2272,14 @@ PartitionedRocksDBStore::getWritePartition(
       current_partition->flags &= ~PartitionDirectoryValue::PSEUDORECORDS_ONLY;
     }
 
+    // Set NO_COPYSET_INDEX flag if this is the first record of this log
+    // written to the given partition without a copyset index entry.
+    bool set_no_copyset_index_flag = no_copyset_index &&
+        !(current_partition->flags & PartitionDirectoryValue::NO_COPYSET_INDEX);
+    if (set_no_copyset_index_flag) {
+      current_partition->flags |= PartitionDirectoryValue::NO_COPYSET_INDEX;
+    }
+
     if (lsn > current_partition->max_lsn) {
       if (!timestamp.has_value()) {
         // This is a delete/amend operation, and record with this LSN is known
@@ -1870,7 +2296,8 @@ PartitionedRocksDBStore::getWritePartition(
     } else if ((durability > Durability::MEMORY &&
                 (current_partition->flags &
                  PartitionDirectoryValue::NOT_DURABLE)) ||
-               payload_size_bytes != 0 || unset_pseudorecords_only_flag) {
+               payload_size_bytes != 0 || unset_pseudorecords_only_flag ||
+               set_no_copyset_index_flag) {
       // Upgrade to a durable entry.
       current_partition->doPut(
           log_id, durability, metadata_cf_->get(), rocksdb_batch);
@@ -1888,6 +2315,9 @@ PartitionedRocksDBStore::getWritePartition(
     new_next_partition.first_lsn = lsn;
     // Update data size
     new_next_partition.approximate_size_bytes += payload_size_bytes;
+    if (no_copyset_index) {
+      new_next_partition.flags |= PartitionDirectoryValue::NO_COPYSET_INDEX;
+    }
     new_next_partition.doPut(
         log_id, Durability::ASYNC_WRITE, metadata_cf_->get(), durable_batch);
     STAT_INCR(stats_, logsdb_writes_dir_key_decrease);
@@ -1912,6 +2342,9 @@ PartitionedRocksDBStore::getWritePartition(
         flags & LocalLogStoreRecordFormat::PSEUDORECORD_MASK
         ? PartitionDirectoryValue::PSEUDORECORDS_ONLY
         : 0;
+    if (no_copyset_index) {
+      directory_entry_flags |= PartitionDirectoryValue::NO_COPYSET_INDEX;
+    }
 
     DirectoryEntry new_partition{
         target_partition,      // partition id
@@ -1934,12 +2367,26 @@ PartitionedRocksDBStore::getWritePartition(
 
   ld_check_eq(current_partition->id, target_partition);
 
+  if (timestamp.has_value() &&
+      !(flags &
+        (LocalLogStoreRecordFormat::PSEUDORECORD_MASK |
+         LocalLogStoreRecordFormat::FLAG_AMEND))) {
+    current_partition->find_time_samples.add(
+        timestamp.value(), lsn, getSettings()->find_time_samples_per_partition);
+  }
+
   // Get the partition by ID.
 
   bool ok = getPartition(target_partition, out_partition);
   // target_partition >= *min_allowed_partition, so it can't have been dropped.
   ld_check(ok);
 
+  if (no_copyset_index) {
+    // Before the record is written, so that readers that see the record also
+    // see the flag.
+    (*out_partition)->no_copyset_index.store(true);
+  }
+
   if (target_partition < latest_partition_id - 1) {
     STAT_INCR(stats_, logsdb_writes_to_old_partitions);
   }
@@ -2223,16 +2670,22 @@ int PartitionedRocksDBStore::findPartition(
 int PartitionedRocksDBStore::dataSize(logid_t log_id,
                                       std::chrono::milliseconds lo,
                                       std::chrono::milliseconds hi,
-                                      size_t* out) {
-  return dataSize(log_id, RecordTimestamp(lo), RecordTimestamp(hi), out);
+                                      size_t* out,
+                                      size_t* out_error) {
+  return dataSize(
+      log_id, RecordTimestamp(lo), RecordTimestamp(hi), out, out_error);
 }
 
 int PartitionedRocksDBStore::dataSize(logid_t log_id,
                                       RecordTimestamp lo_timestamp,
                                       RecordTimestamp hi_timestamp,
-                                      size_t* out) {
+                                      size_t* out,
+                                      size_t* out_error) {
   ld_check_ne(out, nullptr);
   *out = 0;
+  if (out_error) {
+    *out_error = 0;
+  }
 
   RecordTimestamp now(currentTime());
   if (hi_timestamp > now) {
@@ -2342,7 +2795,13 @@ int PartitionedRocksDBStore::dataSize(logid_t log_id,
       double fraction_in_range = partition_time_range == 0
           ? 1
           : (double(time_range_covered) / double(partition_time_range));
+      size_t partition_bytes = bytes_covered;
       bytes_covered = (uint64_t)round(bytes_covered * fraction_in_range);
+      if (out_error) {
+        // All of the partition's data for this log may be on either side of
+        // the boundary.
+        *out_error += std::max(bytes_covered, partition_bytes - bytes_covered);
+      }
     }
 
     *out += bytes_covered;
@@ -2448,7 +2907,11 @@ PartitionedRocksDBStore::writeBatch(const rocksdb::WriteOptions& options,
                        getSettings()->memtable_size_per_node / num_shards_);
   }
 
-  return RocksDBLogStoreBase::writeBatch(options, batch);
+  rocksdb::Status status = RocksDBLogStoreBase::writeBatch(options, batch);
+  if (!status.ok()) {
+    had_failed_writes_.store(true);
+  }
+  return status;
 }
 
 void PartitionedRocksDBStore::findPartitionsMatchingIntervals(
@@ -2503,6 +2966,62 @@ void PartitionedRocksDBStore::normalizeTimeRanges(
   }
 }
 
+int PartitionedRocksDBStore::findLogsInTimeRanges(
+    const RecordTimeIntervals& rtis,
+    std::unordered_set<logid_t>* out) const {
+  ld_check(out != nullptr);
+  RecordTimeIntervals intervals = rtis;
+  std::vector<partition_id_t> partitions;
+  findPartitionsMatchingIntervals(
+      intervals, [&](PartitionPtr partition, RecordTimeInterval /* pi */) {
+        partitions.push_back(partition->id_);
+      });
+  if (partitions.empty()) {
+    return 0;
+  }
+  // getLogsDBDirectories() interprets empty `partitions` as all partitions,
+  // so only call it if some partitions matched.
+  std::vector<std::pair<logid_t, DirectoryEntry>> entries;
+  getLogsDBDirectories(std::move(partitions), {}, entries);
+  for (const auto& entry : entries) {
+    out->insert(entry.first);
+  }
+  return 0;
+}
+
+int PartitionedRocksDBStore::findLogsWrittenSince(
+    uint64_t seqno,
+    std::unordered_set<logid_t>* out) const {
+  ld_check(out != nullptr);
+  if (seqno == sequence_number_at_open_ && !isUnderReplicated()) {
+    return 0;
+  }
+  const RecoveredWrites& replayed = recovered_writes_;
+  // Every write in (seqno, sequence_number_at_open_] must have been
+  // replayed. A later `seqno` means the DB lost writes it had numbered.
+  if (seqno > sequence_number_at_open_ || isUnderReplicated() ||
+      replayed.invalid || replayed.first_seqno > seqno + 1 ||
+      replayed.next_seqno <= sequence_number_at_open_) {
+    ld_info("Shard %u: can't tell which logs were written after sequence "
+            "number %lu: replayed %lu..%lu%s, opened at %lu%s",
+            shard_idx_,
+            seqno,
+            replayed.first_seqno,
+            replayed.next_seqno,
+            replayed.invalid ? " (some unparsed)" : "",
+            sequence_number_at_open_,
+            isUnderReplicated() ? ", under-replicated" : "");
+    err = E::NOTFOUND;
+    return -1;
+  }
+  for (const auto& kv : replayed.last_write) {
+    if (kv.second > seqno) {
+      out->insert(kv.first);
+    }
+  }
+  return 0;
+}
+
 RocksDBIterator
 PartitionedRocksDBStore::createMetadataIterator(bool allow_blocking_io) const {
   ld_check(metadata_cf_);
@@ -2845,6 +3364,21 @@ int PartitionedRocksDBStore::writeMultiImpl(
   const bool skip_rebuilding = getRebuildingSettings()->read_only ==
       RebuildingReadOnlyOption::ON_RECIPIENT;
 
+  // Rebuilding stores to old partitions that will be ingested as sst files
+  // instead of written to memtable if there are enough of them, by partition.
+  // See --rocksdb-ingest-rebuilding-writes-min-bytes.
+  struct IngestGroup {
+    RocksDBCFPtr cf;
+    // Indexes in `writes`.
+    std::vector<size_t> writes;
+    size_t bytes = 0;
+  };
+  std::map<partition_id_t, IngestGroup> ingest_groups;
+  const size_t ingest_min_bytes =
+      getSettings()->ingest_rebuilding_writes_min_bytes_;
+  const folly::Optional<std::string> db_path = getLocalDBPath();
+  const bool ingest_enabled = ingest_min_bytes > 0 && db_path.has_value();
+
   // Writes and clears rocksdb_batch. Used for flushing directory updates
   // between calls to getWritePartition() for the same log.
   // Note: Partition timestamp updates can be flushed as part of this. Make sure
@@ -2873,8 +3407,18 @@ int PartitionedRocksDBStore::writeMultiImpl(
     return true;
   };
 
+  // Verify checksums before attempting to actually write the records,
+  // so that a corrupt record does not affect log state or directory.
+  // All records are checked in one batch, and the write fails once the loop
+  // below reaches the first malformed one.
+  const bool verify_checksums = getSettings()->verify_checksum_during_store;
+  const size_t first_malformed = verify_checksums
+      ? RocksDBWriter::findFirstMalformedPut(writes_in)
+      : writes_in.size();
+
   ld_spew("------------- Write Batch Begin --------------");
-  for (const auto write : writes_in) {
+  for (size_t write_idx = 0; write_idx < writes_in.size(); ++write_idx) {
+    const WriteOp* write = writes_in[write_idx];
     // When testing, we may want to ignore rebuilding related writes.
     if (skip_rebuilding && write->getType() == WriteType::PUT &&
         static_cast<const PutWriteOp*>(write)->isRebuilding()) {
@@ -2886,14 +3430,10 @@ int PartitionedRocksDBStore::writeMultiImpl(
 
     switch (write->getType()) {
       case WriteType::PUT:
-        // Verify checksums before attempting to actually write the records,
-        // so that a corrupt record does not affect log state or directory.
-        if (getSettings()->verify_checksum_during_store) {
+        if (verify_checksums) {
           // Reject to store malformed records.
           const PutWriteOp* op = static_cast<const PutWriteOp*>(write);
-          int rv = LocalLogStoreRecordFormat::checkWellFormed(
-              op->record_header, op->data);
-          if (rv != 0) {
+          if (write_idx == first_malformed) {
             RATELIMIT_ERROR(
                 std::chrono::seconds(10),
                 10,
@@ -2980,8 +3520,10 @@ int PartitionedRocksDBStore::writeMultiImpl(
         //    entry.
         size_t payload_size_bytes = 0;
         LocalLogStoreRecordFormat::flags_t flags = 0;
+        bool no_copyset_index = false;
         if (write->getType() == WriteType::PUT) {
           auto* put_write_op = static_cast<const PutWriteOp*>(write);
+          no_copyset_index = !put_write_op->copyset_index_lsn.has_value();
           int rv = LocalLogStoreRecordFormat::parseFlags(
               put_write_op->record_header, &flags);
           if (rv != 0) {
@@ -3008,7 +3550,8 @@ int PartitionedRocksDBStore::writeMultiImpl(
             wal_batch,
             &partition,
             payload_size_bytes,
-            flags);
+            flags,
+            no_copyset_index);
         switch (res) {
           case GetWritePartitionResult::OK:
             break;
@@ -3130,6 +3673,14 @@ int PartitionedRocksDBStore::writeMultiImpl(
           // RocksDBWriter. These updates can be flushed before the actual data
           // alongwith directory updates.
           const PutWriteOp* put_op = static_cast<const PutWriteOp*>(write);
+          if (ingest_enabled && put_op->isRebuilding() &&
+              !(flags & LocalLogStoreRecordFormat::FLAG_AMEND) &&
+              partition->id_ < latest_partition_id - 1) {
+            IngestGroup& group = ingest_groups[partition->id_];
+            group.cf = partition->cf_;
+            group.writes.push_back(writes.size());
+            group.bytes += put_op->record_header.size + put_op->data.size;
+          }
           for (auto it = put_op->index_key_list.begin();
                it != put_op->index_key_list.end();
                ++it) {
@@ -3170,6 +3721,71 @@ int PartitionedRocksDBStore::writeMultiImpl(
   ld_check_eq(*min_target_partition_est, min_target_partition->id_);
   ld_check(!min_target_partition->is_dropped);
 
+  if (!ingest_groups.empty()) {
+    std::vector<bool> ingested(writes.size(), false);
+    bool batches_written = false;
+    for (auto& kv : ingest_groups) {
+      const IngestGroup& group = kv.second;
+      if (group.bytes < ingest_min_bytes) {
+        continue;
+      }
+      if (!batches_written) {
+        // Ingested records are durable right away, so their directory
+        // entries have to be durable too. Write the pending metadata updates,
+        // with WAL, before ingesting.
+        for (auto* batch : {&wal_batch, &mem_batch}) {
+          if (batch->Count()) {
+            auto status = writeBatch(rocksdb::WriteOptions(), batch);
+            if (!status.ok()) {
+              ld_error("Failed to write directory updates to RocksDB: %s",
+                       status.ToString().c_str());
+              err = E::LOCAL_LOG_STORE_WRITE;
+              return -1;
+            }
+            batch->Clear();
+          }
+        }
+        batches_written = true;
+      }
+      std::vector<const PutWriteOp*> ops;
+      ops.reserve(group.writes.size());
+      for (size_t idx : group.writes) {
+        ops.push_back(static_cast<const PutWriteOp*>(writes[idx]));
+      }
+      if (writer_->ingestPuts(
+              ops, group.cf->get(), db_path.value() + "/rebuilding_ingest")) {
+        for (size_t idx : group.writes) {
+          ingested[idx] = true;
+        }
+      }
+    }
+
+    // Ingested records don't go to memtable and don't make the partition
+    // dirty. Their flush token stays invalid, which tells the donor that
+    // they're already durable.
+    std::unordered_set<const WriteOp*> ingested_ops;
+    size_t num_left = 0;
+    for (size_t i = 0; i < writes.size(); ++i) {
+      if (ingested[i]) {
+        ingested_ops.insert(writes[i]);
+        continue;
+      }
+      writes[num_left] = writes[i];
+      cf_ptrs[num_left] = std::move(cf_ptrs[i]);
+      ++num_left;
+    }
+    writes.resize(num_left);
+    cf_ptrs.resize(num_left);
+    if (!ingested_ops.empty()) {
+      dirty_ops.erase(std::remove_if(dirty_ops.begin(),
+                                     dirty_ops.end(),
+                                     [&](const DirtyOp& op) {
+                                       return ingested_ops.count(op.write_op);
+                                     }),
+                      dirty_ops.end());
+    }
+  }
+
   // Go over all holders and mark beginning of write on the partition.
   std::vector<rocksdb::ColumnFamilyHandle*> cf_handles;
   cf_handles.reserve(cf_ptrs.size());
@@ -3638,6 +4254,11 @@ int PartitionedRocksDBStore::dropPartitions(
       locked_accessor.erase(partition->cf_->getID());
     }
   });
+  if (IOTracing* io_tracing = getIOTracing()) {
+    for (const auto& partition : partitions) {
+      io_tracing->unregisterColumnFamily(partition->cf_->getID());
+    }
+  }
 
   partitions_.popUpTo(oldest_to_keep);
 
@@ -3645,10 +4266,12 @@ int PartitionedRocksDBStore::dropPartitions(
   // They will see that partition is dropped and choose another partition.
   partition_locks.clear();
 
-  // 4d) Drop column families.
+  // 4d) Drop column families. Idle pooled iterators would keep the dropped
+  // data alive, destroy them first.
   std::vector<rocksdb::ColumnFamilyHandle*> cf_handles;
   cf_handles.reserve(partitions.size());
   for (auto& partition : partitions) {
+    getIteratorPool()->dropColumnFamily(partition->cf_->getID());
     cf_handles.push_back(partition->cf_->get());
   }
 
@@ -4453,6 +5076,9 @@ int PartitionedRocksDBStore::trimLogsBasedOnTime(
   const auto settings = getSettings();
   const auto now = currentTime().toSeconds();
   partition_id_t oldest_to_keep = latest;
+  // Log with non-trimmed records in oldest_to_keep, and its backlog duration.
+  logid_t pinning_log = LOGID_INVALID;
+  folly::Optional<std::chrono::seconds> pinning_backlog;
 
   PartitionDirectoryIterator iterator(*this);
   while (iterator.nextLog()) {
@@ -4543,7 +5169,11 @@ int PartitionedRocksDBStore::trimLogsBasedOnTime(
            partitions->get(next_partition)->starting_timestamp >
                cutoff_timestamp)) {
         // This is first partition that has non-trimmed records for this log.
-        oldest_to_keep = std::min(oldest_to_keep, partition);
+        if (partition < oldest_to_keep) {
+          oldest_to_keep = partition;
+          pinning_log = log_id;
+          pinning_backlog = backlog;
+        }
         break;
       }
 
@@ -4593,6 +5223,7 @@ int PartitionedRocksDBStore::trimLogsBasedOnTime(
       if (partition->isUnderReplicated() &&
           max_timestamp >= min_cutoff_timestamp) {
         oldest_to_keep = min_dirty_partition;
+        pinning_log = LOGID_INVALID;
         break;
       }
       ++min_dirty_partition;
@@ -4616,6 +5247,23 @@ int PartitionedRocksDBStore::trimLogsBasedOnTime(
 
   if (out_oldest_to_keep != nullptr) {
     *out_oldest_to_keep = oldest_to_keep;
+
+    logid_t prev_pinning_log =
+        logid_t(retention_pinning_log_.exchange(pinning_log.val_));
+    if (pinning_log != LOGID_INVALID && pinning_log != prev_pinning_log) {
+      // Every partition from oldest_to_keep on is kept alive by this log.
+      // If its backlog duration is much longer than that of most logs, space
+      // taken by the other logs is only reclaimed by compactions.
+      ld_info("Log %lu with backlog duration %s is keeping partitions "
+              "[%lu, %lu] from being dropped in shard %u",
+              pinning_log.val_,
+              pinning_backlog.has_value()
+                  ? chrono_string(pinning_backlog.value()).c_str()
+                  : "infinite",
+              oldest_to_keep,
+              latest,
+              getShardIdx());
+    }
   }
 
   return LocalLogStoreUtils::updateTrimPoints(new_trim_points,
@@ -5592,6 +6240,99 @@ uint64_t PartitionedRocksDBStore::getApproximateObsoleteBytes(
   return res;
 }
 
+const char*
+PartitionedRocksDBStore::partitionTierName(PartitionTier tier) {
+  switch (tier) {
+    case PartitionTier::HOT:
+      return "hot";
+    case PartitionTier::WARM:
+      return "warm";
+    case PartitionTier::COLD:
+      return "cold";
+  }
+  ld_check(false);
+  return "unknown";
+}
+
+PartitionedRocksDBStore::PartitionTier
+PartitionedRocksDBStore::getPartitionTier(const PartitionPtr& partition) {
+  if (partition->offloaded_bytes.load() > 0) {
+    return PartitionTier::COLD;
+  }
+  PartitionPtr next_partition;
+  if (partition->id_ + 1 > latest_.get()->id_ ||
+      !getPartition(partition->id_ + 1, &next_partition)) {
+    // Latest or dropped.
+    return PartitionTier::HOT;
+  }
+  // Approximate minimum age of records in partition.
+  auto age = std::chrono::duration_cast<std::chrono::seconds>(
+      currentTime() - next_partition->starting_timestamp);
+  return age < getSettings()->partition_hot_age_ ? PartitionTier::HOT
+                                                 : PartitionTier::WARM;
+}
+
+void PartitionedRocksDBStore::offloadColdPartitions() {
+  const std::chrono::seconds cold_age = getSettings()->partition_cold_age_;
+  if (cold_age.count() == 0) {
+    return;
+  }
+
+  auto partitions = getPartitionList();
+  const auto now = currentTime();
+  for (partition_id_t id = partitions->firstID(); id + 1 < partitions->nextID();
+       ++id) {
+    if (shutdown_event_.signaled() || inFailSafeMode()) {
+      return;
+    }
+    PartitionPtr partition = partitions->get(id);
+    PartitionPtr next_partition = partitions->get(id + 1);
+    ld_check(partition);
+    ld_check(next_partition);
+    auto age = std::chrono::duration_cast<std::chrono::seconds>(
+        now - next_partition->starting_timestamp);
+    if (age < cold_age) {
+      // Partitions are in chronological order, the rest are younger.
+      break;
+    }
+
+    uint64_t memtables_size = 0;
+    if (db_->GetIntProperty(partition->cf_->get(),
+                            rocksdb::DB::Properties::kCurSizeAllMemTables,
+                            &memtables_size) &&
+        memtables_size > 0) {
+      // Not flushed yet (e.g. rebuilding writes); the set of sst files is
+      // about to change.
+      continue;
+    }
+
+    rocksdb::ColumnFamilyMetaData cf_meta;
+    db_->GetColumnFamilyMetaData(partition->cf_->get(), &cf_meta);
+    std::vector<std::string> files;
+    for (const auto& level : cf_meta.levels) {
+      for (const auto& file : level.files) {
+        files.push_back(file.db_path + file.name);
+      }
+    }
+    std::sort(files.begin(), files.end());
+    if (files.empty() || files == partition->offloaded_files) {
+      continue;
+    }
+
+    uint64_t bytes = customiser_->offloadColdFiles(
+        shard_idx_, partition->cf_->get()->GetName(), files);
+    if (bytes > 0 && partition->offloaded_bytes.load() == 0) {
+      ld_info("Shard %u: offloaded %.3f MB of cold partition %lu in %lu files",
+              shard_idx_,
+              bytes / 1e6,
+              id,
+              files.size());
+    }
+    partition->offloaded_bytes.store(bytes);
+    partition->offloaded_files = std::move(files);
+  }
+}
+
 int PartitionedRocksDBStore::isEmpty() const {
   int res = isCFEmpty(unpartitioned_cf_->get());
   if (res != 1) {
@@ -5995,6 +6736,18 @@ SteadyTimestamp PartitionedRocksDBStore::currentSteadyTime() {
   return SteadyTimestamp::now();
 }
 
+bool PartitionedRocksDBStore::readIoRecentlyThrottled() {
+  const std::chrono::milliseconds backoff =
+      getSettings()->partition_compaction_read_throttle_backoff_;
+  ServerProcessor* processor = processor_.load();
+  if (backoff.count() <= 0 || processor == nullptr) {
+    return false;
+  }
+  // Unlike currentSteadyTime(), not mocked in tests: the throttling time
+  // comes from the real clock.
+  return processor->lastReadIoThrottled() > SteadyTimestamp::now() - backoff;
+}
+
 static void setBGThreadName(const char* pri, shard_index_t shard_idx) {
   // Make sure we'll squeeze into 15-character limit.
   ld_check_le(strlen(pri), 2);
@@ -6029,6 +6782,10 @@ void PartitionedRocksDBStore::hiPriBackgroundThreadRun() {
       createPartition();
     }
 
+    // Bound how long log metadata can stay buffered if the shard gets no
+    // other writes.
+    writer_->flushPendingLogMetadata();
+
     if (last_broadcast_flush_ < flushedUpThrough()) {
       ld_debug("Shard %d: Flushed up through now %ju.",
                getShardIdx(),
@@ -6178,9 +6935,17 @@ void PartitionedRocksDBStore::loPriBackgroundThreadRun() {
       }
     }
 
+    // Unless there are enough partial compactions to stall rebuilding,
+    // they can wait for reads to calm down.
+    const bool postpone_for_reads = !need_stall && readIoRecentlyThrottled();
+
     size_t num_partial_compactions_postponed = 0;
-    if (partial_compactions.size() >=
-        partition_partial_compaction_max_num_per_loop) {
+    if (postpone_for_reads) {
+      num_partial_compactions_postponed = partial_compactions.size();
+      partial_compactions.clear();
+      PER_SHARD_STAT_INCR(stats_, compactions_postponed_for_reads, shard_idx_);
+    } else if (partial_compactions.size() >=
+               partition_partial_compaction_max_num_per_loop) {
       // there are likely more partial compactions to process
       skip_sleep = true;
       num_partial_compactions_postponed = partial_compactions.size() -
@@ -6194,7 +6959,9 @@ void PartitionedRocksDBStore::loPriBackgroundThreadRun() {
               partial_compactions.end(),
               std::back_inserter(to_compact));
 
-    getPartitionsForProactiveCompaction(&to_compact);
+    if (!postpone_for_reads) {
+      getPartitionsForProactiveCompaction(&to_compact);
+    }
 
     // We only get lo-pri manual compactions if there are no other compactions
     // pending. But, we skip the delay if there are pending lo-pri manual
@@ -6258,6 +7025,8 @@ void PartitionedRocksDBStore::loPriBackgroundThreadRun() {
       }
     }
 
+    offloadColdPartitions();
+
     // Update stats for total trash size and the rate limit on its deletion
     PER_SHARD_STAT_SET(stats_, trash_size, shard_idx_, getTotalTrashSize());
     PER_SHARD_STAT_SET(stats_,
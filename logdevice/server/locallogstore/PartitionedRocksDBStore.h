@@ -14,6 +14,7 @@
 #include <limits>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include <folly/IntrusiveList.h>
@@ -35,6 +36,7 @@
 #include "logdevice/common/debug.h"
 #include "logdevice/common/util.h"
 #include "logdevice/server/FixedKeysMap.h"
+#include "logdevice/server/locallogstore/IOAttribution.h"
 #include "logdevice/server/locallogstore/NodeDirtyData.h"
 #include "logdevice/server/locallogstore/RocksDBLogStoreBase.h"
 #include "logdevice/server/locallogstore/RocksDBWriter.h"
@@ -286,6 +288,24 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
     // exclusively locked mutex_.
     bool is_dropped{false};
 
+    // True if some records in this partition were written without a copyset
+    // index entry, i.e. some directory entry pointing to this partition has
+    // the NO_COPYSET_INDEX flag. Readers don't use the copyset index in such
+    // partitions. Set before such records are written, never cleared.
+    std::atomic<bool> no_copyset_index{false};
+
+    // Number of bytes of this partition's sst files stored remotely, as last
+    // reported by RocksDBCustomiser::offloadColdFiles().
+    std::atomic<uint64_t> offloaded_bytes{0};
+
+    // Sst files last passed to offloadColdFiles(), sorted. Only accessed by
+    // offloadColdPartitions().
+    std::vector<std::string> offloaded_files;
+
+    // Reads and writes of this partition's files, see IOAttribution.
+    // Shared with rocksdb background jobs, which may outlive the partition.
+    const std::shared_ptr<IOStats> io_stats = std::make_shared<IOStats>();
+
     Partition(partition_id_t id,
               RocksDBCFPtr cf,
               RecordTimestamp starting_timestamp,
@@ -328,12 +348,45 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
                                          partition_id_t latest_id) const;
   };
 
+  // A sparse in-memory index of one log's records in one partition: a few
+  // (timestamp, lsn) pairs of actual records, increasing in both. FindTime
+  // uses it to narrow the range of LSNs it binary searches in the partition.
+  // Only covers records written since the store was opened.
+  struct FindTimeSamples {
+    struct Sample {
+      RecordTimestamp timestamp;
+      lsn_t lsn;
+    };
+
+    // Records a written record. Only takes a sample if `timestamp` is at
+    // least `interval` after the last sample, and ignores records that are
+    // out of order with it. When there are more than `max_samples` samples,
+    // drops every other one and doubles `interval`. max_samples == 0 clears
+    // the samples.
+    void add(RecordTimestamp timestamp, lsn_t lsn, size_t max_samples);
+
+    // Narrows (*lo, *hi] to the last sample stamped before `timestamp` and
+    // the first sample stamped at or after it. Leaves a bound unchanged if
+    // there's no such sample.
+    void lookup(RecordTimestamp timestamp, lsn_t* lo, lsn_t* hi) const;
+
+    bool empty() const {
+      return samples.empty();
+    }
+
+    std::vector<Sample> samples;
+    std::chrono::milliseconds interval{1};
+  };
+
   struct DirectoryEntry {
     partition_id_t id = PARTITION_INVALID;
     lsn_t first_lsn;
     lsn_t max_lsn;
     PartitionDirectoryValue::flags_t flags;
     size_t approximate_size_bytes = 0;
+    // Not persisted. Protected by LogState::mutex, like the rest of the
+    // in-memory directory.
+    FindTimeSamples find_time_samples;
 
     int fromIterator(const RocksDBIterator* it, logid_t log_id);
 
@@ -454,15 +507,22 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
                std::chrono::steady_clock::time_point deadline =
                    std::chrono::steady_clock::time_point::max()) const override;
 
-  // Approximate size of the data in the given log between the two timestamps.
+  // Approximate size of the data in the given log between the two timestamps,
+  // summed from the per-partition sizes kept in directory entries. Partitions
+  // only partially inside the range are interpolated linearly by time; if
+  // `out_error' is given, it's set to the most that the interpolation may be
+  // off by, i.e. the true size is in [*out - *out_error, *out + *out_error],
+  // up to the accuracy of the directory entries themselves.
   int dataSize(logid_t log_id,
                RecordTimestamp lo,
                RecordTimestamp hi,
-               size_t* out);
+               size_t* out,
+               size_t* out_error = nullptr);
   int dataSize(logid_t log_id,
                std::chrono::milliseconds lo,
                std::chrono::milliseconds hi,
-               size_t* out);
+               size_t* out,
+               size_t* out_error = nullptr);
 
   /**
    * Checks whether the given log has no records.
@@ -480,6 +540,31 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
 
   void normalizeTimeRanges(RecordTimeIntervals&) const override;
 
+  // Looks at directory entries of partitions whose time range intersects
+  // `rtis`. Logs that aren't partitioned (metadata and internal logs) are
+  // not reported.
+  int findLogsInTimeRanges(const RecordTimeIntervals& rtis,
+                           std::unordered_set<logid_t>* out) const override;
+
+  // Looks at the writes that a rocksdb::WalFilter saw replayed when the DB
+  // was opened. Also fails if a previous crash left partitions potentially
+  // under replicated: records written without WAL may have been lost.
+  int findLogsWrittenSince(uint64_t seqno,
+                           std::unordered_set<logid_t>* out) const override;
+
+  // What findLogsWrittenSince() knows about the writes replayed from the WAL
+  // when the DB was opened.
+  struct RecoveredWrites {
+    // Sequence number of the last replayed write to each data log.
+    std::unordered_map<logid_t, rocksdb::SequenceNumber> last_write;
+    // The last run of replayed writes without gaps in sequence numbers is
+    // [first_seqno, next_seqno).
+    rocksdb::SequenceNumber first_seqno{0};
+    rocksdb::SequenceNumber next_seqno{0};
+    // Set if a replayed batch couldn't be parsed.
+    bool invalid{false};
+  };
+
   /**
    * Implement the FindKey API. @see logdevice/common/FindKeyRequest.h.
    *
@@ -623,6 +708,17 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
   // trimming into account.
   uint64_t getApproximateObsoleteBytes(partition_id_t partition_id);
 
+  // Where a partition's data is, for reporting. See
+  // --rocksdb-partition-hot-age and --rocksdb-partition-cold-age.
+  enum class PartitionTier { HOT, WARM, COLD };
+  static const char* partitionTierName(PartitionTier tier);
+  PartitionTier getPartitionTier(const PartitionPtr& partition);
+
+  // Hands the sst files of partitions older than --rocksdb-partition-cold-age
+  // to RocksDBCustomiser::offloadColdFiles(). Called by the lo-pri background
+  // thread, must not be called concurrently with itself.
+  void offloadColdPartitions();
+
   // Returns rocksdb handle of metadata column family.
   rocksdb::ColumnFamilyHandle* getMetadataCFHandle() const override {
     return metadata_cf_->get();
@@ -742,6 +838,13 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
   //  - AGAIN if the store is not fully initialised (no processor),
   int trimLogsBasedOnTime();
 
+  // Log whose retention kept the oldest partition from being dropped the last
+  // time the background thread looked for partitions to drop. LOGID_INVALID
+  // if no log did, e.g. because the oldest partition is under-replicated.
+  logid_t getRetentionPinningLog() const {
+    return logid_t(retention_pinning_log_.load());
+  }
+
   // Puts all directory entries for the given partitions and logs in 'out'.
   // Empty 'partitions' or 'logs' is interpreted as 'all'.
   // `partitions` must be sorted.
@@ -1229,6 +1332,12 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
     LatestPartitionInfo latest_partition;
 
     // Information about partitions used by this log, keyed by their first_lsn
+    // This is an exact per-partition presence index for the log: a partition
+    // without an entry here has no records of the log, so readers never need
+    // to look into its column family. PartitionedAllLogsIterator builds its
+    // list of (partition, log) pairs to read from it (see
+    // getLogsDBDirectories()), and Iterator, FindTime and FindKey go through
+    // the on-disk copy of the same directory.
     std::map<lsn_t, DirectoryEntry> directory;
   };
 
@@ -1299,6 +1408,20 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
   // Called by the constructor. Populates directory in LogState for each log.
   bool readDirectories();
 
+  // Loads logs_ from the file written by writeDirectorySnapshot() on the last
+  // clean shutdown, if there is one and nothing was written to rocksdb since.
+  // Deletes the file unless read-only.
+  // @return true if logs_ was loaded, false if it's still empty and the
+  //         directory needs to be read from rocksdb.
+  bool readDirectorySnapshot();
+
+  // Writes the in-memory partition directory of all logs to a file in the
+  // shard's directory, along with rocksdb's latest sequence number. Called
+  // from joinBackgroundThreads() once nothing can write to the DB anymore.
+  void writeDirectorySnapshot();
+
+  std::string getDirectorySnapshotPath() const;
+
   // Called by the constructor.
   // Reads timestamps metadata for the given partition.
   bool readPartitionTimestamps(PartitionPtr partition);
@@ -1388,6 +1511,10 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
   //   the size of the record's payload in bytes; 0 for all operations except
   //   PUT. Used in order to update the byte size in logsdb directory entries.
   //
+  // @param no_copyset_index
+  //   true if the operation is a PUT without a copyset index entry. Sets the
+  //   NO_COPYSET_INDEX flag in the directory entry and in the partition.
+  //
   GetWritePartitionResult
   getWritePartition(logid_t log_id,
                     lsn_t lsn,
@@ -1398,7 +1525,8 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
                     rocksdb::WriteBatch& durable_batch,
                     PartitionPtr* out_partition,
                     size_t payload_size_bytes,
-                    LocalLogStoreRecordFormat::flags_t flags);
+                    LocalLogStoreRecordFormat::flags_t flags,
+                    bool no_copyset_index);
 
   // Gets the partition that best matches the given timestamp
   // (see Partition::starting_timestamp). Most records are written to their
@@ -1752,6 +1880,18 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
   // bytes written since last flush evaluation
   std::atomic<uint64_t> bytes_written_since_flush_eval_{0};
 
+  // rocksdb's latest sequence number right after the DB was opened, before
+  // we wrote anything. A directory snapshot is only valid at this number.
+  rocksdb::SequenceNumber sequence_number_at_open_{0};
+
+  // Writes replayed from the WAL when the DB was opened.
+  RecoveredWrites recovered_writes_;
+
+  // Set if any write failed. The in-memory directory is updated before the
+  // write that persists it, so after a failed write (e.g. during shutdown)
+  // it may not match rocksdb and must not be snapshotted.
+  std::atomic<bool> had_failed_writes_{false};
+
   // Protects last_flush_eval_stats_ and calls to throttleIOIfNeeded().
   // Can be locked on write path, so don't do anything slow while holding it.
   std::mutex throttle_eval_mutex_;
@@ -1776,6 +1916,9 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
   std::atomic<partition_id_t> max_under_replicated_partition_{
       PARTITION_INVALID};
 
+  // See getRetentionPinningLog().
+  std::atomic<logid_t::raw_type> retention_pinning_log_{LOGID_INVALID.val_};
+
   explicit PartitionedRocksDBStore(uint32_t shard_idx,
                                    uint32_t num_shards,
                                    const std::string& path,
@@ -1824,6 +1967,11 @@ class PartitionedRocksDBStore : public RocksDBLogStoreBase {
   // Hook to allow tests to override time.
   virtual SteadyTimestamp currentSteadyTime();
 
+  // True if read IO shaping throttled a read within the last
+  // partition_compaction_read_throttle_backoff_. Lo-pri background thread
+  // postpones non-urgent compactions while this is true.
+  bool readIoRecentlyThrottled();
+
   void onMemTableWindowUpdated() override;
 
   // Performs compaction of the partition. Removes obsolete partition directory
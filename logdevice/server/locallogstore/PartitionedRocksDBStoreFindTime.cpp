@@ -140,7 +140,13 @@ int PartitionedRocksDBStore::FindTime::execute(lsn_t* lo, lsn_t* hi) {
 
   // Do a search on the found column family.
   if (cf) {
-    int rv = partitionSearch(cf);
+    lsn_t search_lo = min_lo_;
+    lsn_t search_hi = max_hi_;
+    if (p && !use_index_ &&
+        narrowWithSamples(*p, p_first_lsn, &search_lo, &search_hi)) {
+      STAT_INCR(store_.getStatsHolder(), logsdb_findtime_narrowed_by_samples);
+    }
+    int rv = partitionSearch(cf, search_lo, search_hi);
     if (rv != 0) {
       if (err == E::WOULDBLOCK) {
         ld_check(!allow_blocking_io_);
@@ -419,16 +425,55 @@ int PartitionedRocksDBStore::FindTime::findPartition(
   return 0;
 }
 
+bool PartitionedRocksDBStore::FindTime::narrowWithSamples(
+    const Partition& partition,
+    lsn_t first_lsn,
+    lsn_t* search_lo,
+    lsn_t* search_hi) const {
+  auto logs_it = store_.logs_.find(logid_.val_);
+  if (logs_it == store_.logs_.cend()) {
+    return false;
+  }
+  LogState* log_state = logs_it->second.get();
+
+  lsn_t lo = LSN_INVALID;
+  lsn_t hi = LSN_MAX;
+  {
+    std::lock_guard<std::mutex> lock(log_state->mutex);
+    auto entry_it = log_state->directory.find(first_lsn);
+    if (entry_it == log_state->directory.end() ||
+        entry_it->second.id != partition.id_) {
+      // The directory entry changed since findPartition() looked at it.
+      return false;
+    }
+    entry_it->second.find_time_samples.lookup(timestamp_, &lo, &hi);
+  }
+
+  // Samples may be of records above max_hi_, which we must not return.
+  bool narrowed = false;
+  if (lo > *search_lo && lo < *search_hi) {
+    *search_lo = lo;
+    narrowed = true;
+  }
+  if (hi < *search_hi && hi > *search_lo) {
+    *search_hi = hi;
+    narrowed = true;
+  }
+  return narrowed;
+}
+
 int PartitionedRocksDBStore::FindTime::partitionSearch(
-    rocksdb::ColumnFamilyHandle* cf) const {
+    rocksdb::ColumnFamilyHandle* cf,
+    lsn_t search_lo,
+    lsn_t search_hi) const {
   IteratorSearch search(&store_,
                         cf,
                         FIND_TIME_INDEX,
                         timestamp_.toMilliseconds().count(),
                         std::string(""),
                         logid_,
-                        min_lo_,
-                        max_hi_,
+                        search_lo,
+                        search_hi,
                         allow_blocking_io_,
                         deadline_);
 
@@ -72,9 +72,28 @@ class PartitionedRocksDBStore::FindTime {
    * both a record stamped before `timestamp_` and a record stamped at or after.
    *
    * @param cf Column family on which to search.
+   * @param search_lo, search_hi  Range (search_lo, search_hi] of LSNs to
+   *                              search in.
    * @return 0 on success or -1 if there is an error reading from rocksdb.
    */
-  int partitionSearch(rocksdb::ColumnFamilyHandle* cf) const;
+  int partitionSearch(rocksdb::ColumnFamilyHandle* cf,
+                      lsn_t search_lo,
+                      lsn_t search_hi) const;
+
+  /**
+   * Narrows the range that partitionSearch() needs to search in
+   * `partition`, using the in-memory samples of the directory entry with
+   * the given first_lsn. See PartitionedRocksDBStore::FindTimeSamples.
+   * Takes LogState::mutex; no IO.
+   *
+   * @param search_lo, search_hi  Range to narrow; both bounds are LSNs of
+   *                              actual records or left unchanged.
+   * @return true if the range was narrowed.
+   */
+  bool narrowWithSamples(const Partition& partition,
+                         lsn_t first_lsn,
+                         lsn_t* search_lo,
+                         lsn_t* search_hi) const;
 
   bool isTimedOut() const {
     return std::chrono::steady_clock::now() >= deadline_;
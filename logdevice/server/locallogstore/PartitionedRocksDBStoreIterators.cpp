@@ -16,6 +16,19 @@ namespace facebook { namespace logdevice {
 using RocksDBKeyFormat::PartitionDirectoryKey;
 using Location = LocalLogStore::AllLogsIterator::Location;
 
+// Read options for a data iterator in a partition. The copyset index is
+// incomplete in partitions that have records written without it, so it can't
+// be used to read them.
+static LocalLogStore::ReadOptions
+partitionReadOptions(const LocalLogStore::ReadOptions& options,
+                     bool no_copyset_index) {
+  LocalLogStore::ReadOptions res = options;
+  if (no_copyset_index) {
+    res.allow_copyset_index = false;
+  }
+  return res;
+}
+
 // ==== Iterator ====
 
 PartitionedRocksDBStore::Iterator::Iterator(
@@ -47,9 +60,20 @@ void PartitionedRocksDBStore::Iterator::setDataIteratorFromCurrent(
 
   RecordTimestamp min_ts, max_ts;
   if (!filter || checkFilterTimeRange(*filter, &min_ts, &max_ts)) {
+    const bool no_copyset_index = current_.partition_->no_copyset_index.load();
+    if (data_iterator_ != nullptr && no_copyset_index &&
+        data_iterator_->usesCopySetIndex()) {
+      // Records without copyset index were written to the partition since the
+      // iterator was created.
+      data_iterator_.reset();
+    }
     if (data_iterator_ == nullptr) {
       data_iterator_ = std::make_unique<RocksDBLocalLogStore::CSIWrapper>(
-          pstore_, log_id_, options_, current_.partition_->cf_->get());
+          pstore_,
+          log_id_,
+          partitionReadOptions(options_, no_copyset_index),
+          current_.partition_->cf_->get());
+      data_iterator_->io_stats_ = current_.partition_->io_stats.get();
     }
     data_iterator_->min_ts_ = min_ts;
     data_iterator_->max_ts_ = max_ts;
@@ -1157,13 +1181,19 @@ void PartitionedRocksDBStore::PartitionedAllLogsIterator::seekToCurrentEntry(
       continue;
     }
 
+    const bool no_copyset_index = current_partition_->no_copyset_index.load();
+    if (data_iterator_ != nullptr && no_copyset_index &&
+        data_iterator_->usesCopySetIndex()) {
+      data_iterator_.reset();
+    }
     if (data_iterator_ == nullptr) {
       // Create iterator in current partition.
       data_iterator_ = std::make_unique<RocksDBLocalLogStore::CSIWrapper>(
           pstore_,
           /* log_id */ folly::none,
-          options_,
+          partitionReadOptions(options_, no_copyset_index),
           current_partition_->cf_->get());
+      data_iterator_->io_stats_ = current_partition_->io_stats.get();
       data_iterator_->min_ts_ = min_ts;
       data_iterator_->max_ts_ = max_ts;
 
@@ -1208,6 +1238,29 @@ void PartitionedRocksDBStore::PartitionedAllLogsIterator::seekToCurrentEntry(
   current_partition_ = nullptr;
 }
 
+int PartitionedRocksDBStore::PartitionedAllLogsIterator::compareLocations(
+    const Location& base_lhs,
+    const Location& base_rhs) const {
+  const PartitionedLocation& lhs =
+      checked_downcast<const PartitionedLocation&>(base_lhs);
+  const PartitionedLocation& rhs =
+      checked_downcast<const PartitionedLocation&>(base_rhs);
+  if (lhs.partition != rhs.partition) {
+    // Unpartitioned column family is visited before all partitions.
+    if (lhs.partition == PARTITION_INVALID) {
+      return -1;
+    }
+    if (rhs.partition == PARTITION_INVALID) {
+      return +1;
+    }
+    return whichPartitionToVisitEarlier(lhs.partition, rhs.partition);
+  }
+  if (std::tie(lhs.log, lhs.lsn) == std::tie(rhs.log, rhs.lsn)) {
+    return 0;
+  }
+  return std::tie(lhs.log, lhs.lsn) < std::tie(rhs.log, rhs.lsn) ? -1 : +1;
+}
+
 std::unique_ptr<Location>
 PartitionedRocksDBStore::PartitionedAllLogsIterator::minLocation() const {
   return std::make_unique<PartitionedLocation>(
@@ -1243,6 +1296,7 @@ void PartitionedRocksDBStore::PartitionedAllLogsIterator::
     progress_lookup_.at(i) = sum_so_far;
     sum_so_far += directory_[i].second.approximate_size_bytes;
   }
+  total_bytes_estimate_ = sum_so_far;
 
   if (sum_so_far != 0) {
     for (double& x : progress_lookup_) {
@@ -1273,6 +1327,11 @@ PartitionedRocksDBStore::PartitionedAllLogsIterator::getProgress() const {
   return progress_lookup_.at(i);
 }
 
+uint64_t PartitionedRocksDBStore::PartitionedAllLogsIterator::
+    getTotalBytesEstimate() const {
+  return total_bytes_estimate_;
+}
+
 // ==== PartitionDirectoryIterator ====
 
 bool PartitionedRocksDBStore::PartitionDirectoryIterator::error() {
@@ -263,12 +263,16 @@ class PartitionedRocksDBStore::PartitionedAllLogsIterator
   Slice getRecord() const override;
   std::unique_ptr<Location> getLocation() const override;
   double getProgress() const override;
+  uint64_t getTotalBytesEstimate() const override;
 
   void seek(const Location& location,
             ReadFilter* filter = nullptr,
             ReadStats* stats = nullptr) override;
   void next(ReadFilter* filter = nullptr, ReadStats* stats = nullptr) override;
 
+  int compareLocations(const Location& lhs,
+                       const Location& rhs) const override;
+
   std::unique_ptr<Location> minLocation() const override;
   std::unique_ptr<Location> metadataLogsBegin() const override;
 
@@ -313,6 +317,8 @@ class PartitionedRocksDBStore::PartitionedAllLogsIterator
   // on directory entry i, getProgress() reports progress_lookup_[i].
   // Precalculated based on data size estimates in directory.
   std::vector<double> progress_lookup_;
+  // Sum of data size estimates in directory_, plus size of unpartitioned CF.
+  uint64_t total_bytes_estimate_ = 0;
 
   // Copy of the logsdb directory for the requested data logs.
   std::vector<LogDirectoryEntry> directory_;
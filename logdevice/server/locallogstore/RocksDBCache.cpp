@@ -7,6 +7,14 @@
  */
 #include "logdevice/server/locallogstore/RocksDBCache.h"
 
+#include <rocksdb/version.h>
+#if ROCKSDB_MAJOR > 5 || (ROCKSDB_MAJOR == 5 && ROCKSDB_MINOR >= 18)
+#include <rocksdb/memory_allocator.h>
+#define LOGDEVICE_ROCKSDB_HAS_MEMORY_ALLOCATOR
+#endif
+
+#include "logdevice/common/debug.h"
+
 namespace facebook { namespace logdevice {
 
 RocksDBCache::RocksDBCache(UpdateableSettings<RocksDBSettings> rocksdb_settings)
@@ -15,6 +23,26 @@ RocksDBCache::RocksDBCache(UpdateableSettings<RocksDBSettings> rocksdb_settings)
   opt.capacity = rocksdb_settings_->cache_size_;
   opt.num_shard_bits = rocksdb_settings_->cache_numshardbits_;
   opt.high_pri_pool_ratio = rocksdb_settings_->cache_high_pri_pool_ratio_;
+#ifdef LOGDEVICE_ROCKSDB_HAS_MEMORY_ALLOCATOR
+  if (rocksdb_settings_->cache_dedicated_arena_) {
+    rocksdb::JemallocAllocatorOptions allocator_opts;
+    std::shared_ptr<rocksdb::MemoryAllocator> allocator;
+    rocksdb::Status s =
+        rocksdb::NewJemallocNodumpAllocator(allocator_opts, &allocator);
+    if (s.ok()) {
+      opt.memory_allocator = std::move(allocator);
+    } else {
+      ld_warning("Could not create a dedicated jemalloc arena for the block "
+                 "cache, using the default allocator: %s",
+                 s.ToString().c_str());
+    }
+  }
+#else
+  if (rocksdb_settings_->cache_dedicated_arena_) {
+    ld_warning("--rocksdb-cache-dedicated-arena requires rocksdb 5.18 or "
+               "higher, ignoring");
+  }
+#endif
 
   cache_ = rocksdb::NewLRUCache(opt);
 }
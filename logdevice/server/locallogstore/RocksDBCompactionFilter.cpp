@@ -448,6 +448,17 @@ void RocksDBCompactionFilter::getTrimInfo(logid_t log_id) {
     return;
   }
 
+  auto it = std::lower_bound(
+      trim_info_snapshot_.begin(),
+      trim_info_snapshot_.end(),
+      log_id,
+      [](const TrimInfoCache& info, logid_t id) { return info.log_id < id; });
+  if (it != trim_info_snapshot_.end() && it->log_id == log_id) {
+    // Already looked up earlier in this compaction
+    cache = *it;
+    return;
+  }
+
   lsn_t trim_point{LSN_INVALID};
   folly::Optional<std::chrono::milliseconds> cutoff_timestamp;
   folly::Optional<epoch_t> per_epoch_log_metadata_trim_point;
@@ -500,6 +511,8 @@ void RocksDBCompactionFilter::getTrimInfo(logid_t log_id) {
   cache.trim_point = trim_point;
   cache.cutoff_timestamp = cutoff_timestamp;
   cache.per_epoch_log_metadata_trim_point = per_epoch_log_metadata_trim_point;
+  // Logs are mostly visited in increasing order, so this is usually an append.
+  trim_info_snapshot_.insert(it, cache);
 }
 
 void RocksDBCompactionFilter::noteLogSkipped(logid_t log_id) {
@@ -148,6 +148,13 @@ class RocksDBCompactionFilter : public rocksdb::CompactionFilter {
     folly::Optional<epoch_t> per_epoch_log_metadata_trim_point;
   } cache;
 
+  // Trim info of all logs looked up during this compaction, sorted by log ID.
+  // Compaction visits data keys, copyset index keys and findKey index keys
+  // in separate passes over the same logs, so `cache' alone would go back to
+  // LogStorageStateMap and the config for every log in each pass. This also
+  // makes all passes of one compaction see the same trim point of a log.
+  std::vector<TrimInfoCache> trim_info_snapshot_;
+
   virtual std::chrono::milliseconds currentTime();
 
   // Makes sure `cache' is filled with information about the given log.
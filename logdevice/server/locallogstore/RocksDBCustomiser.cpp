@@ -273,4 +273,11 @@ rocksdb::Status RocksDBCustomiser::openReadOnlyDB(
                                       error_if_log_file_exist);
 }
 
+uint64_t RocksDBCustomiser::offloadColdFiles(
+    shard_index_t /*shard_idx*/,
+    const std::string& /*column_family*/,
+    const std::vector<std::string>& /*files*/) {
+  return 0;
+}
+
 }} // namespace facebook::logdevice
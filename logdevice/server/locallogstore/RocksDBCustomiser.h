@@ -95,6 +95,25 @@ class RocksDBCustomiser {
       std::vector<rocksdb::ColumnFamilyHandle*>* handles,
       rocksdb::DB** dbptr,
       bool error_if_log_file_exist = false);
+
+  // Tiered storage, see --rocksdb-partition-cold-age.
+  //
+  // Called from a LogsDB background thread with the full paths of the sst
+  // files of a partition that became cold: old enough to be rarely read and
+  // only written to by rebuilding, if at all. The customiser may upload the
+  // files to remote storage and free their local copies, as long as the Env
+  // returned from getEnv() keeps serving them, e.g. by fetching them back
+  // into a local cache on first access. rocksdb may still delete any of these
+  // files later (compaction, partition drop) through the same Env. If the set
+  // of sst files of the partition changes, this method is called again with
+  // the new set.
+  //
+  // @return number of bytes of `files` that are stored remotely after this
+  //         call. The default implementation keeps all files local and
+  //         returns 0.
+  virtual uint64_t offloadColdFiles(shard_index_t shard_idx,
+                                    const std::string& column_family,
+                                    const std::vector<std::string>& files);
 };
 
 class RocksDBCustomiserFactory : public Plugin {
@@ -7,15 +7,20 @@
  */
 #include "logdevice/server/locallogstore/RocksDBEnv.h"
 
+#include <fcntl.h>
+
 #include <boost/algorithm/string/predicate.hpp>
 #include <folly/Optional.h>
 #include <folly/ThreadLocal.h>
+#include <folly/small_vector.h>
 
 #include "logdevice/common/ThreadID.h"
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/common/util.h"
+#include "logdevice/server/locallogstore/IOAttribution.h"
+#include "logdevice/server/locallogstore/IOUring.h"
 #include "logdevice/server/locallogstore/LocalLogStore.h"
 #include "logdevice/server/locallogstore/ShardedRocksDBLocalLogStore.h"
 
@@ -75,6 +80,10 @@ void RocksDBEnv::bgJobRun(void* arg) {
 
   // Clean up after RocksDBListener.
   thread_state.io_tracing_context.clear();
+  if (thread_state.io_stats) {
+    IOAttribution::setPartition(nullptr);
+    thread_state.io_stats.reset();
+  }
 }
 
 void RocksDBEnv::bgJobUnschedule(void* arg) {
@@ -115,6 +124,16 @@ IOTracing::AddContext* RocksDBEnv::backgroundJobContextOfThisThread() {
   return &thread_state.io_tracing_context;
 }
 
+void RocksDBEnv::setBackgroundJobIOStats(std::shared_ptr<IOStats> io_stats) {
+  BGThreadState& thread_state = *bg_threads_;
+  if (ThreadID::getType() != ThreadID::Type::ROCKSDB ||
+      !thread_state.running_a_job) {
+    return;
+  }
+  IOAttribution::setPartition(io_stats.get());
+  thread_state.io_stats = std::move(io_stats);
+}
+
 rocksdb::Status
 RocksDBEnv::WritableFileOpImpl(WritableFileOp op,
                                const char* op_name,
@@ -274,8 +293,26 @@ RocksDBEnv::NewRandomAccessFile(const std::string& f,
       return status;
     }
   }
+  int fd = -1;
+  if (settings_->io_uring_queue_depth > 0) {
+    // rocksdb doesn't expose the descriptor of the file it opened, so open
+    // another one for io_uring. If this fails we just won't use io_uring for
+    // this file.
+    int flags = O_RDONLY | O_CLOEXEC;
+    if (options.use_direct_reads) {
+      flags |= O_DIRECT;
+    }
+    fd = ::open(f.c_str(), flags);
+    if (fd < 0) {
+      RATELIMIT_WARNING(std::chrono::seconds(10),
+                        2,
+                        "Failed to open %s for io_uring reads: %s",
+                        f.c_str(),
+                        strerror(errno));
+    }
+  }
   *r = std::make_unique<RocksDBRandomAccessFile>(
-      std::move(file), tracing, settings_);
+      std::move(file), tracing, settings_, stats_, fd);
   return rocksdb::Status::OK();
 }
 rocksdb::Status
@@ -431,14 +468,28 @@ rocksdb::Status RocksDBSequentialFile::PositionedRead(uint64_t offset,
 RocksDBRandomAccessFile::RocksDBRandomAccessFile(
     std::unique_ptr<rocksdb::RandomAccessFile> file,
     FileTracingInfo tracing,
-    UpdateableSettings<RocksDBSettings> settings)
+    UpdateableSettings<RocksDBSettings> settings,
+    StatsHolder* stats,
+    int fd)
     : rocksdb::RandomAccessFileWrapper(file.get()),
       file_(std::move(file)),
       tracing_(tracing),
-      settings_(settings) {}
+      settings_(settings),
+      stats_(stats),
+      fd_(fd) {}
 RocksDBRandomAccessFile::~RocksDBRandomAccessFile() {
   SCOPED_IO_TRACED_OP(tracing_.io_tracing, "rf:{}|close", tracing_.filename);
   file_.reset();
+  if (fd_ != -1) {
+    ::close(fd_);
+  }
+}
+void RocksDBRandomAccessFile::maybeStallForTesting() const {
+  while (UNLIKELY(settings_->test_stall_sst_reads) &&
+         boost::ends_with(tracing_.filename, ".sst")) {
+    // Re-check the setting every 100ms.
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
 }
 rocksdb::Status RocksDBRandomAccessFile::Read(uint64_t offset,
                                               size_t n,
@@ -449,13 +500,60 @@ rocksdb::Status RocksDBRandomAccessFile::Read(uint64_t offset,
                       tracing_.filename,
                       offset,
                       n);
-  while (UNLIKELY(settings_->test_stall_sst_reads) &&
-         boost::ends_with(tracing_.filename, ".sst")) {
-    // Re-check the setting every 100ms.
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  maybeStallForTesting();
+  auto start_time = std::chrono::steady_clock::now();
+  auto s = rocksdb::RandomAccessFileWrapper::Read(offset, n, result, scratch);
+  IOAttribution::onRead(stats_,
+                        tracing_.shard_idx,
+                        std::chrono::steady_clock::now() - start_time,
+                        result->size());
+  return s;
+}
+#ifdef LOGDEVICED_ROCKSDB_HAS_MULTIREAD
+rocksdb::Status RocksDBRandomAccessFile::MultiRead(rocksdb::ReadRequest* reqs,
+                                                   size_t num_reqs) {
+  IOUring* ring = fd_ != -1 && num_reqs > 1
+      ? IOUring::forThisThread(settings_->io_uring_queue_depth)
+      : nullptr;
+  if (ring == nullptr) {
+    // The default implementation calls Read() for each request.
+    return rocksdb::RandomAccessFile::MultiRead(reqs, num_reqs);
   }
-  return rocksdb::RandomAccessFileWrapper::Read(offset, n, result, scratch);
+
+  SCOPED_IO_TRACED_OP(tracing_.io_tracing,
+                      "rf:{}|MultiRead|n:{}",
+                      tracing_.filename,
+                      num_reqs);
+  maybeStallForTesting();
+
+  folly::small_vector<IOUring::Read, 16> reads(num_reqs);
+  for (size_t i = 0; i < num_reqs; ++i) {
+    reads[i] = {fd_, reqs[i].offset, reqs[i].len, reqs[i].scratch, 0};
+  }
+  auto start_time = std::chrono::steady_clock::now();
+  ring->readAll(reads.data(), num_reqs);
+  auto duration = std::chrono::steady_clock::now() - start_time;
+  STAT_INCR(stats_, io_uring_batches);
+  STAT_ADD(stats_, io_uring_reads, num_reqs);
+
+  for (size_t i = 0; i < num_reqs; ++i) {
+    if (reads[i].result < 0) {
+      reqs[i].result = rocksdb::Slice();
+      reqs[i].status = rocksdb::Status::IOError(
+          "io_uring read of " + tracing_.filename + " failed",
+          strerror(-reads[i].result));
+    } else {
+      reqs[i].result = rocksdb::Slice(reqs[i].scratch, reads[i].result);
+      reqs[i].status = rocksdb::Status::OK();
+    }
+    // The reads of a batch run concurrently, so each of them took about as
+    // long as the batch.
+    IOAttribution::onRead(
+        stats_, tracing_.shard_idx, duration, reqs[i].result.size());
+  }
+  return rocksdb::Status::OK();
 }
+#endif
 rocksdb::Status RocksDBRandomAccessFile::Prefetch(uint64_t offset, size_t n) {
   SCOPED_IO_TRACED_OP(tracing_.io_tracing,
                       "rf:{}|Prefetch|off:{}|sz:{}",
@@ -514,6 +612,7 @@ FileTracingInfo RocksDBEnv::tracingInfoForPath(const std::string& path) {
           path, &shard_idx, &info.filename) &&
       shard_idx < io_tracing_by_shard_.size()) {
     info.io_tracing = io_tracing_by_shard_[shard_idx];
+    info.shard_idx = shard_idx;
   } else {
     // If path is in unexpected format, leave io_tracing null.
     info.filename = path;
@@ -539,7 +638,13 @@ rocksdb::Status RocksDBWritableFile::Append(const rocksdb::Slice& data) {
                       "wf:{}|Append|sz:{}",
                       tracing_.filename,
                       data.size());
-  return rocksdb::WritableFileWrapper::Append(data);
+  auto start_time = std::chrono::steady_clock::now();
+  auto s = rocksdb::WritableFileWrapper::Append(data);
+  IOAttribution::onWrite(stats_,
+                         tracing_.shard_idx,
+                         std::chrono::steady_clock::now() - start_time,
+                         data.size());
+  return s;
 }
 rocksdb::Status
 RocksDBWritableFile::PositionedAppend(const rocksdb::Slice& data,
@@ -549,7 +654,13 @@ RocksDBWritableFile::PositionedAppend(const rocksdb::Slice& data,
                       tracing_.filename,
                       offset,
                       data.size());
-  return rocksdb::WritableFileWrapper::PositionedAppend(data, offset);
+  auto start_time = std::chrono::steady_clock::now();
+  auto s = rocksdb::WritableFileWrapper::PositionedAppend(data, offset);
+  IOAttribution::onWrite(stats_,
+                         tracing_.shard_idx,
+                         std::chrono::steady_clock::now() - start_time,
+                         data.size());
+  return s;
 }
 rocksdb::Status RocksDBWritableFile::Truncate(uint64_t size) {
   SCOPED_IO_TRACED_OP(
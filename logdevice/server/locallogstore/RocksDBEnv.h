@@ -25,6 +25,10 @@
 #define LOGDEVICED_ROCKSDB_HAS_WRAPPERS
 #endif
 
+#if ROCKSDB_MAJOR > 6 || (ROCKSDB_MAJOR == 6 && ROCKSDB_MINOR >= 4)
+#define LOGDEVICED_ROCKSDB_HAS_MULTIREAD
+#endif
+
 namespace facebook { namespace logdevice {
 
 class StatsHolder;
@@ -32,6 +36,8 @@ class StatsHolder;
 struct FileTracingInfo {
   IOTracing* io_tracing = nullptr;
   std::string filename;
+  // -1 if the path is in unexpected format.
+  shard_index_t shard_idx = -1;
 };
 
 /**
@@ -79,6 +85,12 @@ class RocksDBEnv : public rocksdb::EnvWrapper {
   // then RocksDBEnv's job wrapper clears it.
   IOTracing::AddContext* backgroundJobContextOfThisThread();
 
+  // Attributes the IO of the background job running on this thread to the
+  // column family with the given IO counters, until the job ends. Used by
+  // RocksDBListener the same way as backgroundJobContextOfThisThread().
+  // No-op if not called from a background job.
+  void setBackgroundJobIOStats(std::shared_ptr<IOStats> io_stats);
+
   // We wrap all background jobs to:
   //  (a) set information in ThreadID needed to identify rocksdb bg threads,
   //  (b) change io priority if rocksdb-low-ioprio setting is set,
@@ -169,6 +181,8 @@ class RocksDBEnv : public rocksdb::EnvWrapper {
     bool initialized = false;
     bool running_a_job = false;
     IOTracing::AddContext io_tracing_context;
+    // Keeps alive the counters passed to IOAttribution::setPartition().
+    std::shared_ptr<IOStats> io_stats;
   };
 
   UpdateableSettings<RocksDBSettings> settings_;
@@ -270,17 +284,26 @@ class RocksDBSequentialFile : public rocksdb::SequentialFileWrapper {
   FileTracingInfo tracing_;
 };
 
+// If `fd` is not -1, it's a separate descriptor of the same file, used for
+// submitting MultiRead() batches through io_uring (see
+// rocksdb-io-uring-queue-depth setting). The file takes ownership of it.
 class RocksDBRandomAccessFile : public rocksdb::RandomAccessFileWrapper {
  public:
   RocksDBRandomAccessFile(std::unique_ptr<rocksdb::RandomAccessFile> file,
                           FileTracingInfo tracing,
-                          UpdateableSettings<RocksDBSettings> settings);
+                          UpdateableSettings<RocksDBSettings> settings,
+                          StatsHolder* stats = nullptr,
+                          int fd = -1);
   ~RocksDBRandomAccessFile() override;
 
   rocksdb::Status Read(uint64_t offset,
                        size_t n,
                        rocksdb::Slice* result,
                        char* scratch) const override;
+#ifdef LOGDEVICED_ROCKSDB_HAS_MULTIREAD
+  rocksdb::Status MultiRead(rocksdb::ReadRequest* reqs,
+                            size_t num_reqs) override;
+#endif
   rocksdb::Status Prefetch(uint64_t offset, size_t n) override;
   size_t GetUniqueId(char* id, size_t max_size) const override;
   void Hint(AccessPattern pattern) override;
@@ -290,6 +313,10 @@ class RocksDBRandomAccessFile : public rocksdb::RandomAccessFileWrapper {
   std::unique_ptr<rocksdb::RandomAccessFile> file_;
   FileTracingInfo tracing_;
   UpdateableSettings<RocksDBSettings> settings_;
+  StatsHolder* stats_;
+  int fd_;
+
+  void maybeStallForTesting() const;
 };
 
 class RocksDBDirectory : public rocksdb::DirectoryWrapper {
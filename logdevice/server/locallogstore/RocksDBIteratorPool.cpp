@@ -0,0 +1,280 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/locallogstore/RocksDBIteratorPool.h"
+
+#include <limits>
+
+#include <folly/Conv.h>
+
+#include "logdevice/common/debug.h"
+#include "logdevice/common/stats/Stats.h"
+
+namespace facebook { namespace logdevice {
+
+constexpr size_t RocksDBIteratorPool::ENTRY_OVERHEAD_BYTES;
+
+RocksDBIteratorPool::Handle::Handle(RocksDBIteratorPool* pool,
+                                    std::unique_ptr<Entry> entry)
+    : pool_(pool), entry_(std::move(entry)) {
+  ld_check(pool_ != nullptr);
+  ld_check(entry_ != nullptr);
+}
+
+RocksDBIteratorPool::Handle& RocksDBIteratorPool::Handle::
+operator=(Handle&& rhs) noexcept {
+  if (this != &rhs) {
+    reset();
+    pool_ = rhs.pool_;
+    entry_ = std::move(rhs.entry_);
+  }
+  return *this;
+}
+
+RocksDBIteratorPool::Handle::~Handle() {
+  reset();
+}
+
+RocksDBIterator& RocksDBIteratorPool::Handle::operator*() const {
+  ld_check(entry_ != nullptr);
+  return entry_->iterator_;
+}
+
+bool RocksDBIteratorPool::Handle::reused() const {
+  ld_check(entry_ != nullptr);
+  return entry_->reused_;
+}
+
+void RocksDBIteratorPool::Handle::reset() {
+  if (entry_ != nullptr) {
+    pool_->release(std::move(entry_));
+  }
+}
+
+RocksDBIteratorPool::Entry::Entry(const RocksDBLogStoreBase* store,
+                                  rocksdb::ColumnFamilyHandle* cf,
+                                  Key key,
+                                  folly::Optional<logid_t> upper_bound_log,
+                                  rocksdb::ReadOptions options)
+    : store_(store), cf_(cf), key_(key), upper_bound_(upper_bound_log) {
+  options.iterate_upper_bound =
+      upper_bound_log.has_value() ? &upper_bound_.upper_bound : nullptr;
+  iterator_ = store_->newIterator(options, cf_);
+}
+
+void RocksDBIteratorPool::Entry::setLog(logid_t log_id) {
+  ld_check(key_.has_upper_bound);
+  // Rewrites the key in place: the iterator's ReadOptions point at
+  // upper_bound_.upper_bound, which keeps pointing at data_key.
+  upper_bound_.data_key =
+      RocksDBKeyFormat::DataKey(log_id, std::numeric_limits<lsn_t>::max());
+  upper_bound_.upper_bound = upper_bound_.data_key.sliceForBackwardSeek();
+}
+
+void RocksDBIteratorPool::Entry::onPooled(size_t pinned_bytes) {
+  pinned_bytes_ = pinned_bytes;
+  if (!tracking_registered_) {
+    registerTracking(cf_->GetName(),
+                     LOGID_INVALID,
+                     key_.tailing,
+                     key_.read_tier != rocksdb::kBlockCacheTier,
+                     IteratorType::POOLED,
+                     TrackingContext());
+    tracking_registered_ = true;
+  }
+  setContextString("idle");
+  trackPinnedBytes(pinned_bytes);
+  trackIteratorRelease();
+}
+
+void RocksDBIteratorPool::Entry::onReused() {
+  reused_ = true;
+  setContextString("in use");
+  trackPinnedBytes(0);
+  trackIteratorCreation(/* reused */ true);
+}
+
+RocksDBIteratorPool::~RocksDBIteratorPool() {
+  shutdown();
+}
+
+RocksDBIteratorPool::Handle
+RocksDBIteratorPool::acquire(rocksdb::ColumnFamilyHandle* cf,
+                             const rocksdb::ReadOptions& options,
+                             folly::Optional<logid_t> upper_bound_log) {
+  ld_check(cf != nullptr);
+  const Key key{cf->GetID(),
+                upper_bound_log.has_value(),
+                options.tailing,
+                options.total_order_seek,
+                options.prefix_same_as_start,
+                options.read_tier,
+                options.fill_cache,
+                options.readahead_size};
+
+  std::unique_ptr<Entry> entry;
+  if (key.tailing) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto range = index_.equal_range(key);
+    if (range.first != range.second) {
+      // Take the most recently released one, its blocks are most likely to
+      // still be cached.
+      auto it = std::prev(range.second);
+      Entry* e = it->second;
+      index_.erase(it);
+      entry = std::move(*e->idle_it_);
+      idle_.erase(e->idle_it_);
+      ld_check(pinned_bytes_ >= entry->pinned_bytes_);
+      pinned_bytes_ -= entry->pinned_bytes_;
+    }
+  }
+
+  if (entry != nullptr) {
+    updatePinnedBytesStat();
+    if (upper_bound_log.has_value()) {
+      entry->setLog(upper_bound_log.value());
+    }
+    entry->onReused();
+    STAT_INCR(store_->getStatsHolder(), read_streams_num_data_iterators_reused);
+  } else {
+    entry = std::make_unique<Entry>(store_, cf, key, upper_bound_log, options);
+    STAT_INCR(
+        store_->getStatsHolder(), read_streams_num_data_iterators_created);
+  }
+  return Handle(this, std::move(entry));
+}
+
+void RocksDBIteratorPool::release(std::unique_ptr<Entry> entry) {
+  ld_check(entry != nullptr);
+  entry->reused_ = false;
+  const size_t limit = store_->getSettings()->iterator_pool_max_pinned_bytes;
+  if (limit == 0 || !entry->key_.tailing) {
+    return;
+  }
+
+  // Don't keep an iterator that already references outdated memtables and
+  // sst files: it would keep them alive, and would rebuild its children on
+  // the next seek anyway.
+  rocksdb::DB& db = store_->getDB();
+  std::string iterator_version;
+  uint64_t current_version;
+  if (!entry->iterator_
+           .GetProperty("rocksdb.iterator.super-version-number",
+                        &iterator_version)
+           .ok() ||
+      !db.GetIntProperty(entry->cf_,
+                         "rocksdb.current-super-version-number",
+                         &current_version) ||
+      folly::tryTo<uint64_t>(iterator_version).value_or(current_version + 1) !=
+          current_version) {
+    return;
+  }
+
+  uint64_t memtables_size = 0;
+  db.GetIntProperty(entry->cf_,
+                    rocksdb::DB::Properties::kSizeAllMemTables,
+                    &memtables_size);
+  const size_t pinned_bytes =
+      memtables_size + entry->key_.readahead_size + ENTRY_OVERHEAD_BYTES;
+  if (pinned_bytes > limit) {
+    return;
+  }
+  entry->onPooled(pinned_bytes);
+
+  std::vector<std::unique_ptr<Entry>> evicted;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (shut_down_ || dropped_cfs_.count(entry->key_.cf_id)) {
+      // Destroy it after unlocking.
+      evicted.push_back(std::move(entry));
+      return;
+    }
+    Entry* e = entry.get();
+    idle_.push_front(std::move(entry));
+    e->idle_it_ = idle_.begin();
+    index_.emplace(e->key_, e);
+    pinned_bytes_ += pinned_bytes;
+    evicted = evictLocked(limit);
+  }
+  updatePinnedBytesStat();
+  STAT_ADD(store_->getStatsHolder(),
+           rocksdb_iterator_pool_evictions,
+           evicted.size());
+}
+
+std::vector<std::unique_ptr<RocksDBIteratorPool::Entry>>
+RocksDBIteratorPool::evictLocked(size_t limit) {
+  std::vector<std::unique_ptr<Entry>> evicted;
+  while (pinned_bytes_ > limit && !idle_.empty()) {
+    std::unique_ptr<Entry> entry = std::move(idle_.back());
+    idle_.pop_back();
+    auto range = index_.equal_range(entry->key_);
+    auto it = range.first;
+    while (it->second != entry.get()) {
+      ++it;
+      ld_check(it != range.second);
+    }
+    index_.erase(it);
+    ld_check(pinned_bytes_ >= entry->pinned_bytes_);
+    pinned_bytes_ -= entry->pinned_bytes_;
+    evicted.push_back(std::move(entry));
+  }
+  return evicted;
+}
+
+void RocksDBIteratorPool::dropColumnFamily(uint32_t cf_id) {
+  std::vector<std::unique_ptr<Entry>> dropped;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    dropped_cfs_.insert(cf_id);
+    for (auto it = idle_.begin(); it != idle_.end();) {
+      if ((*it)->key_.cf_id != cf_id) {
+        ++it;
+        continue;
+      }
+      std::unique_ptr<Entry> entry = std::move(*it);
+      it = idle_.erase(it);
+      pinned_bytes_ -= entry->pinned_bytes_;
+      dropped.push_back(std::move(entry));
+    }
+    for (auto it = index_.begin(); it != index_.end();) {
+      it = it->first.cf_id == cf_id ? index_.erase(it) : std::next(it);
+    }
+  }
+  updatePinnedBytesStat();
+}
+
+void RocksDBIteratorPool::shutdown() {
+  std::list<std::unique_ptr<Entry>> idle;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shut_down_ = true;
+    idle.swap(idle_);
+    index_.clear();
+    pinned_bytes_ = 0;
+  }
+  updatePinnedBytesStat();
+}
+
+size_t RocksDBIteratorPool::pinnedBytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pinned_bytes_;
+}
+
+size_t RocksDBIteratorPool::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return idle_.size();
+}
+
+void RocksDBIteratorPool::updatePinnedBytesStat() {
+  PER_SHARD_STAT_SET(store_->getStatsHolder(),
+                     iterator_pool_pinned_bytes,
+                     store_->getShardIdx(),
+                     pinnedBytes());
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,217 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include <folly/Optional.h>
+#include <rocksdb/db.h>
+
+#include "logdevice/include/types.h"
+#include "logdevice/server/locallogstore/IteratorTracker.h"
+#include "logdevice/server/locallogstore/RocksDBLogStoreBase.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file RocksDBIteratorPool keeps the rocksdb data iterators that a shard's
+ *       read iterators are done with, so that reading another log from the
+ *       same column family (e.g. the same LogsDB partition) can Seek an
+ *       existing iterator instead of creating one. Creating a rocksdb
+ *       iterator builds a child iterator for every memtable and sst file of
+ *       the column family, which adds up when many streams read logs that
+ *       live in the same partitions.
+ *
+ *       Only tailing iterators are pooled. They aren't tied to a snapshot, so
+ *       seeking a reused one sees the same data as seeking a new one; it
+ *       rebuilds its children on its own once memtables or sst files change.
+ *       A non-tailing iterator would need a Refresh(), which costs about as
+ *       much as creating it.
+ *
+ *       An idle iterator keeps the memtables it references alive after they
+ *       are flushed. The pool estimates that as the size of all the column
+ *       family's memtables plus the read-ahead buffer, and destroys least
+ *       recently used iterators to stay below
+ *       RocksDBSettings::iterator_pool_max_pinned_bytes. An iterator that
+ *       already references an outdated set of memtables and files when it's
+ *       released isn't pooled.
+ *
+ *       Thread safe.
+ */
+
+class RocksDBIteratorPool {
+ public:
+  class Entry;
+
+  /**
+   * Owns an iterator taken from the pool and gives it back on destruction or
+   * reset(). Dereferences to the RocksDBIterator.
+   */
+  class Handle {
+   public:
+    Handle() = default;
+    Handle(RocksDBIteratorPool* pool, std::unique_ptr<Entry> entry);
+    Handle(Handle&& rhs) noexcept = default;
+    Handle& operator=(Handle&& rhs) noexcept;
+    ~Handle();
+
+    bool has_value() const {
+      return entry_ != nullptr;
+    }
+    RocksDBIterator& operator*() const;
+    RocksDBIterator* operator->() const {
+      return &**this;
+    }
+
+    // True if the iterator came from the pool rather than being created.
+    bool reused() const;
+
+    // Returns the iterator to the pool.
+    void reset();
+
+   private:
+    RocksDBIteratorPool* pool_{nullptr};
+    std::unique_ptr<Entry> entry_;
+  };
+
+  explicit RocksDBIteratorPool(const RocksDBLogStoreBase* store)
+      : store_(store) {}
+  ~RocksDBIteratorPool();
+
+  // Estimated memory pinned by an idle iterator on top of memtables and
+  // read-ahead: the blocks and table readers its children reference.
+  static constexpr size_t ENTRY_OVERHEAD_BYTES = 256 * 1024;
+
+  /**
+   * Returns an iterator on column family `cf` created with `options`, either
+   * an idle one from the pool or a new one. If upper_bound_log is set, the
+   * iterator's iterate_upper_bound is the end of that log, otherwise it has
+   * none; options.iterate_upper_bound is ignored.
+   *
+   * The iterator must be seeked before use.
+   */
+  Handle acquire(rocksdb::ColumnFamilyHandle* cf,
+                 const rocksdb::ReadOptions& options,
+                 folly::Optional<logid_t> upper_bound_log);
+
+  /**
+   * Destroys idle iterators on the column family and makes sure iterators on
+   * it that are currently in use aren't pooled when released. Call before
+   * dropping the column family.
+   */
+  void dropColumnFamily(uint32_t cf_id);
+
+  /**
+   * Destroys all idle iterators. Iterators in use are destroyed on release.
+   */
+  void shutdown();
+
+  // Estimated memory pinned by idle iterators.
+  size_t pinnedBytes() const;
+
+  // Number of idle iterators.
+  size_t size() const;
+
+ private:
+  // Iterators are only interchangeable if they were created with the same
+  // options and on the same column family.
+  struct Key {
+    uint32_t cf_id;
+    bool has_upper_bound;
+    bool tailing;
+    bool total_order_seek;
+    bool prefix_same_as_start;
+    rocksdb::ReadTier read_tier;
+    bool fill_cache;
+    size_t readahead_size;
+
+    auto asTuple() const {
+      return std::make_tuple(cf_id,
+                             has_upper_bound,
+                             tailing,
+                             total_order_seek,
+                             prefix_same_as_start,
+                             read_tier,
+                             fill_cache,
+                             readahead_size);
+    }
+    bool operator<(const Key& rhs) const {
+      return asTuple() < rhs.asTuple();
+    }
+  };
+
+  // Called by Handle.
+  void release(std::unique_ptr<Entry> entry);
+
+  // Destroys idle iterators, least recently used first, until their pinned
+  // bytes are within `limit`. Returns the destroyed entries so that they're
+  // destroyed outside of mutex_.
+  std::vector<std::unique_ptr<Entry>> evictLocked(size_t limit);
+
+  void updatePinnedBytesStat();
+
+  const RocksDBLogStoreBase* store_;
+
+  mutable std::mutex mutex_;
+  // Idle iterators, most recently released first.
+  std::list<std::unique_ptr<Entry>> idle_;
+  std::multimap<Key, Entry*> index_;
+  size_t pinned_bytes_{0};
+  // Column families dropped or about to be dropped. The ids are never reused
+  // by the same DB.
+  std::set<uint32_t> dropped_cfs_;
+  bool shut_down_{false};
+};
+
+/**
+ * A pooled rocksdb iterator. Listed by "info iterators" as a POOLED iterator
+ * once it has been in the pool.
+ */
+class RocksDBIteratorPool::Entry : public TrackableIterator {
+ public:
+  Entry(const RocksDBLogStoreBase* store,
+        rocksdb::ColumnFamilyHandle* cf,
+        Key key,
+        folly::Optional<logid_t> upper_bound_log,
+        rocksdb::ReadOptions options);
+
+  const LocalLogStore* getStore() const override {
+    return store_;
+  }
+
+  // Points the iterate_upper_bound at the end of the given log.
+  void setLog(logid_t log_id);
+
+  // Called when the entry goes in the pool, with its estimated pinned bytes.
+  void onPooled(size_t pinned_bytes);
+  // Called when the entry is taken out of the pool.
+  void onReused();
+
+  const RocksDBLogStoreBase* const store_;
+  rocksdb::ColumnFamilyHandle* const cf_;
+  const Key key_;
+  // iterator_ keeps a pointer to upper_bound_.upper_bound, so entries are
+  // always heap-allocated and never move.
+  IterateUpperBoundHelper upper_bound_;
+  RocksDBIterator iterator_;
+  // Estimate passed to onPooled().
+  size_t pinned_bytes_{0};
+  // True if the entry was taken from the pool by the current Handle.
+  bool reused_{false};
+  bool tracking_registered_{false};
+  // Position in RocksDBIteratorPool::idle_ while idle.
+  std::list<std::unique_ptr<Entry>>::iterator idle_it_;
+};
+
+}} // namespace facebook::logdevice
@@ -98,6 +98,10 @@ void RocksDBListener::OnFlushBegin(rocksdb::DB*,
   if (io_tracing_context && io_tracing_ && io_tracing_->isEnabled()) {
     io_tracing_context->assign(io_tracing_, "flush|cf:{}", info.cf_name);
   }
+  if (io_tracing_) {
+    env_->setBackgroundJobIOStats(
+        io_tracing_->getColumnFamilyIOStats(info.cf_id));
+  }
 }
 void RocksDBListener::OnCompactionBegin(
     rocksdb::DB*,
@@ -107,6 +111,10 @@ void RocksDBListener::OnCompactionBegin(
   if (io_tracing_context && io_tracing_ && io_tracing_->isEnabled()) {
     io_tracing_context->assign(io_tracing_, "compact|cf:{}", info.cf_name);
   }
+  if (io_tracing_) {
+    env_->setBackgroundJobIOStats(
+        io_tracing_->getColumnFamilyIOStats(info.cf_id));
+  }
 }
 
 template <>
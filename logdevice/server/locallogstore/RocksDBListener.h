@@ -46,7 +46,7 @@ class RocksDBListener : public rocksdb::EventListener {
   // Bumps stats.
   void OnTableFileCreated(const rocksdb::TableFileCreationInfo& info) override;
 
-  // These provide context to IO tracing.
+  // These provide context to IO tracing and IO attribution.
   void OnFlushBegin(rocksdb::DB*, const rocksdb::FlushJobInfo&) override;
   void OnCompactionBegin(rocksdb::DB*,
                          const rocksdb::CompactionJobInfo&) override;
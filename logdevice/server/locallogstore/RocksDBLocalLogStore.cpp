@@ -31,6 +31,7 @@
 #include "logdevice/server/locallogstore/IteratorSearch.h"
 #include "logdevice/server/locallogstore/RocksDBCustomiser.h"
 #include "logdevice/server/locallogstore/RocksDBEnv.h"
+#include "logdevice/server/locallogstore/RocksDBIteratorPool.h"
 #include "logdevice/server/locallogstore/RocksDBKeyFormat.h"
 #include "logdevice/server/locallogstore/RocksDBWriterMergeOperator.h"
 #include "logdevice/server/locallogstore/WriteOps.h"
@@ -426,10 +427,13 @@ class RocksDBLocalLogStore::CSIWrapper::DataIterator
 
   const CSIWrapper* parent_;
 
-  IterateUpperBoundHelper upper_bound_;
+  // Log whose end is the iterate_upper_bound of iterator_, if any.
+  folly::Optional<logid_t> upper_bound_log_;
+  // iterate_upper_bound is set by RocksDBIteratorPool.
   rocksdb::ReadOptions rocks_options_;
 
-  folly::Optional<RocksDBIterator> iterator_;
+  // Taken from the shard's RocksDBIteratorPool, returned to it on release.
+  RocksDBIteratorPool::Handle iterator_;
 
   // TODO (#10357210):
   //   merged_value_, skipped_dangling_amend_ and handleKeyFormatMigration() are
@@ -551,6 +555,7 @@ void RocksDBLocalLogStore::CSIWrapper::seek(logid_t log,
                                             ReadStats* stats) {
   SCOPED_IO_TRACING_CONTEXT_FROM_ITERATOR(
       this, filter ? "seek(filtered)" : "seek");
+  IOAttribution::ScopedPartition io_partition(io_stats_);
   // Note: if state_ == LIMIT_REACHED, and we're seeking to exactly where the
   // limit was reached, we could set near=true to tell moveTo() to resume
   // where the last operation left off and avoid the initial seeks.
@@ -574,6 +579,7 @@ void RocksDBLocalLogStore::CSIWrapper::seek(lsn_t lsn,
 
 void RocksDBLocalLogStore::CSIWrapper::seekForPrev(lsn_t lsn) {
   SCOPED_IO_TRACING_CONTEXT_FROM_ITERATOR(this, "seekForPrev");
+  IOAttribution::ScopedPartition io_partition(io_stats_);
   ld_check(log_id_.has_value());
   moveTo(Location(log_id_.value(), lsn),
          Direction::BACKWARD,
@@ -589,6 +595,7 @@ void RocksDBLocalLogStore::CSIWrapper::next(ReadFilter* filter,
       state_, ({IteratorState::AT_RECORD, IteratorState::LIMIT_REACHED}));
   SCOPED_IO_TRACING_CONTEXT_FROM_ITERATOR(
       this, filter ? "next(filtered)" : "next");
+  IOAttribution::ScopedPartition io_partition(io_stats_);
   Location loc = state_ == IteratorState::LIMIT_REACHED
       ? limit_reached_.location
       : getLocation().advance(Direction::FORWARD, log_id_);
@@ -601,6 +608,7 @@ void RocksDBLocalLogStore::CSIWrapper::next(ReadFilter* filter,
 
 void RocksDBLocalLogStore::CSIWrapper::prev() {
   SCOPED_IO_TRACING_CONTEXT_FROM_ITERATOR(this, "prev");
+  IOAttribution::ScopedPartition io_partition(io_stats_);
   moveTo(getLocation().advance(Direction::BACKWARD, log_id_),
          Direction::BACKWARD,
          /* near */ true,
@@ -1278,13 +1286,13 @@ void RocksDBLocalLogStore::CSIWrapper::CopySetIndexIterator::step(
 RocksDBLocalLogStore::CSIWrapper::DataIterator::DataIterator(
     const CSIWrapper* parent)
     : parent_(parent),
-      upper_bound_(
+      upper_bound_log_(
           parent_->getRocksDBStore()->getSettings()->disable_iterate_upper_bound
               ? folly::none
               : parent_->log_id_),
       rocks_options_(translateReadOptions(parent_->read_opts_,
                                           parent_->log_id_.has_value(),
-                                          &upper_bound_.upper_bound)) {
+                                          nullptr)) {
   registerTracking(parent_->cf_->GetName(),
                    parent_->log_id_.value_or(LOGID_INVALID),
                    rocks_options_.tailing,
@@ -1295,8 +1303,9 @@ RocksDBLocalLogStore::CSIWrapper::DataIterator::DataIterator(
 
 void RocksDBLocalLogStore::CSIWrapper::DataIterator::createIteratorIfNeeded() {
   if (!iterator_.has_value()) {
-    iterator_ =
-        parent_->getRocksDBStore()->newIterator(rocks_options_, parent_->cf_);
+    iterator_ = parent_->getRocksDBStore()->getIteratorPool()->acquire(
+        parent_->cf_, rocks_options_, upper_bound_log_);
+    trackIteratorCreation(iterator_.reused());
   }
 }
 
@@ -1539,6 +1548,18 @@ void RocksDBLocalLogStore::AllLogsIteratorImpl::next(ReadFilter* filter,
                                                      ReadStats* stats) {
   iterator_->next(filter, stats);
 }
+int RocksDBLocalLogStore::AllLogsIteratorImpl::compareLocations(
+    const Location& lhs,
+    const Location& rhs) const {
+  ld_assert(dynamic_cast<const LocationImpl*>(&lhs));
+  ld_assert(dynamic_cast<const LocationImpl*>(&rhs));
+  const LocationImpl& l = static_cast<const LocationImpl&>(lhs);
+  const LocationImpl& r = static_cast<const LocationImpl&>(rhs);
+  if (std::tie(l.log, l.lsn) == std::tie(r.log, r.lsn)) {
+    return 0;
+  }
+  return std::tie(l.log, l.lsn) < std::tie(r.log, r.lsn) ? -1 : +1;
+}
 std::unique_ptr<LocalLogStore::AllLogsIterator::Location>
 RocksDBLocalLogStore::AllLogsIteratorImpl::minLocation() const {
   return std::make_unique<LocationImpl>(logid_t(0), lsn_t(0));
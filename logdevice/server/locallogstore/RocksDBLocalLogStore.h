@@ -23,6 +23,7 @@
 #include "logdevice/common/debug.h"
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/include/types.h"
+#include "logdevice/server/locallogstore/IOAttribution.h"
 #include "logdevice/server/locallogstore/IteratorTracker.h"
 #include "logdevice/server/locallogstore/RocksDBKeyFormat.h"
 #include "logdevice/server/locallogstore/RocksDBLogStoreBase.h"
@@ -151,6 +152,11 @@ class RocksDBLocalLogStore : public RocksDBLogStoreBase {
       return cf_;
     }
 
+    // True if records are enumerated using the copyset index.
+    bool usesCopySetIndex() const {
+      return csi_iterator_ != nullptr;
+    }
+
     // Propagate debug info to subiterators.
     void setContextString(const char* str) override;
 
@@ -164,6 +170,11 @@ class RocksDBLocalLogStore : public RocksDBLogStoreBase {
     RecordTimestamp min_ts_ = RecordTimestamp::min();
     RecordTimestamp max_ts_ = RecordTimestamp::max();
 
+    // Set by PartitionedRocksDBStore::Iterator to the IO counters of the
+    // partition, which it keeps alive for as long as this iterator. If set,
+    // the IO of seeks and nexts is attributed to them, see IOAttribution.
+    IOStats* io_stats_ = nullptr;
+
    private:
     class CopySetIndexIterator;
     class DataIterator;
@@ -275,6 +286,8 @@ class RocksDBLocalLogStore : public RocksDBLogStoreBase {
               ReadStats* stats = nullptr) override;
     void next(ReadFilter* filter = nullptr,
               ReadStats* stats = nullptr) override;
+    int compareLocations(const Location& lhs,
+                         const Location& rhs) const override;
     std::unique_ptr<Location> minLocation() const override;
     std::unique_ptr<Location> metadataLogsBegin() const override;
     void invalidate() override;
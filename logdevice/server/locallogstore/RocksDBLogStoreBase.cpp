@@ -10,7 +10,9 @@
 #include <rocksdb/iostats_context.h>
 
 #include "logdevice/common/stats/PerShardHistograms.h"
+#include "logdevice/server/locallogstore/LogAppendMemTableRep.h"
 #include "logdevice/server/locallogstore/RocksDBCustomiser.h"
+#include "logdevice/server/locallogstore/RocksDBIteratorPool.h"
 #include "logdevice/server/locallogstore/RocksDBMemTableRep.h"
 #include "logdevice/server/locallogstore/RocksDBSettings.h"
 #include "logdevice/server/locallogstore/RocksDBWriter.h"
@@ -39,17 +41,24 @@ RocksDBLogStoreBase::RocksDBLogStoreBase(uint32_t shard_idx,
       writer_(new RocksDBWriter(this, *rocksdb_config.getRocksDBSettings())),
       stats_(stats_holder),
       statistics_(rocksdb_config.options_.statistics),
-      rocksdb_config_(std::move(rocksdb_config)) {
+      rocksdb_config_(std::move(rocksdb_config)),
+      iterator_pool_(std::make_unique<RocksDBIteratorPool>(this)) {
   io_tracing_ = io_tracing;
   // Per RocksDB instance option overrides.
   installMemTableRep();
 }
 
 RocksDBLogStoreBase::~RocksDBLogStoreBase() {
+  // No-op if a subclass already did it.
+  writer_->flushPendingLogMetadata();
+
   if (fail_safe_mode_.load()) {
     PER_SHARD_STAT_DECR(getStatsHolder(), failed_safe_log_stores, shard_idx_);
   }
 
+  // Idle iterators must go before the column families and the DB.
+  iterator_pool_->shutdown();
+
   // Clears the last reference to all column family handles in the map
   // by copying it to a vector and then clearing it. This is required to
   // satisfy TSAN which otherwise will complain about lock-order-inversion
@@ -132,10 +141,19 @@ int RocksDBLogStoreBase::isCFEmpty(rocksdb::ColumnFamilyHandle* cf) const {
 
 void RocksDBLogStoreBase::installMemTableRep() {
   auto create_memtable_factory = [this]() {
-    mtr_factory_ = std::make_shared<RocksDBMemTableRepFactory>(
-        this,
-        std::make_unique<rocksdb::SkipListFactory>(
-            getSettings()->skip_list_lookahead));
+    std::unique_ptr<rocksdb::MemTableRepFactory> factory;
+    switch (getSettings()->memtable_rep) {
+      case RocksDBSettings::MemTableRepType::SKIP_LIST:
+        factory = std::make_unique<rocksdb::SkipListFactory>(
+            getSettings()->skip_list_lookahead);
+        break;
+      case RocksDBSettings::MemTableRepType::LOG_APPEND:
+        factory = std::make_unique<LogAppendMemTableRepFactory>();
+        break;
+    }
+    ld_check(factory);
+    mtr_factory_ =
+        std::make_shared<RocksDBMemTableRepFactory>(this, std::move(factory));
   };
 
   if (!rocksdb_config_.options_.memtable_factory) {
@@ -168,6 +186,10 @@ SteadyTimestamp RocksDBLogStoreBase::oldestUnflushedDataTimestamp() const {
   return mtr_factory_->oldestUnflushedDataTimestamp();
 }
 
+uint64_t RocksDBLogStoreBase::getLatestSequenceNumber() const {
+  return db_->GetLatestSequenceNumber();
+}
+
 void RocksDBLogStoreBase::throttleIOIfNeeded(WriteBufStats buf_stats,
                                              uint64_t memory_limit) {
   auto state_to_str = [](LocalLogStore::WriteThrottleState st) {
@@ -361,6 +383,13 @@ rocksdb::ReadOptions RocksDBLogStoreBase::translateReadOptions(
   // allows us to cache and reuse the iterator.
   rocks_options.tailing = opts.tailing;
 
+  if (opts.readahead_size > 0) {
+    rocks_options.readahead_size = opts.readahead_size;
+#ifdef LOGDEVICE_ROCKSDB_HAS_READ_OPTIONS_ASYNC_IO
+    rocks_options.async_io = true;
+#endif
+  }
+
   if (upper_bound != nullptr && !upper_bound->empty()) {
     // Since this iterator is only used to read data for a given log, setting
     // iterate_upper_bound allows RocksDB to release some resources when child
@@ -499,6 +528,11 @@ RocksDBLogStoreBase::writeBatch(const rocksdb::WriteOptions& options,
     return rocksdb::Status::IOError(
         "assertion failure: trying to write to read-only store");
   }
+  // Buffered log metadata was written before this batch, so it has to get to
+  // rocksdb first.
+  if (writer_->flushPendingLogMetadata() != 0) {
+    return rocksdb::Status::IOError("failed to write pending log metadata");
+  }
   using IOType = IOFaultInjection::IOType;
   using FaultType = IOFaultInjection::FaultType;
 
@@ -29,6 +29,7 @@ namespace facebook { namespace logdevice {
 
 class RocksDBCustomiser;
 class RocksDBIterator;
+class RocksDBIteratorPool;
 class RocksDBMemTableRepFactory;
 class RocksDBWriter;
 class IOTracing;
@@ -72,6 +73,8 @@ class RocksDBLogStoreBase : public LocalLogStore {
   FlushToken flushedUpThrough() const override;
   SteadyTimestamp oldestUnflushedDataTimestamp() const override;
 
+  uint64_t getLatestSequenceNumber() const override;
+
   void stallLowPriWrite() override;
 
   StatsHolder* getStatsHolder() const {
@@ -99,6 +102,14 @@ class RocksDBLogStoreBase : public LocalLogStore {
   RocksDBIterator newIterator(rocksdb::ReadOptions ropt,
                               rocksdb::ColumnFamilyHandle* cf) const;
 
+  /**
+   * Pool of idle tailing data iterators of this shard, see
+   * RocksDBIteratorPool.
+   */
+  RocksDBIteratorPool* getIteratorPool() const {
+    return iterator_pool_.get();
+  }
+
   void onStorageThreadStarted() override {
     // Make RocksDB's PerfContext track time stats.
     rocksdb::SetPerfLevel(rocksdb::kEnableTime);
@@ -607,6 +618,9 @@ class RocksDBLogStoreBase : public LocalLogStore {
   using RocksDBColumnFamilyMap = std::unordered_map<uint32_t, RocksDBCFPtr>;
   folly::Synchronized<RocksDBColumnFamilyMap> cf_accessor_;
 
+  // Must be shut down before db_ is destroyed.
+  const std::unique_ptr<RocksDBIteratorPool> iterator_pool_;
+
  private:
   // Write stalling stuff.
 
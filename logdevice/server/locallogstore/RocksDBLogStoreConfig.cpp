@@ -51,6 +51,8 @@ RocksDBLogStoreConfig::RocksDBLogStoreConfig(
 
   table_options_.index_block_restart_interval =
       rocksdb_settings_->index_block_restart_interval;
+  table_options_.block_restart_interval =
+      rocksdb_settings_->block_restart_interval;
 
   table_options_.whole_key_filtering = false;
 
@@ -32,6 +32,35 @@ using namespace facebook::logdevice::setting_validators;
 
 namespace facebook { namespace logdevice {
 
+static RocksDBSettings::ShardList parseShardList(const char* name,
+                                                 const std::string& val) {
+  RocksDBSettings::ShardList ret;
+  if (val == "none" || val == "") {
+    return ret;
+  }
+  if (val == "all") {
+    ret.all_shards = true;
+    return ret;
+  }
+  std::vector<std::string> tokens;
+  folly::split(',', val, tokens, true /* ignoreEmpty */);
+
+  for (const auto& token : tokens) {
+    try {
+      ret.shards.push_back(folly::to<shard_index_t>(token));
+    } catch (std::range_error&) {
+      throw boost::program_options::error(
+          std::string("Invalid shard idx in --") + name + ": " + val);
+    }
+  }
+
+  std::sort(ret.shards.begin(), ret.shards.end());
+  ret.shards.erase(
+      std::unique(ret.shards.begin(), ret.shards.end()), ret.shards.end());
+
+  return ret;
+}
+
 void RocksDBSettings::defineSettings(SettingEasyInit& init) {
   using namespace SettingFlag;
 
@@ -228,6 +257,19 @@ void RocksDBSettings::defineSettings(SettingEasyInit& init) {
        SERVER | REQUIRES_RESTART,
        SettingsCategory::RocksDB);
 
+  init("rocksdb-cache-dedicated-arena",
+       &cache_dedicated_arena_,
+       "false",
+       nullptr,
+       "Allocate uncompressed block cache entries from a dedicated jemalloc "
+       "arena instead of the general-purpose heap. This keeps cached blocks "
+       "packed together in their own extents, which can then be backed by "
+       "transparent huge pages (e.g. MALLOC_CONF=thp:always) to cut TLB misses "
+       "on cache lookups, and leaves them out of core dumps. Ignored if "
+       "RocksDB was built without jemalloc support.",
+       SERVER | REQUIRES_RESTART,
+       SettingsCategory::RocksDB);
+
   init("rocksdb-cache-small-block-threshold-for-high-priority",
        &cache_small_block_threshold_for_high_priority_,
        "30K",
@@ -264,6 +306,20 @@ void RocksDBSettings::defineSettings(SettingEasyInit& init) {
        SERVER,
        SettingsCategory::LogsDB);
 
+  init("rocksdb-partition-directory-snapshot",
+       &partition_directory_snapshot,
+       "false",
+       nullptr,
+       "On clean shutdown, write the in-memory partition directory of all logs "
+       "to a file in the shard's directory, tagged with rocksdb's latest "
+       "sequence number. On startup, if the DB is still at that sequence "
+       "number, load the directory from the file instead of scanning it in "
+       "the metadata column family, which can take a long time with many logs "
+       "and partitions. The file is deleted after startup, so after an "
+       "unclean shutdown the directory is always read from rocksdb.",
+       SERVER,
+       SettingsCategory::LogsDB);
+
   init("rocksdb-partition-compaction-schedule",
        &partition_compaction_schedule,
        "auto",
@@ -286,6 +342,40 @@ void RocksDBSettings::defineSettings(SettingEasyInit& init) {
        SERVER,
        SettingsCategory::LogsDB);
 
+  init("rocksdb-partition-hot-age",
+       &partition_hot_age_,
+       "6h",
+       [](std::chrono::seconds val) {
+         if (val.count() < 0) {
+           throw boost::program_options::error(
+               "value of --rocksdb-partition-hot-age must be non-negative; " +
+               std::to_string(val.count()) + "s given.");
+         }
+       },
+       "Partitions whose records are all younger than this are reported as "
+       "'hot' in 'info partitions', older ones as 'warm', or as 'cold' once "
+       "offloaded (see --rocksdb-partition-cold-age). Doesn't change how "
+       "partitions are stored.",
+       SERVER,
+       SettingsCategory::LogsDB);
+
+  init("rocksdb-partition-cold-age",
+       &partition_cold_age_,
+       "0",
+       [](std::chrono::seconds val) {
+         if (val.count() < 0) {
+           throw boost::program_options::error(
+               "value of --rocksdb-partition-cold-age must be non-negative; " +
+               std::to_string(val.count()) + "s given.");
+         }
+       },
+       "Partitions whose records are all older than this are handed to the "
+       "RocksDBCustomiser plugin, which may offload their sst files to remote "
+       "storage and fetch them back lazily when they're read. Does nothing "
+       "without a plugin that supports it. 0 disables.",
+       SERVER,
+       SettingsCategory::LogsDB);
+
   init("rocksdb-proactive-compaction-enabled",
        &proactive_compaction_enabled,
        "false",
@@ -304,6 +394,21 @@ void RocksDBSettings::defineSettings(SettingEasyInit& init) {
        SERVER,
        SettingsCategory::RocksDB);
 
+  init("rocksdb-iterator-pool-max-pinned-bytes",
+       &iterator_pool_max_pinned_bytes,
+       "0",
+       parse_nonnegative<ssize_t>(),
+       "If positive, tailing rocksdb data iterators that read streams are "
+       "done with are kept in a per-shard pool and reused, via Seek, by "
+       "streams reading other logs from the same partition, instead of "
+       "creating a new iterator over all of the partition's memtables and "
+       "sst files each time. An idle iterator keeps the memtables it was "
+       "created over alive after they're flushed; this is the upper bound "
+       "on memory that idle iterators of a shard may pin, least recently "
+       "used ones are destroyed first. 0 disables the pool.",
+       SERVER | EXPERIMENTAL,
+       SettingsCategory::RocksDB);
+
   init("rocksdb-partition-duration",
        &partition_duration_,
        "15min",
@@ -446,6 +551,23 @@ void RocksDBSettings::defineSettings(SettingEasyInit& init) {
        SERVER,
        SettingsCategory::LogsDB);
 
+  init("rocksdb-ingest-rebuilding-writes-min-bytes",
+       &ingest_rebuilding_writes_min_bytes_,
+       "0",
+       parse_nonnegative<size_t>(),
+       "If positive, rebuilding stores that go to partitions older than the "
+       "two latest ones are written as an sst file and ingested into the "
+       "partition, bypassing memtable and WAL, whenever a write batch "
+       "contains at least this many bytes of such stores for the same "
+       "partition. This avoids the flushes of small memtables and the "
+       "partial compactions that rebuilding otherwise causes on recipients. "
+       "Ingested records are durable right away, so donors don't need to "
+       "wait for memtable flushes for them. If the partition's memtable "
+       "overlaps the written key range, the stores are written to the "
+       "memtable as usual. 0 disables ingestion.",
+       SERVER | EXPERIMENTAL,
+       SettingsCategory::LogsDB);
+
   init("rocksdb-partition-partial-compaction-max-num-per-loop",
        &partition_partial_compaction_max_num_per_loop_,
        "4",
@@ -465,6 +587,27 @@ void RocksDBSettings::defineSettings(SettingEasyInit& init) {
        SERVER,
        SettingsCategory::LogsDB);
 
+  init("rocksdb-partition-compaction-read-throttle-backoff",
+       &partition_compaction_read_throttle_backoff_,
+       "0",
+       [](std::chrono::milliseconds val) -> void {
+         if (val.count() < 0) {
+           throw boost::program_options::error(
+               "rocksdb-partition-compaction-read-throttle-backoff must be "
+               "non-negative");
+         }
+       },
+       "Postpone partial and proactive partition compactions for this long "
+       "after read IO shaping last had to throttle a read because the read "
+       "bandwidth budget of the node was used up, so that compactions don't "
+       "compete with saturated reads for the disk. Retention-based and "
+       "manual compactions are never postponed, and neither are partial "
+       "compactions once there are enough of them to stall rebuilding "
+       "(see --rocksdb-partition-partial-compaction-stall-trigger). "
+       "0 disables.",
+       SERVER,
+       SettingsCategory::LogsDB);
+
   init(
       "rocksdb-partition-count-soft-limit",
       &partition_count_soft_limit_,
@@ -846,6 +989,20 @@ void RocksDBSettings::defineSettings(SettingEasyInit& init) {
        SERVER,
        SettingsCategory::LogsDB);
 
+  init("rocksdb-io-uring-queue-depth",
+       &io_uring_queue_depth,
+       "0",
+       nullptr, // no validation
+       "If positive, batched reads issued by rocksdb (MultiRead(), used by "
+       "MultiGet()) are submitted to the kernel together through an io_uring "
+       "of this depth, one per thread, instead of one pread() at a time. "
+       "Requires Linux 5.1+; falls back to synchronous reads if io_uring is "
+       "not available. Each sst file gets an extra file descriptor while "
+       "this is enabled. Only affects files opened after the change. "
+       "0 to disable.",
+       SERVER | EXPERIMENTAL,
+       SettingsCategory::LogsDB);
+
   init("rocksdb-use-copyset-index",
        &use_copyset_index,
        "true",
@@ -854,12 +1011,14 @@ void RocksDBSettings::defineSettings(SettingEasyInit& init) {
        "records that do not pass copyset filters. This greatly improves the "
        "efficiency of reading and rebuilding if records are large (1KB or "
        "bigger). For small records, the overhead of maintaining the copyset "
-       "index negates the savings. **WARNING**: if this setting is enabled, "
-       "records written without --write-copyset-index will be skipped by the "
-       "copyset filter and will not be delivered to readers. Enable "
-       "--write-copyset-index first and wait for all data records written "
-       "before --write-copyset-index was enabled (if any) to be trimmed "
-       "before enabling this setting.",
+       "index negates the savings. LogsDB partitions that have records "
+       "written without --write-copyset-index are read without the copyset "
+       "index. **WARNING**: with the legacy unpartitioned store, if this "
+       "setting is enabled, records written without --write-copyset-index "
+       "will be skipped by the copyset filter and will not be delivered to "
+       "readers. Enable --write-copyset-index first and wait for all data "
+       "records written before --write-copyset-index was enabled (if any) to "
+       "be trimmed before enabling this setting.",
        SERVER | REQUIRES_RESTART,
        SettingsCategory::LogsDB);
 
@@ -872,6 +1031,18 @@ void RocksDBSettings::defineSettings(SettingEasyInit& init) {
        SERVER,
        SettingsCategory::LogsDB);
 
+  init("rocksdb-find-time-samples-per-partition",
+       &find_time_samples_per_partition,
+       "16",
+       parse_nonnegative<ssize_t>(),
+       "Maximum number of (timestamp, LSN) pairs of records that LogsDB keeps "
+       "in memory for each log in each partition, sampled at write time. "
+       "findTime uses them to narrow the binary search within the partition "
+       "to the LSNs between two samples. Costs about 16 bytes per sample. "
+       "0 disables sampling. Not used with --rocksdb-read-find-time-index.",
+       SERVER,
+       SettingsCategory::LogsDB);
+
   init("rocksdb-read-only",
        &read_only,
        "false",
@@ -1090,6 +1261,36 @@ void RocksDBSettings::defineSettings(SettingEasyInit& init) {
        SERVER | REQUIRES_RESTART,
        SettingsCategory::RocksDB);
 
+  init("rocksdb-wal-dir",
+       &wal_dir,
+       "",
+       nullptr, // no validation
+       "If not empty, each shard keeps its write-ahead log in a \"shard<idx>\" "
+       "subdirectory of this directory instead of next to its sst files. "
+       "Pointing it at a small low-latency device (a dedicated NVMe "
+       "namespace, or a DAX-mounted persistent memory file system) makes "
+       "synced writes, e.g. appends with append-store-durability=sync_write, "
+       "wait only for that device, while memtable flushes move the data to "
+       "the main device in the background. WAL files are only needed until "
+       "the memtables they cover are flushed, see rocksdb-max-total-wal-size. "
+       "Changing this directory on a node that has unflushed data loses that "
+       "data, so change it only together with a clean shutdown or a wipe.",
+       SERVER | REQUIRES_RESTART,
+       SettingsCategory::RocksDB);
+
+  init("rocksdb-recycle-log-file-num",
+       &recycle_log_file_num,
+       "0",
+       nullptr, // no validation
+       "If positive, rocksdb keeps up to this many WAL files that are no "
+       "longer needed and overwrites them instead of creating new ones. "
+       "Writes into a recycled file don't change its size or allocation, so "
+       "syncing the WAL doesn't also have to sync file system metadata, "
+       "which noticeably lowers the latency of synced writes. Useful "
+       "together with rocksdb-wal-dir.",
+       SERVER | REQUIRES_RESTART,
+       SettingsCategory::RocksDB);
+
   init("rocksdb-bytes-written-since-throttle-eval-trigger",
        &bytes_written_since_throttle_eval_trigger,
        "20M",
@@ -1211,6 +1412,21 @@ void RocksDBSettings::defineSettings(SettingEasyInit& init) {
        SERVER | REQUIRES_RESTART,
        SettingsCategory::LogsDB);
 
+  init("rocksdb-log-metadata-write-batch-size",
+       &log_metadata_write_batch_size,
+       "0",
+       parse_nonnegative<ssize_t>(),
+       "If nonzero, writes of log metadata (trim points, seals, last clean "
+       "epochs etc) are buffered in memory, coalescing repeated updates of the "
+       "same log, and written to rocksdb when this many logs have pending "
+       "updates, or before the next write to the shard, WAL sync or shutdown, "
+       "or periodically by the partitioned store's background thread. Reads "
+       "see the buffered values. Buffered writes have MEMORY durability until "
+       "written out; a sync of the shard makes them durable as before. "
+       "0 writes every update right away.",
+       SERVER | REQUIRES_RESTART,
+       SettingsCategory::LogsDB);
+
   init("rocksdb-skip-list-lookahead",
        &skip_list_lookahead,
        "3",
@@ -1220,6 +1436,28 @@ void RocksDBSettings::defineSettings(SettingEasyInit& init) {
        SERVER | REQUIRES_RESTART,
        SettingsCategory::RocksDB);
 
+  init("rocksdb-memtable-rep",
+       &memtable_rep,
+       "skiplist",
+       [](const std::string& val) {
+         if (val == "skiplist") {
+           return RocksDBSettings::MemTableRepType::SKIP_LIST;
+         } else if (val == "log-append") {
+           return RocksDBSettings::MemTableRepType::LOG_APPEND;
+         } else {
+           throw boost::program_options::error(
+               "invalid value '" + val +
+               "' for option --rocksdb-memtable-rep. Expected 'skiplist' or "
+               "'log-append'");
+         }
+       },
+       "Memtable implementation. 'skiplist' is rocksdb's skiplist. "
+       "'log-append' keeps a sorted vector of records per log, which makes "
+       "inserts of records appended in order cheaper and flushes faster, "
+       "but makes creating iterators on the active memtable more expensive.",
+       SERVER | REQUIRES_RESTART,
+       SettingsCategory::RocksDB);
+
   init("rocksdb-max-open-files",
        &max_open_files,
        "10000",
@@ -1238,6 +1476,21 @@ void RocksDBSettings::defineSettings(SettingEasyInit& init) {
        SERVER | REQUIRES_RESTART,
        SettingsCategory::RocksDB);
 
+  init("rocksdb-block-restart-interval",
+       &block_restart_interval,
+       "16",
+       parse_positive<ssize_t>(),
+       "Number of keys between restart points for prefix encoding of keys in "
+       "data blocks. Consecutive records of a log share all of their DataKey "
+       "except the low bytes of the lsn, so only keys at restart points are "
+       "stored in full. Raising this (e.g. to 64) shrinks keys in sst files "
+       "and block cache, which matters for logs with small records, at the "
+       "cost of a longer linear scan when seeking inside a block. Only "
+       "affects newly written sst files; files with different values can be "
+       "read together.",
+       SERVER | REQUIRES_RESTART,
+       SettingsCategory::RocksDB);
+
   init("rocksdb-compaction-readahead-size",
        &compaction_readahead_size,
        "4096",
@@ -1584,32 +1837,8 @@ void RocksDBSettings::defineSettings(SettingEasyInit& init) {
   init("rocksdb-io-tracing-shards",
        &io_tracing_shards,
        "all",
-       [](const std::string& val) -> IOTracingShards {
-         IOTracingShards ret;
-         if (val == "none" || val == "") {
-           return ret;
-         }
-         if (val == "all") {
-           ret.all_shards = true;
-           return ret;
-         }
-         std::vector<std::string> tokens;
-         folly::split(',', val, tokens, true /* ignoreEmpty */);
-
-         for (const auto& token : tokens) {
-           try {
-             ret.shards.push_back(folly::to<shard_index_t>(token));
-           } catch (std::range_error&) {
-             throw boost::program_options::error(
-                 "Invalid shard idx in --rocksdb-io-tracing-shards: " + val);
-           }
-         }
-
-         std::sort(ret.shards.begin(), ret.shards.end());
-         ret.shards.erase(std::unique(ret.shards.begin(), ret.shards.end()),
-                          ret.shards.end());
-
-         return ret;
+       [](const std::string& val) {
+         return parseShardList("rocksdb-io-tracing-shards", val);
        },
        "List of shards for which to enable IO tracing. 'all' to enable for all "
        "shards, 'none' or empty string to disable for all shards. IO tracing "
@@ -1619,6 +1848,35 @@ void RocksDBSettings::defineSettings(SettingEasyInit& init) {
        SERVER,
        SettingsCategory::LogsDB);
 
+  init("rocksdb-in-memory-shards",
+       &in_memory_shards,
+       "none",
+       [](const std::string& val) {
+         return parseShardList("rocksdb-in-memory-shards", val);
+       },
+       "List of shards to keep entirely in memory instead of on disk, 'all' "
+       "for all shards, 'none' or empty string for none. The data of these "
+       "shards is lost on restart, so only use this for ephemeral logs whose "
+       "replication is for availability only, and for benchmarks that need "
+       "a storage engine without disk noise. Records are evicted by the "
+       "logs' time-based retention as usual; see also "
+       "rocksdb-in-memory-shard-capacity. The shard directories are still "
+       "created but stay empty.",
+       SERVER | REQUIRES_RESTART,
+       SettingsCategory::LogsDB);
+
+  init("rocksdb-in-memory-shard-capacity",
+       &in_memory_shard_capacity,
+       "0",
+       parse_nonnegative<size_t>(),
+       "If positive, when the data of a shard in rocksdb-in-memory-shards "
+       "grows beyond this many bytes, its oldest partitions are dropped (and "
+       "the logs trimmed accordingly) until it fits, like space-based "
+       "trimming does for disks. Memtables aren't counted. Only supported "
+       "with partitioned storage.",
+       SERVER,
+       SettingsCategory::LogsDB);
+
   init("rocksdb-io-tracing-threshold",
        &io_tracing_threshold,
        "5s",
@@ -1694,6 +1952,7 @@ rocksdb::Options RocksDBSettings::passThroughRocksDBOptions() const {
   options.max_open_files = max_open_files;
   options.bytes_per_sync = bytes_per_sync;
   options.wal_bytes_per_sync = wal_bytes_per_sync;
+  options.recycle_log_file_num = recycle_log_file_num;
   options.compaction_readahead_size = compaction_readahead_size;
   options.level0_file_num_compaction_trigger =
       level0_file_num_compaction_trigger;
@@ -1722,6 +1981,9 @@ rocksdb::Options RocksDBSettings::passThroughRocksDBOptions() const {
   options.skip_checking_sst_file_sizes_on_db_open =
       skip_checking_sst_file_sizes_on_db_open;
 #endif
+  // LogAppendMemTableRep doesn't support concurrent inserts.
+  options.allow_concurrent_memtable_write =
+      memtable_rep != MemTableRepType::LOG_APPEND;
 
   options.compaction_options_universal.min_merge_width = uc_min_merge_width;
   options.compaction_options_universal.max_merge_width = uc_max_merge_width;
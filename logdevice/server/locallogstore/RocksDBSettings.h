@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 
@@ -56,6 +57,10 @@ static_assert(ROCKSDB_MAJOR > 5 || (ROCKSDB_MAJOR == 5 && ROCKSDB_MINOR >= 7),
 #define LOGDEVICE_ROCKSDB_HAS_SKIP_CHECKING_SST_FILE_SIZES_ON_DB_OPEN
 #endif
 
+#if ROCKSDB_MAJOR > 7 || (ROCKSDB_MAJOR == 7 && ROCKSDB_MINOR >= 2)
+#define LOGDEVICE_ROCKSDB_HAS_READ_OPTIONS_ASYNC_IO
+#endif
+
 namespace boost { namespace program_options {
 class options_description;
 }} // namespace boost::program_options
@@ -106,6 +111,10 @@ class RocksDBSettings : public SettingsBundle {
   // points)
   int num_metadata_locks;
 
+  // If nonzero, log metadata writes are buffered in memory and written to
+  // rocksdb in batches of up to this many logs; see RocksDBWriter.
+  size_t log_metadata_write_batch_size;
+
   // enable RocksDB statistics collection
   bool statistics;
 
@@ -117,10 +126,22 @@ class RocksDBSettings : public SettingsBundle {
   // position.
   int skip_list_lookahead;
 
+  enum class MemTableRepType {
+    SKIP_LIST,
+    LOG_APPEND,
+  };
+
+  // Memtable implementation, see LogAppendMemTableRep.h.
+  MemTableRepType memtable_rep;
+
   WALBufferingMode wal_buffering;
 
   uint64_t wal_buffer_size;
 
+  // If positive, rocksdb::RandomAccessFile::MultiRead() calls are submitted
+  // through a per-thread io_uring with this queue depth.
+  size_t io_uring_queue_depth;
+
   // IO priority to request for lo-pri rocksdb threads.
   folly::Optional<std::pair<int, int>> low_ioprio;
 
@@ -143,6 +164,10 @@ class RocksDBSettings : public SettingsBundle {
   // Whether partitioned log store should do background compactions.
   bool partition_compactions_enabled;
 
+  // Write the in-memory partition directory to a file on clean shutdown and
+  // load it on the next startup instead of scanning the directory in rocksdb.
+  bool partition_directory_snapshot;
+
   // If x is present in this vector, each partition will be compacted when
   // all logs with backlog durations <= x are trimmed away from the partition.
   // If empty, all distinct backlog durations from config are used.
@@ -150,6 +175,15 @@ class RocksDBSettings : public SettingsBundle {
   using compaction_schedule_t = std::vector<std::chrono::seconds>;
   folly::Optional<compaction_schedule_t> partition_compaction_schedule;
 
+  // Partitions whose records are all younger than this are reported as hot,
+  // older ones as warm (or cold, once offloaded). Informational only.
+  std::chrono::seconds partition_hot_age_;
+
+  // Partitions whose records are all older than this are passed to
+  // RocksDBCustomiser::offloadColdFiles(), which may move their sst files to
+  // remote storage. 0 disables offloading.
+  std::chrono::seconds partition_cold_age_;
+
   // whether we're going to proactively compact all partitions
   // (besides two latest) that were never compacted.
   // Compacting will be done in low priority background thread
@@ -190,6 +224,10 @@ class RocksDBSettings : public SettingsBundle {
   size_t partition_partial_compaction_max_num_per_loop_;
   size_t partition_partial_compaction_stall_trigger_;
 
+  // Postpone partial and proactive compactions for this long after read IO
+  // shaping throttled a read. 0 disables.
+  std::chrono::milliseconds partition_compaction_read_throttle_backoff_;
+
   // The largest l0 files that it is beneficial to compact on their own. note
   // that we can still compact larger files than this if that enables us to
   // compact a longer range of consecutive files. e.g. if there are smaller
@@ -206,6 +244,11 @@ class RocksDBSettings : public SettingsBundle {
   // record can be compacted in partial compactions.
   double partition_partial_compaction_largest_file_share_;
 
+  // If positive, rebuilding writes to old partitions are ingested as sst
+  // files instead of going through memtables, whenever a write batch has at
+  // least this many bytes of them for the same partition.
+  size_t ingest_rebuilding_writes_min_bytes_;
+
   // See .cpp
   size_t partition_count_soft_limit_;
 
@@ -274,6 +317,10 @@ class RocksDBSettings : public SettingsBundle {
   // TODO(#8945358): Remove this option once #8945358 is fixed.
   bool disable_iterate_upper_bound;
 
+  // Upper bound on the memory that idle rocksdb data iterators kept for reuse
+  // by RocksDBIteratorPool may pin, per shard. 0 disables the pool.
+  size_t iterator_pool_max_pinned_bytes;
+
   // When set to true, the read path will use the copyset index to skip records
   // that do not pass copyset filters
   bool use_copyset_index;
@@ -282,6 +329,10 @@ class RocksDBSettings : public SettingsBundle {
   // instead of doing a binary search in the relevant partition.
   bool read_find_time_index;
 
+  // Maximum number of (timestamp, lsn) samples kept in memory for each log in
+  // each partition to narrow the binary search done by findTime. 0 disables.
+  size_t find_time_samples_per_partition;
+
   // If true, PartitionedRocksDBStore will be opened in read only mode.
   bool read_only;
 
@@ -373,11 +424,25 @@ class RocksDBSettings : public SettingsBundle {
 
   bool print_details;
 
-  struct IOTracingShards {
+  // A set of shards given as a comma-separated list of indices, 'all' or
+  // 'none'.
+  struct ShardList {
     std::vector<shard_index_t> shards;
     bool all_shards = false;
+
+    bool contains(shard_index_t shard_idx) const {
+      return all_shards ||
+          std::binary_search(shards.begin(), shards.end(), shard_idx);
+    }
   };
-  IOTracingShards io_tracing_shards;
+  ShardList io_tracing_shards;
+
+  // Shards whose RocksDB instance is kept in memory instead of on disk. See
+  // .cpp
+  ShardList in_memory_shards;
+
+  // See .cpp
+  size_t in_memory_shard_capacity;
 
   std::chrono::milliseconds io_tracing_threshold;
 
@@ -410,6 +475,9 @@ class RocksDBSettings : public SettingsBundle {
   // Ratio of rocksdb block cache reserve for index and filter blocks.
   double cache_high_pri_pool_ratio_;
 
+  // Allocate uncompressed block cache entries from a dedicated jemalloc arena.
+  bool cache_dedicated_arena_;
+
   // If greater than 0, will create a bitmap to estimate rocksdb read
   // amplification and expose the result through
   // READ_AMP_ESTIMATE_USEFUL_BYTES and READ_AMP_TOTAL_READ_BYTES stats.
@@ -449,6 +517,13 @@ class RocksDBSettings : public SettingsBundle {
   uint64_t compaction_max_bytes_at_once;
   uint64_t bytes_per_sync;
   uint64_t wal_bytes_per_sync;
+
+  // If not empty, directory under which each shard keeps its WAL (in a
+  // "shard<idx>" subdirectory) instead of keeping it next to its sst files.
+  std::string wal_dir;
+
+  // Number of WAL files rocksdb reuses instead of creating new ones.
+  size_t recycle_log_file_num;
   size_t compaction_readahead_size;
   int level0_file_num_compaction_trigger;
   int level0_slowdown_writes_trigger;
@@ -488,6 +563,9 @@ class RocksDBSettings : public SettingsBundle {
 
   int index_block_restart_interval;
 
+  // Same as index_block_restart_interval, for data blocks.
+  int block_restart_interval;
+
  private:
   // Only UpdateableSettings can create this bundle.
   RocksDBSettings() {}
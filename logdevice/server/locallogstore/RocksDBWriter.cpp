@@ -10,7 +10,10 @@
 #include <algorithm>
 
 #include <folly/small_vector.h>
+#include <rocksdb/comparator.h>
 #include <rocksdb/env.h>
+#include <rocksdb/sst_file_writer.h>
+#include <rocksdb/write_batch.h>
 
 #include "logdevice/common/LocalLogStoreRecordFormat.h"
 #include "logdevice/common/Metadata.h"
@@ -32,6 +35,24 @@ static_assert(sizeof(DataKey) == 21, "expected 21");
 static_assert(sizeof(LogMetaKey) == 9, "expected 9");
 static_assert(sizeof(StoreMetaKey) == 1, "expected 1");
 
+size_t RocksDBWriter::findFirstMalformedPut(
+    const std::vector<const WriteOp*>& writes) {
+  folly::small_vector<Slice, 16> headers;
+  folly::small_vector<Slice, 16> data;
+  folly::small_vector<size_t, 16> idx;
+  for (size_t i = 0; i < writes.size(); ++i) {
+    if (writes[i]->getType() == WriteType::PUT) {
+      const PutWriteOp* op = static_cast<const PutWriteOp*>(writes[i]);
+      headers.push_back(op->record_header);
+      data.push_back(op->data);
+      idx.push_back(i);
+    }
+  }
+  size_t bad = LocalLogStoreRecordFormat::checkWellFormedBatch(
+      headers.data(), data.data(), headers.size());
+  return bad < idx.size() ? idx[bad] : writes.size();
+}
+
 int RocksDBWriter::writeMulti(
     const std::vector<const WriteOp*>& writes,
     const LocalLogStore::WriteOptions& /*write_options*/,
@@ -50,16 +71,20 @@ int RocksDBWriter::writeMulti(
     return -1;
   }
 
-  size_t csi_entry_writes = 0;
-  size_t index_entry_writes = 0;
+  PutStats put_stats;
   SCOPE_EXIT {
-    STAT_ADD(store_->getStatsHolder(), csi_entry_writes, csi_entry_writes);
-    STAT_ADD(store_->getStatsHolder(), index_entry_writes, index_entry_writes);
+    STAT_ADD(store_->getStatsHolder(),
+             csi_entry_writes,
+             put_stats.csi_entry_writes);
+    STAT_ADD(store_->getStatsHolder(),
+             index_entry_writes,
+             put_stats.index_entry_writes);
   };
 
-  size_t record_bytes = 0;
-  size_t csi_bytes = 0;
-  size_t index_bytes = 0;
+  const bool verify_checksums = !skip_checksum_verification &&
+      store_->getSettings()->verify_checksum_during_store;
+  const size_t first_malformed =
+      verify_checksums ? findFirstMalformedPut(writes) : writes.size();
 
   for (size_t i = 0; i < writes.size(); ++i) {
     const WriteOp* write = writes[i];
@@ -73,14 +98,9 @@ int RocksDBWriter::writeMulti(
       case WriteType::PUT: {
         const PutWriteOp* op = static_cast<const PutWriteOp*>(write);
 
-        DataKey key(op->log_id, op->lsn);
-
-        if (!skip_checksum_verification &&
-            store_->getSettings()->verify_checksum_during_store) {
+        if (verify_checksums) {
           // Reject to store malformed records.
-          rv = LocalLogStoreRecordFormat::checkWellFormed(
-              op->record_header, op->data);
-          if (rv != 0) {
+          if (i == first_malformed) {
             RATELIMIT_ERROR(std::chrono::seconds(10),
                             10,
                             "Refusing to write malformed record %lu%s. "
@@ -108,78 +128,7 @@ int RocksDBWriter::writeMulti(
           }
         }
 
-        // NOTE: There is an assumption in prepare_write_op() in
-        // RocksDBWriterMergeOperator that the value in RocksDB will be
-        // exactly the concatenation of the header and data blobs.  If that
-        // ever changes here, take care to update the code there as well.
-        rocksdb::Slice key_slice =
-            key.sliceForWriting(op->TEST_data_key_format);
-
-        folly::small_vector<rocksdb::Slice, 3> value_slices;
-
-        // NOTE: At least RocksDBWriterMergeOperator and
-        // RocksDBCompactionFilter expect this format (header byte then same
-        // as normal non-merge stores).
-        value_slices.emplace_back(
-            &RocksDBWriterMergeOperator::DATA_MERGE_HEADER, 1);
-        value_slices.emplace_back(
-            reinterpret_cast<const char*>(op->record_header.data),
-            op->record_header.size);
-        value_slices.emplace_back(
-            reinterpret_cast<const char*>(op->data.data), op->data.size);
-
-        rocksdb_batch.Merge(
-            data_cf,
-            rocksdb::SliceParts(&key_slice, 1),
-            rocksdb::SliceParts(value_slices.data(), value_slices.size()));
-
-        record_bytes += key_slice.size();
-        for (const auto& s : value_slices) {
-          record_bytes += s.size();
-        }
-
-        if (op->copyset_index_lsn.has_value()) {
-          // Writing copyset index entry
-          ++csi_entry_writes;
-          ld_check(op->copyset_index_entry.data);
-          ld_check(op->copyset_index_entry.size);
-          // TODO (t9002309): block records
-          ld_check(op->copyset_index_lsn.value() == LSN_INVALID);
-          lsn_t csi_lsn = op->lsn;
-
-          // Writing copyset index entry
-          CopySetIndexKey key{op->log_id,
-                              csi_lsn,
-                              // TODO (t9002309): block records
-                              CopySetIndexKey::SINGLE_ENTRY_TYPE};
-          Slice value = op->copyset_index_entry;
-          rocksdb::Slice csi_key_slice(
-              reinterpret_cast<const char*>(&key), sizeof key);
-          rocksdb::Slice value_slice(
-              reinterpret_cast<const char*>(value.data), value.size);
-          rocksdb_batch.Merge(data_cf, csi_key_slice, value_slice);
-
-          csi_bytes += csi_key_slice.size() + value_slice.size();
-        }
-
-        // Writing index entries
-        for (auto it = op->index_key_list.begin();
-             it != op->index_key_list.end();
-             ++it) {
-          // Writing a findTime or findKey index entry
-          ++index_entry_writes;
-
-          folly::small_vector<char, 26> index_key =
-              RocksDBKeyFormat::IndexKey::create(op->log_id,
-                                                 (*it).first,  // index type
-                                                 (*it).second, // key
-                                                 op->lsn);
-          rocksdb::Slice k_slice(index_key.data(), index_key.size());
-          rocksdb::Slice v_slice(nullptr, 0);
-          rocksdb_batch.Put(data_cf, k_slice, v_slice);
-
-          index_bytes += k_slice.size();
-        }
+        addPutToBatch(*op, data_cf, rocksdb_batch, &put_stats);
         break;
       }
 
@@ -389,12 +338,204 @@ int RocksDBWriter::writeMulti(
     options.disableWAL = true;
   }
 
-  STAT_ADD(store_->getStatsHolder(), record_bytes_written, record_bytes);
-  STAT_ADD(store_->getStatsHolder(), csi_bytes_written, csi_bytes);
-  STAT_ADD(store_->getStatsHolder(), index_bytes_written, index_bytes);
+  addPutStats(put_stats);
   return 0;
 }
 
+void RocksDBWriter::addPutToBatch(const PutWriteOp& op,
+                                  rocksdb::ColumnFamilyHandle* data_cf,
+                                  rocksdb::WriteBatch& batch,
+                                  PutStats* stats) {
+  DataKey key(op.log_id, op.lsn);
+
+  // NOTE: There is an assumption in prepare_write_op() in
+  // RocksDBWriterMergeOperator that the value in RocksDB will be
+  // exactly the concatenation of the header and data blobs.  If that
+  // ever changes here, take care to update the code there as well.
+  rocksdb::Slice key_slice = key.sliceForWriting(op.TEST_data_key_format);
+
+  folly::small_vector<rocksdb::Slice, 3> value_slices;
+
+  // NOTE: At least RocksDBWriterMergeOperator and
+  // RocksDBCompactionFilter expect this format (header byte then same
+  // as normal non-merge stores).
+  value_slices.emplace_back(&RocksDBWriterMergeOperator::DATA_MERGE_HEADER, 1);
+  value_slices.emplace_back(
+      reinterpret_cast<const char*>(op.record_header.data),
+      op.record_header.size);
+  value_slices.emplace_back(
+      reinterpret_cast<const char*>(op.data.data), op.data.size);
+
+  batch.Merge(data_cf,
+              rocksdb::SliceParts(&key_slice, 1),
+              rocksdb::SliceParts(value_slices.data(), value_slices.size()));
+
+  stats->record_bytes += key_slice.size();
+  for (const auto& s : value_slices) {
+    stats->record_bytes += s.size();
+  }
+
+  if (op.copyset_index_lsn.has_value()) {
+    // Writing copyset index entry
+    ++stats->csi_entry_writes;
+    ld_check(op.copyset_index_entry.data);
+    ld_check(op.copyset_index_entry.size);
+    // TODO (t9002309): block records
+    ld_check(op.copyset_index_lsn.value() == LSN_INVALID);
+    lsn_t csi_lsn = op.lsn;
+
+    // Writing copyset index entry
+    CopySetIndexKey key{op.log_id,
+                        csi_lsn,
+                        // TODO (t9002309): block records
+                        CopySetIndexKey::SINGLE_ENTRY_TYPE};
+    Slice value = op.copyset_index_entry;
+    rocksdb::Slice csi_key_slice(
+        reinterpret_cast<const char*>(&key), sizeof key);
+    rocksdb::Slice value_slice(
+        reinterpret_cast<const char*>(value.data), value.size);
+    batch.Merge(data_cf, csi_key_slice, value_slice);
+
+    stats->csi_bytes += csi_key_slice.size() + value_slice.size();
+  }
+
+  // Writing index entries
+  for (auto it = op.index_key_list.begin(); it != op.index_key_list.end();
+       ++it) {
+    // Writing a findTime or findKey index entry
+    ++stats->index_entry_writes;
+
+    folly::small_vector<char, 26> index_key =
+        RocksDBKeyFormat::IndexKey::create(op.log_id,
+                                           (*it).first,  // index type
+                                           (*it).second, // key
+                                           op.lsn);
+    rocksdb::Slice k_slice(index_key.data(), index_key.size());
+    rocksdb::Slice v_slice(nullptr, 0);
+    batch.Put(data_cf, k_slice, v_slice);
+
+    stats->index_bytes += k_slice.size();
+  }
+}
+
+void RocksDBWriter::addPutStats(const PutStats& stats) {
+  STAT_ADD(store_->getStatsHolder(), record_bytes_written, stats.record_bytes);
+  STAT_ADD(store_->getStatsHolder(), csi_bytes_written, stats.csi_bytes);
+  STAT_ADD(store_->getStatsHolder(), index_bytes_written, stats.index_bytes);
+}
+
+bool RocksDBWriter::ingestPuts(const std::vector<const PutWriteOp*>& ops,
+                               rocksdb::ColumnFamilyHandle* data_cf,
+                               const std::string& dir) {
+  ld_check(!ops.empty());
+  ld_check(data_cf != nullptr);
+  rocksdb::DB& db = store_->getDB();
+  rocksdb::Env* env = db.GetEnv();
+
+  std::call_once(ingest_dir_cleanup_once_, [&] {
+    env->CreateDirIfMissing(dir);
+    std::vector<std::string> children;
+    if (env->GetChildren(dir, &children).ok()) {
+      for (const std::string& name : children) {
+        if (name != "." && name != "..") {
+          env->DeleteFile(dir + "/" + name);
+        }
+      }
+    }
+  });
+
+  // Encode the PUTs the same way writeMulti() does, then sort the resulting
+  // key-values, as sst files require.
+  rocksdb::WriteBatch batch;
+  PutStats put_stats;
+  for (const PutWriteOp* op : ops) {
+    addPutToBatch(*op, data_cf, batch, &put_stats);
+  }
+
+  struct Entry {
+    bool merge;
+    rocksdb::Slice key;
+    rocksdb::Slice value;
+  };
+  struct Collector : public rocksdb::WriteBatch::Handler {
+    std::vector<Entry> entries;
+    rocksdb::Status PutCF(uint32_t,
+                          const rocksdb::Slice& key,
+                          const rocksdb::Slice& value) override {
+      entries.push_back({false, key, value});
+      return rocksdb::Status::OK();
+    }
+    rocksdb::Status MergeCF(uint32_t,
+                            const rocksdb::Slice& key,
+                            const rocksdb::Slice& value) override {
+      entries.push_back({true, key, value});
+      return rocksdb::Status::OK();
+    }
+  } collector;
+  rocksdb::Status status = batch.Iterate(&collector);
+  ld_check(status.ok());
+
+  rocksdb::Options options = db.GetOptions(data_cf);
+  const rocksdb::Comparator* cmp = options.comparator;
+  std::sort(collector.entries.begin(),
+            collector.entries.end(),
+            [cmp](const Entry& a, const Entry& b) {
+              return cmp->Compare(a.key, b.key) < 0;
+            });
+  for (size_t i = 1; i < collector.entries.size(); ++i) {
+    if (cmp->Compare(collector.entries[i - 1].key, collector.entries[i].key) ==
+        0) {
+      // Same record written twice in one batch, e.g. a store and an amend.
+      return false;
+    }
+  }
+
+  const std::string path = dir + "/" + std::to_string(store_->getShardIdx()) +
+      "-" + std::to_string(next_ingest_file_id_++) + ".sst";
+  rocksdb::SstFileWriter sst_writer(rocksdb::EnvOptions(), options, data_cf);
+  status = sst_writer.Open(path);
+  for (size_t i = 0; status.ok() && i < collector.entries.size(); ++i) {
+    const Entry& e = collector.entries[i];
+    status = e.merge ? sst_writer.Merge(e.key, e.value)
+                     : sst_writer.Put(e.key, e.value);
+  }
+  if (status.ok()) {
+    status = sst_writer.Finish();
+  }
+  if (status.ok()) {
+    rocksdb::IngestExternalFileOptions ingest_options;
+    ingest_options.move_files = true;
+    // Records may be concurrently written to the partition through memtable,
+    // e.g. by recovery. Rather than stalling this storage thread on a flush,
+    // let the caller write these records to memtable too.
+    ingest_options.allow_blocking_flush = false;
+    status = db.IngestExternalFile(data_cf, {path}, ingest_options);
+  }
+  if (!status.ok()) {
+    RATELIMIT_INFO(std::chrono::seconds(10),
+                   2,
+                   "Couldn't ingest %lu rebuilding records as %s, writing "
+                   "them to memtable instead: %s",
+                   ops.size(),
+                   path.c_str(),
+                   status.ToString().c_str());
+    env->DeleteFile(path);
+    STAT_INCR(store_->getStatsHolder(), rebuilding_ingest_fallbacks);
+    return false;
+  }
+
+  addPutStats(put_stats);
+  STAT_ADD(store_->getStatsHolder(),
+           csi_entry_writes,
+           put_stats.csi_entry_writes);
+  STAT_ADD(store_->getStatsHolder(),
+           index_entry_writes,
+           put_stats.index_entry_writes);
+  STAT_INCR(store_->getStatsHolder(), rebuilding_ingested_files);
+  STAT_ADD(store_->getStatsHolder(), rebuilding_ingested_records, ops.size());
+  return true;
+}
+
 // ====== Metadata operations ======
 
 int RocksDBWriter::readLogMetadata(logid_t log_id,
@@ -403,7 +544,12 @@ int RocksDBWriter::readLogMetadata(logid_t log_id,
   SCOPED_IO_TRACING_CONTEXT(store_->getIOTracing(),
                             "read-log-meta:{}",
                             logMetadataTypeNames()[metadata->getType()]);
-  return readMetadata(LogMetaKey(metadata->getType(), log_id), metadata, cf);
+  LogMetaKey key(metadata->getType(), log_id);
+  if (log_metadata_write_batch_size_ > 0 &&
+      readPendingLogMetadata(key, metadata)) {
+    return 0;
+  }
+  return readMetadata(key, metadata, cf);
 }
 
 int RocksDBWriter::readStoreMetadata(StoreMetadata* metadata,
@@ -418,8 +564,13 @@ int RocksDBWriter::writeLogMetadata(logid_t log_id,
                                     const LogMetadata& metadata,
                                     const LocalLogStore::WriteOptions& options,
                                     rocksdb::ColumnFamilyHandle* cf) {
-  return writeMetadata(
-      LogMetaKey(metadata.getType(), log_id), metadata, options, cf);
+  LogMetaKey key(metadata.getType(), log_id);
+  if (shouldBufferLogMetadata(metadata) && !read_only_ &&
+      store_->acceptingWrites() != E::DISABLED && metadata.valid()) {
+    return bufferLogMetadata(key, metadata, cf);
+  }
+  // writeMetadata() also reports the errors.
+  return writeMetadata(key, metadata, options, cf);
 }
 
 int RocksDBWriter::deleteStoreMetadata(
@@ -495,15 +646,7 @@ int RocksDBWriter::updateLogMetadata(
     return -1;
   }
 
-  rocksdb::WriteBatch batch;
-
   LogMetaKey key(metadata.getType(), log_id);
-  Slice value(metadata.serialize());
-
-  batch.Put(
-      cf,
-      rocksdb::Slice(reinterpret_cast<const char*>(&key), sizeof key),
-      rocksdb::Slice(reinterpret_cast<const char*>(value.data), value.size));
 
   auto p = LogMetadataFactory::create(metadata.getType());
   ld_assert(dynamic_cast<ComparableLogMetadata*>(p.get()) != nullptr);
@@ -527,11 +670,122 @@ int RocksDBWriter::updateLogMetadata(
     return -1;
   }
 
+  if (shouldBufferLogMetadata(metadata)) {
+    return bufferLogMetadata(key, metadata, cf);
+  }
+
+  rocksdb::WriteBatch batch;
+  Slice value(metadata.serialize());
+  batch.Put(
+      cf,
+      rocksdb::Slice(reinterpret_cast<const char*>(&key), sizeof key),
+      rocksdb::Slice(reinterpret_cast<const char*>(value.data), value.size));
+
+  rocksdb::Status status = store_->writeBatch(rocksdb::WriteOptions(), &batch);
+  if (!status.ok()) {
+    err = E::LOCAL_LOG_STORE_WRITE;
+    return -1;
+  }
+  return 0;
+}
+
+bool RocksDBWriter::shouldBufferLogMetadata(const LogMetadata& metadata) const {
+  // Merges would need to be applied to the pending value on read; not worth
+  // it while no LogMetadata uses them.
+  return log_metadata_write_batch_size_ > 0 && !detail::useMerge(metadata);
+}
+
+int RocksDBWriter::bufferLogMetadata(const LogMetaKey& key,
+                                     const LogMetadata& metadata,
+                                     rocksdb::ColumnFamilyHandle* cf) {
+  Slice value(metadata.serialize());
+  bool replaced;
+  bool batch_full;
+  {
+    std::lock_guard<std::mutex> lock(pending_log_metadata_mutex_);
+    auto ins = pending_log_metadata_.emplace(
+        std::string(reinterpret_cast<const char*>(&key), sizeof key),
+        PendingLogMetadata());
+    PendingLogMetadata& pending = ins.first->second;
+    pending.cf = cf;
+    pending.value.assign(static_cast<const char*>(value.data), value.size);
+    pending.version = ++next_pending_version_;
+    replaced = !ins.second;
+    num_pending_log_metadata_.store(pending_log_metadata_.size());
+    batch_full =
+        pending_log_metadata_.size() >= log_metadata_write_batch_size_;
+  }
+
+  STAT_INCR(store_->getStatsHolder(), log_metadata_writes_buffered);
+  if (replaced) {
+    STAT_INCR(store_->getStatsHolder(), log_metadata_writes_coalesced);
+  }
+  return batch_full ? flushPendingLogMetadata() : 0;
+}
+
+bool RocksDBWriter::readPendingLogMetadata(const LogMetaKey& key,
+                                           LogMetadata* metadata) {
+  if (num_pending_log_metadata_.load() == 0) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(pending_log_metadata_mutex_);
+  auto it = pending_log_metadata_.find(
+      std::string(reinterpret_cast<const char*>(&key), sizeof key));
+  if (it == pending_log_metadata_.end()) {
+    return false;
+  }
+  int rv = metadata->deserialize(
+      Slice(it->second.value.data(), it->second.value.size()));
+  // We serialized it ourselves.
+  ld_check(rv == 0);
+  return rv == 0;
+}
+
+int RocksDBWriter::flushPendingLogMetadata() {
+  if (num_pending_log_metadata_.load() == 0) {
+    return 0;
+  }
+
+  std::lock_guard<std::recursive_mutex> flush_lock(log_metadata_flush_mutex_);
+  if (flushing_log_metadata_) {
+    // Called by the writeBatch() below.
+    return 0;
+  }
+
+  rocksdb::WriteBatch batch;
+  std::vector<std::pair<std::string, uint64_t>> flushed;
+  {
+    std::lock_guard<std::mutex> lock(pending_log_metadata_mutex_);
+    flushed.reserve(pending_log_metadata_.size());
+    for (const auto& kv : pending_log_metadata_) {
+      batch.Put(kv.second.cf, kv.first, kv.second.value);
+      flushed.emplace_back(kv.first, kv.second.version);
+    }
+  }
+  if (flushed.empty()) {
+    return 0;
+  }
+
+  flushing_log_metadata_ = true;
   rocksdb::Status status = store_->writeBatch(rocksdb::WriteOptions(), &batch);
+  flushing_log_metadata_ = false;
   if (!status.ok()) {
     err = E::LOCAL_LOG_STORE_WRITE;
     return -1;
   }
+
+  {
+    std::lock_guard<std::mutex> lock(pending_log_metadata_mutex_);
+    for (const auto& key_version : flushed) {
+      auto it = pending_log_metadata_.find(key_version.first);
+      if (it != pending_log_metadata_.end() &&
+          it->second.version == key_version.second) {
+        pending_log_metadata_.erase(it);
+      }
+    }
+    num_pending_log_metadata_.store(pending_log_metadata_.size());
+  }
+  STAT_INCR(store_->getStatsHolder(), log_metadata_batches_flushed);
   return 0;
 }
 
@@ -733,6 +987,10 @@ int RocksDBWriter::writeLogSnapshotBlobs(
 }
 
 rocksdb::Status RocksDBWriter::syncWAL() {
+  if (flushPendingLogMetadata() != 0) {
+    return rocksdb::Status::IOError("failed to write pending log metadata");
+  }
+
   FlushToken synced_up_to = next_wal_sync_token_.fetch_add(1);
 
   auto time_start = std::chrono::steady_clock::now();
@@ -10,6 +10,7 @@
 #include <deque>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <folly/Demangle.h>
@@ -39,10 +40,23 @@ namespace facebook { namespace logdevice {
  *       (The name is quite inaccurate. Feel free to rename.)
  *       Writes to DB should go through RocksDBLogStoreBase::writeBatch() to
  *       bump stats and keep track of persistent error.
+ *
+ *       If RocksDBSettings::log_metadata_write_batch_size is nonzero,
+ *       writeLogMetadata() and updateLogMetadata() don't write to rocksdb
+ *       right away. Instead the serialized value is kept in an in-memory map
+ *       of pending log metadata, which readLogMetadata() consults before
+ *       rocksdb, so repeated updates of the same log (e.g. seal and last clean
+ *       epoch during recovery) are coalesced. The pending map is written out
+ *       as one batch by flushPendingLogMetadata(), which
+ *       RocksDBLogStoreBase::writeBatch() calls before every other write, so
+ *       rocksdb sees writes in the order they were issued, and syncWAL()
+ *       calls before syncing, so LocalLogStore::sync() makes buffered metadata
+ *       as durable as it made direct writes.
  */
 
 class ComparableLogMetadata;
 class LogMetadata;
+class PutWriteOp;
 class StoreMetadata;
 class WriteOp;
 
@@ -64,7 +78,9 @@ class RocksDBWriter {
                          const RocksDBSettings& rocksdb_settings)
       : store_(store),
         read_only_(rocksdb_settings.read_only),
-        locks_(rocksdb_settings.num_metadata_locks) {}
+        locks_(rocksdb_settings.num_metadata_locks),
+        log_metadata_write_batch_size_(
+            rocksdb_settings.log_metadata_write_batch_size) {}
 
   // see common/LocalLogStore.h for the description of these methods
 
@@ -90,6 +106,26 @@ class RocksDBWriter {
                  rocksdb::WriteBatch& mem_batch,
                  bool skip_checksum_verification = false);
 
+  // Checks that all PUT operations in `writes` are well formed, verifying
+  // their checksums in one batch (see
+  // LocalLogStoreRecordFormat::checkWellFormedBatch()).
+  // @return  index in `writes` of the first malformed record, or
+  //          writes.size() if all of them are fine.
+  static size_t
+  findFirstMalformedPut(const std::vector<const WriteOp*>& writes);
+
+  // Writes the given PUTs, which must all go to column family `data_cf` and
+  // have distinct keys, to an sst file and ingests it into the column family,
+  // bypassing memtable and WAL. The records are durable once this returns.
+  // `dir` is where the sst file is created before being moved into the DB.
+  // @return  true on success. false if the file couldn't be written or
+  //          ingested, e.g. because the memtable overlaps its key range; in
+  //          this case nothing was written and the caller should write the
+  //          PUTs the usual way.
+  bool ingestPuts(const std::vector<const PutWriteOp*>& ops,
+                  rocksdb::ColumnFamilyHandle* data_cf,
+                  const std::string& dir);
+
   int readLogMetadata(logid_t log_id,
                       LogMetadata* metadata,
                       rocksdb::ColumnFamilyHandle* cf);
@@ -355,8 +391,16 @@ class RocksDBWriter {
       const std::vector<std::pair<logid_t, Slice>>& snapshots);
 
   // A wrapper around rocksdb::DB::SyncWAL() which also updates stats.
+  // Writes out pending log metadata first.
   rocksdb::Status syncWAL();
 
+  // Writes all pending log metadata (see the comment at the top) to rocksdb
+  // in one batch. Blocks while another thread is doing the same, so that
+  // when it returns all log metadata written before the call is in rocksdb.
+  // @return  0 on success, -1 with err set to LOCAL_LOG_STORE_WRITE if the
+  //          write failed; the metadata stays pending in that case.
+  int flushPendingLogMetadata();
+
   FlushToken maxWALSyncToken() const {
     return next_wal_sync_token_.load();
   }
@@ -402,11 +446,71 @@ class RocksDBWriter {
                                       PerEpochLogMetadata* metadata,
                                       rocksdb::ColumnFamilyHandle* cf);
 
+  // Should writes of this metadata go to pending_log_metadata_?
+  bool shouldBufferLogMetadata(const LogMetadata& metadata) const;
+
+  // Adds or replaces the pending value of the given key, flushing the
+  // pending log metadata if there's log_metadata_write_batch_size_ of it.
+  // Amounts of data written by PUTs, for stats.
+  struct PutStats {
+    size_t record_bytes = 0;
+    size_t csi_bytes = 0;
+    size_t index_bytes = 0;
+    size_t csi_entry_writes = 0;
+    size_t index_entry_writes = 0;
+  };
+
+  // Adds the data, copyset index and index entries of `op` to `batch`.
+  static void addPutToBatch(const PutWriteOp& op,
+                            rocksdb::ColumnFamilyHandle* data_cf,
+                            rocksdb::WriteBatch& batch,
+                            PutStats* stats);
+
+  void addPutStats(const PutStats& stats);
+
+  int bufferLogMetadata(const RocksDBKeyFormat::LogMetaKey& key,
+                        const LogMetadata& metadata,
+                        rocksdb::ColumnFamilyHandle* cf);
+
+  // If the given key has a pending value, deserializes it into `metadata`
+  // and returns true.
+  bool readPendingLogMetadata(const RocksDBKeyFormat::LogMetaKey& key,
+                              LogMetadata* metadata);
+
   RocksDBLogStoreBase* store_;
   bool read_only_;
   // locks protecting metadata updates (read-modify-write)
   std::vector<std::mutex> locks_;
 
+  struct PendingLogMetadata {
+    rocksdb::ColumnFamilyHandle* cf;
+    std::string value;
+    // Tells flushPendingLogMetadata() whether the value was replaced while
+    // the batch containing the old value was being written.
+    uint64_t version;
+  };
+
+  const size_t log_metadata_write_batch_size_;
+  // Serialized LogMetaKey -> value not yet written to rocksdb.
+  std::unordered_map<std::string, PendingLogMetadata> pending_log_metadata_;
+  uint64_t next_pending_version_{0};
+  std::mutex pending_log_metadata_mutex_;
+  // pending_log_metadata_.size(), readable without the mutex. Entries are
+  // only erased after they are written, so a nonzero value makes
+  // flushPendingLogMetadata() wait for a flush in progress.
+  std::atomic<size_t> num_pending_log_metadata_{0};
+  // Serializes flushes. Recursive because the flush's own writeBatch() call
+  // calls flushPendingLogMetadata() again; flushing_log_metadata_ turns that
+  // nested call into a no-op.
+  std::recursive_mutex log_metadata_flush_mutex_;
+  bool flushing_log_metadata_{false};
+
+  // Used for naming sst files created by ingestPuts().
+  std::atomic<uint64_t> next_ingest_file_id_{0};
+  // Leftover sst files are removed from the ingestion directory the first
+  // time ingestPuts() uses it.
+  std::once_flag ingest_dir_cleanup_once_;
+
   std::atomic<FlushToken> next_wal_sync_token_{1};
   std::atomic<FlushToken> wal_synced_up_to_token_{0};
 };
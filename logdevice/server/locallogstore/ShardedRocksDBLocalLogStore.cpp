@@ -22,6 +22,7 @@
 #include <sys/stat.h>
 
 #include "logdevice/common/ConstructorFailed.h"
+#include "logdevice/common/NumaPlacement.h"
 #include "logdevice/common/RandomAccessQueue.h"
 #include "logdevice/common/ThreadID.h"
 #include "logdevice/common/settings/RebuildingSettings.h"
@@ -83,6 +84,14 @@ bool ShardedRocksDBLocalLogStore::createOrValidatePaths() {
         fs::path(base_path_) / fs::path("shard" + std::to_string(shard_idx));
   }
 
+  wal_paths_.assign(nshards_, fs::path());
+  if (!db_settings_->wal_dir.empty()) {
+    for (shard_index_t shard_idx = 0; shard_idx < nshards_; ++shard_idx) {
+      wal_paths_.at(shard_idx) = fs::path(db_settings_->wal_dir) /
+          fs::path("shard" + std::to_string(shard_idx));
+    }
+  }
+
   return true;
 }
 
@@ -133,6 +142,16 @@ void ShardedRocksDBLocalLogStore::init(
     env_->SetBackgroundThreads(num_bg_threads_hi, rocksdb::Env::HIGH);
   }
 
+  in_memory_envs_.resize(nshards_);
+  for (shard_index_t shard_idx = 0; shard_idx < nshards_; ++shard_idx) {
+    if (db_settings_->in_memory_shards.contains(shard_idx)) {
+      in_memory_envs_[shard_idx].reset(rocksdb::NewMemEnv(env_.get()));
+      ld_info("Shard %d will be kept in memory. Its data won't survive a "
+              "restart.",
+              shard_idx);
+    }
+  }
+
   rocksdb_config_ = RocksDBLogStoreConfig(
       db_settings_, rebuilding_settings, env_.get(), updateable_config, stats_);
 
@@ -167,9 +186,16 @@ void ShardedRocksDBLocalLogStore::init(
       RocksDBLogStoreConfig shard_config = rocksdb_config_;
       shard_config.createMergeOperator(shard_idx);
 
-      // Create SstFileManager for this shard
-      if (is_db_local_) {
+      if (in_memory_envs_[shard_idx]) {
+        // Nothing to throttle for files in memory.
+        shard_config.options_.env = in_memory_envs_[shard_idx].get();
+      } else if (is_db_local_) {
+        // Create SstFileManager for this shard
         shard_config.addSstFileManagerForShard();
+        if (!wal_paths_[shard_idx].empty()) {
+          // rocksdb creates the subdirectory if it is missing.
+          shard_config.options_.wal_dir = wal_paths_[shard_idx].string();
+        }
       } else {
         // Don't throttle file deletion when using remote storage.
       }
@@ -317,6 +343,19 @@ bool ShardedRocksDBLocalLogStore::wipe(
            ++dir_it) {
         fs::remove_all(dir_it->path());
       }
+
+      // A WAL kept elsewhere would otherwise be replayed into the new DB.
+      const fs::path& wal_path = wal_paths_.at(shard_idx);
+      if (!wal_path.empty() && fs::is_directory(wal_path)) {
+        ld_info("Wiping WAL of shard %d at %s",
+                shard_idx,
+                wal_path.string().c_str());
+        for (fs::directory_iterator end_dir_it, dir_it(wal_path);
+             dir_it != end_dir_it;
+             ++dir_it) {
+          fs::remove_all(dir_it->path());
+        }
+      }
     } catch (const fs::filesystem_error& e) {
       ld_critical("Failed to wipe/validate %s: %s. Failing safe and aborting",
                   shard_path.string().c_str(),
@@ -583,6 +622,73 @@ int ShardedRocksDBLocalLogStore::trimLogsBasedOnSpaceIfNeeded(
   return 0;
 }
 
+void ShardedRocksDBLocalLogStore::trimInMemoryShardsIfNeeded() {
+  const size_t capacity = db_settings_->in_memory_shard_capacity;
+  if (capacity == 0) {
+    return;
+  }
+
+  for (shard_index_t shard_idx = 0; shard_idx < numShards(); ++shard_idx) {
+    if (!isShardInMemory(shard_idx)) {
+      continue;
+    }
+    auto partitioned_store =
+        dynamic_cast<PartitionedRocksDBStore*>(getByIndex(shard_idx));
+    if (partitioned_store == nullptr) {
+      // Failing shard, or not partitioned.
+      RATELIMIT_INFO(std::chrono::minutes(1),
+                     1,
+                     "rocksdb-in-memory-shard-capacity is only supported on "
+                     "partitioned storage; not enforcing it for shard %d",
+                     shard_idx);
+      continue;
+    }
+
+    auto partition_list = partitioned_store->getPartitionList();
+    size_t space_usage =
+        partitioned_store->getApproximatePartitionSize(
+            partitioned_store->getMetadataCFHandle()) +
+        partitioned_store->getApproximatePartitionSize(
+            partitioned_store->getUnpartitionedCFHandle());
+    std::vector<size_t> partition_sizes;
+    for (const auto& partition : *partition_list) {
+      partition_sizes.push_back(
+          partitioned_store->getApproximatePartitionSize(
+              partition->cf_->get()));
+      space_usage += partition_sizes.back();
+    }
+    if (space_usage <= capacity) {
+      continue;
+    }
+
+    // Drop the oldest partitions, but never the latest one.
+    size_t reclaimed = 0;
+    size_t num_to_drop = 0;
+    while (space_usage - reclaimed > capacity &&
+           num_to_drop + 1 < partition_sizes.size()) {
+      reclaimed += partition_sizes[num_to_drop];
+      ++num_to_drop;
+    }
+    if (num_to_drop == 0) {
+      continue;
+    }
+
+    partition_id_t first = partition_list->firstID();
+    partition_id_t target =
+        (*std::next(partition_list->begin(), num_to_drop))->id_;
+    partitioned_store->setSpaceBasedTrimLimit(target);
+    PER_SHARD_STAT_INCR(stats_, sbt_num_storage_trims, shard_idx);
+    ld_info("Trimming in-memory shard %d: %ju used, capacity %ju, %ju "
+            "reclaimed, dropping partitions [%ju,%ju)",
+            shard_idx,
+            space_usage,
+            capacity,
+            reclaimed,
+            first,
+            target);
+  }
+}
+
 void ShardedRocksDBLocalLogStore::setSequencerInitiatedSpaceBasedRetention(
     int shard_idx) {
   if (!is_db_local_) {
@@ -593,7 +699,8 @@ void ShardedRocksDBLocalLogStore::setSequencerInitiatedSpaceBasedRetention(
            shard_idx,
            db_settings_->free_disk_space_threshold_low);
 
-  if (db_settings_->free_disk_space_threshold_low == 0) {
+  if (db_settings_->free_disk_space_threshold_low == 0 ||
+      isShardInMemory(shard_idx)) {
     return;
   }
 
@@ -665,8 +772,14 @@ size_t ShardedRocksDBLocalLogStore::createDiskShardMapping() {
   std::unordered_map<dev_t, size_t> dev_to_out_index;
   size_t success = 0, added_to_map = 0;
   shard_to_devt_.resize(shard_paths_.size());
+  shard_to_numa_node_.assign(shard_paths_.size(), -1);
 
   for (int shard_idx = 0; shard_idx < shard_paths_.size(); ++shard_idx) {
+    if (isShardInMemory(shard_idx)) {
+      // Doesn't use any disk space.
+      ++success;
+      continue;
+    }
     const fs::path& path = shard_paths_[shard_idx];
     boost::system::error_code ec;
     // Resolve any links and such
@@ -695,6 +808,7 @@ size_t ShardedRocksDBLocalLogStore::createDiskShardMapping() {
     }
 
     shard_to_devt_[shard_idx] = st.st_dev;
+    shard_to_numa_node_[shard_idx] = numa::nodeOfBlockDevice(st.st_dev);
     auto insert_result = dev_to_out_index.emplace(st.st_dev, added_to_map);
     if (!insert_result.second) {
       // A previous shard had the same dev_t so they are on the same disk.
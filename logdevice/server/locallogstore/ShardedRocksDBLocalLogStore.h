@@ -110,6 +110,12 @@ class ShardedRocksDBLocalLogStore : public ShardedLocalLogStore {
     return shards_[idx].get();
   }
 
+  int getShardNumaNode(int idx) const override {
+    return idx >= 0 && idx < shard_to_numa_node_.size()
+        ? shard_to_numa_node_[idx]
+        : -1;
+  }
+
   void setShardedStorageThreadPool(const ShardedStorageThreadPool*);
 
   /**
@@ -171,6 +177,23 @@ class ShardedRocksDBLocalLogStore : public ShardedLocalLogStore {
                                    boost::filesystem::space_info info,
                                    bool* full);
 
+  /**
+   * For each shard in rocksdb-in-memory-shards whose data exceeds
+   * rocksdb-in-memory-shard-capacity, tells the shard to drop its oldest
+   * partitions until it fits. Called periodically by LogStoreMonitor.
+   */
+  void trimInMemoryShardsIfNeeded();
+
+  /**
+   * @return true if the shard's RocksDB instance is kept in memory rather
+   *         than on disk, see rocksdb-in-memory-shards. Such shards are left
+   *         out of the disk -> shard mapping.
+   */
+  bool isShardInMemory(shard_index_t shard_idx) const {
+    return shard_idx >= 0 && shard_idx < in_memory_envs_.size() &&
+        in_memory_envs_[shard_idx] != nullptr;
+  }
+
   /**
    * Adjust DiskInfo to indicate sequencer initiated space-based retention.
    */
@@ -225,6 +248,11 @@ class ShardedRocksDBLocalLogStore : public ShardedLocalLogStore {
   std::unique_ptr<RocksDBCustomiser> customiser_;
   std::unique_ptr<RocksDBEnv> env_;
 
+  // For shards kept in memory (rocksdb-in-memory-shards), the Env holding
+  // their files; it delegates everything but file IO to env_. nullptr for
+  // shards on disk. Index in vector is shard idx.
+  std::vector<std::unique_ptr<rocksdb::Env>> in_memory_envs_;
+
   RocksDBLogStoreConfig rocksdb_config_;
 
   // subscription to update db settings on update of RocksDB settings.
@@ -244,12 +272,19 @@ class ShardedRocksDBLocalLogStore : public ShardedLocalLogStore {
   // For each shard, the directory containing the shard's database
   std::vector<boost::filesystem::path> shard_paths_;
 
+  // For each shard, the directory containing the shard's WAL if it's kept
+  // apart from the database (see RocksDBSettings::wal_dir), empty otherwise.
+  std::vector<boost::filesystem::path> wal_paths_;
+
   // Shards we shouldn't open.
   std::vector<shard_index_t> disabled_shards_;
 
   // Mapping between shard idx, and the disk on which it resides.
   // Empty if is_db_local_ is false.
   std::vector<dev_t> shard_to_devt_;
+  // NUMA node of each shard's disk, -1 if unknown. Filled in
+  // createDiskShardMapping().
+  std::vector<int> shard_to_numa_node_;
   std::unordered_map<dev_t, DiskShardMappingEntry> fspath_to_dsme_;
 
   // Base path of where the actual RocksDB folders (shards) are located.
@@ -0,0 +1,131 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/locallogstore/LogAppendMemTableRep.h"
+
+#include <map>
+#include <random>
+
+#include <gtest/gtest.h>
+#include <rocksdb/db.h>
+
+#include "logdevice/common/test/TestUtil.h"
+#include "logdevice/server/locallogstore/RocksDBKeyFormat.h"
+
+using namespace facebook::logdevice;
+using RocksDBKeyFormat::DataKey;
+
+namespace {
+
+class LogAppendMemTableRepTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    dir_ = std::make_unique<TemporaryDirectory>("LogAppendMemTableRepTest");
+    rocksdb::Options options;
+    options.create_if_missing = true;
+    options.memtable_factory = std::make_shared<LogAppendMemTableRepFactory>();
+    options.allow_concurrent_memtable_write = false;
+    rocksdb::DB* db;
+    rocksdb::Status s =
+        rocksdb::DB::Open(options, dir_->path().string(), &db);
+    ASSERT_TRUE(s.ok()) << s.ToString();
+    db_.reset(db);
+  }
+
+  void put(const std::string& key, const std::string& value) {
+    ASSERT_TRUE(db_->Put(rocksdb::WriteOptions(), key, value).ok());
+    expected_[key] = value;
+  }
+
+  void del(const std::string& key) {
+    ASSERT_TRUE(db_->Delete(rocksdb::WriteOptions(), key).ok());
+    expected_.erase(key);
+  }
+
+  static std::string dataKey(uint64_t log, lsn_t lsn) {
+    DataKey key(logid_t(log), lsn);
+    return key.sliceForWriting().ToString();
+  }
+
+  // Checks that iteration in both directions and point lookups see exactly
+  // expected_.
+  void verify() {
+    std::unique_ptr<rocksdb::Iterator> it(
+        db_->NewIterator(rocksdb::ReadOptions()));
+    auto exp = expected_.begin();
+    for (it->SeekToFirst(); it->Valid(); it->Next(), ++exp) {
+      ASSERT_NE(expected_.end(), exp);
+      EXPECT_EQ(exp->first, it->key().ToString());
+      EXPECT_EQ(exp->second, it->value().ToString());
+    }
+    ASSERT_TRUE(it->status().ok());
+    EXPECT_EQ(expected_.end(), exp);
+
+    auto rexp = expected_.rbegin();
+    for (it->SeekToLast(); it->Valid(); it->Prev(), ++rexp) {
+      ASSERT_NE(expected_.rend(), rexp);
+      EXPECT_EQ(rexp->first, it->key().ToString());
+    }
+    EXPECT_EQ(expected_.rend(), rexp);
+
+    for (const auto& kv : expected_) {
+      std::string value;
+      ASSERT_TRUE(db_->Get(rocksdb::ReadOptions(), kv.first, &value).ok());
+      EXPECT_EQ(kv.second, value);
+    }
+  }
+
+  std::unique_ptr<TemporaryDirectory> dir_;
+  std::unique_ptr<rocksdb::DB> db_;
+  std::map<std::string, std::string> expected_;
+};
+
+} // namespace
+
+TEST_F(LogAppendMemTableRepTest, Basic) {
+  std::mt19937 rng(4242);
+  std::vector<lsn_t> next_lsn(20, 1);
+  for (int i = 0; i < 2000; ++i) {
+    const uint64_t log = rng() % next_lsn.size() + 1;
+    lsn_t lsn = next_lsn[log - 1]++;
+    if (rng() % 10 == 0) {
+      // Out of order within the log, e.g. written by rebuilding.
+      lsn += 100000;
+    }
+    put(dataKey(log, lsn), "v" + std::to_string(i));
+  }
+  // Keys that aren't DataKeys, on both sides of the DataKey prefix.
+  put("Cfoo", "copyset index");
+  put("sbar", "seal");
+  put("d", "short key with DataKey prefix");
+  // Overwrites and deletions.
+  put(dataKey(3, 1), "overwritten");
+  del(dataKey(5, 2));
+  del("sbar");
+
+  verify();
+
+  std::unique_ptr<rocksdb::Iterator> it(
+      db_->NewIterator(rocksdb::ReadOptions()));
+  it->Seek(dataKey(7, 3));
+  ASSERT_TRUE(it->Valid());
+  EXPECT_EQ(expected_.lower_bound(dataKey(7, 3))->first, it->key().ToString());
+  it->SeekForPrev(dataKey(7, 3));
+  ASSERT_TRUE(it->Valid());
+  EXPECT_EQ(std::prev(expected_.upper_bound(dataKey(7, 3)))->first,
+            it->key().ToString());
+  it.reset();
+
+  // The flush iterates over the immutable memtable.
+  ASSERT_TRUE(db_->Flush(rocksdb::FlushOptions()).ok());
+  verify();
+
+  // A new memtable on top of the sst.
+  put(dataKey(1, 1), "new");
+  put(dataKey(42, 1), "new log");
+  verify();
+}
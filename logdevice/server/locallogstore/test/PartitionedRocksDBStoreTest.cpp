@@ -14,6 +14,7 @@
 #include <queue>
 #include <set>
 
+#include <folly/FileUtil.h>
 #include <folly/Random.h>
 #include <folly/Varint.h>
 #include <gtest/gtest.h>
@@ -95,13 +96,15 @@ class TestPartitionedRocksDBStore : public PartitionedRocksDBStore {
                                        RocksDBLogStoreConfig rocksdb_config,
                                        const Configuration* config,
                                        StatsHolder* stats,
-                                       SystemTimestamp* time)
+                                       SystemTimestamp* time,
+                                       RocksDBCustomiser* customiser =
+                                           RocksDBCustomiser::defaultInstance())
       : PartitionedRocksDBStore(0,
                                 1,
                                 path,
                                 std::move(rocksdb_config),
                                 config,
-                                RocksDBCustomiser::defaultInstance(),
+                                customiser,
                                 stats,
                                 /* io_tracing */ nullptr,
                                 DeferInit::YES),
@@ -901,7 +904,12 @@ class PartitionedRocksDBStoreTest : public ::testing::Test {
         log_store_config.metadata_options_.memtable_factory = mtr_factory_;
 
     store_ = std::make_unique<TestPartitionedRocksDBStore>(
-        path_, std::move(log_store_config), config_.get(), &stats_, &time_);
+        path_,
+        std::move(log_store_config),
+        config_.get(),
+        &stats_,
+        &time_,
+        customiser_);
 
     Params params;
     params[(size_t)StorageTaskThreadType::SLOW].nthreads = 1;
@@ -1084,7 +1092,8 @@ class PartitionedRocksDBStoreTest : public ::testing::Test {
   void put(std::vector<TestRecord> ops,
            std::vector<StoreChainLink> csi_copyset = {},
            bool assert_write_fail = false,
-           DataKeyFormat key_format = DataKeyFormat::DEFAULT) {
+           DataKeyFormat key_format = DataKeyFormat::DEFAULT,
+           bool write_copyset_index = true) {
     std::vector<PutWriteOp> put_write_ops(ops.size());
     std::vector<DeleteWriteOp> delete_write_ops(ops.size());
     std::vector<const WriteOp*> op_ptrs(ops.size());
@@ -1151,8 +1160,9 @@ class PartitionedRocksDBStoreTest : public ::testing::Test {
                        header,
                        payload,
                        /*coordinator*/ node_index_t(1),
-                       LSN_INVALID,
-                       csi_entry,
+                       write_copyset_index ? folly::Optional<lsn_t>(LSN_INVALID)
+                                           : folly::none,
+                       write_copyset_index ? csi_entry : Slice(),
                        {},
                        ops[i].durability,
                        ops[i].store_type == TestRecord::StoreType::REBUILD);
@@ -1550,6 +1560,8 @@ class PartitionedRocksDBStoreTest : public ::testing::Test {
   std::shared_ptr<TestCompactionFilterFactory> filter_factory_;
   StatsHolder stats_;
   std::unique_ptr<TestPartitionedRocksDBStore> store_;
+  // Customiser passed to store_ on openStore().
+  RocksDBCustomiser* customiser_ = RocksDBCustomiser::defaultInstance();
   // to remain in scope for store_ destructor when sst_file_manager used
   std::unique_ptr<RocksDBEnv> env_;
 
@@ -1655,6 +1667,109 @@ TEST_F(PartitionedRocksDBStoreTest, SimpleOutOfOrderWrites) {
   EXPECT_EQ(std::vector<lsn_t>({}), data[1][logid].records);
 }
 
+// Rebuilding stores to old partitions are ingested as sst files, while
+// rebuilding stores to the latest partitions go through the memtable.
+TEST_F(PartitionedRocksDBStoreTest, IngestRebuildingWrites) {
+  increasing_lsns_ = false;
+  updateSetting("rocksdb-ingest-rebuilding-writes-min-bytes", "1");
+  const logid_t logid(1);
+  put({TestRecord(logid, 10)});
+  for (int i = 0; i < 3; ++i) {
+    store_->createPartition();
+  }
+  put({TestRecord(logid, 100)});
+  // Ingestion falls back to the memtable if the file overlaps it.
+  EXPECT_TRUE(store_->flushMemtable(store_->getPartitionList()->get(ID0)->cf_));
+
+  put({TestRecord(
+           logid, 20, Durability::MEMORY, TestRecord::StoreType::REBUILD),
+       TestRecord(
+           logid, 30, Durability::MEMORY, TestRecord::StoreType::REBUILD)});
+  auto stats = stats_.aggregate();
+  EXPECT_EQ(1, stats.rebuilding_ingested_files);
+  EXPECT_EQ(2, stats.rebuilding_ingested_records);
+  EXPECT_EQ(0, stats.rebuilding_ingest_fallbacks);
+
+  put({TestRecord(
+      logid, 110, Durability::MEMORY, TestRecord::StoreType::REBUILD)});
+  EXPECT_EQ(1, stats_.aggregate().rebuilding_ingested_files);
+
+  auto data = readAndCheck();
+  EXPECT_EQ(4, data.size());
+  EXPECT_EQ(std::vector<lsn_t>({10, 20, 30}), data[0][logid].records);
+  EXPECT_EQ(std::vector<lsn_t>({100, 110}), data[3][logid].records);
+}
+
+// Only logs with directory entries in partitions intersecting the time ranges
+// are reported.
+TEST_F(PartitionedRocksDBStoreTest, FindLogsInTimeRanges) {
+  put({TestRecord(logid_t(1), 10, BASE_TIME)});
+  setTime(BASE_TIME + HOUR);
+  store_->createPartition();
+  put({TestRecord(logid_t(2), 10, BASE_TIME + HOUR + MINUTE)});
+  setTime(BASE_TIME + 2 * HOUR);
+  store_->createPartition();
+  put({TestRecord(logid_t(3), 10, BASE_TIME + 2 * HOUR + MINUTE)});
+
+  RecordTimeIntervals rtis;
+  rtis.insert(RecordTimeInterval(
+      RecordTimestamp(std::chrono::milliseconds(BASE_TIME + HOUR + MINUTE)),
+      RecordTimestamp(
+          std::chrono::milliseconds(BASE_TIME + HOUR + 2 * MINUTE))));
+  std::unordered_set<logid_t> logs;
+  EXPECT_EQ(0, store_->findLogsInTimeRanges(rtis, &logs));
+  EXPECT_EQ(std::unordered_set<logid_t>({logid_t(2)}), logs);
+
+  // Nothing was written this far back.
+  rtis.clear();
+  rtis.insert(RecordTimeInterval(
+      RecordTimestamp(std::chrono::milliseconds(BASE_TIME - 2 * HOUR)),
+      RecordTimestamp(std::chrono::milliseconds(BASE_TIME - HOUR))));
+  logs.clear();
+  EXPECT_EQ(0, store_->findLogsInTimeRanges(rtis, &logs));
+  EXPECT_TRUE(logs.empty());
+}
+
+// Logs written after a sequence number are found in the WAL replayed on the
+// next open, as long as no writes were lost.
+TEST_F(PartitionedRocksDBStoreTest, FindLogsWrittenSince) {
+  // Prevent flushes on shutdown to simulate a crash.
+  auto no_flush = [](RocksDBLogStoreConfig& cfg) {
+    cfg.options_.avoid_flush_during_shutdown = true;
+  };
+  closeStore();
+  openStore({}, no_flush);
+
+  put({TestRecord(logid_t(1), 10)});
+  const uint64_t seqno = store_->getLatestSequenceNumber();
+  ASSERT_NE(0, seqno);
+  put({TestRecord(logid_t(2), 10)});
+  put({TestRecord(logid_t(3), 10)});
+
+  closeStore();
+  openStore({}, no_flush);
+  std::unordered_set<logid_t> logs;
+  ASSERT_EQ(0, store_->findLogsWrittenSince(seqno, &logs));
+  EXPECT_EQ(std::unordered_set<logid_t>({logid_t(2), logid_t(3)}), logs);
+
+  // The store can't have numbered writes it doesn't have.
+  logs.clear();
+  EXPECT_EQ(-1,
+            store_->findLogsWrittenSince(
+                store_->getLatestSequenceNumber() + 1000, &logs));
+  EXPECT_EQ(E::NOTFOUND, err);
+
+  // Writes that skipped the WAL may have been lost.
+  const uint64_t seqno2 = store_->getLatestSequenceNumber();
+  put({TestRecord(
+      logid_t(4), 10, Durability::MEMORY, TestRecord::StoreType::APPEND)});
+  closeStore();
+  openStore({}, no_flush);
+  logs.clear();
+  EXPECT_EQ(-1, store_->findLogsWrittenSince(seqno2, &logs));
+  EXPECT_EQ(E::NOTFOUND, err);
+}
+
 // Do random stuff from single thread, check consistency. Increasing LSNs.
 TEST_F(PartitionedRocksDBStoreTest, SingleThreadedIncreasingWriteStressTest) {
   std::mt19937 rnd; // Deterministic generator with constant seed.
@@ -2447,6 +2562,34 @@ TEST_F(PartitionedRocksDBStoreTest, AutoTrim) {
   ASSERT_EQ(0, data[0].size());
 }
 
+// Check that the log keeping the oldest partition alive is reported.
+TEST_F(PartitionedRocksDBStoreTest, RetentionPinningLog) {
+  // Log 1 has 1-day retention, log 300 has 7-day retention.
+  put({TestRecord(logid_t(1), 10, BASE_TIME - WEEK),
+       TestRecord(logid_t(300), 10, BASE_TIME - WEEK)});
+  store_->createPartition();
+  EXPECT_EQ(LOGID_INVALID, store_->getRetentionPinningLog());
+
+  // Log 1 is trimmed, but log 300 keeps the first partition from being
+  // dropped.
+  time_ = SystemTimestamp(std::chrono::milliseconds(BASE_TIME + 2 * DAY));
+  store_
+      ->backgroundThreadIteration(
+          PartitionedRocksDBStore::BackgroundThreadType::LO_PRI)
+      .wait();
+  EXPECT_EQ(2, store_->getPartitionList()->size());
+  EXPECT_EQ(logid_t(300), store_->getRetentionPinningLog());
+
+  // Once log 300 is trimmed too, the partition is dropped.
+  time_ = SystemTimestamp(std::chrono::milliseconds(BASE_TIME + 8 * DAY));
+  store_
+      ->backgroundThreadIteration(
+          PartitionedRocksDBStore::BackgroundThreadType::LO_PRI)
+      .wait();
+  EXPECT_EQ(1, store_->getPartitionList()->size());
+  EXPECT_EQ(LOGID_INVALID, store_->getRetentionPinningLog());
+}
+
 // Check that time-based auto-trimming trims properly when partitions are dirty.
 TEST_F(PartitionedRocksDBStoreTest, AutoTrimDirty) {
   logid_t logid(1);
@@ -3313,6 +3456,76 @@ TEST_F(PartitionedRocksDBStoreTest, FindTimeSimple) {
   FINDTIME(logid, BASE_TIME + 90, LSN_INVALID, LSN_MAX, 60, LSN_MAX);
 }
 
+TEST(PartitionedRocksDBStoreFindTimeSamplesTest, Thinning) {
+  using FindTimeSamples = PartitionedRocksDBStore::FindTimeSamples;
+  auto ts = [](int64_t ms) {
+    return RecordTimestamp(std::chrono::milliseconds(BASE_TIME + ms));
+  };
+
+  FindTimeSamples samples;
+  for (lsn_t lsn = 1; lsn <= 100; ++lsn) {
+    samples.add(ts(lsn * 10), lsn, 8);
+  }
+  EXPECT_LE(samples.samples.size(), 8u);
+  for (size_t i = 1; i < samples.samples.size(); ++i) {
+    EXPECT_LT(samples.samples[i - 1].lsn, samples.samples[i].lsn);
+    EXPECT_GE(samples.samples[i].timestamp - samples.samples[i - 1].timestamp,
+              samples.interval);
+  }
+
+  // Out of order records are ignored.
+  size_t n = samples.samples.size();
+  samples.add(ts(100000), 50, 8);
+  samples.add(ts(5), 200, 8);
+  EXPECT_EQ(n, samples.samples.size());
+
+  lsn_t lo = LSN_INVALID;
+  lsn_t hi = LSN_MAX;
+  samples.lookup(ts(0), &lo, &hi);
+  EXPECT_EQ(LSN_INVALID, lo);
+  EXPECT_EQ(1, hi);
+
+  lo = LSN_INVALID;
+  hi = LSN_MAX;
+  samples.lookup(ts(505), &lo, &hi);
+  EXPECT_LT(lo, 51);
+  EXPECT_GE(hi, 51);
+  EXPECT_NE(LSN_INVALID, lo);
+  EXPECT_NE(LSN_MAX, hi);
+
+  samples.add(ts(200000), 1000, 0);
+  EXPECT_TRUE(samples.empty());
+}
+
+// The samples taken at write time narrow the binary search, and the results
+// are the same as without them.
+TEST_F(PartitionedRocksDBStoreTest, FindTimeWithSamples) {
+  logid_t logid(3);
+
+  time_ = SystemTimestamp(std::chrono::milliseconds(BASE_TIME));
+  store_->createPartition();
+  std::vector<TestRecord> records;
+  for (lsn_t lsn = 1; lsn <= 1000; ++lsn) {
+    records.push_back(TestRecord(logid, lsn, BASE_TIME + lsn * 10));
+  }
+  put(records);
+
+  FINDTIME(logid, BASE_TIME + 4205, LSN_INVALID, LSN_MAX, 420, 421);
+  FINDTIME(logid, BASE_TIME + 4210, LSN_INVALID, LSN_MAX, 420, 421);
+  FINDTIME(logid, BASE_TIME + 15, LSN_INVALID, LSN_MAX, 1, 2);
+  FINDTIME(logid, BASE_TIME + 9995, LSN_INVALID, LSN_MAX, 999, 1000);
+  FINDTIME(logid, BASE_TIME + 4205, LSN_INVALID, 400, 400, LSN_MAX);
+  EXPECT_GT(stats_.aggregate().logsdb_findtime_narrowed_by_samples.load(), 0);
+
+  closeStore();
+  ServerConfig::SettingsConfig s;
+  s["rocksdb-find-time-samples-per-partition"] = "0";
+  openStore(s);
+  // After reopening, there are no samples until new records are written.
+  FINDTIME(logid, BASE_TIME + 4205, LSN_INVALID, LSN_MAX, 420, 421);
+  FINDTIME(logid, BASE_TIME + 15, LSN_INVALID, LSN_MAX, 1, 2);
+}
+
 TEST_F(PartitionedRocksDBStoreTest, FindTimeTimedout) {
   logid_t logid(3);
 
@@ -7540,6 +7753,48 @@ TEST_F(PartitionedRocksDBStoreTest, PartialCompactionStallTrigger) {
   EXPECT_EQ(WriteThrottleState::NONE, store_->getWriteThrottleState());
 }
 
+TEST_F(PartitionedRocksDBStoreTest, PartialCompactionsPostponedForReads) {
+  closeStore();
+  ServerConfig::SettingsConfig s;
+  s["rocksdb-partition-partial-compaction-file-num-threshold-old"] = "3";
+  s["rocksdb-partition-partial-compaction-file-num-threshold-recent"] = "3";
+  s["rocksdb-partition-partial-compaction-file-size-threshold"] = "10000000000";
+  s["rocksdb-partition-partial-compaction-largest-file-share"] = "1.0";
+  s["rocksdb-partition-compaction-read-throttle-backoff"] = "500ms";
+  openStore(s);
+
+  // Create 3 l0 files in the first partition, followed by two partitions
+  // that are exempted from partial compactions.
+  for (int r = 0; r < 3; ++r) {
+    put({TestRecord(logid_t(1), r + 1)});
+    store_->flushAllMemtables();
+  }
+  store_->createPartition();
+  store_->createPartition();
+  auto cf = store_->getPartitionList()->get(ID0)->cf_->get();
+  ASSERT_EQ(3, store_->getNumL0Files(cf));
+
+  // Reads are being throttled, compaction waits.
+  processor_->noteReadIoThrottled();
+  store_
+      ->backgroundThreadIteration(
+          PartitionedRocksDBStore::BackgroundThreadType::LO_PRI)
+      .wait();
+  EXPECT_EQ(3, store_->getNumL0Files(cf));
+  EXPECT_EQ(1,
+            stats_.aggregate()
+                .per_shard_stats->get(0)
+                ->compactions_postponed_for_reads);
+
+  /* sleep override */
+  std::this_thread::sleep_for(std::chrono::milliseconds(600));
+  store_
+      ->backgroundThreadIteration(
+          PartitionedRocksDBStore::BackgroundThreadType::LO_PRI)
+      .wait();
+  EXPECT_EQ(1, store_->getNumL0Files(cf));
+}
+
 TEST_F(PartitionedRocksDBStoreTest, MetadataCompactions) {
   std::chrono::milliseconds period =
       RocksDBSettings::defaultTestSettings().metadata_compaction_period;
@@ -7588,6 +7843,41 @@ TEST_F(PartitionedRocksDBStoreTest, MetadataCompactions) {
   EXPECT_EQ(1, store_->getNumL0Files(store_->getMetadataCFHandle()));
 }
 
+// Records written without copyset index must still be visible to readers
+// that are allowed to use it, before and after reopening the store.
+TEST_F(PartitionedRocksDBStoreTest, PartitionWithoutCopySetIndex) {
+  put({TestRecord(logid_t(42), 10)});
+  store_->createPartition();
+  put({TestRecord(logid_t(42), 20)},
+      {},
+      false,
+      DataKeyFormat::DEFAULT,
+      /* write_copyset_index */ false);
+  put({TestRecord(logid_t(42), 30)});
+
+  for (int reopen = 0; reopen < 2; ++reopen) {
+    if (reopen) {
+      closeStore();
+      openStore();
+    }
+    auto partitions = store_->getPartitionList();
+    ASSERT_EQ(2, partitions->size());
+    EXPECT_FALSE(partitions->get(ID0)->no_copyset_index.load());
+    EXPECT_TRUE(partitions->get(ID0 + 1)->no_copyset_index.load());
+
+    LocalLogStore::ReadOptions read_options("PartitionWithoutCopySetIndex");
+    read_options.allow_copyset_index = true;
+    auto it = store_->read(logid_t(42), read_options);
+    it->seek(0);
+    std::vector<lsn_t> lsns;
+    for (; it->state() == IteratorState::AT_RECORD; it->next()) {
+      lsns.push_back(it->getLSN());
+    }
+    EXPECT_EQ(IteratorState::AT_END, it->state());
+    EXPECT_EQ(std::vector<lsn_t>({10, 20, 30}), lsns);
+  }
+}
+
 // TODO(T44746268): replace NDEBUG with folly::kIsDebug
 #ifdef NDEBUG
 #define IF_DEBUG(...)
@@ -9067,6 +9357,57 @@ TEST_F(PartitionedRocksDBStoreTest, DataSize2) {
   ASSERT_LT(result, 2600000);
 }
 
+TEST_F(PartitionedRocksDBStoreTest, DataSizeErrorBound) {
+  closeStore();
+  openStore({{"rocksdb-partition-duration", "15min"}});
+
+  logid_t log(1);
+  auto update_time = [&](uint64_t new_time) {
+    setTime(new_time);
+    store_
+        ->backgroundThreadIteration(
+            PartitionedRocksDBStore::BackgroundThreadType::HI_PRI)
+        .wait();
+  };
+  auto dataSize = [&](uint64_t lo, uint64_t hi, size_t* size, size_t* error) {
+    return store_->dataSize(log,
+                            std::chrono::milliseconds(lo),
+                            std::chrono::milliseconds(hi),
+                            size,
+                            error);
+  };
+
+  put({TestRecord(log, 10, BASE_TIME, std::string(1000, 'x'))});
+  update_time(BASE_TIME + 15 * MINUTE + 1 * SECOND);
+  ASSERT_EQ(2, store_->getPartitionList()->size());
+  put({TestRecord(
+      log, 20, BASE_TIME + 15 * MINUTE + 1 * SECOND, std::string(1000, 'x'))});
+  update_time(BASE_TIME + 30 * MINUTE);
+
+  // Whole first partition and part of the second one.
+  size_t full = 0;
+  size_t size = 0;
+  size_t error = 0;
+  ASSERT_EQ(
+      0, dataSize(0, BASE_TIME + 15 * MINUTE + 1 * SECOND, &full, &error));
+  EXPECT_GT(full, 0);
+
+  // Half of the first partition: the estimate is interpolated, and the
+  // bound must cover both "all of it" and "none of it".
+  ASSERT_EQ(
+      0,
+      dataSize(
+          BASE_TIME + 7 * MINUTE, BASE_TIME + 15 * MINUTE, &size, &error));
+  EXPECT_GT(size, 0);
+  EXPECT_GT(error, 0);
+  EXPECT_LE(size, error);
+  EXPECT_GE(size + error, full);
+
+  // No partition boundaries inside the range, nothing to interpolate.
+  ASSERT_EQ(0, dataSize(0, BASE_TIME + 30 * MINUTE, &size, &error));
+  EXPECT_EQ(0, error);
+}
+
 TEST_F(PartitionedRocksDBStoreTest, DataSizeOnRestart) {
   closeStore();
   openStore({{"rocksdb-partition-duration", "15min"},
@@ -9213,6 +9554,68 @@ TEST_F(PartitionedRocksDBStoreTest, CorruptionAndNewPartition) {
   ASSERT_EQ(de.max_lsn, lsn_t(17));
 }
 
+// With rocksdb-partition-directory-snapshot, the directory written on clean
+// shutdown is loaded on the next open, unless rocksdb was written since.
+TEST_F(PartitionedRocksDBStoreTest, DirectorySnapshot) {
+  closeStore();
+  ServerConfig::SettingsConfig s;
+  s["rocksdb-partition-directory-snapshot"] = "true";
+  openStore(s);
+
+  auto get_directory = [&] {
+    std::vector<std::pair<logid_t, DirectoryEntry>> dir;
+    store_->getLogsDBDirectories(/*partitions=*/{}, /*logs=*/{}, dir);
+    std::vector<std::tuple<logid_t, partition_id_t, lsn_t, lsn_t, size_t>> res;
+    for (const auto& p : dir) {
+      res.emplace_back(p.first,
+                       p.second.id,
+                       p.second.first_lsn,
+                       p.second.max_lsn,
+                       p.second.approximate_size_bytes);
+    }
+    std::sort(res.begin(), res.end());
+    return res;
+  };
+  auto snapshot_loaded = [&] {
+    return stats_.aggregate()
+        .per_shard_stats->get(0)
+        ->logsdb_directory_snapshot_loaded;
+  };
+
+  put({TestRecord(logid_t(1), 10), TestRecord(logid_t(2), 5)});
+  store_->createPartition();
+  put({TestRecord(logid_t(1), 20), TestRecord(logid_t(3), 7)});
+  auto expected = get_directory();
+  EXPECT_EQ(4, expected.size());
+
+  closeStore();
+  const std::string snapshot_path = path_ + "/LOGSDB_DIRECTORY_SNAPSHOT";
+  std::string old_snapshot;
+  ASSERT_TRUE(folly::readFile(snapshot_path.c_str(), old_snapshot));
+  openStore(s);
+  EXPECT_EQ(1, snapshot_loaded());
+  EXPECT_EQ(expected, get_directory());
+  put({TestRecord(logid_t(3), 8)});
+  expected = get_directory();
+
+  // Put back the snapshot from before the last write. It must be rejected.
+  closeStore();
+  ASSERT_TRUE(folly::writeFile(old_snapshot, snapshot_path.c_str()));
+  openStore(s);
+  EXPECT_EQ(0, snapshot_loaded());
+  EXPECT_EQ(expected, get_directory());
+
+  // With the setting off the snapshot is neither used nor written.
+  closeStore();
+  openStore();
+  EXPECT_EQ(0, snapshot_loaded());
+  EXPECT_EQ(expected, get_directory());
+  closeStore();
+  std::string unused;
+  EXPECT_FALSE(folly::readFile(snapshot_path.c_str(), unused));
+  EXPECT_EQ(5, numRecords(readAndCheck()));
+}
+
 // unstall low priority writes during shutdown.
 TEST_F(PartitionedRocksDBStoreTest, StallLowPriWritesShutdownTest) {
   store_->suggested_throttle_state_ = WriteThrottleState::STALL_LOW_PRI_WRITE;
@@ -10523,3 +10926,70 @@ TEST_F(PartitionedRocksDBStoreTest,
   EXPECT_EQ(IteratorState::AT_END, it->state());
   EXPECT_EQ(0, stats.seen_logsdb_partitions);
 }
+
+namespace {
+// Pretends to move all the files it's given to remote storage.
+class OffloadingCustomiser : public RocksDBCustomiser {
+ public:
+  uint64_t offloadColdFiles(shard_index_t /*shard_idx*/,
+                            const std::string& column_family,
+                            const std::vector<std::string>& files) override {
+    calls.emplace_back(column_family, files);
+    return files.size() * 1000;
+  }
+
+  std::vector<std::pair<std::string, std::vector<std::string>>> calls;
+};
+} // namespace
+
+TEST_F(PartitionedRocksDBStoreTest, PartitionTiers) {
+  using Tier = PartitionedRocksDBStore::PartitionTier;
+  const uint64_t hour = 3600 * 1000;
+  const logid_t logid(1);
+
+  OffloadingCustomiser customiser;
+  closeStore();
+  customiser_ = &customiser;
+  ServerConfig::SettingsConfig s;
+  s["rocksdb-partition-hot-age"] = "1h";
+  s["rocksdb-partition-cold-age"] = "1d";
+  openStore(s);
+
+  put({TestRecord(logid, 10, BASE_TIME)});
+  setTime(BASE_TIME + hour);
+  store_->createPartition();
+  put({TestRecord(logid, 20, BASE_TIME + hour)});
+  setTime(BASE_TIME + 2 * hour);
+  store_->createPartition();
+  put({TestRecord(logid, 30, BASE_TIME + 2 * hour)});
+
+  auto partitions = store_->getPartitionList();
+  auto p0 = partitions->get(ID0);
+  auto p1 = partitions->get(ID0 + 1);
+  auto p2 = partitions->get(ID0 + 2);
+  EXPECT_TRUE(store_->flushMemtable(p0->cf_));
+
+  setTime(BASE_TIME + 2 * hour + hour / 2);
+  EXPECT_EQ(Tier::WARM, store_->getPartitionTier(p0));
+  EXPECT_EQ(Tier::HOT, store_->getPartitionTier(p1));
+  EXPECT_EQ(Tier::HOT, store_->getPartitionTier(p2));
+  store_->offloadColdPartitions();
+  EXPECT_TRUE(customiser.calls.empty());
+
+  // Only partition ID0 is older than a day.
+  setTime(BASE_TIME + 25 * hour + hour / 2);
+  store_->offloadColdPartitions();
+  ASSERT_EQ(1, customiser.calls.size());
+  EXPECT_EQ(toString(ID0), customiser.calls[0].first);
+  ASSERT_FALSE(customiser.calls[0].second.empty());
+  EXPECT_EQ(customiser.calls[0].second.size() * 1000, p0->offloaded_bytes);
+  EXPECT_EQ(Tier::COLD, store_->getPartitionTier(p0));
+  EXPECT_EQ(Tier::WARM, store_->getPartitionTier(p1));
+
+  // The files didn't change, so they aren't offloaded again.
+  store_->offloadColdPartitions();
+  EXPECT_EQ(1, customiser.calls.size());
+
+  closeStore();
+  customiser_ = RocksDBCustomiser::defaultInstance();
+}
@@ -9,6 +9,7 @@
 
 #include <memory>
 
+#include <boost/filesystem.hpp>
 #include <folly/Memory.h>
 #include <folly/ScopeGuard.h>
 #include <gtest/gtest.h>
@@ -238,6 +239,49 @@ TEST_F(RocksDBLocalLogStoreTest, WriteTest) {
   EXPECT_EQ(1, keys_seen);
 }
 
+/**
+ * An in-memory store reads back what was written, including across reopening,
+ * without creating any files on disk.
+ */
+TEST_F(RocksDBLocalLogStoreTest, InMemory) {
+  TemporaryInMemoryRocksDBStore store;
+
+  PutWriteOp op{logid_t(123),
+                511,
+                getHeader(),
+                Slice("abc1", 4),
+                /*coordinator*/ folly::none,
+                folly::none,
+                Slice(nullptr, 0),
+                {},
+                Durability::ASYNC_WRITE,
+                false};
+  ASSERT_EQ(0, store.writeMulti(std::vector<const WriteOp*>{&op}));
+  ClusterMarkerMetadata marker{"hello"};
+  ASSERT_EQ(0, store.writeStoreMetadata(marker, LocalLogStore::WriteOptions()));
+
+  for (int i = 0; i < 2; ++i) {
+    if (i) {
+      store.close();
+      store.open();
+    }
+
+    auto it = store.read(logid_t(123), LocalLogStore::ReadOptions("InMemory"));
+    it->seek(0);
+    ASSERT_EQ(IteratorState::AT_RECORD, it->state());
+    EXPECT_EQ(511, it->getLSN());
+    EXPECT_EQ(getHeader().size + strlen("abc1"), it->getRecord().size);
+    it->next();
+    EXPECT_EQ(IteratorState::AT_END, it->state());
+
+    ClusterMarkerMetadata marker_read;
+    ASSERT_EQ(0, store.readStoreMetadata(&marker_read));
+    EXPECT_EQ(marker.marker_, marker_read.marker_);
+  }
+
+  EXPECT_TRUE(boost::filesystem::is_empty(store.getPath()));
+}
+
 static void
 verifyRecord(const char* expected,
              const std::unique_ptr<LocalLogStore::ReadIterator>& it) {
@@ -677,6 +721,158 @@ STORE_TEST(RocksDBLocalLogStoreTest, WriteInvalidMetadata, store) {
   }
 }
 
+// With rocksdb-log-metadata-write-batch-size, log metadata writes are
+// buffered and coalesced, but reads and durability are unaffected.
+TEST_F(RocksDBLocalLogStoreTest, BufferedLogMetadataWrites) {
+  RocksDBSettings settings = RocksDBSettings::defaultTestSettings();
+  settings.log_metadata_write_batch_size = 3;
+  RocksDBLogStoreConfig config(
+      UpdateableSettings<RocksDBSettings>(settings),
+      UpdateableSettings<RebuildingSettings>(),
+      &env_,
+      nullptr,
+      &stats_);
+  config.createMergeOperator(0);
+  TemporaryLogStore temp_store([&](std::string path) {
+    return std::make_unique<RocksDBLocalLogStore>(
+        0,
+        1,
+        path,
+        config,
+        RocksDBCustomiser::defaultInstance(),
+        &stats_,
+        /* io_tracing */ nullptr);
+  });
+  LocalLogStore& store = temp_store;
+  auto flushed = [&] {
+    return stats_.aggregate().log_metadata_batches_flushed;
+  };
+
+  TrimMetadata tm1{100};
+  TrimMetadata tm2{200};
+  TrimMetadata tm3{150};
+  ASSERT_EQ(0, store.writeLogMetadata(logid_t(1), tm1));
+  ASSERT_EQ(0, store.updateLogMetadata(logid_t(1), tm2));
+  // Compared against the buffered value.
+  ASSERT_EQ(-1, store.updateLogMetadata(logid_t(1), tm3));
+  ASSERT_EQ(E::UPTODATE, err);
+  EXPECT_EQ(200, tm3.trim_point_);
+  EXPECT_EQ(2, stats_.aggregate().log_metadata_writes_buffered);
+  EXPECT_EQ(1, stats_.aggregate().log_metadata_writes_coalesced);
+
+  SealMetadata sm{Seal(epoch_t(7), NodeID(1, 1))};
+  ASSERT_EQ(0, store.writeLogMetadata(logid_t(2), sm));
+  EXPECT_EQ(0, flushed());
+  // Third log with pending metadata fills the batch.
+  ASSERT_EQ(0, store.writeLogMetadata(logid_t(3), tm1));
+  EXPECT_EQ(1, flushed());
+
+  ASSERT_EQ(0, store.writeLogMetadata(logid_t(4), tm1));
+  EXPECT_EQ(1, flushed());
+  ASSERT_EQ(0, store.sync(Durability::ASYNC_WRITE));
+  EXPECT_EQ(2, flushed());
+
+  // Written out when the store is closed.
+  ASSERT_EQ(0, store.writeLogMetadata(logid_t(5), tm2));
+  temp_store.close();
+  temp_store.open();
+
+  TrimMetadata trim;
+  ASSERT_EQ(0, store.readLogMetadata(logid_t(1), &trim));
+  EXPECT_EQ(200, trim.trim_point_);
+  SealMetadata seal;
+  ASSERT_EQ(0, store.readLogMetadata(logid_t(2), &seal));
+  EXPECT_EQ(epoch_t(7), seal.seal_.epoch);
+  for (logid_t log : {logid_t(3), logid_t(4)}) {
+    ASSERT_EQ(0, store.readLogMetadata(log, &trim));
+    EXPECT_EQ(100, trim.trim_point_);
+  }
+  ASSERT_EQ(0, store.readLogMetadata(logid_t(5), &trim));
+  EXPECT_EQ(200, trim.trim_point_);
+}
+
+// With rocksdb-iterator-pool-max-pinned-bytes, tailing data iterators are
+// reused across logs and read the same records as new ones.
+TEST_F(RocksDBLocalLogStoreTest, IteratorPool) {
+  RocksDBSettings settings = RocksDBSettings::defaultTestSettings();
+  settings.iterator_pool_max_pinned_bytes = 1024 * 1024 * 1024;
+  RocksDBLogStoreConfig config(
+      UpdateableSettings<RocksDBSettings>(settings),
+      UpdateableSettings<RebuildingSettings>(),
+      &env_,
+      nullptr,
+      &stats_);
+  config.createMergeOperator(0);
+  TemporaryLogStore temp_store([&](std::string path) {
+    return std::make_unique<RocksDBLocalLogStore>(
+        0,
+        1,
+        path,
+        config,
+        RocksDBCustomiser::defaultInstance(),
+        &stats_,
+        /* io_tracing */ nullptr);
+  });
+  LocalLogStore& store = temp_store;
+
+  std::vector<PutWriteOp> put_ops;
+  for (auto record : {std::make_pair(logid_t(1), lsn_t(1)),
+                      std::make_pair(logid_t(1), lsn_t(2)),
+                      std::make_pair(logid_t(2), lsn_t(1)),
+                      std::make_pair(logid_t(3), lsn_t(1))}) {
+    put_ops.push_back(PutWriteOp{record.first,
+                                 record.second,
+                                 getHeader(),
+                                 Slice("abc", 3),
+                                 folly::none,
+                                 folly::none,
+                                 Slice(nullptr, 0),
+                                 {},
+                                 Durability::ASYNC_WRITE,
+                                 false});
+  }
+  std::vector<const WriteOp*> ops;
+  for (const auto& op : put_ops) {
+    ops.push_back(&op);
+  }
+  ASSERT_EQ(0, store.writeMulti(ops));
+
+  LocalLogStore::ReadOptions options("IteratorPool");
+  options.tailing = true;
+  auto count_records = [&](logid_t log) {
+    auto it = store.read(log, options);
+    size_t nread = 0;
+    for (it->seek(0); it->state() == IteratorState::AT_RECORD; it->next()) {
+      ++nread;
+    }
+    EXPECT_EQ(IteratorState::AT_END, it->state());
+    return nread;
+  };
+
+  auto created = [&] {
+    return stats_.aggregate().read_streams_num_data_iterators_created;
+  };
+  auto reused = [&] {
+    return stats_.aggregate().read_streams_num_data_iterators_reused;
+  };
+
+  EXPECT_EQ(2, count_records(logid_t(1)));
+  EXPECT_EQ(1, created());
+
+  // The iterator of log 1 is reused, its upper bound now being log 2's end.
+  EXPECT_EQ(1, count_records(logid_t(2)));
+  EXPECT_EQ(1, created());
+  EXPECT_GE(reused(), 1);
+
+  // Non-tailing iterators are never reused.
+  const int64_t reused_before = reused();
+  options.tailing = false;
+  EXPECT_EQ(1, count_records(logid_t(3)));
+  EXPECT_EQ(1, count_records(logid_t(3)));
+  EXPECT_GE(created(), 3);
+  EXPECT_EQ(reused_before, reused());
+}
+
 STORE_TEST(RocksDBLocalLogStoreTest, Seek, store) {
   Slice data("foo", 3);
   lsn_t lsns[] = {
@@ -254,6 +254,38 @@ TemporaryRocksDBStore::TemporaryRocksDBStore(bool read_find_time_index)
             /* io_tracing */ nullptr);
       }) {}
 
+TemporaryInMemoryRocksDBStore::TemporaryInMemoryRocksDBStore()
+    : TemporaryLogStore(
+          [this](const std::string& path) {
+            RocksDBSettings raw_settings =
+                RocksDBSettings::defaultTestSettings();
+            raw_settings.use_copyset_index = true;
+
+            UpdateableSettings<RocksDBSettings> settings(raw_settings);
+            UpdateableSettings<RebuildingSettings> rebuilding_settings;
+
+            RocksDBLogStoreConfig rocksdb_config(
+                settings, rebuilding_settings, nullptr, nullptr, nullptr);
+            rocksdb_config.options_.env = env_.get();
+            rocksdb_config.createMergeOperator(0);
+
+            return std::make_unique<RocksDBLocalLogStore>(
+                0,
+                1,
+                path,
+                std::move(rocksdb_config),
+                RocksDBCustomiser::defaultInstance(),
+                /* stats */ nullptr,
+                /* io_tracing */ nullptr);
+          },
+          false),
+      env_(rocksdb::NewMemEnv(rocksdb::Env::Default())) {
+  open();
+}
+TemporaryInMemoryRocksDBStore::~TemporaryInMemoryRocksDBStore() {
+  close();
+}
+
 class TemporaryPartitionedStoreImpl : public PartitionedRocksDBStore {
  public:
   explicit TemporaryPartitionedStoreImpl(const std::string& path,
@@ -9,6 +9,8 @@
 
 #include <memory>
 
+#include <rocksdb/env.h>
+
 #include "logdevice/common/Metadata.h"
 #include "logdevice/common/test/TestUtil.h"
 #include "logdevice/server/locallogstore/LocalLogStore.h"
@@ -165,6 +167,16 @@ struct TemporaryRocksDBStore : public TemporaryLogStore {
   explicit TemporaryRocksDBStore(bool read_find_time_index = false);
 };
 
+// A RocksDBLocalLogStore keeping its files in memory, like the shards in
+// rocksdb-in-memory-shards. Nothing is written to the temporary directory.
+struct TemporaryInMemoryRocksDBStore : public TemporaryLogStore {
+  TemporaryInMemoryRocksDBStore();
+  ~TemporaryInMemoryRocksDBStore() override;
+
+ private:
+  std::unique_ptr<rocksdb::Env> env_;
+};
+
 // A temporary logsdb store with fake clock.
 // The clock starts at BASE_TIME and only moves when you call setTime().
 // This allows controlling which partition each record goes to.
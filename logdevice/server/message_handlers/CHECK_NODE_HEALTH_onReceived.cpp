@@ -10,6 +10,7 @@
 #include "logdevice/common/Sender.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/common/protocol/CHECK_NODE_HEALTH_REPLY_Message.h"
+#include "logdevice/server/HealthMonitor.h"
 #include "logdevice/server/ServerProcessor.h"
 #include "logdevice/server/ServerWorker.h"
 #include "logdevice/server/storage_tasks/PerWorkerStorageTaskQueue.h"
@@ -121,6 +122,14 @@ CHECK_NODE_HEALTH_onReceived(CHECK_NODE_HEALTH_Message* msg,
     }
   }
 
+  HealthMonitor* health_monitor = worker->processor_->getHealthMonitor();
+  if (worker->settings().health_monitor_shed_load && health_monitor &&
+      health_monitor->getNodeStatus() != NodeHealthStatus::HEALTHY) {
+    WORKER_STAT_INCR(health_monitor_check_node_health_shed);
+    sendReply(E::OVERLOADED, header, from);
+    return Message::Disposition::NORMAL;
+  }
+
   if (worker->getStorageTaskQueueForShard(header.shard_idx)->isOverloaded() ||
       sharded_pool->getByIndex(header.shard_idx)
               .getLocalLogStore()
@@ -22,11 +22,14 @@ namespace facebook { namespace logdevice {
 static void send_reply(const Address& to,
                        const DATA_SIZE_Header& request,
                        Status status,
-                       size_t size) {
-  ld_debug("Sending DATA_SIZE_REPLY: client_rqid=%lu, status=%s, size=%lu",
+                       size_t size,
+                       size_t error_bound = 0) {
+  ld_debug("Sending DATA_SIZE_REPLY: client_rqid=%lu, status=%s, size=%lu, "
+           "error_bound=%lu",
            request.client_rqid.val_,
            error_name(status),
-           size);
+           size,
+           error_bound);
 
   if (status == E::OK) {
     WORKER_LOG_STAT_INCR(request.log_id, data_size_reply);
@@ -35,7 +38,7 @@ static void send_reply(const Address& to,
   }
 
   DATA_SIZE_REPLY_Header header = {
-      request.client_rqid, status, size, request.shard};
+      request.client_rqid, status, size, request.shard, error_bound};
   auto msg = std::make_unique<DATA_SIZE_REPLY_Message>(header);
   Worker::onThisThread()->sender().sendMessage(std::move(msg), to);
 }
@@ -115,12 +118,14 @@ Message::Disposition DATA_SIZE_onReceived(DATA_SIZE_Message* msg,
   }
 
   size_t size = 0;
+  size_t error_bound = 0;
   int rv = partitioned_store->dataSize(
       header.log_id,
       std::chrono::milliseconds(header.lo_timestamp_ms),
       std::chrono::milliseconds(header.hi_timestamp_ms),
-      &size);
-  send_reply(from, header, rv == 0 ? E::OK : E::FAILED, size);
+      &size,
+      &error_bound);
+  send_reply(from, header, rv == 0 ? E::OK : E::FAILED, size, error_bound);
   return Message::Disposition::NORMAL;
 }
 
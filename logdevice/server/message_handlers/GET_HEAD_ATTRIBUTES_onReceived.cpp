@@ -44,6 +44,20 @@ void send_reply(const Address& to,
   Worker::onThisThread()->sender().sendMessage(std::move(msg), to);
 }
 
+// The timestamp of the first record after the trim point only changes when
+// the trim point moves, so it's cached in LogStorageState. A log with no
+// records after the trim point isn't cached: records can show up at any time.
+void cacheHeadTimestamp(const GET_HEAD_ATTRIBUTES_Header& request,
+                        lsn_t trim_point,
+                        std::chrono::milliseconds timestamp) {
+  LogStorageState* log_state =
+      ServerWorker::onThisThread()->processor_->getLogStorageStateMap().find(
+          request.log_id, request.shard);
+  if (log_state != nullptr) {
+    log_state->cacheHeadTimestamp(trim_point, timestamp);
+  }
+}
+
 class GetHeadAttributesStorageTask : public StorageTask {
  public:
   // Trim point is going to be available if if it was successfully fetched
@@ -86,6 +100,10 @@ class GetHeadAttributesStorageTask : public StorageTask {
   }
 
   void onDone() override {
+    if (status_ == E::OK &&
+        trim_point_timestamp_ != std::chrono::milliseconds::max()) {
+      cacheHeadTimestamp(header_, trim_point_, trim_point_timestamp_);
+    }
     send_reply(
         reply_to_, header_, status_, {trim_point_, trim_point_timestamp_});
   }
@@ -166,6 +184,11 @@ GET_HEAD_ATTRIBUTES_onReceived(GET_HEAD_ATTRIBUTES_Message* msg,
   }
 
   lsn_t trim_point = log_state->getTrimPoint();
+  auto cached_timestamp = log_state->getCachedHeadTimestamp(trim_point);
+  if (cached_timestamp.has_value()) {
+    send_reply(from, header, E::OK, {trim_point, cached_timestamp.value()});
+    return Message::Disposition::NORMAL;
+  }
   if (Worker::settings().allow_reads_on_workers) {
     // Try to read approximate timestamp of trim point without reading from
     // disk as well.
@@ -175,6 +198,7 @@ GET_HEAD_ATTRIBUTES_onReceived(GET_HEAD_ATTRIBUTES_Message* msg,
                                            false, // not allow_blocking_io
                                            &timestamp);
     if (rv == 0) {
+      log_state->cacheHeadTimestamp(trim_point, timestamp);
       send_reply(from, header, E::OK, {trim_point, timestamp});
       return Message::Disposition::NORMAL;
     }
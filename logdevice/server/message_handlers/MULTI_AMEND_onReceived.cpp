@@ -0,0 +1,45 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/message_handlers/MULTI_AMEND_onReceived.h"
+
+#include "logdevice/common/stats/Stats.h"
+#include "logdevice/server/STORE_onSent.h"
+#include "logdevice/server/StoreStateMachine.h"
+
+namespace facebook { namespace logdevice {
+
+Message::Disposition MULTI_AMEND_onReceived(MULTI_AMEND_Message* msg,
+                                            const Address& from) {
+  WORKER_STAT_INCR(multi_amend_messages_received);
+
+  // Each entry goes through the same path as an amend received in its own
+  // STORE message. The writes they issue are coalesced into one write batch
+  // per shard by the storage threads.
+  for (auto& store : msg->getStores()) {
+    STORE_Message* m = store.release();
+    Message::Disposition disp = StoreStateMachine::onReceived(m, from);
+    if (disp != Message::Disposition::KEEP) {
+      delete m;
+    }
+    if (disp == Message::Disposition::ERROR) {
+      return Message::Disposition::ERROR;
+    }
+  }
+  return Message::Disposition::NORMAL;
+}
+
+void MULTI_AMEND_onSent(const MULTI_AMEND_Message& msg,
+                        Status st,
+                        const Address& to,
+                        const SteadyTimestamp enqueue_time) {
+  for (const auto& store : msg.getStores()) {
+    STORE_onSent(*store, st, to, enqueue_time);
+  }
+}
+
+}} // namespace facebook::logdevice
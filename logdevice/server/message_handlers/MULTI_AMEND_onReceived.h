@@ -0,0 +1,26 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include "logdevice/common/protocol/MULTI_AMEND_Message.h"
+#include "logdevice/common/protocol/Message.h"
+
+namespace facebook { namespace logdevice {
+
+struct Address;
+
+Message::Disposition MULTI_AMEND_onReceived(MULTI_AMEND_Message* msg,
+                                            const Address& from);
+
+// Reports the outcome of sending to each amend in the message, like
+// STORE_onSent() does for a single one.
+void MULTI_AMEND_onSent(const MULTI_AMEND_Message& msg,
+                        Status st,
+                        const Address& to,
+                        const SteadyTimestamp enqueue_time);
+}} // namespace facebook::logdevice
@@ -0,0 +1,55 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/message_handlers/MULTI_SEAL_onReceived.h"
+
+#include <map>
+
+#include "logdevice/common/stats/Stats.h"
+#include "logdevice/server/ServerWorker.h"
+#include "logdevice/server/message_handlers/SEAL_onReceived.h"
+#include "logdevice/server/storage/SealBatchStorageTask.h"
+#include "logdevice/server/storage/SealStorageTask.h"
+#include "logdevice/server/storage_tasks/PerWorkerStorageTaskQueue.h"
+
+namespace facebook { namespace logdevice {
+
+Message::Disposition MULTI_SEAL_onReceived(MULTI_SEAL_Message* msg,
+                                           const Address& from) {
+  // Like for SEAL, a malformed entry means the sender is broken.
+  for (const SEAL_Header& header : msg->getSeals()) {
+    if (!SEAL_checkHeader(header, from)) {
+      return Message::Disposition::ERROR;
+    }
+  }
+
+  WORKER_STAT_INCR(multi_seal_messages_received);
+
+  std::map<shard_index_t, std::vector<std::unique_ptr<SealStorageTask>>>
+      tasks_by_shard;
+  for (const SEAL_Header& header : msg->getSeals()) {
+    auto task = SEAL_handleHeader(header, from);
+    if (task) {
+      tasks_by_shard[header.shard].push_back(std::move(task));
+    }
+  }
+
+  ServerWorker* worker = ServerWorker::onThisThread();
+  for (auto& kv : tasks_by_shard) {
+    auto queue = worker->getStorageTaskQueueForShard(kv.first);
+    if (kv.second.size() == 1) {
+      queue->putTask(std::move(kv.second.front()));
+      continue;
+    }
+    WORKER_STAT_INCR(seal_batch_storage_tasks);
+    queue->putTask(
+        std::make_unique<SealBatchStorageTask>(std::move(kv.second)));
+  }
+  return Message::Disposition::NORMAL;
+}
+
+}} // namespace facebook::logdevice
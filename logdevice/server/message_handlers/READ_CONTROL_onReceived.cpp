@@ -0,0 +1,56 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/message_handlers/READ_CONTROL_onReceived.h"
+
+#include "logdevice/common/stats/Stats.h"
+#include "logdevice/server/ServerProcessor.h"
+#include "logdevice/server/ServerWorker.h"
+#include "logdevice/server/message_handlers/STOP_onReceived.h"
+#include "logdevice/server/read_path/AllServerReadStreams.h"
+
+namespace facebook { namespace logdevice {
+
+Message::Disposition READ_CONTROL_onReceived(READ_CONTROL_Message* msg,
+                                             const Address& from) {
+  if (!from.isClientAddress()) {
+    ld_error("got READ_CONTROL message from non-client %s",
+             Sender::describeConnection(from).c_str());
+    err = E::PROTO;
+    return Message::Disposition::ERROR;
+  }
+
+  ServerWorker* w = ServerWorker::onThisThread();
+
+  if (!w->isAcceptingWork()) {
+    ld_debug("Ignoring READ_CONTROL message: not accepting more work");
+    return Message::Disposition::NORMAL;
+  }
+
+  if (!msg->getWindows().empty() && !w->processor_->runningOnStorageNode()) {
+    // Same as for WINDOW messages, this should never happen.
+    ld_error("got READ_CONTROL message with window updates from client %s "
+             "but not a storage node",
+             Sender::describeConnection(from).c_str());
+    err = E::PROTO;
+    return Message::Disposition::ERROR;
+  }
+
+  WORKER_STAT_INCR(read_control_messages_received);
+
+  // Window updates go first, a client never updates the window of a read
+  // stream after stopping it.
+  for (const WINDOW_Header& header : msg->getWindows()) {
+    AllServerReadStreams::onWindowUpdate(header, from);
+  }
+  for (const STOP_Header& header : msg->getStops()) {
+    STOP_handleHeader(header, from);
+  }
+  return Message::Disposition::NORMAL;
+}
+
+}} // namespace facebook::logdevice
@@ -20,10 +20,7 @@
 
 namespace facebook { namespace logdevice {
 
-Message::Disposition SEAL_onReceived(SEAL_Message* msg, const Address& from) {
-  const SEAL_Header& header = msg->getHeader();
-  ServerWorker* worker = ServerWorker::onThisThread();
-
+bool SEAL_checkHeader(const SEAL_Header& header, const Address& from) {
   if (header.log_id == LOGID_INVALID || !epoch_valid(header.seal_epoch)) {
     RATELIMIT_CRITICAL(std::chrono::seconds(10),
                        10,
@@ -33,7 +30,7 @@ Message::Disposition SEAL_onReceived(SEAL_Message* msg, const Address& from) {
                        header.log_id.val_,
                        header.seal_epoch.val_);
     err = E::BADMSG;
-    return Message::Disposition::ERROR;
+    return false;
   }
 
   if (!header.sealed_by.isNodeID()) {
@@ -45,14 +42,20 @@ Message::Disposition SEAL_onReceived(SEAL_Message* msg, const Address& from) {
                     header.log_id.val_);
 
     err = E::PROTO;
-    return Message::Disposition::ERROR;
+    return false;
   }
+  return true;
+}
+
+std::unique_ptr<SealStorageTask> SEAL_handleHeader(const SEAL_Header& header,
+                                                   const Address& from) {
+  ServerWorker* worker = ServerWorker::onThisThread();
 
   if (!worker->isAcceptingWork()) {
     ld_debug("Ignoring SEAL message: not accepting more work");
     SEALED_Message::createAndSend(
         from, header.log_id, header.shard, header.seal_epoch, E::SHUTDOWN);
-    return Message::Disposition::NORMAL;
+    return nullptr;
   }
 
   ServerProcessor* processor = worker->processor_;
@@ -62,7 +65,7 @@ Message::Disposition SEAL_onReceived(SEAL_Message* msg, const Address& from) {
 
     SEALED_Message::createAndSend(
         from, header.log_id, header.shard, header.seal_epoch, E::NOTSTORAGE);
-    return Message::Disposition::NORMAL;
+    return nullptr;
   }
 
   const shard_size_t n_shards = worker->getNodesConfiguration()->getNumShards(
@@ -78,7 +81,7 @@ Message::Disposition SEAL_onReceived(SEAL_Message* msg, const Address& from) {
                     Sender::describeConnection(from).c_str(),
                     shard_idx,
                     n_shards);
-    return Message::Disposition::NORMAL;
+    return nullptr;
   }
 
   if (processor->isDataMissingFromShard(shard_idx)) {
@@ -87,7 +90,7 @@ Message::Disposition SEAL_onReceived(SEAL_Message* msg, const Address& from) {
 
     SEALED_Message::createAndSend(
         from, header.log_id, header.shard, header.seal_epoch, E::REBUILDING);
-    return Message::Disposition::NORMAL;
+    return nullptr;
   }
 
   Seal seal;
@@ -100,7 +103,7 @@ Message::Disposition SEAL_onReceived(SEAL_Message* msg, const Address& from) {
     // LogStorageStateMap is at capacity
     SEALED_Message::createAndSend(
         from, header.log_id, header.shard, header.seal_epoch, E::FAILED);
-    return Message::Disposition::NORMAL;
+    return nullptr;
   }
 
   folly::Optional<Seal> current_seal =
@@ -118,7 +121,7 @@ Message::Disposition SEAL_onReceived(SEAL_Message* msg, const Address& from) {
                                   LSN_INVALID,
                                   /*lng_list*/ std::vector<lsn_t>(),
                                   current_seal.value());
-    return Message::Disposition::NORMAL;
+    return nullptr;
   }
 
   bool tail_optimized = false;
@@ -133,10 +136,22 @@ Message::Disposition SEAL_onReceived(SEAL_Message* msg, const Address& from) {
     tail_optimized = log->attrs().tailOptimized().value();
   }
 
-  auto task = std::make_unique<SealStorageTask>(
+  return std::make_unique<SealStorageTask>(
       header.log_id, header.last_clean_epoch, seal, from, tail_optimized);
-  worker->getStorageTaskQueueForShard(shard_idx)->putTask(std::move(task));
+}
+
+Message::Disposition SEAL_onReceived(SEAL_Message* msg, const Address& from) {
+  const SEAL_Header& header = msg->getHeader();
+  if (!SEAL_checkHeader(header, from)) {
+    return Message::Disposition::ERROR;
+  }
 
+  auto task = SEAL_handleHeader(header, from);
+  if (task) {
+    ServerWorker::onThisThread()
+        ->getStorageTaskQueueForShard(header.shard)
+        ->putTask(std::move(task));
+  }
   return Message::Disposition::NORMAL;
 }
 }} // namespace facebook::logdevice
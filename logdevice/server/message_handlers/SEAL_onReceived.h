@@ -7,12 +7,30 @@
  */
 #pragma once
 
+#include <memory>
+
 #include "logdevice/common/protocol/Message.h"
 #include "logdevice/common/protocol/SEAL_Message.h"
 
 namespace facebook { namespace logdevice {
 
 struct Address;
+class SealStorageTask;
 
 Message::Disposition SEAL_onReceived(SEAL_Message* msg, const Address& from);
+
+/**
+ * The following handle one SEAL, carried either by a SEAL message or in a
+ * MULTI_SEAL message.
+ */
+
+// @return  false with err set if the header is malformed, in which case the
+//          connection should be closed
+bool SEAL_checkHeader(const SEAL_Header& header, const Address& from);
+
+// Replies right away if the log can't or needn't be sealed on the shard.
+// @return  the storage task that seals the log on shard `header.shard', or
+//          nullptr if there's nothing more to do
+std::unique_ptr<SealStorageTask> SEAL_handleHeader(const SEAL_Header& header,
+                                                   const Address& from);
 }} // namespace facebook::logdevice
@@ -260,7 +260,7 @@ Message::Disposition START_onReceived(START_Message* msg,
 
     // for recovery reads for digest, attempt a cache lookup
     WORKER_STAT_INCR(epoch_recovery_digest_received);
-    RecordCache* cache = log_state->record_cache_.get();
+    RecordCache* cache = log_state->getRecordCache();
     if (cache) {
       auto result = cache->getEpochRecordCache(lsn_to_epoch(header.start_lsn));
       switch (result.first) {
@@ -430,6 +430,7 @@ Message::Disposition START_onReceived(START_Message* msg,
       stream->disableSingleCopyDelivery();
     }
     stream->needs_started_message_ = true;
+    stream->reached_tail_ = false;
   }
 
   stream->setWindowHigh(header.window_high);
@@ -445,6 +446,13 @@ Message::Disposition START_onReceived(START_Message* msg,
       (header.flags & START_Header::INCLUDE_BYTE_OFFSET) &&
       Worker::settings().byte_offsets;
   stream->is_internal_ = w->sender().getNodeID(from).isNodeID();
+  if (header.flags & START_Header::MONITORING_TIER_HIGH) {
+    stream->monitoring_tier_ = MonitoringTier::HIGH_PRI;
+  } else if (header.flags & START_Header::MONITORING_TIER_LOW) {
+    stream->monitoring_tier_ = MonitoringTier::LOW_PRI;
+  } else {
+    stream->monitoring_tier_ = MonitoringTier::MEDIUM_PRI;
+  }
 
   if (stream->digest_ || stream->no_payload_) {
     stream->setTrafficClass(TrafficClass::RECOVERY);
@@ -24,12 +24,17 @@ Message::Disposition STOP_onReceived(STOP_Message* msg, const Address& from) {
     return Message::Disposition::ERROR;
   }
 
-  const STOP_Header& header = msg->getHeader();
+  STOP_handleHeader(msg->getHeader(), from);
+  return Message::Disposition::NORMAL;
+}
+
+void STOP_handleHeader(const STOP_Header& header, const Address& from) {
+  ld_check(from.isClientAddress());
   ServerWorker* w = ServerWorker::onThisThread();
   if (!w->processor_->runningOnStorageNode()) {
     ld_debug("got STOP message from client %s but not a storage node",
              Sender::describeConnection(from).c_str());
-    return Message::Disposition::NORMAL;
+    return;
   }
 
   const shard_size_t n_shards = w->getNodesConfiguration()->getNumShards();
@@ -42,7 +47,7 @@ Message::Disposition STOP_onReceived(STOP_Message* msg, const Address& from) {
                     Sender::describeConnection(from).c_str(),
                     shard_idx,
                     n_shards);
-    return Message::Disposition::NORMAL;
+    return;
   }
 
   // TODO validate log ID and send back error
@@ -51,8 +56,6 @@ Message::Disposition STOP_onReceived(STOP_Message* msg, const Address& from) {
     w->serverReadStreams().erase(
         from.id_.client_, header.log_id, header.read_stream_id, shard_idx);
   }
-
-  return Message::Disposition::NORMAL;
 }
 
 }} // namespace facebook::logdevice
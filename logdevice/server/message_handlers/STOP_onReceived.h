@@ -15,4 +15,11 @@ namespace facebook { namespace logdevice {
 struct Address;
 
 Message::Disposition STOP_onReceived(STOP_Message* msg, const Address& from);
+
+/**
+ * Stops the read stream described by a STOP header received from client
+ * `from`. Used for STOP messages and for the stops batched in READ_CONTROL
+ * messages.
+ */
+void STOP_handleHeader(const STOP_Header& header, const Address& from);
 }} // namespace facebook::logdevice
@@ -0,0 +1,57 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/read_path/AdaptiveBatchSize.h"
+
+#include <algorithm>
+
+namespace facebook { namespace logdevice {
+
+constexpr size_t AdaptiveBatchSize::MIN_SIZE;
+constexpr double AdaptiveBatchSize::ALPHA;
+
+void AdaptiveBatchSize::onWindowUpdate(uint64_t bytes_sent,
+                                       Clock::time_point now) {
+  const bool first = last_window_update_ == Clock::time_point();
+  const auto elapsed = now - last_window_update_;
+  const uint64_t bytes = bytes_sent - last_bytes_sent_;
+  last_window_update_ = now;
+  last_bytes_sent_ = bytes_sent;
+  if (first || elapsed <= Clock::duration::zero()) {
+    return;
+  }
+
+  const double rate =
+      bytes / std::chrono::duration_cast<std::chrono::duration<double>>(elapsed)
+                  .count();
+  bytes_per_sec_ =
+      bytes_per_sec_ == 0 ? rate : ALPHA * rate + (1 - ALPHA) * bytes_per_sec_;
+}
+
+void AdaptiveBatchSize::onStorageTaskDone(std::chrono::microseconds latency) {
+  latency = std::max(latency, std::chrono::microseconds(1));
+  latency_ = latency_.count() == 0
+      ? latency
+      : std::chrono::microseconds(static_cast<int64_t>(
+            ALPHA * latency.count() + (1 - ALPHA) * latency_.count()));
+}
+
+size_t AdaptiveBatchSize::getSize(size_t max_size) const {
+  const size_t min_size = std::min(MIN_SIZE, max_size);
+  if (bytes_per_sec_ == 0 || latency_.count() == 0) {
+    return max_size;
+  }
+  // What the client consumes during two storage task round trips: one for
+  // the batch being read and one for the batch being consumed.
+  const double target = 2 * bytes_per_sec_ * latency_.count() / 1e6;
+  if (target >= max_size) {
+    return max_size;
+  }
+  return std::max(min_size, static_cast<size_t>(target));
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Per-ServerReadStream policy that picks how many bytes a batch read
+ *       from the local log store may read, based on how fast the client
+ *       consumes records and how long the stream's storage tasks take.
+ *
+ *       A batch should hold about what the client consumes while the next
+ *       batch is being read, so that the client never waits on the storage
+ *       node but the stream doesn't read much further ahead than that either:
+ *       a fast consumer behind a slow disk gets large batches and few round
+ *       trips, while a slow consumer gets small batches that leave room for
+ *       other streams of the storage threads and of the client's socket.
+ *
+ *       The consumption rate is the rate at which RECORD bytes were sent to
+ *       the client between WINDOW messages sliding the window, since the
+ *       client only slides the window once it has consumed records.
+ */
+
+class AdaptiveBatchSize {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // Smallest batch size returned by getSize().
+  static constexpr size_t MIN_SIZE = 64 * 1024;
+
+  /**
+   * Called when a WINDOW message slides the window of the stream.
+   *
+   * @param bytes_sent  total RECORD bytes sent for the stream so far
+   */
+  void onWindowUpdate(uint64_t bytes_sent, Clock::time_point now);
+
+  /**
+   * Called when a storage task of the stream comes back, with the time since
+   * it was issued.
+   */
+  void onStorageTaskDone(std::chrono::microseconds latency);
+
+  /**
+   * @return bytes that the next batch may read, between MIN_SIZE and
+   *         max_size. max_size until both the consumption rate and the
+   *         storage task latency were measured.
+   */
+  size_t getSize(size_t max_size) const;
+
+  // Estimates, 0 if not measured yet.
+  double bytesPerSecond() const {
+    return bytes_per_sec_;
+  }
+  std::chrono::microseconds storageTaskLatency() const {
+    return latency_;
+  }
+
+ private:
+  // Weight of the last sample in the moving averages.
+  static constexpr double ALPHA = 0.25;
+
+  double bytes_per_sec_{0};
+  std::chrono::microseconds latency_{0};
+
+  // State at the last WINDOW update.
+  uint64_t last_bytes_sent_{0};
+  Clock::time_point last_window_update_{};
+};
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,50 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/read_path/AdaptiveReadahead.h"
+
+#include <algorithm>
+
+namespace facebook { namespace logdevice {
+
+constexpr size_t AdaptiveReadahead::INITIAL_SIZE;
+
+void AdaptiveReadahead::onBatchComplete(Status status) {
+  switch (status) {
+    case E::BYTE_LIMIT_REACHED:
+    case E::PARTIAL:
+      // Stopped in the middle of the data, the next batch continues from
+      // here.
+      ++sequential_batches_;
+      break;
+    case E::CAUGHT_UP:
+    case E::UNTIL_LSN_REACHED:
+      // Tailing, or done.
+      sequential_batches_ = 0;
+      break;
+    default:
+      // E::WINDOW_END_REACHED: the client's flow control stopped us, which
+      // says nothing about the access pattern. Errors neither.
+      break;
+  }
+}
+
+size_t AdaptiveReadahead::getSize(size_t max_size,
+                                  size_t min_sequential_batches) const {
+  if (max_size == 0 || sequential_batches_ == 0 ||
+      sequential_batches_ < min_sequential_batches) {
+    return 0;
+  }
+  size_t size = std::min(INITIAL_SIZE, max_size);
+  const size_t doublings = sequential_batches_ - min_sequential_batches;
+  for (size_t i = 0; i < doublings && size < max_size; ++i) {
+    size *= 2;
+  }
+  return std::min(size, max_size);
+}
+
+}} // namespace facebook::logdevice
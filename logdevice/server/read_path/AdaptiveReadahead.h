@@ -0,0 +1,55 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <cstddef>
+
+#include "logdevice/include/Err.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Per-ServerReadStream policy that picks the read-ahead size used by the
+ *       local log store iterator of a catching up stream, based on how the
+ *       stream's recent storage task batches ended.
+ *
+ *       A batch that stopped because it hit a byte or time limit means there
+ *       is more data to read right after it: the stream is scanning a
+ *       backlog. Once that happened `min_sequential_batches` times in a row,
+ *       read-ahead kicks in and doubles with each further such batch, up to
+ *       `max_size`. A batch that caught up with the tail (or reached
+ *       until_lsn) resets the policy, so tailing readers keep doing small
+ *       block reads.
+ */
+
+class AdaptiveReadahead {
+ public:
+  // Read-ahead size used for the first sequential batch.
+  static constexpr size_t INITIAL_SIZE = 256 * 1024;
+
+  /**
+   * Called with the status of each batch read by a storage task.
+   */
+  void onBatchComplete(Status status);
+
+  /**
+   * @return read-ahead size to use for the next storage task, or 0 to use
+   *         the storage engine's default. Always 0 if max_size is 0.
+   */
+  size_t getSize(size_t max_size, size_t min_sequential_batches) const;
+
+  size_t sequentialBatches() const {
+    return sequential_batches_;
+  }
+
+ private:
+  // Number of consecutive batches that ended because of a read limit.
+  size_t sequential_batches_{0};
+};
+
+}} // namespace facebook::logdevice
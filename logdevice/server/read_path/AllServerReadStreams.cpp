@@ -28,6 +28,7 @@
 #include "logdevice/server/locallogstore/LocalLogStore.h"
 #include "logdevice/server/read_path/IteratorCache.h"
 #include "logdevice/server/storage_tasks/EpochOffsetStorageTask.h"
+#include "logdevice/server/storage_tasks/MultiLogReadStorageTask.h"
 #include "logdevice/server/storage_tasks/PerWorkerStorageTaskQueue.h"
 #include "logdevice/server/storage_tasks/ReadStorageTask.h"
 #include "logdevice/server/storage_tasks/ShardedStorageThreadPool.h"
@@ -43,8 +44,14 @@ AllServerReadStreams::AllServerReadStreams(
     StatsHolder* stats,
     bool on_worker_thread)
     : real_time_record_buffer_(
-          settings->real_time_max_bytes / settings->num_workers,
           settings->real_time_eviction_threshold_bytes / settings->num_workers,
+          settings->real_time_max_bytes / settings->num_workers,
+          stats,
+          settings->real_time_max_bytes_per_log / settings->num_workers,
+          settings->real_time_admission_control),
+      read_result_cache_(
+          settings->read_result_cache_max_bytes / settings->num_workers,
+          settings->read_result_cache_ttl,
           stats),
       processor_(processor),
       stats_(stats),
@@ -404,7 +411,14 @@ AllServerReadStreams::onWindowMessage(WINDOW_Message* msg,
     return Message::Disposition::ERROR;
   }
 
-  const WINDOW_Header& header = msg->header_;
+  onWindowUpdate(msg->header_, from);
+  return Message::Disposition::NORMAL;
+}
+
+void AllServerReadStreams::onWindowUpdate(const WINDOW_Header& header,
+                                          const Address& from) {
+  ld_check(from.isClientAddress());
+  ServerWorker* w = ServerWorker::onThisThread();
 
   // TODO validate log ID and send back error
 
@@ -420,7 +434,7 @@ AllServerReadStreams::onWindowMessage(WINDOW_Message* msg,
                uint64_t(header.read_stream_id),
                header.sliding_window.high,
                header.sliding_window.low);
-    return Message::Disposition::NORMAL;
+    return;
   }
 
   ld_spew("Client %s updated window for log %lu (rsid %ld) to [%s, %s]",
@@ -431,7 +445,6 @@ AllServerReadStreams::onWindowMessage(WINDOW_Message* msg,
           lsn_to_string(header.sliding_window.high).c_str());
 
   w->serverReadStreams().onWindowMessage(from.asClientID(), header);
-  return Message::Disposition::NORMAL;
 }
 
 void AllServerReadStreams::onWindowMessage(ClientID from,
@@ -493,6 +506,8 @@ void AllServerReadStreams::onWindowMessage(ClientID from,
   }
 
   stream->setWindowHigh(msg_header.sliding_window.high);
+  stream->batch_size_.onWindowUpdate(
+      stream->record_bytes_sent_, std::chrono::steady_clock::now());
   if (stream->isPastWindow()) {
     // read_ptr_ is already past the new window high, this means we already
     // sent a gap to the client with higher bound >= window high. We do not
@@ -595,9 +610,14 @@ void AllServerReadStreams::getReadStreamsDebugInfo(
     InfoReadersTable& table) const {
   const auto& client_index = streams_.get<ClientIndex>();
   auto range = client_index.equal_range(client_id);
-  std::string out;
+  if (range.first == range.second) {
+    return;
+  }
+  const ssize_t send_buf_occupancy =
+      Worker::onThisThread()->sender().getTcpSendBufOccupancyForClient(
+          client_id);
   for (auto it = range.first; it != range.second; ++it) {
-    it->getDebugInfo(table);
+    it->getDebugInfo(table, send_buf_occupancy);
   }
 }
 
@@ -606,16 +626,27 @@ void AllServerReadStreams::getReadStreamsDebugInfo(
     InfoReadersTable& table) const {
   const auto& log_index = streams_.get<LogIndex>();
   auto range = log_index.equal_range(log_id);
-  std::string out;
+  const Sender& sender = Worker::onThisThread()->sender();
   for (auto it = range.first; it != range.second; ++it) {
-    it->getDebugInfo(table);
+    it->getDebugInfo(
+        table, sender.getTcpSendBufOccupancyForClient(it->client_id_));
   }
 }
 
 void AllServerReadStreams::getReadStreamsDebugInfo(
     InfoReadersTable& table) const {
-  for (const ServerReadStream& stream : streams_) {
-    stream.getDebugInfo(table);
+  // Streams of the same client are adjacent in the client index, so the
+  // client's socket only needs to be queried once (an ioctl per call).
+  const auto& client_index = streams_.get<ClientIndex>();
+  const Sender& sender = Worker::onThisThread()->sender();
+  ClientID prev_client = ClientID::INVALID;
+  ssize_t send_buf_occupancy = -1;
+  for (const ServerReadStream& stream : client_index) {
+    if (stream.client_id_ != prev_client) {
+      prev_client = stream.client_id_;
+      send_buf_occupancy = sender.getTcpSendBufOccupancyForClient(prev_client);
+    }
+    stream.getDebugInfo(table, send_buf_occupancy);
   }
 }
 
@@ -688,6 +719,33 @@ void AllServerReadStreams::putStorageTask(
   }
 }
 
+void AllServerReadStreams::putStorageTasks(
+    std::vector<std::unique_ptr<ReadStorageTask>> tasks,
+    shard_index_t shard) {
+  std::vector<std::unique_ptr<ReadStorageTask>> ready;
+  for (auto& task : tasks) {
+    ld_check(task);
+    if (!delayed_read_storage_tasks_.empty() ||
+        !tryAcquireMemoryForTask(task)) {
+      // Same as in putStorageTask(). The task will be sent on its own once
+      // there is memory for it.
+      delayed_read_storage_tasks_.push(QueuedTask{std::move(task), shard});
+      STAT_INCR(stats_, read_storage_tasks_delayed);
+    } else {
+      read_storage_tasks_in_flight_++;
+      ready.push_back(std::move(task));
+    }
+  }
+
+  if (ready.size() == 1) {
+    sendStorageTask(std::move(ready.front()), shard);
+  } else if (ready.size() > 1) {
+    STAT_INCR(stats_, read_storage_task_batches);
+    STAT_ADD(stats_, read_storage_tasks_batched, ready.size());
+    sendStorageTaskBatch(std::move(ready), shard);
+  }
+}
+
 void AllServerReadStreams::sendStorageTask(
     std::unique_ptr<ReadStorageTask>&& task,
     shard_index_t shard) {
@@ -697,6 +755,17 @@ void AllServerReadStreams::sendStorageTask(
   task_queue->putTask(std::move(task));
 }
 
+void AllServerReadStreams::sendStorageTaskBatch(
+    std::vector<std::unique_ptr<ReadStorageTask>> tasks,
+    shard_index_t shard) {
+  ld_check(tasks.size() > 1);
+  ServerWorker* worker = ServerWorker::onThisThread();
+  ld_check(worker);
+  auto task_queue = worker->getStorageTaskQueueForShard(shard);
+  task_queue->putTask(
+      std::make_unique<MultiLogReadStorageTask>(std::move(tasks)));
+}
+
 ResourceBudget& AllServerReadStreams::getMemoryBudget() {
   return memory_budget_;
 }
@@ -720,7 +789,13 @@ void AllServerReadStreams::evictRealTime() {
   while (real_time_record_buffer_.overEvictionThreshold()) {
     distributeNewlyReleasedRecords();
 
-    evictRealTimeLog(real_time_record_buffer_.toEvict());
+    // Distributing may have evicted logs over their quota, possibly all of
+    // them.
+    logid_t logid = real_time_record_buffer_.toEvict();
+    if (logid == LOGID_INVALID) {
+      break;
+    }
+    evictRealTimeLog(logid);
   }
 }
 
@@ -875,13 +950,29 @@ void AllServerReadStreams::onShardStatusUpdateMessageSent(ClientID cid,
 void AllServerReadStreams::distributeNewlyReleasedRecords() {
   real_time_record_buffer_.sweep(
       [this](std::unique_ptr<ReleasedRecords> records) {
+        const logid_t logid = records->logid_;
+        const bool admitted = real_time_record_buffer_.admit(logid);
         records->buffer_ = &real_time_record_buffer_;
-        real_time_record_buffer_.addToLRU(records->logid_);
+        real_time_record_buffer_.addToLRU(*records);
+        if (!admitted) {
+          STAT_INCR(stats_, real_time_records_not_admitted);
+          // The ReleasedRecords will be deleted when records goes out of
+          // scope.
+          return;
+        }
         std::shared_ptr<ReleasedRecords> ptr{records.release()};
-        auto range = streams_.get<LogIndex>().equal_range(ptr->logid_);
+        auto range = streams_.get<LogIndex>().equal_range(logid);
         for (auto it = range.first; it != range.second; ++it) {
           deref(it).addReleasedRecords(ptr);
         }
+        ptr.reset();
+        if (range.first != range.second &&
+            real_time_record_buffer_.overLogQuota(logid)) {
+          // Keep a single high-throughput log from pushing the records of
+          // all other logs out of the buffer.
+          STAT_INCR(stats_, real_time_record_buffer_log_quota_eviction);
+          evictRealTimeLog(logid);
+        }
       });
 }
 
@@ -11,6 +11,7 @@
 #include <queue>
 #include <set>
 #include <utility>
+#include <vector>
 
 #include <boost/multi_index/composite_key.hpp>
 #include <boost/multi_index/hashed_index.hpp>
@@ -36,6 +37,7 @@
 #include "logdevice/server/read_path/CatchupQueue.h"
 #include "logdevice/server/read_path/LogStorageStateMap.h"
 #include "logdevice/server/read_path/ReadIoShapingCallback.h"
+#include "logdevice/server/read_path/ReadResultCache.h"
 #include "logdevice/server/read_path/ServerReadStream.h"
 
 namespace facebook { namespace logdevice {
@@ -210,6 +212,14 @@ class AllServerReadStreams : public ShardAuthoritativeStatusSubscriber {
   static Message::Disposition onWindowMessage(WINDOW_Message* msg,
                                               const Address& from);
 
+  /**
+   * Validates a window update received from client `from` in a WINDOW
+   * message or batched in a READ_CONTROL message, and applies it to the
+   * current Worker's AllServerReadStreams instance. The checks that apply to
+   * the whole message must have been done by the caller.
+   */
+  static void onWindowUpdate(const WINDOW_Header& header, const Address& from);
+
   /**
    * Called when a WINDOW message is received from a client.  Looks up the
    * relevant ServerReadStream and updates its window, switching it to the
@@ -282,6 +292,14 @@ class AllServerReadStreams : public ShardAuthoritativeStatusSubscriber {
   void putStorageTask(std::unique_ptr<ReadStorageTask>&& task,
                       shard_index_t shard);
 
+  /**
+   * Like putStorageTask() but for several tasks going to the same shard.
+   * Tasks that fit in the memory budget are sent together in one
+   * MultiLogReadStorageTask; the others are delayed individually.
+   */
+  void putStorageTasks(std::vector<std::unique_ptr<ReadStorageTask>> tasks,
+                       shard_index_t shard);
+
   /**
    * Adjust the memory budget for read storage tasks (called by Worker when
    * settings are updated).
@@ -296,6 +314,10 @@ class AllServerReadStreams : public ShardAuthoritativeStatusSubscriber {
     return real_time_record_buffer_;
   }
 
+  ReadResultCache& getReadResultCache() {
+    return read_result_cache_;
+  }
+
   /**
    * This method can be called from any thread, including storage threads.  It's
    * called with the EpochRecordCache rw lock held, so it should be as fast as
@@ -325,6 +347,14 @@ class AllServerReadStreams : public ShardAuthoritativeStatusSubscriber {
     real_time_record_buffer_.used(logid);
   }
 
+  /**
+   * Tell the real time record cache that a reader tailing the given log wants
+   * newly released records, see RealTimeRecordBuffer::noteDemand().
+   */
+  void noteRealTimeDemand(logid_t logid) {
+    real_time_record_buffer_.noteDemand(logid);
+  }
+
   /**
    * Callback, called when settings_ changes.
    */
@@ -369,6 +399,14 @@ class AllServerReadStreams : public ShardAuthoritativeStatusSubscriber {
   virtual void sendStorageTask(std::unique_ptr<ReadStorageTask>&& task,
                                shard_index_t shard);
 
+  /**
+   * Send several ReadStorageTasks wrapped in a MultiLogReadStorageTask.
+   * @param tasks At least two tasks for `shard`, all of the same type.
+   */
+  virtual void
+  sendStorageTaskBatch(std::vector<std::unique_ptr<ReadStorageTask>> tasks,
+                       shard_index_t shard);
+
   // Starts a zero-delay timer to call sendDelayedStorageTasks() on the next
   // event loop iteration.
   virtual void scheduleSendDelayedStorageTasks();
@@ -441,6 +479,8 @@ class AllServerReadStreams : public ShardAuthoritativeStatusSubscriber {
 
   RealTimeRecordBuffer real_time_record_buffer_;
 
+  ReadResultCache read_result_cache_;
+
   /**
    * Retrieve a ServerReadStream behind an iterator. boost::multi_index does not
    * allow retrieving a non const ServerReadStream because modifying its
@@ -14,7 +14,9 @@
 #include <utility>
 
 #include <folly/CppAttributes.h>
+#include <folly/Format.h>
 #include <folly/Optional.h>
+#include <folly/ScopeGuard.h>
 
 #include "logdevice/common/BWAvailableCallback.h"
 #include "logdevice/common/Checksum.h"
@@ -23,7 +25,9 @@
 #include "logdevice/common/Sender.h"
 #include "logdevice/common/ServerRecordFilter.h"
 #include "logdevice/common/configuration/InternalLogs.h"
+#include "logdevice/common/protocol/Compatibility.h"
 #include "logdevice/common/protocol/GAP_Message.h"
+#include "logdevice/common/protocol/MULTI_RECORD_Message.h"
 #include "logdevice/common/protocol/RECORD_Message.h"
 #include "logdevice/common/protocol/STARTED_Message.h"
 #include "logdevice/common/stats/Histogram.h"
@@ -221,6 +225,21 @@ class ReadingCallback : public LocalLogStoreReader::Callback {
   LocalLogStore* store_;
   ServerReadStream::RecordSource source_;
   CatchupEventTrigger catchup_reason_;
+
+  // Raw record currently being processed, if it came from the local log
+  // store. Used to share the payload with the RECORD message instead of
+  // copying it, see RawRecord::sharePayload().
+  const RawRecord* current_record_{nullptr};
+
+  // Payload of the RealTimeRecordBuffer entry currently being processed, if
+  // the record is served from the real time buffer. All streams tailing the
+  // log reference this one buffer from their RECORD messages instead of each
+  // making a private copy of the payload.
+  const PayloadHolder* current_real_time_payload_{nullptr};
+
+  // Verdict of the stream's filter on the record currently being processed,
+  // if it was already evaluated while parsing the record.
+  folly::Optional<bool> current_filter_result_;
 };
 
 int ReadingCallback::processRecord(const RawRecord& record) {
@@ -240,6 +259,12 @@ int ReadingCallback::processRecord(const RawRecord& record) {
   if (stream_->include_extra_metadata_) {
     copyset = (ShardID*)alloca(COPYSET_SIZE_MAX * sizeof(ShardID));
   }
+  // Equality and range filters only need the FILTERABLE key. Evaluate them
+  // on a view into the blob instead of copying all optional keys into a map,
+  // which is most of the cost of filtering a record.
+  const bool key_only_filter = stream_->filter_pred_ != nullptr &&
+      stream_->filter_pred_->onlyUsesFilterableKey();
+  folly::Optional<folly::StringPiece> filterable_key;
   int rv = LocalLogStoreRecordFormat::parse(
       record.blob,
       &timestamp,
@@ -250,9 +275,11 @@ int ReadingCallback::processRecord(const RawRecord& record) {
       stream_->include_extra_metadata_ ? copyset : nullptr,
       COPYSET_SIZE_MAX,
       &offsets_within_epoch,
-      stream_->filter_pred_ != nullptr ? &optional_keys : nullptr,
+      stream_->filter_pred_ != nullptr && !key_only_filter ? &optional_keys
+                                                           : nullptr,
       &payload,
-      stream_->shard_);
+      stream_->shard_,
+      key_only_filter ? &filterable_key : nullptr);
 
   if (rv != 0) {
     ld_check(false);
@@ -278,6 +305,15 @@ int ReadingCallback::processRecord(const RawRecord& record) {
   //       is only reset at the end of each read if the read only accessed
   //       fully replicated portions of the LocalLogStore.
   stream_->in_under_replicated_region_ |= record.from_under_replicated_region;
+  current_record_ = &record;
+  if (key_only_filter) {
+    current_filter_result_ = !filterable_key.has_value() ||
+        (*stream_->filter_pred_)(filterable_key.value());
+  }
+  SCOPE_EXIT {
+    current_record_ = nullptr;
+    current_filter_result_.clear();
+  };
   return processRecord(lsn,
                        timestamp,
                        flags,
@@ -309,13 +345,19 @@ int ReadingCallback::processRecord(
   // FILTERED_OUT will be sent to client-side.
   bool filtered_out = false;
 
-  if (stream_->filter_pred_ != nullptr &&
-      (flags & LocalLogStoreRecordFormat::FLAG_OPTIONAL_KEYS)) {
-    const auto it = optional_keys.find(KeyType::FILTERABLE);
-    if (it != optional_keys.end()) {
-      if (!(*stream_->filter_pred_)(it->second)) {
-        filtered_out = true;
-      }
+  if (stream_->filter_pred_ != nullptr) {
+    if (current_filter_result_.has_value()) {
+      filtered_out = !current_filter_result_.value();
+    } else {
+      // optional_keys is empty unless flags has FLAG_OPTIONAL_KEYS.
+      filtered_out = !stream_->filter_pred_->matches(
+          ServerRecordFilter::RecordAttributes{
+              lsn, timestamp, payload.size(), optional_keys});
+    }
+    if (filtered_out) {
+      ++stream_->filter_records_rejected_;
+    } else {
+      ++stream_->filter_records_passed_;
     }
   }
 
@@ -595,11 +637,39 @@ int ReadingCallback::shipRecord(lsn_t lsn,
                           static_cast<uint64_t>(timestamp.count()),
                           wire_flags,
                           stream_->shard_};
+  // A payload stored compressed is uncompressed only now, after server-side
+  // filtering, so records that are filtered out don't pay for it.
+  folly::IOBuf uncompressed;
+  if ((disk_flags & LocalLogStoreRecordFormat::FLAG_PAYLOAD_COMPRESSED) &&
+      !stream_->no_payload_ && !stream_->csi_data_only_) {
+    if (LocalLogStoreRecordFormat::uncompressPayload(payload, &uncompressed) !=
+        0) {
+      RATELIMIT_ERROR(std::chrono::seconds(10),
+                      10,
+                      "Failed to uncompress payload of record %lu%s",
+                      stream_->log_id_.val_,
+                      lsn_to_string(lsn).c_str());
+      return -1;
+    }
+    payload = Payload(uncompressed.data(), uncompressed.length());
+    STAT_INCR(
+        catchup_->deps_.getStatsHolder(), read_path_payloads_uncompressed);
+  }
+
   PayloadHolder payload_holder;
   if (stream_->no_payload_ || stream_->csi_data_only_) {
     // Clear checksum flags if we don't ship payload
     header.flags &= ~(RECORD_Header::CHECKSUM | RECORD_Header::CHECKSUM_64BIT);
     header.flags |= RECORD_Header::CHECKSUM_PARITY;
+  } else if (current_record_ && current_record_->payload_hash_only) {
+    // The storage thread already replaced the payload with its hash.
+    ld_check(stream_->payload_hash_only_);
+    if (header.flags & RECORD_Header::CHECKSUM) {
+      header.flags &=
+          ~(RECORD_Header::CHECKSUM | RECORD_Header::CHECKSUM_64BIT);
+      header.flags |= RECORD_Header::CHECKSUM_PARITY;
+    }
+    payload_holder = PayloadHolder::copyBuffer(payload.data(), payload.size());
   } else if (stream_->payload_hash_only_) {
     // Strip checksum from the payload.
     if (header.flags & RECORD_Header::CHECKSUM) {
@@ -630,6 +700,25 @@ int ReadingCallback::shipRecord(lsn_t lsn,
     h.length = static_cast<uint32_t>(payload.size());
     h.hash = checksum_32bit(Slice(payload));
     payload_holder = PayloadHolder::copyBuffer(&h, sizeof(h));
+  } else if (!uncompressed.empty()) {
+    payload_holder = PayloadHolder(std::move(uncompressed));
+  } else if (current_record_ && current_record_->shareable()) {
+    // The storage thread already copied the record into a refcounted buffer
+    // that nobody else modifies. Reference it from the RECORD message; the
+    // buffer gets released once the message is written to the socket.
+    payload_holder = current_record_->sharePayload(payload);
+    STAT_ADD(catchup_->deps_.getStatsHolder(),
+             read_path_payload_bytes_shared,
+             payload.size());
+  } else if (current_real_time_payload_ &&
+             payload.data() == current_real_time_payload_->iobuf().data() &&
+             payload.size() == current_real_time_payload_->size()) {
+    // Copying a PayloadHolder only bumps the refcount of its IOBuf, which
+    // the real time buffer never modifies.
+    payload_holder = *current_real_time_payload_;
+    STAT_ADD(catchup_->deps_.getStatsHolder(),
+             real_time_payload_bytes_shared,
+             payload.size());
   } else {
     // Make private copy of the data so it is stable for the lifetime of
     // the, possibly deferred on transmission, RECORD message.
@@ -666,11 +755,21 @@ int ReadingCallback::shipRecord(lsn_t lsn,
   // Remember how much space we will take in the output evbuffer
   const auto msg_size = msg->size();
 
-  // Let the Sender deal with any traffic shaping induced deferral.
-  // We don't want to have to read the data again just because traffic
-  // shaping is pacing data.
-  int rv =
-      catchup_->deps_.sender_->sendMessage(std::move(msg), stream_->client_id_);
+  int rv;
+  if (msg->payload_.size() <= MAX_COPY_TO_EVBUFFER_PAYLOAD_SIZE &&
+      catchup_->recordBatchSize() > 1) {
+    // Small record, send it together with the ones that follow it.
+    rv = catchup_->addPendingRecord(std::move(msg));
+  } else {
+    rv = catchup_->flushRecords();
+    if (rv == 0) {
+      // Let the Sender deal with any traffic shaping induced deferral.
+      // We don't want to have to read the data again just because traffic
+      // shaping is pacing data.
+      rv = catchup_->deps_.sender_->sendMessage(
+          std::move(msg), stream_->client_id_);
+    }
+  }
 
   if (rv != 0) {
     ld_check(err != E::CBREGISTERED);
@@ -734,6 +833,69 @@ CatchupOneStream::CatchupOneStream(CatchupQueueDependencies& deps,
       resume_cb_(resume_cb),
       record_bytes_queued_(0) {}
 
+CatchupOneStream::~CatchupOneStream() {
+  // Every path that processes records ends with flushRecords().
+  ld_check(pending_records_.empty());
+}
+
+size_t CatchupOneStream::recordBatchSize() const {
+  if (stream_->proto_ < Compatibility::MULTI_RECORD_SUPPORT) {
+    return 1;
+  }
+  return std::min(deps_.getSettings().read_record_batch_size,
+                  MULTI_RECORD_Message::MAX_ENTRIES);
+}
+
+int CatchupOneStream::addPendingRecord(std::unique_ptr<RECORD_Message> msg) {
+  if (pending_records_.empty()) {
+    pending_rollback_ = {stream_->last_delivered_lsn_,
+                         stream_->last_delivered_record_,
+                         stream_->getReadPtr(),
+                         stream_->filtered_out_end_lsn_,
+                         record_bytes_queued_};
+  }
+  pending_records_.push_back(std::move(msg));
+  if (pending_records_.size() >= recordBatchSize()) {
+    return flushRecords();
+  }
+  return 0;
+}
+
+int CatchupOneStream::flushRecords() {
+  if (pending_records_.empty()) {
+    return 0;
+  }
+
+  std::unique_ptr<Message> msg;
+  const size_t nrecords = pending_records_.size();
+  if (nrecords == 1) {
+    msg = std::move(pending_records_.front());
+  } else {
+    msg = std::make_unique<MULTI_RECORD_Message>(
+        std::move(pending_records_), stream_->trafficClass());
+  }
+  pending_records_.clear();
+
+  int rv = deps_.sender_->sendMessage(std::move(msg), stream_->client_id_);
+  if (rv != 0) {
+    // The records were never handed over to the messaging layer. Pretend
+    // they were not read at all; the stream will read them again.
+    stream_ld_debug(*stream_,
+                    "Failed to send a batch of %lu records: %s. Rolling back "
+                    "read pointer to %s.",
+                    nrecords,
+                    error_description(err),
+                    lsn_to_string(pending_rollback_.read_ptr.lsn).c_str());
+    stream_->last_delivered_lsn_ = pending_rollback_.last_delivered_lsn;
+    stream_->last_delivered_record_ = pending_rollback_.last_delivered_record;
+    stream_->setReadPtr(pending_rollback_.read_ptr);
+    stream_->filtered_out_end_lsn_ = pending_rollback_.filtered_out_end_lsn;
+    record_bytes_queued_ = pending_rollback_.record_bytes_queued;
+    return -1;
+  }
+  return 0;
+}
+
 CatchupOneStream::Action
 CatchupOneStream::startRead(WeakRef<CatchupQueue> catchup_queue,
                             bool try_non_blocking_read,
@@ -1000,14 +1162,51 @@ CatchupOneStream::startRead(WeakRef<CatchupQueue> catchup_queue,
     }
   }
 
+  // A read triggered by a release comes from a reader tailing the log.
+  const bool tailing = catchup_reason == CatchupEventTrigger::RELEASE;
+  if (tailing) {
+    deps_.noteRealTimeDemand(stream_->log_id_);
+  }
+
   // If we can push realtime records, lets do it!
   if (!released_records.empty() && !inject_latency) {
     Action action = pushReleasedRecords(released_records, read_ctx);
     if (action != Action::NOT_IN_REAL_TIME_BUFFER) {
       deps_.used(stream_->log_id_);
+      if (tailing) {
+        WORKER_LOG_STAT_INCR(stream_->log_id_, real_time_reads_hit);
+      }
       return action;
     }
   }
+  if (tailing && !inject_latency) {
+    WORKER_LOG_STAT_INCR(stream_->log_id_, real_time_reads_miss);
+  }
+
+  // Readers that aren't tailing may be reading a range another stream has
+  // just read, e.g. several consumers of a backfill job.
+  ReadResultCache& result_cache = deps_.getReadResultCache();
+  if (!tailing && !inject_latency && result_cache.enabled()) {
+    LogStorageState& log_state =
+        deps_.getLogStorageStateMap().get(stream_->log_id_, stream_->shard_);
+    auto batch = result_cache.lookup(readResultCacheKey(read_ctx.read_ptr_),
+                                     read_ctx,
+                                     log_state.getTrimPoint());
+    if (batch) {
+      ++stream_->read_result_cache_hits_;
+      stream_ld_debug(*stream_,
+                      "Serving %zu records up to %s from read result cache",
+                      batch->records.size(),
+                      lsn_to_string(batch->read_ptr.lsn).c_str());
+      return processRecords(batch->records,
+                            stream_->version_,
+                            batch->read_ptr,
+                            batch->accessed_under_replicated_region,
+                            batch->status,
+                            catchup_reason);
+    }
+    ++stream_->read_result_cache_misses_;
+  }
 
   if (try_non_blocking_read && !inject_latency) {
     // First try an immediate non-blocking read on the current worker
@@ -1041,7 +1240,9 @@ CatchupOneStream::startRead(WeakRef<CatchupQueue> catchup_queue,
       return Action::WAIT_FOR_READ_BANDWIDTH;
     }
     if (w) {
-      cost_estimate = w->settings().max_record_bytes_read_at_once;
+      cost_estimate = read_ctx.max_bytes_to_read_ > 0
+          ? read_ctx.max_bytes_to_read_
+          : w->settings().max_record_bytes_read_at_once;
     }
     STAT_INCR(deps_.getStatsHolder(), read_throttling_num_storage_tasks_issued);
   }
@@ -1063,6 +1264,7 @@ CatchupOneStream::Action CatchupOneStream::pushReleasedRecords(
   int nrecords = 0;
   size_t bytes_delivered = 0;
   bool seen_our_epoch = false;
+  const bool share_payloads = deps_.getSettings().zero_copy_record_delivery;
 
   // By definition, every record in released_records has been released.  So it's
   // safe to increase last_released_lsn_ to the max in released_records for this
@@ -1216,6 +1418,9 @@ CatchupOneStream::Action CatchupOneStream::pushReleasedRecords(
 
       nrecords++;
 
+      if (share_payloads) {
+        callback.current_real_time_payload_ = &entry->payload;
+      }
       int rv =
           callback.processRecord(entry->lsn,
                                  std::chrono::milliseconds(entry->timestamp),
@@ -1227,6 +1432,7 @@ CatchupOneStream::Action CatchupOneStream::pushReleasedRecords(
                                  entry->copyset.size(),
                                  entry->copyset.data(),
                                  entry->offsets_within_epoch);
+      callback.current_real_time_payload_ = nullptr;
       if (rv != 0) {
         ld_check_ne(err, E::CBREGISTERED);
         status = E::ABORTED;
@@ -1241,7 +1447,10 @@ CatchupOneStream::Action CatchupOneStream::pushReleasedRecords(
     }
   }
 
-  if (read_ctx.read_ptr_.lsn > stream_->getReadPtr().lsn) {
+  // If a record failed to be sent, records held back before it may have
+  // been rolled back too, so don't move the read pointer past them.
+  if (status != E::ABORTED &&
+      read_ctx.read_ptr_.lsn > stream_->getReadPtr().lsn) {
     stream_->setReadPtr(read_ctx.read_ptr_.lsn);
   }
 
@@ -1317,6 +1526,10 @@ CatchupOneStream::readNonBlocking(WeakRef<CatchupQueue> /*catchup_queue*/,
     // or byte_offset and is therefore an underestimate.
     ld_check(read_ctx.max_bytes_to_deliver_ > record_bytes_queued_);
 
+    if (flushRecords() != 0) {
+      return handleBatchEnd(stream_->version_, E::ABORTED, read_ctx.read_ptr_);
+    }
+
     // setting the read pointer from the read_ctx, so we don't read the same
     // data twice
     stream_->setReadPtr(read_ctx.read_ptr_);
@@ -1355,6 +1568,10 @@ void CatchupOneStream::readOnStorageThread(
   options.allow_copyset_index = true;
   options.csi_data_only = stream_->csi_data_only_;
   options.inject_latency = inject_latency;
+  const Settings& settings = deps_.getSettings();
+  options.readahead_size =
+      stream_->readahead_.getSize(settings.catchup_readahead_max_size,
+                                  settings.catchup_readahead_min_batches);
 
   std::weak_ptr<LocalLogStore::ReadIterator> read_iterator;
   if (stream_->iterator_cache_ && stream_->iterator_cache_->valid(options)) {
@@ -1433,6 +1650,20 @@ CatchupOneStream::processTask(const ReadStorageTask& task) {
 
   ld_check(task.status_ != E::UNKNOWN);
 
+  stream_->readahead_.onBatchComplete(task.status_);
+  const LocalLogStore::ReadStats& read_stats = task.read_ctx_.it_stats_;
+  stream_->storage_bytes_read_ +=
+      read_stats.read_record_bytes + read_stats.read_csi_bytes;
+  stream_->storage_bytes_delivered_ += read_stats.sent_record_bytes;
+  STAT_ADD(deps_.getStatsHolder(),
+           read_storage_tasks_bytes_delivered,
+           read_stats.sent_record_bytes);
+  if (task.enqueue_time_ != std::chrono::steady_clock::time_point()) {
+    stream_->batch_size_.onStorageTaskDone(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - task.enqueue_time_));
+  }
+
   bool accessed_under_replicated_region =
       task.owned_iterator_ && // May be null in tests.
       task.owned_iterator_->accessedUnderReplicatedRegion();
@@ -1460,6 +1691,16 @@ CatchupOneStream::processTask(const ReadStorageTask& task) {
 
   LocalLogStoreReader::ReadPointer read_ptr = task.read_ctx_.read_ptr_;
 
+  ReadResultCache& result_cache = deps_.getReadResultCache();
+  if (result_cache.enabled() &&
+      task.read_ctx_.catchup_reason_ != CatchupEventTrigger::RELEASE) {
+    result_cache.insert(readResultCacheKey(task.start_read_ptr_),
+                        task.records_,
+                        read_ptr,
+                        task.status_,
+                        accessed_under_replicated_region);
+  }
+
   return processRecords(task.records_,
                         task.server_read_stream_version_,
                         read_ptr,
@@ -1645,6 +1886,10 @@ CatchupOneStream::Action CatchupOneStream::handleBatchEnd(
     Status status,
     const LocalLogStoreReader::ReadPointer& read_ptr) {
   ld_check(status != E::CBREGISTERED);
+  if (flushRecords() != 0) {
+    ld_check(err != E::CBREGISTERED);
+    status = E::ABORTED;
+  }
   if (status != E::ABORTED && status != E::CBREGISTERED &&
       stream_->getReadPtr().lsn <= read_ptr.lsn) {
     // Update the read pointer here to account for skipped records.
@@ -1772,6 +2017,10 @@ int CatchupOneStream::sendGAP(lsn_t end_lsn,
                               GapReason reason,
                               lsn_t start_lsn) {
   ld_check(stream_);
+  // Records held back for batching precede the gap.
+  if (flushRecords() != 0) {
+    return -1;
+  }
   if (start_lsn == LSN_INVALID) {
     start_lsn = stream_->need_to_deliver_lsn_zero_
         ? LSN_INVALID
@@ -1834,6 +2083,38 @@ int CatchupOneStream::sendGAP(lsn_t end_lsn,
   return rv;
 }
 
+ReadResultCache::Key CatchupOneStream::readResultCacheKey(
+    LocalLogStoreReader::ReadPointer read_ptr) const {
+  // Everything createReadContext() and readOnStorageThread() put into the
+  // read filter and read options that affects which records are returned.
+  std::string filter = stream_->csi_data_only_ ? "csi_data_only," : "";
+  // Storage threads strip payloads for these streams.
+  if (stream_->no_payload_) {
+    filter += "no_payload,";
+  } else if (stream_->payload_hash_only_) {
+    filter += "hash_only,";
+  }
+  if (stream_->scdEnabled()) {
+    filter += folly::sformat("scd,r{},reorder{}",
+                             stream_->replication_,
+                             static_cast<int>(stream_->scdCopysetReordering()));
+    if (stream_->scdCopysetReordering() != SCDCopysetReordering::NONE) {
+      uint64_t pt1, pt2;
+      stream_->csidHash(pt1, pt2);
+      filter += folly::sformat(",csid{}:{}", pt1, pt2);
+    }
+    filter += ",down";
+    for (ShardID shard : stream_->getKnownDown()) {
+      filter += ":" + shard.toString();
+    }
+    if (stream_->localScdEnabled()) {
+      filter += ",location:" + stream_->client_location_;
+    }
+  }
+  return ReadResultCache::Key{
+      stream_->log_id_, stream_->shard_, read_ptr.lsn, std::move(filter)};
+}
+
 LocalLogStoreReader::ReadContext
 CatchupOneStream::createReadContext(lsn_t last_released_lsn,
                                     size_t max_record_bytes_queued,
@@ -1870,6 +2151,12 @@ CatchupOneStream::createReadContext(lsn_t last_released_lsn,
                                             first_record_any_size,
                                             std::move(filter),
                                             catchup_reason);
+  const Settings& settings = deps_.getSettings();
+  if (settings.catchup_adaptive_batch_size &&
+      settings.max_record_bytes_read_at_once > 0) {
+    read_ctx.max_bytes_to_read_ =
+        stream_->batch_size_.getSize(settings.max_record_bytes_read_at_once);
+  }
 
   return read_ctx;
 }
@@ -1927,9 +2214,9 @@ int CatchupOneStream::readLastKnownGood(WeakRef<CatchupQueue> catchup_queue,
   // First, check the RecordCache. It keeps track of the lng of every unclean
   // epoch, which is exactly the information we need. (We do not need LNGs of
   // clean epochs, since the global last released LSN already covers those.)
-  if (const auto& record_cache = deps_.getLogStorageStateMap()
-                                     .get(stream.log_id_, stream.shard_)
-                                     .record_cache_) {
+  if (RecordCache* record_cache = deps_.getLogStorageStateMap()
+                                      .get(stream.log_id_, stream.shard_)
+                                      .getRecordCache()) {
     const auto cache_result = record_cache->getEpochRecordCache(epoch);
     switch (cache_result.first) {
       case RecordCache::Result::HIT:
@@ -7,7 +7,9 @@
  */
 #pragma once
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "logdevice/common/StorageTask-enums.h"
 #include "logdevice/common/WeakRefHolder.h"
@@ -16,6 +18,7 @@
 #include "logdevice/include/Err.h"
 #include "logdevice/server/read_path/LocalLogStoreReader.h"
 #include "logdevice/server/read_path/LogStorageState.h"
+#include "logdevice/server/read_path/ReadResultCache.h"
 #include "logdevice/server/read_path/ServerReadStream.h"
 
 namespace facebook { namespace logdevice {
@@ -26,6 +29,7 @@ class CatchupQueue;
 class CatchupQueueDependencies;
 class LogStorageState;
 class ReadStorageTask;
+class RECORD_Message;
 class ServerReadStream;
 enum class GapReason : uint8_t;
 
@@ -171,6 +175,8 @@ class CatchupOneStream {
                    ServerReadStream* stream,
                    BWAvailableCallback& resume_cb);
 
+  ~CatchupOneStream();
+
   Action startRead(WeakRef<CatchupQueue> catchup_queue,
                    bool try_non_blocking_read,
                    size_t max_record_bytes_queued,
@@ -288,6 +294,14 @@ class CatchupOneStream {
               GapReason reason,
               lsn_t provided_start_lsn = LSN_INVALID);
 
+  /**
+   * @return key under which the result of a read starting at `read_ptr` is
+   *         kept in the ReadResultCache.  Streams reading the same log with
+   *         the same read filter get the same key.
+   */
+  ReadResultCache::Key
+  readResultCacheKey(LocalLogStoreReader::ReadPointer read_ptr) const;
+
   /**
    * @return ReadContext to be passed by LocalLogStoreReader::read().
    */
@@ -323,6 +337,38 @@ class CatchupOneStream {
    */
   int sendGapFilteredOutIfNeeded(lsn_t trim_point);
 
+  /**
+   * @return maximum number of records that ReadingCallback may hold back to
+   *         send in a single MULTI_RECORD message, 1 if records should be
+   *         sent as soon as they are read. See
+   *         Settings::read_record_batch_size.
+   */
+  size_t recordBatchSize() const;
+
+  /**
+   * Holds back a RECORD message of a small record, to be sent by
+   * flushRecords() together with the records that follow it. The caller has
+   * not updated the stream for the record yet.
+   *
+   * @return 0 on success, -1 with err set if the batch was full and flushing
+   *         it failed.
+   */
+  int addPendingRecord(std::unique_ptr<RECORD_Message> msg);
+
+  /**
+   * Sends the records held back by addPendingRecord(), in a single
+   * MULTI_RECORD message if there are more than one. If that fails, rolls
+   * the stream back to the state it had before the first of them was read,
+   * so that they are read and sent again later.
+   *
+   * Must be called before sending anything else to the client and before
+   * the end of the batch.
+   *
+   * @return 0 on success or if there was nothing to send, -1 with err set
+   *         according to Sender::sendMessage() otherwise.
+   */
+  int flushRecords();
+
   CatchupQueueDependencies& deps_;
   ServerReadStream* stream_{nullptr};
   BWAvailableCallback& resume_cb_;
@@ -330,6 +376,20 @@ class CatchupOneStream {
   // Current amount of bytes we have enqueued in the output evbuffer so far.
   size_t record_bytes_queued_;
 
+  // Records held back by addPendingRecord().
+  std::vector<std::unique_ptr<RECORD_Message>> pending_records_;
+
+  // State of the stream before the first record of pending_records_ was
+  // processed, restored by flushRecords() if the records can't be sent.
+  struct PendingRecordsRollback {
+    lsn_t last_delivered_lsn;
+    lsn_t last_delivered_record;
+    LocalLogStoreReader::ReadPointer read_ptr;
+    lsn_t filtered_out_end_lsn;
+    size_t record_bytes_queued;
+  };
+  PendingRecordsRollback pending_rollback_;
+
   friend class ReadingCallback;
 };
 
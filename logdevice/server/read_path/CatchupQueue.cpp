@@ -7,6 +7,10 @@
  */
 #include "logdevice/server/read_path/CatchupQueue.h"
 
+#include <algorithm>
+#include <iterator>
+#include <tuple>
+
 #include <folly/Optional.h>
 
 #include "logdevice/common/AdminCommandTable.h"
@@ -16,6 +20,7 @@
 #include "logdevice/common/Sender.h"
 #include "logdevice/common/ShapingContainer.h"
 #include "logdevice/common/Timer.h"
+#include "logdevice/common/chrono_util.h"
 #include "logdevice/common/configuration/Configuration.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/common/protocol/Message.h"
@@ -111,12 +116,12 @@ void CatchupQueue::add(ServerReadStream& stream, CatchupQueue::PushMode mode) {
         STAT_INCR(deps_->getStatsHolder(), catchup_queue_push_delayed);
         break;
       } else {
-        // delivery latency not set, fall-through and add to queue_ directly
+        // delivery latency not set, fall-through and add to queues_ directly
       }
     }
     case PushMode::IMMEDIATE:
       stream_ld_debug(stream, "Enqueue stream in IMMEDIATE mode");
-      queue_.push_back(stream);
+      enqueue(stream);
       STAT_INCR(deps_->getStatsHolder(), catchup_queue_push_immediate);
       break;
   }
@@ -134,7 +139,7 @@ void CatchupQueue::processDelayedQueue() {
 
   auto now = std::chrono::steady_clock::now();
   while (!queue_delayed_.empty()) {
-    // Note that if a stream had just been added to queue_ before pushRecords()
+    // Note that if a stream had just been added to queues_ before pushRecords()
     // was called, it will be processed before any streams already queued in
     // queue_delayed_; it's probably not worth adding extra complexity to handle
     // this special case.
@@ -144,18 +149,87 @@ void CatchupQueue::processDelayedQueue() {
     }
 
     stream_ld_debug(*stream, "Stream with artificial latency is ready");
-    queue_.push_back(*stream);
+    ServerReadStream& ready = *stream;
     queue_delayed_.erase(stream);
-    ld_check(stream->isCatchingUp());
+    enqueue(ready);
+    ld_check(ready.isCatchingUp());
+  }
+}
+
+void CatchupQueue::enqueue(ServerReadStream& stream) {
+  const size_t tier = std::min(
+      static_cast<size_t>(stream.monitoring_tier_), NUM_TIERS - 1);
+  TierQueue& queue = queues_[tier];
+  if (queue.streams.empty()) {
+    // A tier that had nothing to send doesn't get to make up for it now:
+    // start it at the share of the least served tier that is catching up.
+    folly::Optional<uint64_t> least_served;
+    for (const TierQueue& other : queues_) {
+      if (!other.streams.empty() &&
+          (!least_served.has_value() ||
+           other.weighted_bytes < least_served.value())) {
+        least_served = other.weighted_bytes;
+      }
+    }
+    if (least_served.has_value()) {
+      queue.weighted_bytes =
+          std::max(queue.weighted_bytes, least_served.value());
+    }
+  }
+
+  stream.queued_tier_ = static_cast<MonitoringTier>(tier);
+  if (stream.reached_tail_) {
+    queue.streams.push_front(stream);
+  } else {
+    queue.streams.push_back(stream);
+  }
+}
+
+size_t CatchupQueue::queueSize() const {
+  size_t size = 0;
+  for (const TierQueue& queue : queues_) {
+    size += queue.streams.size();
+  }
+  return size;
+}
+
+bool CatchupQueue::queueEmpty() const {
+  for (const TierQueue& queue : queues_) {
+    if (!queue.streams.empty()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void CatchupQueue::chargeTier(const ServerReadStream& stream, size_t bytes) {
+  if (bytes == 0) {
+    return;
+  }
+  const size_t tier = static_cast<size_t>(stream.queued_tier_);
+  queues_[tier].weighted_bytes += bytes * TIER_WEIGHTS[0] / TIER_WEIGHTS[tier];
+  switch (stream.queued_tier_) {
+    case MonitoringTier::HIGH_PRI:
+      STAT_ADD(deps_->getStatsHolder(), catchup_queue_bytes_high_pri, bytes);
+      break;
+    case MonitoringTier::MEDIUM_PRI:
+      STAT_ADD(deps_->getStatsHolder(), catchup_queue_bytes_medium_pri, bytes);
+      break;
+    case MonitoringTier::LOW_PRI:
+    case MonitoringTier::MAX:
+      STAT_ADD(deps_->getStatsHolder(), catchup_queue_bytes_low_pri, bytes);
+      break;
   }
 }
 
 void CatchupQueue::pushRecords(CatchupEventTrigger catchup_reason) {
   catchup_queue_ld_debug("Pushing records");
   // The current implementation goes through active read streams for the
-  // client in round-robin fashion and tries to push a batch of records from
-  // each into the socket.  This proceeds until we hit a limit on the number
-  // of RECORD bytes we are willing to buffer in the output evbuffer.
+  // client and tries to push a batch of records from each into the socket.
+  // Each step picks the tier that got the smallest weighted share of bytes
+  // so far, and the next stream of that tier in round-robin order.  This
+  // proceeds until we hit a limit on the number of RECORD bytes we are
+  // willing to buffer in the output evbuffer.
   //
   // When the socket fills up and there is no room for the next record in
   // line, we yield until there is enough space for it in a subsequent call.
@@ -175,7 +249,7 @@ void CatchupQueue::pushRecords(CatchupEventTrigger catchup_reason) {
 
   processDelayedQueue();
 
-  if (queue_.empty()) {
+  if (queueEmpty()) {
     // use ping timer to make sure that we eventually process read streams in
     // queue_delayed_
     adjustPingTimer();
@@ -193,27 +267,66 @@ void CatchupQueue::pushRecords(CatchupEventTrigger catchup_reason) {
   // indefinitely.
   static constexpr size_t max_iterations = 30;
 
-  auto next_from_queue = queue_.begin();
+  // If nothing is in flight, new storage tasks may be issued by this call.
+  // With batching enabled, up to `max_new_storage_tasks` of them are
+  // collected and sent together once the loop is done.  Each of them may read
+  // at most its share of the remaining byte budget so that we don't queue
+  // more than max_record_bytes_queued when they all come back.
+  const size_t batch_size =
+      std::max<size_t>(1, deps_->getSettings().multi_log_read_batch_size);
+  const size_t max_new_storage_tasks =
+      storage_tasks_in_flight_ == 0 ? batch_size : 0;
+  const size_t storage_task_max_bytes =
+      record_bytes_queued_ < max_record_bytes_queued
+      ? (max_record_bytes_queued - record_bytes_queued_) / batch_size
+      : 0;
+  const bool batch_storage_tasks = max_new_storage_tasks > 1;
+  if (batch_storage_tasks) {
+    deps_->beginStorageTaskBatch();
+  }
+
+  std::array<StreamQueue::iterator, NUM_TIERS> next_from_queue;
+  for (size_t tier = 0; tier < NUM_TIERS; ++tier) {
+    next_from_queue[tier] = queues_[tier].streams.begin();
+  }
+  // Returns the tier to take the next stream from, or NUM_TIERS if all
+  // queues were gone through.
+  auto next_tier = [&] {
+    size_t best = NUM_TIERS;
+    for (size_t tier = 0; tier < NUM_TIERS; ++tier) {
+      if (next_from_queue[tier] != queues_[tier].streams.end() &&
+          (best == NUM_TIERS ||
+           queues_[tier].weighted_bytes < queues_[best].weighted_bytes)) {
+        best = tier;
+      }
+    }
+    return best;
+  };
+
   size_t storage_task_count = 0;
-  for (size_t i = 0; i < max_iterations && next_from_queue != queue_.end() &&
+  for (size_t i = 0; i < max_iterations &&
        record_bytes_queued_ < max_record_bytes_queued;
        ++i) {
-    auto stream = next_from_queue;
-    ++next_from_queue;
+    const size_t tier = next_tier();
+    if (tier == NUM_TIERS) {
+      break;
+    }
+    StreamQueue& queue = queues_[tier].streams;
+    auto stream = next_from_queue[tier];
+    ++next_from_queue[tier];
 
     if (stream->storage_task_in_flight_) {
       // If this stream has a storage task in flight, the catchup queue should
       // also be aware of it.
-      if (!storage_task_in_flight_) {
+      if (storage_tasks_in_flight_ == 0) {
         ld_critical("Although stream %" PRIu64 " of client %s for log:%lu has "
                     "a storage task in flight, the catchup queue doesn't know "
                     "it.",
                     stream->id_.val(),
                     Sender::describeConnection(client_id_).c_str(),
                     stream->log_id_.val());
-        ld_check(storage_task_in_flight_);
+        ld_check_gt(storage_tasks_in_flight_, 0);
       }
-      storage_task_count++;
       continue;
     }
 
@@ -251,22 +364,29 @@ void CatchupQueue::pushRecords(CatchupEventTrigger catchup_reason) {
     size_t n_bytes_queued;
     bool try_non_blocking_read =
         try_non_blocking_read_ && deps_->getSettings().allow_reads_on_workers;
+    const bool allow_storage_task = storage_task_count < max_new_storage_tasks;
+    size_t max_bytes = max_record_bytes_queued - record_bytes_queued_;
+    if (batch_storage_tasks && allow_storage_task) {
+      max_bytes =
+          std::max<size_t>(1, std::min(max_bytes, storage_task_max_bytes));
+    }
     std::tie(act, n_bytes_queued) =
         CatchupOneStream::read(*deps_,
                                &*stream,
                                ref_holder_.ref(),
                                try_non_blocking_read,
-                               max_record_bytes_queued - record_bytes_queued_,
+                               max_bytes,
                                record_bytes_queued_ == 0,
-                               !storage_task_in_flight_,
+                               allow_storage_task,
                                catchup_reason);
     record_bytes_queued_ += n_bytes_queued;
+    chargeTier(*stream, n_bytes_queued);
 
-    // Note: storage_task_in_flight_ is NOT updated in the above call to
+    // Note: storage_tasks_in_flight_ is NOT updated in the above call to
     // CatchupOneStream::read(), but stream->storage_task_in_flight_ is.  Also,
-    // storage_task_in_flight_ is true if ANY stream managed by this CatcupQueue
-    // has a task in flight.
-    if (storage_task_in_flight_) {
+    // storage_tasks_in_flight_ counts tasks of ALL streams managed by this
+    // CatchupQueue.
+    if (storage_tasks_in_flight_ > 0) {
       if (n_bytes_queued > 0) {
         STAT_ADD(deps_->getStatsHolder(),
                  bytes_queued_during_storage_task,
@@ -279,8 +399,8 @@ void CatchupQueue::pushRecords(CatchupEventTrigger catchup_reason) {
     if (act == CatchupOneStream::Action::WAIT_FOR_STORAGE_TASK ||
         act == CatchupOneStream::Action::WAIT_FOR_LNG) {
       ld_check(stream->storage_task_in_flight_);
-      ld_check(!storage_task_in_flight_);
-      storage_task_in_flight_ = true;
+      ld_check(allow_storage_task);
+      storage_tasks_in_flight_++;
       storage_task_count++;
     } else {
       ld_check(!stream->storage_task_in_flight_);
@@ -317,7 +437,8 @@ void CatchupQueue::pushRecords(CatchupEventTrigger catchup_reason) {
     } else if (act == CatchupOneStream::Action::DEQUEUE_AND_CONTINUE) {
       // There are no more records to deliver right now. The stream may be added
       // back to the queue later when we determine there is more to send.
-      queue_.erase(stream);
+      stream->reached_tail_ = true;
+      queue.erase(stream);
       ld_check(!stream->isCatchingUp());
       stream->adjustStatWhenCatchingUpChanged();
     } else if (act == CatchupOneStream::Action::ERASE_AND_CONTINUE) {
@@ -325,24 +446,26 @@ void CatchupQueue::pushRecords(CatchupEventTrigger catchup_reason) {
       // This also removes the stream from the queue since we are using
       // folly::IntrusiveList.
       deps_->eraseStream(client_id_, log_id, read_stream_id, stream->shard_);
-      stream = queue_.end();
+      stream = queue.end();
     } else if (act == CatchupOneStream::Action::PERMANENT_ERROR) {
       if (notifyShardError(&*stream) == 0) {
         deps_->eraseStream(client_id_, log_id, read_stream_id, stream->shard_);
-        stream = queue_.end();
+        stream = queue.end();
       }
     } else if (act == CatchupOneStream::Action::WOULDBLOCK) {
       // We can only get here if we disallowed blocking I/O, which we only do
-      // when we already have a storage task in flight.
-      ld_check(storage_task_in_flight_);
+      // when we already have as many storage tasks in flight as we allow.
+      ld_check_gt(storage_tasks_in_flight_, 0);
       // To make progress on this stream, we'd have to do a blocking read.  So,
       // just continue to the next stream.
     } else {
       ld_check(act == CatchupOneStream::Action::REQUEUE_AND_DRAIN ||
                act == CatchupOneStream::Action::REQUEUE_AND_CONTINUE);
-      // Move the stream to the end of the queue.
-      queue_.erase(stream);
-      queue_.push_back(*stream);
+      // Move the stream to the end of the queue. It has more to read than
+      // one batch, so it no longer counts as reading near the tail.
+      stream->reached_tail_ = false;
+      queue.erase(stream);
+      queue.push_back(*stream);
       ld_check(stream->isCatchingUp());
 
       if (act == CatchupOneStream::Action::REQUEUE_AND_DRAIN) {
@@ -353,11 +476,17 @@ void CatchupQueue::pushRecords(CatchupEventTrigger catchup_reason) {
     }
   }
 
-  if (storage_task_count > 1) {
-    ld_critical("The catchup queue of client %s started more than one storage "
-                "task.",
-                Sender::describeConnection(client_id_).c_str());
-    ld_check_le(storage_task_count, 1);
+  if (batch_storage_tasks) {
+    deps_->flushStorageTaskBatch();
+  }
+
+  if (storage_task_count > max_new_storage_tasks) {
+    ld_critical("The catchup queue of client %s started %zu storage tasks, "
+                "more than the allowed %zu.",
+                Sender::describeConnection(client_id_).c_str(),
+                storage_task_count,
+                max_new_storage_tasks);
+    ld_check_le(storage_task_count, max_new_storage_tasks);
   }
 
   // Depending on the outcome of the above loop, under certain error
@@ -437,6 +566,16 @@ void CatchupQueue::onRecordSent(const RECORD_Message& msg,
     // Stream has been reaped. Nothing to validate.
     return;
   }
+  stream->record_bytes_sent_ += msg_size;
+  ++stream->records_sent_;
+  CLIENT_RESOURCE_ADD(deps_->getStatsHolder(),
+                      read_bytes,
+                      deps_->getPrincipal(client_id_),
+                      msg_size);
+  CLIENT_RESOURCE_ADD(deps_->getStatsHolder(),
+                      records_read,
+                      deps_->getPrincipal(client_id_),
+                      1);
 
   // Handle the case of a stream rewind after we hit until lsn and
   // destroyed the ServerReadStream object.
@@ -668,6 +807,7 @@ bool CatchupQueueDependencies::canIssueReadIO(
     lock.unlock();
     err = E::CBREGISTERED;
     stream->markThrottled(true);
+    ServerWorker::onThisThread()->processor_->noteReadIoThrottled();
     STAT_INCR(getStatsHolder(), read_throttling_num_reads_throttled);
     ld_spew("Throttled: log:%lu, cb:%p", logid.val_, &on_bw_avail);
     return false;
@@ -685,6 +825,14 @@ void CatchupQueueDependencies::used(logid_t logid) {
   all_server_read_streams_->used(logid);
 }
 
+void CatchupQueueDependencies::noteRealTimeDemand(logid_t logid) {
+  all_server_read_streams_->noteRealTimeDemand(logid);
+}
+
+ReadResultCache& CatchupQueueDependencies::getReadResultCache() {
+  return all_server_read_streams_->getReadResultCache();
+}
+
 void CatchupQueueDependencies::invalidateIterators(ClientID client_id) {
   all_server_read_streams_->invalidateIterators(client_id);
 }
@@ -725,9 +873,51 @@ CatchupQueueDependencies::createIteratorTimer(std::function<void()> callback) {
 void CatchupQueueDependencies::putStorageTask(
     std::unique_ptr<ReadStorageTask>&& task,
     shard_index_t shard) {
+  if (batching_storage_tasks_) {
+    batched_storage_tasks_.emplace_back(shard, std::move(task));
+    return;
+  }
   all_server_read_streams_->putStorageTask(std::move(task), shard);
 }
 
+void CatchupQueueDependencies::beginStorageTaskBatch() {
+  ld_check(!batching_storage_tasks_);
+  ld_check(batched_storage_tasks_.empty());
+  batching_storage_tasks_ = true;
+}
+
+void CatchupQueueDependencies::flushStorageTaskBatch() {
+  ld_check(batching_storage_tasks_);
+  batching_storage_tasks_ = false;
+  auto tasks = std::move(batched_storage_tasks_);
+  batched_storage_tasks_.clear();
+
+  // Tasks of different types have different priorities and thread types, so
+  // they can't share a MultiLogReadStorageTask.  Batches are small, a linear
+  // scan for the group is fine.
+  using Group = std::tuple<shard_index_t,
+                           StorageTaskType,
+                           std::vector<std::unique_ptr<ReadStorageTask>>>;
+  std::vector<Group> groups;
+  for (auto& shard_and_task : tasks) {
+    const shard_index_t shard = shard_and_task.first;
+    const StorageTaskType type = shard_and_task.second->getType();
+    auto group = std::find_if(groups.begin(), groups.end(), [&](Group& g) {
+      return std::get<0>(g) == shard && std::get<1>(g) == type;
+    });
+    if (group == groups.end()) {
+      groups.emplace_back(
+          shard, type, std::vector<std::unique_ptr<ReadStorageTask>>());
+      group = std::prev(groups.end());
+    }
+    std::get<2>(*group).push_back(std::move(shard_and_task.second));
+  }
+  for (auto& group : groups) {
+    all_server_read_streams_->putStorageTasks(
+        std::move(std::get<2>(group)), std::get<0>(group));
+  }
+}
+
 Status
 CatchupQueueDependencies::read(LocalLogStore::ReadIterator* read_iterator,
                                LocalLogStoreReader::Callback& callback,
@@ -773,6 +963,11 @@ size_t CatchupQueueDependencies::getMaxRecordBytesQueued(ClientID client) {
   return max_record_bytes_queued;
 }
 
+const PrincipalIdentity*
+CatchupQueueDependencies::getPrincipal(ClientID client) {
+  return Worker::onThisThread()->sender().getPrincipal(Address(client));
+}
+
 const Settings& CatchupQueueDependencies::getSettings() const {
   return Worker::settings();
 }
@@ -842,11 +1037,19 @@ void CatchupQueue::onReadTaskDone(const ReadStorageTask& task) {
           error_description(task.status_));
   STAT_ADD(
       deps_->getStatsHolder(), num_bytes_read_via_read_task, task.total_bytes_);
+  if (task.execution_start_time_ && task.execution_end_time_) {
+    CLIENT_RESOURCE_ADD(deps_->getStatsHolder(),
+                        storage_task_usec,
+                        deps_->getPrincipal(client_id_),
+                        to_usec(task.execution_end_time_.value() -
+                                task.execution_start_time_.value())
+                            .count());
+  }
 
   // Call to readThrottlingOnReadTaskDone() should remain at the top to give
   // preference to read streams that were already queued for read i/o
   // Until onStorageTaskStopped() is called, no more read storage tasks can
-  // be issued because storage_task_in_flight_ will remain true.
+  // be issued because storage_tasks_in_flight_ will remain positive.
   readThrottlingOnReadTaskDone(task);
 
   // We may be waiting for bandwidth due to attempts to process another
@@ -870,13 +1073,18 @@ void CatchupQueue::onReadTaskDone(const ReadStorageTask& task) {
     return;
   }
 
-  ld_check(stream == &queue_.front());
+  // With batching, other streams of this queue may also have a task in flight
+  // so the stream isn't necessarily at the front of the queue.
+  ld_check(stream->queue_hook_.is_linked());
+  StreamQueue& queue = queueOf(*stream);
+  auto it = queue.iterator_to(*stream);
 
   size_t n_bytes_queued;
   CatchupOneStream::Action act;
   std::tie(act, n_bytes_queued) =
       CatchupOneStream::onReadTaskDone(*deps_, stream, task);
   record_bytes_queued_ += n_bytes_queued;
+  chargeTier(*stream, n_bytes_queued);
 
   onBatchComplete(stream);
 
@@ -901,7 +1109,8 @@ void CatchupQueue::onReadTaskDone(const ReadStorageTask& task) {
   }
 
   if (act == CatchupOneStream::Action::DEQUEUE_AND_CONTINUE) {
-    queue_.pop_front();
+    stream->reached_tail_ = true;
+    queue.erase(it);
     ld_check(!stream->isCatchingUp());
     stream->adjustStatWhenCatchingUpChanged();
   } else if (act == CatchupOneStream::Action::ERASE_AND_CONTINUE) {
@@ -921,8 +1130,9 @@ void CatchupQueue::onReadTaskDone(const ReadStorageTask& task) {
     ld_check(act == CatchupOneStream::Action::REQUEUE_AND_DRAIN ||
              act == CatchupOneStream::Action::REQUEUE_AND_CONTINUE);
     // Move to the end of the queue.
-    queue_.pop_front();
-    queue_.push_back(*stream);
+    stream->reached_tail_ = false;
+    queue.erase(it);
+    queue.push_back(*stream);
     ld_check(stream->isCatchingUp());
   }
 
@@ -932,18 +1142,15 @@ void CatchupQueue::onReadTaskDone(const ReadStorageTask& task) {
   }
 }
 
-void CatchupQueue::onStorageTaskStopped(const ServerReadStream* stream) {
-  ld_check(storage_task_in_flight_);
-  storage_task_in_flight_ = false;
+void CatchupQueue::onStorageTaskStopped(ServerReadStream* stream) {
+  ld_check_gt(storage_tasks_in_flight_, 0);
+  storage_tasks_in_flight_--;
 
   if (stream != nullptr) {
-    // If the ServerReadStream still exists, it should be at the top of the
-    // queue.
-    ld_check(!queue_.empty());
-    ServerReadStream* queue_stream = &queue_.front();
-    ld_check_eq(stream, queue_stream);
-    ld_check(queue_stream->storage_task_in_flight_);
-    queue_stream->storage_task_in_flight_ = false;
+    // If the ServerReadStream still exists, it should still be in the queue.
+    ld_check(stream->queue_hook_.is_linked());
+    ld_check(stream->storage_task_in_flight_);
+    stream->storage_task_in_flight_ = false;
   } else {
     catchup_queue_ld_debug("Stream was erased while task was in flight");
   }
@@ -955,8 +1162,8 @@ void CatchupQueue::adjustPingTimer() {
   // there is still work to do, then we need to activate the timer to retry
   // later.
   if (record_bytes_queued_ == 0 && !resume_cb_.active() &&
-      !storage_task_in_flight_ &&
-      (!queue_.empty() || !queue_delayed_.empty())) {
+      storage_tasks_in_flight_ == 0 &&
+      (!queueEmpty() || !queue_delayed_.empty())) {
     STAT_INCR(deps_->getStatsHolder(), read_streams_transient_errors);
     catchup_queue_ld_debug("Activate ping timer with timeout=%lu",
                            ping_timer_->getNextDelay().count());
@@ -998,11 +1205,11 @@ void CatchupQueue::onBatchComplete(ServerReadStream* stream) {
 void CatchupQueue::getDebugInfo(InfoCatchupQueuesTable& table) {
   table.next()
       .set<0>(client_id_)
-      .set<1>(queue_.size() + queue_delayed_.size())
-      .set<2>(queue_.size())
+      .set<1>(queueSize() + queue_delayed_.size())
+      .set<2>(queueSize())
       .set<3>(queue_delayed_.size())
       .set<4>(record_bytes_queued_)
-      .set<5>(storage_task_in_flight_)
+      .set<5>(storage_tasks_in_flight_ > 0)
       .set<6>(ping_timer_->isActive())
       .set<7>(blocked_);
 }
@@ -7,12 +7,14 @@
  */
 #pragma once
 
+#include <array>
 #include <chrono>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include <boost/intrusive/set.hpp>
 #include <folly/IntrusiveList.h>
@@ -42,6 +44,11 @@ namespace facebook { namespace logdevice {
  *       records in a fair and efficient manner.  This is not trivial --
  *       imagine a client subscribing to many logs with significant backlogs
  *       of records.
+ *
+ *       Streams are queued per SLO class (monitoring tier of the reader).
+ *       Classes share the bytes queued to the client in proportion to
+ *       TIER_WEIGHTS, and within a class streams are served round-robin,
+ *       except that streams reading near the tail of their log go first.
  */
 
 class AllServerReadStreams;
@@ -50,7 +57,9 @@ class CatchupQueue;
 class Timer;
 class LogStorageStateMap;
 class ReadIoShapingCallback;
+class ReadResultCache;
 class ReadStorageTask;
+struct PrincipalIdentity;
 class RECORD_Message;
 class SenderBase;
 class SenderProxy;
@@ -91,6 +100,16 @@ class CatchupQueueDependencies {
    */
   virtual void used(logid_t logid);
 
+  /**
+   * Proxy for AllServerReadStreams::noteRealTimeDemand().
+   */
+  virtual void noteRealTimeDemand(logid_t logid);
+
+  /**
+   * Proxy for AllServerReadStreams::getReadResultCache().
+   */
+  virtual ReadResultCache& getReadResultCache();
+
   /**
    * If specified in the configuration for a log, return how much is allowed to
    * artificially delay delivery of newly released records in order to improve
@@ -135,6 +154,15 @@ class CatchupQueueDependencies {
   virtual void putStorageTask(std::unique_ptr<ReadStorageTask>&& task,
                               shard_index_t shard);
 
+  /**
+   * Between these two calls, putStorageTask() holds on to tasks instead of
+   * sending them. flushStorageTaskBatch() then hands them to
+   * AllServerReadStreams grouped by shard and task type, so that reads of
+   * several logs can share a single MultiLogReadStorageTask.
+   */
+  void beginStorageTaskBatch();
+  void flushStorageTaskBatch();
+
   /**
    * Proxy for Processor::getLogStorageStateMap().
    */
@@ -156,6 +184,12 @@ class CatchupQueueDependencies {
    */
   virtual size_t getMaxRecordBytesQueued(ClientID client);
 
+  /**
+   * Principal of the client's connection, or nullptr if unknown. Used to
+   * charge the client's reads in per-client resource stats.
+   */
+  virtual const PrincipalIdentity* getPrincipal(ClientID client);
+
   /**
    * Checks with underlying FlowGroup's(corresponding to stream's priority)
    * FlowMeter if sufficient bandwidth exists to allow a read storage task.
@@ -171,6 +205,11 @@ class CatchupQueueDependencies {
  private:
   AllServerReadStreams* all_server_read_streams_;
   StatsHolder* stats_holder_;
+
+  // Tasks collected by putStorageTask() while a batch is open.
+  bool batching_storage_tasks_ = false;
+  std::vector<std::pair<shard_index_t, std::unique_ptr<ReadStorageTask>>>
+      batched_storage_tasks_;
 };
 
 class CatchupQueue {
@@ -277,6 +316,11 @@ class CatchupQueue {
 
   void blockUnBlock(bool block);
 
+  // Relative share of the bytes sent to the client that streams of each
+  // MonitoringTier get when streams of several tiers are catching up.
+  static constexpr size_t NUM_TIERS = static_cast<size_t>(MonitoringTier::MAX);
+  static constexpr std::array<uint64_t, NUM_TIERS> TIER_WEIGHTS{{8, 4, 1}};
+
   const ClientID client_id_;
 
   WeakRefHolder<CatchupQueue> ref_holder_;
@@ -286,9 +330,19 @@ class CatchupQueue {
 
   std::unique_ptr<CatchupQueueDependencies> deps_;
 
-  // Queue containing read streams inserted with PushMode::IMMEDIATE. Processed
-  // immediately by pushRecords().
-  folly::IntrusiveList<ServerReadStream, &ServerReadStream::queue_hook_> queue_;
+  using StreamQueue =
+      folly::IntrusiveList<ServerReadStream, &ServerReadStream::queue_hook_>;
+
+  struct TierQueue {
+    StreamQueue streams;
+    // Record bytes queued for streams of the tier, divided by the tier's
+    // weight. pushRecords() serves the tier with the lowest value first.
+    uint64_t weighted_bytes{0};
+  };
+
+  // Queues containing read streams inserted with PushMode::IMMEDIATE, one per
+  // MonitoringTier. Processed immediately by pushRecords().
+  std::array<TierQueue, NUM_TIERS> queues_;
 
   // If true, processing of this CatchupQueue has been blocked by the `block
   // catchup_queue` admin command.
@@ -321,9 +375,11 @@ class CatchupQueue {
   // network.
   size_t record_bytes_queued_ = 0;
 
-  // Is there a storage task in flight for this catchup queue?  We only allow
-  // one at a time.
-  bool storage_task_in_flight_ = false;
+  // Number of storage tasks in flight for this catchup queue, at most one per
+  // stream.  Unless Settings::multi_log_read_batch_size is greater than 1,
+  // we only allow one at a time.  Otherwise, pushRecords() issues up to that
+  // many tasks together, and only when none are in flight.
+  size_t storage_tasks_in_flight_ = 0;
 
   // If true, try a non-blocking read on the worker thread before involving a
   // storage thread.  This is only disabled in tests.
@@ -342,15 +398,33 @@ class CatchupQueue {
 
   /**
    * Helper method used in pushRecords(). Moves all streams from queue_delayed_
-   * scheduled for reading to the end of queue_.
+   * scheduled for reading to queues_.
    */
   void processDelayedQueue();
 
+  /**
+   * Adds the stream to the queue of its tier: at the front if it's reading
+   * near the tail, at the back otherwise.
+   */
+  void enqueue(ServerReadStream& stream);
+
+  StreamQueue& queueOf(const ServerReadStream& stream) {
+    return queues_[static_cast<size_t>(stream.queued_tier_)].streams;
+  }
+
+  size_t queueSize() const;
+  bool queueEmpty() const;
+
+  /**
+   * Accounts record bytes queued for the stream to its tier.
+   */
+  void chargeTier(const ServerReadStream& stream, size_t bytes);
+
   void adjustPingTimer();
 
   void onBatchComplete(ServerReadStream* stream);
 
-  void onStorageTaskStopped(const ServerReadStream* stream);
+  void onStorageTaskStopped(ServerReadStream* stream);
 
   /**
    * Handle Read Throttling related credits and stats,
@@ -18,8 +18,9 @@ namespace facebook { namespace logdevice {
 std::shared_ptr<LocalLogStore::ReadIterator>
 IteratorCache::createOrGet(const LocalLogStore::ReadOptions& options) {
   auto& wrapper = getWrapper(options);
-  if (!wrapper.iterator) {
+  if (!wrapper.iterator || wrapper.readahead_size != options.readahead_size) {
     wrapper.iterator = store_->read(log_id_, options);
+    wrapper.readahead_size = options.readahead_size;
   } else {
     wrapper.iterator->setContextString(options.tracking_ctx.more_context);
   }
@@ -29,13 +30,16 @@ IteratorCache::createOrGet(const LocalLogStore::ReadOptions& options) {
 }
 
 bool IteratorCache::valid(const LocalLogStore::ReadOptions& options) {
-  return getWrapper(options).iterator != nullptr;
+  auto& wrapper = getWrapper(options);
+  return wrapper.iterator != nullptr &&
+      wrapper.readahead_size == options.readahead_size;
 }
 
 void IteratorCache::set(const LocalLogStore::ReadOptions& options,
                         std::shared_ptr<LocalLogStore::ReadIterator> iter) {
   auto& wrapper = getWrapper(options);
   wrapper.iterator = iter;
+  wrapper.readahead_size = options.readahead_size;
   wrapper.last_used = std::chrono::steady_clock::now();
 }
 
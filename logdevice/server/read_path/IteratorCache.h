@@ -47,7 +47,10 @@ class IteratorCache {
   createOrGet(const LocalLogStore::ReadOptions&);
 
   /**
-   * @return  true if a valid iterator exists for the specified ReadOptions
+   * @return  true if a valid iterator exists for the specified ReadOptions.
+   *          A cached iterator created with a different readahead_size
+   *          doesn't count: read-ahead is fixed at creation, so the stream
+   *          needs a new one when its access pattern changes.
    */
   bool valid(const LocalLogStore::ReadOptions&);
 
@@ -83,6 +86,9 @@ class IteratorCache {
     // reference to the iterator.
     std::shared_ptr<LocalLogStore::ReadIterator> iterator;
 
+    // ReadOptions::readahead_size the iterator was created with.
+    size_t readahead_size{0};
+
     std::chrono::steady_clock::time_point last_used;
   };
 
@@ -22,7 +22,38 @@
 #include "logdevice/common/util.h"
 #include "logdevice/server/read_path/IteratorCache.h"
 
-namespace facebook { namespace logdevice { namespace LocalLogStoreReader {
+namespace facebook { namespace logdevice {
+
+PayloadHolder RawRecord::sharePayload(const Payload& payload) const {
+  if (!shareable() || payload.size() == 0) {
+    return PayloadHolder::copyPayload(payload);
+  }
+  const char* begin = static_cast<const char*>(payload.data());
+  const char* blob_begin = reinterpret_cast<const char*>(buf_.data());
+  if (begin < blob_begin ||
+      begin + payload.size() > blob_begin + buf_.length()) {
+    ld_check(false);
+    return PayloadHolder::copyPayload(payload);
+  }
+  // Shares the underlying buffer, only the refcount is incremented.
+  folly::IOBuf shared = buf_.cloneOneAsValue();
+  shared.trimStart(begin - blob_begin);
+  shared.trimEnd(shared.length() - payload.size());
+  return PayloadHolder(std::move(shared));
+}
+
+RawRecord RawRecord::share() const {
+  RawRecord res = shareable()
+      ? RawRecord(lsn, buf_.cloneOneAsValue(), from_under_replicated_region)
+      : RawRecord(
+            lsn,
+            folly::IOBuf(folly::IOBuf::COPY_BUFFER, blob.data, blob.size),
+            from_under_replicated_region);
+  res.payload_hash_only = payload_hash_only;
+  return res;
+}
+
+namespace LocalLogStoreReader {
 
 static Status maybeSendRecord(LocalLogStore::ReadIterator& read_iterator,
                               Callback& callback,
@@ -68,6 +99,10 @@ Status readImpl(LocalLogStore::ReadIterator& read_iterator,
       settings.max_record_bytes_read_at_once < 0
       ? std::numeric_limits<size_t>::max()
       : static_cast<size_t>(settings.max_record_bytes_read_at_once);
+  if (read_ctx->max_bytes_to_read_ > 0) {
+    read_ctx->it_stats_.max_bytes_to_read = std::min(
+        read_ctx->it_stats_.max_bytes_to_read, read_ctx->max_bytes_to_read_);
+  }
   read_ctx->it_stats_.stop_reading_after.first = read_ctx->logid_;
   read_ctx->it_stats_.stop_reading_after.second =
       std::min(std::min(read_ctx->until_lsn_, read_ctx->last_released_lsn_),
@@ -365,21 +400,17 @@ int getLastKnownGood(LocalLogStore::ReadIterator& iterator,
     err = E::NOTFOUND;
     return -1;
   }
-  int rv = LocalLogStoreRecordFormat::parse(iterator.getRecord(),
-                                            last_record_timestamp_out,
-                                            lng_out,
-                                            nullptr,
-                                            nullptr,
-                                            nullptr,
-                                            nullptr,
-                                            0,
-                                            nullptr,
-                                            nullptr,
-                                            nullptr,
-                                            -1 /* unused */);
+  LocalLogStoreRecordFormat::RecordView record;
+  int rv = record.init(iterator.getRecord());
   if (rv != 0) {
     return -1;
   }
+  if (last_record_timestamp_out != nullptr) {
+    *last_record_timestamp_out = record.timestamp();
+  }
+  if (lng_out != nullptr) {
+    *lng_out = record.lastKnownGood();
+  }
   if (last_record_out != nullptr) {
     *last_record_out = lsn_to_esn(iterator.getLSN());
   }
@@ -445,31 +476,26 @@ int getTailRecord(LocalLogStore::ReadIterator& iterator,
     return -1;
   }
 
-  std::chrono::milliseconds timestamp;
-  LocalLogStoreRecordFormat::flags_t record_flags;
+  LocalLogStoreRecordFormat::RecordView record;
   Payload payload;
 
   // if the tail record does not have byte offset included, use
   // BYTE_OFFSET_INVALID
   OffsetMap offsets_within_epoch;
 
-  int rv =
-      LocalLogStoreRecordFormat::parse(iterator.getRecord(),
-                                       &timestamp,
-                                       nullptr,
-                                       &record_flags,
-                                       nullptr,
-                                       nullptr,
-                                       nullptr,
-                                       0,
-                                       &offsets_within_epoch,
-                                       nullptr,
-                                       include_payload ? &payload : nullptr,
-                                       -1 /* unused */);
+  int rv = record.init(iterator.getRecord());
+  if (rv == 0) {
+    rv = record.offsetsWithinEpoch(&offsets_within_epoch);
+  }
+  if (rv == 0 && include_payload) {
+    rv = record.payload(&payload);
+  }
   if (rv != 0) {
     ld_check(err == E::MALFORMED_RECORD);
     return -1;
   }
+  const std::chrono::milliseconds timestamp = record.timestamp();
+  const LocalLogStoreRecordFormat::flags_t record_flags = record.flags();
 
   if (record_flags & STORE_Header::HOLE) {
     RATELIMIT_ERROR(
@@ -488,8 +514,17 @@ int getTailRecord(LocalLogStore::ReadIterator& iterator,
   }
   PayloadHolder ph;
   if (include_payload) {
-    // make a private copy so that payload can be owned by the PayloadHolder
-    ph = PayloadHolder::copyPayload(payload);
+    if (record_flags & LocalLogStoreRecordFormat::FLAG_PAYLOAD_COMPRESSED) {
+      folly::IOBuf uncompressed;
+      if (LocalLogStoreRecordFormat::uncompressPayload(
+              payload, &uncompressed) != 0) {
+        return -1;
+      }
+      ph = PayloadHolder(std::move(uncompressed));
+    } else {
+      // make a private copy so that payload can be owned by the PayloadHolder
+      ph = PayloadHolder::copyPayload(payload);
+    }
     flags |= TailRecordHeader::HAS_PAYLOAD;
     flags |= (record_flags &
               (TailRecordHeader::CHECKSUM | TailRecordHeader::CHECKSUM_64BIT |
@@ -12,9 +12,11 @@
 #include <cstdlib>
 
 #include <boost/noncopyable.hpp>
+#include <folly/io/IOBuf.h>
 
 #include "logdevice/common/CopySet.h"
 #include "logdevice/common/LocalLogStoreRecordFormat.h"
+#include "logdevice/common/PayloadHolder.h"
 #include "logdevice/common/SCDCopysetReordering.h"
 #include "logdevice/common/TailRecord.h"
 #include "logdevice/common/settings/Settings.h"
@@ -61,21 +63,70 @@ class RawRecord : boost::noncopyable {
     }
   }
 
+  /**
+   * Creates a record whose blob is held by a refcounted buffer. Payloads of
+   * such records can be handed to outgoing messages without copying, see
+   * sharePayload().
+   */
+  RawRecord(lsn_t lsn,
+            folly::IOBuf buf,
+            bool from_under_replicated_region = false)
+      : lsn(lsn),
+        blob(buf.data(), buf.length()),
+        owned(false),
+        from_under_replicated_region(from_under_replicated_region),
+        buf_(std::move(buf)) {}
+
   RawRecord(RawRecord&& other) noexcept
       : lsn(other.lsn),
         blob(other.blob),
         owned(other.owned),
-        from_under_replicated_region(other.from_under_replicated_region) {
+        from_under_replicated_region(other.from_under_replicated_region),
+        payload_hash_only(other.payload_hash_only),
+        buf_(std::move(other.buf_)) {
     other.lsn = LSN_INVALID;
     other.blob = Slice();
     other.owned = false;
     other.from_under_replicated_region = false;
+    other.payload_hash_only = false;
   }
 
+  /**
+   * @return true if the blob is held by a refcounted buffer that can be
+   *         shared with outgoing messages.
+   */
+  bool shareable() const {
+    return buf_.isManaged() && !buf_.empty();
+  }
+
+  /**
+   * Makes a PayloadHolder for `payload`, which must point into this record's
+   * blob (e.g. as returned by LocalLogStoreRecordFormat::parse()). If the
+   * record is shareable(), the returned holder references the blob's buffer
+   * and keeps it alive until all messages using it are written to the socket.
+   * Otherwise the payload is copied.
+   */
+  PayloadHolder sharePayload(const Payload& payload) const;
+
+  /**
+   * @return a record with the same contents whose blob is held by a
+   *         refcounted buffer.  If this record is shareable(), the buffer is
+   *         shared, otherwise the blob is copied.
+   */
+  RawRecord share() const;
+
   lsn_t lsn;
   Slice blob;
   bool owned;
   bool from_under_replicated_region;
+  // If true, the storage thread replaced the payload (and its checksum, if
+  // any) in `blob' with the payload's length and hash, for PAYLOAD_HASH_ONLY
+  // streams. The record flags still describe the original payload.
+  bool payload_hash_only{false};
+
+ private:
+  // If non-empty, holds the memory `blob` points to.
+  folly::IOBuf buf_;
 };
 
 namespace LocalLogStoreReader {
@@ -135,6 +186,10 @@ struct ReadContext {
   // Should the first record be delivered even if it is bigger than
   // `max_bytes_to_deliver_`?
   bool first_record_any_size_;
+  // If nonzero, max amount of bytes to read from the local log store, on top
+  // of the max_record_bytes_read_at_once setting. Reaching it ends the batch
+  // with E::PARTIAL.
+  size_t max_bytes_to_read_{0};
   // Filter to be used for filtering records that should not be sent.
   std::shared_ptr<LocalLogStore::ReadFilter> lls_filter_;
   // A reason of the current catchup
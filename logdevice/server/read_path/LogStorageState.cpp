@@ -45,19 +45,61 @@ LogStorageState::LogStorageState(logid_t log_id,
                                  shard_index_t shard,
                                  LogStorageStateMap* owner,
                                  RecordCacheDependencies* cache_deps)
-    : record_cache_(
-          cache_deps != nullptr
-              ? std::make_unique<RecordCache>(log_id, shard, cache_deps)
-              : nullptr),
-      log_id_(log_id),
-      shard_(shard),
-      owner_(owner) {
-  retry_release_.timer_scheduled_ = false;
-  retry_release_.force_ = false;
-  purge_coordinator_ = std::make_unique<PurgeCoordinator>(log_id, shard, this);
+    : log_id_(log_id), shard_(shard), owner_(owner), cache_deps_(cache_deps) {}
+
+LogStorageState::~LogStorageState() {
+  delete purge_coordinator_.load();
+  delete record_cache_.load();
+  delete cold_state_.load();
 }
 
-LogStorageState::~LogStorageState() = default;
+namespace {
+
+// Stores `created` in `ptr` unless another thread got there first, in which
+// case `created` is destroyed. Returns what ended up in `ptr`.
+template <typename Base, typename T>
+Base* publish(std::atomic<Base*>& ptr, std::unique_ptr<T> created) {
+  Base* expected = nullptr;
+  if (ptr.compare_exchange_strong(expected, created.get())) {
+    return created.release();
+  }
+  return expected;
+}
+
+} // namespace
+
+LogStorageState_PurgeCoordinator_Bridge&
+LogStorageState::getPurgeCoordinator() {
+  auto coordinator = purge_coordinator_.load(std::memory_order_acquire);
+  if (coordinator == nullptr) {
+    coordinator = publish(purge_coordinator_,
+                          std::make_unique<PurgeCoordinator>(
+                              log_id_, shard_, this));
+  }
+  return *coordinator;
+}
+
+RecordCache* LogStorageState::getOrCreateRecordCache() {
+  RecordCache* cache = getRecordCache();
+  if (cache == nullptr && cache_deps_ != nullptr) {
+    cache = publish(
+        record_cache_,
+        std::make_unique<RecordCache>(log_id_, shard_, cache_deps_));
+  }
+  return cache;
+}
+
+void LogStorageState::setRecordCache(std::unique_ptr<RecordCache> cache) {
+  delete record_cache_.exchange(cache.release());
+}
+
+LogStorageState::ColdState& LogStorageState::getColdState() {
+  ColdState* state = cold_state_.load(std::memory_order_acquire);
+  if (state == nullptr) {
+    state = publish(cold_state_, std::make_unique<ColdState>());
+  }
+  return *state;
+}
 
 bool LogStorageState::notePermanentError(const char* context) {
   if (!permanent_error_.exchange(true)) {
@@ -127,8 +169,38 @@ epoch_t LogStorageState::getLastCleanEpoch() const {
 
 folly::Optional<std::pair<epoch_t, OffsetMap>>
 LogStorageState::getEpochOffsetMap() const {
-  RWLock::ReadHolder read_guard(rw_lock_);
-  return latest_epoch_offsets_;
+  const ColdState* state = cold_state_.load(std::memory_order_acquire);
+  if (state == nullptr) {
+    return folly::none;
+  }
+  RWLock::ReadHolder read_guard(state->rw_lock_);
+  return state->latest_epoch_offsets_;
+}
+
+folly::Optional<std::chrono::milliseconds>
+LogStorageState::getCachedHeadTimestamp(lsn_t trim_point) const {
+  const ColdState* state = cold_state_.load(std::memory_order_acquire);
+  if (state == nullptr) {
+    return folly::none;
+  }
+  RWLock::ReadHolder read_guard(state->rw_lock_);
+  if (!state->head_timestamp_.has_value() ||
+      state->head_timestamp_->first != trim_point) {
+    return folly::none;
+  }
+  return state->head_timestamp_->second;
+}
+
+void LogStorageState::cacheHeadTimestamp(lsn_t trim_point,
+                                         std::chrono::milliseconds ts) {
+  ColdState& state = getColdState();
+  RWLock::WriteHolder write_guard(state.rw_lock_);
+  if (state.head_timestamp_.has_value() &&
+      state.head_timestamp_->first > trim_point) {
+    // Computed for an older trim point.
+    return;
+  }
+  state.head_timestamp_ = std::make_pair(trim_point, ts);
 }
 
 void LogStorageState::updateLastCleanEpoch(epoch_t epoch) {
@@ -137,7 +209,9 @@ void LogStorageState::updateLastCleanEpoch(epoch_t epoch) {
 
 void LogStorageState::updateEpochOffsetMap(
     std::pair<epoch_t, OffsetMap> epoch_offsets) {
-  RWLock::WriteHolder write_guard(rw_lock_);
+  ColdState& state = getColdState();
+  RWLock::WriteHolder write_guard(state.rw_lock_);
+  auto& latest_epoch_offsets_ = state.latest_epoch_offsets_;
   if (latest_epoch_offsets_.has_value() &&
       latest_epoch_offsets_.value().first < epoch_offsets.first) {
     // No updates needed for older epoch.
@@ -178,6 +252,7 @@ int LogStorageState::updateSeal(Seal new_seal, LogStorageState::SealType type) {
 }
 
 void LogStorageState::retryRelease(worker_id_t id, bool force) {
+  auto& retry_release_ = getColdState().retry_release_;
   std::lock_guard<std::mutex> guard(retry_release_.mutex_);
   retry_release_.failed_workers_.set(id.val_);
   retry_release_.force_ |= force;
@@ -199,6 +274,7 @@ void LogStorageState::retryRelease(worker_id_t id, bool force) {
 void LogStorageState::onRetryReleaseTimer(ExponentialBackoffTimerNode* node) {
   ld_spew("fired for log %lu", log_id_.val_);
 
+  auto& retry_release_ = getColdState().retry_release_;
   ld_check(retry_release_.timer_scheduled_);
 
   std::bitset<MAX_WORKERS> failed_workers;
@@ -406,7 +482,7 @@ void LogStorageState::getSeqStateRequestCallback(
   // Epoch offset may be available if sequencer is not under recovery and
   // LogTailAttributes were requested by setting INCLUDE_EPOCH_OFFSET flag.
   if (result.last_released_lsn != LSN_INVALID) {
-    log_state->purge_coordinator_->onReleaseMessage(
+    log_state->getPurgeCoordinator().onReleaseMessage(
         result.last_released_lsn,
         result.last_seq,
         ReleaseType::GLOBAL,
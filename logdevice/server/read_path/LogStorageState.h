@@ -32,6 +32,10 @@ namespace facebook { namespace logdevice {
  * @file
  * On storage nodes, contains state for one log that we need to keep in
  * memory for fast access.
+ *
+ * There is one instance per log and shard, and most logs on a node are idle,
+ * so the object is kept small: the purge coordinator, the record cache and
+ * rarely used state are only allocated when first needed.
  */
 
 struct ExponentialBackoffTimerNode;
@@ -174,6 +178,20 @@ class LogStorageState {
 
   folly::Optional<std::pair<epoch_t, OffsetMap>> getEpochOffsetMap() const;
 
+  /**
+   * Approximate timestamp of the first record after `trim_point', if it was
+   * cached with cacheHeadTimestamp() for that same trim point.
+   */
+  folly::Optional<std::chrono::milliseconds>
+  getCachedHeadTimestamp(lsn_t trim_point) const;
+
+  /**
+   * Remembers the approximate timestamp of the first record after
+   * `trim_point', so that GET_HEAD_ATTRIBUTES can be answered without a
+   * storage task until the trim point moves.
+   */
+  void cacheHeadTimestamp(lsn_t trim_point, std::chrono::milliseconds ts);
+
   std::chrono::seconds getLogRemovalTime() const {
     return log_removal_time_.load();
   }
@@ -296,11 +314,32 @@ class LogStorageState {
 
   ~LogStorageState();
 
-  // TODO change to inline PurgeCoordinator instance (which was moved to
-  // server/) once this class is in server/
-  std::unique_ptr<LogStorageState_PurgeCoordinator_Bridge> purge_coordinator_;
+  /**
+   * @return the purge coordinator of the log, creating it on first use.
+   */
+  LogStorageState_PurgeCoordinator_Bridge& getPurgeCoordinator();
 
-  std::unique_ptr<RecordCache> record_cache_;
+  /**
+   * @return the record cache of the log, or nullptr if record caching is
+   *         disabled or nothing was cached for the log yet.  An empty cache
+   *         knows nothing that a missing one doesn't: both make readers go to
+   *         the local log store.
+   */
+  RecordCache* getRecordCache() const {
+    return record_cache_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * Same as getRecordCache(), but creates the record cache if record caching
+   * is enabled.  Used on the write path, which fills the cache.
+   */
+  RecordCache* getOrCreateRecordCache();
+
+  /**
+   * Replaces the record cache.  Not thread safe; only used to repopulate the
+   * cache from a snapshot during startup.
+   */
+  void setRecordCache(std::unique_ptr<RecordCache> cache);
 
   // Static callback for GetSeqStateRequest; looks up the correct
   // LogStorageState instance and passes it the result to populate the
@@ -323,6 +362,17 @@ class LogStorageState {
   const logid_t log_id_;
   const shard_index_t shard_;
   LogStorageStateMap* const owner_;
+  // nullptr if record caching is disabled.
+  RecordCacheDependencies* const cache_deps_;
+
+  // Created on first use, see getPurgeCoordinator().
+  // TODO change to inline PurgeCoordinator instance (which was moved to
+  // server/) once this class is in server/
+  std::atomic<LogStorageState_PurgeCoordinator_Bridge*> purge_coordinator_{
+      nullptr};
+
+  // Created on first use, see getOrCreateRecordCache().
+  std::atomic<RecordCache*> record_cache_{nullptr};
 
   // The last released LSN for the log. Updated when a global RELEASE message
   // is received from the log's sequencer. Read by CatchupQueue when reading
@@ -408,23 +458,35 @@ class LogStorageState {
   std::atomic<std::chrono::seconds> log_removal_time_{std::chrono::seconds(0)};
 
   using RWLock = folly::SharedMutexWritePriority;
-  // Lock to update and read latest_epoch_offsets_ safely.
-  mutable RWLock rw_lock_;
-  // Pair of latest updated epoch and corresponding epoch offsets.
-  // This value get updated from sequencer once recover() get triggered.
-  // It is not updated with RELEASE messages, so epoch of last_released_lsn_
-  // can be different from epoch in latest_epoch_offsets_ pair.
-  folly::Optional<std::pair<epoch_t, OffsetMap>> latest_epoch_offsets_;
-
-  // Data needed to manage retrying sending ReleaseRequests to workers.
-  struct RetryRelease {
-    std::mutex mutex_;
-    // True when there is a timer scheduled to fire or currently running on
-    // *some* worker.
-    bool timer_scheduled_;
-    bool force_;
-    std::bitset<MAX_WORKERS> failed_workers_;
-  } retry_release_;
+
+  // State that most logs never need. Allocated on first use by getColdState().
+  struct ColdState {
+    // Lock to update and read latest_epoch_offsets_ safely.
+    mutable RWLock rw_lock_;
+    // Pair of latest updated epoch and corresponding epoch offsets.
+    // This value get updated from sequencer once recover() get triggered.
+    // It is not updated with RELEASE messages, so epoch of last_released_lsn_
+    // can be different from epoch in latest_epoch_offsets_ pair.
+    folly::Optional<std::pair<epoch_t, OffsetMap>> latest_epoch_offsets_;
+
+    // Trim point and approximate timestamp of the first record after it.
+    // Also protected by rw_lock_.
+    folly::Optional<std::pair<lsn_t, std::chrono::milliseconds>>
+        head_timestamp_;
+
+    // Data needed to manage retrying sending ReleaseRequests to workers.
+    struct RetryRelease {
+      std::mutex mutex_;
+      // True when there is a timer scheduled to fire or currently running on
+      // *some* worker.
+      bool timer_scheduled_{false};
+      bool force_{false};
+      std::bitset<MAX_WORKERS> failed_workers_;
+    } retry_release_;
+  };
+  std::atomic<ColdState*> cold_state_{nullptr};
+
+  ColdState& getColdState();
 
   // Lock to protect `last_released_lsn_`
   mutable folly::SharedMutex lsn_mutex_;
@@ -21,40 +21,35 @@ namespace facebook { namespace logdevice {
 
 LogStorageState* LogStorageStateMap::insertOrGet(logid_t log_id,
                                                  shard_index_t shard_idx) {
+  ld_check(shard_idx < shard_map_.size());
   Map& map = *shard_map_[shard_idx];
 
   // First try a lookup to avoid memory allocation in the common case
-  auto it = map.find(log_id.val_);
-  if (it != map.cend()) {
-    return it->second.get();
+  LogStorageState* state = map.find(log_id.val_);
+  if (state != nullptr) {
+    return state;
   }
 
-  // No state for this log yet.
-  auto insert_result =
-      map.emplace(log_id.val(),
-                  std::make_unique<LogStorageState>(
-                      log_id, shard_idx, this, cache_disposal_.get()));
-
-  // Whether or not we were the ones to insert or some other thread beat us
-  // to it, return a pointer to whatever ended up in the map.
-  return insert_result.first->second.get();
+  // No state for this log yet.  Whether or not we were the ones to insert or
+  // some other thread beat us to it, return a pointer to whatever ended up in
+  // the map.
+  return map.insert(log_id.val_,
+                    std::make_unique<LogStorageState>(
+                        log_id, shard_idx, this, cache_disposal_.get()));
 }
 
 LogStorageState* LogStorageStateMap::find(logid_t log_id,
                                           shard_index_t shard_idx) {
   ld_check(shard_idx < shard_map_.size());
-  Map& map = *shard_map_[shard_idx];
-  auto it = map.find(log_id.val_);
-  return it != map.cend() ? it->second.get() : nullptr;
+  return shard_map_[shard_idx]->find(log_id.val_);
 }
 
 LogStorageState& LogStorageStateMap::get(logid_t log_id,
                                          shard_index_t shard_idx) {
   ld_check(shard_idx < shard_map_.size());
-  Map& map = *shard_map_[shard_idx];
-  auto it = map.find(log_id.val_);
-  ld_check(it != map.cend());
-  return *(it->second);
+  LogStorageState* state = shard_map_[shard_idx]->find(log_id.val_);
+  ld_check(state != nullptr);
+  return *state;
 }
 
 void LogStorageStateMap::clear() {
@@ -83,7 +78,7 @@ int LogStorageStateMap::repopulateRecordCacheFromLinearBuffer(
                       log_id.val());
     return -1;
   }
-  log_storage_state->record_cache_ = std::move(record_cache);
+  log_storage_state->setRecordCache(std::move(record_cache));
   return 0;
 }
 
@@ -91,13 +86,12 @@ LogStorageStateMap::ReleaseStates
 LogStorageStateMap::getAllLastReleasedLSNs(shard_index_t shard) const {
   ReleaseStates states;
 
-  for (auto entry = shard_map_[shard]->cbegin();
-       entry != shard_map_[shard]->cend();
-       ++entry) {
+  forEachLogOnShard(shard, [&](logid_t log_id, const LogStorageState& state) {
     LogStorageState::LastReleasedLSN last_released =
-        entry->second->getLastReleasedLSN();
-    states.emplace_back(logid_t(entry->first), last_released.value());
-  }
+        state.getLastReleasedLSN();
+    states.emplace_back(log_id, last_released.value());
+    return 0;
+  });
 
   return states;
 }
@@ -119,14 +113,12 @@ void LogStorageStateMap::shutdownRecordCaches() {
   if (cache_disposal_ == nullptr) {
     return;
   }
-  for (shard_index_t i = 0; i < num_shards_; ++i) {
-    for (auto entry = shard_map_[i]->cbegin(); entry != shard_map_[i]->cend();
-         ++entry) {
-      if (entry->second->record_cache_ != nullptr) {
-        entry->second->record_cache_->shutdown();
-      }
+  forEachLog([](logid_t, const LogStorageState& state) {
+    if (RecordCache* cache = state.getRecordCache()) {
+      cache->shutdown();
     }
-  }
+    return 0;
+  });
 }
 
 void LogStorageStateMap::shutdownRecordCacheMonitor() {
@@ -157,6 +149,81 @@ StatsHolder* LogStorageStateMap::getStats() {
   return stats_;
 }
 
+LogStorageStateMap::Map::~Map() {
+  clear();
+}
+
+LogStorageState* LogStorageStateMap::Map::find(logid_t::raw_type log_id) const {
+  const size_t num_tables = num_tables_.load(std::memory_order_acquire);
+  const size_t h = hash(log_id);
+  // The newest table is the largest one, so it's the most likely to have the
+  // log.
+  for (size_t i = num_tables; i-- > 0;) {
+    const Table& table = *tables_[i].load(std::memory_order_acquire);
+    const size_t mask = table.capacity - 1;
+    for (size_t pos = h & mask;; pos = (pos + 1) & mask) {
+      const Slot& slot = table.slots[pos];
+      LogStorageState* state = slot.state.load(std::memory_order_acquire);
+      if (state == nullptr) {
+        // Tables are never full, so every probe ends at an empty slot.
+        break;
+      }
+      if (slot.log_id == log_id) {
+        return state;
+      }
+    }
+  }
+  return nullptr;
+}
+
+LogStorageState*
+LogStorageStateMap::Map::insert(logid_t::raw_type log_id,
+                                std::unique_ptr<LogStorageState> state) {
+  ld_check(state != nullptr);
+  std::lock_guard<std::mutex> guard(insert_mutex_);
+
+  LogStorageState* existing = find(log_id);
+  if (existing != nullptr) {
+    return existing;
+  }
+
+  const size_t num_tables = num_tables_.load(std::memory_order_relaxed);
+  Table* table = num_tables > 0
+      ? tables_[num_tables - 1].load(std::memory_order_relaxed)
+      : nullptr;
+  // Keep the load factor at most 3/4 so that probe sequences stay short.
+  if (table == nullptr || (table->size + 1) * 4 > table->capacity * 3) {
+    ld_check(num_tables < MAX_TABLES);
+    table = new Table(table == nullptr ? INITIAL_CAPACITY
+                                       : table->capacity * 2);
+    tables_[num_tables].store(table, std::memory_order_release);
+    num_tables_.store(num_tables + 1, std::memory_order_release);
+  }
+
+  const size_t mask = table->capacity - 1;
+  size_t pos = hash(log_id) & mask;
+  while (table->slots[pos].state.load(std::memory_order_relaxed) != nullptr) {
+    pos = (pos + 1) & mask;
+  }
+  Slot& slot = table->slots[pos];
+  slot.log_id = log_id;
+  slot.state.store(state.get(), std::memory_order_release);
+  ++table->size;
+  return state.release();
+}
+
+void LogStorageStateMap::Map::clear() {
+  const size_t num_tables = num_tables_.load();
+  num_tables_.store(0);
+  for (size_t i = 0; i < num_tables; ++i) {
+    Table* table = tables_[i].exchange(nullptr);
+    for (size_t pos = 0; pos < table->capacity; ++pos) {
+      delete table->slots[pos].state.load();
+    }
+    delete table;
+  }
+}
+
 std::vector<std::unique_ptr<LogStorageStateMap::Map>>
 LogStorageStateMap::makeMap(shard_size_t num_shards) {
   std::vector<std::unique_ptr<Map>> ret;
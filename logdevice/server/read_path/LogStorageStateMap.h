@@ -7,13 +7,13 @@
  */
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <vector>
 
-#include <folly/concurrency/ConcurrentHashMap.h>
-
 #include "logdevice/common/types_internal.h"
 #include "logdevice/common/util.h"
 #include "logdevice/include/Err.h"
@@ -28,13 +28,18 @@ namespace facebook { namespace logdevice {
  * @file
  * On storage nodes, maps log IDs to LogStorageState instances, state that we
  * need to keep in memory for fast access.
+ *
+ * The map is consulted on every STORE and RELEASE and may hold tens of
+ * millions of entries, so each shard uses a compact insert-only open
+ * addressing table: lookups are lock-free and an entry costs one 16-byte slot
+ * besides the LogStorageState itself.  LogStorageState instances are never
+ * removed from the map, except by clear().
  */
 
 class LogStorageStateMap {
  public:
   /**
    * @param num_shards         Number of shards on this node
-   *                           map, required by AtomicHashMap
    * @param recovery_interval  interval between consecutive attempts to recover
    *                           log state
    */
@@ -49,6 +54,8 @@ class LogStorageStateMap {
         num_shards_(num_shards),
         processor_(nullptr),
         shard_map_(makeMap(num_shards)),
+        persistence_state_(
+            std::make_unique<RecordCachePersistenceState[]>(num_shards)),
         state_recovery_interval_(recovery_interval),
         stats_(stats) {}
 
@@ -158,6 +165,30 @@ class LogStorageStateMap {
   template <typename Func>
   int forEachLogOnShard(shard_index_t shard, const Func& func) const;
 
+  /**
+   * State of RecordCachePersistence for one shard, see
+   * RecordCachePersistence.h.
+   */
+  struct RecordCachePersistenceState {
+    // Serializes persistence runs on the shard, protects the other members
+    // and RecordCache::persisted_copy_ of the shard's caches.
+    std::mutex mutex;
+    // Set once RecordCacheRepopulationTask has consumed and deleted the
+    // blobs left by the previous run. Checkpoints are only written after
+    // that, so that all blobs on the shard are from this run.
+    bool repopulated{false};
+    // Set by the persistence run of the shutdown. No checkpoints after that.
+    bool shut_down{false};
+    // Total size of the record cache blobs written by this run.
+    size_t bytes{0};
+  };
+
+  RecordCachePersistenceState&
+  getRecordCachePersistenceState(shard_index_t shard) {
+    ld_check(shard < num_shards_);
+    return persistence_state_[shard];
+  }
+
   // May be nullptr in tests.
   ServerProcessor* getProcessor();
   void setProcessor(ServerProcessor*);
@@ -176,15 +207,80 @@ class LogStorageStateMap {
   // initialization.
   ServerProcessor* processor_;
 
-  // use Hash64 to mitigate the effect of logid (data and metadata) collision
-  using Map = folly::ConcurrentHashMap<logid_t::raw_type,
-                                       std::unique_ptr<LogStorageState>,
-                                       Hash64<logid_t::raw_type>>;
+  /**
+   * Map from log id to LogStorageState for one shard.  Lookups are lock-free;
+   * insertions are serialized by a mutex since each log is only inserted once.
+   *
+   * Instead of rehashing when full, the map allocates a new table twice the
+   * size of the previous one and inserts new entries there, so that tables
+   * never move under concurrent readers.  Lookups search the tables from the
+   * newest (largest) one.
+   */
+  class Map {
+   public:
+    Map() = default;
+    ~Map();
+
+    Map(const Map&) = delete;
+    Map& operator=(const Map&) = delete;
+
+    LogStorageState* find(logid_t::raw_type log_id) const;
+
+    /**
+     * Inserts `state` unless the map already has a state for the log, in
+     * which case `state` is destroyed.
+     *
+     * @return  the state in the map
+     */
+    LogStorageState* insert(logid_t::raw_type log_id,
+                            std::unique_ptr<LogStorageState> state);
+
+    // Not thread safe.
+    void clear();
+
+    template <typename Func>
+    int forEach(const Func& func) const;
+
+   private:
+    struct Slot {
+      // Written before `state` is published, never changed afterwards.
+      logid_t::raw_type log_id;
+      // nullptr if the slot is empty.
+      std::atomic<LogStorageState*> state{nullptr};
+    };
+
+    struct Table {
+      explicit Table(size_t cap)
+          : capacity(cap), slots(std::make_unique<Slot[]>(cap)) {}
+
+      // Power of two.
+      const size_t capacity;
+      // Number of used slots, protected by insert_mutex_.
+      size_t size{0};
+      const std::unique_ptr<Slot[]> slots;
+    };
+
+    static constexpr size_t INITIAL_CAPACITY = 1024;
+    // Enough for INITIAL_CAPACITY << MAX_TABLES slots.
+    static constexpr size_t MAX_TABLES = 40;
+
+    // use Hash64 to mitigate the effect of logid (data and metadata)
+    // collision
+    static size_t hash(logid_t::raw_type log_id) {
+      return Hash64<logid_t::raw_type>()(log_id);
+    }
+
+    std::array<std::atomic<Table*>, MAX_TABLES> tables_{};
+    std::atomic<size_t> num_tables_{0};
+    std::mutex insert_mutex_;
+  };
 
   const std::vector<std::unique_ptr<Map>> shard_map_;
 
   static std::vector<std::unique_ptr<Map>> makeMap(shard_size_t num_shards);
 
+  const std::unique_ptr<RecordCachePersistenceState[]> persistence_state_;
+
   // Attempt to recover log state only once this many usecs.
   std::chrono::microseconds state_recovery_interval_;
 
@@ -200,10 +296,19 @@ template <typename Func>
 int LogStorageStateMap::forEachLogOnShard(shard_index_t shard,
                                           const Func& func) const {
   ld_check(shard < shard_map_.size());
-  for (auto kv = shard_map_[shard]->cbegin(); kv != shard_map_[shard]->cend();
-       ++kv) {
-    if (kv->second != nullptr) {
-      if (func(logid_t(kv->first), *kv->second) != 0) {
+  return shard_map_[shard]->forEach(func);
+}
+
+template <typename Func>
+int LogStorageStateMap::Map::forEach(const Func& func) const {
+  const size_t num_tables = num_tables_.load(std::memory_order_acquire);
+  for (size_t i = 0; i < num_tables; ++i) {
+    const Table& table = *tables_[i].load(std::memory_order_acquire);
+    for (size_t pos = 0; pos < table.capacity; ++pos) {
+      const Slot& slot = table.slots[pos];
+      const LogStorageState* state =
+          slot.state.load(std::memory_order_acquire);
+      if (state != nullptr && func(logid_t(slot.log_id), *state) != 0) {
         return -1;
       }
     }
@@ -0,0 +1,112 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/read_path/ReadResultCache.h"
+
+#include <algorithm>
+
+#include <folly/hash/Hash.h>
+
+#include "logdevice/common/debug.h"
+#include "logdevice/common/stats/Stats.h"
+
+namespace facebook { namespace logdevice {
+
+size_t ReadResultCache::KeyHasher::operator()(const Key& key) const {
+  return folly::hash::hash_combine(
+      key.log_id.val_, key.shard, key.start_lsn, key.filter);
+}
+
+void ReadResultCache::insert(Key key,
+                             const std::vector<RawRecord>& records,
+                             LocalLogStoreReader::ReadPointer read_ptr,
+                             Status status,
+                             bool accessed_under_replicated_region) {
+  if (!enabled() || !cacheableStatus(status) || records.empty() ||
+      read_ptr.lsn <= key.start_lsn) {
+    return;
+  }
+
+  auto batch = std::make_shared<Batch>();
+  batch->records.reserve(records.size());
+  batch->bytes = 0;
+  for (const RawRecord& record : records) {
+    batch->records.push_back(record.share());
+    batch->bytes += record.blob.size;
+  }
+  if (batch->bytes > max_bytes_ / 2) {
+    // Don't let one batch flush out everything else.
+    return;
+  }
+  batch->read_ptr = read_ptr;
+  batch->status = status;
+  batch->accessed_under_replicated_region = accessed_under_replicated_region;
+
+  auto it = map_.find(key);
+  if (it != map_.end()) {
+    erase(it);
+  }
+  while (bytes_ + batch->bytes > max_bytes_ && !lru_.empty()) {
+    erase(map_.find(lru_.front()));
+    STAT_INCR(stats_, read_result_cache_evictions);
+  }
+
+  bytes_ += batch->bytes;
+  lru_.push_back(key);
+  Entry entry{std::move(batch), std::chrono::steady_clock::now(), lru_.end()};
+  --entry.lru_it;
+  map_.emplace(std::move(key), std::move(entry));
+  STAT_INCR(stats_, read_result_cache_inserts);
+}
+
+std::shared_ptr<const ReadResultCache::Batch>
+ReadResultCache::lookup(const Key& key,
+                        const LocalLogStoreReader::ReadContext& read_ctx,
+                        lsn_t trim_point) {
+  if (!enabled()) {
+    return nullptr;
+  }
+  auto it = map_.find(key);
+  if (it == map_.end()) {
+    STAT_INCR(stats_, read_result_cache_misses);
+    return nullptr;
+  }
+
+  const Batch& batch = *it->second.batch;
+  if (key.start_lsn <= trim_point ||
+      std::chrono::steady_clock::now() - it->second.created > ttl_) {
+    erase(it);
+    STAT_INCR(stats_, read_result_cache_misses);
+    return nullptr;
+  }
+
+  // The batch covers [start_lsn, read_ptr.lsn - 1].
+  const lsn_t last_lsn = batch.read_ptr.lsn - 1;
+  const lsn_t max_lsn = std::min({read_ctx.until_lsn_,
+                                  read_ctx.window_high_,
+                                  read_ctx.last_released_lsn_});
+  const bool too_big = batch.bytes > read_ctx.max_bytes_to_deliver_ &&
+      !(read_ctx.first_record_any_size_ && batch.records.size() == 1);
+  if (last_lsn > max_lsn || too_big) {
+    STAT_INCR(stats_, read_result_cache_misses);
+    return nullptr;
+  }
+
+  lru_.splice(lru_.end(), lru_, it->second.lru_it);
+  STAT_INCR(stats_, read_result_cache_hits);
+  return it->second.batch;
+}
+
+void ReadResultCache::erase(Map::iterator it) {
+  ld_check(it != map_.end());
+  ld_check(bytes_ >= it->second.batch->bytes);
+  bytes_ -= it->second.batch->bytes;
+  lru_.erase(it->second.lru_it);
+  map_.erase(it);
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,148 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <chrono>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "logdevice/include/types.h"
+#include "logdevice/server/read_path/LocalLogStoreReader.h"
+
+namespace facebook { namespace logdevice {
+
+class StatsHolder;
+
+/**
+ * @file  ReadResultCache keeps batches of records recently read from the local
+ *        log store by ReadStorageTask, so that other read streams reading the
+ *        same range of the same log shortly after (e.g. several consumers of a
+ *        backfill job) can be served without going to the local log store
+ *        again.
+ *
+ *        Batches are keyed by log, shard, the LSN the read started at, and a
+ *        string describing the LocalLogStoreReadFilter and read options the
+ *        batch was read with.  Records are stored in the form that
+ *        ReadStorageTask returns them, i.e. before ServerRecordFilter and
+ *        per-stream options such as no_payload are applied, so batches are
+ *        shared by streams whose server-side filters differ.
+ *
+ *        There is one instance per worker, owned by AllServerReadStreams.  Not
+ *        thread safe.
+ */
+
+class ReadResultCache {
+ public:
+  struct Key {
+    logid_t log_id;
+    shard_index_t shard;
+    lsn_t start_lsn;
+    std::string filter;
+
+    bool operator==(const Key& other) const {
+      return log_id == other.log_id && shard == other.shard &&
+          start_lsn == other.start_lsn && filter == other.filter;
+    }
+  };
+
+  struct Batch {
+    std::vector<RawRecord> records;
+    // Read pointer and status of the read that produced the records.
+    LocalLogStoreReader::ReadPointer read_ptr;
+    Status status;
+    bool accessed_under_replicated_region;
+    // Sum of record blob sizes.
+    size_t bytes;
+  };
+
+  /**
+   * @param max_bytes  Total size of record blobs to keep.  0 disables the
+   *                   cache.
+   * @param ttl        Batches older than this are not used.  They may hold
+   *                   copies of records that were since amended or rebuilt.
+   */
+  ReadResultCache(size_t max_bytes,
+                  std::chrono::milliseconds ttl,
+                  StatsHolder* stats)
+      : max_bytes_(max_bytes), ttl_(ttl), stats_(stats) {}
+
+  bool enabled() const {
+    return max_bytes_ > 0;
+  }
+
+  /**
+   * @return true if the result of a read with the given status can be reused
+   *         by other streams.  Only reads that stopped because of a limit on
+   *         the amount of data to read or deliver qualify: other statuses
+   *         depend on the stream's window, until_lsn or last released LSN.
+   */
+  static bool cacheableStatus(Status status) {
+    return status == E::BYTE_LIMIT_REACHED || status == E::PARTIAL;
+  }
+
+  /**
+   * Stores a copy of the given records.  Records whose blob is held by a
+   * refcounted buffer (see RawRecord::shareable()) are not copied.
+   */
+  void insert(Key key,
+              const std::vector<RawRecord>& records,
+              LocalLogStoreReader::ReadPointer read_ptr,
+              Status status,
+              bool accessed_under_replicated_region);
+
+  /**
+   * Looks up a batch that can be handed to a read stream with the given
+   * read context.  The batch must not go past the LSN the stream is allowed to
+   * read up to, or above its byte limit, and must not contain records below
+   * `trim_point`; batches that do are removed.
+   *
+   * @return the batch, or nullptr if there is none.
+   */
+  std::shared_ptr<const Batch>
+  lookup(const Key& key,
+         const LocalLogStoreReader::ReadContext& read_ctx,
+         lsn_t trim_point);
+
+  size_t bytes() const {
+    return bytes_;
+  }
+
+  size_t size() const {
+    return map_.size();
+  }
+
+ private:
+  struct KeyHasher {
+    size_t operator()(const Key& key) const;
+  };
+
+  struct Entry {
+    std::shared_ptr<const Batch> batch;
+    std::chrono::steady_clock::time_point created;
+    // Position in lru_.
+    std::list<Key>::iterator lru_it;
+  };
+
+  using Map = std::unordered_map<Key, Entry, KeyHasher>;
+
+  void erase(Map::iterator it);
+
+  const size_t max_bytes_;
+  const std::chrono::milliseconds ttl_;
+  StatsHolder* const stats_;
+
+  Map map_;
+  // Keys from least to most recently used.
+  std::list<Key> lru_;
+  size_t bytes_{0};
+};
+
+}} // namespace facebook::logdevice
@@ -11,6 +11,7 @@
 #include <string>
 
 #include "logdevice/common/AdminCommandTable.h"
+#include "logdevice/common/PrincipalIdentity.h"
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/configuration/Configuration.h"
 #include "logdevice/common/debug.h"
@@ -219,7 +220,8 @@ void ServerReadStream::setTrafficClass(TrafficClass c) {
   }
 }
 
-void ServerReadStream::getDebugInfo(InfoReadersTable& table) const {
+void ServerReadStream::getDebugInfo(InfoReadersTable& table,
+                                    ssize_t send_buf_occupancy) const {
   std::string known_down;
   if (scdEnabled()) {
     for (size_t i = 0; i < getKnownDown().size(); ++i) {
@@ -282,9 +284,30 @@ void ServerReadStream::getDebugInfo(InfoReadersTable& table) const {
   size_t current_meter_level = getCurrentMeterLevel();
   table.set<22>(current_meter_level);
 
-  ssize_t send_buf_occupancy =
-      worker->sender().getTcpSendBufOccupancyForClient(client_id_);
   table.set<25>(send_buf_occupancy);
+  const Settings& settings = Worker::settings();
+  table.set<26>(readahead_.getSize(settings.catchup_readahead_max_size,
+                                   settings.catchup_readahead_min_batches));
+  if (storage_bytes_delivered_ > 0) {
+    table.set<27>(double(storage_bytes_read_) / storage_bytes_delivered_);
+  }
+  table.set<28>(read_result_cache_hits_);
+  table.set<29>(read_result_cache_misses_);
+  if (filter_records_passed_ + filter_records_rejected_ > 0) {
+    table.set<30>(double(filter_records_passed_) /
+                  (filter_records_passed_ + filter_records_rejected_));
+  }
+  if (settings.catchup_adaptive_batch_size &&
+      settings.max_record_bytes_read_at_once > 0) {
+    table.set<31>(
+        batch_size_.getSize(settings.max_record_bytes_read_at_once));
+  }
+  if (const PrincipalIdentity* principal =
+          worker->sender().getPrincipal(Address(client_id_))) {
+    table.set<32>(principal->accountingName());
+  }
+  table.set<33>(records_sent_);
+  table.set<34>(record_bytes_sent_);
 }
 
 void ServerReadStream::addReleasedRecords(
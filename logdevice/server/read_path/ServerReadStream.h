@@ -30,6 +30,8 @@
 #include "logdevice/include/strong_typedef.h"
 #include "logdevice/include/types.h"
 #include "logdevice/server/RealTimeRecordBuffer.h"
+#include "logdevice/server/read_path/AdaptiveBatchSize.h"
+#include "logdevice/server/read_path/AdaptiveReadahead.h"
 #include "logdevice/server/read_path/LocalLogStoreReader.h"
 #include "logdevice/server/read_path/ReadIoShapingCallback.h"
 
@@ -201,7 +203,10 @@ class ServerReadStream : boost::noncopyable {
 
   std::string toString() const;
 
-  void getDebugInfo(InfoReadersTable& table) const;
+  // `send_buf_occupancy` is the TCP send buffer occupancy of the client's
+  // connection. It is passed in so that callers listing many streams of the
+  // same client only query the socket once.
+  void getDebugInfo(InfoReadersTable& table, ssize_t send_buf_occupancy) const;
 
   logid_t getLogId() {
     return log_id_;
@@ -498,9 +503,37 @@ class ServerReadStream : boost::noncopyable {
   ReadIoShapingCallback read_shaping_cb_;
 
   // Whether there is currently a storage task in flight for this stream, in
-  // which case the stream should be at the top of CatchupQueue.
+  // which case the stream should be in CatchupQueue::queues_.
   bool storage_task_in_flight_;
 
+  // Picks the read-ahead size of this stream's blocking iterator based on how
+  // its recent storage task batches ended.
+  AdaptiveReadahead readahead_;
+
+  // Picks how many bytes this stream's storage tasks may read, based on how
+  // fast the client consumes records and how long storage tasks take.
+  AdaptiveBatchSize batch_size_;
+
+  // Total size of RECORD messages sent for this stream. Sampled by
+  // batch_size_ on each WINDOW update.
+  uint64_t record_bytes_sent_{0};
+  // Number of RECORD messages sent for this stream. Reported by
+  // 'info readers'.
+  uint64_t records_sent_{0};
+
+  // Bytes that storage tasks of this stream read from the local log store
+  // (records and copyset index entries), and record bytes out of those that
+  // passed the filters and were delivered. Their ratio is the stream's read
+  // amplification, reported by 'info readers'.
+  uint64_t storage_bytes_read_{0};
+  uint64_t storage_bytes_delivered_{0};
+
+  // Number of reads of this stream that were served from the worker's
+  // ReadResultCache, and that looked for a batch there but found none.
+  // Reported by 'info readers'.
+  uint64_t read_result_cache_hits_{0};
+  uint64_t read_result_cache_misses_{0};
+
   // Status of the last batch. Used for debugging only.
   // Pointer to a string literal, so that it's fast to assign.
   const char* last_batch_status_ = "no batches";
@@ -511,7 +544,21 @@ class ServerReadStream : boost::noncopyable {
   // Set to 0 if replication is unknown.
   uint16_t replication_;
 
-  // Hook for CatchupQueue::queue_.
+  // SLO class of the client reader, from the START message. CatchupQueue
+  // shares the bytes it sends between classes in proportion to their weights.
+  MonitoringTier monitoring_tier_ = MonitoringTier::MEDIUM_PRI;
+
+  // Class whose queue in CatchupQueue the stream is in. Set by
+  // CatchupQueue::add(), so that START messages changing monitoring_tier_
+  // take effect the next time the stream is queued.
+  MonitoringTier queued_tier_ = MonitoringTier::MEDIUM_PRI;
+
+  // True if the stream had delivered everything that was available to it
+  // since it was last queued by CatchupQueue, i.e. it is reading near the
+  // tail of the log. Such streams are served before streams with a backlog.
+  bool reached_tail_ = false;
+
+  // Hook for CatchupQueue::queues_.
   folly::IntrusiveListHook queue_hook_;
 
   // Hook for CatchupQueue::queue_delayed_.
@@ -525,6 +572,11 @@ class ServerReadStream : boost::noncopyable {
   // by ServerRecordFilterFactory.
   std::unique_ptr<ServerRecordFilter> filter_pred_;
 
+  // Number of records that filter_pred_ let through and filtered out. Their
+  // ratio is the filter's selectivity, reported by 'info readers'.
+  uint64_t filter_records_passed_{0};
+  uint64_t filter_records_rejected_{0};
+
   // The location of the client reader.
   // Only used if local_scd_enabled_ is set to true.
   std::string client_location_;
@@ -0,0 +1,114 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/rebuilding/AmendBatcher.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "logdevice/common/Sender.h"
+#include "logdevice/common/protocol/Compatibility.h"
+#include "logdevice/common/protocol/MULTI_AMEND_Message.h"
+#include "logdevice/common/stats/Stats.h"
+#include "logdevice/server/STORE_onSent.h"
+#include "logdevice/server/ServerWorker.h"
+
+namespace facebook { namespace logdevice {
+
+void AmendBatcher::queue(node_index_t node,
+                         std::unique_ptr<STORE_Message> msg) {
+  ld_check(msg);
+  ld_check(msg->getHeader().flags & STORE_Header::AMEND);
+  pending_[node].push_back(std::move(msg));
+  scheduleFlush();
+}
+
+size_t AmendBatcher::getQueued(node_index_t node) const {
+  auto it = pending_.find(node);
+  return it == pending_.end() ? 0 : it->second.size();
+}
+
+void AmendBatcher::scheduleFlush() {
+  if (!flush_timer_.isAssigned()) {
+    flush_timer_.assign([this] { flush(); });
+  }
+  if (!flush_timer_.isActive()) {
+    flush_timer_.activate(std::chrono::microseconds(0));
+  }
+}
+
+void AmendBatcher::flush() {
+  auto pending = std::move(pending_);
+  pending_.clear();
+
+  for (auto& kv : pending) {
+    const node_index_t node = kv.first;
+    std::vector<std::unique_ptr<STORE_Message>>& msgs = kv.second;
+
+    if (msgs.size() == 1 || !supportsMultiAmend(node)) {
+      for (auto& msg : msgs) {
+        if (sendStore(node, msg) != 0) {
+          onSendFailed(node, *msg, err);
+        }
+      }
+      continue;
+    }
+
+    for (size_t begin = 0; begin < msgs.size();
+         begin += MULTI_AMEND_Message::MAX_ENTRIES) {
+      const size_t end =
+          std::min(msgs.size(), begin + MULTI_AMEND_Message::MAX_ENTRIES);
+      std::vector<std::unique_ptr<STORE_Message>> batch(
+          std::make_move_iterator(msgs.begin() + begin),
+          std::make_move_iterator(msgs.begin() + end));
+      if (sendMultiAmend(node, batch) != 0) {
+        const Status st = err;
+        for (const auto& msg : batch) {
+          onSendFailed(node, *msg, st);
+        }
+      }
+    }
+  }
+}
+
+bool AmendBatcher::supportsMultiAmend(node_index_t node) const {
+  auto proto = Worker::onThisThread()->sender().getSocketProtocolVersion(node);
+  return proto.has_value() &&
+      proto.value() >= Compatibility::MULTI_AMEND_SUPPORT;
+}
+
+int AmendBatcher::sendStore(node_index_t node,
+                            std::unique_ptr<STORE_Message>& msg) {
+  return Worker::onThisThread()->sender().sendMessage(
+      std::move(msg), NodeID(node));
+}
+
+int AmendBatcher::sendMultiAmend(
+    node_index_t node,
+    std::vector<std::unique_ptr<STORE_Message>>& msgs) {
+  const size_t count = msgs.size();
+  auto msg = std::make_unique<MULTI_AMEND_Message>(std::move(msgs));
+  int rv = Worker::onThisThread()->sender().sendMessage(
+      std::move(msg), NodeID(node));
+  if (rv == 0) {
+    WORKER_STAT_INCR(multi_amend_messages_sent);
+    WORKER_STAT_ADD(multi_amend_amends_batched, count);
+  } else {
+    // Sender leaves the message with us on failure. Hand the amends back so
+    // that their failures can be reported.
+    msgs = std::move(msg->getStores());
+  }
+  return rv;
+}
+
+void AmendBatcher::onSendFailed(node_index_t node,
+                                const STORE_Message& msg,
+                                Status status) {
+  STORE_onSent(msg, status, Address(NodeID(node)), SteadyTimestamp::now());
+}
+
+}} // namespace facebook::logdevice
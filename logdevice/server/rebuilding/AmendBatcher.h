@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "logdevice/common/Timer.h"
+#include "logdevice/common/protocol/STORE_Message.h"
+#include "logdevice/include/types.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Batches the amends that the record rebuildings of a ServerWorker send
+ *       to other storage nodes. Rebuilding runs many logs at once, and amends
+ *       carry no payload, so a STORE message per amend is mostly overhead.
+ *       Amends queued for a node during one event loop iteration, whatever
+ *       log they belong to, are sent together in MULTI_AMEND messages.
+ *
+ *       Nodes that predate MULTI_AMEND_SUPPORT, and flushes that found a
+ *       single amend for a node, still get plain STORE messages. Failures to
+ *       send are reported through STORE_onSent(), as for any rebuilding
+ *       STORE, so that the record rebuildings retry.
+ *
+ *       Not thread-safe, owned by ServerWorker.
+ */
+
+class AmendBatcher {
+ public:
+  virtual ~AmendBatcher() {}
+
+  // Queues an amend for `node'.
+  void queue(node_index_t node, std::unique_ptr<STORE_Message> msg);
+
+  // Number of amends queued for `node'.
+  size_t getQueued(node_index_t node) const;
+
+ protected:
+  // Arranges for flush() to be called once the current iteration of the
+  // event loop is done. Tests can override.
+  virtual void scheduleFlush();
+
+  // Sends everything queued.
+  void flush();
+
+  // The following are overridden in tests.
+
+  // @return  true if `node' is known to understand MULTI_AMEND
+  virtual bool supportsMultiAmend(node_index_t node) const;
+  // @return  0 on success, -1 with err set on failure, like Sender. On
+  //          failure `msg' is left untouched.
+  virtual int sendStore(node_index_t node,
+                        std::unique_ptr<STORE_Message>& msg);
+  // On failure the amends are handed back in `msgs'.
+  virtual int sendMultiAmend(node_index_t node,
+                             std::vector<std::unique_ptr<STORE_Message>>& msgs);
+  // Tells the record rebuilding that its amend couldn't be sent.
+  virtual void onSendFailed(node_index_t node,
+                            const STORE_Message& msg,
+                            Status status);
+
+ private:
+  std::unordered_map<node_index_t, std::vector<std::unique_ptr<STORE_Message>>>
+      pending_;
+  Timer flush_timer_;
+};
+
+}} // namespace facebook::logdevice
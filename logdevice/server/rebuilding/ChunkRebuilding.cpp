@@ -259,15 +259,16 @@ void ChunkRebuilding::getDebugInfo(InfoRebuildingChunksTable& table) const {
 
 StartChunkRebuildingRequest::StartChunkRebuildingRequest(
     worker_id_t worker_id,
+    WorkerType worker_type,
     std::unique_ptr<ChunkRebuilding> r)
-    : workerID_(worker_id), r_(std::move(r)) {}
+    : workerID_(worker_id), workerType_(worker_type), r_(std::move(r)) {}
 
 int StartChunkRebuildingRequest::getThreadAffinity(int) {
   return workerID_.val();
 }
 
 WorkerType StartChunkRebuildingRequest::getWorkerTypeAffinity() {
-  return workerType;
+  return workerType_;
 }
 
 Request::Execution StartChunkRebuildingRequest::execute() {
@@ -282,15 +283,16 @@ Request::Execution StartChunkRebuildingRequest::execute() {
 
 AbortChunkRebuildingRequest::AbortChunkRebuildingRequest(
     worker_id_t worker_id,
+    WorkerType worker_type,
     chunk_rebuilding_id_t id)
-    : workerID_(worker_id), id_(id) {}
+    : workerID_(worker_id), workerType_(worker_type), id_(id) {}
 
 int AbortChunkRebuildingRequest::getThreadAffinity(int) {
   return workerID_.val();
 }
 
 WorkerType AbortChunkRebuildingRequest::getWorkerTypeAffinity() {
-  return StartChunkRebuildingRequest::workerType;
+  return workerType_;
 }
 
 Request::Execution AbortChunkRebuildingRequest::execute() {
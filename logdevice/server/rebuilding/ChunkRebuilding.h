@@ -214,24 +214,25 @@ class ChunkRebuilding : public RecordRebuildingOwner {
 
 class StartChunkRebuildingRequest : public Request {
  public:
-  explicit StartChunkRebuildingRequest(worker_id_t worker_id,
-                                       std::unique_ptr<ChunkRebuilding> r);
+  StartChunkRebuildingRequest(worker_id_t worker_id,
+                              WorkerType worker_type,
+                              std::unique_ptr<ChunkRebuilding> r);
   int getThreadAffinity(int) override;
   WorkerType getWorkerTypeAffinity() override;
 
   Execution execute() override;
 
-  // On what workers ChunkRebuilding state machines live.
-  static constexpr WorkerType workerType = WorkerType::GENERAL;
-
  private:
   worker_id_t workerID_;
+  WorkerType workerType_;
   std::unique_ptr<ChunkRebuilding> r_;
 };
 
 class AbortChunkRebuildingRequest : public Request {
  public:
-  AbortChunkRebuildingRequest(worker_id_t worker_id, chunk_rebuilding_id_t id);
+  AbortChunkRebuildingRequest(worker_id_t worker_id,
+                              WorkerType worker_type,
+                              chunk_rebuilding_id_t id);
 
   int getThreadAffinity(int) override;
   WorkerType getWorkerTypeAffinity() override;
@@ -240,6 +241,7 @@ class AbortChunkRebuildingRequest : public Request {
 
  private:
   worker_id_t workerID_;
+  WorkerType workerType_;
   chunk_rebuilding_id_t id_;
 };
 
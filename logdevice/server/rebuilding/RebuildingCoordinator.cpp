@@ -7,6 +7,7 @@
  */
 #include "logdevice/server/rebuilding/RebuildingCoordinator.h"
 
+#include <folly/String.h>
 #include <folly/hash/Hash.h>
 
 #include "logdevice/admin/maintenance/types.h"
@@ -238,6 +239,33 @@ class WakeUpServerReadStreamsRequest : public Request {
   uint32_t shard_idx_;
 };
 
+/**
+ * Returns true if every shard in the rebuilding set only lost data in some
+ * time ranges and the ranges add up to at most `max_duration`. Such
+ * rebuildings can take the mini-rebuilding fast path.
+ */
+bool isShortTimeRangedRebuilding(const RebuildingSet& set,
+                                 std::chrono::milliseconds max_duration) {
+  if (max_duration.count() <= 0 || set.shards.empty() ||
+      set.all_dirty_time_intervals.empty()) {
+    return false;
+  }
+  for (const auto& kv : set.shards) {
+    if (kv.second.dc_dirty_ranges.empty()) {
+      return false;
+    }
+  }
+  std::chrono::milliseconds total(0);
+  for (const auto& interval : set.all_dirty_time_intervals) {
+    if (interval.lower() == RecordTimestamp::min() ||
+        interval.upper() == RecordTimestamp::max()) {
+      return false;
+    }
+    total += interval.upper() - interval.lower();
+  }
+  return total <= max_duration;
+}
+
 } // end of anonymous namespace
 
 RebuildingCoordinator::RebuildingCoordinator(
@@ -784,6 +812,13 @@ void RebuildingCoordinator::restartForShard(uint32_t shard_idx,
     return;
   }
 
+  // State carried over from the rebuilding we're about to abort.
+  std::shared_ptr<const RebuildingSet> prev_rebuilding_set;
+  std::shared_ptr<const ShardRebuildingInterface::Checkpoint> checkpoint;
+  bool had_shard_rebuilding = false;
+  size_t wasted_bytes = 0;
+  std::deque<size_t> restart_wasted_bytes;
+
   if (shardsRebuilding_.count(shard_idx)) {
     auto& shard_state = getShardState(shard_idx);
     ld_check(shard_state.restartVersion <= set.getLastSeenLSN());
@@ -802,6 +837,16 @@ void RebuildingCoordinator::restartForShard(uint32_t shard_idx,
       return;
     }
 
+    restart_wasted_bytes = std::move(shard_state.restartWastedBytes);
+    if (shard_state.shardRebuilding != nullptr) {
+      had_shard_rebuilding = true;
+      prev_rebuilding_set = shard_state.rebuildingSet;
+      wasted_bytes = shard_state.shardRebuilding->getBytesRead();
+      if (rebuildingSettings_->incremental_set_updates) {
+        checkpoint = shard_state.shardRebuilding->getCheckpoint();
+      }
+    }
+
     // Cancel the current rebuilding.
     abortShardRebuilding(shard_idx);
   }
@@ -858,6 +903,36 @@ void RebuildingCoordinator::restartForShard(uint32_t shard_idx,
   shard_state.progressStat.assign(
       getStats(), &PerShardStats::rebuilding_progress_ppm, shard_idx, 0);
 
+  if (checkpoint != nullptr) {
+    auto added_shards = getAddedShards(*prev_rebuilding_set, *rebuildingSet);
+    if (added_shards != nullptr) {
+      // Shards were only added to the rebuilding set. The new ShardRebuilding
+      // will continue where the old one left off.
+      ld_info("Shards %s were added to rebuilding set of shard %u. Will "
+              "resume reading from %lu bytes before where we stopped.",
+              added_shards->describe().c_str(),
+              shard_idx,
+              checkpoint->bytesReadPastCheckpoint);
+      wasted_bytes = checkpoint->bytesReadPastCheckpoint;
+      shard_state.resumeCheckpoint = std::move(checkpoint);
+      shard_state.addedShards = std::move(added_shards);
+    }
+  }
+  if (had_shard_rebuilding) {
+    if (shard_state.resumeCheckpoint != nullptr) {
+      STAT_INCR(getStats(), rebuilding_restarts_resumed);
+    } else {
+      STAT_INCR(getStats(), rebuilding_restarts_from_scratch);
+    }
+    STAT_ADD(getStats(), rebuilding_restart_wasted_bytes, wasted_bytes);
+    restart_wasted_bytes.push_back(wasted_bytes);
+    // Only keep the most recent few.
+    while (restart_wasted_bytes.size() > 10) {
+      restart_wasted_bytes.pop_front();
+    }
+  }
+  shard_state.restartWastedBytes = std::move(restart_wasted_bytes);
+
   // Install a delay timer to support the feature to skip rebuilding data logs
   // as well as to stagger sending SHARD_IS_REBUILT messages. If the
   // disable_data_log_rebuilding setting is enabled, the timer just delays the
@@ -995,10 +1070,44 @@ void RebuildingCoordinator::restartForShard(uint32_t shard_idx,
           !rebuildUserLogsOnly_ && shouldRebuildMetadataLogs(shard_idx),
       .min_timestamp = rsi->all_dirty_time_intervals.begin()->lower(),
       .version = shard_state.version};
+  if (isShortTimeRangedRebuilding(
+          *shard_state.rebuildingSet,
+          settings->mini_rebuilding_fast_path_max_duration)) {
+    params.dirty_time_ranges =
+        shard_state.rebuildingSet->all_dirty_time_intervals;
+  }
 
   requestPlan(shard_idx, params, *shard_state.rebuildingSet);
 }
 
+std::shared_ptr<RebuildingSet>
+RebuildingCoordinator::getAddedShards(const RebuildingSet& old_set,
+                                      const RebuildingSet& new_set) {
+  if (old_set.filter_relocate_shards != new_set.filter_relocate_shards ||
+      new_set.shards.size() <= old_set.shards.size()) {
+    return nullptr;
+  }
+  for (const auto& kv : old_set.shards) {
+    auto it = new_set.shards.find(kv.first);
+    if (it == new_set.shards.end() || !(it->second == kv.second)) {
+      // A shard was removed or its mode or dirty ranges changed.
+      return nullptr;
+    }
+  }
+  auto added = std::make_shared<RebuildingSet>();
+  added->filter_relocate_shards = new_set.filter_relocate_shards;
+  added->all_dirty_time_intervals = new_set.all_dirty_time_intervals;
+  for (const auto& kv : new_set.shards) {
+    if (!old_set.shards.count(kv.first)) {
+      added->shards.emplace(kv.first, kv.second);
+      if (new_set.empty.count(kv.first)) {
+        added->empty.insert(kv.first);
+      }
+    }
+  }
+  return added;
+}
+
 void RebuildingCoordinator::normalizeTimeRanges(uint32_t shard_idx,
                                                 RecordTimeIntervals& rtis) {
   auto& store =
@@ -1338,7 +1447,6 @@ void RebuildingCoordinator::onRetrievedPlanForLog(
   auto& shard_state = getShardState(shard_idx);
   ld_check(version == shard_state.version);
   ld_check(shard_state.waitingForMorePlans);
-  ld_check(shard_state.shardRebuilding == nullptr);
   ld_check(!shard_state.logsWithPlan.count(log));
 
   if (!is_authoritative && shard_state.isAuthoritative &&
@@ -1351,7 +1459,23 @@ void RebuildingCoordinator::onRetrievedPlanForLog(
   ld_check(log_plan);
   ld_check(!log_plan->epochsToRead.empty());
 
+  if (shard_state.shardRebuilding != nullptr) {
+    // Rebuilding has started before planning was done. Hand the plan over.
+    if (config_->get()->getLogGroupByIDShared(log)) {
+      std::unordered_map<logid_t, std::unique_ptr<RebuildingPlan>> plans;
+      plans.emplace(log, std::move(log_plan));
+      shard_state.shardRebuilding->addPlans(std::move(plans), false);
+    }
+    return;
+  }
+
   shard_state.logsWithPlan.emplace(log, std::move(log_plan));
+
+  const size_t start_after = rebuildingSettings_->start_after_planned_logs;
+  if (start_after > 0 && shard_state.resumeCheckpoint == nullptr &&
+      shard_state.logsWithPlan.size() >= start_after) {
+    startShardRebuilding(shard_idx, /* more_plans_coming */ true);
+  }
 }
 
 void RebuildingCoordinator::onLogsEnumerated(
@@ -1386,6 +1510,20 @@ void RebuildingCoordinator::onFinishedRetrievingPlans(uint32_t shard_idx,
           shard_idx,
           lsn_to_string(version).c_str());
 
+  if (shard_state.shardRebuilding != nullptr) {
+    // Rebuilding was started early, and has been getting plans as they came.
+    shard_state.shardRebuilding->addPlans({}, /* last */ true);
+    return;
+  }
+
+  startShardRebuilding(shard_idx, /* more_plans_coming */ false);
+}
+
+void RebuildingCoordinator::startShardRebuilding(uint32_t shard_idx,
+                                                 bool more_plans_coming) {
+  auto& shard_state = getShardState(shard_idx);
+  ld_check(shard_state.shardRebuilding == nullptr);
+
   // Remove logs that are not in config anymore.
   auto config = config_->get();
   size_t total_epoch_ranges = 0;
@@ -1405,6 +1543,11 @@ void RebuildingCoordinator::onFinishedRetrievingPlans(uint32_t shard_idx,
           SteadyTimestamp::now() - shard_state.planningStartTime)
           .count();
 
+  if (shard_state.logsWithPlan.empty() && more_plans_coming) {
+    // All the logs planned so far were removed from config. Wait for more.
+    return;
+  }
+
   if (shard_state.logsWithPlan.empty()) {
     ld_info(
         "Got empty rebuild plan for shard %u in %.3fs with rebuilding set: %s",
@@ -1413,8 +1556,9 @@ void RebuildingCoordinator::onFinishedRetrievingPlans(uint32_t shard_idx,
         shard_state.rebuildingSet->describe().c_str());
     onShardRebuildingComplete(shard_idx);
   } else {
-    ld_info("Got rebuilding plan (%lu epoch ranges in %lu logs) for shard %u "
+    ld_info("Got %srebuilding plan (%lu epoch ranges in %lu logs) for shard %u "
             "in %.3fs. Starting rebuilding. Rebuilding set: %s",
+            more_plans_coming ? "partial " : "",
             total_epoch_ranges,
             shard_state.logsWithPlan.size(),
             shard_idx,
@@ -1428,6 +1572,16 @@ void RebuildingCoordinator::onFinishedRetrievingPlans(uint32_t shard_idx,
                               rebuildingSettings_);
     shard_state.shardRebuilding->advanceGlobalWindow(
         shard_state.globalWindowEnd);
+    if (shard_state.resumeCheckpoint != nullptr) {
+      shard_state.shardRebuilding->resumeFrom(
+          std::move(shard_state.resumeCheckpoint),
+          std::move(shard_state.addedShards));
+      shard_state.resumeCheckpoint = nullptr;
+      shard_state.addedShards = nullptr;
+    }
+    if (more_plans_coming) {
+      shard_state.shardRebuilding->expectMorePlans();
+    }
     shard_state.shardRebuilding->start(std::move(shard_state.logsWithPlan));
   }
 }
@@ -2031,7 +2185,8 @@ void RebuildingCoordinator::getDebugInfo(
         .set<2>(shard_state.version)
         .set<3>(shard_state.globalWindowEnd.toMilliseconds())
         .set<5>(logs_waiting_for_plan)
-        .set<8>(shard_state.participating);
+        .set<8>(shard_state.participating)
+        .set<18>(folly::join(",", shard_state.restartWastedBytes));
 
     if (shard_state.shardRebuilding != nullptr) {
       shard_state.shardRebuilding->getDebugInfo(table);
@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include <deque>
 #include <memory>
 #include <queue>
 
@@ -312,6 +313,17 @@ class RebuildingCoordinator : public RebuildingPlanner::Listener,
 
   virtual NodeID getMyNodeID();
 
+  /**
+   * Creates and starts ShardRebuilding for the logs in
+   * shard_state.logsWithPlan, or completes rebuilding of the shard right away
+   * if there are none.
+   *
+   * @param more_plans_coming  If true, planning is still in progress, and the
+   *                           remaining plans will be passed to
+   *                           ShardRebuildingInterface::addPlans().
+   */
+  void startShardRebuilding(uint32_t shard_idx, bool more_plans_coming);
+
   void requestPlan(shard_index_t shard_idx,
                    RebuildingPlanner::Parameters params,
                    RebuildingSet rebuilding_set);
@@ -424,6 +436,14 @@ class RebuildingCoordinator : public RebuildingPlanner::Listener,
    */
   virtual void scheduleRestartForShard(uint32_t shard_idx);
 
+  /**
+   * If `new_set` is `old_set` with some shards added, and the shards of
+   * `old_set` are unchanged, returns a RebuildingSet containing only the added
+   * shards. Otherwise returns nullptr.
+   */
+  static std::shared_ptr<RebuildingSet>
+  getAddedShards(const RebuildingSet& old_set, const RebuildingSet& new_set);
+
   /**
    * Have the LocalLogStore adjust our rebuilding ranges such that we cannot
    * miss any records even if the timestamps in this log are not strictly
@@ -540,6 +560,18 @@ class RebuildingCoordinator : public RebuildingPlanner::Listener,
     // Created after RebuildingPlanner finishes for all logs.
     std::unique_ptr<ShardRebuildingInterface> shardRebuilding;
 
+    // If not nullptr, the ShardRebuilding created after planning resumes from
+    // this checkpoint of the previous ShardRebuilding, which was aborted
+    // because `addedShards` were added to the rebuilding set.
+    std::shared_ptr<const ShardRebuildingInterface::Checkpoint>
+        resumeCheckpoint;
+    std::shared_ptr<const RebuildingSet> addedShards;
+
+    // How many bytes our ShardRebuilding had read and had to read again after
+    // each of the last few restarts, oldest first. Carried over to the new
+    // ShardState in restartForShard().
+    std::deque<size_t> restartWastedBytes;
+
     // The max backlog duration of all the logs with retention on this shard
     std::chrono::milliseconds max_rebuild_by_retention_backlog{0};
 
@@ -17,8 +17,29 @@ namespace facebook { namespace logdevice {
 
 void RebuildingEnumerateMetadataLogsTask::execute() {
   shard_index_t shard_idx = storageThreadPool_->getShardIdx();
+  LocalLogStore& store = storageThreadPool_->getLocalLogStore();
 
-  auto it = storageThreadPool_->getLocalLogStore().readAllLogs(
+  if (dirty_time_ranges_.hasValue()) {
+    std::unordered_set<logid_t> data_logs;
+    if (store.findLogsInTimeRanges(dirty_time_ranges_.value(), &data_logs) ==
+        0) {
+      ld_info("Found %lu data logs with records in dirty time ranges %s on "
+              "shard %u",
+              data_logs.size(),
+              toString(dirty_time_ranges_.value()).c_str(),
+              shard_idx);
+      data_logs_ = std::move(data_logs);
+    } else {
+      ld_check_eq(err, E::NOTSUPPORTED);
+    }
+  }
+
+  if (!enumerate_metadata_logs_) {
+    status_ = E::OK;
+    return;
+  }
+
+  auto it = store.readAllLogs(
       LocalLogStore::ReadOptions("RebuildingEnumerateMetadataLogsTask", true),
       /* data_logs_filter */
       std::unordered_map<logid_t, std::pair<lsn_t, lsn_t>>{});
@@ -77,7 +98,8 @@ void RebuildingEnumerateMetadataLogsTask::onDone() {
     return;
   }
   shard_index_t shard_idx = storageThreadPool_->getShardIdx();
-  ref_->onMetaDataLogsStorageTaskDone(status_, shard_idx, std::move(result_));
+  ref_->onStorageTaskDone(
+      status_, shard_idx, std::move(result_), std::move(data_logs_));
 }
 
 void RebuildingEnumerateMetadataLogsTask::onDropped() {
@@ -14,7 +14,8 @@ namespace facebook { namespace logdevice {
 
 /**
  * @file Task created by RebuildingLogEnumerator to identify all metadata logs
- *       that are stored in a given shard.
+ *       that are stored in a given shard, and, for mini-rebuildings, the data
+ *       logs that have records in the dirty time ranges.
  */
 
 class RebuildingEnumerateMetadataLogsTask : public StorageTask {
@@ -22,13 +23,20 @@ class RebuildingEnumerateMetadataLogsTask : public StorageTask {
   /**
    * @param ref   weak reference to the RebuildingLogEnumerator object, used
    *              to check if it's still alive
+   * @param enumerate_metadata_logs  whether to look for metadata logs
+   * @param dirty_time_ranges  if set, also look for data logs that have
+   *                           records in these time ranges
    */
-  explicit RebuildingEnumerateMetadataLogsTask(
+  RebuildingEnumerateMetadataLogsTask(
       WeakRefHolder<RebuildingLogEnumerator>::Ref ref,
-      size_t num_shards)
+      size_t num_shards,
+      bool enumerate_metadata_logs,
+      folly::Optional<RecordTimeIntervals> dirty_time_ranges)
       : StorageTask(StorageTask::Type::REBUILDING_ENUMERATE_LOGS),
         ref_(std::move(ref)),
-        num_shards_(num_shards) {}
+        num_shards_(num_shards),
+        enumerate_metadata_logs_(enumerate_metadata_logs),
+        dirty_time_ranges_(std::move(dirty_time_ranges)) {}
 
   void execute() override;
 
@@ -57,9 +65,12 @@ class RebuildingEnumerateMetadataLogsTask : public StorageTask {
 
   WeakRefHolder<RebuildingLogEnumerator>::Ref ref_;
   size_t num_shards_;
+  bool enumerate_metadata_logs_;
+  folly::Optional<RecordTimeIntervals> dirty_time_ranges_;
 
   Status status_;
   std::vector<logid_t> result_;
+  folly::Optional<std::unordered_set<logid_t>> data_logs_;
 };
 
 }} // namespace facebook::logdevice
@@ -8,7 +8,9 @@
 #include "logdevice/server/rebuilding/RebuildingLogEnumerator.h"
 
 #include "logdevice/common/LegacyLogToShard.h"
+#include "logdevice/common/MetaDataLog.h"
 #include "logdevice/common/configuration/Configuration.h"
+#include "logdevice/common/configuration/InternalLogs.h"
 #include "logdevice/common/configuration/UpdateableConfig.h"
 #include "logdevice/server/ServerWorker.h"
 #include "logdevice/server/rebuilding/RebuildingEnumerateMetadataLogsTask.h"
@@ -100,32 +102,45 @@ void RebuildingLogEnumerator::start() {
           dataSkipped,
           results_.size());
 
-  /* figure out the metadata logs for shards that have requested them */
+  // Mini-rebuilding fast path: if all shards only need to rebuild some short
+  // time ranges, only keep the data logs that have records in those ranges.
+  fast_path_ = !parameters_.empty();
+  for (const auto& p : parameters_) {
+    fast_path_ &= p.second.dirty_time_ranges.hasValue();
+  }
+
+  /* figure out the metadata logs for shards that have requested them, and
+   * the data logs in dirty time ranges if we're on the fast path */
   for (const auto& p : parameters_) {
     auto shard_idx = p.first;
     auto params = p.second;
 
-    if (params.rebuild_metadata_logs) {
+    if (params.rebuild_metadata_logs || fast_path_) {
       shard_storage_tasks_remaining_.insert(shard_idx);
-      putStorageTask(shard_idx);
+      putStorageTask(shard_idx, params);
     }
   }
   maybeFinalize();
   // `this` may be destroyed here.
 }
 
-void RebuildingLogEnumerator::putStorageTask(uint32_t shard_idx) {
+void RebuildingLogEnumerator::putStorageTask(uint32_t shard_idx,
+                                             const Parameters& params) {
   auto task = std::make_unique<RebuildingEnumerateMetadataLogsTask>(
-      ref_holder_.ref(), max_num_shards_);
+      ref_holder_.ref(),
+      max_num_shards_,
+      params.rebuild_metadata_logs,
+      fast_path_ ? params.dirty_time_ranges : folly::none);
   auto task_queue =
       ServerWorker::onThisThread()->getStorageTaskQueueForShard(shard_idx);
   task_queue->putTask(std::move(task));
 }
 
-void RebuildingLogEnumerator::onMetaDataLogsStorageTaskDone(
+void RebuildingLogEnumerator::onStorageTaskDone(
     Status st,
     uint32_t shard_idx,
-    std::vector<logid_t> log_ids) {
+    std::vector<logid_t> metadata_logs,
+    folly::Optional<std::unordered_set<logid_t>> data_logs) {
   if (!shard_storage_tasks_remaining_.count(shard_idx)) {
     return; // ignore
   } else if (st != E::OK) {
@@ -139,9 +154,14 @@ void RebuildingLogEnumerator::onMetaDataLogsStorageTaskDone(
              error_description(st));
     ld_check_eq(st, E::LOCAL_LOG_STORE_READ);
   } else {
-    for (logid_t l : log_ids) {
+    for (logid_t l : metadata_logs) {
       results_.emplace(l, RecordTimestamp::min());
     }
+    if (data_logs.hasValue()) {
+      logs_in_dirty_ranges_.insert(data_logs->begin(), data_logs->end());
+    } else {
+      fast_path_ = false;
+    }
     shard_storage_tasks_remaining_.erase(shard_idx);
     maybeFinalize();
     // `this` may be destroyed here.
@@ -170,6 +190,25 @@ void RebuildingLogEnumerator::maybeFinalize() {
     return;
   }
 
+  if (fast_path_) {
+    size_t skipped = 0;
+    for (auto it = results_.begin(); it != results_.end();) {
+      logid_t log = it->first;
+      if (!MetaDataLog::isMetaDataLog(log) &&
+          !configuration::InternalLogs::isInternal(log) &&
+          !logs_in_dirty_ranges_.count(log)) {
+        it = results_.erase(it);
+        ++skipped;
+      } else {
+        ++it;
+      }
+    }
+    ld_info("Mini-rebuilding fast path: skipped %lu data logs that have no "
+            "records in dirty time ranges. %lu logs left to rebuild.",
+            skipped,
+            results_.size());
+  }
+
   finalized_ = true;
   callback_->onLogsEnumerated(std::move(results_), maxBacklogDuration_);
   // `this` may be destroyed here.
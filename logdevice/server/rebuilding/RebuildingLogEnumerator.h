@@ -7,6 +7,10 @@
  */
 #pragma once
 
+#include <unordered_set>
+
+#include <folly/Optional.h>
+
 #include "logdevice/common/Timestamp.h"
 #include "logdevice/common/WeakRefHolder.h"
 #include "logdevice/common/settings/RebuildingSettings.h"
@@ -24,9 +28,13 @@ class RebuildingLogEnumerator {
     bool rebuild_metadata_logs;
     RecordTimestamp min_timestamp;
     lsn_t version;
+    // If set, only data logs that have records in these time ranges on the
+    // shard are enumerated. See --rebuilding-mini-fast-path-max-duration.
+    folly::Optional<RecordTimeIntervals> dirty_time_ranges;
     inline bool operator==(const Parameters& o) const {
       return rebuild_metadata_logs == o.rebuild_metadata_logs &&
-          min_timestamp == o.min_timestamp && version == o.version;
+          min_timestamp == o.min_timestamp && version == o.version &&
+          dirty_time_ranges == o.dirty_time_ranges;
     }
   };
 
@@ -59,9 +67,12 @@ class RebuildingLogEnumerator {
   }
 
   void start();
-  void onMetaDataLogsStorageTaskDone(Status,
-                                     uint32_t shard_idx,
-                                     std::vector<logid_t> log_ids);
+  // `data_logs` is folly::none if the task wasn't asked to look for data
+  // logs in dirty time ranges, or if the local log store doesn't support it.
+  void onStorageTaskDone(Status,
+                         uint32_t shard_idx,
+                         std::vector<logid_t> metadata_logs,
+                         folly::Optional<std::unordered_set<logid_t>> data_logs);
 
   void abortShardIdx(shard_index_t shard_idx);
 
@@ -76,11 +87,16 @@ class RebuildingLogEnumerator {
   Results results_;
   WeakRefHolder<RebuildingLogEnumerator> ref_holder_;
   std::set<uint32_t> shard_storage_tasks_remaining_;
+  // True if all shards have dirty_time_ranges and all storage tasks so far
+  // found data logs in them. If still true when finalizing, data logs
+  // not in logs_in_dirty_ranges_ are dropped from results_.
+  bool fast_path_{false};
+  std::unordered_set<logid_t> logs_in_dirty_ranges_;
 
   bool finalized_{false};
 
   void maybeFinalize();
-  void putStorageTask(uint32_t shard_idx);
+  void putStorageTask(uint32_t shard_idx, const Parameters& params);
 };
 
 }} // namespace facebook::logdevice
@@ -57,9 +57,11 @@ void RebuildingReadStorageTask::execute() {
     }
 
     context->iterator = createIterator(opts, logs);
-    context->nextLocation =
-        std::shared_ptr<LocalLogStore::AllLogsIterator::Location>(
-            context->iterator->minLocation());
+    if (context->nextLocation == nullptr) {
+      context->nextLocation =
+          std::shared_ptr<LocalLogStore::AllLogsIterator::Location>(
+              context->iterator->minLocation());
+    }
 
     context->filter = std::make_unique<Filter>(context.get());
   }
@@ -72,6 +74,14 @@ void RebuildingReadStorageTask::execute() {
   LocalLogStore::ReadStats read_stats;
   read_stats.max_bytes_to_read = context->rebuildingSettings->max_batch_bytes;
   read_stats.max_execution_time = context->rebuildingSettings->max_batch_time;
+  if (getNumQueuedReadTasks() > 0) {
+    // Other reads are waiting for a storage thread, and we're low priority.
+    // Don't hold this thread for long.
+    read_stats.max_execution_time =
+        std::min(read_stats.max_execution_time,
+                 context->rebuildingSettings->max_batch_time_with_queued_reads);
+    STAT_INCR(stats, rebuilding_read_batches_shortened_for_reads);
+  }
   // Count iterator initialization and trim point fetching towards the
   // execution time limit.
   read_stats.read_start_time = start_time;
@@ -124,6 +134,9 @@ void RebuildingReadStorageTask::execute() {
       STAT_ADD(stats,
                rebuilding_num_records_late_filtered,
                context->filter->nRecordsLateFiltered);
+      STAT_ADD(stats,
+               rebuilding_num_record_ranges_nodeset_filtered,
+               context->filter->nRecordRangesNodesetFiltered);
 
       size_t tot_skipped = context->filter->nRecordsSCDFiltered +
           context->filter->nRecordsNotDirtyFiltered +
@@ -139,7 +152,8 @@ void RebuildingReadStorageTask::execute() {
           "Rebuilding has read a batch of records in %.3fs. Got %lu records "
           "(%lu bytes) in %lu chunks, read %lu bytes of rocksdb blocks. "
           "Skipped %lu records (SCD: %lu, ND: %lu, "
-          "DRAINED: %lu, TS: %lu, EPOCH: %lu; LATE: %lu).",
+          "DRAINED: %lu, TS: %lu, EPOCH: %lu; LATE: %lu). Skipped %lu record "
+          "ranges whose nodesets don't intersect the dirty shards.",
           std::chrono::duration_cast<std::chrono::duration<double>>(end_time -
                                                                     start_time)
               .count(),
@@ -153,7 +167,8 @@ void RebuildingReadStorageTask::execute() {
           context->filter->nRecordsDrainedFiltered,
           context->filter->nRecordsTimestampFiltered,
           context->filter->nRecordsEpochRangeFiltered,
-          context->filter->nRecordsLateFiltered);
+          context->filter->nRecordsLateFiltered,
+          context->filter->nRecordRangesNodesetFiltered);
     }
   };
 
@@ -196,6 +211,12 @@ void RebuildingReadStorageTask::execute() {
       // stop here without delivering it.
       break;
     }
+    if (context->stopLocation != nullptr &&
+        iterator->compareLocations(
+            *iterator->getLocation(), *context->stopLocation) >= 0) {
+      // Reached the end of the range this read pass is interested in.
+      break;
+    }
 
     logid_t log = iterator->getLogID();
     lsn_t lsn = iterator->getLSN();
@@ -297,7 +318,14 @@ void RebuildingReadStorageTask::execute() {
           std::shared_ptr<LocalLogStore::AllLogsIterator::Location>(
               iterator->getLocation());
       context->progress = iterator->getProgress();
-      break;
+      context->totalBytesEstimate = iterator->getTotalBytesEstimate();
+      if (context->stopLocation == nullptr ||
+          iterator->compareLocations(
+              *context->nextLocation, *context->stopLocation) < 0) {
+        break;
+      }
+      // Reached stopLocation. Treat it as end.
+      FOLLY_FALLTHROUGH;
     case IteratorState::AT_END:
       context->reachedEnd = true;
       context->nextLocation.reset();
@@ -326,22 +354,12 @@ int RebuildingReadStorageTask::checkRecordForBlockChange(
     Context::LogState* log_state,
     std::vector<ShardID>* temp_copyset,
     RecordTimestamp* out_timestamp) {
-  copyset_size_t new_copyset_size;
+  LocalLogStoreRecordFormat::RecordView view;
   Payload payload;
-  temp_copyset->resize(COPYSET_SIZE_MAX);
-  std::chrono::milliseconds timestamp;
-  int rv = LocalLogStoreRecordFormat::parse(record,
-                                            &timestamp,
-                                            nullptr,
-                                            nullptr,
-                                            nullptr,
-                                            &new_copyset_size,
-                                            temp_copyset->data(),
-                                            COPYSET_SIZE_MAX,
-                                            nullptr,
-                                            nullptr,
-                                            &payload,
-                                            context->myShardID.shard());
+  int rv = view.init(record);
+  if (rv == 0) {
+    rv = view.payload(&payload);
+  }
   if (rv != 0) {
     RATELIMIT_ERROR(std::chrono::seconds(1),
                     1,
@@ -351,8 +369,9 @@ int RebuildingReadStorageTask::checkRecordForBlockChange(
     ld_check(err == E::MALFORMED_RECORD);
     return -1;
   }
-  *out_timestamp = RecordTimestamp(timestamp);
-  temp_copyset->resize(new_copyset_size);
+  *out_timestamp = RecordTimestamp(view.timestamp());
+  temp_copyset->resize(view.copysetSize());
+  view.copyset(temp_copyset->data(), context->myShardID.shard());
   bool copyset_changed = (log_state->lastSeenCopyset != *temp_copyset);
   bool epoch_changed =
       lsn_to_epoch(log_state->lastSeenLSN) != lsn_to_epoch(lsn);
@@ -490,6 +509,9 @@ folly::Optional<NodeID> RebuildingReadStorageTask::getMyNodeID() {
 StatsHolder* RebuildingReadStorageTask::getStats() {
   return storageThreadPool_->stats();
 }
+size_t RebuildingReadStorageTask::getNumQueuedReadTasks() {
+  return storageThreadPool_->getNumQueuedTasks(ThreadType::SLOW);
+}
 
 std::unique_ptr<LocalLogStore::AllLogsIterator>
 RebuildingReadStorageTask::createIterator(
@@ -521,6 +543,7 @@ void RebuildingReadStorageTask::Filter::clearStats() {
   nRecordsDrainedFiltered = 0;
   nRecordsTimestampFiltered = 0;
   nRecordsEpochRangeFiltered = 0;
+  nRecordRangesNodesetFiltered = 0;
 }
 
 bool RebuildingReadStorageTask::Filter::shouldProcessTimeRange(
@@ -551,7 +574,7 @@ bool RebuildingReadStorageTask::Filter::shouldProcessTimeRange(
   cache.maxTs = max;
   bool have_shards_intersecting_range = false;
 
-  for (const auto& node_kv : context->rebuildingSet->shards) {
+  for (const auto& node_kv : context->getFilterRebuildingSet().shards) {
     ShardID shard = node_kv.first;
     auto& node_info = node_kv.second;
     if (node_info.dc_dirty_ranges.empty()) {
@@ -585,14 +608,8 @@ bool RebuildingReadStorageTask::Filter::shouldProcessRecordRange(
     logid_t log,
     lsn_t min_lsn,
     lsn_t max_lsn,
-    RecordTimestamp /* min_ts */,
-    RecordTimestamp /* max_ts */) {
-  // Note: we're not taking time ranges into account. I.e. if in some partition
-  // the effective rebuilding set (rebuilding set minus shardsOutsideTimeRange)
-  // doesn't intersect some log's nodeset, we could detect it here and skip
-  // this log in this partition. For simplicity we're not doing it currently.
-  // We're just skipping epoch ranges not covered by rebuilding plan.
-
+    RecordTimestamp min_ts,
+    RecordTimestamp max_ts) {
   if (!lookUpLogState(log)) {
     return false;
   }
@@ -610,21 +627,83 @@ bool RebuildingReadStorageTask::Filter::shouldProcessRecordRange(
                                 context,
                                 currentLogState,
                                 /* create_replication_scheme */ false);
-  // If min_lsn is covered by rebuilding plan, process the range.
-  if (first_epoch_good) {
-    return true;
-  }
   // If max_lsn is in the same, non-covered, epoch range as min_lsn, reject the
   // lsn range.
-  if (lsn_to_epoch(max_lsn) < currentLogState->currentEpochRange.second) {
+  if (!first_epoch_good &&
+      lsn_to_epoch(max_lsn) < currentLogState->currentEpochRange.second) {
+    return false;
+  }
+
+  // Some epochs of [min_lsn, max_lsn] are covered by the rebuilding plan, i.e.
+  // their nodesets intersect the rebuilding set. But in this partition some
+  // of the rebuilding shards may be clean (time-ranged rebuilding), so the
+  // effective rebuilding set may not intersect any of these nodesets. In that
+  // case no copyset in the range can contain a dirty shard, and we can skip
+  // the whole range without reading its copyset index.
+  if (!anyEpochAffected(min_lsn, max_lsn, min_ts, max_ts)) {
+    ++nRecordRangesNodesetFiltered;
     return false;
   }
 
-  // The epoch currentEpochRange.second is covered by plan and
-  // intersects [min_lsn, max_lsn]. Process the lsn range.
   return true;
 }
 
+bool RebuildingReadStorageTask::Filter::anyEpochAffected(
+    lsn_t min_lsn,
+    lsn_t max_lsn,
+    RecordTimestamp min_ts,
+    RecordTimestamp max_ts) {
+  // Shards outside the time range are only known if shouldProcessTimeRange()
+  // was called for this partition. Otherwise be conservative.
+  if (!timeRangeCache.valid(min_ts, max_ts) ||
+      timeRangeCache.shardsOutsideTimeRange.empty()) {
+    return true;
+  }
+
+  const epoch_t last_epoch = lsn_to_epoch(max_lsn);
+  epoch_t epoch = lsn_to_epoch(min_lsn);
+  while (true) {
+    std::pair<epoch_t, epoch_t> range;
+    auto metadata = currentLogState->plan.lookUpEpoch(epoch, &range);
+    if (metadata != nullptr && nodesetIntersectsDirtyShards(*metadata)) {
+      return true;
+    }
+    if (range.second > last_epoch || range.second <= epoch) {
+      return false;
+    }
+    epoch = range.second;
+  }
+}
+
+bool RebuildingReadStorageTask::Filter::nodesetIntersectsDirtyShards(
+    const EpochMetaData& metadata) {
+  // TODO(T43708398): like populateFilterParams(), only look at append dirty
+  // ranges.
+  const auto dc = DataClass::APPEND;
+  const auto& rebuilding_shards = context->getFilterRebuildingSet().shards;
+  for (ShardID shard : metadata.shards) {
+    auto it = rebuilding_shards.find(shard);
+    if (it == rebuilding_shards.end()) {
+      continue;
+    }
+    const auto& node_info = it->second;
+    if (node_info.dc_dirty_ranges.empty()) {
+      // Dirty for all time points.
+      return true;
+    }
+    auto dc_tr_kv = node_info.dc_dirty_ranges.find(dc);
+    if (dc_tr_kv == node_info.dc_dirty_ranges.end() ||
+        dc_tr_kv->second.empty()) {
+      continue;
+    }
+    if (!timeRangeCache.shardsOutsideTimeRange.count(
+            std::make_pair(shard, dc))) {
+      return true;
+    }
+  }
+  return false;
+}
+
 bool RebuildingReadStorageTask::Filter::
 operator()(logid_t log,
            lsn_t lsn,
@@ -741,10 +820,11 @@ RebuildingReadStorageTask::Filter::populateFilterParams(
   // append dirty ranges.
   auto dc = DataClass::APPEND;
 
+  const auto& rebuilding_shards = context->getFilterRebuildingSet().shards;
   for (copyset_off_t i = 0; i < copyset_size; ++i) {
     ShardID shard = copyset[i];
-    auto node_kv = context->rebuildingSet->shards.find(shard);
-    if (node_kv != context->rebuildingSet->shards.end()) {
+    auto node_kv = rebuilding_shards.find(shard);
+    if (node_kv != rebuilding_shards.end()) {
       auto& node_info = node_kv->second;
       if (!node_info.dc_dirty_ranges.empty()) {
         // Node is only partially dirty (time range data is provided).
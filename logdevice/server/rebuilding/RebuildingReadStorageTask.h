@@ -77,6 +77,14 @@ class RebuildingReadStorageTask : public StorageTask {
     // The onDone callback is called from worker thread.
     std::function<void(std::vector<std::unique_ptr<ChunkData>>)> onDone;
     std::shared_ptr<const RebuildingSet> rebuildingSet;
+    // If not nullptr, only records that need to be rebuilt for shards in this
+    // set (a subset of `rebuildingSet`) pass the filter. `rebuildingSet` is
+    // still used for everything else, e.g. for excluding rebuilding shards
+    // from recipients. Used for ShardRebuilding's follow-up read pass.
+    std::shared_ptr<const RebuildingSet> filterRebuildingSet;
+    // If not nullptr, reading stops (reachedEnd is set) upon reaching this
+    // location.
+    std::shared_ptr<LocalLogStore::AllLogsIterator::Location> stopLocation;
     UpdateableSettings<RebuildingSettings> rebuildingSettings;
     ShardID myShardID;
 
@@ -89,6 +97,11 @@ class RebuildingReadStorageTask : public StorageTask {
     // there's no need for a mutex.
     mutable std::mutex logsMutex;
 
+    // The set of shards whose records the filter is looking for.
+    const RebuildingSet& getFilterRebuildingSet() const {
+      return filterRebuildingSet ? *filterRebuildingSet : *rebuildingSet;
+    }
+
     // What to read.
     std::unordered_map<logid_t, LogState> logs;
     // A long-living main iterator. If nullptr, the storage task will create it.
@@ -96,7 +109,8 @@ class RebuildingReadStorageTask : public StorageTask {
     // at nextLocation.
     std::unique_ptr<LocalLogStore::AllLogsIterator> iterator;
     // The first location not processed yet.
-    // Next storage task needs to start reading from here.
+    // Next storage task needs to start reading from here. If nullptr when the
+    // iterator is created, reading starts from the beginning.
     std::shared_ptr<LocalLogStore::AllLogsIterator::Location> nextLocation;
     // If we encounter too many invalid records, stall rebuilding just in case.
     size_t numMalformedRecordsSeen{0};
@@ -108,6 +122,8 @@ class RebuildingReadStorageTask : public StorageTask {
     // What fraction of data we have read, approximately. Between 0 and 1.
     // -1 if not supported.
     double progress = 0;
+    // Approximate total bytes that `progress` is a fraction of. 0 if unknown.
+    size_t totalBytesEstimate = 0;
 
     // Bytes read (including CSI, filtered out records and and other overhead)
     // by the last storage task.
@@ -162,6 +178,8 @@ class RebuildingReadStorageTask : public StorageTask {
   virtual std::shared_ptr<UpdateableConfig> getConfig();
   virtual folly::Optional<NodeID> getMyNodeID();
   virtual StatsHolder* getStats();
+  // Number of tasks waiting for a slow storage thread of this shard.
+  virtual size_t getNumQueuedReadTasks();
 
   virtual std::unique_ptr<LocalLogStore::AllLogsIterator> createIterator(
       const LocalLogStore::ReadOptions& opts,
@@ -209,6 +227,20 @@ class RebuildingReadStorageTask : public StorageTask {
     // and returns false.
     bool lookUpLogState(logid_t log);
 
+    // Returns true if at least one epoch range of the current log that
+    // intersects [min_lsn, max_lsn] and is covered by the rebuilding plan has a
+    // nodeset containing a shard that is dirty in time range [min_ts, max_ts].
+    // Uses timeRangeCache, so it's conservative (returns true) if the time
+    // range doesn't match the one passed to shouldProcessTimeRange().
+    bool anyEpochAffected(lsn_t min_lsn,
+                          lsn_t max_lsn,
+                          RecordTimestamp min_ts,
+                          RecordTimestamp max_ts);
+
+    // Whether the nodeset contains a shard from the rebuilding set that is
+    // not in timeRangeCache.shardsOutsideTimeRange.
+    bool nodesetIntersectsDirtyShards(const EpochMetaData& metadata);
+
     // Update stats regarding skipped records.
     // @param late  true if the filter was called on the full record rather
     // than CSI entry.
@@ -278,6 +310,10 @@ class RebuildingReadStorageTask : public StorageTask {
     size_t nRecordsDrainedFiltered{std::numeric_limits<size_t>::max() / 2};
     size_t nRecordsTimestampFiltered{std::numeric_limits<size_t>::max() / 2};
     size_t nRecordsEpochRangeFiltered{std::numeric_limits<size_t>::max() / 2};
+    // Number of (log, partition) record ranges skipped as a whole because no
+    // shard of their nodesets is dirty in the partition's time range.
+    size_t nRecordRangesNodesetFiltered{std::numeric_limits<size_t>::max() /
+                                        2};
   };
 
   std::weak_ptr<Context> context_;
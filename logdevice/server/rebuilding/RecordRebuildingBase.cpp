@@ -15,6 +15,7 @@
 #include "logdevice/common/Processor.h"
 #include "logdevice/common/stats/PerShardHistograms.h"
 #include "logdevice/server/ServerWorker.h"
+#include "logdevice/server/rebuilding/AmendBatcher.h"
 #include "logdevice/server/storage_tasks/PerWorkerStorageTaskQueue.h"
 #include "logdevice/server/storage_tasks/ShardedStorageThreadPool.h"
 
@@ -288,6 +289,10 @@ int RecordRebuildingBase::sendStore(StageRecipients::Type type,
           owner_->getLogID().val_,
           lsn_to_string(lsn_).c_str(),
           recipient.shard_.toString().c_str());
+  if (amend && queueBatchedAmend(recipient, message)) {
+    ld_check(recipient.isStoreInFlight());
+    return 0;
+  }
   int rv = sender_->sendMessage(std::move(message),
                                 recipient.shard_.asNodeID(),
                                 &recipient.on_bw_avail,
@@ -319,6 +324,26 @@ int RecordRebuildingBase::sendStore(StageRecipients::Type type,
   return 0;
 }
 
+bool RecordRebuildingBase::queueBatchedAmend(
+    RecipientNode& recipient,
+    std::unique_ptr<STORE_Message>& message) {
+  if (!owner_->getRebuildingSettings()->amend_batching) {
+    return false;
+  }
+  ServerWorker* worker = ServerWorker::onThisThread();
+  // Only batch once there is a connection to the node, so that the
+  // recipient can find out if it closes before the amend gets a reply.
+  // The first amend to a node goes out on its own and opens the connection.
+  if (worker->sender().registerOnSocketClosed(
+          Address(recipient.shard_.asNodeID()), recipient.on_socket_close) !=
+      0) {
+    return false;
+  }
+  worker->amendBatcher().queue(
+      recipient.shard_.node(), std::move(message));
+  return true;
+}
+
 std::unique_ptr<STORE_Message>
 RecordRebuildingBase::buildStoreMessage(ShardID target_shard, bool amend) {
   RebuildingStoreChain copyset(newCopyset_.size());
@@ -717,7 +742,10 @@ bool RecordRebuildingBase::checkEveryoneStillInConfig() {
 
 PutWriteOp RecordRebuildingBase::AmendSelfStorageTask::createWriteOp(
     const RecordRebuildingBase& owner) {
-  auto record_header_flags = owner.recordFlags_ |
+  // The amend has no payload, so it's never compressed.
+  auto record_header_flags =
+      (owner.recordFlags_ &
+       ~LocalLogStoreRecordFormat::FLAG_PAYLOAD_COMPRESSED) |
       LocalLogStoreRecordFormat::FLAG_AMEND |
       (owner.replication_->relocate_local_records
            ? LocalLogStoreRecordFormat::FLAG_DRAINED
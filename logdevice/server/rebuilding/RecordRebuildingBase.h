@@ -406,6 +406,11 @@ class RecordRebuildingBase : public RecordRebuildingInterface {
   virtual void deferredComplete();
   virtual uint32_t getStoreTimeoutMs() const;
   virtual void putAmendSelfTask(std::unique_ptr<AmendSelfStorageTask> task);
+  // Hands an amend for `recipient' to the worker's AmendBatcher, which sends
+  // it together with amends of other logs for the same node. Returns false if
+  // the amend should be sent on its own, leaving `message' untouched.
+  virtual bool queueBatchedAmend(RecipientNode& recipient,
+                                 std::unique_ptr<STORE_Message>& message);
 
   /**
    * Called when this state machine completes. Inform the owner
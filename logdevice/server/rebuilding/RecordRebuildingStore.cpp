@@ -156,6 +156,21 @@ int RecordRebuildingStore::parseRecord() {
     recordOrPayload_.trimStart(payload_ptr - record_ptr);
   }
 
+  if (recordFlags_ & LocalLogStoreRecordFormat::FLAG_PAYLOAD_COMPRESSED) {
+    // Send the payload the way it was appended. The recipients compress it
+    // again if the log's storage_compression attribute says so.
+    folly::IOBuf uncompressed;
+    rv = LocalLogStoreRecordFormat::uncompressPayload(payload, &uncompressed);
+    if (rv != 0) {
+      ld_error("Refusing to rebuild record %lu%s with malformed compressed "
+               "payload.",
+               owner_->getLogID().val_,
+               lsn_to_string(lsn_).c_str());
+      return -1;
+    }
+    recordOrPayload_ = std::move(uncompressed);
+  }
+
   return 0;
 }
 
@@ -7,9 +7,14 @@
  */
 #include "logdevice/server/rebuilding/ShardRebuilding.h"
 
+#include <cmath>
+
 #include "logdevice/common/AdminCommandTable.h"
 #include "logdevice/common/MetaDataLog.h"
 #include "logdevice/common/configuration/InternalLogs.h"
+#include "logdevice/common/stats/Histogram.h"
+#include "logdevice/common/stats/PerShardHistograms.h"
+#include "logdevice/common/stats/ServerHistograms.h"
 #include "logdevice/server/ServerWorker.h"
 #include "logdevice/server/storage_tasks/PerWorkerStorageTaskQueue.h"
 
@@ -19,8 +24,18 @@ namespace facebook { namespace logdevice {
 static constexpr std::chrono::milliseconds PROFILING_TIMER_PERIOD =
     std::chrono::minutes(1);
 
+// How much auto-tuning raises throttleFactor_ per interval when client
+// latency is below target.
+static constexpr double AUTO_TUNE_INCREASE_STEP = .1;
+
 std::atomic<chunk_rebuilding_id_t::raw_type> ShardRebuilding::nextChunkID_{0};
 
+struct ShardRebuilding::ClientLatencySnapshot {
+  SketchLatencyHistogram append;
+  CompactLatencyHistogram readQueue;
+  CompactLatencyHistogram readExecution;
+};
+
 ShardRebuilding::ShardRebuilding(
     shard_index_t shard,
     lsn_t rebuilding_version,
@@ -50,8 +65,9 @@ ShardRebuilding::~ShardRebuilding() {
 
 void ShardRebuilding::abortChunkRebuildings() {
   for (const auto& p : chunkRebuildings_) {
+    ld_check(chunkWorkerType_.hasValue());
     std::unique_ptr<Request> rq = std::make_unique<AbortChunkRebuildingRequest>(
-        p.second.workerID, p.first.chunkID);
+        p.second.workerID, *chunkWorkerType_, p.first.chunkID);
     int rv = Worker::onThisThread()->processor_->postImportant(rq);
     if (rv != 0) {
       // If we're shutting down, ServerWorker itself will clean up all chunk
@@ -66,25 +82,24 @@ void ShardRebuilding::start(
   numLogs_ = plan.size();
   startTime_ = SteadyTimestamp::now();
   readingProgressTimestamp_ = direction_.firstTimestamp();
-  readRateLimiter_ = RateLimiter(rebuildingSettings_->rate_limit);
-  readContext_ = std::make_shared<RebuildingReadStorageTask::Context>();
-  readContext_->onDone = [this, this_ref = callbackHelper_.getHolder().ref()](
-                             std::vector<std::unique_ptr<ChunkData>> chunks) {
-    if (this_ref.get() != nullptr) {
-      onReadTaskDone(std::move(chunks));
-    }
-  };
-  readContext_->rebuildingSet = rebuildingSet_;
-  readContext_->rebuildingSettings = rebuildingSettings_;
-  readContext_->myShardID = ShardID(getMyNodeIndex(), shard_);
-  readContext_->progressTimestamp = direction_.firstTimestamp();
+  readRateLimiter_ = RateLimiter(scaledReadRateLimit());
 
+  std::unordered_map<logid_t, RebuildingPlan> plans;
   for (const auto& log_plan : plan) {
-    auto ins = readContext_->logs.emplace(
-        std::piecewise_construct,
-        std::forward_as_tuple(log_plan.first),
-        std::forward_as_tuple(std::move(*log_plan.second)));
-    ld_check(ins.second);
+    if (resumeLocation_ != nullptr) {
+      followUpPlan_.emplace(log_plan.first, *log_plan.second);
+    }
+    plans.emplace(log_plan.first, std::move(*log_plan.second));
+  }
+  readContext_ = createReadContext(std::move(plans));
+  if (resumeLocation_ != nullptr) {
+    ld_info("Resuming rebuilding of shard %u from %s. Shards added to "
+            "rebuilding set: %s",
+            shard_,
+            resumeLocation_->toString().c_str(),
+            addedShards_->describe().c_str());
+    readContext_->nextLocation = resumeLocation_;
+    nextLocation_ = resumeLocation_;
   }
 
   delayedReadTimer_ = createTimer([this] { tryMakeProgress(); });
@@ -96,6 +111,192 @@ void ShardRebuilding::start(
 
   profilingTimer_->activate(PROFILING_TIMER_PERIOD);
 
+  autoTuneTimer_ = createTimer([this] { autoTune(); });
+  if (autoTuneEnabled()) {
+    PER_SHARD_STAT_SET(getStats(), rebuilding_auto_tune_percent, shard_, 100);
+    autoTuneTimer_->activate(rebuildingSettings_->auto_tune_interval);
+  }
+
+  tryMakeProgress();
+}
+
+std::shared_ptr<RebuildingReadStorageTask::Context>
+ShardRebuilding::createReadContext(
+    std::unordered_map<logid_t, RebuildingPlan> plan) {
+  auto context = std::make_shared<RebuildingReadStorageTask::Context>();
+  context->onDone = [this, this_ref = callbackHelper_.getHolder().ref()](
+                        std::vector<std::unique_ptr<ChunkData>> chunks) {
+    if (this_ref.get() != nullptr) {
+      onReadTaskDone(std::move(chunks));
+    }
+  };
+  context->rebuildingSet = rebuildingSet_;
+  context->rebuildingSettings = rebuildingSettings_;
+  context->myShardID = ShardID(getMyNodeIndex(), shard_);
+  context->progressTimestamp = direction_.firstTimestamp();
+
+  for (auto& log_plan : plan) {
+    auto ins = context->logs.emplace(
+        std::piecewise_construct,
+        std::forward_as_tuple(log_plan.first),
+        std::forward_as_tuple(std::move(log_plan.second)));
+    ld_check(ins.second);
+  }
+  return context;
+}
+
+void ShardRebuilding::resumeFrom(
+    std::shared_ptr<const Checkpoint> checkpoint,
+    std::shared_ptr<const RebuildingSet> added_shards) {
+  ld_check(readContext_ == nullptr);
+  ld_check(added_shards != nullptr);
+  auto c = std::dynamic_pointer_cast<const ReadCheckpoint>(checkpoint);
+  ld_check(c != nullptr);
+  if (c == nullptr) {
+    return;
+  }
+  if (c->newToOld != direction_.new_to_old) {
+    ld_info("Not resuming rebuilding of shard %u from checkpoint %s because "
+            "rebuilding direction has changed.",
+            shard_,
+            c->location->toString().c_str());
+    return;
+  }
+  resumeLocation_ = c->location;
+  addedShards_ = std::move(added_shards);
+}
+
+void ShardRebuilding::expectMorePlans() {
+  ld_check(readContext_ == nullptr);
+  ld_check(resumeLocation_ == nullptr);
+  waitingForMorePlans_ = true;
+}
+
+void ShardRebuilding::addPlans(
+    std::unordered_map<logid_t, std::unique_ptr<RebuildingPlan>> plans,
+    bool last) {
+  ld_check(waitingForMorePlans_);
+  ld_check(readContext_ != nullptr);
+  for (auto& log_plan : plans) {
+    pendingPlans_.emplace(log_plan.first, std::move(*log_plan.second));
+  }
+  if (last) {
+    ld_info("Got all rebuilding plans for shard %u. Reading %lu logs, %lu "
+            "more logs pending, %lu logs joined after reading started.",
+            shard_,
+            numLogs_,
+            pendingPlans_.size(),
+            followUpPlan_.size());
+    waitingForMorePlans_ = false;
+  }
+  tryMakeProgress();
+}
+
+void ShardRebuilding::applyPendingPlansIfNeeded() {
+  if (pendingPlans_.empty() || storageTaskInFlight_) {
+    return;
+  }
+  ld_check(!inFollowUpPass_);
+  ld_check(addedShards_ == nullptr);
+
+  const bool reached_end = readContext_->reachedEnd;
+  if (waitingForMorePlans_ && !reached_end && readTasksDone_ > 0 &&
+      pendingPlans_.size() < numLogs_) {
+    // Wait for more plans to accumulate. This way the iterator is recreated
+    // a logarithmic number of times.
+    return;
+  }
+
+  if (readTasksDone_ > 0) {
+    // The read pass has already gone past some records of these logs. Read
+    // them in a follow-up pass, up to where they joined.
+    if (reached_end) {
+      lateLogsReadToEnd_ = true;
+    } else {
+      ld_check(readContext_->nextLocation != nullptr);
+      lateLogsStopLocation_ = readContext_->nextLocation;
+    }
+    for (const auto& log_plan : pendingPlans_) {
+      followUpPlan_.emplace(log_plan.first, log_plan.second);
+    }
+  }
+
+  if (!reached_end) {
+    {
+      std::lock_guard<std::mutex> lock(readContext_->logsMutex);
+      for (auto& log_plan : pendingPlans_) {
+        readContext_->logs.emplace(std::piecewise_construct,
+                                   std::forward_as_tuple(log_plan.first),
+                                   std::forward_as_tuple(
+                                       std::move(log_plan.second)));
+      }
+    }
+    numLogs_ += pendingPlans_.size();
+    if (readContext_->iterator != nullptr) {
+      // The iterator only reads the logs it was created for. The next storage
+      // task will create a new one and seek it to nextLocation.
+      iteratorInvalidationTimer_->cancel();
+      readContext_->iterator.reset();
+    }
+  }
+  pendingPlans_.clear();
+}
+
+std::shared_ptr<const ShardRebuildingInterface::Checkpoint>
+ShardRebuilding::getCheckpoint() const {
+  // If we have a follow-up pass pending, or some logs haven't been planned
+  // yet, the checkpoint doesn't cover everything before it, so we can't be
+  // resumed.
+  if (addedShards_ != nullptr || waitingForMorePlans_ ||
+      !pendingPlans_.empty() || !followUpPlan_.empty() || inFollowUpPass_ ||
+      checkpointLocation_ == nullptr) {
+    return nullptr;
+  }
+  auto checkpoint = std::make_shared<ReadCheckpoint>();
+  checkpoint->location = checkpointLocation_;
+  checkpoint->newToOld = direction_.new_to_old;
+  ld_check_ge(bytesRead_, checkpointBytesRead_);
+  checkpoint->bytesReadPastCheckpoint = bytesRead_ - checkpointBytesRead_;
+  return checkpoint;
+}
+
+size_t ShardRebuilding::getBytesRead() const {
+  return bytesRead_;
+}
+
+void ShardRebuilding::startFollowUpPass() {
+  ld_check(addedShards_ != nullptr || !followUpPlan_.empty());
+  ld_check(!inFollowUpPass_);
+  ld_check(readBatches_.empty());
+  std::shared_ptr<Location> stop_location;
+  if (addedShards_ != nullptr) {
+    ld_info("Rebuilding of shard %u has read everything after %s. Starting a "
+            "follow-up pass over records before that for shards added to "
+            "rebuilding set: %s",
+            shard_,
+            resumeLocation_->toString().c_str(),
+            addedShards_->describe().c_str());
+    stop_location = resumeLocation_;
+  } else {
+    if (!lateLogsReadToEnd_) {
+      stop_location = lateLogsStopLocation_;
+    }
+    ld_info("Rebuilding of shard %u has read everything. Starting a "
+            "follow-up pass up to %s for %lu logs that got planned after "
+            "reading had started.",
+            shard_,
+            stop_location ? stop_location->toString().c_str() : "the end",
+            followUpPlan_.size());
+  }
+  inFollowUpPass_ = true;
+  numLogs_ = followUpPlan_.size();
+  readContext_ = createReadContext(std::move(followUpPlan_));
+  followUpPlan_.clear();
+  readContext_->filterRebuildingSet = addedShards_;
+  readContext_->stopLocation = stop_location;
+  nextLocation_ = nullptr;
+  readingProgressTimestamp_ = direction_.firstTimestamp();
+  readingProgress_ = 0;
   tryMakeProgress();
 }
 
@@ -114,6 +315,8 @@ void ShardRebuilding::sendStorageTaskIfNeeded() {
   // This could be a separate setting, but that doesn't seem very useful.
   const size_t max_read_buffer_size = read_batch_size * 3;
 
+  readThrottled_ = false;
+
   // Note that reading is not affected by global window or
   // max_record_bytes_in_flight. Reading just tries to keep readBuffer_
   // reasonably full.
@@ -129,6 +332,7 @@ void ShardRebuilding::sendStorageTaskIfNeeded() {
   std::chrono::steady_clock::duration to_wait;
   bool allowed = readRateLimiter_.isAllowed(
       0, &to_wait, std::chrono::steady_clock::duration::zero());
+  readThrottled_ = !allowed && throttleFactor_ < 1;
   if (!allowed) {
     if (to_wait != std::chrono::steady_clock::duration::max()) {
       delayedReadTimer_->activate(
@@ -173,17 +377,26 @@ void ShardRebuilding::onReadTaskDone(
   std::chrono::steady_clock::duration unused;
   readRateLimiter_.isAllowed(readContext_->bytesRead, &unused);
 
+  bytesRead_ += readContext_->bytesRead;
+  const size_t batch = nextReadBatch_++;
+  readBatches_.emplace(
+      batch, ReadBatch{readContext_->nextLocation, bytesRead_, chunks.size()});
+
   for (auto& c : chunks) {
     bytesInReadBuffer_ += c->totalBytes();
+    bytesSelected_ += c->totalBytes();
   }
   readBuffer_.insert(readBuffer_.end(),
                      std::make_move_iterator(chunks.begin()),
                      std::make_move_iterator(chunks.end()));
+  readBufferBatches_.insert(readBufferBatches_.end(), chunks.size(), batch);
   storageTaskInFlight_ = false;
   ++readTasksDone_;
+  advanceCheckpoint();
   nextLocation_ = readContext_->nextLocation;
   readingProgressTimestamp_ = readContext_->progressTimestamp;
   readingProgress_ = readContext_->progress;
+  readingTotalBytes_ = readContext_->totalBytesEstimate;
   if (readContext_->iterator != nullptr) {
     iteratorInvalidationTimer_->activate(getIteratorTTL());
   }
@@ -192,9 +405,9 @@ void ShardRebuilding::onReadTaskDone(
 
 void ShardRebuilding::startSomeChunkRebuildingsIfNeeded() {
   const size_t max_records_in_flight =
-      rebuildingSettings_->max_records_in_flight;
+      scaleLimit(rebuildingSettings_->max_records_in_flight);
   const size_t max_bytes_in_flight =
-      rebuildingSettings_->max_record_bytes_in_flight;
+      scaleLimit(rebuildingSettings_->max_record_bytes_in_flight);
   const bool new_to_old = rebuildingSettings_->new_to_old;
 
   auto is_log_exempted_from_window = [&](logid_t log) {
@@ -256,6 +469,8 @@ void ShardRebuilding::startSomeChunkRebuildingsIfNeeded() {
     chunk_rebuilding_id_t chunk_id{++nextChunkID_};
     std::unique_ptr<ChunkData> chunk = std::move(readBuffer_.front());
     readBuffer_.pop_front();
+    const size_t read_batch = readBufferBatches_.front();
+    readBufferBatches_.pop_front();
     ld_check_ge(bytesInReadBuffer_, chunk->totalBytes());
     bytesInReadBuffer_ -= chunk->totalBytes();
 
@@ -266,6 +481,7 @@ void ShardRebuilding::startSomeChunkRebuildingsIfNeeded() {
     info.address = chunk->address;
     info.numRecords = chunk->numRecords();
     info.totalBytes = chunk->totalBytes();
+    info.readBatch = read_batch;
 
     worker_id_t worker_id = startChunkRebuilding(std::move(chunk), chunk_id);
     if (worker_id == WORKER_ID_INVALID) {
@@ -280,6 +496,15 @@ void ShardRebuilding::startSomeChunkRebuildingsIfNeeded() {
     chunkRebuildings_.emplace(key, info);
   }
 
+  // Did we stop because of limits that auto-tuning scaled down?
+  storeThrottled_ = !readBuffer_.empty() && throttleFactor_ < 1 &&
+      (chunkRebuildingRecordsInFlight_ >= max_records_in_flight ||
+       chunkRebuildingBytesInFlight_ >= max_bytes_in_flight) &&
+      chunkRebuildingRecordsInFlight_ <
+          rebuildingSettings_->max_records_in_flight &&
+      chunkRebuildingBytesInFlight_ <
+          rebuildingSettings_->max_record_bytes_in_flight;
+
   // Find the chunk with the least advanced timestamp that is in the process
   // of being rebuilt, and publish this chunk's timestamp so other donors
   // can update the position of the global window.
@@ -324,8 +549,14 @@ worker_id_t
 ShardRebuilding::startChunkRebuilding(std::unique_ptr<ChunkData> chunk,
                                       chunk_rebuilding_id_t chunk_id) {
   Processor* processor = Worker::onThisThread()->processor_;
-  worker_id_t worker_id = processor->selectWorkerRandomly(
-      chunk_id.val(), StartChunkRebuildingRequest::workerType);
+  if (!chunkWorkerType_.hasValue()) {
+    chunkWorkerType_ = rebuildingSettings_->chunks_on_background_workers &&
+            processor->getWorkerCount(WorkerType::BACKGROUND) > 0
+        ? WorkerType::BACKGROUND
+        : WorkerType::GENERAL;
+  }
+  worker_id_t worker_id =
+      processor->selectWorkerRandomly(chunk_id.val(), *chunkWorkerType_);
 
   auto chunk_rebuilding =
       std::make_unique<ChunkRebuilding>(std::move(chunk),
@@ -337,7 +568,7 @@ ShardRebuilding::startChunkRebuilding(std::unique_ptr<ChunkData> chunk,
                                         shard_,
                                         callbackHelper_.ticket());
   std::unique_ptr<Request> rq = std::make_unique<StartChunkRebuildingRequest>(
-      worker_id, std::move(chunk_rebuilding));
+      worker_id, *chunkWorkerType_, std::move(chunk_rebuilding));
   int rv = processor->postImportant(rq);
   if (rv != 0) {
     ld_check_eq(err, E::SHUTDOWN);
@@ -364,11 +595,31 @@ void ShardRebuilding::onChunkRebuildingDone(chunk_rebuilding_id_t chunk_id,
   PER_SHARD_STAT_ADD(getStats(), records_rebuilt, shard_, info.numRecords);
   PER_SHARD_STAT_ADD(getStats(), bytes_rebuilt, shard_, info.totalBytes);
 
+  auto batch_it = readBatches_.find(info.readBatch);
+  ld_check(batch_it != readBatches_.end());
+  ld_check_gt(batch_it->second.chunksLeft, 0);
+  --batch_it->second.chunksLeft;
+
   chunkRebuildings_.erase(it);
 
+  advanceCheckpoint();
   tryMakeProgress();
 }
 
+void ShardRebuilding::advanceCheckpoint() {
+  while (!readBatches_.empty() &&
+         readBatches_.begin()->second.chunksLeft == 0) {
+    const ReadBatch& batch = readBatches_.begin()->second;
+    // endLocation is nullptr if the read task reached the end. There's no
+    // point resuming from there, so keep the previous checkpoint.
+    if (batch.endLocation != nullptr) {
+      checkpointLocation_ = batch.endLocation;
+      checkpointBytesRead_ = batch.bytesRead;
+    }
+    readBatches_.erase(readBatches_.begin());
+  }
+}
+
 void ShardRebuilding::finalizeIfNeeded() {
   // We're done if reading has reached the end, read buffer was drained,
   // and all chunk rebuildings have completed.
@@ -381,9 +632,20 @@ void ShardRebuilding::finalizeIfNeeded() {
       !chunkRebuildings_.empty()) {
     return;
   }
+  if (waitingForMorePlans_) {
+    // Some logs may still need rebuilding. Wait for their plans.
+    return;
+  }
+  if ((addedShards_ != nullptr || !followUpPlan_.empty()) &&
+      !inFollowUpPass_) {
+    // The first pass started in the middle, or some logs joined it in the
+    // middle. Go back to read what we skipped.
+    startFollowUpPass();
+    return;
+  }
   completed_ = true;
   ld_info("Rebuilt shard %u in %.3fs (%s). Rebuilt %lu chunks, %lu records, "
-          "%lu bytes. Executed %lu read storage tasks.",
+          "%lu bytes. Executed %lu read storage tasks, read %lu bytes.",
           shard_,
           std::chrono::duration_cast<std::chrono::duration<double>>(
               SteadyTimestamp::now() - startTime_)
@@ -392,11 +654,13 @@ void ShardRebuilding::finalizeIfNeeded() {
           chunksRebuilt_,
           recordsRebuilt_,
           bytesRebuilt_,
-          readTasksDone_);
+          readTasksDone_,
+          bytesRead_);
   listener_->onShardRebuildingComplete(shard_);
 }
 
 void ShardRebuilding::tryMakeProgress() {
+  applyPendingPlansIfNeeded();
   startSomeChunkRebuildingsIfNeeded();
   sendStorageTaskIfNeeded();
   updateProfilingState();
@@ -410,10 +674,148 @@ void ShardRebuilding::noteConfigurationChanged() {
 }
 
 void ShardRebuilding::noteRebuildingSettingsChanged() {
-  readRateLimiter_.update(rebuildingSettings_->rate_limit);
+  if (!autoTuneEnabled()) {
+    throttleFactor_ = 1.;
+    if (autoTuneTimer_ != nullptr) {
+      autoTuneTimer_->cancel();
+    }
+  } else {
+    throttleFactor_ =
+        std::max(throttleFactor_, rebuildingSettings_->auto_tune_min_factor);
+    if (autoTuneTimer_ != nullptr && !autoTuneTimer_->isActive()) {
+      autoTuneTimer_->activate(rebuildingSettings_->auto_tune_interval);
+    }
+  }
+  readRateLimiter_.update(scaledReadRateLimit());
+  tryMakeProgress();
+}
+
+bool ShardRebuilding::autoTuneEnabled() const {
+  return rebuildingSettings_->auto_tune_append_p99_target.count() > 0 ||
+      rebuildingSettings_->auto_tune_read_p99_target.count() > 0;
+}
+
+size_t ShardRebuilding::scaleLimit(size_t limit) const {
+  if (throttleFactor_ >= 1) {
+    return limit;
+  }
+  return std::max<size_t>(1, limit * throttleFactor_);
+}
+
+rate_limit_t ShardRebuilding::scaledReadRateLimit() const {
+  rate_limit_t limit = rebuildingSettings_->rate_limit;
+  if (limit.second.count() > 0) {
+    // Unlimited reads stay unlimited; they're still throttled indirectly by
+    // the in-flight limits, since reading only keeps readBuffer_ full.
+    limit.first = scaleLimit(limit.first);
+  }
+  return limit;
+}
+
+void ShardRebuilding::autoTune() {
+  if (!autoTuneEnabled()) {
+    return;
+  }
+  std::chrono::microseconds append_p99, read_p99;
+  getClientLatencyP99(&append_p99, &read_p99);
+
+  const auto append_target = rebuildingSettings_->auto_tune_append_p99_target;
+  const auto read_target = rebuildingSettings_->auto_tune_read_p99_target;
+  const bool over_target =
+      (append_target.count() > 0 && append_p99 > append_target) ||
+      (read_target.count() > 0 && read_p99 > read_target);
+
+  const double prev_factor = throttleFactor_;
+  if (over_target) {
+    throttleFactor_ = std::max(
+        throttleFactor_ / 2, rebuildingSettings_->auto_tune_min_factor);
+    PER_SHARD_STAT_INCR(getStats(), rebuilding_auto_tune_backoffs, shard_);
+  } else {
+    throttleFactor_ = std::min(1., throttleFactor_ + AUTO_TUNE_INCREASE_STEP);
+  }
+  PER_SHARD_STAT_SET(getStats(),
+                     rebuilding_auto_tune_percent,
+                     shard_,
+                     static_cast<int64_t>(throttleFactor_ * 100 + .5));
+  if (throttleFactor_ != prev_factor) {
+    RATELIMIT_INFO(std::chrono::seconds(10),
+                   2,
+                   "Rebuilding of shard %u %s throughput to %.0f%% of "
+                   "configured limits. Client p99 latency: append %.3fms "
+                   "(target %ldms), read %.3fms (target %ldms)",
+                   shard_,
+                   over_target ? "throttled" : "raised",
+                   throttleFactor_ * 100,
+                   append_p99.count() / 1e3,
+                   append_target.count(),
+                   read_p99.count() / 1e3,
+                   read_target.count());
+    readRateLimiter_.update(scaledReadRateLimit());
+  }
+
+  autoTuneTimer_->activate(rebuildingSettings_->auto_tune_interval);
   tryMakeProgress();
 }
 
+void ShardRebuilding::getClientLatencyP99(std::chrono::microseconds* append,
+                                          std::chrono::microseconds* read) {
+  *append = *read = std::chrono::microseconds::zero();
+  StatsHolder* stats = getStats();
+  if (stats == nullptr) {
+    return;
+  }
+
+  // Aggregate only the histograms we need rather than calling
+  // StatsHolder::aggregate(), which would copy all stats.
+  auto current = std::make_unique<ClientLatencySnapshot>();
+  const std::array<StorageTaskType, 2> read_types = {
+      StorageTaskType::READ_BACKLOG, StorageTaskType::READ_TAIL};
+  stats->runForEach([&](Stats& s) {
+    if (s.server_histograms) {
+      current->append.merge(s.server_histograms->append_latency);
+    }
+    if (s.per_shard_histograms) {
+      for (StorageTaskType type : read_types) {
+        auto& queue =
+            s.per_shard_histograms->storage_task_queue_time[(int)type];
+        auto& execution = s.per_shard_histograms->storage_tasks[(int)type];
+        if (queue.getNumShards() > shard_) {
+          current->readQueue.merge(*queue.get(shard_));
+        }
+        if (execution.getNumShards() > shard_) {
+          current->readExecution.merge(*execution.get(shard_));
+        }
+      }
+    }
+  });
+
+  if (clientLatencySnapshot_ == nullptr) {
+    // First sample. We only want latency since the previous call.
+    clientLatencySnapshot_ = std::move(current);
+    return;
+  }
+
+  auto p99 = [](HistogramInterface& cur, const HistogramInterface& prev) {
+    // `cur` is overwritten with the delta.
+    cur.subtract(prev);
+    if (cur.getCountAndSum().first == 0) {
+      return std::chrono::microseconds::zero();
+    }
+    return std::chrono::microseconds(
+        std::max<int64_t>(0, cur.estimatePercentile(.99)));
+  };
+  ClientLatencySnapshot delta;
+  delta.append.assign(current->append);
+  delta.readQueue.assign(current->readQueue);
+  delta.readExecution.assign(current->readExecution);
+  *append = p99(delta.append, clientLatencySnapshot_->append);
+  // Sum of percentiles of the two stages; an upper bound of the percentile of
+  // the sum, which is not tracked directly.
+  *read = p99(delta.readQueue, clientLatencySnapshot_->readQueue) +
+      p99(delta.readExecution, clientLatencySnapshot_->readExecution);
+  clientLatencySnapshot_ = std::move(current);
+}
+
 void ShardRebuilding::getDebugInfo(InfoRebuildingShardsTable& table) const {
   // Some measure of how far we have progressed, in terms of record timestamps.
   if (!chunkRebuildings_.empty()) {
@@ -443,6 +845,63 @@ void ShardRebuilding::getDebugInfo(InfoRebuildingShardsTable& table) const {
     table.set<14>(nextLocation_->toString());
   }
   table.set<15>(readingProgress_);
+  table.set<16>(inFollowUpPass_
+                    ? "follow-up"
+                    : (addedShards_ == nullptr ? "full" : "resumed"));
+  table.set<17>(bytesRead_);
+  auto estimate = estimateProgress();
+  if (estimate.hasValue()) {
+    table.set<19>(estimate->bytesLeftToRead);
+    table.set<20>(estimate->bytesLeftToRebuild);
+    table.setOptional<21>(estimate->eta);
+  }
+}
+
+folly::Optional<ShardRebuilding::ProgressEstimate>
+ShardRebuilding::estimateProgress() const {
+  if (completed_) {
+    return ProgressEstimate{0, 0, std::chrono::seconds(0)};
+  }
+  if (readingProgress_ < 0 || readingTotalBytes_ == 0) {
+    return folly::none;
+  }
+
+  ProgressEstimate res;
+  res.bytesLeftToRead = readContext_ != nullptr && readContext_->reachedEnd
+      ? 0
+      : static_cast<size_t>(readingTotalBytes_ *
+                            std::max(0., 1. - readingProgress_));
+  // Assume the rest of the data needs rebuilding in the same proportion as
+  // what we've read so far. This folds in how much the copyset index lets
+  // us skip.
+  const double hit_ratio =
+      bytesRead_ == 0 ? 1. : std::min(1., 1. * bytesSelected_ / bytesRead_);
+  res.bytesLeftToRebuild =
+      static_cast<size_t>(res.bytesLeftToRead * hit_ratio) +
+      bytesInReadBuffer_ + chunkRebuildingBytesInFlight_;
+
+  // Don't count time spent waiting for global window or stuck on errors.
+  auto now = SteadyTimestamp::now();
+  auto stalled = totalTimeByState_[(int)ProfilingState::STALLED];
+  if (profilingState_ == ProfilingState::STALLED) {
+    stalled += std::chrono::duration_cast<std::chrono::milliseconds>(
+        now - currentStateStartTime_);
+  }
+  const double active_sec =
+      std::chrono::duration_cast<std::chrono::duration<double>>(
+          now - startTime_ - stalled)
+          .count();
+  if (active_sec < 1 || bytesRead_ == 0 ||
+      (res.bytesLeftToRebuild > 0 && bytesRebuilt_ == 0)) {
+    return res;
+  }
+  double eta_sec = res.bytesLeftToRead / (bytesRead_ / active_sec);
+  if (res.bytesLeftToRebuild > 0) {
+    eta_sec = std::max(
+        eta_sec, res.bytesLeftToRebuild / (bytesRebuilt_ / active_sec));
+  }
+  res.eta = std::chrono::seconds(static_cast<int64_t>(std::ceil(eta_sec)));
+  return res;
 }
 
 std::function<void(InfoRebuildingLogsTable&)>
@@ -468,7 +927,9 @@ ShardRebuilding::profilingStateNames() {
        {ProfilingState::WAITING_FOR_READ, "waiting_for_read"},
        {ProfilingState::RATE_LIMITED, "rate_limited"},
        {ProfilingState::WAITING_FOR_REREPLICATION, "waiting_for_rereplication"},
-       {ProfilingState::STALLED, "stalled"}});
+       {ProfilingState::STALLED, "stalled"},
+       {ProfilingState::THROTTLED_BY_AUTO_TUNING,
+        "throttled_by_auto_tuning"}});
   return s_names;
 }
 
@@ -496,6 +957,7 @@ void ShardRebuilding::flushCurrentStateTime() {
     S(RATE_LIMITED, rate_limited)
     S(WAITING_FOR_REREPLICATION, waiting_for_rereplication)
     S(STALLED, stalled)
+    S(THROTTLED_BY_AUTO_TUNING, throttled_by_auto_tuning)
 #undef S
     case ProfilingState::MAX:
       ld_check(false);
@@ -516,6 +978,11 @@ void ShardRebuilding::updateProfilingState() {
         ? ProfilingState::FULLY_OCCUPIED
         : ProfilingState::WAITING_FOR_REREPLICATION;
   }
+  if ((new_state == ProfilingState::RATE_LIMITED && readThrottled_) ||
+      (new_state == ProfilingState::WAITING_FOR_REREPLICATION &&
+       (readThrottled_ || storeThrottled_))) {
+    new_state = ProfilingState::THROTTLED_BY_AUTO_TUNING;
+  }
   if (new_state != profilingState_) {
     // Log a message if we started or stopped waiting on global window.
     if (storageTaskInFlight_ || !readContext_->persistentError) {
@@ -7,6 +7,8 @@
  */
 #pragma once
 
+#include <folly/Optional.h>
+
 #include "logdevice/common/Processor.h"
 #include "logdevice/common/RateLimiter.h"
 #include "logdevice/common/RebuildingTypes.h"
@@ -41,6 +43,15 @@ class ShardRebuilding : public ShardRebuildingInterface {
 
   void getDebugInfo(InfoRebuildingShardsTable& table) const override;
 
+  std::shared_ptr<const Checkpoint> getCheckpoint() const override;
+  size_t getBytesRead() const override;
+  void resumeFrom(std::shared_ptr<const Checkpoint> checkpoint,
+                  std::shared_ptr<const RebuildingSet> added_shards) override;
+  void expectMorePlans() override;
+  void addPlans(std::unordered_map<logid_t, std::unique_ptr<RebuildingPlan>>
+                    plans,
+                bool last) override;
+
   // To collect per-log debug info, call this from the worker thread, pass
   // the returned function to some non-worker thread and call it from there.
   // This is needed because the per-log states may be in use by the storage
@@ -58,6 +69,11 @@ class ShardRebuilding : public ShardRebuildingInterface {
   virtual std::chrono::milliseconds getIteratorTTL();
   virtual void putStorageTask();
   virtual std::unique_ptr<TimerInterface> createTimer(std::function<void()> cb);
+  // Sets *append and *read to p99 latency of appends sequenced on this node
+  // and of client read storage tasks on this shard since the previous call.
+  // Zero if there were none. Used by auto-tuning.
+  virtual void getClientLatencyP99(std::chrono::microseconds* append,
+                                   std::chrono::microseconds* read);
 
  protected:
   // Key in the ordered map of in-flight chunk rebuildings.
@@ -79,6 +95,24 @@ class ShardRebuilding : public ShardRebuildingInterface {
     size_t numRecords;
     size_t totalBytes;
     worker_id_t workerID;
+    // Sequence number of the read task that read this chunk.
+    size_t readBatch;
+  };
+
+  using Location = LocalLogStore::AllLogsIterator::Location;
+
+  struct ReadCheckpoint : public Checkpoint {
+    std::shared_ptr<Location> location;
+    bool newToOld;
+  };
+
+  // Chunks of a read task that haven't finished rebuilding, and the iterator
+  // location after the read task.
+  struct ReadBatch {
+    std::shared_ptr<Location> endLocation;
+    // Value of bytesRead_ after the read task.
+    size_t bytesRead;
+    size_t chunksLeft;
   };
 
   lsn_t rebuildingVersion_{LSN_INVALID};
@@ -106,8 +140,61 @@ class ShardRebuilding : public ShardRebuildingInterface {
 
   // Records we've read but haven't started ChunkRebuilding yet.
   std::deque<std::unique_ptr<ChunkData>> readBuffer_;
+  // Read task sequence number for each chunk in readBuffer_.
+  std::deque<size_t> readBufferBatches_;
   size_t bytesInReadBuffer_ = 0;
 
+  // Normally there's a single read pass, from the beginning to the end. If we
+  // were resumed from a previous ShardRebuilding's checkpoint, the first pass
+  // starts at resumeLocation_ and looks for all shards in rebuildingSet_, then
+  // a follow-up pass reads from the beginning up to resumeLocation_ and only
+  // looks for addedShards_.
+  std::shared_ptr<Location> resumeLocation_;
+  std::shared_ptr<const RebuildingSet> addedShards_;
+  // Copy of the plan for the follow-up pass.
+  std::unordered_map<logid_t, RebuildingPlan> followUpPlan_;
+  bool inFollowUpPass_ = false;
+
+  // If planning is still going on (see expectMorePlans()), the read pass can
+  // reach the end before all logs are planned, and the logs that got planned
+  // after the pass had started need a follow-up pass over what the main pass
+  // read before they joined. In that case, followUpPlan_ contains those logs,
+  // and the follow-up pass stops at lateLogsStopLocation_, or reads
+  // everything if lateLogsReadToEnd_ is true.
+  bool waitingForMorePlans_ = false;
+  // Plans received while a storage task was in flight, or not yet worth
+  // recreating the iterator for. See applyPendingPlans().
+  std::unordered_map<logid_t, RebuildingPlan> pendingPlans_;
+  std::shared_ptr<Location> lateLogsStopLocation_;
+  bool lateLogsReadToEnd_ = false;
+
+  // Read tasks of the current pass whose chunks are still buffered or being
+  // rebuilt, by sequence number. Used for maintaining checkpointLocation_.
+  std::map<size_t, ReadBatch> readBatches_;
+  size_t nextReadBatch_ = 0;
+  // Everything before this location has been rebuilt. nullptr if we haven't
+  // made any progress yet.
+  std::shared_ptr<Location> checkpointLocation_;
+  // Value of bytesRead_ when reading reached checkpointLocation_.
+  size_t checkpointBytesRead_ = 0;
+  // Total bytes read by all read tasks.
+  size_t bytesRead_ = 0;
+
+  // Fraction of the configured read rate limit and in-flight limits that
+  // rebuilding is currently allowed to use. Stays 1 unless auto-tuning is
+  // enabled, see autoTune().
+  double throttleFactor_ = 1.;
+  std::unique_ptr<TimerInterface> autoTuneTimer_;
+  // Cumulative client latency histograms as of the previous
+  // getClientLatencyP99() call.
+  struct ClientLatencySnapshot;
+  std::unique_ptr<ClientLatencySnapshot> clientLatencySnapshot_;
+  // Whether the scaled down read rate limit and in-flight limits are what
+  // currently stops us from reading and starting ChunkRebuildings,
+  // respectively. Used for profiling.
+  bool readThrottled_ = false;
+  bool storeThrottled_ = false;
+
   // Information about in-flight ChunkRebuildings.
   // Used for finding the timestamp of the oldest/newest record being rebuilt,
   // to make sure it's not too far behind.
@@ -115,6 +202,10 @@ class ShardRebuilding : public ShardRebuildingInterface {
   // because they live on different worker threads.
   std::map<ChunkRebuildingKey, ChunkRebuildingInfo> chunkRebuildings_;
 
+  // Pool of the workers ChunkRebuildings run on, picked when the first one
+  // is started (see RebuildingSettings::chunks_on_background_workers).
+  folly::Optional<WorkerType> chunkWorkerType_;
+
   // Sum of numRecords and totalBytes in chunkRebuildings_.
   size_t chunkRebuildingRecordsInFlight_ = 0;
   size_t chunkRebuildingBytesInFlight_ = 0;
@@ -132,12 +223,33 @@ class ShardRebuilding : public ShardRebuildingInterface {
   // Posts requests to abort state machines listed in chunkRebuildings_.
   void abortChunkRebuildings();
 
+  std::shared_ptr<RebuildingReadStorageTask::Context> createReadContext(
+      std::unordered_map<logid_t, RebuildingPlan> plan);
+  void startFollowUpPass();
+  // Adds pendingPlans_ to the read context. Has to recreate the iterator,
+  // which copies the directory for all logs, so it's only done when the
+  // number of pending logs is comparable to the number of logs we're already
+  // reading, or when planning is done.
+  void applyPendingPlansIfNeeded();
+  // Called when a chunk is done. Moves checkpointLocation_ forward if all
+  // chunks of the oldest read tasks are done.
+  void advanceCheckpoint();
+
   void sendStorageTaskIfNeeded();
   void startSomeChunkRebuildingsIfNeeded();
   void finalizeIfNeeded();
 
   void invalidateIterator();
 
+  bool autoTuneEnabled() const;
+  // Closed-loop controller for rebuilding throughput. Called every
+  // --rebuilding-auto-tune-interval. Halves throttleFactor_ if client latency
+  // is above target, otherwise raises it additively, up to 1.
+  void autoTune();
+  // Applies throttleFactor_ to a configured limit.
+  size_t scaleLimit(size_t limit) const;
+  rate_limit_t scaledReadRateLimit() const;
+
   void tryMakeProgress();
 
   // Stuff below is for instrumentation and stats.
@@ -156,8 +268,13 @@ class ShardRebuilding : public ShardRebuildingInterface {
     // buffer is full, i.e. ChunkRebuildings can't keep up with reads).
     WAITING_FOR_REREPLICATION,
     // There are neither ChunkRebuildings nor read task in flight.
-    // We either reached the end of global window or hit a permanent error.
+    // We either reached the end of global window, are waiting for more
+    // plans, or hit a permanent error.
     STALLED,
+    // Same as RATE_LIMITED or WAITING_FOR_REREPLICATION, but only because
+    // auto-tuning scaled down the rate limit or in-flight limits to protect
+    // client latency.
+    THROTTLED_BY_AUTO_TUNING,
 
     // Not a state.
     MAX,
@@ -194,6 +311,29 @@ class ShardRebuilding : public ShardRebuildingInterface {
   // Value between 0 and 1 indicating approximately what fraction of the data
   // we have read. -1 means not supported.
   double readingProgress_ = 0;
+  // Approximate total bytes that readingProgress_ is a fraction of.
+  // 0 means not supported.
+  size_t readingTotalBytes_ = 0;
+  // Total bytes of chunks that read tasks selected for rebuilding. Compared
+  // with bytesRead_, tells what fraction of the data we read (copyset index
+  // included) needs rebuilding.
+  size_t bytesSelected_ = 0;
+
+  struct ProgressEstimate {
+    // Approximately how many bytes are left to read in the current pass.
+    size_t bytesLeftToRead;
+    // Approximately how many bytes are left to re-replicate, including the
+    // ones already read and buffered or in flight.
+    size_t bytesLeftToRebuild;
+    // Time until this donor is done, extrapolated from the read and
+    // re-replication throughput observed so far. folly::none if we haven't
+    // been running long enough to tell.
+    folly::Optional<std::chrono::seconds> eta;
+  };
+  // Estimates how much work is left, based on the data size estimates the
+  // iterator gets from partition directory. folly::none if the local log
+  // store doesn't support progress estimation.
+  folly::Optional<ProgressEstimate> estimateProgress() const;
 
   // Advances currentStateStartTime_ to current time, updating totalTimeByState_
   // and stats as needed.
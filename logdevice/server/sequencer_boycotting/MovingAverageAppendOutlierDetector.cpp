@@ -53,8 +53,10 @@ MovingAverageAppendOutlierDetector::detectOutliers(TimePoint now) {
 
   std::vector<PotentialOutlier> outliers;
   const auto grace_period = getGracePeriod();
+  const auto severe_failure_ratio = getSevereFailureRatio();
   for (auto& entry : potential_outliers_) {
-    if (now - entry.second.outlier_since >= grace_period) {
+    if (now - entry.second.outlier_since >= grace_period ||
+        entry.second.recent_failure_ratio > severe_failure_ratio) {
       outliers.emplace_back(entry.second);
     }
   }
@@ -155,6 +157,7 @@ void MovingAverageAppendOutlierDetector::updatePotentialOutliersUsingRMSD(
     } else {
       it = new_map.emplace(outlier.first, std::move(it->second)).first;
     }
+    it->second.recent_failure_ratio = outlier.second;
     auto& stats = aggregated_stats_[outlier.first];
     it->second.successes += stats.append_successes.sum(ts_start, later_now);
     it->second.fails += stats.append_fails.sum(ts_start, later_now);
@@ -168,6 +171,11 @@ MovingAverageAppendOutlierDetector::getGracePeriod() const {
       .sequencer_boycotting.node_stats_boycott_grace_period;
 }
 
+double MovingAverageAppendOutlierDetector::getSevereFailureRatio() const {
+  return Worker::settings()
+      .sequencer_boycotting.node_stats_boycott_severe_failure_ratio;
+}
+
 float MovingAverageAppendOutlierDetector::getSensitivity() const {
   return Worker::settings().sequencer_boycotting.node_stats_boycott_sensitivity;
 }
@@ -41,6 +41,8 @@ class MovingAverageAppendOutlierDetector : public AppendOutlierDetector {
     // will be accumulated each time it's considered an outlier
     uint32_t successes{0};
     uint32_t fails{0};
+    // failure ratio in the most recent collection period
+    double recent_failure_ratio{0};
 
     std::string toString() const;
   };
@@ -61,6 +63,12 @@ class MovingAverageAppendOutlierDetector : public AppendOutlierDetector {
    */
   virtual std::chrono::milliseconds getGracePeriod() const;
 
+  /**
+   * @returns The setting that defines the failure ratio above which an outlier
+   * does not have to wait for the grace period before being boycotted
+   */
+  virtual double getSevereFailureRatio() const;
+
   /**
    * @returns The setting that defines how sensitive outlier detection should be
    * compared to 100% success. If getSensitivity returns 0.05, that means that a
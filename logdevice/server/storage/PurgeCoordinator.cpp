@@ -16,6 +16,7 @@
 #include "logdevice/common/debug.h"
 #include "logdevice/common/protocol/CLEANED_Message.h"
 #include "logdevice/common/protocol/CLEAN_Message.h"
+#include "logdevice/common/protocol/MULTI_RELEASE_Message.h"
 #include "logdevice/common/protocol/RELEASE_Message.h"
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/server/CleanedResponseRequest.h"
@@ -238,7 +239,7 @@ Message::Disposition PurgeCoordinator::onReceived(CLEAN_Message* msg,
     return Message::Disposition::NORMAL;
   }
 
-  checked_downcast<PurgeCoordinator&>(*log_state->purge_coordinator_)
+  checked_downcast<PurgeCoordinator&>(log_state->getPurgeCoordinator())
       .onCleanMessage(std::unique_ptr<CLEAN_Message>(msg),
                       w->sender().getNodeID(from),
                       from,
@@ -250,9 +251,28 @@ Message::Disposition PurgeCoordinator::onReceived(CLEAN_Message* msg,
 
 Message::Disposition PurgeCoordinator::onReceived(RELEASE_Message* msg,
                                                   const Address& from) {
-  ServerWorker* w = ServerWorker::onThisThread();
+  return handleRelease(msg->getHeader(), from);
+}
+
+Message::Disposition
+PurgeCoordinator::onReceived(MULTI_RELEASE_Message* msg, const Address& from) {
+  WORKER_STAT_INCR(multi_release_messages_received);
 
-  const RELEASE_Header& header = msg->getHeader();
+  // Wake up the read streams of all the released logs with one
+  // ReleaseRequest per worker.
+  ReleaseRequest::Batch batch(ServerWorker::onThisThread()->processor_);
+  for (const RELEASE_Header& header : msg->getReleases()) {
+    if (handleRelease(header, from) == Message::Disposition::ERROR) {
+      return Message::Disposition::ERROR;
+    }
+  }
+  return Message::Disposition::NORMAL;
+}
+
+Message::Disposition
+PurgeCoordinator::handleRelease(const RELEASE_Header& header,
+                                const Address& from) {
+  ServerWorker* w = ServerWorker::onThisThread();
 
   const shard_size_t n_shards = w->getNodesConfiguration()->getNumShards();
   shard_index_t shard = header.shard;
@@ -334,7 +354,7 @@ Message::Disposition PurgeCoordinator::onReceived(RELEASE_Message* msg,
     return Message::Disposition::NORMAL;
   }
 
-  RecordCache* cache = log_state->record_cache_.get();
+  RecordCache* cache = log_state->getRecordCache();
 
   // Decide whether to update the mutable per-epoch log metadata, and whether
   // or not to broadcast the release request immediately.
@@ -406,7 +426,7 @@ Message::Disposition PurgeCoordinator::onReceived(RELEASE_Message* msg,
             do_broadcast ? log_state : nullptr, header.rid, flags));
   }
 
-  checked_downcast<PurgeCoordinator&>(*log_state->purge_coordinator_)
+  checked_downcast<PurgeCoordinator&>(log_state->getPurgeCoordinator())
       .onReleaseMessage(
           header.rid.lsn(), peer_node_id, header.release_type, do_broadcast);
 
@@ -752,7 +772,7 @@ void PurgeCoordinator::doRelease(lsn_t lsn,
 }
 
 void PurgeCoordinator::updateLastCleanEpochInRecordCache(epoch_t lce) {
-  RecordCache* cache = parent_->record_cache_.get();
+  RecordCache* cache = parent_->getRecordCache();
   if (cache != nullptr) {
     cache->onLastCleanEpochAdvanced(lce);
   }
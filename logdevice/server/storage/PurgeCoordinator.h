@@ -29,8 +29,10 @@ namespace facebook { namespace logdevice {
 
 class CLEAN_Message;
 class LogStorageState;
+class MULTI_RELEASE_Message;
 class PurgeUncleanEpochs;
 class RELEASE_Message;
+struct RELEASE_Header;
 enum class ReleaseType : uint8_t;
 
 /**
@@ -57,13 +59,15 @@ class PurgeCoordinator : public LogStorageState_PurgeCoordinator_Bridge {
                    LogStorageState* parent);
 
   /**
-   * Static handlers for incoming CLEAN and RELEASE messages; validates and
-   * hands over to per-log PurgeCoordinator instance.
+   * Static handlers for incoming CLEAN, RELEASE and MULTI_RELEASE messages;
+   * validates and hands over to per-log PurgeCoordinator instance.
    */
   static Message::Disposition onReceived(CLEAN_Message* msg,
                                          const Address& from);
   static Message::Disposition onReceived(RELEASE_Message* msg,
                                          const Address& from);
+  static Message::Disposition onReceived(MULTI_RELEASE_Message* msg,
+                                         const Address& from);
 
   //
   // NOTE: all public methods expect the mutex *not* to be held
@@ -144,6 +148,10 @@ class PurgeCoordinator : public LogStorageState_PurgeCoordinator_Bridge {
   ~PurgeCoordinator() override;
 
  private:
+  // Common part of the RELEASE and MULTI_RELEASE handlers.
+  static Message::Disposition handleRelease(const RELEASE_Header& header,
+                                            const Address& from);
+
   // LSN that we got a RELEASE for and NodeID of the sequencer we got it from.
   struct BufferedRelease {
     lsn_t lsn;
@@ -85,7 +85,7 @@ void PurgeScheduler::wakeUpMorePurgingForReleases(shard_index_t shard_index) {
       continue;
     }
 
-    checked_downcast<PurgeCoordinator&>(*log_state->purge_coordinator_)
+    checked_downcast<PurgeCoordinator&>(log_state->getPurgeCoordinator())
         .startBuffered();
   }
 }
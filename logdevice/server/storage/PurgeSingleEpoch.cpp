@@ -154,8 +154,16 @@ void PurgeSingleEpoch::purgeRecords() {
                                      : "n/a");
 
   // delete every record in [start, end] in this epoch
-  startStorageTask(std::make_unique<PurgeDeleteRecordsStorageTask>(
-      log_id_, epoch_, start_esn, end_esn, ref_holder_.ref()));
+  if (end_esn.val_ - start_esn.val_ <=
+      PurgeDeleteRecordsStorageTask::PURGE_DELETE_BY_KEY_THRESHOLD - 1) {
+    STAT_INCR(getStats(), purging_delete_started);
+    STAT_INCR(getStats(), purging_v2_delete_by_keys);
+    startStorageTask(std::make_unique<PurgeDeleteKeysStorageTask>(
+        log_id_, epoch_, start_esn, end_esn, ref_holder_.ref()));
+  } else {
+    startStorageTask(std::make_unique<PurgeDeleteRecordsStorageTask>(
+        log_id_, epoch_, start_esn, end_esn, ref_holder_.ref()));
+  }
 }
 
 void PurgeSingleEpoch::onPurgeRecordsTaskDone(Status status) {
@@ -457,6 +465,79 @@ void PurgeDeleteRecordsStorageTask::onDropped() {
   onDone();
 }
 
+///////// PurgeDeleteKeysStorageTask
+
+PurgeDeleteKeysStorageTask::PurgeDeleteKeysStorageTask(
+    logid_t log_id,
+    epoch_t epoch,
+    esn_t start_esn,
+    esn_t end_esn,
+    WeakRef<PurgeSingleEpoch> driver)
+    : WriteStorageTask(StorageTask::Type::PURGE_DELETE_KEYS),
+      log_id_(log_id),
+      epoch_(epoch),
+      start_esn_(start_esn),
+      end_esn_(end_esn),
+      driver_(std::move(driver)) {
+  ld_check(start_esn <= end_esn);
+  // shouldn't overflow here
+  const size_t num_keys = end_esn.val_ - start_esn.val_ + 1;
+  ld_check_le(num_keys,
+              PurgeDeleteRecordsStorageTask::PURGE_DELETE_BY_KEY_THRESHOLD);
+  deletes_.reserve(num_keys);
+  for (size_t i = 0; i < num_keys; ++i) {
+    esn_t::raw_type esn = start_esn.val_ + static_cast<esn_t::raw_type>(i);
+    deletes_.emplace_back(log_id, compose_lsn(epoch, esn_t(esn)));
+  }
+
+  if (MetaDataLog::isMetaDataLog(log_id)) {
+    ld_info("Maybe deleting metadata log records; log: %lu epoch: %u "
+            "start esn: %u end esn: %u",
+            log_id.val_,
+            epoch.val_,
+            start_esn.val_,
+            end_esn.val_);
+  }
+}
+
+size_t PurgeDeleteKeysStorageTask::getWriteOps(const WriteOp** write_ops,
+                                               size_t write_ops_len) const {
+  size_t n = std::min(write_ops_len, deletes_.size());
+  for (size_t i = 0; i < n; ++i) {
+    write_ops[i] = &deletes_[i];
+  }
+  return n;
+}
+
+void PurgeDeleteKeysStorageTask::onDone() {
+  if (status_ == E::OK && storageThreadPool_ != nullptr) {
+    PurgingTracer::traceRecordPurge(
+        storageThreadPool_->getProcessor().getTraceLogger().get(),
+        log_id_,
+        epoch_,
+        ESN_INVALID,
+        start_esn_,
+        end_esn_,
+        true);
+  }
+  PurgeSingleEpoch* driver = driver_.get();
+  if (driver != nullptr) {
+    if (status_ == E::OK) {
+      STAT_INCR(driver->getStats(), purging_delete_done);
+    }
+    driver->onPurgeRecordsTaskDone(status_);
+  }
+}
+
+void PurgeDeleteKeysStorageTask::onDropped() {
+  PurgeSingleEpoch* driver = driver_.get();
+  if (driver != nullptr) {
+    STAT_INCR(driver->getStats(), purging_task_dropped);
+  }
+  status_ = E::DROPPED;
+  onDone();
+}
+
 ///////// PurgeWriteEpochRecoveryMetadataStorageTask
 
 void PurgeWriteEpochRecoveryMetadataStorageTask::execute() {
@@ -15,7 +15,9 @@
 #include "logdevice/common/ShardAuthoritativeStatusMap.h"
 #include "logdevice/common/WeakRefHolder.h"
 #include "logdevice/common/WorkerCallbackHelper.h"
+#include "logdevice/server/locallogstore/WriteOps.h"
 #include "logdevice/server/storage/SealStorageTask.h"
+#include "logdevice/server/storage_tasks/WriteStorageTask.h"
 
 namespace facebook { namespace logdevice {
 
@@ -157,12 +159,50 @@ class PurgeDeleteRecordsStorageTask : public StorageTask {
   WeakRef<PurgeSingleEpoch> driver_;
   Status status_;
 
+ public:
   // if the ESN range contains less or equal number of records than this
   // threshold, delete key by key directly. Otherwise, create an iterator
   // to read actual records for deletion
   static const size_t PURGE_DELETE_BY_KEY_THRESHOLD = 4096;
 };
 
+/**
+ * Deletes every possible key in an ESN range without reading the data first.
+ * Used instead of PurgeDeleteRecordsStorageTask for ranges of at most
+ * PURGE_DELETE_BY_KEY_THRESHOLD ESNs. Being a WriteStorageTask, the deletes
+ * are written together with other pending writes of the shard, so after a
+ * mass sequencer failover the deletes of thousands of purges end up in a few
+ * large WriteBatches instead of one writeMulti() each.
+ */
+class PurgeDeleteKeysStorageTask : public WriteStorageTask {
+ public:
+  PurgeDeleteKeysStorageTask(logid_t log_id,
+                             epoch_t epoch,
+                             esn_t start_esn,
+                             esn_t end_esn,
+                             WeakRef<PurgeSingleEpoch> driver);
+
+  void onDone() override;
+  void onDropped() override;
+  StorageTaskPriority getPriority() const override {
+    return StorageTaskPriority::HIGH;
+  }
+
+  size_t getNumWriteOps() const override {
+    return deletes_.size();
+  }
+  size_t getWriteOps(const WriteOp** write_ops,
+                     size_t write_ops_len) const override;
+
+ private:
+  const logid_t log_id_;
+  const epoch_t epoch_;
+  const esn_t start_esn_;
+  const esn_t end_esn_;
+  WeakRef<PurgeSingleEpoch> driver_;
+  std::vector<DeleteWriteOp> deletes_;
+};
+
 class PurgeWriteEpochRecoveryMetadataStorageTask : public StorageTask {
  public:
   PurgeWriteEpochRecoveryMetadataStorageTask(
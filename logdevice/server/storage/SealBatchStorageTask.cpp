@@ -0,0 +1,53 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/storage/SealBatchStorageTask.h"
+
+#include "logdevice/common/debug.h"
+
+namespace facebook { namespace logdevice {
+
+SealBatchStorageTask::SealBatchStorageTask(
+    std::vector<std::unique_ptr<SealStorageTask>> tasks)
+    : StorageTask(StorageTask::Type::SEAL_BATCH), tasks_(std::move(tasks)) {
+  ld_check(!tasks_.empty());
+}
+
+void SealBatchStorageTask::execute() {
+  for (auto& task : tasks_) {
+    task->setStorageThreadPool(storageThreadPool_);
+    task->execute();
+  }
+}
+
+Durability SealBatchStorageTask::durability() const {
+  Durability result = Durability::INVALID;
+  for (const auto& task : tasks_) {
+    if (task->durability() == Durability::SYNC_WRITE) {
+      return Durability::SYNC_WRITE;
+    }
+    if (task->durability() != Durability::INVALID) {
+      result = task->durability();
+    }
+  }
+  return result;
+}
+
+void SealBatchStorageTask::onDone() {
+  for (auto& task : tasks_) {
+    task->onDone();
+  }
+}
+
+void SealBatchStorageTask::onDropped() {
+  for (auto& task : tasks_) {
+    task->setStorageThreadPool(storageThreadPool_);
+    task->onDropped();
+  }
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,52 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "logdevice/server/storage/SealStorageTask.h"
+#include "logdevice/server/storage_tasks/StorageTask.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file  Runs the SealStorageTasks of the SEALs batched in a MULTI_SEAL
+ *        message that are for the same shard, as a single storage task.
+ *        Compared to running them one by one, that saves a queue round trip
+ *        per log, and the seal records of all of them are synced together
+ *        before any SEALED reply goes out.
+ */
+
+class SealBatchStorageTask : public StorageTask {
+ public:
+  explicit SealBatchStorageTask(
+      std::vector<std::unique_ptr<SealStorageTask>> tasks);
+
+  // see StorageTask.h
+  void execute() override;
+
+  // SYNC_WRITE if any of the seals changed the local log store.
+  Durability durability() const override;
+
+  void onDone() override;
+  void onDropped() override;
+
+  StorageTaskPriority getPriority() const override {
+    return StorageTaskPriority::HIGH;
+  }
+
+  size_t size() const {
+    return tasks_.size();
+  }
+
+ private:
+  std::vector<std::unique_ptr<SealStorageTask>> tasks_;
+};
+
+}} // namespace facebook::logdevice
@@ -194,7 +194,7 @@ Status SealStorageTask::recoverSoftSeals(LocalLogStore& store,
   }
 
   // if record cache is enabled, update its metadata
-  RecordCache* cache = log_state->record_cache_.get();
+  RecordCache* cache = log_state->getRecordCache();
   if (cache != nullptr) {
     cache->updateLastNonAuthoritativeEpoch(log_id_);
   }
@@ -235,7 +235,7 @@ bool SealStorageTask::getEpochInfoFromCache(LocalLogStore& /*store*/,
   ld_check(log_state != nullptr);
   ld_check(epoch_info_ != nullptr);
 
-  RecordCache* cache = log_state->record_cache_.get();
+  RecordCache* cache = log_state->getRecordCache();
   bool from_cache = false;
   if (cache) {
     from_cache = true;
@@ -7,14 +7,20 @@
  */
 #include "logdevice/server/storage_tasks/ExecStorageThread.h"
 
+#include <algorithm>
 #include <chrono>
 
+#include "logdevice/common/NumaPlacement.h"
 #include "logdevice/common/SlowStorageTasksTracer.h"
 #include "logdevice/common/StorageTask-enums.h"
 #include "logdevice/common/Timestamp.h"
+#include "logdevice/common/chrono_util.h"
+#include "logdevice/common/stats/ServerHistograms.h"
 #include "logdevice/common/stats/PerShardHistograms.h"
 #include "logdevice/common/stats/Stats.h"
+#include "logdevice/server/CpuProfiler.h"
 #include "logdevice/server/ServerProcessor.h"
+#include "logdevice/server/locallogstore/IOAttribution.h"
 #include "logdevice/server/locallogstore/LocalLogStore.h"
 #include "logdevice/server/storage_tasks/StorageTask.h"
 #include "logdevice/server/storage_tasks/StorageTaskResponse.h"
@@ -23,6 +29,11 @@
 namespace facebook { namespace logdevice {
 
 void ExecStorageThread::run() {
+  if (pool_->getNumaNode() != -1) {
+    // Pin before anything else so that thread-local state gets allocated on
+    // the right node.
+    numa::bindThisThreadToNode(pool_->getNumaNode());
+  }
   pool_->getLocalLogStore().onStorageThreadStarted();
 
   auto settings = pool_->getSettings().get();
@@ -33,10 +44,22 @@ void ExecStorageThread::run() {
     set_io_priority_of_this_thread(settings->slow_ioprio.value());
   }
 
-  SlowStorageTasksTracer slow_task_tracer{pool_->getTraceLogger()};
+  slow_task_tracer_ =
+      std::make_unique<SlowStorageTasksTracer>(pool_->getTraceLogger());
+  StorageTaskResponseBatcher responses;
 
   while (shouldProcessTasks_) {
-    std::unique_ptr<StorageTask> task = pool_->blockingGetTask(thread_type_);
+    std::unique_ptr<StorageTask> task;
+    if (responses.size() > 0) {
+      task = pool_->tryGetTask(thread_type_);
+      if (!task) {
+        // Don't hold responses while waiting for more tasks.
+        responses.flush();
+      }
+    }
+    if (!task) {
+      task = pool_->blockingGetTask(thread_type_);
+    }
     task->setStorageThread(this);
 
     // Maintain stats for queueing latency.
@@ -55,8 +78,18 @@ void ExecStorageThread::run() {
     }
 
     auto execution_start_time = std::chrono::steady_clock::now();
-    task->execute();
+    task->execution_start_time_ = execution_start_time;
+    CpuProfiler::setThreadTag(storageTaskTypeNames[task->getType()].c_str());
+    std::chrono::microseconds io_time;
+    {
+      IOAttribution::ScopedTaskType io_task_type(
+          task->getType(), pool_->stats(), pool_->getShardIdx());
+      task->execute();
+      io_time = io_task_type.ioTime();
+    }
+    CpuProfiler::setThreadTag(nullptr);
     auto execution_end_time = std::chrono::steady_clock::now();
+    task->execution_end_time_ = execution_end_time;
     auto usec = SystemTimestamp(execution_end_time - execution_start_time)
                     .toMicroseconds()
                     .count();
@@ -80,32 +113,100 @@ void ExecStorageThread::run() {
       }
     }
 
-    slow_task_tracer.traceStorageTask(
-        [&] {
-          StorageTaskDebugInfo info = task->getDebugInfo();
-          info.execution_start_time = SteadyTimestamp(execution_start_time)
-                                          .approximateSystemTimestamp()
-                                          .toMilliseconds();
-          info.execution_end_time = SteadyTimestamp(execution_end_time)
-                                        .approximateSystemTimestamp()
-                                        .toMilliseconds();
-          return info;
-        },
-        /* execution_time_ms */ usec / 1000);
-
-    /*
-     * TODO (T37204962):
-       Update the IO scheduler with and reset the cost
-       pool_->creditSchedulert(task->bytesProcessed(), task->getPrincipal());
-       task->bytesProcessed(0);
-    */
+    // Writes in the batch have already been reported one by one.
+    if (task->getType() != StorageTaskType::WRITE_BATCH) {
+      reportTaskStageTimes(*task);
+    }
 
+    // Charge the task's principal for the device time the task actually took
+    // rather than for the request it was dequeued as.
+    if (thread_type_ == StorageTask::ThreadType::SLOW &&
+        pool_->getSettings()->storage_tasks_drr_charge_io_time) {
+      pool_->chargeScheduler(task->reqSize(),
+                             std::max<uint64_t>(io_time.count(), 1),
+                             task->getPrincipal());
+    }
+
+    const std::chrono::microseconds batch_delay =
+        pool_->getServerSettings()->storage_task_response_batch_delay;
     if (task->durability() == Durability::SYNC_WRITE) {
       pool_->enqueueForSync(std::move(task));
+    } else if (batch_delay.count() > 0) {
+      responses.add(std::move(task));
     } else {
       StorageTaskResponse::sendBackToWorker(std::move(task));
     }
+
+    if (responses.size() > 0 &&
+        std::chrono::steady_clock::now() - responses.oldestAddedAt() >=
+            batch_delay) {
+      responses.flush();
+    }
   }
+  responses.flush();
   ld_info("ExecStorageThread exiting");
 }
+
+void ExecStorageThread::reportTaskStageTimes(const StorageTask& task) {
+  if (!task.dequeue_time_ || !task.execution_start_time_ ||
+      !task.execution_end_time_) {
+    return;
+  }
+  const bool is_write = task.isWriteTask();
+  const auto queue_time =
+      to_usec(task.dequeue_time_.value() - task.enqueue_time_);
+  const auto batching_time =
+      to_usec(task.execution_start_time_.value() - task.dequeue_time_.value());
+  const auto execution_time = to_usec(task.execution_end_time_.value() -
+                                      task.execution_start_time_.value());
+
+  const int priority = static_cast<int>(task.getPriority());
+  if (priority >= 0 &&
+      priority < static_cast<int>(StorageTaskPriority::NUM_PRIORITIES)) {
+    HISTOGRAM_ADD(pool_->stats(),
+                  storage_task_queue_time_by_priority[priority],
+                  queue_time.count());
+    if (is_write) {
+      HISTOGRAM_ADD(pool_->stats(),
+                    storage_task_batching_time_by_priority[priority],
+                    batching_time.count());
+    }
+    HISTOGRAM_ADD(pool_->stats(),
+                  storage_task_execution_time_by_priority[priority],
+                  execution_time.count());
+  }
+  const int principal = static_cast<int>(task.getPrincipal());
+  if (principal >= 0 &&
+      principal < static_cast<int>(StorageTaskPrincipal::NUM_PRINCIPALS)) {
+    HISTOGRAM_ADD(pool_->stats(),
+                  storage_task_queue_time_by_principal[principal],
+                  queue_time.count());
+    if (is_write) {
+      HISTOGRAM_ADD(pool_->stats(),
+                    storage_task_batching_time_by_principal[principal],
+                    batching_time.count());
+    }
+    HISTOGRAM_ADD(pool_->stats(),
+                  storage_task_execution_time_by_principal[principal],
+                  execution_time.count());
+  }
+
+  if (!slow_task_tracer_) {
+    return;
+  }
+  const auto total_time =
+      to_usec(task.execution_end_time_.value() - task.enqueue_time_);
+  slow_task_tracer_->traceStorageTask(
+      [&] {
+        StorageTaskDebugInfo info = task.getDebugInfo();
+        info.queue_time = queue_time;
+        if (is_write) {
+          info.batching_time = batching_time;
+        }
+        info.execution_time = execution_time;
+        return info;
+      },
+      /* duration_ms */ total_time.count() / 1000.0);
+}
+
 }} // namespace facebook::logdevice
@@ -9,6 +9,7 @@
 
 #include <memory>
 
+#include "logdevice/common/SlowStorageTasksTracer.h"
 #include "logdevice/server/storage_tasks/StorageTask.h"
 #include "logdevice/server/storage_tasks/StorageThread.h"
 #include "logdevice/server/storage_tasks/StorageThreadPool.h"
@@ -37,6 +38,18 @@ class ExecStorageThread : public StorageThread {
     shouldProcessTasks_ = false;
   }
 
+  /**
+   * Breaks down the latency of a task that just finished executing into time
+   * spent in the queue (enqueue to dequeue), waiting for the rest of its write
+   * batch (dequeue to execution start; writes only) and executing. Adds them
+   * to histograms per priority and principal and samples the slowest tasks
+   * to the slow storage tasks tracer.
+   *
+   * Writes are reported individually by WriteBatchStorageTask rather than
+   * as part of their batch.
+   */
+  void reportTaskStageTimes(const StorageTask& task);
+
  protected:
   void run() override;
 
@@ -60,5 +73,8 @@ class ExecStorageThread : public StorageThread {
   int idx_;
 
   bool shouldProcessTasks_ = true;
+
+  // Created in run(), on this thread.
+  std::unique_ptr<SlowStorageTasksTracer> slow_task_tracer_;
 };
 }} // namespace facebook::logdevice
@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/storage_tasks/MultiLogReadStorageTask.h"
+
+#include <algorithm>
+#include <tuple>
+
+#include <folly/Format.h>
+
+#include "logdevice/common/debug.h"
+
+namespace facebook { namespace logdevice {
+
+MultiLogReadStorageTask::MultiLogReadStorageTask(
+    std::vector<std::unique_ptr<ReadStorageTask>> tasks)
+    : StorageTask(StorageTask::Type::READ_MULTI_LOG), tasks_(std::move(tasks)) {
+  ld_check(!tasks_.empty());
+  for (const auto& task : tasks_) {
+    ld_check(task);
+    ld_check(task->getType() == tasks_.front()->getType());
+  }
+}
+
+void MultiLogReadStorageTask::execute() {
+  // Visit the reads in key order. Sort pointers rather than tasks_ itself so
+  // that the worker gets results back in the order the streams were queued.
+  std::vector<ReadStorageTask*> order;
+  order.reserve(tasks_.size());
+  for (const auto& task : tasks_) {
+    order.push_back(task.get());
+  }
+  std::stable_sort(order.begin(),
+                   order.end(),
+                   [](const ReadStorageTask* a, const ReadStorageTask* b) {
+                     return std::tie(a->read_ctx_.logid_.val_,
+                                     a->read_ctx_.read_ptr_.lsn) <
+                         std::tie(b->read_ctx_.logid_.val_,
+                                  b->read_ctx_.read_ptr_.lsn);
+                   });
+
+  for (ReadStorageTask* task : order) {
+    task->setStorageThreadPool(storageThreadPool_);
+    task->setStorageThread(storageThread_);
+    task->stats_ = stats_;
+    task->execute();
+  }
+}
+
+void MultiLogReadStorageTask::onDone() {
+  for (auto& task : tasks_) {
+    task->onDone();
+  }
+}
+
+void MultiLogReadStorageTask::onDropped() {
+  for (auto& task : tasks_) {
+    task->onDropped();
+  }
+}
+
+void MultiLogReadStorageTask::onStorageThreadDrop() {
+  for (auto& task : tasks_) {
+    task->onStorageThreadDrop();
+  }
+}
+
+void MultiLogReadStorageTask::getDebugInfoDetailed(
+    StorageTaskDebugInfo& info) const {
+  // Report the first read; the extra info lists the rest.
+  info.log_id = tasks_.front()->read_ctx_.logid_;
+  info.lsn = tasks_.front()->read_ctx_.read_ptr_.lsn;
+  std::string reads;
+  for (const auto& task : tasks_) {
+    if (!reads.empty()) {
+      reads += ", ";
+    }
+    reads += folly::sformat("{}@{}",
+                            task->read_ctx_.logid_.val_,
+                            lsn_to_string(task->read_ctx_.read_ptr_.lsn));
+  }
+  info.extra_info =
+      folly::sformat("{} reads: {}", tasks_.size(), std::move(reads));
+}
+
+}} // namespace facebook::logdevice
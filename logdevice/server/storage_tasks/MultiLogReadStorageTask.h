@@ -0,0 +1,75 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "logdevice/server/storage_tasks/ReadStorageTask.h"
+#include "logdevice/server/storage_tasks/StorageTask.h"
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Storage task that bundles the ReadStorageTasks of several catch-up
+ *       streams reading from the same shard. The reads are executed back to
+ *       back on a single storage thread, sorted by (log id, read pointer),
+ *       which is the order in which they are laid out in the local log store,
+ *       so the storage thread walks the keyspace in one forward pass instead
+ *       of picking the reads in queue order.
+ *
+ *       Each sub-task keeps its own iterator, memory token and completion
+ *       path: onDone()/onDropped() are forwarded to every sub-task, so the
+ *       worker side sees exactly what it would if the tasks had been sent
+ *       individually. See CatchupQueue::pushRecords() and
+ *       Settings::multi_log_read_batch_size.
+ */
+
+class MultiLogReadStorageTask : public StorageTask {
+ public:
+  /**
+   * @param tasks  Tasks to execute. Must be non-empty, and all of the same
+   *               StorageTaskType, so that they agree on thread type,
+   *               priority and principal.
+   */
+  explicit MultiLogReadStorageTask(
+      std::vector<std::unique_ptr<ReadStorageTask>> tasks);
+
+  void execute() override;
+
+  void onDone() override;
+
+  void onDropped() override;
+
+  void onStorageThreadDrop() override;
+
+  ThreadType getThreadType() const override {
+    return tasks_.front()->getThreadType();
+  }
+
+  StorageTaskPriority getPriority() const override {
+    return tasks_.front()->getPriority();
+  }
+
+  Principal getPrincipal() const override {
+    return tasks_.front()->getPrincipal();
+  }
+
+  size_t numTasks() const {
+    return tasks_.size();
+  }
+
+ private:
+  void getDebugInfoDetailed(StorageTaskDebugInfo&) const override;
+
+  // Sub-tasks, in the order in which they were handed to us. This is the
+  // order in which the worker gets them back.
+  std::vector<std::unique_ptr<ReadStorageTask>> tasks_;
+};
+
+}} // namespace facebook::logdevice
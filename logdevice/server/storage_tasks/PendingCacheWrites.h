@@ -0,0 +1,91 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Tracks the writes to a shard whose records may already be in the
+ *       local log store but not yet in the record caches, so that a record
+ *       cache checkpoint can wait until every write that the local log store
+ *       has numbered so far is also in the caches.
+ *
+ *       Writers register in one of two counters, picked by the parity of a
+ *       generation number. waitForEarlierWrites() bumps the generation, so
+ *       that it only waits for the writes that began before it, and never
+ *       for a steady stream of new ones.
+ */
+
+class PendingCacheWrites {
+ public:
+  /**
+   * Called before writing records that will then be put in the record
+   * caches.
+   *
+   * @return  ticket to pass to end()
+   */
+  size_t begin() {
+    while (true) {
+      const size_t gen = gen_.load();
+      counts_[gen % 2].fetch_add(1);
+      if (gen_.load() == gen) {
+        return gen % 2;
+      }
+      // Raced with waitForEarlierWrites(), which may have already seen the
+      // counter at zero.
+      counts_[gen % 2].fetch_sub(1);
+    }
+  }
+
+  // Called once the records are in the record caches, or failed to be
+  // written.
+  void end(size_t ticket) {
+    counts_[ticket].fetch_sub(1);
+  }
+
+  /**
+   * Waits for all writes that began before the call to end. Not thread-safe,
+   * calls must be serialized.
+   *
+   * @return  false if some writes didn't end within `timeout`
+   */
+  bool waitForEarlierWrites(std::chrono::milliseconds timeout) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    const size_t gen = gen_.load();
+    // If the previous call timed out, writes of older generations may still
+    // be counted in the other counter. No new writes join it until the
+    // generation is bumped.
+    if (!waitForZero((gen + 1) % 2, deadline)) {
+      return false;
+    }
+    gen_.store(gen + 1);
+    return waitForZero(gen % 2, deadline);
+  }
+
+ private:
+  bool waitForZero(size_t idx,
+                   std::chrono::steady_clock::time_point deadline) {
+    while (counts_[idx].load() != 0) {
+      if (std::chrono::steady_clock::now() >= deadline) {
+        return false;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+  }
+
+  std::atomic<size_t> gen_{0};
+  std::array<std::atomic<size_t>, 2> counts_{{{0}, {0}}};
+};
+
+}} // namespace facebook::logdevice
@@ -171,9 +171,16 @@ void PerWorkerStorageTaskQueue::putTask(std::unique_ptr<StorageTask>&& task) {
 void PerWorkerStorageTaskQueue::onReply(const StorageTask& task) {
   auto type = task.getThreadType();
 
-  // NOTE: here we always subtract 1 (not inflight_slots_for_task()) because
-  // we expect two replies per write, each releasing one inflight slot.
-  --taskBuffer_[(int)type].tasks_in_flight;
+  // NOTE: here we subtract 1 (not inflight_slots_for_task()) because we
+  // expect two replies per write, each releasing one inflight slot. A
+  // WriteBatchStorageTask may stand for several writes, and releases one
+  // slot for each.
+  size_t slots = 1;
+  if (task.getType() == StorageTask::Type::WRITE_BATCH) {
+    slots = static_cast<const WriteBatchStorageTask&>(task).getNumWrites();
+  }
+  ld_check(taskBuffer_[(int)type].tasks_in_flight >= slots);
+  taskBuffer_[(int)type].tasks_in_flight -= slots;
 
   auto check_queue = [=](std::queue<std::unique_ptr<StorageTask>>& queue) {
     while (!queue.empty() && canSendToStorageThread(*queue.front())) {
@@ -248,19 +255,66 @@ void PerWorkerStorageTaskQueue::sendTaskToStorageThread(
     rv = pool->tryPutWrite(std::unique_ptr<WriteStorageTask>(raw));
     ld_check(rv == 0 || err == E::SHUTDOWN);
 
-    // Now put a blank WriteBatchStorageTask onto the main queue
-    auto batch_task = std::make_unique<WriteBatchStorageTask>(thread_type);
-    batch_task->reply_executor_ = Worker::onThisThread();
-    batch_task->reply_shard_idx_ = shard_idx_;
-    batch_task->reply_worker_idx_ = Worker::onThisThread()->idx_;
-    batch_task->stats_ = Worker::stats();
-    batch_task->enqueue_time_ = std::chrono::steady_clock::now();
-    rv = pool->tryPutTask(std::unique_ptr<StorageTask>(std::move(batch_task)));
-    ld_check(rv == 0 || err == E::SHUTDOWN);
+    auto& buffer = taskBuffer_[(int)thread_type];
+    if (!Worker::settings().coalesce_write_batch_tasks) {
+      postWriteBatchTask(thread_type, 1);
+    } else if (buffer.write_batch_task_posted) {
+      // Some other write (e.g. a STORE from the same read off the network)
+      // already posted a task in this iteration. Cover this one with a
+      // single task at the end of the iteration.
+      ++buffer.writes_without_batch_task;
+      WORKER_STAT_INCR(write_batch_tasks_coalesced);
+    } else {
+      // Don't delay the first write of an iteration.
+      postWriteBatchTask(thread_type, 1);
+      buffer.write_batch_task_posted = true;
+      if (!flush_write_batches_timer_.isActive()) {
+        flush_write_batches_timer_.setCallback(
+            [this] { flushWriteBatchTasks(); });
+        flush_write_batches_timer_.activate(std::chrono::microseconds(0));
+      }
+    }
+  }
+}
+
+void PerWorkerStorageTaskQueue::postWriteBatchTask(
+    StorageTask::ThreadType thread_type,
+    size_t num_writes) {
+  StorageThreadPool* pool =
+      &ServerWorker::onThisThread()
+           ->processor_->sharded_storage_thread_pool_->getByIndex(shard_idx_);
+  // Now put a blank WriteBatchStorageTask onto the main queue
+  auto batch_task =
+      std::make_unique<WriteBatchStorageTask>(thread_type, num_writes);
+  batch_task->reply_executor_ = Worker::onThisThread();
+  batch_task->reply_shard_idx_ = shard_idx_;
+  batch_task->reply_worker_idx_ = Worker::onThisThread()->idx_;
+  batch_task->stats_ = Worker::stats();
+  batch_task->enqueue_time_ = std::chrono::steady_clock::now();
+  int rv =
+      pool->tryPutTask(std::unique_ptr<StorageTask>(std::move(batch_task)));
+  ld_check(rv == 0 || err == E::SHUTDOWN);
+}
+
+void PerWorkerStorageTaskQueue::flushWriteBatchTasks() {
+  for (int i = 0; i < (int)StorageTask::ThreadType::MAX; ++i) {
+    auto& buffer = taskBuffer_[i];
+    buffer.write_batch_task_posted = false;
+    if (buffer.writes_without_batch_task > 0) {
+      postWriteBatchTask(
+          (StorageTask::ThreadType)i, buffer.writes_without_batch_task);
+      buffer.writes_without_batch_task = 0;
+    }
   }
 }
 
 void PerWorkerStorageTaskQueue::drop(StorageTask::ThreadType thread_type) {
+  // Writes already on the write queue need their WriteBatchStorageTask to be
+  // performed or dropped by the storage threads.
+  if (taskBuffer_[(int)thread_type].writes_without_batch_task > 0) {
+    flushWriteBatchTasks();
+  }
+
   std::vector<std::unique_ptr<StorageTask>> to_notify;
   std::map<StorageTaskType, int> count_by_type;
 
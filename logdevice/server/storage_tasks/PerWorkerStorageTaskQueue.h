@@ -12,6 +12,7 @@
 #include <queue>
 #include <utility>
 
+#include "logdevice/common/Timer.h"
 #include "logdevice/include/Err.h"
 #include "logdevice/server/storage_tasks/StorageTask.h"
 
@@ -102,6 +103,15 @@ class PerWorkerStorageTaskQueue {
   // updates the inflight task count.
   void sendTaskToStorageThread(std::unique_ptr<StorageTask>&& task);
 
+  // Puts a WriteBatchStorageTask standing for `num_writes` writes onto the
+  // storage thread pool's main queue.
+  void postWriteBatchTask(StorageTask::ThreadType thread_type,
+                          size_t num_writes);
+
+  // Posts WriteBatchStorageTasks for writes that were coalesced during this
+  // event loop iteration. See Settings::coalesce_write_batch_tasks.
+  void flushWriteBatchTasks();
+
   // Called when putTask() needs to buffer but the buffer is full. Drops
   // normal-priority tasks buffered in this queue and requests
   // StorageThreadPool corresponding to shard_idx_ to drop tasks as well.
@@ -126,6 +136,16 @@ class PerWorkerStorageTaskQueue {
 
     // last time drop() was called
     std::chrono::steady_clock::time_point last_queue_drop_time{};
+
+    // True if a WriteBatchStorageTask was posted in the current event loop
+    // iteration. Further writes in the same iteration only bump
+    // writes_without_batch_task, and flushWriteBatchTasks() posts a single
+    // task for all of them.
+    bool write_batch_task_posted{false};
+    size_t writes_without_batch_task{0};
   } taskBuffer_[(int)StorageTask::ThreadType::MAX];
+
+  // Fires at the next event loop iteration to call flushWriteBatchTasks().
+  Timer flush_write_batches_timer_;
 };
 }} // namespace facebook::logdevice
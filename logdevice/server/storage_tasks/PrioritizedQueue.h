@@ -17,6 +17,7 @@
 #include <folly/MPMCQueue.h>
 #include <folly/SharedMutex.h>
 #include <folly/small_vector.h>
+#include <folly/synchronization/LifoSem.h>
 #include <logdevice/common/Semaphore.h>
 #include <logdevice/common/debug.h>
 #include <logdevice/common/stats/Stats.h>
@@ -29,7 +30,41 @@
  */
 namespace facebook { namespace logdevice {
 
-template <class T, size_t NumPriorities>
+namespace detail {
+/**
+ * Adapts folly::LifoSem to the interface of Semaphore. Posting and waiting
+ * are lock-free and don't enter the kernel unless a thread actually has to
+ * sleep, and the most recently idle thread is woken up first, which keeps
+ * fewer storage threads bouncing between sleeping and running when the pool
+ * is lightly loaded.
+ */
+class LifoSemaphore {
+ public:
+  void post() {
+    sem_.post();
+  }
+  void wait() {
+    sem_.wait();
+  }
+  bool try_wait() {
+    return sem_.tryWait();
+  }
+
+ private:
+  folly::LifoSem sem_;
+};
+} // namespace detail
+
+/**
+ * Per-priority lock-free MPMC queues with a counting semaphore tracking the
+ * total number of queued items.
+ *
+ * @param Sem  Semaphore used to wait for items. Needs post(), wait() and
+ *             try_wait(). The POSIX Semaphore FIFO-wakes waiters through a
+ *             single futex, which shows up as contention with many storage
+ *             threads; LifoSemaphore (the default) doesn't.
+ */
+template <class T, size_t NumPriorities, class Sem = detail::LifoSemaphore>
 class PrioritizedQueue {
  public:
   PrioritizedQueue(size_t size, StatsHolder* stats) : stats_(stats) {
@@ -171,7 +206,7 @@ class PrioritizedQueue {
  private:
   std::vector<folly::MPMCQueue<T>> queues_;
 
-  Semaphore sem_;
+  Sem sem_;
 
   /**
    * The pointer to stats.
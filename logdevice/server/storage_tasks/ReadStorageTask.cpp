@@ -15,6 +15,8 @@
 #include <folly/synchronization/Baton.h>
 
 #include "logdevice/common/AdminCommandTable.h"
+#include "logdevice/common/Checksum.h"
+#include "logdevice/common/LocalLogStoreRecordFormat.h"
 #include "logdevice/common/Processor.h"
 #include "logdevice/common/Sender.h"
 #include "logdevice/common/debug.h"
@@ -34,6 +36,14 @@ namespace facebook { namespace logdevice {
  */
 class StorageThreadCallback : public LocalLogStoreReader::Callback {
  public:
+  using PayloadMode = ReadStorageTask::PayloadMode;
+
+  // If `shareable_blobs` is true, records are copied into refcounted buffers
+  // so that the worker can ship their payloads without another copy.
+  explicit StorageThreadCallback(bool shareable_blobs = false,
+                                 PayloadMode payload_mode = PayloadMode::FULL)
+      : shareable_blobs_(shareable_blobs), payload_mode_(payload_mode) {}
+
   int processRecord(const RawRecord& raw_record) override;
   ReadStorageTask::RecordContainer&& releaseRecords() {
     return std::move(records_);
@@ -43,7 +53,24 @@ class StorageThreadCallback : public LocalLogStoreReader::Callback {
     return total_bytes_;
   }
 
+  size_t payloadBytesSkipped() const {
+    return payload_bytes_skipped_;
+  }
+
  private:
+  // Copies `blob' into a buffer owned by a new record in records_.
+  void addRecord(const RawRecord& record, Slice blob, Slice suffix = Slice());
+
+  // Copies a record without its payload, followed by the payload's length and
+  // hash if payload_mode_ is HASH_ONLY.
+  //
+  // @return  false if the payload must be kept, e.g. because it's compressed
+  //          and its hash can't be computed without uncompressing it
+  bool addRecordWithoutPayload(const RawRecord& record);
+
+  const bool shareable_blobs_;
+  const PayloadMode payload_mode_;
+  size_t payload_bytes_skipped_{0};
   size_t total_bytes_{0}; // Used for stats.
   ReadStorageTask::RecordContainer records_;
 };
@@ -69,6 +96,7 @@ ReadStorageTask::ReadStorageTask(
       server_read_stream_version_(server_read_stream_version),
       filter_version_(filter_version),
       read_ctx_(read_ctx),
+      start_read_ptr_(read_ctx.read_ptr_),
       options_(options),
       iterator_from_cache_(iterator),
       thread_type_(thread_type),
@@ -88,6 +116,11 @@ ReadStorageTask::ReadStorageTask(
   stream_shard_ = stream_ptr->shard_;
   stream_scd_enabled_ = stream_ptr->scdEnabled();
   stream_known_down_ = stream_ptr->getKnownDown();
+  if (stream_ptr->no_payload_ || stream_ptr->csi_data_only_) {
+    payload_mode_ = PayloadMode::NONE;
+  } else if (stream_ptr->payload_hash_only_) {
+    payload_mode_ = PayloadMode::HASH_ONLY;
+  }
 
   // catchup_queue may be nullptr in tests.
 
@@ -140,7 +173,9 @@ void ReadStorageTask::execute() {
 
     ld_check(owned_iterator_);
 
-    StorageThreadCallback callback;
+    StorageThreadCallback callback(
+        storageThreadPool_->getSettings()->zero_copy_record_delivery,
+        payload_mode_);
     Status status =
         LocalLogStoreReader::read(*owned_iterator_,
                                   callback,
@@ -155,6 +190,9 @@ void ReadStorageTask::execute() {
     records_ = std::move(callback.releaseRecords());
 
     total_bytes_ = callback.totalBytes();
+    STAT_ADD(storageThreadPool_->stats(),
+             read_storage_tasks_payload_bytes_skipped,
+             callback.payloadBytesSkipped());
 
     /*
      * TODO (T37204962).
@@ -229,18 +267,108 @@ int StorageThreadCallback::processRecord(const RawRecord& record) {
   // data out of the local log store into a malloc'd buffer, since records
   // will only get passed to the messaging layer at some later time (when the
   // worker thread gets around to processing the ReadStorageTask result).
-  void* blob_copy = malloc(record.blob.size);
+  if (payload_mode_ != PayloadMode::FULL && addRecordWithoutPayload(record)) {
+    return 0;
+  }
+  addRecord(record, record.blob);
+  return 0;
+}
+
+void StorageThreadCallback::addRecord(const RawRecord& record,
+                                      Slice blob,
+                                      Slice suffix) {
+  const size_t size = blob.size + suffix.size;
+  total_bytes_ += size;
+  if (shareable_blobs_) {
+    folly::IOBuf buf(folly::IOBuf::CREATE, size);
+    memcpy(buf.writableTail(), blob.data, blob.size);
+    if (suffix.size > 0) {
+      memcpy(buf.writableTail() + blob.size, suffix.data, suffix.size);
+    }
+    buf.append(size);
+    records_.emplace_back(
+        record.lsn, std::move(buf), record.from_under_replicated_region);
+    return;
+  }
+
+  void* blob_copy = malloc(size);
   if (blob_copy == nullptr) {
     throw std::bad_alloc();
   }
-  memcpy(blob_copy, record.blob.data, record.blob.size);
-  total_bytes_ += record.blob.size;
+  memcpy(blob_copy, blob.data, blob.size);
+  if (suffix.size > 0) {
+    memcpy(static_cast<char*>(blob_copy) + blob.size, suffix.data, suffix.size);
+  }
 
   records_.emplace_back( // creating a RawRecord
       record.lsn,
-      Slice(blob_copy, record.blob.size),
+      Slice(blob_copy, size),
       /*owned*/ true, // We malloc-d the memory
       record.from_under_replicated_region);
-  return 0;
+}
+
+bool StorageThreadCallback::addRecordWithoutPayload(const RawRecord& record) {
+  using namespace LocalLogStoreRecordFormat;
+  flags_t flags;
+  Payload payload;
+  int rv = parse(record.blob,
+                 nullptr,
+                 nullptr,
+                 &flags,
+                 nullptr,
+                 nullptr,
+                 nullptr,
+                 0,
+                 nullptr,
+                 nullptr,
+                 &payload,
+                 /*this_shard=*/0);
+  if (rv != 0) {
+    // Let the worker deal with it.
+    return false;
+  }
+  // The payload is at the end of the blob.
+  const size_t header_size = record.blob.size - payload.size();
+  ld_check(payload.size() == 0 ||
+           static_cast<const char*>(payload.data()) ==
+               static_cast<const char*>(record.blob.data) + header_size);
+  Slice header(record.blob.data, header_size);
+
+  if (payload_mode_ == PayloadMode::NONE) {
+    addRecord(record, header);
+    payload_bytes_skipped_ += payload.size();
+    return true;
+  }
+
+  ld_check(payload_mode_ == PayloadMode::HASH_ONLY);
+  if (flags & FLAG_PAYLOAD_COMPRESSED) {
+    return false;
+  }
+  const size_t checksum_size =
+      flags & FLAG_CHECKSUM ? (flags & FLAG_CHECKSUM_64BIT ? 8 : 4) : 0;
+  if (payload.size() < checksum_size) {
+    // Malformed, the worker will complain.
+    return false;
+  }
+  Slice data(static_cast<const char*>(payload.data()) + checksum_size,
+             payload.size() - checksum_size);
+
+  // Same format as CatchupOneStream sends to PAYLOAD_HASH_ONLY streams.
+  struct {
+    uint32_t length;
+    uint32_t hash;
+  } __attribute__((__packed__)) h;
+  h.length = static_cast<uint32_t>(data.size);
+  if (checksum_size == 4) {
+    // The stored 32-bit checksum is the hash we're after, no need to read
+    // the payload.
+    memcpy(&h.hash, payload.data(), sizeof(h.hash));
+  } else {
+    h.hash = checksum_32bit(data);
+  }
+  addRecord(record, header, Slice(&h, sizeof(h)));
+  records_.back().payload_hash_only = true;
+  payload_bytes_skipped_ += payload.size();
+  return true;
 }
 }} // namespace facebook::logdevice
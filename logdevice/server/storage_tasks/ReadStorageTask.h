@@ -106,6 +106,9 @@ class ReadStorageTask : public StorageTask {
   const server_read_stream_version_t server_read_stream_version_;
   const filter_version_t filter_version_;
   LocalLogStoreReader::ReadContext read_ctx_;
+  // Read pointer the read started at.  read_ctx_.read_ptr_ is advanced by
+  // execute().
+  const LocalLogStoreReader::ReadPointer start_read_ptr_;
   ResourceBudget::Token memory_token_;
   LocalLogStore::ReadOptions options_;
 
@@ -130,6 +133,11 @@ class ReadStorageTask : public StorageTask {
   StorageTaskPriority priority_;
   Principal principal_;
 
+  // What the stream needs of record payloads. Streams that don't ship
+  // payloads get records with the payload stripped by the storage thread.
+  enum class PayloadMode { FULL, NONE, HASH_ONLY };
+  PayloadMode payload_mode_{PayloadMode::FULL};
+
   size_t getThrottlingEstimate() const {
     return throttling_estimate_;
   }
@@ -7,12 +7,15 @@
  */
 #include "logdevice/server/storage_tasks/RecordCacheRepopulationTask.h"
 
+#include <unordered_set>
+
 #include "logdevice/common/Processor.h"
 #include "logdevice/common/Worker.h"
 #include "logdevice/common/debug.h"
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/common/types_internal.h"
 #include "logdevice/server/RecordCache.h"
+#include "logdevice/server/RecordCachePersistence.h"
 #include "logdevice/server/ServerProcessor.h"
 #include "logdevice/server/locallogstore/LocalLogStore.h"
 #include "logdevice/server/read_path/LogStorageStateMap.h"
@@ -40,6 +43,12 @@ void RecordCacheRepopulationTask::execute() {
       ld_critical(
           "Failed to delete all log snapshot blobs on shard %d", shard_idx_);
       status_ = E::FAILED;
+    } else {
+      // Only blobs written by this instance are left, checkpoints may start.
+      auto& persistence_state =
+          log_storage_state_map.getRecordCachePersistenceState(shard_idx_);
+      std::lock_guard<std::mutex> guard(persistence_state.mutex);
+      persistence_state.repopulated = true;
     }
   };
 
@@ -56,8 +65,62 @@ void RecordCacheRepopulationTask::execute() {
       storageThreadPool_->getProcessor().settings()->record_cache_max_size /
       sharded_store->numShards();
 
+  // Blobs are read in order of log id, so the manifest comes first. Blobs
+  // written before manifests were introduced have none and are complete.
+  bool first_blob = true;
+  bool discarded = false;
+  // Set if the blobs are a checkpoint left by a crashed instance, which is
+  // repopulated except for the caches of the logs written after it.
+  bool recovered = false;
+  std::unordered_set<logid_t> written_after_checkpoint;
+  size_t invalidated_caches = 0;
+
   LocalLogStore::LogSnapshotBlobCallback repopulate = [&](logid_t log_id,
                                                           Slice data) {
+    if (first_blob && log_id == RecordCachePersistence::MANIFEST_LOG_ID) {
+      first_blob = false;
+      bool clean_shutdown;
+      uint64_t sequence_number;
+      if (RecordCachePersistence::readManifest(
+              data, &clean_shutdown, &sequence_number) != 0) {
+        ld_error("Invalid record cache manifest on shard %d", shard_idx_);
+        return -1;
+      }
+      if (clean_shutdown) {
+        return 0;
+      }
+      if (sequence_number != 0 &&
+          storageThreadPool_->getProcessor()
+              .settings()
+              ->record_cache_recover_checkpoints &&
+          shard.findLogsWrittenSince(
+              sequence_number, &written_after_checkpoint) == 0) {
+        ld_info("Record caches on shard %d were checkpointed at sequence "
+                "number %lu by an instance that didn't shut down cleanly. "
+                "Repopulating them, except for %lu logs written since.",
+                shard_idx_,
+                sequence_number,
+                written_after_checkpoint.size());
+        recovered = true;
+        return 0;
+      }
+      ld_info("Record caches on shard %d were checkpointed by an instance "
+              "that didn't shut down cleanly, discarding them.",
+              shard_idx_);
+      discarded = true;
+      return -1;
+    }
+    first_blob = false;
+    if (data.size == 0) {
+      // Record cache dropped on shutdown.
+      return 0;
+    }
+    if (written_after_checkpoint.count(log_id)) {
+      // Misses the records stored after the checkpoint.
+      invalidated_caches++;
+      return 0;
+    }
+
     if (bytes_limit_per_shard > 0 &&
         repopulated_bytes + data.size > bytes_limit_per_shard) {
       ld_error("Repopulating saved snapshot of record cache on shard %d "
@@ -84,7 +147,15 @@ void RecordCacheRepopulationTask::execute() {
 
   int rv = shard.readAllLogSnapshotBlobs(
       LocalLogStore::LogSnapshotBlobType::RECORD_CACHE, repopulate);
-  if (rv == 0) {
+  if (discarded) {
+    STAT_INCR(stats_, record_cache_checkpoints_discarded);
+    status_ = E::OK;
+  } else if (rv == 0) {
+    if (recovered) {
+      STAT_INCR(stats_, record_cache_checkpoints_recovered);
+      STAT_ADD(
+          stats_, record_cache_checkpoint_logs_invalidated, invalidated_caches);
+    }
     status_ = E::OK;
   } else {
     ld_error("Failed to read all snapshots on shard %d. Repopulated caches "
@@ -75,7 +75,7 @@ void RecoverSealTask::invokeCallback() {
       ServerWorker::onThisThread()->processor_->getLogStorageStateMap().get(
           log_id_, storageThreadPool_->getShardIdx());
 
-  RecordCache* cache = state.record_cache_.get();
+  RecordCache* cache = state.getRecordCache();
   if (cache != nullptr) {
     cache->updateLastNonAuthoritativeEpoch(log_id_);
   }
@@ -21,8 +21,22 @@ ShardedStorageThreadPool::ShardedStorageThreadPool(
     const std::shared_ptr<TraceLogger> trace_logger)
     : sharded_log_store_(store) {
   shard_size_t nshards = store->numShards();
+  wal_sync_group_ = std::make_unique<WALSyncGroup>(nshards);
   pools_.reserve(nshards);
   for (shard_index_t shard_idx = 0; shard_idx < nshards; ++shard_idx) {
+    int numa_node = -1;
+    if (settings->numa_aware_storage_threads) {
+      numa_node = store->getShardNumaNode(shard_idx);
+      if (numa_node == -1) {
+        ld_warning("NUMA node of shard %u is unknown, its storage threads "
+                   "will not be pinned",
+                   shard_idx);
+      } else {
+        ld_info("Pinning storage threads of shard %u to NUMA node %d",
+                shard_idx,
+                numa_node);
+      }
+    }
     pools_.push_back(
         // may throw
         std::make_unique<StorageThreadPool>(shard_idx,
@@ -33,7 +47,9 @@ ShardedStorageThreadPool::ShardedStorageThreadPool(
                                             store->getByIndex(shard_idx),
                                             task_queue_size,
                                             stats,
-                                            trace_logger));
+                                            trace_logger,
+                                            numa_node,
+                                            wal_sync_group_.get()));
   }
 }
 }} // namespace facebook::logdevice
@@ -13,6 +13,7 @@
 #include "logdevice/include/types.h"
 #include "logdevice/server/locallogstore/LocalLogStore.h"
 #include "logdevice/server/storage_tasks/StorageThreadPool.h"
+#include "logdevice/server/storage_tasks/WALSyncGroup.h"
 
 namespace facebook { namespace logdevice {
 
@@ -73,6 +74,9 @@ class ShardedStorageThreadPool {
   }
 
  private:
+  // Shared by the syncing threads of all pools. Declared before pools_ so
+  // that it outlives them.
+  std::unique_ptr<WALSyncGroup> wal_sync_group_;
   std::vector<std::unique_ptr<StorageThreadPool>> pools_;
   ShardedLocalLogStore* const sharded_log_store_;
 };
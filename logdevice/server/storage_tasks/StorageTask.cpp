@@ -22,7 +22,13 @@ StorageTaskDebugInfo StorageTask::getDebugInfo() const {
                                 .approximateSystemTimestamp()
                                 .toMilliseconds(),
                             durability_to_string(durability()));
+  info.principal = toString(getPrincipal());
   // Fill optional fields
+  if (dequeue_time_) {
+    info.dequeue_time = SteadyTimestamp(dequeue_time_.value())
+                            .approximateSystemTimestamp()
+                            .toMilliseconds();
+  }
   if (execution_start_time_) {
     info.execution_start_time = SteadyTimestamp(execution_start_time_.value())
                                     .approximateSystemTimestamp()
@@ -248,6 +248,10 @@ class StorageTask {
   // Used to maintain histograms of queueing time of storage tasks.
   std::chrono::steady_clock::time_point enqueue_time_;
 
+  // Time a storage thread took this task off the queue. For writes, when a
+  // WriteBatchStorageTask picked it up from the write queue.
+  folly::Optional<std::chrono::steady_clock::time_point> dequeue_time_;
+
   // Time this task execution was started
   folly::Optional<std::chrono::steady_clock::time_point> execution_start_time_;
   // Time this task execution was finished
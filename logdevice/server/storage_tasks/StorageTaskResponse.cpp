@@ -7,14 +7,32 @@
  */
 #include "logdevice/server/storage_tasks/StorageTaskResponse.h"
 
+#include <algorithm>
+
 #include <folly/Memory.h>
 
+#include "logdevice/common/OwnerThreadFreeList.h"
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/server/ServerWorker.h"
 #include "logdevice/server/storage_tasks/PerWorkerStorageTaskQueue.h"
 
 namespace facebook { namespace logdevice {
 
+void* StorageTaskResponse::operator new(size_t size) {
+  if (size == sizeof(StorageTaskResponse)) {
+    return OwnerThreadFreeList<StorageTaskResponse>::allocate();
+  }
+  return ::operator new(size);
+}
+
+void StorageTaskResponse::operator delete(void* ptr, size_t size) {
+  if (size == sizeof(StorageTaskResponse)) {
+    OwnerThreadFreeList<StorageTaskResponse>::deallocate(ptr);
+    return;
+  }
+  ::operator delete(ptr);
+}
+
 void StorageTaskResponse::sendBackToWorker(std::unique_ptr<StorageTask> task) {
   auto executor = task->reply_executor_;
   if (!executor) {
@@ -24,6 +42,7 @@ void StorageTaskResponse::sendBackToWorker(std::unique_ptr<StorageTask> task) {
 
   auto stats = task->stats_;
   auto worker_idx = task->reply_worker_idx_;
+  auto task_type = task->getType();
 
   // Tasks not associated with any worker are completed directly.
   if (worker_idx == WORKER_ID_INVALID) {
@@ -48,6 +67,7 @@ void StorageTaskResponse::sendBackToWorker(std::unique_ptr<StorageTask> task) {
   }
 
   Request::bumpStatsWhenPosted(stats, req_type, worker_type, worker_idx, true);
+  STORAGE_TASK_TYPE_STAT_INCR(stats, task_type, storage_task_response_wakeups);
 }
 
 void StorageTaskResponse::sendDroppedToWorker(
@@ -92,4 +112,71 @@ std::string StorageTaskResponse::describe() const {
       storageTaskTypeNames[task_->getType()] + ")";
 }
 
+constexpr size_t StorageTaskResponseBatcher::MAX_BATCH_SIZE;
+
+void StorageTaskResponseBatcher::add(std::unique_ptr<StorageTask> task) {
+  auto w = dynamic_cast<Worker*>(task->reply_executor_);
+  if (!w || task->reply_worker_idx_ == WORKER_ID_INVALID) {
+    // Nothing to batch.
+    StorageTaskResponse::sendBackToWorker(std::move(task));
+    return;
+  }
+
+  auto stats = task->stats_;
+  auto task_type = task->getType();
+  std::unique_ptr<Request> req =
+      std::make_unique<StorageTaskResponse>(std::move(task));
+  auto priority = req->getExecutorPriority();
+
+  auto it = std::find_if(batches_.begin(), batches_.end(), [&](const Batch& b) {
+    return b.worker == w && b.priority == priority;
+  });
+  if (it == batches_.end()) {
+    batches_.push_back(Batch{w, priority, stats, {}, {}});
+    it = std::prev(batches_.end());
+  }
+  if (size_ == 0) {
+    oldest_added_at_ = std::chrono::steady_clock::now();
+  }
+  it->requests.push_back(std::move(req));
+  it->task_types.set(static_cast<size_t>(task_type));
+  ++size_;
+
+  if (it->requests.size() >= MAX_BATCH_SIZE) {
+    post(*it);
+    batches_.erase(it);
+  }
+}
+
+void StorageTaskResponseBatcher::flush() {
+  for (Batch& batch : batches_) {
+    post(batch);
+  }
+  batches_.clear();
+  ld_check(size_ == 0);
+}
+
+void StorageTaskResponseBatcher::post(Batch& batch) {
+  ld_check(size_ >= batch.requests.size());
+  size_ -= batch.requests.size();
+
+  for (const auto& req : batch.requests) {
+    Request::bumpStatsWhenPosted(batch.stats,
+                                 req->type_,
+                                 req->getWorkerTypeAffinity(),
+                                 batch.worker->idx_,
+                                 true);
+  }
+  for (size_t i = 0; i < batch.task_types.size(); ++i) {
+    if (batch.task_types.test(i)) {
+      STORAGE_TASK_TYPE_STAT_INCR(batch.stats,
+                                  static_cast<StorageTaskType>(i),
+                                  storage_task_response_wakeups);
+    }
+  }
+
+  int rv = batch.worker->forcePostBatch(batch.requests, batch.priority);
+  ld_check(rv == 0);
+}
+
 }} // namespace facebook::logdevice
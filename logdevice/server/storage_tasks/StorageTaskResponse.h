@@ -7,7 +7,10 @@
  */
 #pragma once
 
+#include <bitset>
+#include <chrono>
 #include <memory>
+#include <vector>
 
 #include "logdevice/common/Request.h"
 #include "logdevice/common/RequestType.h"
@@ -15,6 +18,8 @@
 
 namespace facebook { namespace logdevice {
 
+class Worker;
+
 /**
  * @file Storage threads create this Request to let the worker thread know
  *       when the StorageTask has finished processing.
@@ -47,7 +52,71 @@ class StorageTaskResponse : public Request {
 
   std::string describe() const override;
 
+  /**
+   * StorageTaskResponses are allocated on storage threads and destroyed on
+   * workers; their memory goes back to the allocating storage thread (see
+   * OwnerThreadFreeList) rather than through a cross-thread free.
+   */
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size);
+
  private:
   std::unique_ptr<StorageTask> task_;
 };
+
+/**
+ * Used by a storage thread to send StorageTaskResponses back to workers in
+ * batches: responses going to the same worker with the same priority are held
+ * and then added to the worker's task queue as a single task, so the worker is
+ * woken up once per batch instead of once per response. Responses to tasks
+ * whose reply executor isn't a Worker are sent right away.
+ *
+ * The owner decides when to flush(), bounding the added latency. Not thread
+ * safe.
+ */
+class StorageTaskResponseBatcher {
+ public:
+  // A batch is posted as soon as it has this many responses.
+  static constexpr size_t MAX_BATCH_SIZE = 64;
+
+  ~StorageTaskResponseBatcher() {
+    flush();
+  }
+
+  /**
+   * Same as StorageTaskResponse::sendBackToWorker(), except that the response
+   * may be held until the next flush().
+   */
+  void add(std::unique_ptr<StorageTask> task);
+
+  // Posts all held responses.
+  void flush();
+
+  // @return number of responses held
+  size_t size() const {
+    return size_;
+  }
+
+  // @return when the oldest held response was added; only valid if size() > 0
+  std::chrono::steady_clock::time_point oldestAddedAt() const {
+    return oldest_added_at_;
+  }
+
+ private:
+  struct Batch {
+    Worker* worker;
+    int8_t priority;
+    StatsHolder* stats;
+    std::vector<std::unique_ptr<Request>> requests;
+    // types of the tasks in `requests`
+    std::bitset<static_cast<size_t>(StorageTaskType::MAX)> task_types;
+  };
+
+  void post(Batch& batch);
+
+  // one per (worker, priority) with responses held, there are few of them
+  std::vector<Batch> batches_;
+  size_t size_ = 0;
+  std::chrono::steady_clock::time_point oldest_added_at_;
+};
 }} // namespace facebook::logdevice
@@ -72,7 +72,9 @@ StorageThreadPool::StorageThreadPool(
     LocalLogStore* local_log_store,
     size_t task_queue_size,
     StatsHolder* stats,
-    const std::shared_ptr<TraceLogger> trace_logger)
+    const std::shared_ptr<TraceLogger> trace_logger,
+    int numa_node,
+    WALSyncGroup* wal_sync_group)
     : server_settings_(server_settings),
       settings_(settings),
       nthreads_slow_(params[(size_t)ThreadType::SLOW].nthreads),
@@ -88,6 +90,8 @@ StorageThreadPool::StorageThreadPool(
       stats_(stats),
       shard_idx_(shard_idx),
       num_shards_(num_shards),
+      numa_node_(numa_node),
+      wal_sync_group_(wal_sync_group),
       taskQueues_([&, task_queue_size]() {
         const auto actual_queue_sizes =
             computeActualQueueSizes(task_queue_size);
@@ -364,18 +368,37 @@ bool StorageThreadPool::blockingPutTask(std::unique_ptr<StorageTask>&& task) {
 
 std::unique_ptr<StorageTask>
 StorageThreadPool::blockingGetTask(StorageTask::ThreadType type) {
+  return getTask(type, /* blocking */ true);
+}
+
+std::unique_ptr<StorageTask>
+StorageThreadPool::tryGetTask(StorageTask::ThreadType type) {
+  return getTask(type, /* blocking */ false);
+}
+
+std::unique_ptr<StorageTask>
+StorageThreadPool::getTask(StorageTask::ThreadType type, bool blocking) {
   auto& task_queue = taskQueues_[getThreadType(type)];
   std::map<StorageTaskType, int> dropped_by_type;
 
+  std::unique_ptr<StorageTask> task;
   while (true) {
     StorageTask* rawptr;
     if (useDRR_ && (type == StorageTask::ThreadType::SLOW)) {
-      rawptr = task_queue.drrQueue.blockingDequeue();
-    } else {
+      rawptr = blocking ? task_queue.drrQueue.blockingDequeue()
+                        : task_queue.drrQueue.dequeue();
+    } else if (blocking) {
       task_queue.queue.blockingRead(rawptr);
+    } else if (!task_queue.queue.read(rawptr)) {
+      rawptr = nullptr;
+    }
+
+    if (rawptr == nullptr) {
+      ld_check(!blocking);
+      break;
     }
 
-    std::unique_ptr<StorageTask> task(rawptr);
+    task.reset(rawptr);
 
     STORAGE_TASK_STAT_DECR(stats_, type, num_storage_tasks);
 
@@ -386,17 +409,19 @@ StorageThreadPool::blockingGetTask(StorageTask::ThreadType type) {
       continue;
     }
 
-    if (!dropped_by_type.empty()) {
-      RATELIMIT_INFO(std::chrono::seconds(1),
-                     2,
-                     "Dropping storage tasks in shard %d: %s",
-                     (int)shard_idx_,
-                     toString(dropped_by_type).c_str());
-    }
-
     STORAGE_TASK_STAT_INCR(stats_, type, storage_tasks_dequeued);
-    return task;
+    task->dequeue_time_ = std::chrono::steady_clock::now();
+    break;
   }
+
+  if (!dropped_by_type.empty()) {
+    RATELIMIT_INFO(std::chrono::seconds(1),
+                   2,
+                   "Dropping storage tasks in shard %d: %s",
+                   (int)shard_idx_,
+                   toString(dropped_by_type).c_str());
+  }
+  return task;
 }
 
 folly::small_vector<std::unique_ptr<WriteStorageTask>, 4>
@@ -410,7 +435,9 @@ StorageThreadPool::tryGetWriteBatch(StorageTask::ThreadType thread_type,
       task_queue.write_queue.readBatchSinglePriority(max_count, max_bytes);
   folly::small_vector<std::unique_ptr<WriteStorageTask>, 4> res;
   res.reserve(raw_tasks.size());
+  const auto now = std::chrono::steady_clock::now();
   for (auto rawptr : raw_tasks) {
+    rawptr->dequeue_time_ = now;
     res.emplace_back(rawptr);
   }
   return res;
@@ -420,6 +447,17 @@ void StorageThreadPool::enqueueForSync(std::unique_ptr<StorageTask> task) {
   syncing_thread_->enqueueForSync(std::move(task));
 }
 
+size_t StorageThreadPool::getNumQueuedTasks(StorageTask::ThreadType type) {
+  auto& task_queue = taskQueues_[getThreadType(type)];
+  ssize_t ntasks;
+  if (useDRR_ && (type == StorageTask::ThreadType::SLOW)) {
+    ntasks = task_queue.drrQueue.size();
+  } else {
+    ntasks = task_queue.queue.size();
+  }
+  return std::max(ntasks, ssize_t(0));
+}
+
 void StorageThreadPool::dropTaskQueue(StorageTask::ThreadType type) {
   auto& task_queue = taskQueues_[getThreadType(type)];
   ssize_t ntasks;
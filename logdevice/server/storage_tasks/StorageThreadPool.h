@@ -18,6 +18,7 @@
 #include "logdevice/common/SimpleEnumMap.h"
 #include "logdevice/common/settings/Settings.h"
 #include "logdevice/server/ServerSettings.h"
+#include "logdevice/server/storage_tasks/PendingCacheWrites.h"
 #include "logdevice/server/storage_tasks/PrioritizedQueue.h"
 #include "logdevice/server/storage_tasks/StorageTask.h"
 
@@ -34,6 +35,7 @@ class ServerProcessor;
 class StatsHolder;
 class ExecStorageThread;
 class SyncingStorageThread;
+class WALSyncGroup;
 class TraceLogger;
 class WriteStorageTask;
 
@@ -52,6 +54,13 @@ class StorageThreadPool {
    * Creates the pool and starts all threads.  Does not claim ownership of the
    * local log store.
    *
+   * @param numa_node  if not -1, all threads of the pool pin themselves to the
+   *                   cpus of this NUMA node when they start
+   * @param wal_sync_group  if not null, the syncing thread lines up its WAL
+   *                        syncs with other shards' through it, see
+   *                        --wal-sync-group-commit-window; must outlive
+   *                        the pool
+   *
    * @throws ConstructorFailed on failure
    */
   StorageThreadPool(shard_index_t shard_idx,
@@ -62,7 +71,9 @@ class StorageThreadPool {
                     LocalLogStore* local_log_store,
                     size_t task_queue_size,
                     StatsHolder* stats = nullptr,
-                    const std::shared_ptr<TraceLogger> trace_logger = nullptr);
+                    const std::shared_ptr<TraceLogger> trace_logger = nullptr,
+                    int numa_node = -1,
+                    WALSyncGroup* wal_sync_group = nullptr);
 
   ~StorageThreadPool();
 
@@ -107,6 +118,26 @@ class StorageThreadPool {
     return shard_idx_;
   }
 
+  // Cross-shard WAL sync group commit coordinator, may be null.
+  WALSyncGroup* getWALSyncGroup() const {
+    return wal_sync_group_;
+  }
+
+  // Writes of the shard that may not be in the record caches yet, see
+  // RecordCachePersistence.
+  PendingCacheWrites& getPendingCacheWrites() {
+    return pending_cache_writes_;
+  }
+
+  // Approximate number of tasks waiting in the queue for the given thread
+  // type.
+  size_t getNumQueuedTasks(StorageTask::ThreadType type);
+
+  // NUMA node the threads of this pool are pinned to, -1 if they aren't.
+  int getNumaNode() const {
+    return numa_node_;
+  }
+
   // If true, storage tasks of type FAST_STALLABLE should stall writes
   bool writeStallingEnabled() const {
     return nthreads_fast_stallable_ > 0;
@@ -143,6 +174,21 @@ class StorageThreadPool {
     }
   }
 
+  /*
+   * Settles the cost of a SLOW task with the scheduler once it has executed:
+   * the task was dequeued at its reqSize() and actually cost `actual`.
+   * See DRRScheduler::chargeCost().
+   */
+  void chargeScheduler(uint64_t charged,
+                       uint64_t actual,
+                       StorageTaskPrincipal p) {
+    if (useDRR_) {
+      uint32_t principal = static_cast<uint32_t>(p);
+      taskQueues_[StorageTask::ThreadType::SLOW].drrQueue.chargeCost(
+          charged, actual, principal);
+    }
+  }
+
   /**
    * Attempts to put a task onto the queue.  If it succeeds (there is room on
    * the queue), claims ownership of the task.
@@ -174,6 +220,12 @@ class StorageThreadPool {
    */
   std::unique_ptr<StorageTask> blockingGetTask(StorageTask::ThreadType type);
 
+  /**
+   * Same as blockingGetTask() but returns nullptr instead of blocking if
+   * there are no tasks.
+   */
+  std::unique_ptr<StorageTask> tryGetTask(StorageTask::ThreadType type);
+
   /**
    * Tries to get a batch of WriteStorageTasks from the write queue.
    * @return nullptr if write queue was empty
@@ -240,6 +292,8 @@ class StorageThreadPool {
 
   const std::shared_ptr<TraceLogger> trace_logger_;
 
+  PendingCacheWrites pending_cache_writes_;
+
   struct PerTypeTaskQueue {
     PerTypeTaskQueue(size_t size, size_t memory_limit, StatsHolder* stats)
         : queue(size, stats),
@@ -272,6 +326,10 @@ class StorageThreadPool {
   shard_index_t shard_idx_;
   size_t num_shards_;
 
+  const int numa_node_;
+
+  WALSyncGroup* const wal_sync_group_;
+
   // Separate queue for each type of storage thread.
   SimpleEnumMap<StorageTask::ThreadType, PerTypeTaskQueue> taskQueues_;
 
@@ -288,6 +346,10 @@ class StorageThreadPool {
   bool tryDropOneTask(std::unique_ptr<StorageTask>& task,
                       std::map<StorageTaskType, int>& dropped_by_type);
 
+  // Implementation of blockingGetTask() and tryGetTask().
+  std::unique_ptr<StorageTask> getTask(StorageTask::ThreadType type,
+                                       bool blocking);
+
   /**
    * Called only by the constructor.
    */
@@ -10,13 +10,16 @@
 #include <chrono>
 #include <deque>
 
+#include "logdevice/common/NumaPlacement.h"
 #include "logdevice/common/SlowStorageTasksTracer.h"
 #include "logdevice/common/debug.h"
+#include "logdevice/common/stats/PerShardHistograms.h"
 #include "logdevice/common/stats/Stats.h"
 #include "logdevice/server/locallogstore/LocalLogStore.h"
 #include "logdevice/server/storage_tasks/StorageTask.h"
 #include "logdevice/server/storage_tasks/StorageTaskResponse.h"
 #include "logdevice/server/storage_tasks/StorageThreadPool.h"
+#include "logdevice/server/storage_tasks/WALSyncGroup.h"
 
 namespace facebook { namespace logdevice {
 
@@ -53,6 +56,11 @@ void SyncingStorageThread::stopProcessingTasks() {
 }
 
 void SyncingStorageThread::run() {
+  if (pool_->getNumaNode() != -1) {
+    // Pin before anything else so that thread-local state gets allocated on
+    // the right node.
+    numa::bindThisThreadToNode(pool_->getNumaNode());
+  }
   pool_->getLocalLogStore().onStorageThreadStarted();
   SlowStorageTasksTracer slow_task_tracer{pool_->getTraceLogger()};
 
@@ -120,6 +128,21 @@ void SyncingStorageThread::run() {
 
     if (!batch.empty()) {
       using namespace std::chrono;
+      WALSyncGroup* group = pool_->getWALSyncGroup();
+      const microseconds group_window =
+          pool_->getServerSettings()->wal_sync_group_commit_window;
+      if (group != nullptr && group_window.count() > 0) {
+        WALSyncGroup::Result res = group->join(group_window);
+        PER_SHARD_HISTOGRAM_ADD(pool_->stats(),
+                                wal_sync_group_size,
+                                pool_->getShardIdx(),
+                                res.batch_size);
+        PER_SHARD_HISTOGRAM_ADD(pool_->stats(),
+                                wal_sync_group_wait,
+                                pool_->getShardIdx(),
+                                res.wait_time.count());
+      }
+
       auto start_time = steady_clock::now();
       int rv = pool_->getLocalLogStore().sync(Durability::ASYNC_WRITE);
       auto end_time = steady_clock::now();
@@ -156,13 +179,16 @@ void SyncingStorageThread::run() {
           },
           duration_ms);
 
+      // All of these are ready now, so batching them adds no latency.
+      StorageTaskResponseBatcher responses;
       for (auto& ptr : batch) {
         if (ptr) {
           ptr->onSynced();
-          StorageTaskResponse::sendBackToWorker(std::move(ptr));
+          responses.add(std::move(ptr));
         } else {
         }
       }
+      responses.flush();
       batch.clear();
     }
   }
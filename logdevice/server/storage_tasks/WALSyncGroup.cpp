@@ -0,0 +1,54 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/storage_tasks/WALSyncGroup.h"
+
+#include "logdevice/common/checks.h"
+
+namespace facebook { namespace logdevice {
+
+WALSyncGroup::Result WALSyncGroup::join(std::chrono::microseconds window) {
+  using namespace std::chrono;
+  const auto start_time = steady_clock::now();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  const bool opened = current_ == nullptr;
+  if (opened) {
+    current_ = std::make_shared<Round>();
+  }
+  // Keep a reference so that we can read the round's size after it's closed
+  // and a new one has been opened.
+  std::shared_ptr<Round> round = current_;
+  ++round->joined;
+
+  auto close_round = [&] {
+    ld_check(current_ == round);
+    round->closed = true;
+    current_.reset();
+    cv_.notify_all();
+  };
+
+  if (round->joined >= num_participants_) {
+    close_round();
+  } else if (opened) {
+    // The thread that opened the round closes it when the window expires.
+    cv_.wait_until(lock, start_time + window, [&] { return round->closed; });
+    if (!round->closed) {
+      close_round();
+    }
+  } else {
+    cv_.wait(lock, [&] { return round->closed; });
+  }
+
+  Result res;
+  res.batch_size = round->joined;
+  res.wait_time =
+      duration_cast<microseconds>(steady_clock::now() - start_time);
+  return res;
+}
+
+}} // namespace facebook::logdevice
@@ -0,0 +1,67 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+namespace facebook { namespace logdevice {
+
+/**
+ * @file Group commit of WAL syncs across shards.
+ *
+ * Every shard's SyncingStorageThread syncs its own WAL. When many shards
+ * live on one device, their syncs arrive at the device spread out in time
+ * and each one pays for a separate device flush (journal commit, FUA,
+ * cache flush). A WALSyncGroup shared by the SyncingStorageThreads of all
+ * shards lines the syncs up: a thread that is about to sync join()s the
+ * current round and is released, together with everyone else who joined,
+ * when the round's window expires or when all participants have joined.
+ * The released threads then sync concurrently, which lets the file system
+ * and the device merge their flushes.
+ */
+
+class WALSyncGroup {
+ public:
+  explicit WALSyncGroup(size_t num_participants)
+      : num_participants_(num_participants) {}
+
+  struct Result {
+    // Number of threads released by the round, including the caller.
+    size_t batch_size;
+    // How long the caller waited for the round to close.
+    std::chrono::microseconds wait_time;
+  };
+
+  /**
+   * Joins the current round, opening a new one if there's none, and blocks
+   * until the round closes. A round closes `window` after it was opened or
+   * as soon as all participants have joined it, whichever comes first.
+   * The window of a round is the one passed by the thread that opened it.
+   */
+  Result join(std::chrono::microseconds window);
+
+ private:
+  const size_t num_participants_;
+
+  struct Round {
+    // Number of threads that joined the round.
+    size_t joined{0};
+    bool closed{false};
+  };
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  // Round that threads are currently joining, nullptr if there's none.
+  std::shared_ptr<Round> current_;
+};
+
+}} // namespace facebook::logdevice
@@ -22,6 +22,7 @@
 #include "logdevice/server/IOFaultInjection.h"
 #include "logdevice/server/locallogstore/LocalLogStore.h"
 #include "logdevice/server/locallogstore/WriteOps.h"
+#include "logdevice/server/storage_tasks/ExecStorageThread.h"
 #include "logdevice/server/storage_tasks/StorageTaskResponse.h"
 #include "logdevice/server/storage_tasks/StorageThreadPool.h"
 #include "logdevice/server/storage_tasks/WriteStorageTask.h"
@@ -29,6 +30,20 @@
 namespace facebook { namespace logdevice {
 
 void WriteBatchStorageTask::execute() {
+  // Pick up at least as many writes as this task was posted for, so that
+  // there's still a WriteBatchStorageTask in the main queue for every write
+  // in the write queue.
+  size_t picked = 0;
+  do {
+    size_t n = executeBatch();
+    if (n == 0) {
+      break;
+    }
+    picked += n;
+  } while (picked < num_writes_);
+}
+
+size_t WriteBatchStorageTask::executeBatch() {
   using namespace std::chrono_literals;
 
   size_t ntasks, limit = getWriteBatchSize();
@@ -39,7 +54,7 @@ void WriteBatchStorageTask::execute() {
 
   if (ntasks == 0) {
     // Common case, avoid cost of interaction with local log store
-    return;
+    return 0;
   }
 
   // Yield to higher-pri tasks if needed. Since this can take a few seconds
@@ -131,8 +146,22 @@ void WriteBatchStorageTask::execute() {
     STAT_INCR(stats(), write_batches);
   }
 
+  // All writes in the batch start executing together; the time between their
+  // dequeue and now is reported as batching time.
+  const auto write_start_time = std::chrono::steady_clock::now();
+  for (auto& write : writes) {
+    if (write) {
+      write->execution_start_time_ = write_start_time;
+    }
+  }
+
+  // Until the loop below has put the records in the record caches, a
+  // checkpoint of the caches would miss them.
+  PendingCacheWrites& pending_cache_writes = getPendingCacheWrites();
+  const size_t cache_ticket = pending_cache_writes.begin();
   int rv = writeMulti(write_ops);
   Status status = rv == 0 ? E::OK : err;
+  const auto write_end_time = std::chrono::steady_clock::now();
 
   auto write_ops_iter = write_ops.begin();
   for (auto& write : writes) {
@@ -140,6 +169,10 @@ void WriteBatchStorageTask::execute() {
       continue;
     }
     write->status_ = status;
+    write->execution_end_time_ = write_end_time;
+    if (storageThread_) {
+      storageThread_->reportTaskStageTimes(*write);
+    }
     if (status == E::OK) {
       // store success, try to insert the stored record into the record
       // cache. Perform insertion on the storage thread rather than the
@@ -168,7 +201,10 @@ void WriteBatchStorageTask::execute() {
       sendBackToWorker(std::move(write));
     }
   }
+  pending_cache_writes.end(cache_ticket);
+
   // StorageThread will send back the response for *this
+  return ntasks;
 }
 
 bool WriteBatchStorageTask::throttleIfNeeded() {
@@ -201,8 +237,11 @@ void WriteBatchStorageTask::onStorageThreadDrop() {
   // also drop a write from the write queue, in order to maintain the
   // invariant that there are at least as many WriteBatch tasks in the main
   // queue as there are individual writes in the separate write queue.
-  std::unique_ptr<WriteStorageTask> write = tryGetWrite();
-  if (write) {
+  for (size_t i = 0; i < num_writes_; ++i) {
+    std::unique_ptr<WriteStorageTask> write = tryGetWrite();
+    if (!write) {
+      break;
+    }
     sendDroppedToWorker(std::move(write));
   }
 }
@@ -246,6 +285,10 @@ int WriteBatchStorageTask::writeMulti(
   return store.writeMulti(write_ops);
 }
 
+PendingCacheWrites& WriteBatchStorageTask::getPendingCacheWrites() {
+  return storageThreadPool_->getPendingCacheWrites();
+}
+
 StatsHolder* WriteBatchStorageTask::stats() {
   return storageThreadPool_->stats();
 }
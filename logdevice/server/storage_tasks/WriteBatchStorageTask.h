@@ -7,6 +7,7 @@
  */
 #pragma once
 
+#include "logdevice/server/storage_tasks/PendingCacheWrites.h"
 #include "logdevice/server/storage_tasks/StorageTask.h"
 #include "logdevice/server/storage_tasks/WriteStorageTask.h"
 
@@ -53,6 +54,12 @@ namespace facebook { namespace logdevice {
  * thread takes to perform the batch.  Writes counting double makes sure that
  * the resources (main queue slots and response pipe capacity) are never
  * overused, at the cost of being conservative at times.
+ *
+ * A worker that puts several writes onto the write queue in one event loop
+ * iteration may post a single WriteBatchStorageTask standing for all of them
+ * (see num_writes below and Settings::coalesce_write_batch_tasks). Such a
+ * task keeps pulling batches until it has picked up that many writes or the
+ * write queue is empty, and its response relaxes the limit by num_writes.
  */
 
 class StatsHolder;
@@ -60,9 +67,16 @@ class WriteOp;
 
 class WriteBatchStorageTask : public StorageTask {
  public:
-  explicit WriteBatchStorageTask(ThreadType thread_type)
+  /**
+   * @param num_writes  number of writes on the write queue this task was
+   *                    posted for
+   */
+  explicit WriteBatchStorageTask(ThreadType thread_type, size_t num_writes = 1)
       : StorageTask(StorageTask::Type::WRITE_BATCH),
-        thread_type_(thread_type) {}
+        thread_type_(thread_type),
+        num_writes_(num_writes) {
+    ld_check(num_writes_ > 0);
+  }
   void execute() override;
   void onDone() override;
   void onDropped() override;
@@ -72,8 +86,17 @@ class WriteBatchStorageTask : public StorageTask {
     return thread_type_;
   }
 
+  size_t getNumWrites() const {
+    return num_writes_;
+  }
+
  protected:
   ThreadType thread_type_;
+  const size_t num_writes_;
+
+  // Pulls one batch of writes off the write queue and performs it.
+  // @return number of writes picked up
+  size_t executeBatch();
 
   // these get mocked in unit tests
 
@@ -88,5 +111,6 @@ class WriteBatchStorageTask : public StorageTask {
   virtual int writeMulti(const std::vector<const WriteOp*>& write_ops);
   // Returns true if entire tasks will be rejected.
   virtual bool throttleIfNeeded();
+  virtual PendingCacheWrites& getPendingCacheWrites();
 };
 }} // namespace facebook::logdevice
@@ -0,0 +1,92 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/read_path/AdaptiveBatchSize.h"
+
+#include <gtest/gtest.h>
+
+namespace facebook { namespace logdevice {
+
+namespace {
+const size_t MAX_SIZE = 16 * 1024 * 1024;
+const size_t MB = 1024 * 1024;
+} // namespace
+
+using std::chrono::microseconds;
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+
+TEST(AdaptiveBatchSizeTest, MaxUntilMeasured) {
+  AdaptiveBatchSize batch_size;
+  EXPECT_EQ(MAX_SIZE, batch_size.getSize(MAX_SIZE));
+
+  batch_size.onStorageTaskDone(milliseconds(10));
+  EXPECT_EQ(MAX_SIZE, batch_size.getSize(MAX_SIZE));
+
+  // The first WINDOW update only starts the measurement.
+  auto now = AdaptiveBatchSize::Clock::now();
+  batch_size.onWindowUpdate(MB, now);
+  EXPECT_EQ(MAX_SIZE, batch_size.getSize(MAX_SIZE));
+
+  batch_size.onWindowUpdate(2 * MB, now + seconds(1));
+  EXPECT_DOUBLE_EQ(MB, batch_size.bytesPerSecond());
+  EXPECT_NE(MAX_SIZE, batch_size.getSize(MAX_SIZE));
+}
+
+TEST(AdaptiveBatchSizeTest, FollowsConsumptionRate) {
+  AdaptiveBatchSize batch_size;
+  auto now = AdaptiveBatchSize::Clock::now();
+  uint64_t sent = 0;
+  batch_size.onWindowUpdate(sent, now);
+  batch_size.onStorageTaskDone(milliseconds(100));
+
+  // 10MB/s with 100ms storage tasks: 2 * 1MB per batch.
+  for (int i = 0; i < 50; ++i) {
+    now += milliseconds(100);
+    sent += MB;
+    batch_size.onWindowUpdate(sent, now);
+  }
+  EXPECT_NEAR(2 * MB, batch_size.getSize(MAX_SIZE), 1024);
+
+  // The client slows down to 1MB/s.
+  for (int i = 0; i < 50; ++i) {
+    now += milliseconds(100);
+    sent += MB / 10;
+    batch_size.onWindowUpdate(sent, now);
+  }
+  EXPECT_NEAR(2 * MB / 10, batch_size.getSize(MAX_SIZE), 1024);
+
+  // Slower storage tasks mean larger batches.
+  for (int i = 0; i < 50; ++i) {
+    batch_size.onStorageTaskDone(milliseconds(400));
+  }
+  EXPECT_NEAR(8 * MB / 10, batch_size.getSize(MAX_SIZE), 1024);
+}
+
+TEST(AdaptiveBatchSizeTest, Bounds) {
+  AdaptiveBatchSize batch_size;
+  auto now = AdaptiveBatchSize::Clock::now();
+  batch_size.onWindowUpdate(0, now);
+  batch_size.onStorageTaskDone(microseconds(100));
+
+  // A trickle of records is still read in batches of MIN_SIZE.
+  batch_size.onWindowUpdate(100, now + seconds(1));
+  EXPECT_EQ(AdaptiveBatchSize::MIN_SIZE, batch_size.getSize(MAX_SIZE));
+  EXPECT_EQ(1000, batch_size.getSize(1000));
+
+  // A very fast reader is capped at the max.
+  batch_size.onStorageTaskDone(seconds(10));
+  batch_size.onWindowUpdate(100 + 1000 * MB, now + seconds(2));
+  EXPECT_EQ(MAX_SIZE, batch_size.getSize(MAX_SIZE));
+
+  // WINDOW updates with no time in between are ignored.
+  double rate = batch_size.bytesPerSecond();
+  batch_size.onWindowUpdate(100 + 2000 * MB, now + seconds(2));
+  EXPECT_DOUBLE_EQ(rate, batch_size.bytesPerSecond());
+}
+
+}} // namespace facebook::logdevice
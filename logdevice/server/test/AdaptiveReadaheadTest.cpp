@@ -0,0 +1,65 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/read_path/AdaptiveReadahead.h"
+
+#include <gtest/gtest.h>
+
+namespace facebook { namespace logdevice {
+
+namespace {
+const size_t MAX_SIZE = 2 * 1024 * 1024;
+const size_t MIN_BATCHES = 2;
+} // namespace
+
+TEST(AdaptiveReadaheadTest, RampsUpOnSequentialScan) {
+  AdaptiveReadahead readahead;
+  EXPECT_EQ(0, readahead.getSize(MAX_SIZE, MIN_BATCHES));
+
+  readahead.onBatchComplete(E::BYTE_LIMIT_REACHED);
+  EXPECT_EQ(0, readahead.getSize(MAX_SIZE, MIN_BATCHES));
+
+  readahead.onBatchComplete(E::PARTIAL);
+  EXPECT_EQ(AdaptiveReadahead::INITIAL_SIZE,
+            readahead.getSize(MAX_SIZE, MIN_BATCHES));
+
+  readahead.onBatchComplete(E::BYTE_LIMIT_REACHED);
+  EXPECT_EQ(2 * AdaptiveReadahead::INITIAL_SIZE,
+            readahead.getSize(MAX_SIZE, MIN_BATCHES));
+
+  for (int i = 0; i < 100; ++i) {
+    readahead.onBatchComplete(E::BYTE_LIMIT_REACHED);
+  }
+  EXPECT_EQ(MAX_SIZE, readahead.getSize(MAX_SIZE, MIN_BATCHES));
+
+  // Flow control doesn't change anything.
+  readahead.onBatchComplete(E::WINDOW_END_REACHED);
+  EXPECT_EQ(MAX_SIZE, readahead.getSize(MAX_SIZE, MIN_BATCHES));
+
+  // Catching up with the tail goes back to small reads.
+  readahead.onBatchComplete(E::CAUGHT_UP);
+  EXPECT_EQ(0, readahead.sequentialBatches());
+  EXPECT_EQ(0, readahead.getSize(MAX_SIZE, MIN_BATCHES));
+}
+
+TEST(AdaptiveReadaheadTest, Limits) {
+  AdaptiveReadahead readahead;
+  for (int i = 0; i < 5; ++i) {
+    readahead.onBatchComplete(E::BYTE_LIMIT_REACHED);
+  }
+  // Disabled.
+  EXPECT_EQ(0, readahead.getSize(0, MIN_BATCHES));
+  // Max smaller than the initial size.
+  EXPECT_EQ(4096, readahead.getSize(4096, MIN_BATCHES));
+  // Not enough sequential batches yet.
+  EXPECT_EQ(0, readahead.getSize(MAX_SIZE, 6));
+
+  readahead.onBatchComplete(E::UNTIL_LSN_REACHED);
+  EXPECT_EQ(0, readahead.getSize(MAX_SIZE, 1));
+}
+
+}} // namespace facebook::logdevice
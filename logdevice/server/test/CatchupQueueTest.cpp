@@ -20,6 +20,7 @@
 #include "logdevice/common/Sender.h"
 #include "logdevice/common/protocol/Compatibility.h"
 #include "logdevice/common/protocol/GAP_Message.h"
+#include "logdevice/common/protocol/MULTI_RECORD_Message.h"
 #include "logdevice/common/protocol/Message.h"
 #include "logdevice/common/protocol/RECORD_Message.h"
 #include "logdevice/common/protocol/STARTED_Message.h"
@@ -77,6 +78,20 @@ class TestAllServerReadStreams : public AllServerReadStreams {
     tasks_->push_back(std::move(task));
   }
 
+  // Unpacks batches into tasks_ so that tests can complete their tasks one
+  // by one, like MultiLogReadStorageTask::onDone() does.
+  void sendStorageTaskBatch(std::vector<std::unique_ptr<ReadStorageTask>> tasks,
+                            shard_index_t shard) override {
+    ASSERT_EQ(SHARD_IDX, shard);
+    batch_sizes_.push_back(tasks.size());
+    for (auto& task : tasks) {
+      tasks_->push_back(std::move(task));
+    }
+  }
+
+  // Sizes of batches that went through sendStorageTaskBatch().
+  std::vector<size_t> batch_sizes_;
+
   void scheduleSendDelayedStorageTasks() override {
     sendDelayedStorageTasksPending_ = true;
   }
@@ -130,6 +145,18 @@ class CatchupQueueTest : public ::testing::Test {
 
   void resetCatchupQueue();
 
+  void setMultiLogReadBatchSize(size_t batch_size) {
+    Settings settings = *settings_.get();
+    settings.multi_log_read_batch_size = batch_size;
+    settings_ = UpdateableSettings<Settings>(settings);
+  }
+
+  void setReadRecordBatchSize(size_t batch_size) {
+    Settings settings = *settings_.get();
+    settings.read_record_batch_size = batch_size;
+    settings_ = UpdateableSettings<Settings>(settings);
+  }
+
   void setTryNonBlockingRead(bool value = true) {
     getClientStateMap()
         .find(client_id_)
@@ -155,7 +182,7 @@ class CatchupQueueTest : public ::testing::Test {
   size_t getCatchupQueueSize(ClientID client_id) {
     auto it = streams_.client_states_.find(client_id);
     ld_check(it != streams_.client_states_.end());
-    return it->second.catchup_queue->queue_.size();
+    return it->second.catchup_queue->queueSize();
   }
 
   BackoffTimer* getPingTimer(ClientID client_id) {
@@ -295,6 +322,8 @@ class CatchupQueueTest : public ::testing::Test {
                         folly::StringPiece record_key1,
                         folly::StringPiece record_key2);
 
+  // Returned by MockCatchupQueueDependencies::getSettings().
+  UpdateableSettings<Settings> settings_;
   LogStorageStateMap log_storage_state_map_;
   InterceptedTasks tasks_;
   TestAllServerReadStreams streams_;
@@ -451,7 +480,7 @@ class MockCatchupQueueDependencies : public CatchupQueueDependencies {
   }
 
   const Settings& getSettings() const override {
-    return *settings_.get();
+    return *test_.settings_.get();
   }
 
  private:
@@ -461,7 +490,6 @@ class MockCatchupQueueDependencies : public CatchupQueueDependencies {
     test_.flow_group_->push(callback, priority);
   }
 
-  UpdateableSettings<Settings> settings_; // never updated
   CatchupQueueTest& test_;
   StatsHolder server_stats_;
 };
@@ -1466,6 +1494,160 @@ TEST_F(CatchupQueueTest, MaxRecordsReadLimitReached) {
   ASSERT_EQ(1, task->read_ctx_.read_ptr_.lsn);
 }
 
+// With multi-log-read-batch-size > 1, streams waiting behind a storage task
+// get their own tasks issued together, in a single batch, once it comes back.
+TEST_F(CatchupQueueTest, MultiLogReadBatch) {
+  setMultiLogReadBatchSize(4);
+
+  for (int i = 1; i <= 4; ++i) {
+    ServerReadStream& stream = createStream(read_stream_id_t(i));
+    stream.until_lsn_ = 200;
+    stream.setWindowHigh(200);
+    notifyNeedsCatchup(stream, read_stream_id_t(i));
+  }
+
+  // Stream 1 was alone when it was notified, so its task isn't batched.
+  // The other streams wait for it to come back.
+  ASSERT_EQ(1, tasks_.size());
+  ASSERT_TRUE(streams_.batch_sizes_.empty());
+  std::unique_ptr<ReadStorageTask> task = std::move(tasks_.front());
+  tasks_.clear();
+  EXPECT_EQ(read_stream_id_t(1), task->stream_.get()->id_);
+
+  task->status_ = E::CAUGHT_UP;
+  task->read_ctx_.read_ptr_ = {lsn_t{101}}; // last_released_lsn + 1
+  streams_.onReadTaskDone(*task);
+
+  // Stream 1 is caught up. Streams 2-4 should have been batched together,
+  // each with its share of the byte budget.
+  ASSERT_EQ(std::vector<size_t>({3}), streams_.batch_sizes_);
+  ASSERT_EQ(3, tasks_.size());
+  InterceptedTasks batch = std::move(tasks_);
+  tasks_.clear();
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(read_stream_id_t(i + 2), batch[i]->stream_.get()->id_);
+    EXPECT_EQ(1, batch[i]->read_ctx_.read_ptr_.lsn);
+    EXPECT_LE(batch[i]->read_ctx_.max_bytes_to_deliver_, 128 * 1024 / 4);
+  }
+
+  // Completing the tasks one at a time doesn't start new ones while the rest
+  // of the batch is in flight.
+  for (auto& t : batch) {
+    t->status_ = E::CAUGHT_UP;
+    t->read_ctx_.read_ptr_ = {lsn_t{101}};
+    streams_.onReadTaskDone(*t);
+    EXPECT_EQ(0, tasks_.size());
+  }
+  EXPECT_EQ(0, getCatchupQueueSize(client_id_));
+  EXPECT_EQ(1, streams_.batch_sizes_.size());
+}
+
+// Small records read back to back are sent in MULTI_RECORD messages of at
+// most read_record_batch_size records. Large records are sent on their own.
+TEST_F(CatchupQueueTest, ReadRecordBatch) {
+  setReadRecordBatchSize(3);
+
+  read_stream_id_t read_stream_id(1);
+  ServerReadStream& stream = createStream(read_stream_id);
+  stream.setReadPtr(1);
+  notifyNeedsCatchup(stream, read_stream_id);
+
+  ASSERT_EQ(1, tasks_.size());
+  std::unique_ptr<ReadStorageTask> task = std::move(tasks_.front());
+  tasks_.clear();
+  ReadStorageTask::RecordContainer records;
+  records.push_back(createFakeRecord(1, 100));
+  records.push_back(createFakeRecord(2, 100));
+  records.push_back(createFakeRecord(3, 100));
+  records.push_back(createFakeRecord(4, 100));
+  records.push_back(createFakeRecord(5, 2000));
+  records.push_back(createFakeRecord(6, 100));
+  task->status_ = E::CAUGHT_UP;
+  task->records_ = std::move(records);
+  task->read_ctx_.read_ptr_ = {lsn_t{7}};
+  streams_.onReadTaskDone(*task);
+
+  // STARTED, MULTI_RECORD(1-3), RECORD(4), RECORD(5), RECORD(6).
+  ASSERT_EQ(5, messages_.size());
+  auto* m1 = dynamic_cast<MULTI_RECORD_Message*>(messages_[1].first.get());
+  ASSERT_NE(nullptr, m1);
+  ASSERT_EQ(3, m1->getRecords().size());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(i + 1, getHeader(*m1->getRecords()[i]).lsn);
+  }
+  for (int i = 2; i < 5; ++i) {
+    auto* r = dynamic_cast<RECORD_Message*>(messages_[i].first.get());
+    ASSERT_NE(nullptr, r);
+    EXPECT_EQ(i + 2, getHeader(*r).lsn);
+  }
+  EXPECT_EQ(6, stream.last_delivered_lsn_);
+  EXPECT_EQ(7, stream.getReadPtr().lsn);
+}
+
+// If a MULTI_RECORD message can't be sent, the stream is rolled back to the
+// first record of the batch.
+TEST_F(CatchupQueueTest, ReadRecordBatchSendFailed) {
+  setReadRecordBatchSize(3);
+
+  read_stream_id_t read_stream_id(1);
+  ServerReadStream& stream = createStream(read_stream_id);
+  stream.setReadPtr(1);
+  notifyNeedsCatchup(stream, read_stream_id);
+
+  ASSERT_EQ(1, tasks_.size());
+  std::unique_ptr<ReadStorageTask> task = std::move(tasks_.front());
+  tasks_.clear();
+  ReadStorageTask::RecordContainer records;
+  for (lsn_t lsn = 1; lsn <= 5; ++lsn) {
+    records.push_back(createFakeRecord(lsn, 100));
+  }
+  task->status_ = E::CAUGHT_UP;
+  task->records_ = std::move(records);
+  task->read_ctx_.read_ptr_ = {lsn_t{6}};
+
+  // STARTED and the first MULTI_RECORD get through, the second one doesn't.
+  n_messages_before_fail_ = 2;
+  streams_.onReadTaskDone(*task);
+
+  ASSERT_EQ(2, messages_.size());
+  auto* m1 = dynamic_cast<MULTI_RECORD_Message*>(messages_[1].first.get());
+  ASSERT_NE(nullptr, m1);
+  ASSERT_EQ(3, m1->getRecords().size());
+  EXPECT_EQ(3, stream.last_delivered_lsn_);
+  EXPECT_EQ(4, stream.getReadPtr().lsn);
+}
+
+// Streams of higher monitoring tiers are served first when none of the tiers
+// has been sent anything yet.
+TEST_F(CatchupQueueTest, MonitoringTiers) {
+  setMultiLogReadBatchSize(4);
+
+  const MonitoringTier tiers[] = {MonitoringTier::LOW_PRI,
+                                  MonitoringTier::HIGH_PRI,
+                                  MonitoringTier::LOW_PRI,
+                                  MonitoringTier::MEDIUM_PRI};
+  for (int i = 1; i <= 4; ++i) {
+    ServerReadStream& stream = createStream(read_stream_id_t(i));
+    stream.until_lsn_ = 200;
+    stream.setWindowHigh(200);
+    stream.monitoring_tier_ = tiers[i - 1];
+    notifyNeedsCatchup(stream, read_stream_id_t(i));
+  }
+
+  ASSERT_EQ(1, tasks_.size());
+  std::unique_ptr<ReadStorageTask> task = std::move(tasks_.front());
+  tasks_.clear();
+  EXPECT_EQ(read_stream_id_t(1), task->stream_.get()->id_);
+  task->status_ = E::CAUGHT_UP;
+  task->read_ctx_.read_ptr_ = {lsn_t{101}};
+  streams_.onReadTaskDone(*task);
+
+  ASSERT_EQ(3, tasks_.size());
+  EXPECT_EQ(read_stream_id_t(2), tasks_[0]->stream_.get()->id_);
+  EXPECT_EQ(read_stream_id_t(4), tasks_[1]->stream_.get()->id_);
+  EXPECT_EQ(read_stream_id_t(3), tasks_[2]->stream_.get()->id_);
+}
+
 // Verify that a stream is not marked caught up if a task came back with
 // E::CAUGHT_UP because read_ptr was advanced past the value of
 // last_released_lsn at the time the task was issued but this value since then
@@ -1774,6 +1956,8 @@ void CatchupQueueTest::filterTestHelper(ServerRecordFilterType filter_type,
       ASSERT_NE((size_t)0, record_msg->payload_.size());
     }
   }
+  EXPECT_EQ(50, stream.filter_records_passed_);
+  EXPECT_EQ(50, stream.filter_records_rejected_);
   tasks_.clear();
   messages_.clear();
   ASSERT_EQ(0, tasks_.size());
@@ -1840,6 +2024,30 @@ TEST_F(CatchupQueueTest, ServerRecordFilterFeatureTest) {
   // filter_key1 > filter_key2, an error message should be printed
   // ServerRecordFilterFactory should return a nullptr
   filterTestHelper(ServerRecordFilterType::RANGE, "b", "a", "", ")");
+
+  // Test case 10: EXPRESSION filter
+  // Expect: filter out records with key "c"
+  //         records with "b" will pass
+  filterTestHelper(ServerRecordFilterType::EXPRESSION,
+                   "key in (\"a\", \"b\") && !(key == \"c\")",
+                   "not used",
+                   "b",
+                   "c");
+
+  // Test case 11: EXPRESSION filter on record attributes
+  // Expect: records are 100 bytes, so all of them are filtered out except
+  //         those with key "us-east"
+  filterTestHelper(ServerRecordFilterType::EXPRESSION,
+                   "key ^= \"us-\" || size < 10",
+                   "not used",
+                   "us-east",
+                   "eu-west");
+
+  // Test case 12: EXPRESSION filter that doesn't compile
+  // ServerRecordFilterFactory should return a nullptr
+  EXPECT_EQ(nullptr,
+            ServerRecordFilterFactory::create(
+                ServerRecordFilterType::EXPRESSION, "key ==", "not used"));
 }
 
 TEST_F(CatchupQueueTest, MergeFilteredOutGapOnServerSide1) {
@@ -0,0 +1,107 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/CpuProfiler.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <folly/Benchmark.h>
+#include <folly/ScopeGuard.h>
+#include <gtest/gtest.h>
+
+#include "logdevice/common/ThreadID.h"
+#include "logdevice/common/test/TestUtil.h"
+#include "logdevice/include/Err.h"
+
+using namespace facebook::logdevice;
+
+namespace {
+void burnCpu(std::chrono::milliseconds duration) {
+  auto deadline = std::chrono::steady_clock::now() + duration;
+  uint64_t x = 0;
+  while (std::chrono::steady_clock::now() < deadline) {
+    for (int i = 0; i < 1000; ++i) {
+      x = x * 31 + i;
+    }
+    folly::doNotOptimizeAway(x);
+  }
+}
+} // namespace
+
+TEST(CpuProfilerTest, SamplesTaggedThreads) {
+  CpuProfiler::Options options;
+  options.frequency_hz = 1000;
+  options.thread_types = {ThreadID::STORAGE};
+  EXPECT_EQ(-1, CpuProfiler::stop());
+  EXPECT_EQ(E::NOTFOUND, err);
+
+  // The threads exist before profiling starts, so that they are sampled from
+  // the start rather than from the next scan of threads.
+  std::atomic<bool> go{false};
+  auto wait_for_go = [&] {
+    while (!go.load()) {
+      /* sleep override */
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  };
+  std::thread storage([&] {
+    ThreadID::set(ThreadID::STORAGE, "test-storage1");
+    wait_for_go();
+    CpuProfiler::setThreadTag("TestTask");
+    burnCpu(std::chrono::milliseconds(500));
+    CpuProfiler::setThreadTag(nullptr);
+  });
+  // Not sampled.
+  std::thread worker([&] {
+    ThreadID::set(ThreadID::SERVER_WORKER, "test-worker1");
+    wait_for_go();
+    burnCpu(std::chrono::milliseconds(500));
+  });
+  SCOPE_EXIT {
+    go.store(true);
+    for (std::thread* t : {&storage, &worker}) {
+      if (t->joinable()) {
+        t->join();
+      }
+    }
+  };
+
+  if (CpuProfiler::start(options) != 0) {
+    // perf_event_open() isn't allowed in this environment.
+    return;
+  }
+  EXPECT_TRUE(CpuProfiler::isRunning());
+  EXPECT_EQ(-1, CpuProfiler::start(options));
+  EXPECT_EQ(E::INPROGRESS, err);
+  wait_until("threads are attached",
+             [] { return CpuProfiler::getCounts().threads > 0; });
+
+  go.store(true);
+  storage.join();
+  worker.join();
+  wait_until("samples are collected",
+             [] { return CpuProfiler::getCounts().samples > 0; });
+  EXPECT_EQ(0, CpuProfiler::stop());
+  EXPECT_FALSE(CpuProfiler::isRunning());
+
+  auto stacks = CpuProfiler::getFoldedStacks();
+  ASSERT_FALSE(stacks.empty());
+  uint64_t total = 0;
+  for (const auto& kv : stacks) {
+    EXPECT_EQ(0, kv.first.find("storage;test-storage;TestTask;")) << kv.first;
+    total += kv.second;
+  }
+  EXPECT_EQ(CpuProfiler::getCounts().samples, total);
+
+  // Results stay after stopping, until the next start.
+  EXPECT_EQ(stacks, CpuProfiler::getFoldedStacks());
+  ASSERT_EQ(0, CpuProfiler::start(options));
+  EXPECT_TRUE(CpuProfiler::getFoldedStacks().empty());
+  EXPECT_EQ(0, CpuProfiler::stop());
+}
@@ -336,7 +336,7 @@ TEST(GOSSIP_MessageTest, SerializeAndDeserializeWithVersions) {
   }
 
   for (uint16_t p = Compatibility::INCLUDE_VERSIONS_IN_GOSSIP;
-       p <= Compatibility::MAX_PROTOCOL_SUPPORTED;
+       p < Compatibility::GOSSIP_DELTA_NODE_LIST;
        p++) {
     Params params{p};
     params.with_versions = true;
@@ -359,4 +359,73 @@ TEST(GOSSIP_MessageTest, SerializeAndDeserializeWithVersions) {
         "00000000000000";
     serializeAndDeserializeTest(params);
   }
+
+  for (uint16_t p = Compatibility::GOSSIP_DELTA_NODE_LIST;
+       p <= Compatibility::MAX_PROTOCOL_SUPPORTED;
+       p++) {
+    Params params{p};
+    params.with_versions = true;
+    params.expected =
+        "0200000001002001000000000000000100000000000000000000000000000000000000"
+        "01080101021203FBFFFFFFFFFFFF3FFDFFFFFFFFFFFF3FFFFFFFFFFFFFFF3F02000000"
+        "0000000000000100000000000000020000000000000003000000000000006500000000"
+        "0000006600000000000000670000000000000001000000000000000400000000000000"
+        "05000000000000000600000000000000680000000000000069000000000000006A0000"
+        "0000000000";
+    serializeAndDeserializeTest(params);
+
+    params.with_versions = false;
+    params.expected =
+        "0200000001000001000000000000000100000000000000000000000000000000000000"
+        "010801000212";
+    serializeAndDeserializeTest(params);
+  }
+}
+
+TEST(GOSSIP_MessageTest, SerializeAndDeserializeCompactNodeList) {
+  Params params{Compatibility::ProtocolVersion::GOSSIP_DELTA_NODE_LIST};
+  params.with_health_status = true;
+  params.expected =
+      "0200000001000001000000000000000100000000000000000000000000000000000010"
+      "010801300212";
+  serializeAndDeserializeTest(params);
+
+  params.with_failover = true;
+  params.expected =
+      "0200000001000101000000000000000100000000000000000000000000000000000012"
+      "010807013202120F";
+  serializeAndDeserializeTest(params);
+}
+
+TEST(GOSSIP_MessageTest, DeltaNodeList) {
+  node_list_t node_list{{0, 1, 5ms, 0ms, 0}, {1, 2, 10ms, 0ms, 0}};
+  GOSSIP_Message msg(NodeID{1}, node_list, 1ms, 1ms, {}, {}, 0, 0, {}, {});
+  msg.changed_ = {false, true};
+
+  auto serialize_and_deserialize = [&](uint16_t proto) {
+    auto buffer = folly::IOBuf::create(IOBUF_ALLOCATION_UNIT);
+    ProtocolWriter writer(msg.type_, buffer.get(), proto);
+    msg.serialize(writer);
+    EXPECT_GT(writer.result(), 0);
+    ProtocolReader reader(msg.type_, std::move(buffer), proto);
+    std::unique_ptr<Message> deserialized =
+        GOSSIP_Message::deserialize(reader).msg;
+    EXPECT_NE(nullptr, deserialized);
+    return std::unique_ptr<GOSSIP_Message>(
+        static_cast<GOSSIP_Message*>(deserialized.release()));
+  };
+
+  // Only the changed entry is sent.
+  auto delta = serialize_and_deserialize(
+      Compatibility::ProtocolVersion::GOSSIP_DELTA_NODE_LIST);
+  ASSERT_NE(nullptr, delta);
+  EXPECT_TRUE(delta->is_delta_);
+  checkNodeList({node_list[1]}, delta->node_list_);
+
+  // Older peers get the whole list.
+  auto full = serialize_and_deserialize(
+      Compatibility::ProtocolVersion::INCLUDE_VERSIONS_IN_GOSSIP);
+  ASSERT_NE(nullptr, full);
+  EXPECT_FALSE(full->is_delta_);
+  checkNodeList(node_list, full->node_list_);
 }
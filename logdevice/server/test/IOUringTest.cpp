@@ -0,0 +1,69 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/locallogstore/IOUring.h"
+
+#include <fcntl.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include <folly/FileUtil.h>
+#include <gtest/gtest.h>
+
+#include "logdevice/common/test/TestUtil.h"
+
+using namespace facebook::logdevice;
+
+TEST(IOUringTest, ReadAll) {
+  IOUring* ring = IOUring::forThisThread(4);
+  if (ring == nullptr) {
+    // Kernel without io_uring support, or io_uring disabled in this
+    // environment.
+    return;
+  }
+  EXPECT_EQ(ring, IOUring::forThisThread(4));
+
+  TemporaryDirectory dir("IOUringTest");
+  std::string path = (dir.path() / "data").string();
+  std::string data;
+  for (int i = 0; i < 100000; ++i) {
+    data.push_back('a' + i % 26);
+  }
+  ASSERT_TRUE(folly::writeFile(data, path.c_str()));
+  int fd = ::open(path.c_str(), O_RDONLY);
+  ASSERT_NE(-1, fd);
+
+  // More reads than the queue depth, the last one crossing end of file.
+  const size_t nreads = 10;
+  const size_t len = 5000;
+  std::vector<std::string> bufs(nreads, std::string(len, '\0'));
+  std::vector<IOUring::Read> reads;
+  for (size_t i = 0; i < nreads; ++i) {
+    reads.push_back({fd, i * 9999, len, &bufs[i][0], 0});
+  }
+  reads.back().offset = data.size() - len / 2;
+  // And one that fails.
+  std::string bad_buf(len, '\0');
+  reads.push_back({-1, 0, len, &bad_buf[0], 0});
+
+  ring->readAll(reads.data(), reads.size());
+
+  for (size_t i = 0; i < nreads; ++i) {
+    size_t expected_len = std::min(len, data.size() - reads[i].offset);
+    ASSERT_EQ(expected_len, static_cast<size_t>(reads[i].result));
+    EXPECT_EQ(data.substr(reads[i].offset, expected_len),
+              bufs[i].substr(0, expected_len));
+  }
+  EXPECT_EQ(-EBADF, reads.back().result);
+
+  ::close(fd);
+}
+
+TEST(IOUringTest, Disabled) {
+  EXPECT_EQ(nullptr, IOUring::forThisThread(0));
+}
@@ -1643,3 +1643,29 @@ TEST_P(LocalLogStoreReaderTest, ReadLimitAtEndOfWindow) {
   EXPECT_EQ(E::WINDOW_END_REACHED, st);
   ASSERT_SHIPPED(records, 1, 2);
 }
+
+TEST(RawRecordTest, SharePayload) {
+  const std::string blob = "headerpayload";
+  const Payload payload(blob.data() + 6, 7);
+
+  // An unowned record must have its payload copied.
+  RawRecord unowned(1, Slice(blob.data(), blob.size()), false);
+  EXPECT_FALSE(unowned.shareable());
+  PayloadHolder copied = unowned.sharePayload(payload);
+  EXPECT_EQ("payload", copied.toString());
+  EXPECT_NE(payload.data(), copied.getPayload().data());
+
+  // A record backed by a refcounted buffer shares it, and the holder keeps
+  // the buffer alive after the record is gone.
+  PayloadHolder holder;
+  const void* data;
+  {
+    RawRecord shared(
+        1, folly::IOBuf(folly::IOBuf::COPY_BUFFER, blob.data(), blob.size()));
+    ASSERT_TRUE(shared.shareable());
+    data = static_cast<const char*>(shared.blob.data) + 6;
+    holder = shared.sharePayload(Payload(data, 7));
+    EXPECT_EQ(data, holder.getPayload().data());
+  }
+  EXPECT_EQ("payload", holder.toString());
+}
@@ -146,3 +146,100 @@ TEST(LogStorageStateMapTest, LastReleasedLSNSource) {
   EXPECT_EQ(
       LogStorageState::LastReleasedSource::RELEASE, released_state.source());
 }
+
+TEST(LogStorageStateMapTest, CachedHeadTimestamp) {
+  LogStorageStateMap map(1, /*stats*/ nullptr, /*record_cache*/ false);
+  LogStorageState log_state(logid_t(42), THIS_SHARD, &map);
+  using std::chrono::milliseconds;
+
+  EXPECT_FALSE(log_state.getCachedHeadTimestamp(LSN_INVALID).has_value());
+
+  log_state.cacheHeadTimestamp(10, milliseconds(1000));
+  EXPECT_EQ(milliseconds(1000), log_state.getCachedHeadTimestamp(10));
+  // Only valid for the trim point it was computed for.
+  EXPECT_FALSE(log_state.getCachedHeadTimestamp(20).has_value());
+
+  log_state.cacheHeadTimestamp(20, milliseconds(2000));
+  EXPECT_EQ(milliseconds(2000), log_state.getCachedHeadTimestamp(20));
+
+  // A result for an older trim point arriving late doesn't overwrite it.
+  log_state.cacheHeadTimestamp(10, milliseconds(1000));
+  EXPECT_EQ(milliseconds(2000), log_state.getCachedHeadTimestamp(20));
+}
+
+/**
+ * Inserts enough logs for the per-shard map to grow several times and checks
+ * that all of them can still be found.
+ */
+TEST(LogStorageStateMapTest, ManyLogs) {
+  const int nlogs = 10000;
+  LogStorageStateMap map(2, /*stats*/ nullptr, /*record_cache*/ false);
+
+  std::vector<LogStorageState*> states;
+  for (int log_id = 1; log_id <= nlogs; ++log_id) {
+    LogStorageState* state = map.insertOrGet(logid_t(log_id), THIS_SHARD);
+    ASSERT_NE(nullptr, state);
+    states.push_back(state);
+  }
+
+  for (int log_id = 1; log_id <= nlogs; ++log_id) {
+    EXPECT_EQ(states[log_id - 1], map.find(logid_t(log_id), THIS_SHARD));
+    EXPECT_EQ(states[log_id - 1], map.insertOrGet(logid_t(log_id), THIS_SHARD));
+    EXPECT_EQ(nullptr, map.find(logid_t(log_id), 1));
+  }
+  EXPECT_EQ(nullptr, map.find(logid_t(nlogs + 1), THIS_SHARD));
+
+  int count = 0;
+  map.forEachLog([&](logid_t log_id, const LogStorageState& state) {
+    EXPECT_EQ(states[log_id.val_ - 1], &state);
+    ++count;
+    return 0;
+  });
+  EXPECT_EQ(nlogs, count);
+
+  map.clear();
+  EXPECT_EQ(nullptr, map.find(logid_t(1), THIS_SHARD));
+  ASSERT_NE(nullptr, map.insertOrGet(logid_t(1), THIS_SHARD));
+  EXPECT_NE(nullptr, map.find(logid_t(1), THIS_SHARD));
+}
+
+/**
+ * Many threads inserting the same logs should all get the same instances,
+ * while other threads look them up.
+ */
+TEST(LogStorageStateMapTest, ConcurrentInsertOrGet) {
+  const int nthreads = 16;
+  const int nlogs = 5000;
+  LogStorageStateMap map(1, /*stats*/ nullptr, /*record_cache*/ false);
+
+  // Results of insertOrGet() by even threads and of find() by odd ones.
+  std::vector<std::vector<LogStorageState*>> results(nthreads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < nthreads; ++i) {
+    threads.emplace_back([&, i] {
+      for (int log_id = 1; log_id <= nlogs; ++log_id) {
+        results[i].push_back(
+            i % 2 == 0 ? map.insertOrGet(logid_t(log_id), THIS_SHARD)
+                       : map.find(logid_t(log_id), THIS_SHARD));
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < nthreads; ++i) {
+    ASSERT_EQ(nlogs, results[i].size());
+    for (int j = 0; j < nlogs; ++j) {
+      if (i % 2 == 0) {
+        EXPECT_EQ(results[0][j], results[i][j]);
+      } else if (results[i][j] != nullptr) {
+        // Readers see either nothing or the final instance.
+        EXPECT_EQ(results[0][j], results[i][j]);
+      }
+    }
+  }
+  for (int log_id = 1; log_id <= nlogs; ++log_id) {
+    EXPECT_EQ(results[0][log_id - 1], map.find(logid_t(log_id), THIS_SHARD));
+  }
+}
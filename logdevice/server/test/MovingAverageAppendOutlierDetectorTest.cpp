@@ -25,11 +25,13 @@ class MockOutlierDetector : public MovingAverageAppendOutlierDetector {
   MockOutlierDetector() {
     ON_CALL(*this, getGracePeriod()).WillByDefault(Return(0s));
     ON_CALL(*this, getSensitivity()).WillByDefault(Return(0));
+    ON_CALL(*this, getSevereFailureRatio()).WillByDefault(Return(1.0));
     ON_CALL(*this, getStatsRetentionDuration()).WillByDefault(Return(5min));
   }
 
   MOCK_CONST_METHOD0(getGracePeriod, std::chrono::milliseconds());
   MOCK_CONST_METHOD0(getSensitivity, float());
+  MOCK_CONST_METHOD0(getSevereFailureRatio, double());
   MOCK_CONST_METHOD0(getStatsRetentionDuration, std::chrono::milliseconds());
 
   std::chrono::milliseconds getStatsCollectionPeriod() const override {
@@ -123,6 +125,17 @@ TEST_F(MovingAverageAppendOutlierDetectorTest, WithGracePeriod) {
   EXPECT_THAT(detector.detectOutliers(now + 2 * COLLECTION_PERIOD), IsEmpty());
 }
 
+TEST_F(MovingAverageAppendOutlierDetectorTest, SevereOutlierSkipsGracePeriod) {
+  EXPECT_CALL(detector, getGracePeriod())
+      .WillRepeatedly(Return(2 * COLLECTION_PERIOD));
+  EXPECT_CALL(detector, getSevereFailureRatio()).WillRepeatedly(Return(0.5));
+
+  // node 1 is a mild outlier and still has to wait out the grace period,
+  // node 0 fails most of its appends and is reported right away
+  addManyStats({{10, 90}, {100, 1}}, now);
+  EXPECT_THAT(detector.detectOutliers(now), ElementsAre(0));
+}
+
 TEST_F(MovingAverageAppendOutlierDetectorTest, NoSensitivity) {
   EXPECT_CALL(detector, getSensitivity()).WillRepeatedly(Return(0.0));
 
@@ -155,7 +155,7 @@ TEST_F(PurgeSingleEpochTest, Basic) {
   status_ = E::OK;
   setUp();
   purge_->start();
-  CHECK_STORAGE_TASK(PurgeDeleteRecordsStorageTask);
+  CHECK_STORAGE_TASK(PurgeDeleteKeysStorageTask);
   purge_->onPurgeRecordsTaskDone(E::OK);
   CHECK_STORAGE_TASK(PurgeWriteEpochRecoveryMetadataStorageTask);
   purge_->onWriteEpochRecoveryMetadataDone(E::OK);
@@ -179,7 +179,7 @@ TEST_F(PurgeSingleEpochTest, ERMKnown) {
   status_ = E::OK;
   setUp();
   purge_->start();
-  CHECK_STORAGE_TASK(PurgeDeleteRecordsStorageTask);
+  CHECK_STORAGE_TASK(PurgeDeleteKeysStorageTask);
   purge_->onPurgeRecordsTaskDone(E::OK);
   CHECK_STORAGE_TASK(PurgeWriteEpochRecoveryMetadataStorageTask);
   purge_->onWriteEpochRecoveryMetadataDone(E::OK);
@@ -298,3 +298,46 @@ TEST_F(PurgeSingleEpochTest, DeleteRecordsByReadingData) {
   ASSERT_EQ(0, stats.get().purging_v2_delete_by_keys);
   ASSERT_EQ(1, stats.get().purging_v2_delete_by_reading_data);
 }
+
+TEST_F(PurgeSingleEpochTest, DeleteKeysTask) {
+  TemporaryRocksDBStore store;
+
+  std::vector<TestRecord> test_data = {
+      TestRecord(LOG_ID, lsn(1, 2), esn_t(1)),
+      TestRecord(LOG_ID, lsn(2, 1), esn_t(0)),
+      TestRecord(LOG_ID, lsn(2, 2), esn_t(1)),
+      TestRecord(LOG_ID, lsn(2, 10), esn_t(1)),
+      TestRecord(LOG_ID, lsn(2, 3033), esn_t(225)),
+      TestRecord(LOG_ID, lsn(3, 1), esn_t(0)),
+  };
+  store_fill(store, test_data);
+
+  PurgeDeleteKeysStorageTask task(LOG_ID,
+                                  epoch_t(2),
+                                  esn_t(2),
+                                  esn_t(3900),
+                                  WeakRef<PurgeSingleEpoch>());
+  ASSERT_EQ(3899, task.getNumWriteOps());
+  // This is what WriteBatchStorageTask does with it, together with the ops of
+  // other write tasks.
+  std::vector<const WriteOp*> ops(task.getNumWriteOps());
+  ASSERT_EQ(ops.size(), task.getWriteOps(ops.data(), ops.size()));
+  ASSERT_EQ(0, store.writeMulti(ops));
+
+  const std::vector<lsn_t> expected_lsns = {
+      lsn(1, 2),
+      lsn(2, 1),
+      lsn(3, 1),
+  };
+  ASSERT_EQ(expected_lsns, getLsnsForLog(LOG_ID, store));
+}
+
+TEST_F(PurgeSingleEpochTest, LargeRangeReadsData) {
+  epoch_ = epoch_t(8);
+  local_lng_ = esn_t(0);
+  local_last_record_ = esn_t(100000);
+  status_ = E::EMPTY;
+  setUp();
+  purge_->start();
+  CHECK_STORAGE_TASK(PurgeDeleteRecordsStorageTask);
+}
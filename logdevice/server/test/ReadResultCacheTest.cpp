@@ -0,0 +1,130 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/read_path/ReadResultCache.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+
+namespace {
+
+const logid_t LOG_ID(1);
+
+RawRecord makeRecord(lsn_t lsn, size_t size) {
+  void* data = malloc(size);
+  memset(data, 'a' + lsn % 26, size);
+  return RawRecord(lsn, Slice(data, size), /* owned */ true);
+}
+
+std::vector<RawRecord> makeRecords(lsn_t first, lsn_t last, size_t size) {
+  std::vector<RawRecord> records;
+  for (lsn_t lsn = first; lsn <= last; ++lsn) {
+    records.push_back(makeRecord(lsn, size));
+  }
+  return records;
+}
+
+ReadResultCache::Key key(lsn_t start_lsn, std::string filter = "") {
+  return ReadResultCache::Key{LOG_ID, 0, start_lsn, std::move(filter)};
+}
+
+LocalLogStoreReader::ReadContext readContext(lsn_t read_ptr,
+                                             lsn_t window_high = LSN_MAX,
+                                             size_t max_bytes = 1000000) {
+  return LocalLogStoreReader::ReadContext(LOG_ID,
+                                          {read_ptr},
+                                          LSN_MAX,
+                                          window_high,
+                                          std::chrono::milliseconds::max(),
+                                          LSN_MAX - 1,
+                                          max_bytes,
+                                          false,
+                                          nullptr,
+                                          CatchupEventTrigger::OTHER);
+}
+
+} // namespace
+
+TEST(ReadResultCacheTest, Basic) {
+  ReadResultCache cache(10000, std::chrono::minutes(5), nullptr);
+  ASSERT_TRUE(cache.enabled());
+
+  // Records 10..19 were read starting at 5, the read stopped at 20.
+  {
+    std::vector<RawRecord> records = makeRecords(10, 19, 100);
+    cache.insert(key(5), records, {20}, E::BYTE_LIMIT_REACHED, false);
+    // The cache has its own copy.
+  }
+  EXPECT_EQ(1, cache.size());
+  EXPECT_EQ(1000, cache.bytes());
+
+  auto batch = cache.lookup(key(5), readContext(5), /* trim_point */ 0);
+  ASSERT_NE(nullptr, batch);
+  ASSERT_EQ(10, batch->records.size());
+  EXPECT_EQ(10, batch->records[0].lsn);
+  EXPECT_TRUE(batch->records[0].shareable());
+  EXPECT_EQ('a' + 10, *static_cast<const char*>(batch->records[0].blob.data));
+  EXPECT_EQ(20, batch->read_ptr.lsn);
+  EXPECT_EQ(E::BYTE_LIMIT_REACHED, batch->status);
+
+  // Different start or filter.
+  EXPECT_EQ(nullptr, cache.lookup(key(6), readContext(6), 0));
+  EXPECT_EQ(nullptr, cache.lookup(key(5, "scd"), readContext(5), 0));
+  // Batch goes past what the stream may read, or over its byte limit.
+  EXPECT_EQ(nullptr, cache.lookup(key(5), readContext(5, 18), 0));
+  EXPECT_EQ(nullptr, cache.lookup(key(5), readContext(5, LSN_MAX, 999), 0));
+  EXPECT_EQ(1, cache.size());
+
+  // Trimming the start of the range invalidates the batch.
+  EXPECT_EQ(nullptr, cache.lookup(key(5), readContext(5), 5));
+  EXPECT_EQ(0, cache.size());
+  EXPECT_EQ(0, cache.bytes());
+}
+
+TEST(ReadResultCacheTest, OnlyLimitedReadsAreCached) {
+  ReadResultCache cache(10000, std::chrono::minutes(5), nullptr);
+  std::vector<RawRecord> records = makeRecords(1, 5, 10);
+  cache.insert(key(1), records, {6}, E::CAUGHT_UP, false);
+  cache.insert(key(2), records, {6}, E::WINDOW_END_REACHED, false);
+  EXPECT_EQ(0, cache.size());
+  cache.insert(key(3), records, {6}, E::PARTIAL, false);
+  EXPECT_EQ(1, cache.size());
+
+  ReadResultCache disabled(0, std::chrono::minutes(5), nullptr);
+  EXPECT_FALSE(disabled.enabled());
+  disabled.insert(key(1), records, {6}, E::BYTE_LIMIT_REACHED, false);
+  EXPECT_EQ(0, disabled.size());
+}
+
+TEST(ReadResultCacheTest, Eviction) {
+  ReadResultCache cache(2500, std::chrono::minutes(5), nullptr);
+  for (lsn_t start : {1, 100, 200}) {
+    std::vector<RawRecord> records = makeRecords(start, start + 9, 100);
+    cache.insert(key(start), records, {start + 10}, E::PARTIAL, false);
+  }
+  EXPECT_EQ(2, cache.size());
+  EXPECT_EQ(2000, cache.bytes());
+  // The least recently inserted batch was evicted.
+  EXPECT_EQ(nullptr, cache.lookup(key(1), readContext(1), 0));
+  EXPECT_NE(nullptr, cache.lookup(key(100), readContext(100), 0));
+
+  // Batch 100 was used more recently than 200.
+  std::vector<RawRecord> records = makeRecords(300, 309, 100);
+  cache.insert(key(300), records, {310}, E::PARTIAL, false);
+  EXPECT_NE(nullptr, cache.lookup(key(100), readContext(100), 0));
+  EXPECT_EQ(nullptr, cache.lookup(key(200), readContext(200), 0));
+
+  // Batches bigger than half of the cache are not kept.
+  records = makeRecords(400, 419, 100);
+  cache.insert(key(400), records, {420}, E::PARTIAL, false);
+  EXPECT_EQ(nullptr, cache.lookup(key(400), readContext(400), 0));
+}
@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2018-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/RealTimeRecordBuffer.h"
+
+#include <gtest/gtest.h>
+
+#include "logdevice/common/ZeroCopiedRecord.h"
+
+using namespace facebook::logdevice;
+
+namespace {
+
+// Appends a group of released records of the given size and hands it out the
+// way AllServerReadStreams::distributeNewlyReleasedRecords() does.
+std::shared_ptr<ReleasedRecords> distribute(RealTimeRecordBuffer& buffer,
+                                            logid_t logid,
+                                            size_t bytes) {
+  buffer.appendReleasedRecords(std::make_unique<ReleasedRecords>(
+      logid, lsn_t(1), lsn_t(1), nullptr, bytes));
+  std::shared_ptr<ReleasedRecords> result;
+  buffer.sweep([&](std::unique_ptr<ReleasedRecords> records) {
+    records->buffer_ = &buffer;
+    buffer.addToLRU(*records);
+    result = std::move(records);
+  });
+  return result;
+}
+
+} // namespace
+
+TEST(RealTimeRecordBufferTest, PerLogQuota) {
+  RealTimeRecordBuffer buffer(1000, 2000, nullptr, /*max_bytes_per_log=*/100);
+
+  auto r1 = distribute(buffer, logid_t(1), 60);
+  auto r2 = distribute(buffer, logid_t(2), 60);
+  EXPECT_FALSE(buffer.overLogQuota(logid_t(1)));
+  EXPECT_FALSE(buffer.overLogQuota(logid_t(2)));
+
+  auto r3 = distribute(buffer, logid_t(1), 60);
+  EXPECT_TRUE(buffer.overLogQuota(logid_t(1)));
+  EXPECT_FALSE(buffer.overLogQuota(logid_t(2)));
+
+  // Bytes are released along with the records.
+  r1.reset();
+  EXPECT_FALSE(buffer.overLogQuota(logid_t(1)));
+  r3.reset();
+  EXPECT_EQ(logid_t(2), buffer.toEvict());
+  r2.reset();
+  EXPECT_EQ(LOGID_INVALID, buffer.toEvict());
+
+  buffer.shutdown();
+}
+
+TEST(RealTimeRecordBufferTest, AdmissionControl) {
+  RealTimeRecordBuffer buffer(100,
+                              1000,
+                              nullptr,
+                              /*max_bytes_per_log=*/0,
+                              /*admission_control=*/true);
+
+  // Under the eviction threshold everything is admitted.
+  EXPECT_TRUE(buffer.admit(logid_t(2)));
+  auto r1 = distribute(buffer, logid_t(1), 80);
+  for (int i = 0; i < 3; ++i) {
+    buffer.noteDemand(logid_t(1));
+  }
+  auto r2 = distribute(buffer, logid_t(1), 80);
+  ASSERT_TRUE(buffer.overEvictionThreshold());
+  EXPECT_FALSE(buffer.overLogQuota(logid_t(1)));
+
+  // Log 1 is the eviction candidate. Log 2 has seen less demand than log 1.
+  EXPECT_EQ(logid_t(1), buffer.toEvict());
+  EXPECT_TRUE(buffer.admit(logid_t(1)));
+  EXPECT_FALSE(buffer.admit(logid_t(2)));
+
+  for (int i = 0; i < 3; ++i) {
+    buffer.noteDemand(logid_t(2));
+  }
+  EXPECT_TRUE(buffer.admit(logid_t(2)));
+
+  r1.reset();
+  r2.reset();
+  EXPECT_FALSE(buffer.overEvictionThreshold());
+  buffer.shutdown();
+}
@@ -70,6 +70,9 @@ class RebuildingReadStorageTaskTest : public ::testing::TestWithParam<bool> {
     StatsHolder* getStats() override {
       return &test->stats;
     }
+    size_t getNumQueuedReadTasks() override {
+      return 0;
+    }
   };
 
   RebuildingReadStorageTaskTest() {
@@ -613,6 +616,11 @@ TEST_P(RebuildingReadStorageTaskTest, TimeRanges) {
                                                {L2, mklsn(2, 3)}}),
                 convertChunks(chunks));
     }
+    // L2 in partition 0 (N4 clean) and L1 in partition 2 (N3 clean) are
+    // skipped without reading their records. Partition 3 is skipped as a
+    // whole.
+    EXPECT_EQ(
+        2, stats.aggregate().rebuilding_num_record_ranges_nodeset_filtered);
   }
 }
 
@@ -250,6 +250,8 @@ class EpochRecordCacheTest : public ::testing::Test {
   std::vector<std::unique_ptr<Entry>> dropped_;
   bool tail_optimized_ = false;
   StoredBefore stored_before_ = StoredBefore::MAYBE;
+  // 0 disables RecordCacheSlab
+  size_t slab_segment_size_ = 0;
   std::unique_ptr<EpochRecordCacheDependencies> deps_;
   std::unique_ptr<EpochRecordCache> cache_;
 
@@ -328,6 +330,10 @@ class MockEpochRecordCacheDependencies : public EpochRecordCacheDependencies {
                          lsn_t /*end*/,
                          const ReleasedVector& /*entries*/) override {}
 
+  size_t getPayloadSlabSegmentSize() const override {
+    return test_->slab_segment_size_;
+  }
+
  private:
   EpochRecordCacheTest* const test_;
 };
@@ -724,6 +730,66 @@ TEST_F(EpochRecordCacheTest, Snapshot) {
   ASSERT_EQ(lsn(EPOCH, 9), *((lsn_t*)record.payload_raw.data));
 }
 
+// Payloads of cached records are packed into slab segments, and survive
+// eviction, snapshots and repopulation.
+TEST_F(EpochRecordCacheTest, SlabPayloads) {
+  capacity_ = 64;
+  stored_before_ = StoredBefore::NEVER;
+  tail_optimized_ = true;
+  slab_segment_size_ = 4096;
+  create();
+
+  for (esn_t::raw_type esn = 1; esn <= 40; ++esn) {
+    ASSERT_EQ(0, putRecord(cache_.get(), lsn(EPOCH, esn), 0));
+  }
+  for (esn_t::raw_type esn = 1; esn <= 40; ++esn) {
+    ASSERT_CACHE_ENTRY(cache_, esn, lsn(EPOCH, esn));
+  }
+
+  // 8-byte payloads stored one after the other share a segment
+  auto e1 = cache_->getEntry(esn_t(1)).second;
+  auto e2 = cache_->getEntry(esn_t(2)).second;
+  ASSERT_EQ(e1->payload.getPayload().data() + sizeof(lsn_t),
+            e2->payload.getPayload().data());
+
+  // large payloads are not copied
+  PayloadHolder large = createPayload(slab_segment_size_, 'x');
+  const void* large_data = large.getPayload().data();
+  ASSERT_EQ(0,
+            cache_->putRecord(RecordID(lsn(EPOCH, 41), LOG_ID),
+                              lsn(EPOCH, 41),
+                              esn_t(0),
+                              1,
+                              copyset_t({N0, N1, N2}),
+                              STORE_flags_t(0),
+                              KeysType(),
+                              large));
+  ASSERT_EQ(large_data,
+            cache_->getEntry(esn_t(41)).second->payload.getPayload().data());
+
+  // evicted records remain valid as long as they are referenced
+  e1.reset();
+  e2.reset();
+  cache_->advanceLNG(esn_t(20));
+  ASSERT_NO_CACHE_ENTRY(cache_, 20);
+  ASSERT_TAIL_RECORD(cache_, lsn(EPOCH, 20));
+  ASSERT_CACHE_ENTRY(cache_, 21, lsn(EPOCH, 21));
+
+  // round trip through a linear buffer
+  auto snapshot = cache_->createSerializableSnapshot();
+  ASSERT_NE(nullptr, snapshot);
+  std::vector<char> buf(snapshot->sizeInLinearBuffer());
+  ASSERT_EQ(buf.size(), snapshot->toLinearBuffer(buf.data(), buf.size()));
+  auto repopulated = EpochRecordCache::fromLinearBuffer(
+      LOG_ID, SHARD, buf.data(), buf.size(), deps_.get());
+  ASSERT_NE(nullptr, repopulated);
+  ASSERT_TRUE(testEpochRecordCachesIdentical(*cache_, *repopulated));
+  e1 = repopulated->getEntry(esn_t(21)).second;
+  e2 = repopulated->getEntry(esn_t(22)).second;
+  ASSERT_EQ(e1->payload.getPayload().data() + sizeof(lsn_t),
+            e2->payload.getPayload().data());
+}
+
 TEST_F(EpochRecordCacheTest, MultithreadedAppend) {
   multi_threaded_ = true;
   capacity_ = 64;
@@ -1871,6 +1937,32 @@ TEST_F(RecordCacheTest, AdvanceLCE) {
   ASSERT_EQ(nullptr, result.second);
 }
 
+TEST_F(RecordCacheTest, Version) {
+  epoch_cache_capacity_ = 10;
+  create();
+  uint64_t version = cache_->getVersion();
+
+  ASSERT_EQ(0, putRecord(cache_.get(), lsn(EPOCH, 4), 2));
+  ASSERT_GT(cache_->getVersion(), version);
+  version = cache_->getVersion();
+
+  // lookups don't change the version
+  cache_->getEpochRecordCache(EPOCH);
+  cache_->sizeInLinearBuffer();
+  ASSERT_EQ(version, cache_->getVersion());
+
+  cache_->onRelease(lsn(EPOCH, 4));
+  ASSERT_GT(cache_->getVersion(), version);
+  version = cache_->getVersion();
+
+  cache_->evictResetAllEpochs();
+  ASSERT_GT(cache_->getVersion(), version);
+  version = cache_->getVersion();
+
+  cache_->onLastCleanEpochAdvanced(EPOCH);
+  ASSERT_GT(cache_->getVersion(), version);
+}
+
 TEST_F(RecordCacheTest, BasicSequencing) {
   epoch_cache_capacity_ = 10;
   create();
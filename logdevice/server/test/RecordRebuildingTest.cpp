@@ -293,6 +293,12 @@ class TestRecordRebuildingStore : public RecordRebuildingStore,
   void resetStoreTimer() override {
     store_timer_active_ = false;
   }
+  bool
+  queueBatchedAmend(RecipientNode& /* recipient */,
+                    std::unique_ptr<STORE_Message>& /* message */) override {
+    // Tests check the messages sent through the sender.
+    return false;
+  }
   void putAmendSelfTask(std::unique_ptr<AmendSelfStorageTask> task) override {
     EXPECT_EQ(nullptr, amend_self_task_);
     amend_self_task_ = std::move(task);
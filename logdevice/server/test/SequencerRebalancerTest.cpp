@@ -0,0 +1,60 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/SequencerRebalancer.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+
+using L = SequencerRebalancer::LogThroughput;
+
+TEST(SequencerRebalancerTest, NotOverloaded) {
+  EXPECT_TRUE(SequencerRebalancer::pickLogsToMove(
+                  {L{logid_t(1), 30}, L{logid_t(2), 60}}, 100, 10)
+                  .empty());
+  EXPECT_TRUE(SequencerRebalancer::pickLogsToMove({}, 100, 10).empty());
+}
+
+TEST(SequencerRebalancerTest, HottestFirst) {
+  // 160 in total, moving log 3 brings it down to 90.
+  EXPECT_EQ(std::vector<logid_t>({logid_t(3)}),
+            SequencerRebalancer::pickLogsToMove(
+                {L{logid_t(1), 30}, L{logid_t(2), 60}, L{logid_t(3), 70}},
+                100,
+                10));
+  // 200 in total: logs 3 and 2 need to go.
+  EXPECT_EQ(std::vector<logid_t>({logid_t(3), logid_t(2)}),
+            SequencerRebalancer::pickLogsToMove({L{logid_t(1), 40},
+                                                 L{logid_t(2), 60},
+                                                 L{logid_t(3), 70},
+                                                 L{logid_t(4), 30}},
+                                                100,
+                                                10));
+}
+
+TEST(SequencerRebalancerTest, Budget) {
+  EXPECT_EQ(std::vector<logid_t>({logid_t(3)}),
+            SequencerRebalancer::pickLogsToMove({L{logid_t(1), 40},
+                                                 L{logid_t(2), 60},
+                                                 L{logid_t(3), 70},
+                                                 L{logid_t(4), 30}},
+                                                100,
+                                                1));
+  EXPECT_TRUE(SequencerRebalancer::pickLogsToMove(
+                  {L{logid_t(1), 80}, L{logid_t(2), 80}}, 100, 0)
+                  .empty());
+}
+
+TEST(SequencerRebalancerTest, SkipsLogsTooHotToMove) {
+  // Log 1 alone would overload any node, move the smaller ones instead.
+  EXPECT_EQ(std::vector<logid_t>({logid_t(2), logid_t(3)}),
+            SequencerRebalancer::pickLogsToMove(
+                {L{logid_t(1), 150}, L{logid_t(2), 20}, L{logid_t(3), 10}},
+                100,
+                10));
+}
@@ -0,0 +1,152 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/ServerRecordExpressionFilter.h"
+
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+
+namespace {
+
+struct Record {
+  lsn_t lsn = 1;
+  std::chrono::milliseconds timestamp{1000};
+  size_t payload_size = 100;
+  std::map<KeyType, std::string> keys;
+};
+
+bool matches(folly::StringPiece expression, const Record& record) {
+  std::string error;
+  auto filter = ServerRecordExpressionFilter::compile(expression, &error);
+  EXPECT_NE(nullptr, filter) << expression << ": " << error;
+  if (filter == nullptr) {
+    return false;
+  }
+  return filter->matches(ServerRecordFilter::RecordAttributes{
+      record.lsn, record.timestamp, record.payload_size, record.keys});
+}
+
+Record withKey(std::string key) {
+  Record record;
+  record.keys[KeyType::FILTERABLE] = std::move(key);
+  return record;
+}
+
+} // namespace
+
+TEST(ServerRecordExpressionFilterTest, Comparisons) {
+  Record r = withKey("b");
+  EXPECT_TRUE(matches("key == \"b\"", r));
+  EXPECT_FALSE(matches("key != \"b\"", r));
+  EXPECT_TRUE(matches("key > \"a\"", r));
+  EXPECT_TRUE(matches("key >= \"b\"", r));
+  EXPECT_FALSE(matches("key < \"b\"", r));
+  EXPECT_TRUE(matches("key <= \"b\"", r));
+  EXPECT_TRUE(matches("key in (\"c\", \"b\", \"c\")", r));
+  EXPECT_FALSE(matches("key in (\"a\")", r));
+
+  r = withKey("us-west");
+  EXPECT_TRUE(matches("key ^= \"us-\"", r));
+  EXPECT_FALSE(matches("key ^= \"eu-\"", r));
+
+  r = withKey("say \"hi\"\\");
+  EXPECT_TRUE(matches(R"(key == "say \"hi\"\\")", r));
+
+  EXPECT_TRUE(matches("lsn == 1 && timestamp >= 1000 && size < 101", r));
+  EXPECT_FALSE(matches("lsn in (2, 3) || timestamp > 1000", r));
+  r.lsn = (uint64_t(5) << 32) | 10;
+  EXPECT_TRUE(matches("lsn == e5n10", r));
+  EXPECT_TRUE(matches("lsn > e5n9", r));
+}
+
+TEST(ServerRecordExpressionFilterTest, MissingKeys) {
+  Record r = withKey("a");
+  // Comparisons on keys the record doesn't have are false.
+  EXPECT_FALSE(matches("findkey == \"a\"", r));
+  EXPECT_FALSE(matches("findkey != \"a\"", r));
+  EXPECT_TRUE(matches("!has(findkey)", r));
+  EXPECT_TRUE(matches("has(key)", r));
+
+  r.keys[KeyType::FINDKEY] = "f";
+  EXPECT_TRUE(matches("has(findkey) && findkey == \"f\" && key == \"a\"", r));
+}
+
+TEST(ServerRecordExpressionFilterTest, BooleanOperators) {
+  Record r = withKey("x");
+  // && binds tighter than ||.
+  EXPECT_TRUE(matches("key == \"x\" || key == \"y\" && lsn == 2", r));
+  EXPECT_FALSE(matches("(key == \"x\" || key == \"y\") && lsn == 2", r));
+  EXPECT_TRUE(matches("!(key == \"y\") && !!(lsn == 1)", r));
+  EXPECT_TRUE(matches("!(key == \"x\" && lsn == 2)", r));
+  EXPECT_FALSE(matches("!(key == \"x\" || lsn == 2)", r));
+  EXPECT_TRUE(matches("lsn == 2 || lsn == 3 || key == \"x\"", r));
+  EXPECT_FALSE(matches("key == \"x\" && lsn == 1 && size == 0", r));
+  EXPECT_TRUE(matches(" ( ( key==\"x\" ) ) ", r));
+}
+
+TEST(ServerRecordExpressionFilterTest, ShortCircuit) {
+  auto filter = ServerRecordExpressionFilter::compile(
+      "key == \"a\" && lsn == 1 || size > 5");
+  ASSERT_NE(nullptr, filter);
+  using Op = ServerRecordExpressionFilter::Instruction::Op;
+  const auto& program = filter->program();
+  ASSERT_EQ(5, program.size());
+  EXPECT_EQ(Op::TEST, program[0].op);
+  EXPECT_EQ(Op::JUMP_IF_FALSE, program[1].op);
+  EXPECT_EQ(3, program[1].target);
+  EXPECT_EQ(Op::TEST, program[2].op);
+  EXPECT_EQ(Op::JUMP_IF_TRUE, program[3].op);
+  EXPECT_EQ(5, program[3].target);
+  EXPECT_EQ(Op::TEST, program[4].op);
+}
+
+TEST(ServerRecordExpressionFilterTest, InvalidExpressions) {
+  for (const char* expression : {"",
+                                 "key",
+                                 "key == ",
+                                 "key == b",
+                                 "key == \"b",
+                                 "key == \"\\n\"",
+                                 "lsn == \"1\"",
+                                 "lsn == x",
+                                 "size ^= 1",
+                                 "has(lsn)",
+                                 "foo == 1",
+                                 "key == \"a\" &&",
+                                 "(key == \"a\"",
+                                 "key == \"a\")",
+                                 "key in ()",
+                                 "key == \"a\" key == \"b\""}) {
+    std::string error;
+    EXPECT_EQ(
+        nullptr, ServerRecordExpressionFilter::compile(expression, &error))
+        << expression;
+    EXPECT_FALSE(error.empty()) << expression;
+  }
+
+  std::string deep(ServerRecordExpressionFilter::MAX_NESTING_DEPTH + 1, '(');
+  deep += "lsn == 1";
+  deep += std::string(ServerRecordExpressionFilter::MAX_NESTING_DEPTH + 1, ')');
+  EXPECT_EQ(nullptr, ServerRecordExpressionFilter::compile(deep));
+  std::string nots(ServerRecordExpressionFilter::MAX_NESTING_DEPTH + 1, '!');
+  EXPECT_EQ(nullptr, ServerRecordExpressionFilter::compile(nots + "lsn == 1"));
+
+  std::string long_key(
+      ServerRecordExpressionFilter::MAX_EXPRESSION_LENGTH, 'a');
+  EXPECT_EQ(nullptr,
+            ServerRecordExpressionFilter::compile(
+                "key == \"" + long_key + "\""));
+}
+
+TEST(ServerRecordExpressionFilterTest, KeyOnly) {
+  auto filter = ServerRecordExpressionFilter::compile(
+      "key in (\"a\", \"b\") && !has(findkey)");
+  ASSERT_NE(nullptr, filter);
+  EXPECT_TRUE((*filter)("a"));
+  EXPECT_FALSE((*filter)("c"));
+}
@@ -21,6 +21,14 @@ static const shard_index_t SHARD_IDX = 4;
 static const lsn_t REBUILDING_VERSION = 42;
 static const lsn_t RESTART_VERSION = 420;
 
+struct TestLocation : public LocalLogStore::AllLogsIterator::Location {
+  explicit TestLocation(std::string name) : name(std::move(name)) {}
+  std::string toString() const override {
+    return name;
+  }
+  std::string name;
+};
+
 class MockedShardRebuilding : public ShardRebuilding,
                               public ShardRebuildingInterface::Listener {
  public:
@@ -32,6 +40,9 @@ class MockedShardRebuilding : public ShardRebuilding,
 
   StatsHolder stats;
   bool taskInFlight = false;
+  // Returned by getClientLatencyP99().
+  std::chrono::microseconds appendP99{0};
+  std::chrono::microseconds readP99{0};
   bool waitingForGlobalWindow = false;
   bool completed = false;
 
@@ -116,6 +127,11 @@ class MockedShardRebuilding : public ShardRebuilding,
         ChunkInfo{.id = chunk_id, .data = std::move(chunk), .worker = worker});
     return worker;
   }
+  void getClientLatencyP99(std::chrono::microseconds* append,
+                           std::chrono::microseconds* read) override {
+    *append = appendP99;
+    *read = readP99;
+  }
   void putStorageTask() override {
     EXPECT_FALSE(taskInFlight);
     taskInFlight = true;
@@ -148,12 +164,21 @@ class MockedShardRebuilding : public ShardRebuilding,
   }
 
   void simulateReadTaskDone(std::vector<ChunkData*> chunks,
-                            bool reached_end = false) {
+                            bool reached_end = false,
+                            std::string next_location = "",
+                            size_t bytes_read = 0) {
     ld_check(taskInFlight);
     taskInFlight = false;
 
     ld_check(!readContext_->reachedEnd);
     readContext_->reachedEnd = reached_end;
+    if (reached_end) {
+      readContext_->nextLocation = nullptr;
+    } else if (!next_location.empty()) {
+      readContext_->nextLocation =
+          std::make_shared<TestLocation>(next_location);
+    }
+    readContext_->bytesRead = bytes_read;
     auto before = SteadyTimestamp::now();
     readContext_->onDone(
         std::vector<std::unique_ptr<ChunkData>>(chunks.begin(), chunks.end()));
@@ -170,6 +195,21 @@ class MockedShardRebuilding : public ShardRebuilding,
     globalWindowWaitingMayHaveChanged(before);
   }
 
+  RebuildingReadStorageTask::Context* getReadContext() {
+    return readContext_.get();
+  }
+
+  void simulateAutoTuneTimer() {
+    auto timer = dynamic_cast<MockTimer*>(autoTuneTimer_.get());
+    ASSERT_NE(nullptr, timer);
+    ASSERT_TRUE(timer->isActive());
+    timer->trigger();
+  }
+
+  bool throttledByAutoTuning() const {
+    return profilingState_ == ProfilingState::THROTTLED_BY_AUTO_TUNING;
+  }
+
   // idx is index in chunkRebuildings.
   void simulateChunkRebuildingDone(size_t idx) {
     auto before = SteadyTimestamp::now();
@@ -528,6 +568,125 @@ TEST_P(ShardRebuildingTest, WindowsAndInternalLogs) {
   EXPECT_DONOR_PROGRESS(BASE_TIME + direction * HOUR);
 }
 
+TEST_P(ShardRebuildingTest, ResumeFromCheckpoint) {
+  MockedShardRebuilding reb(rebuildingSettings_);
+  reb.start({});
+  EXPECT_EQ(nullptr, reb.getCheckpoint());
+
+  // Two read tasks, whose chunks are rebuilt out of order.
+  reb.simulateReadTaskDone(
+      {makeChunk(logid_t(1), 100, 101, 10)}, false, "a", 100);
+  reb.simulateReadTaskDone(
+      {makeChunk(logid_t(1), 102, 103, 10)}, false, "b", 200);
+  ASSERT_EQ(2, reb.chunkRebuildings.size());
+  reb.simulateChunkRebuildingDone(1);
+  // Chunk of the first read task is still in flight.
+  EXPECT_EQ(nullptr, reb.getCheckpoint());
+  reb.simulateChunkRebuildingDone(0);
+  auto checkpoint = reb.getCheckpoint();
+  ASSERT_NE(nullptr, checkpoint);
+  EXPECT_EQ(0, checkpoint->bytesReadPastCheckpoint);
+
+  // Third read task's chunk is in flight, so it's not covered by checkpoint.
+  reb.simulateReadTaskDone(
+      {makeChunk(logid_t(2), 10, 10, 10)}, false, "c", 50);
+  checkpoint = reb.getCheckpoint();
+  ASSERT_NE(nullptr, checkpoint);
+  EXPECT_EQ(50, checkpoint->bytesReadPastCheckpoint);
+  EXPECT_EQ(350, reb.getBytesRead());
+
+  // Shards were added to rebuilding set. Resume from the checkpoint.
+  auto added_shards = std::make_shared<RebuildingSet>();
+  added_shards->shards.emplace(
+      ShardID(7, SHARD_IDX), RebuildingNodeInfo(RebuildingMode::RESTORE));
+  MockedShardRebuilding reb2(rebuildingSettings_);
+  reb2.resumeFrom(checkpoint, added_shards);
+  reb2.start({});
+  EXPECT_TRUE(reb2.taskInFlight);
+  ASSERT_NE(nullptr, reb2.getReadContext()->nextLocation);
+  EXPECT_EQ("b", reb2.getReadContext()->nextLocation->toString());
+  EXPECT_EQ(nullptr, reb2.getReadContext()->stopLocation);
+  EXPECT_EQ(nullptr, reb2.getReadContext()->filterRebuildingSet);
+
+  // Read to the end.
+  reb2.simulateReadTaskDone({makeChunk(logid_t(1), 104, 105, 10)}, true);
+  ASSERT_EQ(1, reb2.chunkRebuildings.size());
+  // A resumed rebuilding can't be resumed again until it's done with the
+  // follow-up pass.
+  EXPECT_EQ(nullptr, reb2.getCheckpoint());
+  reb2.simulateChunkRebuildingDone(0);
+
+  // Not done yet: a follow-up pass from the beginning up to the checkpoint,
+  // for the added shard only.
+  EXPECT_FALSE(reb2.completed);
+  EXPECT_TRUE(reb2.taskInFlight);
+  EXPECT_EQ(nullptr, reb2.getReadContext()->nextLocation);
+  ASSERT_NE(nullptr, reb2.getReadContext()->stopLocation);
+  EXPECT_EQ("b", reb2.getReadContext()->stopLocation->toString());
+  EXPECT_EQ(added_shards, reb2.getReadContext()->filterRebuildingSet);
+
+  reb2.simulateReadTaskDone({makeChunk(logid_t(1), 50, 50, 10)}, true);
+  ASSERT_EQ(1, reb2.chunkRebuildings.size());
+  EXPECT_FALSE(reb2.completed);
+  reb2.simulateChunkRebuildingDone(0);
+  EXPECT_FALSE(reb2.taskInFlight);
+  EXPECT_TRUE(reb2.completed);
+}
+
+TEST_P(ShardRebuildingTest, AutoTune) {
+  rebuildingSettingsUpdater_.setFromCLI(
+      {{"rebuilding-max-records-in-flight", "4"},
+       {"rebuilding-auto-tune-append-p99-target", "10ms"},
+       {"rebuilding-auto-tune-min-factor", "0.25"}});
+  MockedShardRebuilding reb(rebuildingSettings_);
+  reb.start({});
+  EXPECT_EQ(100, PER_SHARD_STAT(rebuilding_auto_tune_percent));
+
+  reb.simulateReadTaskDone({makeChunk(logid_t(1), 1, 1, 10),
+                            makeChunk(logid_t(1), 2, 2, 10),
+                            makeChunk(logid_t(1), 3, 3, 10),
+                            makeChunk(logid_t(1), 4, 4, 10)});
+  EXPECT_EQ(4, reb.chunkRebuildings.size());
+
+  // Appends are slow. Throttle down to 2 records in flight.
+  reb.appendP99 = std::chrono::milliseconds(20);
+  reb.simulateAutoTuneTimer();
+  EXPECT_EQ(50, PER_SHARD_STAT(rebuilding_auto_tune_percent));
+  EXPECT_EQ(1, PER_SHARD_STAT(rebuilding_auto_tune_backoffs));
+  for (int i = 0; i < 3; ++i) {
+    reb.simulateChunkRebuildingDone(0);
+  }
+  reb.simulateReadTaskDone({makeChunk(logid_t(1), 5, 5, 10),
+                            makeChunk(logid_t(1), 6, 6, 10),
+                            makeChunk(logid_t(1), 7, 7, 10)},
+                           true);
+  EXPECT_EQ(2, reb.chunkRebuildings.size());
+  EXPECT_TRUE(reb.throttledByAutoTuning());
+
+  // Latency is back to normal. Additive increase.
+  reb.appendP99 = std::chrono::milliseconds(1);
+  reb.simulateAutoTuneTimer();
+  reb.simulateAutoTuneTimer();
+  EXPECT_EQ(2, reb.chunkRebuildings.size());
+  reb.simulateAutoTuneTimer();
+  EXPECT_EQ(80, PER_SHARD_STAT(rebuilding_auto_tune_percent));
+  EXPECT_EQ(3, reb.chunkRebuildings.size());
+  EXPECT_FALSE(reb.throttledByAutoTuning());
+
+  // Multiplicative decrease, down to the min factor.
+  reb.appendP99 = std::chrono::milliseconds(20);
+  reb.simulateAutoTuneTimer();
+  reb.simulateAutoTuneTimer();
+  reb.simulateAutoTuneTimer();
+  EXPECT_EQ(25, PER_SHARD_STAT(rebuilding_auto_tune_percent));
+  EXPECT_EQ(4, PER_SHARD_STAT(rebuilding_auto_tune_backoffs));
+
+  for (int i = 0; i < 3; ++i) {
+    reb.simulateChunkRebuildingDone(0);
+  }
+  EXPECT_TRUE(reb.completed);
+}
+
 // TODO: getDebugInfo()
 // TODO: getDebugInfo() while waiting for global window
 // TODO: getDebugInfo() while have and don't have storage task in flight
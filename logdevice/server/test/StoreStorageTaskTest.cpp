@@ -152,6 +152,10 @@ class MockWriteBatchStorageTask : public WriteBatchStorageTask {
     return false;
   }
 
+  PendingCacheWrites& getPendingCacheWrites() override {
+    return pending_cache_writes_;
+  }
+
   std::unique_ptr<WriteStorageTask> tryGetWrite() override {
     if (queue_.empty()) {
       return nullptr;
@@ -180,6 +184,7 @@ class MockWriteBatchStorageTask : public WriteBatchStorageTask {
  private:
   std::queue<std::unique_ptr<WriteStorageTask>> queue_;
   StatsHolder stats_;
+  PendingCacheWrites pending_cache_writes_;
 };
 
 size_t get_task_idx(WriteStorageTask* task) {
@@ -0,0 +1,53 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include "logdevice/server/storage_tasks/WALSyncGroup.h"
+
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace facebook::logdevice;
+using namespace std::chrono;
+
+// A lone participant is released when the window expires.
+TEST(WALSyncGroupTest, WindowExpires) {
+  WALSyncGroup group(4);
+  auto res = group.join(milliseconds(50));
+  EXPECT_EQ(1, res.batch_size);
+  EXPECT_GE(res.wait_time, milliseconds(50));
+}
+
+// The round closes as soon as all participants have joined it.
+TEST(WALSyncGroupTest, AllParticipantsJoined) {
+  const size_t n = 4;
+  WALSyncGroup group(n);
+  std::vector<WALSyncGroup::Result> results(n);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < n; ++i) {
+    threads.emplace_back([&, i] { results[i] = group.join(seconds(60)); });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  for (const auto& res : results) {
+    EXPECT_EQ(n, res.batch_size);
+    EXPECT_LT(res.wait_time, seconds(30));
+  }
+
+  // The next round starts empty.
+  WALSyncGroup::Result res = group.join(milliseconds(1));
+  EXPECT_EQ(1, res.batch_size);
+}
+
+TEST(WALSyncGroupTest, SingleParticipant) {
+  WALSyncGroup group(1);
+  auto res = group.join(seconds(60));
+  EXPECT_EQ(1, res.batch_size);
+  EXPECT_LT(res.wait_time, seconds(30));
+}
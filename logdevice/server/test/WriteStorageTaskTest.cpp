@@ -157,11 +157,11 @@ class ShardedStoreWrapper : public ShardedLocalLogStore {
   T store_;
 };
 
-TEST(WriteStorageTaskTest, Simple) {
-  const int nwrites = 10000;
+// Posts `nwrites` writes from a single worker request and checks that all of
+// them made it into the store.
+static void runSimpleWrites(const int nwrites, Settings settings) {
   const int nworkers = 1;
 
-  Settings settings = create_default_settings<Settings>();
   ServerSettings server_settings = create_default_settings<ServerSettings>();
 
   settings.num_workers = nworkers;
@@ -231,6 +231,27 @@ TEST(WriteStorageTaskTest, Simple) {
   shutdown_test_server(processor);
 }
 
+TEST(WriteStorageTaskTest, Simple) {
+  runSimpleWrites(10000, create_default_settings<Settings>());
+}
+
+// All writes are posted in one event loop iteration, so they share a single
+// WriteBatchStorageTask, which has to keep picking batches of write_batch_size
+// until it has done all of them.
+TEST(WriteStorageTaskTest, CoalescedBatchTasks) {
+  Settings settings = create_default_settings<Settings>();
+  settings.coalesce_write_batch_tasks = true;
+  settings.write_batch_size = 3;
+  runSimpleWrites(1000, settings);
+}
+
+TEST(WriteStorageTaskTest, NoCoalescing) {
+  Settings settings = create_default_settings<Settings>();
+  settings.coalesce_write_batch_tasks = false;
+  settings.write_batch_size = 3;
+  runSimpleWrites(1000, settings);
+}
+
 // Checks that writes into metadata logs are executed even if log store reports
 // that it's out of space.
 TEST(WriteStorageTaskTest, MetadataLogNOSPC) {
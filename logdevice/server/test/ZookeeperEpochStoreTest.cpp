@@ -24,6 +24,7 @@
 #include "logdevice/common/test/TestNodeSetSelector.h"
 #include "logdevice/common/test/TestUtil.h"
 #include "logdevice/common/test/ZookeeperClientInMemory.h"
+#include "logdevice/server/EpochMetaDataZRQ.h"
 #include "logdevice/server/ServerProcessor.h"
 #include "logdevice/server/SetLastCleanEpochZRQ.h"
 
@@ -150,6 +151,30 @@ TailRecord gen_tail_record_with_payload(logid_t logid,
       std::move(offsets),
       PayloadHolder::copyBuffer(&payload_flat[0], payload_flat.size()));
 }
+
+// Bumps the next epoch of a log and waits for the result.
+std::pair<Status, epoch_t> bump_epoch(EpochStore* epochstore, logid_t logid) {
+  Semaphore sem;
+  Status status = E::UNKNOWN;
+  epoch_t epoch = EPOCH_INVALID;
+  int rv = epochstore->createOrUpdateMetaData(
+      logid,
+      std::make_shared<EpochMetaDataUpdateToNextEpoch>(),
+      [&](Status st,
+          logid_t,
+          std::unique_ptr<EpochMetaData> info,
+          std::unique_ptr<EpochStoreMetaProperties> /*meta_props*/) {
+        status = st;
+        if (info) {
+          epoch = info->h.epoch;
+        }
+        sem.post();
+      },
+      MetaDataTracer());
+  EXPECT_EQ(0, rv);
+  sem.wait();
+  return std::make_pair(status, epoch);
+}
 } // namespace
 
 /*
@@ -945,3 +970,71 @@ TEST_F(ZookeeperEpochStoreTest, LastCleanEpochWithTailRecord) {
   ASSERT_EQ(0, rv);
   sem.wait();
 }
+
+// Epoch bumps with the metadata cache on are based on the cached znode, and
+// are redone from a fresh read if someone else wrote the znode.
+TEST_F(ZookeeperEpochStoreTest, MetaDataCache) {
+  SettingsUpdater updater;
+  updater.registerSettings(processor->updateableSettings());
+  updater.setFromAdminCmd("zk-epoch-store-metadata-cache", "true");
+
+  const logid_t logid(1);
+  auto res = bump_epoch(epochstore.get(), logid);
+  ASSERT_EQ(E::OK, res.first);
+  const epoch_t first = res.second;
+
+  // served from the cache
+  res = bump_epoch(epochstore.get(), logid);
+  ASSERT_EQ(E::OK, res.first);
+  EXPECT_EQ(first.val() + 1, res.second.val());
+
+  // another writer changes the znode version behind the cache's back
+  auto zkclient = epochstore->getZookeeperClient();
+  const std::string path = epochstore->znodePathForLog(logid) + "/" +
+      EpochMetaDataZRQ::znodeName;
+  Semaphore sem;
+  zkclient->getData(path, [&](int rc, std::string value, zk::Stat) {
+    ASSERT_EQ(ZOK, rc);
+    zkclient->setData(path, std::move(value), [&](int rc2, zk::Stat) {
+      EXPECT_EQ(ZOK, rc2);
+      sem.post();
+    });
+  });
+  sem.wait();
+
+  res = bump_epoch(epochstore.get(), logid);
+  ASSERT_EQ(E::OK, res.first);
+  EXPECT_EQ(first.val() + 2, res.second.val());
+}
+
+// Concurrent epoch bumps of different logs with writes sent in multi-ops.
+TEST_F(ZookeeperEpochStoreTest, BatchedWrites) {
+  SettingsUpdater updater;
+  updater.registerSettings(processor->updateableSettings());
+  updater.setFromAdminCmd("zk-epoch-store-write-batch-size", "8");
+  updater.setFromAdminCmd("zk-epoch-store-metadata-cache", "true");
+
+  std::vector<epoch_t> epochs;
+  for (logid_t logid : VALID_LOG_IDS) {
+    auto res = bump_epoch(epochstore.get(), logid);
+    ASSERT_EQ(E::OK, res.first);
+    epochs.push_back(res.second);
+  }
+
+  for (int round = 1; round <= 5; ++round) {
+    std::vector<std::thread> threads;
+    std::vector<std::pair<Status, epoch_t>> results(VALID_LOG_IDS.size());
+    for (size_t i = 0; i < VALID_LOG_IDS.size(); ++i) {
+      threads.emplace_back([&, i] {
+        results[i] = bump_epoch(epochstore.get(), VALID_LOG_IDS[i]);
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    for (size_t i = 0; i < VALID_LOG_IDS.size(); ++i) {
+      ASSERT_EQ(E::OK, results[i].first);
+      EXPECT_EQ(epochs[i].val() + round, results[i].second.val());
+    }
+  }
+}
@@ -0,0 +1,565 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <time.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <folly/Singleton.h>
+#include <folly/io/IOBuf.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/common/LocalLogStoreRecordFormat.h"
+#include "logdevice/common/Sender.h"
+#include "logdevice/common/ServerRecordFilter.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/protocol/Compatibility.h"
+#include "logdevice/common/protocol/GAP_Message.h"
+#include "logdevice/common/protocol/ProtocolWriter.h"
+#include "logdevice/common/protocol/RECORD_Message.h"
+#include "logdevice/common/protocol/STARTED_Message.h"
+#include "logdevice/common/settings/util.h"
+#include "logdevice/common/stats/Stats.h"
+#include "logdevice/common/test/MockBackoffTimer.h"
+#include "logdevice/common/test/MockTimer.h"
+#include "logdevice/server/ServerRecordFilterFactory.h"
+#include "logdevice/server/ServerSettings.h"
+#include "logdevice/server/locallogstore/WriteOps.h"
+#include "logdevice/server/locallogstore/test/TemporaryLogStore.h"
+#include "logdevice/server/read_path/AllServerReadStreams.h"
+#include "logdevice/server/read_path/CatchupQueue.h"
+#include "logdevice/server/read_path/IteratorCache.h"
+#include "logdevice/server/read_path/LogStorageStateMap.h"
+#include "logdevice/server/storage_tasks/ReadStorageTask.h"
+#include "logdevice/server/storage_tasks/StorageThreadPool.h"
+
+using namespace facebook::logdevice;
+
+/**
+ * @file: benchmark of the server read path of one worker, from
+ *        AllServerReadStreams through CatchupQueue, CatchupOneStream and
+ *        ReadStorageTask to serialized RECORD messages. The log store is a
+ *        TemporaryInMemoryRocksDBStore filled with --records_per_log records
+ *        in each of --num_logs logs. Storage tasks are executed inline rather
+ *        than on storage threads, and every message is serialized with
+ *        ProtocolWriter and then immediately reported as drained from the
+ *        output evbuffer, so the benchmark measures CPU cost of the read
+ *        path, not I/O.
+ *
+ *        Each iteration starts --num_streams read streams from
+ *        --num_clients clients, each reading one log from the beginning to
+ *        the end, and finishes when all streams are caught up. Benchmarks
+ *        report RECORD messages per second of a single worker; at exit, the
+ *        CPU time per record and per serialized byte of each mode is
+ *        printed. Modes:
+ *          Full       plain streams;
+ *          NoPayload  streams created with the no-payload flag;
+ *          Filter     server-side filtering letting 1 record in 4 through;
+ *          SCD        single copy delivery, this node is the primary
+ *                     recipient of 1 record in 3.
+ */
+
+DEFINE_int32(num_logs, 64, "Number of logs in the store.");
+DEFINE_int32(records_per_log, 2000, "Number of records in each log.");
+DEFINE_int32(payload_size, 500, "Payload size of records in bytes.");
+DEFINE_int32(num_streams, 256, "Number of read streams.");
+DEFINE_int32(num_clients, 8, "Number of clients the streams are spread over.");
+
+namespace facebook { namespace logdevice {
+
+namespace {
+
+const shard_index_t SHARD_IDX = 0;
+const node_index_t MY_NODE_INDEX = 0;
+const epoch_t EPOCH(1);
+const size_t NUM_FILTER_KEYS = 4;
+
+enum class Mode { FULL, NO_PAYLOAD, FILTER, SCD };
+
+struct ModeTotals {
+  uint64_t records = 0;
+  uint64_t bytes = 0;
+  uint64_t cpu_ns = 0;
+};
+
+std::map<std::string, ModeTotals>& totals() {
+  static std::map<std::string, ModeTotals> totals;
+  return totals;
+}
+
+uint64_t threadCpuNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return uint64_t(ts.tv_sec) * 1000000000ul + ts.tv_nsec;
+}
+
+lsn_t lastLSN() {
+  return compose_lsn(EPOCH, esn_t(FLAGS_records_per_log));
+}
+
+UpdateableSettings<Settings> benchSettings() {
+  Settings settings = create_default_settings<Settings>();
+  // Always go through ReadStorageTask rather than reading on the worker.
+  settings.allow_reads_on_workers = false;
+  return UpdateableSettings<Settings>(settings);
+}
+
+/**
+ * The store and an idle storage thread pool, which ReadStorageTask::execute()
+ * needs to get to the store and settings. Created once and shared by all
+ * benchmarks.
+ */
+struct BenchStore {
+  BenchStore() : settings(benchSettings()) {
+    ServerSettings::StoragePoolParams params;
+    params[(size_t)StorageTaskThreadType::SLOW].nthreads = 1;
+    pool = std::make_unique<StorageThreadPool>(
+        SHARD_IDX,
+        1,
+        params,
+        UpdateableSettings<ServerSettings>(
+            create_default_settings<ServerSettings>()),
+        settings,
+        &store,
+        16);
+    fill();
+  }
+
+  void fill() {
+    const std::string payload(FLAGS_payload_size, 'x');
+    const LocalLogStoreRecordFormat::flags_t flags =
+        LocalLogStoreRecordFormat::FLAG_SHARD_ID |
+        LocalLogStoreRecordFormat::FLAG_CHECKSUM_PARITY |
+        LocalLogStoreRecordFormat::FLAG_CUSTOM_KEY |
+        LocalLogStoreRecordFormat::FLAG_OPTIONAL_KEYS;
+    const int64_t now_ms = RecordTimestamp::now().toMilliseconds().count();
+
+    for (int log = 1; log <= FLAGS_num_logs; ++log) {
+      std::vector<std::string> header_bufs(FLAGS_records_per_log);
+      std::vector<std::string> csi_bufs(FLAGS_records_per_log);
+      std::vector<PutWriteOp> ops;
+      std::vector<const WriteOp*> op_ptrs;
+      ops.reserve(FLAGS_records_per_log);
+      for (int i = 0; i < FLAGS_records_per_log; ++i) {
+        // Rotate the copyset so that this node comes first in a third of
+        // the records, which is what SCD delivers.
+        copyset_t copyset;
+        for (int j = 0; j < 3; ++j) {
+          copyset.push_back(ShardID((i + j) % 3, SHARD_IDX));
+        }
+        std::map<KeyType, std::string> keys;
+        keys[KeyType::FILTERABLE] = "key" + std::to_string(i % NUM_FILTER_KEYS);
+        Slice header = LocalLogStoreRecordFormat::formRecordHeader(
+            now_ms,
+            esn_t(0), // LNG
+            flags,
+            1, // wave
+            folly::Range<const ShardID*>(
+                copyset.data(), copyset.data() + copyset.size()),
+            OffsetMap::fromLegacy(0),
+            keys,
+            &header_bufs[i]);
+        Slice csi_entry = LocalLogStoreRecordFormat::formCopySetIndexEntry(
+            1, // wave
+            copyset.data(),
+            copyset.size(),
+            LSN_INVALID, // block starting LSN
+            LocalLogStoreRecordFormat::formCopySetIndexFlags(flags),
+            &csi_bufs[i]);
+        ops.emplace_back(logid_t(log),
+                         compose_lsn(EPOCH, esn_t(i + 1)),
+                         header,
+                         Slice::fromString(payload),
+                         node_index_t(1), // coordinator
+                         LSN_INVALID,     // block starting LSN
+                         csi_entry,
+                         std::vector<std::pair<char, std::string>>(),
+                         Durability::ASYNC_WRITE,
+                         false); // is_rebuilding
+      }
+      for (const auto& op : ops) {
+        op_ptrs.push_back(&op);
+      }
+      int rv = store.writeMulti(op_ptrs);
+      ld_check(rv == 0);
+    }
+  }
+
+  UpdateableSettings<Settings> settings;
+  TemporaryInMemoryRocksDBStore store;
+  std::unique_ptr<StorageThreadPool> pool;
+};
+
+BenchStore& benchStore() {
+  static BenchStore store;
+  return store;
+}
+
+class CatchupQueueBenchmark;
+
+/**
+ * AllServerReadStreams with all its CatchupQueues using
+ * BenchCatchupQueueDependencies, and with storage tasks queued in the
+ * benchmark instead of being sent to storage threads.
+ */
+class BenchAllServerReadStreams : public AllServerReadStreams {
+ public:
+  BenchAllServerReadStreams(UpdateableSettings<Settings> settings,
+                            LogStorageStateMap* log_storage_state_map)
+      : AllServerReadStreams(settings,
+                             1ul << 30,
+                             worker_id_t(0),
+                             log_storage_state_map,
+                             nullptr,
+                             nullptr,
+                             false) {}
+
+  void addClient(ClientID client_id, CatchupQueueBenchmark& bench);
+
+  void sendStorageTask(std::unique_ptr<ReadStorageTask>&& task,
+                       shard_index_t /*shard*/) override {
+    tasks_.push_back(std::move(task));
+  }
+
+  void sendStorageTaskBatch(std::vector<std::unique_ptr<ReadStorageTask>> tasks,
+                            shard_index_t /*shard*/) override {
+    for (auto& task : tasks) {
+      tasks_.push_back(std::move(task));
+    }
+  }
+
+  void scheduleSendDelayedStorageTasks() override {
+    delayed_tasks_pending_ = true;
+  }
+
+  // Sends the storage tasks delayed for lack of memory budget, if any.
+  bool sendDelayedTasks() {
+    if (!delayed_tasks_pending_) {
+      return false;
+    }
+    delayed_tasks_pending_ = false;
+    sendDelayedReadStorageTasks();
+    return true;
+  }
+
+  std::deque<std::unique_ptr<ReadStorageTask>> tasks_;
+
+ private:
+  bool delayed_tasks_pending_ = false;
+};
+
+/**
+ * Runs all streams of one iteration to completion on the calling thread.
+ */
+class CatchupQueueBenchmark {
+ public:
+  explicit CatchupQueueBenchmark(Mode mode)
+      : mode_(mode),
+        settings_(benchStore().settings),
+        log_storage_state_map_(1, /*stats*/ nullptr, /*record_cache*/ false),
+        streams_(settings_, &log_storage_state_map_),
+        stats_(StatsParams().setIsServer(true)) {
+    for (int log = 1; log <= FLAGS_num_logs; ++log) {
+      LogStorageState* log_state =
+          log_storage_state_map_.insertOrGet(logid_t(log), SHARD_IDX);
+      log_state->updateLastReleasedLSN(
+          lastLSN(), LogStorageState::LastReleasedSource::RELEASE);
+      log_state->updateTrimPoint(lsn_t(0));
+    }
+    for (int i = 0; i < FLAGS_num_clients; ++i) {
+      streams_.addClient(ClientID(i + 1), *this);
+    }
+    for (int i = 0; i < FLAGS_num_streams; ++i) {
+      createStream(i);
+    }
+  }
+
+  ~CatchupQueueBenchmark() {
+    streams_.clear();
+  }
+
+  // Returns the number of RECORD messages sent.
+  size_t run() {
+    for (ServerReadStream* stream : new_streams_) {
+      streams_.notifyNeedsCatchup(*stream, /*allow_delay=*/false);
+    }
+    new_streams_.clear();
+
+    while (!sent_.empty() || !streams_.tasks_.empty() ||
+           streams_.sendDelayedTasks()) {
+      drainSent();
+      if (!streams_.tasks_.empty()) {
+        std::unique_ptr<ReadStorageTask> task =
+            std::move(streams_.tasks_.front());
+        streams_.tasks_.pop_front();
+        task->setStorageThreadPool(benchStore().pool.get());
+        task->execute();
+        streams_.onReadTaskDone(*task);
+      }
+    }
+    return records_sent_;
+  }
+
+  int onMessage(std::unique_ptr<Message>&& msg, ClientID client_id) {
+    auto iobuf = folly::IOBuf::create(IOBUF_ALLOCATION_UNIT);
+    ProtocolWriter writer(
+        msg->type_, iobuf.get(), Compatibility::MAX_PROTOCOL_SUPPORTED);
+    msg->serialize(writer);
+    folly::doNotOptimizeAway(writer.computeChecksum());
+    ssize_t size = writer.result();
+    ld_check(size >= 0);
+    bytes_sent_ += size;
+    records_sent_ += msg->type_ == MessageType::RECORD;
+    sent_.push_back(SentMessage{std::move(msg), client_id});
+    return 0;
+  }
+
+  size_t bytesSent() const {
+    return bytes_sent_;
+  }
+
+  const Settings& getSettings() const {
+    return *settings_.get();
+  }
+
+ private:
+  struct SentMessage {
+    std::unique_ptr<Message> msg;
+    ClientID client_id;
+  };
+
+  void createStream(int idx) {
+    const ClientID client_id(idx % FLAGS_num_clients + 1);
+    const logid_t log_id(idx % FLAGS_num_logs + 1);
+    auto insert_result = streams_.insertOrGet(
+        client_id, log_id, SHARD_IDX, "", read_stream_id_t(idx + 1));
+    ld_check(insert_result.second);
+    ServerReadStream* stream = insert_result.first;
+    stream->setTrafficClass(TrafficClass::READ_BACKLOG);
+    stream->setReadPtr(compose_lsn(EPOCH, esn_t(1)));
+    stream->last_delivered_record_ = 0;
+    stream->last_delivered_lsn_ = 0;
+    stream->until_lsn_ = lastLSN();
+    stream->setWindowHigh(lastLSN());
+    stream->proto_ = Compatibility::MAX_PROTOCOL_SUPPORTED;
+    stream->needs_started_message_ = false;
+    stream->iterator_cache_ = std::make_shared<IteratorCache>(
+        &benchStore().store, log_id, /*created_by_rebuilding=*/false);
+    switch (mode_) {
+      case Mode::FULL:
+        break;
+      case Mode::NO_PAYLOAD:
+        stream->no_payload_ = true;
+        break;
+      case Mode::FILTER:
+        stream->filter_pred_ = ServerRecordFilterFactory::create(
+            ServerRecordFilterType::EQUALITY, "key0", "");
+        break;
+      case Mode::SCD:
+        stream->enableSingleCopyDelivery(small_shardset_t(), MY_NODE_INDEX);
+        break;
+    }
+    new_streams_.push_back(stream);
+  }
+
+  // Tells CatchupQueues that the messages were drained from the output
+  // evbuffer, which makes them queue more.
+  void drainSent() {
+    while (!sent_.empty()) {
+      std::vector<SentMessage> sent;
+      sent.swap(sent_);
+      const SteadyTimestamp now = SteadyTimestamp::now();
+      for (SentMessage& s : sent) {
+        switch (s.msg->type_) {
+          case MessageType::RECORD:
+            streams_.onRecordSent(
+                s.client_id, static_cast<RECORD_Message&>(*s.msg), now);
+            break;
+          case MessageType::GAP:
+            streams_.onGapSent(
+                s.client_id, static_cast<GAP_Message&>(*s.msg), now);
+            break;
+          case MessageType::STARTED:
+            streams_.onStartedSent(
+                s.client_id, static_cast<STARTED_Message&>(*s.msg), now);
+            break;
+          default:
+            break;
+        }
+      }
+    }
+  }
+
+  const Mode mode_;
+  UpdateableSettings<Settings> settings_;
+  LogStorageStateMap log_storage_state_map_;
+  BenchAllServerReadStreams streams_;
+  StatsHolder stats_;
+  std::vector<ServerReadStream*> new_streams_;
+  std::vector<SentMessage> sent_;
+  size_t records_sent_ = 0;
+  size_t bytes_sent_ = 0;
+
+  friend class BenchCatchupQueueDependencies;
+};
+
+/**
+ * CatchupQueueDependencies that never throttle and hand all messages to
+ * CatchupQueueBenchmark::onMessage().
+ */
+class BenchCatchupQueueDependencies : public CatchupQueueDependencies {
+  using BenchSender = SenderTestProxy<BenchCatchupQueueDependencies>;
+
+ public:
+  explicit BenchCatchupQueueDependencies(CatchupQueueBenchmark& bench)
+      : CatchupQueueDependencies(&bench.streams_, &bench.stats_),
+        bench_(bench) {
+    sender_ = std::make_unique<BenchSender>(this);
+  }
+
+  std::unique_ptr<BackoffTimer>
+  createPingTimer(std::function<void()> callback) override {
+    auto timer = std::make_unique<MockBackoffTimer>();
+    timer->setCallback(callback);
+    return std::move(timer);
+  }
+
+  std::unique_ptr<Timer>
+  createIteratorTimer(std::function<void()> callback) override {
+    auto timer = std::make_unique<MockTimer>();
+    timer->setCallback(callback);
+    return std::move(timer);
+  }
+
+  std::chrono::milliseconds iteratorTimerTTL() const override {
+    return std::chrono::milliseconds::zero();
+  }
+
+  folly::Optional<std::chrono::milliseconds>
+  getDeliveryLatency(logid_t /*log_id*/) override {
+    return folly::none;
+  }
+
+  bool canSendToImpl(const Address&, TrafficClass, BWAvailableCallback&) {
+    return true;
+  }
+
+  int sendMessageImpl(std::unique_ptr<Message>&& msg,
+                      const Address& addr,
+                      BWAvailableCallback*,
+                      SocketCallback*) {
+    ld_check(addr.isClientAddress());
+    return bench_.onMessage(std::move(msg), addr.id_.client_);
+  }
+
+  LogStorageStateMap& getLogStorageStateMap() override {
+    return bench_.log_storage_state_map_;
+  }
+
+  int recoverLogState(logid_t /*log_id*/,
+                      shard_index_t /*shard*/,
+                      bool /*force_ask_sequencer*/ = false) override {
+    return 0;
+  }
+
+  NodeID getMyNodeID() const override {
+    return NodeID(MY_NODE_INDEX, 1);
+  }
+
+  size_t getMaxRecordBytesQueued(ClientID) override {
+    return 128 * 1024;
+  }
+
+  const PrincipalIdentity* getPrincipal(ClientID) override {
+    return nullptr;
+  }
+
+  const Settings& getSettings() const override {
+    return bench_.getSettings();
+  }
+
+ private:
+  CatchupQueueBenchmark& bench_;
+};
+
+void BenchAllServerReadStreams::addClient(ClientID client_id,
+                                          CatchupQueueBenchmark& bench) {
+  auto insert_result = client_states_.emplace(std::piecewise_construct,
+                                              std::forward_as_tuple(client_id),
+                                              std::forward_as_tuple());
+  ld_check(insert_result.second);
+  insert_result.first->second.catchup_queue.reset(new CatchupQueue(
+      std::make_unique<BenchCatchupQueueDependencies>(bench), client_id));
+}
+
+size_t runBenchmark(const char* name, Mode mode) {
+  std::unique_ptr<CatchupQueueBenchmark> bench;
+  BENCHMARK_SUSPEND {
+    benchStore();
+    bench = std::make_unique<CatchupQueueBenchmark>(mode);
+  }
+  const uint64_t cpu_start = threadCpuNs();
+  const size_t records = bench->run();
+  const uint64_t cpu_ns = threadCpuNs() - cpu_start;
+  BENCHMARK_SUSPEND {
+    ModeTotals& t = totals()[name];
+    t.records += records;
+    t.bytes += bench->bytesSent();
+    t.cpu_ns += cpu_ns;
+    bench.reset();
+  }
+  return records;
+}
+
+} // namespace
+
+}} // namespace facebook::logdevice
+
+BENCHMARK_MULTI(CatchupQueueFull) {
+  return runBenchmark("Full", Mode::FULL);
+}
+
+BENCHMARK_MULTI(CatchupQueueNoPayload) {
+  return runBenchmark("NoPayload", Mode::NO_PAYLOAD);
+}
+
+BENCHMARK_MULTI(CatchupQueueFilter) {
+  return runBenchmark("Filter", Mode::FILTER);
+}
+
+BENCHMARK_MULTI(CatchupQueueSCD) {
+  return runBenchmark("SCD", Mode::SCD);
+}
+
+#ifndef BENCHMARK_BUNDLE
+
+int main(int argc, char** argv) {
+  dbg::currentLevel = dbg::Level::ERROR;
+  folly::SingletonVault::singleton()->registrationComplete();
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  folly::runBenchmarks();
+  for (const auto& kv : totals()) {
+    const ModeTotals& t = kv.second;
+    printf("%-10s %12" PRIu64 " records %10.1f MB  %8.1f ns CPU/record  "
+           "%6.2f ns CPU/byte\n",
+           kv.first.c_str(),
+           t.records,
+           t.bytes / 1e6,
+           t.records ? double(t.cpu_ns) / t.records : 0.,
+           t.bytes ? double(t.cpu_ns) / t.bytes : 0.);
+  }
+  return 0;
+}
+#endif
@@ -26,7 +26,8 @@ const shard_index_t SHARD_IDX = 0;
 /**
  * @file: a benchmark for testing time spent on accessing LogStorageStateMap
  *        populated with different logids. The performance is directly related
- *        to the internal AtomicHashMap, and specifically, its hash function.
+ *        to the per-shard open addressing map, and specifically, its hash
+ *        function.
  */
 
 // range 1..100000
@@ -0,0 +1,130 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <gflags/gflags.h>
+#include <rocksdb/db.h>
+#include <rocksdb/memtablerep.h>
+
+#include "logdevice/common/debug.h"
+#include "logdevice/common/test/TestUtil.h"
+#include "logdevice/server/locallogstore/LogAppendMemTableRep.h"
+#include "logdevice/server/locallogstore/RocksDBKeyFormat.h"
+
+using namespace facebook::logdevice;
+using RocksDBKeyFormat::DataKey;
+
+/**
+ * @file: insert throughput of rocksdb's skiplist against LogAppendMemTableRep
+ *        for a LogsDB-like write pattern: appends to many logs with a skewed
+ *        (Zipf) distribution of appends per log, in lsn order within each log,
+ *        plus a fraction of out of order (rebuilding) stores. WAL is disabled
+ *        and the memtable is big enough to never flush, so the measurement is
+ *        dominated by the memtable.
+ */
+
+DEFINE_int32(num_logs, 10000, "Number of logs records are appended to.");
+DEFINE_double(zipf_exponent, 1.0, "Skew of the distribution of logs.");
+DEFINE_int32(payload_size, 200, "Size of record values.");
+DEFINE_double(rebuilding_fraction,
+              0.01,
+              "Fraction of records written out of lsn order.");
+
+namespace {
+
+// Precomputed keys, so that key generation isn't measured.
+std::vector<std::string> makeKeys(size_t n) {
+  std::mt19937_64 rng(0xfeed);
+  std::vector<double> cdf(FLAGS_num_logs);
+  double sum = 0;
+  for (int i = 0; i < FLAGS_num_logs; ++i) {
+    sum += 1.0 / std::pow(i + 1, FLAGS_zipf_exponent);
+    cdf[i] = sum;
+  }
+  std::uniform_real_distribution<double> uniform(0, sum);
+  std::uniform_real_distribution<double> coin(0, 1);
+  std::vector<lsn_t> next_lsn(FLAGS_num_logs, 1);
+
+  std::vector<std::string> keys;
+  keys.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    const size_t log =
+        std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin();
+    lsn_t lsn = next_lsn[log]++;
+    if (coin(rng) < FLAGS_rebuilding_fraction) {
+      lsn = 1 + rng() % lsn;
+    }
+    DataKey key(logid_t(log + 1), lsn);
+    keys.push_back(key.sliceForWriting().ToString());
+  }
+  return keys;
+}
+
+void runInserts(size_t iters,
+                std::shared_ptr<rocksdb::MemTableRepFactory> factory) {
+  std::unique_ptr<TemporaryDirectory> dir;
+  std::unique_ptr<rocksdb::DB> db;
+  std::vector<std::string> keys;
+  std::string value;
+  BENCHMARK_SUSPEND {
+    dir = std::make_unique<TemporaryDirectory>("MemTableRepBenchmark");
+    rocksdb::Options options;
+    options.create_if_missing = true;
+    options.memtable_factory = std::move(factory);
+    options.allow_concurrent_memtable_write =
+        options.memtable_factory->IsInsertConcurrentlySupported();
+    options.write_buffer_size = 16ul << 30;
+    rocksdb::DB* raw_db;
+    rocksdb::Status s =
+        rocksdb::DB::Open(options, dir->path().string(), &raw_db);
+    if (!s.ok()) {
+      ld_critical("Failed to open DB: %s", s.ToString().c_str());
+      std::abort();
+    }
+    db.reset(raw_db);
+    keys = makeKeys(iters);
+    value.assign(FLAGS_payload_size, 'x');
+  }
+
+  rocksdb::WriteOptions write_options;
+  write_options.disableWAL = true;
+  for (const std::string& key : keys) {
+    db->Put(write_options, key, value);
+  }
+
+  BENCHMARK_SUSPEND {
+    db.reset();
+    dir.reset();
+  }
+}
+
+} // namespace
+
+BENCHMARK(SkipListInsert, iters) {
+  runInserts(iters, std::make_shared<rocksdb::SkipListFactory>());
+}
+
+BENCHMARK_RELATIVE(LogAppendInsert, iters) {
+  runInserts(iters, std::make_shared<LogAppendMemTableRepFactory>());
+}
+
+BENCHMARK_DRAW_LINE();
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  gflags::SetCommandLineOptionWithMode(
+      "bm_min_iters", "1000000", gflags::SET_FLAG_IF_DEFAULT);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -0,0 +1,466 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <folly/String.h>
+#include <gflags/gflags.h>
+#include <rocksdb/statistics.h>
+
+#include "logdevice/common/ConstructorFailed.h"
+#include "logdevice/common/LocalLogStoreRecordFormat.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/settings/RebuildingSettings.h"
+#include "logdevice/common/settings/SettingsUpdater.h"
+#include "logdevice/common/stats/Histogram.h"
+#include "logdevice/server/locallogstore/PartitionedRocksDBStore.h"
+#include "logdevice/server/locallogstore/RocksDBCustomiser.h"
+#include "logdevice/server/locallogstore/RocksDBLogStoreConfig.h"
+#include "logdevice/server/locallogstore/RocksDBSettings.h"
+#include "logdevice/server/locallogstore/WriteOps.h"
+
+using namespace facebook::logdevice;
+using steady_clock = std::chrono::steady_clock;
+
+/**
+ * @file: standalone benchmark of PartitionedRocksDBStore write, read and
+ *        compaction paths, without the rest of the server. Writer threads
+ *        append records to LocalLogStore::writeMulti() in lsn order per log,
+ *        reader threads concurrently seek to random positions in random logs
+ *        and read batches with ReadIterator. At the end, the old partitions
+ *        can optionally be compacted manually. Reports throughput, p50/p99
+ *        latencies, and write amplification (bytes RocksDB wrote to WAL,
+ *        flushes and compactions per byte written by the benchmark).
+ *
+ *        Point --path to the device being evaluated and pass RocksDB
+ *        settings in --rocksdb_settings, e.g.
+ *          --path=/data/bench --duration=300 --rocksdb_settings=\
+ *          rocksdb-partition-duration=1min,rocksdb-compaction-style=universal
+ *        Partitions are created based on real time, so keep the partition
+ *        duration well below the benchmark duration.
+ */
+
+DEFINE_string(path,
+              "",
+              "Directory to create the store in, on the device being "
+              "evaluated. Must not exist or be empty.");
+DEFINE_bool(keep_data, false, "Don't delete the store when done.");
+DEFINE_string(rocksdb_settings,
+              "",
+              "Comma-separated list of name=value RocksDB settings, with the "
+              "same names as logdeviced options, e.g. "
+              "'rocksdb-partition-duration=1min,rocksdb-bytes-per-sync=1M'.");
+DEFINE_int32(duration, 60, "Seconds to write and read for.");
+DEFINE_int32(num_logs, 1000, "Number of logs records are written to.");
+DEFINE_int32(record_size, 1000, "Payload size of records in bytes.");
+DEFINE_int32(records_per_write, 1, "Records per writeMulti() call.");
+DEFINE_int32(writers, 4, "Number of writer threads.");
+DEFINE_double(write_rate,
+              0,
+              "Total records per second to write. 0 means as fast as "
+              "possible.");
+DEFINE_int32(readers, 4, "Number of concurrent reader threads.");
+DEFINE_int32(records_per_read,
+             100,
+             "Records each reader reads after seeking to a random position.");
+DEFINE_bool(compact,
+            true,
+            "Manually compact all partitions but the latest after writing, "
+            "and report compaction throughput.");
+DEFINE_int32(report_interval, 10, "Print progress every this many seconds.");
+
+namespace {
+
+const epoch_t EPOCH(1);
+
+// Latencies are in microseconds.
+struct ThreadStats {
+  std::unique_ptr<HistogramInterface> latency =
+      std::make_unique<SketchLatencyHistogram>();
+  uint64_t ops = 0;
+  uint64_t records = 0;
+  uint64_t bytes = 0;
+  uint64_t errors = 0;
+};
+
+struct Totals {
+  SketchLatencyHistogram latency;
+  uint64_t ops = 0;
+  uint64_t records = 0;
+  uint64_t bytes = 0;
+  uint64_t errors = 0;
+
+  explicit Totals(const std::vector<ThreadStats>& threads) {
+    for (const auto& t : threads) {
+      latency.merge(*t.latency);
+      ops += t.ops;
+      records += t.records;
+      bytes += t.bytes;
+      errors += t.errors;
+    }
+  }
+};
+
+class Benchmark {
+ public:
+  explicit Benchmark(std::unique_ptr<PartitionedRocksDBStore> store)
+      : store_(std::move(store)),
+        written_(FLAGS_num_logs),
+        writer_stats_(FLAGS_writers),
+        reader_stats_(FLAGS_readers) {}
+
+  void run();
+
+ private:
+  std::unique_ptr<PartitionedRocksDBStore> store_;
+  // Number of records written to each log, by 0-based log index. Records
+  // of a log have esns 1, 2, ... in EPOCH. Readers only read what has been
+  // written.
+  std::vector<std::atomic<uint32_t>> written_;
+  // Stats of each thread are only written by that thread. Totals are
+  // approximate while the threads are running.
+  std::vector<ThreadStats> writer_stats_;
+  std::vector<ThreadStats> reader_stats_;
+  std::atomic<bool> stop_{false};
+
+  void writerThread(int idx);
+  void readerThread(int idx);
+  void compact();
+  void report(const char* name,
+              const std::vector<ThreadStats>& threads,
+              double seconds);
+  uint64_t ticker(rocksdb::Tickers t) const {
+    return store_->getStatsTickerCount(t);
+  }
+};
+
+int64_t usecSince(steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             steady_clock::now() - start)
+      .count();
+}
+
+void Benchmark::writerThread(int idx) {
+  ThreadStats& stats = writer_stats_[idx];
+  std::mt19937_64 rng(idx);
+  // Each writer owns the logs with index equal to idx modulo the number of
+  // writers, so that records of each log are written in lsn order.
+  std::vector<int> logs;
+  for (int i = idx; i < FLAGS_num_logs; i += FLAGS_writers) {
+    logs.push_back(i);
+  }
+  if (logs.empty()) {
+    return;
+  }
+  const std::string payload(FLAGS_record_size, 'x');
+  const copyset_t copyset = {ShardID(1, 0), ShardID(2, 0), ShardID(3, 0)};
+  const LocalLogStoreRecordFormat::flags_t flags =
+      LocalLogStoreRecordFormat::FLAG_SHARD_ID |
+      LocalLogStoreRecordFormat::FLAG_CHECKSUM_PARITY;
+
+  const size_t batch = std::max(1, FLAGS_records_per_write);
+  std::vector<std::string> header_bufs(batch);
+  std::vector<std::string> csi_bufs(batch);
+  std::vector<PutWriteOp> ops;
+  std::vector<const WriteOp*> op_ptrs;
+  ops.reserve(batch);
+
+  std::chrono::duration<double> write_interval(0);
+  if (FLAGS_write_rate > 0) {
+    write_interval = std::chrono::duration<double>(
+        double(batch) * FLAGS_writers / FLAGS_write_rate);
+  }
+  auto next_write = steady_clock::now();
+
+  while (!stop_.load()) {
+    if (FLAGS_write_rate > 0) {
+      std::this_thread::sleep_until(next_write);
+      next_write += std::chrono::duration_cast<steady_clock::duration>(
+          write_interval);
+    }
+
+    ops.clear();
+    op_ptrs.clear();
+    // Number of records of each log in this batch.
+    std::unordered_map<int, uint32_t> batch_records;
+    const int64_t now_ms = RecordTimestamp::now().toMilliseconds().count();
+    for (size_t i = 0; i < batch; ++i) {
+      const int log = logs[rng() % logs.size()];
+      const uint32_t esn = written_[log].load() + ++batch_records[log];
+      Slice header = LocalLogStoreRecordFormat::formRecordHeader(
+          now_ms,
+          esn_t(0), // LNG
+          flags,
+          1, // wave
+          folly::Range<const ShardID*>(copyset.data(),
+                                       copyset.data() + copyset.size()),
+          OffsetMap::fromLegacy(0),
+          {}, // keys
+          &header_bufs[i]);
+      Slice csi_entry = LocalLogStoreRecordFormat::formCopySetIndexEntry(
+          1, // wave
+          copyset.data(),
+          copyset.size(),
+          LSN_INVALID, // block starting LSN
+          LocalLogStoreRecordFormat::formCopySetIndexFlags(flags),
+          &csi_bufs[i]);
+      ops.emplace_back(logid_t(log + 1),
+                       compose_lsn(EPOCH, esn_t(esn)),
+                       header,
+                       Slice::fromString(payload),
+                       node_index_t(1), // coordinator
+                       LSN_INVALID,     // block starting LSN
+                       csi_entry,
+                       std::vector<std::pair<char, std::string>>(),
+                       Durability::ASYNC_WRITE,
+                       false); // is_rebuilding
+      stats.bytes += header.size + payload.size();
+    }
+    for (const auto& op : ops) {
+      op_ptrs.push_back(&op);
+    }
+
+    auto start = steady_clock::now();
+    int rv = store_->writeMulti(op_ptrs);
+    stats.latency->add(usecSince(start));
+    ++stats.ops;
+    if (rv != 0) {
+      ++stats.errors;
+      continue;
+    }
+    stats.records += ops.size();
+    for (const auto& kv : batch_records) {
+      written_[kv.first].fetch_add(kv.second);
+    }
+  }
+}
+
+void Benchmark::readerThread(int idx) {
+  ThreadStats& stats = reader_stats_[idx];
+  std::mt19937_64 rng(FLAGS_writers + idx);
+  LocalLogStore::ReadOptions options("PartitionedRocksDBStoreBenchmark");
+
+  while (!stop_.load()) {
+    const int log = rng() % FLAGS_num_logs;
+    const uint32_t written = written_[log].load();
+    if (written == 0) {
+      std::this_thread::yield();
+      continue;
+    }
+    const lsn_t from = compose_lsn(EPOCH, esn_t(1 + rng() % written));
+
+    auto start = steady_clock::now();
+    auto it = store_->read(logid_t(log + 1), options);
+    it->seek(from);
+    for (int i = 0;
+         i < FLAGS_records_per_read && it->state() == IteratorState::AT_RECORD;
+         ++i) {
+      stats.bytes += it->getRecord().size;
+      ++stats.records;
+      it->next();
+    }
+    stats.latency->add(usecSince(start));
+    ++stats.ops;
+    if (it->state() == IteratorState::ERROR) {
+      ++stats.errors;
+    }
+  }
+}
+
+void Benchmark::compact() {
+  auto partitions = store_->getPartitionList();
+  if (partitions->size() < 2) {
+    printf("Only one partition, nothing to compact. Consider a lower "
+           "rocksdb-partition-duration.\n");
+    return;
+  }
+  const uint64_t read_before = ticker(rocksdb::COMPACT_READ_BYTES);
+  const uint64_t write_before = ticker(rocksdb::COMPACT_WRITE_BYTES);
+  SketchLatencyHistogram latency;
+  auto start = steady_clock::now();
+  // Compacting the latest partition would race with writes; a real server
+  // doesn't compact it either.
+  for (auto it = partitions->begin(); it + 1 != partitions->end(); ++it) {
+    auto partition_start = steady_clock::now();
+    store_->performCompaction((*it)->id_);
+    latency.add(usecSince(partition_start));
+  }
+  const double seconds = usecSince(start) / 1e6;
+  const uint64_t read_bytes = ticker(rocksdb::COMPACT_READ_BYTES) - read_before;
+  const uint64_t write_bytes =
+      ticker(rocksdb::COMPACT_WRITE_BYTES) - write_before;
+  printf("compaction: %zu partitions in %.1fs, %.1f MB/s read, %.1f MB/s "
+         "written, per partition p50 %.1fms p99 %.1fms\n",
+         partitions->size() - 1,
+         seconds,
+         read_bytes / 1e6 / seconds,
+         write_bytes / 1e6 / seconds,
+         latency.estimatePercentile(.5) / 1e3,
+         latency.estimatePercentile(.99) / 1e3);
+}
+
+void Benchmark::report(const char* name,
+                       const std::vector<ThreadStats>& threads,
+                       double seconds) {
+  Totals t(threads);
+  printf("%s: %.0f ops/s, %.0f records/s, %.1f MB/s, latency p50 %" PRId64
+         "us p99 %" PRId64 "us max %" PRId64 "us, %" PRIu64 " errors\n",
+         name,
+         t.ops / seconds,
+         t.records / seconds,
+         t.bytes / 1e6 / seconds,
+         t.latency.estimatePercentile(.5),
+         t.latency.estimatePercentile(.99),
+         t.latency.estimatePercentile(1.),
+         t.errors);
+}
+
+void Benchmark::run() {
+  std::vector<std::thread> threads;
+  auto start = steady_clock::now();
+  for (int i = 0; i < FLAGS_writers; ++i) {
+    threads.emplace_back([this, i] { writerThread(i); });
+  }
+  for (int i = 0; i < FLAGS_readers; ++i) {
+    threads.emplace_back([this, i] { readerThread(i); });
+  }
+
+  const auto end = start + std::chrono::seconds(FLAGS_duration);
+  const auto interval =
+      std::chrono::seconds(std::max(1, FLAGS_report_interval));
+  for (auto next = start + interval; next < end; next += interval) {
+    std::this_thread::sleep_until(next);
+    const double seconds = usecSince(start) / 1e6;
+    printf("[%.0fs] %zu partitions\n",
+           seconds,
+           store_->getPartitionList()->size());
+    report("  write", writer_stats_, seconds);
+    report("  read", reader_stats_, seconds);
+  }
+  std::this_thread::sleep_until(end);
+  stop_.store(true);
+  for (auto& t : threads) {
+    t.join();
+  }
+  const double seconds = usecSince(start) / 1e6;
+
+  // Flush so that write amplification includes the data still in memtables.
+  store_->flushAllMemtables(/* wait */ true);
+
+  printf("\nAfter %.1fs, %zu partitions:\n",
+         seconds,
+         store_->getPartitionList()->size());
+  report("write", writer_stats_, seconds);
+  report("read", reader_stats_, seconds);
+
+  if (FLAGS_compact) {
+    compact();
+  }
+
+  const uint64_t user_bytes = Totals(writer_stats_).bytes;
+  const uint64_t wal_bytes = ticker(rocksdb::WAL_FILE_BYTES);
+  const uint64_t flush_bytes = ticker(rocksdb::FLUSH_WRITE_BYTES);
+  const uint64_t compaction_bytes = ticker(rocksdb::COMPACT_WRITE_BYTES);
+  printf("write amplification: %.2f (%.1f MB of records; %.1f MB WAL, "
+         "%.1f MB flushed, %.1f MB compacted)\n",
+         user_bytes
+             ? double(wal_bytes + flush_bytes + compaction_bytes) / user_bytes
+             : 0.,
+         user_bytes / 1e6,
+         wal_bytes / 1e6,
+         flush_bytes / 1e6,
+         compaction_bytes / 1e6);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  gflags::SetUsageMessage("Benchmark of PartitionedRocksDBStore on a device");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  dbg::currentLevel = dbg::Level::WARNING;
+
+  if (FLAGS_path.empty() || FLAGS_num_logs <= 0 || FLAGS_writers < 0 ||
+      FLAGS_readers < 0) {
+    fprintf(stderr, "--path, --num_logs > 0 and --writers/--readers >= 0 "
+                    "are required\n");
+    return 1;
+  }
+  boost::system::error_code ec;
+  if (boost::filesystem::exists(FLAGS_path, ec) &&
+      !boost::filesystem::is_empty(FLAGS_path, ec)) {
+    fprintf(stderr, "%s is not empty\n", FLAGS_path.c_str());
+    return 1;
+  }
+
+  UpdateableSettings<RocksDBSettings> rocksdb_settings;
+  UpdateableSettings<RebuildingSettings> rebuilding_settings;
+  SettingsUpdater settings_updater;
+  settings_updater.registerSettings(rocksdb_settings);
+  std::unordered_map<std::string, std::string> settings = {
+      // Needed for write amplification.
+      {"rocksdb-enable-statistics", "true"},
+  };
+  std::vector<folly::StringPiece> pairs;
+  folly::split(',', FLAGS_rocksdb_settings, pairs, /* ignoreEmpty */ true);
+  for (auto pair : pairs) {
+    folly::StringPiece name, value;
+    if (!folly::split('=', pair, name, value)) {
+      fprintf(stderr,
+              "Invalid setting '%s' in --rocksdb_settings, expected "
+              "name=value\n",
+              pair.str().c_str());
+      return 1;
+    }
+    settings[name.str()] = value.str();
+  }
+  try {
+    settings_updater.setFromCLI(settings);
+  } catch (const boost::program_options::error&) {
+    // The error was logged.
+    return 1;
+  }
+
+  RocksDBLogStoreConfig rocksdb_config(rocksdb_settings,
+                                       rebuilding_settings,
+                                       /* env */ nullptr,
+                                       /* updateable_config */ nullptr,
+                                       /* stats */ nullptr);
+  rocksdb_config.createMergeOperator(0);
+
+  std::unique_ptr<PartitionedRocksDBStore> store;
+  try {
+    store = std::make_unique<PartitionedRocksDBStore>(
+        0, // shard_idx
+        1, // num_shards
+        FLAGS_path,
+        std::move(rocksdb_config),
+        /* config */ nullptr,
+        RocksDBCustomiser::defaultInstance(),
+        /* stats */ nullptr,
+        /* io_tracing */ nullptr);
+  } catch (const ConstructorFailed&) {
+    fprintf(stderr, "Failed to open store in %s\n", FLAGS_path.c_str());
+    return 1;
+  }
+
+  Benchmark(std::move(store)).run();
+
+  if (!FLAGS_keep_data) {
+    boost::filesystem::remove_all(FLAGS_path, ec);
+  }
+  return 0;
+}
@@ -0,0 +1,119 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <folly/Benchmark.h>
+#include <gflags/gflags.h>
+
+#include "logdevice/common/Semaphore.h"
+#include "logdevice/server/storage_tasks/PrioritizedQueue.h"
+
+using namespace facebook::logdevice;
+
+/**
+ * @file: compares the storage task queue used by StorageThreadPool with
+ *        different semaphores. Producers play the role of workers calling
+ *        tryPutTask(), consumers the role of storage threads blocked in
+ *        blockingGetTask().
+ */
+
+DEFINE_int32(num_producers, 16, "Number of threads writing to the queue.");
+DEFINE_int32(num_consumers, 32, "Number of threads reading from the queue.");
+
+namespace {
+
+constexpr size_t NUM_PRIORITIES = 3;
+
+struct FakeTask {
+  size_t priority;
+  size_t getPriority() const {
+    return priority;
+  }
+  size_t getPayloadSize() const {
+    return 0;
+  }
+};
+
+template <class Sem>
+void runQueue(size_t iters) {
+  using Queue = PrioritizedQueue<FakeTask*, NUM_PRIORITIES, Sem>;
+  std::unique_ptr<Queue> queue;
+  std::vector<FakeTask> tasks;
+  BENCHMARK_SUSPEND {
+    queue = std::make_unique<Queue>(10000, /*stats=*/nullptr);
+    for (size_t i = 0; i < NUM_PRIORITIES; ++i) {
+      tasks.push_back(FakeTask{i});
+    }
+  }
+
+  const size_t per_producer = std::max<size_t>(iters / FLAGS_num_producers, 1);
+  const size_t total = per_producer * FLAGS_num_producers;
+  std::atomic<size_t> consumed{0};
+  // Consumers exit when they read this one.
+  FakeTask stop_task{NUM_PRIORITIES - 1};
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < FLAGS_num_consumers; ++i) {
+    threads.emplace_back([&] {
+      FakeTask* task;
+      while (true) {
+        queue->blockingRead(task);
+        if (task == &stop_task) {
+          return;
+        }
+        folly::doNotOptimizeAway(task->getPriority());
+        consumed.fetch_add(1, std::memory_order_relaxed);
+      }
+    });
+  }
+  for (int i = 0; i < FLAGS_num_producers; ++i) {
+    threads.emplace_back([&, i] {
+      for (size_t j = 0; j < per_producer; ++j) {
+        queue->blockingWrite(&tasks[(i + j) % NUM_PRIORITIES]);
+      }
+    });
+  }
+
+  // Wait for producers, then stop consumers once everything is consumed.
+  for (int i = 0; i < FLAGS_num_producers; ++i) {
+    threads[FLAGS_num_consumers + i].join();
+  }
+  while (consumed.load() < total) {
+    std::this_thread::yield();
+  }
+  for (int i = 0; i < FLAGS_num_consumers; ++i) {
+    queue->blockingWrite(&stop_task);
+  }
+  for (int i = 0; i < FLAGS_num_consumers; ++i) {
+    threads[i].join();
+  }
+}
+
+} // namespace
+
+BENCHMARK(PrioritizedQueuePosixSemaphore, iters) {
+  runQueue<Semaphore>(iters);
+}
+
+BENCHMARK_RELATIVE(PrioritizedQueueLifoSemaphore, iters) {
+  runQueue<detail::LifoSemaphore>(iters);
+}
+
+BENCHMARK_DRAW_LINE();
+
+int main(int argc, char* argv[]) {
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  gflags::SetCommandLineOptionWithMode(
+      "bm_min_iters", "1000000", gflags::SET_FLAG_IF_DEFAULT);
+  folly::runBenchmarks();
+  return 0;
+}
@@ -1033,8 +1033,65 @@ TEST_F(AppendIntegrationTest, WriteLsnAfterTrimPoint) {
   ASSERT_EQ(-1, nread);
 }
 
-// Returns the number of successful writes
-static int hammer_client_with_writes(Client& client,
+// With --chain-sending-cut-through, storage nodes forward chain-sent STOREs
+// before processing them locally. Records should still be fully replicated.
+TEST_F(AppendIntegrationTest, ChainSendingCutThrough) {
+  const int NUM_NODES = 4;
+  const logid_t LOG_ID(1);
+  const int NUM_RECORDS = 50;
+
+  auto cluster_factory = IntegrationTestUtils::ClusterFactory();
+  cluster_factory.setParam("--chain-sending-cut-through",
+                           "true",
+                           IntegrationTestUtils::ParamScope::STORAGE_NODE);
+  auto log_attrs = cluster_factory.createDefaultLogAttributes(NUM_NODES)
+                       .with_replicationFactor(3);
+  cluster_factory.setLogAttributes(log_attrs);
+  auto cluster = cluster_factory.create(NUM_NODES);
+
+  std::shared_ptr<Client> client = cluster->createClient();
+  ASSERT_TRUE((bool)client);
+
+  // Large enough for the sequencer to chain-send.
+  std::string data(4096, 'x');
+  lsn_t first_lsn = LSN_INVALID;
+  lsn_t last_lsn = LSN_INVALID;
+  for (int i = 0; i < NUM_RECORDS; ++i) {
+    lsn_t lsn = client->appendSync(LOG_ID, Payload(data.data(), data.size()));
+    ASSERT_NE(LSN_INVALID, lsn);
+    if (first_lsn == LSN_INVALID) {
+      first_lsn = lsn;
+    }
+    last_lsn = lsn;
+  }
+
+  int64_t forwarded = 0;
+  for (auto& it : cluster->getNodes()) {
+    forwarded += it.second->stats()["store_forwarded_cut_through"];
+  }
+  EXPECT_GT(forwarded, 0);
+
+  auto reader = client->createReader(1);
+  reader->setTimeout(std::chrono::seconds(5));
+  ASSERT_EQ(0, reader->startReading(LOG_ID, first_lsn, last_lsn));
+  std::vector<std::unique_ptr<DataRecord>> records;
+  GapRecord gap;
+  int nread = 0;
+  while (reader->isReading(LOG_ID)) {
+    records.clear();
+    ssize_t n = reader->read(NUM_RECORDS, &records, &gap);
+    if (n == 0) {
+      // timed out
+      break;
+    }
+    if (n > 0) {
+      nread += n;
+    }
+  }
+  EXPECT_EQ(NUM_RECORDS, nread);
+}
+
+Client& client,
                                      const int NAPPENDS,
                                      const int PAYLOAD_SIZE,
                                      const int NTHREADS) {
@@ -915,9 +915,7 @@ TEST_P(ReadingIntegrationTest, PayloadHashOnly) {
   ASSERT_EQ(lsn2 + 1, lsn3);
 
   std::unique_ptr<Reader> reader = client->createReader(1);
-  auto reader_impl = dynamic_cast<ReaderImpl*>(reader.get());
-  ASSERT_NE(nullptr, reader_impl);
-  reader_impl->payloadHashOnly();
+  reader->payloadHashOnly();
   ASSERT_EQ(0, reader->startReading(LOG_ID, 1));
 
   std::vector<std::unique_ptr<DataRecord>> recs;
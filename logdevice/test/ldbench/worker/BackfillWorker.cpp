@@ -162,6 +162,7 @@ int BackfillWorker::run() {
 
   // Clear append token bucket.
   token_bucket_.reset(token_bucket_.defaultClockNow());
+  resetSchedule();
 
   // Callback for use with Client::append.
   append_callback_t append_cb([this](Status status, const DataRecord& record) {
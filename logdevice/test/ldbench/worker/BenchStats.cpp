@@ -8,11 +8,27 @@
 
 #include "logdevice/test/ldbench/worker/BenchStats.h"
 
+#include <cmath>
 #include <functional>
 #include <iostream>
 
+#include <folly/Format.h>
+
 namespace facebook { namespace logdevice { namespace ldbench {
 
+const char* latencyTypeName(LatencyType type) {
+  switch (type) {
+    case LatencyType::APPEND:
+      return "append_lat_us";
+    case LatencyType::APPEND_FROM_INTENDED_START:
+      return "append_intended_lat_us";
+    case LatencyType::MAX:
+      break;
+  }
+  ld_check(false);
+  return "unknown";
+}
+
 BenchStats::BenchStats(const std::string& type)
     : success_(0),
       success_byte_(0),
@@ -59,12 +75,26 @@ void BenchStats::incStat(StatsType attr, int64_t num) {
   }
 }
 
+void BenchStats::addLatency(LatencyType type,
+                            std::chrono::microseconds latency) {
+  latency_[static_cast<size_t>(type)].add(
+      std::max<int64_t>(latency.count(), 0));
+}
+
+const SketchLatencyHistogram&
+BenchStats::getLatencyHistogram(LatencyType type) const {
+  return latency_[static_cast<size_t>(type)];
+}
+
 void BenchStats::aggregate(const BenchStats& stats) {
   success_ += stats.getAttr(StatsType::SUCCESS);
   success_byte_ += stats.getAttr(StatsType::SUCCESS_BYTE);
   failure_ += stats.getAttr(StatsType::FAILURE);
   skipped_ += stats.getAttr(StatsType::SKIPPED);
   in_flight_ += stats.getAttr(StatsType::INFLIGHT);
+  for (size_t i = 0; i < latency_.size(); ++i) {
+    latency_[i].merge(stats.latency_[i]);
+  }
   return;
 }
 
@@ -82,9 +112,29 @@ folly::dynamic BenchStats::collectStatsAsPairs() {
   stats_res["fail"] = failure_.load();
   stats_res["skipped"] = skipped_.load();
   stats_res["inflight"] = in_flight_.load();
+  for (size_t i = 0; i < latency_.size(); ++i) {
+    addLatencyPercentiles(stats_res, static_cast<LatencyType>(i), latency_[i]);
+  }
   return stats_res;
 }
 
+void BenchStats::addLatencyPercentiles(folly::dynamic& out,
+                                       LatencyType type,
+                                       const HistogramInterface& hist) {
+  static const double percentiles[] = {.5, .9, .99, .999, .9999, 1.};
+  static const char* suffixes[] = {
+      "_p50", "_p90", "_p99", "_p999", "_p9999", "_max"};
+  constexpr size_t n = sizeof(percentiles) / sizeof(percentiles[0]);
+  int64_t samples[n];
+  uint64_t count;
+  hist.estimatePercentiles(percentiles, n, samples, &count);
+  const std::string name = latencyTypeName(type);
+  out[name + "_count"] = count;
+  for (size_t i = 0; i < n; ++i) {
+    out[name + suffixes[i]] = samples[i];
+  }
+}
+
 BenchStats* BenchStatsHolder::getOrCreateTLStats() {
   BenchStatsWrapper* bench_stat_wrapper = bench_thread_stats_.get();
   if (!bench_stat_wrapper) {
@@ -102,16 +152,79 @@ void BenchStatsHolder::displayAllForDebug() {
   };
 }
 
+void BenchStatsHolder::aggregateAll(BenchStats& result) {
+  std::lock_guard<std::mutex> lock(aggregated_stats_mutex_);
+  result.aggregate(aggregated_stats_);
+  for (auto& x : bench_thread_stats_.accessAllThreads()) {
+    result.aggregate(x.stats_);
+  }
+}
+
 folly::dynamic BenchStatsHolder::aggregateAllStats() {
   BenchStats result(name_);
-  {
-    std::lock_guard<std::mutex> lock(aggregated_stats_mutex_);
-    result.aggregate(aggregated_stats_);
-    for (auto& x : bench_thread_stats_.accessAllThreads()) {
-      result.aggregate(x.stats_);
+  aggregateAll(result);
+  return result.collectStatsAsPairs();
+}
+
+folly::dynamic BenchStatsHolder::aggregateIntervalStats() {
+  BenchStats result(name_);
+  aggregateAll(result);
+  folly::dynamic res = result.collectStatsAsPairs();
+  std::lock_guard<std::mutex> lock(aggregated_stats_mutex_);
+  for (size_t i = 0; i < last_interval_latency_.size(); ++i) {
+    auto type = static_cast<LatencyType>(i);
+    SketchLatencyHistogram interval(result.getLatencyHistogram(type));
+    interval.subtract(last_interval_latency_[i]);
+    BenchStats::addLatencyPercentiles(res, type, interval);
+    last_interval_latency_[i].assign(result.getLatencyHistogram(type));
+  }
+  return res;
+}
+
+void BenchStatsHolder::writeLatencyPercentileDistribution(LatencyType type,
+                                                          std::ostream& out) {
+  BenchStats result(name_);
+  aggregateAll(result);
+  const auto& hist = result.getLatencyHistogram(type);
+
+  // Same percentiles as HdrHistogram with 5 ticks per half distance: 5 steps
+  // from 0 to 50%, 5 from 50% to 75%, and so on, up to the last value.
+  std::vector<double> percentiles;
+  for (double half = .5; half * 2 >= 1e-6; half /= 2) {
+    double base = 1 - half * 2;
+    for (int tick = 0; tick < 5; ++tick) {
+      percentiles.push_back(base + half * tick / 5);
     }
   }
-  return result.collectStatsAsPairs();
+  percentiles.push_back(1.);
+  std::vector<int64_t> samples(percentiles.size());
+  uint64_t count;
+  int64_t sum;
+  hist.estimatePercentiles(
+      percentiles.data(), percentiles.size(), samples.data(), &count, &sum);
+
+  out << folly::sformat("{:>12} {:>14} {:>10} {:>14}\n\n",
+                        "Value",
+                        "Percentile",
+                        "TotalCount",
+                        "1/(1-Percentile)");
+  for (size_t i = 0; i < percentiles.size() && count > 0; ++i) {
+    double p = percentiles[i];
+    out << folly::sformat("{:12.3f} {:14.12f} {:10d}",
+                          samples[i] / 1000.,
+                          p,
+                          uint64_t(std::llround(p * count)));
+    if (p < 1) {
+      out << folly::sformat(" {:14.2f}", 1 / (1 - p));
+    }
+    out << '\n';
+  }
+  out << folly::sformat(
+      "#[Mean    = {:12.3f}, Max            = {:12.3f}]\n"
+      "#[Total count    = {:12d}]\n",
+      count ? sum / 1000. / count : 0.,
+      count ? samples.back() / 1000. : 0.,
+      count);
 }
 
 BenchStatsCollectionThread::BenchStatsCollectionThread(
@@ -137,7 +250,7 @@ BenchStatsCollectionThread::~BenchStatsCollectionThread() {
 }
 
 void BenchStatsCollectionThread::statsCollectionFunction() {
-  auto cur_stats = stats_source_->aggregateAllStats();
+  auto cur_stats = stats_source_->aggregateIntervalStats();
   cur_stats["timestamp"] =
       std::chrono::system_clock::now().time_since_epoch().count();
   stats_store_->writeCurrentStats(cur_stats);
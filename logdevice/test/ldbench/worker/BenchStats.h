@@ -8,19 +8,37 @@
 
 #pragma once
 
+#include <array>
 #include <chrono>
+#include <ostream>
 
 #include <folly/ThreadLocal.h>
 #include <folly/dynamic.h>
 #include <folly/experimental/FunctionScheduler.h>
 
 #include "logdevice/common/checks.h"
+#include "logdevice/common/stats/Histogram.h"
 #include "logdevice/test/ldbench/worker/StatsStore.h"
 
 namespace facebook { namespace logdevice { namespace ldbench {
 
 enum class StatsType { SUCCESS, SUCCESS_BYTE, FAILURE, INFLIGHT, SKIPPED };
 
+enum class LatencyType {
+  // From when the append was sent to its callback.
+  APPEND,
+  // From when the workload meant to send the append, according to its target
+  // rate, to its callback. Unlike APPEND, this includes the time the append
+  // waited behind stalled appends, so stalls aren't underreported
+  // (coordinated omission).
+  APPEND_FROM_INTENDED_START,
+
+  MAX,
+};
+
+// Prefix of the stats of a LatencyType, e.g. "append_lat_us".
+const char* latencyTypeName(LatencyType type);
+
 /**
  * BenchStats defines the stats content and provides access/update operations
  * It will be a thread-local object and managed by BenchStatsHolder
@@ -41,6 +59,13 @@ class BenchStats {
    */
   void incStat(StatsType attr, int64_t num);
 
+  /**
+   * Record a latency sample.
+   */
+  void addLatency(LatencyType type, std::chrono::microseconds latency);
+
+  const SketchLatencyHistogram& getLatencyHistogram(LatencyType type) const;
+
   /**
    * Aggregate its own attributes with another BenchStats object
    */
@@ -53,10 +78,19 @@ class BenchStats {
   void display() const;
 
   /**
-   * Convert current stats content to key-value pairs using dynamic object
+   * Convert current stats content to key-value pairs using dynamic object.
+   * Latencies are reported as percentiles, see addLatencyPercentiles().
    */
   folly::dynamic collectStatsAsPairs();
 
+  /**
+   * Adds "<name>_count", "<name>_p50", ..., "<name>_p9999" and "<name>_max"
+   * of `hist` to `out`, where name is latencyTypeName(type).
+   */
+  static void addLatencyPercentiles(folly::dynamic& out,
+                                    LatencyType type,
+                                    const HistogramInterface& hist);
+
  private:
   // Define stats attributes
   std::atomic<int64_t> success_;      // total number of successful records
@@ -65,6 +99,8 @@ class BenchStats {
   std::atomic<int64_t> failure_;      // total number of failed records
   std::atomic<int64_t> skipped_;      // total number of skipped records
   std::string type_;                  // request types for different workloads
+  std::array<SketchLatencyHistogram, static_cast<size_t>(LatencyType::MAX)>
+      latency_;
 };
 
 /**
@@ -95,6 +131,21 @@ class BenchStatsHolder {
    */
   folly::dynamic aggregateAllStats();
 
+  /**
+   * Like aggregateAllStats(), but latency percentiles only cover the
+   * latencies recorded since the previous call, so that they can be
+   * published as a time series. Counters are still cumulative.
+   */
+  folly::dynamic aggregateIntervalStats();
+
+  /**
+   * Writes the distribution of all latencies of `type` recorded so far in the
+   * text format of HdrHistogram's outputPercentileDistribution(), in
+   * milliseconds, which HdrHistogram's plotting tools accept.
+   */
+  void writeLatencyPercentileDistribution(LatencyType type,
+                                          std::ostream& out);
+
   /**
    * Display every local BenchStats
    * This is a debug function
@@ -113,6 +164,9 @@ class BenchStatsHolder {
     aggregated_stats_.aggregate(stats);
   }
 
+  // Aggregates the stats of all threads into `result`.
+  void aggregateAll(BenchStats& result);
+
   struct Tag;
   struct BenchStatsWrapper;
   // store BenchStats to be reclaimed
@@ -125,6 +179,11 @@ class BenchStatsHolder {
 
   folly::ThreadLocalPtr<BenchStatsWrapper, Tag> bench_thread_stats_;
 
+  // Latencies as of the last aggregateIntervalStats() call. Protected by
+  // aggregated_stats_mutex_.
+  std::array<SketchLatencyHistogram, static_cast<size_t>(LatencyType::MAX)>
+      last_interval_latency_;
+
   std::string name_; // request type: append_sync, append_async ...
 };
 
@@ -7,6 +7,7 @@
  */
 
 #include <cstdio>
+#include <sstream>
 
 #include <folly/dynamic.h>
 #include <folly/json.h>
@@ -73,4 +74,51 @@ TEST_F(BenchStatsHolderTest, collectionThreadTest) {
   EXPECT_EQ(stats_obj["success"].asInt(), 30);
   std::remove(tmp_file_name.c_str());
 }
+
+TEST_F(BenchStatsHolderTest, intervalLatencyTest) {
+  auto add = [&](LatencyType type, std::chrono::microseconds latency) {
+    std::thread([&] {
+      bench_stats_holder->getOrCreateTLStats()->addLatency(type, latency);
+    }).join();
+  };
+  add(LatencyType::APPEND, std::chrono::milliseconds(1));
+  add(LatencyType::APPEND_FROM_INTENDED_START, std::chrono::seconds(1));
+
+  folly::dynamic stats_obj = bench_stats_holder->aggregateIntervalStats();
+  EXPECT_EQ(1, stats_obj["append_lat_us_count"].asInt());
+  EXPECT_NEAR(1000, stats_obj["append_lat_us_max"].asInt(), 50);
+  EXPECT_EQ(1, stats_obj["append_intended_lat_us_count"].asInt());
+  EXPECT_NEAR(1000000, stats_obj["append_intended_lat_us_p50"].asInt(), 50000);
+
+  // The next interval only has the new samples.
+  add(LatencyType::APPEND, std::chrono::milliseconds(100));
+  stats_obj = bench_stats_holder->aggregateIntervalStats();
+  EXPECT_EQ(1, stats_obj["append_lat_us_count"].asInt());
+  EXPECT_NEAR(100000, stats_obj["append_lat_us_p50"].asInt(), 5000);
+  EXPECT_EQ(0, stats_obj["append_intended_lat_us_count"].asInt());
+
+  // Cumulative stats have all of them.
+  stats_obj = bench_stats_holder->aggregateAllStats();
+  EXPECT_EQ(2, stats_obj["append_lat_us_count"].asInt());
+
+  std::stringstream ss;
+  bench_stats_holder->writeLatencyPercentileDistribution(
+      LatencyType::APPEND, ss);
+  std::string line;
+  std::getline(ss, line);
+  EXPECT_NE(std::string::npos, line.find("Percentile"));
+  std::string last_value_line;
+  while (std::getline(ss, line)) {
+    if (!line.empty() && line[0] != '#') {
+      last_value_line = line;
+    }
+  }
+  // The last line is the max, in ms, at the 100th percentile.
+  double value, percentile;
+  uint64_t total_count;
+  std::istringstream(last_value_line) >> value >> percentile >> total_count;
+  EXPECT_NEAR(100, value, 5);
+  EXPECT_EQ(1.0, percentile);
+  EXPECT_EQ(2, total_count);
+}
 }}} // namespace facebook::logdevice::ldbench
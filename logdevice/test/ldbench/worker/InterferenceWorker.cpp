@@ -0,0 +1,489 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <folly/Random.h>
+#include <folly/hash/Hash.h>
+
+#include "logdevice/common/LibeventTimer.h"
+#include "logdevice/common/Timestamp.h"
+#include "logdevice/common/debug.h"
+#include "logdevice/common/stats/Histogram.h"
+#include "logdevice/include/AsyncReader.h"
+#include "logdevice/include/Client.h"
+#include "logdevice/include/Err.h"
+#include "logdevice/include/Record.h"
+#include "logdevice/include/types.h"
+#include "logdevice/test/ldbench/worker/MetaRequestWorker.h"
+#include "logdevice/test/ldbench/worker/Options.h"
+#include "logdevice/test/ldbench/worker/WorkerRegistry.h"
+
+namespace facebook { namespace logdevice { namespace ldbench {
+namespace {
+
+static constexpr const char* BENCH_NAME = "interference";
+
+/**
+ * Multi-tenant interference benchmark worker.
+ *
+ * Splits the logs in two. A fraction of them (--interference-latency-log-
+ * fraction) gets a latency-sensitive workload: appends at --write-rate while
+ * tailing the same logs, measuring append-to-read latency. The rest of the
+ * logs are the target of the aggressors: backfill scans, rebuilding-like
+ * scans (no single copy delivery, so every copy of every record is shipped
+ * to the reader, like rebuilding does between storage nodes), and findTime
+ * requests.
+ *
+ * The latency-sensitive workload first runs alone for
+ * --interference-baseline-duration seconds, then together with the aggressors
+ * for --duration seconds. Prints the latency percentiles of both phases and
+ * how much each degraded.
+ */
+class InterferenceWorker final : public MetaRequestWorker {
+ public:
+  using MetaRequestWorker::MetaRequestWorker;
+  ~InterferenceWorker() override;
+  int run() override;
+
+ protected:
+  int makeMetadataAPIRequest(LogState* state) override;
+  void printProgress(double seconds_since_start,
+                     double seconds_since_last_call) override;
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  enum Phase : uint8_t { BASELINE = 0, INTERFERENCE = 1, NONE = 2 };
+
+  struct PayloadHeader {
+    static constexpr uint64_t MAGIC = 0x1DBE1F7E00000001;
+    uint64_t magic;
+    uint64_t worker_id : 56;
+    uint8_t phase : 8;
+    int64_t intended_time_ns;
+  };
+
+  // One AsyncReader repeatedly scanning a subset of the bulk logs.
+  struct Scan {
+    std::unique_ptr<AsyncReader> reader;
+    LogToLsnMap until_lsns;
+  };
+
+  void scheduleNextAppend();
+  void doAppend();
+  void appendCallback(Status st, const DataRecord& record);
+  void onLatencyRecord(const DataRecord& record);
+
+  bool startScans(const std::vector<logid_t>& logs,
+                  const LogToLsnMap& tail_lsns,
+                  bool no_single_copy_delivery);
+  void restartScan(size_t scan_idx, logid_t log);
+  void stopScans();
+
+  void printResult(std::chrono::milliseconds baseline_duration,
+                   std::chrono::milliseconds interference_duration);
+
+  const uint64_t worker_id_ = folly::Random::rand64() >> 8;
+
+  std::vector<logid_t> latency_logs_;
+  double appends_per_sec_ = 0;
+  Clock::time_point next_append_time_;
+  LibeventTimer append_timer_;
+
+  std::atomic<Phase> phase_{NONE};
+  std::array<SketchLatencyHistogram, 2> latency_us_;
+  std::atomic<uint64_t> appends_in_flight_{0};
+  std::atomic<uint64_t> appends_failed_{0};
+  std::atomic<uint64_t> appends_skipped_{0};
+
+  // Accessed only on ev_ thread.
+  std::vector<Scan> scans_;
+  bool scanning_ = false;
+  std::atomic<uint64_t> scanned_records_{0};
+  std::atomic<uint64_t> scanned_bytes_{0};
+  std::atomic<uint64_t> scan_restart_failures_{0};
+};
+
+InterferenceWorker::~InterferenceWorker() {
+  // AsyncReaders must be gone before the Client.
+  stopScans();
+  // Make sure no callbacks are called after this subclass is destroyed.
+  destroyClient();
+}
+
+int InterferenceWorker::makeMetadataAPIRequest(LogState* state) {
+  // Look up a random point in the last hour, which mostly lands in old
+  // partitions, like a consumer picking a replay position.
+  std::chrono::milliseconds timestamp =
+      RecordTimestamp::now().toMilliseconds() -
+      std::chrono::milliseconds(folly::Random::rand64(3600 * 1000));
+  return findTime(state->log_id, timestamp, [this](Status st, lsn_t) {
+    onRequestDone(st == E::OK);
+  });
+}
+
+void InterferenceWorker::scheduleNextAppend() {
+  // Poisson process, see doc/ldbench.md.
+  double x = folly::Random::randDouble01();
+  next_append_time_ += std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(-std::log1p(-x) / appends_per_sec_));
+  auto delay =
+      std::max(Clock::duration::zero(), next_append_time_ - Clock::now());
+  append_timer_.activate(
+      std::chrono::duration_cast<std::chrono::microseconds>(delay));
+}
+
+void InterferenceWorker::doAppend() {
+  // Measure from the scheduled time rather than from now, so that appends
+  // held back by a stall still count the stall (coordinated omission).
+  Clock::time_point intended_time = next_append_time_;
+  scheduleNextAppend();
+
+  if (appends_in_flight_.load() >= options.max_appends_in_flight) {
+    ++appends_skipped_;
+    return;
+  }
+
+  static_assert(
+      sizeof(PayloadHeader) == 24, "Unexpected padding of PayloadHeader");
+  PayloadHeader header;
+  header.magic = PayloadHeader::MAGIC;
+  header.worker_id = worker_id_;
+  header.phase = phase_.load();
+  header.intended_time_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          intended_time.time_since_epoch())
+          .count();
+  std::string payload(reinterpret_cast<char*>(&header), sizeof(header));
+  if (options.payload_size > sizeof(header)) {
+    payload.append(generatePayload(options.payload_size - sizeof(header)));
+  }
+
+  logid_t log = latency_logs_[folly::Random::rand64(latency_logs_.size())];
+  ++appends_in_flight_;
+  if (tryAppend(log,
+                std::move(payload),
+                [this](Status st, const DataRecord& record) {
+                  appendCallback(st, record);
+                })) {
+    --appends_in_flight_;
+    ++appends_failed_;
+  }
+}
+
+void InterferenceWorker::appendCallback(Status st, const DataRecord& record) {
+  --appends_in_flight_;
+  if (st != E::OK) {
+    ++appends_failed_;
+    RATELIMIT_WARNING(std::chrono::seconds(1),
+                      1,
+                      "Append failed: %s",
+                      error_description(st));
+    return;
+  }
+  if (options.pretend) {
+    // There is no reader.
+    onLatencyRecord(record);
+  }
+}
+
+void InterferenceWorker::onLatencyRecord(const DataRecord& record) {
+  if (record.payload.size() < sizeof(PayloadHeader)) {
+    return;
+  }
+  PayloadHeader header;
+  memcpy(&header, record.payload.data(), sizeof(header));
+  if (header.magic != PayloadHeader::MAGIC || header.worker_id != worker_id_ ||
+      header.phase >= NONE) {
+    return;
+  }
+  Clock::time_point intended_time{std::chrono::duration_cast<Clock::duration>(
+      std::chrono::nanoseconds(header.intended_time_ns))};
+  latency_us_[header.phase].add(
+      std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() -
+                                                            intended_time)
+          .count());
+}
+
+bool InterferenceWorker::startScans(const std::vector<logid_t>& logs,
+                                    const LogToLsnMap& tail_lsns,
+                                    bool no_single_copy_delivery) {
+  size_t first = scans_.size();
+  size_t nreaders = std::max<uint64_t>(
+      1, std::min<uint64_t>(options.interference_scan_readers, logs.size()));
+  for (size_t i = 0; i < nreaders; ++i) {
+    size_t idx = first + i;
+    Scan scan;
+    scan.reader = client_->createAsyncReader();
+    if (no_single_copy_delivery) {
+      scan.reader->forceNoSingleCopyDelivery();
+    }
+    scan.reader->setRecordCallback([this](std::unique_ptr<DataRecord>& r) {
+      ++scanned_records_;
+      scanned_bytes_ += r->payload.size();
+      return true;
+    });
+    // Start over as soon as the scan reaches the tail it started with.
+    scan.reader->setDoneCallback([this, idx](logid_t log) {
+      ev_->add([this, idx, log] { restartScan(idx, log); });
+    });
+    scans_.push_back(std::move(scan));
+  }
+
+  for (size_t i = 0; i < logs.size(); ++i) {
+    Scan& scan = scans_[first + i % nreaders];
+    auto it = tail_lsns.find(logs[i].val());
+    if (it == tail_lsns.end() || it->second == LSN_INVALID) {
+      continue;
+    }
+    scan.until_lsns[logs[i].val()] = it->second;
+    if (scan.reader->startReading(logs[i], LSN_OLDEST, it->second) != 0) {
+      ld_error("Failed to start scanning log %lu: %s",
+               logs[i].val(),
+               error_description(err));
+      if (!options.ignore_errors) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void InterferenceWorker::restartScan(size_t scan_idx, logid_t log) {
+  if (!scanning_ || isStopped()) {
+    return;
+  }
+  Scan& scan = scans_[scan_idx];
+  if (scan.reader->startReading(
+          log, LSN_OLDEST, scan.until_lsns.at(log.val())) != 0) {
+    ++scan_restart_failures_;
+    RATELIMIT_WARNING(std::chrono::seconds(1),
+                      1,
+                      "Failed to restart scan of log %lu: %s",
+                      log.val(),
+                      error_description(err));
+  }
+}
+
+void InterferenceWorker::stopScans() {
+  executeOnEventLoopSync([&] {
+    scanning_ = false;
+    // Destroying an AsyncReader stops all its reads.
+    scans_.clear();
+  });
+}
+
+void InterferenceWorker::printProgress(double /* seconds_since_start */,
+                                       double /* seconds_since_last_call */) {
+  Phase phase = phase_.load();
+  if (phase == NONE) {
+    return;
+  }
+  ld_info("%s: %lu latency samples, p99 %ldus; scanned %lu records",
+          phase == BASELINE ? "baseline" : "interference",
+          latency_us_[phase].getCountAndSum().first,
+          latency_us_[phase].estimatePercentile(.99),
+          scanned_records_.load());
+}
+
+int InterferenceWorker::run() {
+  std::vector<logid_t> all_logs;
+  if (getLogs(all_logs)) {
+    return 1;
+  }
+
+  // Split the logs deterministically so that all workers agree on which logs
+  // are latency-sensitive, then partition each set among workers.
+  std::vector<logid_t> all_latency_logs;
+  std::vector<logid_t> all_bulk_logs;
+  for (logid_t log : all_logs) {
+    double h = folly::hash::hash_128_to_64(log.val_, 4721639) /
+        (std::numeric_limits<uint64_t>::max() + 1.);
+    (h < options.interference_latency_log_fraction ? all_latency_logs
+                                                   : all_bulk_logs)
+        .push_back(log);
+  }
+  latency_logs_ = getLogsPartition(all_latency_logs);
+  std::vector<logid_t> bulk_logs = getLogsPartition(all_bulk_logs);
+  if (latency_logs_.empty()) {
+    ld_error("No latency-sensitive logs assigned to this worker. Use more "
+             "logs, fewer workers or a higher "
+             "--interference-latency-log-fraction.");
+    return 1;
+  }
+  ld_info("%zu latency-sensitive logs, %zu bulk logs",
+          latency_logs_.size(),
+          bulk_logs.size());
+
+  // Keep per-log throughput independent of number of workers.
+  appends_per_sec_ =
+      options.write_rate * latency_logs_.size() / all_latency_logs.size();
+
+  // Tail the latency-sensitive logs.
+  LogToLsnMap tail_lsns;
+  if (getTailLSNs(tail_lsns, latency_logs_)) {
+    return 1;
+  }
+  if (startReading(tail_lsns, [this](std::unique_ptr<DataRecord>& record) {
+        onLatencyRecord(*record);
+        return true;
+      })) {
+    return 1;
+  }
+
+  phase_ = BASELINE;
+  if (appends_per_sec_ > 0) {
+    executeOnEventLoopSync([&] {
+      append_timer_.assign(&ev_->getEvBase(), [this] { doAppend(); });
+      next_append_time_ = Clock::now();
+      scheduleNextAppend();
+    });
+  }
+
+  // Phase 1: latency-sensitive workload alone.
+  ld_info("Measuring baseline for %" PRIu64 " seconds",
+          options.interference_baseline_duration);
+  auto baseline_start = Clock::now();
+  auto baseline_end =
+      baseline_start +
+      std::chrono::seconds(options.interference_baseline_duration);
+  while (!isStopped() && Clock::now() < baseline_end) {
+    /* sleep override */
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  auto baseline_duration =
+      std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() -
+                                                            baseline_start);
+
+  // Phase 2: with aggressors.
+  std::chrono::milliseconds interference_duration{0};
+  if (!isStopped()) {
+    const auto& aggressors = options.interference_aggressors;
+    bool scan = aggressors.count("backfill") || aggressors.count("rebuild");
+    LogToLsnMap bulk_tail_lsns;
+    if (scan && !options.pretend && !bulk_logs.empty()) {
+      if (getTailLSNs(bulk_tail_lsns, bulk_logs)) {
+        return 1;
+      }
+      bool failed = false;
+      executeOnEventLoopSync([&] {
+        scanning_ = true;
+        if (aggressors.count("backfill")) {
+          failed |= startScans(bulk_logs, bulk_tail_lsns, false);
+        }
+        if (aggressors.count("rebuild")) {
+          failed |= startScans(bulk_logs, bulk_tail_lsns, true);
+        }
+      });
+      if (failed) {
+        return 1;
+      }
+    }
+    if (aggressors.count("meta") && !options.pretend && !bulk_logs.empty()) {
+      startRequests(bulk_logs, all_bulk_logs.size());
+    }
+
+    phase_ = INTERFERENCE;
+    ld_info("Measuring with aggressors for %" PRId64 " seconds",
+            options.duration);
+    interference_duration = sleepForDurationOfTheBench();
+
+    ld_info("Stopping aggressors");
+    stopRequests();
+    stopScans();
+  }
+
+  phase_ = NONE;
+  executeOnEventLoopSync([&] { append_timer_.cancel(); });
+  if (stopReading()) {
+    return 1;
+  }
+
+  printResult(baseline_duration, interference_duration);
+  return 0;
+}
+
+void InterferenceWorker::printResult(
+    std::chrono::milliseconds baseline_duration,
+    std::chrono::milliseconds interference_duration) {
+  static const std::array<double, 5> PERCENTILES = {.5, .9, .99, .999, 1.};
+  std::array<std::array<int64_t, PERCENTILES.size()>, 2> values;
+  std::array<uint64_t, 2> counts;
+  std::array<std::chrono::milliseconds, 2> durations = {
+      baseline_duration, interference_duration};
+  const char* names[] = {"baseline", "interference"};
+
+  // Each line: phase, duration in ms, number of samples, then p50, p90, p99,
+  // p99.9 and max latency in microseconds.
+  for (size_t phase = 0; phase < 2; ++phase) {
+    latency_us_[phase].estimatePercentiles(PERCENTILES.data(),
+                                           PERCENTILES.size(),
+                                           values[phase].data(),
+                                           &counts[phase]);
+    std::cout << names[phase] << ' ' << durations[phase].count() << ' '
+              << counts[phase];
+    for (int64_t v : values[phase]) {
+      std::cout << ' ' << v;
+    }
+    std::cout << '\n';
+  }
+
+  // Ratio of each percentile with aggressors to the same percentile without.
+  std::cout << "degradation - -";
+  for (size_t i = 0; i < PERCENTILES.size(); ++i) {
+    if (counts[0] == 0 || counts[1] == 0 || values[0][i] <= 0) {
+      std::cout << " -";
+    } else {
+      std::cout << ' ' << double(values[1][i]) / values[0][i];
+    }
+  }
+  std::cout << '\n';
+
+  std::cout << "aggressors " << scanned_records_ << ' ' << scanned_bytes_
+            << ' ' << scan_restart_failures_ << ' ' << requestsSucceeded()
+            << ' ' << requestsFailed() << ' ' << requestsSkipped() << '\n';
+  std::cout << "appends " << appends_failed_ << ' ' << appends_skipped_
+            << std::endl;
+}
+
+} // namespace
+
+void registerInterferenceWorker() {
+  registerWorkerImpl(BENCH_NAME,
+                     []() -> std::unique_ptr<Worker> {
+                       return std::make_unique<InterferenceWorker>();
+                     },
+                     OptionsRestrictions({"pretend",
+                                          "duration",
+                                          "payload-size",
+                                          "write-rate",
+                                          "max-appends-in-flight",
+                                          "meta-requests-per-sec",
+                                          "meta-requests-spikiness",
+                                          "max-requests-in-flight",
+                                          "log-requests-per-sec-distribution",
+                                          "interference-latency-log-fraction",
+                                          "interference-baseline-duration",
+                                          "interference-aggressors",
+                                          "interference-scan-readers"},
+                                         {PartitioningMode::LOG}));
+}
+
+}}} // namespace facebook::logdevice::ldbench
@@ -9,6 +9,7 @@
 #include "logdevice/test/ldbench/worker/LogStoreClientHolder.h"
 
 #include <chrono>
+#include <fstream>
 #include <functional>
 #include <memory>
 
@@ -91,7 +92,29 @@ LogStoreClientHolder::LogStoreClientHolder() {
                 std::placeholders::_5));
 }
 
-LogStoreClientHolder::~LogStoreClientHolder() {}
+LogStoreClientHolder::~LogStoreClientHolder() {
+  if (options.publish_dir == "") {
+    return;
+  }
+  // Publish the last stats before writing the latency distributions.
+  collect_thread_.reset();
+  for (auto type :
+       {LatencyType::APPEND, LatencyType::APPEND_FROM_INTENDED_START}) {
+    std::string file = folly::to<std::string>(options.publish_dir,
+                                              "/",
+                                              latencyTypeName(type),
+                                              "_",
+                                              options.bench_name,
+                                              options.worker_id_index,
+                                              ".hgrm");
+    std::ofstream out(file);
+    if (!out.is_open()) {
+      ld_error("Failed to create %s", file.c_str());
+      continue;
+    }
+    bench_stats_holder_->writeLatencyPercentileDistribution(type, out);
+  }
+}
 
 std::unique_ptr<LogStoreReader> LogStoreClientHolder::createReader() {
   return client_->createReader();
@@ -182,9 +205,21 @@ void LogStoreClientHolder::onAppendDone(bool successful,
   bench_stats_holder_->getOrCreateTLStats()->incStat(
       StatsType::INFLIGHT, -1 * static_cast<int64_t>(contexts.size()));
   uint64_t payload_size = 0;
+  const auto now = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::system_clock::now().time_since_epoch());
   for (auto it = contexts.begin(); it != contexts.end(); it++) {
     const std::string& payload = std::get<std::string>(it->second);
     payload_size += payload.size();
+    if (successful && options.record_writer_info) {
+      RecordWriterInfo info;
+      Payload p(payload.data(), payload.size());
+      if (info.deserialize(p) == 0) {
+        BenchStats* stats = bench_stats_holder_->getOrCreateTLStats();
+        stats->addLatency(LatencyType::APPEND, now - info.client_timestamp);
+        stats->addLatency(LatencyType::APPEND_FROM_INTENDED_START,
+                          now - info.intendedOrClientTimestamp());
+      }
+    }
     // start to sample event
     // Current example is sampling latency
     if (bench_tracer_) {
@@ -65,24 +65,13 @@ void MetaRequestWorker::onRequestDone(bool success) {
   --requests_in_flight_;
 }
 
-int MetaRequestWorker::run() {
-  // Get the log set from config.
-  std::vector<logid_t> all_logs;
-  if (getLogs(all_logs)) {
-    return 1;
-  }
-  auto logs = options.partition_by == PartitioningMode::LOG
-      ? getLogsPartition(all_logs)
-      : all_logs;
-  if (logs.empty()) {
-    return 0;
-  }
-
+void MetaRequestWorker::startRequests(const std::vector<logid_t>& logs,
+                                      size_t num_all_logs) {
   request_generator_ = RandomEventSequence(options.meta_requests_spikiness);
 
   // Create a distribution for the number of requests/sec for different logs.
   double target_avg_requests_per_sec = static_cast<double>(
-      options.meta_requests_per_sec / double(all_logs.size()));
+      options.meta_requests_per_sec / double(num_all_logs));
   if (options.partition_by == PartitioningMode::RECORD) {
     target_avg_requests_per_sec /= options.worker_id_count;
   }
@@ -125,15 +114,35 @@ int MetaRequestWorker::run() {
       activateNextRequestTimer(kv.second.get());
     }
   });
+}
 
-  std::chrono::milliseconds actual_duration_ms = sleepForDurationOfTheBench();
-
-  ld_info("Stopping requests");
+void MetaRequestWorker::stopRequests() {
   executeOnEventLoopSync([&] {
     for (auto& kv : logs_) {
       kv.second->next_request_timer.cancel();
     }
   });
+}
+
+int MetaRequestWorker::run() {
+  // Get the log set from config.
+  std::vector<logid_t> all_logs;
+  if (getLogs(all_logs)) {
+    return 1;
+  }
+  auto logs = options.partition_by == PartitioningMode::LOG
+      ? getLogsPartition(all_logs)
+      : all_logs;
+  if (logs.empty()) {
+    return 0;
+  }
+
+  startRequests(logs, all_logs.size());
+
+  std::chrono::milliseconds actual_duration_ms = sleepForDurationOfTheBench();
+
+  ld_info("Stopping requests");
+  stopRequests();
 
   std::cout << actual_duration_ms.count() << ' ' << requests_succeeded_ << ' '
             << requests_failed_ << ' ' << requests_skipped_ << std::endl;
@@ -43,6 +43,23 @@ class MetaRequestWorker : public Worker {
   void activateNextRequestTimer(LogState* state);
   void onRequestDone(bool success);
 
+  // Starts issuing requests to `logs` in the background, at a rate such that
+  // all workers together issue options.meta_requests_per_sec requests to
+  // `num_all_logs` logs. Lets subclasses use metadata requests as one part of
+  // a larger workload. Returns immediately; call stopRequests() to stop.
+  void startRequests(const std::vector<logid_t>& logs, size_t num_all_logs);
+  void stopRequests();
+
+  uint64_t requestsSucceeded() const {
+    return requests_succeeded_.load();
+  }
+  uint64_t requestsFailed() const {
+    return requests_failed_.load();
+  }
+  uint64_t requestsSkipped() const {
+    return requests_skipped_.load();
+  }
+
   static double steadyTime() {
     return std::chrono::duration_cast<std::chrono::duration<double>>(
                std::chrono::steady_clock::now().time_since_epoch())
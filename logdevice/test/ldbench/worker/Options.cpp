@@ -15,6 +15,7 @@
 #include <boost/program_options.hpp>
 #include <folly/Optional.h>
 #include <folly/Random.h>
+#include <folly/String.h>
 #include <folly/experimental/EnvUtil.h>
 
 #include "logdevice/common/buffered_writer/BufferedWriterOptionsUtil.h"
@@ -617,6 +618,84 @@ void Options::get_named_options(options_description& named) {
           }),
       "This fraction of the readers will each start in the backlog with a "
       "probability of --restart-backlog-probability.");
+  named.add_options()(
+      "latency-from-intended-start",
+      value<bool>(&latency_from_intended_start)->default_value(true),
+      "Measure latency from when each append was meant to start according to "
+      "the target write rate, rather than from when it actually started. "
+      "Otherwise, when appends stall, the worker sends fewer appends and the "
+      "stall is underrepresented in latency percentiles (coordinated "
+      "omission).");
+  named.add_options()(
+      "read-from-sequencer-tail",
+      value<bool>(&read_from_sequencer_tail)->default_value(false),
+      "In read_your_write_latency, also ask the sequencer for the tail record "
+      "right after each append succeeds. If the sequencer still has our "
+      "record as the last released one, it counts as read without waiting "
+      "for storage nodes; otherwise the read stream delivers it as usual. "
+      "Only helps for tail-optimized logs, which keep the tail payload on the "
+      "sequencer.");
+  named.add_options()("replay-trace",
+                      value<std::string>(&replay_trace_path),
+                      "Path of the trace to replay, see ReplayTrace.h");
+  named.add_options()(
+      "replay-speed",
+      value<double>(&replay_speed)
+          ->default_value(1.0)
+          ->notifier([](double val) {
+            if (val <= 0) {
+              throw boost::program_options::error(
+                  "--replay-speed must be positive");
+            }
+          }),
+      "How many times faster than recorded to replay the trace, e.g. 2 "
+      "replays an hour of traffic in 30 minutes");
+  named.add_options()(
+      "interference-latency-log-fraction",
+      value<double>(&interference_latency_log_fraction)
+          ->default_value(0.1)
+          ->notifier([](double val) {
+            if (val <= 0 || val >= 1) {
+              throw boost::program_options::error(
+                  "--interference-latency-log-fraction must be between 0 and "
+                  "1, exclusive");
+            }
+          }),
+      "Fraction of the logs that get the latency-sensitive tailing workload. "
+      "The other logs are the target of the aggressors.");
+  named.add_options()(
+      "interference-baseline-duration",
+      value<uint64_t>(&interference_baseline_duration)->default_value(30),
+      "How long to measure the latency-sensitive workload alone before "
+      "starting the aggressors, in seconds");
+  named.add_options()(
+      "interference-aggressors",
+      value<std::string>()
+          ->default_value("backfill,rebuild,meta")
+          ->notifier([this](const std::string& val) {
+            interference_aggressors.clear();
+            if (val == "none") {
+              return;
+            }
+            std::vector<std::string> tokens;
+            folly::split(',', val, tokens);
+            for (const std::string& t : tokens) {
+              if (t != "backfill" && t != "rebuild" && t != "meta") {
+                throw boost::program_options::error(
+                    "Invalid interference-aggressors: " + val);
+              }
+              interference_aggressors.insert(t);
+            }
+          }),
+      "Comma-separated list of workloads to run against the other logs "
+      "during the second phase: 'backfill' (scans from the oldest record), "
+      "'rebuild' (the same scans, but without single copy delivery), 'meta' "
+      "(findTime requests at --meta-requests-per-sec). 'none' to run no "
+      "aggressors.");
+  named.add_options()(
+      "interference-scan-readers",
+      value<uint64_t>(&interference_scan_readers)->default_value(4),
+      "Number of AsyncReaders each worker uses for each scanning aggressor");
   named.add_options()(
       "sys-name",
       value<std::string>(&sys_name)
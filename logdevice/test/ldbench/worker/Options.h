@@ -96,6 +96,8 @@ struct Options {
   double write_rate;
   bool pretend;
   bool record_writer_info;
+  bool latency_from_intended_start;
+  bool read_from_sequencer_tail;
   // If you're adding an option, don't forget to add it to a REGISTER_WORKER().
 
   // Options of "read" bench.
@@ -133,6 +135,16 @@ struct Options {
   std::chrono::milliseconds findtime_avg_time_ago = std::chrono::minutes(30);
   Log2Histogram findtime_timestamp_distribution;
 
+  // Options of "replay" bench.
+  std::string replay_trace_path;
+  double replay_speed;
+
+  // Options of "interference" bench.
+  double interference_latency_log_fraction;
+  uint64_t interference_baseline_duration;
+  std::set<std::string> interference_aggressors;
+  uint64_t interference_scan_readers;
+
   // Populates the given options description with the options pointing to fields
   // of this Options instance.
   void get_named_options(boost::program_options::options_description&);
@@ -26,6 +26,7 @@
 #include "logdevice/include/Err.h"
 #include "logdevice/include/Record.h"
 #include "logdevice/include/types.h"
+#include "logdevice/lib/ClientImpl.h"
 #include "logdevice/test/ldbench/worker/Histogram.h"
 #include "logdevice/test/ldbench/worker/Options.h"
 #include "logdevice/test/ldbench/worker/Reservoir.h"
@@ -42,12 +43,20 @@ static constexpr const char* BENCH_NAME = "read_your_write_latency";
  *
  * Performs async appends at a steady rate while tailing the logs it writes to.
  * Measures the end-to-end latency from the time of calling Client::append() to
- * the time of receiving a read callback of the respective record.
+ * the time of receiving a read callback of the respective record. With
+ * --latency-from-intended-start (the default), latency is measured from when
+ * the append was meant to be called according to the target write rate
+ * instead, so that stalls that hold back appends show up in the results.
  *
  * Writes are uniformly randomly distributed across the set of logs. The
  * set of logs is partitioned among concurrent writers so that each worker
  * only reads its own writes. (Otherwise, one would quickly exceed the read
  * bandwidth of workers.)
+ *
+ * With --read-from-sequencer-tail, each successful append is also followed by
+ * a request for the log's tail record to its sequencer. If that is still our
+ * record, it counts as read right away; if the tail has moved on, the record
+ * is left to the read stream.
  */
 class ReadYourWriteLatencyWorker final : public SteadyWriteRateWorker {
  public:
@@ -70,6 +79,7 @@ class ReadYourWriteLatencyWorker final : public SteadyWriteRateWorker {
   void printResult();
   void appendCallback(Status status, const DataRecord& record);
   void recordCallback(const DataRecord& record);
+  void readTailFromSequencer(logid_t log, lsn_t lsn);
   void handleAppendSuccess(Payload payload) override;
   void handleAppendError(Status st, Payload payload) override;
   size_t getNumPendingXacts() const noexcept override;
@@ -85,23 +95,27 @@ class ReadYourWriteLatencyWorker final : public SteadyWriteRateWorker {
 };
 
 struct ReadYourWriteLatencyWorker::PayloadHeader final {
-  static constexpr uint32_t VERSION = 4; /// bump after structural changes
+  static constexpr uint32_t VERSION = 5; /// bump after structural changes
   static constexpr uint64_t MAGIC = 0x1DBE7C4000000000 + VERSION;
   PayloadHeader(uint64_t worker_id,
                 uint64_t record_id,
                 TimePoint append_time,
+                TimePoint intended_time,
                 bool filter_out)
       : magic(MAGIC),
         worker_id(worker_id),
         filter_out(filter_out),
         record_id(record_id),
-        append_time(append_time) {}
+        append_time(append_time),
+        intended_time(intended_time) {}
 
   uint64_t magic;          /// to detect structural changes
   uint64_t worker_id : 56; /// to ensure we don't read others' records
   bool filter_out : 8;     /// expect this record to be filtered out
   uint64_t record_id;      /// to identify the record on callback
   TimePoint append_time;   /// time of append
+  TimePoint intended_time; /// intended time of append, see
+                           /// SteadyWriteRateWorker::intended_start_time_
 };
 
 ReadYourWriteLatencyWorker::~ReadYourWriteLatencyWorker() {
@@ -111,9 +125,10 @@ ReadYourWriteLatencyWorker::~ReadYourWriteLatencyWorker() {
 
 std::string ReadYourWriteLatencyWorker::generatePayload(size_t size) {
   static_assert(
-      sizeof(PayloadHeader) == 32, "Unexpected padding of PayloadHeader");
+      sizeof(PayloadHeader) == 40, "Unexpected padding of PayloadHeader");
   auto record_id = next_record_id_++;
-  PayloadHeader header(worker_id, record_id, Clock::now(), false);
+  PayloadHeader header(
+      worker_id, record_id, Clock::now(), intended_start_time_, false);
   std::string payload(reinterpret_cast<char*>(&header), sizeof(header));
   if (size > sizeof(header)) {
     payload.append(generatePayload(size - sizeof(header)));
@@ -144,6 +159,7 @@ int ReadYourWriteLatencyWorker::run() {
 
   // Clear append token bucket.
   token_bucket_.reset(token_bucket_.defaultClockNow());
+  resetSchedule();
 
   // Callback for use with Client::append.
   append_callback_t append_cb([this](Status status, const DataRecord& record) {
@@ -287,6 +303,8 @@ void ReadYourWriteLatencyWorker::appendCallback(Status status,
   if (status == E::OK && (options.pretend || header.filter_out)) {
     // Pretend mode. There is no reader. Just call record callback immediately.
     recordCallback(record);
+  } else if (status == E::OK && options.read_from_sequencer_tail) {
+    readTailFromSequencer(record.logid, record.attrs.lsn);
   }
 
   // Notify main thread in run().
@@ -303,7 +321,9 @@ void ReadYourWriteLatencyWorker::recordCallback(const DataRecord& record) {
       // wrote into the payload. The difference to the current time gives us
       // the read-your-write latency.
       auto now = Clock::now();
-      auto latency = now - header.append_time;
+      auto latency = now -
+          (options.latency_from_intended_start ? header.intended_time
+                                               : header.append_time);
       auto latency_sample = std::chrono::duration_cast<Sample>(latency);
       ld_debug(
           "Record read: latency=%" PRIu64, uint64_t(latency_sample.count()));
@@ -313,16 +333,18 @@ void ReadYourWriteLatencyWorker::recordCallback(const DataRecord& record) {
         std::lock_guard<std::recursive_mutex> lock(mutex_);
         --nwaiting_;
 
-        // Put sample into reservoir (or not).
-        if (collect_samples_) {
-          reservoir_->put(latency_sample);
-        }
-
         // Remove record id from pending reads. May be a no-op in case the
         // append was considered failed but succeeded anyways. (That can happen
         // in a distributed system and is the reason for keeping a set of
-        // record ids instead of a simple counter.)
-        pending_reads_.erase(header.record_id);
+        // record ids instead of a simple counter.) Also a no-op for the
+        // second of the read stream and the sequencer tail to deliver a
+        // record with --read-from-sequencer-tail.
+        bool first_read = pending_reads_.erase(header.record_id) > 0;
+
+        // Put sample into reservoir (or not).
+        if (collect_samples_ && first_read) {
+          reservoir_->put(latency_sample);
+        }
       }
 
       // Notify main thread in tryAppend().
@@ -344,6 +366,26 @@ void ReadYourWriteLatencyWorker::recordCallback(const DataRecord& record) {
   }
 }
 
+void ReadYourWriteLatencyWorker::readTailFromSequencer(logid_t log,
+                                                       lsn_t lsn) {
+  auto cb = [this, lsn](Status st, std::unique_ptr<DataRecord> tail) {
+    // Anything other than our record being the tail (e.g. a newer record
+    // was released already, or the log is not tail-optimized) means the
+    // record has to come from the read stream.
+    if (st == E::OK && tail->attrs.lsn == lsn) {
+      recordCallback(*tail);
+    }
+  };
+  int rv = static_cast<ClientImpl*>(client_.get())->readLogTail(log, cb);
+  if (rv != 0) {
+    RATELIMIT_WARNING(std::chrono::seconds(1),
+                      1,
+                      "Failed to request tail record of log %lu: %s",
+                      log.val_,
+                      error_name(err));
+  }
+}
+
 void ReadYourWriteLatencyWorker::handleAppendSuccess(Payload payload) {
   ld_check(payload.size() >= sizeof(PayloadHeader));
   const auto& header = *reinterpret_cast<const PayloadHeader*>(payload.data());
@@ -419,7 +461,9 @@ void registerReadYourWriteLatencyWorker() {
                                           "payload-size",
                                           "histogram-bucket-count",
                                           "filter-selectivity",
-                                          "write-rate"},
+                                          "write-rate",
+                                          "latency-from-intended-start",
+                                          "read-from-sequencer-tail"},
                                          {PartitioningMode::LOG}));
 }
 
@@ -17,25 +17,31 @@ namespace facebook { namespace logdevice {
 // If payload starts with these 8 bytes, we assume it has RecordWriterInfo.
 static const uint64_t MAGIC_NUMBER = 0xf506aab41f587bb5ul;
 
+// Header::flags. If set, client_timestamp is followed by intended_timestamp.
+// Records written before intended_timestamp was added don't have it.
+static const uint32_t FLAG_INTENDED_TIMESTAMP = 1u << 0;
+
 size_t RecordWriterInfo::serializedSize() const {
-  return sizeof(Header) + sizeof(RecordWriterInfo);
+  return sizeof(Header) + 2 * sizeof(int64_t);
 }
 
 void RecordWriterInfo::serialize(char* out) const {
   Header h;
   h.magic_number = MAGIC_NUMBER;
-  h.flags = 0;
+  h.flags = FLAG_INTENDED_TIMESTAMP;
   h.payload_offset = serializedSize();
   memcpy(out, &h, sizeof(h));
   int64_t ts = client_timestamp.count();
   memcpy(out + sizeof(h), &ts, sizeof(ts));
+  ts = intended_timestamp.count();
+  memcpy(out + sizeof(h) + sizeof(ts), &ts, sizeof(ts));
 }
 
 int RecordWriterInfo::deserialize(Payload& payload) {
   const char* data = reinterpret_cast<const char*>(payload.data());
   Header h;
 
-  if (payload.size() < sizeof(Header) + sizeof(RecordWriterInfo)) {
+  if (payload.size() < sizeof(Header) + sizeof(int64_t)) {
     memcpy(&h.magic_number, data, sizeof(h.magic_number));
     err = h.magic_number == MAGIC_NUMBER ? E::MALFORMED_RECORD : E::NOTFOUND;
     return -1;
@@ -55,6 +61,13 @@ int RecordWriterInfo::deserialize(Payload& payload) {
   int64_t ts;
   memcpy(&ts, data + sizeof(h), sizeof(ts));
   client_timestamp = std::chrono::microseconds(ts);
+  if ((h.flags & FLAG_INTENDED_TIMESTAMP) &&
+      h.payload_offset >= sizeof(h) + 2 * sizeof(ts)) {
+    memcpy(&ts, data + sizeof(h) + sizeof(ts), sizeof(ts));
+    intended_timestamp = std::chrono::microseconds(ts);
+  } else {
+    intended_timestamp = std::chrono::microseconds(0);
+  }
   size_t size = payload.size() - h.payload_offset;
   payload = size ? Payload(data + h.payload_offset, size) : Payload();
 
@@ -29,6 +29,18 @@ struct RecordWriterInfo {
   // Time since epoch when the writer started the append.
   std::chrono::microseconds client_timestamp;
 
+  // Time since epoch when the writer meant to start the append according to
+  // its target rate, or zero if unknown. Earlier than client_timestamp if the
+  // writer fell behind, e.g. because appends stalled. Latency measured from
+  // it includes the time the append waited to be sent, so it isn't
+  // underreported when the cluster stalls (coordinated omission).
+  std::chrono::microseconds intended_timestamp{0};
+
+  // intended_timestamp if known, client_timestamp otherwise.
+  std::chrono::microseconds intendedOrClientTimestamp() const {
+    return intended_timestamp.count() ? intended_timestamp : client_timestamp;
+  }
+
   // Exact number of bytes serialize() will need.
   size_t serializedSize() const;
 
@@ -0,0 +1,131 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "logdevice/test/ldbench/worker/ReplayTrace.h"
+
+#include <cstring>
+
+#include "logdevice/common/debug.h"
+
+namespace facebook { namespace logdevice { namespace ldbench {
+
+static constexpr char MAGIC[] = "LDTRACE1";
+static constexpr size_t MAGIC_LEN = sizeof(MAGIC) - 1;
+// A uint64_t takes at most 10 bytes as varint.
+static constexpr int MAX_VARINT_BYTES = 10;
+
+bool ReplayTraceReader::open(const std::string& path) {
+  path_ = path;
+  in_.close();
+  in_.clear();
+  in_.open(path, std::ios::binary);
+  if (!in_.is_open()) {
+    ld_error("Failed to open trace %s: %s", path.c_str(), strerror(errno));
+    return true;
+  }
+  char magic[MAGIC_LEN];
+  if (!in_.read(magic, MAGIC_LEN) || memcmp(magic, MAGIC, MAGIC_LEN) != 0) {
+    ld_error("%s is not a replay trace", path.c_str());
+    return true;
+  }
+  last_time_ = std::chrono::microseconds(0);
+  events_read_ = 0;
+  return false;
+}
+
+bool ReplayTraceReader::readVarint(uint64_t* out) {
+  uint64_t v = 0;
+  for (int i = 0; i < MAX_VARINT_BYTES; ++i) {
+    int c = in_.get();
+    if (c == EOF) {
+      return false;
+    }
+    v |= uint64_t(c & 0x7f) << (7 * i);
+    if (!(c & 0x80)) {
+      *out = v;
+      return true;
+    }
+  }
+  return false;
+}
+
+int ReplayTraceReader::next(ReplayTraceEvent* out) {
+  uint64_t delta;
+  if (in_.peek() == EOF) {
+    return 0;
+  }
+  uint64_t log_id;
+  uint64_t arg;
+  int type = EOF;
+  if (!readVarint(&delta) || (type = in_.get()) == EOF ||
+      !readVarint(&log_id) || !readVarint(&arg) || type == 0 ||
+      type >= static_cast<int>(ReplayTraceEvent::Type::MAX)) {
+    ld_error("Trace %s is corrupted after %lu events",
+             path_.c_str(),
+             events_read_);
+    return -1;
+  }
+  last_time_ += std::chrono::microseconds(delta);
+  out->time = last_time_;
+  out->type = static_cast<ReplayTraceEvent::Type>(type);
+  out->log_id = log_id;
+  out->arg = arg;
+  ++events_read_;
+  return 1;
+}
+
+bool ReplayTraceWriter::open(const std::string& path) {
+  path_ = path;
+  out_.open(path, std::ios::binary | std::ios::trunc);
+  if (!out_.is_open()) {
+    ld_error("Failed to create trace %s: %s", path.c_str(), strerror(errno));
+    return true;
+  }
+  out_.write(MAGIC, MAGIC_LEN);
+  last_time_ = std::chrono::microseconds(0);
+  return !out_;
+}
+
+void ReplayTraceWriter::writeVarint(uint64_t v) {
+  while (v >= 0x80) {
+    out_.put(static_cast<char>(v | 0x80));
+    v >>= 7;
+  }
+  out_.put(static_cast<char>(v));
+}
+
+bool ReplayTraceWriter::write(const ReplayTraceEvent& event) {
+  if (event.time < last_time_) {
+    ld_error("Trace events must be written in order of time, got %ld us "
+             "after %ld us",
+             event.time.count(),
+             last_time_.count());
+    return true;
+  }
+  writeVarint((event.time - last_time_).count());
+  out_.put(static_cast<char>(event.type));
+  writeVarint(event.log_id);
+  writeVarint(event.arg);
+  last_time_ = event.time;
+  if (!out_) {
+    ld_error("Failed to write trace %s", path_.c_str());
+    return true;
+  }
+  return false;
+}
+
+bool ReplayTraceWriter::close() {
+  out_.close();
+  if (!out_) {
+    ld_error("Failed to write trace %s", path_.c_str());
+    return true;
+  }
+  return false;
+}
+
+}}} // namespace facebook::logdevice::ldbench
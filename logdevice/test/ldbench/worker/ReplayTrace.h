@@ -0,0 +1,107 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+namespace facebook { namespace logdevice { namespace ldbench {
+
+/**
+ * @file Compact binary trace of client operations, replayed by the "replay"
+ *       worker (see TraceReplayWorker.cpp). Produced by capture tools, e.g.
+ *       from sampled AppenderTracer and ClientAPIHitsTracer records, using
+ *       ReplayTraceWriter.
+ *
+ *       Format: the 8-byte magic "LDTRACE1", followed by events sorted by
+ *       time. Each event is
+ *         varint  microseconds since the previous event (or trace start),
+ *         uint8   ReplayTraceEvent::Type,
+ *         varint  log id,
+ *         varint  argument, see ReplayTraceEvent::arg.
+ */
+
+struct ReplayTraceEvent {
+  enum class Type : uint8_t {
+    // Append a record of `arg` bytes.
+    APPEND = 1,
+    // Start reading the log `arg` milliseconds behind the tail, or at the
+    // tail if `arg` is 0. If the log is already being read, this is a seek:
+    // the reader is restarted from the new position. Backfill bursts are
+    // starts far behind the tail.
+    START_READING = 2,
+    // Stop reading the log. `arg` is unused.
+    STOP_READING = 3,
+
+    MAX,
+  };
+
+  // Time since the start of the trace.
+  std::chrono::microseconds time{0};
+  Type type = Type::APPEND;
+  uint64_t log_id = 0;
+  uint64_t arg = 0;
+
+  bool operator==(const ReplayTraceEvent& other) const {
+    return time == other.time && type == other.type &&
+        log_id == other.log_id && arg == other.arg;
+  }
+};
+
+class ReplayTraceReader {
+ public:
+  /**
+   * @return false on success, true if the file can't be opened or isn't a
+   *         trace. Logs the error.
+   */
+  bool open(const std::string& path);
+
+  /**
+   * Reads the next event.
+   *
+   * @return 1 if an event was read, 0 at the end of the trace, -1 if the
+   *         trace is corrupted (logs the error).
+   */
+  int next(ReplayTraceEvent* out);
+
+ private:
+  bool readVarint(uint64_t* out);
+
+  std::ifstream in_;
+  std::string path_;
+  std::chrono::microseconds last_time_{0};
+  uint64_t events_read_ = 0;
+};
+
+class ReplayTraceWriter {
+ public:
+  // @return false on success, true on failure. Logs the error.
+  bool open(const std::string& path);
+
+  /**
+   * Appends an event. Events must be written in order of time.
+   *
+   * @return false on success, true on failure (logs the error).
+   */
+  bool write(const ReplayTraceEvent& event);
+
+  // Flushes and closes the file. @return false on success, true on failure.
+  bool close();
+
+ private:
+  void writeVarint(uint64_t v);
+
+  std::ofstream out_;
+  std::string path_;
+  std::chrono::microseconds last_time_{0};
+};
+
+}}} // namespace facebook::logdevice::ldbench
@@ -0,0 +1,99 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include "logdevice/test/ldbench/worker/ReplayTrace.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace facebook { namespace logdevice { namespace ldbench {
+
+class ReplayTraceTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    tmp_file_name = std::tmpnam(nullptr);
+  }
+  void TearDown() override {
+    std::remove(tmp_file_name.c_str());
+  }
+
+  static ReplayTraceEvent event(int64_t time_us,
+                                ReplayTraceEvent::Type type,
+                                uint64_t log_id,
+                                uint64_t arg) {
+    ReplayTraceEvent e;
+    e.time = std::chrono::microseconds(time_us);
+    e.type = type;
+    e.log_id = log_id;
+    e.arg = arg;
+    return e;
+  }
+
+  std::string tmp_file_name;
+};
+
+TEST_F(ReplayTraceTest, RoundTrip) {
+  using Type = ReplayTraceEvent::Type;
+  std::vector<ReplayTraceEvent> events = {
+      event(0, Type::START_READING, 1, 0),
+      event(0, Type::APPEND, 1, 100),
+      event(1500, Type::APPEND, 1ul << 62, 1 << 20),
+      event(1500, Type::START_READING, 2, 6 * 3600 * 1000),
+      event(3600ll * 1000 * 1000, Type::STOP_READING, 2, 0),
+  };
+
+  ReplayTraceWriter writer;
+  ASSERT_FALSE(writer.open(tmp_file_name));
+  for (const auto& e : events) {
+    ASSERT_FALSE(writer.write(e));
+  }
+  // Out of order.
+  EXPECT_TRUE(writer.write(event(0, Type::APPEND, 1, 1)));
+  ASSERT_FALSE(writer.close());
+
+  ReplayTraceReader reader;
+  ASSERT_FALSE(reader.open(tmp_file_name));
+  for (const auto& expected : events) {
+    ReplayTraceEvent e;
+    ASSERT_EQ(1, reader.next(&e));
+    EXPECT_EQ(expected, e);
+  }
+  ReplayTraceEvent e;
+  EXPECT_EQ(0, reader.next(&e));
+}
+
+TEST_F(ReplayTraceTest, Corrupted) {
+  {
+    std::ofstream out(tmp_file_name, std::ios::binary);
+    out << "not a trace";
+  }
+  ReplayTraceReader reader;
+  EXPECT_TRUE(reader.open(tmp_file_name));
+
+  ReplayTraceWriter writer;
+  ASSERT_FALSE(writer.open(tmp_file_name));
+  ASSERT_FALSE(
+      writer.write(event(10, ReplayTraceEvent::Type::APPEND, 1, 1000)));
+  ASSERT_FALSE(writer.close());
+  {
+    // Truncates the last event.
+    std::ofstream out(tmp_file_name, std::ios::binary | std::ios::app);
+    out.put(5);
+    out.put(static_cast<char>(ReplayTraceEvent::Type::APPEND));
+  }
+  ASSERT_FALSE(reader.open(tmp_file_name));
+  ReplayTraceEvent e;
+  EXPECT_EQ(1, reader.next(&e));
+  EXPECT_EQ(-1, reader.next(&e));
+}
+
+}}} // namespace facebook::logdevice::ldbench
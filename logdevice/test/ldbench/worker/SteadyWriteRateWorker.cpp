@@ -54,6 +54,12 @@ bool SteadyWriteRateWorker::tryAppend(
     }
   }
 
+  // Take the next slot of the schedule. If the token bucket let us start
+  // early, we're ahead of the schedule and the latency counts from now.
+  intended_start_time_ = std::min(next_intended_start_time_, Clock::now());
+  next_intended_start_time_ += std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(1.0 / write_rate_));
+
   // Pick random log id from distribution.
   logid_t log_id(log_id_dist());
 
@@ -86,4 +92,8 @@ bool SteadyWriteRateWorker::errorOrStopped() const noexcept {
   return error() || isStopped();
 }
 
+void SteadyWriteRateWorker::resetSchedule() {
+  next_intended_start_time_ = Clock::now();
+}
+
 }}} // namespace facebook::logdevice::ldbench
@@ -48,12 +48,28 @@ class SteadyWriteRateWorker : public Worker {
   virtual bool error() const noexcept = 0;
   bool errorOrStopped() const noexcept;
 
+  // Restarts the schedule of intended start times at the current time. Call
+  // before the first tryAppend() and after any deliberate pause in appends.
+  void resetSchedule();
+
   std::recursive_mutex mutex_;
   std::condition_variable_any cond_var_;
   std::atomic<uint64_t> nwaiting_{0};
   double write_rate_;
   TimePoint end_time_;
   TokenBucket token_bucket_;
+
+  // When the append being made by tryAppend() was meant to start, according
+  // to a fixed schedule of write_rate_ appends per second. Set before
+  // generatePayload() is called. Unlike the actual start, it doesn't move
+  // later while appends are held back by options.max_window, so latency
+  // measured from it isn't underreported when the cluster stalls
+  // (coordinated omission).
+  TimePoint intended_start_time_;
+
+ private:
+  // Next slot of the schedule.
+  TimePoint next_intended_start_time_;
 };
 
 }}} // namespace facebook::logdevice::ldbench
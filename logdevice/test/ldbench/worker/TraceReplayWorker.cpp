@@ -0,0 +1,387 @@
+/**
+ * Copyright (c) 2019-present, Facebook, Inc. and its affiliates.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+
+#include "logdevice/common/debug.h"
+#include "logdevice/common/util.h"
+#include "logdevice/test/ldbench/worker/LogStoreClientHolder.h"
+#include "logdevice/test/ldbench/worker/LogStoreReader.h"
+#include "logdevice/test/ldbench/worker/Options.h"
+#include "logdevice/test/ldbench/worker/ReplayTrace.h"
+#include "logdevice/test/ldbench/worker/Worker.h"
+#include "logdevice/test/ldbench/worker/WorkerRegistry.h"
+
+namespace facebook { namespace logdevice { namespace ldbench {
+namespace {
+
+static constexpr const char* BENCH_NAME = "replay";
+
+/**
+ * Trace replay worker.
+ *
+ * Replays the appends, reader starts, seeks and stops of a ReplayTrace at
+ * --replay-speed times the recorded speed, until the trace ends or duration
+ * has passed. Events are partitioned across workers by log
+ * (--partition-by=log) or round-robin (--partition-by=record).
+ *
+ * A pacing thread reads the trace and sleeps until each event is due, then
+ * hands the events due together to ev_, which does the appends and reads.
+ * Events that fall behind are replayed late rather than dropped, so the
+ * replayed workload keeps the trace's content; lateness is reported in
+ * replay_* stats and in the progress output.
+ */
+class TraceReplayWorker final : public Worker {
+ public:
+  using Worker::Worker;
+  int run() override;
+
+ private:
+  struct LogState {
+    bool reading = false;
+    // Bumped on every start and stop, to ignore getTailLSN()/findTime()
+    // results of superseded starts.
+    uint64_t generation = 0;
+  };
+
+  // Runs on pacing_thread_.
+  void pace();
+  // Posts the events to ev_ and clears `events`.
+  void flush(std::vector<ReplayTraceEvent>& events);
+
+  // Called on ev_ thread.
+  void replay(const ReplayTraceEvent& event);
+  void append(logid_t log, size_t size);
+  void startReader(logid_t log, std::chrono::milliseconds backlog);
+  void stopReader(logid_t log);
+
+  void onAppendDone(LogIDType log_id,
+                    bool successful,
+                    bool buffered,
+                    uint64_t num_records,
+                    uint64_t payload_bytes) override;
+
+  void printProgress(double seconds_since_start,
+                     double seconds_since_last_call) override;
+
+  ReplayTraceReader trace_;
+  std::thread pacing_thread_;
+  std::atomic<bool> trace_corrupted_{false};
+
+  // Accessed only from ev_ thread.
+  std::unique_ptr<LogStoreReader> log_reader_;
+  std::unordered_map<logid_t, LogState, logid_t::Hash> logs_;
+
+  std::atomic<uint64_t> events_{0};
+  std::atomic<uint64_t> events_late_{0};
+  std::atomic<int64_t> lag_ms_{0};
+  std::atomic<uint64_t> appends_in_flight_{0};
+  std::atomic<uint64_t> appends_succeeded_{0};
+  std::atomic<uint64_t> appends_failed_{0};
+  std::atomic<uint64_t> appends_skipped_{0};
+  std::atomic<uint64_t> read_starts_{0};
+  std::atomic<uint64_t> nrecords_{0};
+  std::atomic<uint64_t> nbytes_{0};
+};
+
+void TraceReplayWorker::pace() {
+  // How close to their due time events are batched together.
+  const auto batch_window = std::chrono::milliseconds(1);
+  // Events later than this are counted as late.
+  const auto late_threshold = std::chrono::milliseconds(10);
+  // Upper bound on sleeps, to notice stop() in time.
+  const auto max_sleep = std::chrono::milliseconds(100);
+  const size_t max_batch = 1000;
+
+  waitUntilStartTime();
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<ReplayTraceEvent> batch;
+  uint64_t seq = 0;
+  int64_t max_lag_ms = 0;
+  ReplayTraceEvent event;
+  int rv = 0;
+  while (!isStopped() && (rv = trace_.next(&event)) > 0) {
+    bool mine = options.partition_by == PartitioningMode::LOG
+        ? isLogInPartition(logid_t(event.log_id))
+        : seq % options.worker_id_count == options.worker_id_index;
+    ++seq;
+    if (!mine) {
+      continue;
+    }
+
+    const auto due = start +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                         std::chrono::duration<double, std::micro>(
+                             event.time.count() / options.replay_speed));
+    auto now = std::chrono::steady_clock::now();
+    if (due > now + batch_window) {
+      flush(batch);
+      while (!isStopped() && (now = std::chrono::steady_clock::now()) < due) {
+        std::this_thread::sleep_for(std::min<std::chrono::nanoseconds>(
+            due - now, max_sleep));
+      }
+    }
+
+    const auto lag = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - due);
+    lag_ms_.store(std::max<int64_t>(lag.count(), 0));
+    if (lag > late_threshold) {
+      ++events_late_;
+      STAT_INCR(stats_.get(), ldbench->replay_events_late);
+    }
+    if (lag.count() > max_lag_ms) {
+      max_lag_ms = lag.count();
+      STAT_SET(stats_.get(), ldbench->replay_max_lag_ms, max_lag_ms);
+    }
+
+    batch.push_back(event);
+    if (batch.size() >= max_batch) {
+      flush(batch);
+    }
+  }
+  flush(batch);
+
+  if (!isStopped()) {
+    if (rv < 0) {
+      trace_corrupted_.store(true);
+    } else {
+      ld_info("Reached the end of the trace");
+    }
+    stop();
+  }
+}
+
+void TraceReplayWorker::flush(std::vector<ReplayTraceEvent>& events) {
+  if (events.empty()) {
+    return;
+  }
+  ev_->add([this, events = std::move(events)] {
+    for (const auto& event : events) {
+      if (isStopped()) {
+        return;
+      }
+      replay(event);
+    }
+  });
+  events.clear();
+}
+
+void TraceReplayWorker::replay(const ReplayTraceEvent& event) {
+  ++events_;
+  STAT_INCR(stats_.get(), ldbench->replay_events);
+  logid_t log(event.log_id);
+  switch (event.type) {
+    case ReplayTraceEvent::Type::APPEND:
+      append(log, event.arg);
+      break;
+    case ReplayTraceEvent::Type::START_READING:
+      startReader(log, std::chrono::milliseconds(event.arg));
+      break;
+    case ReplayTraceEvent::Type::STOP_READING:
+      stopReader(log);
+      break;
+    case ReplayTraceEvent::Type::MAX:
+      ld_check(false);
+      break;
+  }
+}
+
+void TraceReplayWorker::append(logid_t log, size_t size) {
+  if (appends_in_flight_.load() >= options.max_appends_in_flight) {
+    ++appends_skipped_;
+    STAT_INCR(stats_.get(), ldbench->replay_appends_skipped);
+    return;
+  }
+  std::string payload = generatePayload(size);
+  ++appends_in_flight_;
+  if (options.pretend) {
+    ev_->add(
+        [this, log, size] { onAppendDone(log.val_, true, false, 1, size); });
+  } else if (!client_holder_->append(
+                 log.val_, std::move(payload), reinterpret_cast<void*>(size))) {
+    --appends_in_flight_;
+    ++appends_failed_;
+  }
+}
+
+void TraceReplayWorker::onAppendDone(LogIDType /* log_id */,
+                                     bool successful,
+                                     bool /* buffered */,
+                                     uint64_t num_records,
+                                     uint64_t /* payload_bytes */) {
+  (successful ? appends_succeeded_ : appends_failed_) += num_records;
+  appends_in_flight_ -= num_records;
+}
+
+void TraceReplayWorker::startReader(logid_t log,
+                                    std::chrono::milliseconds backlog) {
+  if (options.pretend) {
+    ++read_starts_;
+    return;
+  }
+  // A start on a log that's being read is a seek.
+  stopReader(log);
+  LogState& state = logs_[log];
+  const uint64_t generation = state.generation;
+
+  auto cb = [this, log, generation, backlog](bool successful, lsn_t lsn) {
+    LogState& st = logs_[log];
+    if (st.generation != generation) {
+      // Stopped or restarted in the meantime.
+      return;
+    }
+    if (!successful || lsn == LSN_INVALID) {
+      RATELIMIT_INFO(std::chrono::seconds(10),
+                     2,
+                     "%s() failed for log %lu",
+                     backlog.count() ? "findTime" : "getTailLSN",
+                     log.val_);
+      STAT_INCR(stats_.get(), ldbench->replay_read_starts_failed);
+      return;
+    }
+    if (!backlog.count() && lsn < LSN_MAX) {
+      // Start right after the tail.
+      ++lsn;
+    }
+    if (!log_reader_->startReading(log.val_, lsn, LSN_MAX)) {
+      RATELIMIT_INFO(std::chrono::seconds(10),
+                     2,
+                     "Failed to start reading log %lu: %s",
+                     log.val_,
+                     error_name(err));
+      STAT_INCR(stats_.get(), ldbench->replay_read_starts_failed);
+      return;
+    }
+    st.reading = true;
+    ++read_starts_;
+  };
+
+  bool rv;
+  if (backlog.count()) {
+    auto ts = std::chrono::duration_cast<std::chrono::milliseconds>(
+        (std::chrono::system_clock::now() - backlog).time_since_epoch());
+    rv = findTime(log, ts, cb);
+  } else {
+    rv = getTailLSN(log, cb);
+  }
+  if (rv != true) {
+    STAT_INCR(stats_.get(), ldbench->replay_read_starts_failed);
+  }
+}
+
+void TraceReplayWorker::stopReader(logid_t log) {
+  auto it = logs_.find(log);
+  if (it == logs_.end()) {
+    return;
+  }
+  ++it->second.generation;
+  if (it->second.reading) {
+    log_reader_->stopReading(log.val_);
+    it->second.reading = false;
+  }
+}
+
+void TraceReplayWorker::printProgress(double seconds_since_start,
+                                      double /* seconds_since_last_call */) {
+  std::array<std::array<char, 32>, 6> bufs; // for commaprint_r()
+  ld_info("ran for: %.3fs, events: %s (%s late), lag: %ldms, "
+          "appends: %s ok, %lu failed, %lu skipped, %lu in flight, "
+          "read starts: %s, records: %s, bytes: %s",
+          seconds_since_start,
+          commaprint_r(events_.load(), &bufs[0][0], 32),
+          commaprint_r(events_late_.load(), &bufs[1][0], 32),
+          lag_ms_.load(),
+          commaprint_r(appends_succeeded_.load(), &bufs[2][0], 32),
+          appends_failed_.load(),
+          appends_skipped_.load(),
+          appends_in_flight_.load(),
+          commaprint_r(read_starts_.load(), &bufs[3][0], 32),
+          commaprint_r(nrecords_.load(), &bufs[4][0], 32),
+          commaprint_r(nbytes_.load(), &bufs[5][0], 32));
+}
+
+int TraceReplayWorker::run() {
+  if (options.replay_trace_path.empty()) {
+    ld_error("--replay-trace is required");
+    return 1;
+  }
+  if (trace_.open(options.replay_trace_path)) {
+    return 1;
+  }
+
+  if (!options.pretend) {
+    log_reader_ = client_holder_->createReader();
+    log_reader_->setWorkerRecordCallback([this](LogIDType,
+                                            LogPositionType,
+                                            std::chrono::milliseconds,
+                                            std::string payload) {
+      ++nrecords_;
+      nbytes_ += payload.size();
+      return true;
+    });
+    log_reader_->setWorkerGapCallback(
+        [](LogStoreGapType, LogIDType, LogPositionType, LogPositionType) {
+          return true;
+        });
+  }
+
+  pacing_thread_ = std::thread([this] { pace(); });
+  std::chrono::milliseconds actual_duration_ms = sleepForDurationOfTheBench();
+  pacing_thread_.join();
+
+  ld_info("Stopping replay");
+  executeOnEventLoopSync([&] {
+    for (auto& kv : logs_) {
+      if (kv.second.reading) {
+        log_reader_->stopReading(kv.first.val_);
+        kv.second.reading = false;
+      }
+    }
+  });
+  while (appends_in_flight_.load()) {
+    /* sleep override */
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  log_reader_.reset();
+  destroyClient();
+
+  std::cout << actual_duration_ms.count() << ' ' << events_ << ' '
+            << events_late_ << ' ' << appends_succeeded_ << ' '
+            << appends_failed_ << ' ' << appends_skipped_ << ' ' << nrecords_
+            << ' ' << nbytes_ << std::endl;
+
+  return trace_corrupted_.load() ? 1 : 0;
+}
+
+} // namespace
+
+void registerTraceReplayWorker() {
+  registerWorkerImpl(BENCH_NAME,
+                     []() -> std::unique_ptr<Worker> {
+                       return std::make_unique<TraceReplayWorker>();
+                     },
+                     OptionsRestrictions(
+                         {
+                             "pretend",
+                             "duration",
+                             "replay-trace",
+                             "replay-speed",
+                             "max-appends-in-flight",
+                             "use-buffered-writer",
+                             "start-time",
+                         },
+                         {PartitioningMode::LOG, PartitioningMode::RECORD},
+                         OptionsRestrictions::AllowBufferedWriterOptions::YES));
+}
+
+}}} // namespace facebook::logdevice::ldbench
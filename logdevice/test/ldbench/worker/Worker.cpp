@@ -99,18 +99,22 @@ Worker::getLogsPartition(const std::vector<logid_t>& logs) {
   ld_check(options.partition_by == PartitioningMode::LOG);
   std::vector<logid_t> res;
   for (logid_t log : logs) {
-    // Use some random salt to make sure we don't accidentally use the same hash
-    // function for multiple purposes (e.g. partitioning and selecting log
-    // throughput).
-    if (folly::hash::hash_128_to_64(log.val_, 757071) %
-            options.worker_id_count ==
-        options.worker_id_index) {
+    if (isLogInPartition(log)) {
       res.push_back(log);
     }
   }
   return res;
 }
 
+bool Worker::isLogInPartition(logid_t log) {
+  // Use some random salt to make sure we don't accidentally use the same hash
+  // function for multiple purposes (e.g. partitioning and selecting log
+  // throughput).
+  return folly::hash::hash_128_to_64(log.val_, 757071) %
+      options.worker_id_count ==
+      options.worker_id_index;
+}
+
 Worker::LogIdDist Worker::getLogIdDist(std::vector<logid_t> logs) {
   if (logs.empty()) {
     return nullptr;
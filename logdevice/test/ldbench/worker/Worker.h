@@ -148,6 +148,10 @@ class Worker : private boost::noncopyable {
   static std::vector<logid_t>
   getLogsPartition(const std::vector<logid_t>& logs);
 
+  // Whether the log belongs to this worker's partition, see
+  // getLogsPartition().
+  static bool isLogInPartition(logid_t log);
+
   /**
    * Get uniform random distribution across given logs.
    *
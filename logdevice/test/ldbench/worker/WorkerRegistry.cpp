@@ -26,6 +26,8 @@ const WorkerFactoryMap& getWorkerFactoryMap() {
   registerWriteSaturationWorker();
   registerIsLogEmptyWorker();
   registerFindTimeWorker();
+  registerTraceReplayWorker();
+  registerInterferenceWorker();
 
   return getWorkerFactoryMapImpl();
 }
@@ -67,6 +67,8 @@ void registerReadYourWriteLatencyWorker();
 void registerWriteSaturationWorker();
 void registerIsLogEmptyWorker();
 void registerFindTimeWorker();
+void registerTraceReplayWorker();
+void registerInterferenceWorker();
 
 } // namespace ldbench
 }} // namespace facebook::logdevice
@@ -8,6 +8,8 @@
 
 #include <iostream>
 
+#include <folly/small_vector.h>
+
 #include "logdevice/common/LibeventTimer.h"
 #include "logdevice/common/Random.h"
 #include "logdevice/test/ldbench/worker/BenchStats.h"
@@ -32,6 +34,8 @@ class WriteWorker final : public Worker {
 
     RandomEventSequence::State append_generator_state;
     LibeventTimer next_append_timer;
+    // steadyTime() at which next_append_timer is meant to fire.
+    double next_append_time = 0;
     double payload_size_multiplier;
 
     // See makePayload() for explanation.
@@ -41,11 +45,14 @@ class WriteWorker final : public Worker {
     explicit LogState(logid_t log) : log_id(log) {}
   };
 
-  // Returns how many appends we need to do now. Typically 1, but can be more
-  // if timer is ticking slower than our target rate of appends.
-  size_t activateNextAppendTimer(LogState* state);
+  // Returns the steadyTime()s at which the appends we need to do now were
+  // meant to be done. Typically one, but can be more if timer is ticking
+  // slower than our target rate of appends.
+  folly::small_vector<double, 4> activateNextAppendTimer(LogState* state);
 
-  void maybeAppend(LogState* state);
+  // `intended_time` is the steadyTime() at which the append was scheduled,
+  // latency is also reported from it. See RecordWriterInfo.
+  void maybeAppend(LogState* state, double intended_time);
 
   void updateThroughput();
 
@@ -55,7 +62,7 @@ class WriteWorker final : public Worker {
                     uint64_t num_records,
                     uint64_t payload_bytes) override;
 
-  std::string makePayload(size_t size, LogState* state);
+  std::string makePayload(size_t size, LogState* state, double intended_time);
 
   void printProgress(double seconds_since_start,
                      double seconds_since_last_call) override;
@@ -122,7 +129,9 @@ void WriteWorker::onAppendDone(LogIDType log_id,
   }
 }
 
-std::string WriteWorker::makePayload(size_t size, LogState* state) {
+std::string WriteWorker::makePayload(size_t size,
+                                     LogState* state,
+                                     double intended_time) {
   // We want the payload to have a given compression ratio on the client,
   // followed by a given additional compression ratio in sequencer batching.
   // To do that, we'll generate payload consisting of 3 parts:
@@ -153,6 +162,10 @@ std::string WriteWorker::makePayload(size_t size, LogState* state) {
     info.client_timestamp =
         std::chrono::duration_cast<std::chrono::microseconds>(
             std::chrono::system_clock::now().time_since_epoch());
+    double behind_sec = std::max(0., steadyTime() - intended_time);
+    info.intended_timestamp = info.client_timestamp -
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::duration<double>(behind_sec));
     header = (info.serializedSize() + 3) / 4;
     len = std::max(len, header) - header;
     payload_buf_.resize(header + len);
@@ -238,10 +251,11 @@ void WriteWorker::printProgress(double seconds_since_start,
           commaprint_r(uint64_t(bytes_per_sec), &bufs[5][0], 32));
 }
 
-size_t WriteWorker::activateNextAppendTimer(LogState* state) {
+folly::small_vector<double, 4>
+WriteWorker::activateNextAppendTimer(LogState* state) {
   double now = steadyTime();
   double t;
-  size_t to_append = 1;
+  folly::small_vector<double, 4> to_append = {state->next_append_time};
   while (true) {
     t = append_generator_.nextEvent(state->append_generator_state);
     if (t >= now) {
@@ -255,25 +269,28 @@ size_t WriteWorker::activateNextAppendTimer(LogState* state) {
     if (t >= now - 0.010) { // 10 ms ago
       // If we missed a few events because the timer was a little late, let's
       // do as many extra appends as many events we missed.
-      ++to_append;
+      to_append.push_back(t);
       STAT_INCR(stats_.get(), ldbench->writer_append_timer_slightly_late);
     } else {
       // But if we're too far behind, it means we're probably out of CPU and
       // can't keep up with the append rate.
-      // Skip some appends to avoid falling behind indefinitely far.
+      // Skip some appends to avoid falling behind indefinitely far. Note that
+      // the latency of skipped appends isn't accounted for anywhere, watch
+      // the skipped counters.
       ++appends_skipped_;
       STAT_INCR(stats_.get(), ldbench->writer_appends_skipped_latency);
       client_holder_->getBenchStatsHolder()->getOrCreateTLStats()->incStat(
           StatsType::SKIPPED, 1);
     }
   }
+  state->next_append_time = t;
   state->next_append_timer.activate(
       std::chrono::duration_cast<std::chrono::microseconds>(
           std::chrono::duration<double>(t - now)));
   return to_append;
 }
 
-void WriteWorker::maybeAppend(LogState* state) {
+void WriteWorker::maybeAppend(LogState* state, double intended_time) {
   if (append_bytes_in_flight_.load() >= options.max_append_bytes_in_flight) {
     ++appends_skipped_;
     STAT_INCR(stats_.get(), ldbench->writer_appends_skipped_bytes_in_flight);
@@ -292,7 +309,7 @@ void WriteWorker::maybeAppend(LogState* state) {
   uint64_t payload_size = (uint64_t)(payload_size_distribution_.sampleFloat() *
                                          state->payload_size_multiplier +
                                      0.5);
-  std::string payload = makePayload(payload_size, state);
+  std::string payload = makePayload(payload_size, state, intended_time);
   payload_size = payload.size(); // may be slightly different
 
   // Track the largest payload size we've constructed.
@@ -488,9 +505,8 @@ int WriteWorker::run() {
     for (auto& kv : logs_) {
       auto state = kv.second.get();
       state->next_append_timer.assign(&ev_->getEvBase(), [this, state] {
-        size_t to_append = activateNextAppendTimer(state);
-        for (size_t i = 0; i < to_append; ++i) {
-          maybeAppend(state);
+        for (double intended_time : activateNextAppendTimer(state)) {
+          maybeAppend(state, intended_time);
         }
       });
     }
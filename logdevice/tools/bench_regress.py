@@ -0,0 +1,223 @@
+#!/usr/bin/env python3
+
+# Copyright (c) Facebook, Inc. and its affiliates.
+# All rights reserved.
+#
+# This source code is licensed under the BSD-style license found in the
+# LICENSE file in the root directory of this source tree.
+
+import argparse
+import datetime
+import json
+import math
+import os
+import platform
+import statistics
+import subprocess
+import sys
+
+
+DESC = """Runs folly benchmark binaries (e.g. the ones built from
+common/test/benchmarks and server/test/benchmarks) several times on pinned
+CPUs and writes the per-run results as JSON. If a baseline file is given,
+compares against it and exits with status 1 if any benchmark got slower by
+more than --threshold with statistical significance (Mann-Whitney U test).
+
+Typical use: run with --save on a known good revision to produce a baseline,
+then run with --baseline on later revisions on the same machine."""
+
+
+def pin_cpus(cpus):
+    if cpus:
+        return lambda: os.sched_setaffinity(0, cpus)
+    return None
+
+
+def parse_cpus(spec):
+    """Parses a CPU list like "2,4-7" into a set of CPU numbers."""
+    cpus = set()
+    for part in spec.split(","):
+        if not part:
+            continue
+        if "-" in part:
+            lo, hi = part.split("-")
+            cpus.update(range(int(lo), int(hi) + 1))
+        else:
+            cpus.add(int(part))
+    return cpus
+
+
+def run_binary(binary, args, cpus):
+    """Runs one benchmark binary once. Returns a dict from benchmark name to
+nanoseconds per iteration.
+
+    """
+    cmd = [binary, "--json"] + args
+    out = subprocess.run(
+        cmd,
+        stdout=subprocess.PIPE,
+        stderr=subprocess.DEVNULL,
+        preexec_fn=pin_cpus(cpus),
+        check=True,
+    ).stdout
+    results = json.loads(out.decode())
+    name_prefix = os.path.basename(binary) + ":"
+    # Skip BENCHMARK_DRAW_LINE() separators.
+    return {name_prefix + k: float(v) for k, v in results.items() if k != "-"}
+
+
+def mann_whitney_p(a, b):
+    """Two-sided p-value of the Mann-Whitney U test, using the normal
+approximation with tie correction. Good enough for the 5+ samples per side
+this script is meant to be used with.
+
+    """
+    n1, n2 = len(a), len(b)
+    if n1 == 0 or n2 == 0:
+        return 1.0
+    merged = sorted([(v, 0) for v in a] + [(v, 1) for v in b])
+    ranks = [0.0] * len(merged)
+    tie_term = 0.0
+    i = 0
+    while i < len(merged):
+        j = i
+        while j + 1 < len(merged) and merged[j + 1][0] == merged[i][0]:
+            j += 1
+        for k in range(i, j + 1):
+            ranks[k] = (i + j) / 2.0 + 1
+        t = j - i + 1
+        tie_term += t ** 3 - t
+        i = j + 1
+    r1 = sum(r for r, (_, side) in zip(ranks, merged) if side == 0)
+    u = r1 - n1 * (n1 + 1) / 2.0
+    n = n1 + n2
+    var = n1 * n2 / 12.0 * ((n + 1) - tie_term / (n * (n - 1)))
+    if var <= 0:
+        return 1.0
+    z = (abs(u - n1 * n2 / 2.0) - 0.5) / math.sqrt(var)
+    return math.erfc(max(z, 0.0) / math.sqrt(2))
+
+
+def compare(results, baseline, threshold, alpha):
+    """Prints a comparison table. Returns the names of regressed benchmarks."""
+    regressions = []
+    print(
+        "{:60} {:>12} {:>12} {:>8} {:>8}".format(
+            "benchmark", "base ns", "new ns", "change", "p"
+        )
+    )
+    for name in sorted(results):
+        new = results[name]
+        if name not in baseline:
+            print(
+                "{:60} {:>12} {:>12.1f}".format(name, "-", statistics.median(new))
+            )
+            continue
+        base = baseline[name]
+        base_med = statistics.median(base)
+        new_med = statistics.median(new)
+        change = new_med / base_med - 1 if base_med > 0 else 0.0
+        p = mann_whitney_p(base, new)
+        flag = ""
+        if change > threshold and p < alpha:
+            flag = " REGRESSION"
+            regressions.append(name)
+        elif change < -threshold and p < alpha:
+            flag = " improved"
+        print(
+            "{:60} {:>12.1f} {:>12.1f} {:>+7.1f}% {:>8.3f}{}".format(
+                name, base_med, new_med, change * 100, p, flag
+            )
+        )
+    return regressions
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description=DESC, formatter_class=argparse.ArgumentDefaultsHelpFormatter
+    )
+    parser.add_argument("binaries", nargs="+", help="benchmark binaries to run")
+    parser.add_argument(
+        "--cpus", default="", help='CPUs to pin benchmarks to, e.g. "2-3"'
+    )
+    parser.add_argument(
+        "--warmup", default=1, type=int, help="runs to discard per binary"
+    )
+    parser.add_argument(
+        "-n", default=7, dest="runs", type=int, help="measured runs per binary"
+    )
+    parser.add_argument(
+        "--bm-regex", default="", help="only run benchmarks matching this"
+    )
+    parser.add_argument(
+        "--extra-args",
+        default="",
+        help="more arguments for the binaries, space-separated",
+    )
+    parser.add_argument("--save", help="write results as JSON to this file")
+    parser.add_argument("--baseline", help="JSON results to compare against")
+    parser.add_argument(
+        "--threshold",
+        default=0.05,
+        type=float,
+        help="relative slowdown of the median that counts as a regression",
+    )
+    parser.add_argument(
+        "--alpha", default=0.01, type=float, help="significance level"
+    )
+    ARGS = parser.parse_args()
+
+    cpus = parse_cpus(ARGS.cpus)
+    bm_args = ARGS.extra_args.split()
+    if ARGS.bm_regex:
+        bm_args.append("--bm_regex=" + ARGS.bm_regex)
+
+    results = {}
+    for binary in ARGS.binaries:
+        for i in range(ARGS.warmup + ARGS.runs):
+            print(
+                "{} run {}/{}{}".format(
+                    binary,
+                    i + 1,
+                    ARGS.warmup + ARGS.runs,
+                    " (warmup)" if i < ARGS.warmup else "",
+                ),
+                file=sys.stderr,
+            )
+            run = run_binary(binary, bm_args, cpus)
+            if i < ARGS.warmup:
+                continue
+            for name, ns in run.items():
+                results.setdefault(name, []).append(ns)
+
+    if ARGS.save:
+        with open(ARGS.save, "w") as f:
+            json.dump(
+                {
+                    "host": platform.node(),
+                    "time": datetime.datetime.now().isoformat(),
+                    "cpus": sorted(cpus),
+                    "runs": ARGS.runs,
+                    "results": results,
+                },
+                f,
+                indent=2,
+                sort_keys=True,
+            )
+
+    if ARGS.baseline:
+        with open(ARGS.baseline) as f:
+            baseline = json.load(f)
+        if baseline.get("host") != platform.node():
+            print(
+                "Warning: baseline was recorded on {}".format(
+                    baseline.get("host")
+                ),
+                file=sys.stderr,
+            )
+        regressions = compare(
+            results, baseline["results"], ARGS.threshold, ARGS.alpha
+        )
+        if regressions:
+            print("{} regression(s)".format(len(regressions)), file=sys.stderr)
+            sys.exit(1)